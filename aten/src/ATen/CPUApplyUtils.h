@@ -35,7 +35,7 @@ namespace at {
  * reducing the number of nested loops.
  */
 
-inline Tensor sort_strides(Tensor& tensor_) {
+inline Tensor sort_strides(const Tensor& tensor_) {
   IntList strides = tensor_.strides();
   std::vector<int64_t> indices;
   indices.reserve(tensor_.ndimension());
@@ -50,7 +50,7 @@ inline Tensor sort_strides(Tensor& tensor_) {
 }
 
 template <typename Arg>
-inline void _setup_arrays(Tensor& tensor, Arg* iter) {
+inline void _setup_arrays(const Tensor& tensor, Arg* iter) {
   int64_t max_dim = tensor.ndimension();
   iter->dim_ = 0;
   for (int64_t i = 0; i < max_dim; i++) {
@@ -83,7 +83,7 @@ struct strided_tensor_iter_fixed {
   strided_tensor_iter_fixed(strided_tensor_iter_fixed const&) = delete;
   void operator=(strided_tensor_iter_fixed const& x) = delete;
   strided_tensor_iter_fixed(strided_tensor_iter_fixed&&) = default;
-  strided_tensor_iter_fixed(Tensor& tensor, bool sort_strides = false)
+  strided_tensor_iter_fixed(const Tensor& tensor, bool sort_strides = false)
       : data_(tensor.data<T>()) {
     memset(counter_, 0, sizeof(int64_t) * N);
     _setup_arrays(tensor, this);
@@ -104,7 +104,7 @@ struct strided_tensor_iter {
   strided_tensor_iter(strided_tensor_iter const&) = delete;
   void operator=(strided_tensor_iter const& x) = delete;
   strided_tensor_iter(strided_tensor_iter&&) = default;
-  strided_tensor_iter(Tensor& tensor)
+  strided_tensor_iter(const Tensor& tensor)
       : data_(tensor.data<T>()),
         dim_(tensor.ndimension()),
         counter_(dim_, 0),
@@ -253,7 +253,7 @@ apply_op(int64_t numel, int64_t offset, const Op& op, Args... iters) {
 */
 
 template <typename scalar1, typename Op>
-inline void CPU_tensor_apply1(Tensor tensor1, const Op op) {
+inline void CPU_tensor_apply1(const Tensor& tensor1, const Op op) {
   if (!_apply_preamble({tensor1}))
     return;
   if (tensor1.ndimension() < 8) {
@@ -268,7 +268,10 @@ inline void CPU_tensor_apply1(Tensor tensor1, const Op op) {
 }
 
 template <typename scalar1, typename scalar2, typename Op>
-inline void CPU_tensor_apply2(Tensor tensor1, Tensor tensor2, const Op op) {
+inline void CPU_tensor_apply2(
+    const Tensor& tensor1,
+    const Tensor& tensor2,
+    const Op op) {
   if (!_apply_preamble({tensor1, tensor2}))
     return;
   if (_max_dim_tensors({tensor1, tensor2}) <= 8) {
@@ -289,8 +292,11 @@ inline void CPU_tensor_apply2(Tensor tensor1, Tensor tensor2, const Op op) {
 }
 
 template <typename scalar1, typename scalar2, typename scalar3, typename Op>
-inline void
-CPU_tensor_apply3(Tensor tensor1, Tensor tensor2, Tensor tensor3, const Op op) {
+inline void CPU_tensor_apply3(
+    const Tensor& tensor1,
+    const Tensor& tensor2,
+    const Tensor& tensor3,
+    const Op op) {
   if (!_apply_preamble({tensor1, tensor2, tensor3}))
     return;
   if (_max_dim_tensors({tensor1, tensor2, tensor3}) <= 8) {
@@ -319,10 +325,10 @@ template <
     typename scalar4,
     typename Op>
 inline void CPU_tensor_apply4(
-    Tensor tensor1,
-    Tensor tensor2,
-    Tensor tensor3,
-    Tensor tensor4,
+    const Tensor& tensor1,
+    const Tensor& tensor2,
+    const Tensor& tensor3,
+    const Tensor& tensor4,
     const Op op) {
   if (!_apply_preamble({tensor1, tensor2, tensor3, tensor4}))
     return;
@@ -348,61 +354,70 @@ inline void CPU_tensor_apply4(
 }
 
 template <typename scalar1, typename Op>
-inline void CPU_tensor_parallel_apply1(Tensor tensor1, const Op op) {
+inline void CPU_tensor_parallel_apply1(const Tensor& tensor1, const Op op) {
   if (!_apply_preamble({tensor1}))
     return;
   if (tensor1.numel() < internal::TBB_GRAIN_SIZE) {
     CPU_tensor_apply1<scalar1>(tensor1, op);
     return;
   }
-  auto range = tbb::blocked_range<size_t>(0, tensor1.numel());
   if (tensor1.ndimension() < 8) {
-    tbb::parallel_for(
-        range, [&tensor1, &op](const tbb::blocked_range<size_t> r) {
+    parallel_for(
+        0,
+        tensor1.numel(),
+        internal::TBB_GRAIN_SIZE,
+        [&tensor1, &op](int64_t begin, int64_t end) {
           apply_op(
-              r.end() - r.begin(),
-              r.begin(),
+              end - begin,
+              begin,
               op,
               strided_tensor_iter_fixed<scalar1, 8>(tensor1, true));
         });
   } else {
-    tbb::parallel_for(
-        range, [&tensor1, &op](const tbb::blocked_range<size_t> r) {
+    parallel_for(
+        0,
+        tensor1.numel(),
+        internal::TBB_GRAIN_SIZE,
+        [&tensor1, &op](int64_t begin, int64_t end) {
           apply_op(
-              r.end() - r.begin(),
-              r.begin(),
-              op,
-              strided_tensor_iter<scalar1>(tensor1));
+              end - begin, begin, op, strided_tensor_iter<scalar1>(tensor1));
         });
   }
 }
 
 template <typename scalar1, typename scalar2, typename Op>
-inline void
-CPU_tensor_parallel_apply2(Tensor tensor1, Tensor tensor2, const Op op) {
+inline void CPU_tensor_parallel_apply2(
+    const Tensor& tensor1,
+    const Tensor& tensor2,
+    const Op op) {
   if (!_apply_preamble({tensor1, tensor2}))
     return;
   if ((tensor1.numel() + tensor2.numel()) < internal::TBB_GRAIN_SIZE) {
     CPU_tensor_apply2<scalar1, scalar2>(tensor1, tensor2, op);
     return;
   }
-  auto range = tbb::blocked_range<size_t>(0, tensor1.numel());
   if (tensor1.ndimension() < 8 && tensor2.ndimension() < 8) {
-    tbb::parallel_for(
-        range, [&tensor1, &tensor2, &op](const tbb::blocked_range<size_t> r) {
+    parallel_for(
+        0,
+        tensor1.numel(),
+        internal::TBB_GRAIN_SIZE,
+        [&tensor1, &tensor2, &op](int64_t begin, int64_t end) {
           apply_op(
-              r.end() - r.begin(),
-              r.begin(),
+              end - begin,
+              begin,
               op,
               strided_tensor_iter_fixed<scalar1, 8>(tensor1),
               strided_tensor_iter_fixed<scalar2, 8>(tensor2));
         });
   } else {
-    tbb::parallel_for(
-        range, [&tensor1, &tensor2, &op](const tbb::blocked_range<size_t> r) {
+    parallel_for(
+        0,
+        tensor1.numel(),
+        internal::TBB_GRAIN_SIZE,
+        [&tensor1, &tensor2, &op](int64_t begin, int64_t end) {
           apply_op(
-              r.end() - r.begin(),
-              r.begin(),
+              end - begin,
+              begin,
               op,
               strided_tensor_iter<scalar1>(tensor1),
               strided_tensor_iter<scalar2>(tensor2));
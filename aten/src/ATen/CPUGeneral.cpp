@@ -1,4 +1,5 @@
 #include <ATen/CPUGeneral.h>
+#include <TH/TH.h>
 #include <atomic>
 #include <memory>
 #include <thread>
@@ -7,9 +8,15 @@ namespace at {
 // Lock free atomic type
 std::atomic<int> num_threads(-1);
 
+// The thread count is shared by every intra-op runtime in the process:
+// ATen's own parallel primitives read it lazily (see ATen/Parallel.h), and
+// TH's OpenMP loops and MKL are updated eagerly here so that they never
+// spin up a second, differently sized pool next to ours.
 void set_num_threads(int num_threads_) {
-  if (num_threads_ >= 0)
+  if (num_threads_ >= 0) {
     num_threads.store(num_threads_);
+    THSetNumThreads(num_threads_ == 0 ? 1 : num_threads_);
+  }
 }
 
 int get_num_threads() { return num_threads.load(); }
@@ -14,6 +14,10 @@
 #include <pmmintrin.h>
 #endif
 
+#if AT_NNPACK_ENABLED()
+#include <nnpack.h>
+#endif
+
 namespace at {
 
 static inline void errorHandler(const char * msg, void * data) {
@@ -76,6 +80,25 @@ bool Context::hasMKL() const {
 #endif
 }
 
+bool Context::hasMKLDNN() const {
+#if AT_MKLDNN_ENABLED()
+  return true;
+#else
+  return false;
+#endif
+}
+
+bool Context::hasNNPACK() const {
+#if AT_NNPACK_ENABLED()
+  // nnp_initialize fails on CPUs without the instructions NNPACK needs
+  // (e.g. AVX2 on x86-64)
+  static const bool available = nnp_initialize() == nnp_status_success;
+  return available;
+#else
+  return false;
+#endif
+}
+
 bool Context::setFlushDenormal(bool on) {
 #ifdef USE_SSE3
   // Setting flush-to-zero (FTZ) flag
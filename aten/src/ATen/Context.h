@@ -57,6 +57,9 @@ public:
     return *generator;
   }
   bool hasMKL() const;
+  bool hasMKLDNN() const;
+  // True if ATen was compiled with NNPACK and NNPACK supports this CPU
+  bool hasNNPACK() const;
   bool hasCUDA() const {
     return detail::getCUDAHooks().hasCUDA();
   }
@@ -164,6 +167,14 @@ static inline bool hasMKL() {
   return globalContext().hasMKL();
 }
 
+static inline bool hasMKLDNN() {
+  return globalContext().hasMKLDNN();
+}
+
+static inline bool hasNNPACK() {
+  return globalContext().hasNNPACK();
+}
+
 static inline int64_t current_device() {
   return globalContext().current_device();
 }
@@ -2,6 +2,7 @@
 
 #include <iostream>
 #include <sstream>
+#include <vector>
 
 
 using namespace std;
@@ -157,16 +158,32 @@ DLManagedTensor* toDLPack(const Tensor& src) {
 }
 
 
+// The returned tensor views the memory of src, whatever its strides: a
+// tensor without strides (compact, row-major) and byte_offset are handled
+// too. ATen strides cannot be negative, so those are rejected.
 Tensor fromDLPack(const DLManagedTensor* src) {
   Backend backend = getATenBackend(src->dl_tensor.ctx);
   ScalarType stype = toScalarType(src->dl_tensor.dtype);
+  IntList sizes(src->dl_tensor.shape, src->dl_tensor.ndim);
+  std::vector<int64_t> strides;
+  if (src->dl_tensor.strides) {
+    strides.assign(src->dl_tensor.strides, src->dl_tensor.strides + src->dl_tensor.ndim);
+    for (auto stride : strides) {
+      AT_CHECK(stride >= 0, "fromDLPack: negative strides are not supported, got ", stride);
+    }
+  } else {
+    strides.resize(src->dl_tensor.ndim);
+    int64_t stride = 1;
+    for (int64_t i = src->dl_tensor.ndim - 1; i >= 0; i--) {
+      strides[i] = stride;
+      stride *= sizes[i];
+    }
+  }
   auto deleter = [src](void * self) {
     src->deleter(const_cast<DLManagedTensor*>(src));
   };
   return getType(backend, stype).tensorFromBlob(
-      src->dl_tensor.data,
-      IntList(src->dl_tensor.shape, src->dl_tensor.ndim),
-      IntList(src->dl_tensor.strides, src->dl_tensor.ndim),
-      deleter);
+      static_cast<char*>(src->dl_tensor.data) + src->dl_tensor.byte_offset,
+      sizes, strides, deleter);
 }
 } //namespace at
@@ -1,5 +1,6 @@
 #pragma once
 #include <ATen/ATen.h>
+#include <ATen/CPUGeneral.h>
 #include <tbb/tbb.h>
 #include <cstddef>
 
@@ -22,8 +23,76 @@ AT_API void init_tbb_num_threads();
 // no parallel algorithm (such as parallel_reduce) should split work into
 // smaller than GRAIN_SIZE chunks.
 constexpr int64_t TBB_GRAIN_SIZE = 32768;
+
+// Returns true if the user asked for a single thread of execution, in which
+// case the parallel primitives below run inline without touching the
+// scheduler. 0 is treated like 1 for compatibility with TH.
+inline bool run_serially() {
+  int num_threads = get_num_threads();
+  return num_threads == 0 || num_threads == 1;
+}
 } // namespace internal
 
+// Intra-op parallel primitives. All CPU kernels in ATen should go through
+// these functions instead of calling into TBB directly, so that the number
+// of threads requested with at::set_num_threads is honored everywhere and
+// the backend can be swapped out in a single place.
+//
+// parallel_for splits [begin, end) into chunks of at least grain_size
+// elements and calls f(chunk_begin, chunk_end) for each of them, possibly
+// concurrently. Small ranges and single-threaded configurations run inline
+// on the calling thread.
+template <class F>
+inline void parallel_for(
+    int64_t begin,
+    int64_t end,
+    int64_t grain_size,
+    const F& f) {
+  if (begin >= end) {
+    return;
+  }
+  if ((end - begin) <= grain_size || internal::run_serially()) {
+    f(begin, end);
+    return;
+  }
+  internal::init_tbb_num_threads();
+  static tbb::affinity_partitioner ap;
+  tbb::parallel_for(
+      tbb::blocked_range<int64_t>(begin, end, grain_size),
+      [&f](const tbb::blocked_range<int64_t>& r) { f(r.begin(), r.end()); },
+      ap);
+}
+
+// parallel_reduce computes f over chunks of [begin, end) of at least
+// grain_size elements, each starting from ident, and combines the partial
+// results with sf. Both f and sf must be safe to call concurrently and sf
+// must be associative.
+template <class scalar_t, class F, class SF>
+inline scalar_t parallel_reduce(
+    int64_t begin,
+    int64_t end,
+    int64_t grain_size,
+    scalar_t ident,
+    const F& f,
+    const SF& sf) {
+  if (begin >= end) {
+    return ident;
+  }
+  if ((end - begin) <= grain_size || internal::run_serially()) {
+    return f(begin, end, ident);
+  }
+  internal::init_tbb_num_threads();
+  static tbb::affinity_partitioner ap;
+  return tbb::parallel_reduce(
+      tbb::blocked_range<int64_t>(begin, end, grain_size),
+      ident,
+      [&f](const tbb::blocked_range<int64_t>& r, scalar_t init) {
+        return f(r.begin(), r.end(), init);
+      },
+      sf,
+      ap);
+}
+
 template <class T, template <class> class OP>
 T parallel_reduce(
     T (*f)(const T*, size_t, size_t, T),
@@ -31,23 +100,15 @@ T parallel_reduce(
     size_t start,
     size_t end,
     T init_) {
-  internal::init_tbb_num_threads();
-
-  T result_;
-  static tbb::affinity_partitioner ap;
-  if (end - start < internal::TBB_GRAIN_SIZE) {
-    result_ = f(data, start, end, init_);
-  } else {
-    result_ = tbb::parallel_reduce(
-        tbb::blocked_range<size_t>(start, end, internal::TBB_GRAIN_SIZE),
-        init_,
-        [&data, &f](const tbb::blocked_range<size_t> r, T init) -> T {
-          return f(data, r.begin(), r.end(), init);
-        },
-        OP<T>(),
-        ap);
-  }
-  return result_;
+  return parallel_reduce(
+      static_cast<int64_t>(start),
+      static_cast<int64_t>(end),
+      internal::TBB_GRAIN_SIZE,
+      init_,
+      [&data, &f](int64_t b, int64_t e, T init) -> T {
+        return f(data, b, e, init);
+      },
+      OP<T>());
 }
 
 template <class T>
@@ -58,34 +119,24 @@ void parallel_reduce_2d(
     size_t numel,
     const T* arr_,
     T* outarr_) {
-  internal::init_tbb_num_threads();
-
-  static tbb::affinity_partitioner ap;
-
   size_t max_i_ =
       (numel && num_rows && num_cols) ? numel / (num_rows * num_cols) : 0;
-  if (numel < internal::TBB_GRAIN_SIZE) {
-    for (size_t i_ = 0; i_ < max_i_; i_++) {
+  auto reduce_matrices = [&arr_, &outarr_, num_rows, num_cols, &f](
+                             int64_t begin, int64_t end) {
+    for (int64_t i_ = begin; i_ < end; i_++) {
       int64_t i = i_ * num_rows * num_cols;
       int64_t i_r = i_ * num_cols;
       const T* arr = arr_ + i;
       T* outarr = outarr_ + i_r;
       f(arr, outarr, num_rows, num_cols);
     }
+  };
+  // Each task handles a whole matrix, so only split the work once the total
+  // number of elements justifies it.
+  if (numel < static_cast<size_t>(internal::TBB_GRAIN_SIZE)) {
+    reduce_matrices(0, max_i_);
   } else {
-    tbb::parallel_for(
-        tbb::blocked_range<size_t>(0, max_i_, 1),
-        [&arr_, &outarr_, num_rows, num_cols, &f](
-            const tbb::blocked_range<size_t> r) {
-          for (size_t i_ = r.begin(); i_ < r.end(); i_++) {
-            int64_t i = i_ * num_rows * num_cols;
-            int64_t i_r = i_ * num_cols;
-            const T* arr = arr_ + i;
-            T* outarr = outarr_ + i_r;
-            f(arr, outarr, num_rows, num_cols);
-          }
-        },
-        ap);
+    parallel_for(0, max_i_, 1, reduce_matrices);
   }
 }
 
@@ -20,6 +20,9 @@ struct Storage {
   virtual const void* data() const = 0;
   virtual Storage& retain() = 0;
   virtual Storage& free() = 0;
+  // Number of references to the underlying storage, including the one held
+  // by this object
+  virtual int use_count() const = 0;
   virtual void * unsafeGetTH(bool retain) const = 0;
 
   virtual Storage& resize(int64_t new_size) = 0;
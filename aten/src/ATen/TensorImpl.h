@@ -1,5 +1,6 @@
 #pragma once
 
+#include <array>
 #include <atomic>
 #include <memory>
 
@@ -14,6 +15,21 @@ struct Tensor;
 } // namespace at
 
 namespace at {
+
+// Note [Empty versus 0-dim tensors]
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// Unlike Torch, ATen treats zero-dimension tensors as having ONE
+// element (that is to say, a zero-dimensional tensor is a scalar!)
+// This is in contrast to Torch, where a zero-dimension tensor has
+// zero elements.
+//
+// Because we are backed by Torch tensors, we need to be able to
+// represent this state (of numel==0).  These tensors are represented
+// by one-dimensional tensors with size[0] == 0 and stride[0] == 1
+// (the stride is arbitrary but matches the NumPy equivalent).
+constexpr std::array<int64_t, 1> kEmptySizes { {0} };
+constexpr std::array<int64_t, 1> kEmptyStrides { {1} };
+
 struct TensorImpl : public Retainable {
   explicit TensorImpl(Type * type)
   : is_scalar(false), type_(type) {}
@@ -22,9 +38,45 @@ struct TensorImpl : public Retainable {
     return *type_;
   }
   virtual const char * toString() const = 0;
-  virtual IntList sizes() const = 0;
-  virtual IntList strides() const = 0;
-  virtual int64_t dim() const = 0;
+
+  // Metadata of dense TH tensors is read in place, without virtual calls,
+  // since it is queried by every operator. Other tensors implement the
+  // *_custom methods.
+  IntList sizes() const {
+    if (th_dim_) {
+      // See Note [Empty versus 0-dim tensors]
+      if (*th_dim_ != 0) {
+        return IntList(*th_size_, dim());
+      }
+      return IntList(kEmptySizes);
+    }
+    return sizes_custom();
+  }
+  IntList strides() const {
+    if (th_dim_) {
+      if (*th_dim_ != 0) {
+        return IntList(*th_stride_, dim());
+      }
+      return IntList(kEmptyStrides);
+    }
+    return strides_custom();
+  }
+  int64_t dim() const {
+    if (th_dim_) {
+      if (is_scalar) {
+        return 0;
+      }
+      if (*th_dim_ != 0) {
+        return *th_dim_;
+      }
+      return kEmptySizes.size();
+    }
+    return dim_custom();
+  }
+  virtual IntList sizes_custom() const = 0;
+  virtual IntList strides_custom() const = 0;
+  virtual int64_t dim_custom() const = 0;
+
   virtual Scalar localScalar() = 0;
   virtual void * unsafeGetTH(bool retain) = 0;
   virtual std::unique_ptr<Storage> storage() = 0;
@@ -74,7 +126,20 @@ struct TensorImpl : public Retainable {
   AT_API virtual void set_data(Tensor new_data);
 
 protected:
+  // Called by dense tensors with the fields of their TH tensor, which must
+  // outlive this TensorImpl.
+  void set_th_metadata(int64_t* const* size, int64_t* const* stride, const int* dim) {
+    th_size_ = size;
+    th_stride_ = stride;
+    th_dim_ = dim;
+  }
+
   bool is_scalar;
   Type * type_;
+
+private:
+  int64_t* const* th_size_ = nullptr;
+  int64_t* const* th_stride_ = nullptr;
+  const int* th_dim_ = nullptr;
 };
 } // namespace at
@@ -47,7 +47,7 @@ inline Tensor Tensor::operator[](Scalar index) const {
       index.toTensor().type().toString(), ")");
   return select(0, index.toLong());
 }
-inline Tensor Tensor::operator[](Tensor index) const {
+inline Tensor Tensor::operator[](const Tensor & index) const {
   // These properties are checked in the Scalar constructor, but we already
   // check them here to provide more useful diagnostics for the user.
   AT_CHECK(index.defined(), "Can only index with tensors that are defined");
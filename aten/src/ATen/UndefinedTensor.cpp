@@ -13,11 +13,11 @@ const char * UndefinedTensor::toString() const {
   return "UndefinedTensor";
 }
 
-IntList UndefinedTensor::sizes() const {
+IntList UndefinedTensor::sizes_custom() const {
   AT_ERROR("sizes() called on undefined Tensor");
 }
 
-int64_t UndefinedTensor::dim() const {
+int64_t UndefinedTensor::dim_custom() const {
   AT_ERROR("dim() called on undefined Tensor");
 }
 
@@ -31,7 +31,7 @@ std::unique_ptr<Storage> UndefinedTensor::storage() {
   AT_ERROR("storage() called on undefined Tensor");
 }
 
-IntList UndefinedTensor::strides() const {
+IntList UndefinedTensor::strides_custom() const {
   AT_ERROR("strides() called on undefined Tensor");
 }
 Scalar UndefinedTensor::localScalar() {
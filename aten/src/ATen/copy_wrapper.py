@@ -35,6 +35,14 @@ static_cast<${dst_tensor}*>(dst.pImpl)->tensor, \
 static_cast<${src_tensor}*>(src.pImpl)->tensor);
 """)
 
+# Copies between CPU tensors of different scalar types first try the
+# parallel conversion kernel of native/Copy.h, and fall back on TH's copy.
+COPY_CONVERT_CPU = CodeTemplate("""\
+if (at::native::copy_convert_cpu(dst, src)) {
+    break;
+}
+""")
+
 COPY_ASYNC_CPU = CodeTemplate("""\
 if (non_blocking) {
     ${THTensor}_copyAsyncCPU(${state,}\
@@ -136,6 +144,8 @@ def create_one_copy(dst_type, all_types):
         if dst_type['ScalarType'] == src_type['ScalarType']:
             if dst_type['Backend'] == 'CUDA' and src_type['Backend'] == 'CPU':
                 copies.append(COPY_ASYNC_CPU.substitute(body_env))
+        elif dst_type['Backend'] == 'CPU' and src_type['Backend'] == 'CPU':
+            copies.append(COPY_CONVERT_CPU.substitute(body_env))
         copies.append(COPY.substitute(body_env))
 
         copy_body.append(CASE.substitute(body_env, copies=copies))
@@ -203,6 +213,8 @@ def create(all_types, backend):
 
     if backend == 'CUDA':
         top_env['cuda_includes'].append(CUDA_INCLUDES)
+    else:
+        top_env['copy_includes'].append('#include "ATen/native/Copy.h"')
 
     # Headers to include
     for the_type in all_types:
@@ -4,8 +4,13 @@
 
 #include "vec256_base.h"
 #include "vec256_float.h"
+#include "vec256_float_neon.h"
 #include "vec256_double.h"
 #include "vec256_int.h"
+#include "vec256_half.h"
+#include "vec512_base.h"
+#include "vec512_float.h"
+#include "vec512_double.h"
 
 #include <algorithm>
 #include <cstddef>
@@ -17,6 +22,30 @@ namespace at {
 namespace vec256 {
 namespace {
 
+// Vectorized<T> is the widest vector of T for the instruction set of the
+// current compilation: Vec512 for float and double with AVX-512, Vec256
+// otherwise. The kernels in native/cpu are compiled once per CPU capability
+// and use it, so that each capability gets its own vector width.
+template <typename T>
+struct vectorized_type {
+  using type = Vec256<T>;
+};
+
+#ifdef __AVX512F__
+template <>
+struct vectorized_type<float> {
+  using type = Vec512<float>;
+};
+
+template <>
+struct vectorized_type<double> {
+  using type = Vec512<double>;
+};
+#endif
+
+template <typename T>
+using Vectorized = typename vectorized_type<T>::type;
+
 template <typename T>
 std::ostream& operator<<(std::ostream& stream, const Vec256<T>& vec) {
   T buf[Vec256<T>::size()];
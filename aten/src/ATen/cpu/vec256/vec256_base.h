@@ -120,6 +120,14 @@ template <class T> Vec256<T> operator+(const Vec256<T> &a, const Vec256<T> &b) {
   return c;
 }
 
+template <class T> Vec256<T> operator-(const Vec256<T> &a, const Vec256<T> &b) {
+  Vec256<T> c = Vec256<T>();
+  for (int i = 0; i != c.size; i++) {
+    c.values[i] = a.values[i] - b.values[i];
+  }
+  return c;
+}
+
 template <class T> Vec256<T> operator*(const Vec256<T> &a, const Vec256<T> &b) {
   Vec256<T> c = Vec256<T>();
   for (int i = 0; i != c.size; i++) {
@@ -136,4 +144,13 @@ template <class T> Vec256<T> operator/(const Vec256<T> &a, const Vec256<T> &b) {
   return c;
 }
 
+// Elementwise max; if either value is NaN, returns b (as _mm256_max_ps does)
+template <class T> Vec256<T> maximum(const Vec256<T> &a, const Vec256<T> &b) {
+  Vec256<T> c = Vec256<T>();
+  for (int i = 0; i != c.size; i++) {
+    c.values[i] = a.values[i] > b.values[i] ? a.values[i] : b.values[i];
+  }
+  return c;
+}
+
 }}}
@@ -113,6 +113,11 @@ Vec256<double> inline operator+(const Vec256<double>& a, const Vec256<double>& b
   return _mm256_add_pd(a, b);
 }
 
+template <>
+Vec256<double> inline operator-(const Vec256<double>& a, const Vec256<double>& b) {
+  return _mm256_sub_pd(a, b);
+}
+
 template <>
 Vec256<double> inline operator*(const Vec256<double>& a, const Vec256<double>& b) {
   return _mm256_mul_pd(a, b);
@@ -123,6 +128,11 @@ Vec256<double> inline operator/(const Vec256<double>& a, const Vec256<double>& b
   return _mm256_div_pd(a, b);
 }
 
+template <>
+Vec256<double> inline maximum(const Vec256<double>& a, const Vec256<double>& b) {
+  return _mm256_max_pd(a, b);
+}
+
 #endif
 
 }}}
@@ -114,6 +114,11 @@ Vec256<float> inline operator+(const Vec256<float>& a, const Vec256<float>& b) {
   return _mm256_add_ps(a, b);
 }
 
+template <>
+Vec256<float> inline operator-(const Vec256<float>& a, const Vec256<float>& b) {
+  return _mm256_sub_ps(a, b);
+}
+
 template <>
 Vec256<float> inline operator*(const Vec256<float>& a, const Vec256<float>& b) {
   return _mm256_mul_ps(a, b);
@@ -124,6 +129,11 @@ Vec256<float> inline operator/(const Vec256<float>& a, const Vec256<float>& b) {
   return _mm256_div_ps(a, b);
 }
 
+template <>
+Vec256<float> inline maximum(const Vec256<float>& a, const Vec256<float>& b) {
+  return _mm256_max_ps(a, b);
+}
+
 #endif
 
 }}}
@@ -0,0 +1,190 @@
+#pragma once
+
+#include "intrinsics.h"
+#include "vec256_base.h"
+#include <cmath>
+
+namespace at {
+namespace vec256 {
+namespace {
+
+// Vec256<float> as a pair of 128-bit NEON registers. Division, square root
+// and rounding have vector instructions on AArch64 only and are computed
+// lane by lane on 32-bit ARM; the transcendental functions are always
+// computed lane by lane.
+#if (defined(__ARM_NEON) || defined(__ARM_NEON__)) && !defined(__AVX__)
+
+template <> class Vec256<float> {
+public:
+  static constexpr int size = 8;
+  float32x4x2_t values;
+  Vec256() {}
+  Vec256(float32x4x2_t v) : values(v) {}
+  Vec256(float32x4_t lo, float32x4_t hi) {
+    values.val[0] = lo;
+    values.val[1] = hi;
+  }
+  Vec256(float val) {
+    values.val[0] = vdupq_n_f32(val);
+    values.val[1] = values.val[0];
+  }
+  operator float32x4x2_t() const {
+    return values;
+  }
+  float32x4_t lo() const {
+    return values.val[0];
+  }
+  float32x4_t hi() const {
+    return values.val[1];
+  }
+  void load(const void *ptr) {
+    auto src = reinterpret_cast<const float*>(ptr);
+    values.val[0] = vld1q_f32(src);
+    values.val[1] = vld1q_f32(src + 4);
+  }
+  void load_partial(const void *ptr, int count) {
+    float tmp_values[size];
+    std::memcpy(tmp_values, ptr, count * sizeof(float));
+    load(tmp_values);
+  }
+  static Vec256<float> s_load(const void* ptr) {
+    Vec256<float> vec;
+    vec.load(ptr);
+    return vec;
+  }
+  void store(void *ptr) const {
+    auto dst = reinterpret_cast<float*>(ptr);
+    vst1q_f32(dst, values.val[0]);
+    vst1q_f32(dst + 4, values.val[1]);
+  }
+  void store_partial(void* ptr, int count) const {
+    float tmp_values[size];
+    store(tmp_values);
+    std::memcpy(ptr, tmp_values, count * sizeof(float));
+  }
+  Vec256<float> map(float (*f)(float)) const {
+    __at_align32__ float tmp[8];
+    store(tmp);
+    for (int64_t i = 0; i < 8; i++) {
+      tmp[i] = f(tmp[i]);
+    }
+    return s_load(tmp);
+  }
+  Vec256<float> abs() const {
+    return Vec256<float>(vabsq_f32(lo()), vabsq_f32(hi()));
+  }
+  Vec256<float> acos() const {
+    return map(std::acos);
+  }
+  Vec256<float> asin() const {
+    return map(std::asin);
+  }
+  Vec256<float> atan() const {
+    return map(std::atan);
+  }
+  Vec256<float> erf() const {
+    return map(std::erf);
+  }
+  Vec256<float> exp() const {
+    return map(std::exp);
+  }
+  Vec256<float> expm1() const {
+    return map(std::expm1);
+  }
+  Vec256<float> log() const {
+    return map(std::log);
+  }
+  Vec256<float> log2() const {
+    return map(std::log2);
+  }
+  Vec256<float> log10() const {
+    return map(std::log10);
+  }
+  Vec256<float> log1p() const {
+    return map(std::log1p);
+  }
+  Vec256<float> sin() const {
+    return map(std::sin);
+  }
+  Vec256<float> cos() const {
+    return map(std::cos);
+  }
+#if defined(__aarch64__)
+  Vec256<float> ceil() const {
+    return Vec256<float>(vrndpq_f32(lo()), vrndpq_f32(hi()));
+  }
+  Vec256<float> floor() const {
+    return Vec256<float>(vrndmq_f32(lo()), vrndmq_f32(hi()));
+  }
+  // to nearest even, as _mm256_round_ps with _MM_FROUND_TO_NEAREST_INT
+  Vec256<float> round() const {
+    return Vec256<float>(vrndnq_f32(lo()), vrndnq_f32(hi()));
+  }
+  Vec256<float> trunc() const {
+    return Vec256<float>(vrndq_f32(lo()), vrndq_f32(hi()));
+  }
+  Vec256<float> sqrt() const {
+    return Vec256<float>(vsqrtq_f32(lo()), vsqrtq_f32(hi()));
+  }
+#else
+  Vec256<float> ceil() const {
+    return map(std::ceil);
+  }
+  Vec256<float> floor() const {
+    return map(std::floor);
+  }
+  Vec256<float> round() const {
+    return map(std::nearbyint);
+  }
+  Vec256<float> trunc() const {
+    return map(std::trunc);
+  }
+  Vec256<float> sqrt() const {
+    return map(std::sqrt);
+  }
+#endif
+};
+
+template <>
+Vec256<float> inline operator+(const Vec256<float>& a, const Vec256<float>& b) {
+  return Vec256<float>(vaddq_f32(a.lo(), b.lo()), vaddq_f32(a.hi(), b.hi()));
+}
+
+template <>
+Vec256<float> inline operator-(const Vec256<float>& a, const Vec256<float>& b) {
+  return Vec256<float>(vsubq_f32(a.lo(), b.lo()), vsubq_f32(a.hi(), b.hi()));
+}
+
+template <>
+Vec256<float> inline operator*(const Vec256<float>& a, const Vec256<float>& b) {
+  return Vec256<float>(vmulq_f32(a.lo(), b.lo()), vmulq_f32(a.hi(), b.hi()));
+}
+
+template <>
+Vec256<float> inline operator/(const Vec256<float>& a, const Vec256<float>& b) {
+#if defined(__aarch64__)
+  return Vec256<float>(vdivq_f32(a.lo(), b.lo()), vdivq_f32(a.hi(), b.hi()));
+#else
+  __at_align32__ float a_values[8];
+  __at_align32__ float b_values[8];
+  a.store(a_values);
+  b.store(b_values);
+  for (int i = 0; i < 8; i++) {
+    a_values[i] /= b_values[i];
+  }
+  return Vec256<float>::s_load(a_values);
+#endif
+}
+
+// vmaxq_f32 returns NaN if either value is NaN; select instead so that, as
+// with _mm256_max_ps, b is returned in that case
+template <>
+Vec256<float> inline maximum(const Vec256<float>& a, const Vec256<float>& b) {
+  return Vec256<float>(
+      vbslq_f32(vcgtq_f32(a.lo(), b.lo()), a.lo(), b.lo()),
+      vbslq_f32(vcgtq_f32(a.hi(), b.hi()), a.hi(), b.hi()));
+}
+
+#endif
+
+}}}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "intrinsics.h"
+#include "ATen/Half.h"
+
+#include <cstdint>
+
+namespace at {
+namespace vec256 {
+namespace {
+
+// Conversions between half storage and float arithmetic, 8 values at a
+// time with the F16C instructions when they are enabled (the AVX and AVX2
+// capabilities), and through at::convert otherwise. Both round like TH's
+// half conversions, to nearest even.
+
+static inline void convert_half_to_float(const Half* src, float* dst, int64_t n) {
+  int64_t i = 0;
+#if defined(__F16C__)
+  for (; i + 8 <= n; i += 8) {
+    __m128i h = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    _mm256_storeu_ps(dst + i, _mm256_cvtph_ps(h));
+  }
+#endif
+  for (; i < n; i++) {
+    dst[i] = convert<float, Half>(src[i]);
+  }
+}
+
+static inline void convert_float_to_half(const float* src, Half* dst, int64_t n) {
+  int64_t i = 0;
+#if defined(__F16C__)
+  for (; i + 8 <= n; i += 8) {
+    __m128i h = _mm256_cvtps_ph(_mm256_loadu_ps(src + i), _MM_FROUND_TO_NEAREST_INT);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), h);
+  }
+#endif
+  for (; i < n; i++) {
+    dst[i] = convert<Half, float>(src[i]);
+  }
+}
+
+}}}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include "vec256_base.h"
+
+#if defined(__GNUC__)
+#define __at_align64__ __attribute__((aligned(64)))
+#elif defined(_WIN32)
+#define __at_align64__ __declspec(align(64))
+#else
+#define __at_align64__
+#endif
+
+namespace at {
+namespace vec256 {
+namespace {
+
+// 512-bit vectors. Unlike Vec256 there is no emulated fallback: they are
+// only defined for float and double when compiling with AVX-512 (see
+// vec512_float.h and vec512_double.h), and kernels get them through
+// Vectorized<T> rather than by name.
+template <class T>
+struct Vec512;
+
+template <class T> Vec512<T> operator+(const Vec512<T> &a, const Vec512<T> &b);
+template <class T> Vec512<T> operator-(const Vec512<T> &a, const Vec512<T> &b);
+template <class T> Vec512<T> operator*(const Vec512<T> &a, const Vec512<T> &b);
+template <class T> Vec512<T> operator/(const Vec512<T> &a, const Vec512<T> &b);
+template <class T> Vec512<T> maximum(const Vec512<T> &a, const Vec512<T> &b);
+
+}}}
@@ -0,0 +1,137 @@
+#pragma once
+
+#include "intrinsics.h"
+#include "vec512_base.h"
+#include <sleef.h>
+
+namespace at {
+namespace vec256 {
+namespace {
+
+#ifdef __AVX512F__
+
+template <> class Vec512<double> {
+public:
+  static constexpr int size = 8;
+  __m512d values;
+  Vec512() {}
+  Vec512(__m512d v) : values(v) {}
+  Vec512(double val) {
+    values = _mm512_set1_pd(val);
+  }
+  operator __m512d() const {
+    return values;
+  }
+  void load(const void *ptr) {
+    values = _mm512_loadu_pd(reinterpret_cast<const double*>(ptr));
+  }
+  void load_partial(const void *ptr, int count) {
+    __mmask8 mask = (1 << count) - 1;
+    values = _mm512_maskz_loadu_pd(mask, ptr);
+  }
+  static Vec512<double> s_load(const void* ptr) {
+    Vec512<double> vec;
+    vec.load(ptr);
+    return vec;
+  }
+  void store(void *ptr) const {
+    _mm512_storeu_pd(reinterpret_cast<double*>(ptr), values);
+  }
+  void store_partial(void* ptr, int count) const {
+    __mmask8 mask = (1 << count) - 1;
+    _mm512_mask_storeu_pd(ptr, mask, values);
+  }
+  Vec512<double> map(double (*f)(double)) const {
+    __at_align64__ double tmp[8];
+    store(tmp);
+    for (int64_t i = 0; i < 8; i++) {
+      tmp[i] = f(tmp[i]);
+    }
+    return s_load(tmp);
+  }
+  Vec512<double> abs() const {
+    auto mask = _mm512_set1_epi64(0x7fffffffffffffff);
+    return _mm512_castsi512_pd(
+        _mm512_and_si512(_mm512_castpd_si512(values), mask));
+  }
+  Vec512<double> acos() const {
+    return Vec512<double>(Sleef_acosd8_u10(values));
+  }
+  Vec512<double> asin() const {
+    return Vec512<double>(Sleef_asind8_u10(values));
+  }
+  Vec512<double> atan() const {
+    return Vec512<double>(Sleef_atand8_u10(values));
+  }
+  Vec512<double> erf() const {
+    return Vec512<double>(Sleef_erfd8_u10(values));
+  }
+  Vec512<double> exp() const {
+    return Vec512<double>(Sleef_expd8_u10(values));
+  }
+  Vec512<double> expm1() const {
+    return Vec512<double>(Sleef_expm1d8_u10(values));
+  }
+  Vec512<double> log() const {
+    return Vec512<double>(Sleef_logd8_u10(values));
+  }
+  Vec512<double> log2() const {
+    return Vec512<double>(Sleef_log2d8_u10(values));
+  }
+  Vec512<double> log10() const {
+    return Vec512<double>(Sleef_log10d8_u10(values));
+  }
+  Vec512<double> log1p() const {
+    return Vec512<double>(Sleef_log1pd8_u10(values));
+  }
+  Vec512<double> sin() const {
+    return map(std::sin);
+  }
+  Vec512<double> cos() const {
+    return map(std::cos);
+  }
+  Vec512<double> ceil() const {
+    return _mm512_roundscale_pd(values, (_MM_FROUND_TO_POS_INF | _MM_FROUND_NO_EXC));
+  }
+  Vec512<double> floor() const {
+    return _mm512_roundscale_pd(values, (_MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC));
+  }
+  Vec512<double> round() const {
+    return _mm512_roundscale_pd(values, (_MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC));
+  }
+  Vec512<double> trunc() const {
+    return _mm512_roundscale_pd(values, (_MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC));
+  }
+  Vec512<double> sqrt() const {
+    return _mm512_sqrt_pd(values);
+  }
+};
+
+template <>
+Vec512<double> inline operator+(const Vec512<double>& a, const Vec512<double>& b) {
+  return _mm512_add_pd(a, b);
+}
+
+template <>
+Vec512<double> inline operator-(const Vec512<double>& a, const Vec512<double>& b) {
+  return _mm512_sub_pd(a, b);
+}
+
+template <>
+Vec512<double> inline operator*(const Vec512<double>& a, const Vec512<double>& b) {
+  return _mm512_mul_pd(a, b);
+}
+
+template <>
+Vec512<double> inline operator/(const Vec512<double>& a, const Vec512<double>& b) {
+  return _mm512_div_pd(a, b);
+}
+
+template <>
+Vec512<double> inline maximum(const Vec512<double>& a, const Vec512<double>& b) {
+  return _mm512_max_pd(a, b);
+}
+
+#endif
+
+}}}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include "ATen/cuda/ATenCUDAGeneral.h"
+
+#include <cstdint>
+
+namespace at { namespace native {
+
+// The cuFFT plans made by the FFTs are kept in one cache per device, of at
+// most max size (least recently used) plans each.  A max size of 0 disables
+// the caches.
+
+AT_CUDA_API int64_t cufft_get_plan_cache_max_size();
+AT_CUDA_API void cufft_set_plan_cache_max_size(int64_t max_size);
+
+// Number of plans currently cached for the device
+AT_CUDA_API int64_t cufft_get_plan_cache_size(int64_t device_index);
+AT_CUDA_API void cufft_clear_plan_cache(int64_t device_index);
+
+}} // namespace at::native
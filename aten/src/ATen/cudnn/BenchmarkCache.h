@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace at { namespace native {
+
+// The convolution algorithms found with cudnn.benchmark are cached per
+// process.  These functions write the cache to a file, and read it back (e.g.
+// in the next run of the same job, or on another machine with the same
+// GPUs), so that the benchmarking is only paid once.
+//
+// Entries are keyed by the convolution parameters and the name of the
+// device; a file written with another version of cuDNN is ignored.  Loaded
+// entries apply to every local device with a matching name, and don't
+// replace the entries already in the cache.
+
+void cudnn_save_benchmark_cache(const std::string& path);
+
+// Returns the number of entries added to the cache
+int64_t cudnn_load_benchmark_cache(const std::string& path);
+
+}} // namespace at::native
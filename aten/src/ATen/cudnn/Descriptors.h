@@ -210,6 +210,16 @@ struct SpatialTransformerDescriptor
   }
 };
 
+struct ActivationDescriptor
+  : public Descriptor<cudnnActivationStruct,
+                      &cudnnCreateActivationDescriptor,
+                      &cudnnDestroyActivationDescriptor>
+{
+  void set(cudnnActivationMode_t mode) {
+    CUDNN_CHECK(cudnnSetActivationDescriptor(mut_desc(), mode, CUDNN_PROPAGATE_NAN, 0.0));
+  }
+};
+
 #if CUDNN_VERSION < 7000
 
 // See Note [cuDNN dropout descriptor initialization]
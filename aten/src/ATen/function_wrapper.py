@@ -1347,8 +1347,11 @@ def create_derived(backend_type_env, declarations):
             else:
                 types = [to_return_type(arg, option)['type']
                          for arg in arguments]
-                # TODO: check for move semantics...
-                names = [arg['name'] for arg in arguments]
+                # locally allocated results are moved into the tuple, which
+                # saves a retain/release pair for each of them
+                names = ['std::move({})'.format(arg['name'])
+                         if arg.get('allocate', False) else arg['name']
+                         for arg in arguments]
                 body.append(CodeTemplate("return std::tuple<${types}>(${names});").substitute(
                     types=types, names=names))
         elif ret['kind'] == 'type':
@@ -320,9 +320,12 @@ def generate_storage_type_and_tensor(backend, density, scalar_type, declarations
         fm.write(env['Storage'] + ".h", STORAGE_DERIVED_H.substitute(env))
         env['TensorDenseOrSparse'] = TENSOR_DENSE_CPP.substitute(env)
         env['THTensor_nDimension'] = 'tensor->nDimension'
+        env['TensorImpl_metadata'] = \
+            'set_th_metadata(&tensor->size, &tensor->stride, &tensor->nDimension);'
     else:
         env['TensorDenseOrSparse'] = TENSOR_SPARSE_CPP.substitute(env)
         env['THTensor_nDimension'] = 'tensor->nDimensionI + tensor->nDimensionV'
+        env['TensorImpl_metadata'] = []
 
     fm.write(env['Type'] + ".cpp", TYPE_DERIVED_CPP.substitute(env))
     fm.write(env['Type'] + ".h", TYPE_DERIVED_H.substitute(env))
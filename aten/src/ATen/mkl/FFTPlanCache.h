@@ -0,0 +1,20 @@
+#pragma once
+
+#include "ATen/ATenGeneral.h"
+
+#include <cstdint>
+
+namespace at { namespace native {
+
+// The MKL DFTI descriptors made by the FFTs on CPU are kept in a cache of at
+// most max size (least recently used) descriptors.  A max size of 0 disables
+// the cache.
+
+AT_API int64_t mkl_fft_get_plan_cache_max_size();
+AT_API void mkl_fft_set_plan_cache_max_size(int64_t max_size);
+
+// Number of descriptors currently cached
+AT_API int64_t mkl_fft_get_plan_cache_size();
+AT_API void mkl_fft_clear_plan_cache();
+
+}} // namespace at::native
@@ -1,7 +1,17 @@
 #pragma once
 
+#include <ATen/ATen.h>
 #include <mkldnn.hpp>
 
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
 using namespace mkldnn;
 
 namespace at { namespace native {
@@ -46,4 +56,146 @@ private:
   stream _cpu_stream;
 };
 
+// Blocked tensors hold an NCHW tensor in the nChw8c or nChw16c format of
+// MKL-DNN, which is what its CPU primitives use internally. They are 5-d
+// (N, C / block, H, W, block) CPU float tensors, made by mkldnn_to_blocked,
+// so that a chain of MKL-DNN ops doesn't reorder at every op.
+
+// Block size of the channels of a blocked tensor, 0 for a 4-d NCHW tensor
+inline int32_t channel_block(const Tensor& t) {
+  if (t.dim() != 5) {
+    return 0;
+  }
+  AT_CHECK(t.size(4) == 8 || t.size(4) == 16,
+           "expected a 4-d NCHW or 5-d blocked tensor, got size ", t.sizes());
+  return static_cast<int32_t>(t.size(4));
+}
+
+// MKL-DNN format of the tensors with the given channel_block
+inline memory::format nchw_format(int32_t block) {
+  switch (block) {
+    case 0: return memory::format::nchw;
+    case 8: return memory::format::nChw8c;
+    case 16: return memory::format::nChw16c;
+  }
+  AT_ERROR("unsupported channel block size ", block);
+}
+
+// NCHW sizes of a 4-d NCHW or blocked tensor
+inline std::vector<int64_t> nchw_sizes(const Tensor& t) {
+  if (channel_block(t) == 0) {
+    return t.sizes();
+  }
+  return {t.size(0), t.size(1) * t.size(4), t.size(2), t.size(3)};
+}
+
+// Sizes of the tensor holding an NCHW tensor of the given sizes with the
+// given channel_block
+inline std::vector<int64_t> blocked_sizes(IntList nchw, int32_t block) {
+  if (block == 0) {
+    return nchw;
+  }
+  AT_CHECK(nchw[1] % block == 0, "the ", nchw[1], " channels are not a multiple of the block size ", block);
+  return {nchw[0], nchw[1] / block, nchw[2], nchw[3], block};
+}
+
+// A primitive bound to "user" memory, i.e. memory in the layouts of the ATen
+// tensors, together with the reorders to and from the layouts the primitive
+// prefers. Making the primitive descriptors and primitives costs more than
+// running them on small inputs, so they are made once per shape and only the
+// user buffers are swapped in on every run.
+struct PrimitiveNet {
+  // Returns the memory the primitive should read for the user memory with
+  // primitive descriptor usr_pd, reordering into it when pd differs
+  memory input(const memory::primitive_desc& usr_pd, const memory::primitive_desc& pd) {
+    user_memory.emplace_back(usr_pd, nullptr);
+    if (usr_pd == pd) {
+      return user_memory.back();
+    }
+    memory m(pd);
+    net.push_back(reorder(user_memory.back(), m));
+    return m;
+  }
+
+  // Returns the memory the primitive should write for the user memory with
+  // primitive descriptor usr_pd; the reorder back runs after the primitive
+  memory output(const memory::primitive_desc& usr_pd, const memory::primitive_desc& pd) {
+    user_memory.emplace_back(usr_pd, nullptr);
+    if (usr_pd == pd) {
+      return user_memory.back();
+    }
+    memory m(pd);
+    output_reorders.push_back(reorder(m, user_memory.back()));
+    return m;
+  }
+
+  void add(const primitive& p) {
+    net.push_back(p);
+    net.insert(net.end(), output_reorders.begin(), output_reorders.end());
+    output_reorders.clear();
+  }
+
+  // handles are the buffers of the user memory, in the order it was added
+  void run(const std::vector<void*>& handles) {
+    // The intermediate buffers are shared by every run
+    std::lock_guard<std::mutex> guard(mutex);
+    for (size_t i = 0; i < handles.size(); ++i) {
+      user_memory[i].set_data_handle(handles[i]);
+    }
+    Stream::Instance().get_stream().submit(net);
+  }
+
+private:
+  std::mutex mutex;
+  std::vector<memory> user_memory;
+  std::vector<primitive> net;
+  std::vector<primitive> output_reorders;
+};
+
+// Cache of primitives keyed by their parameters. A model only runs a handful
+// of shapes, so nothing is ever evicted.
+//
+// Params must be a POD struct, which is hashed and compared bytewise, so it
+// must be memset to zero before being filled in.
+template <typename Params, typename Entry>
+class PrimitiveCache {
+  static_assert(std::is_pod<Params>::value, "PrimitiveCache params must be a POD");
+
+public:
+  // Returns the entry made by make_entry(params), making it on a miss
+  std::shared_ptr<Entry> get(const Params& params,
+                             const std::function<std::shared_ptr<Entry>(const Params&)>& make_entry) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    auto it = map_.find(params);
+    if (it != map_.end()) {
+      return it->second;
+    }
+    auto entry = make_entry(params);
+    map_[params] = entry;
+    return entry;
+  }
+
+private:
+  struct ParamsHash {
+    size_t operator()(const Params& params) const {
+      auto ptr = reinterpret_cast<const uint8_t*>(&params);
+      uint32_t value = 0x811C9DC5;
+      for (size_t i = 0; i < sizeof(Params); ++i) {
+        value ^= ptr[i];
+        value *= 0x01000193;
+      }
+      return (size_t)value;
+    }
+  };
+
+  struct ParamsEqual {
+    bool operator()(const Params& a, const Params& b) const {
+      return memcmp(&a, &b, sizeof(Params)) == 0;
+    }
+  };
+
+  std::mutex mutex_;
+  std::unordered_map<Params, std::shared_ptr<Entry>, ParamsHash, ParamsEqual> map_;
+};
+
 }}  // namespace at::native
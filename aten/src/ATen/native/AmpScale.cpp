@@ -0,0 +1,70 @@
+#include "ATen/ATen.h"
+#include "ATen/Dispatch.h"
+#include "ATen/NativeFunctions.h"
+#include "ATen/native/AmpScale.h"
+
+#include <vector>
+
+namespace at { namespace native {
+
+namespace {
+
+void check_scalar_tensor(const char* name, const char* arg, const Tensor& t, ScalarType type,
+                         const Tensor& other) {
+  AT_CHECK(t.type().scalarType() == type && t.numel() == 1,
+           name, ": expected ", arg, " to be a ", toString(type), " tensor of one element");
+  AT_CHECK(t.is_cuda() == other.is_cuda() && (!t.is_cuda() || t.get_device() == other.get_device()),
+           name, ": expected ", arg, " to be on the device of the other tensors");
+}
+
+} // anonymous namespace
+
+void check_amp_unscale_tensors(TensorList grads, const Tensor& found_inf, const Tensor& inv_scale) {
+  check_scalar_tensor("_amp_unscale", "found_inf", found_inf, kFloat, inv_scale);
+  check_scalar_tensor("_amp_unscale", "inv_scale", inv_scale, kFloat, found_inf);
+  if (grads.size() > 0) {
+    check_fused_optimizer_lists("_amp_unscale", {grads, grads});
+    check_scalar_tensor("_amp_unscale", "found_inf", found_inf, kFloat, grads[0]);
+  }
+}
+
+void check_amp_update_scale_tensors(
+    const Tensor& growth_tracker, const Tensor& current_scale, const Tensor& found_inf) {
+  check_scalar_tensor("_amp_update_scale", "growth_tracker", growth_tracker, kInt, current_scale);
+  check_scalar_tensor("_amp_update_scale", "current_scale", current_scale, kFloat, found_inf);
+  check_scalar_tensor("_amp_update_scale", "found_inf", found_inf, kFloat, growth_tracker);
+}
+
+std::vector<Tensor> _amp_unscale_cpu(TensorList grads, const Tensor& found_inf,
+                                     const Tensor& inv_scale) {
+  check_amp_unscale_tensors(grads, found_inf, inv_scale);
+  if (grads.size() == 0) {
+    return {};
+  }
+  AT_DISPATCH_FLOATING_TYPES(grads[0].type(), "_amp_unscale", [&] {
+    AmpUnscale<scalar_t> op{found_inf.data<float>(), inv_scale.data<float>()};
+    for (auto& grad : grads) {
+      scalar_t* data = grad.data<scalar_t>();
+      scalar_t v[2];
+      for (int64_t i = 0; i < grad.numel(); i++) {
+        v[0] = data[i];
+        op(v);
+        data[i] = v[1];
+      }
+    }
+  });
+  return grads.vec();
+}
+
+Tensor _amp_update_scale_cpu(const Tensor& growth_tracker, const Tensor& current_scale,
+                             const Tensor& found_inf, double growth_factor,
+                             double backoff_factor, int64_t growth_interval) {
+  check_amp_update_scale_tensors(growth_tracker, current_scale, found_inf);
+  auto new_scale = current_scale.clone();
+  amp_update_scale(growth_tracker.data<int>(), new_scale.data<float>(), found_inf.data<float>(),
+                   static_cast<float>(growth_factor), static_cast<float>(backoff_factor),
+                   growth_interval);
+  return new_scale;
+}
+
+}} // namespace at::native
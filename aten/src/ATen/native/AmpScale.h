@@ -0,0 +1,55 @@
+#pragma once
+
+#include "ATen/ATen.h"
+#include "ATen/native/FusedOptimizers.h"
+
+#include <cmath>
+
+// Steps of dynamic loss scaling for mixed precision training. The loss is
+// multiplied by a scale before the backward so that small half gradients
+// don't flush to zero; the gradients are then unscaled before the optimizer
+// step, which is skipped if any of them overflowed. Everything is kept on
+// the device, so that only the optimizer step has to look at found_inf.
+
+namespace at { namespace native {
+
+// v = {grad, grad}. Sets *found_inf to 1 if the gradient is an inf or a nan.
+// Every thread that finds one stores the same value, so no atomics are needed.
+template <typename acc_t>
+struct AmpUnscale {
+  float* found_inf;
+  const float* inv_scale;
+
+  FUSED_OPTIMIZER_HOST_DEVICE void operator()(acc_t* v) const {
+    using std::isfinite;
+    if (!isfinite(v[0])) {
+      *found_inf = 1;
+    }
+    v[1] = v[0] * static_cast<acc_t>(*inv_scale);
+  }
+};
+
+// Backs the scale off after an overflow, and grows it after growth_interval
+// steps without one
+FUSED_OPTIMIZER_HOST_DEVICE void amp_update_scale(
+    int* growth_tracker, float* scale, const float* found_inf,
+    float growth_factor, float backoff_factor, int64_t growth_interval) {
+  if (*found_inf) {
+    *scale *= backoff_factor;
+    *growth_tracker = 0;
+  } else if (*growth_tracker + 1 == growth_interval) {
+    *scale *= growth_factor;
+    *growth_tracker = 0;
+  } else {
+    *growth_tracker += 1;
+  }
+}
+
+// Checks that found_inf and inv_scale are floats of one element on the
+// device of the gradients, which are contiguous and all of one type
+void check_amp_unscale_tensors(TensorList grads, const Tensor& found_inf, const Tensor& inv_scale);
+
+void check_amp_update_scale_tensors(
+    const Tensor& growth_tracker, const Tensor& current_scale, const Tensor& found_inf);
+
+}} // namespace at::native
@@ -0,0 +1,127 @@
+#include "ATen/ATen.h"
+#include "ATen/Dispatch.h"
+#include "ATen/NativeFunctions.h"
+#include "ATen/Parallel.h"
+
+#include "ATen/native/LinearAlgebraUtils.h"
+#include "ATen/native/SmallMatrixOps.h"
+
+#include <algorithm>
+#include <vector>
+
+// Batched inverse and potrf. inverse and potrf call the TH (LAPACK, MAGMA)
+// single matrix functions for 2-d inputs; for batches, _inverse_helper and
+// _potrf_helper run the register-resident kernels of SmallMatrixOps.h over
+// the batch when the matrices are small, and otherwise the single matrix
+// function per matrix.
+
+namespace at { namespace native {
+
+namespace {
+
+void checkSquareBatch(const Tensor& self, const char* name) {
+  AT_CHECK(self.dim() >= 2, name, ": expected a tensor with 2 or more dimensions, got ",
+           self.dim(), "-d");
+  AT_CHECK(self.size(-1) == self.size(-2), name, ": expected batches of square matrices, "
+           "but they are ", self.size(-2), " by ", self.size(-1), " matrices");
+}
+
+// Matrices per task of a batch of N x N matrices
+inline int64_t small_matrix_grain_size(int64_t n) {
+  return std::max<int64_t>(1, internal::TBB_GRAIN_SIZE / (n * n * n));
+}
+
+} // namespace
+
+Tensor inverse(const Tensor& self) {
+  if (self.dim() <= 2) {
+    return at::_inverse_single(self);
+  }
+  checkSquareBatch(self, "inverse");
+  return self.type()._inverse_helper(self);
+}
+
+Tensor& inverse_out(Tensor& result, const Tensor& self) {
+  AT_CHECK(self.dim() <= 2, "torch.inverse() with the `out` keyword does not support batching. "
+           "self.dim() (", self.dim(), ") must be 2.");
+  return at::_inverse_single_out(result, self);
+}
+
+Tensor potrf(const Tensor& self, bool upper) {
+  if (self.dim() <= 2) {
+    return at::_potrf_single(self, upper);
+  }
+  checkSquareBatch(self, "potrf");
+  return self.type()._potrf_helper(self, upper);
+}
+
+Tensor& potrf_out(Tensor& result, const Tensor& self, bool upper) {
+  AT_CHECK(self.dim() <= 2, "torch.potrf() with the `out` keyword does not support batching. "
+           "self.dim() (", self.dim(), ") must be 2.");
+  return at::_potrf_single_out(result, self, upper);
+}
+
+Tensor _inverse_helper_cpu(const Tensor& self) {
+  auto input = self.contiguous();
+  auto result = input.type().tensor(input.sizes());
+  int64_t batch_size = batchCount(input);
+  int64_t n = input.size(-1);
+  if (!use_small_matrix_kernels(input)) {
+    auto input_3d = input.view({batch_size, n, n});
+    auto result_3d = result.view({batch_size, n, n});
+    for (int64_t i = 0; i < batch_size; i++) {
+      auto result_i = result_3d[i];
+      at::_inverse_single_out(result_i, input_3d[i]);
+    }
+    return result;
+  }
+
+  std::vector<int64_t> infos(batch_size, 0);
+  AT_DISPATCH_FLOATING_TYPES(input.type(), "inverse", [&] {
+    const scalar_t* input_data = input.data<scalar_t>();
+    scalar_t* result_data = result.data<scalar_t>();
+    AT_DISPATCH_SMALL_MATRIX_SIZE(n, "inverse", [&] {
+      parallel_for(0, batch_size, small_matrix_grain_size(N), [&](int64_t begin, int64_t end) {
+        for (int64_t i = begin; i < end; i++) {
+          infos[i] = small_inverse<scalar_t, N>(input_data + i * N * N, result_data + i * N * N);
+        }
+      });
+    });
+  });
+  checkInverseErrors(infos);
+  return result;
+}
+
+Tensor _potrf_helper_cpu(const Tensor& self, bool upper) {
+  auto input = self.contiguous();
+  auto result = input.type().tensor(input.sizes());
+  int64_t batch_size = batchCount(input);
+  int64_t n = input.size(-1);
+  if (!use_small_matrix_kernels(input)) {
+    auto input_3d = input.view({batch_size, n, n});
+    auto result_3d = result.view({batch_size, n, n});
+    for (int64_t i = 0; i < batch_size; i++) {
+      auto result_i = result_3d[i];
+      at::_potrf_single_out(result_i, input_3d[i], upper);
+    }
+    return result;
+  }
+
+  std::vector<int64_t> infos(batch_size, 0);
+  AT_DISPATCH_FLOATING_TYPES(input.type(), "potrf", [&] {
+    const scalar_t* input_data = input.data<scalar_t>();
+    scalar_t* result_data = result.data<scalar_t>();
+    AT_DISPATCH_SMALL_MATRIX_SIZE(n, "potrf", [&] {
+      parallel_for(0, batch_size, small_matrix_grain_size(N), [&](int64_t begin, int64_t end) {
+        for (int64_t i = begin; i < end; i++) {
+          infos[i] = small_potrf<scalar_t, N>(input_data + i * N * N, result_data + i * N * N,
+                                              upper);
+        }
+      });
+    });
+  });
+  checkPotrfErrors(infos);
+  return result;
+}
+
+}}  // namespace at::native
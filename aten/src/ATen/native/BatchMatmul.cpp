@@ -0,0 +1,207 @@
+// Batched matrix multiplication on the CPU. TH's baddbmm selects every
+// matrix of the batch into a new tensor and calls addmm on it, one after the
+// other, so a batch of many small matrices (e.g. batch x heads in an
+// attention layer) pays that overhead per matrix and runs on one thread.
+// bmm works on raw pointers instead: with MKL, float and double batches go
+// through a single cblas_?gemm_batch call; otherwise the batch is split
+// over threads, each multiplying its matrices with THBlas gemm. Large
+// matrices are multiplied one after the other, leaving the parallelism to
+// BLAS. Other types are forwarded to TH.
+
+#include "ATen/ATen.h"
+#include "ATen/Config.h"
+#include "ATen/Dispatch.h"
+#include "ATen/NativeFunctions.h"
+#include "ATen/Parallel.h"
+
+#include <TH/THBlas.h>
+
+#include <algorithm>
+#include <vector>
+
+#if AT_MKL_ENABLED()
+#include <mkl.h>
+#endif
+
+namespace at { namespace native {
+
+namespace {
+
+// Multiply-adds per matrix below which a product is too small to be worth
+// more than one thread, and threads take whole matrices of the batch
+constexpr int64_t kSmallGemmWork = 64 * 64 * 64;
+
+// The layout of one matrix of a batch as BLAS sees it in row-major order:
+// either the matrix itself (trans == false) or its transpose, with leading
+// dimension ld.
+struct BlasLayout {
+  bool trans;
+  int64_t ld;
+};
+
+bool blas_layout(const Tensor& batch, BlasLayout& layout) {
+  int64_t rows = batch.size(1), cols = batch.size(2);
+  int64_t row_stride = batch.stride(1), col_stride = batch.stride(2);
+  if (col_stride == 1 && row_stride >= std::max<int64_t>(1, cols)) {
+    layout = {false, row_stride};
+    return true;
+  }
+  if (row_stride == 1 && col_stride >= std::max<int64_t>(1, rows)) {
+    layout = {true, col_stride};
+    return true;
+  }
+  return false;
+}
+
+template <typename scalar_t>
+void gemm(bool transa, bool transb, int64_t m, int64_t n, int64_t k,
+          scalar_t* a, int64_t lda, scalar_t* b, int64_t ldb, scalar_t* c, int64_t ldc);
+
+// THBlas is column-major: the row-major C = A B is computed as the
+// column-major C^T = B^T A^T.
+template <>
+void gemm<float>(bool transa, bool transb, int64_t m, int64_t n, int64_t k,
+                 float* a, int64_t lda, float* b, int64_t ldb, float* c, int64_t ldc) {
+  THFloatBlas_gemm(transb ? 't' : 'n', transa ? 't' : 'n', n, m, k,
+                   1, b, ldb, a, lda, 0, c, ldc);
+}
+
+template <>
+void gemm<double>(bool transa, bool transb, int64_t m, int64_t n, int64_t k,
+                  double* a, int64_t lda, double* b, int64_t ldb, double* c, int64_t ldc) {
+  THDoubleBlas_gemm(transb ? 't' : 'n', transa ? 't' : 'n', n, m, k,
+                    1, b, ldb, a, lda, 0, c, ldc);
+}
+
+#if AT_MKL_ENABLED()
+
+template <typename scalar_t>
+void gemm_batch(CBLAS_TRANSPOSE transa, CBLAS_TRANSPOSE transb, MKL_INT m, MKL_INT n,
+                MKL_INT k, const scalar_t** a, MKL_INT lda, const scalar_t** b, MKL_INT ldb,
+                scalar_t** c, MKL_INT ldc, MKL_INT batch_size);
+
+template <>
+void gemm_batch<float>(CBLAS_TRANSPOSE transa, CBLAS_TRANSPOSE transb, MKL_INT m, MKL_INT n,
+                       MKL_INT k, const float** a, MKL_INT lda, const float** b, MKL_INT ldb,
+                       float** c, MKL_INT ldc, MKL_INT batch_size) {
+  float alpha = 1, beta = 0;
+  cblas_sgemm_batch(CblasRowMajor, &transa, &transb, &m, &n, &k, &alpha, a, &lda, b, &ldb,
+                    &beta, c, &ldc, 1, &batch_size);
+}
+
+template <>
+void gemm_batch<double>(CBLAS_TRANSPOSE transa, CBLAS_TRANSPOSE transb, MKL_INT m, MKL_INT n,
+                        MKL_INT k, const double** a, MKL_INT lda, const double** b, MKL_INT ldb,
+                        double** c, MKL_INT ldc, MKL_INT batch_size) {
+  double alpha = 1, beta = 0;
+  cblas_dgemm_batch(CblasRowMajor, &transa, &transb, &m, &n, &k, &alpha, a, &lda, b, &ldb,
+                    &beta, c, &ldc, 1, &batch_size);
+}
+
+#endif
+
+// result = self @ mat2, where result is a row-major (b, m, n) batch and
+// self and mat2 have BLAS compatible layouts
+template <typename scalar_t>
+void bmm_kernel(Tensor& result, const Tensor& self, BlasLayout self_layout,
+                const Tensor& mat2, BlasLayout mat2_layout) {
+  int64_t batch_size = self.size(0);
+  int64_t m = self.size(1), k = self.size(2), n = mat2.size(2);
+  scalar_t* a = self.data<scalar_t>();
+  scalar_t* b = mat2.data<scalar_t>();
+  scalar_t* c = result.data<scalar_t>();
+  int64_t a_stride = self.stride(0), b_stride = mat2.stride(0), c_stride = result.stride(0);
+  int64_t ldc = result.stride(1);
+#if AT_MKL_ENABLED()
+  std::vector<const scalar_t*> a_array(batch_size), b_array(batch_size);
+  std::vector<scalar_t*> c_array(batch_size);
+  for (int64_t i = 0; i < batch_size; ++i) {
+    a_array[i] = a + i * a_stride;
+    b_array[i] = b + i * b_stride;
+    c_array[i] = c + i * c_stride;
+  }
+  gemm_batch<scalar_t>(self_layout.trans ? CblasTrans : CblasNoTrans,
+                       mat2_layout.trans ? CblasTrans : CblasNoTrans,
+                       m, n, k, a_array.data(), self_layout.ld, b_array.data(), mat2_layout.ld,
+                       c_array.data(), ldc, batch_size);
+#else
+  auto multiply = [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; ++i) {
+      gemm<scalar_t>(self_layout.trans, mat2_layout.trans, m, n, k,
+                     a + i * a_stride, self_layout.ld, b + i * b_stride, mat2_layout.ld,
+                     c + i * c_stride, ldc);
+    }
+  };
+  int64_t work = m * n * k;
+  if (work >= kSmallGemmWork) {
+    multiply(0, batch_size);
+  } else {
+    parallel_for(0, batch_size, std::max<int64_t>(1, kSmallGemmWork / std::max<int64_t>(1, work)),
+                 multiply);
+  }
+#endif
+}
+
+void check_bmm_args(const Tensor& self, const Tensor& mat2) {
+  AT_CHECK(self.dim() == 3, "bmm: expected 3D tensor, got ", self.dim(), "D");
+  AT_CHECK(mat2.dim() == 3, "bmm: expected 3D tensor, got ", mat2.dim(), "D");
+  AT_CHECK(self.size(0) == mat2.size(0), "bmm: equal number of batches expected, got ",
+           self.size(0), ", ", mat2.size(0));
+  AT_CHECK(self.size(2) == mat2.size(1), "bmm: wrong matrix size, batch1: ",
+           self.size(1), "x", self.size(2), ", batch2: ", mat2.size(1), "x", mat2.size(2));
+}
+
+} // namespace
+
+Tensor _bmm_cpu(const Tensor& self, const Tensor& mat2) {
+  Tensor result = self.type().tensor();
+  return _bmm_out_cpu(result, self, mat2);
+}
+
+Tensor& _bmm_out_cpu(Tensor& result, const Tensor& self, const Tensor& mat2) {
+  auto scalar_type = self.type().scalarType();
+  if ((scalar_type != kFloat && scalar_type != kDouble) ||
+      mat2.type() != self.type() || result.type() != self.type()) {
+    return at::_th_bmm_out(result, self, mat2);
+  }
+  check_bmm_args(self, mat2);
+  result.resize_({self.size(0), self.size(1), mat2.size(2)});
+  if (result.numel() == 0) {
+    return result;
+  }
+  if (self.size(2) == 0) {
+    return result.zero_();
+  }
+
+  BlasLayout self_layout, mat2_layout, result_layout;
+  Tensor a = self, b = mat2;
+  if (!blas_layout(a, self_layout)) {
+    a = a.contiguous();
+    blas_layout(a, self_layout);
+  }
+  if (!blas_layout(b, mat2_layout)) {
+    b = b.contiguous();
+    blas_layout(b, mat2_layout);
+  }
+  bool result_ok = blas_layout(result, result_layout) && !result_layout.trans &&
+                   result.stride(0) >= result.size(1) * result_layout.ld;
+  Tensor c = result_ok ? result : result.type().tensor(result.sizes());
+
+  AT_DISPATCH_FLOATING_TYPES(self.type(), "bmm", [&] {
+    bmm_kernel<scalar_t>(c, a, self_layout, b, mat2_layout);
+  });
+  if (!result_ok) {
+    result.copy_(c);
+  }
+  return result;
+}
+
+Tensor _bmm_cuda(const Tensor& self, const Tensor& mat2) {
+  return at::_th_bmm(self, mat2);
+}
+
+Tensor& _bmm_out_cuda(Tensor& result, const Tensor& self, const Tensor& mat2) {
+  return at::_th_bmm_out(result, self, mat2);
+}
+
+}} // namespace at::native
@@ -0,0 +1,134 @@
+#include "ATen/ATen.h"
+#include "ATen/NativeFunctions.h"
+#include "ATen/native/PoolingUtils.h"
+#include "ATen/native/cpu/ChannelsLastKernel.h"
+
+#include <cmath>
+#include <tuple>
+
+// The channels-last memory format: 4-d tensors of size (N, C, H, W) laid out
+// as contiguous (N, H, W, C) tensors, which is what the ops on pixels (e.g.
+// pooling and batch norm) read most efficiently. Such tensors are ordinary
+// strided tensors, so every op accepts them; the ops below don't transpose
+// them to NCHW first, and keep their outputs in the same format.
+
+namespace at { namespace native {
+
+namespace {
+
+Tensor empty_channels_last(const Type& type, IntList sizes) {
+  return type.tensor({sizes[0], sizes[2], sizes[3], sizes[1]}).permute({0, 3, 1, 2});
+}
+
+void check_channels_last_cpu(const char* name, const Tensor& input) {
+  AT_CHECK(input.type().backend() == kCPU, name, ": expected a CPU tensor, got ", input.toString());
+  AT_CHECK(input.is_channels_last(), name, ": expected a channels-last tensor, got strides ",
+           input.strides(), " for size ", input.sizes());
+}
+
+} // namespace
+
+bool is_channels_last(const Tensor& self) {
+  if (self.dim() != 4 || self.is_contiguous()) {
+    // NB: tensors with a single channel or pixel are NCHW contiguous too
+    return false;
+  }
+  int64_t expected[4] = {self.size(1) * self.size(2) * self.size(3), 1,
+                         self.size(3) * self.size(1), self.size(1)};
+  for (int64_t d = 0; d < 4; d++) {
+    if (self.size(d) != 1 && self.stride(d) != expected[d]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+Tensor channels_last_contiguous(const Tensor& self) {
+  AT_CHECK(self.dim() == 4, "channels_last_contiguous: expected a 4-d tensor, got ", self.dim(), "-d");
+  if (self.is_channels_last()) {
+    return self;
+  }
+  return self.permute({0, 2, 3, 1}).contiguous().permute({0, 3, 1, 2});
+}
+
+std::tuple<Tensor, Tensor> _max_pool2d_channels_last_cpu(
+    const Tensor& self, IntList kernel_size, IntList stride, IntList padding,
+    IntList dilation, bool ceil_mode) {
+  check_channels_last_cpu("_max_pool2d_channels_last", self);
+  std::vector<int64_t> output_size = {self.size(0), self.size(1), 0, 0};
+  for (int64_t d = 0; d < 2; d++) {
+    output_size[d + 2] = pooling_output_size("_max_pool2d_channels_last", self.size(d + 2),
+                                             kernel_size[d], stride[d], padding[d],
+                                             dilation[d], ceil_mode);
+  }
+  auto output = empty_channels_last(self.type(), output_size);
+  auto indices = empty_channels_last(self.type().toScalarType(kLong), output_size);
+  max_pool2d_channels_last_kernel(output, indices, self, kernel_size[0], kernel_size[1],
+                                  stride[0], stride[1], padding[0], padding[1],
+                                  dilation[0], dilation[1]);
+  return std::make_tuple(output, indices);
+}
+
+Tensor _avg_pool2d_channels_last_cpu(
+    const Tensor& self, IntList kernel_size, IntList stride, IntList padding,
+    bool ceil_mode, bool count_include_pad) {
+  check_channels_last_cpu("_avg_pool2d_channels_last", self);
+  std::vector<int64_t> output_size = {self.size(0), self.size(1), 0, 0};
+  for (int64_t d = 0; d < 2; d++) {
+    output_size[d + 2] = pooling_output_size("_avg_pool2d_channels_last", self.size(d + 2),
+                                             kernel_size[d], stride[d], padding[d], 1,
+                                             ceil_mode);
+  }
+  auto output = empty_channels_last(self.type(), output_size);
+  avg_pool2d_channels_last_kernel(output, self, kernel_size[0], kernel_size[1],
+                                  stride[0], stride[1], padding[0], padding[1],
+                                  count_include_pad);
+  return output;
+}
+
+// Returns the output, and the save_mean and save_std (i.e. reciprocal
+// standard deviation) of thnn_batch_norm, which are empty in evaluation mode
+std::tuple<Tensor, Tensor, Tensor> _batch_norm_channels_last_cpu(
+    const Tensor& input, const Tensor& weight /* optional */, const Tensor& bias /* optional */,
+    const Tensor& running_mean /* optional */, const Tensor& running_var /* optional */,
+    bool training, double momentum, double eps) {
+  check_channels_last_cpu("_batch_norm_channels_last", input);
+  auto num_features = input.size(1);
+
+  Tensor mean, invstd, save_mean, save_std;
+  if (training) {
+    mean = input.type().tensor({num_features});
+    auto var = input.type().tensor({num_features});
+    channels_last_moments_kernel(mean, var, input);
+    invstd = (var + eps).rsqrt();
+    save_mean = mean;
+    save_std = invstd;
+    auto n = input.numel() / num_features;
+    // The running statistics are updated in place, like in thnn_batch_norm
+    if (running_mean.defined()) {
+      Tensor running_mean_ = running_mean;
+      running_mean_.mul_(1 - momentum).add_(mean, momentum);
+    }
+    if (running_var.defined()) {
+      // The running variance is unbiased
+      Tensor running_var_ = running_var;
+      running_var_.mul_(1 - momentum).add_(var, momentum * n / (n - 1));
+    }
+  } else {
+    AT_CHECK(running_mean.defined() && running_var.defined(),
+             "_batch_norm_channels_last: running_mean and running_var must be defined in evaluation mode");
+    mean = running_mean;
+    invstd = (running_var + eps).rsqrt();
+    save_mean = input.type().tensor({0});
+    save_std = input.type().tensor({0});
+  }
+
+  // y = (x - mean) * invstd * weight + bias = x * scale + shift
+  auto scale = weight.defined() ? invstd * weight : invstd;
+  auto shift = bias.defined() ? bias - mean * scale : -mean * scale;
+  auto output = empty_channels_last(input.type(), input.sizes());
+  channels_last_affine_kernel(output, input, scale.contiguous(), shift.contiguous());
+  return std::make_tuple(output, save_mean, save_std);
+}
+
+}} // namespace at::native
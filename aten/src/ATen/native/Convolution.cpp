@@ -25,6 +25,7 @@ struct ConvParams {
   void view1d_as_2d();
   bool use_cudnn(const at::Tensor& input) const;
   bool use_mkldnn(const at::Tensor& input) const;
+  bool use_nnpack(const at::Tensor& input, const at::Tensor& weight) const;
   bool is_depthwise(const at::Tensor& input, const at::Tensor& weight) const;
 };
 
@@ -130,13 +131,32 @@ auto ConvParams::use_mkldnn(const at::Tensor& input) const -> bool {
   return false;
 }
 
+// NNPACK only computes undilated stride 1 convolutions; we use it for 3x3
+// kernels, where its Winograd F(6x6, 3x3) algorithm beats im2col + GEMM
+auto ConvParams::use_nnpack(const at::Tensor& input, const at::Tensor& weight) const -> bool {
+#if AT_NNPACK_ENABLED()
+  return input.type().backend() == kCPU &&
+         input.type().scalarType() == kFloat && // only on CPU Float Tensors
+         input.type() == weight.type() &&
+         !is_strided() && // doesn't support strides
+         !is_dilated() && // or dilation
+         !transposed && // or transposed tensors
+         input.ndimension() == 4 && // must be in NCHW format
+         groups == 1 &&
+         weight.size(2) == 3 && weight.size(3) == 3 &&
+         padding[0] < 3 && padding[1] < 3 && // padding must be smaller than the kernel
+         hasNNPACK();
+#endif
+  return false;
+}
+
 // We currently only have depthwise support for the case where groups ==
-// nInputPlane and nInputPlane == nOutputPlane (the latter due to the lack of
-// a depthwise multiplier)
+// nInputPlane and nOutputPlane is a multiple of nInputPlane (i.e. with a
+// depthwise multiplier): thnn_conv_depthwise2d on CUDA and the direct
+// _depthwise_conv2d kernels on CPU
 auto ConvParams::is_depthwise(
         const at::Tensor& input, const at::Tensor& weight) const -> bool {
-  return input.type().is_cuda() &&
-         !transposed &&
+  return !transposed &&
          input.ndimension() == 4 &&
          input.size(1) == groups &&
          groups > 1 && // no point if there is only a single group
@@ -286,6 +306,23 @@ static inline std::vector<int64_t> convolution_expand_param_if_needed(
   }
 }
 
+static ConvParams make_conv_params(
+    IntList stride_, IntList padding_, IntList dilation_,
+    bool transposed_, IntList output_padding_, int64_t groups_,
+    bool benchmark, bool deterministic, bool cudnn_enabled, int64_t dim) {
+  ConvParams params;
+  params.stride = convolution_expand_param_if_needed(stride_, "stride", dim);
+  params.padding = convolution_expand_param_if_needed(padding_, "padding", dim);
+  params.dilation = convolution_expand_param_if_needed(dilation_, "dilation", dim);
+  params.transposed = transposed_;
+  params.output_padding = convolution_expand_param_if_needed(output_padding_, "output_padding", dim);
+  params.groups = groups_;
+  params.benchmark = benchmark;
+  params.deterministic = deterministic;
+  params.cudnn_enabled = cudnn_enabled;
+  return params;
+}
+
 at::Tensor _convolution(
     const Tensor& input_r, const Tensor& weight_r, const Tensor& bias_r,
     IntList stride_, IntList padding_, IntList dilation_,
@@ -302,16 +339,9 @@ at::Tensor _convolution(
     throw std::runtime_error("input has less dimensions than expected");
   }
 
-  ConvParams params;
-  params.stride = convolution_expand_param_if_needed(stride_, "stride", dim);
-  params.padding = convolution_expand_param_if_needed(padding_, "padding", dim);
-  params.dilation = convolution_expand_param_if_needed(dilation_, "dilation", dim);
-  params.transposed = transposed_;
-  params.output_padding = convolution_expand_param_if_needed(output_padding_, "output_padding", dim);
-  params.groups = groups_;
-  params.benchmark = benchmark;
-  params.deterministic = deterministic;
-  params.cudnn_enabled = cudnn_enabled;
+  auto params = make_conv_params(
+      stride_, padding_, dilation_, transposed_, output_padding_, groups_,
+      benchmark, deterministic, cudnn_enabled, dim);
 
   if (params.is_padding_neg()) throw std::runtime_error("negative padding is not supported");
   if (params.is_output_padding_neg()) throw std::runtime_error("negative output_padding is not supported");
@@ -334,7 +364,11 @@ at::Tensor _convolution(
       auto padding = params.padding;
       auto dilation = params.dilation;
 
-      output = at::thnn_conv_depthwise2d(input, weight, kernel_size, bias, stride, padding, dilation);
+      if (input.type().is_cuda()) {
+        output = at::thnn_conv_depthwise2d(input, weight, kernel_size, bias, stride, padding, dilation);
+      } else {
+        output = at::_depthwise_conv2d(input, weight, bias, stride, padding, dilation);
+      }
   } else if (params.use_cudnn(input)) {
     if (input.type() != weight.type()){
       std::stringstream ss;
@@ -371,10 +405,15 @@ at::Tensor _convolution(
 
     output = at::mkldnn_convolution(input, weight, bias, params.padding, params.stride, params.dilation);
 #endif
+  } else if (params.use_nnpack(input, weight)) {
+    output = at::_nnpack_spatial_convolution(input, weight, bias, params.padding);
   } else {
     if (params.groups == 1) {
       output = at::_convolution_nogroup(
           input, weight, bias, params.stride, params.padding, params.dilation, params.transposed, params.output_padding);
+    } else if (input.type().backend() == kCPU && !params.transposed && input.ndimension() == 4) {
+      output = at::_grouped_conv2d(
+          input, weight, bias, params.stride, params.padding, params.dilation, params.groups);
     } else {
       std::vector<Tensor> outputs(params.groups);
       for (int g = 0; g < params.groups; ++g) {
@@ -395,6 +434,42 @@ at::Tensor _convolution(
   return output;
 }
 
+// _convolution followed by relu. cuDNN and MKL-DNN apply the ReLU while they
+// write the output, the other backends run relu_ on it. The JIT fuses the
+// two in inference graphs (see FuseConvRelu); neither fused kernel has a
+// backward for all of its arguments.
+at::Tensor _convolution_relu(
+    const Tensor& input_r, const Tensor& weight, const Tensor& bias,
+    IntList stride_, IntList padding_, IntList dilation_,
+    bool transposed_, IntList output_padding_, int64_t groups_,
+    bool benchmark, bool deterministic, bool cudnn_enabled) {
+
+  auto input = input_r.contiguous();
+  int64_t dim = input.ndimension() - 2;
+
+  if (dim >= 2 && !transposed_ &&
+      input.type() == weight.type() && (!bias.defined() || input.type() == bias.type())) {
+    auto params = make_conv_params(
+        stride_, padding_, dilation_, transposed_, output_padding_, groups_,
+        benchmark, deterministic, cudnn_enabled, dim);
+    if (!params.is_padding_neg() && !params.is_depthwise(input, weight)) {
+      if (params.use_cudnn(input)) {
+        return at::cudnn_convolution_relu(
+            input, weight, bias,
+            params.padding, params.stride, params.dilation, params.groups, params.benchmark, params.deterministic);
+      }
+      if (params.use_mkldnn(input)) {
+        return at::mkldnn_convolution_relu(input, weight, bias, params.padding, params.stride, params.dilation);
+      }
+    }
+  }
+
+  auto output = at::_convolution(
+      input, weight, bias, stride_, padding_, dilation_, transposed_, output_padding_, groups_,
+      benchmark, deterministic, cudnn_enabled);
+  return output.relu_();
+}
+
 // A generic function for convolution implementations which don't
 // natively implement groups (e.g., not CuDNN).
 at::Tensor _convolution_nogroup(
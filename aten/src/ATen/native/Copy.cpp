@@ -0,0 +1,20 @@
+#include "ATen/native/Copy.h"
+
+#include "ATen/native/cpu/CopyKernel.h"
+
+namespace at { namespace native {
+
+// TH's copy between scalar types is a serial element by element loop;
+// copy_kernel converts in parallel, with contiguous inner loops the compiler
+// vectorizes and tiles for transposes. It needs the sizes of the tensors to
+// match, which they do after the expand of copy_, where TH only needs the
+// numbers of elements to.
+bool copy_convert_cpu(Tensor& dst, const Tensor& src) {
+  if (!dst.sizes().equals(src.sizes())) {
+    return false;
+  }
+  copy_kernel(dst, src);
+  return true;
+}
+
+}} // namespace at::native
@@ -0,0 +1,12 @@
+#pragma once
+
+#include "ATen/ATen.h"
+
+namespace at { namespace native {
+
+// Called by the generated s_copy_ of the CPU types for copies from a CPU
+// tensor of another scalar type: converts src into dst with copy_kernel and
+// returns true, or returns false without copying for TH's copy to do it.
+bool copy_convert_cpu(Tensor& dst, const Tensor& src);
+
+}} // namespace at::native
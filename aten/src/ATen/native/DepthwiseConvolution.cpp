@@ -0,0 +1,83 @@
+#include "ATen/ATen.h"
+#include "ATen/NativeFunctions.h"
+#include "ATen/native/cpu/DepthwiseConvolutionKernel.h"
+
+#include <tuple>
+
+namespace at { namespace native {
+
+namespace {
+
+void check_depthwise_conv2d_args(const Tensor& input, const Tensor& weight,
+                                 IntList stride, IntList padding, IntList dilation) {
+  AT_CHECK(input.dim() == 4, "_depthwise_conv2d: expected a 4-d input, got ", input.dim(), "-d");
+  AT_CHECK(weight.dim() == 4 && weight.size(1) == 1,
+           "_depthwise_conv2d: expected a weight of size (C * m, 1, kH, kW), got ", weight.sizes());
+  AT_CHECK(weight.size(0) % input.size(1) == 0,
+           "_depthwise_conv2d: expected the ", weight.size(0), " filters to be a multiple of the ",
+           input.size(1), " input channels");
+  AT_CHECK(input.type() == weight.type(), "_depthwise_conv2d: expected input and weight of the same type, got ",
+           input.toString(), " and ", weight.toString());
+  for (int64_t d = 0; d < 2; d++) {
+    AT_CHECK(stride[d] > 0 && dilation[d] > 0 && padding[d] >= 0,
+             "_depthwise_conv2d: expected positive stride and dilation and non-negative padding");
+  }
+}
+
+int64_t output_size(int64_t input_size, int64_t kernel, int64_t stride,
+                    int64_t padding, int64_t dilation) {
+  return (input_size + 2 * padding - dilation * (kernel - 1) - 1) / stride + 1;
+}
+
+} // namespace
+
+Tensor _depthwise_conv2d_cpu(
+    const Tensor& self, const Tensor& weight, const Tensor& bias /* optional */,
+    IntList stride, IntList padding, IntList dilation) {
+  check_depthwise_conv2d_args(self, weight, stride, padding, dilation);
+  auto input = self.contiguous();
+  auto weight_ = weight.contiguous();
+  Tensor bias_;
+  if (bias.defined()) {
+    AT_CHECK(bias.dim() == 1 && bias.size(0) == weight.size(0),
+             "_depthwise_conv2d: expected a bias of ", weight.size(0), " elements, got ", bias.sizes());
+    AT_CHECK(bias.type() == self.type(), "_depthwise_conv2d: expected input and bias of the same type, got ",
+             self.toString(), " and ", bias.toString());
+    bias_ = bias.contiguous();
+  }
+  auto oH = output_size(input.size(2), weight.size(2), stride[0], padding[0], dilation[0]);
+  auto oW = output_size(input.size(3), weight.size(3), stride[1], padding[1], dilation[1]);
+  AT_CHECK(oH > 0 && oW > 0, "_depthwise_conv2d: the input of size ", input.sizes(),
+           " is too small for the filters of size ", weight.sizes());
+  auto output = input.type().tensor({input.size(0), weight.size(0), oH, oW});
+  depthwise_conv2d_kernel(output, input, weight_, bias_, stride[0], stride[1],
+                          padding[0], padding[1], dilation[0], dilation[1]);
+  return output;
+}
+
+std::tuple<Tensor, Tensor, Tensor> _depthwise_conv2d_backward_cpu(
+    const Tensor& grad_output, const Tensor& self, const Tensor& weight,
+    IntList stride, IntList padding, IntList dilation, std::array<bool, 3> output_mask) {
+  check_depthwise_conv2d_args(self, weight, stride, padding, dilation);
+  auto grad_output_ = grad_output.contiguous();
+
+  Tensor grad_input, grad_weight, grad_bias;
+  if (output_mask[0]) {
+    grad_input = self.type().tensor(self.sizes());
+    depthwise_conv2d_backward_input_kernel(grad_input, grad_output_, weight.contiguous(),
+                                           stride[0], stride[1], padding[0], padding[1],
+                                           dilation[0], dilation[1]);
+  }
+  if (output_mask[1]) {
+    grad_weight = weight.type().tensor(weight.sizes());
+    depthwise_conv2d_backward_weight_kernel(grad_weight, grad_output_, self.contiguous(),
+                                            stride[0], stride[1], padding[0], padding[1],
+                                            dilation[0], dilation[1]);
+  }
+  if (output_mask[2]) {
+    grad_bias = grad_output_.sum({0, 2, 3});
+  }
+  return std::make_tuple(grad_input, grad_weight, grad_bias);
+}
+
+}} // namespace at::native
@@ -4,7 +4,49 @@
 
 namespace at { namespace native {
 
+// Bounds the number of elements of the N x M x D differences that are
+// materialized at once by cdist for p != 2
+static constexpr int64_t kCdistChunkElements = 1 << 22;
+
 Tensor pairwise_distance(const Tensor& x1, const Tensor& x2, double p, double eps, bool keepdim) {
   return norm(x1 - x2 + eps, p, 1, keepdim);
 }
+
+Tensor cdist(const Tensor& x1, const Tensor& x2, double p) {
+  AT_CHECK(x1.dim() == 2 && x2.dim() == 2,
+           "cdist only supports 2D tensors, got: ", x1.dim(), "D and ", x2.dim(), "D");
+  AT_CHECK(x1.size(1) == x2.size(1),
+           "X1 and X2 must have the same number of columns, got: ", x1.size(1), " and ", x2.size(1));
+  AT_CHECK(p >= 0, "cdist only supports non-negative p values");
+  int64_t n = x1.size(0);
+  int64_t m = x2.size(0);
+  int64_t d = x1.size(1);
+
+  if (p == 2) {
+    // ||x - y||^2 = ||x||^2 + ||y||^2 - 2 x y^T turns the distances into a
+    // GEMM. Both sets are centered first: the distances are unchanged, but the
+    // norms are smaller, which reduces the cancellation in the difference.
+    auto mean = x2.mean(0, true);
+    auto x1c = x1 - mean;
+    auto x2c = x2 - mean;
+    auto x1_norm = x1c.pow(2).sum(1, true);
+    auto x2_norm = x2c.pow(2).sum(1, true).t();
+    auto result = x1_norm + x2_norm;
+    result.addmm_(x1c, x2c.t(), 1, -2);
+    return result.clamp_min_(0).sqrt_();
+  }
+
+  // Other norms are computed directly on the differences, for chunks of rows
+  // of x1 so that the N x M x D broadcast is never materialized
+  int64_t rows = std::max<int64_t>(1, kCdistChunkElements / std::max<int64_t>(1, m * d));
+  if (rows >= n) {
+    return norm(x1.unsqueeze(1) - x2.unsqueeze(0), p, 2, false);
+  }
+  std::vector<Tensor> chunks;
+  for (int64_t i = 0; i < n; i += rows) {
+    auto x1_chunk = x1.narrow(0, i, std::min(rows, n - i));
+    chunks.push_back(norm(x1_chunk.unsqueeze(1) - x2.unsqueeze(0), p, 2, false));
+  }
+  return at::cat(chunks, 0);
+}
 }}  // namespace at::native
@@ -4,13 +4,17 @@
 #include "ATen/Error.h"
 #include "ATen/ExpandUtils.h"
 #include "ATen/NativeFunctions.h"
+#include "ATen/Parallel.h"
 
 #include "ATen/CPUGenerator.h"
 #include "ATen/CheckGenerator.h"
 #include "ATen/Generator.h"
 #include "ATen/native/Distributions.h"
 
+#include <algorithm>
+#include <cmath>
 #include <functional>
+#include <vector>
 
 #include "TH/THRandom.h"
 #include "TH/THGenerator.hpp"
@@ -54,7 +58,8 @@ THGenerator* get_generator(at::Generator* gen) {
   return gen_->generator;
 }
 
-int64_t sample_poisson(double lambda, THGenerator* generator) {
+template <typename Uniform>
+int64_t sample_poisson(double lambda, Uniform& standard_uniform) {
   if (lambda >= 10) {
     // transformed rejection method, (Hoermann, 1993)
     int64_t k;
@@ -68,8 +73,8 @@ int64_t sample_poisson(double lambda, THGenerator* generator) {
     vr = 0.9277 - 3.6224 / (b - 2);
 
     while (1) {
-      U = THRandom_standard_uniform(generator) - 0.5;
-      V = THRandom_standard_uniform(generator);
+      U = standard_uniform() - 0.5;
+      V = standard_uniform();
       us = 0.5 - std::fabs(U);
       k = (int64_t)std::floor((2 * a / us + b) * U + lambda + 0.43);
       if ((us >= 0.07) && (V <= vr)) {
@@ -93,7 +98,7 @@ int64_t sample_poisson(double lambda, THGenerator* generator) {
     X = 0;
     prod = 1.0;
     while (1) {
-      U = THRandom_standard_uniform(generator);
+      U = standard_uniform();
       prod *= U;
       if (prod > enlam) {
         X += 1;
@@ -104,6 +109,87 @@ int64_t sample_poisson(double lambda, THGenerator* generator) {
   }
 }
 
+// The samplers that draw a variable number of uniform numbers per element,
+// like the rejection samplers of gamma and poisson, run in parallel over
+// fixed chunks of kSamplerChunkSize elements. Chunk c reads its own Philox
+// stream, see PhiloxStream, so the samples only depend on the generator and
+// not on the number of threads.
+constexpr int64_t kSamplerChunkSize = 4096;
+
+// A uniform number in [0, 1) with 53 random bits, from two 32 bits words,
+// like THRandom_standard_uniform
+inline double uniform_from_words(uint32_t hi, uint32_t lo) {
+  uint64_t x = ((uint64_t)hi << 32) | lo;
+  return (x >> 11) * (1.0 / (1ULL << 53));
+}
+
+// The uniform numbers of blocks (stream << 32), (stream << 32) + 1, ... of
+// the Philox4x32-10 generator (THRandom_philox4x32) of key
+class PhiloxStream {
+ public:
+  PhiloxStream(uint64_t key, uint64_t stream)
+    : key_(key), counter_(stream << 32) {}
+
+  double standard_uniform() {
+    if (index_ == 4) {
+      THRandom_philox4x32(key_, counter_++, words_);
+      index_ = 0;
+    }
+    double u = uniform_from_words(words_[index_], words_[index_ + 1]);
+    index_ += 2;
+    return u;
+  }
+
+  // Box-Muller transform of two uniform numbers, like THRandom_normal
+  double standard_normal() {
+    if (has_normal_) {
+      has_normal_ = false;
+      return normal_;
+    }
+    double u1 = 1 - standard_uniform(); // (0, 1] for the log
+    double u2 = standard_uniform();
+    double radius = std::sqrt(-2 * std::log(u1));
+    double theta = 2 * M_PI * u2;
+    normal_ = radius * std::sin(theta);
+    has_normal_ = true;
+    return radius * std::cos(theta);
+  }
+
+ private:
+  uint64_t key_;
+  uint64_t counter_;
+  uint32_t words_[4];
+  int index_ = 4;
+  double normal_ = 0;
+  bool has_normal_ = false;
+};
+
+// ret[i] = sample(self[i], stream) for the contiguous ret and self, where
+// stream is the PhiloxStream of the chunk of i
+uint64_t philox_key(at::Generator* gen) {
+  THGenerator* generator = get_generator(gen);
+  std::lock_guard<std::mutex> lock(generator->mutex);
+  return THRandom_random64(generator);
+}
+
+template <typename scalar_t, typename Sample>
+void parallel_sample(at::Tensor& ret, const at::Tensor& self, at::Generator* gen, const Sample& sample) {
+  uint64_t key = philox_key(gen);
+  auto ret_data = ret.data<scalar_t>();
+  auto self_data = self.data<scalar_t>();
+  int64_t numel = ret.numel();
+  int64_t num_chunks = (numel + kSamplerChunkSize - 1) / kSamplerChunkSize;
+  at::parallel_for(0, num_chunks, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t chunk = begin; chunk < end; chunk++) {
+      PhiloxStream stream(key, chunk);
+      int64_t last = std::min(numel, (chunk + 1) * kSamplerChunkSize);
+      for (int64_t i = chunk * kSamplerChunkSize; i < last; i++) {
+        ret_data[i] = sample(self_data[i], stream);
+      }
+    }
+  });
+}
+
 } // namespace
 
 namespace at {
@@ -114,6 +200,10 @@ Tensor& bernoulli_(Tensor& self, const Tensor& p, Generator* generator) {
 }
 
 Tensor& bernoulli_(Tensor& self, double p, Generator* generator) {
+  if (self.type().backend() == kCPU) {
+    // Contiguous tensors are filled in parallel, see THTensor_(bernoulli)
+    return self._bernoulli_(p, generator);
+  }
   Tensor probs = self.type().toScalarType(kDouble).tensor({}).fill_(p);
   return native::bernoulli_(self, probs, generator);
 }
@@ -134,35 +224,34 @@ Tensor _standard_gamma_grad_cpu(const Tensor& self, const Tensor& output) {
  * This section is a counterpart to Distributions.cu
  */
 
-Tensor _s_poisson_cpu(const Tensor& lambda, Generator *gen) {
+Tensor _s_poisson_cpu(const Tensor& lambda_, Generator *gen) {
+  auto lambda = lambda_.contiguous();
   Tensor ret = at::zeros(lambda.type(), lambda.sizes());
   AT_DISPATCH_FLOATING_TYPES(ret.type(), "poisson", [&] {
-    THGenerator* generator = get_generator(gen);
-    std::lock_guard<std::mutex> lock(generator->mutex);
-    CPU_tensor_apply2<scalar_t, scalar_t>(ret, lambda,
-      [generator](scalar_t& ret_val, const scalar_t& lambda){
-        ret_val = static_cast<scalar_t>(sample_poisson(static_cast<double>(lambda), generator));
+    parallel_sample<scalar_t>(ret, lambda, gen,
+      [](scalar_t lambda, PhiloxStream& stream) {
+        auto standard_uniform = [&stream] { return stream.standard_uniform(); };
+        return static_cast<scalar_t>(sample_poisson(static_cast<double>(lambda), standard_uniform));
       }
     );
     });
   return ret;
 }
 
-Tensor _s_gamma_cpu(const Tensor& alpha, Generator *gen) {
+Tensor _s_gamma_cpu(const Tensor& alpha_, Generator *gen) {
+  auto alpha = alpha_.contiguous();
   Tensor ret = alpha.type().zeros(alpha.sizes());
   AT_DISPATCH_FLOATING_TYPES(ret.type(), "gamma", [&] {
-    THGenerator* generator = get_generator(gen);
-    std::lock_guard<std::mutex> lock(generator->mutex);
-    CPU_tensor_apply2<scalar_t, scalar_t>(ret, alpha,
-      [generator](scalar_t& ret_val, const scalar_t& alpha){
-        BaseSampler<double> standard_uniform([generator] () {
-          return THRandom_standard_uniform(generator);
+    parallel_sample<scalar_t>(ret, alpha, gen,
+      [](scalar_t alpha, PhiloxStream& stream) {
+        BaseSampler<double> standard_uniform([&stream] () {
+          return stream.standard_uniform();
         });
-        BaseSampler<double> standard_normal([generator] () {
-          return THRandom_normal(generator, 0.0, 1.0);
+        BaseSampler<double> standard_normal([&stream] () {
+          return stream.standard_normal();
         });
         auto sample = sample_gamma<scalar_t, double>(alpha, standard_uniform, standard_normal);
-        ret_val = std::max(std::numeric_limits<scalar_t>::min(), (scalar_t) sample);
+        return std::max(std::numeric_limits<scalar_t>::min(), (scalar_t) sample);
       }
     );
     });
@@ -170,4 +259,89 @@ Tensor _s_gamma_cpu(const Tensor& alpha, Generator *gen) {
   return ret;
 }
 
+// Walker's alias method, with the O(K) construction of Vose (1991): sample k
+// is drawn by picking a column i uniformly, then keeping i with probability
+// q[i] or else taking its alias J[i]. The tables are built from a single
+// distribution, on the CPU, and each draw is O(1), which pays off when the
+// same distribution is sampled many times.
+std::tuple<Tensor, Tensor> _multinomial_alias_setup(const Tensor& probs) {
+  AT_CHECK(probs.dim() == 1, "multinomial_alias_setup: expected a 1-D distribution, got ",
+           probs.dim(), "-D");
+  int64_t K = probs.numel();
+  AT_CHECK(K > 0, "multinomial_alias_setup: expected at least one category");
+  auto p = probs.toBackend(kCPU).toType(kDouble).contiguous();
+  auto p_data = p.data<double>();
+  double sum = 0;
+  for (int64_t i = 0; i < K; i++) {
+    AT_CHECK(p_data[i] >= 0, "invalid multinomial distribution (encountering probability entry < 0)");
+    sum += p_data[i];
+  }
+  AT_CHECK(sum > 0, "invalid multinomial distribution (sum of probabilities <= 0)");
+
+  auto q = p.type().tensor({K});
+  auto J = p.type().toScalarType(kLong).tensor({K});
+  auto q_data = q.data<double>();
+  auto J_data = J.data<int64_t>();
+  std::vector<int64_t> smaller, larger;
+  for (int64_t i = 0; i < K; i++) {
+    q_data[i] = p_data[i] * K / sum;
+    J_data[i] = i;
+    (q_data[i] < 1 ? smaller : larger).push_back(i);
+  }
+  // Each column i < 1 is completed by the mass of a column >= 1
+  while (!smaller.empty() && !larger.empty()) {
+    int64_t small = smaller.back();
+    int64_t large = larger.back();
+    smaller.pop_back();
+    J_data[small] = large;
+    q_data[large] -= 1 - q_data[small];
+    if (q_data[large] < 1) {
+      larger.pop_back();
+      smaller.push_back(large);
+    }
+  }
+  // What is left is 1 up to rounding errors
+  for (auto i : smaller) {
+    q_data[i] = 1;
+  }
+  for (auto i : larger) {
+    q_data[i] = 1;
+  }
+  return std::make_tuple(q.toType(probs.type()), J.toType(probs.type().toScalarType(kLong)));
+}
+
+Tensor _multinomial_alias_draw(const Tensor& q, const Tensor& J, int64_t num_samples, Generator* gen) {
+  AT_CHECK(q.dim() == 1 && J.dim() == 1 && q.numel() == J.numel() && q.numel() > 0,
+           "multinomial_alias_draw: expected the tables of multinomial_alias_setup, got sizes ",
+           q.sizes(), " and ", J.sizes());
+  AT_CHECK(num_samples >= 0, "multinomial_alias_draw: cannot sample ", num_samples, " samples");
+  int64_t K = q.numel();
+  if (q.type().backend() != kCPU) {
+    auto column = q.type().tensor({num_samples}).uniform_(0, K, gen).toType(J.type()).clamp_max_(K - 1);
+    auto keep = q.type().tensor({num_samples}).uniform_(0, 1, gen).lt(q.index_select(0, column));
+    return at::where(keep, column, J.index_select(0, column));
+  }
+  // Sample i uses block i of the Philox stream of a key drawn from the
+  // generator, so that the samples can be drawn in parallel
+  uint64_t key = philox_key(gen);
+  auto J_ = J.contiguous();
+  auto result = J.type().tensor({num_samples});
+  AT_DISPATCH_FLOATING_TYPES(q.type(), "multinomial_alias_draw", [&] {
+    auto q_ = q.contiguous();
+    auto q_data = q_.data<scalar_t>();
+    auto J_data = J_.data<int64_t>();
+    auto result_data = result.data<int64_t>();
+    parallel_for(0, num_samples, internal::TBB_GRAIN_SIZE, [&](int64_t begin, int64_t end) {
+      uint32_t words[4];
+      for (int64_t i = begin; i < end; i++) {
+        THRandom_philox4x32(key, i, words);
+        int64_t column = std::min<int64_t>(K - 1, uniform_from_words(words[0], words[1]) * K);
+        bool keep = uniform_from_words(words[2], words[3]) < q_data[column];
+        result_data[i] = keep ? column : J_data[column];
+      }
+    });
+  });
+  return result;
+}
+
 }} // namespace at::native
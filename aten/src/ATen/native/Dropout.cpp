@@ -0,0 +1,106 @@
+#include "ATen/ATen.h"
+#include "ATen/CPUGenerator.h"
+#include "ATen/CheckGenerator.h"
+#include "ATen/Dispatch.h"
+#include "ATen/NativeFunctions.h"
+#include "ATen/Parallel.h"
+
+#include "TH/THRandom.h"
+#include "TH/THGenerator.hpp"
+
+#include <mutex>
+#include <tuple>
+
+// Fused dropout. The forward draws the random numbers inside the kernel and
+// saves a bit-packed mask for the backward, bit k of byte j being set if
+// element 8 * j + k of the input is kept. The mask takes one bit per element
+// instead of the element size of the bernoulli_ mask of nn.Dropout.
+
+namespace at { namespace native {
+
+namespace {
+
+THGenerator* get_generator(Generator* gen) {
+  auto default_gen = &globalContext().defaultGenerator(Backend::CPU);
+  return check_generator<CPUGenerator>(gen, default_gen)->generator;
+}
+
+// 1 / (1 - p), or 0 if every element is dropped
+double dropout_scale(double p) {
+  return p < 1 ? 1. / (1. - p) : 0.;
+}
+
+void check_dropout_mask(const Tensor& mask, int64_t numel) {
+  AT_CHECK(mask.type().scalarType() == kByte && mask.is_contiguous() &&
+           mask.numel() == (numel + 7) / 8,
+           "_fused_dropout_backward: expected a contiguous byte mask of ", (numel + 7) / 8,
+           " elements, got ", mask.toString(), " of size ", mask.sizes());
+}
+
+} // namespace
+
+std::tuple<Tensor, Tensor> _fused_dropout_cpu(const Tensor& self, double p, Generator* gen) {
+  AT_CHECK(p >= 0 && p <= 1, "dropout probability has to be between 0 and 1, but got ", p);
+  auto input = self.contiguous();
+  auto output = input.type().tensor(input.sizes());
+  int64_t numel = input.numel();
+  auto mask = input.type().toScalarType(kByte).tensor({(numel + 7) / 8});
+
+  // Element i is kept if the 24 high bits of word i of the Philox stream of
+  // key are below (1 - p) * 2^24, so it does not depend on how the bytes are
+  // split between threads
+  uint64_t key;
+  {
+    THGenerator* generator = get_generator(gen);
+    std::lock_guard<std::mutex> lock(generator->mutex);
+    key = THRandom_random64(generator);
+  }
+  const uint32_t threshold = static_cast<uint32_t>((1. - p) * (1 << 24));
+
+  AT_DISPATCH_FLOATING_TYPES(input.type(), "_fused_dropout", [&] {
+    const scalar_t* input_data = input.data<scalar_t>();
+    scalar_t* output_data = output.data<scalar_t>();
+    uint8_t* mask_data = mask.data<uint8_t>();
+    const scalar_t scale = static_cast<scalar_t>(dropout_scale(p));
+    parallel_for(0, mask.numel(), internal::TBB_GRAIN_SIZE / 8, [&](int64_t begin, int64_t end) {
+      uint32_t words[8];
+      for (int64_t j = begin; j < end; j++) {
+        THRandom_philox4x32(key, 2 * j, words);
+        THRandom_philox4x32(key, 2 * j + 1, words + 4);
+        uint8_t bits = 0;
+        for (int64_t k = 0, i = 8 * j; k < 8 && i < numel; k++, i++) {
+          bool keep = (words[k] >> 8) < threshold;
+          bits |= static_cast<uint8_t>(keep) << k;
+          output_data[i] = keep ? input_data[i] * scale : scalar_t(0);
+        }
+        mask_data[j] = bits;
+      }
+    });
+  });
+  return std::make_tuple(output, mask);
+}
+
+Tensor _fused_dropout_backward_cpu(const Tensor& grad_output_r, const Tensor& mask, double p) {
+  auto grad_output = grad_output_r.contiguous();
+  int64_t numel = grad_output.numel();
+  check_dropout_mask(mask, numel);
+  auto grad_input = grad_output.type().tensor(grad_output.sizes());
+
+  AT_DISPATCH_FLOATING_TYPES(grad_output.type(), "_fused_dropout_backward", [&] {
+    const scalar_t* grad_output_data = grad_output.data<scalar_t>();
+    scalar_t* grad_input_data = grad_input.data<scalar_t>();
+    const uint8_t* mask_data = mask.data<uint8_t>();
+    const scalar_t scale = static_cast<scalar_t>(dropout_scale(p));
+    parallel_for(0, mask.numel(), internal::TBB_GRAIN_SIZE / 8, [&](int64_t begin, int64_t end) {
+      for (int64_t j = begin; j < end; j++) {
+        uint8_t bits = mask_data[j];
+        for (int64_t k = 0, i = 8 * j; k < 8 && i < numel; k++, i++) {
+          grad_input_data[i] = ((bits >> k) & 1) ? grad_output_data[i] * scale : scalar_t(0);
+        }
+      }
+    });
+  });
+  return grad_input;
+}
+
+}} // namespace at::native
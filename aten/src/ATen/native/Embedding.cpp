@@ -44,7 +44,7 @@ Tensor embedding_backward(
   }
 }
 
-Tensor embedding_sparse_backward(
+Tensor embedding_sparse_backward_cpu(
     const Tensor & grad_, const Tensor & indices_, int64_t num_weights,
     int64_t padding_idx, bool scale_grad_by_freq) {
 
@@ -1,7 +1,11 @@
 #include "ATen/ATen.h"
 #include "ATen/TensorUtils.h"
 #include "ATen/NativeFunctions.h"
+#include "ATen/Parallel.h"
+#include "ATen/native/cpu/EmbeddingBagKernel.h"
 
+#include <algorithm>
+#include <cmath>
 #include <cstring>
 #include <iostream>
 #include <memory>
@@ -44,23 +48,24 @@ void axpy<double>(int64_t n, double a, double *x, int64_t incx,
   THDoubleBlas_axpy(n, a, x, incx, y, incy);
 }
 
-// This function combines index_select (using select_indices as the index) and
-// index_add (using add_indices as the index), without creating an intermediary
-// tensor to hold the selected embeddings
-template<typename T>
-static void index_select_add(const Tensor &select_indices,
-                             const Tensor &add_indices,
-                             const Tensor &src,
-                             Tensor &output) {
-  auto add_indices_data = add_indices.data<int64_t>();
-  auto select_indices_data = select_indices.data<int64_t>();
-  auto src_data = src.data<T>();
-  auto output_data = output.data<T>();
-  auto numel = add_indices.numel();
-  int64_t ddim = src.size(1);
-  for (int64_t i = 0; i < numel; i++) {
-    axpy<T>(ddim, 1, src_data + ddim * select_indices_data[i], 1,
-            output_data + ddim * add_indices_data[i], 1);
+// The CPU kernels read the bags straight from offsets and indices, so both
+// must be valid. indices and offsets must be contiguous.
+static void check_bags(const Tensor &indices, const Tensor &offsets,
+                       int64_t num_weights) {
+  auto offsets_data = offsets.data<int64_t>();
+  for (int64_t b = 0; b < offsets.numel(); b++) {
+    AT_CHECK(offsets_data[b] >= 0 && offsets_data[b] <= indices.numel() &&
+             (b == 0 || offsets_data[b - 1] <= offsets_data[b]),
+             "embedding_bag: offsets must be non-decreasing and within the ",
+             "range of indices, but offsets[", b, "] is ", offsets_data[b]);
+  }
+  AT_CHECK(offsets.numel() == 0 || indices.numel() == 0 || offsets_data[0] == 0,
+           "embedding_bag: offsets[0] must be 0");
+  auto indices_data = indices.data<int64_t>();
+  for (int64_t i = 0; i < indices.numel(); i++) {
+    AT_CHECK(indices_data[i] >= 0 && indices_data[i] < num_weights,
+             "embedding_bag: index ", indices_data[i], " is out of range for ",
+             num_weights, " embeddings");
   }
 }
 
@@ -77,26 +82,6 @@ static void make_bag_size(const Tensor &offsets, const Tensor &indices,
   }
 }
 
-static Tensor apply_bag_size(const Tensor &offsets, const Tensor &indices,
-                             const int64_t mode, Tensor &output,
-                             const Tensor &bag_size) {
-  if (mode == 1) { // MODE_MEAN
-    if (offsets.size(0) == 1) {
-      auto bag_size_ = indices.size(0);
-      output /= bag_size_;
-    } else {
-      // Avoid dividing by 0 for empty bags.
-      // Instead we want empty bags to return all 0s
-      auto bag_size_ = at::max(bag_size, at::ones_like(bag_size))
-                           .toType(output.type())
-                           .unsqueeze(1)
-                           .expand_as(output);
-      output /= bag_size_;
-    }
-  }
-  return output;
-}
-
 static Tensor apply_bag_size_backward(const Tensor &offsets,
                                       const Tensor &indices, const int64_t mode,
                                       Tensor &output, const Tensor &offset2bag,
@@ -123,35 +108,40 @@ std::tuple<Tensor, Tensor, Tensor, Tensor> embedding_bag_cpu_max(
     auto max_indices = at::zeros(indices.type(), {offsets.size(0), weight.size(1)});
 
     int64_t numel = indices.numel();
+    int64_t num_bags = offsets.size(0);
     int64_t dims = weight.size(1);
     auto indices_data = indices.data<int64_t>();
-    auto offset2bag_data = offset2bag.data<int64_t>();
+    auto offsets_data = offsets.data<int64_t>();
 
     auto max_indices_data = max_indices.data<int64_t>();
     auto max_indices_stride = max_indices.stride(0);
 
     auto weight_data = weight.data<scalar_t>();
     auto output_data = output.data<scalar_t>();
-    auto weight_stride = weight.stride(0);
+    auto weight_stride0 = weight.stride(0);
+    auto weight_stride1 = weight.stride(1);
     auto output_stride = output.stride(0);
 
-    for (int i = 0; i < numel; i++) {
-      auto bag = offset2bag_data[i];
-      auto word_idx = indices_data[i];
-
-
-      for (int dim = 0; dim < dims; dim++) {
-        auto& current_item = output_data[output_stride * bag + dim];
-        auto weight_item = weight_data[weight_stride * word_idx + dim];
-
-        bool is_first_for_bag = (i == 0) || offset2bag_data[i - 1] != bag;
-
-        if (is_first_for_bag || weight_item > current_item) {
-          current_item = weight_item;
-          max_indices_data[max_indices_stride * bag + dim] = word_idx;
+    // every bag writes its own output row
+    parallel_for(0, num_bags, 1, [&](int64_t begin, int64_t end) {
+      for (int64_t bag = begin; bag < end; bag++) {
+        int64_t start = offsets_data[bag];
+        int64_t stop = bag + 1 < num_bags ? offsets_data[bag + 1] : numel;
+        auto out = output_data + output_stride * bag;
+        auto max_idx = max_indices_data + max_indices_stride * bag;
+        for (int64_t i = start; i < stop; i++) {
+          auto word_idx = indices_data[i];
+          auto row = weight_data + weight_stride0 * word_idx;
+          for (int64_t dim = 0; dim < dims; dim++) {
+            auto weight_item = row[weight_stride1 * dim];
+            if (i == start || weight_item > out[dim]) {
+              out[dim] = weight_item;
+              max_idx[dim] = word_idx;
+            }
+          }
         }
       }
-    }
+    });
 
     return std::tuple<Tensor, Tensor, Tensor, Tensor>(output, offset2bag, bag_size, max_indices);
 }
@@ -167,7 +157,12 @@ embedding_bag_cpu(const Tensor &weight, const Tensor &indices__,
   Tensor indices = indices__.contiguous();
   Tensor offsets = offsets__.contiguous();
   auto weight_arg = TensorArg(weight, "weight", 1);
-  checkScalarTypes("embedding_bag", weight_arg, {kFloat, kDouble});
+  checkScalarTypes("embedding_bag", weight_arg, {kFloat, kDouble, kHalf});
+  checkDim("embedding_bag", weight_arg, 2);
+  AT_CHECK(weight.type().scalarType() != kHalf || mode == MODE_MEAN || mode == MODE_SUM,
+           "embedding_bag: half weights are only supported in 'sum' and 'mean' modes");
+
+  check_bags(indices, offsets, weight.size(0));
 
   auto bag_size = at::zeros(indices.type(), offsets.sizes());
   make_bag_size(offsets, indices, mode, bag_size);
@@ -183,17 +178,20 @@ embedding_bag_cpu(const Tensor &weight, const Tensor &indices__,
 
   offset2bag.resize_({indices.sizes()[0]});
 
-  auto output = at::zeros(weight.type(), {offsets.size(0), weight.size(1)});
-
   if (mode == MODE_MEAN || mode == MODE_SUM) {
-    if (weight.type().scalarType() == kFloat) {
-      index_select_add<float>(indices, offset2bag, weight, output);
-    } else if (weight.type().scalarType() == kDouble) {
-      index_select_add<double>(indices, offset2bag, weight, output);
+    // the kernel averages the bags itself; the rows of a half weight are
+    // summed in float, and only the result is rounded to half
+    bool half = weight.type().scalarType() == kHalf;
+    auto output = at::zeros(half ? weight.type().toScalarType(kFloat) : weight.type(),
+                            {offsets.size(0), weight.size(1)});
+    embedding_bag_sum_kernel(output, weight.stride(1) == 1 ? weight : weight.contiguous(),
+                             indices, offsets, mode == MODE_MEAN);
+    if (half) {
+      output = output.toType(kHalf);
     }
-    auto ret = apply_bag_size(offsets, indices, mode, output, bag_size);
-    return std::tuple<Tensor, Tensor, Tensor, Tensor>(ret, offset2bag, bag_size, bag_size);
+    return std::tuple<Tensor, Tensor, Tensor, Tensor>(output, offset2bag, bag_size, bag_size);
   } else { // MODE_MAX
+    auto output = at::zeros(weight.type(), {offsets.size(0), weight.size(1)});
     return AT_DISPATCH_FLOATING_TYPES_AND_HALF(
       weight.type(), "embedding_bag_cpu_max", [&]() {
         return embedding_bag_cpu_max<scalar_t>(weight, indices, offset2bag, output, bag_size, offsets);
@@ -202,6 +200,107 @@ embedding_bag_cpu(const Tensor &weight, const Tensor &indices__,
   }
 }
 
+// Rowwise quantized tables store every row as its values quantized to
+// bits bits, followed by the float scale and bias of the row:
+//
+//   x = scale * q + bias,  bias = min(row),  scale = (max(row) - min(row)) / (2^bits - 1)
+//
+// With 4 bits, two values share a byte (the even one in the low nibble), so
+// the embedding dimension must be even. Only the forward lookup is provided;
+// these tables are meant for inference.
+static int64_t quantized_row_bytes(int64_t embedding_dim, int64_t bits) {
+  return (bits == 8 ? embedding_dim : embedding_dim / 2) + 2 * sizeof(float);
+}
+
+static int64_t quantized_embedding_dim(const Tensor &weight, int64_t bits) {
+  int64_t data_bytes = weight.size(1) - 2 * sizeof(float);
+  AT_CHECK(data_bytes >= 0, "rowwise quantized embeddings must have at least ",
+           2 * sizeof(float), " bytes per row, but got ", weight.size(1));
+  return bits == 8 ? data_bytes : 2 * data_bytes;
+}
+
+static void check_quantized(const Tensor &weight, int64_t bits) {
+  AT_CHECK(bits == 8 || bits == 4,
+           "rowwise quantized embeddings support 8 or 4 bits, but got ", bits);
+  auto weight_arg = TensorArg(weight, "weight", 1);
+  checkScalarType("embedding_rowwise_dequantize", weight_arg, kByte);
+  checkDim("embedding_rowwise_dequantize", weight_arg, 2);
+  checkContiguous("embedding_rowwise_dequantize", weight_arg);
+}
+
+Tensor embedding_rowwise_quantize_cpu(const Tensor &self_, int64_t bits) {
+  AT_CHECK(bits == 8 || bits == 4,
+           "embedding_rowwise_quantize: bits must be 8 or 4, but got ", bits);
+  auto self_arg = TensorArg(self_, "self", 1);
+  checkScalarType("embedding_rowwise_quantize", self_arg, kFloat);
+  checkDim("embedding_rowwise_quantize", self_arg, 2);
+  Tensor self = self_.contiguous();
+  int64_t rows = self.size(0);
+  int64_t dim = self.size(1);
+  AT_CHECK(bits == 8 || dim % 2 == 0,
+           "embedding_rowwise_quantize: 4-bit rows must have an even size, but got ", dim);
+
+  int64_t row_bytes = quantized_row_bytes(dim, bits);
+  auto result = at::zeros(self.type().toScalarType(kByte), {rows, row_bytes});
+  auto in = self.data<float>();
+  auto out = result.data<uint8_t>();
+  float levels = (1 << bits) - 1;
+  parallel_for(0, rows, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t r = begin; r < end; r++) {
+      const float* x = in + r * dim;
+      uint8_t* q = out + r * row_bytes;
+      float min = dim > 0 ? *std::min_element(x, x + dim) : 0;
+      float max = dim > 0 ? *std::max_element(x, x + dim) : 0;
+      float scale = (max - min) / levels;
+      float inv_scale = scale > 0 ? 1 / scale : 0;
+      for (int64_t k = 0; k < dim; k++) {
+        float v = std::nearbyint((x[k] - min) * inv_scale);
+        auto code = static_cast<uint8_t>(std::min(std::max(v, 0.f), levels));
+        if (bits == 8) {
+          q[k] = code;
+        } else {
+          q[k / 2] |= k % 2 == 0 ? code : code << 4;
+        }
+      }
+      int64_t data_bytes = row_bytes - 2 * sizeof(float);
+      std::memcpy(q + data_bytes, &scale, sizeof(float));
+      std::memcpy(q + data_bytes + sizeof(float), &min, sizeof(float));
+    }
+  });
+  return result;
+}
+
+Tensor embedding_rowwise_dequantize_cpu(const Tensor &self, int64_t bits) {
+  check_quantized(self, bits);
+  int64_t dim = quantized_embedding_dim(self, bits);
+  // every row is a bag of one
+  auto indices = at::arange(self.type().toScalarType(kLong), self.size(0));
+  return at::embedding_bag_rowwise_quantized(self, indices, indices, bits, MODE_SUM)
+      .view({self.size(0), dim});
+}
+
+Tensor embedding_bag_rowwise_quantized_cpu(const Tensor &weight,
+                                           const Tensor &indices__,
+                                           const Tensor &offsets__,
+                                           int64_t bits, int64_t mode) {
+  check_quantized(weight, bits);
+  AT_CHECK(mode == MODE_SUM || mode == MODE_MEAN,
+           "embedding_bag_rowwise_quantized: only sum and mean bags are supported");
+  auto indices_arg = TensorArg(indices__, "indices", 2);
+  checkScalarType("embedding_bag_rowwise_quantized", indices_arg, kLong);
+  auto offsets_arg = TensorArg(offsets__, "offsets", 3);
+  checkScalarType("embedding_bag_rowwise_quantized", offsets_arg, kLong);
+  Tensor indices = indices__.contiguous();
+  Tensor offsets = offsets__.contiguous();
+  check_bags(indices, offsets, weight.size(0));
+
+  int64_t dim = quantized_embedding_dim(weight, bits);
+  auto output = at::zeros(weight.type().toScalarType(kFloat), {offsets.size(0), dim});
+  embedding_bag_rowwise_quantized_kernel(output, weight, indices, offsets, bits,
+                                         mode == MODE_MEAN);
+  return output;
+}
+
 Tensor embedding_bag_backward(const Tensor &grad_, const Tensor &indices__,
                               const Tensor &offsets__,
                               const Tensor &offset2bag__,
@@ -333,7 +432,7 @@ Tensor embedding_bag_backward_cpu(const Tensor &grad_, const Tensor &indices__,
 
   return index_grad_weight;
 }
-Tensor embedding_bag_sparse_backward(
+Tensor embedding_bag_sparse_backward_cpu(
     const Tensor &grad_, const Tensor &indices__, const Tensor &offsets__,
     const Tensor &offset2bag__, const Tensor &bag_size_, int64_t num_weights,
     bool scale_grad_by_freq, int64_t mode) {
@@ -0,0 +1,128 @@
+#include "ATen/ATen.h"
+#include "ATen/Dispatch.h"
+#include "ATen/NativeFunctions.h"
+#include "ATen/Parallel.h"
+#include "ATen/native/FusedOptimizers.h"
+
+#include <vector>
+
+namespace at { namespace native {
+
+void check_fused_optimizer_lists(const char* name, ArrayRef<TensorList> lists) {
+  AT_CHECK(lists.size() >= 2, name, ": expected gradients and parameters");
+  TensorList params = lists[1];
+  AT_CHECK(params.size() > 0, name, ": expected at least one parameter");
+  const Type& type = params[0].type();
+  int64_t device = params[0].is_cuda() ? params[0].get_device() : -1;
+  for (size_t l = 0; l < lists.size(); l++) {
+    AT_CHECK(lists[l].size() == params.size(),
+             name, ": expected ", params.size(), " tensors in list ", l,
+             " (one per parameter), but got ", lists[l].size());
+    for (size_t i = 0; i < params.size(); i++) {
+      const Tensor& t = lists[l][i];
+      AT_CHECK(t.type() == type,
+               name, ": expected all tensors to be of type ", type.toString(),
+               ", but tensor ", i, " of list ", l, " is ", t.type().toString());
+      AT_CHECK((t.is_cuda() ? t.get_device() : -1) == device,
+               name, ": expected all tensors to be on one device");
+      AT_CHECK(t.is_contiguous(),
+               name, ": expected contiguous tensors, but tensor ", i, " of list ", l, " is not");
+      AT_CHECK(t.numel() == params[i].numel(),
+               name, ": expected tensor ", i, " of list ", l, " to have the ", params[i].numel(),
+               " elements of its parameter, but got ", t.numel());
+    }
+  }
+}
+
+namespace {
+
+// Runs op over every element of the tensors of lists, in parallel within
+// each tensor
+template <typename scalar_t, int depth, typename Op>
+void fused_optimizer_apply_cpu(ArrayRef<TensorList> lists, const Op& op) {
+  for (size_t i = 0; i < lists[0].size(); i++) {
+    scalar_t* ptrs[depth];
+    for (int d = 0; d < depth; d++) {
+      ptrs[d] = lists[d][i].data<scalar_t>();
+    }
+    parallel_for(0, lists[0][i].numel(), 2048, [&](int64_t begin, int64_t end) {
+      for (int64_t j = begin; j < end; j++) {
+        scalar_t v[depth];
+        for (int d = 0; d < depth; d++) {
+          v[d] = ptrs[d][j];
+        }
+        op(v);
+        for (int d = 1; d < depth; d++) {
+          ptrs[d][j] = v[d];
+        }
+      }
+    });
+  }
+}
+
+} // namespace
+
+std::vector<Tensor> _fused_sgd_cpu(
+    TensorList params, TensorList grads, TensorList momentum_buffers,
+    double lr, double momentum, double dampening, double weight_decay,
+    bool nesterov, bool init_momentum) {
+  if (momentum != 0) {
+    check_fused_optimizer_lists("_fused_sgd", {grads, params, momentum_buffers});
+    AT_DISPATCH_FLOATING_TYPES(params[0].type(), "_fused_sgd", [&] {
+      SGDUpdate<scalar_t, true> op{
+          static_cast<scalar_t>(lr), static_cast<scalar_t>(momentum),
+          static_cast<scalar_t>(dampening), static_cast<scalar_t>(weight_decay),
+          nesterov, init_momentum};
+      fused_optimizer_apply_cpu<scalar_t, 3>({grads, params, momentum_buffers}, op);
+    });
+  } else {
+    check_fused_optimizer_lists("_fused_sgd", {grads, params});
+    AT_DISPATCH_FLOATING_TYPES(params[0].type(), "_fused_sgd", [&] {
+      SGDUpdate<scalar_t, false> op{
+          static_cast<scalar_t>(lr), 0, 0, static_cast<scalar_t>(weight_decay), false, false};
+      fused_optimizer_apply_cpu<scalar_t, 2>({grads, params}, op);
+    });
+  }
+  return params.vec();
+}
+
+std::vector<Tensor> _fused_adam_cpu(
+    TensorList params, TensorList grads, TensorList exp_avgs, TensorList exp_avg_sqs,
+    TensorList max_exp_avg_sqs, double step_size, double beta1, double beta2, double eps,
+    double weight_decay) {
+  if (max_exp_avg_sqs.size() > 0) {
+    check_fused_optimizer_lists(
+        "_fused_adam", {grads, params, exp_avgs, exp_avg_sqs, max_exp_avg_sqs});
+    AT_DISPATCH_FLOATING_TYPES(params[0].type(), "_fused_adam", [&] {
+      AdamUpdate<scalar_t, true> op{
+          static_cast<scalar_t>(step_size), static_cast<scalar_t>(beta1),
+          static_cast<scalar_t>(beta2), static_cast<scalar_t>(eps),
+          static_cast<scalar_t>(weight_decay)};
+      fused_optimizer_apply_cpu<scalar_t, 5>(
+          {grads, params, exp_avgs, exp_avg_sqs, max_exp_avg_sqs}, op);
+    });
+  } else {
+    check_fused_optimizer_lists("_fused_adam", {grads, params, exp_avgs, exp_avg_sqs});
+    AT_DISPATCH_FLOATING_TYPES(params[0].type(), "_fused_adam", [&] {
+      AdamUpdate<scalar_t, false> op{
+          static_cast<scalar_t>(step_size), static_cast<scalar_t>(beta1),
+          static_cast<scalar_t>(beta2), static_cast<scalar_t>(eps),
+          static_cast<scalar_t>(weight_decay)};
+      fused_optimizer_apply_cpu<scalar_t, 4>({grads, params, exp_avgs, exp_avg_sqs}, op);
+    });
+  }
+  return params.vec();
+}
+
+std::vector<Tensor> _fused_adagrad_cpu(
+    TensorList params, TensorList grads, TensorList state_sums,
+    double clr, double weight_decay) {
+  check_fused_optimizer_lists("_fused_adagrad", {grads, params, state_sums});
+  AT_DISPATCH_FLOATING_TYPES(params[0].type(), "_fused_adagrad", [&] {
+    AdagradUpdate<scalar_t> op{static_cast<scalar_t>(clr), static_cast<scalar_t>(weight_decay)};
+    fused_optimizer_apply_cpu<scalar_t, 3>({grads, params, state_sums}, op);
+  });
+  return params.vec();
+}
+
+}} // namespace at::native
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "ATen/ATen.h"
+
+#include <cmath>
+
+// Element-wise updates of the fused optimizers, which step every parameter
+// of a group in a single pass instead of a chain of pointwise ops per
+// parameter (mul_, add_, addcdiv_, ...). An update gets the values of one
+// element of each tensor list in v: v[0] is the gradient, which is only
+// read, v[1] the parameter and v[2...] the optimizer state, which are
+// written back. Compiled for the host and, from .cu files, the device.
+
+#if defined(__CUDACC__)
+#define FUSED_OPTIMIZER_HOST_DEVICE __host__ __device__ __forceinline__
+#else
+#define FUSED_OPTIMIZER_HOST_DEVICE inline
+#endif
+
+namespace at { namespace native {
+
+// v = {grad, param, momentum_buffer} if kMomentum, else {grad, param}.
+// The momentum buffer is set to the gradient if init_momentum.
+template <typename acc_t, bool kMomentum>
+struct SGDUpdate {
+  acc_t lr;
+  acc_t momentum;
+  acc_t dampening;
+  acc_t weight_decay;
+  bool nesterov;
+  bool init_momentum;
+
+  FUSED_OPTIMIZER_HOST_DEVICE void operator()(acc_t* v) const {
+    acc_t d_p = v[0] + weight_decay * v[1];
+    if (kMomentum) {
+      acc_t buf = init_momentum ? d_p : momentum * v[2] + (1 - dampening) * d_p;
+      v[2] = buf;
+      d_p = nesterov ? d_p + momentum * buf : buf;
+    }
+    v[1] -= lr * d_p;
+  }
+};
+
+// v = {grad, param, exp_avg, exp_avg_sq, max_exp_avg_sq} if kAmsgrad, else
+// without max_exp_avg_sq. step_size includes the bias corrections.
+template <typename acc_t, bool kAmsgrad>
+struct AdamUpdate {
+  acc_t step_size;
+  acc_t beta1;
+  acc_t beta2;
+  acc_t eps;
+  acc_t weight_decay;
+
+  FUSED_OPTIMIZER_HOST_DEVICE void operator()(acc_t* v) const {
+    using std::sqrt;
+    acc_t grad = v[0] + weight_decay * v[1];
+    acc_t exp_avg = beta1 * v[2] + (1 - beta1) * grad;
+    acc_t exp_avg_sq = beta2 * v[3] + (1 - beta2) * grad * grad;
+    v[2] = exp_avg;
+    v[3] = exp_avg_sq;
+    if (kAmsgrad) {
+      exp_avg_sq = v[4] > exp_avg_sq ? v[4] : exp_avg_sq;
+      v[4] = exp_avg_sq;
+    }
+    v[1] -= step_size * exp_avg / (sqrt(exp_avg_sq) + eps);
+  }
+};
+
+// v = {grad, param, sum}. clr is the decayed learning rate.
+template <typename acc_t>
+struct AdagradUpdate {
+  acc_t clr;
+  acc_t weight_decay;
+
+  FUSED_OPTIMIZER_HOST_DEVICE void operator()(acc_t* v) const {
+    using std::sqrt;
+    acc_t grad = v[0] + weight_decay * v[1];
+    acc_t sum = v[2] + grad * grad;
+    v[2] = sum;
+    v[1] -= clr * grad / (sqrt(sum) + acc_t(1e-10));
+  }
+};
+
+// Checks that lists, ordered like v, have a dense and contiguous tensor of
+// the size of each parameter, all of one type and on one device
+void check_fused_optimizer_lists(const char* name, ArrayRef<TensorList> lists);
+
+}} // namespace at::native
@@ -3,12 +3,15 @@
 #include "ATen/Dispatch.h"
 #include "ATen/ExpandUtils.h"
 #include "ATen/NativeFunctions.h"
+#include "ATen/Parallel.h"
 
 #include "ATen/native/LinearAlgebraUtils.h"
 #include "ATen/native/Gesv.h"
+#include "ATen/native/SmallMatrixOps.h"
 
 #include "TH.h"  // for USE_LAPACK
 
+#include <algorithm>
 #include <vector>
 
 #ifdef USE_LAPACK
@@ -44,7 +47,7 @@ template<> void lapackGesv<double>(
 #endif
 
 template <typename scalar_t>
-static void applyGesv(Tensor& b, Tensor& A, std::vector<int64_t> infos) {
+static void applyGesv(Tensor& b, Tensor& A, std::vector<int64_t>& infos) {
 #ifndef USE_LAPACK
   AT_ERROR("gesv: LAPACK library not found in compilation");
 #endif
@@ -72,12 +75,40 @@ static void applyGesv(Tensor& b, Tensor& A, std::vector<int64_t> infos) {
   }
 }
 
+// Same as applyGesv with the register-resident kernel of SmallMatrixOps.h,
+// for batches of matrices of at most kMaxSmallMatrixSize rows
+template <typename scalar_t>
+static void applySmallGesv(Tensor& b, Tensor& A, std::vector<int64_t>& infos) {
+  auto A_data = A.data<scalar_t>();
+  auto b_data = b.data<scalar_t>();
+  auto A_mat_stride = matrixStride(A);
+  auto b_mat_stride = matrixStride(b);
+
+  auto batch_size = batchCount(A);
+  auto n = A.size(-2);
+  auto nrhs = b.size(-1);
+  auto grain_size = std::max<int64_t>(1, internal::TBB_GRAIN_SIZE / (n * n * (n + nrhs)));
+
+  AT_DISPATCH_SMALL_MATRIX_SIZE(n, "gesv", [&] {
+    parallel_for(0, batch_size, grain_size, [&](int64_t begin, int64_t end) {
+      for (int64_t i = begin; i < end; i++) {
+        infos[i] = small_gesv<scalar_t, N>(
+            &A_data[i * A_mat_stride], &b_data[i * b_mat_stride], nrhs);
+      }
+    });
+  });
+}
+
 std::tuple<Tensor,Tensor> _gesv_helper_cpu(const Tensor& self, const Tensor& A) {
   std::vector<int64_t> infos(batchCount(A), 0);
   auto A_working_copy = cloneBatchedColumnMajor(A);
   auto b_working_copy = cloneBatchedColumnMajor(self);
   AT_DISPATCH_FLOATING_TYPES(self.type(), "gesv", [&]{
-    applyGesv<scalar_t>(b_working_copy, A_working_copy, infos);
+    if (use_small_matrix_kernels(A)) {
+      applySmallGesv<scalar_t>(b_working_copy, A_working_copy, infos);
+    } else {
+      applyGesv<scalar_t>(b_working_copy, A_working_copy, infos);
+    }
   });
   checkErrors(infos);
   return std::tuple<Tensor,Tensor>(b_working_copy, A_working_copy);
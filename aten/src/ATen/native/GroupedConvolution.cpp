@@ -0,0 +1,200 @@
+#include "ATen/ATen.h"
+#include "ATen/NativeFunctions.h"
+#include "ATen/Dispatch.h"
+#include "ATen/Parallel.h"
+
+#include <algorithm>
+#include <tuple>
+
+// im2col + GEMM convolution with groups on the CPU. The unfolded input of
+// a sample, of size (C * kH * kW, oH * oW), is also a (groups, C / groups *
+// kH * kW, oH * oW) batch of matrices, and the output of the sample a
+// (groups, K / groups, oH * oW) one, so all groups are computed by a single
+// batched GEMM written directly into the output, instead of convolving
+// subtensors of every group and concatenating the results.
+
+namespace at { namespace native {
+
+namespace {
+
+struct Conv2dShape {
+  int64_t C, iH, iW, K, kH, kW, oH, oW;
+  int64_t sH, sW, padH, padW, dilationH, dilationW;
+  int64_t groups;
+
+  Conv2dShape(const Tensor& input, const Tensor& weight, IntList stride,
+              IntList padding, IntList dilation, int64_t groups_)
+    : C(input.size(1)), iH(input.size(2)), iW(input.size(3))
+    , K(weight.size(0)), kH(weight.size(2)), kW(weight.size(3))
+    , sH(stride[0]), sW(stride[1]), padH(padding[0]), padW(padding[1])
+    , dilationH(dilation[0]), dilationW(dilation[1]), groups(groups_) {
+    oH = (iH + 2 * padH - dilationH * (kH - 1) - 1) / sH + 1;
+    oW = (iW + 2 * padW - dilationW * (kW - 1) - 1) / sW + 1;
+  }
+
+  // Rows of the unfolded input of a group
+  int64_t group_rows() const { return C / groups * kH * kW; }
+};
+
+void check_grouped_conv2d_args(const char* name, const Tensor& input, const Tensor& weight,
+                               IntList stride, IntList padding, IntList dilation,
+                               int64_t groups) {
+  AT_CHECK(input.dim() == 4 && weight.dim() == 4, name, ": expected 4-d input and weight, got ",
+           input.dim(), "-d and ", weight.dim(), "-d");
+  AT_CHECK(groups > 0 && input.size(1) % groups == 0 && weight.size(0) % groups == 0,
+           name, ": expected the ", input.size(1), " input channels and ", weight.size(0),
+           " output channels to be multiples of groups = ", groups);
+  AT_CHECK(weight.size(1) * groups == input.size(1), name, ": expected a weight of size (K, ",
+           input.size(1) / groups, ", kH, kW), got ", weight.sizes());
+  AT_CHECK(input.type() == weight.type(), name, ": expected input and weight of the same type, got ",
+           input.toString(), " and ", weight.toString());
+  for (int64_t d = 0; d < 2; d++) {
+    AT_CHECK(stride[d] > 0 && dilation[d] > 0 && padding[d] >= 0,
+             name, ": expected positive stride and dilation and non-negative padding");
+  }
+}
+
+// Unfolds the (C, iH, iW) image into the (C * kH * kW, oH * oW) columns,
+// like THNN's im2col
+template <typename scalar_t>
+void im2col(const scalar_t* image, const Conv2dShape& s, scalar_t* columns) {
+  int64_t rows = s.C * s.kH * s.kW;
+  parallel_for(0, rows, std::max<int64_t>(1, internal::TBB_GRAIN_SIZE / (s.oH * s.oW)),
+               [&](int64_t begin, int64_t end) {
+    for (int64_t row = begin; row < end; row++) {
+      int64_t kw = row % s.kW;
+      int64_t kh = row / s.kW % s.kH;
+      int64_t c = row / (s.kW * s.kH);
+      scalar_t* col = columns + row * s.oH * s.oW;
+      for (int64_t oh = 0; oh < s.oH; oh++) {
+        int64_t ih = oh * s.sH - s.padH + kh * s.dilationH;
+        for (int64_t ow = 0; ow < s.oW; ow++) {
+          int64_t iw = ow * s.sW - s.padW + kw * s.dilationW;
+          col[oh * s.oW + ow] = (ih >= 0 && ih < s.iH && iw >= 0 && iw < s.iW)
+              ? image[(c * s.iH + ih) * s.iW + iw] : scalar_t(0);
+        }
+      }
+    }
+  });
+}
+
+// Accumulates the (C * kH * kW, oH * oW) columns into the (C, iH, iW)
+// image, which it overwrites. Every task owns the channels it writes to.
+template <typename scalar_t>
+void col2im(const scalar_t* columns, const Conv2dShape& s, scalar_t* image) {
+  parallel_for(0, s.C, std::max<int64_t>(1, internal::TBB_GRAIN_SIZE / (s.kH * s.kW * s.oH * s.oW)),
+               [&](int64_t begin, int64_t end) {
+    for (int64_t c = begin; c < end; c++) {
+      scalar_t* plane = image + c * s.iH * s.iW;
+      std::fill(plane, plane + s.iH * s.iW, scalar_t(0));
+      for (int64_t kh = 0; kh < s.kH; kh++) {
+        for (int64_t kw = 0; kw < s.kW; kw++) {
+          const scalar_t* col = columns + ((c * s.kH + kh) * s.kW + kw) * s.oH * s.oW;
+          for (int64_t oh = 0; oh < s.oH; oh++) {
+            int64_t ih = oh * s.sH - s.padH + kh * s.dilationH;
+            if (ih < 0 || ih >= s.iH) {
+              continue;
+            }
+            for (int64_t ow = 0; ow < s.oW; ow++) {
+              int64_t iw = ow * s.sW - s.padW + kw * s.dilationW;
+              if (iw >= 0 && iw < s.iW) {
+                plane[ih * s.iW + iw] += col[oh * s.oW + ow];
+              }
+            }
+          }
+        }
+      }
+    }
+  });
+}
+
+void unfold_input(Tensor& columns, const Tensor& image, const Conv2dShape& s) {
+  AT_DISPATCH_FLOATING_TYPES(image.type(), "im2col", [&] {
+    im2col<scalar_t>(image.data<scalar_t>(), s, columns.data<scalar_t>());
+  });
+}
+
+void fold_columns(Tensor& image, const Tensor& columns, const Conv2dShape& s) {
+  AT_DISPATCH_FLOATING_TYPES(image.type(), "col2im", [&] {
+    col2im<scalar_t>(columns.data<scalar_t>(), s, image.data<scalar_t>());
+  });
+}
+
+} // namespace
+
+Tensor _grouped_conv2d_cpu(
+    const Tensor& self, const Tensor& weight_r, const Tensor& bias /* optional */,
+    IntList stride, IntList padding, IntList dilation, int64_t groups) {
+  check_grouped_conv2d_args("_grouped_conv2d", self, weight_r, stride, padding, dilation, groups);
+  auto input = self.contiguous();
+  Conv2dShape s(input, weight_r, stride, padding, dilation, groups);
+  AT_CHECK(s.oH > 0 && s.oW > 0, "_grouped_conv2d: the input of size ", input.sizes(),
+           " is too small for the kernel of size ", weight_r.sizes());
+  if (bias.defined()) {
+    AT_CHECK(bias.dim() == 1 && bias.size(0) == s.K, "_grouped_conv2d: expected a bias of ",
+             s.K, " elements, got ", bias.sizes());
+  }
+
+  auto weight = weight_r.contiguous().view({groups, s.K / groups, s.group_rows()});
+  auto output = input.type().tensor({input.size(0), s.K, s.oH, s.oW});
+  auto columns = input.type().tensor({groups, s.group_rows(), s.oH * s.oW});
+  Tensor bias_;
+  if (bias.defined()) {
+    bias_ = bias.view({groups, s.K / groups, 1}).expand({groups, s.K / groups, s.oH * s.oW});
+  }
+  for (int64_t n = 0; n < input.size(0); n++) {
+    unfold_input(columns, input[n], s);
+    auto output_n = output[n].view({groups, s.K / groups, s.oH * s.oW});
+    if (bias_.defined()) {
+      at::baddbmm_out(output_n, bias_, weight, columns);
+    } else {
+      at::bmm_out(output_n, weight, columns);
+    }
+  }
+  return output;
+}
+
+std::tuple<Tensor, Tensor, Tensor> _grouped_conv2d_backward_cpu(
+    const Tensor& grad_output_r, const Tensor& self, const Tensor& weight_r,
+    IntList stride, IntList padding, IntList dilation, int64_t groups,
+    std::array<bool, 3> output_mask) {
+  check_grouped_conv2d_args("_grouped_conv2d_backward", self, weight_r, stride, padding,
+                            dilation, groups);
+  auto input = self.contiguous();
+  auto grad_output = grad_output_r.contiguous();
+  Conv2dShape s(input, weight_r, stride, padding, dilation, groups);
+  auto weight = weight_r.contiguous().view({groups, s.K / groups, s.group_rows()});
+  auto columns = input.type().tensor({groups, s.group_rows(), s.oH * s.oW});
+
+  Tensor grad_input, grad_weight, grad_bias;
+  if (output_mask[0]) {
+    grad_input = input.type().tensor(input.sizes());
+  }
+  if (output_mask[1]) {
+    grad_weight = weight.type().zeros(weight.sizes());
+  }
+  if (output_mask[0] || output_mask[1]) {
+    auto weight_t = weight.transpose(1, 2);
+    for (int64_t n = 0; n < input.size(0); n++) {
+      auto grad_output_n = grad_output[n].view({groups, s.K / groups, s.oH * s.oW});
+      if (output_mask[0]) {
+        at::bmm_out(columns, weight_t, grad_output_n);
+        auto grad_input_n = grad_input[n];
+        fold_columns(grad_input_n, columns, s);
+      }
+      if (output_mask[1]) {
+        unfold_input(columns, input[n], s);
+        grad_weight.baddbmm_(grad_output_n, columns.transpose(1, 2));
+      }
+    }
+  }
+  if (output_mask[1]) {
+    grad_weight = grad_weight.view(weight_r.sizes());
+  }
+  if (output_mask[2]) {
+    grad_bias = grad_output.sum({0, 2, 3});
+  }
+  return std::make_tuple(grad_input, grad_weight, grad_bias);
+}
+
+}} // namespace at::native
@@ -3,7 +3,7 @@
 // This corresponds to "advanced indexing" in NumPy. The two operations are:
 //
 //  index(Tensor self, indices) -> Tensor
-//  index_put_(Tensor self, indices, value)
+//  index_put_(Tensor self, indices, value, accumulate=false)
 //
 // The index is a TensorList containg kLong or kByte tensors or nulls. Byte
 // tensors (boolean masks) are expanded to long tensors via nonzero(). Null
@@ -25,6 +25,7 @@
 #include "ATen/ATen.h"
 #include "ATen/NativeFunctions.h"
 #include "ATen/ExpandUtils.h"
+#include "ATen/native/cpu/IndexKernel.h"
 
 #include <algorithm>
 #include <functional>
@@ -237,15 +238,88 @@ Tensor index(const Tensor & self, TensorList indices) {
   return src.take(linearIndex);
 }
 
-Tensor & index_put_(Tensor & self, TensorList indices, const Tensor & value) {
+// True for self[index] with a single LongTensor index, which selects whole
+// rows of self
+static bool isRowIndex(TensorList indices) {
+  if (indices.size() == 0 || !indices[0].defined() ||
+      indices[0].type().scalarType() != kLong) {
+    return false;
+  }
+  for (size_t i = 1; i < indices.size(); i++) {
+    if (indices[i].defined()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Negative indices count from the end, as in put_
+static Tensor wrapIndex(const Tensor & index, int64_t size) {
+  return index + index.lt(0).toType(index.type()).mul_(size);
+}
+
+Tensor & index_put_(Tensor & self, TensorList indices, const Tensor & value, bool accumulate) {
   if (indices.size() > (size_t)self.dim()) {
    AT_ERROR("too many indices for tensor of dimension ", self.dim(), " (got ", indices.size(), ")");
   }
 
+  // Accumulating is an index_add_: of the rows of self when they are indexed
+  // by one LongTensor, without building the linear index of every element,
+  // and otherwise of the elements of a contiguous self.
+  if (accumulate && isRowIndex(indices)) {
+    // as in computeLinearIndex, the index may be on another backend
+    auto index = indices[0].toType(self.type().toScalarType(kLong));
+    if (index.numel() == 0) {
+      return self;
+    }
+    std::vector<int64_t> valueSizes(index.sizes());
+    valueSizes.insert(valueSizes.end(), self.sizes().begin() + 1, self.sizes().end());
+    std::vector<int64_t> sourceSizes(self.sizes());
+    sourceSizes[0] = index.numel();
+    auto source = value.expand(valueSizes).contiguous().view(sourceSizes);
+    return self.index_add_(0, wrapIndex(index.reshape({-1}), self.size(0)), source);
+  }
+
   Tensor src, linearIndex, expandedValue;
   std::tie(src, linearIndex) = makeLinearIndex(self, indices);
   std::tie(expandedValue) = expand_inplace(linearIndex, value);
-  return src.put_(linearIndex, expandedValue);
+  if (accumulate && src.is_contiguous()) {
+    if (linearIndex.numel() > 0) {
+      src.view(-1).index_add_(0, wrapIndex(linearIndex.reshape({-1}), src.numel()),
+                              expandedValue.contiguous().view(-1));
+    }
+    return src;
+  }
+  return src.put_(linearIndex, expandedValue, accumulate);
+}
+
+Tensor & _index_add__cpu(Tensor & self, int64_t dim, const Tensor & index, const Tensor & source) {
+  dim = maybe_wrap_dim(dim, self.dim());
+  // The rows of a contiguous self are added by index_add_rows_kernel, the rest
+  // is left to TH.
+  bool rows = dim == 0 && self.dim() > 0 && self.is_contiguous() &&
+      source.type() == self.type() && self.type().scalarType() != kHalf &&
+      index.dim() == 1 && source.dim() == self.dim() && source.size(0) == index.numel();
+  for (int64_t d = 1; rows && d < self.dim(); d++) {
+    rows = source.size(d) == self.size(d);
+  }
+  if (!rows) {
+    return self._th_index_add_(dim, index, source);
+  }
+  if (index.numel() == 0) {
+    return self;
+  }
+
+  auto index_contig = index.contiguous();
+  const int64_t* index_data = index_contig.data<int64_t>();
+  for (int64_t i = 0; i < index_contig.numel(); i++) {
+    AT_CHECK(index_data[i] >= 0 && index_data[i] < self.size(0), "index_add_(): index ",
+             index_data[i], " is out of bounds for dimension 0 with size ", self.size(0));
+  }
+  auto self_2d = self.view({self.size(0), -1});
+  auto source_2d = source.contiguous().view({source.size(0), -1});
+  index_add_rows_kernel(self_2d, index_contig, source_2d);
+  return self;
 }
 
 Tensor & index_copy_(Tensor & self, int64_t dim, const Tensor & index, const Tensor & source) {
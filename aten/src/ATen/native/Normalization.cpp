@@ -4,7 +4,9 @@
 #include "ATen/Config.h"
 
 #include "ATen/detail/CUDAHooksInterface.h"
+#include "ATen/native/cpu/NormalizationKernel.h"
 
+#include <tuple>
 #include <vector>
 
 namespace at { namespace native {
@@ -17,6 +19,18 @@ namespace {
       throw std::runtime_error(ss.str());
     }
   }
+
+  // The layer norm normalizes the input as M rows of N elements, N being the
+  // number of elements of normalized_shape
+  std::tuple<int64_t, int64_t> layer_norm_rows_and_cols(
+      const Tensor& input, IntList normalized_shape) {
+    int64_t M = 1, N = 1;
+    int64_t axis = input.dim() - normalized_shape.size();
+    for (int64_t i = 0; i < input.dim(); i++) {
+      (i < axis ? M : N) *= input.size(i);
+    }
+    return std::make_tuple(M, N);
+  }
 }
 
 Tensor batch_norm(
@@ -60,11 +74,130 @@ Tensor batch_norm(
                         training, momentum, eps));
   }
 
+  bool use_channels_last = (input.type().backend() == kCPU
+                            && (input.type().scalarType() == kFloat
+                              || input.type().scalarType() == kDouble)
+                            && input.is_channels_last()
+                            && (!running_mean.defined() || running_mean.type() == input.type())
+                            && (!running_var.defined() || running_var.type() == input.type())
+                            && (!weight.defined() || weight.type() == input.type())
+                            && (!bias.defined() || bias.type() == input.type()));
+
+  if (use_channels_last) {
+    return std::get<0>(at::_batch_norm_channels_last(
+                        input, weight, bias,
+                        running_mean, running_var,
+                        training, momentum, eps));
+  }
+
+  bool use_mkldnn = (!training
+                     && input.type().backend() == kCPU
+                     && input.type().scalarType() == kFloat
+                     && input.dim() == 4
+                     && running_mean.defined() && running_var.defined()
+                     && running_mean.type() == input.type()
+                     && running_var.type() == input.type()
+                     && (!weight.defined() || weight.type() == input.type())
+                     && (!bias.defined() || bias.type() == input.type())
+                     && hasMKLDNN());
+
+  if (use_mkldnn) {
+    return at::mkldnn_batch_norm(
+              input, weight, bias, running_mean, running_var, eps);
+  }
+
   return at::thnn_batch_norm(
             input, weight, bias,
             running_mean, running_var, training, momentum, eps);
 }
 
+// Batch norm followed by leaky_relu, computed in place. Backward saves only
+// the output (and the per channel invstd): it recovers the normalized input
+// from it, which requires negative_slope > 0 and no zero in weight.
+Tensor& inplace_abn_(
+    Tensor& self, const Tensor& weight /* optional */, const Tensor& bias /* optional */,
+    const Tensor& running_mean /* optional */, const Tensor& running_var /* optional */,
+    bool training, double momentum, double eps, double negative_slope) {
+  AT_CHECK(self.dim() >= 2, "inplace_abn_: expected an input with at least 2 dimensions, got ",
+           self.dim());
+  AT_CHECK(negative_slope > 0, "inplace_abn_: negative_slope must be positive, got ",
+           negative_slope);
+  auto num_features = self.size(1);
+  if (running_mean.defined()) {
+    check_dims_match_num_input_features("running_mean", num_features, running_mean.numel());
+  } else if (!training) {
+    throw std::runtime_error("running_mean must be defined in evaluation mode");
+  }
+  if (running_var.defined()) {
+    check_dims_match_num_input_features("running_var", num_features, running_var.numel());
+  } else if (!training) {
+    throw std::runtime_error("running_var must be defined in evaluation mode");
+  }
+  if (weight.defined()) {
+    check_dims_match_num_input_features("weight", num_features, weight.numel());
+  }
+  if (bias.defined()) {
+    check_dims_match_num_input_features("bias", num_features, bias.numel());
+  }
+
+  Tensor mean, invstd;
+  std::tie(mean, invstd) = at::_inplace_abn_stats(
+      self, running_mean, running_var, training, momentum, eps);
+  return at::_inplace_abn_forward_(self, weight, bias, mean, invstd, training, negative_slope);
+}
+
+// The mean and biased variance of each channel (dimension 1) of self
+std::tuple<Tensor, Tensor> _batch_norm_stats_cpu(const Tensor& self) {
+  AT_CHECK(self.dim() >= 2, "_batch_norm_stats: expected an input with at least 2 dimensions, got ",
+           self.dim());
+  auto channels = self.transpose(0, 1).contiguous().view({self.size(1), -1});
+  return std::make_tuple(channels.mean(1), channels.var(1, /*unbiased=*/false));
+}
+
+// The per channel mean and invstd inplace_abn_ normalizes with: those of the
+// batch (also folded into the running statistics) in training mode, those of
+// the running statistics in evaluation mode
+std::tuple<Tensor, Tensor> _inplace_abn_stats(
+    const Tensor& self, const Tensor& running_mean_, const Tensor& running_var_,
+    bool training, double momentum, double eps) {
+  // the running statistics are updated in place, like in thnn_batch_norm
+  Tensor& running_mean = const_cast<Tensor&>(running_mean_);
+  Tensor& running_var = const_cast<Tensor&>(running_var_);
+  if (!training) {
+    return std::make_tuple(running_mean.toType(self.type()),
+                           running_var.toType(self.type()).add(eps).rsqrt());
+  }
+  Tensor mean, var;
+  std::tie(mean, var) = at::_batch_norm_stats(self);
+  if (running_mean.defined()) {
+    running_mean.mul_(1 - momentum).add_(mean.toType(running_mean.type()), momentum);
+  }
+  if (running_var.defined()) {
+    // the running variance is unbiased
+    int64_t n = self.size(1) > 0 ? self.numel() / self.size(1) : 0;
+    auto unbiased_var = n > 1 ? var.mul(static_cast<double>(n) / (n - 1)) : var;
+    running_var.mul_(1 - momentum).add_(unbiased_var.toType(running_var.type()), momentum);
+  }
+  return std::make_tuple(mean, var.add(eps).rsqrt());
+}
+
+// training is only used by the backward, which sees the batch statistics as
+// functions of the input in training mode
+Tensor& _inplace_abn_forward_(
+    Tensor& self, const Tensor& weight /* optional */, const Tensor& bias /* optional */,
+    const Tensor& mean, const Tensor& invstd, bool training, double negative_slope) {
+  std::vector<int64_t> shape(self.dim(), 1);
+  shape[1] = self.size(1);
+  self.sub_(mean.view(shape)).mul_(invstd.view(shape));
+  if (weight.defined()) {
+    self.mul_(weight.view(shape));
+  }
+  if (bias.defined()) {
+    self.add_(bias.view(shape));
+  }
+  return at::leaky_relu_(self, negative_slope);
+}
+
 Tensor layer_norm(const Tensor& input, IntList normalized_shape,
     const Tensor& weight /* optional */, const Tensor& bias /* optional */,
     double eps, bool cudnn_enabled) {
@@ -110,27 +243,8 @@ Tensor layer_norm(const Tensor& input, IntList normalized_shape,
       throw std::runtime_error(ss.str());
     }
 
-    int64_t n = 1;
-    for (int64_t i = 0; i < input_ndim - normalized_ndim; i++) {
-      n *= input_shape[i];
-    }
-
-    // Apply layer norm
-    auto input_reshaped = input.contiguous().view({1, n, -1});
-
-    auto out = at::batch_norm(input_reshaped, {}, {}, {}, {}, true, 0, eps,
-                              cudnn_enabled);
-    out = out.view(input_shape);
-
-    if (weight.defined() && bias.defined()) {
-      return bias.addcmul(out, weight, 1);
-    } else if (weight.defined()) {
-      return out.mul(weight);
-    } else if (bias.defined()) {
-      return out.add(bias);
-    } else {
-      return out;
-    }
+    return std::get<0>(at::_layer_norm_forward(input, normalized_shape, weight,
+                                               bias, eps));
 }
 
 Tensor group_norm(const Tensor& input, int64_t num_groups,
@@ -165,27 +279,79 @@ Tensor group_norm(const Tensor& input, int64_t num_groups,
       throw std::runtime_error(ss.str());
     }
 
-    // Apply group norm
-    auto input_reshaped = input.contiguous().view({1, b * num_groups, -1});
+    int64_t hxw = 1;
+    for (int64_t i = 2; i < input.dim(); i++) {
+      hxw *= input_shape[i];
+    }
+
+    return std::get<0>(at::_group_norm_forward(input, weight, bias, b, c, hxw,
+                                               num_groups, eps));
+}
 
-    auto out = at::batch_norm(input_reshaped, {}, {}, {}, {}, true, 0, eps,
-                              cudnn_enabled);
-    out = out.view(input_shape);
+std::tuple<Tensor, Tensor, Tensor> layer_norm_cpu(
+    const Tensor& input_, IntList normalized_shape, const Tensor& weight_,
+    const Tensor& bias_, double eps) {
+  int64_t M, N;
+  std::tie(M, N) = layer_norm_rows_and_cols(input_, normalized_shape);
+  auto input = input_.contiguous();
+  auto weight = weight_.defined() ? weight_.contiguous() : weight_;
+  auto bias = bias_.defined() ? bias_.contiguous() : bias_;
+  auto output = at::empty_like(input);
+  auto mean = input.type().tensor({M});
+  auto rstd = input.type().tensor({M});
+  layer_norm_kernel(output, mean, rstd, input, weight, bias, M, N, eps);
+  return std::make_tuple(output, mean, rstd);
+}
 
-    if (!weight.defined() && !bias.defined()) {
-      return out;
-    }
+std::tuple<Tensor, Tensor, Tensor> layer_norm_backward_cpu(
+    const Tensor& grad_out_, const Tensor& input_, IntList normalized_shape,
+    const Tensor& mean_, const Tensor& rstd_, const Tensor& weight_,
+    std::array<bool,3> output_mask) {
+  int64_t M, N;
+  std::tie(M, N) = layer_norm_rows_and_cols(input_, normalized_shape);
+  auto grad_out = grad_out_.contiguous();
+  auto input = input_.contiguous();
+  auto mean = mean_.contiguous();
+  auto rstd = rstd_.contiguous();
+  auto weight = weight_.defined() ? weight_.contiguous() : weight_;
+  Tensor grad_input, grad_weight, grad_bias;
+  if (output_mask[0]) grad_input = at::empty_like(input);
+  if (output_mask[1]) grad_weight = input.type().tensor(normalized_shape);
+  if (output_mask[2]) grad_bias = input.type().tensor(normalized_shape);
+  layer_norm_backward_kernel(grad_input, grad_weight, grad_bias, grad_out, input,
+                             mean, rstd, weight, M, N);
+  return std::make_tuple(grad_input, grad_weight, grad_bias);
+}
 
-    std::vector<int64_t> affine_param_shape(input.dim(), 1);
-    affine_param_shape[1] = c;
+std::tuple<Tensor, Tensor, Tensor> group_norm_cpu(
+    const Tensor& input_, const Tensor& weight_, const Tensor& bias_,
+    int64_t N, int64_t C, int64_t HxW, int64_t group, double eps) {
+  auto input = input_.contiguous();
+  auto weight = weight_.defined() ? weight_.contiguous() : weight_;
+  auto bias = bias_.defined() ? bias_.contiguous() : bias_;
+  auto output = at::empty_like(input);
+  auto mean = input.type().tensor({N * group});
+  auto rstd = input.type().tensor({N * group});
+  group_norm_kernel(output, mean, rstd, input, weight, bias, N, C, HxW, group, eps);
+  return std::make_tuple(output, mean, rstd);
+}
 
-    if (weight.defined() && bias.defined()) {
-      return bias.view(affine_param_shape).addcmul(out, weight.view(affine_param_shape), 1);
-    } else if (weight.defined()) {
-      return out.mul(weight.view(affine_param_shape));
-    } else {
-      return out.add(bias.view(affine_param_shape));
-    }
+std::tuple<Tensor, Tensor, Tensor> group_norm_backward_cpu(
+    const Tensor& grad_out_, const Tensor& input_, const Tensor& mean_,
+    const Tensor& rstd_, const Tensor& weight_, int64_t N, int64_t C,
+    int64_t HxW, int64_t group, std::array<bool,3> output_mask) {
+  auto grad_out = grad_out_.contiguous();
+  auto input = input_.contiguous();
+  auto mean = mean_.contiguous();
+  auto rstd = rstd_.contiguous();
+  auto weight = weight_.defined() ? weight_.contiguous() : weight_;
+  Tensor grad_input, grad_weight, grad_bias;
+  if (output_mask[0]) grad_input = at::empty_like(input);
+  if (output_mask[1]) grad_weight = input.type().tensor({C});
+  if (output_mask[2]) grad_bias = input.type().tensor({C});
+  group_norm_backward_kernel(grad_input, grad_weight, grad_bias, grad_out, input,
+                             mean, rstd, weight, N, C, HxW, group);
+  return std::make_tuple(grad_input, grad_weight, grad_bias);
 }
 
 }} // at::native
@@ -0,0 +1,137 @@
+#include "ATen/ATen.h"
+#include "ATen/Config.h"
+#include "ATen/NativeFunctions.h"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#if AT_MKL_ENABLED()
+#include <mkl.h>
+#endif
+
+// Linear layers with a fixed weight. BLAS packs its operands into its own
+// blocked layout on every gemm call; for inference with a weight that never
+// changes, _linear_prepack does that work once and _linear_packed reuses it.
+//
+// The packed weight is either
+//  - with MKL and a float weight, a byte tensor holding a PackedLinearHeader
+//    followed by the weight packed by cblas_sgemm_pack for the batch size
+//    passed to _linear_prepack (the packed layout depends on it, which is
+//    also why Caffe2's PackedFC repacks when its batch size changes), or
+//  - otherwise, the contiguous (in_features, out_features) transposed weight,
+//    which works for any batch size. A half weight stays half, and is
+//    converted back to float in panels of rows as it is used, so that a
+//    model stored in half only ever holds a panel of its weight in float.
+
+namespace at { namespace native {
+
+namespace {
+
+#if AT_MKL_ENABLED()
+
+struct PackedLinearHeader {
+  int64_t batch_size;
+  int64_t out_features;
+  int64_t in_features;
+};
+
+// The packed data starts at a 64-byte offset to keep the alignment of the
+// allocation
+constexpr int64_t kPackedDataOffset = 64;
+static_assert(sizeof(PackedLinearHeader) <= kPackedDataOffset, "PackedLinearHeader too large");
+
+PackedLinearHeader packed_header(const Tensor& packed_weight) {
+  AT_CHECK(packed_weight.dim() == 1 && packed_weight.is_contiguous() &&
+           packed_weight.numel() >= kPackedDataOffset,
+           "_linear_packed: expected a weight returned by _linear_prepack");
+  PackedLinearHeader header;
+  std::memcpy(&header, packed_weight.data<uint8_t>(), sizeof(header));
+  return header;
+}
+
+float* packed_data(const Tensor& packed_weight) {
+  return reinterpret_cast<float*>(packed_weight.data<uint8_t>() + kPackedDataOffset);
+}
+
+#endif
+
+// Floats per panel of a half weight, which stays in cache while it's used
+constexpr int64_t kHalfPanelSize = 1 << 16;
+
+} // namespace
+
+Tensor _linear_prepack(const Tensor& weight, int64_t batch_size) {
+  AT_CHECK(weight.dim() == 2, "_linear_prepack: expected a 2-d weight, got ", weight.dim(), "-d");
+  AT_CHECK(batch_size > 0, "_linear_prepack: expected a positive batch size, got ", batch_size);
+#if AT_MKL_ENABLED()
+  if (weight.type().scalarType() == kFloat) {
+    auto w = weight.contiguous();
+    PackedLinearHeader header{batch_size, w.size(0), w.size(1)};
+    // op(B) = weight^T, so that output = input * op(B)
+    int64_t size = cblas_sgemm_pack_get_size(CblasBMatrix, batch_size, header.out_features,
+                                            header.in_features);
+    auto packed = w.type().toScalarType(kByte).tensor({kPackedDataOffset + size});
+    std::memcpy(packed.data<uint8_t>(), &header, sizeof(header));
+    cblas_sgemm_pack(CblasRowMajor, CblasBMatrix, CblasTrans, batch_size, header.out_features,
+                     header.in_features, 1.0f, w.data<float>(), header.in_features,
+                     packed_data(packed));
+    return packed;
+  }
+#endif
+  return weight.t().contiguous();
+}
+
+Tensor _linear_packed(const Tensor& input, const Tensor& packed_weight, const Tensor& bias) {
+  AT_CHECK(input.dim() >= 1, "_linear_packed: expected an input with at least one dimension");
+  int64_t in_features = input.size(-1);
+  auto input_2d = input.contiguous().view({-1, in_features});
+  int64_t batch_size = input_2d.size(0);
+  std::vector<int64_t> output_size(input.sizes().begin(), input.sizes().end() - 1);
+
+#if AT_MKL_ENABLED()
+  if (packed_weight.type().scalarType() == kByte) {
+    auto header = packed_header(packed_weight);
+    AT_CHECK(input.type().scalarType() == kFloat,
+             "_linear_packed: expected a float input for an MKL packed weight, got ",
+             input.toString());
+    AT_CHECK(header.in_features == in_features, "_linear_packed: expected ",
+             header.in_features, " input features, got ", in_features);
+    AT_CHECK(header.batch_size == batch_size, "_linear_packed: the weight was packed for a batch "
+             "size of ", header.batch_size, ", got ", batch_size);
+    output_size.push_back(header.out_features);
+    auto output = input.type().tensor({batch_size, header.out_features});
+    if (bias.defined()) {
+      output.copy_(bias.expand_as(output));
+    }
+    cblas_sgemm_compute(CblasRowMajor, CblasNoTrans, CblasPacked, batch_size,
+                        header.out_features, in_features, input_2d.data<float>(), in_features,
+                        packed_data(packed_weight), header.out_features,
+                        bias.defined() ? 1.0f : 0.0f, output.data<float>(), header.out_features);
+    return output.view(output_size);
+  }
+#endif
+
+  AT_CHECK(packed_weight.dim() == 2 && packed_weight.size(0) == in_features,
+           "_linear_packed: expected a weight returned by _linear_prepack with ", in_features,
+           " input features, got sizes ", packed_weight.sizes());
+  output_size.push_back(packed_weight.size(1));
+  if (packed_weight.type().scalarType() == kHalf) {
+    AT_CHECK(input.type().scalarType() == kFloat,
+             "_linear_packed: expected a float input for a half weight, got ", input.toString());
+    int64_t out_features = packed_weight.size(1);
+    auto output = bias.defined() ? bias.expand({batch_size, out_features}).contiguous()
+                                 : input.type().zeros({batch_size, out_features});
+    int64_t panel_rows = std::max<int64_t>(1, kHalfPanelSize / std::max<int64_t>(1, out_features));
+    for (int64_t k = 0; k < in_features; k += panel_rows) {
+      int64_t rows = std::min(panel_rows, in_features - k);
+      output.addmm_(input_2d.narrow(1, k, rows), packed_weight.narrow(0, k, rows).toType(kFloat));
+    }
+    return output.view(output_size);
+  }
+  auto output = bias.defined() ? at::addmm(bias, input_2d, packed_weight)
+                               : at::mm(input_2d, packed_weight);
+  return output.view(output_size);
+}
+
+}} // namespace at::native
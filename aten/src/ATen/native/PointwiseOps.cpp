@@ -0,0 +1,93 @@
+// Ternary and scalar-weighted binary pointwise ops (lerp, addcmul, addcdiv).
+// The CPU versions build a TensorIterator over their operands and run the
+// vectorized kernels in native/cpu/PointwiseOpsKernel.cpp; anything those
+// kernels do not handle (integral types, sparse arguments, mismatched types)
+// is forwarded to TH, which also produces the error messages for invalid
+// arguments.
+
+#include "ATen/ATen.h"
+#include "ATen/ExpandUtils.h"
+#include "ATen/NativeFunctions.h"
+#include "ATen/native/TensorIterator.h"
+#include "ATen/native/cpu/PointwiseOpsKernel.h"
+
+#include <tuple>
+
+namespace at {
+namespace native {
+
+static bool can_use_pointwise_kernel(
+    const Tensor& self,
+    std::initializer_list<std::reference_wrapper<const Tensor>> others) {
+  if (!isFloatingType(self.type().scalarType())) {
+    return false;
+  }
+  for (const Tensor& other : others) {
+    if (other.is_sparse() || other.type() != self.type()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+Tensor lerp(const Tensor& self, const Tensor& end, Scalar weight) {
+  Tensor result = self.type().tensor();
+  return at::lerp_out(result, self, end, weight);
+}
+
+Tensor& _lerp__cpu(Tensor& self, const Tensor& end, Scalar weight) {
+  if (!can_use_pointwise_kernel(self, {end})) {
+    return self._th_lerp_(end, weight);
+  }
+  Tensor b_end;
+  std::tie(b_end) = expand_inplace(self, end, "lerp_");
+  auto iter = TensorIterator::binary_op(self, self, b_end);
+  lerpImpl(iter, weight);
+  return self;
+}
+
+Tensor& _lerp_out_cpu(Tensor& result, const Tensor& self, const Tensor& end, Scalar weight) {
+  if (!can_use_pointwise_kernel(result, {self, end})) {
+    return at::_th_lerp_out(result, self, end, weight);
+  }
+  auto iter = TensorIterator::binary_op(result, self, end);
+  lerpImpl(iter, weight);
+  return result;
+}
+
+#define IMPLEMENT_POINTWISE_OP(op)                                            \
+  Tensor op(                                                                  \
+      const Tensor& self, const Tensor& tensor1, const Tensor& tensor2,       \
+      Scalar value) {                                                         \
+    Tensor result = self.type().tensor();                                     \
+    return at::op##_out(result, self, tensor1, tensor2, value);               \
+  }                                                                           \
+  Tensor& _##op##__cpu(                                                       \
+      Tensor& self, const Tensor& tensor1, const Tensor& tensor2,             \
+      Scalar value) {                                                         \
+    if (!can_use_pointwise_kernel(self, {tensor1, tensor2})) {                \
+      return self._th_##op##_(tensor1, tensor2, value);                       \
+    }                                                                         \
+    Tensor b_tensor1, b_tensor2;                                              \
+    std::tie(b_tensor1, b_tensor2) =                                          \
+        expand_inplace(self, tensor1, tensor2, #op "_");                      \
+    auto iter = TensorIterator::ternary_op(self, self, b_tensor1, b_tensor2); \
+    op##Impl(iter, value);                                                    \
+    return self;                                                              \
+  }                                                                           \
+  Tensor& _##op##_out_cpu(                                                    \
+      Tensor& result, const Tensor& self, const Tensor& tensor1,              \
+      const Tensor& tensor2, Scalar value) {                                  \
+    if (!can_use_pointwise_kernel(result, {self, tensor1, tensor2})) {        \
+      return at::_th_##op##_out(result, self, tensor1, tensor2, value);       \
+    }                                                                         \
+    auto iter = TensorIterator::ternary_op(result, self, tensor1, tensor2);   \
+    op##Impl(iter, value);                                                    \
+    return result;                                                            \
+  }
+
+IMPLEMENT_POINTWISE_OP(addcmul)
+IMPLEMENT_POINTWISE_OP(addcdiv)
+
+}
+} // namespace at
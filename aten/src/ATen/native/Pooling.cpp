@@ -1,11 +1,13 @@
 #include "ATen/ATen.h"
 #include "ATen/TensorUtils.h"
 #include "ATen/NativeFunctions.h"
+#include "ATen/native/PoolingUtils.h"
+#include "ATen/native/cpu/PoolingKernel.h"
 
 #include <sstream>
+#include <tuple>
 #include <vector>
 
-
 namespace at { namespace native {
 
 static void check1d(const char* name, IntList x) {
@@ -17,13 +19,39 @@ static void check1d(const char* name, IntList x) {
   }
 }
 
+// Whether the _*_pool2d_contiguous kernels take self, which the 1-d poolings
+// below unsqueeze to 2-d
+static bool use_contiguous_pooling(const Tensor& self) {
+  return self.type().backend() == kCPU &&
+         (self.type().scalarType() == kFloat || self.type().scalarType() == kDouble) &&
+         self.is_contiguous();
+}
+
+static void check_contiguous_pooling(const char* name, const Tensor& input) {
+  AT_CHECK(input.type().backend() == kCPU, name, ": expected a CPU tensor, got ", input.toString());
+  AT_CHECK(input.dim() == 3 || input.dim() == 4, name, ": expected a 3-d or 4-d tensor, got ",
+           input.dim(), "-d");
+  AT_CHECK(input.is_contiguous(), name, ": expected a contiguous tensor");
+  AT_CHECK(input.size(-2) > 0 && input.size(-1) > 0, name, ": expected a non-empty plane, got size ",
+           input.sizes());
+}
+
+// The size of input with the last two dimensions replaced by oH x oW
+static std::vector<int64_t> pooled_size(const Tensor& input, int64_t oH, int64_t oW) {
+  auto size = input.sizes().vec();
+  size[size.size() - 2] = oH;
+  size[size.size() - 1] = oW;
+  return size;
+}
+
 Tensor adaptive_avg_pool1d(const Tensor & self, IntList output_size) {
   checkDim("adaptive_avg_pool1d", TensorArg(self, "self", 1), 3);
   check1d("output_size", output_size);
 
-  auto output = at::adaptive_avg_pool2d(
-      self.unsqueeze(2),
-      {1, output_size[0]});
+  auto input = self.unsqueeze(2);
+  auto output = use_contiguous_pooling(input)
+      ? at::_adaptive_avg_pool2d_contiguous(input, {1, output_size[0]})
+      : at::adaptive_avg_pool2d(input, {1, output_size[0]});
 
   return output.squeeze(2);
 }
@@ -32,10 +60,11 @@ std::tuple<Tensor,Tensor> adaptive_max_pool1d(const Tensor & self, IntList outpu
   checkDim("adaptive_max_pool1d", TensorArg(self, "self", 1), 3);
   check1d("output_size", output_size);
 
+  auto input = self.unsqueeze(2);
   Tensor output, indices;
-  std::tie(output, indices) = at::adaptive_max_pool2d(
-      self.unsqueeze(2),
-      {1, output_size[0]});
+  std::tie(output, indices) = use_contiguous_pooling(input)
+      ? at::_adaptive_max_pool2d_contiguous(input, {1, output_size[0]})
+      : at::adaptive_max_pool2d(input, {1, output_size[0]});
 
   return std::make_tuple(output.squeeze(2), indices.squeeze(2));
 }
@@ -53,16 +82,73 @@ std::tuple<Tensor,Tensor> max_pool1d(
   check1d("padding", padding);
   check1d("dilation", dilation);
 
+  auto input = self.unsqueeze(2);
   Tensor output, indices;
-  std::tie(output, indices) = at::max_pool2d(
-      self.unsqueeze(2),
-      {1, kernel_size[0]},
-      {1, stride[0]},
-      {0, padding[0]},
-      {1, dilation[0]},
-      ceil_mode);
+  std::tie(output, indices) = use_contiguous_pooling(input)
+      ? at::_max_pool2d_contiguous(
+            input, {1, kernel_size[0]}, {1, stride[0]}, {0, padding[0]},
+            {1, dilation[0]}, ceil_mode)
+      : at::max_pool2d(
+            input, {1, kernel_size[0]}, {1, stride[0]}, {0, padding[0]},
+            {1, dilation[0]}, ceil_mode);
 
   return std::make_tuple(output.squeeze(2), indices.squeeze(2));
 }
 
+std::tuple<Tensor, Tensor> _max_pool2d_contiguous_cpu(
+    const Tensor& self, IntList kernel_size, IntList stride, IntList padding,
+    IntList dilation, bool ceil_mode) {
+  check_contiguous_pooling("_max_pool2d_contiguous", self);
+  int64_t output_size[2];
+  for (int64_t d = 0; d < 2; d++) {
+    output_size[d] = pooling_output_size("_max_pool2d_contiguous", self.size(d - 2),
+                                         kernel_size[d], stride[d], padding[d],
+                                         dilation[d], ceil_mode);
+  }
+  auto size = pooled_size(self, output_size[0], output_size[1]);
+  auto output = self.type().tensor(size);
+  auto indices = self.type().toScalarType(kLong).tensor(size);
+  max_pool2d_kernel(output, indices, self, kernel_size[0], kernel_size[1],
+                    stride[0], stride[1], padding[0], padding[1],
+                    dilation[0], dilation[1]);
+  return std::make_tuple(output, indices);
+}
+
+Tensor _avg_pool2d_contiguous_cpu(
+    const Tensor& self, IntList kernel_size, IntList stride, IntList padding,
+    bool ceil_mode, bool count_include_pad) {
+  check_contiguous_pooling("_avg_pool2d_contiguous", self);
+  int64_t output_size[2];
+  for (int64_t d = 0; d < 2; d++) {
+    output_size[d] = pooling_output_size("_avg_pool2d_contiguous", self.size(d - 2),
+                                         kernel_size[d], stride[d], padding[d], 1,
+                                         ceil_mode);
+  }
+  auto output = self.type().tensor(pooled_size(self, output_size[0], output_size[1]));
+  avg_pool2d_kernel(output, self, kernel_size[0], kernel_size[1],
+                    stride[0], stride[1], padding[0], padding[1], count_include_pad);
+  return output;
+}
+
+Tensor _adaptive_avg_pool2d_contiguous_cpu(const Tensor& self, IntList output_size) {
+  check_contiguous_pooling("_adaptive_avg_pool2d_contiguous", self);
+  AT_CHECK(output_size[0] > 0 && output_size[1] > 0,
+           "_adaptive_avg_pool2d_contiguous: expected a positive output size, got ", output_size);
+  auto output = self.type().tensor(pooled_size(self, output_size[0], output_size[1]));
+  adaptive_avg_pool2d_kernel(output, self);
+  return output;
+}
+
+std::tuple<Tensor, Tensor> _adaptive_max_pool2d_contiguous_cpu(
+    const Tensor& self, IntList output_size) {
+  check_contiguous_pooling("_adaptive_max_pool2d_contiguous", self);
+  AT_CHECK(output_size[0] > 0 && output_size[1] > 0,
+           "_adaptive_max_pool2d_contiguous: expected a positive output size, got ", output_size);
+  auto size = pooled_size(self, output_size[0], output_size[1]);
+  auto output = self.type().tensor(size);
+  auto indices = self.type().toScalarType(kLong).tensor(size);
+  adaptive_max_pool2d_kernel(output, indices, self);
+  return std::make_tuple(output, indices);
+}
+
 }}  // namespace at::native
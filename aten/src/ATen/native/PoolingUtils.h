@@ -0,0 +1,28 @@
+#pragma once
+
+#include "ATen/ATen.h"
+
+#include <cmath>
+
+namespace at { namespace native {
+
+// The output size of a pooling along one dimension, same as THNN's
+// pooling_shape of SpatialDilatedMaxPooling and SpatialAveragePooling
+static inline int64_t pooling_output_size(
+    const char* name, int64_t input_size, int64_t kernel, int64_t stride,
+    int64_t pad, int64_t dilation, bool ceil_mode) {
+  AT_CHECK(kernel > 0 && stride > 0 && dilation > 0,
+           name, ": kernel size, stride and dilation should be greater than zero");
+  AT_CHECK(kernel / 2 >= pad, name, ": pad should be smaller than half of kernel size, but got pad = ",
+           pad, ", kernel size = ", kernel);
+  auto size = static_cast<float>(input_size - (dilation * (kernel - 1) + 1) + 2 * pad) / stride;
+  auto output_size = static_cast<int64_t>(ceil_mode ? std::ceil(size) : std::floor(size)) + 1;
+  // ensure that the last pooling starts inside the image
+  if (pad && (output_size - 1) * stride >= input_size + pad) {
+    --output_size;
+  }
+  AT_CHECK(output_size >= 1, name, ": output size is too small for input size ", input_size);
+  return output_size;
+}
+
+}} // namespace at::native
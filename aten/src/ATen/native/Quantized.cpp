@@ -0,0 +1,272 @@
+#include "ATen/ATen.h"
+#include "ATen/NativeFunctions.h"
+#include "ATen/Parallel.h"
+#include "ATen/TensorUtils.h"
+#include "ATen/native/cpu/QuantizedGemmKernel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <tuple>
+#include <vector>
+
+// Int8 inference. ATen has no quantized dtype, so quantized tensors are
+// plain integer tensors and their parameters are passed alongside:
+//  - activations are uint8 with an affine scale and zero point,
+//    x = scale * (q - zero_point), like Caffe2's Int8TensorCPU;
+//  - weights are int8 with one symmetric scale per output channel,
+//    w[o] = scales[o] * q[o], as returned by quantize_per_channel.
+// quantized_linear and quantized_conv2d take float inputs, quantize them on
+// the fly with the range of the whole input, accumulate the products in int32
+// and return float outputs, so they can replace linear and conv2d in a float
+// model without quantize/dequantize nodes between layers.
+
+namespace at { namespace native {
+
+namespace {
+
+struct QuantParams {
+  float scale;
+  int32_t zero_point;
+};
+
+// Affine uint8 parameters covering [min(x, 0), max(x, 0)], so that 0 is
+// exactly representable (padding is quantized to zero_point)
+QuantParams choose_quant_params(const float* data, int64_t numel) {
+  float min = 0, max = 0;
+  if (numel > 0) {
+    auto minmax = std::minmax_element(data, data + numel);
+    min = std::min(*minmax.first, 0.f);
+    max = std::max(*minmax.second, 0.f);
+  }
+  if (max == min) {
+    return {1.f, 0};
+  }
+  float scale = (max - min) / 255;
+  auto zero_point = static_cast<int32_t>(std::nearbyint(-min / scale));
+  return {scale, std::min(std::max(zero_point, 0), 255)};
+}
+
+void quantize(const float* x, int64_t numel, QuantParams p, uint8_t* q) {
+  float inv_scale = 1 / p.scale;
+  parallel_for(0, numel, internal::TBB_GRAIN_SIZE, [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; i++) {
+      float v = std::nearbyint(x[i] * inv_scale) + p.zero_point;
+      q[i] = static_cast<uint8_t>(std::min(std::max(v, 0.f), 255.f));
+    }
+  });
+}
+
+void check_quantized_weight(CheckedFrom c, const Tensor& weight, const Tensor& weight_scales,
+                            int64_t dim) {
+  auto weight_arg = TensorArg(weight, "weight", 2);
+  auto scales_arg = TensorArg(weight_scales, "weight_scales", 3);
+  checkScalarType(c, weight_arg, kChar);
+  checkDim(c, weight_arg, dim);
+  checkContiguous(c, weight_arg);
+  checkScalarType(c, scales_arg, kFloat);
+  checkContiguous(c, scales_arg);
+  checkSize(c, scales_arg, {weight.size(0)});
+}
+
+void check_quantized_bias(CheckedFrom c, const Tensor& bias, int64_t channels) {
+  if (bias.defined()) {
+    auto bias_arg = TensorArg(bias, "bias", 4);
+    checkScalarType(c, bias_arg, kFloat);
+    checkSize(c, bias_arg, {channels});
+  }
+}
+
+// Sum of every row of the (N, K) int8 weight, to subtract the zero point
+// of the input from the int32 products
+std::vector<int32_t> row_sums(const Tensor& weight_2d) {
+  int64_t N = weight_2d.size(0);
+  int64_t K = weight_2d.size(1);
+  const int8_t* w = weight_2d.data<int8_t>();
+  std::vector<int32_t> sums(N);
+  for (int64_t n = 0; n < N; n++) {
+    int32_t sum = 0;
+    for (int64_t k = 0; k < K; k++) {
+      sum += w[n * K + k];
+    }
+    sums[n] = sum;
+  }
+  return sums;
+}
+
+} // namespace
+
+Tensor quantize_linear_cpu(const Tensor& self, double scale, int64_t zero_point) {
+  auto self_arg = TensorArg(self, "self", 1);
+  checkScalarType("quantize_linear", self_arg, kFloat);
+  AT_CHECK(scale > 0, "quantize_linear: expected a positive scale, got ", scale);
+  AT_CHECK(zero_point >= 0 && zero_point <= 255,
+           "quantize_linear: expected a zero point in [0, 255], got ", zero_point);
+  auto input = self.contiguous();
+  auto result = input.type().toScalarType(kByte).tensor(input.sizes());
+  quantize(input.data<float>(), input.numel(),
+           {static_cast<float>(scale), static_cast<int32_t>(zero_point)}, result.data<uint8_t>());
+  return result;
+}
+
+Tensor dequantize_linear_cpu(const Tensor& self, double scale, int64_t zero_point) {
+  auto self_arg = TensorArg(self, "self", 1);
+  checkScalarType("dequantize_linear", self_arg, kByte);
+  return (self.toType(kFloat) - static_cast<double>(zero_point)).mul_(scale);
+}
+
+std::tuple<Tensor, Tensor> quantize_per_channel_cpu(const Tensor& self) {
+  auto self_arg = TensorArg(self, "self", 1);
+  checkScalarType("quantize_per_channel", self_arg, kFloat);
+  AT_CHECK(self.dim() >= 1, "quantize_per_channel: expected a tensor with at least one dimension");
+  auto weight = self.contiguous();
+  int64_t channels = weight.size(0);
+  int64_t channel_size = channels > 0 ? weight.numel() / channels : 0;
+  auto result = weight.type().toScalarType(kChar).tensor(weight.sizes());
+  auto scales = weight.type().tensor({channels});
+  const float* w = weight.data<float>();
+  int8_t* q = result.data<int8_t>();
+  float* s = scales.data<float>();
+  parallel_for(0, channels, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t o = begin; o < end; o++) {
+      const float* w_o = w + o * channel_size;
+      float max = 0;
+      for (int64_t k = 0; k < channel_size; k++) {
+        max = std::max(max, std::abs(w_o[k]));
+      }
+      // symmetric [-127, 127], so that negating a weight is exact
+      float scale = max > 0 ? max / 127 : 1;
+      for (int64_t k = 0; k < channel_size; k++) {
+        float v = std::nearbyint(w_o[k] / scale);
+        q[o * channel_size + k] = static_cast<int8_t>(std::min(std::max(v, -127.f), 127.f));
+      }
+      s[o] = scale;
+    }
+  });
+  return std::make_tuple(result, scales);
+}
+
+Tensor quantized_linear_cpu(const Tensor& input_, const Tensor& weight, const Tensor& weight_scales,
+                            const Tensor& bias) {
+  auto input_arg = TensorArg(input_, "input", 1);
+  checkScalarType("quantized_linear", input_arg, kFloat);
+  check_quantized_weight("quantized_linear", weight, weight_scales, 2);
+  check_quantized_bias("quantized_linear", bias, weight.size(0));
+  int64_t K = weight.size(1);
+  int64_t N = weight.size(0);
+  AT_CHECK(input_.dim() >= 1 && input_.size(-1) == K, "quantized_linear: expected an input with ",
+           K, " features, got sizes ", input_.sizes());
+  auto input = input_.contiguous().view({-1, K});
+  int64_t M = input.size(0);
+
+  auto params = choose_quant_params(input.data<float>(), input.numel());
+  auto input_q = input.type().toScalarType(kByte).tensor({M, K});
+  quantize(input.data<float>(), input.numel(), params, input_q.data<uint8_t>());
+  auto acc = input.type().toScalarType(kInt).tensor({M, N});
+  u8s8_gemm_kernel(acc, input_q, weight);
+
+  auto sums = row_sums(weight);
+  auto output = input.type().tensor({M, N});
+  auto bias_c = bias.defined() ? bias.contiguous() : bias;
+  const int32_t* acc_data = acc.data<int32_t>();
+  const float* scales = weight_scales.data<float>();
+  const float* bias_data = bias.defined() ? bias_c.data<float>() : nullptr;
+  float* out = output.data<float>();
+  parallel_for(0, M, std::max<int64_t>(1, internal::TBB_GRAIN_SIZE / std::max<int64_t>(1, N)),
+               [&](int64_t begin, int64_t end) {
+    for (int64_t m = begin; m < end; m++) {
+      for (int64_t n = 0; n < N; n++) {
+        float v = params.scale * scales[n] * (acc_data[m * N + n] - params.zero_point * sums[n]);
+        out[m * N + n] = bias_data ? v + bias_data[n] : v;
+      }
+    }
+  });
+
+  std::vector<int64_t> output_size(input_.sizes().begin(), input_.sizes().end() - 1);
+  output_size.push_back(N);
+  return output.view(output_size);
+}
+
+Tensor quantized_conv2d_cpu(const Tensor& input_, const Tensor& weight, const Tensor& weight_scales,
+                            const Tensor& bias, IntList stride, IntList padding, IntList dilation,
+                            int64_t groups) {
+  auto input_arg = TensorArg(input_, "input", 1);
+  checkScalarType("quantized_conv2d", input_arg, kFloat);
+  checkDim("quantized_conv2d", input_arg, 4);
+  check_quantized_weight("quantized_conv2d", weight, weight_scales, 4);
+  check_quantized_bias("quantized_conv2d", bias, weight.size(0));
+  AT_CHECK(groups > 0 && input_.size(1) % groups == 0 && weight.size(0) % groups == 0 &&
+           weight.size(1) * groups == input_.size(1),
+           "quantized_conv2d: expected a weight of size (K, ", input_.size(1) / std::max<int64_t>(groups, 1),
+           ", kH, kW) with K a multiple of groups = ", groups, ", got ", weight.sizes());
+  auto input = input_.contiguous();
+  int64_t batch = input.size(0), C = input.size(1), iH = input.size(2), iW = input.size(3);
+  int64_t K = weight.size(0), kH = weight.size(2), kW = weight.size(3);
+  int64_t oH = (iH + 2 * padding[0] - dilation[0] * (kH - 1) - 1) / stride[0] + 1;
+  int64_t oW = (iW + 2 * padding[1] - dilation[1] * (kW - 1) - 1) / stride[1] + 1;
+  AT_CHECK(oH > 0 && oW > 0, "quantized_conv2d: the output of an input of size ", input.sizes(),
+           " and a weight of size ", weight.sizes(), " would be empty");
+  int64_t Cg = C / groups, Kg = K / groups;
+  int64_t R = Cg * kH * kW;
+  int64_t P = oH * oW;
+
+  auto params = choose_quant_params(input.data<float>(), input.numel());
+  auto input_q = input.type().toScalarType(kByte).tensor(input.sizes());
+  quantize(input.data<float>(), input.numel(), params, input_q.data<uint8_t>());
+
+  auto weight_2d = weight.view({K, R});
+  auto sums = row_sums(weight_2d);
+  // The (oH * oW, C / groups * kH * kW) columns of a group, transposed with
+  // respect to THNN's im2col so that every output is a dot product of two
+  // contiguous rows
+  auto columns = input_q.type().tensor({P, R});
+  auto acc = input.type().toScalarType(kInt).tensor({P, Kg});
+  auto output = input.type().tensor({batch, K, oH, oW});
+  auto bias_c = bias.defined() ? bias.contiguous() : bias;
+  const float* scales = weight_scales.data<float>();
+  const float* bias_data = bias.defined() ? bias_c.data<float>() : nullptr;
+  const uint8_t* image_data = input_q.data<uint8_t>();
+  uint8_t* col_data = columns.data<uint8_t>();
+  const int32_t* acc_data = acc.data<int32_t>();
+  const uint8_t pad = static_cast<uint8_t>(params.zero_point);
+
+  for (int64_t n = 0; n < batch; n++) {
+    for (int64_t g = 0; g < groups; g++) {
+      const uint8_t* image = image_data + (n * C + g * Cg) * iH * iW;
+      parallel_for(0, P, std::max<int64_t>(1, internal::TBB_GRAIN_SIZE / R),
+                   [&](int64_t begin, int64_t end) {
+        for (int64_t p = begin; p < end; p++) {
+          int64_t oh = p / oW, ow = p % oW;
+          uint8_t* col = col_data + p * R;
+          for (int64_t c = 0; c < Cg; c++) {
+            for (int64_t kh = 0; kh < kH; kh++) {
+              int64_t ih = oh * stride[0] - padding[0] + kh * dilation[0];
+              for (int64_t kw = 0; kw < kW; kw++) {
+                int64_t iw = ow * stride[1] - padding[1] + kw * dilation[1];
+                *col++ = (ih >= 0 && ih < iH && iw >= 0 && iw < iW)
+                    ? image[(c * iH + ih) * iW + iw] : pad;
+              }
+            }
+          }
+        }
+      });
+      u8s8_gemm_kernel(acc, columns, weight_2d.narrow(0, g * Kg, Kg));
+
+      float* out = output.data<float>() + (n * K + g * Kg) * P;
+      parallel_for(0, Kg, std::max<int64_t>(1, internal::TBB_GRAIN_SIZE / P),
+                   [&](int64_t begin, int64_t end) {
+        for (int64_t k = begin; k < end; k++) {
+          int64_t o = g * Kg + k;
+          float scale = params.scale * scales[o];
+          int32_t offset = params.zero_point * sums[o];
+          float b = bias_data ? bias_data[o] : 0;
+          for (int64_t p = 0; p < P; p++) {
+            out[k * P + p] = scale * (acc_data[p * Kg + k] - offset) + b;
+          }
+        }
+      });
+    }
+  }
+  return output;
+}
+
+}} // namespace at::native
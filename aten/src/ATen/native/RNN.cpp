@@ -0,0 +1,218 @@
+#include "ATen/ATen.h"
+#include "ATen/Config.h"
+#include "ATen/NativeFunctions.h"
+#include "ATen/native/cpu/RNNKernel.h"
+
+#include <tuple>
+#include <vector>
+
+#if AT_MKL_ENABLED()
+#include <mkl.h>
+#endif
+
+// Inference engine for multi-layer RNNs on the CPU. Instead of doing two
+// GEMMs and a handful of pointwise operations per timestep like the autograd
+// cells of torch/nn/_functions/rnn.py, every layer computes the input
+// projections of all timesteps with one GEMM, and then, per timestep, one
+// GEMM with the recurrent weight followed by a single fused pointwise kernel.
+// The recurrent weight is transposed (or, with MKL, packed) once per layer.
+
+namespace at { namespace native {
+
+namespace {
+
+// Same values as the cuDNN modes of _cudnn_rnn
+enum CPURNNMode { RNN_RELU = 0, RNN_TANH = 1, LSTM = 2, GRU = 3 };
+
+int64_t num_gates(int64_t mode) {
+  switch (mode) {
+    case RNN_RELU:
+    case RNN_TANH:
+      return 1;
+    case LSTM:
+      return 4;
+    case GRU:
+      return 3;
+    default:
+      AT_ERROR("_cpu_rnn: unknown mode ", mode);
+  }
+  return 0;
+}
+
+// gates = h * w_hh^T (+ b_hh) for a fixed batch size
+struct RecurrentWeight {
+  Tensor weight_t;
+#if AT_MKL_ENABLED()
+  float* packed = nullptr;
+#endif
+  int64_t batch;
+  int64_t rows;
+  int64_t hidden;
+
+  RecurrentWeight(const Tensor& w_hh, int64_t batch_)
+    : batch(batch_), rows(w_hh.size(0)), hidden(w_hh.size(1)) {
+#if AT_MKL_ENABLED()
+    if (w_hh.type().scalarType() == kFloat) {
+      auto w = w_hh.contiguous();
+      packed = cblas_sgemm_alloc(CblasBMatrix, batch, rows, hidden);
+      cblas_sgemm_pack(CblasRowMajor, CblasBMatrix, CblasTrans, batch, rows, hidden,
+                       1.0f, w.data<float>(), hidden, packed);
+      return;
+    }
+#endif
+    weight_t = w_hh.t().contiguous();
+  }
+
+  ~RecurrentWeight() {
+#if AT_MKL_ENABLED()
+    if (packed) {
+      cblas_sgemm_free(packed);
+    }
+#endif
+  }
+
+  RecurrentWeight(const RecurrentWeight&) = delete;
+  RecurrentWeight& operator=(const RecurrentWeight&) = delete;
+
+  void mm_out(Tensor& gates, const Tensor& h, const Tensor& bias) const {
+#if AT_MKL_ENABLED()
+    if (packed) {
+      if (bias.defined()) {
+        gates.copy_(bias.expand_as(gates));
+      }
+      cblas_sgemm_compute(CblasRowMajor, CblasNoTrans, CblasPacked, batch, rows, hidden,
+                          h.data<float>(), hidden, packed, rows,
+                          bias.defined() ? 1.0f : 0.0f, gates.data<float>(), rows);
+      return;
+    }
+#endif
+    if (bias.defined()) {
+      at::addmm_out(gates, bias, h, weight_t);
+    } else {
+      at::mm_out(gates, h, weight_t);
+    }
+  }
+};
+
+void check_cpu_rnn_args(const Tensor& input, TensorList weight, int64_t weight_stride0,
+                        const Tensor& hx, const Tensor& cx, int64_t mode,
+                        int64_t hidden_size, int64_t num_layers, int64_t num_directions) {
+  AT_CHECK(input.dim() == 3, "_cpu_rnn: expected a 3-d (seq_len, batch, input_size) input, got ",
+           input.dim(), "-d");
+  AT_CHECK(weight_stride0 == 2 || weight_stride0 == 4,
+           "_cpu_rnn: expected 2 or 4 weights per layer and direction, got ", weight_stride0);
+  AT_CHECK(static_cast<int64_t>(weight.size()) == weight_stride0 * num_layers * num_directions,
+           "_cpu_rnn: expected ", weight_stride0 * num_layers * num_directions, " weights, got ",
+           weight.size());
+  std::vector<int64_t> hidden_sizes = {num_layers * num_directions, input.size(1), hidden_size};
+  AT_CHECK(hx.sizes().equals(hidden_sizes), "_cpu_rnn: expected hx of size ", IntList(hidden_sizes),
+           ", got ", hx.sizes());
+  if (mode == LSTM) {
+    AT_CHECK(cx.defined() && cx.sizes().equals(hidden_sizes),
+             "_cpu_rnn: expected cx of size ", IntList(hidden_sizes));
+  }
+  for (const auto& w : weight) {
+    AT_CHECK(w.type() == input.type(), "_cpu_rnn: expected weights of type ", input.toString(),
+             ", got ", w.toString());
+  }
+  int64_t gate_size = num_gates(mode) * hidden_size;
+  for (size_t i = 0; i < weight.size(); i += weight_stride0) {
+    int64_t layer_input_size = i < static_cast<size_t>(weight_stride0 * num_directions)
+        ? input.size(2) : num_directions * hidden_size;
+    AT_CHECK(weight[i].dim() == 2 && weight[i].size(0) == gate_size &&
+             weight[i].size(1) == layer_input_size,
+             "_cpu_rnn: expected w_ih of size (", gate_size, ", ", layer_input_size, "), got ",
+             weight[i].sizes());
+    AT_CHECK(weight[i + 1].dim() == 2 && weight[i + 1].size(0) == gate_size &&
+             weight[i + 1].size(1) == hidden_size,
+             "_cpu_rnn: expected w_hh of size (", gate_size, ", ", hidden_size, "), got ",
+             weight[i + 1].sizes());
+  }
+}
+
+// Runs one direction of a layer over the (T, B, I) input, writing the
+// hidden states to the (T, B, H) output, and h_n, c_n to h and c.
+void cpu_rnn_layer(Tensor& output, Tensor& h, Tensor& c, const Tensor& input,
+                   TensorList weight, int64_t mode, bool reverse) {
+  int64_t T = input.size(0);
+  int64_t B = input.size(1);
+  const Tensor& w_ih = weight[0];
+  const Tensor& w_hh = weight[1];
+  Tensor b_ih, b_hh;
+  if (weight.size() == 4) {
+    b_ih = weight[2];
+    b_hh = weight[3];
+  }
+
+  // The input projections of all timesteps. b_hh is added to them too,
+  // except for GRU which multiplies its h_n part by the reset gate.
+  auto input_2d = input.view({T * B, input.size(2)});
+  Tensor igates = b_ih.defined() ? at::addmm(b_ih, input_2d, w_ih.t()) : at::mm(input_2d, w_ih.t());
+  Tensor recurrent_bias;
+  if (b_hh.defined()) {
+    if (mode == GRU) {
+      recurrent_bias = b_hh;
+    } else {
+      igates.add_(b_hh);
+    }
+  }
+
+  RecurrentWeight recurrent(w_hh, B);
+  auto hgates = igates.type().tensor({B, w_hh.size(0)});
+  for (int64_t step = 0; step < T; step++) {
+    int64_t t = reverse ? T - 1 - step : step;
+    auto ig = igates.narrow(0, t * B, B);
+    recurrent.mm_out(hgates, h, recurrent_bias);
+    switch (mode) {
+      case LSTM:
+        lstm_cell_kernel(h, c, ig, hgates, c);
+        break;
+      case GRU:
+        gru_cell_kernel(h, ig, hgates, h);
+        break;
+      case RNN_TANH:
+        at::tanh_out(h, hgates.add_(ig));
+        break;
+      case RNN_RELU:
+        at::relu_(at::add_out(h, hgates, ig));
+        break;
+    }
+    output[t].copy_(h);
+  }
+}
+
+} // namespace
+
+std::tuple<Tensor, Tensor, Tensor> _cpu_rnn(
+    const Tensor& input_r, TensorList weight, int64_t weight_stride0,
+    const Tensor& hx, const Tensor& cx /* optional */,
+    int64_t mode, int64_t hidden_size, int64_t num_layers, bool bidirectional) {
+  int64_t num_directions = bidirectional ? 2 : 1;
+  check_cpu_rnn_args(input_r, weight, weight_stride0, hx, cx, mode, hidden_size,
+                     num_layers, num_directions);
+
+  auto input = input_r.contiguous();
+  auto hy = hx.clone();
+  Tensor cy;
+  if (mode == LSTM) {
+    cy = cx.clone();
+  }
+  int64_t T = input.size(0);
+  int64_t B = input.size(1);
+  for (int64_t layer = 0; layer < num_layers; layer++) {
+    auto layer_output = input.type().tensor({T, B, num_directions * hidden_size});
+    for (int64_t direction = 0; direction < num_directions; direction++) {
+      int64_t index = layer * num_directions + direction;
+      auto h = hy[index];
+      auto c = cy.defined() ? cy[index] : Tensor();
+      auto output = layer_output.narrow(2, direction * hidden_size, hidden_size);
+      cpu_rnn_layer(output, h, c, input,
+                    weight.slice(index * weight_stride0, weight_stride0),
+                    mode, direction == 1);
+    }
+    input = layer_output;
+  }
+  return std::make_tuple(input, hy, cy);
+}
+
+}} // namespace at::native
@@ -4,6 +4,7 @@
 #include "ATen/NativeFunctions.h"
 #include "ATen/WrapDimUtils.h"
 #include "ATen/WrapDimUtilsMulti.h"
+#include "ATen/native/TensorIterator.h"
 #include "cpu/ReduceOpsKernel.h"
 
 #include <algorithm>
@@ -78,6 +79,54 @@ Tensor& cumprod_out(Tensor& result, const Tensor& self, int64_t dim) {
   return at::native::cumprod_out(result, self, dim, nullopt);
 }
 
+static std::vector<int64_t> reduced_shape(const Tensor& self,
+                                          std::bitset<dim_bitset_size> mask) {
+  std::vector<int64_t> shape = self.sizes().vec();
+  for (int64_t dim = 0; dim < self.dim(); dim++) {
+    if (mask[dim]) {
+      shape[dim] = 1;
+    }
+  }
+  return shape;
+}
+
+static Tensor& squeeze_reduced_dims(Tensor& result, std::bitset<dim_bitset_size> mask,
+                                    int64_t ndim) {
+  for (int64_t dim = ndim - 1; dim >= 0; dim--) {
+    if (mask[dim]) {
+      result.squeeze_(dim);
+    }
+  }
+  return result;
+}
+
+// Reduces self over the dimensions set in mask with the given kernel and
+// writes the result to result, which must have the same type as self.
+static Tensor& reduce_cpu(Tensor& result, const Tensor& self,
+                          std::bitset<dim_bitset_size> mask, bool keepdim,
+                          int64_t ident, DispatchStub<reduce_fn>& kernel) {
+  result.resize_(reduced_shape(self, mask));
+  result.fill_(ident);
+  auto iter = TensorIterator::reduce_op(result, self);
+  kernel(iter);
+  if (!keepdim) {
+    squeeze_reduced_dims(result, mask, self.dim());
+  }
+  return result;
+}
+
+static inline bool can_use_reduce_kernel(const Tensor& result, const Tensor& self) {
+  return !self.is_sparse() && result.type() == self.type();
+}
+
+static std::bitset<dim_bitset_size> all_dims(int64_t ndim) {
+  std::bitset<dim_bitset_size> mask;
+  for (int64_t dim = 0; dim < ndim; dim++) {
+    mask[dim] = true;
+  }
+  return mask;
+}
+
 // ALL REDUCE #################################################################
 
 static inline Tensor sum(const Tensor &self, optional<ScalarType> dtype) {
@@ -93,12 +142,11 @@ Tensor sum(const Tensor &self) {
 }
 
 Tensor _sum_cpu(const Tensor& self) {
-  if (self.is_contiguous()) {
-    Tensor result = self.type().tensor({});
-    sum_kernel(result, self, at::nullopt);
-    return result;
+  if (self.is_sparse()) {
+    return self._sumall();
   }
-  return self._sumall();
+  Tensor result = self.type().tensor();
+  return reduce_cpu(result, self, all_dims(self.dim()), false, 0, sum_kernel);
 }
 
 static inline Tensor prod(const Tensor &self, optional<ScalarType> dtype) {
@@ -114,12 +162,11 @@ Tensor prod(const Tensor &self) {
 }
 
 Tensor _prod_cpu(const Tensor &self) {
-  if (self.is_contiguous()) {
-    Tensor result = self.type().tensor({});
-    prod_kernel(result, self, at::nullopt);
-    return result;
+  if (self.is_sparse()) {
+    return self._prodall();
   }
-  return self._prodall();
+  Tensor result = self.type().tensor();
+  return reduce_cpu(result, self, all_dims(self.dim()), false, 1, prod_kernel);
 }
 
 // \ALL REDUCE ################################################################
@@ -142,16 +189,6 @@ static bool _dimreduce_return_trivial(Tensor &result, const Tensor &self,
   return false;
 }
 
-static Tensor &_dimreduce_setup(Tensor &result, const Tensor &self,
-                                int64_t dim) {
-  IntList self_sizes = self.sizes();
-  std::vector<int64_t> result_sizes;
-  result_sizes.insert(result_sizes.end(), self_sizes.begin(), self_sizes.end());
-  result_sizes[dim] = 1;
-  result.resize_(result_sizes);
-  return result;
-}
-
 static inline Tensor &sum_out(Tensor &result, const Tensor &self, IntList dim,
                  bool keepdim, optional<ScalarType> dtype) {
   // result type is favored over dtype; check that they match if provided (NumPy doesn't check)
@@ -177,11 +214,8 @@ Tensor &_sum_out_cpu(Tensor &result, const Tensor &self, int64_t dim_,
   int64_t dim = maybe_wrap_dim(dim_, self.dim());
   if (_dimreduce_return_trivial(result, self, 0))
     return result;
-  if (self.is_contiguous() && result.is_contiguous()) {
-    _dimreduce_setup(result, self, dim);
-    sum_kernel(result, self, dim);
-    if (!keepdim) result.squeeze_(dim);
-    return result;
+  if (can_use_reduce_kernel(result, self)) {
+    return reduce_cpu(result, self, dim_list_to_bitset(dim, self.dim()), keepdim, 0, sum_kernel);
   }
   return at::_th_sum_out(result, self, dim, keepdim);
 }
@@ -211,11 +245,8 @@ Tensor &_prod_out_cpu(Tensor &result, const Tensor &self, int64_t dim_,
   int64_t dim = maybe_wrap_dim(dim_, self.dim());
   if (_dimreduce_return_trivial(result, self, 1))
     return result;
-  if (self.is_contiguous() && result.is_contiguous()) {
-    _dimreduce_setup(result, self, dim);
-    prod_kernel(result, self, dim);
-    if (!keepdim) result.squeeze_(dim);
-    return result;
+  if (can_use_reduce_kernel(result, self)) {
+    return reduce_cpu(result, self, dim_list_to_bitset(dim, self.dim()), keepdim, 1, prod_kernel);
   }
   return at::_th_prod_out(result, self, dim, keepdim);
 }
@@ -266,6 +297,90 @@ Tensor _prod(const Tensor &self, int64_t dim_, bool keepdim) {
 
 // \DIM REDUCE ################################################################
 
+// MEAN, VAR, STD #############################################################
+
+// The CPU kernels below handle any strided floating point input; everything
+// else (including the empty and 0-dim edge cases) is left to TH.
+static inline bool can_use_moment_kernel(const Tensor& result, const Tensor& self) {
+  return can_use_reduce_kernel(result, self) &&
+         at::isFloatingType(self.type().scalarType()) &&
+         self.dim() > 0 && self.numel() > 0;
+}
+
+static int64_t reduced_numel(const Tensor& self, std::bitset<dim_bitset_size> mask) {
+  int64_t n = 1;
+  for (int64_t dim = 0; dim < self.dim(); dim++) {
+    if (mask[dim]) {
+      n *= self.size(dim);
+    }
+  }
+  return n;
+}
+
+static Tensor& mean_out_cpu(Tensor& result, const Tensor& self,
+                            std::bitset<dim_bitset_size> mask, bool keepdim) {
+  reduce_cpu(result, self, mask, keepdim, 0, sum_kernel);
+  return result.div_(reduced_numel(self, mask));
+}
+
+// Two passes: the mean, then the sum of squared deviations from it.
+static Tensor& var_out_cpu(Tensor& result, const Tensor& self,
+                           std::bitset<dim_bitset_size> mask, bool unbiased,
+                           bool keepdim) {
+  Tensor mean = self.type().tensor();
+  mean_out_cpu(mean, self, mask, /*keepdim=*/true);
+  result.resize_(mean.sizes());
+  result.fill_(0);
+  auto iter = TensorIterator::reduce_op(result, self, mean);
+  sum_squared_deviations_kernel(iter);
+  result.div_(reduced_numel(self, mask) - (unbiased ? 1 : 0));
+  if (!keepdim) {
+    squeeze_reduced_dims(result, mask, self.dim());
+  }
+  return result;
+}
+
+Tensor mean(const Tensor& self, int64_t dim, bool keepdim) {
+  Tensor result = self.type().tensor();
+  return at::mean_out(result, self, dim, keepdim);
+}
+
+Tensor& _mean_out_cpu(Tensor& result, const Tensor& self, int64_t dim, bool keepdim) {
+  if (!can_use_moment_kernel(result, self)) {
+    return at::_th_mean_out(result, self, dim, keepdim);
+  }
+  return mean_out_cpu(result, self, dim_list_to_bitset(dim, self.dim()), keepdim);
+}
+
+Tensor var(const Tensor& self, int64_t dim, bool unbiased, bool keepdim) {
+  Tensor result = self.type().tensor();
+  return at::var_out(result, self, dim, unbiased, keepdim);
+}
+
+Tensor& _var_out_cpu(Tensor& result, const Tensor& self, int64_t dim,
+                     bool unbiased, bool keepdim) {
+  if (!can_use_moment_kernel(result, self)) {
+    return at::_th_var_out(result, self, dim, unbiased, keepdim);
+  }
+  return var_out_cpu(result, self, dim_list_to_bitset(dim, self.dim()), unbiased, keepdim);
+}
+
+Tensor std(const Tensor& self, int64_t dim, bool unbiased, bool keepdim) {
+  Tensor result = self.type().tensor();
+  return at::std_out(result, self, dim, unbiased, keepdim);
+}
+
+Tensor& _std_out_cpu(Tensor& result, const Tensor& self, int64_t dim,
+                     bool unbiased, bool keepdim) {
+  if (!can_use_moment_kernel(result, self)) {
+    return at::_th_std_out(result, self, dim, unbiased, keepdim);
+  }
+  var_out_cpu(result, self, dim_list_to_bitset(dim, self.dim()), unbiased, keepdim);
+  return result.sqrt_();
+}
+
+// \MEAN, VAR, STD ############################################################
+
 // MULTI DIM REDUCE ###########################################################
 
 template <Tensor (reduce_1)(const Tensor &, int64_t, bool)>
@@ -320,13 +435,34 @@ Tensor& _sum_out(Tensor &result, const Tensor &self, int64_t dim, bool keepdim)
   }
 }
 
+// Reduces over all of dims in a single pass instead of one dimension at a
+// time.
+static Tensor &_sum_out_cpu(Tensor &result, const Tensor &self, IntList dims,
+                            bool keepdim) {
+  if (dims.size() == 1) {
+    return _sum_out_cpu(result, self, dims[0], keepdim);
+  }
+  auto mask = dim_list_to_bitset(dims, self.dim());
+  if (dims.size() == 0 || self.dim() == 0 || !can_use_reduce_kernel(result, self)) {
+    return reduce_multi_associative_out<_sum, _sum_out>(result, self, dims, keepdim);
+  }
+  return reduce_cpu(result, self, mask, keepdim, 0, sum_kernel);
+}
+
 Tensor _sum(const Tensor &self, IntList dims, bool keepdim) {
-  return reduce_multi_associative<_sum>(self, dims, keepdim);
+  if (self.is_cuda() || dims.size() == 0) {
+    return reduce_multi_associative<_sum>(self, dims, keepdim);
+  }
+  Tensor result = self.type().tensor();
+  return _sum_out_cpu(result, self, dims, keepdim);
 }
 
 Tensor& _sum_out(Tensor &result, const Tensor &self, IntList dims, bool keepdim)
 {
-  return reduce_multi_associative_out<_sum, _sum_out>(result, self, dims, keepdim);
+  if (self.is_cuda()) {
+    return reduce_multi_associative_out<_sum, _sum_out>(result, self, dims, keepdim);
+  }
+  return _sum_out_cpu(result, self, dims, keepdim);
 }
 
 }} // namespace at::native
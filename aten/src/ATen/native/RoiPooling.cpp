@@ -1,10 +1,35 @@
 #include "ATen/ATen.h"
 #include "ATen/NativeFunctions.h"
+#include "ATen/Parallel.h"
 #include <tuple>
+#include <vector>
 
 namespace at {
 namespace native {
 
+namespace {
+
+// The input window [start, end) of the tiles of a pooled dimension of one RoI,
+// clipped to the input. It only depends on the RoI, so it is computed once
+// and shared by all channels.
+void roi_pooling_tiles(
+    int64_t roiStart,
+    int64_t roiSize,
+    int64_t pooledSize,
+    int64_t inputSize,
+    int64_t *tileStart,
+    int64_t *tileEnd) {
+  auto tileSize = static_cast<float>(roiSize) / static_cast<float>(pooledSize);
+  for (int64_t p = 0; p < pooledSize; ++p) {
+    auto start = static_cast<int64_t>(std::floor(p * tileSize));
+    auto end = static_cast<int64_t>(std::ceil((p + 1) * tileSize));
+    tileStart[p] = std::min(std::max<int64_t>(start + roiStart, 0), inputSize);
+    tileEnd[p] = std::min(std::max<int64_t>(end + roiStart, 0), inputSize);
+  }
+}
+
+} // namespace
+
 std::tuple<at::Tensor, at::Tensor> RoiPooling2d_forward_cpu(
 	const Tensor& input,
 	const Tensor& rois,
@@ -48,80 +73,75 @@ std::tuple<at::Tensor, at::Tensor> RoiPooling2d_forward_cpu(
   auto *rawOutput = output.data<float>();
   auto *rawArgmaxes = argmaxes.data<int>();
   auto outputChannelStride = pooledHeight * pooledWidth;
+  auto outputProposalStride = inputChannels * outputChannelStride;
 
   // Now that our Tensors are properly sized, we can perform the pooling operation.
-  // We iterate over each RoI and perform pooling on each channel in the input, to
-  // generate a pooledHeight x pooledWidth output for each RoI
-  for (auto i = 0; i < proposals; ++i) {
-    auto n = static_cast<int>(rawRois[0]);
-    auto startWidth = static_cast<int>(std::round(rawRois[1] * spatialScale));
-    auto startHeight = static_cast<int>(std::round(rawRois[2] * spatialScale));
-    auto endWidth = static_cast<int>(std::round(rawRois[3] * spatialScale));
-    auto endHeight = static_cast<int>(std::round(rawRois[4] * spatialScale));
-
-    // TODO: assertions for valid values?
-    // TODO: fix malformed ROIs??
-
-    auto roiHeight = endHeight - startHeight;
-    auto roiWidth = endWidth - startWidth;
-
-    // Because the Region of Interest can be of variable size, but our output
-    // must always be (pooledHeight x pooledWidth), we need to split the RoI
-    // into a pooledHeight x pooledWidth grid of tiles
-
-    auto tileHeight = static_cast<float>(roiHeight) / static_cast<float>(pooledHeight);
-    auto tileWidth = static_cast<float>(roiWidth) / static_cast<float>(pooledWidth);
-
-    auto *rawInputBatch = rawInput + (n * inputBatchStride);
-
-    // Compute pooling for each of the (pooledHeight x pooledWidth) tiles for each
-    // channel in the input
-    for (auto ch = 0; ch < inputChannels; ++ch) {
-      for (auto ph = 0; ph < pooledHeight; ++ph) {
-        for (auto pw = 0; pw < pooledWidth; ++pw) {
-          auto tileHStart = static_cast<int64_t>(std::floor(ph * tileHeight));
-          auto tileWStart =	static_cast<int64_t>(std::floor(pw * tileWidth));
-          auto tileHEnd = static_cast<int64_t>(std::ceil((ph + 1) * tileHeight));
-          auto tileWEnd = static_cast<int64_t>(std::ceil((pw + 1) * tileWidth));
-
-          // Add tile offsets to RoI offsets, and clip to input boundaries
-          tileHStart = std::min(std::max<int64_t>(tileHStart + startHeight, 0), inputHeight);
-          tileWStart = std::min(std::max<int64_t>(tileWStart + startWidth, 0), inputWidth);
-          tileHEnd = std::min(std::max<int64_t>(tileHEnd + startHeight, 0), inputHeight);
-          tileWEnd = std::min(std::max<int64_t>(tileWEnd + startWidth, 0), inputWidth);
-
-          auto poolIndex = (ph * pooledWidth) + pw;
-
-          // If our pooling region is empty, we set the output to 0, otherwise to
-          // the min float so we can calculate the max properly
-          auto empty = tileHStart >= tileHEnd || tileWStart >= tileWEnd;
-          rawOutput[poolIndex] = empty ? 0 : std::numeric_limits<float>::min();
-
-          // Set to -1 so we don't try to backprop to anywhere
-          // TODO: make optional for test
-          rawArgmaxes[poolIndex] = -1;
-
-          for (auto th = tileHStart; th < tileHEnd; ++th) {
-            for (auto tw = tileWStart; tw < tileWEnd; ++tw) {
-              auto index = (th * inputWidth) + tw;
-              if (rawInputBatch[index] > rawOutput[poolIndex]) {
-                rawOutput[poolIndex] = rawInputBatch[index];
-                // TODO: make optional for test
-                rawArgmaxes[poolIndex] = index;
+  // Every RoI writes its own slice of the output, so the RoIs are pooled in
+  // parallel, each generating a pooledHeight x pooledWidth output per channel
+  parallel_for(0, proposals, 1, [&](int64_t begin, int64_t end) {
+    std::vector<int64_t> tileHStart(pooledHeight), tileHEnd(pooledHeight);
+    std::vector<int64_t> tileWStart(pooledWidth), tileWEnd(pooledWidth);
+    for (auto i = begin; i < end; ++i) {
+      auto *roi = rawRois + i * roiProposalStride;
+      auto n = static_cast<int>(roi[0]);
+      auto startWidth = static_cast<int>(std::round(roi[1] * spatialScale));
+      auto startHeight = static_cast<int>(std::round(roi[2] * spatialScale));
+      auto endWidth = static_cast<int>(std::round(roi[3] * spatialScale));
+      auto endHeight = static_cast<int>(std::round(roi[4] * spatialScale));
+
+      // TODO: assertions for valid values?
+      // TODO: fix malformed ROIs??
+
+      // Because the Region of Interest can be of variable size, but our output
+      // must always be (pooledHeight x pooledWidth), we need to split the RoI
+      // into a pooledHeight x pooledWidth grid of tiles, clipped to the input
+      roi_pooling_tiles(startHeight, endHeight - startHeight, pooledHeight,
+                        inputHeight, tileHStart.data(), tileHEnd.data());
+      roi_pooling_tiles(startWidth, endWidth - startWidth, pooledWidth,
+                        inputWidth, tileWStart.data(), tileWEnd.data());
+
+      auto *rawInputBatch = rawInput + (n * inputBatchStride);
+      auto *rawOutputRoi = rawOutput + i * outputProposalStride;
+      auto *rawArgmaxesRoi = rawArgmaxes + i * outputProposalStride;
+
+      // Compute pooling for each of the (pooledHeight x pooledWidth) tiles for each
+      // channel in the input
+      for (auto ch = 0; ch < inputChannels; ++ch) {
+        for (auto ph = 0; ph < pooledHeight; ++ph) {
+          for (auto pw = 0; pw < pooledWidth; ++pw) {
+            auto poolIndex = (ph * pooledWidth) + pw;
+
+            // If our pooling region is empty, we set the output to 0, otherwise to
+            // the min float so we can calculate the max properly
+            auto empty = tileHStart[ph] >= tileHEnd[ph] || tileWStart[pw] >= tileWEnd[pw];
+            float maxValue = empty ? 0 : std::numeric_limits<float>::min();
+
+            // Set to -1 so we don't try to backprop to anywhere
+            // TODO: make optional for test
+            int maxIndex = -1;
+
+            for (auto th = tileHStart[ph]; th < tileHEnd[ph]; ++th) {
+              auto *row = rawInputBatch + th * inputWidth;
+              for (auto tw = tileWStart[pw]; tw < tileWEnd[pw]; ++tw) {
+                if (row[tw] > maxValue) {
+                  maxValue = row[tw];
+                  maxIndex = (th * inputWidth) + tw;
+                }
               }
             }
+            rawOutputRoi[poolIndex] = maxValue;
+            // TODO: make optional for test
+            rawArgmaxesRoi[poolIndex] = maxIndex;
           }
         }
+        // Increment raw pointers by channel stride
+        rawInputBatch += inputChannelStride;
+        rawOutputRoi += outputChannelStride;
+        // TODO: make optional for test
+        rawArgmaxesRoi += outputChannelStride;
       }
-      // Increment raw pointers by channel stride
-      rawInputBatch += inputChannelStride;
-      rawOutput += outputChannelStride;
-      // TODO: make optional for test
-      rawArgmaxes += outputChannelStride;
     }
-    // Increment RoI raw pointer
-    rawRois += roiProposalStride;
-  }
+  });
 
   return std::make_tuple(output, argmaxes);
 }
@@ -134,7 +154,52 @@ Tensor RoiPooling2d_backward_cpu(
   double spatialScale,
   const Tensor& gradOutput,
   const Tensor& argmaxes) {
-  throw std::runtime_error("not implemented");
+  auto proposals = rois.size(0);
+  auto inputChannels = input.size(1);
+  auto inputHeight = input.size(2);
+  auto inputWidth = input.size(3);
+
+  AT_CHECK(gradOutput.sizes().equals({proposals, inputChannels, pooledHeight, pooledWidth}),
+           "gradOutput should be of size (num_rois, C, pooledHeight, pooledWidth)");
+  AT_CHECK(argmaxes.sizes().equals(gradOutput.sizes()),
+           "argmaxes should be of the same size as gradOutput");
+
+  auto rois_ = rois.contiguous();
+  auto gradOutput_ = gradOutput.contiguous();
+  auto argmaxes_ = argmaxes.contiguous();
+  auto gradInput = at::zeros_like(input);
+
+  auto *rawRois = rois_.data<float>();
+  auto roiProposalStride = rois_.size(1);
+  auto *rawGradOutput = gradOutput_.data<float>();
+  auto *rawArgmaxes = argmaxes_.data<int>();
+  auto *rawGradInput = gradInput.data<float>();
+  auto inputChannelStride = inputHeight * inputWidth;
+  auto outputChannelStride = pooledHeight * pooledWidth;
+
+  // The RoIs of an image overlap, but the argmaxes of a channel only point
+  // into the same channel of the input. Scattering the gradient of all RoIs
+  // channel by channel, in parallel over the channels, needs no atomics and
+  // keeps the order of the additions, and thus the result, deterministic.
+  parallel_for(0, inputChannels, 1, [&](int64_t begin, int64_t end) {
+    for (auto ch = begin; ch < end; ++ch) {
+      for (auto i = 0; i < proposals; ++i) {
+        auto n = static_cast<int64_t>(rawRois[i * roiProposalStride]);
+        auto *gradInputPlane = rawGradInput + (n * inputChannels + ch) * inputChannelStride;
+        auto outputOffset = (i * inputChannels + ch) * outputChannelStride;
+        auto *gradOutputPlane = rawGradOutput + outputOffset;
+        auto *argmaxesPlane = rawArgmaxes + outputOffset;
+        for (auto poolIndex = 0; poolIndex < outputChannelStride; ++poolIndex) {
+          auto argmax = argmaxesPlane[poolIndex];
+          if (argmax != -1) {
+            gradInputPlane[argmax] += gradOutputPlane[poolIndex];
+          }
+        }
+      }
+    }
+  });
+
+  return gradInput;
 }
 
 }
@@ -0,0 +1,293 @@
+#pragma once
+
+#include "ATen/ATen.h"
+
+#include <cmath>
+#include <vector>
+
+// Factorizations of matrices of at most kMaxSmallMatrixSize rows, for batches
+// of many tiny systems (3x3, 6x6, ...) where a LAPACK or MAGMA call per matrix
+// costs far more than the arithmetic. The size is a template argument, so
+// every loop is unrolled and a whole matrix lives in registers; rows are only
+// ever indexed by loop counters (a pivot row is found by comparing with every
+// row, not by indexing with it), which keeps it that way on the GPU too.
+//   small_gesv:    solves A X = B in place, leaving the LU factorization of
+//                  A as LAPACK's getrf does (partial pivoting, unit L)
+//   small_inverse: out = A^-1
+//   small_potrf:   out = U with A = U^T U if upper, else L with A = L L^T,
+//                  the other triangle zeroed like TH's potrf
+// They return 0, or like LAPACK k > 0 if U(k, k) is zero (getrf) or the
+// leading minor of order k is not positive definite (potrf). Compiled for
+// the host and, from .cu files, the device.
+
+#if defined(__CUDACC__)
+#define SMALL_MATRIX_HOST_DEVICE __host__ __device__ __forceinline__
+#define SMALL_MATRIX_UNROLL _Pragma("unroll")
+#else
+#define SMALL_MATRIX_HOST_DEVICE inline
+#define SMALL_MATRIX_UNROLL
+#endif
+
+namespace at { namespace native {
+
+constexpr int64_t kMaxSmallMatrixSize = 8;
+
+#define AT_SMALL_MATRIX_SIZE_CASE(size, ...) \
+  case size: {                               \
+    constexpr int N = size;                  \
+    return __VA_ARGS__();                    \
+  }
+
+// Calls the lambda with the constant N = n, for 1 <= n <= kMaxSmallMatrixSize
+#define AT_DISPATCH_SMALL_MATRIX_SIZE(n, NAME, ...)                              \
+  [&] {                                                                          \
+    switch (n) {                                                                 \
+      AT_SMALL_MATRIX_SIZE_CASE(1, __VA_ARGS__)                                  \
+      AT_SMALL_MATRIX_SIZE_CASE(2, __VA_ARGS__)                                  \
+      AT_SMALL_MATRIX_SIZE_CASE(3, __VA_ARGS__)                                  \
+      AT_SMALL_MATRIX_SIZE_CASE(4, __VA_ARGS__)                                  \
+      AT_SMALL_MATRIX_SIZE_CASE(5, __VA_ARGS__)                                  \
+      AT_SMALL_MATRIX_SIZE_CASE(6, __VA_ARGS__)                                  \
+      AT_SMALL_MATRIX_SIZE_CASE(7, __VA_ARGS__)                                  \
+      AT_SMALL_MATRIX_SIZE_CASE(8, __VA_ARGS__)                                  \
+      default:                                                                   \
+        AT_ERROR(NAME, ": no small matrix kernel for matrices of size ", n);     \
+    }                                                                            \
+  }()
+
+static inline bool use_small_matrix_kernels(const Tensor& batched_matrices) {
+  int64_t n = batched_matrices.size(-1);
+  return n >= 1 && n <= kMaxSmallMatrixSize;
+}
+
+// Raise the error of the first failed factorization of a batch
+static inline void checkInverseErrors(const std::vector<int64_t>& infos) {
+  for (size_t i = 0; i < infos.size(); i++) {
+    AT_CHECK(infos[i] == 0, "inverse: For batch ", i, ": U(", infos[i], ",", infos[i],
+             ") is zero, singular U.");
+  }
+}
+
+static inline void checkPotrfErrors(const std::vector<int64_t>& infos) {
+  for (size_t i = 0; i < infos.size(); i++) {
+    AT_CHECK(infos[i] == 0, "potrf: For batch ", i, ": the leading minor of order ", infos[i],
+             " is not positive definite");
+  }
+}
+
+namespace small_matrix {
+
+template <typename scalar_t>
+SMALL_MATRIX_HOST_DEVICE scalar_t abs(scalar_t x) {
+  return x < 0 ? -x : x;
+}
+
+// In-place LU factorization with partial pivoting: on return the strictly
+// lower part of m is L and the rest U, and row k was swapped with row piv[k]
+template <typename scalar_t, int N>
+SMALL_MATRIX_HOST_DEVICE int lu(scalar_t (&m)[N][N], int (&piv)[N]) {
+  SMALL_MATRIX_UNROLL
+  for (int k = 0; k < N; k++) {
+    int p = k;
+    scalar_t best = abs(m[k][k]);
+    SMALL_MATRIX_UNROLL
+    for (int i = k + 1; i < N; i++) {
+      if (abs(m[i][k]) > best) {
+        best = abs(m[i][k]);
+        p = i;
+      }
+    }
+    piv[k] = p;
+    if (best == 0) {
+      return k + 1;
+    }
+    SMALL_MATRIX_UNROLL
+    for (int i = k + 1; i < N; i++) {
+      if (i == p) {
+        SMALL_MATRIX_UNROLL
+        for (int j = 0; j < N; j++) {
+          scalar_t t = m[k][j];
+          m[k][j] = m[i][j];
+          m[i][j] = t;
+        }
+      }
+    }
+    scalar_t inv_pivot = scalar_t(1) / m[k][k];
+    SMALL_MATRIX_UNROLL
+    for (int i = k + 1; i < N; i++) {
+      m[i][k] *= inv_pivot;
+      SMALL_MATRIX_UNROLL
+      for (int j = k + 1; j < N; j++) {
+        m[i][j] -= m[i][k] * m[k][j];
+      }
+    }
+  }
+  return 0;
+}
+
+// x = A^-1 x given the factorization of lu
+template <typename scalar_t, int N>
+SMALL_MATRIX_HOST_DEVICE void lu_solve(const scalar_t (&m)[N][N], const int (&piv)[N],
+                                       scalar_t (&x)[N]) {
+  SMALL_MATRIX_UNROLL
+  for (int k = 0; k < N; k++) {
+    SMALL_MATRIX_UNROLL
+    for (int i = k + 1; i < N; i++) {
+      if (i == piv[k]) {
+        scalar_t t = x[k];
+        x[k] = x[i];
+        x[i] = t;
+      }
+    }
+  }
+  SMALL_MATRIX_UNROLL
+  for (int i = 1; i < N; i++) {
+    SMALL_MATRIX_UNROLL
+    for (int j = 0; j < i; j++) {
+      x[i] -= m[i][j] * x[j];
+    }
+  }
+  SMALL_MATRIX_UNROLL
+  for (int i = N - 1; i >= 0; i--) {
+    SMALL_MATRIX_UNROLL
+    for (int j = i + 1; j < N; j++) {
+      x[i] -= m[i][j] * x[j];
+    }
+    x[i] /= m[i][i];
+  }
+}
+
+// In-place lower Cholesky factor of the lower part of m
+template <typename scalar_t, int N>
+SMALL_MATRIX_HOST_DEVICE int cholesky(scalar_t (&m)[N][N]) {
+  using std::sqrt;
+  SMALL_MATRIX_UNROLL
+  for (int j = 0; j < N; j++) {
+    scalar_t d = m[j][j];
+    SMALL_MATRIX_UNROLL
+    for (int k = 0; k < j; k++) {
+      d -= m[j][k] * m[j][k];
+    }
+    if (!(d > 0)) {
+      return j + 1;
+    }
+    d = sqrt(d);
+    m[j][j] = d;
+    SMALL_MATRIX_UNROLL
+    for (int i = j + 1; i < N; i++) {
+      scalar_t s = m[i][j];
+      SMALL_MATRIX_UNROLL
+      for (int k = 0; k < j; k++) {
+        s -= m[i][k] * m[j][k];
+      }
+      m[i][j] = s / d;
+    }
+  }
+  return 0;
+}
+
+} // namespace small_matrix
+
+// a is a column-major N x N matrix and b a column-major N x nrhs one
+template <typename scalar_t, int N>
+SMALL_MATRIX_HOST_DEVICE int small_gesv(scalar_t* a, scalar_t* b, int64_t nrhs) {
+  scalar_t m[N][N];
+  int piv[N];
+  SMALL_MATRIX_UNROLL
+  for (int j = 0; j < N; j++) {
+    SMALL_MATRIX_UNROLL
+    for (int i = 0; i < N; i++) {
+      m[i][j] = a[j * N + i];
+    }
+  }
+  int info = small_matrix::lu(m, piv);
+  SMALL_MATRIX_UNROLL
+  for (int j = 0; j < N; j++) {
+    SMALL_MATRIX_UNROLL
+    for (int i = 0; i < N; i++) {
+      a[j * N + i] = m[i][j];
+    }
+  }
+  if (info != 0) {
+    return info;
+  }
+  for (int64_t r = 0; r < nrhs; r++) {
+    scalar_t x[N];
+    SMALL_MATRIX_UNROLL
+    for (int i = 0; i < N; i++) {
+      x[i] = b[r * N + i];
+    }
+    small_matrix::lu_solve(m, piv, x);
+    SMALL_MATRIX_UNROLL
+    for (int i = 0; i < N; i++) {
+      b[r * N + i] = x[i];
+    }
+  }
+  return 0;
+}
+
+// a and out are row-major N x N matrices
+template <typename scalar_t, int N>
+SMALL_MATRIX_HOST_DEVICE int small_inverse(const scalar_t* a, scalar_t* out) {
+  scalar_t m[N][N];
+  int piv[N];
+  SMALL_MATRIX_UNROLL
+  for (int i = 0; i < N; i++) {
+    SMALL_MATRIX_UNROLL
+    for (int j = 0; j < N; j++) {
+      m[i][j] = a[i * N + j];
+    }
+  }
+  int info = small_matrix::lu(m, piv);
+  if (info != 0) {
+    return info;
+  }
+  SMALL_MATRIX_UNROLL
+  for (int r = 0; r < N; r++) {
+    scalar_t x[N];
+    SMALL_MATRIX_UNROLL
+    for (int i = 0; i < N; i++) {
+      x[i] = i == r ? scalar_t(1) : scalar_t(0);
+    }
+    small_matrix::lu_solve(m, piv, x);
+    SMALL_MATRIX_UNROLL
+    for (int i = 0; i < N; i++) {
+      out[i * N + r] = x[i];
+    }
+  }
+  return 0;
+}
+
+// a and out are row-major N x N matrices; only the triangle of a that is
+// factorized is read, like LAPACK's potrf
+template <typename scalar_t, int N>
+SMALL_MATRIX_HOST_DEVICE int small_potrf(const scalar_t* a, scalar_t* out, bool upper) {
+  // the upper triangle of A is the lower triangle of A^T, and U = L^T
+  scalar_t m[N][N];
+  SMALL_MATRIX_UNROLL
+  for (int i = 0; i < N; i++) {
+    SMALL_MATRIX_UNROLL
+    for (int j = 0; j < N; j++) {
+      m[i][j] = upper ? a[j * N + i] : a[i * N + j];
+    }
+  }
+  int info = small_matrix::cholesky(m);
+  if (info != 0) {
+    return info;
+  }
+  SMALL_MATRIX_UNROLL
+  for (int i = 0; i < N; i++) {
+    SMALL_MATRIX_UNROLL
+    for (int j = 0; j < N; j++) {
+      scalar_t l = j <= i ? m[i][j] : scalar_t(0);
+      if (upper) {
+        out[j * N + i] = l;
+      } else {
+        out[i * N + j] = l;
+      }
+    }
+  }
+  return 0;
+}
+
+}}  // namespace at::native
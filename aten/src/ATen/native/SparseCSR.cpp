@@ -0,0 +1,238 @@
+#include "ATen/ATen.h"
+#include "ATen/Dispatch.h"
+#include "ATen/NativeFunctions.h"
+#include "ATen/TensorUtils.h"
+
+#include <tuple>
+#include <vector>
+
+// Kernels for 2-D sparse matrices in compressed sparse row (CSR) format.
+//
+// ATen has no CSR layout, so a CSR matrix is passed around as three dense
+// tensors (see torch.sparse.CSRTensor):
+//
+//   crow_indices  int64, size rows + 1; the entries of row i are at positions
+//                 [crow_indices[i], crow_indices[i + 1])
+//   col_indices   int64, size nnz; column of each entry, sorted within a row
+//   values        size nnz
+//
+// Operations that only rearrange entries (transpose, index_select) return the
+// new index tensors and the positions of the new entries in the old values,
+// so that the values can be gathered with index_select and autograd works
+// without any extra backward kernels.
+
+namespace at { namespace native {
+
+namespace {
+
+void checkCSR(CheckedFrom c, const Tensor& crow_indices, const Tensor& col_indices) {
+  auto crow_arg = TensorArg(crow_indices, "crow_indices", 1);
+  auto col_arg = TensorArg(col_indices, "col_indices", 2);
+  checkScalarType(c, crow_arg, kLong);
+  checkScalarType(c, col_arg, kLong);
+  checkContiguous(c, crow_arg);
+  checkContiguous(c, col_arg);
+  checkDim(c, crow_arg, 1);
+  // empty tensors have no dimensions
+  AT_CHECK(col_indices.dim() <= 1, c, ": col_indices must be 1-D");
+
+  auto crow = crow_indices.data<int64_t>();
+  int64_t rows = crow_indices.size(0) - 1;
+  AT_CHECK(crow[0] == 0 && crow[rows] == col_indices.numel(),
+           c, ": crow_indices must start at 0 and end at nnz (", col_indices.numel(), ")");
+  for (int64_t i = 0; i < rows; i++) {
+    AT_CHECK(crow[i] <= crow[i + 1], c, ": crow_indices must be non-decreasing");
+  }
+}
+
+void checkColumns(CheckedFrom c, const Tensor& col_indices, int64_t cols) {
+  auto col = col_indices.data<int64_t>();
+  int64_t nnz = col_indices.numel();
+  for (int64_t p = 0; p < nnz; p++) {
+    AT_CHECK(col[p] >= 0 && col[p] < cols,
+             c, ": column index ", col[p], " is out of range for ", cols, " columns");
+  }
+}
+
+template <typename scalar_t>
+void csr_addmm_kernel(Tensor& result, const Tensor& crow_indices, const Tensor& col_indices,
+                      const Tensor& values, const Tensor& dense, Scalar alpha) {
+  auto crow = crow_indices.data<int64_t>();
+  auto col = col_indices.data<int64_t>();
+  auto val = values.data<scalar_t>();
+  auto in = dense.data<scalar_t>();
+  auto out = result.data<scalar_t>();
+  auto alpha_ = alpha.to<scalar_t>();
+  int64_t rows = result.size(0);
+  int64_t n = result.size(1);
+
+  // rows of the result are independent, so every thread owns some of them
+  #pragma omp parallel for if (values.numel() * n > 100000) schedule(dynamic, 16)
+  for (int64_t i = 0; i < rows; i++) {
+    scalar_t* out_row = out + i * n;
+    for (int64_t p = crow[i]; p < crow[i + 1]; p++) {
+      scalar_t v = alpha_ * val[p];
+      const scalar_t* in_row = in + col[p] * n;
+      for (int64_t k = 0; k < n; k++) {
+        out_row[k] += v * in_row[k];
+      }
+    }
+  }
+}
+
+} // anonymous namespace
+
+Tensor _csr_pointers_cpu(const Tensor& rows_, int64_t num_rows) {
+  auto rows_arg = TensorArg(rows_, "rows", 1);
+  checkScalarType("_csr_pointers", rows_arg, kLong);
+  AT_CHECK(rows_.dim() <= 1, "_csr_pointers: rows must be 1-D");
+  AT_CHECK(num_rows >= 0, "_csr_pointers: num_rows must be non-negative");
+
+  auto rows = rows_.contiguous();
+  auto row = rows.data<int64_t>();
+  int64_t nnz = rows.numel();
+  auto crow_indices = at::zeros(rows.type(), {num_rows + 1});
+  auto crow = crow_indices.data<int64_t>();
+  for (int64_t p = 0; p < nnz; p++) {
+    AT_CHECK(p == 0 || row[p - 1] <= row[p], "_csr_pointers: rows must be sorted");
+    AT_CHECK(row[p] >= 0 && row[p] < num_rows,
+             "_csr_pointers: row index ", row[p], " is out of range for ", num_rows, " rows");
+    crow[row[p] + 1]++;
+  }
+  for (int64_t i = 0; i < num_rows; i++) {
+    crow[i + 1] += crow[i];
+  }
+  return crow_indices;
+}
+
+Tensor _csr_row_indices_cpu(const Tensor& crow_indices) {
+  auto crow_arg = TensorArg(crow_indices, "crow_indices", 1);
+  checkScalarType("_csr_row_indices", crow_arg, kLong);
+  checkContiguous("_csr_row_indices", crow_arg);
+  checkDim("_csr_row_indices", crow_arg, 1);
+
+  auto crow = crow_indices.data<int64_t>();
+  int64_t rows = crow_indices.size(0) - 1;
+  auto row_indices = crow_indices.type().tensor({crow[rows]});
+  auto row = row_indices.data<int64_t>();
+  for (int64_t i = 0; i < rows; i++) {
+    for (int64_t p = crow[i]; p < crow[i + 1]; p++) {
+      row[p] = i;
+    }
+  }
+  return row_indices;
+}
+
+Tensor _csr_addmm_cpu(const Tensor& self, const Tensor& crow_indices, const Tensor& col_indices,
+                      const Tensor& values_, const Tensor& dense_, Scalar beta, Scalar alpha) {
+  checkCSR("_csr_addmm", crow_indices, col_indices);
+  auto values_arg = TensorArg(values_, "values", 3);
+  auto dense_arg = TensorArg(dense_, "dense", 4);
+  checkDim("_csr_addmm", dense_arg, 2);
+  checkSameType("_csr_addmm", values_arg, dense_arg);
+  AT_CHECK(values_.dim() <= 1 && values_.numel() == col_indices.numel(),
+           "_csr_addmm: values must be 1-D and of the same size as col_indices");
+  checkColumns("_csr_addmm", col_indices, dense_.size(0));
+
+  int64_t rows = crow_indices.size(0) - 1;
+  int64_t n = dense_.size(1);
+  auto values = values_.contiguous();
+  auto dense = dense_.contiguous();
+  auto result = dense.type().tensor({rows, n});
+  if (beta.toDouble() == 0) {
+    // like addmm, self is ignored (even NaNs) when beta is 0
+    result.zero_();
+  } else {
+    result.copy_(self.expand({rows, n}));
+    if (beta.toDouble() != 1) {
+      result.mul_(beta);
+    }
+  }
+
+  AT_DISPATCH_FLOATING_TYPES(values.type(), "_csr_addmm", [&] {
+    csr_addmm_kernel<scalar_t>(result, crow_indices, col_indices, values, dense, alpha);
+  });
+  return result;
+}
+
+Tensor _csr_mm(const Tensor& crow_indices, const Tensor& col_indices,
+               const Tensor& values, const Tensor& dense) {
+  return at::_csr_addmm(at::zeros(dense.type(), {1}), crow_indices, col_indices,
+                        values, dense, 0, 1);
+}
+
+std::tuple<Tensor, Tensor, Tensor> _csr_transpose_cpu(
+    const Tensor& crow_indices, const Tensor& col_indices, int64_t num_cols) {
+  checkCSR("_csr_transpose", crow_indices, col_indices);
+  checkColumns("_csr_transpose", col_indices, num_cols);
+
+  auto crow = crow_indices.data<int64_t>();
+  auto col = col_indices.data<int64_t>();
+  int64_t rows = crow_indices.size(0) - 1;
+  int64_t nnz = col_indices.numel();
+  auto crow_t_indices = at::zeros(crow_indices.type(), {num_cols + 1});
+  auto col_t_indices = col_indices.type().tensor({nnz});
+  auto positions = col_indices.type().tensor({nnz});
+  auto crow_t = crow_t_indices.data<int64_t>();
+  auto col_t = col_t_indices.data<int64_t>();
+  auto pos = positions.data<int64_t>();
+
+  // counting sort of the entries by column; visiting the rows in order keeps
+  // every row of the transpose sorted
+  for (int64_t p = 0; p < nnz; p++) {
+    crow_t[col[p] + 1]++;
+  }
+  for (int64_t j = 0; j < num_cols; j++) {
+    crow_t[j + 1] += crow_t[j];
+  }
+  std::vector<int64_t> next(crow_t, crow_t + num_cols);
+  for (int64_t i = 0; i < rows; i++) {
+    for (int64_t p = crow[i]; p < crow[i + 1]; p++) {
+      int64_t q = next[col[p]]++;
+      col_t[q] = i;
+      pos[q] = p;
+    }
+  }
+  return std::make_tuple(crow_t_indices, col_t_indices, positions);
+}
+
+std::tuple<Tensor, Tensor, Tensor> _csr_index_select_cpu(
+    const Tensor& crow_indices, const Tensor& col_indices, const Tensor& index_) {
+  checkCSR("_csr_index_select", crow_indices, col_indices);
+  auto index_arg = TensorArg(index_, "index", 3);
+  checkScalarType("_csr_index_select", index_arg, kLong);
+  AT_CHECK(index_.dim() <= 1, "_csr_index_select: index must be 1-D");
+
+  auto index = index_.contiguous();
+  auto crow = crow_indices.data<int64_t>();
+  auto col = col_indices.data<int64_t>();
+  auto idx = index.data<int64_t>();
+  int64_t rows = crow_indices.size(0) - 1;
+  int64_t num_selected = index.numel();
+
+  auto crow_out_indices = crow_indices.type().tensor({num_selected + 1});
+  auto crow_out = crow_out_indices.data<int64_t>();
+  crow_out[0] = 0;
+  for (int64_t i = 0; i < num_selected; i++) {
+    AT_CHECK(idx[i] >= 0 && idx[i] < rows,
+             "_csr_index_select: index ", idx[i], " is out of range for ", rows, " rows");
+    crow_out[i + 1] = crow_out[i] + (crow[idx[i] + 1] - crow[idx[i]]);
+  }
+
+  int64_t nnz = crow_out[num_selected];
+  auto col_out_indices = col_indices.type().tensor({nnz});
+  auto positions = col_indices.type().tensor({nnz});
+  auto col_out = col_out_indices.data<int64_t>();
+  auto pos = positions.data<int64_t>();
+  #pragma omp parallel for if (nnz > 100000)
+  for (int64_t i = 0; i < num_selected; i++) {
+    int64_t q = crow_out[i];
+    for (int64_t p = crow[idx[i]]; p < crow[idx[i] + 1]; p++, q++) {
+      col_out[q] = col[p];
+      pos[q] = p;
+    }
+  }
+  return std::make_tuple(crow_out_indices, col_out_indices, positions);
+}
+
+}} // namespace at::native
@@ -1,8 +1,17 @@
 #pragma once
 
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <stdexcept>
 #include <sstream>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
 
 namespace at { namespace native {
 
@@ -55,4 +64,104 @@ inline int64_t infer_ft_complex_to_real_onesided_size(int64_t complex_size,
   }
 }
 
+// Least recently used cache of FFT plans (cuFFT plans, MKL DFTI descriptors),
+// since making a plan often costs more than running it on small signals.
+//
+// Params must be a POD struct describing the plan, which is hashed and
+// compared bytewise, so it must be memset to zero before being filled in.
+// Plans are returned as shared_ptr, so that evicting a plan doesn't destroy
+// it under a thread that is still running it.
+template <typename Params, typename Plan>
+class FFTPlanCache {
+  static_assert(std::is_pod<Params>::value, "FFTPlanCache params must be a POD");
+
+public:
+  explicit FFTPlanCache(int64_t max_size) : max_size_(max_size) {}
+
+  // Returns the plan made by make_plan(params), making it on a miss
+  std::shared_ptr<Plan> get(const Params& params,
+                            const std::function<std::shared_ptr<Plan>(const Params&)>& make_plan) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    auto it = map_.find(params);
+    if (it != map_.end()) {
+      // Move to the front of the usage list
+      lru_.splice(lru_.begin(), lru_, it->second);
+      return it->second->second;
+    }
+    auto plan = make_plan(params);
+    if (max_size_ > 0) {
+      lru_.emplace_front(params, plan);
+      map_[params] = lru_.begin();
+      trim();
+    }
+    return plan;
+  }
+
+  int64_t max_size() {
+    std::lock_guard<std::mutex> guard(mutex_);
+    return max_size_;
+  }
+
+  // 0 disables the cache
+  void set_max_size(int64_t max_size) {
+    if (max_size < 0) {
+      throw std::runtime_error("FFT plan cache size must be non-negative");
+    }
+    std::lock_guard<std::mutex> guard(mutex_);
+    max_size_ = max_size;
+    trim();
+  }
+
+  int64_t size() {
+    std::lock_guard<std::mutex> guard(mutex_);
+    return static_cast<int64_t>(lru_.size());
+  }
+
+  void clear() {
+    std::lock_guard<std::mutex> guard(mutex_);
+    map_.clear();
+    lru_.clear();
+  }
+
+private:
+  struct ParamsHash {
+    size_t operator()(const Params& params) const {
+      auto ptr = reinterpret_cast<const uint8_t*>(&params);
+      uint32_t value = 0x811C9DC5;
+      for (size_t i = 0; i < sizeof(Params); ++i) {
+        value ^= ptr[i];
+        value *= 0x01000193;
+      }
+      return (size_t)value;
+    }
+  };
+
+  struct ParamsEqual {
+    bool operator()(const Params& a, const Params& b) const {
+      return memcmp(&a, &b, sizeof(Params)) == 0;
+    }
+  };
+
+  using Entry = std::pair<Params, std::shared_ptr<Plan>>;
+
+  void trim() {
+    while (static_cast<int64_t>(lru_.size()) > max_size_) {
+      map_.erase(lru_.back().first);
+      lru_.pop_back();
+    }
+  }
+
+  std::mutex mutex_;
+  int64_t max_size_;
+  // Most recently used first
+  std::list<Entry> lru_;
+  std::unordered_map<Params, typename std::list<Entry>::iterator, ParamsHash, ParamsEqual> map_;
+};
+
+// Signals have at most 3 dimensions
+constexpr int64_t max_signal_ndim = 3;
+
+// Default number of plans kept by each FFT plan cache
+constexpr int64_t fft_plan_cache_default_max_size = 1024;
+
 }} // at::native
@@ -1,28 +1,26 @@
 #include "ATen/ATen.h"
-#include "ATen/CPUApplyUtils.h"
 #include "ATen/Dispatch.h"
 #include "ATen/Error.h"
 #include "ATen/ExpandUtils.h"
 #include "ATen/NativeFunctions.h"
+#include "ATen/native/TensorIterator.h"
 
 namespace {
 template <typename scalar_t>
-void where_cpu(
-    at::Tensor& ret,
-    const at::Tensor& condition,
-    const at::Tensor& self,
-    const at::Tensor& other) {
-  at::CPU_tensor_apply4<scalar_t, uint8_t, scalar_t, scalar_t>(
-      ret,
-      condition,
-      self,
-      other,
-      [](scalar_t& ret_val,
-         const uint8_t& cond_val,
-         const scalar_t& self_val,
-         const scalar_t& other_val) {
-        ret_val = cond_val ? self_val : other_val;
-      });
+void where_cpu(at::TensorIterator& iter) {
+  iter.for_each([](int ntensors, char** data, const int64_t* strides, int64_t n) {
+    char* ret = data[0];
+    const char* cond = data[1];
+    const char* self = data[2];
+    const char* other = data[3];
+    for (int64_t i = 0; i < n; i++) {
+      *(scalar_t*)ret = *(const uint8_t*)cond ? *(const scalar_t*)self : *(const scalar_t*)other;
+      ret += strides[0];
+      cond += strides[1];
+      self += strides[2];
+      other += strides[3];
+    }
+  });
 }
 } // namespace
 
@@ -74,8 +72,9 @@ Tensor where(const Tensor& condition, const Tensor& self, const Tensor& other) {
 
 Tensor _s_where_cpu(const Tensor& condition, const Tensor& self, const Tensor& other) {
   Tensor ret = self.type().tensor(self.sizes());
+  auto iter = TensorIterator::ternary_op(ret, condition, self, other);
   AT_DISPATCH_ALL_TYPES(ret.type(), "where", [&] {
-    where_cpu<scalar_t>(ret, condition, self, other);
+    where_cpu<scalar_t>(iter);
   });
   return ret;
 }
@@ -5,6 +5,7 @@
 #include "ATen/Error.h"
 #include "ATen/NativeFunctions.h"
 #include "ATen/ScalarType.h"
+#include "TH/THAllocator.h"
 #include "TH/THRandom.h"
 
 #include <algorithm>
@@ -13,6 +14,26 @@
     namespace at {
 namespace native {
 
+namespace {
+
+// Dense CPU tensors of at least this many bytes are created by zeros with
+// memory that is already zero instead of being zeroed with a memset
+static constexpr int64_t kZeroedAllocationBytes = 1 << 20;
+
+// calloc hands out large blocks as fresh pages from the system, which read as
+// zero and are only backed by memory once written, so the zeros of a large
+// tensor cost nothing until they are touched
+struct ZeroedCPUAllocator final : public Allocator {
+  void* allocate(std::size_t n) const override {
+    return THZeroedAllocator.malloc(nullptr, n);
+  }
+  void deallocate(void* ptr) const override {
+    THZeroedAllocator.free(nullptr, ptr);
+  }
+};
+
+} // namespace
+
 Tensor arange(const Type& dtype, Scalar start, Scalar end, Scalar step) {
   return dtype._arange(start, end, step);
 }
@@ -294,6 +315,19 @@ Tensor& range_out(Tensor& result, Scalar start, Scalar end, Scalar step) {
 }
 
 Tensor zeros(const Type& dtype, IntList size) {
+  if (dtype.backend() == kCPU) {
+    int64_t numel = 1;
+    for (auto s : size) {
+      numel *= s;
+    }
+    if (numel * static_cast<int64_t>(dtype.elementSizeInBytes()) >= kZeroedAllocationBytes) {
+      auto result = dtype.tensorWithAllocator(size, std::unique_ptr<Allocator>(new ZeroedCPUAllocator()));
+      // Storages with an allocator are not resizable by default, but these
+      // behave like the ones of dtype.tensor(size)
+      result.storage()->set_flag(Storage::RESIZABLE);
+      return result;
+    }
+  }
   auto result = dtype.tensor(size);
   return at::native::zeros_out(result, size);
 }
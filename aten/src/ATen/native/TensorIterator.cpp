@@ -0,0 +1,252 @@
+#include "ATen/native/TensorIterator.h"
+
+#include "ATen/ExpandUtils.h"
+
+#include <algorithm>
+#include <numeric>
+
+namespace at {
+
+TensorIterator& TensorIterator::add_output(const Tensor& output) {
+  AT_ASSERTM(operands_.empty(), "TensorIterator: the output must be added first");
+  Operand op;
+  op.tensor = output;
+  operands_.push_back(std::move(op));
+  return *this;
+}
+
+TensorIterator& TensorIterator::add_input(const Tensor& input) {
+  AT_ASSERTM(!operands_.empty(), "TensorIterator: the output must be added first");
+  AT_CHECK(input.defined(), "TensorIterator: undefined input tensor");
+  Operand op;
+  op.tensor = input;
+  operands_.push_back(std::move(op));
+  return *this;
+}
+
+TensorIterator& TensorIterator::reduction() {
+  is_reduction_ = true;
+  return *this;
+}
+
+TensorIterator TensorIterator::unary_op(Tensor& out, const Tensor& a) {
+  TensorIterator iter;
+  iter.add_output(out).add_input(a);
+  iter.build();
+  return iter;
+}
+
+TensorIterator TensorIterator::binary_op(Tensor& out, const Tensor& a, const Tensor& b) {
+  TensorIterator iter;
+  iter.add_output(out).add_input(a).add_input(b);
+  iter.build();
+  return iter;
+}
+
+TensorIterator TensorIterator::ternary_op(
+    Tensor& out, const Tensor& a, const Tensor& b, const Tensor& c) {
+  TensorIterator iter;
+  iter.add_output(out).add_input(a).add_input(b).add_input(c);
+  iter.build();
+  return iter;
+}
+
+TensorIterator TensorIterator::reduce_op(Tensor& out, const Tensor& a) {
+  TensorIterator iter;
+  iter.add_output(out).add_input(a).reduction();
+  iter.build();
+  return iter;
+}
+
+TensorIterator TensorIterator::reduce_op(Tensor& out, const Tensor& a, const Tensor& b) {
+  TensorIterator iter;
+  iter.add_output(out).add_input(a).add_input(b).reduction();
+  iter.build();
+  return iter;
+}
+
+void TensorIterator::build() {
+  compute_shape();
+  compute_strides();
+  reorder_dimensions();
+  coalesce_dimensions();
+  for (auto& op : operands_) {
+    op.data = static_cast<char*>(op.tensor.data_ptr());
+  }
+}
+
+int64_t TensorIterator::numel() const {
+  int64_t n = 1;
+  for (auto size : shape_) {
+    n *= size;
+  }
+  return n;
+}
+
+int64_t TensorIterator::num_output_elements() const {
+  int64_t n = 1;
+  for (int dim = 0; dim < ndim(); dim++) {
+    if (operands_[0].stride_bytes[dim] != 0) {
+      n *= shape_[dim];
+    }
+  }
+  return n;
+}
+
+void TensorIterator::narrow(int dim, int64_t start, int64_t size) {
+  AT_ASSERT(dim < ndim() && size >= 1 && start + size <= shape_[dim]);
+  for (auto& op : operands_) {
+    op.data += start * op.stride_bytes[dim];
+  }
+  shape_[dim] = size;
+}
+
+bool TensorIterator::is_contiguous() const {
+  if (ndim() != 1) {
+    return false;
+  }
+  for (auto& op : operands_) {
+    if (op.stride_bytes[0] != static_cast<int64_t>(op.tensor.type().elementSizeInBytes())) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void TensorIterator::compute_shape() {
+  // Broadcast the inputs against each other, then make sure the output can
+  // hold the result. A mismatching output is resized, as TH does for out=
+  // arguments.
+  std::vector<int64_t> shape = operands_[0].tensor.sizes().vec();
+  for (int arg = 1; arg < ntensors(); arg++) {
+    auto sizes = operands_[arg].tensor.sizes();
+    shape = arg == 1 ? sizes.vec() : infer_size(shape, sizes);
+  }
+  auto& out = operands_[0].tensor;
+  if (is_reduction_) {
+    AT_CHECK(out.dim() == static_cast<int64_t>(shape.size()),
+             "TensorIterator: reduction output must have ", shape.size(),
+             " dimensions, but got ", out.dim());
+    for (int64_t d = 0; d < out.dim(); d++) {
+      AT_CHECK(out.size(d) == 1 || out.size(d) == shape[d],
+               "TensorIterator: reduction output has size ", out.size(d),
+               " at dimension ", d, ", expected 1 or ", shape[d]);
+    }
+  } else if (!out.sizes().equals(shape)) {
+    out.resize_(shape);
+  }
+  // Stored innermost-first; a 0-dim iteration space is treated as [1].
+  shape_.assign(shape.rbegin(), shape.rend());
+  if (shape_.empty()) {
+    shape_.push_back(1);
+  }
+}
+
+void TensorIterator::compute_strides() {
+  int ndim = this->ndim();
+  for (auto& op : operands_) {
+    auto& t = op.tensor;
+    int64_t element_size = t.type().elementSizeInBytes();
+    int64_t offset = ndim - t.dim();
+    op.stride_bytes.assign(ndim, 0);
+    for (int64_t d = 0; d < t.dim(); d++) {
+      // Dimensions that are broadcast (or of size 1, whose stride is
+      // meaningless) get stride 0.
+      if (t.size(d) != 1) {
+        op.stride_bytes[ndim - 1 - (d + offset)] = t.stride(d) * element_size;
+      }
+    }
+  }
+}
+
+void TensorIterator::reorder_dimensions() {
+  // Sort dimensions by increasing stride so that the innermost loop walks
+  // memory sequentially. The output decides; inputs break ties, and an
+  // operand that is broadcast along one of the two dimensions has no say.
+  int ndim = this->ndim();
+  if (ndim <= 1) {
+    return;
+  }
+  SmallVector<int, 6> perm(static_cast<size_t>(ndim));
+  std::iota(perm.begin(), perm.end(), 0);
+
+  // Returns true if dim0 should be iterated inside (faster than) dim1.
+  auto should_swap = [&](int dim0, int dim1) {
+    for (auto& op : operands_) {
+      int64_t stride0 = op.stride_bytes[dim0];
+      int64_t stride1 = op.stride_bytes[dim1];
+      if (stride0 == 0 || stride1 == 0) {
+        continue;
+      }
+      if (stride0 != stride1) {
+        return stride0 < stride1;
+      }
+    }
+    return false;
+  };
+
+  // Insertion sort, which keeps the original order among equivalent
+  // dimensions.
+  for (int i = 1; i < ndim; i++) {
+    for (int j = i; j > 0 && should_swap(perm[j], perm[j - 1]); j--) {
+      std::swap(perm[j], perm[j - 1]);
+    }
+  }
+
+  auto apply_perm = [&](SmallVector<int64_t, 6>& v) {
+    SmallVector<int64_t, 6> tmp(v.begin(), v.end());
+    for (int i = 0; i < ndim; i++) {
+      v[i] = tmp[perm[i]];
+    }
+  };
+  apply_perm(shape_);
+  for (auto& op : operands_) {
+    apply_perm(op.stride_bytes);
+  }
+}
+
+void TensorIterator::coalesce_dimensions() {
+  // Merge dimension d + 1 into d whenever stepping over the whole of d in
+  // every operand lands exactly one step of d + 1 further.
+  int ndim = this->ndim();
+  if (ndim <= 1) {
+    return;
+  }
+  auto can_coalesce = [&](int dim0, int dim1) {
+    if (shape_[dim0] == 1 || shape_[dim1] == 1) {
+      return true;
+    }
+    for (auto& op : operands_) {
+      if (shape_[dim0] * op.stride_bytes[dim0] != op.stride_bytes[dim1]) {
+        return false;
+      }
+    }
+    return true;
+  };
+
+  int prev = 0;
+  for (int dim = 1; dim < ndim; dim++) {
+    if (can_coalesce(prev, dim)) {
+      if (shape_[prev] == 1) {
+        for (auto& op : operands_) {
+          op.stride_bytes[prev] = op.stride_bytes[dim];
+        }
+      }
+      shape_[prev] *= shape_[dim];
+    } else {
+      prev++;
+      if (prev != dim) {
+        shape_[prev] = shape_[dim];
+        for (auto& op : operands_) {
+          op.stride_bytes[prev] = op.stride_bytes[dim];
+        }
+      }
+    }
+  }
+  shape_.resize(prev + 1);
+  for (auto& op : operands_) {
+    op.stride_bytes.resize(prev + 1);
+  }
+}
+
+} // namespace at
@@ -0,0 +1,162 @@
+#pragma once
+
+#include "ATen/ATen.h"
+#include "ATen/Parallel.h"
+#include "ATen/SmallVector.h"
+
+// TensorIterator is the shared loop engine for pointwise kernels. It
+// replaces the per-element stride bookkeeping of TH_TENSOR_APPLY and
+// CPU_tensor_apply with a geometry that is computed once per call:
+//
+//   1. the inputs are broadcast against each other and the output is resized
+//      to the broadcast shape if necessary;
+//   2. dimensions are reordered so that the one that moves fastest in memory
+//      (looking at the output first, then the inputs) is innermost;
+//   3. adjacent dimensions that can be addressed with a single stride in
+//      every operand are collapsed.
+//
+// Kernels then supply an inner loop that receives one pointer and one byte
+// stride per operand for a run of elements along the innermost dimension.
+// for_each() splits the iteration space across threads along the outer
+// dimensions; a single long inner dimension is split as well.
+//
+// Example:
+//   auto iter = TensorIterator::binary_op(result, a, b);
+//   iter.for_each([](int ntensors, char** data, const int64_t* strides, int64_t n) {
+//     for (int64_t i = 0; i < n; i++) {
+//       auto& out = *(float*)(data[0] + i * strides[0]);
+//       out = *(float*)(data[1] + i * strides[1]) + *(float*)(data[2] + i * strides[2]);
+//     }
+//   });
+//
+// Operand 0 is always the output; it may alias one of the inputs (for
+// in-place ops) as long as it has the full broadcast shape. Type checking is
+// left to the caller.
+//
+// For reductions (reduce_op) the output keeps the rank of the input and has
+// size 1 along the reduced dimensions, which then get output stride 0. The
+// output is not resized, and several elements of the iteration space map to
+// the same output element, so for_each() must not be used; see
+// native/cpu/Reduce.h for a loop that splits the work safely.
+
+namespace at {
+
+struct AT_API TensorIterator {
+  struct Operand {
+    Tensor tensor;
+    char* data = nullptr;
+    // Byte strides, innermost dimension first.
+    SmallVector<int64_t, 6> stride_bytes;
+  };
+
+  TensorIterator() {}
+
+  TensorIterator& add_output(const Tensor& output);
+  TensorIterator& add_input(const Tensor& input);
+  // Marks the iterator as a reduction; must be called before build().
+  TensorIterator& reduction();
+  // Computes the iteration geometry. Must be called once after all
+  // operands have been added.
+  void build();
+
+  static TensorIterator unary_op(Tensor& out, const Tensor& a);
+  static TensorIterator binary_op(Tensor& out, const Tensor& a, const Tensor& b);
+  static TensorIterator ternary_op(
+      Tensor& out, const Tensor& a, const Tensor& b, const Tensor& c);
+  static TensorIterator reduce_op(Tensor& out, const Tensor& a);
+  // Reduction with an extra input that has the shape of the output, e.g. the
+  // mean when computing a variance.
+  static TensorIterator reduce_op(Tensor& out, const Tensor& a, const Tensor& b);
+
+  int ntensors() const { return static_cast<int>(operands_.size()); }
+  int ndim() const { return static_cast<int>(shape_.size()); }
+  // Iteration shape, innermost dimension first.
+  IntList shape() const { return shape_; }
+  int64_t numel() const;
+  const Tensor& tensor(int arg) const { return operands_[arg].tensor; }
+  IntList strides(int arg) const { return operands_[arg].stride_bytes; }
+  // Address of the first element of the iteration space in operand arg
+  char* data_ptr(int arg) const { return operands_[arg].data; }
+  ScalarType dtype(int arg = 0) const { return operands_[arg].tensor.type().scalarType(); }
+  const Type& type(int arg = 0) const { return operands_[arg].tensor.type(); }
+
+  // True if every operand is contiguous along the collapsed innermost
+  // dimension with stride sizeof(element), i.e. the whole iteration space
+  // is a single flat loop.
+  bool is_contiguous() const;
+
+  bool is_reduction() const { return is_reduction_; }
+  // Number of distinct output elements touched by the iteration.
+  int64_t num_output_elements() const;
+  // Restricts the iteration space to [start, start + size) along dim.
+  void narrow(int dim, int64_t start, int64_t size);
+
+  // Calls loop(ntensors, data, strides, n) for consecutive runs of the
+  // elements in [begin, end) (in iteration order) on the calling thread.
+  template <typename loop_t>
+  void serial_for_each(const loop_t& loop, int64_t begin, int64_t end) const;
+
+  // Like serial_for_each over all elements, but in parallel.
+  template <typename loop_t>
+  void for_each(const loop_t& loop) const {
+    int64_t n = numel();
+    if (n == 0) {
+      return;
+    }
+    parallel_for(0, n, internal::TBB_GRAIN_SIZE, [&](int64_t begin, int64_t end) {
+      serial_for_each(loop, begin, end);
+    });
+  }
+
+ private:
+  void compute_shape();
+  void compute_strides();
+  void reorder_dimensions();
+  void coalesce_dimensions();
+
+  SmallVector<int64_t, 6> shape_;
+  SmallVector<Operand, 4> operands_;
+  bool is_reduction_ = false;
+};
+
+template <typename loop_t>
+void TensorIterator::serial_for_each(const loop_t& loop, int64_t begin, int64_t end) const {
+  int ntensors = this->ntensors();
+  int ndim = this->ndim();
+  SmallVector<char*, 4> ptrs(static_cast<size_t>(ntensors));
+  SmallVector<int64_t, 4> inner_strides(static_cast<size_t>(ntensors));
+  for (int arg = 0; arg < ntensors; arg++) {
+    inner_strides[arg] = operands_[arg].stride_bytes[0];
+  }
+
+  // Multi-dimensional counter over the outer dimensions, positioned at begin.
+  SmallVector<int64_t, 6> counter(static_cast<size_t>(ndim));
+  int64_t linear = begin;
+  for (int dim = 0; dim < ndim; dim++) {
+    counter[dim] = linear % shape_[dim];
+    linear /= shape_[dim];
+  }
+
+  int64_t idx = begin;
+  while (idx < end) {
+    for (int arg = 0; arg < ntensors; arg++) {
+      char* ptr = operands_[arg].data;
+      for (int dim = 0; dim < ndim; dim++) {
+        ptr += counter[dim] * operands_[arg].stride_bytes[dim];
+      }
+      ptrs[arg] = ptr;
+    }
+    int64_t n = std::min(shape_[0] - counter[0], end - idx);
+    loop(ntensors, ptrs.data(), inner_strides.data(), n);
+    idx += n;
+
+    // Advance the counter past the run that was just processed.
+    counter[0] += n;
+    for (int dim = 0; dim + 1 < ndim && counter[dim] == shape_[dim]; dim++) {
+      counter[dim] = 0;
+      counter[dim + 1]++;
+    }
+  }
+}
+
+} // namespace at
@@ -2,10 +2,13 @@
 #include "ATen/Error.h"
 #include "ATen/ExpandUtils.h"
 #include "ATen/NativeFunctions.h"
+#include "ATen/Parallel.h"
 #include "ATen/WrapDimUtils.h"
 #include "ATen/optional.h"
 
 #include <algorithm>
+#include <cstring>
+#include <vector>
 
 namespace at {
 namespace native {
@@ -19,15 +22,105 @@ static void check_cat_no_zero_dim(TensorList tensors) {
   }
 }
 
+static inline bool is_legacy_empty(const Tensor& t) {
+  return t.dim() == 1 && t.size(0) == 0;
+}
+
+// cat of contiguous CPU tensors of result's type into a contiguous result.
+// With outer the product of the sizes before dim, the result is outer rows,
+// each made of one contiguous slab of every input, so every (row, input)
+// pair is a single memcpy; these are spread over threads. The copy is untyped,
+// so there is no dispatch on the scalar type. Returns false without touching
+// result if the inputs don't qualify, leaving the general TH path (which also
+// reports the errors) to deal with them.
+static bool cat_contiguous_cpu(Tensor& result, TensorList tensors, int64_t dim) {
+  if (result.type().backend() != kCPU) {
+    return false;
+  }
+  // like TH, skip the legacy empty tensors
+  std::vector<const Tensor*> inputs;
+  for (auto& t : tensors) {
+    if (!is_legacy_empty(t)) {
+      inputs.push_back(&t);
+    }
+  }
+  if (inputs.empty() || dim < 0 || dim >= inputs[0]->dim()) {
+    return false;
+  }
+  std::vector<int64_t> sizes(inputs[0]->sizes());
+  sizes[dim] = 0;
+  for (auto t : inputs) {
+    if (t->type() != result.type() || t->dim() != inputs[0]->dim() || !t->is_contiguous() ||
+        t->data_ptr() == result.data_ptr()) {
+      return false;
+    }
+    for (int64_t d = 0; d < t->dim(); d++) {
+      if (d != dim && t->size(d) != sizes[d]) {
+        return false;
+      }
+    }
+    sizes[dim] += t->size(dim);
+  }
+  if (!result.sizes().equals(sizes)) {
+    result.resize_(sizes);
+  }
+  if (!result.is_contiguous()) {
+    return false;
+  }
+
+  int64_t element_size = result.type().elementSizeInBytes();
+  int64_t outer = 1;
+  for (int64_t d = 0; d < dim; d++) {
+    outer *= sizes[d];
+  }
+  int64_t num_inputs = inputs.size();
+  std::vector<const char*> input_data(num_inputs);
+  std::vector<int64_t> slab_bytes(num_inputs);
+  std::vector<int64_t> row_offsets(num_inputs);
+  int64_t row_bytes = 0;
+  for (int64_t i = 0; i < num_inputs; i++) {
+    input_data[i] = static_cast<const char*>(inputs[i]->data_ptr());
+    slab_bytes[i] = outer == 0 ? 0 : inputs[i]->numel() / outer * element_size;
+    row_offsets[i] = row_bytes;
+    row_bytes += slab_bytes[i];
+  }
+  char* result_data = static_cast<char*>(result.data_ptr());
+
+  int64_t num_slabs = outer * num_inputs;
+  if (num_slabs == 0 || row_bytes == 0) {
+    return true;
+  }
+  int64_t slab_elements = std::max<int64_t>(1, row_bytes / num_inputs / element_size);
+  int64_t grain_size = std::max<int64_t>(1, internal::TBB_GRAIN_SIZE / slab_elements);
+  parallel_for(0, num_slabs, grain_size, [&](int64_t begin, int64_t end) {
+    for (int64_t s = begin; s < end; s++) {
+      int64_t row = s / num_inputs;
+      int64_t i = s % num_inputs;
+      std::memcpy(result_data + row * row_bytes + row_offsets[i],
+                  input_data[i] + row * slab_bytes[i], slab_bytes[i]);
+    }
+  });
+  return true;
+}
+
 Tensor & cat_out(Tensor & result, TensorList tensors, int64_t dim) {
   check_cat_no_zero_dim(tensors);
   dim = legacy_cat_wrap_dim(dim, tensors);
+  if (cat_contiguous_cpu(result, tensors, dim)) {
+    return result;
+  }
   return at::_cat_out(result, tensors, dim);
 }
 
 Tensor cat(TensorList tensors, int64_t dim) {
   check_cat_no_zero_dim(tensors);
   dim = legacy_cat_wrap_dim(dim, tensors);
+  if (tensors.size() > 0 && tensors[0].type().backend() == kCPU) {
+    auto result = tensors[0].type().tensor();
+    if (cat_contiguous_cpu(result, tensors, dim)) {
+      return result;
+    }
+  }
   return at::_cat(tensors, dim);
 }
 
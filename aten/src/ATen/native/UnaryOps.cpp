@@ -32,8 +32,8 @@ Tensor& fill_(Tensor& self, const Tensor& value) {
   return self._fill_(value);
 }
 
-// NB: If you use this macro, you may also need to add a CUDA forwarding
-// stub in CUDAUnaryOps
+// NB: If you use this macro, you may also need to add a CUDA
+// implementation in cuda/UnaryOps.cu
 #define IMPLEMENT_UNARY_OP_PREQUEL(op)                           \
   Tensor op(const Tensor& self) {                                \
     Tensor result = self.type().tensor();                        \
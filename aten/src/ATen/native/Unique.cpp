@@ -3,56 +3,281 @@
 #include "ATen/ATen.h"
 #include "ATen/Dispatch.h"
 
-#include <set>
+#include <algorithm>
+#include <cstring>
 #include <tuple>
+#include <type_traits>
 #include <unordered_map>
 #include <unordered_set>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 namespace at {
 namespace native{
 
 namespace {
 
+// Inputs smaller than this are deduplicated with a hash table; larger ones
+// are radix sorted, which is parallel and produces sorted output for free.
+constexpr int64_t UNIQUE_HASH_THRESHOLD = 4096;
+constexpr int RADIX_BITS = 11;
+constexpr int64_t RADIX_OMP_THRESHOLD = 100000;
+
+// Maps a value to an unsigned key with the same ordering, so that values can
+// be radix sorted and compared bitwise.
 template <typename scalar_t>
-std::tuple<Tensor, Tensor> _unique_cpu_template(
-    const Tensor& self,
-    const bool sorted,
-    const bool return_inverse) {
-  const Tensor& input = self.contiguous();
+typename std::enable_if<std::is_integral<scalar_t>::value, uint64_t>::type
+sort_key(scalar_t value) {
+  if (std::is_signed<scalar_t>::value) {
+    return static_cast<uint64_t>(static_cast<int64_t>(value)) ^ (1ULL << 63);
+  }
+  return static_cast<uint64_t>(value);
+}
+
+// For floating point numbers, flipping the sign bit of positive values and
+// all the bits of negative ones orders the bit patterns like the values.
+// -0.0 is mapped to 0.0 so that they are not considered different.
+uint64_t sort_key(double value) {
+  if (value == 0) {
+    value = 0;
+  }
+  uint64_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  return (bits >> 63) ? ~bits : bits | (1ULL << 63);
+}
+
+uint64_t sort_key(float value) {
+  if (value == 0) {
+    value = 0;
+  }
+  uint32_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  return (bits >> 31) ? ~bits : bits | (1U << 31);
+}
+
+// Sorts the n keys in [0, max_key] and stores in perm the position each of
+// them came from, with a stable least significant digit radix sort (the same
+// scheme as THS_radixSort): each pass counts an 11-bit digit in every chunk
+// of the keys in parallel, turns the counts into output positions and
+// scatters the chunks in parallel. Digits above the highest bit of max_key
+// are skipped.
+void radix_sort(
+    std::vector<uint64_t>& keys,
+    std::vector<int64_t>& perm,
+    uint64_t max_key) {
+  const int64_t radix = 1 << RADIX_BITS;
+  const int64_t n = keys.size();
+  int nchunks = 1;
+#ifdef _OPENMP
+  if (n > RADIX_OMP_THRESHOLD && !omp_in_parallel()) {
+    nchunks = omp_get_max_threads();
+  }
+#endif
+  std::vector<uint64_t> keys_buffer(n);
+  std::vector<int64_t> perm_buffer(n);
+  std::vector<int64_t> counts(nchunks * radix);
+  for (int64_t i = 0; i < n; i++) {
+    perm[i] = i;
+  }
+  const int64_t chunk_size = (n + nchunks - 1) / nchunks;
+
+  for (int shift = 0; shift < 64 && (max_key >> shift) > 0; shift += RADIX_BITS) {
+    std::fill(counts.begin(), counts.end(), 0);
+    #pragma omp parallel for num_threads(nchunks) if (nchunks > 1)
+    for (int c = 0; c < nchunks; c++) {
+      int64_t* count = counts.data() + c * radix;
+      int64_t end = std::min(n, (c + 1) * chunk_size);
+      for (int64_t i = c * chunk_size; i < end; i++) {
+        count[(keys[i] >> shift) & (radix - 1)]++;
+      }
+    }
+    int64_t position = 0;
+    for (int64_t digit = 0; digit < radix; digit++) {
+      for (int c = 0; c < nchunks; c++) {
+        int64_t count = counts[c * radix + digit];
+        counts[c * radix + digit] = position;
+        position += count;
+      }
+    }
+    #pragma omp parallel for num_threads(nchunks) if (nchunks > 1)
+    for (int c = 0; c < nchunks; c++) {
+      int64_t* next = counts.data() + c * radix;
+      int64_t end = std::min(n, (c + 1) * chunk_size);
+      for (int64_t i = c * chunk_size; i < end; i++) {
+        int64_t j = next[(keys[i] >> shift) & (radix - 1)]++;
+        keys_buffer[j] = keys[i];
+        perm_buffer[j] = perm[i];
+      }
+    }
+    keys.swap(keys_buffer);
+    perm.swap(perm_buffer);
+  }
+}
+
+template <typename scalar_t>
+std::tuple<Tensor, Tensor, Tensor> _unique_cpu_radix(
+    const Tensor& input,
+    const bool return_inverse,
+    const bool return_counts) {
   const scalar_t* input_data = input.data<scalar_t>();
-  std::unordered_set<scalar_t> set(input_data, input_data + input.numel());
-  Tensor output = input.type().tensor({static_cast<int64_t>(set.size())});
+  const int64_t numel = input.numel();
+
+  std::vector<uint64_t> keys(numel);
+  #pragma omp parallel for if (numel > RADIX_OMP_THRESHOLD)
+  for (int64_t i = 0; i < numel; i++) {
+    keys[i] = sort_key(input_data[i]);
+  }
+  auto min_max = std::minmax_element(keys.begin(), keys.end());
+  const uint64_t min_key = *min_max.first;
+  const uint64_t max_key = *min_max.second - min_key;
+  #pragma omp parallel for if (numel > RADIX_OMP_THRESHOLD)
+  for (int64_t i = 0; i < numel; i++) {
+    keys[i] -= min_key;
+  }
+  std::vector<int64_t> perm(numel);
+  radix_sort(keys, perm, max_key);
+
+  // first[u] is the position in sorted order of the first copy of the u-th
+  // unique value; first.back() is numel so that every run has an end
+  std::vector<int64_t> first;
+  for (int64_t i = 0; i < numel; i++) {
+    if (i == 0 || keys[i] != keys[i - 1]) {
+      first.push_back(i);
+    }
+  }
+  const int64_t num_unique = first.size();
+  first.push_back(numel);
+
+  Tensor output = input.type().tensor({num_unique});
   scalar_t* output_data = output.data<scalar_t>();
+  #pragma omp parallel for if (numel > RADIX_OMP_THRESHOLD)
+  for (int64_t u = 0; u < num_unique; u++) {
+    output_data[u] = input_data[perm[first[u]]];
+  }
+
+  Tensor inverse_indices = input.type().toScalarType(kLong).tensor({0});
+  if (return_inverse) {
+    inverse_indices.resize_(input.sizes());
+    int64_t* inverse_indices_data = inverse_indices.data<int64_t>();
+    #pragma omp parallel for if (numel > RADIX_OMP_THRESHOLD)
+    for (int64_t u = 0; u < num_unique; u++) {
+      for (int64_t i = first[u]; i < first[u + 1]; i++) {
+        inverse_indices_data[perm[i]] = u;
+      }
+    }
+  }
+
+  Tensor counts = input.type().toScalarType(kLong).tensor({0});
+  if (return_counts) {
+    counts.resize_({num_unique});
+    int64_t* counts_data = counts.data<int64_t>();
+    for (int64_t u = 0; u < num_unique; u++) {
+      counts_data[u] = first[u + 1] - first[u];
+    }
+  }
+  return std::make_tuple(output, inverse_indices, counts);
+}
 
+template <typename scalar_t>
+std::tuple<Tensor, Tensor, Tensor> _unique_cpu_hash(
+    const Tensor& input,
+    const bool sorted,
+    const bool return_inverse,
+    const bool return_counts) {
+  const scalar_t* input_data = input.data<scalar_t>();
+  const int64_t numel = input.numel();
+  Tensor inverse_indices = input.type().toScalarType(kLong).tensor({0});
+  Tensor counts = input.type().toScalarType(kLong).tensor({0});
+
+  if (!return_inverse && !return_counts) {
+    std::unordered_set<scalar_t> set(input_data, input_data + numel);
+    Tensor output = input.type().tensor({static_cast<int64_t>(set.size())});
+    scalar_t* output_data = output.data<scalar_t>();
+    if (sorted) {
+      std::vector<scalar_t> vec(set.begin(), set.end());
+      std::sort(vec.begin(), vec.end());
+      std::copy(vec.begin(), vec.end(), output_data);
+    } else {
+      std::copy(set.begin(), set.end(), output_data);
+    }
+    return std::make_tuple(output, inverse_indices, counts);
+  }
+
+  // number the unique values in order of first occurrence, remembering the
+  // number of every element
+  std::unordered_map<scalar_t, int64_t> ids;
+  std::vector<scalar_t> values;
+  std::vector<int64_t> element_ids(numel);
+  for (int64_t i = 0; i < numel; i++) {
+    auto it = ids.emplace(input_data[i], values.size());
+    if (it.second) {
+      values.push_back(input_data[i]);
+    }
+    element_ids[i] = it.first->second;
+  }
+  const int64_t num_unique = values.size();
+
+  // rank[id] is the position of unique value id in the output
+  std::vector<int64_t> rank(num_unique);
+  for (int64_t u = 0; u < num_unique; u++) {
+    rank[u] = u;
+  }
   if (sorted) {
-    std::vector<scalar_t> vec(set.begin(), set.end());
-    std::sort(vec.begin(), vec.end());
-    std::copy(vec.begin(), vec.end(), output_data);
-  } else {
-    std::copy(set.begin(), set.end(), output_data);
+    std::vector<int64_t> order(rank);
+    std::sort(order.begin(), order.end(), [&](int64_t a, int64_t b) {
+      return values[a] < values[b];
+    });
+    for (int64_t u = 0; u < num_unique; u++) {
+      rank[order[u]] = u;
+    }
   }
 
-  Tensor inverse_indices = self.type().toScalarType(kLong).tensor({0});
+  Tensor output = input.type().tensor({num_unique});
+  scalar_t* output_data = output.data<scalar_t>();
+  for (int64_t u = 0; u < num_unique; u++) {
+    output_data[rank[u]] = values[u];
+  }
   if (return_inverse) {
     inverse_indices.resize_(input.sizes());
     int64_t* inverse_indices_data = inverse_indices.data<int64_t>();
-    std::unordered_map<scalar_t, int64_t> inverse_map;
-    inverse_map.reserve(output.numel());
-    for (int i = 0; i < output.numel(); ++i) {
-      inverse_map[output_data[i]] = i;
+    for (int64_t i = 0; i < numel; i++) {
+      inverse_indices_data[i] = rank[element_ids[i]];
     }
-    for (int i = 0; i < input.numel(); ++i) {
-      inverse_indices_data[i] = inverse_map[input_data[i]];
+  }
+  if (return_counts) {
+    counts.resize_({num_unique}).zero_();
+    int64_t* counts_data = counts.data<int64_t>();
+    for (int64_t i = 0; i < numel; i++) {
+      counts_data[rank[element_ids[i]]]++;
     }
   }
-  return std::make_tuple(output, inverse_indices);
+  return std::make_tuple(output, inverse_indices, counts);
+}
+
+template <typename scalar_t>
+std::tuple<Tensor, Tensor, Tensor> _unique_cpu_template(
+    const Tensor& self,
+    const bool sorted,
+    const bool return_inverse,
+    const bool return_counts) {
+  const Tensor& input = self.contiguous();
+  if (input.numel() < UNIQUE_HASH_THRESHOLD) {
+    return _unique_cpu_hash<scalar_t>(input, sorted, return_inverse, return_counts);
+  }
+  return _unique_cpu_radix<scalar_t>(input, return_inverse, return_counts);
 }
 } // namespace
 
-std::tuple<Tensor, Tensor>
-_unique_cpu(const Tensor& self, const bool sorted, const bool return_inverse) {
+std::tuple<Tensor, Tensor, Tensor> _unique_cpu(
+    const Tensor& self,
+    const bool sorted,
+    const bool return_inverse,
+    const bool return_counts) {
   return AT_DISPATCH_ALL_TYPES(self.type(), "unique", [&] {
-    return _unique_cpu_template<scalar_t>(self, sorted, return_inverse);
+    return _unique_cpu_template<scalar_t>(self, sorted, return_inverse, return_counts);
   });
 }
 
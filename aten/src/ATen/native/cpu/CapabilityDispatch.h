@@ -3,6 +3,7 @@
 #include <cpuinfo.h>
 #include <type_traits>
 #include <iostream>
+#include <utility>
 
 // Implements instruction set specific function dispatch.
 //
@@ -10,7 +11,9 @@
 // compiled multiple times with different compiler flags (e.g. -mavx). A
 // DispatchStub contains a table of function pointers for a kernel. At runtime,
 // the fastest available kernel is chosen based on the features reported by
-// cpuinfo.
+// cpuinfo. On x86 these are AVX-512 (with Vec512 for float and double), AVX2
+// and AVX; on ARM, NEON. A capability can be skipped by setting the
+// ATEN_DISABLE_<capability> environment variable, e.g. ATEN_DISABLE_AVX512.
 //
 // Example:
 //
@@ -29,32 +32,47 @@
 namespace at {
 namespace native {
 
-enum class CPUCapability { DEFAULT, AVX, AVX2, NUM_OPTIONS };
+enum class CPUCapability { DEFAULT, AVX, AVX2, AVX512, NEON, NUM_OPTIONS };
 
 template <typename FnPtr>
 struct DispatchStub {
   static_assert(std::is_pointer<FnPtr>::value, "FnPtr should be a pointer type");
 
   template <typename... ArgTypes>
-  void operator()(ArgTypes... args) {
+  void operator()(ArgTypes&&... args) {
     if (!dispatch_ptr) {
       dispatch_ptr = choose_impl();
     }
-    (*dispatch_ptr)(args...);
+    (*dispatch_ptr)(std::forward<ArgTypes>(args)...);
   }
 
   FnPtr choose_impl() {
 // Do not use cpuinfo on PowerPC as it shows confusing errors when run on ppc
 #ifndef __powerpc__
     if (cpuinfo_initialize()) {
+      // the AVX, AVX2 and AVX512 kernels are also compiled with -mf16c, and
+      // the AVX512 kernels with all of AVX2 and FMA
+      int avx512 = static_cast<int>(CPUCapability::AVX512);
+      if (!std::getenv("ATEN_DISABLE_AVX512") && cpuinfo_has_x86_avx512f() &&
+          cpuinfo_has_x86_avx2() && cpuinfo_has_x86_fma3() &&
+          cpuinfo_has_x86_f16c() && table[avx512]) {
+        return table[avx512];
+      }
       int avx2 = static_cast<int>(CPUCapability::AVX2);
-      if (!std::getenv("ATEN_DISABLE_AVX2") && cpuinfo_has_x86_avx2() && table[avx2]) {
+      if (!std::getenv("ATEN_DISABLE_AVX2") && cpuinfo_has_x86_avx2() &&
+          cpuinfo_has_x86_f16c() && table[avx2]) {
         return table[avx2];
       }
       int avx = static_cast<int>(CPUCapability::AVX);
-      if (!std::getenv("ATEN_DISABLE_AVX") && cpuinfo_has_x86_avx() && table[avx]) {
+      if (!std::getenv("ATEN_DISABLE_AVX") && cpuinfo_has_x86_avx() &&
+          cpuinfo_has_x86_f16c() && table[avx]) {
         return table[avx];
       }
+      int neon = static_cast<int>(CPUCapability::NEON);
+      if (!std::getenv("ATEN_DISABLE_NEON") && cpuinfo_has_arm_neon() &&
+          table[neon]) {
+        return table[neon];
+      }
     }
 #endif
     int def = static_cast<int>(CPUCapability::DEFAULT);
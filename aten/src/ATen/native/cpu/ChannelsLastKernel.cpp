@@ -0,0 +1,203 @@
+#include "ATen/native/cpu/ChannelsLastKernel.h"
+
+#include "ATen/AccumulateType.h"
+#include "ATen/Dispatch.h"
+#include "ATen/Parallel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+// The values of the C channels of a pixel are contiguous, so these kernels
+// loop over pixels and, innermost, over channels, which the compiler
+// vectorizes.
+
+namespace at { namespace native {
+namespace {
+
+// Number of pixels of C channels per task
+static inline int64_t grain_size_for(int64_t C) {
+  return std::max<int64_t>(1, internal::TBB_GRAIN_SIZE / std::max<int64_t>(1, C));
+}
+
+static void max_pool2d_channels_last_kernel_impl(
+    Tensor& output, Tensor& indices, const Tensor& input,
+    int64_t kH, int64_t kW, int64_t dH, int64_t dW,
+    int64_t padH, int64_t padW, int64_t dilationH, int64_t dilationW) {
+  int64_t C = input.size(1);
+  int64_t iH = input.size(2);
+  int64_t iW = input.size(3);
+  int64_t oH = output.size(2);
+  int64_t oW = output.size(3);
+  AT_DISPATCH_FLOATING_TYPES(input.type(), "max_pool2d_channels_last", [&] {
+    const scalar_t* input_data = input.data<scalar_t>();
+    scalar_t* output_data = output.data<scalar_t>();
+    int64_t* indices_data = indices.data<int64_t>();
+    parallel_for(0, output.size(0) * oH * oW, grain_size_for(C),
+                 [&](int64_t begin, int64_t end) {
+      for (int64_t i = begin; i < end; i++) {
+        int64_t n = i / (oH * oW);
+        int64_t oh = i / oW % oH;
+        int64_t ow = i % oW;
+        int64_t hstart = oh * dH - padH;
+        int64_t wstart = ow * dW - padW;
+        int64_t hend = std::min(hstart + (kH - 1) * dilationH + 1, iH);
+        int64_t wend = std::min(wstart + (kW - 1) * dilationW + 1, iW);
+        while (hstart < 0) hstart += dilationH;
+        while (wstart < 0) wstart += dilationW;
+
+        scalar_t* out = output_data + i * C;
+        int64_t* ind = indices_data + i * C;
+        std::fill(out, out + C, -std::numeric_limits<scalar_t>::infinity());
+        std::fill(ind, ind + C, -1);
+        for (int64_t h = hstart; h < hend; h += dilationH) {
+          for (int64_t w = wstart; w < wend; w += dilationW) {
+            const scalar_t* in = input_data + ((n * iH + h) * iW + w) * C;
+            int64_t offset = h * iW + w;
+            for (int64_t c = 0; c < C; c++) {
+              if (in[c] > out[c] || std::isnan(in[c])) {
+                out[c] = in[c];
+                ind[c] = offset;
+              }
+            }
+          }
+        }
+      }
+    });
+  });
+}
+
+static void avg_pool2d_channels_last_kernel_impl(
+    Tensor& output, const Tensor& input,
+    int64_t kH, int64_t kW, int64_t dH, int64_t dW,
+    int64_t padH, int64_t padW, bool count_include_pad) {
+  int64_t C = input.size(1);
+  int64_t iH = input.size(2);
+  int64_t iW = input.size(3);
+  int64_t oH = output.size(2);
+  int64_t oW = output.size(3);
+  AT_DISPATCH_FLOATING_TYPES(input.type(), "avg_pool2d_channels_last", [&] {
+    const scalar_t* input_data = input.data<scalar_t>();
+    scalar_t* output_data = output.data<scalar_t>();
+    parallel_for(0, output.size(0) * oH * oW, grain_size_for(C),
+                 [&](int64_t begin, int64_t end) {
+      for (int64_t i = begin; i < end; i++) {
+        int64_t n = i / (oH * oW);
+        int64_t oh = i / oW % oH;
+        int64_t ow = i % oW;
+        int64_t hstart = oh * dH - padH;
+        int64_t wstart = ow * dW - padW;
+        int64_t hend = std::min(hstart + kH, iH + padH);
+        int64_t wend = std::min(wstart + kW, iW + padW);
+        int64_t pool_size = (hend - hstart) * (wend - wstart);
+        hstart = std::max<int64_t>(hstart, 0);
+        wstart = std::max<int64_t>(wstart, 0);
+        hend = std::min(hend, iH);
+        wend = std::min(wend, iW);
+        int64_t divide_factor = count_include_pad ? pool_size : (hend - hstart) * (wend - wstart);
+
+        scalar_t* out = output_data + i * C;
+        std::fill(out, out + C, scalar_t(0));
+        for (int64_t h = hstart; h < hend; h++) {
+          for (int64_t w = wstart; w < wend; w++) {
+            const scalar_t* in = input_data + ((n * iH + h) * iW + w) * C;
+            for (int64_t c = 0; c < C; c++) {
+              out[c] += in[c];
+            }
+          }
+        }
+        for (int64_t c = 0; c < C; c++) {
+          out[c] /= divide_factor;
+        }
+      }
+    });
+  });
+}
+
+// total[c] = the sum of f(x, c) over the values x of channel c. Every chunk
+// of pixels accumulates its own partial sums, which are added up afterwards.
+template <typename scalar_t, typename acc_t, typename F>
+static void channel_sums(const scalar_t* data, int64_t pixels, int64_t C,
+                         acc_t* total, const F& f) {
+  int64_t chunk_size = grain_size_for(C);
+  int64_t num_chunks = (pixels + chunk_size - 1) / chunk_size;
+  std::vector<acc_t> partial(num_chunks * C, acc_t(0));
+  parallel_for(0, num_chunks, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t chunk = begin; chunk < end; chunk++) {
+      acc_t* acc = partial.data() + chunk * C;
+      int64_t chunk_end = std::min(pixels, (chunk + 1) * chunk_size);
+      for (int64_t i = chunk * chunk_size; i < chunk_end; i++) {
+        const scalar_t* x = data + i * C;
+        for (int64_t c = 0; c < C; c++) {
+          acc[c] += f(x[c], c);
+        }
+      }
+    }
+  });
+  std::fill(total, total + C, acc_t(0));
+  for (int64_t chunk = 0; chunk < num_chunks; chunk++) {
+    for (int64_t c = 0; c < C; c++) {
+      total[c] += partial[chunk * C + c];
+    }
+  }
+}
+
+static void channels_last_moments_kernel_impl(Tensor& mean, Tensor& var,
+                                              const Tensor& input) {
+  int64_t C = input.size(1);
+  int64_t pixels = input.numel() / C;
+  AT_DISPATCH_FLOATING_TYPES(input.type(), "channels_last_moments", [&] {
+    using acc_t = acc_type<scalar_t, false>;
+    const scalar_t* input_data = input.data<scalar_t>();
+    scalar_t* mean_data = mean.data<scalar_t>();
+    scalar_t* var_data = var.data<scalar_t>();
+
+    // Two passes, for the accuracy of the variance
+    std::vector<acc_t> channel_mean(C), m2(C);
+    channel_sums(input_data, pixels, C, channel_mean.data(),
+                 [](scalar_t x, int64_t c) { return static_cast<acc_t>(x); });
+    for (int64_t c = 0; c < C; c++) {
+      channel_mean[c] /= pixels;
+      mean_data[c] = static_cast<scalar_t>(channel_mean[c]);
+    }
+    const acc_t* mean_acc = channel_mean.data();
+    channel_sums(input_data, pixels, C, m2.data(), [mean_acc](scalar_t x, int64_t c) {
+      acc_t d = static_cast<acc_t>(x) - mean_acc[c];
+      return d * d;
+    });
+    for (int64_t c = 0; c < C; c++) {
+      var_data[c] = static_cast<scalar_t>(m2[c] / pixels);
+    }
+  });
+}
+
+static void channels_last_affine_kernel_impl(Tensor& output, const Tensor& input,
+                                             const Tensor& scale, const Tensor& shift) {
+  int64_t C = input.size(1);
+  int64_t pixels = input.numel() / C;
+  AT_DISPATCH_FLOATING_TYPES(input.type(), "channels_last_affine", [&] {
+    const scalar_t* input_data = input.data<scalar_t>();
+    scalar_t* output_data = output.data<scalar_t>();
+    const scalar_t* scale_data = scale.data<scalar_t>();
+    const scalar_t* shift_data = shift.data<scalar_t>();
+    parallel_for(0, pixels, grain_size_for(C), [&](int64_t begin, int64_t end) {
+      for (int64_t i = begin; i < end; i++) {
+        const scalar_t* x = input_data + i * C;
+        scalar_t* y = output_data + i * C;
+        for (int64_t c = 0; c < C; c++) {
+          y[c] = x[c] * scale_data[c] + shift_data[c];
+        }
+      }
+    });
+  });
+}
+
+} // anonymous namespace
+
+REGISTER_DISPATCH(max_pool2d_channels_last_kernel, &max_pool2d_channels_last_kernel_impl);
+REGISTER_DISPATCH(avg_pool2d_channels_last_kernel, &avg_pool2d_channels_last_kernel_impl);
+REGISTER_DISPATCH(channels_last_moments_kernel, &channels_last_moments_kernel_impl);
+REGISTER_DISPATCH(channels_last_affine_kernel, &channels_last_affine_kernel_impl);
+
+}} // namespace at::native
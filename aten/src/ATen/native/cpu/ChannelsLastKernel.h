@@ -0,0 +1,42 @@
+#pragma once
+
+#include <ATen/ATen.h>
+#include "CapabilityDispatch.h"
+
+namespace at { namespace native {
+
+// Kernels for 4-d tensors in the channels-last memory format, i.e. of size
+// (N, C, H, W) but laid out as a contiguous (N, H, W, C) tensor (see
+// is_channels_last). Outputs must be allocated in the same format.
+
+// Max pooling. indices holds the h * W + w offset of every maximum in its
+// plane, like those of THNN's SpatialDilatedMaxPooling.
+using max_pool2d_channels_last_fn = void(*)(Tensor& output, Tensor& indices,
+                                            const Tensor& input,
+                                            int64_t kH, int64_t kW,
+                                            int64_t dH, int64_t dW,
+                                            int64_t padH, int64_t padW,
+                                            int64_t dilationH, int64_t dilationW);
+
+// Average pooling, with the divisors of THNN's SpatialAveragePooling
+using avg_pool2d_channels_last_fn = void(*)(Tensor& output, const Tensor& input,
+                                            int64_t kH, int64_t kW,
+                                            int64_t dH, int64_t dW,
+                                            int64_t padH, int64_t padW,
+                                            bool count_include_pad);
+
+// Mean and biased variance of every channel of input (C elements each)
+using channels_last_moments_fn = void(*)(Tensor& mean, Tensor& var,
+                                         const Tensor& input);
+
+// output = input * scale[c] + shift[c] for the values of channel c; scale
+// and shift are contiguous with C elements
+using channels_last_affine_fn = void(*)(Tensor& output, const Tensor& input,
+                                        const Tensor& scale, const Tensor& shift);
+
+extern DispatchStub<max_pool2d_channels_last_fn> max_pool2d_channels_last_kernel;
+extern DispatchStub<avg_pool2d_channels_last_fn> avg_pool2d_channels_last_kernel;
+extern DispatchStub<channels_last_moments_fn> channels_last_moments_kernel;
+extern DispatchStub<channels_last_affine_fn> channels_last_affine_kernel;
+
+}} // namespace at::native
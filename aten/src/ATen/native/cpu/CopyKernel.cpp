@@ -0,0 +1,294 @@
+#include "ATen/native/cpu/CopyKernel.h"
+
+#include "ATen/Dispatch.h"
+#include "ATen/Parallel.h"
+#include "ATen/cpu/vec256/vec256.h"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+namespace at { namespace native {
+namespace {
+
+using namespace vec256;
+
+// Side of the square tiles of a transposing copy; a tile of either tensor
+// fits in L1 for every scalar type
+constexpr int64_t kTileSize = 32;
+
+// Elements per conversion through a float buffer, for half
+constexpr int64_t kHalfChunkSize = 256;
+
+// Half converts through float, like TH's copy; contiguous runs of half are
+// converted with the F16C instructions of the AVX capabilities
+template <typename To, typename From>
+struct Cast {
+  static inline To apply(From x) { return static_cast<To>(x); }
+};
+
+template <typename To>
+struct Cast<To, Half> {
+  static inline To apply(Half x) { return static_cast<To>(convert<float, Half>(x)); }
+};
+
+template <typename From>
+struct Cast<Half, From> {
+  static inline Half apply(From x) { return convert<Half, float>(static_cast<float>(x)); }
+};
+
+template <>
+struct Cast<Half, Half> {
+  static inline Half apply(Half x) { return x; }
+};
+
+// The dimensions of a copy without those of size 1 and with those that are
+// contiguous in both tensors merged, outermost first
+struct CopyDims {
+  std::vector<int64_t> sizes;
+  std::vector<int64_t> dst_strides;
+  std::vector<int64_t> src_strides;
+
+  CopyDims() {}
+
+  CopyDims(const Tensor& dst, const Tensor& src) {
+    for (int64_t d = 0; d < dst.dim(); d++) {
+      int64_t size = dst.size(d);
+      if (size == 1) {
+        continue;
+      }
+      if (!sizes.empty() && dst_strides.back() == size * dst.stride(d) &&
+          src_strides.back() == size * src.stride(d)) {
+        sizes.back() *= size;
+        dst_strides.back() = dst.stride(d);
+        src_strides.back() = src.stride(d);
+      } else {
+        push_back(size, dst.stride(d), src.stride(d));
+      }
+    }
+    if (sizes.empty()) {
+      push_back(1, 1, 1);
+    }
+  }
+
+  void push_back(int64_t size, int64_t dst_stride, int64_t src_stride) {
+    sizes.push_back(size);
+    dst_strides.push_back(dst_stride);
+    src_strides.push_back(src_stride);
+  }
+
+  int64_t dim() const {
+    return sizes.size();
+  }
+
+  int64_t numel() const {
+    int64_t n = 1;
+    for (auto size : sizes) {
+      n *= size;
+    }
+    return n;
+  }
+
+  // The dimensions other than a and b
+  CopyDims without(int64_t a, int64_t b = -1) const {
+    CopyDims result;
+    for (int64_t d = 0; d < dim(); d++) {
+      if (d != a && d != b) {
+        result.push_back(sizes[d], dst_strides[d], src_strides[d]);
+      }
+    }
+    return result;
+  }
+
+  // The first dimension for which the stride of dst is dst_stride and the
+  // stride of src is src_stride, where 0 matches any, or -1
+  int64_t find(int64_t dst_stride, int64_t src_stride) const {
+    for (int64_t d = 0; d < dim(); d++) {
+      if ((dst_stride == 0 || dst_strides[d] == dst_stride) &&
+          (src_stride == 0 || src_strides[d] == src_stride)) {
+        return d;
+      }
+    }
+    return -1;
+  }
+};
+
+// The offsets of the elements of the dimensions of a CopyDims, visited in
+// order starting from a linear index
+struct StridedCounter {
+  StridedCounter(const CopyDims& dims, int64_t linear)
+    : dims(dims), index(dims.dim()), dst_offset(0), src_offset(0) {
+    for (int64_t d = dims.dim() - 1; d >= 0; d--) {
+      index[d] = linear % dims.sizes[d];
+      linear /= dims.sizes[d];
+      dst_offset += index[d] * dims.dst_strides[d];
+      src_offset += index[d] * dims.src_strides[d];
+    }
+  }
+
+  void next() {
+    for (int64_t d = dims.dim() - 1; d >= 0; d--) {
+      index[d]++;
+      dst_offset += dims.dst_strides[d];
+      src_offset += dims.src_strides[d];
+      if (index[d] < dims.sizes[d]) {
+        return;
+      }
+      dst_offset -= index[d] * dims.dst_strides[d];
+      src_offset -= index[d] * dims.src_strides[d];
+      index[d] = 0;
+    }
+  }
+
+  const CopyDims& dims;
+  std::vector<int64_t> index;
+  int64_t dst_offset;
+  int64_t src_offset;
+};
+
+template <typename dst_t, typename src_t>
+static inline void convert_contiguous(dst_t* dst, const src_t* src, int64_t n) {
+  // kept as a plain loop for the compiler to vectorize
+  for (int64_t i = 0; i < n; i++) {
+    dst[i] = Cast<dst_t, src_t>::apply(src[i]);
+  }
+}
+
+static inline void convert_contiguous(float* dst, const Half* src, int64_t n) {
+  convert_half_to_float(src, dst, n);
+}
+
+static inline void convert_contiguous(Half* dst, const float* src, int64_t n) {
+  convert_float_to_half(src, dst, n);
+}
+
+static inline void convert_contiguous(Half* dst, const Half* src, int64_t n) {
+  std::memcpy(dst, src, n * sizeof(Half));
+}
+
+// Half and the types other than float convert through chunks of floats
+template <typename dst_t>
+static inline void convert_contiguous(dst_t* dst, const Half* src, int64_t n) {
+  float buffer[kHalfChunkSize];
+  for (int64_t i = 0; i < n; i += kHalfChunkSize) {
+    int64_t chunk = std::min(kHalfChunkSize, n - i);
+    convert_half_to_float(src + i, buffer, chunk);
+    convert_contiguous(dst + i, buffer, chunk);
+  }
+}
+
+template <typename src_t>
+static inline void convert_contiguous(Half* dst, const src_t* src, int64_t n) {
+  float buffer[kHalfChunkSize];
+  for (int64_t i = 0; i < n; i += kHalfChunkSize) {
+    int64_t chunk = std::min(kHalfChunkSize, n - i);
+    convert_contiguous(buffer, src + i, chunk);
+    convert_float_to_half(buffer, dst + i, chunk);
+  }
+}
+
+template <typename dst_t, typename src_t>
+static inline void convert_run(dst_t* dst, int64_t dst_stride, const src_t* src,
+                               int64_t src_stride, int64_t n) {
+  if (dst_stride == 1 && src_stride == 1) {
+    convert_contiguous(dst, src, n);
+  } else {
+    for (int64_t i = 0; i < n; i++) {
+      dst[i * dst_stride] = Cast<dst_t, src_t>::apply(src[i * src_stride]);
+    }
+  }
+}
+
+// Copies along dimension d, in parallel over the elements
+template <typename dst_t, typename src_t>
+static void copy_runs(dst_t* dst_data, const src_t* src_data, const CopyDims& dims, int64_t d) {
+  int64_t run_size = dims.sizes[d];
+  int64_t dst_stride = dims.dst_strides[d];
+  int64_t src_stride = dims.src_strides[d];
+  auto outer = dims.without(d);
+  parallel_for(0, dims.numel(), internal::TBB_GRAIN_SIZE, [&](int64_t begin, int64_t end) {
+    StridedCounter counter(outer, begin / run_size);
+    int64_t j = begin % run_size;
+    for (int64_t i = begin; i < end;) {
+      int64_t n = std::min(run_size - j, end - i);
+      convert_run(dst_data + counter.dst_offset + j * dst_stride, dst_stride,
+                  src_data + counter.src_offset + j * src_stride, src_stride, n);
+      i += n;
+      j = 0;
+      counter.next();
+    }
+  });
+}
+
+// Copies the planes of dimensions a, contiguous in dst, and b, contiguous in
+// src, in square tiles so that the strided side of every tile stays in cache,
+// in parallel over the tiles
+template <typename dst_t, typename src_t>
+static void copy_tiles(dst_t* dst_data, const src_t* src_data, const CopyDims& dims, int64_t a,
+                       int64_t b) {
+  int64_t size_a = dims.sizes[a];
+  int64_t size_b = dims.sizes[b];
+  int64_t dst_stride_b = dims.dst_strides[b];
+  int64_t src_stride_a = dims.src_strides[a];
+  int64_t tiles_a = (size_a + kTileSize - 1) / kTileSize;
+  int64_t tiles_per_plane = tiles_a * ((size_b + kTileSize - 1) / kTileSize);
+  auto outer = dims.without(a, b);
+  int64_t grain_size = std::max<int64_t>(1, internal::TBB_GRAIN_SIZE / (kTileSize * kTileSize));
+  parallel_for(0, outer.numel() * tiles_per_plane, grain_size, [&](int64_t begin, int64_t end) {
+    StridedCounter counter(outer, begin / tiles_per_plane);
+    int64_t tile = begin % tiles_per_plane;
+    for (int64_t t = begin; t < end; t++) {
+      int64_t a_begin = (tile % tiles_a) * kTileSize;
+      int64_t b_begin = (tile / tiles_a) * kTileSize;
+      int64_t a_end = std::min(a_begin + kTileSize, size_a);
+      int64_t b_end = std::min(b_begin + kTileSize, size_b);
+      dst_t* dst = dst_data + counter.dst_offset;
+      const src_t* src = src_data + counter.src_offset;
+      for (int64_t ib = b_begin; ib < b_end; ib++) {
+        for (int64_t ia = a_begin; ia < a_end; ia++) {
+          dst[ia + ib * dst_stride_b] = Cast<dst_t, src_t>::apply(src[ia * src_stride_a + ib]);
+        }
+      }
+      if (++tile == tiles_per_plane) {
+        tile = 0;
+        counter.next();
+      }
+    }
+  });
+}
+
+template <typename dst_t, typename src_t>
+static void copy_strided(dst_t* dst_data, const src_t* src_data, const CopyDims& dims) {
+  int64_t contiguous = dims.find(1, 1);
+  if (contiguous >= 0) {
+    copy_runs(dst_data, src_data, dims, contiguous);
+    return;
+  }
+  int64_t a = dims.find(1, 0);
+  int64_t b = dims.find(0, 1);
+  if (a >= 0 && b >= 0) {
+    copy_tiles(dst_data, src_data, dims, a, b);
+    return;
+  }
+  copy_runs(dst_data, src_data, dims, a >= 0 ? a : dims.dim() - 1);
+}
+
+static void copy_kernel_impl(Tensor& dst, const Tensor& src) {
+  if (dst.numel() == 0) {
+    return;
+  }
+  CopyDims dims(dst, src);
+  AT_DISPATCH_ALL_TYPES_AND_HALF(dst.type(), "copy_", [&] {
+    using dst_t = scalar_t;
+    dst_t* dst_data = dst.data<dst_t>();
+    AT_DISPATCH_ALL_TYPES_AND_HALF(src.type(), "copy_", [&] {
+      copy_strided(dst_data, src.data<scalar_t>(), dims);
+    });
+  });
+}
+
+} // anonymous namespace
+
+REGISTER_DISPATCH(copy_kernel, &copy_kernel_impl);
+
+}} // namespace at::native
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <ATen/ATen.h>
+#include "CapabilityDispatch.h"
+
+namespace at { namespace native {
+
+// dst = src converted to the scalar type of dst, for dense CPU tensors of
+// the same sizes with any strides. Runs over the dimensions collapsed to as
+// few as possible: in contiguous runs when both tensors have a common unit
+// stride dimension, in cache-blocked tiles when they have different ones (a
+// transposing copy), and in strided runs otherwise.
+using copy_fn = void(*)(Tensor& dst, const Tensor& src);
+
+extern DispatchStub<copy_fn> copy_kernel;
+
+}} // namespace at::native
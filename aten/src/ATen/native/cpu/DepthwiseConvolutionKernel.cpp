@@ -0,0 +1,242 @@
+#include "ATen/native/cpu/DepthwiseConvolutionKernel.h"
+
+#include "ATen/AccumulateType.h"
+#include "ATen/Dispatch.h"
+#include "ATen/Parallel.h"
+#include "ATen/cpu/vec256/vec256.h"
+
+#include <algorithm>
+
+// Instead of unfolding the input (im2col) and multiplying it with a single
+// filter per group, these kernels accumulate, for every filter tap, a row of
+// the input scaled by the tap into a row of the output. With a unit stride
+// the rows are contiguous and accumulated with vector instructions; this is
+// the same for every kernel size, so 3x3 and 5x5 filters need no special
+// casing.
+
+namespace at { namespace native {
+namespace {
+
+using namespace vec256;
+
+// y[i] += a * x[i * incx] for i in [0, n)
+template <typename scalar_t>
+static inline void axpy(int64_t n, scalar_t a, const scalar_t* x, int64_t incx, scalar_t* y) {
+  using Vec = Vectorized<scalar_t>;
+  int64_t i = 0;
+  if (incx == 1) {
+    Vec va(a);
+    for (; i + Vec::size <= n; i += Vec::size) {
+      (Vec::s_load(y + i) + va * Vec::s_load(x + i)).store(y + i);
+    }
+  }
+  for (; i < n; i++) {
+    y[i] += a * x[i * incx];
+  }
+}
+
+// y[i * incy] += a * x[i] for i in [0, n)
+template <typename scalar_t>
+static inline void axpy_strided(int64_t n, scalar_t a, const scalar_t* x, scalar_t* y, int64_t incy) {
+  if (incy == 1) {
+    axpy<scalar_t>(n, a, x, 1, y);
+    return;
+  }
+  for (int64_t i = 0; i < n; i++) {
+    y[i * incy] += a * x[i];
+  }
+}
+
+// sum(x[i] * y[i * incy]) for i in [0, n)
+template <typename scalar_t>
+static inline acc_type<scalar_t, false> dot(int64_t n, const scalar_t* x, const scalar_t* y, int64_t incy) {
+  using Vec = Vectorized<scalar_t>;
+  using accscalar_t = acc_type<scalar_t, false>;
+  accscalar_t sum = 0;
+  int64_t i = 0;
+  if (incy == 1 && n >= Vec::size) {
+    Vec vsum(0);
+    for (; i + Vec::size <= n; i += Vec::size) {
+      vsum = vsum + Vec::s_load(x + i) * Vec::s_load(y + i);
+    }
+    __at_align32__ scalar_t sums[Vec::size];
+    vsum.store(sums);
+    for (int k = 0; k < Vec::size; k++) {
+      sum += sums[k];
+    }
+  }
+  for (; i < n; i++) {
+    sum += static_cast<accscalar_t>(x[i]) * y[i * incy];
+  }
+  return sum;
+}
+
+// The output positions [begin, end) of a row of out_size whose input
+// position o * stride + offset is inside a row of in_size
+struct ValidRange {
+  int64_t begin;
+  int64_t end;
+
+  ValidRange(int64_t offset, int64_t stride, int64_t in_size, int64_t out_size) {
+    begin = offset >= 0 ? 0 : (-offset + stride - 1) / stride;
+    end = offset >= in_size ? 0 : std::min(out_size, (in_size - offset + stride - 1) / stride);
+    end = std::max(begin, end);
+  }
+
+  int64_t size() const { return end - begin; }
+};
+
+// Number of planes of plane_work operations per task
+static inline int64_t grain_size_for(int64_t plane_work) {
+  return std::max<int64_t>(1, internal::TBB_GRAIN_SIZE / std::max<int64_t>(1, plane_work));
+}
+
+static void depthwise_conv2d_kernel_impl(
+    Tensor& output, const Tensor& input, const Tensor& weight, const Tensor& bias,
+    int64_t dH, int64_t dW, int64_t padH, int64_t padW,
+    int64_t dilationH, int64_t dilationW) {
+  int64_t C = input.size(1);
+  int64_t iH = input.size(2);
+  int64_t iW = input.size(3);
+  int64_t OC = output.size(1);
+  int64_t oH = output.size(2);
+  int64_t oW = output.size(3);
+  int64_t kH = weight.size(2);
+  int64_t kW = weight.size(3);
+  int64_t multiplier = OC / C;
+  AT_DISPATCH_FLOATING_TYPES(input.type(), "depthwise_conv2d", [&] {
+    const scalar_t* input_data = input.data<scalar_t>();
+    const scalar_t* weight_data = weight.data<scalar_t>();
+    const scalar_t* bias_data = bias.defined() ? bias.data<scalar_t>() : nullptr;
+    scalar_t* output_data = output.data<scalar_t>();
+    parallel_for(0, output.size(0) * OC, grain_size_for(oH * oW * kH * kW),
+                 [&](int64_t begin, int64_t end) {
+      for (int64_t p = begin; p < end; p++) {
+        int64_t n = p / OC;
+        int64_t oc = p % OC;
+        const scalar_t* in = input_data + (n * C + oc / multiplier) * iH * iW;
+        const scalar_t* w = weight_data + oc * kH * kW;
+        scalar_t* out = output_data + p * oH * oW;
+        std::fill(out, out + oH * oW, bias_data ? bias_data[oc] : scalar_t(0));
+        for (int64_t kw = 0; kw < kW; kw++) {
+          ValidRange cols(kw * dilationW - padW, dW, iW, oW);
+          int64_t iw = cols.begin * dW + kw * dilationW - padW;
+          for (int64_t oh = 0; oh < oH; oh++) {
+            for (int64_t kh = 0; kh < kH; kh++) {
+              int64_t ih = oh * dH - padH + kh * dilationH;
+              if (ih < 0 || ih >= iH) {
+                continue;
+              }
+              axpy<scalar_t>(cols.size(), w[kh * kW + kw], in + ih * iW + iw, dW,
+                             out + oh * oW + cols.begin);
+            }
+          }
+        }
+      }
+    });
+  });
+}
+
+static void depthwise_conv2d_backward_input_kernel_impl(
+    Tensor& grad_input, const Tensor& grad_output, const Tensor& weight,
+    int64_t dH, int64_t dW, int64_t padH, int64_t padW,
+    int64_t dilationH, int64_t dilationW) {
+  int64_t C = grad_input.size(1);
+  int64_t iH = grad_input.size(2);
+  int64_t iW = grad_input.size(3);
+  int64_t OC = grad_output.size(1);
+  int64_t oH = grad_output.size(2);
+  int64_t oW = grad_output.size(3);
+  int64_t kH = weight.size(2);
+  int64_t kW = weight.size(3);
+  int64_t multiplier = OC / C;
+  AT_DISPATCH_FLOATING_TYPES(grad_output.type(), "depthwise_conv2d_backward_input", [&] {
+    const scalar_t* grad_output_data = grad_output.data<scalar_t>();
+    const scalar_t* weight_data = weight.data<scalar_t>();
+    scalar_t* grad_input_data = grad_input.data<scalar_t>();
+    // Every task owns the input planes it writes to
+    parallel_for(0, grad_input.size(0) * C, grain_size_for(multiplier * oH * oW * kH * kW),
+                 [&](int64_t begin, int64_t end) {
+      for (int64_t p = begin; p < end; p++) {
+        int64_t n = p / C;
+        int64_t c = p % C;
+        scalar_t* grad_in = grad_input_data + p * iH * iW;
+        std::fill(grad_in, grad_in + iH * iW, scalar_t(0));
+        for (int64_t oc = c * multiplier; oc < (c + 1) * multiplier; oc++) {
+          const scalar_t* grad_out = grad_output_data + (n * OC + oc) * oH * oW;
+          const scalar_t* w = weight_data + oc * kH * kW;
+          for (int64_t kw = 0; kw < kW; kw++) {
+            ValidRange cols(kw * dilationW - padW, dW, iW, oW);
+            int64_t iw = cols.begin * dW + kw * dilationW - padW;
+            for (int64_t oh = 0; oh < oH; oh++) {
+              for (int64_t kh = 0; kh < kH; kh++) {
+                int64_t ih = oh * dH - padH + kh * dilationH;
+                if (ih < 0 || ih >= iH) {
+                  continue;
+                }
+                axpy_strided<scalar_t>(cols.size(), w[kh * kW + kw], grad_out + oh * oW + cols.begin,
+                                       grad_in + ih * iW + iw, dW);
+              }
+            }
+          }
+        }
+      }
+    });
+  });
+}
+
+static void depthwise_conv2d_backward_weight_kernel_impl(
+    Tensor& grad_weight, const Tensor& grad_output, const Tensor& input,
+    int64_t dH, int64_t dW, int64_t padH, int64_t padW,
+    int64_t dilationH, int64_t dilationW) {
+  int64_t N = input.size(0);
+  int64_t C = input.size(1);
+  int64_t iH = input.size(2);
+  int64_t iW = input.size(3);
+  int64_t OC = grad_output.size(1);
+  int64_t oH = grad_output.size(2);
+  int64_t oW = grad_output.size(3);
+  int64_t kH = grad_weight.size(2);
+  int64_t kW = grad_weight.size(3);
+  int64_t multiplier = OC / C;
+  AT_DISPATCH_FLOATING_TYPES(input.type(), "depthwise_conv2d_backward_weight", [&] {
+    using accscalar_t = acc_type<scalar_t, false>;
+    const scalar_t* grad_output_data = grad_output.data<scalar_t>();
+    const scalar_t* input_data = input.data<scalar_t>();
+    scalar_t* grad_weight_data = grad_weight.data<scalar_t>();
+    // Every task owns the filters it writes to
+    parallel_for(0, OC, grain_size_for(N * oH * oW * kH * kW),
+                 [&](int64_t begin, int64_t end) {
+      for (int64_t oc = begin; oc < end; oc++) {
+        for (int64_t kh = 0; kh < kH; kh++) {
+          for (int64_t kw = 0; kw < kW; kw++) {
+            ValidRange cols(kw * dilationW - padW, dW, iW, oW);
+            int64_t iw = cols.begin * dW + kw * dilationW - padW;
+            accscalar_t sum = 0;
+            for (int64_t n = 0; n < N; n++) {
+              const scalar_t* grad_out = grad_output_data + (n * OC + oc) * oH * oW;
+              const scalar_t* in = input_data + (n * C + oc / multiplier) * iH * iW;
+              for (int64_t oh = 0; oh < oH; oh++) {
+                int64_t ih = oh * dH - padH + kh * dilationH;
+                if (ih < 0 || ih >= iH) {
+                  continue;
+                }
+                sum += dot<scalar_t>(cols.size(), grad_out + oh * oW + cols.begin,
+                                     in + ih * iW + iw, dW);
+              }
+            }
+            grad_weight_data[(oc * kH + kh) * kW + kw] = static_cast<scalar_t>(sum);
+          }
+        }
+      }
+    });
+  });
+}
+
+} // anonymous namespace
+
+REGISTER_DISPATCH(depthwise_conv2d_kernel, &depthwise_conv2d_kernel_impl);
+REGISTER_DISPATCH(depthwise_conv2d_backward_input_kernel, &depthwise_conv2d_backward_input_kernel_impl);
+REGISTER_DISPATCH(depthwise_conv2d_backward_weight_kernel, &depthwise_conv2d_backward_weight_kernel_impl);
+
+}} // namespace at::native
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <ATen/ATen.h>
+#include "CapabilityDispatch.h"
+
+namespace at { namespace native {
+
+// Direct 2D depthwise convolution: output channel oc of the (N, C * m, oH, oW)
+// output is the cross-correlation of input channel oc / m of the (N, C, iH, iW)
+// input with the (kH, kW) filter weight[oc][0], plus bias[oc] (bias may be
+// undefined). All tensors must be contiguous and output allocated.
+using depthwise_conv2d_fn = void(*)(Tensor& output, const Tensor& input,
+                                    const Tensor& weight, const Tensor& bias,
+                                    int64_t dH, int64_t dW, int64_t padH, int64_t padW,
+                                    int64_t dilationH, int64_t dilationW);
+
+// Gradient of the input of depthwise_conv2d_kernel, allocated like the input
+using depthwise_conv2d_backward_input_fn = void(*)(Tensor& grad_input, const Tensor& grad_output,
+                                                   const Tensor& weight,
+                                                   int64_t dH, int64_t dW, int64_t padH, int64_t padW,
+                                                   int64_t dilationH, int64_t dilationW);
+
+// Gradient of the weight of depthwise_conv2d_kernel, allocated like the weight
+using depthwise_conv2d_backward_weight_fn = void(*)(Tensor& grad_weight, const Tensor& grad_output,
+                                                    const Tensor& input,
+                                                    int64_t dH, int64_t dW, int64_t padH, int64_t padW,
+                                                    int64_t dilationH, int64_t dilationW);
+
+extern DispatchStub<depthwise_conv2d_fn> depthwise_conv2d_kernel;
+extern DispatchStub<depthwise_conv2d_backward_input_fn> depthwise_conv2d_backward_input_kernel;
+extern DispatchStub<depthwise_conv2d_backward_weight_fn> depthwise_conv2d_backward_weight_kernel;
+
+}} // namespace at::native
@@ -0,0 +1,223 @@
+#include "ATen/native/cpu/EmbeddingBagKernel.h"
+
+#include "ATen/Dispatch.h"
+#include "ATen/Parallel.h"
+#include "ATen/cpu/vec256/vec256.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace at { namespace native {
+namespace {
+
+using namespace vec256;
+
+// Looking up a bag is bound by the latency of fetching the weight rows, which
+// are scattered all over the table. Like caffe2's EmbeddingLookup, start
+// fetching the row kPrefetchDistance lookups ahead of the one being added.
+constexpr int64_t kPrefetchDistance = 16;
+
+template <typename scalar_t>
+static inline void prefetch_row(const scalar_t* row, int64_t size) {
+#if defined(__GNUC__)
+  constexpr int64_t kLine = 64 / sizeof(scalar_t);
+  for (int64_t k = 0; k < size; k += kLine) {
+    __builtin_prefetch(row + k, 0, 0);
+  }
+#endif
+}
+
+template <typename scalar_t>
+static void sum_bags(scalar_t* output, const scalar_t* weight, int64_t weight_stride,
+                     int64_t size, const int64_t* indices, const int64_t* offsets,
+                     int64_t num_indices, bool mean, int64_t begin, int64_t end,
+                     int64_t num_bags) {
+  using Vec = Vectorized<scalar_t>;
+  int64_t size_rounded = size - (size % Vec::size);
+  for (int64_t bag = begin; bag < end; bag++) {
+    int64_t start = offsets[bag];
+    int64_t stop = bag + 1 < num_bags ? offsets[bag + 1] : num_indices;
+    scalar_t* out = output + bag * size;
+    for (int64_t i = start; i < stop; i++) {
+      if (i + kPrefetchDistance < stop) {
+        prefetch_row(weight + indices[i + kPrefetchDistance] * weight_stride, size);
+      }
+      const scalar_t* row = weight + indices[i] * weight_stride;
+      int64_t k = 0;
+      for (; k != size_rounded; k += Vec::size) {
+        (Vec::s_load(out + k) + Vec::s_load(row + k)).store(out + k);
+      }
+      for (; k < size; k++) {
+        out[k] += row[k];
+      }
+    }
+    if (mean && stop > start) {
+      // empty bags stay all zeros
+      Vec scale(static_cast<scalar_t>(1) / (stop - start));
+      int64_t k = 0;
+      for (; k != size_rounded; k += Vec::size) {
+        (Vec::s_load(out + k) * scale).store(out + k);
+      }
+      for (; k < size; k++) {
+        out[k] /= (stop - start);
+      }
+    }
+  }
+}
+
+// Half rows are converted to float with F16C a chunk at a time and added to
+// the float output
+static void sum_half_bags(float* output, const Half* weight, int64_t weight_stride,
+                          int64_t size, const int64_t* indices, const int64_t* offsets,
+                          int64_t num_indices, bool mean, int64_t begin, int64_t end,
+                          int64_t num_bags) {
+  using Vec = Vectorized<float>;
+  constexpr int64_t kChunkSize = 256;
+  float buffer[kChunkSize];
+  for (int64_t bag = begin; bag < end; bag++) {
+    int64_t start = offsets[bag];
+    int64_t stop = bag + 1 < num_bags ? offsets[bag + 1] : num_indices;
+    float* out = output + bag * size;
+    for (int64_t i = start; i < stop; i++) {
+      if (i + kPrefetchDistance < stop) {
+        prefetch_row(weight + indices[i + kPrefetchDistance] * weight_stride, size);
+      }
+      const Half* row = weight + indices[i] * weight_stride;
+      for (int64_t k0 = 0; k0 < size; k0 += kChunkSize) {
+        int64_t chunk = std::min(kChunkSize, size - k0);
+        convert_half_to_float(row + k0, buffer, chunk);
+        int64_t k = 0;
+        for (; k + Vec::size <= chunk; k += Vec::size) {
+          (Vec::s_load(out + k0 + k) + Vec::s_load(buffer + k)).store(out + k0 + k);
+        }
+        for (; k < chunk; k++) {
+          out[k0 + k] += buffer[k];
+        }
+      }
+    }
+    if (mean && stop > start) {
+      float inv = 1.f / (stop - start);
+      for (int64_t k = 0; k < size; k++) {
+        out[k] *= inv;
+      }
+    }
+  }
+}
+
+static void embedding_bag_sum_kernel_impl(Tensor& output, const Tensor& weight,
+                                          const Tensor& indices, const Tensor& offsets,
+                                          bool mean) {
+  if (offsets.numel() == 0) {
+    return;
+  }
+  int64_t num_bags = offsets.size(0);
+  int64_t num_indices = indices.numel();
+  int64_t size = weight.size(1);
+  // every bag writes its own output row, so any split over bags is fine
+  int64_t grain_size = std::max<int64_t>(
+      1, internal::TBB_GRAIN_SIZE / std::max<int64_t>(1, size * num_indices / num_bags));
+  if (weight.type().scalarType() == kHalf) {
+    auto output_data = output.data<float>();
+    auto weight_data = weight.data<Half>();
+    auto indices_data = indices.data<int64_t>();
+    auto offsets_data = offsets.data<int64_t>();
+    int64_t weight_stride = weight.stride(0);
+    parallel_for(0, num_bags, grain_size, [&](int64_t begin, int64_t end) {
+      sum_half_bags(output_data, weight_data, weight_stride, size, indices_data, offsets_data,
+                    num_indices, mean, begin, end, num_bags);
+    });
+    return;
+  }
+  AT_DISPATCH_FLOATING_TYPES(weight.type(), "embedding_bag", [&] {
+    auto output_data = output.data<scalar_t>();
+    auto weight_data = weight.data<scalar_t>();
+    auto indices_data = indices.data<int64_t>();
+    auto offsets_data = offsets.data<int64_t>();
+    int64_t weight_stride = weight.stride(0);
+    parallel_for(0, num_bags, grain_size, [&](int64_t begin, int64_t end) {
+      sum_bags<scalar_t>(output_data, weight_data, weight_stride, size, indices_data,
+                         offsets_data, num_indices, mean, begin, end, num_bags);
+    });
+  });
+}
+
+// The quantized values of a row are dequantized and added in one pass; the
+// loops are simple enough for the compiler to vectorize them for every
+// capability this file is compiled for.
+template <int bits>
+static void sum_quantized_bags(float* output, const uint8_t* weight, int64_t row_bytes,
+                               int64_t size, const int64_t* indices, const int64_t* offsets,
+                               int64_t num_indices, bool mean, int64_t begin, int64_t end,
+                               int64_t num_bags) {
+  int64_t data_bytes = row_bytes - 2 * sizeof(float);
+  for (int64_t bag = begin; bag < end; bag++) {
+    int64_t start = offsets[bag];
+    int64_t stop = bag + 1 < num_bags ? offsets[bag + 1] : num_indices;
+    float* out = output + bag * size;
+    for (int64_t i = start; i < stop; i++) {
+      if (i + kPrefetchDistance < stop) {
+        prefetch_row(weight + indices[i + kPrefetchDistance] * row_bytes, row_bytes);
+      }
+      const uint8_t* row = weight + indices[i] * row_bytes;
+      float scale, bias;
+      std::memcpy(&scale, row + data_bytes, sizeof(float));
+      std::memcpy(&bias, row + data_bytes + sizeof(float), sizeof(float));
+      if (bits == 8) {
+        for (int64_t k = 0; k < size; k++) {
+          out[k] += scale * row[k] + bias;
+        }
+      } else {
+        int64_t k = 0;
+        for (; k + 1 < size; k += 2) {
+          uint8_t pair = row[k / 2];
+          out[k] += scale * (pair & 0xf) + bias;
+          out[k + 1] += scale * (pair >> 4) + bias;
+        }
+        if (k < size) {
+          out[k] += scale * (row[k / 2] & 0xf) + bias;
+        }
+      }
+    }
+    if (mean && stop > start) {
+      float inv = 1.f / (stop - start);
+      for (int64_t k = 0; k < size; k++) {
+        out[k] *= inv;
+      }
+    }
+  }
+}
+
+static void embedding_bag_rowwise_quantized_kernel_impl(
+    Tensor& output, const Tensor& weight, const Tensor& indices,
+    const Tensor& offsets, int64_t bits, bool mean) {
+  if (offsets.numel() == 0) {
+    return;
+  }
+  auto output_data = output.data<float>();
+  auto weight_data = weight.data<uint8_t>();
+  auto indices_data = indices.data<int64_t>();
+  auto offsets_data = offsets.data<int64_t>();
+  int64_t num_bags = offsets.size(0);
+  int64_t num_indices = indices.numel();
+  int64_t size = output.size(1);
+  int64_t row_bytes = weight.size(1);
+  int64_t grain_size = std::max<int64_t>(
+      1, internal::TBB_GRAIN_SIZE / std::max<int64_t>(1, size * num_indices / num_bags));
+  parallel_for(0, num_bags, grain_size, [&](int64_t begin, int64_t end) {
+    if (bits == 8) {
+      sum_quantized_bags<8>(output_data, weight_data, row_bytes, size, indices_data,
+                            offsets_data, num_indices, mean, begin, end, num_bags);
+    } else {
+      sum_quantized_bags<4>(output_data, weight_data, row_bytes, size, indices_data,
+                            offsets_data, num_indices, mean, begin, end, num_bags);
+    }
+  });
+}
+
+} // anonymous namespace
+
+REGISTER_DISPATCH(embedding_bag_sum_kernel, &embedding_bag_sum_kernel_impl);
+REGISTER_DISPATCH(embedding_bag_rowwise_quantized_kernel,
+                  &embedding_bag_rowwise_quantized_kernel_impl);
+
+}} // namespace at::native
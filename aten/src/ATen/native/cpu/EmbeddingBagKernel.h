@@ -0,0 +1,30 @@
+#pragma once
+
+#include <ATen/ATen.h>
+#include "CapabilityDispatch.h"
+
+namespace at { namespace native {
+
+// Adds the rows of weight selected by the indices of every bag to the
+// corresponding row of output, and divides the result by the size of the
+// bag if mean is set. Bag b is indices[offsets[b]:offsets[b + 1]] (the last
+// one ends at the end of indices). indices and offsets must be contiguous
+// and valid, weight rows must be contiguous and output must be contiguous
+// and zero-filled. For a half weight, output is float.
+using embedding_bag_fn = void(*)(Tensor& output, const Tensor& weight,
+                                 const Tensor& indices, const Tensor& offsets,
+                                 bool mean);
+
+extern DispatchStub<embedding_bag_fn> embedding_bag_sum_kernel;
+
+// As embedding_bag_sum_kernel, but weight is a uint8 table of rows quantized
+// to bits (8 or 4) bits, in the format of embedding_rowwise_quantize: the
+// quantized values of a row (two per byte for 4 bits, low nibble first)
+// followed by its float scale and bias. output has size(1) columns.
+using embedding_bag_quantized_fn = void(*)(Tensor& output, const Tensor& weight,
+                                           const Tensor& indices, const Tensor& offsets,
+                                           int64_t bits, bool mean);
+
+extern DispatchStub<embedding_bag_quantized_fn> embedding_bag_rowwise_quantized_kernel;
+
+}} // namespace at::native
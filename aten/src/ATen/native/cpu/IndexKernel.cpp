@@ -0,0 +1,88 @@
+#include "ATen/native/cpu/IndexKernel.h"
+
+#include "ATen/Dispatch.h"
+#include "ATen/Parallel.h"
+#include "ATen/cpu/vec256/vec256.h"
+
+#include <algorithm>
+#include <numeric>
+#include <vector>
+
+namespace at { namespace native {
+namespace {
+
+using namespace vec256;
+
+// Rows at least this wide are split into column blocks, one per task, each
+// adding all the source rows; narrower rows are grouped by target instead.
+constexpr int64_t kMinBlockedRowSize = 1024;
+
+template <typename scalar_t>
+static inline void add_row(scalar_t* out, const scalar_t* in, int64_t size) {
+  using Vec = Vectorized<scalar_t>;
+  int64_t j = 0;
+  for (; j + Vec::size <= size; j += Vec::size) {
+    (Vec::s_load(out + j) + Vec::s_load(in + j)).store(out + j);
+  }
+  for (; j < size; j++) {
+    out[j] += in[j];
+  }
+}
+
+static void index_add_rows_kernel_impl(Tensor& self, const Tensor& index,
+                                       const Tensor& source) {
+  int64_t num_indices = index.numel();
+  int64_t row_size = self.size(1);
+  const int64_t* index_data = index.data<int64_t>();
+  AT_DISPATCH_ALL_TYPES(self.type(), "index_add_", [&] {
+    scalar_t* self_data = self.data<scalar_t>();
+    const scalar_t* source_data = source.data<scalar_t>();
+
+    if (row_size >= kMinBlockedRowSize) {
+      int64_t block_size = std::max<int64_t>(
+          Vectorized<scalar_t>::size,
+          internal::TBB_GRAIN_SIZE / std::max<int64_t>(1, num_indices));
+      parallel_for(0, row_size, block_size, [&](int64_t begin, int64_t end) {
+        for (int64_t i = 0; i < num_indices; i++) {
+          add_row(self_data + index_data[i] * row_size + begin,
+                  source_data + i * row_size + begin, end - begin);
+        }
+      });
+      return;
+    }
+
+    // Sort the positions by target row (stably, to keep the order in which
+    // the rows of a target are added), then every run of equal targets is an
+    // independent task.
+    std::vector<int64_t> order(num_indices);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](int64_t a, int64_t b) {
+      return index_data[a] < index_data[b];
+    });
+    std::vector<int64_t> run_starts;
+    for (int64_t i = 0; i < num_indices; i++) {
+      if (i == 0 || index_data[order[i]] != index_data[order[i - 1]]) {
+        run_starts.push_back(i);
+      }
+    }
+    int64_t num_runs = run_starts.size();
+    run_starts.push_back(num_indices);
+    int64_t average_run = num_indices / std::max<int64_t>(1, num_runs);
+    int64_t grain_size = std::max<int64_t>(
+        1, internal::TBB_GRAIN_SIZE / std::max<int64_t>(1, average_run * row_size));
+    parallel_for(0, num_runs, grain_size, [&](int64_t begin, int64_t end) {
+      for (int64_t r = begin; r < end; r++) {
+        scalar_t* out = self_data + index_data[order[run_starts[r]]] * row_size;
+        for (int64_t i = run_starts[r]; i < run_starts[r + 1]; i++) {
+          add_row(out, source_data + order[i] * row_size, row_size);
+        }
+      }
+    });
+  });
+}
+
+} // anonymous namespace
+
+REGISTER_DISPATCH(index_add_rows_kernel, &index_add_rows_kernel_impl);
+
+}} // namespace at::native
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <ATen/ATen.h>
+#include "CapabilityDispatch.h"
+
+namespace at { namespace native {
+
+// self[index[i]] += source[i] for the rows of the contiguous 2-d self and
+// source, with index a contiguous Long tensor of valid row indices. The rows
+// added to a given row of self are added in the order of index, as in a
+// serial loop, so the result doesn't depend on the number of threads.
+using index_add_rows_fn = void(*)(Tensor& self, const Tensor& index, const Tensor& source);
+
+extern DispatchStub<index_add_rows_fn> index_add_rows_kernel;
+
+}} // namespace at::native
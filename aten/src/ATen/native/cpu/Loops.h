@@ -0,0 +1,99 @@
+#pragma once
+
+// Vectorized elementwise loops on top of TensorIterator.
+//
+// This header is meant to be included from kernels in native/cpu only: those
+// files are compiled once per CPU capability, so Vectorized maps to the widest
+// vectors of the instruction set of that compilation (see vec256.h).
+//
+// TensorIterator broadcasts the operands, reorders and collapses their
+// dimensions and splits the work across threads; the loops here only see runs
+// along the innermost dimension. A run is vectorized when the output is
+// contiguous along it and every input either is contiguous or has stride 0
+// (i.e. is broadcast along it); otherwise it falls back to a plain strided
+// scalar loop.
+//
+// Example:
+//   auto iter = TensorIterator::binary_op(result, a, b);
+//   binary_kernel_vec<float>(iter,
+//       [](float x, float y) { return x + y; },
+//       [](Vectorized<float> x, Vectorized<float> y) { return x + y; });
+
+#include "ATen/ATen.h"
+#include "ATen/cpu/vec256/vec256.h"
+#include "ATen/native/TensorIterator.h"
+
+namespace at { namespace native { namespace {
+
+using namespace vec256;
+
+template <typename scalar_t>
+static inline Vectorized<scalar_t> load_or_broadcast(const scalar_t* ptr, int64_t stride) {
+  return stride == 0 ? Vectorized<scalar_t>(*ptr) : Vectorized<scalar_t>::s_load(ptr);
+}
+
+// Strides in the loops below are in elements, not bytes.
+template <typename scalar_t, typename Op, typename VecOp>
+static inline void binary_row(
+    scalar_t* out, const scalar_t* a, const scalar_t* b,
+    int64_t s_out, int64_t s_a, int64_t s_b, int64_t n,
+    const Op& op, const VecOp& vop) {
+  using Vec = Vectorized<scalar_t>;
+  int64_t i = 0;
+  if (s_out == 1 && s_a <= 1 && s_b <= 1 && s_a >= 0 && s_b >= 0) {
+    for (; i + Vec::size <= n; i += Vec::size) {
+      auto va = load_or_broadcast(a + i * s_a, s_a);
+      auto vb = load_or_broadcast(b + i * s_b, s_b);
+      vop(va, vb).store(out + i);
+    }
+  }
+  for (; i < n; i++) {
+    out[i * s_out] = op(a[i * s_a], b[i * s_b]);
+  }
+}
+
+template <typename scalar_t, typename Op, typename VecOp>
+static inline void ternary_row(
+    scalar_t* out, const scalar_t* a, const scalar_t* b, const scalar_t* c,
+    int64_t s_out, int64_t s_a, int64_t s_b, int64_t s_c, int64_t n,
+    const Op& op, const VecOp& vop) {
+  using Vec = Vectorized<scalar_t>;
+  int64_t i = 0;
+  if (s_out == 1 && s_a <= 1 && s_b <= 1 && s_c <= 1 &&
+      s_a >= 0 && s_b >= 0 && s_c >= 0) {
+    for (; i + Vec::size <= n; i += Vec::size) {
+      auto va = load_or_broadcast(a + i * s_a, s_a);
+      auto vb = load_or_broadcast(b + i * s_b, s_b);
+      auto vc = load_or_broadcast(c + i * s_c, s_c);
+      vop(va, vb, vc).store(out + i);
+    }
+  }
+  for (; i < n; i++) {
+    out[i * s_out] = op(a[i * s_a], b[i * s_b], c[i * s_c]);
+  }
+}
+
+// All operands of iter must have scalar type scalar_t.
+template <typename scalar_t, typename Op, typename VecOp>
+void binary_kernel_vec(TensorIterator& iter, const Op& op, const VecOp& vop) {
+  constexpr int64_t size = sizeof(scalar_t);
+  iter.for_each([&](int ntensors, char** data, const int64_t* strides, int64_t n) {
+    binary_row(
+        (scalar_t*)data[0], (const scalar_t*)data[1], (const scalar_t*)data[2],
+        strides[0] / size, strides[1] / size, strides[2] / size, n, op, vop);
+  });
+}
+
+template <typename scalar_t, typename Op, typename VecOp>
+void ternary_kernel_vec(TensorIterator& iter, const Op& op, const VecOp& vop) {
+  constexpr int64_t size = sizeof(scalar_t);
+  iter.for_each([&](int ntensors, char** data, const int64_t* strides, int64_t n) {
+    ternary_row(
+        (scalar_t*)data[0], (const scalar_t*)data[1], (const scalar_t*)data[2],
+        (const scalar_t*)data[3],
+        strides[0] / size, strides[1] / size, strides[2] / size, strides[3] / size,
+        n, op, vop);
+  });
+}
+
+}}}  // namespace at::native::<anonymous>
@@ -0,0 +1,433 @@
+#include "ATen/native/cpu/NormalizationKernel.h"
+
+#include "ATen/Dispatch.h"
+#include "ATen/Parallel.h"
+#include "ATen/cpu/vec256/vec256.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace at { namespace native {
+namespace {
+
+using namespace vec256;
+
+// Merges the mean and sum of squared deviations (m2) of count values into
+// those of other_count other values (Chan et al.)
+template <typename scalar_t>
+static inline void welford_combine(scalar_t& mean, scalar_t& m2, int64_t& count,
+                                   scalar_t other_mean, scalar_t other_m2,
+                                   int64_t other_count) {
+  if (other_count == 0) {
+    return;
+  }
+  int64_t total = count + other_count;
+  scalar_t delta = other_mean - mean;
+  scalar_t ratio = static_cast<scalar_t>(other_count) / total;
+  mean += delta * ratio;
+  m2 += other_m2 + delta * delta * count * ratio;
+  count = total;
+}
+
+// Mean and reciprocal standard deviation of x[0:n] in a single pass (Welford),
+// with one running mean and m2 per vector lane, merged at the end
+template <typename scalar_t>
+static void moments(const scalar_t* x, int64_t n, double eps,
+                    scalar_t* mean_out, scalar_t* rstd_out) {
+  using Vec = Vectorized<scalar_t>;
+  Vec vmean(0), vm2(0);
+  int64_t lane_count = 0;
+  int64_t i = 0;
+  for (; i + Vec::size <= n; i += Vec::size) {
+    lane_count++;
+    Vec xv = Vec::s_load(x + i);
+    Vec delta = xv - vmean;
+    vmean = vmean + delta * Vec(static_cast<scalar_t>(1) / lane_count);
+    vm2 = vm2 + delta * (xv - vmean);
+  }
+  __at_align32__ scalar_t means[Vec::size];
+  __at_align32__ scalar_t m2s[Vec::size];
+  vmean.store(means);
+  vm2.store(m2s);
+  scalar_t mean = 0, m2 = 0;
+  int64_t count = 0;
+  for (int k = 0; k < Vec::size; k++) {
+    welford_combine(mean, m2, count, means[k], m2s[k], lane_count);
+  }
+  for (; i < n; i++) {
+    count++;
+    scalar_t delta = x[i] - mean;
+    mean += delta / count;
+    m2 += delta * (x[i] - mean);
+  }
+  scalar_t var = count > 0 ? std::max<scalar_t>(m2 / count, 0) : 0;
+  *mean_out = mean;
+  *rstd_out = static_cast<scalar_t>(1) / std::sqrt(var + static_cast<scalar_t>(eps));
+}
+
+template <typename scalar_t>
+static inline scalar_t horizontal_sum(const Vectorized<scalar_t>& v) {
+  __at_align32__ scalar_t values[Vectorized<scalar_t>::size];
+  v.store(values);
+  scalar_t sum = 0;
+  for (int k = 0; k < Vectorized<scalar_t>::size; k++) {
+    sum += values[k];
+  }
+  return sum;
+}
+
+// Returns sum(a[j] * b[j]) and sum(a[j]) over [0, n)
+template <typename scalar_t>
+static inline std::pair<scalar_t, scalar_t> dot_and_sum(
+    const scalar_t* a, const scalar_t* b, int64_t n) {
+  using Vec = Vectorized<scalar_t>;
+  Vec vdot(0), vsum(0);
+  int64_t j = 0;
+  for (; j + Vec::size <= n; j += Vec::size) {
+    Vec av = Vec::s_load(a + j);
+    vdot = vdot + av * Vec::s_load(b + j);
+    vsum = vsum + av;
+  }
+  scalar_t dot = horizontal_sum<scalar_t>(vdot), sum = horizontal_sum<scalar_t>(vsum);
+  for (; j < n; j++) {
+    dot += a[j] * b[j];
+    sum += a[j];
+  }
+  return {dot, sum};
+}
+
+// y[0:n] = x * a + b
+template <typename scalar_t>
+static inline void scale_shift(scalar_t* y, const scalar_t* x, int64_t n,
+                               scalar_t a, scalar_t b) {
+  using Vec = Vectorized<scalar_t>;
+  Vec va(a), vb(b);
+  int64_t j = 0;
+  for (; j + Vec::size <= n; j += Vec::size) {
+    (Vec::s_load(x + j) * va + vb).store(y + j);
+  }
+  for (; j < n; j++) {
+    y[j] = x[j] * a + b;
+  }
+}
+
+// The rows are independent, so they are split among the threads; grain sizes
+// are in rows, aiming at TBB_GRAIN_SIZE elements per task
+static inline int64_t grain_size_for(int64_t row_size) {
+  return std::max<int64_t>(1, internal::TBB_GRAIN_SIZE / std::max<int64_t>(1, row_size));
+}
+
+template <typename scalar_t>
+static void layer_norm_rows(scalar_t* Y, scalar_t* mean, scalar_t* rstd,
+                            const scalar_t* X, const scalar_t* gamma,
+                            const scalar_t* beta, int64_t N, double eps,
+                            int64_t begin, int64_t end) {
+  using Vec = Vectorized<scalar_t>;
+  for (int64_t i = begin; i < end; i++) {
+    const scalar_t* x = X + i * N;
+    scalar_t* y = Y + i * N;
+    moments(x, N, eps, mean + i, rstd + i);
+    scalar_t a = rstd[i];
+    scalar_t b = -mean[i] * rstd[i];
+    if (gamma == nullptr && beta == nullptr) {
+      scale_shift(y, x, N, a, b);
+      continue;
+    }
+    Vec va(a), vb(b);
+    int64_t j = 0;
+    for (; j + Vec::size <= N; j += Vec::size) {
+      Vec xhat = Vec::s_load(x + j) * va + vb;
+      if (gamma != nullptr) {
+        xhat = xhat * Vec::s_load(gamma + j);
+      }
+      if (beta != nullptr) {
+        xhat = xhat + Vec::s_load(beta + j);
+      }
+      xhat.store(y + j);
+    }
+    for (; j < N; j++) {
+      scalar_t xhat = x[j] * a + b;
+      y[j] = (gamma != nullptr ? xhat * gamma[j] : xhat) + (beta != nullptr ? beta[j] : 0);
+    }
+  }
+}
+
+static void layer_norm_kernel_impl(Tensor& Y, Tensor& mean, Tensor& rstd,
+                                   const Tensor& X, const Tensor& gamma,
+                                   const Tensor& beta, int64_t M, int64_t N,
+                                   double eps) {
+  AT_DISPATCH_FLOATING_TYPES(X.type(), "layer_norm", [&] {
+    auto Y_data = Y.data<scalar_t>();
+    auto mean_data = mean.data<scalar_t>();
+    auto rstd_data = rstd.data<scalar_t>();
+    auto X_data = X.data<scalar_t>();
+    auto gamma_data = gamma.defined() ? gamma.data<scalar_t>() : nullptr;
+    auto beta_data = beta.defined() ? beta.data<scalar_t>() : nullptr;
+    parallel_for(0, M, grain_size_for(N), [&](int64_t begin, int64_t end) {
+      layer_norm_rows<scalar_t>(Y_data, mean_data, rstd_data, X_data, gamma_data,
+                                beta_data, N, eps, begin, end);
+    });
+  });
+}
+
+// With g = dY * gamma, xhat = (X - mean) * rstd, and the means taken over a
+// row of n elements:
+//
+//   dX = rstd * (g - mean(g) - xhat * mean(g * xhat))
+//      = rstd * g + b * X + c
+//
+// where, with ds = sum(g * X) and db = sum(g),
+//
+//   b = (db * mean - ds) * rstd^3 / n
+//   c = -b * mean - db * rstd / n
+template <typename scalar_t>
+static inline void input_grad_coefficients(scalar_t ds, scalar_t db, scalar_t mean,
+                                           scalar_t rstd, int64_t n,
+                                           scalar_t* b, scalar_t* c) {
+  scalar_t scale = static_cast<scalar_t>(1) / n;
+  *b = (db * mean - ds) * rstd * rstd * rstd * scale;
+  *c = -*b * mean - db * rstd * scale;
+}
+
+template <typename scalar_t>
+static void layer_norm_backward_rows(scalar_t* dX, const scalar_t* dY,
+                                     const scalar_t* X, const scalar_t* mean,
+                                     const scalar_t* rstd, const scalar_t* gamma,
+                                     int64_t N, int64_t begin, int64_t end) {
+  using Vec = Vectorized<scalar_t>;
+  for (int64_t i = begin; i < end; i++) {
+    const scalar_t* dy = dY + i * N;
+    const scalar_t* x = X + i * N;
+    scalar_t* dx = dX + i * N;
+    scalar_t ds = 0, db = 0;
+    if (gamma == nullptr) {
+      std::tie(ds, db) = dot_and_sum(dy, x, N);
+    } else {
+      Vec vds(0), vdb(0);
+      int64_t j = 0;
+      for (; j + Vec::size <= N; j += Vec::size) {
+        Vec g = Vec::s_load(dy + j) * Vec::s_load(gamma + j);
+        vds = vds + g * Vec::s_load(x + j);
+        vdb = vdb + g;
+      }
+      ds = horizontal_sum<scalar_t>(vds);
+      db = horizontal_sum<scalar_t>(vdb);
+      for (; j < N; j++) {
+        ds += dy[j] * gamma[j] * x[j];
+        db += dy[j] * gamma[j];
+      }
+    }
+    scalar_t b, c;
+    input_grad_coefficients(ds, db, mean[i], rstd[i], N, &b, &c);
+    Vec va(rstd[i]), vb(b), vc(c);
+    int64_t j = 0;
+    for (; j + Vec::size <= N; j += Vec::size) {
+      Vec g = Vec::s_load(dy + j);
+      if (gamma != nullptr) {
+        g = g * Vec::s_load(gamma + j);
+      }
+      (va * g + vb * Vec::s_load(x + j) + vc).store(dx + j);
+    }
+    for (; j < N; j++) {
+      scalar_t g = gamma != nullptr ? dy[j] * gamma[j] : dy[j];
+      dx[j] = rstd[i] * g + b * x[j] + c;
+    }
+  }
+}
+
+// dgamma = sum over the rows of dY * xhat and dbeta = sum over the rows of
+// dY, for the columns [begin, end)
+template <typename scalar_t>
+static void layer_norm_backward_columns(scalar_t* dgamma, scalar_t* dbeta,
+                                        const scalar_t* dY, const scalar_t* X,
+                                        const scalar_t* mean, const scalar_t* rstd,
+                                        int64_t M, int64_t N, int64_t begin,
+                                        int64_t end) {
+  using Vec = Vectorized<scalar_t>;
+  for (int64_t j = begin; j < end; j++) {
+    if (dgamma != nullptr) dgamma[j] = 0;
+    if (dbeta != nullptr) dbeta[j] = 0;
+  }
+  for (int64_t i = 0; i < M; i++) {
+    const scalar_t* dy = dY + i * N;
+    const scalar_t* x = X + i * N;
+    Vec va(rstd[i]), vb(-mean[i] * rstd[i]);
+    int64_t j = begin;
+    for (; j + Vec::size <= end; j += Vec::size) {
+      Vec dyv = Vec::s_load(dy + j);
+      if (dgamma != nullptr) {
+        (Vec::s_load(dgamma + j) + dyv * (Vec::s_load(x + j) * va + vb)).store(dgamma + j);
+      }
+      if (dbeta != nullptr) {
+        (Vec::s_load(dbeta + j) + dyv).store(dbeta + j);
+      }
+    }
+    for (; j < end; j++) {
+      if (dgamma != nullptr) dgamma[j] += dy[j] * (x[j] - mean[i]) * rstd[i];
+      if (dbeta != nullptr) dbeta[j] += dy[j];
+    }
+  }
+}
+
+static void layer_norm_backward_kernel_impl(Tensor& dX, Tensor& dgamma, Tensor& dbeta,
+                                            const Tensor& dY, const Tensor& X,
+                                            const Tensor& mean, const Tensor& rstd,
+                                            const Tensor& gamma, int64_t M, int64_t N) {
+  AT_DISPATCH_FLOATING_TYPES(X.type(), "layer_norm_backward", [&] {
+    auto dY_data = dY.data<scalar_t>();
+    auto X_data = X.data<scalar_t>();
+    auto mean_data = mean.data<scalar_t>();
+    auto rstd_data = rstd.data<scalar_t>();
+    auto gamma_data = gamma.defined() ? gamma.data<scalar_t>() : nullptr;
+    if (dX.defined()) {
+      auto dX_data = dX.data<scalar_t>();
+      parallel_for(0, M, grain_size_for(N), [&](int64_t begin, int64_t end) {
+        layer_norm_backward_rows<scalar_t>(dX_data, dY_data, X_data, mean_data,
+                                           rstd_data, gamma_data, N, begin, end);
+      });
+    }
+    if (dgamma.defined() || dbeta.defined()) {
+      auto dgamma_data = dgamma.defined() ? dgamma.data<scalar_t>() : nullptr;
+      auto dbeta_data = dbeta.defined() ? dbeta.data<scalar_t>() : nullptr;
+      parallel_for(0, N, grain_size_for(M), [&](int64_t begin, int64_t end) {
+        layer_norm_backward_columns<scalar_t>(dgamma_data, dbeta_data, dY_data, X_data,
+                                              mean_data, rstd_data, M, N, begin, end);
+      });
+    }
+  });
+}
+
+// Every (sample, group) is a row of C / group * HxW elements, every channel a
+// contiguous run of HxW of them
+template <typename scalar_t>
+static void group_norm_rows(scalar_t* Y, scalar_t* mean, scalar_t* rstd,
+                            const scalar_t* X, const scalar_t* gamma,
+                            const scalar_t* beta, int64_t C, int64_t HxW,
+                            int64_t group, double eps, int64_t begin, int64_t end) {
+  int64_t channels = C / group;
+  int64_t D = channels * HxW;
+  for (int64_t i = begin; i < end; i++) {
+    const scalar_t* x = X + i * D;
+    scalar_t* y = Y + i * D;
+    moments(x, D, eps, mean + i, rstd + i);
+    for (int64_t k = 0; k < channels; k++) {
+      int64_t c = (i % group) * channels + k;
+      scalar_t a = gamma != nullptr ? rstd[i] * gamma[c] : rstd[i];
+      scalar_t b = (beta != nullptr ? beta[c] : 0) - mean[i] * a;
+      scale_shift(y + k * HxW, x + k * HxW, HxW, a, b);
+    }
+  }
+}
+
+static void group_norm_kernel_impl(Tensor& Y, Tensor& mean, Tensor& rstd,
+                                   const Tensor& X, const Tensor& gamma,
+                                   const Tensor& beta, int64_t N, int64_t C,
+                                   int64_t HxW, int64_t group, double eps) {
+  AT_DISPATCH_FLOATING_TYPES(X.type(), "group_norm", [&] {
+    auto Y_data = Y.data<scalar_t>();
+    auto mean_data = mean.data<scalar_t>();
+    auto rstd_data = rstd.data<scalar_t>();
+    auto X_data = X.data<scalar_t>();
+    auto gamma_data = gamma.defined() ? gamma.data<scalar_t>() : nullptr;
+    auto beta_data = beta.defined() ? beta.data<scalar_t>() : nullptr;
+    parallel_for(0, N * group, grain_size_for(C / group * HxW),
+                 [&](int64_t begin, int64_t end) {
+      group_norm_rows<scalar_t>(Y_data, mean_data, rstd_data, X_data, gamma_data,
+                                beta_data, C, HxW, group, eps, begin, end);
+    });
+  });
+}
+
+// ds and db hold, for every (sample, channel), sum(dY * X) and sum(dY) over
+// its HxW elements
+template <typename scalar_t>
+static void group_norm_backward_rows(scalar_t* dX, scalar_t* ds, scalar_t* db,
+                                     const scalar_t* dY, const scalar_t* X,
+                                     const scalar_t* mean, const scalar_t* rstd,
+                                     const scalar_t* gamma, int64_t C, int64_t HxW,
+                                     int64_t group, int64_t begin, int64_t end) {
+  int64_t channels = C / group;
+  int64_t D = channels * HxW;
+  for (int64_t i = begin; i < end; i++) {
+    // Gradients of the channels of the group, scaled by gamma
+    scalar_t ds_group = 0, db_group = 0;
+    for (int64_t k = 0; k < channels; k++) {
+      int64_t c = (i % group) * channels + k;
+      int64_t nc = i * channels + k;
+      std::tie(ds[nc], db[nc]) = dot_and_sum(dY + nc * HxW, X + nc * HxW, HxW);
+      scalar_t g = gamma != nullptr ? gamma[c] : 1;
+      ds_group += ds[nc] * g;
+      db_group += db[nc] * g;
+    }
+    if (dX == nullptr) {
+      continue;
+    }
+    scalar_t b, c0;
+    input_grad_coefficients(ds_group, db_group, mean[i], rstd[i], D, &b, &c0);
+    using Vec = Vectorized<scalar_t>;
+    Vec vb(b), vc(c0);
+    for (int64_t k = 0; k < channels; k++) {
+      int64_t c = (i % group) * channels + k;
+      int64_t nc = i * channels + k;
+      const scalar_t* dy = dY + nc * HxW;
+      const scalar_t* x = X + nc * HxW;
+      scalar_t* dx = dX + nc * HxW;
+      scalar_t a = gamma != nullptr ? rstd[i] * gamma[c] : rstd[i];
+      Vec va(a);
+      int64_t j = 0;
+      for (; j + Vec::size <= HxW; j += Vec::size) {
+        (va * Vec::s_load(dy + j) + vb * Vec::s_load(x + j) + vc).store(dx + j);
+      }
+      for (; j < HxW; j++) {
+        dx[j] = a * dy[j] + b * x[j] + c0;
+      }
+    }
+  }
+}
+
+static void group_norm_backward_kernel_impl(Tensor& dX, Tensor& dgamma, Tensor& dbeta,
+                                            const Tensor& dY, const Tensor& X,
+                                            const Tensor& mean, const Tensor& rstd,
+                                            const Tensor& gamma, int64_t N, int64_t C,
+                                            int64_t HxW, int64_t group) {
+  AT_DISPATCH_FLOATING_TYPES(X.type(), "group_norm_backward", [&] {
+    auto ds = X.type().tensor({N, C});
+    auto db = X.type().tensor({N, C});
+    auto ds_data = ds.data<scalar_t>();
+    auto db_data = db.data<scalar_t>();
+    auto dY_data = dY.data<scalar_t>();
+    auto X_data = X.data<scalar_t>();
+    auto mean_data = mean.data<scalar_t>();
+    auto rstd_data = rstd.data<scalar_t>();
+    auto gamma_data = gamma.defined() ? gamma.data<scalar_t>() : nullptr;
+    auto dX_data = dX.defined() ? dX.data<scalar_t>() : nullptr;
+    parallel_for(0, N * group, grain_size_for(C / group * HxW),
+                 [&](int64_t begin, int64_t end) {
+      group_norm_backward_rows<scalar_t>(dX_data, ds_data, db_data, dY_data, X_data,
+                                         mean_data, rstd_data, gamma_data, C, HxW,
+                                         group, begin, end);
+    });
+    // dgamma[c] = sum over the samples of (ds - db * mean) * rstd, and
+    // dbeta[c] = sum over the samples of db
+    int64_t channels = C / group;
+    for (int64_t c = 0; c < C; c++) {
+      scalar_t dg = 0, dbias = 0;
+      for (int64_t n = 0; n < N; n++) {
+        int64_t i = n * group + c / channels;
+        dg += (ds_data[n * C + c] - db_data[n * C + c] * mean_data[i]) * rstd_data[i];
+        dbias += db_data[n * C + c];
+      }
+      if (dgamma.defined()) dgamma.data<scalar_t>()[c] = dg;
+      if (dbeta.defined()) dbeta.data<scalar_t>()[c] = dbias;
+    }
+  });
+}
+
+} // anonymous namespace
+
+REGISTER_DISPATCH(layer_norm_kernel, &layer_norm_kernel_impl);
+REGISTER_DISPATCH(layer_norm_backward_kernel, &layer_norm_backward_kernel_impl);
+REGISTER_DISPATCH(group_norm_kernel, &group_norm_kernel_impl);
+REGISTER_DISPATCH(group_norm_backward_kernel, &group_norm_backward_kernel_impl);
+
+}} // namespace at::native
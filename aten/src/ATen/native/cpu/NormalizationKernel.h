@@ -0,0 +1,43 @@
+#pragma once
+
+#include <ATen/ATen.h>
+#include "CapabilityDispatch.h"
+
+namespace at { namespace native {
+
+// Normalizes the M rows of N elements of X and scales and shifts the result
+// by gamma and beta (N elements each, either may be undefined). mean and rstd
+// are filled with the mean and the reciprocal of the standard deviation of
+// every row. All tensors must be contiguous and Y, mean and rstd allocated.
+using layer_norm_fn = void(*)(Tensor& Y, Tensor& mean, Tensor& rstd,
+                              const Tensor& X, const Tensor& gamma,
+                              const Tensor& beta, int64_t M, int64_t N,
+                              double eps);
+
+// Gradients of layer_norm_kernel given the mean and rstd it computed. The
+// gradients that are undefined are not computed.
+using layer_norm_backward_fn = void(*)(Tensor& dX, Tensor& dgamma, Tensor& dbeta,
+                                       const Tensor& dY, const Tensor& X,
+                                       const Tensor& mean, const Tensor& rstd,
+                                       const Tensor& gamma, int64_t M, int64_t N);
+
+// As layer_norm_kernel, for X of shape (N, C, HxW) normalized over the
+// channels of each of the group groups of every sample; gamma and beta have
+// C elements, mean and rstd have N * group.
+using group_norm_fn = void(*)(Tensor& Y, Tensor& mean, Tensor& rstd,
+                              const Tensor& X, const Tensor& gamma,
+                              const Tensor& beta, int64_t N, int64_t C,
+                              int64_t HxW, int64_t group, double eps);
+
+using group_norm_backward_fn = void(*)(Tensor& dX, Tensor& dgamma, Tensor& dbeta,
+                                       const Tensor& dY, const Tensor& X,
+                                       const Tensor& mean, const Tensor& rstd,
+                                       const Tensor& gamma, int64_t N, int64_t C,
+                                       int64_t HxW, int64_t group);
+
+extern DispatchStub<layer_norm_fn> layer_norm_kernel;
+extern DispatchStub<layer_norm_backward_fn> layer_norm_backward_kernel;
+extern DispatchStub<group_norm_fn> group_norm_kernel;
+extern DispatchStub<group_norm_backward_fn> group_norm_backward_kernel;
+
+}} // namespace at::native
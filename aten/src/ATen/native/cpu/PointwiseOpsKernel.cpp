@@ -0,0 +1,55 @@
+#include "ATen/native/cpu/PointwiseOpsKernel.h"
+
+#include "ATen/Dispatch.h"
+#include "ATen/native/cpu/CapabilityDispatch.h"
+#include "ATen/native/cpu/Loops.h"
+
+namespace at { namespace native {
+namespace {
+
+using namespace vec256;
+
+static void lerp_kernel(TensorIterator& iter, Scalar weight) {
+  AT_DISPATCH_FLOATING_TYPES(iter.type(), "lerp", [&] {
+    scalar_t w = weight.to<scalar_t>();
+    Vectorized<scalar_t> w_vec(w);
+    binary_kernel_vec<scalar_t>(
+        iter,
+        [=](scalar_t a, scalar_t b) { return a + w * (b - a); },
+        [=](Vectorized<scalar_t> a, Vectorized<scalar_t> b) { return a + w_vec * (b - a); });
+  });
+}
+
+static void addcmul_kernel(TensorIterator& iter, Scalar value) {
+  AT_DISPATCH_FLOATING_TYPES(iter.type(), "addcmul", [&] {
+    scalar_t v = value.to<scalar_t>();
+    Vectorized<scalar_t> v_vec(v);
+    ternary_kernel_vec<scalar_t>(
+        iter,
+        [=](scalar_t a, scalar_t b, scalar_t c) { return a + v * b * c; },
+        [=](Vectorized<scalar_t> a, Vectorized<scalar_t> b, Vectorized<scalar_t> c) {
+          return a + v_vec * b * c;
+        });
+  });
+}
+
+static void addcdiv_kernel(TensorIterator& iter, Scalar value) {
+  AT_DISPATCH_FLOATING_TYPES(iter.type(), "addcdiv", [&] {
+    scalar_t v = value.to<scalar_t>();
+    Vectorized<scalar_t> v_vec(v);
+    ternary_kernel_vec<scalar_t>(
+        iter,
+        [=](scalar_t a, scalar_t b, scalar_t c) { return a + v * b / c; },
+        [=](Vectorized<scalar_t> a, Vectorized<scalar_t> b, Vectorized<scalar_t> c) {
+          return a + v_vec * b / c;
+        });
+  });
+}
+
+} // anonymous namespace
+
+REGISTER_DISPATCH(lerpImpl, &lerp_kernel);
+REGISTER_DISPATCH(addcmulImpl, &addcmul_kernel);
+REGISTER_DISPATCH(addcdivImpl, &addcdiv_kernel);
+
+}} // namespace at::native
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <ATen/ATen.h>
+#include "ATen/native/TensorIterator.h"
+#include "CapabilityDispatch.h"
+
+namespace at { namespace native {
+
+// The iterator's operands are (result, self, end) for lerp and
+// (result, self, tensor1, tensor2) for addcmul/addcdiv. The output must not
+// overlap with any of the inputs except by being equal to one.
+using pointwise_fn = void(*)(TensorIterator&, Scalar);
+
+extern DispatchStub<pointwise_fn> lerpImpl;
+extern DispatchStub<pointwise_fn> addcmulImpl;
+extern DispatchStub<pointwise_fn> addcdivImpl;
+
+}} // namespace at::native
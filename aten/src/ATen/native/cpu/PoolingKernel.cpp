@@ -0,0 +1,248 @@
+#include "ATen/native/cpu/PoolingKernel.h"
+
+#include "ATen/Dispatch.h"
+#include "ATen/Parallel.h"
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+// Every H x W plane is pooled by one task. Within a plane the kernels visit
+// the window offsets (kh, kw) in the outer loops and a row of outputs in the
+// inner loop, which reads the input at stride dW (contiguously for dW == 1)
+// and which the compiler vectorizes. The maximum is taken with selects rather
+// than branches.
+
+namespace at { namespace native {
+namespace {
+
+// Number of planes of `work` outputs per task
+static inline int64_t grain_size_for(int64_t work) {
+  return std::max<int64_t>(1, internal::TBB_GRAIN_SIZE / std::max<int64_t>(1, work));
+}
+
+// The outputs ow of [*begin, *end) whose input column ow * dW + offset is in
+// [0, iW)
+static inline void output_range(int64_t offset, int64_t dW, int64_t iW, int64_t oW,
+                                int64_t* begin, int64_t* end) {
+  *begin = offset >= 0 ? 0 : (-offset + dW - 1) / dW;
+  *end = iW - offset <= 0 ? 0 : std::min(oW, (iW - offset + dW - 1) / dW);
+}
+
+// Same as START_IND and END_IND of THNN's SpatialAdaptive*Pooling
+static inline int64_t adaptive_start(int64_t o, int64_t osize, int64_t isize) {
+  return o * isize / osize;
+}
+
+static inline int64_t adaptive_end(int64_t o, int64_t osize, int64_t isize) {
+  return ((o + 1) * isize + osize - 1) / osize;
+}
+
+// Takes value x at offset of the plane if it is greater than out or NaN,
+// like THNN
+template <typename scalar_t>
+static inline void select_max(scalar_t x, int64_t offset, scalar_t& out, int64_t& ind) {
+  bool take = (x > out) | (x != x);
+  out = take ? x : out;
+  ind = take ? offset : ind;
+}
+
+static void max_pool2d_kernel_impl(
+    Tensor& output, Tensor& indices, const Tensor& input,
+    int64_t kH, int64_t kW, int64_t dH, int64_t dW,
+    int64_t padH, int64_t padW, int64_t dilationH, int64_t dilationW) {
+  int64_t iH = input.size(-2);
+  int64_t iW = input.size(-1);
+  int64_t oH = output.size(-2);
+  int64_t oW = output.size(-1);
+  int64_t planes = input.numel() / (iH * iW);
+  AT_DISPATCH_FLOATING_TYPES(input.type(), "max_pool2d", [&] {
+    const scalar_t* input_data = input.data<scalar_t>();
+    scalar_t* output_data = output.data<scalar_t>();
+    int64_t* indices_data = indices.data<int64_t>();
+    parallel_for(0, planes, grain_size_for(oH * oW * kH * kW), [&](int64_t begin, int64_t end) {
+      for (int64_t p = begin; p < end; p++) {
+        const scalar_t* in = input_data + p * iH * iW;
+        for (int64_t oh = 0; oh < oH; oh++) {
+          int64_t hstart = oh * dH - padH;
+          int64_t hend = std::min(hstart + (kH - 1) * dilationH + 1, iH);
+          while (hstart < 0) hstart += dilationH;
+
+          scalar_t* out = output_data + (p * oH + oh) * oW;
+          int64_t* ind = indices_data + (p * oH + oh) * oW;
+          std::fill(out, out + oW, -std::numeric_limits<scalar_t>::infinity());
+          std::fill(ind, ind + oW, -1);
+          // Rows, then columns, of every window in order, so ties and NaNs
+          // pick the same element as THNN
+          for (int64_t h = hstart; h < hend; h += dilationH) {
+            const scalar_t* in_row = in + h * iW;
+            for (int64_t kw = 0; kw < kW; kw++) {
+              int64_t offset = kw * dilationW - padW;
+              int64_t ow_begin, ow_end;
+              output_range(offset, dW, iW, oW, &ow_begin, &ow_end);
+              if (dW == 1) {
+                const scalar_t* x = in_row + offset;
+                int64_t base = h * iW + offset;
+                for (int64_t ow = ow_begin; ow < ow_end; ow++) {
+                  select_max(x[ow], base + ow, out[ow], ind[ow]);
+                }
+              } else {
+                for (int64_t ow = ow_begin; ow < ow_end; ow++) {
+                  int64_t w = ow * dW + offset;
+                  select_max(in_row[w], h * iW + w, out[ow], ind[ow]);
+                }
+              }
+            }
+          }
+        }
+      }
+    });
+  });
+}
+
+static void avg_pool2d_kernel_impl(
+    Tensor& output, const Tensor& input,
+    int64_t kH, int64_t kW, int64_t dH, int64_t dW,
+    int64_t padH, int64_t padW, bool count_include_pad) {
+  int64_t iH = input.size(-2);
+  int64_t iW = input.size(-1);
+  int64_t oH = output.size(-2);
+  int64_t oW = output.size(-1);
+  int64_t planes = input.numel() / (iH * iW);
+  AT_DISPATCH_FLOATING_TYPES(input.type(), "avg_pool2d", [&] {
+    const scalar_t* input_data = input.data<scalar_t>();
+    scalar_t* output_data = output.data<scalar_t>();
+
+    // The number of columns of the window of every output, which doesn't
+    // depend on the row or plane
+    std::vector<int64_t> window_cols(oW);
+    for (int64_t ow = 0; ow < oW; ow++) {
+      int64_t wstart = ow * dW - padW;
+      int64_t wend = std::min(wstart + kW, iW + padW);
+      window_cols[ow] = count_include_pad
+          ? wend - wstart
+          : std::min(wend, iW) - std::max<int64_t>(wstart, 0);
+    }
+
+    parallel_for(0, planes, grain_size_for(oH * oW * kH * kW), [&](int64_t begin, int64_t end) {
+      for (int64_t p = begin; p < end; p++) {
+        const scalar_t* in = input_data + p * iH * iW;
+        for (int64_t oh = 0; oh < oH; oh++) {
+          int64_t hstart = oh * dH - padH;
+          int64_t hend = std::min(hstart + kH, iH + padH);
+          int64_t rows = count_include_pad
+              ? hend - hstart
+              : std::min(hend, iH) - std::max<int64_t>(hstart, 0);
+          hstart = std::max<int64_t>(hstart, 0);
+          hend = std::min(hend, iH);
+
+          scalar_t* out = output_data + (p * oH + oh) * oW;
+          std::fill(out, out + oW, scalar_t(0));
+          for (int64_t h = hstart; h < hend; h++) {
+            const scalar_t* in_row = in + h * iW;
+            for (int64_t kw = 0; kw < kW; kw++) {
+              int64_t offset = kw - padW;
+              int64_t ow_begin, ow_end;
+              output_range(offset, dW, iW, oW, &ow_begin, &ow_end);
+              for (int64_t ow = ow_begin; ow < ow_end; ow++) {
+                out[ow] += in_row[ow * dW + offset];
+              }
+            }
+          }
+          for (int64_t ow = 0; ow < oW; ow++) {
+            out[ow] /= rows * window_cols[ow];
+          }
+        }
+      }
+    });
+  });
+}
+
+static void adaptive_avg_pool2d_kernel_impl(Tensor& output, const Tensor& input) {
+  int64_t iH = input.size(-2);
+  int64_t iW = input.size(-1);
+  int64_t oH = output.size(-2);
+  int64_t oW = output.size(-1);
+  int64_t planes = input.numel() / (iH * iW);
+  AT_DISPATCH_FLOATING_TYPES(input.type(), "adaptive_avg_pool2d", [&] {
+    const scalar_t* input_data = input.data<scalar_t>();
+    scalar_t* output_data = output.data<scalar_t>();
+    parallel_for(0, planes, grain_size_for(iH * iW), [&](int64_t begin, int64_t end) {
+      // The sums of the columns of the rows of a window
+      std::vector<scalar_t> col_sums(iW);
+      for (int64_t p = begin; p < end; p++) {
+        const scalar_t* in = input_data + p * iH * iW;
+        for (int64_t oh = 0; oh < oH; oh++) {
+          int64_t hstart = adaptive_start(oh, oH, iH);
+          int64_t hend = adaptive_end(oh, oH, iH);
+          std::fill(col_sums.begin(), col_sums.end(), scalar_t(0));
+          for (int64_t h = hstart; h < hend; h++) {
+            const scalar_t* in_row = in + h * iW;
+            for (int64_t w = 0; w < iW; w++) {
+              col_sums[w] += in_row[w];
+            }
+          }
+          scalar_t* out = output_data + (p * oH + oh) * oW;
+          for (int64_t ow = 0; ow < oW; ow++) {
+            int64_t wstart = adaptive_start(ow, oW, iW);
+            int64_t wend = adaptive_end(ow, oW, iW);
+            scalar_t sum = 0;
+            for (int64_t w = wstart; w < wend; w++) {
+              sum += col_sums[w];
+            }
+            out[ow] = sum / ((hend - hstart) * (wend - wstart));
+          }
+        }
+      }
+    });
+  });
+}
+
+static void adaptive_max_pool2d_kernel_impl(Tensor& output, Tensor& indices,
+                                            const Tensor& input) {
+  int64_t iH = input.size(-2);
+  int64_t iW = input.size(-1);
+  int64_t oH = output.size(-2);
+  int64_t oW = output.size(-1);
+  int64_t planes = input.numel() / (iH * iW);
+  AT_DISPATCH_FLOATING_TYPES(input.type(), "adaptive_max_pool2d", [&] {
+    const scalar_t* input_data = input.data<scalar_t>();
+    scalar_t* output_data = output.data<scalar_t>();
+    int64_t* indices_data = indices.data<int64_t>();
+    parallel_for(0, planes, grain_size_for(iH * iW), [&](int64_t begin, int64_t end) {
+      for (int64_t p = begin; p < end; p++) {
+        const scalar_t* in = input_data + p * iH * iW;
+        for (int64_t oh = 0; oh < oH; oh++) {
+          int64_t hstart = adaptive_start(oh, oH, iH);
+          int64_t hend = adaptive_end(oh, oH, iH);
+          scalar_t* out = output_data + (p * oH + oh) * oW;
+          int64_t* ind = indices_data + (p * oH + oh) * oW;
+          // The windows differ in width, so this reduces every window on its
+          // own, in the order of THNN
+          for (int64_t ow = 0; ow < oW; ow++) {
+            int64_t wstart = adaptive_start(ow, oW, iW);
+            int64_t wend = adaptive_end(ow, oW, iW);
+            scalar_t max = -std::numeric_limits<scalar_t>::infinity();
+            int64_t max_index = -1;
+            for (int64_t h = hstart; h < hend; h++) {
+              for (int64_t w = wstart; w < wend; w++) {
+                select_max(in[h * iW + w], h * iW + w, max, max_index);
+              }
+            }
+            out[ow] = max;
+            ind[ow] = max_index;
+          }
+        }
+      }
+    });
+  });
+}
+
+} // anonymous namespace
+
+REGISTER_DISPATCH(max_pool2d_kernel, &max_pool2d_kernel_impl);
+REGISTER_DISPATCH(avg_pool2d_kernel, &avg_pool2d_kernel_impl);
+REGISTER_DISPATCH(adaptive_avg_pool2d_kernel, &adaptive_avg_pool2d_kernel_impl);
+REGISTER_DISPATCH(adaptive_max_pool2d_kernel, &adaptive_max_pool2d_kernel_impl);
+
+}} // namespace at::native
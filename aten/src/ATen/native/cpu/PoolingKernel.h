@@ -0,0 +1,34 @@
+#pragma once
+
+#include <ATen/ATen.h>
+#include "CapabilityDispatch.h"
+
+namespace at { namespace native {
+
+// Kernels for contiguous (N, C, H, W) or (C, H, W) tensors, which pool every
+// H x W plane independently. Outputs must be contiguous and of the pooled
+// size; indices hold the h * W + w offset of every maximum in its plane, like
+// those of THNN.
+
+// Max pooling, like THNN's SpatialDilatedMaxPooling
+using max_pool2d_fn = void(*)(Tensor& output, Tensor& indices, const Tensor& input,
+                              int64_t kH, int64_t kW, int64_t dH, int64_t dW,
+                              int64_t padH, int64_t padW,
+                              int64_t dilationH, int64_t dilationW);
+
+// Average pooling, with the divisors of THNN's SpatialAveragePooling
+using avg_pool2d_fn = void(*)(Tensor& output, const Tensor& input,
+                              int64_t kH, int64_t kW, int64_t dH, int64_t dW,
+                              int64_t padH, int64_t padW, bool count_include_pad);
+
+// Adaptive pooling, with the windows of THNN's SpatialAdaptive*Pooling
+using adaptive_avg_pool2d_fn = void(*)(Tensor& output, const Tensor& input);
+using adaptive_max_pool2d_fn = void(*)(Tensor& output, Tensor& indices,
+                                       const Tensor& input);
+
+extern DispatchStub<max_pool2d_fn> max_pool2d_kernel;
+extern DispatchStub<avg_pool2d_fn> avg_pool2d_kernel;
+extern DispatchStub<adaptive_avg_pool2d_fn> adaptive_avg_pool2d_kernel;
+extern DispatchStub<adaptive_max_pool2d_fn> adaptive_max_pool2d_kernel;
+
+}} // namespace at::native
@@ -0,0 +1,112 @@
+#include "ATen/native/cpu/QuantizedGemmKernel.h"
+
+#include "ATen/Parallel.h"
+#include "ATen/native/cpu/Intrinsics.h"
+
+#include <algorithm>
+
+namespace at { namespace native {
+namespace {
+
+// Rows of b whose dot products with a row of a are computed together, and
+// rows of b walked for all rows of a of a task before moving on, so that
+// they stay in cache
+constexpr int64_t kColumns = 4;
+constexpr int64_t kColumnBlock = 64;
+
+#if defined(__AVX2__)
+
+static inline int32_t hsum(__m256i v) {
+  __m128i s = _mm_add_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+  s = _mm_add_epi32(s, _mm_shuffle_epi32(s, _MM_SHUFFLE(1, 0, 3, 2)));
+  s = _mm_add_epi32(s, _mm_shuffle_epi32(s, _MM_SHUFFLE(2, 3, 0, 1)));
+  return _mm_cvtsi128_si32(s);
+}
+
+// 16 products at a time: both operands are widened to int16 and pmaddwd adds
+// pairs of products into int32. Unlike pmaddubsw, which adds the pairs in
+// saturating int16, this is exact for any int8 weight.
+static inline __m256i load_u8(const uint8_t* p) {
+  return _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));
+}
+
+static inline __m256i load_s8(const int8_t* p) {
+  return _mm256_cvtepi8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));
+}
+
+#endif
+
+// out[j] = dot(a, b + j * K) for j < kColumns
+static inline void dot_columns(const uint8_t* a, const int8_t* b, int64_t K, int32_t* out) {
+  int64_t k = 0;
+  int32_t sum[kColumns] = {0, 0, 0, 0};
+#if defined(__AVX2__)
+  __m256i acc[kColumns];
+  for (int64_t j = 0; j < kColumns; j++) {
+    acc[j] = _mm256_setzero_si256();
+  }
+  for (; k + 16 <= K; k += 16) {
+    __m256i x = load_u8(a + k);
+    for (int64_t j = 0; j < kColumns; j++) {
+      acc[j] = _mm256_add_epi32(acc[j], _mm256_madd_epi16(x, load_s8(b + j * K + k)));
+    }
+  }
+  for (int64_t j = 0; j < kColumns; j++) {
+    sum[j] = hsum(acc[j]);
+  }
+#endif
+  for (; k < K; k++) {
+    for (int64_t j = 0; j < kColumns; j++) {
+      sum[j] += static_cast<int32_t>(a[k]) * b[j * K + k];
+    }
+  }
+  std::copy(sum, sum + kColumns, out);
+}
+
+static inline int32_t dot(const uint8_t* a, const int8_t* b, int64_t K) {
+  int64_t k = 0;
+  int32_t sum = 0;
+#if defined(__AVX2__)
+  __m256i acc = _mm256_setzero_si256();
+  for (; k + 16 <= K; k += 16) {
+    acc = _mm256_add_epi32(acc, _mm256_madd_epi16(load_u8(a + k), load_s8(b + k)));
+  }
+  sum = hsum(acc);
+#endif
+  for (; k < K; k++) {
+    sum += static_cast<int32_t>(a[k]) * b[k];
+  }
+  return sum;
+}
+
+static void u8s8_gemm_kernel_impl(Tensor& c, const Tensor& a, const Tensor& b) {
+  int64_t M = a.size(0);
+  int64_t K = a.size(1);
+  int64_t N = b.size(0);
+  const uint8_t* a_data = a.data<uint8_t>();
+  const int8_t* b_data = b.data<int8_t>();
+  int32_t* c_data = c.data<int32_t>();
+  int64_t grain_size = std::max<int64_t>(1, internal::TBB_GRAIN_SIZE / std::max<int64_t>(1, N * K));
+  parallel_for(0, M, grain_size, [&](int64_t begin, int64_t end) {
+    for (int64_t n0 = 0; n0 < N; n0 += kColumnBlock) {
+      int64_t n1 = std::min(N, n0 + kColumnBlock);
+      for (int64_t m = begin; m < end; m++) {
+        const uint8_t* a_row = a_data + m * K;
+        int32_t* c_row = c_data + m * N;
+        int64_t n = n0;
+        for (; n + kColumns <= n1; n += kColumns) {
+          dot_columns(a_row, b_data + n * K, K, c_row + n);
+        }
+        for (; n < n1; n++) {
+          c_row[n] = dot(a_row, b_data + n * K, K);
+        }
+      }
+    }
+  });
+}
+
+} // anonymous namespace
+
+REGISTER_DISPATCH(u8s8_gemm_kernel, &u8s8_gemm_kernel_impl);
+
+}} // namespace at::native
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <ATen/ATen.h>
+#include "CapabilityDispatch.h"
+
+namespace at { namespace native {
+
+// c = a * b^T for a uint8 (M, K) matrix a and an int8 (N, K) matrix b,
+// accumulated exactly in int32 into the (M, N) matrix c. All tensors must be
+// contiguous and c allocated.
+using u8s8_gemm_fn = void(*)(Tensor& c, const Tensor& a, const Tensor& b);
+
+extern DispatchStub<u8s8_gemm_fn> u8s8_gemm_kernel;
+
+}} // namespace at::native
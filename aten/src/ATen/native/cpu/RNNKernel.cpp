@@ -0,0 +1,119 @@
+#include "ATen/native/cpu/RNNKernel.h"
+
+#include "ATen/Dispatch.h"
+#include "ATen/Parallel.h"
+#include "ATen/cpu/vec256/vec256.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace at { namespace native {
+namespace {
+
+using namespace vec256;
+
+template <typename scalar_t>
+static inline scalar_t sigmoid(scalar_t x) {
+  return scalar_t(1) / (scalar_t(1) + std::exp(-x));
+}
+
+template <typename scalar_t>
+static inline Vectorized<scalar_t> sigmoid(const Vectorized<scalar_t>& x) {
+  const Vectorized<scalar_t> one(1);
+  return one / (one + (Vectorized<scalar_t>(0) - x).exp());
+}
+
+// tanh(x) = 2 * sigmoid(2 * x) - 1
+template <typename scalar_t>
+static inline Vectorized<scalar_t> tanh(const Vectorized<scalar_t>& x) {
+  const Vectorized<scalar_t> two(2);
+  return two * sigmoid<scalar_t>(two * x) - Vectorized<scalar_t>(1);
+}
+
+// Rows of the batch per task
+static inline int64_t grain_size_for(int64_t row_work) {
+  return std::max<int64_t>(1, internal::TBB_GRAIN_SIZE / std::max<int64_t>(1, row_work));
+}
+
+static void lstm_cell_kernel_impl(Tensor& hy, Tensor& cy, const Tensor& igates,
+                                  const Tensor& hgates, const Tensor& cx) {
+  int64_t B = cx.size(0);
+  int64_t H = cx.size(1);
+  AT_DISPATCH_FLOATING_TYPES(cx.type(), "lstm_cell", [&] {
+    using Vec = Vectorized<scalar_t>;
+    const scalar_t* ig_data = igates.data<scalar_t>();
+    const scalar_t* hg_data = hgates.data<scalar_t>();
+    const scalar_t* cx_data = cx.data<scalar_t>();
+    scalar_t* hy_data = hy.data<scalar_t>();
+    scalar_t* cy_data = cy.data<scalar_t>();
+    parallel_for(0, B, grain_size_for(8 * H), [&](int64_t begin, int64_t end) {
+      for (int64_t b = begin; b < end; b++) {
+        const scalar_t* ig = ig_data + b * 4 * H;
+        const scalar_t* hg = hg_data + b * 4 * H;
+        const scalar_t* c = cx_data + b * H;
+        scalar_t* h_out = hy_data + b * H;
+        scalar_t* c_out = cy_data + b * H;
+        int64_t j = 0;
+        for (; j + Vec::size <= H; j += Vec::size) {
+          auto i = sigmoid<scalar_t>(Vec::s_load(ig + j) + Vec::s_load(hg + j));
+          auto f = sigmoid<scalar_t>(Vec::s_load(ig + H + j) + Vec::s_load(hg + H + j));
+          auto g = tanh<scalar_t>(Vec::s_load(ig + 2 * H + j) + Vec::s_load(hg + 2 * H + j));
+          auto o = sigmoid<scalar_t>(Vec::s_load(ig + 3 * H + j) + Vec::s_load(hg + 3 * H + j));
+          auto c_new = f * Vec::s_load(c + j) + i * g;
+          c_new.store(c_out + j);
+          (o * tanh<scalar_t>(c_new)).store(h_out + j);
+        }
+        for (; j < H; j++) {
+          scalar_t i = sigmoid(ig[j] + hg[j]);
+          scalar_t f = sigmoid(ig[H + j] + hg[H + j]);
+          scalar_t g = std::tanh(ig[2 * H + j] + hg[2 * H + j]);
+          scalar_t o = sigmoid(ig[3 * H + j] + hg[3 * H + j]);
+          scalar_t c_new = f * c[j] + i * g;
+          c_out[j] = c_new;
+          h_out[j] = o * std::tanh(c_new);
+        }
+      }
+    });
+  });
+}
+
+static void gru_cell_kernel_impl(Tensor& hy, const Tensor& igates,
+                                 const Tensor& hgates, const Tensor& hx) {
+  int64_t B = hx.size(0);
+  int64_t H = hx.size(1);
+  AT_DISPATCH_FLOATING_TYPES(hx.type(), "gru_cell", [&] {
+    using Vec = Vectorized<scalar_t>;
+    const scalar_t* ig_data = igates.data<scalar_t>();
+    const scalar_t* hg_data = hgates.data<scalar_t>();
+    const scalar_t* hx_data = hx.data<scalar_t>();
+    scalar_t* hy_data = hy.data<scalar_t>();
+    parallel_for(0, B, grain_size_for(6 * H), [&](int64_t begin, int64_t end) {
+      for (int64_t b = begin; b < end; b++) {
+        const scalar_t* ig = ig_data + b * 3 * H;
+        const scalar_t* hg = hg_data + b * 3 * H;
+        const scalar_t* h = hx_data + b * H;
+        scalar_t* h_out = hy_data + b * H;
+        int64_t j = 0;
+        for (; j + Vec::size <= H; j += Vec::size) {
+          auto r = sigmoid<scalar_t>(Vec::s_load(ig + j) + Vec::s_load(hg + j));
+          auto z = sigmoid<scalar_t>(Vec::s_load(ig + H + j) + Vec::s_load(hg + H + j));
+          auto n = tanh<scalar_t>(Vec::s_load(ig + 2 * H + j) + r * Vec::s_load(hg + 2 * H + j));
+          (n + z * (Vec::s_load(h + j) - n)).store(h_out + j);
+        }
+        for (; j < H; j++) {
+          scalar_t r = sigmoid(ig[j] + hg[j]);
+          scalar_t z = sigmoid(ig[H + j] + hg[H + j]);
+          scalar_t n = std::tanh(ig[2 * H + j] + r * hg[2 * H + j]);
+          h_out[j] = n + z * (h[j] - n);
+        }
+      }
+    });
+  });
+}
+
+} // anonymous namespace
+
+REGISTER_DISPATCH(lstm_cell_kernel, &lstm_cell_kernel_impl);
+REGISTER_DISPATCH(gru_cell_kernel, &gru_cell_kernel_impl);
+
+}} // namespace at::native
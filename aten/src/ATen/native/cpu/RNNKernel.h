@@ -0,0 +1,27 @@
+#pragma once
+
+#include <ATen/ATen.h>
+#include "CapabilityDispatch.h"
+
+namespace at { namespace native {
+
+// Pointwise parts of a timestep of the CPU RNN engine. All tensors are
+// contiguous (B, G * H) gates or (B, H) states, where igates holds the input
+// projection plus b_ih and hgates the recurrent one plus b_hh, with the
+// gates in the order of the weights of nn.LSTM and nn.GRU. The output
+// states may alias the input ones.
+
+// i, f, g, o = sigmoid, sigmoid, tanh, sigmoid of igates + hgates
+// cy = f * cx + i * g, hy = o * tanh(cy)
+using lstm_cell_fn = void(*)(Tensor& hy, Tensor& cy, const Tensor& igates,
+                             const Tensor& hgates, const Tensor& cx);
+
+// r = sigmoid(i_r + h_r), z = sigmoid(i_z + h_z), n = tanh(i_n + r * h_n)
+// hy = n + z * (hx - n)
+using gru_cell_fn = void(*)(Tensor& hy, const Tensor& igates,
+                            const Tensor& hgates, const Tensor& hx);
+
+extern DispatchStub<lstm_cell_fn> lstm_cell_kernel;
+extern DispatchStub<gru_cell_fn> gru_cell_kernel;
+
+}} // namespace at::native
@@ -0,0 +1,230 @@
+#pragma once
+
+// Vectorized reductions on top of TensorIterator::reduce_op.
+//
+// Like Loops.h, this header is meant to be included from kernels in
+// native/cpu only.
+//
+// A reduction is described by an ops struct with two member templates that
+// are called both with scalar_t and with Vectorized<scalar_t>:
+//
+//   T reduce(T acc, T a [, T b]) const;  // fold one element into acc
+//   T combine(T acc1, T acc2) const;     // merge two partial results
+//
+// The output must be filled with the identity before the kernel runs; every
+// run of elements is folded into the value already stored there.
+//
+// Runs along which the output is fixed and the inputs are contiguous (or
+// broadcast) are reduced with several vector accumulators and pairwise
+// combination of chunks of 32 vectors, which keeps the rounding error of
+// floating point sums at O(log n) instead of O(n). Runs along which the
+// output is contiguous are vectorized across output elements. Everything else
+// falls back to strided scalar loops.
+//
+// Work is split across threads along the outermost dimension that is not
+// reduced, so that no two threads write the same output element. Reductions
+// to a single value instead combine per-thread partial results.
+//
+// Example (sum):
+//   struct SumOps {
+//     template <typename T> T reduce(T acc, T a) const { return acc + a; }
+//     template <typename T> T combine(T a, T b) const { return a + b; }
+//   };
+//   result.fill_(0);
+//   auto iter = TensorIterator::reduce_op(result, self);
+//   unary_reduce_vec<float>(iter, 0.f, SumOps());
+
+#include "ATen/native/cpu/Loops.h"
+
+#include <type_traits>
+
+namespace at { namespace native { namespace {
+
+template <int N>
+using ninputs_t = std::integral_constant<int, N>;
+
+// Folds element i of the inputs into acc.
+template <typename scalar_t, typename ops_t>
+static inline scalar_t reduce_at(
+    const ops_t& ops, scalar_t acc, char* const* in, const int64_t* strides,
+    int64_t i, ninputs_t<1>) {
+  return ops.reduce(acc, *(scalar_t*)(in[0] + i * strides[0]));
+}
+
+template <typename scalar_t, typename ops_t>
+static inline scalar_t reduce_at(
+    const ops_t& ops, scalar_t acc, char* const* in, const int64_t* strides,
+    int64_t i, ninputs_t<2>) {
+  return ops.reduce(
+      acc, *(scalar_t*)(in[0] + i * strides[0]), *(scalar_t*)(in[1] + i * strides[1]));
+}
+
+// As reduce_at, but loads Vec::size elements starting at element i. Every
+// input stride must be 0 or sizeof(scalar_t).
+template <typename scalar_t, typename ops_t>
+static inline Vectorized<scalar_t> vreduce_at(
+    const ops_t& ops, Vectorized<scalar_t> acc, char* const* in,
+    const int64_t* strides, int64_t i, ninputs_t<1>) {
+  return ops.reduce(acc, load_or_broadcast((scalar_t*)(in[0] + i * strides[0]), strides[0]));
+}
+
+template <typename scalar_t, typename ops_t>
+static inline Vectorized<scalar_t> vreduce_at(
+    const ops_t& ops, Vectorized<scalar_t> acc, char* const* in,
+    const int64_t* strides, int64_t i, ninputs_t<2>) {
+  return ops.reduce(
+      acc,
+      load_or_broadcast((scalar_t*)(in[0] + i * strides[0]), strides[0]),
+      load_or_broadcast((scalar_t*)(in[1] + i * strides[1]), strides[1]));
+}
+
+// Reduces at most kChunk contiguous elements with four vector accumulators.
+template <typename scalar_t, int N, typename ops_t>
+static inline scalar_t reduce_chunk(
+    const ops_t& ops, scalar_t ident, char* const* in, const int64_t* strides,
+    int64_t n) {
+  using Vec = Vectorized<scalar_t>;
+  Vec acc[4] = {Vec(ident), Vec(ident), Vec(ident), Vec(ident)};
+  int64_t i = 0;
+  for (; i + 4 * Vec::size <= n; i += 4 * Vec::size) {
+    for (int j = 0; j != 4; j++) {
+      acc[j] = vreduce_at<scalar_t>(ops, acc[j], in, strides, i + j * Vec::size, ninputs_t<N>());
+    }
+  }
+  for (; i + Vec::size <= n; i += Vec::size) {
+    acc[0] = vreduce_at<scalar_t>(ops, acc[0], in, strides, i, ninputs_t<N>());
+  }
+  Vec total = ops.combine(ops.combine(acc[0], acc[1]), ops.combine(acc[2], acc[3]));
+  scalar_t buf[Vec::size];
+  total.store(buf);
+  scalar_t result = buf[0];
+  for (int j = 1; j != Vec::size; j++) {
+    result = ops.combine(result, buf[j]);
+  }
+  for (; i < n; i++) {
+    result = reduce_at<scalar_t>(ops, result, in, strides, i, ninputs_t<N>());
+  }
+  return result;
+}
+
+template <typename scalar_t, int N, typename ops_t>
+static scalar_t reduce_pairwise(
+    const ops_t& ops, scalar_t ident, char* const* in, const int64_t* strides,
+    int64_t n) {
+  constexpr int64_t kChunk = 32 * Vectorized<scalar_t>::size;
+  if (n <= kChunk) {
+    return reduce_chunk<scalar_t, N>(ops, ident, in, strides, n);
+  }
+  int64_t half = (n / 2) - (n / 2) % Vectorized<scalar_t>::size;
+  char* upper[N];
+  for (int k = 0; k != N; k++) {
+    upper[k] = in[k] + half * strides[k];
+  }
+  return ops.combine(
+      reduce_pairwise<scalar_t, N>(ops, ident, in, strides, half),
+      reduce_pairwise<scalar_t, N>(ops, ident, upper, strides, n - half));
+}
+
+// Folds one run of n elements into the output. data and strides hold the
+// output followed by the N inputs.
+template <typename scalar_t, int N, typename ops_t>
+static inline void reduce_run(
+    const ops_t& ops, scalar_t ident, char** data, const int64_t* strides,
+    int64_t n) {
+  using Vec = Vectorized<scalar_t>;
+  constexpr int64_t size = sizeof(scalar_t);
+  bool inputs_vectorizable = true;
+  for (int k = 1; k <= N; k++) {
+    inputs_vectorizable &= strides[k] == 0 || strides[k] == size;
+  }
+  char* const* in = data + 1;
+  const int64_t* in_strides = strides + 1;
+  scalar_t* out = (scalar_t*)data[0];
+
+  if (strides[0] == 0) {
+    if (inputs_vectorizable) {
+      *out = ops.combine(*out, reduce_pairwise<scalar_t, N>(ops, ident, in, in_strides, n));
+    } else {
+      scalar_t acc = *out;
+      for (int64_t i = 0; i < n; i++) {
+        acc = reduce_at<scalar_t>(ops, acc, in, in_strides, i, ninputs_t<N>());
+      }
+      *out = acc;
+    }
+    return;
+  }
+
+  int64_t i = 0;
+  if (strides[0] == size && inputs_vectorizable) {
+    for (; i + Vec::size <= n; i += Vec::size) {
+      auto acc = Vec::s_load(out + i);
+      vreduce_at<scalar_t>(ops, acc, in, in_strides, i, ninputs_t<N>()).store(out + i);
+    }
+  }
+  for (; i < n; i++) {
+    auto& acc = *(scalar_t*)(data[0] + i * strides[0]);
+    acc = reduce_at<scalar_t>(ops, acc, in, in_strides, i, ninputs_t<N>());
+  }
+}
+
+template <typename scalar_t, int N, typename ops_t>
+static void reduce_kernel_vec(TensorIterator& iter, scalar_t ident, const ops_t& ops) {
+  AT_ASSERT(iter.is_reduction() && iter.ntensors() == N + 1);
+  auto loop = [&](int ntensors, char** data, const int64_t* strides, int64_t n) {
+    reduce_run<scalar_t, N>(ops, ident, data, strides, n);
+  };
+  int64_t numel = iter.numel();
+  if (numel == 0) {
+    return;
+  }
+
+  if (iter.num_output_elements() == 1) {
+    // Each chunk folds into its own accumulator instead of the output.
+    scalar_t* out = iter.tensor(0).data<scalar_t>();
+    scalar_t total = parallel_reduce(
+        0, numel, internal::TBB_GRAIN_SIZE, ident,
+        [&](int64_t begin, int64_t end, scalar_t init) {
+          scalar_t acc = init;
+          iter.serial_for_each(
+              [&](int ntensors, char** data, const int64_t* strides, int64_t n) {
+                char* ptrs[N + 1];
+                ptrs[0] = (char*)&acc;
+                for (int k = 1; k <= N; k++) {
+                  ptrs[k] = data[k];
+                }
+                reduce_run<scalar_t, N>(ops, ident, ptrs, strides, n);
+              },
+              begin, end);
+          return acc;
+        },
+        [&](scalar_t a, scalar_t b) { return ops.combine(a, b); });
+    *out = ops.combine(*out, total);
+    return;
+  }
+
+  // Split along the outermost dimension in which the output moves.
+  int dim = iter.ndim() - 1;
+  while (iter.strides(0)[dim] == 0) {
+    dim--;
+  }
+  int64_t size = iter.shape()[dim];
+  int64_t grain_size = std::max<int64_t>(1, internal::TBB_GRAIN_SIZE / (numel / size));
+  parallel_for(0, size, grain_size, [&](int64_t begin, int64_t end) {
+    TensorIterator sub_iter = iter;
+    sub_iter.narrow(dim, begin, end - begin);
+    sub_iter.serial_for_each(loop, 0, sub_iter.numel());
+  });
+}
+
+template <typename scalar_t, typename ops_t>
+void unary_reduce_vec(TensorIterator& iter, scalar_t ident, const ops_t& ops) {
+  reduce_kernel_vec<scalar_t, 1>(iter, ident, ops);
+}
+
+// Reduction over two inputs; ops.reduce receives one element of each.
+template <typename scalar_t, typename ops_t>
+void binary_reduce_vec(TensorIterator& iter, scalar_t ident, const ops_t& ops) {
+  reduce_kernel_vec<scalar_t, 2>(iter, ident, ops);
+}
+
+}}}  // namespace at::native::<anonymous>
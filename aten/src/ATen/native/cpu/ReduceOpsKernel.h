@@ -1,16 +1,21 @@
 #pragma once
 
 #include <ATen/ATen.h>
-#include <ATen/optional.h>
+#include "ATen/native/TensorIterator.h"
 #include "CapabilityDispatch.h"
 
 namespace at {
 namespace native {
 
-using reduce_fn = void(*)(Tensor &, const Tensor &, at::optional<int64_t>);
+// The iterators are built with TensorIterator::reduce_op and the output must
+// be filled with the identity of the reduction (0 for sums, 1 for products).
+using reduce_fn = void(*)(TensorIterator&);
 
 extern DispatchStub<reduce_fn> sum_kernel;
 extern DispatchStub<reduce_fn> prod_kernel;
+// Operands are (result, self, mean), with mean shaped like result: folds
+// (self - mean)^2 into result.
+extern DispatchStub<reduce_fn> sum_squared_deviations_kernel;
 
 }
 }
@@ -0,0 +1,460 @@
+#include "ATen/native/cpu/SoftMaxKernel.h"
+
+#include "ATen/Dispatch.h"
+#include "ATen/Parallel.h"
+#include "ATen/cpu/vec256/vec256.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace at { namespace native {
+namespace {
+
+using namespace vec256;
+
+// The (log-)softmax is computed over the dim_size elements of every slice
+// x[o][:][k] of the input viewed as (outer_size, dim_size, inner_size). When
+// inner_size is 1 the slices are contiguous rows, which are vectorized along
+// the row; otherwise Vectorized::size adjacent slices are processed at once, one
+// per vector lane.
+
+template <typename scalar_t>
+static inline scalar_t horizontal_sum(const Vectorized<scalar_t>& v) {
+  __at_align32__ scalar_t values[Vectorized<scalar_t>::size];
+  v.store(values);
+  scalar_t sum = 0;
+  for (int k = 0; k < Vectorized<scalar_t>::size; k++) {
+    sum += values[k];
+  }
+  return sum;
+}
+
+template <typename scalar_t>
+static inline scalar_t horizontal_max(const Vectorized<scalar_t>& v) {
+  __at_align32__ scalar_t values[Vectorized<scalar_t>::size];
+  v.store(values);
+  scalar_t max = values[0];
+  for (int k = 1; k < Vectorized<scalar_t>::size; k++) {
+    max = values[k] > max ? values[k] : max;
+  }
+  return max;
+}
+
+template <typename scalar_t>
+static scalar_t row_max(const scalar_t* x, int64_t n) {
+  using Vec = Vectorized<scalar_t>;
+  scalar_t max = -std::numeric_limits<scalar_t>::infinity();
+  int64_t j = 0;
+  if (n >= Vec::size) {
+    Vec vmax = Vec::s_load(x);
+    for (j = Vec::size; j + Vec::size <= n; j += Vec::size) {
+      vmax = maximum(vmax, Vec::s_load(x + j));
+    }
+    max = horizontal_max<scalar_t>(vmax);
+  }
+  for (; j < n; j++) {
+    max = x[j] > max ? x[j] : max;
+  }
+  return max;
+}
+
+// Returns sum(exp(x - max)), also storing exp(x - max) into y unless y is null
+template <typename scalar_t>
+static scalar_t row_exp_sum(scalar_t* y, const scalar_t* x, int64_t n, scalar_t max) {
+  using Vec = Vectorized<scalar_t>;
+  Vec vmax(max), vsum(0);
+  int64_t j = 0;
+  for (; j + Vec::size <= n; j += Vec::size) {
+    Vec e = (Vec::s_load(x + j) - vmax).exp();
+    if (y != nullptr) {
+      e.store(y + j);
+    }
+    vsum = vsum + e;
+  }
+  scalar_t sum = horizontal_sum<scalar_t>(vsum);
+  for (; j < n; j++) {
+    scalar_t e = std::exp(x[j] - max);
+    if (y != nullptr) {
+      y[j] = e;
+    }
+    sum += e;
+  }
+  return sum;
+}
+
+template <typename scalar_t, bool LogSoftMax>
+static void softmax_lastdim(scalar_t* output, const scalar_t* input,
+                            int64_t dim_size, int64_t begin, int64_t end) {
+  using Vec = Vectorized<scalar_t>;
+  for (int64_t i = begin; i < end; i++) {
+    const scalar_t* x = input + i * dim_size;
+    scalar_t* y = output + i * dim_size;
+    scalar_t max = row_max(x, dim_size);
+    if (LogSoftMax) {
+      scalar_t lse = max + std::log(row_exp_sum<scalar_t>(nullptr, x, dim_size, max));
+      Vec vlse(lse);
+      int64_t j = 0;
+      for (; j + Vec::size <= dim_size; j += Vec::size) {
+        (Vec::s_load(x + j) - vlse).store(y + j);
+      }
+      for (; j < dim_size; j++) {
+        y[j] = x[j] - lse;
+      }
+    } else {
+      scalar_t scale = 1 / row_exp_sum(y, x, dim_size, max);
+      Vec vscale(scale);
+      int64_t j = 0;
+      for (; j + Vec::size <= dim_size; j += Vec::size) {
+        (Vec::s_load(y + j) * vscale).store(y + j);
+      }
+      for (; j < dim_size; j++) {
+        y[j] *= scale;
+      }
+    }
+  }
+}
+
+template <typename scalar_t, bool LogSoftMax>
+static void softmax_backward_lastdim(scalar_t* grad_input, const scalar_t* grad,
+                                     const scalar_t* output, int64_t dim_size,
+                                     int64_t begin, int64_t end) {
+  using Vec = Vectorized<scalar_t>;
+  for (int64_t i = begin; i < end; i++) {
+    const scalar_t* g = grad + i * dim_size;
+    const scalar_t* y = output + i * dim_size;
+    scalar_t* gI = grad_input + i * dim_size;
+    // log_softmax: gI = g - exp(y) * sum(g); softmax: gI = y * (g - sum(g * y))
+    Vec vsum(0);
+    int64_t j = 0;
+    for (; j + Vec::size <= dim_size; j += Vec::size) {
+      Vec gv = Vec::s_load(g + j);
+      vsum = vsum + (LogSoftMax ? gv : gv * Vec::s_load(y + j));
+    }
+    scalar_t sum = horizontal_sum<scalar_t>(vsum);
+    for (; j < dim_size; j++) {
+      sum += LogSoftMax ? g[j] : g[j] * y[j];
+    }
+    Vec vs(sum);
+    for (j = 0; j + Vec::size <= dim_size; j += Vec::size) {
+      Vec gv = Vec::s_load(g + j);
+      Vec yv = Vec::s_load(y + j);
+      (LogSoftMax ? gv - yv.exp() * vs : yv * (gv - vs)).store(gI + j);
+    }
+    for (; j < dim_size; j++) {
+      gI[j] = LogSoftMax ? g[j] - std::exp(y[j]) * sum : y[j] * (g[j] - sum);
+    }
+  }
+}
+
+// Loads and stores the first count lanes; the other lanes are zero-filled
+template <typename scalar_t>
+static inline Vectorized<scalar_t> load_lanes(const scalar_t* ptr, int64_t count) {
+  using Vec = Vectorized<scalar_t>;
+  if (count == Vec::size) {
+    return Vec::s_load(ptr);
+  }
+  __at_align32__ scalar_t values[Vec::size] = {0};
+  std::copy(ptr, ptr + count, values);
+  return Vec::s_load(values);
+}
+
+template <typename scalar_t>
+static inline void store_lanes(const Vectorized<scalar_t>& v, scalar_t* ptr, int64_t count) {
+  using Vec = Vectorized<scalar_t>;
+  if (count == Vec::size) {
+    v.store(ptr);
+    return;
+  }
+  __at_align32__ scalar_t values[Vec::size];
+  v.store(values);
+  std::copy(values, values + count, ptr);
+}
+
+// The lanes are the count slices starting at x, which are dim_size elements
+// inner_size apart
+template <typename scalar_t, bool LogSoftMax>
+static void softmax_lanes(scalar_t* y, const scalar_t* x, int64_t dim_size,
+                          int64_t inner_size, int64_t count) {
+  using Vec = Vectorized<scalar_t>;
+  Vec vmax = load_lanes(x, count);
+  for (int64_t d = 1; d < dim_size; d++) {
+    vmax = maximum(vmax, load_lanes(x + d * inner_size, count));
+  }
+  Vec vsum(0);
+  for (int64_t d = 0; d < dim_size; d++) {
+    Vec e = (load_lanes(x + d * inner_size, count) - vmax).exp();
+    if (!LogSoftMax) {
+      store_lanes(e, y + d * inner_size, count);
+    }
+    vsum = vsum + e;
+  }
+  if (LogSoftMax) {
+    Vec vlse = vmax + vsum.log();
+    for (int64_t d = 0; d < dim_size; d++) {
+      store_lanes(load_lanes(x + d * inner_size, count) - vlse, y + d * inner_size, count);
+    }
+  } else {
+    Vec vscale = Vec(1) / vsum;
+    for (int64_t d = 0; d < dim_size; d++) {
+      store_lanes(load_lanes(y + d * inner_size, count) * vscale, y + d * inner_size, count);
+    }
+  }
+}
+
+template <typename scalar_t, bool LogSoftMax>
+static void softmax_backward_lanes(scalar_t* gI, const scalar_t* g, const scalar_t* y,
+                                   int64_t dim_size, int64_t inner_size, int64_t count) {
+  using Vec = Vectorized<scalar_t>;
+  Vec vsum(0);
+  for (int64_t d = 0; d < dim_size; d++) {
+    Vec gv = load_lanes(g + d * inner_size, count);
+    vsum = vsum + (LogSoftMax ? gv : gv * load_lanes(y + d * inner_size, count));
+  }
+  for (int64_t d = 0; d < dim_size; d++) {
+    Vec gv = load_lanes(g + d * inner_size, count);
+    Vec yv = load_lanes(y + d * inner_size, count);
+    store_lanes(LogSoftMax ? gv - yv.exp() * vsum : yv * (gv - vsum),
+                gI + d * inner_size, count);
+  }
+}
+
+// Calls f(offset, count) for the groups of Vectorized::size slices (or fewer, at
+// the end of an inner extent) that make up the input, in parallel
+template <typename scalar_t, typename F>
+static void parallel_for_lanes(int64_t outer_size, int64_t dim_size,
+                               int64_t inner_size, const F& f) {
+  const int64_t lanes = Vectorized<scalar_t>::size;
+  const int64_t groups = (inner_size + lanes - 1) / lanes;
+  const int64_t grain_size = std::max<int64_t>(
+      1, internal::TBB_GRAIN_SIZE / std::max<int64_t>(1, dim_size * lanes));
+  parallel_for(0, outer_size * groups, grain_size, [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; i++) {
+      int64_t o = i / groups;
+      int64_t k = (i % groups) * lanes;
+      f(o * dim_size * inner_size + k, std::min(lanes, inner_size - k));
+    }
+  });
+}
+
+static void sizes_around(const Tensor& self, int64_t dim, int64_t* outer_size,
+                         int64_t* dim_size, int64_t* inner_size) {
+  *outer_size = 1;
+  *dim_size = self.size(dim);
+  *inner_size = 1;
+  for (int64_t i = 0; i < dim; i++) {
+    *outer_size *= self.size(i);
+  }
+  for (int64_t i = dim + 1; i < self.dim(); i++) {
+    *inner_size *= self.size(i);
+  }
+}
+
+template <bool LogSoftMax>
+static void softmax_kernel_impl(Tensor& result, const Tensor& self, int64_t dim) {
+  int64_t outer_size, dim_size, inner_size;
+  sizes_around(self, dim, &outer_size, &dim_size, &inner_size);
+  if (dim_size == 0) {
+    return;
+  }
+  AT_DISPATCH_FLOATING_TYPES(self.type(), "softmax", [&] {
+    auto output = result.data<scalar_t>();
+    auto input = self.data<scalar_t>();
+    if (inner_size == 1) {
+      int64_t grain_size = std::max<int64_t>(1, internal::TBB_GRAIN_SIZE / dim_size);
+      parallel_for(0, outer_size, grain_size, [&](int64_t begin, int64_t end) {
+        softmax_lastdim<scalar_t, LogSoftMax>(output, input, dim_size, begin, end);
+      });
+    } else {
+      parallel_for_lanes<scalar_t>(outer_size, dim_size, inner_size,
+                                   [&](int64_t offset, int64_t count) {
+        softmax_lanes<scalar_t, LogSoftMax>(output + offset, input + offset,
+                                            dim_size, inner_size, count);
+      });
+    }
+  });
+}
+
+template <bool LogSoftMax>
+static void softmax_backward_kernel_impl(Tensor& grad_input, const Tensor& grad,
+                                         const Tensor& output, int64_t dim) {
+  int64_t outer_size, dim_size, inner_size;
+  sizes_around(grad, dim, &outer_size, &dim_size, &inner_size);
+  if (dim_size == 0) {
+    return;
+  }
+  AT_DISPATCH_FLOATING_TYPES(grad.type(), "softmax_backward", [&] {
+    auto gI = grad_input.data<scalar_t>();
+    auto g = grad.data<scalar_t>();
+    auto y = output.data<scalar_t>();
+    if (inner_size == 1) {
+      int64_t grain_size = std::max<int64_t>(1, internal::TBB_GRAIN_SIZE / dim_size);
+      parallel_for(0, outer_size, grain_size, [&](int64_t begin, int64_t end) {
+        softmax_backward_lastdim<scalar_t, LogSoftMax>(gI, g, y, dim_size, begin, end);
+      });
+    } else {
+      parallel_for_lanes<scalar_t>(outer_size, dim_size, inner_size,
+                                   [&](int64_t offset, int64_t count) {
+        softmax_backward_lanes<scalar_t, LogSoftMax>(gI + offset, g + offset, y + offset,
+                                                     dim_size, inner_size, count);
+      });
+    }
+  });
+}
+
+// The rows of the scores can be far too large for the caches (for vocabularies
+// of 100k+ classes), so the forward reads each row once, kCrossEntropyChunk
+// elements at a time: the max and the sum of exponentials are computed on the
+// chunk while it is in L1, and the running sum is rescaled whenever the max
+// grows (online softmax).
+static constexpr int64_t kCrossEntropyChunk = 2048;
+
+template <typename scalar_t>
+static scalar_t row_sum(const scalar_t* x, int64_t n) {
+  using Vec = Vectorized<scalar_t>;
+  Vec vsum(0);
+  int64_t j = 0;
+  for (; j + Vec::size <= n; j += Vec::size) {
+    vsum = vsum + Vec::s_load(x + j);
+  }
+  scalar_t sum = horizontal_sum<scalar_t>(vsum);
+  for (; j < n; j++) {
+    sum += x[j];
+  }
+  return sum;
+}
+
+template <typename scalar_t>
+static void log_softmax_nll_loss_rows(scalar_t* losses, scalar_t* lse,
+                                      scalar_t* row_weights, const scalar_t* self,
+                                      const int64_t* target, const scalar_t* weight,
+                                      int64_t ignore_index, scalar_t label_smoothing,
+                                      int64_t C, int64_t begin, int64_t end) {
+  for (int64_t i = begin; i < end; i++) {
+    int64_t t = target[i];
+    if (t == ignore_index) {
+      losses[i] = lse[i] = row_weights[i] = 0;
+      continue;
+    }
+    const scalar_t* x = self + i * C;
+    scalar_t max = -std::numeric_limits<scalar_t>::infinity();
+    scalar_t sum = 0;
+    scalar_t x_sum = 0;
+    for (int64_t c = 0; c < C; c += kCrossEntropyChunk) {
+      int64_t n = std::min(kCrossEntropyChunk, C - c);
+      scalar_t chunk_max = row_max(x + c, n);
+      if (chunk_max > max) {
+        sum *= std::exp(max - chunk_max);
+        max = chunk_max;
+      }
+      sum += row_exp_sum<scalar_t>(nullptr, x + c, n, max);
+      if (label_smoothing != 0) {
+        x_sum += row_sum(x + c, n);
+      }
+    }
+    lse[i] = max + std::log(sum);
+    row_weights[i] = weight != nullptr ? weight[t] : 1;
+    scalar_t nll = lse[i] - x[t];
+    if (label_smoothing != 0) {
+      // the cross entropy with the uniform distribution, lse - mean(x)
+      nll = (1 - label_smoothing) * nll + label_smoothing * (lse[i] - x_sum / C);
+    }
+    losses[i] = nll * row_weights[i];
+  }
+}
+
+static void log_softmax_nll_loss_kernel_impl(Tensor& losses, Tensor& lse,
+                                             Tensor& row_weights, const Tensor& self,
+                                             const Tensor& target, const Tensor& weight,
+                                             int64_t ignore_index, double label_smoothing) {
+  int64_t N = self.size(0);
+  int64_t C = self.size(1);
+  AT_DISPATCH_FLOATING_TYPES(self.type(), "log_softmax_nll_loss", [&] {
+    auto losses_data = losses.data<scalar_t>();
+    auto lse_data = lse.data<scalar_t>();
+    auto row_weights_data = row_weights.data<scalar_t>();
+    auto self_data = self.data<scalar_t>();
+    auto target_data = target.data<int64_t>();
+    auto weight_data = weight.defined() ? weight.data<scalar_t>() : nullptr;
+    int64_t grain_size = std::max<int64_t>(1, internal::TBB_GRAIN_SIZE / std::max<int64_t>(1, C));
+    parallel_for(0, N, grain_size, [&](int64_t begin, int64_t end) {
+      log_softmax_nll_loss_rows<scalar_t>(losses_data, lse_data, row_weights_data,
+                                          self_data, target_data, weight_data,
+                                          ignore_index, label_smoothing, C, begin, end);
+    });
+  });
+}
+
+// grad_input[i] = (softmax(self[i]) - (1 - eps) * onehot(target[i]) - eps / C)
+//                 * weight[target[i]] * grad_losses[i]
+template <typename scalar_t>
+static void log_softmax_nll_loss_backward_rows(scalar_t* grad_input,
+                                               const scalar_t* grad_losses,
+                                               const scalar_t* self,
+                                               const int64_t* target,
+                                               const scalar_t* weight,
+                                               const scalar_t* lse,
+                                               int64_t ignore_index,
+                                               scalar_t label_smoothing, int64_t C,
+                                               int64_t begin, int64_t end) {
+  using Vec = Vectorized<scalar_t>;
+  for (int64_t i = begin; i < end; i++) {
+    int64_t t = target[i];
+    scalar_t* gI = grad_input + i * C;
+    if (t == ignore_index) {
+      std::fill(gI, gI + C, scalar_t(0));
+      continue;
+    }
+    const scalar_t* x = self + i * C;
+    scalar_t scale = grad_losses[i] * (weight != nullptr ? weight[t] : 1);
+    scalar_t uniform = label_smoothing / C * scale;
+    Vec vlse(lse[i]), vscale(scale), vuniform(uniform);
+    int64_t j = 0;
+    for (; j + Vec::size <= C; j += Vec::size) {
+      ((Vec::s_load(x + j) - vlse).exp() * vscale - vuniform).store(gI + j);
+    }
+    for (; j < C; j++) {
+      gI[j] = std::exp(x[j] - lse[i]) * scale - uniform;
+    }
+    gI[t] -= (1 - label_smoothing) * scale;
+  }
+}
+
+static void log_softmax_nll_loss_backward_kernel_impl(Tensor& grad_input,
+                                                      const Tensor& grad_losses,
+                                                      const Tensor& self,
+                                                      const Tensor& target,
+                                                      const Tensor& weight,
+                                                      const Tensor& lse,
+                                                      int64_t ignore_index,
+                                                      double label_smoothing) {
+  int64_t N = self.size(0);
+  int64_t C = self.size(1);
+  AT_DISPATCH_FLOATING_TYPES(self.type(), "log_softmax_nll_loss_backward", [&] {
+    auto grad_input_data = grad_input.data<scalar_t>();
+    auto grad_losses_data = grad_losses.data<scalar_t>();
+    auto self_data = self.data<scalar_t>();
+    auto target_data = target.data<int64_t>();
+    auto weight_data = weight.defined() ? weight.data<scalar_t>() : nullptr;
+    auto lse_data = lse.data<scalar_t>();
+    int64_t grain_size = std::max<int64_t>(1, internal::TBB_GRAIN_SIZE / std::max<int64_t>(1, C));
+    parallel_for(0, N, grain_size, [&](int64_t begin, int64_t end) {
+      log_softmax_nll_loss_backward_rows<scalar_t>(grad_input_data, grad_losses_data,
+                                                   self_data, target_data, weight_data,
+                                                   lse_data, ignore_index, label_smoothing,
+                                                   C, begin, end);
+    });
+  });
+}
+
+} // anonymous namespace
+
+REGISTER_DISPATCH(softmax_kernel, &softmax_kernel_impl<false>);
+REGISTER_DISPATCH(log_softmax_kernel, &softmax_kernel_impl<true>);
+REGISTER_DISPATCH(softmax_backward_kernel, &softmax_backward_kernel_impl<false>);
+REGISTER_DISPATCH(log_softmax_backward_kernel, &softmax_backward_kernel_impl<true>);
+REGISTER_DISPATCH(log_softmax_nll_loss_kernel, &log_softmax_nll_loss_kernel_impl);
+REGISTER_DISPATCH(log_softmax_nll_loss_backward_kernel,
+                  &log_softmax_nll_loss_backward_kernel_impl);
+
+}} // namespace at::native
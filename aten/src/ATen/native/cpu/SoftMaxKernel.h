@@ -0,0 +1,50 @@
+#pragma once
+
+#include <ATen/ATen.h>
+#include "CapabilityDispatch.h"
+
+namespace at { namespace native {
+
+// (Log-)softmax of self over dimension dim into result, which is allocated
+// like self. self must be contiguous and at least 1-dimensional.
+using softmax_fn = void(*)(Tensor& result, const Tensor& self, int64_t dim);
+
+// Gradient of the (log-)softmax given the gradient and the output of the
+// forward, both contiguous.
+using softmax_backward_fn = void(*)(Tensor& grad_input, const Tensor& grad,
+                                    const Tensor& output, int64_t dim);
+
+extern DispatchStub<softmax_fn> softmax_kernel;
+extern DispatchStub<softmax_fn> log_softmax_kernel;
+extern DispatchStub<softmax_backward_fn> softmax_backward_kernel;
+extern DispatchStub<softmax_backward_fn> log_softmax_backward_kernel;
+
+// For the (N, C) scores self and the N class targets, without materializing
+// log_softmax(self): fills lse with the logsumexp of every row, losses with
+// the cross entropy of every row and row_weights with weight[target[i]]
+// (weight may be undefined, i.e. all ones). With label smoothing eps, the
+// target distribution of row i is (1 - eps) * onehot(target[i]) + eps / C,
+// so the loss of the row is
+//   (lse[i] - (1 - eps) * self[i][target[i]] - eps / C * sum_j self[i][j]) * weight[target[i]]
+// All three are 0 for the rows whose target is ignore_index. All tensors must
+// be contiguous; losses, lse and row_weights have N elements.
+using log_softmax_nll_loss_fn = void(*)(Tensor& losses, Tensor& lse,
+                                        Tensor& row_weights, const Tensor& self,
+                                        const Tensor& target, const Tensor& weight,
+                                        int64_t ignore_index, double label_smoothing);
+
+// Gradient of self given the gradient of the loss of every row (N elements)
+// and the lse computed by the forward.
+using log_softmax_nll_loss_backward_fn = void(*)(Tensor& grad_input,
+                                                 const Tensor& grad_losses,
+                                                 const Tensor& self,
+                                                 const Tensor& target,
+                                                 const Tensor& weight,
+                                                 const Tensor& lse,
+                                                 int64_t ignore_index,
+                                                 double label_smoothing);
+
+extern DispatchStub<log_softmax_nll_loss_fn> log_softmax_nll_loss_kernel;
+extern DispatchStub<log_softmax_nll_loss_backward_fn> log_softmax_nll_loss_backward_kernel;
+
+}} // namespace at::native
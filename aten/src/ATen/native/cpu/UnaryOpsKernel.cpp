@@ -15,7 +15,7 @@ using namespace vec256;
 template <typename scalar_t, typename F>
 static void
 unary_kernel(scalar_t* arr_out, const scalar_t* arr_in, int64_t size, F func) {
-  using Vec = Vec256<scalar_t>;
+  using Vec = Vectorized<scalar_t>;
   int64_t size_rounded = size - (size % Vec::size);
   int64_t k = 0;
   for (; k != size_rounded; k += Vec::size) {
@@ -32,24 +32,12 @@ unary_kernel(scalar_t* arr_out, const scalar_t* arr_in, int64_t size, F func) {
 
 template <class scalar_t, class F>
 static void parallel_apply(Tensor& result, const Tensor& self, F f) {
-  internal::init_tbb_num_threads();
-
-  static tbb::affinity_partitioner ap;
-
   auto arr_out = result.data<scalar_t>();
   auto arr_in = self.data<scalar_t>();
   int64_t size = self.numel();
-  if (size < internal::TBB_GRAIN_SIZE) {
-    unary_kernel(arr_out, arr_in, size, f);
-  } else {
-    tbb::parallel_for(
-        tbb::blocked_range<int64_t>(0, size, internal::TBB_GRAIN_SIZE),
-        [&](const tbb::blocked_range<int64_t>& r) {
-          auto size = r.end() - r.begin();
-          unary_kernel(arr_out + r.begin(), arr_in + r.begin(), size, f);
-        },
-        ap);
-  }
+  parallel_for(0, size, internal::TBB_GRAIN_SIZE, [&](int64_t begin, int64_t end) {
+    unary_kernel(arr_out + begin, arr_in + begin, end - begin, f);
+  });
 }
 
 static void abs_kernel(Tensor& result, const Tensor& self) {
@@ -57,7 +45,7 @@ static void abs_kernel(Tensor& result, const Tensor& self) {
     parallel_apply<scalar_t>(
         result,
         self,
-        [](const Vec256<scalar_t>& x) { return x.abs(); });  });
+        [](const Vectorized<scalar_t>& x) { return x.abs(); });  });
 }
 
 static void rsqrt_kernel(Tensor& result, const Tensor& self) {
@@ -65,14 +53,14 @@ static void rsqrt_kernel(Tensor& result, const Tensor& self) {
     parallel_apply<scalar_t>(
         result,
         self,
-        [](const Vec256<scalar_t>& x) { return Vec256<scalar_t>((scalar_t)(1)) / x.sqrt(); });  });
+        [](const Vectorized<scalar_t>& x) { return Vectorized<scalar_t>((scalar_t)(1)) / x.sqrt(); });  });
 }
 
 #define IMPLEMENT_FLOAT_KERNEL(op)                                             \
   static void op##_kernel(Tensor& result, const Tensor& self) {                \
     AT_DISPATCH_FLOATING_TYPES(self.type(), #op, [&] {                         \
       parallel_apply<scalar_t>(                                                \
-          result, self, [](const Vec256<scalar_t>& x) { return x.op(); }); \
+          result, self, [](const Vectorized<scalar_t>& x) { return x.op(); }); \
     });                                                                        \
   }                                                                            \
   REGISTER_DISPATCH(op##Impl, &op##_kernel)
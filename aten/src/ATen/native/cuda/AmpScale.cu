@@ -0,0 +1,57 @@
+#include "ATen/ATen.h"
+#include "ATen/AccumulateType.h"
+#include "ATen/Dispatch.h"
+#include "ATen/NativeFunctions.h"
+#include "ATen/cuda/CUDATypeConversion.cuh"
+#include "ATen/native/AmpScale.h"
+#include "ATen/native/cuda/MultiTensorApply.cuh"
+
+#include <THC/THCNumerics.cuh>
+#include <THCUNN/THCHalfAutoNumerics.cuh>
+
+#include <vector>
+
+// CUDA counterparts of AmpScale.cpp. The gradients are unscaled through
+// multi_tensor_apply, and the scale is updated by a single thread, so that
+// neither synchronizes with the host.
+
+namespace at { namespace native {
+
+namespace {
+
+__global__ void amp_update_scale_kernel(
+    int* growth_tracker, float* scale, const float* found_inf,
+    float growth_factor, float backoff_factor, int64_t growth_interval) {
+  amp_update_scale(growth_tracker, scale, found_inf, growth_factor, backoff_factor, growth_interval);
+}
+
+} // anonymous namespace
+
+std::vector<Tensor> _amp_unscale_cuda(TensorList grads, const Tensor& found_inf,
+                                      const Tensor& inv_scale) {
+  check_amp_unscale_tensors(grads, found_inf, inv_scale);
+  if (grads.size() == 0) {
+    return {};
+  }
+  AT_DISPATCH_FLOATING_TYPES_AND_HALF(grads[0].type(), "_amp_unscale", [&] {
+    using cuda_scalar_t = cuda::type<scalar_t>;
+    using accscalar_t = acc_type<cuda_scalar_t, true>;
+    AmpUnscale<accscalar_t> op{found_inf.data<float>(), inv_scale.data<float>()};
+    multi_tensor_apply<cuda_scalar_t, accscalar_t, 2>({grads, grads}, op);
+  });
+  return grads.vec();
+}
+
+Tensor _amp_update_scale_cuda(const Tensor& growth_tracker, const Tensor& current_scale,
+                              const Tensor& found_inf, double growth_factor,
+                              double backoff_factor, int64_t growth_interval) {
+  check_amp_update_scale_tensors(growth_tracker, current_scale, found_inf);
+  auto new_scale = current_scale.clone();
+  amp_update_scale_kernel<<<1, 1, 0, globalContext().getCurrentCUDAStream()>>>(
+      growth_tracker.data<int>(), new_scale.data<float>(), found_inf.data<float>(),
+      static_cast<float>(growth_factor), static_cast<float>(backoff_factor), growth_interval);
+  THCudaCheck(cudaGetLastError());
+  return new_scale;
+}
+
+}} // namespace at::native
@@ -0,0 +1,193 @@
+#include "ATen/ATen.h"
+#include "ATen/Dispatch.h"
+#include "ATen/NativeFunctions.h"
+
+#include "ATen/native/LinearAlgebraUtils.h"
+#include "ATen/native/SmallMatrixOps.h"
+
+#include "THC.h"
+
+#include <vector>
+
+// Batched inverse and potrf on the GPU, see native/BatchLinearAlgebra.cpp.
+// Small matrices get one thread each running the kernels of
+// SmallMatrixOps.h; larger inverses go through cuBLAS' batched getrf and
+// getri, and larger potrfs through the single matrix function per matrix.
+
+namespace at {
+namespace native {
+
+namespace {
+
+constexpr int kSmallMatrixThreads = 128;
+
+template <typename scalar_t, int N>
+__global__ void small_inverse_kernel(const scalar_t* input, scalar_t* result, int* infos,
+                                     int64_t batch_size) {
+  int64_t i = blockIdx.x * static_cast<int64_t>(blockDim.x) + threadIdx.x;
+  if (i < batch_size) {
+    infos[i] = small_inverse<scalar_t, N>(input + i * N * N, result + i * N * N);
+  }
+}
+
+template <typename scalar_t, int N>
+__global__ void small_potrf_kernel(const scalar_t* input, scalar_t* result, int* infos,
+                                   int64_t batch_size, bool upper) {
+  int64_t i = blockIdx.x * static_cast<int64_t>(blockDim.x) + threadIdx.x;
+  if (i < batch_size) {
+    infos[i] = small_potrf<scalar_t, N>(input + i * N * N, result + i * N * N, upper);
+  }
+}
+
+inline dim3 small_matrix_grid(int64_t batch_size) {
+  return dim3((batch_size + kSmallMatrixThreads - 1) / kSmallMatrixThreads);
+}
+
+std::vector<int64_t> copyInfos(const Tensor& infos) {
+  auto infos_cpu = infos.toBackend(kCPU).toType(kLong);
+  const int64_t* data = infos_cpu.data<int64_t>();
+  return std::vector<int64_t>(data, data + infos_cpu.numel());
+}
+
+// Device array of the addresses of the matrices of a contiguous batch
+template <typename scalar_t>
+Tensor matrixPointers(const Tensor& batch) {
+  int64_t batch_size = batchCount(batch);
+  auto pointers = batch.type().toBackend(kCPU).toScalarType(kLong).tensor({batch_size});
+  int64_t* pointers_data = pointers.data<int64_t>();
+  scalar_t* batch_data = batch.data<scalar_t>();
+  for (int64_t i = 0; i < batch_size; i++) {
+    pointers_data[i] = reinterpret_cast<int64_t>(batch_data + i * matrixStride(batch));
+  }
+  return pointers.toBackend(kCUDA);
+}
+
+template <typename scalar_t>
+void cublasGetrfBatched(THCState* state, int n, scalar_t** a, int* pivots, int* infos,
+                        int batch_size) {
+  AT_ERROR("inverse only takes float or double Tensors");
+}
+
+template <>
+void cublasGetrfBatched<float>(THCState* state, int n, float** a, int* pivots, int* infos,
+                               int batch_size) {
+  THCudaBlas_Sgetrf(state, n, a, n, pivots, infos, batch_size);
+}
+
+template <>
+void cublasGetrfBatched<double>(THCState* state, int n, double** a, int* pivots, int* infos,
+                                int batch_size) {
+  THCudaBlas_Dgetrf(state, n, a, n, pivots, infos, batch_size);
+}
+
+template <typename scalar_t>
+void cublasGetriBatched(THCState* state, int n, scalar_t** a, int* pivots, scalar_t** c,
+                        int* infos, int batch_size) {
+  AT_ERROR("inverse only takes float or double Tensors");
+}
+
+template <>
+void cublasGetriBatched<float>(THCState* state, int n, float** a, int* pivots, float** c,
+                               int* infos, int batch_size) {
+  THCudaBlas_Sgetri(state, n, const_cast<const float**>(a), n, pivots, c, n, infos, batch_size);
+}
+
+template <>
+void cublasGetriBatched<double>(THCState* state, int n, double** a, int* pivots, double** c,
+                                int* infos, int batch_size) {
+  THCudaBlas_Dgetri(state, n, const_cast<const double**>(a), n, pivots, c, n, infos, batch_size);
+}
+
+// The matrices are row-major, which cuBLAS sees as their transposes; since
+// inverse(A^T) = inverse(A)^T that gives the row-major inverses directly.
+template <typename scalar_t>
+void applyInverseBatched(Tensor& result, const Tensor& input, std::vector<int64_t>& infos) {
+  auto state = input.type().get_context().getTHCState();
+  int64_t batch_size = batchCount(input);
+  int n = static_cast<int>(input.size(-1));
+  auto lu = input.clone();
+  auto pivots = input.type().toScalarType(kInt).tensor({batch_size, n});
+  auto infos_gpu = input.type().toScalarType(kInt).zeros({batch_size});
+  auto lu_pointers = matrixPointers<scalar_t>(lu);
+  auto result_pointers = matrixPointers<scalar_t>(result);
+  auto lu_array = reinterpret_cast<scalar_t**>(lu_pointers.data<int64_t>());
+  auto result_array = reinterpret_cast<scalar_t**>(result_pointers.data<int64_t>());
+
+  cublasGetrfBatched<scalar_t>(state, n, lu_array, pivots.data<int>(), infos_gpu.data<int>(),
+                               static_cast<int>(batch_size));
+  infos = copyInfos(infos_gpu);
+  for (auto info : infos) {
+    if (info != 0) {
+      return;
+    }
+  }
+  cublasGetriBatched<scalar_t>(state, n, lu_array, pivots.data<int>(), result_array,
+                               infos_gpu.data<int>(), static_cast<int>(batch_size));
+  infos = copyInfos(infos_gpu);
+}
+
+} // namespace
+
+Tensor _inverse_helper_cuda(const Tensor& self) {
+  auto input = self.contiguous();
+  auto result = input.type().tensor(input.sizes());
+  int64_t batch_size = batchCount(input);
+  if (batch_size == 0) {
+    return result;
+  }
+  int64_t n = input.size(-1);
+  std::vector<int64_t> infos;
+  AT_DISPATCH_FLOATING_TYPES(input.type(), "inverse", [&] {
+    if (!use_small_matrix_kernels(input)) {
+      applyInverseBatched<scalar_t>(result, input, infos);
+      return;
+    }
+    auto infos_gpu = input.type().toScalarType(kInt).tensor({batch_size});
+    auto stream = input.type().get_context().getCurrentCUDAStream();
+    AT_DISPATCH_SMALL_MATRIX_SIZE(n, "inverse", [&] {
+      small_inverse_kernel<scalar_t, N>
+          <<<small_matrix_grid(batch_size), kSmallMatrixThreads, 0, stream>>>(
+              input.data<scalar_t>(), result.data<scalar_t>(), infos_gpu.data<int>(),
+              batch_size);
+    });
+    THCudaCheck(cudaGetLastError());
+    infos = copyInfos(infos_gpu);
+  });
+  checkInverseErrors(infos);
+  return result;
+}
+
+Tensor _potrf_helper_cuda(const Tensor& self, bool upper) {
+  auto input = self.contiguous();
+  auto result = input.type().tensor(input.sizes());
+  int64_t batch_size = batchCount(input);
+  if (batch_size == 0) {
+    return result;
+  }
+  int64_t n = input.size(-1);
+  if (!use_small_matrix_kernels(input)) {
+    auto input_3d = input.view({batch_size, n, n});
+    auto result_3d = result.view({batch_size, n, n});
+    for (int64_t i = 0; i < batch_size; i++) {
+      auto result_i = result_3d[i];
+      at::_potrf_single_out(result_i, input_3d[i], upper);
+    }
+    return result;
+  }
+
+  auto infos_gpu = input.type().toScalarType(kInt).tensor({batch_size});
+  AT_DISPATCH_FLOATING_TYPES(input.type(), "potrf", [&] {
+    auto stream = input.type().get_context().getCurrentCUDAStream();
+    AT_DISPATCH_SMALL_MATRIX_SIZE(n, "potrf", [&] {
+      small_potrf_kernel<scalar_t, N>
+          <<<small_matrix_grid(batch_size), kSmallMatrixThreads, 0, stream>>>(
+              input.data<scalar_t>(), result.data<scalar_t>(), infos_gpu.data<int>(),
+              batch_size, upper);
+    });
+  });
+  THCudaCheck(cudaGetLastError());
+  checkPotrfErrors(copyInfos(infos_gpu));
+  return result;
+}
+
+}}  // namespace at::native
@@ -0,0 +1,11 @@
+#include "ATen/ATen.h"
+
+namespace at { namespace native {
+
+// These are just forwarding stubs
+
+Tensor& _index_add__cuda(Tensor& self, int64_t dim, const Tensor& index, const Tensor& source) {
+  return self._th_index_add_(dim, index, source);
+}
+
+}}
@@ -16,5 +16,9 @@ Tensor &_prod_out_cuda(Tensor &result, const Tensor &self, int64_t dim,
   return at::_th_prod_out(result, self, dim, keepdim);
 }
 
+Tensor &_mean_out_cuda(Tensor &result, const Tensor &self, int64_t dim,
+                       bool keepdim) {
+  return at::_th_mean_out(result, self, dim, keepdim);
+}
 
 }}
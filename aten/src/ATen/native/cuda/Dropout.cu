@@ -0,0 +1,138 @@
+#include "ATen/ATen.h"
+#include "ATen/AccumulateType.h"
+#include "ATen/Dispatch.h"
+#include "ATen/NativeFunctions.h"
+#include "ATen/cuda/CUDATensorMethods.cuh"
+#include "ATen/cuda/CUDATypeConversion.cuh"
+
+#include <THC/THCGeneral.h>
+#include <THC/THCGenerator.hpp>
+#include <THC/THCNumerics.cuh>
+#include <THCUNN/THCHalfAutoNumerics.cuh>
+
+#include <curand_kernel.h>
+
+#include <algorithm>
+#include <tuple>
+
+// CUDA counterpart of Dropout.cpp, with the same bit-packed mask. Thread j
+// computes byte j of the mask from the Philox subsequence j of the seed and
+// offset of the generator.
+
+THCGenerator* THCRandom_getGenerator(THCState* state);
+
+namespace at { namespace native {
+
+namespace {
+
+const int DROPOUT_THREADS = 256;
+
+std::pair<uint64_t, uint64_t> next_philox_seed(uint64_t increment) {
+  auto gen_ = THCRandom_getGenerator(globalContext().getTHCState());
+  uint64_t offset = gen_->state.philox_seed_offset.fetch_add(increment);
+  return std::make_pair(gen_->state.initial_seed, offset);
+}
+
+double dropout_scale(double p) {
+  return p < 1 ? 1. / (1. - p) : 0.;
+}
+
+dim3 dropout_grid(int64_t mask_numel) {
+  int64_t blocks = (mask_numel + DROPOUT_THREADS - 1) / DROPOUT_THREADS;
+  return dim3(static_cast<unsigned>(std::min<int64_t>(std::max<int64_t>(blocks, 1), 65535)));
+}
+
+template <typename scalar_t, typename accscalar_t>
+__global__ void fused_dropout_kernel(
+    const scalar_t* input, scalar_t* output, uint8_t* mask, int64_t numel,
+    accscalar_t keep_prob, accscalar_t scale, std::pair<uint64_t, uint64_t> seeds) {
+  int64_t mask_numel = (numel + 7) / 8;
+  for (int64_t j = blockIdx.x * blockDim.x + threadIdx.x; j < mask_numel;
+       j += blockDim.x * gridDim.x) {
+    curandStatePhilox4_32_10_t state;
+    curand_init(seeds.first, j, seeds.second, &state);
+    float4 r[2] = {curand_uniform4(&state), curand_uniform4(&state)};
+    const float* u = reinterpret_cast<const float*>(r);
+    uint8_t bits = 0;
+    for (int64_t k = 0, i = 8 * j; k < 8 && i < numel; k++, i++) {
+      // curand_uniform is in (0, 1]
+      bool keep = u[k] <= keep_prob;
+      bits |= static_cast<uint8_t>(keep) << k;
+      output[i] = keep ? scalar_cast<scalar_t>(scalar_cast<accscalar_t>(input[i]) * scale)
+                       : scalar_cast<scalar_t>(0);
+    }
+    mask[j] = bits;
+  }
+}
+
+template <typename scalar_t, typename accscalar_t>
+__global__ void fused_dropout_backward_kernel(
+    const scalar_t* grad_output, scalar_t* grad_input, const uint8_t* mask, int64_t numel,
+    accscalar_t scale) {
+  int64_t mask_numel = (numel + 7) / 8;
+  for (int64_t j = blockIdx.x * blockDim.x + threadIdx.x; j < mask_numel;
+       j += blockDim.x * gridDim.x) {
+    uint8_t bits = mask[j];
+    for (int64_t k = 0, i = 8 * j; k < 8 && i < numel; k++, i++) {
+      grad_input[i] = ((bits >> k) & 1)
+          ? scalar_cast<scalar_t>(scalar_cast<accscalar_t>(grad_output[i]) * scale)
+          : scalar_cast<scalar_t>(0);
+    }
+  }
+}
+
+} // namespace
+
+std::tuple<Tensor, Tensor> _fused_dropout_cuda(const Tensor& self, double p, Generator* gen) {
+  AT_CHECK(p >= 0 && p <= 1, "dropout probability has to be between 0 and 1, but got ", p);
+  auto input = self.contiguous();
+  auto output = input.type().tensor(input.sizes());
+  int64_t numel = input.numel();
+  auto mask = input.type().toScalarType(kByte).tensor({(numel + 7) / 8});
+  if (numel == 0) {
+    return std::make_tuple(output, mask);
+  }
+
+  cudaStream_t stream = globalContext().getCurrentCUDAStream();
+  dim3 grid = dropout_grid(mask.numel());
+  dim3 block(DROPOUT_THREADS);
+  // Every thread draws 8 numbers of its subsequence
+  auto seeds = next_philox_seed(8);
+  AT_DISPATCH_FLOATING_TYPES_AND_HALF(input.type(), "_fused_dropout", [&] {
+    using cuda_scalar_t = cuda::type<scalar_t>;
+    using accscalar_t = acc_type<cuda_scalar_t, true>;
+    fused_dropout_kernel<cuda_scalar_t, accscalar_t><<<grid, block, 0, stream>>>(
+        input.data<cuda_scalar_t>(), output.data<cuda_scalar_t>(), mask.data<uint8_t>(), numel,
+        scalar_cast<accscalar_t>(1. - p), scalar_cast<accscalar_t>(dropout_scale(p)), seeds);
+  });
+  THCudaCheck(cudaGetLastError());
+  return std::make_tuple(output, mask);
+}
+
+Tensor _fused_dropout_backward_cuda(const Tensor& grad_output_r, const Tensor& mask, double p) {
+  auto grad_output = grad_output_r.contiguous();
+  int64_t numel = grad_output.numel();
+  AT_CHECK(mask.type().scalarType() == kByte && mask.is_contiguous() &&
+           mask.numel() == (numel + 7) / 8,
+           "_fused_dropout_backward: expected a contiguous byte mask of ", (numel + 7) / 8,
+           " elements, got ", mask.toString(), " of size ", mask.sizes());
+  auto grad_input = grad_output.type().tensor(grad_output.sizes());
+  if (numel == 0) {
+    return grad_input;
+  }
+
+  cudaStream_t stream = globalContext().getCurrentCUDAStream();
+  dim3 grid = dropout_grid(mask.numel());
+  dim3 block(DROPOUT_THREADS);
+  AT_DISPATCH_FLOATING_TYPES_AND_HALF(grad_output.type(), "_fused_dropout_backward", [&] {
+    using cuda_scalar_t = cuda::type<scalar_t>;
+    using accscalar_t = acc_type<cuda_scalar_t, true>;
+    fused_dropout_backward_kernel<cuda_scalar_t, accscalar_t><<<grid, block, 0, stream>>>(
+        grad_output.data<cuda_scalar_t>(), grad_input.data<cuda_scalar_t>(),
+        mask.data<uint8_t>(), numel, scalar_cast<accscalar_t>(dropout_scale(p)));
+  });
+  THCudaCheck(cudaGetLastError());
+  return grad_input;
+}
+
+}} // namespace at::native
@@ -6,6 +6,7 @@
 #include "ATen/AccumulateType.h"
 #include "ATen/cuda/CUDATensorMethods.cuh"
 #include "ATen/cuda/CUDATypeConversion.cuh"
+#include "ATen/native/cuda/EmbeddingBackwardKernel.cuh"
 
 #include <THC/THCDeviceUtils.cuh>
 #include <THC/THCNumerics.cuh>
@@ -17,6 +18,9 @@
 #include <thrust/execution_policy.h>
 #include <thrust/unique.h>
 
+#include <array>
+#include <tuple>
+
 
 namespace at { namespace native {
 
@@ -87,67 +91,6 @@ __global__ void embedding_backward_feature_kernel(
 }
 
 
-template <typename scalar_t>
-__global__ void embedding_backward_kernel(
-  int64_t* input, int64_t* indices, scalar_t* grad_output, scalar_t* grad_weight,
-  int64_t* count, int64_t numel, int64_t stride, int padding_idx) {
-
-  using accscalar_t = acc_type<scalar_t, true>;
-  int idx = blockIdx.x * 4 + threadIdx.y;
-
-  // Each warp is responsible for an input into the LookupTable.
-  // If the preceding input has the same as this input, then the warp
-  // exits immediately. The warp also processes subsequent inputs with the
-  // same value.
-  //
-  // Input Warp
-  // 1     <warp 1>
-  // 1     <warp 1> (<warp 2> exits without doing any work)
-  // 5     <warp 3>
-  // 8     <warp 4>
-
-  // Number of values proceessed by each thread (grain size)
-  const int SZ = 4;
-
-  if (idx < numel
-      && (idx == 0 || input[idx] != input[idx - 1])
-      && input[idx] != padding_idx) {
-    do {
-      const int start_feature = threadIdx.x + blockIdx.y * blockDim.x * SZ;
-      const int weight_row = ((int) input[idx]) * stride;
-      const int grad_row = ((int) indices[idx]) * stride;
-      const accscalar_t scale = count ? (accscalar_t)1.0 / count[idx] : 1.0;
-
-      accscalar_t gradient[SZ];
-      accscalar_t weight[SZ];
-
-      #pragma unroll
-      for (int ii = 0; ii < SZ; ii++) {
-        int feature_dim = start_feature + ii * WARP_SIZE;
-        if (feature_dim < stride) {
-          gradient[ii] = scalar_cast<accscalar_t>(grad_output[grad_row + feature_dim]);
-          weight[ii] = scalar_cast<accscalar_t>(grad_weight[weight_row + feature_dim]);
-        }
-      }
-
-      #pragma unroll
-      for (int ii = 0; ii < SZ; ii++) {
-        weight[ii] += gradient[ii] * scale;
-      }
-
-      #pragma unroll
-      for (int ii = 0; ii < SZ; ii++) {
-        int feature_dim = start_feature + ii * WARP_SIZE;
-        if (feature_dim < stride) {
-            grad_weight[weight_row + feature_dim] = scalar_cast<scalar_t>(weight[ii]);
-        }
-      }
-
-      idx++;
-    } while (idx < numel && input[idx] == input[idx - 1]);
-  }
-}
-
 /* Calculate norms of the rows of weight_ptr given by idx_ptr and capture them in norms */
 template <typename scalar_t, typename accscalar_t>
 __global__ void renorm_kernel(
@@ -227,82 +170,37 @@ Tensor embedding_backward_cuda(const Tensor & grad_, const Tensor & indices,
    return grad_weight;
   }
 
-  auto sorted_indices = indices.type().tensor(indices.sizes());
-  auto orig_indices = indices.type().tensor(indices.sizes());
-  using device_ptr = thrust::device_ptr<int64_t>;
-
-  // Sort the inputs into sorted with the corresponding indices; we
-  // don't need a stable or multidimensional sort, so just use Thrust
-  // directly
-  {
-    sorted_indices.copy_(indices);
-
-    auto allocator = THCThrustAllocator(globalContext().lazyInitCUDA());
-    auto policy = thrust::cuda::par(allocator).on(stream);
-
-    // Fill sortedOrigIndices with sequential indices
-    auto count_iter = thrust::counting_iterator<int64_t>(0);
-    auto orig_data = device_ptr(orig_indices.data<int64_t>());
-    thrust::copy(policy, count_iter, count_iter + num_indices, orig_data);
+  return embedding_backward_cuda_kernel(grad, indices, num_weights, padding_idx,
+                                        scale_grad_by_freq);
+}
 
-    // Sort; a stable sort is not required
-    auto sorted_data = device_ptr(sorted_indices.data<int64_t>());
-    thrust::sort_by_key(policy, sorted_data, sorted_data + num_indices, orig_data,
-                        ThrustLTOp<int64_t>());
-  }
+Tensor embedding_sparse_backward_cuda(
+    const Tensor & grad_, const Tensor & indices, int64_t num_weights,
+    int64_t padding_idx, bool scale_grad_by_freq) {
+  auto grad_arg = TensorArg(grad_, "grad", 1);
+  auto indices_arg = TensorArg(indices, "indices", 2);
+  checkScalarType("embedding_backward", indices_arg, kLong);
+  checkContiguous("embedding_backward", indices_arg);
+  checkSameGPU("embedding_backward", grad_arg, indices_arg);
 
-  Tensor count;
+  // TODO: implement scale_grad_by_freq
   if (scale_grad_by_freq) {
-    count = indices.type().tensor(indices.sizes());
-
-    auto allocator = THCThrustAllocator(globalContext().lazyInitCUDA());
-    auto policy = thrust::cuda::par(allocator).on(stream);
-
-    // Compute an increasing sequence per unique item in sortedIndices:
-    // sorted: 2 5 5 5 7 7 8 9 9
-    //  count: 1 1 2 3 1 2 1 1 2
-    auto sorted_data = device_ptr(sorted_indices.data<int64_t>());
-    auto count_data = device_ptr(count.data<int64_t>());
-    thrust::inclusive_scan_by_key(
-      policy,
-      sorted_data,
-      sorted_data + num_indices,
-      thrust::make_constant_iterator(1),
-      count_data
-    );
-
-    // Take the maximum of each count per unique key in reverse:
-    // sorted: 2 5 5 5 7 7 8 9 9
-    //  count: 1 3 3 3 2 2 1 2 2
-    thrust::inclusive_scan_by_key(
-      policy,
-      thrust::make_reverse_iterator(sorted_data + num_indices),
-      thrust::make_reverse_iterator(sorted_data),
-      thrust::make_reverse_iterator(count_data + num_indices),
-      thrust::make_reverse_iterator(count_data + num_indices),
-      thrust::equal_to<int64_t>(),
-      thrust::maximum<int64_t>()
-    );
+    AT_ERROR(
+        "embedding_backward: scale_grad_by_freq not supported with sparse gradients");
   }
 
-  dim3 grid(THCCeilDiv(num_indices, (int64_t) 4), THCCeilDiv(stride, (int64_t) 128));
-  dim3 block(32, 4);
-
-  AT_DISPATCH_FLOATING_TYPES_AND_HALF(grad.type(), "embedding_backward", [&] {
-    using cuda_scalar_t = cuda::type<scalar_t>;
-    embedding_backward_kernel<<<grid, block, 0, stream>>>(
-      sorted_indices.data<int64_t>(),
-      orig_indices.data<int64_t>(),
-      grad.data<cuda_scalar_t>(),
-      grad_weight.data<cuda_scalar_t>(),
-      count.defined() ? count.data<int64_t>() : nullptr,
-      num_indices,
-      stride,
-      padding_idx);
-  });
-  THCudaCheck(cudaGetLastError());
-
-  return grad_weight;
+  // The gradient has one row per distinct index, so that it doesn't grow
+  // with the number of lookups of the hot rows, and needs no coalescing
+  auto num_indices = indices.numel();
+  int64_t num_features = grad_.size(-1);
+  auto grad = grad_.contiguous().view({num_indices, num_features});
+  Tensor unique_indices, values;
+  std::tie(unique_indices, values) = embedding_sparse_backward_cuda_kernel(
+      grad, indices, padding_idx, scale_grad_by_freq);
+
+  auto weight_size = std::array<int64_t, 2>{{ num_weights, num_features }};
+  auto& sparse_type = grad.type().toBackend(kSparseCUDA);
+  return sparse_type._sparse_coo_tensor_unsafe(unique_indices.view({1, -1}), values, weight_size);
 }
 
 Tensor & embedding_renorm_cuda_(Tensor & self, const Tensor & indices,
@@ -0,0 +1,259 @@
+#include "ATen/native/cuda/EmbeddingBackwardKernel.cuh"
+
+#include "ATen/AccumulateType.h"
+#include "ATen/Dispatch.h"
+#include "ATen/cuda/CUDATypeConversion.cuh"
+
+#include <THC/THCDeviceUtils.cuh>
+#include <THC/THCGeneral.h>
+#include <THC/THCNumerics.cuh>
+#include <THC/THCThrustAllocator.cuh>
+
+#include <thrust/copy.h>
+#include <thrust/device_ptr.h>
+#include <thrust/execution_policy.h>
+#include <thrust/iterator/counting_iterator.h>
+#include <thrust/reduce.h>
+#include <thrust/scan.h>
+#include <thrust/sort.h>
+#include <thrust/unique.h>
+
+namespace at { namespace native {
+
+namespace {
+
+// Rows summed by a thread in the first phase
+constexpr int64_t NROWS_PER_THREAD = 10;
+constexpr int NUM_THREADS = 128;
+
+// Number of partial segments of each segment
+__global__ void krn_partials_per_segment(
+    int64_t* ret, const int64_t* segment_offsets, int64_t num_segments, int64_t numel) {
+  const int64_t id = static_cast<int64_t>(blockIdx.x) * blockDim.x + threadIdx.x;
+  if (id < num_segments) {
+    const int64_t idx_start = segment_offsets[id];
+    const int64_t idx_end = (id == num_segments - 1) ? numel : segment_offsets[id + 1];
+    ret[id] = THCCeilDiv(idx_end - idx_start, NROWS_PER_THREAD);
+  }
+}
+
+// Offset into the sorted indices of each partial segment
+__global__ void krn_partial_segment_offset(
+    int64_t* ret, const int64_t* partials_per_segment,
+    const int64_t* partials_per_segment_offset, const int64_t* segment_offsets,
+    int64_t num_segments) {
+  const int64_t id = static_cast<int64_t>(blockIdx.x) * blockDim.x + threadIdx.x;
+  if (id < num_segments) {
+    int64_t idx = partials_per_segment_offset[id];
+    const int64_t num_partials = partials_per_segment[id];
+    const int64_t segment_offset = segment_offsets[id];
+    for (int64_t i = 0; i < num_partials; i++) {
+      ret[idx++] = segment_offset + i * NROWS_PER_THREAD;
+    }
+  }
+}
+
+// First phase: thread (partial, feature) sums the feature over the rows of
+// the partial segment, which ends at the end of its segment or after
+// NROWS_PER_THREAD rows
+template <typename scalar_t, typename accscalar_t>
+__global__ void compute_grad_weight_kernel(
+    const int64_t* sorted_indices, const int64_t* orig_indices, const scalar_t* grad,
+    const int64_t* partial_segment_offset, int64_t num_partials, int64_t numel,
+    int64_t stride, const int64_t* offset2bag, const int64_t* bag_size, bool mode_mean,
+    accscalar_t* partial_grad) {
+  const int64_t id = static_cast<int64_t>(blockIdx.x) * blockDim.x + threadIdx.x;
+  const int64_t partial = id / stride;
+  const int64_t feature = id % stride;
+  if (partial >= num_partials) {
+    return;
+  }
+  const int64_t start = partial_segment_offset[partial];
+  const int64_t end = start + NROWS_PER_THREAD < numel ? start + NROWS_PER_THREAD : numel;
+  const int64_t index = sorted_indices[start];
+
+  accscalar_t acc = 0;
+  for (int64_t i = start; i < end && sorted_indices[i] == index; i++) {
+    const int64_t orig = orig_indices[i];
+    if (offset2bag) {
+      const int64_t bag = offset2bag[orig];
+      accscalar_t value = ScalarConvert<scalar_t, accscalar_t>::to(grad[bag * stride + feature]);
+      if (mode_mean) {
+        value /= static_cast<accscalar_t>(bag_size[bag]);
+      }
+      acc += value;
+    } else {
+      acc += ScalarConvert<scalar_t, accscalar_t>::to(grad[orig * stride + feature]);
+    }
+  }
+  partial_grad[partial * stride + feature] = acc;
+}
+
+// Second phase: thread (segment, feature) sums the partial sums of the
+// segment, in order, into row index of out when dense, else into row segment
+template <typename scalar_t, typename accscalar_t>
+__global__ void sum_and_scatter_kernel(
+    const int64_t* sorted_indices, const int64_t* segment_offsets, int64_t num_segments,
+    int64_t numel, const accscalar_t* partial_grad, const int64_t* partials_per_segment_offset,
+    int64_t num_partials, int64_t stride, int64_t padding_idx, bool scale_grad_by_freq,
+    bool dense, scalar_t* out) {
+  const int64_t id = static_cast<int64_t>(blockIdx.x) * blockDim.x + threadIdx.x;
+  const int64_t segment = id / stride;
+  const int64_t feature = id % stride;
+  if (segment >= num_segments) {
+    return;
+  }
+  const int64_t partial_begin = partials_per_segment_offset[segment];
+  const int64_t partial_end =
+      segment == num_segments - 1 ? num_partials : partials_per_segment_offset[segment + 1];
+
+  accscalar_t acc = 0;
+  for (int64_t p = partial_begin; p < partial_end; p++) {
+    acc += partial_grad[p * stride + feature];
+  }
+  if (scale_grad_by_freq) {
+    const int64_t idx_start = segment_offsets[segment];
+    const int64_t idx_end = segment == num_segments - 1 ? numel : segment_offsets[segment + 1];
+    acc /= static_cast<accscalar_t>(idx_end - idx_start);
+  }
+
+  if (dense) {
+    const int64_t index = sorted_indices[segment_offsets[segment]];
+    if (index >= 0 && index != padding_idx) {
+      out[index * stride + feature] = ScalarConvert<accscalar_t, scalar_t>::to(acc);
+    }
+  } else {
+    out[segment * stride + feature] = ScalarConvert<accscalar_t, scalar_t>::to(acc);
+  }
+}
+
+int64_t num_blocks(int64_t n) {
+  return THCCeilDiv(n, static_cast<int64_t>(NUM_THREADS));
+}
+
+// Reduces the rows of grad of each distinct index, and returns the distinct
+// indices. The reductions go to the rows of dense_out given by the indices
+// if it is defined, else to those of values, which is allocated.
+Tensor embedding_backward_segments(
+    const Tensor& grad_, const Tensor& indices, int64_t padding_idx,
+    bool scale_grad_by_freq, bool mode_mean, const Tensor& offset2bag,
+    const Tensor& bag_size, const Tensor& dense_out, Tensor& values) {
+  const bool dense = dense_out.defined();
+  const int64_t numel = indices.numel();
+  const int64_t stride = grad_.size(1);
+  auto grad = grad_.contiguous();
+  if (!dense) {
+    values = grad.type().tensor({0, stride});
+  }
+  if (numel == 0) {
+    return indices.type().tensor({0});
+  }
+
+  cudaStream_t stream = globalContext().getCurrentCUDAStream();
+  auto allocator = THCThrustAllocator(globalContext().lazyInitCUDA());
+  auto policy = thrust::cuda::par(allocator).on(stream);
+  using device_ptr = thrust::device_ptr<int64_t>;
+
+  // The sort is stable so that the rows of each segment are always summed
+  // in the same order
+  auto sorted_indices = indices.contiguous().view({numel}).clone();
+  auto orig_indices = indices.type().tensor({numel});
+  auto sorted_data = device_ptr(sorted_indices.data<int64_t>());
+  auto orig_data = device_ptr(orig_indices.data<int64_t>());
+  auto count_iter = thrust::counting_iterator<int64_t>(0);
+  thrust::copy(policy, count_iter, count_iter + numel, orig_data);
+  thrust::stable_sort_by_key(policy, sorted_data, sorted_data + numel, orig_data);
+
+  // Start of each segment of equal indices:
+  //        sorted: 2 5 5 5 7 7 8 9 9
+  //        unique: 2 5 7 8 9
+  // segment start: 0 1 4 6 7
+  auto unique_indices = indices.type().tensor({numel});
+  auto segment_offsets = indices.type().tensor({numel});
+  auto unique_data = device_ptr(unique_indices.data<int64_t>());
+  auto ends = thrust::unique_by_key_copy(
+      policy, sorted_data, sorted_data + numel, count_iter, unique_data,
+      device_ptr(segment_offsets.data<int64_t>()));
+  const int64_t num_segments = ends.first - unique_data;
+  unique_indices.resize_({num_segments});
+
+  // Cut the segments into partial segments of at most NROWS_PER_THREAD rows
+  auto partials_per_segment = indices.type().tensor({num_segments});
+  krn_partials_per_segment<<<num_blocks(num_segments), NUM_THREADS, 0, stream>>>(
+      partials_per_segment.data<int64_t>(), segment_offsets.data<int64_t>(), num_segments, numel);
+  auto partials_per_segment_offset = indices.type().tensor({num_segments});
+  auto partials_data = device_ptr(partials_per_segment.data<int64_t>());
+  thrust::exclusive_scan(policy, partials_data, partials_data + num_segments,
+                         device_ptr(partials_per_segment_offset.data<int64_t>()));
+  const int64_t num_partials = thrust::reduce(policy, partials_data, partials_data + num_segments);
+
+  auto partial_segment_offset = indices.type().tensor({num_partials});
+  krn_partial_segment_offset<<<num_blocks(num_segments), NUM_THREADS, 0, stream>>>(
+      partial_segment_offset.data<int64_t>(), partials_per_segment.data<int64_t>(),
+      partials_per_segment_offset.data<int64_t>(), segment_offsets.data<int64_t>(),
+      num_segments);
+  THCudaCheck(cudaGetLastError());
+
+  if (!dense) {
+    values = grad.type().tensor({num_segments, stride});
+  }
+  if (stride == 0) {
+    return unique_indices;
+  }
+
+  AT_DISPATCH_FLOATING_TYPES_AND_HALF(grad.type(), "embedding_backward", [&] {
+    using cuda_scalar_t = cuda::type<scalar_t>;
+    using accscalar_t = acc_type<cuda_scalar_t, true>;
+    auto partial_grad = grad.type().toScalarType(kByte).tensor(
+        {static_cast<int64_t>(num_partials * stride * sizeof(accscalar_t))});
+    auto partial_grad_data = reinterpret_cast<accscalar_t*>(partial_grad.data_ptr());
+
+    compute_grad_weight_kernel<cuda_scalar_t, accscalar_t>
+        <<<num_blocks(num_partials * stride), NUM_THREADS, 0, stream>>>(
+        sorted_indices.data<int64_t>(), orig_indices.data<int64_t>(),
+        grad.data<cuda_scalar_t>(), partial_segment_offset.data<int64_t>(), num_partials,
+        numel, stride, offset2bag.defined() ? offset2bag.data<int64_t>() : nullptr,
+        bag_size.defined() ? bag_size.data<int64_t>() : nullptr, mode_mean,
+        partial_grad_data);
+
+    auto out = dense ? dense_out : values;
+    sum_and_scatter_kernel<cuda_scalar_t, accscalar_t>
+        <<<num_blocks(num_segments * stride), NUM_THREADS, 0, stream>>>(
+        sorted_indices.data<int64_t>(), segment_offsets.data<int64_t>(), num_segments,
+        numel, partial_grad_data, partials_per_segment_offset.data<int64_t>(), num_partials,
+        stride, padding_idx, scale_grad_by_freq, dense, out.data<cuda_scalar_t>());
+  });
+  THCudaCheck(cudaGetLastError());
+  return unique_indices;
+}
+
+} // anonymous namespace
+
+Tensor embedding_backward_cuda_kernel(
+    const Tensor& grad, const Tensor& indices, int64_t num_weights,
+    int64_t padding_idx, bool scale_grad_by_freq, bool mode_mean,
+    const Tensor& offset2bag, const Tensor& bag_size) {
+  auto grad_weight = at::zeros(grad.type(), {num_weights, grad.size(1)});
+  Tensor values;
+  embedding_backward_segments(grad, indices, padding_idx, scale_grad_by_freq,
+                              mode_mean, offset2bag, bag_size, grad_weight, values);
+  return grad_weight;
+}
+
+std::tuple<Tensor, Tensor> embedding_sparse_backward_cuda_kernel(
+    const Tensor& grad, const Tensor& indices, int64_t padding_idx,
+    bool scale_grad_by_freq, bool mode_mean, const Tensor& offset2bag,
+    const Tensor& bag_size) {
+  Tensor values;
+  auto unique_indices = embedding_backward_segments(
+      grad, indices, padding_idx, scale_grad_by_freq, mode_mean, offset2bag,
+      bag_size, Tensor(), values);
+  if (padding_idx != -1) {
+    auto mask = unique_indices != padding_idx;
+    unique_indices = unique_indices.masked_select(mask);
+    values = values.index_select(0, mask.nonzero().view(-1));
+  }
+  return std::make_tuple(unique_indices, values);
+}
+
+}} // namespace at::native
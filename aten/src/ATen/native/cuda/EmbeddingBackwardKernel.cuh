@@ -0,0 +1,42 @@
+#pragma once
+
+#include "ATen/ATen.h"
+
+#include <tuple>
+
+// Deterministic gradients of the embedding lookups, shared by embedding and
+// embedding_bag.
+//
+// The indices are stably sorted, so that the occurrences of each weight row
+// form a segment, and the rows of grad are then summed in two phases: each
+// segment is cut into partial segments of at most a few rows, which are
+// summed by one thread per feature, and the partial sums of each segment are
+// then added up, always in the same order. A row that appears in most of the
+// batch is thus spread over many threads instead of serializing a warp, and
+// no atomics are used, so the result doesn't depend on the distribution of
+// the indices nor on the scheduling.
+//
+// grad holds the gradient of each lookup, of shape (indices.numel(), D) for
+// embedding. For embedding_bag, grad is the gradient of the bags, and index i
+// takes its row from bag offset2bag[i], divided by bag_size[offset2bag[i]]
+// when mode_mean. The rows of padding_idx get no gradient, and with
+// scale_grad_by_freq each row is divided by the number of occurrences of its
+// index.
+
+namespace at { namespace native {
+
+// Returns the dense gradient, of shape (num_weights, D)
+Tensor embedding_backward_cuda_kernel(
+    const Tensor& grad, const Tensor& indices, int64_t num_weights,
+    int64_t padding_idx, bool scale_grad_by_freq, bool mode_mean = false,
+    const Tensor& offset2bag = Tensor(), const Tensor& bag_size = Tensor());
+
+// Returns the coalesced sparse gradient as its distinct indices, in
+// increasing order and without padding_idx, and their rows, of shape
+// (num_distinct_indices, D)
+std::tuple<Tensor, Tensor> embedding_sparse_backward_cuda_kernel(
+    const Tensor& grad, const Tensor& indices, int64_t padding_idx,
+    bool scale_grad_by_freq, bool mode_mean = false,
+    const Tensor& offset2bag = Tensor(), const Tensor& bag_size = Tensor());
+
+}} // namespace at::native
@@ -0,0 +1,96 @@
+#include "ATen/ATen.h"
+#include "ATen/AccumulateType.h"
+#include "ATen/Dispatch.h"
+#include "ATen/NativeFunctions.h"
+#include "ATen/cuda/CUDATypeConversion.cuh"
+#include "ATen/native/FusedOptimizers.h"
+#include "ATen/native/cuda/MultiTensorApply.cuh"
+
+#include <THC/THCNumerics.cuh>
+#include <THCUNN/THCHalfAutoNumerics.cuh>
+
+#include <vector>
+
+// CUDA counterparts of FusedOptimizers.cpp: every parameter of the lists is
+// updated through multi_tensor_apply, a few hundred chunks per launch. Half
+// tensors are updated in float.
+
+namespace at { namespace native {
+
+std::vector<Tensor> _fused_sgd_cuda(
+    TensorList params, TensorList grads, TensorList momentum_buffers,
+    double lr, double momentum, double dampening, double weight_decay,
+    bool nesterov, bool init_momentum) {
+  if (momentum != 0) {
+    check_fused_optimizer_lists("_fused_sgd", {grads, params, momentum_buffers});
+    AT_DISPATCH_FLOATING_TYPES_AND_HALF(params[0].type(), "_fused_sgd", [&] {
+      using cuda_scalar_t = cuda::type<scalar_t>;
+      using accscalar_t = acc_type<cuda_scalar_t, true>;
+      SGDUpdate<accscalar_t, true> op{
+          static_cast<accscalar_t>(lr), static_cast<accscalar_t>(momentum),
+          static_cast<accscalar_t>(dampening), static_cast<accscalar_t>(weight_decay),
+          nesterov, init_momentum};
+      multi_tensor_apply<cuda_scalar_t, accscalar_t, 3>({grads, params, momentum_buffers}, op);
+    });
+  } else {
+    check_fused_optimizer_lists("_fused_sgd", {grads, params});
+    AT_DISPATCH_FLOATING_TYPES_AND_HALF(params[0].type(), "_fused_sgd", [&] {
+      using cuda_scalar_t = cuda::type<scalar_t>;
+      using accscalar_t = acc_type<cuda_scalar_t, true>;
+      SGDUpdate<accscalar_t, false> op{
+          static_cast<accscalar_t>(lr), 0, 0, static_cast<accscalar_t>(weight_decay),
+          false, false};
+      multi_tensor_apply<cuda_scalar_t, accscalar_t, 2>({grads, params}, op);
+    });
+  }
+  return params.vec();
+}
+
+std::vector<Tensor> _fused_adam_cuda(
+    TensorList params, TensorList grads, TensorList exp_avgs, TensorList exp_avg_sqs,
+    TensorList max_exp_avg_sqs, double step_size, double beta1, double beta2, double eps,
+    double weight_decay) {
+  if (max_exp_avg_sqs.size() > 0) {
+    check_fused_optimizer_lists(
+        "_fused_adam", {grads, params, exp_avgs, exp_avg_sqs, max_exp_avg_sqs});
+    AT_DISPATCH_FLOATING_TYPES_AND_HALF(params[0].type(), "_fused_adam", [&] {
+      using cuda_scalar_t = cuda::type<scalar_t>;
+      using accscalar_t = acc_type<cuda_scalar_t, true>;
+      AdamUpdate<accscalar_t, true> op{
+          static_cast<accscalar_t>(step_size), static_cast<accscalar_t>(beta1),
+          static_cast<accscalar_t>(beta2), static_cast<accscalar_t>(eps),
+          static_cast<accscalar_t>(weight_decay)};
+      multi_tensor_apply<cuda_scalar_t, accscalar_t, 5>(
+          {grads, params, exp_avgs, exp_avg_sqs, max_exp_avg_sqs}, op);
+    });
+  } else {
+    check_fused_optimizer_lists("_fused_adam", {grads, params, exp_avgs, exp_avg_sqs});
+    AT_DISPATCH_FLOATING_TYPES_AND_HALF(params[0].type(), "_fused_adam", [&] {
+      using cuda_scalar_t = cuda::type<scalar_t>;
+      using accscalar_t = acc_type<cuda_scalar_t, true>;
+      AdamUpdate<accscalar_t, false> op{
+          static_cast<accscalar_t>(step_size), static_cast<accscalar_t>(beta1),
+          static_cast<accscalar_t>(beta2), static_cast<accscalar_t>(eps),
+          static_cast<accscalar_t>(weight_decay)};
+      multi_tensor_apply<cuda_scalar_t, accscalar_t, 4>(
+          {grads, params, exp_avgs, exp_avg_sqs}, op);
+    });
+  }
+  return params.vec();
+}
+
+std::vector<Tensor> _fused_adagrad_cuda(
+    TensorList params, TensorList grads, TensorList state_sums,
+    double clr, double weight_decay) {
+  check_fused_optimizer_lists("_fused_adagrad", {grads, params, state_sums});
+  AT_DISPATCH_FLOATING_TYPES_AND_HALF(params[0].type(), "_fused_adagrad", [&] {
+    using cuda_scalar_t = cuda::type<scalar_t>;
+    using accscalar_t = acc_type<cuda_scalar_t, true>;
+    AdagradUpdate<accscalar_t> op{
+        static_cast<accscalar_t>(clr), static_cast<accscalar_t>(weight_decay)};
+    multi_tensor_apply<cuda_scalar_t, accscalar_t, 3>({grads, params, state_sums}, op);
+  });
+  return params.vec();
+}
+
+}} // namespace at::native
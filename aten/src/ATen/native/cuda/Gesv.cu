@@ -6,6 +6,7 @@
 
 #include "ATen/native/LinearAlgebraUtils.h"
 #include "ATen/native/Gesv.h"
+#include "ATen/native/SmallMatrixOps.h"
 
 #include "THC.h" // for USE_MAGMA
 
@@ -83,7 +84,7 @@ static inline std::unique_ptr<Storage> pin_memory(int64_t size, Tensor dummy) {
   name = reinterpret_cast<type*>(storage_##name->data());
 
 template <typename scalar_t>
-static void applyGesv(Tensor& b, Tensor& A, std::vector<int64_t> infos) {
+static void applyGesv(Tensor& b, Tensor& A, std::vector<int64_t>& infos) {
 #ifndef USE_MAGMA
 AT_ERROR("gesv: MAGMA library not found in "
     "compilation. Please rebuild with MAGMA.");
@@ -126,12 +127,58 @@ AT_ERROR("gesv: MAGMA library not found in "
 #endif
 }
 
+constexpr int kSmallGesvThreads = 128;
+
+template <typename scalar_t, int N>
+__global__ void small_gesv_kernel(
+    scalar_t* A_data, scalar_t* b_data, int* info_data,
+    int64_t nrhs, int64_t batch_size) {
+  int64_t i = blockIdx.x * static_cast<int64_t>(blockDim.x) + threadIdx.x;
+  if (i < batch_size) {
+    info_data[i] = small_gesv<scalar_t, N>(
+        &A_data[i * N * N], &b_data[i * N * nrhs], nrhs);
+  }
+}
+
+// Same as applyGesv with one thread per matrix running the kernel of
+// SmallMatrixOps.h, for batches of matrices of at most kMaxSmallMatrixSize
+// rows. Doesn't need MAGMA.
+template <typename scalar_t>
+static void applySmallGesv(Tensor& b, Tensor& A, std::vector<int64_t>& infos) {
+  auto batch_size = batchCount(A);
+  if (batch_size == 0) {
+    return;
+  }
+  auto n = A.size(-2);
+  auto nrhs = b.size(-1);
+  auto info_tensor = b.type().toScalarType(kInt).tensor({batch_size});
+  auto stream = b.type().get_context().getCurrentCUDAStream();
+  dim3 grid((batch_size + kSmallGesvThreads - 1) / kSmallGesvThreads);
+
+  AT_DISPATCH_SMALL_MATRIX_SIZE(n, "gesv", [&] {
+    small_gesv_kernel<scalar_t, N><<<grid, kSmallGesvThreads, 0, stream>>>(
+        A.data<scalar_t>(), b.data<scalar_t>(), info_tensor.data<int>(),
+        nrhs, batch_size);
+  });
+  THCudaCheck(cudaGetLastError());
+
+  auto info_cpu = info_tensor.toBackend(kCPU);
+  auto info_data = info_cpu.data<int>();
+  for (int64_t i = 0; i < batch_size; i++) {
+    infos[i] = info_data[i];
+  }
+}
+
 std::tuple<Tensor,Tensor> _gesv_helper_cuda(const Tensor& self, const Tensor& A) {
   std::vector<int64_t> infos(batchCount(A), 0);
   auto A_working_copy = cloneBatchedColumnMajor(A);
   auto b_working_copy = cloneBatchedColumnMajor(self);
   AT_DISPATCH_FLOATING_TYPES(self.type(), "gesv", [&]{
-    applyGesv<scalar_t>(b_working_copy, A_working_copy, infos);
+    if (use_small_matrix_kernels(A)) {
+      applySmallGesv<scalar_t>(b_working_copy, A_working_copy, infos);
+    } else {
+      applyGesv<scalar_t>(b_working_copy, A_working_copy, infos);
+    }
   });
   checkErrors(infos);
   return std::tuple<Tensor,Tensor>(b_working_copy, A_working_copy);
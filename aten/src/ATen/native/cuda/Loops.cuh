@@ -0,0 +1,261 @@
+#pragma once
+
+// Elementwise CUDA loops on top of TensorIterator, the counterpart of
+// native/cpu/Loops.h.
+//
+// TensorIterator broadcasts the operands and reorders and collapses their
+// dimensions on the host, so the kernels only have to map a linear index to
+// one byte offset per operand. Two kernels are used:
+//
+//   - when every operand is contiguous and aligned, each thread loads and
+//     stores kLoopsVecSize elements with single vector instructions;
+//   - otherwise each thread handles kLoopsThreadWork elements, kLoopsThreads
+//     apart so that the accesses of a warp stay coalesced, and computes their
+//     offsets with IntDivider. The indices and offsets are 32-bit when they
+//     fit for every operand, which turns the divisions into a multiplication
+//     and a shift; larger tensors use 64-bit indices and plain divisions.
+//
+// The operation takes and returns acc_t, e.g. float for half tensors:
+//
+//   auto iter = TensorIterator::binary_op(result, a, b);
+//   gpu_binary_kernel<scalar_t, accscalar_t>(iter,
+//       [] __device__ (accscalar_t x, accscalar_t y) { return x + y; });
+//
+// Every operand must have type scalar_t, which is left to the caller to
+// check, and all must be on the current device.
+
+#include "ATen/ATen.h"
+#include "ATen/native/TensorIterator.h"
+#include "ATen/native/cuda/MemoryAccess.cuh"
+
+#include <THC/THCGeneral.h>
+#include <THC/THCIntegerDivider.cuh>
+#include <THC/THCNumerics.cuh>
+
+#include <cstdint>
+#include <limits>
+
+namespace at { namespace native {
+
+constexpr int kLoopsThreads = 128;
+// Elements per thread of the strided kernel
+constexpr int kLoopsThreadWork = 4;
+// Elements per thread, and per load, of the vectorized kernel
+constexpr int kLoopsVecSize = 4;
+// As MAX_TENSORINFO_DIMS
+constexpr int kLoopsMaxDims = 25;
+
+template <int NARGS>
+struct ElementwisePointers {
+  char* data[NARGS];
+};
+
+// Byte offsets of each of the NARGS operands of a TensorIterator for an index
+// into its iteration space
+template <int NARGS, typename index_t>
+struct OffsetCalculator {
+  explicit OffsetCalculator(const TensorIterator& iter) : dims(iter.ndim()) {
+    AT_CHECK(dims <= kLoopsMaxDims, "elementwise CUDA kernels support at most ",
+             kLoopsMaxDims, " dimensions after collapsing, but got ", dims);
+    for (int d = 0; d < dims; d++) {
+      sizes[d] = IntDivider<index_t>(static_cast<index_t>(iter.shape()[d]));
+      for (int arg = 0; arg < NARGS; arg++) {
+        strides[d][arg] = static_cast<index_t>(iter.strides(arg)[d]);
+      }
+    }
+  }
+
+  __device__ __forceinline__ void get(index_t linear_idx, index_t (&offsets)[NARGS]) const {
+#pragma unroll
+    for (int arg = 0; arg < NARGS; arg++) {
+      offsets[arg] = 0;
+    }
+    // The dimensions are innermost first
+#pragma unroll
+    for (int d = 0; d < kLoopsMaxDims; d++) {
+      if (d == dims) {
+        break;
+      }
+      auto divmod = sizes[d].divmod(linear_idx);
+      linear_idx = divmod.div;
+#pragma unroll
+      for (int arg = 0; arg < NARGS; arg++) {
+        offsets[arg] += divmod.mod * strides[d][arg];
+      }
+    }
+  }
+
+  int dims;
+  IntDivider<index_t> sizes[kLoopsMaxDims];
+  index_t strides[kLoopsMaxDims][NARGS];
+};
+
+template <int arity>
+struct ApplyElementwise;
+
+template <>
+struct ApplyElementwise<1> {
+  template <typename acc_t, typename func_t>
+  static __device__ __forceinline__ acc_t call(const func_t& f, const acc_t (&in)[1]) {
+    return f(in[0]);
+  }
+};
+
+template <>
+struct ApplyElementwise<2> {
+  template <typename acc_t, typename func_t>
+  static __device__ __forceinline__ acc_t call(const func_t& f, const acc_t (&in)[2]) {
+    return f(in[0], in[1]);
+  }
+};
+
+template <>
+struct ApplyElementwise<3> {
+  template <typename acc_t, typename func_t>
+  static __device__ __forceinline__ acc_t call(const func_t& f, const acc_t (&in)[3]) {
+    return f(in[0], in[1], in[2]);
+  }
+};
+
+// ptrs.data[0] is the output, and ptrs.data[1..arity] the inputs
+template <int arity, typename scalar_t, typename acc_t, typename index_t, typename func_t>
+__global__ void __launch_bounds__(kLoopsThreads)
+elementwise_kernel(index_t N, OffsetCalculator<arity + 1, index_t> calc,
+                   ElementwisePointers<arity + 1> ptrs, func_t f) {
+  index_t idx = static_cast<index_t>(blockIdx.x) * (kLoopsThreads * kLoopsThreadWork) + threadIdx.x;
+#pragma unroll
+  for (int i = 0; i < kLoopsThreadWork; i++) {
+    if (idx < N) {
+      index_t offsets[arity + 1];
+      calc.get(idx, offsets);
+      acc_t in[arity];
+#pragma unroll
+      for (int arg = 0; arg < arity; arg++) {
+        in[arg] = ScalarConvert<scalar_t, acc_t>::to(
+            *reinterpret_cast<const scalar_t*>(ptrs.data[arg + 1] + offsets[arg + 1]));
+      }
+      *reinterpret_cast<scalar_t*>(ptrs.data[0] + offsets[0]) =
+          ScalarConvert<acc_t, scalar_t>::to(ApplyElementwise<arity>::call(f, in));
+      idx += kLoopsThreads;
+    }
+  }
+}
+
+// For contiguous operands whose data is aligned for vectors of kLoopsVecSize
+template <int arity, typename scalar_t, typename acc_t, typename func_t>
+__global__ void __launch_bounds__(kLoopsThreads)
+vectorized_elementwise_kernel(int64_t N, ElementwisePointers<arity + 1> ptrs, func_t f) {
+  using vec_t = aligned_vector<scalar_t, kLoopsVecSize>;
+  const int64_t first =
+      (static_cast<int64_t>(blockIdx.x) * kLoopsThreads + threadIdx.x) * kLoopsVecSize;
+  if (first + kLoopsVecSize <= N) {
+    vec_t in_vecs[arity];
+#pragma unroll
+    for (int arg = 0; arg < arity; arg++) {
+      in_vecs[arg] = reinterpret_cast<const vec_t*>(ptrs.data[arg + 1])[first / kLoopsVecSize];
+    }
+    vec_t out;
+#pragma unroll
+    for (int j = 0; j < kLoopsVecSize; j++) {
+      acc_t in[arity];
+#pragma unroll
+      for (int arg = 0; arg < arity; arg++) {
+        in[arg] = ScalarConvert<scalar_t, acc_t>::to(in_vecs[arg].val[j]);
+      }
+      out.val[j] = ScalarConvert<acc_t, scalar_t>::to(ApplyElementwise<arity>::call(f, in));
+    }
+    reinterpret_cast<vec_t*>(ptrs.data[0])[first / kLoopsVecSize] = out;
+  } else {
+    // Tail of fewer than kLoopsVecSize elements
+    for (int64_t i = first; i < N; i++) {
+      acc_t in[arity];
+#pragma unroll
+      for (int arg = 0; arg < arity; arg++) {
+        in[arg] = ScalarConvert<scalar_t, acc_t>::to(
+            reinterpret_cast<const scalar_t*>(ptrs.data[arg + 1])[i]);
+      }
+      reinterpret_cast<scalar_t*>(ptrs.data[0])[i] =
+          ScalarConvert<acc_t, scalar_t>::to(ApplyElementwise<arity>::call(f, in));
+    }
+  }
+}
+
+// True if every index and byte offset of the iteration fits in 32 bits
+inline bool can_use_32bit_indexing(const TensorIterator& iter) {
+  const int64_t max_value = std::numeric_limits<int32_t>::max();
+  if (iter.numel() > max_value) {
+    return false;
+  }
+  for (int arg = 0; arg < iter.ntensors(); arg++) {
+    int64_t max_offset = iter.type(arg).elementSizeInBytes();
+    for (int d = 0; d < iter.ndim(); d++) {
+      const int64_t stride = iter.strides(arg)[d];
+      if (stride < 0) {
+        return false;
+      }
+      max_offset += (iter.shape()[d] - 1) * stride;
+    }
+    if (max_offset > max_value) {
+      return false;
+    }
+  }
+  return true;
+}
+
+template <int arity, typename scalar_t, typename acc_t, typename index_t, typename func_t>
+void launch_elementwise_kernel(const TensorIterator& iter,
+                               const ElementwisePointers<arity + 1>& ptrs, const func_t& f) {
+  const int64_t N = iter.numel();
+  const int64_t grid = (N + kLoopsThreads * kLoopsThreadWork - 1) / (kLoopsThreads * kLoopsThreadWork);
+  cudaStream_t stream = globalContext().getCurrentCUDAStream();
+  elementwise_kernel<arity, scalar_t, acc_t, index_t, func_t><<<grid, kLoopsThreads, 0, stream>>>(
+      static_cast<index_t>(N), OffsetCalculator<arity + 1, index_t>(iter), ptrs, f);
+}
+
+template <int arity, typename scalar_t, typename acc_t, typename func_t>
+void gpu_elementwise_kernel(const TensorIterator& iter, const func_t& f) {
+  AT_ASSERT(iter.ntensors() == arity + 1 && !iter.is_reduction());
+  const int64_t N = iter.numel();
+  if (N == 0) {
+    return;
+  }
+  ElementwisePointers<arity + 1> ptrs;
+  bool aligned = true;
+  for (int arg = 0; arg < arity + 1; arg++) {
+    ptrs.data[arg] = iter.data_ptr(arg);
+    aligned = aligned && is_aligned_for_vector<kLoopsVecSize>(
+        reinterpret_cast<const scalar_t*>(ptrs.data[arg]));
+  }
+
+  if (iter.is_contiguous() && aligned) {
+    const int64_t grid = (N + kLoopsThreads * kLoopsVecSize - 1) / (kLoopsThreads * kLoopsVecSize);
+    cudaStream_t stream = globalContext().getCurrentCUDAStream();
+    vectorized_elementwise_kernel<arity, scalar_t, acc_t, func_t><<<grid, kLoopsThreads, 0, stream>>>(
+        N, ptrs, f);
+  } else if (can_use_32bit_indexing(iter)) {
+    launch_elementwise_kernel<arity, scalar_t, acc_t, uint32_t>(iter, ptrs, f);
+  } else {
+    launch_elementwise_kernel<arity, scalar_t, acc_t, int64_t>(iter, ptrs, f);
+  }
+  THCudaCheck(cudaGetLastError());
+}
+
+// out = f(a)
+template <typename scalar_t, typename acc_t, typename func_t>
+void gpu_unary_kernel(const TensorIterator& iter, const func_t& f) {
+  gpu_elementwise_kernel<1, scalar_t, acc_t>(iter, f);
+}
+
+// out = f(a, b)
+template <typename scalar_t, typename acc_t, typename func_t>
+void gpu_binary_kernel(const TensorIterator& iter, const func_t& f) {
+  gpu_elementwise_kernel<2, scalar_t, acc_t>(iter, f);
+}
+
+// out = f(a, b, c)
+template <typename scalar_t, typename acc_t, typename func_t>
+void gpu_ternary_kernel(const TensorIterator& iter, const func_t& f) {
+  gpu_elementwise_kernel<3, scalar_t, acc_t>(iter, f);
+}
+
+}} // namespace at::native
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstdint>
+
+// Vectorized memory access shared by the CUDA loops and reductions
+
+namespace at { namespace native {
+
+// vec_size elements loaded or stored with a single instruction, e.g. a float4
+// for 4 floats. The address must be aligned to the size of the vector.
+template <typename T, int vec_size>
+struct alignas(sizeof(T) * vec_size) aligned_vector {
+  T val[vec_size];
+};
+
+template <int vec_size, typename T>
+inline bool is_aligned_for_vector(const T* ptr) {
+  return reinterpret_cast<uintptr_t>(ptr) % (sizeof(T) * vec_size) == 0;
+}
+
+}} // namespace at::native
@@ -0,0 +1,123 @@
+#pragma once
+
+#include "ATen/ATen.h"
+
+#include <THC/THCGeneral.h>
+#include <THC/THCNumerics.cuh>
+
+#include <algorithm>
+
+// multi_tensor_apply runs an element-wise op over lists of tensors, such as
+// the gradients, parameters and optimizer state of a whole model, with one
+// kernel launch per batch of chunks instead of one launch per tensor. Each
+// block handles a chunk of kMultiTensorChunkSize elements of one tensor.
+// The addresses of a batch's tensors are passed in the kernel arguments,
+// which are limited to 4KB, so a batch holds fewer tensors the more lists
+// there are.
+//
+// The element i of tensor t gets op(v) with v[d] = lists[d][t][i], computed
+// in accscalar_t; every list but the first is written back.
+
+namespace at { namespace native {
+
+constexpr int64_t kMultiTensorChunkSize = 65536;
+constexpr int kMultiTensorBlockSize = 512;
+constexpr int kMultiTensorMaxBlocks = 320;
+// by depth - 1, the number of lists
+constexpr int kMultiTensorMaxTensors[] = {110, 64, 48, 36, 30};
+
+template <int depth>
+struct TensorListMetadata {
+  void* addresses[depth][kMultiTensorMaxTensors[depth - 1]];
+  int64_t sizes[kMultiTensorMaxTensors[depth - 1]];
+  unsigned char block_to_tensor[kMultiTensorMaxBlocks];
+  int block_to_chunk[kMultiTensorMaxBlocks];
+};
+
+template <typename scalar_t, typename accscalar_t, int depth, typename Op>
+__global__ void multi_tensor_apply_kernel(TensorListMetadata<depth> tl, Op op) {
+  int tensor = tl.block_to_tensor[blockIdx.x];
+  int64_t start = tl.block_to_chunk[blockIdx.x] * kMultiTensorChunkSize;
+  int64_t n = tl.sizes[tensor] - start;
+  if (n > kMultiTensorChunkSize) {
+    n = kMultiTensorChunkSize;
+  }
+
+  scalar_t* ptrs[depth];
+#pragma unroll
+  for (int d = 0; d < depth; d++) {
+    ptrs[d] = static_cast<scalar_t*>(tl.addresses[d][tensor]) + start;
+  }
+
+  for (int64_t i = threadIdx.x; i < n; i += blockDim.x) {
+    accscalar_t v[depth];
+#pragma unroll
+    for (int d = 0; d < depth; d++) {
+      v[d] = scalar_cast<accscalar_t>(ptrs[d][i]);
+    }
+    op(v);
+#pragma unroll
+    for (int d = 1; d < depth; d++) {
+      ptrs[d][i] = scalar_cast<scalar_t>(v[d]);
+    }
+  }
+}
+
+// lists must have depth lists of contiguous tensors, the tensors at one
+// index having the same number of elements
+template <typename scalar_t, typename accscalar_t, int depth, typename Op>
+void multi_tensor_apply(ArrayRef<TensorList> lists, const Op& op) {
+  static_assert(depth >= 1 && depth <= 5, "multi_tensor_apply supports 1 to 5 lists");
+  AT_ASSERT(lists.size() == depth);
+  constexpr int max_tensors = kMultiTensorMaxTensors[depth - 1];
+  cudaStream_t stream = globalContext().getCurrentCUDAStream();
+
+  TensorListMetadata<depth> tl;
+  int num_tensors = 0;
+  int num_blocks = 0;
+  auto launch = [&] {
+    multi_tensor_apply_kernel<scalar_t, accscalar_t, depth, Op>
+        <<<num_blocks, kMultiTensorBlockSize, 0, stream>>>(tl, op);
+    num_blocks = 0;
+  };
+
+  for (size_t t = 0; t < lists[0].size(); t++) {
+    int64_t numel = lists[0][t].numel();
+    if (numel == 0) {
+      continue;
+    }
+    for (int d = 0; d < depth; d++) {
+      tl.addresses[d][num_tensors] = lists[d][t].data_ptr();
+    }
+    tl.sizes[num_tensors] = numel;
+    num_tensors++;
+
+    int64_t chunks = (numel + kMultiTensorChunkSize - 1) / kMultiTensorChunkSize;
+    for (int64_t c = 0; c < chunks; c++) {
+      tl.block_to_tensor[num_blocks] = num_tensors - 1;
+      tl.block_to_chunk[num_blocks] = c;
+      num_blocks++;
+
+      bool last_chunk = (c == chunks - 1);
+      if (num_blocks == kMultiTensorMaxBlocks || (last_chunk && num_tensors == max_tensors)) {
+        launch();
+        if (last_chunk) {
+          num_tensors = 0;
+        } else {
+          // The rest of the tensor's chunks go in the next batch
+          for (int d = 0; d < depth; d++) {
+            tl.addresses[d][0] = tl.addresses[d][num_tensors - 1];
+          }
+          tl.sizes[0] = tl.sizes[num_tensors - 1];
+          num_tensors = 1;
+        }
+      }
+    }
+  }
+  if (num_blocks > 0) {
+    launch();
+  }
+  THCudaCheck(cudaGetLastError());
+}
+
+}} // namespace at::native
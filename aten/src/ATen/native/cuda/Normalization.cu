@@ -0,0 +1,384 @@
+#include "ATen/ATen.h"
+#include "ATen/NativeFunctions.h"
+#include <THC/THCDeviceUtils.cuh>
+#include <THC/THCNumerics.cuh>
+
+#include "ATen/AccumulateType.h"
+#include "ATen/cuda/CUDATypeConversion.cuh"
+#include "ATen/native/cuda/Reduce.cuh"
+
+#include <algorithm>
+#include <cmath>
+#include <tuple>
+
+namespace at {
+namespace native {
+
+namespace {
+
+// The layer norm of (M, N) inputs and the group norm of (N, C, HxW) inputs
+// are both computed as: per row of D elements, mean and rstd (a Welford
+// reduce_slices over the rows); then per element, an affine transform whose parameter (gamma / beta
+// index) is p = (idx / inner) % P, i.e. D = P = N and inner = 1 for the layer
+// norm and D = C / group * HxW, P = C and inner = HxW for the group norm.
+
+constexpr int kNumThreads = 256;
+
+// A pair of sums, e.g. sum(dY * gamma * X) and sum(dY * gamma)
+template <typename acc_t>
+struct SumPair {
+  acc_t first;
+  acc_t second;
+};
+
+template <typename acc_t>
+struct SumPairOps {
+  __device__ __forceinline__ SumPair<acc_t> identity() const {
+    return {0, 0};
+  }
+  __device__ __forceinline__ SumPair<acc_t> combine(
+      SumPair<acc_t> a, SumPair<acc_t> b) const {
+    return {a.first + b.first, a.second + b.second};
+  }
+  __device__ __forceinline__ SumPair<acc_t> shfl_down(
+      SumPair<acc_t> a, int offset) const {
+    return {WARP_SHFL_DOWN(a.first, offset), WARP_SHFL_DOWN(a.second, offset)};
+  }
+};
+
+// mean and rstd of each row, from their Welford reduction
+template <typename acc_t>
+struct MomentsWriter {
+  acc_t eps;
+  acc_t* mean;
+  acc_t* rstd;
+
+  __device__ __forceinline__ void operator()(int64_t i, WelfordData<acc_t> val) const {
+    acc_t var = val.n > 0 ? val.m2 / val.n : acc_t(0);
+    var = var > 0 ? var : acc_t(0);
+    mean[i] = val.mean;
+    rstd[i] = THCNumerics<acc_t>::rsqrt(var + eps);
+  }
+};
+
+// Mean and biased variance of each channel of a batch norm input
+template <typename T, typename acc_t>
+struct BatchNormStatsWriter {
+  T* mean;
+  T* var;
+
+  __device__ __forceinline__ void operator()(int64_t c, WelfordData<acc_t> val) const {
+    mean[c] = ScalarConvert<acc_t, T>::to(val.mean);
+    var[c] = ScalarConvert<acc_t, T>::to(val.m2 / val.n);
+  }
+};
+
+// Y = (X - mean) * rstd * gamma + beta, elementwise
+template <typename T, typename acc_t>
+__global__ void NormAffineCUDAKernel(
+    int64_t total, int64_t D, int64_t inner, int64_t P, const T* X,
+    const acc_t* mean, const acc_t* rstd, const T* gamma, const T* beta, T* Y) {
+  for (int64_t idx = blockIdx.x * blockDim.x + threadIdx.x; idx < total;
+       idx += blockDim.x * gridDim.x) {
+    const int64_t i = idx / D;
+    const int64_t p = (idx / inner) % P;
+    acc_t y = (ScalarConvert<T, acc_t>::to(X[idx]) - mean[i]) * rstd[i];
+    if (gamma != nullptr) {
+      y *= ScalarConvert<T, acc_t>::to(gamma[p]);
+    }
+    if (beta != nullptr) {
+      y += ScalarConvert<T, acc_t>::to(beta[p]);
+    }
+    Y[idx] = ScalarConvert<acc_t, T>::to(y);
+  }
+}
+
+// One block per row.  With g = dY * gamma, ds = sum(g * X) and db = sum(g)
+// over the D elements of the row:
+//
+//   dX = rstd * g + b * X + c
+//   b = (db * mean - ds) * rstd^3 / D
+//   c = -b * mean - db * rstd / D
+template <typename T, typename acc_t>
+__global__ void InputGradientCUDAKernel(
+    int64_t D, int64_t inner, int64_t P, const T* dY, const T* X,
+    const acc_t* mean, const acc_t* rstd, const T* gamma, T* dX) {
+  const int64_t i = blockIdx.x;
+  SumPair<acc_t> sums = {0, 0};
+  for (int64_t j = threadIdx.x; j < D; j += blockDim.x) {
+    const int64_t idx = i * D + j;
+    acc_t g = ScalarConvert<T, acc_t>::to(dY[idx]);
+    if (gamma != nullptr) {
+      g *= ScalarConvert<T, acc_t>::to(gamma[(idx / inner) % P]);
+    }
+    sums.first += g * ScalarConvert<T, acc_t>::to(X[idx]);
+    sums.second += g;
+  }
+  sums = block_reduce(sums, SumPairOps<acc_t>());
+  const acc_t scale = acc_t(1) / D;
+  const acc_t r = rstd[i];
+  const acc_t b = (sums.second * mean[i] - sums.first) * r * r * r * scale;
+  const acc_t c = -b * mean[i] - sums.second * r * scale;
+  for (int64_t j = threadIdx.x; j < D; j += blockDim.x) {
+    const int64_t idx = i * D + j;
+    acc_t g = ScalarConvert<T, acc_t>::to(dY[idx]);
+    if (gamma != nullptr) {
+      g *= ScalarConvert<T, acc_t>::to(gamma[(idx / inner) % P]);
+    }
+    dX[idx] = ScalarConvert<acc_t, T>::to(
+        r * g + b * ScalarConvert<T, acc_t>::to(X[idx]) + c);
+  }
+}
+
+// Layer norm: one thread per column, so that the loads of a warp over the
+// rows are coalesced
+template <typename T, typename acc_t>
+__global__ void LayerNormParamGradientCUDAKernel(
+    int64_t M, int64_t N, const T* dY, const T* X, const acc_t* mean,
+    const acc_t* rstd, T* dgamma, T* dbeta) {
+  const int64_t j = blockIdx.x * blockDim.x + threadIdx.x;
+  if (j >= N) {
+    return;
+  }
+  acc_t dg = 0, db = 0;
+  for (int64_t i = 0; i < M; i++) {
+    acc_t dy = ScalarConvert<T, acc_t>::to(dY[i * N + j]);
+    dg += dy * (ScalarConvert<T, acc_t>::to(X[i * N + j]) - mean[i]) * rstd[i];
+    db += dy;
+  }
+  if (dgamma != nullptr) {
+    dgamma[j] = ScalarConvert<acc_t, T>::to(dg);
+  }
+  if (dbeta != nullptr) {
+    dbeta[j] = ScalarConvert<acc_t, T>::to(db);
+  }
+}
+
+// Group norm: one block per channel, reducing over the samples and HxW
+template <typename T, typename acc_t>
+__global__ void GroupNormParamGradientCUDAKernel(
+    int64_t N, int64_t C, int64_t HxW, int64_t group, const T* dY, const T* X,
+    const acc_t* mean, const acc_t* rstd, T* dgamma, T* dbeta) {
+  const int64_t c = blockIdx.x;
+  const int64_t g = c / (C / group);
+  SumPair<acc_t> sums = {0, 0};
+  for (int64_t k = threadIdx.x; k < N * HxW; k += blockDim.x) {
+    const int64_t n = k / HxW;
+    const int64_t idx = (n * C + c) * HxW + k % HxW;
+    const int64_t i = n * group + g;
+    acc_t dy = ScalarConvert<T, acc_t>::to(dY[idx]);
+    sums.first += dy * (ScalarConvert<T, acc_t>::to(X[idx]) - mean[i]) * rstd[i];
+    sums.second += dy;
+  }
+  sums = block_reduce(sums, SumPairOps<acc_t>());
+  if (threadIdx.x == 0) {
+    if (dgamma != nullptr) {
+      dgamma[c] = ScalarConvert<acc_t, T>::to(sums.first);
+    }
+    if (dbeta != nullptr) {
+      dbeta[c] = ScalarConvert<acc_t, T>::to(sums.second);
+    }
+  }
+}
+
+inline int64_t elementwise_blocks(int64_t total) {
+  return std::min<int64_t>((total + kNumThreads - 1) / kNumThreads, 65535);
+}
+
+// mean and rstd are kept in the accumulation type, i.e. float for half inputs
+Type& moments_type(const Tensor& input) {
+  return input.type().scalarType() == kHalf ? input.type().toScalarType(kFloat)
+                                            : input.type();
+}
+
+std::tuple<Tensor, Tensor, Tensor> norm_forward_cuda(
+    const Tensor& input_, const Tensor& weight_, const Tensor& bias_,
+    int64_t rows, int64_t D, int64_t inner, int64_t P, double eps) {
+  auto input = input_.contiguous();
+  auto weight = weight_.defined() ? weight_.contiguous() : weight_;
+  auto bias = bias_.defined() ? bias_.contiguous() : bias_;
+  auto output = at::empty_like(input);
+  auto mean = moments_type(input).tensor({rows});
+  auto rstd = moments_type(input).tensor({rows});
+  const int64_t total = rows * D;
+  if (total == 0) {
+    return std::make_tuple(output, mean.fill_(0), rstd.fill_(0));
+  }
+  cudaStream_t stream = globalContext().getCurrentCUDAStream();
+  AT_DISPATCH_FLOATING_TYPES_AND_HALF(input.type(), "norm_forward_cuda", [&] {
+    using cuda_scalar_t = cuda::type<scalar_t>;
+    using accscalar_t = acc_type<cuda_scalar_t, true>;
+    auto weight_data = weight.defined() ? weight.data<cuda_scalar_t>() : nullptr;
+    auto bias_data = bias.defined() ? bias.data<cuda_scalar_t>() : nullptr;
+    reduce_slices<cuda_scalar_t, WelfordData<accscalar_t>>(
+        input, 1, rows, D, WelfordOps<cuda_scalar_t, accscalar_t>(),
+        MomentsWriter<accscalar_t>{static_cast<accscalar_t>(eps),
+                                   mean.data<accscalar_t>(), rstd.data<accscalar_t>()});
+    NormAffineCUDAKernel<cuda_scalar_t, accscalar_t>
+      <<<elementwise_blocks(total), kNumThreads, 0, stream>>>(
+        total, D, inner, P, input.data<cuda_scalar_t>(),
+        mean.data<accscalar_t>(), rstd.data<accscalar_t>(),
+        weight_data, bias_data, output.data<cuda_scalar_t>());
+  });
+  THCudaCheck(cudaGetLastError());
+  return std::make_tuple(output, mean, rstd);
+}
+
+// The layer norm normalizes the input as M rows of N elements, N being the
+// number of elements of normalized_shape
+std::tuple<int64_t, int64_t> layer_norm_rows_and_cols(
+    const Tensor& input, IntList normalized_shape) {
+  int64_t M = 1, N = 1;
+  int64_t axis = input.dim() - normalized_shape.size();
+  for (int64_t i = 0; i < input.dim(); i++) {
+    (i < axis ? M : N) *= input.size(i);
+  }
+  return std::make_tuple(M, N);
+}
+
+// Gradient of the input only; the parameter gradients differ between the
+// layer and the group norm
+Tensor norm_input_backward_cuda(
+    const Tensor& grad_out, const Tensor& input, const Tensor& mean,
+    const Tensor& rstd, const Tensor& weight, int64_t rows, int64_t D,
+    int64_t inner, int64_t P) {
+  auto grad_input = at::empty_like(input);
+  if (rows * D == 0) {
+    return grad_input;
+  }
+  cudaStream_t stream = globalContext().getCurrentCUDAStream();
+  AT_DISPATCH_FLOATING_TYPES_AND_HALF(input.type(), "norm_input_backward_cuda", [&] {
+    using cuda_scalar_t = cuda::type<scalar_t>;
+    using accscalar_t = acc_type<cuda_scalar_t, true>;
+    auto weight_data = weight.defined() ? weight.data<cuda_scalar_t>() : nullptr;
+    InputGradientCUDAKernel<cuda_scalar_t, accscalar_t>
+      <<<rows, kNumThreads, 0, stream>>>(
+        D, inner, P, grad_out.data<cuda_scalar_t>(), input.data<cuda_scalar_t>(),
+        mean.data<accscalar_t>(), rstd.data<accscalar_t>(), weight_data,
+        grad_input.data<cuda_scalar_t>());
+  });
+  THCudaCheck(cudaGetLastError());
+  return grad_input;
+}
+
+} // namespace
+
+std::tuple<Tensor, Tensor, Tensor> layer_norm_cuda(
+    const Tensor& input, IntList normalized_shape, const Tensor& weight,
+    const Tensor& bias, double eps) {
+  int64_t M, N;
+  std::tie(M, N) = layer_norm_rows_and_cols(input, normalized_shape);
+  return norm_forward_cuda(input, weight, bias, M, N, 1, N, eps);
+}
+
+std::tuple<Tensor, Tensor, Tensor> layer_norm_backward_cuda(
+    const Tensor& grad_out_, const Tensor& input_, IntList normalized_shape,
+    const Tensor& mean_, const Tensor& rstd_, const Tensor& weight_,
+    std::array<bool,3> output_mask) {
+  int64_t M, N;
+  std::tie(M, N) = layer_norm_rows_and_cols(input_, normalized_shape);
+  auto grad_out = grad_out_.contiguous();
+  auto input = input_.contiguous();
+  auto mean = mean_.contiguous();
+  auto rstd = rstd_.contiguous();
+  auto weight = weight_.defined() ? weight_.contiguous() : weight_;
+  Tensor grad_input, grad_weight, grad_bias;
+  if (output_mask[0]) {
+    grad_input = norm_input_backward_cuda(grad_out, input, mean, rstd, weight,
+                                          M, N, 1, N);
+  }
+  if (output_mask[1]) {
+    grad_weight = input.type().tensor(normalized_shape);
+  }
+  if (output_mask[2]) {
+    grad_bias = input.type().tensor(normalized_shape);
+  }
+  if ((output_mask[1] || output_mask[2]) && N > 0) {
+    cudaStream_t stream = globalContext().getCurrentCUDAStream();
+    AT_DISPATCH_FLOATING_TYPES_AND_HALF(input.type(), "layer_norm_backward_cuda", [&] {
+      using cuda_scalar_t = cuda::type<scalar_t>;
+      using accscalar_t = acc_type<cuda_scalar_t, true>;
+      LayerNormParamGradientCUDAKernel<cuda_scalar_t, accscalar_t>
+        <<<(N + kNumThreads - 1) / kNumThreads, kNumThreads, 0, stream>>>(
+          M, N, grad_out.data<cuda_scalar_t>(), input.data<cuda_scalar_t>(),
+          mean.data<accscalar_t>(), rstd.data<accscalar_t>(),
+          output_mask[1] ? grad_weight.data<cuda_scalar_t>() : nullptr,
+          output_mask[2] ? grad_bias.data<cuda_scalar_t>() : nullptr);
+    });
+    THCudaCheck(cudaGetLastError());
+  }
+  return std::make_tuple(grad_input, grad_weight, grad_bias);
+}
+
+std::tuple<Tensor, Tensor, Tensor> group_norm_cuda(
+    const Tensor& input, const Tensor& weight, const Tensor& bias,
+    int64_t N, int64_t C, int64_t HxW, int64_t group, double eps) {
+  return norm_forward_cuda(input, weight, bias, N * group, C / group * HxW,
+                           HxW, C, eps);
+}
+
+std::tuple<Tensor, Tensor, Tensor> group_norm_backward_cuda(
+    const Tensor& grad_out_, const Tensor& input_, const Tensor& mean_,
+    const Tensor& rstd_, const Tensor& weight_, int64_t N, int64_t C,
+    int64_t HxW, int64_t group, std::array<bool,3> output_mask) {
+  auto grad_out = grad_out_.contiguous();
+  auto input = input_.contiguous();
+  auto mean = mean_.contiguous();
+  auto rstd = rstd_.contiguous();
+  auto weight = weight_.defined() ? weight_.contiguous() : weight_;
+  Tensor grad_input, grad_weight, grad_bias;
+  if (output_mask[0]) {
+    grad_input = norm_input_backward_cuda(grad_out, input, mean, rstd, weight,
+                                          N * group, C / group * HxW, HxW, C);
+  }
+  if (output_mask[1]) {
+    grad_weight = input.type().tensor({C});
+  }
+  if (output_mask[2]) {
+    grad_bias = input.type().tensor({C});
+  }
+  if ((output_mask[1] || output_mask[2]) && C > 0) {
+    cudaStream_t stream = globalContext().getCurrentCUDAStream();
+    AT_DISPATCH_FLOATING_TYPES_AND_HALF(input.type(), "group_norm_backward_cuda", [&] {
+      using cuda_scalar_t = cuda::type<scalar_t>;
+      using accscalar_t = acc_type<cuda_scalar_t, true>;
+      GroupNormParamGradientCUDAKernel<cuda_scalar_t, accscalar_t>
+        <<<C, kNumThreads, 0, stream>>>(
+          N, C, HxW, group, grad_out.data<cuda_scalar_t>(),
+          input.data<cuda_scalar_t>(), mean.data<accscalar_t>(),
+          rstd.data<accscalar_t>(),
+          output_mask[1] ? grad_weight.data<cuda_scalar_t>() : nullptr,
+          output_mask[2] ? grad_bias.data<cuda_scalar_t>() : nullptr);
+    });
+    THCudaCheck(cudaGetLastError());
+  }
+  return std::make_tuple(grad_input, grad_weight, grad_bias);
+}
+
+// One pass over the (N, C, HxW) input, without the transposed copy of the
+// CPU version
+std::tuple<Tensor, Tensor> _batch_norm_stats_cuda(const Tensor& self) {
+  AT_CHECK(self.dim() >= 2, "_batch_norm_stats: expected an input with at least 2 dimensions, got ",
+           self.dim());
+  auto input = self.contiguous();
+  const int64_t N = input.size(0);
+  const int64_t C = input.size(1);
+  auto mean = input.type().tensor({C});
+  auto var = input.type().tensor({C});
+  if (input.numel() == 0) {
+    return std::make_tuple(mean.fill_(NAN), var.fill_(NAN));
+  }
+  const int64_t HxW = input.numel() / (N * C);
+  AT_DISPATCH_FLOATING_TYPES_AND_HALF(input.type(), "_batch_norm_stats_cuda", [&] {
+    using cuda_scalar_t = cuda::type<scalar_t>;
+    using accscalar_t = acc_type<cuda_scalar_t, true>;
+    reduce_slices<cuda_scalar_t, WelfordData<accscalar_t>>(
+        input, N, C, HxW, WelfordOps<cuda_scalar_t, accscalar_t>(),
+        BatchNormStatsWriter<cuda_scalar_t, accscalar_t>{
+            mean.data<cuda_scalar_t>(), var.data<cuda_scalar_t>()});
+  });
+  return std::make_tuple(mean, var);
+}
+
+} // at::native
+} // at
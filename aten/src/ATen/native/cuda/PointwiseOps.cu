@@ -0,0 +1,115 @@
+#include "ATen/ATen.h"
+#include "ATen/AccumulateType.h"
+#include "ATen/Dispatch.h"
+#include "ATen/ExpandUtils.h"
+#include "ATen/NativeFunctions.h"
+#include "ATen/cuda/CUDATypeConversion.cuh"
+#include "ATen/native/TensorIterator.h"
+#include "ATen/native/cuda/Loops.cuh"
+
+#include <tuple>
+
+// CUDA versions of PointwiseOps.cpp on the elementwise loops of Loops.cuh.
+// As on the CPU, integral types, sparse arguments and mismatched types or
+// devices are forwarded to THC.
+
+namespace at { namespace native {
+
+static bool can_use_pointwise_kernel(
+    const Tensor& self,
+    std::initializer_list<std::reference_wrapper<const Tensor>> others) {
+  if (!isFloatingType(self.type().scalarType())) {
+    return false;
+  }
+  for (const Tensor& other : others) {
+    if (other.is_sparse() || other.type() != self.type()
+        || other.get_device() != self.get_device()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static void lerp_kernel_cuda(TensorIterator& iter, Scalar weight) {
+  AT_DISPATCH_FLOATING_TYPES_AND_HALF(iter.type(), "lerp", [&] {
+    using cuda_scalar_t = cuda::type<scalar_t>;
+    using accscalar_t = acc_type<cuda_scalar_t, true>;
+    auto w = weight.to<accscalar_t>();
+    gpu_binary_kernel<cuda_scalar_t, accscalar_t>(
+        iter, [w] __device__ (accscalar_t a, accscalar_t b) { return a + w * (b - a); });
+  });
+}
+
+static void addcmul_kernel_cuda(TensorIterator& iter, Scalar value) {
+  AT_DISPATCH_FLOATING_TYPES_AND_HALF(iter.type(), "addcmul", [&] {
+    using cuda_scalar_t = cuda::type<scalar_t>;
+    using accscalar_t = acc_type<cuda_scalar_t, true>;
+    auto v = value.to<accscalar_t>();
+    gpu_ternary_kernel<cuda_scalar_t, accscalar_t>(
+        iter, [v] __device__ (accscalar_t a, accscalar_t b, accscalar_t c) {
+          return a + v * b * c;
+        });
+  });
+}
+
+static void addcdiv_kernel_cuda(TensorIterator& iter, Scalar value) {
+  AT_DISPATCH_FLOATING_TYPES_AND_HALF(iter.type(), "addcdiv", [&] {
+    using cuda_scalar_t = cuda::type<scalar_t>;
+    using accscalar_t = acc_type<cuda_scalar_t, true>;
+    auto v = value.to<accscalar_t>();
+    gpu_ternary_kernel<cuda_scalar_t, accscalar_t>(
+        iter, [v] __device__ (accscalar_t a, accscalar_t b, accscalar_t c) {
+          return a + v * b / c;
+        });
+  });
+}
+
+Tensor& _lerp__cuda(Tensor& self, const Tensor& end, Scalar weight) {
+  if (!can_use_pointwise_kernel(self, {end})) {
+    return self._th_lerp_(end, weight);
+  }
+  Tensor b_end;
+  std::tie(b_end) = expand_inplace(self, end, "lerp_");
+  auto iter = TensorIterator::binary_op(self, self, b_end);
+  lerp_kernel_cuda(iter, weight);
+  return self;
+}
+
+Tensor& _lerp_out_cuda(Tensor& result, const Tensor& self, const Tensor& end, Scalar weight) {
+  if (!can_use_pointwise_kernel(result, {self, end})) {
+    return at::_th_lerp_out(result, self, end, weight);
+  }
+  auto iter = TensorIterator::binary_op(result, self, end);
+  lerp_kernel_cuda(iter, weight);
+  return result;
+}
+
+#define IMPLEMENT_POINTWISE_OP_CUDA(op)                                       \
+  Tensor& _##op##__cuda(                                                      \
+      Tensor& self, const Tensor& tensor1, const Tensor& tensor2,             \
+      Scalar value) {                                                         \
+    if (!can_use_pointwise_kernel(self, {tensor1, tensor2})) {                \
+      return self._th_##op##_(tensor1, tensor2, value);                       \
+    }                                                                         \
+    Tensor b_tensor1, b_tensor2;                                              \
+    std::tie(b_tensor1, b_tensor2) =                                          \
+        expand_inplace(self, tensor1, tensor2, #op "_");                      \
+    auto iter = TensorIterator::ternary_op(self, self, b_tensor1, b_tensor2); \
+    op##_kernel_cuda(iter, value);                                            \
+    return self;                                                              \
+  }                                                                           \
+  Tensor& _##op##_out_cuda(                                                   \
+      Tensor& result, const Tensor& self, const Tensor& tensor1,              \
+      const Tensor& tensor2, Scalar value) {                                  \
+    if (!can_use_pointwise_kernel(result, {self, tensor1, tensor2})) {        \
+      return at::_th_##op##_out(result, self, tensor1, tensor2, value);       \
+    }                                                                         \
+    auto iter = TensorIterator::ternary_op(result, self, tensor1, tensor2);   \
+    op##_kernel_cuda(iter, value);                                            \
+    return result;                                                            \
+  }
+
+IMPLEMENT_POINTWISE_OP_CUDA(addcmul)
+IMPLEMENT_POINTWISE_OP_CUDA(addcdiv)
+
+}} // namespace at::native
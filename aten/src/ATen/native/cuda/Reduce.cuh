@@ -0,0 +1,271 @@
+#pragma once
+
+#include "ATen/ATen.h"
+#include "ATen/native/cuda/MemoryAccess.cuh"
+
+#include <THC/THCDeviceUtils.cuh>
+#include <THC/THCGeneral.h>
+#include <THC/THCNumerics.cuh>
+
+#include <algorithm>
+#include <cstdint>
+
+// Building blocks of the CUDA reductions, and reduce_slices, which reduces
+// the slices of a contiguous tensor along a dimension in one launch, or two
+// for large slices.
+//
+// A reduction is described by its Ops, over an accumulator acc_t:
+//
+//   acc_t identity() const                 the reduction of no element
+//   acc_t reduce(acc_t acc, scalar_t x, int64_t i) const
+//                                          folds in x, the element i of the
+//                                          slice
+//   acc_t combine(acc_t a, acc_t b) const  merges two partial reductions
+//   acc_t shfl_down(acc_t a, int offset) const
+//                                          WARP_SHFL_DOWN of each member
+//
+// An accumulator with several members gives several outputs in one pass
+// over the input, like the mean and variance of WelfordOps, or the max and
+// sum of exponentials of MaxSumExpOps.
+
+namespace at { namespace native {
+
+constexpr int kReduceWarpSize = 32;
+constexpr int kReduceMaxThreads = 1024;
+// Elements per vectorized load, i.e. a float4 for floats
+constexpr int kReduceVecSize = 4;
+
+// Mean and sum of squared deviations (m2) of n elements
+template <typename acc_t>
+struct WelfordData {
+  acc_t mean;
+  acc_t m2;
+  acc_t n;
+};
+
+template <typename scalar_t, typename acc_t>
+struct WelfordOps {
+  __device__ __forceinline__ WelfordData<acc_t> identity() const {
+    return {0, 0, 0};
+  }
+  __device__ __forceinline__ WelfordData<acc_t> reduce(
+      WelfordData<acc_t> acc, scalar_t x, int64_t /*i*/) const {
+    acc_t v = ScalarConvert<scalar_t, acc_t>::to(x);
+    acc.n += 1;
+    acc_t delta = v - acc.mean;
+    acc.mean += delta / acc.n;
+    acc.m2 += delta * (v - acc.mean);
+    return acc;
+  }
+  __device__ __forceinline__ WelfordData<acc_t> combine(
+      WelfordData<acc_t> a, WelfordData<acc_t> b) const {
+    acc_t n = a.n + b.n;
+    if (n == 0) {
+      return a;
+    }
+    acc_t delta = b.mean - a.mean;
+    acc_t ratio = b.n / n;
+    return {a.mean + delta * ratio, a.m2 + b.m2 + delta * delta * a.n * ratio, n};
+  }
+  __device__ __forceinline__ WelfordData<acc_t> shfl_down(
+      WelfordData<acc_t> a, int offset) const {
+    return {WARP_SHFL_DOWN(a.mean, offset), WARP_SHFL_DOWN(a.m2, offset),
+            WARP_SHFL_DOWN(a.n, offset)};
+  }
+};
+
+// max(x) and sum(exp(x - max(x))), as needed by the softmax, in one pass:
+// the sum is rescaled whenever the max grows
+template <typename acc_t>
+struct MaxSumExp {
+  acc_t max;
+  acc_t sum;
+};
+
+template <typename scalar_t, typename acc_t>
+struct MaxSumExpOps {
+  __device__ __forceinline__ MaxSumExp<acc_t> identity() const {
+    return {-THCNumerics<acc_t>::max(), 0};
+  }
+  __device__ __forceinline__ MaxSumExp<acc_t> reduce(
+      MaxSumExp<acc_t> acc, scalar_t x, int64_t /*i*/) const {
+    acc_t v = ScalarConvert<scalar_t, acc_t>::to(x);
+    if (v > acc.max) {
+      acc.sum = acc.sum * THCNumerics<acc_t>::exp(acc.max - v) + acc_t(1);
+      acc.max = v;
+    } else {
+      acc.sum += THCNumerics<acc_t>::exp(v - acc.max);
+    }
+    return acc;
+  }
+  __device__ __forceinline__ MaxSumExp<acc_t> combine(
+      MaxSumExp<acc_t> a, MaxSumExp<acc_t> b) const {
+    acc_t max = a.max < b.max ? b.max : a.max;
+    return {max, a.sum * THCNumerics<acc_t>::exp(a.max - max) +
+                 b.sum * THCNumerics<acc_t>::exp(b.max - max)};
+  }
+  __device__ __forceinline__ MaxSumExp<acc_t> shfl_down(
+      MaxSumExp<acc_t> a, int offset) const {
+    return {WARP_SHFL_DOWN(a.max, offset), WARP_SHFL_DOWN(a.sum, offset)};
+  }
+};
+
+// Reduces val over the threads of the block, blockDim.x being a multiple of
+// the warp size: within each warp with shuffles, then across the warps
+// through shared memory. The result is returned to every thread.
+template <typename acc_t, typename Ops>
+__device__ acc_t block_reduce(acc_t val, const Ops& ops) {
+  __shared__ acc_t shared[kReduceMaxThreads / kReduceWarpSize];
+  const int lane = threadIdx.x % kReduceWarpSize;
+  const int warp = threadIdx.x / kReduceWarpSize;
+  // shared may still be read from by a previous block_reduce
+  __syncthreads();
+  for (int offset = kReduceWarpSize / 2; offset > 0; offset /= 2) {
+    val = ops.combine(val, ops.shfl_down(val, offset));
+  }
+  if (lane == 0) {
+    shared[warp] = val;
+  }
+  __syncthreads();
+  if (warp == 0) {
+    val = lane < blockDim.x / kReduceWarpSize ? shared[lane] : ops.identity();
+    for (int offset = kReduceWarpSize / 2; offset > 0; offset /= 2) {
+      val = ops.combine(val, ops.shfl_down(val, offset));
+    }
+    if (lane == 0) {
+      shared[0] = val;
+    }
+  }
+  __syncthreads();
+  return shared[0];
+}
+
+// Folds the elements first, first + stride, ... of the n elements of data
+// into acc, the element i being passed to ops as i + index_offset. The
+// elements are loaded vec_size at a time, from the first one aligned for it.
+template <int vec_size, typename scalar_t, typename acc_t, typename Ops>
+__device__ __forceinline__ acc_t thread_reduce_contiguous(
+    const scalar_t* data, int64_t n, int64_t index_offset,
+    int64_t first, int64_t stride, acc_t acc, const Ops& ops) {
+  using vec_t = aligned_vector<scalar_t, vec_size>;
+  const int64_t misalignment =
+      (reinterpret_cast<uintptr_t>(data) / sizeof(scalar_t)) % vec_size;
+  int64_t head = misalignment == 0 ? 0 : vec_size - misalignment;
+  head = head < n ? head : n;
+  for (int64_t i = first; i < head; i += stride) {
+    acc = ops.reduce(acc, data[i], i + index_offset);
+  }
+  const vec_t* vecs = reinterpret_cast<const vec_t*>(data + head);
+  const int64_t num_vecs = (n - head) / vec_size;
+  for (int64_t v = first; v < num_vecs; v += stride) {
+    vec_t vals = vecs[v];
+    const int64_t i = head + v * vec_size + index_offset;
+#pragma unroll
+    for (int j = 0; j < vec_size; j++) {
+      acc = ops.reduce(acc, vals.val[j], i + j);
+    }
+  }
+  for (int64_t i = head + num_vecs * vec_size + first; i < n; i += stride) {
+    acc = ops.reduce(acc, data[i], i + index_offset);
+  }
+  return acc;
+}
+
+// Block (slice, split) reduces the split-th part of the slice. With a
+// single split, the result goes to writer, else to partials.
+template <typename scalar_t, typename acc_t, typename Ops, typename Writer>
+__global__ void reduce_slices_kernel(
+    const scalar_t* data, int64_t outer, int64_t num_slices, int64_t inner,
+    Ops ops, Writer writer, acc_t* partials) {
+  const int64_t slice = blockIdx.x;
+  const int64_t num_threads = static_cast<int64_t>(gridDim.y) * blockDim.x;
+  const int64_t tid = static_cast<int64_t>(blockIdx.y) * blockDim.x + threadIdx.x;
+  acc_t acc = ops.identity();
+  if (inner >= num_threads * kReduceVecSize) {
+    // Contiguous runs long enough for vectorized loads by every thread
+    for (int64_t o = 0; o < outer; o++) {
+      acc = thread_reduce_contiguous<kReduceVecSize>(
+          data + (o * num_slices + slice) * inner, inner, o * inner, tid, num_threads, acc, ops);
+    }
+  } else {
+    for (int64_t k = tid; k < outer * inner; k += num_threads) {
+      const int64_t o = k / inner;
+      acc = ops.reduce(acc, data[(o * num_slices + slice) * inner + k % inner], k);
+    }
+  }
+  acc = block_reduce(acc, ops);
+  if (threadIdx.x == 0) {
+    if (gridDim.y == 1) {
+      writer(slice, acc);
+    } else {
+      partials[slice * gridDim.y + blockIdx.y] = acc;
+    }
+  }
+}
+
+// Second pass of the split reductions: block slice combines its partials
+template <typename acc_t, typename Ops, typename Writer>
+__global__ void reduce_slices_combine_kernel(
+    const acc_t* partials, int num_splits, Ops ops, Writer writer) {
+  const int64_t slice = blockIdx.x;
+  acc_t acc = ops.identity();
+  for (int s = threadIdx.x; s < num_splits; s += blockDim.x) {
+    acc = ops.combine(acc, partials[slice * num_splits + s]);
+  }
+  acc = block_reduce(acc, ops);
+  if (threadIdx.x == 0) {
+    writer(slice, acc);
+  }
+}
+
+// Reduces input, contiguous and viewed as (outer, num_slices, inner), over
+// its outer and inner dimensions: writer(i, acc) is called, on the device,
+// with the reduction of each slice input[:, i, :]. For a dimension dim of an
+// n-d tensor, outer and inner are the products of the sizes before and after
+// dim; reductions over rows have outer = 1.
+//
+// When there are too few slices to fill the GPU and they are large, each is
+// split over several blocks, whose partial reductions are combined by a
+// second kernel.
+template <typename scalar_t, typename acc_t, typename Ops, typename Writer>
+void reduce_slices(const Tensor& input, int64_t outer, int64_t num_slices, int64_t inner,
+                   const Ops& ops, const Writer& writer) {
+  AT_ASSERT(input.is_contiguous() && input.numel() == outer * num_slices * inner);
+  if (num_slices == 0) {
+    return;
+  }
+  const int64_t slice_size = outer * inner;
+  int threads = kReduceWarpSize;
+  while (threads < 512 && threads * kReduceVecSize < slice_size) {
+    threads *= 2;
+  }
+  // Work for at least 64 elements per thread, and for about 4 blocks per SM
+  const int64_t sms = globalContext().getCurrentDeviceProperties()->multiProcessorCount;
+  int64_t splits = std::min<int64_t>(
+      (slice_size + threads * 64 - 1) / (threads * 64),
+      (4 * sms + num_slices - 1) / num_slices);
+  splits = std::max<int64_t>(1, std::min<int64_t>(splits, 1024));
+
+  const auto data = reinterpret_cast<const scalar_t*>(input.data_ptr());
+  cudaStream_t stream = globalContext().getCurrentCUDAStream();
+  dim3 grid(num_slices, splits);
+  if (splits == 1) {
+    reduce_slices_kernel<scalar_t, acc_t, Ops, Writer><<<grid, threads, 0, stream>>>(
+        data, outer, num_slices, inner, ops, writer, nullptr);
+  } else {
+    auto partials = input.type().toScalarType(kByte).tensor(
+        {static_cast<int64_t>(num_slices * splits * sizeof(acc_t))});
+    auto partials_data = reinterpret_cast<acc_t*>(partials.data_ptr());
+    reduce_slices_kernel<scalar_t, acc_t, Ops, Writer><<<grid, threads, 0, stream>>>(
+        data, outer, num_slices, inner, ops, writer, partials_data);
+    int combine_threads = kReduceWarpSize;
+    while (combine_threads < 256 && combine_threads < splits) {
+      combine_threads *= 2;
+    }
+    reduce_slices_combine_kernel<acc_t, Ops, Writer><<<num_slices, combine_threads, 0, stream>>>(
+        partials_data, static_cast<int>(splits), ops, writer);
+  }
+  THCudaCheck(cudaGetLastError());
+}
+
+}} // namespace at::native
@@ -0,0 +1,84 @@
+#include "ATen/ATen.h"
+#include "ATen/AccumulateType.h"
+#include "ATen/Dispatch.h"
+#include "ATen/NativeFunctions.h"
+#include "ATen/WrapDimUtils.h"
+#include "ATen/cuda/CUDATypeConversion.cuh"
+#include "ATen/native/cuda/Reduce.cuh"
+
+#include <THC/THCNumerics.cuh>
+
+#include <vector>
+
+namespace at { namespace native {
+
+namespace {
+
+// THC's var and std give 16 threads to each innermost row; rows at least
+// this long are better reduced by reduce_slices, which gives each row one
+// block, or several blocks when there are few rows
+constexpr int64_t kVarMinRowSize = 4096;
+
+template <typename T, typename acc_t>
+struct VarWriter {
+  T* out;
+  bool unbiased;
+  bool take_sqrt;
+
+  __device__ __forceinline__ void operator()(int64_t i, WelfordData<acc_t> val) const {
+    acc_t var = val.m2 / (unbiased ? val.n - 1 : val.n);
+    out[i] = ScalarConvert<acc_t, T>::to(take_sqrt ? THCNumerics<acc_t>::sqrt(var) : var);
+  }
+};
+
+bool use_row_var(const Tensor& result, const Tensor& self, int64_t dim) {
+  return result.type() == self.type() && self.is_contiguous() && self.dim() > 0
+      && dim == self.dim() - 1 && self.size(dim) >= kVarMinRowSize;
+}
+
+Tensor& row_var_out(Tensor& result, const Tensor& self, int64_t dim, bool unbiased,
+                    bool keepdim, bool take_sqrt) {
+  auto shape = self.sizes().vec();
+  if (keepdim) {
+    shape[dim] = 1;
+  } else {
+    shape.erase(shape.begin() + dim);
+  }
+  result.resize_(shape);
+  const bool contiguous = result.is_contiguous();
+  auto out = contiguous ? result : result.type().tensor(shape);
+  const int64_t row_size = self.size(dim);
+  AT_DISPATCH_FLOATING_TYPES_AND_HALF(self.type(), "row_var_out", [&] {
+    using cuda_scalar_t = cuda::type<scalar_t>;
+    using accscalar_t = acc_type<cuda_scalar_t, true>;
+    reduce_slices<cuda_scalar_t, WelfordData<accscalar_t>>(
+        self, 1, self.numel() / row_size, row_size, WelfordOps<cuda_scalar_t, accscalar_t>(),
+        VarWriter<cuda_scalar_t, accscalar_t>{out.data<cuda_scalar_t>(), unbiased, take_sqrt});
+  });
+  if (!contiguous) {
+    result.copy_(out);
+  }
+  return result;
+}
+
+} // namespace
+
+Tensor& _var_out_cuda(Tensor& result, const Tensor& self, int64_t dim,
+                      bool unbiased, bool keepdim) {
+  dim = maybe_wrap_dim(dim, self.dim());
+  if (use_row_var(result, self, dim)) {
+    return row_var_out(result, self, dim, unbiased, keepdim, /*take_sqrt=*/false);
+  }
+  return at::_th_var_out(result, self, dim, unbiased, keepdim);
+}
+
+Tensor& _std_out_cuda(Tensor& result, const Tensor& self, int64_t dim,
+                      bool unbiased, bool keepdim) {
+  dim = maybe_wrap_dim(dim, self.dim());
+  if (use_row_var(result, self, dim)) {
+    return row_var_out(result, self, dim, unbiased, keepdim, /*take_sqrt=*/true);
+  }
+  return at::_th_std_out(result, self, dim, unbiased, keepdim);
+}
+
+}} // namespace at::native
@@ -11,6 +11,7 @@
 #include "ATen/AccumulateType.h"
 #include "ATen/cuda/CUDATensorMethods.cuh"
 #include "ATen/cuda/CUDATypeConversion.cuh"
+#include "ATen/native/cuda/Reduce.cuh"
 
 
 namespace at {
@@ -284,14 +285,6 @@ __global__ void cunn_SpatialSoftMaxBackward(
 ////////////////////////////////////////////////////////////////////////////////
 
 
-template <typename T, typename AccumT>
-struct MaxFloat
-{
-  __device__ __forceinline__ AccumT operator()(AccumT max, T v) const {
-    return fmaxType(max, v);
-  }
-};
-
 template<typename T, typename AccumT>
 struct AddFloat
 {
@@ -300,19 +293,6 @@ struct AddFloat
   }
 };
 
-template<typename T, typename AccumT>
-struct SumExpFloat
-{
-  __device__ __forceinline__ SumExpFloat(AccumT v)
-    : max_k(v) {}
-
-  __device__ __forceinline__ AccumT operator()(AccumT sum, T v) const {
-    return sum + THCNumerics<AccumT>::exp(v - max_k);
-  }
-
-  const AccumT max_k;
-};
-
 template <template<typename> class Reduction, typename AccumT>
 __device__ __forceinline__ AccumT
 blockReduce(AccumT* smem, AccumT val,
@@ -393,26 +373,18 @@ template <int ILP, typename scalar_t, typename accscalar_t, template <typename,
 __global__ void
 cunn_SoftMaxForward(scalar_t *output, scalar_t *input, int classes)
 {
-  extern __shared__ unsigned char smem[];
-  auto sdata = reinterpret_cast<accscalar_t*>(smem);
   // forward pointers to batch[blockIdx.x]
   // each block handles a sample in the mini-batch
   input += blockIdx.x * classes;
   output += blockIdx.x * classes;
 
-  // find the max
-  accscalar_t threadMax = ilpReduce<MaxFloat, ILP, scalar_t, accscalar_t>(
-      input, classes, MaxFloat<scalar_t, accscalar_t>(), -THCNumerics<accscalar_t>::max());
-  accscalar_t max_k = blockReduce<Max, accscalar_t>(
-      sdata, threadMax, Max<accscalar_t>(), -THCNumerics<accscalar_t>::max());
-
-  // reduce all values
-  accscalar_t threadExp = ilpReduce<SumExpFloat, ILP, scalar_t, accscalar_t>(
-      input, classes, SumExpFloat<scalar_t, accscalar_t>(max_k), static_cast<accscalar_t>(0));
-  accscalar_t sumAll = blockReduce<Add, accscalar_t>(
-      sdata, threadExp, Add<accscalar_t>(), static_cast<accscalar_t>(0));
+  // the max and the sum of exp(input - max) in one pass, with vectorized loads
+  MaxSumExpOps<scalar_t, accscalar_t> ops;
+  MaxSumExp<accscalar_t> stats = thread_reduce_contiguous<kReduceVecSize>(
+      input, classes, 0, threadIdx.x, blockDim.x, ops.identity(), ops);
+  stats = block_reduce(stats, ops);
 
-  Epilogue<scalar_t, accscalar_t> epilogue(max_k, sumAll);
+  Epilogue<scalar_t, accscalar_t> epilogue(stats.max, stats.sum);
   int offset = threadIdx.x;
   int last = classes % (ILP * blockDim.x);
   for (; offset < classes - last; offset += blockDim.x * ILP) {
@@ -468,6 +440,130 @@ cunn_SoftMaxBackward(scalar_t *gradInput, scalar_t *output, scalar_t *gradOutput
     gradInput[offset] = epilogue(gradOutput[offset], output[offset]);
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// Fused log_softmax + nll_loss (cross entropy) of 2-D inputs
+////////////////////////////////////////////////////////////////////////////////
+// Each block handles a row. The rows are read once for the forward, which
+// reduces them with the online softmax of MaxSumExpOps, and once for the
+// backward; the (N, C) log-probabilities are never written.
+
+// max(x), sum(exp(x - max(x))) and sum(x), the latter for the label smoothing
+template <typename acc_t>
+struct CrossEntropyStats {
+  MaxSumExp<acc_t> softmax;
+  acc_t x_sum;
+};
+
+template <typename scalar_t, typename acc_t>
+struct CrossEntropyOps {
+  __device__ __forceinline__ CrossEntropyStats<acc_t> identity() const {
+    return {softmax_ops.identity(), 0};
+  }
+  __device__ __forceinline__ CrossEntropyStats<acc_t> reduce(
+      CrossEntropyStats<acc_t> acc, scalar_t x, int64_t i) const {
+    return {softmax_ops.reduce(acc.softmax, x, i),
+            acc.x_sum + ScalarConvert<scalar_t, acc_t>::to(x)};
+  }
+  __device__ __forceinline__ CrossEntropyStats<acc_t> combine(
+      CrossEntropyStats<acc_t> a, CrossEntropyStats<acc_t> b) const {
+    return {softmax_ops.combine(a.softmax, b.softmax), a.x_sum + b.x_sum};
+  }
+  __device__ __forceinline__ CrossEntropyStats<acc_t> shfl_down(
+      CrossEntropyStats<acc_t> a, int offset) const {
+    return {softmax_ops.shfl_down(a.softmax, offset), WARP_SHFL_DOWN(a.x_sum, offset)};
+  }
+
+  MaxSumExpOps<scalar_t, acc_t> softmax_ops;
+};
+
+template <typename scalar_t, typename accscalar_t>
+__global__ void
+cunn_CrossEntropyForward(scalar_t *losses, scalar_t *lse, scalar_t *row_weights,
+                         const scalar_t *input, const int64_t *target,
+                         const scalar_t *weight, int64_t ignore_index,
+                         accscalar_t label_smoothing, int classes)
+{
+  const int64_t row = blockIdx.x;
+  const int64_t t = target[row];
+  if (t == ignore_index) {
+    if (threadIdx.x == 0) {
+      losses[row] = lse[row] = row_weights[row] = ScalarConvert<int, scalar_t>::to(0);
+    }
+    return;
+  }
+  assert(t >= 0 && t < classes);
+  input += row * classes;
+
+  CrossEntropyOps<scalar_t, accscalar_t> ops;
+  CrossEntropyStats<accscalar_t> stats = thread_reduce_contiguous<kReduceVecSize>(
+      input, classes, 0, threadIdx.x, blockDim.x, ops.identity(), ops);
+  stats = block_reduce(stats, ops);
+
+  if (threadIdx.x == 0) {
+    accscalar_t row_lse = stats.softmax.max + THCNumerics<accscalar_t>::log(stats.softmax.sum);
+    accscalar_t w = weight != nullptr ? ScalarConvert<scalar_t, accscalar_t>::to(weight[t])
+                                      : accscalar_t(1);
+    accscalar_t nll = row_lse - ScalarConvert<scalar_t, accscalar_t>::to(input[t]);
+    if (label_smoothing != 0) {
+      nll = (1 - label_smoothing) * nll + label_smoothing * (row_lse - stats.x_sum / classes);
+    }
+    losses[row] = ScalarConvert<accscalar_t, scalar_t>::to(nll * w);
+    lse[row] = ScalarConvert<accscalar_t, scalar_t>::to(row_lse);
+    row_weights[row] = ScalarConvert<accscalar_t, scalar_t>::to(w);
+  }
+}
+
+// gradInput = (softmax(input) - (1 - eps) * onehot(target) - eps / classes)
+//             * weight[target] * gradLosses
+template <typename scalar_t, typename accscalar_t>
+__global__ void
+cunn_CrossEntropyBackward(scalar_t *gradInput, const scalar_t *gradLosses,
+                          const scalar_t *input, const int64_t *target,
+                          const scalar_t *weight, const scalar_t *lse,
+                          int64_t ignore_index, accscalar_t label_smoothing, int classes)
+{
+  const int64_t row = blockIdx.x;
+  const int64_t t = target[row];
+  gradInput += row * classes;
+  input += row * classes;
+  if (t == ignore_index) {
+    for (int j = threadIdx.x; j < classes; j += blockDim.x)
+      gradInput[j] = ScalarConvert<int, scalar_t>::to(0);
+    return;
+  }
+
+  accscalar_t scale = ScalarConvert<scalar_t, accscalar_t>::to(gradLosses[row]);
+  if (weight != nullptr)
+    scale *= ScalarConvert<scalar_t, accscalar_t>::to(weight[t]);
+  accscalar_t uniform = label_smoothing / classes * scale;
+  accscalar_t row_lse = ScalarConvert<scalar_t, accscalar_t>::to(lse[row]);
+  for (int j = threadIdx.x; j < classes; j += blockDim.x) {
+    accscalar_t x = ScalarConvert<scalar_t, accscalar_t>::to(input[j]);
+    accscalar_t g = THCNumerics<accscalar_t>::exp(x - row_lse) * scale - uniform;
+    if (j == t)
+      g -= (1 - label_smoothing) * scale;
+    gradInput[j] = ScalarConvert<accscalar_t, scalar_t>::to(g);
+  }
+}
+
+void check_log_softmax_nll_loss_args(const Tensor& self, const Tensor& target,
+                                     const Tensor& weight, double label_smoothing) {
+  AT_CHECK(self.dim() == 2, "log_softmax_nll_loss: expected 2-D input, got ", self.dim(), "-D");
+  AT_CHECK(target.dim() == 1 && target.size(0) == self.size(0),
+           "log_softmax_nll_loss: expected target of size [", self.size(0), "], got ", target.sizes());
+  AT_CHECK(!weight.defined() || weight.numel() == self.size(1),
+           "log_softmax_nll_loss: expected weight with ", self.size(1), " elements, got ", weight.numel());
+  AT_CHECK(label_smoothing >= 0 && label_smoothing <= 1,
+           "log_softmax_nll_loss: expected label_smoothing in [0, 1], got ", label_smoothing);
+}
+
+// total_weight, or 1 when every target is ignored, without synchronizing
+// with the device to read it
+Tensor nonzero_total_weight(const Tensor& total_weight) {
+  return total_weight + total_weight.eq(0).type_as(total_weight);
+}
+
+
 
 
 
@@ -498,7 +594,7 @@ Tensor host_softmax(const Tensor & input_, const int64_t dim_){
     using cuda_scalar_t = cuda::type<scalar_t>;
     using accscalar_t = acc_type<cuda_scalar_t, true>;
     cunn_SoftMaxForward<ILP, cuda_scalar_t, accscalar_t, Epilogue>
-      <<<grid, block, block.x * sizeof(accscalar_t), stream>>>(
+      <<<grid, block, 0, stream>>>(
         output.data<cuda_scalar_t>(), input.data<cuda_scalar_t>(), dim_size
     );
     });
@@ -596,6 +692,86 @@ Tensor softmax_backward_cuda(const Tensor &grad, const Tensor &output, int64_t d
   return host_softmax_backward<SoftMaxBackwardEpilogue>(tmp, output, dim);
 }
 
+std::tuple<Tensor, Tensor, Tensor> log_softmax_nll_loss_cuda(
+    const Tensor& self_, const Tensor& target_, const Tensor& weight_,
+    bool size_average, int64_t ignore_index, bool reduce, double label_smoothing) {
+  auto self = self_.contiguous();
+  auto target = target_.contiguous();
+  auto weight = weight_.defined() ? weight_.contiguous() : weight_;
+  check_log_softmax_nll_loss_args(self, target, weight, label_smoothing);
+  int64_t N = self.size(0);
+  int64_t C = self.size(1);
+  auto losses = self.type().tensor({N});
+  auto lse = self.type().tensor({N});
+  auto row_weights = self.type().tensor({N});
+  if (N > 0) {
+    cudaStream_t stream = globalContext().getCurrentCUDAStream();
+    dim3 grid(N);
+    dim3 block = SoftMax_getBlockSize(kReduceVecSize, C);
+    AT_DISPATCH_FLOATING_TYPES_AND_HALF(self.type(), "log_softmax_nll_loss", [&] {
+    using cuda_scalar_t = cuda::type<scalar_t>;
+    using accscalar_t = acc_type<cuda_scalar_t, true>;
+    cunn_CrossEntropyForward<cuda_scalar_t, accscalar_t>
+      <<<grid, block, 0, stream>>>(
+        losses.data<cuda_scalar_t>(), lse.data<cuda_scalar_t>(), row_weights.data<cuda_scalar_t>(),
+        self.data<cuda_scalar_t>(), target.data<int64_t>(),
+        weight.defined() ? weight.data<cuda_scalar_t>() : nullptr,
+        ignore_index, static_cast<accscalar_t>(label_smoothing), C
+    );
+    });
+    THCudaCheck(cudaGetLastError());
+  }
+  auto total_weight = row_weights.sum();
+  if (!reduce) {
+    return std::make_tuple(losses, lse, total_weight);
+  }
+  auto output = losses.sum();
+  if (size_average) {
+    output.div_(nonzero_total_weight(total_weight));
+  }
+  return std::make_tuple(output, lse, total_weight);
 }
+
+Tensor log_softmax_nll_loss_backward_cuda(
+    const Tensor& grad, const Tensor& self_, const Tensor& target_,
+    const Tensor& weight_, bool size_average, int64_t ignore_index, bool reduce,
+    double label_smoothing, const Tensor& logsumexp, const Tensor& total_weight) {
+  auto self = self_.contiguous();
+  auto target = target_.contiguous();
+  auto weight = weight_.defined() ? weight_.contiguous() : weight_;
+  auto lse = logsumexp.contiguous();
+  int64_t N = self.size(0);
+  int64_t C = self.size(1);
+  Tensor grad_losses;
+  if (reduce) {
+    grad_losses = grad.expand({N});
+    if (size_average) {
+      grad_losses = grad_losses / nonzero_total_weight(total_weight);
+    }
+  } else {
+    grad_losses = grad;
+  }
+  grad_losses = grad_losses.contiguous();
+  auto grad_input = at::empty_like(self);
+  if (N > 0) {
+    cudaStream_t stream = globalContext().getCurrentCUDAStream();
+    dim3 grid(N);
+    dim3 block = SoftMax_getBlockSize(kReduceVecSize, C);
+    AT_DISPATCH_FLOATING_TYPES_AND_HALF(self.type(), "log_softmax_nll_loss_backward", [&] {
+    using cuda_scalar_t = cuda::type<scalar_t>;
+    using accscalar_t = acc_type<cuda_scalar_t, true>;
+    cunn_CrossEntropyBackward<cuda_scalar_t, accscalar_t>
+      <<<grid, block, 0, stream>>>(
+        grad_input.data<cuda_scalar_t>(), grad_losses.data<cuda_scalar_t>(),
+        self.data<cuda_scalar_t>(), target.data<int64_t>(),
+        weight.defined() ? weight.data<cuda_scalar_t>() : nullptr,
+        lse.data<cuda_scalar_t>(), ignore_index, static_cast<accscalar_t>(label_smoothing), C
+    );
+    });
+    THCudaCheck(cudaGetLastError());
+  }
+  return grad_input;
 }
 
+}
+}
@@ -6,6 +6,7 @@
 #include "ATen/NativeFunctions.h"
 #include "ATen/native/SpectralOpsUtils.h"
 #include "ATen/native/cuda/CuFFTUtils.h"
+#include "ATen/cuda/CuFFTPlanCache.h"
 #include "ATen/cuda/CUDATensorMethods.cuh"
 #include "ATen/cuda/CUDATypeConversion.cuh"
 
@@ -21,6 +22,10 @@
 #include <cufft.h>
 #include <cufftXt.h>
 #include <cmath>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <vector>
 
 namespace at { namespace native {
 
@@ -174,6 +179,104 @@ static void _fft_fill_with_conjugate_symmetry_(Tensor& input,
 // tensors being contiguous, and that the strides at the innermost signal
 // dimension being unit (1) w.r.t. the corresponding data type.
 
+// Parameters of a cuFFT plan, the key of the plan caches.  The direction of
+// the transform is given when running the plan, so it is not part of it.
+struct CuFFTParams {
+  int64_t signal_ndim;
+  long long int signal_sizes[max_signal_ndim];
+  long long int batch;
+  cudaDataType itype, otype, exec_type;
+  bool simple_layout;
+  // Only set for the advanced data layout, see NOTE [ cuFFT Embedded Strides ]
+  long long int inembed[max_signal_ndim], onembed[max_signal_ndim];
+  long long int base_istride, idist, base_ostride, odist;
+};
+
+// A plan, the size of the work area it needs, and the lock under which it is
+// run
+struct CuFFTConfig {
+  CufftHandle plan;
+  size_t ws_size;
+  std::mutex mutex;
+};
+
+static std::shared_ptr<CuFFTConfig> make_cufft_config(const CuFFTParams& params) {
+  auto config = std::make_shared<CuFFTConfig>();
+  auto signal_sizes = const_cast<long long int*>(params.signal_sizes);
+
+  // disable auto allocation of workspace to use THC allocator
+  CUFFT_CHECK(cufftSetAutoAllocation(config->plan.get(), /* autoAllocate */ 0));
+
+  // make plan
+  if (params.simple_layout) {
+    // If with unit-stride, we tell cuFFT by setting inembed == onembed == NULL.
+    // In such case, cuFFT ignores base_istride, base_ostride, idist, and odist
+    // by assuming base_istride = base_ostride = 1.
+    //
+    // See NOTE [ cuFFT Embedded Strides ].
+    CUFFT_CHECK(cufftXtMakePlanMany(config->plan.get(), params.signal_ndim, signal_sizes,
+      /* inembed */ nullptr, /* base_istride */ 1, /* idist */ 1, params.itype,
+      /* onembed */ nullptr, /* base_ostride */ 1, /* odist */ 1, params.otype,
+      params.batch, &config->ws_size, params.exec_type));
+  } else {
+    CUFFT_CHECK(cufftXtMakePlanMany(config->plan.get(), params.signal_ndim, signal_sizes,
+      const_cast<long long int*>(params.inembed), params.base_istride, params.idist, params.itype,
+      const_cast<long long int*>(params.onembed), params.base_ostride, params.odist, params.otype,
+      params.batch, &config->ws_size, params.exec_type));
+  }
+  return config;
+}
+
+using CuFFTPlanCache = FFTPlanCache<CuFFTParams, CuFFTConfig>;
+
+// Plans belong to the device that was current when they were made.  The
+// caches are never destroyed, since destroying the plans at exit can fail
+// once the CUDA driver is shutting down.
+static std::mutex cufft_plan_caches_mutex;
+static auto& cufft_plan_caches = *new std::vector<std::unique_ptr<CuFFTPlanCache>>();
+static int64_t cufft_plan_cache_max_size = fft_plan_cache_default_max_size;
+
+static CuFFTPlanCache& cufft_plan_cache(int64_t device_index) {
+  if (device_index < 0) {
+    throw std::runtime_error("cuFFT plan caches are indexed by CUDA device");
+  }
+  std::lock_guard<std::mutex> guard(cufft_plan_caches_mutex);
+  if (device_index >= static_cast<int64_t>(cufft_plan_caches.size())) {
+    cufft_plan_caches.resize(device_index + 1);
+  }
+  auto& cache = cufft_plan_caches[device_index];
+  if (!cache) {
+    cache.reset(new CuFFTPlanCache(cufft_plan_cache_max_size));
+  }
+  return *cache;
+}
+
+int64_t cufft_get_plan_cache_max_size() {
+  std::lock_guard<std::mutex> guard(cufft_plan_caches_mutex);
+  return cufft_plan_cache_max_size;
+}
+
+void cufft_set_plan_cache_max_size(int64_t max_size) {
+  if (max_size < 0) {
+    throw std::runtime_error("cuFFT plan cache size must be non-negative");
+  }
+  std::lock_guard<std::mutex> guard(cufft_plan_caches_mutex);
+  cufft_plan_cache_max_size = max_size;
+  for (auto& cache : cufft_plan_caches) {
+    if (cache) {
+      cache->set_max_size(max_size);
+    }
+  }
+}
+
+int64_t cufft_get_plan_cache_size(int64_t device_index) {
+  return cufft_plan_cache(device_index).size();
+}
+
+void cufft_clear_plan_cache(int64_t device_index) {
+  cufft_plan_cache(device_index).clear();
+}
+
 // cuFFT
 // Currently not utilizing multi GPUs so this potentially speed up.
 Tensor _fft_cufft(const Tensor& self, int64_t signal_ndim,
@@ -330,57 +433,51 @@ Tensor _fft_cufft(const Tensor& self, int64_t signal_ndim,
   // set output
   auto output = input.type().tensor(output_sizes);
 
-  // create plan
-  CufftHandle plan;
-  size_t ws_size = 0;
-  auto& ctx = at::globalContext();
-
-  // set to current stream
-  CUFFT_CHECK(cufftSetStream(plan.get(), ctx.getCurrentCUDAStream()));
-
-  // disable auto allocation of workspace to use THC allocator
-  CUFFT_CHECK(cufftSetAutoAllocation(plan.get(), /* autoAllocate */ 0));
-
-  // make plan
-  if (simple_layout) {
-    // If with unit-stride, we tell cuFFT by setting inembed == onembed == NULL.
-    // In such case, cuFFT ignores base_istride, base_ostride, idist, and odist
-    // by assuming base_istride = base_ostride = 1.
-    //
-    // See NOTE [ cuFFT Embedded Strides ].
-    CUFFT_CHECK(cufftXtMakePlanMany(plan.get(), signal_ndim, signal_sizes.data(),
-      /* inembed */ nullptr, /* base_istride */ 1, /* idist */ 1, itype,
-      /* onembed */ nullptr, /* base_ostride */ 1, /* odist */ 1, otype,
-      batch, &ws_size, exec_type));
-  } else {
+  CuFFTParams params;
+  memset(&params, 0, sizeof(CuFFTParams));
+  params.signal_ndim = signal_ndim;
+  std::copy(signal_sizes.begin(), signal_sizes.end(), params.signal_sizes);
+  params.batch = batch;
+  params.itype = itype;
+  params.otype = otype;
+  params.exec_type = exec_type;
+  params.simple_layout = simple_layout;
+  if (!simple_layout) {
     // set idist (stride at batch dim)
-    long long int idist = complex_input ? input.stride(0) >> 1 : input.stride(0);
+    params.idist = complex_input ? input.stride(0) >> 1 : input.stride(0);
     // Even if batch dimension is one and idist (stride(0)) doesn't matter,
     // cuFFT errors if idist = 0. This is hack to make it succeed.
-    if (idist == 0 && batch == 1) {
-      idist = 1;
+    if (params.idist == 0 && batch == 1) {
+      params.idist = 1;
     }
     // set base_istride (stride at innermost dim of signal)
-    long long int base_istride = complex_input ? input.stride(signal_ndim) >> 1
-                                               : input.stride(signal_ndim);
+    params.base_istride = complex_input ? input.stride(signal_ndim) >> 1
+                                        : input.stride(signal_ndim);
+    std::copy(inembed.begin(), inembed.end(), params.inembed);
 
     // set odist, onembed, base_ostride
-    long long int odist = complex_output ? output.stride(0) >> 1 : output.stride(0);
-    std::vector<long long int> onembed(output_sizes.data() + 1, output_sizes.data() + signal_ndim + 1);
-    long long int base_ostride = 1;
-
-    CUFFT_CHECK(cufftXtMakePlanMany(plan.get(), signal_ndim, signal_sizes.data(),
-      inembed.data(), base_istride, idist, itype,
-      onembed.data(), base_ostride, odist, otype,
-      batch, &ws_size, exec_type));
+    params.odist = complex_output ? output.stride(0) >> 1 : output.stride(0);
+    std::copy(output_sizes.data() + 1, output_sizes.data() + signal_ndim + 1, params.onembed);
+    params.base_ostride = 1;
   }
 
-  auto ws = ctx.getType(at::Backend::CUDA, at::ScalarType::Byte).tensor({ static_cast<int64_t>(ws_size) });
-  CUFFT_CHECK(cufftSetWorkArea(plan.get(), ws.data_ptr()));
+  auto& ctx = at::globalContext();
+  auto config = cufft_plan_cache(input.get_device()).get(params, make_cufft_config);
+  {
+    // A plan is given its stream and work area right before running, which
+    // must not be interleaved with another thread running the same plan
+    std::lock_guard<std::mutex> guard(config->mutex);
+
+    // set to current stream
+    CUFFT_CHECK(cufftSetStream(config->plan.get(), ctx.getCurrentCUDAStream()));
+
+    auto ws = ctx.getType(at::Backend::CUDA, at::ScalarType::Byte).tensor({ static_cast<int64_t>(config->ws_size) });
+    CUFFT_CHECK(cufftSetWorkArea(config->plan.get(), ws.data_ptr()));
 
-  // run
-  CUFFT_CHECK(cufftXtExec(plan.get(), input.data_ptr(), output.data_ptr(),
-    inverse ? CUFFT_INVERSE : CUFFT_FORWARD));
+    // run
+    CUFFT_CHECK(cufftXtExec(config->plan.get(), input.data_ptr(), output.data_ptr(),
+      inverse ? CUFFT_INVERSE : CUFFT_FORWARD));
+  }
 
   // rescale if needed by normalized flag or inverse transform
   auto size_last_signal_dim = checked_signal_sizes[signal_ndim - 1];
@@ -0,0 +1,66 @@
+#include "ATen/ATen.h"
+#include "ATen/AccumulateType.h"
+#include "ATen/Dispatch.h"
+#include "ATen/NativeFunctions.h"
+#include "ATen/cuda/CUDATypeConversion.cuh"
+#include "ATen/native/TensorIterator.h"
+#include "ATen/native/cuda/Loops.cuh"
+
+#include <THC/THCNumerics.cuh>
+
+// Unary ops on floating point tensors run on the elementwise loops of
+// Loops.cuh, half tensors being computed in float. Other types, and results
+// of another type or device, are forwarded to THC.
+
+namespace at { namespace native {
+
+static bool can_use_unary_kernel(const Tensor& result, const Tensor& self) {
+  return isFloatingType(self.type().scalarType()) && result.type() == self.type()
+      && result.get_device() == self.get_device();
+}
+
+#define IMPLEMENT_UNARY_OP_CUDA(op, th_op)                                    \
+  Tensor& _##op##_out_cuda(Tensor& result, const Tensor& self) {              \
+    if (!can_use_unary_kernel(result, self)) {                                \
+      return at::th_op(result, self);                                         \
+    }                                                                         \
+    auto iter = TensorIterator::unary_op(result, self);                       \
+    AT_DISPATCH_FLOATING_TYPES_AND_HALF(iter.type(), #op, [&] {               \
+      using cuda_scalar_t = cuda::type<scalar_t>;                             \
+      using accscalar_t = acc_type<cuda_scalar_t, true>;                      \
+      gpu_unary_kernel<cuda_scalar_t, accscalar_t>(                           \
+          iter, [] __device__ (accscalar_t x) {                               \
+            return THCNumerics<accscalar_t>::op(x);                           \
+          });                                                                 \
+    });                                                                       \
+    return result;                                                            \
+  }                                                                           \
+  Tensor& _##op##__cuda(Tensor& self) {                                       \
+    return _##op##_out_cuda(self, self);                                      \
+  }
+
+IMPLEMENT_UNARY_OP_CUDA(abs, _abs_out)
+IMPLEMENT_UNARY_OP_CUDA(acos, _acos_out)
+IMPLEMENT_UNARY_OP_CUDA(asin, _asin_out)
+IMPLEMENT_UNARY_OP_CUDA(atan, _atan_out)
+IMPLEMENT_UNARY_OP_CUDA(ceil, _ceil_out)
+IMPLEMENT_UNARY_OP_CUDA(cos, _cos_out)
+IMPLEMENT_UNARY_OP_CUDA(cosh, _cosh_out)
+IMPLEMENT_UNARY_OP_CUDA(erf, _erf_out)
+IMPLEMENT_UNARY_OP_CUDA(exp, _exp_out)
+IMPLEMENT_UNARY_OP_CUDA(expm1, _expm1_out)
+IMPLEMENT_UNARY_OP_CUDA(floor, _floor_out)
+IMPLEMENT_UNARY_OP_CUDA(log, _log_out)
+IMPLEMENT_UNARY_OP_CUDA(log10, _log10_out)
+IMPLEMENT_UNARY_OP_CUDA(log1p, _log1p_out)
+IMPLEMENT_UNARY_OP_CUDA(log2, _log2_out)
+IMPLEMENT_UNARY_OP_CUDA(round, _round_out)
+IMPLEMENT_UNARY_OP_CUDA(sin, _sin_out)
+IMPLEMENT_UNARY_OP_CUDA(sinh, _sinh_out)
+IMPLEMENT_UNARY_OP_CUDA(sqrt, _sqrt_out)
+IMPLEMENT_UNARY_OP_CUDA(rsqrt, _rsqrt_out)
+IMPLEMENT_UNARY_OP_CUDA(tan, _tan_out)
+IMPLEMENT_UNARY_OP_CUDA(tanh, _th_tanh_out)
+IMPLEMENT_UNARY_OP_CUDA(trunc, _trunc_out)
+
+}} // namespace at::native
@@ -2,6 +2,7 @@
 #include <ATen/NativeFunctions.h>
 #include <ATen/Config.h>
 #include <ATen/cuda/CUDAConfig.h>
+#include <ATen/cudnn/BenchmarkCache.h>
 
 #if !AT_CUDNN_ENABLED()
 
@@ -16,6 +17,13 @@ at::Tensor cudnn_convolution(
   throw std::runtime_error("cudnn_convolution: ATen not compiled with cuDNN support");
 }
 
+at::Tensor cudnn_convolution_relu(
+    const at::Tensor& input, const at::Tensor& weight, const at::Tensor& bias /* optional */,
+    IntList padding, IntList stride, IntList dilation,
+    int64_t groups, bool benchmark, bool deterministic) {
+  throw std::runtime_error("cudnn_convolution_relu: ATen not compiled with cuDNN support");
+}
+
 at::Tensor cudnn_convolution_backward_input(
     IntList input_size, const at::Tensor& grad_output, const at::Tensor& weight,
     IntList padding, IntList stride, IntList dilation, int64_t groups,
@@ -70,6 +78,14 @@ std::tuple<at::Tensor,at::Tensor,at::Tensor> cudnn_convolution_transpose_backwar
   throw std::runtime_error("cudnn_convolution_transpose_backward: ATen not compiled with cuDNN support");
 }
 
+void cudnn_save_benchmark_cache(const std::string& path) {
+  throw std::runtime_error("cudnn_save_benchmark_cache: ATen not compiled with cuDNN support");
+}
+
+int64_t cudnn_load_benchmark_cache(const std::string& path) {
+  throw std::runtime_error("cudnn_load_benchmark_cache: ATen not compiled with cuDNN support");
+}
+
 }}
 
 #else  // AT_CUDNN_ENABLED
@@ -87,10 +103,14 @@ std::tuple<at::Tensor,at::Tensor,at::Tensor> cudnn_convolution_transpose_backwar
 #include <iterator>
 #include <sstream>
 #include <algorithm>
+#include <cstdlib>
+#include <fstream>
 #include <memory>
 #include <mutex>
 #include <stdint.h>
+#include <string>
 #include <unordered_map>
+#include <vector>
 
 namespace at { namespace native {
 
@@ -253,6 +273,7 @@ static void convolution_shape_check(
 struct ConvolutionParams
 {
   cudnnDataType_t dataType;
+  int device_id;
   int input_size[2 + max_dim];
   int input_stride[2 + max_dim];
   int weight_size[2 + max_dim];
@@ -282,6 +303,8 @@ void setConvolutionParams(
   cudnnDataType_t dataType = getCudnnDataType(input);
   memset(params, 0, sizeof(ConvolutionParams));
   params->dataType = dataType;
+  // The best algorithm depends on the GPU
+  params->device_id = (int) input.get_device();
   // ASSERT(weight.dim() == input.dim())
   for (int i = 0; i != input.dim(); ++i) {
     params->input_size[i] = (int) input.size(i);
@@ -368,6 +391,185 @@ BenchmarkCache<cudnnConvolutionFwdAlgo_t> fwd_algos;
 BenchmarkCache<cudnnConvolutionBwdDataAlgo_t> bwd_data_algos;
 BenchmarkCache<cudnnConvolutionBwdFilterAlgo_t> bwd_filter_algos;
 
+// ---------------------------------------------------------------------
+//
+// Saving and loading the benchmark cache
+//
+// ---------------------------------------------------------------------
+
+// The file starts with a header line
+//
+//    cudnn_benchmark_cache <format> <cuDNN version> <sizeof(ConvolutionParams)>
+//
+// followed by one line per entry
+//
+//    <kind> <algo> <ConvolutionParams in hex, device_id zeroed> <device name>
+//
+// Device ids differ between machines, so entries store the device name
+// instead and are loaded for every device with that name.
+constexpr int benchmark_cache_format = 1;
+constexpr const char* benchmark_cache_magic = "cudnn_benchmark_cache";
+
+std::vector<std::string> getDeviceNames() {
+  int count;
+  CUDA_CHECK(cudaGetDeviceCount(&count));
+  std::vector<std::string> names;
+  for (int i = 0; i < count; i++) {
+    cudaDeviceProp prop;
+    CUDA_CHECK(cudaGetDeviceProperties(&prop, i));
+    names.emplace_back(prop.name);
+  }
+  return names;
+}
+
+std::string paramsToHex(const ConvolutionParams& params) {
+  static const char digits[] = "0123456789abcdef";
+  auto ptr = reinterpret_cast<const uint8_t*>(&params);
+  std::string hex;
+  for (size_t i = 0; i < sizeof(ConvolutionParams); ++i) {
+    hex += digits[ptr[i] >> 4];
+    hex += digits[ptr[i] & 0xf];
+  }
+  return hex;
+}
+
+bool paramsFromHex(const std::string& hex, ConvolutionParams* params) {
+  if (hex.size() != 2 * sizeof(ConvolutionParams)) {
+    return false;
+  }
+  auto ptr = reinterpret_cast<uint8_t*>(params);
+  for (size_t i = 0; i < sizeof(ConvolutionParams); ++i) {
+    char* end;
+    auto byte = hex.substr(2 * i, 2);
+    ptr[i] = (uint8_t) strtoul(byte.c_str(), &end, 16);
+    if (*end != '\0') {
+      return false;
+    }
+  }
+  return true;
+}
+
+template <typename T>
+void saveBenchmarkCache(
+    std::ostream& out, const char* kind, BenchmarkCache<T>& cache,
+    const std::vector<std::string>& device_names) {
+  std::lock_guard<std::mutex> guard(cache.mutex);
+  for (auto& entry : cache.map) {
+    auto params = entry.first;
+    auto& device_name = device_names.at(params.device_id);
+    params.device_id = 0;
+    out << kind << " " << (int) entry.second << " " << paramsToHex(params)
+        << " " << device_name << "\n";
+  }
+}
+
+template <typename T>
+int64_t loadBenchmarkCacheEntry(
+    BenchmarkCache<T>& cache, ConvolutionParams params, int algo,
+    const std::vector<int>& devices) {
+  int64_t loaded = 0;
+  std::lock_guard<std::mutex> guard(cache.mutex);
+  for (int device : devices) {
+    params.device_id = device;
+    loaded += cache.map.emplace(params, (T) algo).second;
+  }
+  return loaded;
+}
+
+void cudnn_save_benchmark_cache(const std::string& path) {
+  auto device_names = getDeviceNames();
+  std::ofstream out(path);
+  if (!out) {
+    throw std::runtime_error("cudnn_save_benchmark_cache: could not open " + path);
+  }
+  out << benchmark_cache_magic << " " << benchmark_cache_format << " "
+      << cudnnGetVersion() << " " << sizeof(ConvolutionParams) << "\n";
+  saveBenchmarkCache(out, "fwd", fwd_algos, device_names);
+  saveBenchmarkCache(out, "bwd_data", bwd_data_algos, device_names);
+  saveBenchmarkCache(out, "bwd_filter", bwd_filter_algos, device_names);
+  out.close();
+  if (!out) {
+    throw std::runtime_error("cudnn_save_benchmark_cache: could not write " + path);
+  }
+}
+
+int64_t cudnn_load_benchmark_cache(const std::string& path) {
+  std::ifstream in(path);
+  if (!in) {
+    throw std::runtime_error("cudnn_load_benchmark_cache: could not open " + path);
+  }
+
+  std::string line;
+  std::getline(in, line);
+  std::istringstream header(line);
+  std::string magic;
+  int format = -1;
+  size_t version = 0, params_size = 0;
+  header >> magic >> format >> version >> params_size;
+  if (magic != benchmark_cache_magic || format != benchmark_cache_format) {
+    throw std::runtime_error("cudnn_load_benchmark_cache: " + path +
+                             " is not a cuDNN benchmark cache");
+  }
+  // The algorithms found with another version of cuDNN, or by another
+  // build, may not be the best (or even valid) ones
+  if (version != cudnnGetVersion() || params_size != sizeof(ConvolutionParams)) {
+    return 0;
+  }
+
+  std::unordered_map<std::string, std::vector<int>> devices_by_name;
+  auto device_names = getDeviceNames();
+  for (int i = 0; i < (int) device_names.size(); i++) {
+    devices_by_name[device_names[i]].push_back(i);
+  }
+
+  int64_t loaded = 0;
+  for (int lineno = 2; std::getline(in, line); lineno++) {
+    if (line.empty()) {
+      continue;
+    }
+    std::istringstream entry(line);
+    std::string kind, hex, device_name;
+    int algo;
+    ConvolutionParams params;
+    entry >> kind >> algo >> hex;
+    entry >> std::ws;
+    std::getline(entry, device_name);
+    if (!entry || !paramsFromHex(hex, &params)) {
+      throw std::runtime_error("cudnn_load_benchmark_cache: malformed entry at " +
+                               path + ":" + std::to_string(lineno));
+    }
+
+    auto devices = devices_by_name.find(device_name);
+    if (devices == devices_by_name.end()) {
+      continue;
+    }
+    if (kind == "fwd") {
+      loaded += loadBenchmarkCacheEntry(fwd_algos, params, algo, devices->second);
+    } else if (kind == "bwd_data") {
+      loaded += loadBenchmarkCacheEntry(bwd_data_algos, params, algo, devices->second);
+    } else if (kind == "bwd_filter") {
+      loaded += loadBenchmarkCacheEntry(bwd_filter_algos, params, algo, devices->second);
+    } else {
+      throw std::runtime_error("cudnn_load_benchmark_cache: unknown kind '" + kind +
+                               "' at " + path + ":" + std::to_string(lineno));
+    }
+  }
+  return loaded;
+}
+
+// Loads the file named by TORCH_CUDNN_BENCHMARK_CACHE, if any, before the
+// first algorithm search of the process
+void loadBenchmarkCacheFromEnv() {
+  static std::once_flag once;
+  std::call_once(once, [] {
+    auto path = std::getenv("TORCH_CUDNN_BENCHMARK_CACHE");
+    if (path == nullptr || *path == '\0' || !std::ifstream(path)) {
+      return;
+    }
+    cudnn_load_benchmark_cache(path);
+  });
+}
+
 // TODO: Stop manually allocating CUDA memory; allocate an ATen byte
 // tensor instead.
 struct Workspace {
@@ -685,6 +887,7 @@ void findAlgorithm(const ConvolutionArgs& args, bool benchmark, algo_t* algo) {
   using search = algorithm_search<algo_t>;
   auto& cache = search::cache();
 
+  loadBenchmarkCacheFromEnv();
   if (cache.find(args.params, algo)) {
     return;
   }
@@ -903,6 +1106,85 @@ Tensor cudnn_convolution(
   return output_t;
 }
 
+// Convolution, bias addition and ReLU in a single cuDNN call, which saves
+// the two passes over the output the separate bias and activation kernels
+// make. There is no backward, it's meant for inference.
+Tensor cudnn_convolution_relu(
+    const Tensor& input_t, const Tensor& weight_t, const Tensor& bias_t,
+    IntList padding, IntList stride, IntList dilation,
+    int64_t groups, bool benchmark, bool deterministic)
+{
+  TensorArg input  { input_t,  "input",  1 },
+            weight { weight_t, "weight", 2 },
+            bias   { bias_t,   "bias",   3 };
+  setCuDNNStreamToCurrent();
+  CheckedFrom c = "cudnn_convolution_relu";
+#if CUDNN_VERSION < 7000
+  if (groups > 1) {
+    // no group count in the convolution descriptor
+    auto output = cudnn_convolution(input_t, weight_t, bias_t, padding, stride, dilation,
+                                    groups, benchmark, deterministic);
+    return output.relu_();
+  }
+#endif
+  checkAllSameType(c, {input, weight});
+  checkAllSameGPU(c, {input, weight});
+
+  auto output_t = input->type().tensor(
+                    conv_output_size(input->sizes(), weight->sizes(),
+                                     padding, stride, dilation, groups));
+  TensorArg output{ output_t, "result", 0 };
+  convolution_shape_check(c, input, weight, output, padding, stride, dilation, groups);
+
+  // cuDNN always adds a bias here
+  Tensor bias_contig;
+  if (bias->defined()) {
+    checkAllSameType(c, {output, bias});
+    checkAllSameGPU(c, {output, bias});
+    checkSize(c, bias, { output->size(output_channels_dim) });
+    bias_contig = bias->contiguous();
+  } else {
+    bias_contig = output_t.type().zeros({ output->size(output_channels_dim) });
+  }
+
+  // See #4500
+  Tensor weight_contig = weight->contiguous();
+
+  auto dataType = getCudnnDataType(*input);
+  ConvolutionArgs args{ *input, output_t, weight_contig };
+  args.handle = getCudnnHandle();
+  setConvolutionParams(&args.params, *input, weight_contig, padding, stride, dilation, groups, deterministic);
+  args.idesc.set(*input);
+  args.wdesc.set(weight_contig);
+  args.odesc.set(output_t);
+  args.cdesc.set(dataType, input->dim() - 2, args.params.padding, args.params.stride, args.params.dilation, args.params.groups);
+
+  cudnnConvolutionFwdAlgo_t fwdAlg;
+  Workspace workspace = chooseAlgorithm(args, benchmark, &fwdAlg);
+
+  // See Note [CuDNN broadcast padding]
+  TensorDescriptor bdesc;
+  bdesc.set(bias_contig.expand({1, bias_contig.size(0)}), output_t.dim());
+  ActivationDescriptor adesc;
+  adesc.set(CUDNN_ACTIVATION_RELU);
+
+  Constant one(dataType, 1);
+  Constant zero(dataType, 0);
+
+  // z (the residual added before the activation) is the output, scaled by 0
+  CUDNN_CHECK(cudnnConvolutionBiasActivationForward(
+    args.handle,
+    &one, args.idesc.desc(), input->data_ptr(),
+    args.wdesc.desc(), weight_contig.data_ptr(),
+    args.cdesc.desc(), fwdAlg, workspace.data, workspace.size,
+    &zero, args.odesc.desc(), output_t.data_ptr(),
+    bdesc.desc(), bias_contig.data_ptr(),
+    adesc.desc(),
+    args.odesc.desc(), output_t.data_ptr()));
+
+  return output_t;
+}
+
 // NB: output_padding not needed here, as there is no ambiguity to
 // resolve
 Tensor cudnn_convolution_transpose_backward_input(
@@ -2,6 +2,7 @@
 #include "ATen/NativeFunctions.h"
 #include "ATen/native/SpectralOpsUtils.h"
 #include "ATen/Config.h"
+#include "ATen/mkl/FFTPlanCache.h"
 
 #if !AT_MKL_ENABLED()
 
@@ -15,6 +16,22 @@ Tensor _fft_mkl(const Tensor& input, int64_t signal_ndim,
   throw std::runtime_error("fft: ATen not compiled with MKL support");
 }
 
+int64_t mkl_fft_get_plan_cache_max_size() {
+  throw std::runtime_error("mkl_fft_get_plan_cache_max_size: ATen not compiled with MKL support");
+}
+
+void mkl_fft_set_plan_cache_max_size(int64_t max_size) {
+  throw std::runtime_error("mkl_fft_set_plan_cache_max_size: ATen not compiled with MKL support");
+}
+
+int64_t mkl_fft_get_plan_cache_size() {
+  throw std::runtime_error("mkl_fft_get_plan_cache_size: ATen not compiled with MKL support");
+}
+
+void mkl_fft_clear_plan_cache() {
+  throw std::runtime_error("mkl_fft_clear_plan_cache: ATen not compiled with MKL support");
+}
+
 }}
 
 #else // AT_MKL_ENABLED
@@ -26,6 +43,9 @@ Tensor _fft_mkl(const Tensor& input, int64_t signal_ndim,
 #include "ATen/NativeFunctions.h"
 
 #include <algorithm>
+#include <cstring>
+#include <functional>
+#include <memory>
 #include <vector>
 #include <numeric>
 #include <cmath>
@@ -159,6 +179,80 @@ static inline void _fft_fill_with_conjugate_symmetry_(Tensor& input,
   });
 }
 
+// Parameters of a DFTI descriptor, the key of the descriptor cache
+struct MklFFTParams {
+  DFTI_CONFIG_VALUE prec;
+  DFTI_CONFIG_VALUE signal_type;
+  int64_t signal_ndim;
+  MKL_LONG sizes[max_signal_ndim];
+  MKL_LONG batch;
+  MKL_LONG idist, odist;
+  MKL_LONG istrides[1 + max_signal_ndim], ostrides[1 + max_signal_ndim];
+  bool complex_input, complex_output;
+  bool normalized, inverse;
+};
+
+static std::shared_ptr<DftiDescriptor> make_descriptor(const MklFFTParams& params) {
+  auto descriptor = std::make_shared<DftiDescriptor>();
+  // create descriptor with signal size
+  std::vector<MKL_LONG> mkl_signal_sizes(params.sizes, params.sizes + params.signal_ndim);
+  descriptor->init(params.prec, params.signal_type, params.signal_ndim, mkl_signal_sizes.data());
+  // out of place FFT
+  MKL_DFTI_CHECK(DftiSetValue(descriptor->get(), DFTI_PLACEMENT, DFTI_NOT_INPLACE));
+  // batch mode
+  MKL_DFTI_CHECK(DftiSetValue(descriptor->get(), DFTI_NUMBER_OF_TRANSFORMS, params.batch));
+  MKL_DFTI_CHECK(DftiSetValue(descriptor->get(), DFTI_INPUT_DISTANCE, params.idist));
+  MKL_DFTI_CHECK(DftiSetValue(descriptor->get(), DFTI_OUTPUT_DISTANCE, params.odist));
+  // DftiSetValue takes non-const stride arrays
+  std::vector<MKL_LONG> mkl_istrides(params.istrides, params.istrides + 1 + params.signal_ndim);
+  std::vector<MKL_LONG> mkl_ostrides(params.ostrides, params.ostrides + 1 + params.signal_ndim);
+  MKL_DFTI_CHECK(DftiSetValue(descriptor->get(), DFTI_INPUT_STRIDES, mkl_istrides.data()));
+  MKL_DFTI_CHECK(DftiSetValue(descriptor->get(), DFTI_OUTPUT_STRIDES, mkl_ostrides.data()));
+  // if conjugate domain of real is involved, set standard CCE storage type
+  // this will become default in MKL in future
+  if (!params.complex_input || !params.complex_output) {
+    MKL_DFTI_CHECK(DftiSetValue(descriptor->get(), DFTI_CONJUGATE_EVEN_STORAGE, DFTI_COMPLEX_COMPLEX));
+  }
+  // rescale if needed by normalized flag or inverse transform
+  if (params.normalized || params.inverse) {
+    auto signal_numel = std::accumulate(mkl_signal_sizes.begin(), mkl_signal_sizes.end(),
+                                        (int64_t) 1, std::multiplies<int64_t>());
+    double double_scale;
+    if (params.normalized) {
+      double_scale = 1.0 / std::sqrt(static_cast<double>(signal_numel));
+    } else {
+      double_scale = 1.0 / static_cast<double>(signal_numel);
+    }
+    MKL_DFTI_CHECK(DftiSetValue(descriptor->get(),
+      params.inverse ? DFTI_BACKWARD_SCALE : DFTI_FORWARD_SCALE,
+      params.prec == DFTI_DOUBLE ? double_scale : static_cast<float>(double_scale)));
+  }
+  // finalize
+  MKL_DFTI_CHECK(DftiCommitDescriptor(descriptor->get()));
+  return descriptor;
+}
+
+static FFTPlanCache<MklFFTParams, DftiDescriptor>& mkl_plan_cache() {
+  static FFTPlanCache<MklFFTParams, DftiDescriptor> cache(fft_plan_cache_default_max_size);
+  return cache;
+}
+
+int64_t mkl_fft_get_plan_cache_max_size() {
+  return mkl_plan_cache().max_size();
+}
+
+void mkl_fft_set_plan_cache_max_size(int64_t max_size) {
+  mkl_plan_cache().set_max_size(max_size);
+}
+
+int64_t mkl_fft_get_plan_cache_size() {
+  return mkl_plan_cache().size();
+}
+
+void mkl_fft_clear_plan_cache() {
+  mkl_plan_cache().clear();
+}
+
 // MKL DFTI
 Tensor _fft_mkl(const Tensor& self, int64_t signal_ndim,
                 bool complex_input, bool complex_output,
@@ -229,63 +323,44 @@ Tensor _fft_mkl(const Tensor& self, int64_t signal_ndim,
        << at::toString(input.type().scalarType());
     throw std::runtime_error(ss.str());
   }
+
+  MklFFTParams params;
+  memset(&params, 0, sizeof(MklFFTParams));
+  params.prec = prec;
   // signal type
-  DFTI_CONFIG_VALUE signal_type;
   if (!inverse) {
-    signal_type = complex_input ? DFTI_COMPLEX : DFTI_REAL;
+    params.signal_type = complex_input ? DFTI_COMPLEX : DFTI_REAL;
   } else {
-    signal_type = complex_output ? DFTI_COMPLEX : DFTI_REAL;
+    params.signal_type = complex_output ? DFTI_COMPLEX : DFTI_REAL;
   }
-  // create descriptor with signal size
-  std::vector<MKL_LONG> mkl_signal_sizes(checked_signal_sizes.begin(), checked_signal_sizes.end());
-  DftiDescriptor descriptor;
-  descriptor.init(prec, signal_type, signal_ndim, mkl_signal_sizes.data());
-  // out of place FFT
-  MKL_DFTI_CHECK(DftiSetValue(descriptor.get(), DFTI_PLACEMENT, DFTI_NOT_INPLACE));
-  // batch mode
-  MKL_DFTI_CHECK(DftiSetValue(descriptor.get(), DFTI_NUMBER_OF_TRANSFORMS, batch));
-
+  params.signal_ndim = signal_ndim;
+  std::copy(checked_signal_sizes.begin(), checked_signal_sizes.end(), params.sizes);
+  params.batch = batch;
   auto istrides = input.strides();
   auto ostrides = output.strides();
   // batch dim stride, i.e., dist between each data
-  MKL_LONG idist = complex_input ? istrides[0] >> 1 : istrides[0];
-  MKL_LONG odist = complex_output ? ostrides[0] >> 1 : ostrides[0];
-  MKL_DFTI_CHECK(DftiSetValue(descriptor.get(), DFTI_INPUT_DISTANCE, idist));
-  MKL_DFTI_CHECK(DftiSetValue(descriptor.get(), DFTI_OUTPUT_DISTANCE, odist));
+  params.idist = complex_input ? istrides[0] >> 1 : istrides[0];
+  params.odist = complex_output ? ostrides[0] >> 1 : ostrides[0];
   // signal strides
   // first val is offset, set to zero (ignored)
-  std::vector<MKL_LONG> mkl_istrides(1 + signal_ndim, 0), mkl_ostrides(1 + signal_ndim, 0);
   for (int64_t i = 1; i <= signal_ndim; i++) {
-    mkl_istrides[i] = complex_input ? istrides[i] >> 1 : istrides[i];
-    mkl_ostrides[i] = complex_output ? ostrides[i] >> 1 : ostrides[i];
-  }
-  MKL_DFTI_CHECK(DftiSetValue(descriptor.get(), DFTI_INPUT_STRIDES, mkl_istrides.data()));
-  MKL_DFTI_CHECK(DftiSetValue(descriptor.get(), DFTI_OUTPUT_STRIDES, mkl_ostrides.data()));
-  // if conjugate domain of real is involved, set standard CCE storage type
-  // this will become default in MKL in future
-  if (!complex_input || !complex_output) {
-    MKL_DFTI_CHECK(DftiSetValue(descriptor.get(), DFTI_CONJUGATE_EVEN_STORAGE, DFTI_COMPLEX_COMPLEX));
-  }
-  // rescale if needed by normalized flag or inverse transform
-  if (normalized || inverse) {
-    auto signal_numel = at::prod_intlist(checked_signal_sizes);
-    double double_scale;
-    if (normalized) {
-      double_scale = 1.0 / std::sqrt(static_cast<double>(signal_numel));
-    } else {
-      double_scale = 1.0 / static_cast<double>(signal_numel);
-    }
-    MKL_DFTI_CHECK(DftiSetValue(descriptor.get(),
-      inverse ? DFTI_BACKWARD_SCALE : DFTI_FORWARD_SCALE,
-      prec == DFTI_DOUBLE ? double_scale : static_cast<float>(double_scale)));
+    params.istrides[i] = complex_input ? istrides[i] >> 1 : istrides[i];
+    params.ostrides[i] = complex_output ? ostrides[i] >> 1 : ostrides[i];
   }
-  // finalize
-  MKL_DFTI_CHECK(DftiCommitDescriptor(descriptor.get()));
+  params.complex_input = complex_input;
+  params.complex_output = complex_output;
+  params.normalized = normalized;
+  params.inverse = inverse;
+
+  // Committed descriptors are not modified by the compute functions, so a
+  // cached one can be used by several threads at once
+  auto descriptor = mkl_plan_cache().get(params, make_descriptor);
+
   // run
   if (!inverse) {
-    MKL_DFTI_CHECK(DftiComputeForward(descriptor.get(), input.data_ptr(), output.data_ptr()));
+    MKL_DFTI_CHECK(DftiComputeForward(descriptor->get(), input.data_ptr(), output.data_ptr()));
   } else {
-    MKL_DFTI_CHECK(DftiComputeBackward(descriptor.get(), input.data_ptr(), output.data_ptr()));
+    MKL_DFTI_CHECK(DftiComputeBackward(descriptor->get(), input.data_ptr(), output.data_ptr()));
   }
   // now if needed, fill out the other half using Hermitian symmetry dim
   if (!complex_input && complex_output && !onesided) {
@@ -0,0 +1,111 @@
+#include <ATen/ATen.h>
+#include <ATen/NativeFunctions.h>
+#include <ATen/Config.h>
+
+#if !AT_MKLDNN_ENABLED()
+
+namespace at { namespace native {
+
+at::Tensor mkldnn_batch_norm(
+    const at::Tensor& input, const at::Tensor& weight, const at::Tensor& bias,
+    const at::Tensor& running_mean, const at::Tensor& running_var, double eps) {
+  throw std::runtime_error("mkldnn_batch_norm: ATen not compiled with MKLDNN support");
+}
+
+}}
+
+#else // AT_MKLDNN_EBABLED
+
+#include <ATen/mkldnn/Runtime.h>
+
+using namespace mkldnn;
+
+namespace at { namespace native {
+
+namespace {
+
+// Key of the cached batch normalization primitives (NCHW input)
+struct BatchNormParams {
+  int32_t input_size[4];
+  float eps;
+};
+
+std::shared_ptr<PrimitiveNet> make_batch_norm(const BatchNormParams& p)
+{
+  auto cpu_engine = CpuEngine::Instance().get_engine();
+
+  memory::dims input_tz(p.input_size, p.input_size + 4);
+  auto input_md = memory::desc({input_tz}, memory::data_type::f32, memory::format::nchw);
+
+  // Normalizes with the running statistics, and scales and shifts by the
+  // weight and bias packed in a single (2, C) scale_shift tensor
+  auto bn_forward_desc = batch_normalization_forward::desc(prop_kind::forward_inference,
+    input_md, p.eps, use_global_stats | use_scale_shift);
+  auto bn_forward_pd = batch_normalization_forward::primitive_desc(bn_forward_desc, cpu_engine);
+
+  auto net = std::make_shared<PrimitiveNet>();
+  auto input_memory = net->input({input_md, cpu_engine}, {input_md, cpu_engine});
+  auto mean_memory = net->input(bn_forward_pd.mean_primitive_desc(),
+    bn_forward_pd.mean_primitive_desc());
+  auto var_memory = net->input(bn_forward_pd.variance_primitive_desc(),
+    bn_forward_pd.variance_primitive_desc());
+  auto scale_shift_memory = net->input(bn_forward_pd.weights_primitive_desc(),
+    bn_forward_pd.weights_primitive_desc());
+  auto output_memory = net->output({input_md, cpu_engine},
+    bn_forward_pd.dst_primitive_desc());
+  net->add(batch_normalization_forward(bn_forward_pd, input_memory, mean_memory,
+    var_memory, scale_shift_memory, output_memory));
+
+  return net;
+}
+
+PrimitiveCache<BatchNormParams, PrimitiveNet> batch_norm_cache;
+
+} // namespace
+
+at::Tensor mkldnn_batch_norm(
+    const at::Tensor& input_t, const at::Tensor& weight, const at::Tensor& bias,
+    const at::Tensor& running_mean_t, const at::Tensor& running_var_t, double eps)
+{
+  AT_CHECK(input_t.type().backend() == kCPU && input_t.type().scalarType() == kFloat,
+           "mkldnn_batch_norm: expected a CPU float input, got ", input_t.toString());
+  AT_CHECK(input_t.dim() == 4,
+           "mkldnn_batch_norm: expected 4-d input (NCHW), got ", input_t.dim(), "-d");
+  auto input = input_t.contiguous();
+  auto running_mean = running_mean_t.contiguous();
+  auto running_var = running_var_t.contiguous();
+  auto num_features = input.size(1);
+  AT_CHECK(running_mean.numel() == num_features && running_var.numel() == num_features,
+           "mkldnn_batch_norm: expected running_mean and running_var to have ",
+           num_features, " elements");
+
+  auto scale_shift = input.type().tensor({2, num_features});
+  if (weight.defined()) {
+    scale_shift[0].copy_(weight.view({num_features}));
+  } else {
+    scale_shift[0].fill_(1);
+  }
+  if (bias.defined()) {
+    scale_shift[1].copy_(bias.view({num_features}));
+  } else {
+    scale_shift[1].fill_(0);
+  }
+
+  BatchNormParams params;
+  memset(&params, 0, sizeof(params));
+  for (int i = 0; i < 4; ++i) {
+    params.input_size[i] = input.size(i);
+  }
+  params.eps = eps;
+
+  auto output = input.type().tensor(input.sizes());
+  batch_norm_cache.get(params, make_batch_norm)->run({input.data_ptr(),
+    running_mean.data_ptr(), running_var.data_ptr(), scale_shift.data_ptr(),
+    output.data_ptr()});
+
+  return output;
+}
+
+}}  // namespace at::native
+
+#endif
@@ -30,8 +30,27 @@ std::tuple<at::Tensor,at::Tensor,at::Tensor> mkldnn_convolution_backward(
   throw std::runtime_error("mkldnn_convolution_backward: ATen not compiled with MKLDNN support");
 }
 
+at::Tensor mkldnn_convolution_relu(
+    const at::Tensor& input, const at::Tensor& weight, const at::Tensor& bias,
+    IntList padding, IntList stride, IntList dilation) {
+  throw std::runtime_error("mkldnn_convolution_relu: ATen not compiled with MKLDNN support");
+}
+
+at::Tensor mkldnn_reorder_conv_weight(
+    const at::Tensor& weight, IntList input_size, IntList padding, IntList stride,
+    IntList dilation, bool bias_defined, bool relu) {
+  throw std::runtime_error("mkldnn_reorder_conv_weight: ATen not compiled with MKLDNN support");
+}
+
+at::Tensor mkldnn_convolution_inference(
+    const at::Tensor& input, const at::Tensor& weight, IntList weight_size, const at::Tensor& bias,
+    IntList padding, IntList stride, IntList dilation, bool relu) {
+  throw std::runtime_error("mkldnn_convolution_inference: ATen not compiled with MKLDNN support");
+}
+
 }}
 
+
 #else // AT_MKLDNN_EBABLED
 
 #include <ATen/mkldnn/Runtime.h>
@@ -66,222 +85,283 @@ std::vector<int64_t> conv_output_size(
   return output_size;
 }
 
-at::Tensor mkldnn_convolution(
-    const at::Tensor& input, const at::Tensor& weight, const at::Tensor& bias,
-    IntList padding, IntList stride, IntList dilation)
+namespace {
+
+// Key of the cached convolution primitives (NCHW input, OIHW weight)
+struct ConvolutionParams {
+  int32_t input_size[4];
+  int32_t weight_size[4];
+  int32_t padding[2];
+  int32_t stride[2];
+  // Forward only: channel_block of the input and output
+  int32_t block;
+  bool bias_defined;
+  bool relu;
+  // Forward only: an inference primitive, whose weight was reordered
+  // beforehand by mkldnn_reorder_conv_weight
+  bool inference;
+};
+
+ConvolutionParams conv_params(
+    IntList input_size, IntList weight_size, IntList padding, IntList stride,
+    bool bias_defined, bool relu, bool inference, int32_t block = 0)
 {
-  auto output = input.type().tensor(conv_output_size(
-    input.sizes(), weight.sizes(), padding, stride, dilation));
-
-  auto cpu_engine = CpuEngine::Instance().get_engine();
-  
-  int32_t n = input.size(0);
-  int32_t ic = input.size(1);
-  int32_t ih = input.size(2);
-  int32_t iw = input.size(3);
-
-  int32_t oc = output.size(1);
-  int32_t oh = output.size(2);
-  int32_t ow = output.size(3);
+  ConvolutionParams params;
+  memset(&params, 0, sizeof(params));
+  for (int i = 0; i < 4; ++i) {
+    params.input_size[i] = input_size[i];
+    params.weight_size[i] = weight_size[i];
+  }
+  for (int i = 0; i < 2; ++i) {
+    params.padding[i] = padding[i];
+    params.stride[i] = stride[i];
+  }
+  params.bias_defined = bias_defined;
+  params.relu = relu;
+  params.inference = inference;
+  params.block = block;
+  return params;
+}
 
-  int32_t kh = weight.size(2);
-  int32_t kw = weight.size(3);
+struct ConvolutionDims {
+  memory::dims input, weight, bias, output, stride, padding;
+
+  explicit ConvolutionDims(const ConvolutionParams& p)
+    : input(p.input_size, p.input_size + 4)
+    , weight(p.weight_size, p.weight_size + 4)
+    , bias{p.weight_size[0]}
+    , output{p.input_size[0], p.weight_size[0],
+             (p.input_size[2] + 2 * p.padding[0] - p.weight_size[2]) / p.stride[0] + 1,
+             (p.input_size[3] + 2 * p.padding[1] - p.weight_size[3]) / p.stride[1] + 1}
+    , stride(p.stride, p.stride + 2)
+    , padding(p.padding, p.padding + 2) {}
+};
+
+// The checks mkldnn_convolution leaves to ConvParams::use_mkldnn
+void check_conv_args(
+    const char* name, const Tensor& input, IntList input_size, IntList weight_size,
+    IntList padding, IntList stride, IntList dilation)
+{
+  AT_CHECK(input.type().backend() == kCPU && input.type().scalarType() == kFloat,
+           name, ": expected a CPU float input, got ", input.toString());
+  AT_CHECK(input_size.size() == 4 && weight_size.size() == 4,
+           name, ": expected 4-d input and weight, got ", input_size.size(), "-d and ",
+           weight_size.size(), "-d");
+  AT_CHECK(padding.size() == 2 && stride.size() == 2 && dilation.size() == 2,
+           name, ": expected 2 paddings, strides and dilations");
+  AT_CHECK(dilation[0] == 1 && dilation[1] == 1,
+           name, ": dilated convolution is not supported");
+}
 
-  int32_t sh = stride[0];
-  int32_t sw = stride[1];
-  int32_t ph = padding[0];
-  int32_t pw = padding[1];
+// Doesn't depend on p.block, since the primitive picks its own layouts
+std::shared_ptr<convolution_forward::primitive_desc> conv_forward_pd(
+    const ConvolutionParams& p, prop_kind kind)
+{
+  ConvolutionDims d(p);
 
   auto data_t = memory::data_type::f32;
   auto format_any = memory::format::any;
-  auto format_nchw = memory::format::nchw;
-  auto format_oihw = memory::format::oihw;
-  auto format_x = memory::format::x;
-
-  memory::dims input_tz = {n, ic, ih, iw};
-  memory::dims weight_tz = {oc, ic, kh, kw};
-  memory::dims bias_tz = {oc};
-  memory::dims output_tz = {n, oc, oh, ow};
-  memory::dims _stride = {sh, sw};
-  memory::dims _padding = {ph, pw};
 
-  auto input_md = memory::desc({input_tz}, data_t, format_any);
-  auto weight_md = memory::desc({weight_tz}, data_t, format_any);
-  auto bias_md = memory::desc({bias_tz}, data_t, format_any);
-  auto output_md = memory::desc({output_tz}, data_t, format_any);
+  auto input_md = memory::desc({d.input}, data_t, format_any);
+  auto weight_md = memory::desc({d.weight}, data_t, format_any);
+  auto bias_md = memory::desc({d.bias}, data_t, format_any);
+  auto output_md = memory::desc({d.output}, data_t, format_any);
 
   std::shared_ptr<convolution_forward::desc> conv_forward_desc;
-  if (bias.defined()) {
-    conv_forward_desc.reset(new convolution_forward::desc(prop_kind::forward,
+  if (p.bias_defined) {
+    conv_forward_desc.reset(new convolution_forward::desc(kind,
       convolution_direct, input_md, weight_md, bias_md, output_md,
-      _stride, _padding, _padding, padding_kind::zero));
+      d.stride, d.padding, d.padding, padding_kind::zero));
   } else {
-    conv_forward_desc.reset(new convolution_forward::desc(prop_kind::forward,
+    conv_forward_desc.reset(new convolution_forward::desc(kind,
       convolution_direct, input_md, weight_md, output_md,
-      _stride, _padding, _padding, padding_kind::zero));
+      d.stride, d.padding, d.padding, padding_kind::zero));
   }
 
-  std::shared_ptr<convolution_forward::primitive_desc> conv_forward_pd;
-  conv_forward_pd.reset(new convolution_forward::primitive_desc(
-    *conv_forward_desc, cpu_engine));
-
-  auto input_usr_memory = memory({{{input_tz}, data_t, format_nchw}, cpu_engine},
-    input.data_ptr());
-  auto weight_usr_memory = memory({{{weight_tz}, data_t,  format_oihw}, cpu_engine},
-    weight.data_ptr());
-  auto output_usr_memory = memory({{{output_tz}, data_t, format_nchw}, cpu_engine},
-    output.data_ptr());
+  primitive_attr attr;
+  if (p.relu) {
+    post_ops ops;
+    ops.append_eltwise(1.0f, algorithm::eltwise_relu, 0.0f, 0.0f);
+    attr.set_post_ops(ops);
+  }
 
-  std::vector<primitive> net;
+  return std::make_shared<convolution_forward::primitive_desc>(
+    *conv_forward_desc, attr, CpuEngine::Instance().get_engine());
+}
 
-  auto input_pd = conv_forward_pd->src_primitive_desc();
-  auto input_memory = input_usr_memory;
-  if (input_usr_memory.get_primitive_desc() != memory::primitive_desc(input_pd)) {
-    input_memory = memory(input_pd);
-    net.push_back(reorder(input_usr_memory, input_memory));
-  }
+struct ConvolutionForward {
+  std::shared_ptr<convolution_forward::primitive_desc> pd;
+  PrimitiveNet net;
+};
 
-  auto weight_pd = conv_forward_pd->weights_primitive_desc();
-  auto weight_memory = weight_usr_memory;
-  if (weight_usr_memory.get_primitive_desc() != memory::primitive_desc(weight_pd)) {
-    weight_memory = memory(weight_pd);
-    net.push_back(reorder(weight_usr_memory, weight_memory));
-  }
+std::shared_ptr<ConvolutionForward> make_conv_forward(const ConvolutionParams& p)
+{
+  auto cpu_engine = CpuEngine::Instance().get_engine();
+  ConvolutionDims d(p);
 
-  auto output_pd = conv_forward_pd->dst_primitive_desc();
-  auto output_memory = output_usr_memory;
-  if (output_usr_memory.get_primitive_desc() != memory::primitive_desc(output_pd)) {
-    output_memory = memory(output_pd);
-  }
+  auto data_t = memory::data_type::f32;
+  auto format_nchw = nchw_format(p.block);
+  auto format_oihw = memory::format::oihw;
+  auto format_x = memory::format::x;
 
-  std::shared_ptr<convolution_forward> conv_forward;
-  std::shared_ptr<memory> bias_usr_memory;
-  if (bias.defined()) {
-    bias_usr_memory.reset(new memory({{{bias_tz}, data_t, format_x}, cpu_engine},
-      bias.data_ptr()));
-    conv_forward.reset(new convolution_forward(*conv_forward_pd, input_memory,
-      weight_memory, *bias_usr_memory, output_memory));
+  auto conv = std::make_shared<ConvolutionForward>();
+  conv->pd = conv_forward_pd(p, p.inference ? prop_kind::forward_inference : prop_kind::forward);
+  auto& net = conv->net;
+
+  auto input_memory = net.input({{{d.input}, data_t, format_nchw}, cpu_engine},
+    conv->pd->src_primitive_desc());
+  auto weight_usr_pd = p.inference
+    ? conv->pd->weights_primitive_desc()
+    : memory::primitive_desc({{d.weight}, data_t, format_oihw}, cpu_engine);
+  auto weight_memory = net.input(weight_usr_pd, conv->pd->weights_primitive_desc());
+
+  if (p.bias_defined) {
+    auto bias_memory = net.input({{{d.bias}, data_t, format_x}, cpu_engine},
+      conv->pd->bias_primitive_desc());
+    auto output_memory = net.output({{{d.output}, data_t, format_nchw}, cpu_engine},
+      conv->pd->dst_primitive_desc());
+    net.add(convolution_forward(*conv->pd, input_memory, weight_memory,
+      bias_memory, output_memory));
   } else {
-    conv_forward.reset(new convolution_forward(*conv_forward_pd, input_memory,
-      weight_memory, output_memory));
+    auto output_memory = net.output({{{d.output}, data_t, format_nchw}, cpu_engine},
+      conv->pd->dst_primitive_desc());
+    net.add(convolution_forward(*conv->pd, input_memory, weight_memory,
+      output_memory));
   }
-  net.push_back(*conv_forward);
 
-  if (output_memory != output_usr_memory) {
-    net.push_back(reorder(output_memory, output_usr_memory));
-  }
-
-  Stream::Instance().get_stream().submit(net);
-
-  return output;
+  return conv;
 }
 
-Tensor mkldnn_convolution_backward_input(
-    IntList input_size, const at::Tensor& grad_output, const at::Tensor& weight,
-    IntList padding, IntList stride, IntList dilation, bool bias_defined)
+std::shared_ptr<PrimitiveNet> make_conv_backward_data(const ConvolutionParams& p)
 {
-  auto grad_input = grad_output.type().tensor(input_size);
-
   auto cpu_engine = CpuEngine::Instance().get_engine();
+  ConvolutionDims d(p);
 
-  int32_t n = grad_input.size(0);
-  int32_t ic = grad_input.size(1);
-  int32_t ih = grad_input.size(2);
-  int32_t iw = grad_input.size(3);
+  auto data_t = memory::data_type::f32;
+  auto format_any = memory::format::any;
+  auto format_nchw = memory::format::nchw;
+  auto format_oihw = memory::format::oihw;
+
+  auto input_md = memory::desc({d.input}, data_t, format_any);
+  auto weight_md = memory::desc({d.weight}, data_t, format_any);
+  auto output_md = memory::desc({d.output}, data_t, format_any);
 
-  int32_t oc = grad_output.size(1);
-  int32_t oh = grad_output.size(2);
-  int32_t ow = grad_output.size(3);
+  // need the forward primitive descriptor as a hint
+  auto conv_backward_data_desc = convolution_backward_data::desc(
+    convolution_direct, input_md, weight_md, output_md,
+    d.stride, d.padding, d.padding, padding_kind::zero);
+  auto conv_backward_data_pd = convolution_backward_data::primitive_desc(
+    conv_backward_data_desc, cpu_engine, *conv_forward_pd(p, prop_kind::forward));
+
+  auto net = std::make_shared<PrimitiveNet>();
+  auto grad_output_memory = net->input({{{d.output}, data_t, format_nchw}, cpu_engine},
+    conv_backward_data_pd.diff_dst_primitive_desc());
+  auto weight_memory = net->input({{{d.weight}, data_t, format_oihw}, cpu_engine},
+    conv_backward_data_pd.weights_primitive_desc());
+  auto grad_input_memory = net->output({{{d.input}, data_t, format_nchw}, cpu_engine},
+    conv_backward_data_pd.diff_src_primitive_desc());
+  net->add(convolution_backward_data(conv_backward_data_pd,
+    grad_output_memory, weight_memory, grad_input_memory));
 
-  int32_t kh = weight.size(2);
-  int32_t kw = weight.size(3);
+  return net;
+}
 
-  int32_t sh = stride[0];
-  int32_t sw = stride[1];
-  int32_t ph = padding[0];
-  int32_t pw = padding[1];
+std::shared_ptr<PrimitiveNet> make_conv_backward_weights(const ConvolutionParams& p)
+{
+  auto cpu_engine = CpuEngine::Instance().get_engine();
+  ConvolutionDims d(p);
 
   auto data_t = memory::data_type::f32;
   auto format_any = memory::format::any;
   auto format_nchw = memory::format::nchw;
   auto format_oihw = memory::format::oihw;
+  auto format_x = memory::format::x;
 
-  memory::dims input_tz = {n, ic, ih, iw};
-  memory::dims weight_tz = {oc, ic, kh, kw};
-  memory::dims bias_tz = {oc};
-  memory::dims output_tz = {n, oc, oh, ow};
-  memory::dims _stride = {sh, sw};
-  memory::dims _padding = {ph, pw};
-
-  auto input_md = memory::desc({input_tz}, data_t, format_any);
-  auto weight_md = memory::desc({weight_tz}, data_t, format_any);
-  auto bias_md = memory::desc({bias_tz}, data_t, format_any);
-  auto output_md = memory::desc({output_tz}, data_t, format_any);
+  auto input_md = memory::desc({d.input}, data_t, format_any);
+  auto weight_md = memory::desc({d.weight}, data_t, format_any);
+  auto bias_md = memory::desc({d.bias}, data_t, format_any);
+  auto output_md = memory::desc({d.output}, data_t, format_any);
 
-  // need to re-create conv_forward_pd to feed conv_backward_data_pd
-  std::shared_ptr<convolution_forward::desc> conv_forward_desc;
-  if (bias_defined) {
-    conv_forward_desc.reset(new convolution_forward::desc(prop_kind::forward,
+  // need the forward primitive descriptor as a hint
+  std::shared_ptr<convolution_backward_weights::desc> conv_backward_weight_desc;
+  if (p.bias_defined) {
+    conv_backward_weight_desc.reset(new convolution_backward_weights::desc(
       convolution_direct, input_md, weight_md, bias_md, output_md,
-      _stride, _padding, _padding, padding_kind::zero));
+      d.stride, d.padding, d.padding, padding_kind::zero));
   } else {
-    conv_forward_desc.reset(new convolution_forward::desc(prop_kind::forward,
+    conv_backward_weight_desc.reset(new convolution_backward_weights::desc(
       convolution_direct, input_md, weight_md, output_md,
-      _stride, _padding, _padding, padding_kind::zero));
+      d.stride, d.padding, d.padding, padding_kind::zero));
+  }
+  auto conv_backward_weight_pd = convolution_backward_weights::primitive_desc(
+    *conv_backward_weight_desc, cpu_engine, *conv_forward_pd(p, prop_kind::forward));
+
+  auto net = std::make_shared<PrimitiveNet>();
+  auto input_memory = net->input({{{d.input}, data_t, format_nchw}, cpu_engine},
+    conv_backward_weight_pd.src_primitive_desc());
+  auto grad_output_memory = net->input({{{d.output}, data_t, format_nchw}, cpu_engine},
+    conv_backward_weight_pd.diff_dst_primitive_desc());
+  auto grad_weight_memory = net->output({{{d.weight}, data_t, format_oihw}, cpu_engine},
+    conv_backward_weight_pd.diff_weights_primitive_desc());
+
+  if (p.bias_defined) {
+    auto grad_bias_memory = net->output({{{d.bias}, data_t, format_x}, cpu_engine},
+      conv_backward_weight_pd.diff_bias_primitive_desc());
+    net->add(convolution_backward_weights(conv_backward_weight_pd,
+      input_memory, grad_output_memory, grad_weight_memory, grad_bias_memory));
+  } else {
+    net->add(convolution_backward_weights(conv_backward_weight_pd,
+      input_memory, grad_output_memory, grad_weight_memory));
   }
 
-  std::shared_ptr<convolution_forward::primitive_desc> conv_forward_pd;
-  conv_forward_pd.reset(new convolution_forward::primitive_desc(
-    *conv_forward_desc, cpu_engine));
-
-  std::shared_ptr<convolution_backward_data::desc> conv_backward_data_desc;
-  conv_backward_data_desc.reset(new convolution_backward_data::desc(
-    convolution_direct, input_md, weight_md, output_md,
-    _stride, _padding, _padding, padding_kind::zero));
-
-  std::shared_ptr<convolution_backward_data::primitive_desc> conv_backward_data_pd;
-  conv_backward_data_pd.reset(new convolution_backward_data::primitive_desc(
-    *conv_backward_data_desc, cpu_engine, *conv_forward_pd));
+  return net;
+}
 
-  auto grad_output_usr_memory = memory({{{output_tz}, data_t, format_nchw}, cpu_engine},
-    grad_output.data_ptr());
-  auto weight_usr_memory = memory({{{weight_tz}, data_t, format_oihw}, cpu_engine},
-    weight.data_ptr());
-  auto grad_input_usr_memory = memory({{{input_tz}, data_t, format_nchw}, cpu_engine},
-    grad_input.data_ptr());
+PrimitiveCache<ConvolutionParams, ConvolutionForward> conv_forward_cache;
+PrimitiveCache<ConvolutionParams, PrimitiveNet> conv_backward_data_cache;
+PrimitiveCache<ConvolutionParams, PrimitiveNet> conv_backward_weights_cache;
 
-  std::vector<primitive> net;
+Tensor run_conv_forward(
+    ConvolutionForward& conv, const Tensor& input, IntList input_size,
+    const Tensor& weight, IntList weight_size, const Tensor& bias,
+    IntList padding, IntList stride, IntList dilation, int32_t block = 0)
+{
+  auto output = input.type().tensor(blocked_sizes(conv_output_size(
+    input_size, weight_size, padding, stride, dilation), block));
 
-  auto grad_output_pd = conv_backward_data_pd->diff_dst_primitive_desc();
-  auto grad_output_memory = grad_output_usr_memory;
-  if (grad_output_usr_memory.get_primitive_desc() != memory::primitive_desc(grad_output_pd)) {
-    grad_output_memory = memory(grad_output_pd);
-    net.push_back(reorder(grad_output_usr_memory, grad_output_memory));
+  std::vector<void*> handles = {input.data_ptr(), weight.data_ptr()};
+  if (bias.defined()) {
+    handles.push_back(bias.data_ptr());
   }
+  handles.push_back(output.data_ptr());
+  conv.net.run(handles);
 
-  auto weight_pd = conv_backward_data_pd->weights_primitive_desc();
-  auto weight_memory = weight_usr_memory;
-  if (weight_usr_memory.get_primitive_desc() != memory::primitive_desc(weight_pd)) {
-    weight_memory = memory(weight_pd);
-    net.push_back(reorder(weight_usr_memory, weight_memory));
-  }
+  return output;
+}
 
-  auto grad_input_pd = conv_backward_data_pd->diff_src_primitive_desc();
-  auto grad_input_memory = grad_input_usr_memory;
-  if (grad_input_memory.get_primitive_desc() != memory::primitive_desc(grad_input_pd)) {
-    grad_input_memory = memory(grad_input_pd);
-  }
+} // namespace
 
-  std::shared_ptr<convolution_backward_data> conv_backward_data;
-  conv_backward_data.reset(new convolution_backward_data(*conv_backward_data_pd,
-    grad_output_memory, weight_memory, grad_input_memory));
-  net.push_back(*conv_backward_data);
+at::Tensor mkldnn_convolution(
+    const at::Tensor& input, const at::Tensor& weight, const at::Tensor& bias,
+    IntList padding, IntList stride, IntList dilation)
+{
+  auto conv = conv_forward_cache.get(conv_params(
+    input.sizes(), weight.sizes(), padding, stride, bias.defined(), false, false),
+    make_conv_forward);
+  return run_conv_forward(*conv, input, input.sizes(), weight, weight.sizes(), bias,
+    padding, stride, dilation);
+}
 
-  if (grad_input_memory != grad_input_usr_memory) {
-    net.push_back(reorder(grad_input_memory, grad_input_usr_memory));
-  }
+Tensor mkldnn_convolution_backward_input(
+    IntList input_size, const at::Tensor& grad_output, const at::Tensor& weight,
+    IntList padding, IntList stride, IntList dilation, bool bias_defined)
+{
+  auto grad_input = grad_output.type().tensor(input_size);
 
-  Stream::Instance().get_stream().submit(net);
+  auto net = conv_backward_data_cache.get(conv_params(
+    input_size, weight.sizes(), padding, stride, bias_defined, false, false),
+    make_conv_backward_data);
+  net->run({grad_output.data_ptr(), weight.data_ptr(), grad_input.data_ptr()});
 
   return grad_input;
 }
@@ -297,122 +377,14 @@ std::tuple<at::Tensor, at::Tensor> mkldnn_convolution_backward_weights(
     grad_bias = grad_output.type().tensor({grad_output.size(1)});
   }
 
-  auto cpu_engine = CpuEngine::Instance().get_engine();
-
-  int32_t n = input.size(0);
-  int32_t ic = input.size(1);
-  int32_t ih = input.size(2);
-  int32_t iw = input.size(3);
-
-  int32_t oc = grad_output.size(1);
-  int32_t oh = grad_output.size(2);
-  int32_t ow = grad_output.size(3);
-
-  int32_t kh = grad_weight.size(2);
-  int32_t kw = grad_weight.size(3);
-
-  int32_t sh = stride[0];
-  int32_t sw = stride[1];
-  int32_t ph = padding[0];
-  int32_t pw = padding[1];
-
-  auto data_t = memory::data_type::f32;
-  auto format_any = memory::format::any;
-  auto format_nchw = memory::format::nchw;
-  auto format_oihw = memory::format::oihw;
-  auto format_x = memory::format::x;
-
-  memory::dims input_tz = {n, ic, ih, iw};
-  memory::dims weight_tz = {oc, ic, kh, kw};
-  memory::dims bias_tz = {oc};
-  memory::dims output_tz = {n, oc, oh, ow};
-  memory::dims _stride = {sh, sw};
-  memory::dims _padding = {ph, pw};
-
-  memory::desc input_md({input_tz}, data_t, format_any);
-  memory::desc weight_md({weight_tz}, data_t, format_any);
-  memory::desc bias_md({bias_tz}, data_t, format_any);
-  memory::desc output_md({output_tz}, data_t, format_any);
-
-  // need to re-create conv_forward_pd to feed conv_backward_weight_pd
-  std::shared_ptr<convolution_forward::desc> conv_forward_desc;
-  if (bias_defined) {
-    conv_forward_desc.reset(new convolution_forward::desc(prop_kind::forward,
-      convolution_direct, input_md, weight_md, bias_md, output_md,
-      _stride, _padding, _padding, padding_kind::zero));
-  } else {
-    conv_forward_desc.reset(new convolution_forward::desc(prop_kind::forward,
-      convolution_direct, input_md, weight_md, output_md,
-      _stride, _padding, _padding, padding_kind::zero));
-  }
-
-  std::shared_ptr<convolution_forward::primitive_desc> conv_forward_pd;
-  conv_forward_pd.reset(new convolution_forward::primitive_desc(
-    *conv_forward_desc, cpu_engine));
-
-  std::shared_ptr<convolution_backward_weights::desc> conv_backward_weight_desc;
-  if (bias_defined) {
-    conv_backward_weight_desc.reset(new convolution_backward_weights::desc(
-      convolution_direct, input_md, weight_md, bias_md, output_md,
-      _stride, _padding, _padding, padding_kind::zero));
-  } else {
-    conv_backward_weight_desc.reset(new convolution_backward_weights::desc(
-      convolution_direct, input_md, weight_md, output_md,
-      _stride, _padding, _padding, padding_kind::zero));
-  }
-
-  std::shared_ptr<convolution_backward_weights::primitive_desc> conv_backward_weight_pd;
-  conv_backward_weight_pd.reset(new convolution_backward_weights::primitive_desc(
-    *conv_backward_weight_desc, cpu_engine, *conv_forward_pd));
-
-  auto input_usr_memory = memory({{{input_tz}, data_t, format_nchw}, cpu_engine},
-    input.data_ptr());
-  auto grad_output_usr_memory = memory({{{output_tz}, data_t, format_nchw}, cpu_engine},
-    grad_output.data_ptr());
-  auto grad_weight_usr_memory = memory({{{weight_tz}, data_t, format_oihw}, cpu_engine},
-    grad_weight.data_ptr());
-  std::shared_ptr<memory> grad_bias_memory;
-
-  std::vector<primitive> net;
-
-  auto input_pd = conv_backward_weight_pd->src_primitive_desc();
-  auto input_memory = input_usr_memory;
-  if (input_usr_memory.get_primitive_desc() != memory::primitive_desc(input_pd)) {
-    input_memory = memory(input_pd);
-    net.push_back(reorder(input_usr_memory, input_memory));
-  }
-
-  auto grad_output_pd = conv_backward_weight_pd->diff_dst_primitive_desc();
-  auto grad_output_memory = grad_output_usr_memory;
-  if (grad_output_usr_memory.get_primitive_desc() != memory::primitive_desc(grad_output_pd)) {
-    grad_output_memory = memory(grad_output_pd);
-    net.push_back(reorder(grad_output_usr_memory, grad_output_memory));
-  }
-
-  auto grad_weight_pd = conv_backward_weight_pd->diff_weights_primitive_desc();
-  auto grad_weight_memory = grad_weight_usr_memory;
-  if (grad_weight_usr_memory.get_primitive_desc() != memory::primitive_desc(grad_weight_pd)) {
-    grad_weight_memory = memory(grad_weight_pd);
-  }
-
-  std::shared_ptr<convolution_backward_weights> conv_backward_weight;
+  auto net = conv_backward_weights_cache.get(conv_params(
+    input.sizes(), weight_size, padding, stride, bias_defined, false, false),
+    make_conv_backward_weights);
+  std::vector<void*> handles = {input.data_ptr(), grad_output.data_ptr(), grad_weight.data_ptr()};
   if (bias_defined) {
-    grad_bias_memory.reset(new memory({{{bias_tz}, data_t, format_x}, cpu_engine},
-      grad_bias.data_ptr()));
-    conv_backward_weight.reset(new convolution_backward_weights(*conv_backward_weight_pd,
-      input_memory, grad_output_memory, grad_weight_memory, *grad_bias_memory));
-  } else {
-    conv_backward_weight.reset(new convolution_backward_weights(*conv_backward_weight_pd,
-      input_memory, grad_output_memory, grad_weight_memory));
-  }
-
-  net.push_back(*conv_backward_weight);
-
-  if (grad_weight_memory != grad_weight_usr_memory) {
-    net.push_back(reorder(grad_weight_memory, grad_weight_usr_memory));
+    handles.push_back(grad_bias.data_ptr());
   }
-
-  Stream::Instance().get_stream().submit(net);
+  net->run(handles);
 
   return std::tuple<at::Tensor, at::Tensor>{grad_weight, grad_bias};
 }
@@ -436,6 +408,78 @@ std::tuple<at::Tensor,at::Tensor,at::Tensor> mkldnn_convolution_backward(
   return std::tuple<Tensor, Tensor, Tensor>{grad_input, grad_weight, grad_bias};
 }
 
+at::Tensor mkldnn_convolution_relu(
+    const at::Tensor& input_t, const at::Tensor& weight_t, const at::Tensor& bias_t,
+    IntList padding, IntList stride, IntList dilation)
+{
+  check_conv_args("mkldnn_convolution_relu", input_t, input_t.sizes(), weight_t.sizes(),
+                  padding, stride, dilation);
+  auto input = input_t.contiguous();
+  auto weight = weight_t.contiguous();
+  auto bias = bias_t.defined() ? bias_t.contiguous() : bias_t;
+
+  auto conv = conv_forward_cache.get(conv_params(
+    input.sizes(), weight.sizes(), padding, stride, bias.defined(), true, false),
+    make_conv_forward);
+  return run_conv_forward(*conv, input, input.sizes(), weight, weight.sizes(), bias,
+    padding, stride, dilation);
+}
+
+at::Tensor mkldnn_reorder_conv_weight(
+    const at::Tensor& weight_t, IntList input_size, IntList padding, IntList stride,
+    IntList dilation, bool bias_defined, bool relu)
+{
+  auto weight = weight_t.contiguous();
+  AT_CHECK(weight.type().backend() == kCPU && weight.type().scalarType() == kFloat,
+           "mkldnn_reorder_conv_weight: expected a CPU float weight, got ", weight.toString());
+  AT_CHECK(input_size.size() == 4 && weight.dim() == 4,
+           "mkldnn_reorder_conv_weight: expected 4-d input and weight, got ",
+           input_size.size(), "-d and ", weight.dim(), "-d");
+  AT_CHECK(dilation.size() == 2 && dilation[0] == 1 && dilation[1] == 1,
+           "mkldnn_reorder_conv_weight: dilated convolution is not supported");
+
+  auto params = conv_params(input_size, weight.sizes(), padding, stride, bias_defined, relu, true);
+  auto conv = conv_forward_cache.get(params, make_conv_forward);
+  auto weight_pd = conv->pd->weights_primitive_desc();
+  auto reordered = weight.type().tensor({static_cast<int64_t>(weight_pd.get_size() / sizeof(float))});
+
+  auto cpu_engine = CpuEngine::Instance().get_engine();
+  ConvolutionDims d(params);
+  auto weight_usr_memory = memory({{{d.weight}, memory::data_type::f32, memory::format::oihw}, cpu_engine},
+    weight.data_ptr());
+  auto weight_memory = memory(weight_pd, reordered.data_ptr());
+
+  std::vector<primitive> net;
+  net.push_back(reorder(weight_usr_memory, weight_memory));
+  Stream::Instance().get_stream().submit(net);
+
+  return reordered;
+}
+
+at::Tensor mkldnn_convolution_inference(
+    const at::Tensor& input_t, const at::Tensor& weight, IntList weight_size, const at::Tensor& bias_t,
+    IntList padding, IntList stride, IntList dilation, bool relu)
+{
+  // A blocked input makes a blocked output
+  auto block = channel_block(input_t);
+  auto input_size = nchw_sizes(input_t);
+  check_conv_args("mkldnn_convolution_inference", input_t, input_size, weight_size,
+                  padding, stride, dilation);
+  auto input = input_t.contiguous();
+  auto bias = bias_t.defined() ? bias_t.contiguous() : bias_t;
+
+  // The weight layout doesn't depend on the block, see conv_forward_pd
+  auto conv = conv_forward_cache.get(conv_params(
+    input_size, weight_size, padding, stride, bias.defined(), relu, true, block),
+    make_conv_forward);
+  AT_CHECK(weight.is_contiguous() &&
+           weight.numel() * sizeof(float) == conv->pd->weights_primitive_desc().get_size(),
+           "mkldnn_convolution_inference: weight must be the result of mkldnn_reorder_conv_weight "
+           "for this input size, bias and relu");
+  return run_conv_forward(*conv, input, input_size, weight, weight_size, bias,
+    padding, stride, dilation, block);
+}
+
 }}  // namespace at::native
 
 #endif
@@ -0,0 +1,31 @@
+#include <ATen/ATen.h>
+#include <ATen/NativeFunctions.h>
+
+// Conversions between NCHW tensors and the blocked tensors of the MKL-DNN
+// ops (see ATen/mkldnn/Runtime.h). These are plain ATen ops, so they are
+// differentiable and don't need MKL-DNN.
+
+namespace at { namespace native {
+
+Tensor mkldnn_to_blocked(const Tensor& self, int64_t block) {
+  AT_CHECK(self.dim() == 4,
+           "mkldnn_to_blocked: expected a 4-d NCHW tensor, got ", self.dim(), "-d");
+  AT_CHECK(block == 8 || block == 16,
+           "mkldnn_to_blocked: block must be 8 or 16, got ", block);
+  AT_CHECK(self.size(1) % block == 0,
+           "mkldnn_to_blocked: the ", self.size(1),
+           " channels are not a multiple of the block size ", block);
+  return self.reshape({self.size(0), self.size(1) / block, block, self.size(2), self.size(3)})
+             .permute({0, 1, 3, 4, 2})
+             .contiguous();
+}
+
+Tensor mkldnn_from_blocked(const Tensor& self) {
+  AT_CHECK(self.dim() == 5 && (self.size(4) == 8 || self.size(4) == 16),
+           "mkldnn_from_blocked: expected a 5-d blocked tensor, got size ", self.sizes());
+  return self.permute({0, 1, 4, 2, 3})
+             .contiguous()
+             .view({self.size(0), self.size(1) * self.size(4), self.size(2), self.size(3)});
+}
+
+}} // namespace at::native
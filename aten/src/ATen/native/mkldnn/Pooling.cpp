@@ -0,0 +1,158 @@
+#include <ATen/ATen.h>
+#include <ATen/NativeFunctions.h>
+#include <ATen/Config.h>
+
+#if !AT_MKLDNN_ENABLED()
+
+namespace at { namespace native {
+
+at::Tensor mkldnn_max_pool2d(
+    const at::Tensor& input, IntList kernel_size, IntList stride, IntList padding,
+    bool ceil_mode) {
+  throw std::runtime_error("mkldnn_max_pool2d: ATen not compiled with MKLDNN support");
+}
+
+at::Tensor mkldnn_avg_pool2d(
+    const at::Tensor& input, IntList kernel_size, IntList stride, IntList padding,
+    bool ceil_mode, bool count_include_pad) {
+  throw std::runtime_error("mkldnn_avg_pool2d: ATen not compiled with MKLDNN support");
+}
+
+}}
+
+#else // AT_MKLDNN_EBABLED
+
+#include <ATen/mkldnn/Runtime.h>
+
+#include <algorithm>
+
+using namespace mkldnn;
+
+namespace at { namespace native {
+
+namespace {
+
+// Key of the cached pooling primitives
+struct PoolingParams {
+  int32_t input_size[4];  // NCHW
+  int32_t block;          // channel_block of the input and output
+  int32_t output_size[2];
+  int32_t kernel_size[2];
+  int32_t stride[2];
+  int32_t padding_l[2];
+  int32_t padding_r[2];
+  algorithm algo;
+};
+
+std::shared_ptr<PrimitiveNet> make_pooling(const PoolingParams& p)
+{
+  auto cpu_engine = CpuEngine::Instance().get_engine();
+
+  auto data_t = memory::data_type::f32;
+  auto format_nchw = nchw_format(p.block);
+
+  memory::dims input_tz(p.input_size, p.input_size + 4);
+  memory::dims output_tz = {p.input_size[0], p.input_size[1], p.output_size[0], p.output_size[1]};
+  memory::dims kernel(p.kernel_size, p.kernel_size + 2);
+  memory::dims _stride(p.stride, p.stride + 2);
+  memory::dims padding_l(p.padding_l, p.padding_l + 2);
+  memory::dims padding_r(p.padding_r, p.padding_r + 2);
+
+  auto input_md = memory::desc({input_tz}, data_t, format_nchw);
+  auto output_md = memory::desc({output_tz}, data_t, format_nchw);
+
+  // Unlike the training one, the inference primitive doesn't save the
+  // indices of the maxima
+  auto pool_forward_desc = pooling_forward::desc(prop_kind::forward_inference,
+    p.algo, input_md, output_md, _stride, kernel, padding_l, padding_r,
+    padding_kind::zero);
+  auto pool_forward_pd = pooling_forward::primitive_desc(pool_forward_desc, cpu_engine);
+
+  auto net = std::make_shared<PrimitiveNet>();
+  auto input_memory = net->input({input_md, cpu_engine}, {input_md, cpu_engine});
+  auto output_memory = net->output({output_md, cpu_engine},
+    pool_forward_pd.dst_primitive_desc());
+  net->add(pooling_forward(pool_forward_pd, input_memory, output_memory));
+
+  return net;
+}
+
+PrimitiveCache<PoolingParams, PrimitiveNet> pooling_cache;
+
+at::Tensor mkldnn_pool2d(
+    const char* name, algorithm algo, const at::Tensor& input_t, IntList kernel_size,
+    IntList stride_, IntList padding, bool ceil_mode, bool count_include_pad)
+{
+  AT_CHECK(input_t.type().backend() == kCPU && input_t.type().scalarType() == kFloat,
+           name, ": expected a CPU float input, got ", input_t.toString());
+  // A blocked input makes a blocked output
+  auto block = channel_block(input_t);
+  auto input_size = nchw_sizes(input_t);
+  AT_CHECK(input_size.size() == 4, name, ": expected 4-d input (NCHW), got ", input_t.dim(), "-d");
+  AT_CHECK(kernel_size.size() == 2 && padding.size() == 2 && (stride_.empty() || stride_.size() == 2),
+           name, ": expected 2 kernel sizes, strides and paddings");
+  auto stride = stride_.empty() ? kernel_size : stride_;
+  auto input = input_t.contiguous();
+
+  PoolingParams params;
+  memset(&params, 0, sizeof(params));
+  for (int i = 0; i < 4; ++i) {
+    params.input_size[i] = input_size[i];
+  }
+  params.block = block;
+  for (int i = 0; i < 2; ++i) {
+    auto in = input_size[i + 2];
+    AT_CHECK(kernel_size[i] > 0 && stride[i] > 0,
+             name, ": kernel size and stride should be greater than zero");
+    AT_CHECK(padding[i] >= 0 && padding[i] <= kernel_size[i] / 2,
+             name, ": pad should be smaller than half of kernel size");
+    // Same output size as THNN: with ceil_mode the last window must still
+    // start inside the input or the left padding
+    int64_t out = (in + 2 * padding[i] - kernel_size[i] + (ceil_mode ? stride[i] - 1 : 0)) / stride[i] + 1;
+    if (ceil_mode && (out - 1) * stride[i] >= in + padding[i]) {
+      --out;
+    }
+    AT_CHECK(out > 0, name, ": output size is too small for input size ", input.sizes());
+    params.output_size[i] = out;
+    params.kernel_size[i] = kernel_size[i];
+    params.stride[i] = stride[i];
+    params.padding_l[i] = padding[i];
+    // Just enough padding on the right for the last window
+    params.padding_r[i] = std::max<int64_t>((out - 1) * stride[i] + kernel_size[i] - in - padding[i], 0);
+    // THNN excludes the windows' overhang past the right padding from the
+    // averages, which MKL-DNN would count as padding
+    AT_CHECK(!count_include_pad || params.padding_r[i] <= padding[i],
+             name, ": ceil_mode with count_include_pad is not supported for input size ", input.sizes());
+  }
+  params.algo = algo;
+
+  auto output = input.type().tensor(blocked_sizes({params.input_size[0], params.input_size[1],
+                                                   params.output_size[0], params.output_size[1]},
+                                                  block));
+  pooling_cache.get(params, make_pooling)->run({input.data_ptr(), output.data_ptr()});
+
+  return output;
+}
+
+} // namespace
+
+at::Tensor mkldnn_max_pool2d(
+    const at::Tensor& input, IntList kernel_size, IntList stride, IntList padding,
+    bool ceil_mode)
+{
+  return mkldnn_pool2d("mkldnn_max_pool2d", pooling_max, input, kernel_size,
+    stride, padding, ceil_mode, false);
+}
+
+at::Tensor mkldnn_avg_pool2d(
+    const at::Tensor& input, IntList kernel_size, IntList stride, IntList padding,
+    bool ceil_mode, bool count_include_pad)
+{
+  return mkldnn_pool2d("mkldnn_avg_pool2d",
+    count_include_pad ? pooling_avg_include_padding : pooling_avg_exclude_padding,
+    input, kernel_size, stride, padding, ceil_mode, count_include_pad);
+}
+
+}}  // namespace at::native
+
+#endif
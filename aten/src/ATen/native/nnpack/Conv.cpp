@@ -0,0 +1,187 @@
+#include <ATen/ATen.h>
+#include <ATen/NativeFunctions.h>
+#include <ATen/Config.h>
+
+#if !AT_NNPACK_ENABLED()
+
+namespace at { namespace native {
+
+at::Tensor _nnpack_spatial_convolution(
+    const at::Tensor& input, const at::Tensor& weight, const at::Tensor& bias,
+    IntList padding) {
+  throw std::runtime_error("_nnpack_spatial_convolution: ATen not compiled with NNPACK support");
+}
+
+std::tuple<at::Tensor,at::Tensor,at::Tensor> _nnpack_spatial_convolution_backward(
+    const at::Tensor& input, const at::Tensor& grad_output, const at::Tensor& weight,
+    IntList padding, std::array<bool,3> output_mask) {
+  throw std::runtime_error("_nnpack_spatial_convolution_backward: ATen not compiled with NNPACK support");
+}
+
+}}
+
+#else // AT_NNPACK_ENABLED
+
+#include <ATen/CPUGeneral.h>
+
+#include <nnpack.h>
+
+#include <mutex>
+
+namespace at { namespace native {
+
+namespace {
+
+// NNPACK threads run on a pthreadpool rather than on the TBB scheduler of
+// ATen/Parallel.h, so we keep one pool per process, recreated when the
+// number of threads requested with at::set_num_threads changes. A null pool
+// makes NNPACK run on the calling thread.
+pthreadpool_t nnpack_threadpool() {
+  static std::mutex mutex;
+  static pthreadpool_t pool = nullptr;
+  static int pool_threads = -2;
+  int num_threads = at::get_num_threads();
+  if (num_threads == 0 || num_threads == 1) {
+    return nullptr;
+  }
+  std::lock_guard<std::mutex> lock(mutex);
+  if (num_threads != pool_threads) {
+    if (pool) {
+      pthreadpool_destroy(pool);
+    }
+    // 0 threads means one per core
+    pool = pthreadpool_create(num_threads < 0 ? 0 : num_threads);
+    pool_threads = num_threads;
+  }
+  return pool;
+}
+
+void check_nnpack_status(const char* name, nnp_status status) {
+  AT_CHECK(status == nnp_status_success, name, ": NNPACK failed with status ",
+           static_cast<int>(status));
+}
+
+void check_nnpack_args(const char* name, const Tensor& input, const Tensor& weight,
+                       IntList padding) {
+  AT_CHECK(hasNNPACK(), name, ": NNPACK is not supported on this CPU");
+  AT_CHECK(input.type().backend() == kCPU && input.type().scalarType() == kFloat,
+           name, ": expected a CPU float input, got ", input.toString());
+  AT_CHECK(input.type() == weight.type(), name, ": expected input and weight of the same type, got ",
+           input.toString(), " and ", weight.toString());
+  AT_CHECK(input.dim() == 4 && weight.dim() == 4,
+           name, ": expected 4-d input and weight, got ", input.dim(), "-d and ",
+           weight.dim(), "-d");
+  AT_CHECK(input.size(1) == weight.size(1), name, ": expected ", weight.size(1),
+           " input channels, got ", input.size(1));
+  AT_CHECK(padding.size() == 2 && padding[0] >= 0 && padding[0] < weight.size(2) &&
+           padding[1] >= 0 && padding[1] < weight.size(3),
+           name, ": expected a non-negative padding smaller than the kernel size, got ", padding);
+}
+
+// Winograd F(6x6, 3x3) for 3x3 kernels, and NNPACK's choice between the
+// FFT and implicit GEMM algorithms otherwise
+nnp_convolution_algorithm forward_algorithm(const Tensor& weight) {
+  if (weight.size(2) == 3 && weight.size(3) == 3) {
+    return nnp_convolution_algorithm_wt8x8;
+  }
+  return nnp_convolution_algorithm_auto;
+}
+
+struct NNPACKShape {
+  nnp_size input_size;
+  nnp_padding padding;
+  nnp_size kernel_size;
+
+  NNPACKShape(const Tensor& input, const Tensor& weight, IntList padding_) {
+    input_size.width = input.size(3);
+    input_size.height = input.size(2);
+    padding.top = padding.bottom = padding_[0];
+    padding.left = padding.right = padding_[1];
+    kernel_size.width = weight.size(3);
+    kernel_size.height = weight.size(2);
+  }
+};
+
+} // namespace
+
+// Stride 1 and undilated; input must be (N, C, H, W) float and weight
+// (K, C, kH, kW)
+at::Tensor _nnpack_spatial_convolution(
+    const at::Tensor& input_r, const at::Tensor& weight_r, const at::Tensor& bias_r,
+    IntList padding) {
+  check_nnpack_args("_nnpack_spatial_convolution", input_r, weight_r, padding);
+  auto input = input_r.contiguous();
+  auto weight = weight_r.contiguous();
+  // NNPACK always adds a bias
+  auto bias = bias_r.defined() ? bias_r.contiguous() : weight.type().zeros({weight.size(0)});
+  AT_CHECK(bias.numel() == weight.size(0), "_nnpack_spatial_convolution: expected a bias of ",
+           weight.size(0), " elements, got ", bias.numel());
+
+  NNPACKShape shape(input, weight, padding);
+  auto output = input.type().tensor({
+      input.size(0), weight.size(0),
+      input.size(2) + 2 * padding[0] - weight.size(2) + 1,
+      input.size(3) + 2 * padding[1] - weight.size(3) + 1});
+  AT_CHECK(output.size(2) > 0 && output.size(3) > 0, "_nnpack_spatial_convolution: the input of size ",
+           input.sizes(), " is too small for the kernel of size ", weight.sizes());
+
+  nnp_status status;
+  if (input.size(0) == 1) {
+    // nnp_convolution_output is tuned for batches and
+    // nnp_convolution_inference for single images
+    nnp_size output_subsample = {1, 1};
+    status = nnp_convolution_inference(
+        forward_algorithm(weight), nnp_convolution_transform_strategy_compute,
+        input.size(1), weight.size(0), shape.input_size, shape.padding, shape.kernel_size,
+        output_subsample, input.data<float>(), weight.data<float>(), bias.data<float>(),
+        output.data<float>(), nullptr, nullptr, nnp_activation_identity, nullptr,
+        nnpack_threadpool(), nullptr);
+  } else {
+    status = nnp_convolution_output(
+        forward_algorithm(weight), input.size(0), input.size(1), weight.size(0),
+        shape.input_size, shape.padding, shape.kernel_size,
+        input.data<float>(), weight.data<float>(), bias.data<float>(), output.data<float>(),
+        nullptr, nullptr, nnp_activation_identity, nullptr, nnpack_threadpool(), nullptr);
+  }
+  check_nnpack_status("_nnpack_spatial_convolution", status);
+  return output;
+}
+
+std::tuple<at::Tensor,at::Tensor,at::Tensor> _nnpack_spatial_convolution_backward(
+    const at::Tensor& input_r, const at::Tensor& grad_output_r, const at::Tensor& weight_r,
+    IntList padding, std::array<bool,3> output_mask) {
+  check_nnpack_args("_nnpack_spatial_convolution_backward", input_r, weight_r, padding);
+  auto input = input_r.contiguous();
+  auto grad_output = grad_output_r.contiguous();
+  auto weight = weight_r.contiguous();
+  NNPACKShape shape(input, weight, padding);
+
+  // NNPACK picks the algorithms of the gradients
+  at::Tensor grad_input, grad_weight, grad_bias;
+  if (output_mask[0]) {
+    grad_input = input.type().tensor(input.sizes());
+    auto status = nnp_convolution_input_gradient(
+        nnp_convolution_algorithm_auto, input.size(0), input.size(1), weight.size(0),
+        shape.input_size, shape.padding, shape.kernel_size,
+        grad_output.data<float>(), weight.data<float>(), grad_input.data<float>(),
+        nullptr, nullptr, nnp_activation_identity, nullptr, nnpack_threadpool(), nullptr);
+    check_nnpack_status("_nnpack_spatial_convolution_backward", status);
+  }
+  if (output_mask[1]) {
+    grad_weight = weight.type().tensor(weight.sizes());
+    auto status = nnp_convolution_kernel_gradient(
+        nnp_convolution_algorithm_auto, input.size(0), input.size(1), weight.size(0),
+        shape.input_size, shape.padding, shape.kernel_size,
+        input.data<float>(), grad_output.data<float>(), grad_weight.data<float>(),
+        nullptr, nullptr, nnp_activation_identity, nullptr, nnpack_threadpool(), nullptr);
+    check_nnpack_status("_nnpack_spatial_convolution_backward", status);
+  }
+  if (output_mask[2]) {
+    grad_bias = grad_output.sum({0, 2, 3});
+  }
+  return std::make_tuple(grad_input, grad_weight, grad_bias);
+}
+
+}} // namespace at::native
+
+#endif
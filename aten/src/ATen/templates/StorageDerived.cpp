@@ -127,6 +127,10 @@ auto ${Storage}::free() -> ${Storage}& {
   return *this;
 }
 
+int ${Storage}::use_count() const {
+  return storage->refcount.load();
+}
+
 void* ${Storage}::unsafeGetTH(bool retain) const {
   if (retain) {
     ${THStorage}_retain(${state,} storage);
@@ -27,6 +27,7 @@ public:
   virtual const void* data() const override;
   virtual ${Storage}& retain() override;
   virtual ${Storage}& free() override;
+  virtual int use_count() const override;
   virtual void * unsafeGetTH(bool retain) const override;
 
   virtual ${Storage}& resize(int64_t new_size) override;
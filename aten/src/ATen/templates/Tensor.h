@@ -123,7 +123,7 @@ struct Tensor : public detail::TensorBase {
   Tensor& operator/=(const Tensor & other);
   Tensor& operator/=(Scalar other);
   Tensor operator[](Scalar index) const;
-  Tensor operator[](Tensor index) const;
+  Tensor operator[](const Tensor & index) const;
   Tensor operator[](int64_t index) const;
 
   // ~~~~~ Autograd API ~~~~~
@@ -1,9 +1,9 @@
 // included as 'TensorDenseOrSparse' in TensorDerived.cpp
 
-IntList ${Tensor}::strides() const {
+IntList ${Tensor}::strides_custom() const {
   int64_t d = tensor->nDimension;
   if (d != 0) {
-    return IntList(reinterpret_cast<int64_t*>(tensor->stride),dim());
+    return IntList(reinterpret_cast<int64_t*>(tensor->stride),dim_custom());
   } else {
     return IntList(kEmptyStrides);
   }
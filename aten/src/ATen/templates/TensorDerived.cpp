@@ -19,7 +19,9 @@ ${Tensor}::${Tensor}(Context* context)
 ${Tensor}::${Tensor}(Context* context, ${THTensor} * tensor)
 : TensorImpl(&context->getType(Backend::${Backend},ScalarType::${ScalarName})),
   tensor(tensor),
-  context(context) {}
+  context(context) {
+  ${TensorImpl_metadata}
+}
 ${Tensor}::~${Tensor}() {
   ${THTensor}_free(${state,} tensor);
 }
@@ -28,17 +30,17 @@ const char * ${Tensor}::toString() const {
   return "${Tensor}";
 }
 
-IntList ${Tensor}::sizes() const {
+IntList ${Tensor}::sizes_custom() const {
   int64_t d = ${THTensor_nDimension};
   if (d != 0) {
     // note: this will return "{}" for a scalar because dim() will return 0 in that case.
-    return IntList(reinterpret_cast<int64_t*>(tensor->size),dim());
+    return IntList(reinterpret_cast<int64_t*>(tensor->size),dim_custom());
   } else {
     return IntList(kEmptySizes);
   }
 }
 
-int64_t ${Tensor}::dim() const {
+int64_t ${Tensor}::dim_custom() const {
   if(isScalar())
     return 0;
   int64_t d = ${THTensor_nDimension};
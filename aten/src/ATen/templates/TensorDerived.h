@@ -15,9 +15,9 @@ public:
   ${Tensor}(Context* context, ${THTensor} * tensor);
   virtual ~${Tensor}();
   virtual const char * toString() const override;
-  virtual IntList sizes() const override;
-  virtual IntList strides() const override;
-  virtual int64_t dim() const override;
+  virtual IntList sizes_custom() const override;
+  virtual IntList strides_custom() const override;
+  virtual int64_t dim_custom() const override;
   virtual Scalar localScalar() override;
   virtual void * unsafeGetTH(bool retain) override;
   virtual std::unique_ptr<Storage> storage() override;
@@ -1,5 +1,5 @@
 // included as 'TensorDenseOrSparse' in TensorDerived.cpp
-IntList ${Tensor}::strides() const {
+IntList ${Tensor}::strides_custom() const {
  AT_ERROR("Sparse tensors do not have strides.");
 }
 Scalar ${Tensor}::localScalar() {
@@ -0,0 +1,195 @@
+// Micro-benchmarks of ATen operators on the CPU and CUDA.
+//
+// Every benchmark is named op/device/dtype/layout/size/threads:N and runs
+// the operator on size x size inputs laid out as
+//   contiguous  every input is contiguous,
+//   transposed  every input is the transpose of a contiguous tensor,
+//   broadcast   the last input is a single row expanded to size x size.
+// It reports the bytes moved by the operator (bytes_per_second, counting
+// each distinct input element once plus the output) and its arithmetic
+// (FLOP/s) where that means something. CUDA iterations synchronize the
+// device, so small CUDA sizes measure launch overhead.
+//
+// Select benchmarks with --benchmark_filter, e.g.
+//   aten_op_benchmark --benchmark_filter='^sum_dim/CPU/float/.*/4096/'
+// and compare two builds with --benchmark_format=json and Google Benchmark's
+// tools/compare.py.
+
+#include "benchmark/benchmark.h"
+
+#include "ATen/ATen.h"
+
+#ifdef ATEN_OP_BENCHMARK_CUDA
+#include "cuda_runtime.h"
+#endif
+
+#include <algorithm>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace at;
+
+namespace {
+
+enum class Layout { Contiguous, Transposed, Broadcast };
+
+const char* layoutName(Layout layout) {
+  switch (layout) {
+    case Layout::Contiguous: return "contiguous";
+    case Layout::Transposed: return "transposed";
+    case Layout::Broadcast: return "broadcast";
+  }
+  return "";
+}
+
+struct OpSpec {
+  const char* name;
+  int num_inputs;
+  // Multiply-adds and the like per output element, or 0 if the operator
+  // only moves data. Matrix products override it with flops().
+  double flops_per_element;
+  std::function<Tensor(const std::vector<Tensor>&)> fn;
+  std::vector<int64_t> sizes;
+  std::function<double(int64_t size)> flops;
+};
+
+const std::vector<int64_t> kElementwiseSizes = {64, 1024, 4096};
+const std::vector<int64_t> kMatmulSizes = {64, 256, 1024};
+
+std::vector<OpSpec> ops() {
+  using Inputs = std::vector<Tensor>;
+  return {
+    {"add", 2, 1, [](const Inputs& x) { return x[0] + x[1]; }, kElementwiseSizes, nullptr},
+    {"mul", 2, 1, [](const Inputs& x) { return x[0] * x[1]; }, kElementwiseSizes, nullptr},
+    {"div", 2, 1, [](const Inputs& x) { return x[0] / x[1]; }, kElementwiseSizes, nullptr},
+    {"clone", 1, 0, [](const Inputs& x) { return x[0].clone(); }, kElementwiseSizes, nullptr},
+    {"exp", 1, 1, [](const Inputs& x) { return x[0].exp(); }, kElementwiseSizes, nullptr},
+    {"sigmoid", 1, 1, [](const Inputs& x) { return x[0].sigmoid(); }, kElementwiseSizes, nullptr},
+    {"tanh", 1, 1, [](const Inputs& x) { return x[0].tanh(); }, kElementwiseSizes, nullptr},
+    {"sum", 1, 1, [](const Inputs& x) { return x[0].sum(); }, kElementwiseSizes, nullptr},
+    {"sum_dim", 1, 1, [](const Inputs& x) { return x[0].sum(1); }, kElementwiseSizes, nullptr},
+    {"mean_dim0", 1, 1, [](const Inputs& x) { return x[0].mean(0); }, kElementwiseSizes, nullptr},
+    {"max_dim", 1, 1, [](const Inputs& x) { return std::get<0>(x[0].max(1)); },
+     kElementwiseSizes, nullptr},
+    {"softmax", 1, 4, [](const Inputs& x) { return x[0].softmax(1); }, kElementwiseSizes, nullptr},
+    {"mm", 2, 0, [](const Inputs& x) { return x[0].mm(x[1]); }, kMatmulSizes,
+     [](int64_t n) { return 2.0 * n * n * n; }},
+  };
+}
+
+Tensor makeInput(Type& type, Layout layout, int64_t size, bool last) {
+  switch (layout) {
+    case Layout::Contiguous:
+      return type.rand({size, size});
+    case Layout::Transposed:
+      return type.rand({size, size}).t();
+    case Layout::Broadcast:
+      return last ? type.rand({1, size}).expand({size, size}) : type.rand({size, size});
+  }
+  return Tensor();
+}
+
+// Elements of t actually stored, so that an expanded input counts once
+int64_t distinctElements(const Tensor& t) {
+  int64_t n = 1;
+  for (int64_t d = 0; d < t.dim(); d++) {
+    if (t.stride(d) != 0) {
+      n *= t.size(d);
+    }
+  }
+  return n;
+}
+
+void synchronize(Type& type) {
+#ifdef ATEN_OP_BENCHMARK_CUDA
+  if (type.is_cuda()) {
+    cudaDeviceSynchronize();
+  }
+#endif
+}
+
+void runOp(benchmark::State& state, const OpSpec& op, Type& type, Layout layout,
+           int64_t size, int threads) {
+  if (threads > 0) {
+    set_num_threads(threads);
+  }
+  std::vector<Tensor> inputs;
+  for (int i = 0; i < op.num_inputs; i++) {
+    inputs.push_back(makeInput(type, layout, size, i == op.num_inputs - 1));
+  }
+
+  // Warm up, which also fills the caching allocator
+  Tensor out = op.fn(inputs);
+  synchronize(type);
+  while (state.KeepRunning()) {
+    out = op.fn(inputs);
+    synchronize(type);
+  }
+
+  int64_t elements = out.numel();
+  for (auto& input : inputs) {
+    elements += distinctElements(input);
+  }
+  state.SetBytesProcessed(state.iterations() * elements * type.elementSizeInBytes());
+  double flops = op.flops ? op.flops(size) : op.flops_per_element * size * size;
+  if (flops > 0) {
+    state.counters["FLOP/s"] =
+        benchmark::Counter(flops * state.iterations(), benchmark::Counter::kIsRate);
+  }
+}
+
+void registerBenchmarks() {
+  std::vector<Backend> backends = {Backend::CPU};
+#ifdef ATEN_OP_BENCHMARK_CUDA
+  if (at::hasCUDA()) {
+    backends.push_back(Backend::CUDA);
+  }
+#endif
+  int max_threads = std::max(1u, std::thread::hardware_concurrency());
+  for (const auto& op : ops()) {
+    for (auto backend : backends) {
+      for (auto scalar_type : {kFloat, kDouble}) {
+        Type& type = getType(backend, scalar_type);
+        for (auto layout : {Layout::Contiguous, Layout::Transposed, Layout::Broadcast}) {
+          if (layout == Layout::Broadcast && op.num_inputs == 1 && op.name != std::string("clone")) {
+            // a unary op on an expanded input mostly reads one row, except
+            // clone, which materializes the expansion
+            continue;
+          }
+          for (int64_t size : op.sizes) {
+            // threads only matter on the CPU; 0 leaves the default
+            std::vector<int> thread_counts = {0};
+            if (backend == Backend::CPU) {
+              thread_counts = max_threads > 1 ? std::vector<int>{1, max_threads}
+                                              : std::vector<int>{1};
+            }
+            for (int threads : thread_counts) {
+              std::string name = std::string(op.name) + "/" + toString(backend) + "/" +
+                                 toString(scalar_type) + "/" + layoutName(layout) + "/" +
+                                 std::to_string(size);
+              if (threads > 0) {
+                name += "/threads:" + std::to_string(threads);
+              }
+              benchmark::RegisterBenchmark(
+                  name.c_str(),
+                  [op, &type, layout, size, threads](benchmark::State& state) {
+                    runOp(state, op, type, layout, size, threads);
+                  })->Unit(benchmark::kMicrosecond);
+            }
+          }
+        }
+      }
+    }
+  }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  registerBenchmarks();
+  benchmark::Initialize(&argc, argv);
+  benchmark::RunSpecifiedBenchmarks();
+  return 0;
+}
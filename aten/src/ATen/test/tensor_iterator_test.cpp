@@ -0,0 +1,93 @@
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+
+#include "ATen/ATen.h"
+#include "ATen/native/TensorIterator.h"
+#include "test_seed.h"
+
+using namespace at;
+
+// result = a + b, computed through TensorIterator with float operands.
+static Tensor add_with_iterator(const Tensor& a, const Tensor& b) {
+  Tensor result = a.type().tensor();
+  auto iter = TensorIterator::binary_op(result, a, b);
+  iter.for_each([](int ntensors, char** data, const int64_t* strides, int64_t n) {
+    for (int64_t i = 0; i < n; i++) {
+      *(float*)(data[0] + i * strides[0]) =
+          *(float*)(data[1] + i * strides[1]) + *(float*)(data[2] + i * strides[2]);
+    }
+  });
+  return result;
+}
+
+TEST_CASE( "tensor iterator geometry", "[cpu]" ) {
+  Type& T = CPU(kFloat);
+
+  SECTION( "contiguous operands collapse to one dimension" ) {
+    auto a = T.ones({2, 3, 4});
+    auto out = T.tensor();
+    auto iter = TensorIterator::binary_op(out, a, a);
+    REQUIRE(out.sizes().equals({2, 3, 4}));
+    REQUIRE(iter.ndim() == 1);
+    REQUIRE(iter.shape()[0] == 24);
+    REQUIRE(iter.is_contiguous());
+  }
+
+  SECTION( "broadcast inputs get stride 0" ) {
+    auto a = T.ones({5, 1});
+    auto b = T.ones({1, 7});
+    auto out = T.tensor();
+    auto iter = TensorIterator::binary_op(out, a, b);
+    REQUIRE(out.sizes().equals({5, 7}));
+    REQUIRE(iter.ndim() == 2);
+    REQUIRE(iter.shape().equals({7, 5}));
+    REQUIRE(iter.strides(1)[0] == 0);
+    REQUIRE(iter.strides(2)[1] == 0);
+    REQUIRE(!iter.is_contiguous());
+  }
+
+  SECTION( "reductions keep the output shape and give it stride 0" ) {
+    auto a = T.ones({4, 3, 5, 6});
+    auto out = T.zeros({1, 3, 1, 1});
+    auto iter = TensorIterator::reduce_op(out, a);
+    REQUIRE(out.sizes().equals({1, 3, 1, 1}));
+    REQUIRE(iter.is_reduction());
+    REQUIRE(iter.shape().equals({30, 3, 4}));
+    REQUIRE(iter.strides(0)[0] == 0);
+    REQUIRE(iter.strides(0)[2] == 0);
+    REQUIRE(iter.num_output_elements() == 3);
+    REQUIRE_THROWS(TensorIterator::reduce_op(out, T.ones({4, 2, 5, 6})));
+  }
+
+  SECTION( "the fastest moving dimension of the output is innermost" ) {
+    auto out = T.ones({6, 4}).t();
+    auto a = T.ones({4, 6});
+    auto iter = TensorIterator::binary_op(out, a, a);
+    REQUIRE(iter.ndim() == 2);
+    REQUIRE(iter.shape().equals({4, 6}));
+    REQUIRE(iter.strides(0)[0] == (int64_t)sizeof(float));
+  }
+}
+
+TEST_CASE( "tensor iterator for_each", "[cpu]" ) {
+  manual_seed(123, at::Backend::CPU);
+  Type& T = CPU(kFloat);
+
+  for (int num_threads : {1, 4}) {
+    set_num_threads(num_threads);
+
+    auto a = T.randn({64, 1, 300});
+    auto b = T.randn({17, 300});
+    REQUIRE(add_with_iterator(a, b).equal(a + b));
+
+    auto c = T.randn({300, 64}).t();
+    auto d = T.randn({64, 300}).narrow(1, 1, 200);
+    REQUIRE(add_with_iterator(c.narrow(1, 0, 200), d).equal(c.narrow(1, 0, 200) + d));
+
+    auto s = T.tensor({}).fill_(2);
+    REQUIRE(add_with_iterator(s, s).toCFloat() == 4);
+
+    auto e = T.tensor({0, 3});
+    REQUIRE(add_with_iterator(e, e).numel() == 0);
+  }
+}
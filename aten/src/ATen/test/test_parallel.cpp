@@ -3,10 +3,12 @@
 
 #include "ATen/ATen.h"
 #include "ATen/DLConvertor.h"
+#include "ATen/Parallel.h"
 
 #include <iostream>
 #include <string.h>
 #include <sstream>
+#include <vector>
 #include "test_seed.h"
 
 using namespace at;
@@ -27,3 +29,34 @@ TEST_CASE( "parallel", "[cpu]" ) {
   REQUIRE(a.sum(0).equal(as));
 }
 
+
+TEST_CASE( "parallel_for and parallel_reduce", "[cpu]" ) {
+  for (int num_threads : {1, 4}) {
+    set_num_threads(num_threads);
+
+    // Every index must be visited exactly once, whatever the chunking.
+    std::vector<int> visited(100000, 0);
+    parallel_for(0, visited.size(), 1000, [&](int64_t begin, int64_t end) {
+      for (int64_t i = begin; i < end; i++) {
+        visited[i]++;
+      }
+    });
+    for (auto v : visited) {
+      REQUIRE(v == 1);
+    }
+
+    int64_t sum = parallel_reduce(
+        0, 100000, 1000, int64_t(0),
+        [](int64_t begin, int64_t end, int64_t init) {
+          for (int64_t i = begin; i < end; i++) {
+            init += i;
+          }
+          return init;
+        },
+        std::plus<int64_t>());
+    REQUIRE(sum == int64_t(100000) * 99999 / 2);
+
+    // Empty ranges must not invoke the function at all.
+    parallel_for(5, 5, 1, [](int64_t, int64_t) { REQUIRE(false); });
+  }
+}
@@ -19,15 +19,59 @@
 #endif
 /* end of stuff for mapped files */
 
+/* for THAllocSize */
+#if defined(__APPLE__)
+#include <malloc/malloc.h>
+#else
+#include <malloc.h>
+#endif
+
+static std::atomic<THAllocatorReportFunction> THDefaultAllocator_reportHandler(nullptr);
+
+void THDefaultAllocator_setReportHandler(THAllocatorReportFunction handler) {
+  THDefaultAllocator_reportHandler = handler;
+}
+
+static ptrdiff_t THAllocSize(void* ptr) {
+#if defined(__APPLE__)
+  return malloc_size(ptr);
+#elif defined(_WIN32)
+  return _msize(ptr);
+#else
+  return malloc_usable_size(ptr);
+#endif
+}
+
 static void *THDefaultAllocator_alloc(void* ctx, ptrdiff_t size) {
-  return THAlloc(size);
+  void* ptr = THAlloc(size);
+  THAllocatorReportFunction report = THDefaultAllocator_reportHandler;
+  if (report && ptr) {
+    report(ptr, THAllocSize(ptr));
+  }
+  return ptr;
 }
 
 static void *THDefaultAllocator_realloc(void* ctx, void* ptr, ptrdiff_t size) {
-  return THRealloc(ptr, size);
+  THAllocatorReportFunction report = THDefaultAllocator_reportHandler;
+  if (!report) {
+    return THRealloc(ptr, size);
+  }
+  ptrdiff_t old_size = ptr ? THAllocSize(ptr) : 0;
+  void* new_ptr = THRealloc(ptr, size);
+  if (old_size) {
+    report(ptr, -old_size);
+  }
+  if (new_ptr) {
+    report(new_ptr, THAllocSize(new_ptr));
+  }
+  return new_ptr;
 }
 
 static void THDefaultAllocator_free(void* ctx, void* ptr) {
+  THAllocatorReportFunction report = THDefaultAllocator_reportHandler;
+  if (report && ptr) {
+    report(ptr, -THAllocSize(ptr));
+  }
   THFree(ptr);
 }
 
@@ -37,6 +81,21 @@ THAllocator THDefaultAllocator = {
   &THDefaultAllocator_free
 };
 
+static void *THZeroedAllocator_alloc(void* ctx, ptrdiff_t size) {
+  void* ptr = THAllocZeroed(size);
+  THAllocatorReportFunction report = THDefaultAllocator_reportHandler;
+  if (report && ptr) {
+    report(ptr, THAllocSize(ptr));
+  }
+  return ptr;
+}
+
+THAllocator THZeroedAllocator = {
+  &THZeroedAllocator_alloc,
+  nullptr,
+  &THDefaultAllocator_free
+};
+
 #if defined(_WIN32) || defined(HAVE_MMAP)
 
 struct THMapAllocatorContext_ {
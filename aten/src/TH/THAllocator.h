@@ -24,6 +24,22 @@ typedef struct THAllocator {
  */
 TH_API THAllocator THDefaultAllocator;
 
+/* Optional hook called after every allocation made by THDefaultAllocator with
+ * the number of bytes allocated, and before every free with minus the number
+ * of bytes freed, e.g. for memory profiling. Sizes are the usable sizes
+ * reported by the system allocator, so they may exceed the requested ones.
+ * Pass NULL to remove the hook.
+ */
+typedef void (*THAllocatorReportFunction)(void* ptr, ptrdiff_t size);
+TH_API void THDefaultAllocator_setReportHandler(THAllocatorReportFunction handler);
+
+/* malloc/free allocator whose allocations are zero-filled, backed by calloc.
+ * Only the memory returned by malloc is zeroed: it has no realloc, so storages
+ * grown by a resize get new zeroed memory and copy the old contents over. The
+ * report handler of THDefaultAllocator is called by this allocator too.
+ */
+TH_API THAllocator THZeroedAllocator;
+
 /* file map allocator
  */
 typedef struct THMapAllocatorContext_  THMapAllocatorContext;
@@ -206,6 +206,29 @@ void* THAlloc(ptrdiff_t size)
   return ptr;
 }
 
+void* THAllocZeroed(ptrdiff_t size)
+{
+  void *ptr;
+
+  if(size < 0)
+    THError("$ Torch: invalid memory size -- maybe an overflow?");
+
+  if(size == 0)
+    return NULL;
+
+  ptr = calloc(1, size);
+
+  if(!ptr && torchGCFunction) {
+    torchGCFunction(torchGCData);
+    ptr = calloc(1, size);
+  }
+
+  if(!ptr)
+    THError("$ Torch: not enough memory: you tried to allocate %dGB. Buy new RAM!", size/1073741824);
+
+  return ptr;
+}
+
 void* THRealloc(void *ptr, ptrdiff_t size)
 {
   if(!ptr)
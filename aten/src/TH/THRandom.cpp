@@ -314,3 +314,30 @@ int THRandom_bernoulli(THGenerator *_generator, double p)
   THArgCheck(p >= 0 && p <= 1, 1, "must be >= 0 and <= 1");
   return(uniform_double(_generator) <= p);
 }
+
+#define PHILOX_M4x32_0 0xD2511F53U
+#define PHILOX_M4x32_1 0xCD9E8D57U
+#define PHILOX_W32_0 0x9E3779B9U
+#define PHILOX_W32_1 0xBB67AE85U
+
+void THRandom_philox4x32(uint64_t key, uint64_t counter, uint32_t out[4])
+{
+  uint32_t k0 = (uint32_t)key, k1 = (uint32_t)(key >> 32);
+  uint32_t c0 = (uint32_t)counter, c1 = (uint32_t)(counter >> 32), c2 = 0, c3 = 0;
+  int round;
+  for(round = 0; round < 10; round++)
+  {
+    uint64_t p0 = (uint64_t)PHILOX_M4x32_0 * c0;
+    uint64_t p1 = (uint64_t)PHILOX_M4x32_1 * c2;
+    c0 = (uint32_t)(p1 >> 32) ^ c1 ^ k0;
+    c2 = (uint32_t)(p0 >> 32) ^ c3 ^ k1;
+    c1 = (uint32_t)p1;
+    c3 = (uint32_t)p0;
+    k0 += PHILOX_W32_0;
+    k1 += PHILOX_W32_1;
+  }
+  out[0] = c0;
+  out[1] = c1;
+  out[2] = c2;
+  out[3] = c3;
+}
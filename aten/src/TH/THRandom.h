@@ -80,4 +80,10 @@ TH_API int THRandom_geometric(THGenerator *_generator, double p);
 /* Returns true with probability $p$ and false with probability $1-p$ (p > 0). */
 TH_API int THRandom_bernoulli(THGenerator *_generator, double p);
 
+/* Philox4x32-10 counter-based generator (Salmon et al., "Parallel random
+   numbers: as easy as 1, 2, 3"). Writes the 4 uniform 32 bits integers of
+   block #counter# of the stream selected by #key#. Blocks depend only on
+   (key, counter) and can be generated in any order, e.g. in parallel. */
+TH_API void THRandom_philox4x32(uint64_t key, uint64_t counter, uint32_t out[4]);
+
 #endif
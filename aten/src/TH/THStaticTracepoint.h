@@ -0,0 +1,43 @@
+#ifndef TH_STATIC_TRACEPOINT_H
+#define TH_STATIC_TRACEPOINT_H
+
+/*
+ * Statically defined tracepoints (USDT) under the "pytorch" provider, the
+ * same kind of probes as CAFFE_SDT in caffe2/core/static_tracepoint.h.
+ * A probe is a single nop plus an ELF note naming it and describing where
+ * its arguments live; tools such as bpftrace, perf or systemtap patch the nop
+ * when they attach, e.g.
+ *
+ *   bpftrace -e 'usdt:libcaffe2.so:pytorch:op_start { @[str(arg0)] = count(); }'
+ *
+ * so a probe costs nothing but the computation of its arguments when nothing
+ * is attached. Keep them cheap. Up to 8 integer or pointer arguments.
+ *
+ * Probes:
+ *   op_start(const char* name, const int64_t* sizes, int64_t dim)
+ *       an operator is dispatched by the autograd VariableType; sizes and dim
+ *       describe its first tensor input (NULL and 0 if it has none)
+ *   op_end(const char* name)
+ *   cuda_malloc(void* ptr, size_t size, int device, cudaStream_t stream)
+ *       THCCachingAllocator hands out a block
+ *   cuda_free(void* ptr, size_t size, int device, cudaStream_t stream)
+ *       a block is given back to THCCachingAllocator
+ *   cuda_malloc_miss(size_t size, int device, cudaStream_t stream)
+ *       no cached block fits and THCCachingAllocator calls cudaMalloc
+ *   autograd_task_start(const char* type_name, void* function, uint64_t sequence_nr)
+ *       the autograd engine starts running a backward function; type_name
+ *       is the mangled name of its type
+ *   autograd_task_end(const char* type_name, void* function, uint64_t sequence_nr)
+ */
+
+#if defined(__ELF__) && (defined(__x86_64__) || defined(__i386__))
+#include "THStaticTracepointElfX86.h"
+
+#define TH_SDT(name, ...)                                            \
+  TH_SDT_PROBE_N(                                                    \
+    pytorch, name, TH_SDT_NARG(0, ##__VA_ARGS__), ##__VA_ARGS__)
+#else
+#define TH_SDT(name, ...) do {} while(0)
+#endif
+
+#endif
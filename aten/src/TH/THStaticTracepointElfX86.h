@@ -0,0 +1,100 @@
+#pragma once
+
+// Default constraint for the probe arguments as operands.
+#ifndef TH_SDT_ARG_CONSTRAINT
+#define TH_SDT_ARG_CONSTRAINT      "nor"
+#endif
+
+// Instruction to emit for the probe.
+#define TH_SDT_NOP                 nop
+
+// Note section properties.
+#define TH_SDT_NOTE_NAME           "stapsdt"
+#define TH_SDT_NOTE_TYPE           3
+
+// Size of address depending on platform.
+#ifdef __LP64__
+#define TH_SDT_ASM_ADDR            .8byte
+#else
+#define TH_SDT_ASM_ADDR            .4byte
+#endif
+
+// Assembler helper Macros.
+#define TH_SDT_S(x)                #x
+#define TH_SDT_ASM_1(x)            TH_SDT_S(x) "\n"
+#define TH_SDT_ASM_2(a, b)         TH_SDT_S(a) "," TH_SDT_S(b) "\n"
+#define TH_SDT_ASM_3(a, b, c)      TH_SDT_S(a) "," TH_SDT_S(b) ","    \
+                                      TH_SDT_S(c) "\n"
+#define TH_SDT_ASM_STRING(x)       TH_SDT_ASM_1(.asciz TH_SDT_S(x))
+
+// Helper to determine the size of an argument.
+#define TH_SDT_ISARRAY(x)  (__builtin_classify_type(x) == 14)
+#define TH_SDT_ARGSIZE(x)  (TH_SDT_ISARRAY(x) ? sizeof(void*) : sizeof(x))
+
+// Format of each probe arguments as operand.
+// Size of the arugment tagged with TH_SDT_Sn, with "n" constraint.
+// Value of the argument tagged with TH_SDT_An, with configured constraint.
+#define TH_SDT_ARG(n, x)                                                    \
+  [TH_SDT_S##n] "n"                ((size_t)TH_SDT_ARGSIZE(x)),          \
+  [TH_SDT_A##n] TH_SDT_ARG_CONSTRAINT (x)
+
+// Templates to append arguments as operands.
+#define TH_SDT_OPERANDS_0()        [__sdt_dummy] "g" (0)
+#define TH_SDT_OPERANDS_1(_1)      TH_SDT_ARG(1, _1)
+#define TH_SDT_OPERANDS_2(_1, _2)                                           \
+  TH_SDT_OPERANDS_1(_1), TH_SDT_ARG(2, _2)
+#define TH_SDT_OPERANDS_3(_1, _2, _3)                                       \
+  TH_SDT_OPERANDS_2(_1, _2), TH_SDT_ARG(3, _3)
+#define TH_SDT_OPERANDS_4(_1, _2, _3, _4)                                   \
+  TH_SDT_OPERANDS_3(_1, _2, _3), TH_SDT_ARG(4, _4)
+#define TH_SDT_OPERANDS_5(_1, _2, _3, _4, _5)                               \
+  TH_SDT_OPERANDS_4(_1, _2, _3, _4), TH_SDT_ARG(5, _5)
+#define TH_SDT_OPERANDS_6(_1, _2, _3, _4, _5, _6)                           \
+  TH_SDT_OPERANDS_5(_1, _2, _3, _4, _5), TH_SDT_ARG(6, _6)
+#define TH_SDT_OPERANDS_7(_1, _2, _3, _4, _5, _6, _7)                       \
+  TH_SDT_OPERANDS_6(_1, _2, _3, _4, _5, _6), TH_SDT_ARG(7, _7)
+#define TH_SDT_OPERANDS_8(_1, _2, _3, _4, _5, _6, _7, _8)                   \
+  TH_SDT_OPERANDS_7(_1, _2, _3, _4, _5, _6, _7), TH_SDT_ARG(8, _8)
+
+// Templates to reference the arguments from operands in note section.
+#define TH_SDT_ARGFMT(no)        %n[TH_SDT_S##no]@%[TH_SDT_A##no]
+#define TH_SDT_ARG_TEMPLATE_0    /*No arguments*/
+#define TH_SDT_ARG_TEMPLATE_1    TH_SDT_ARGFMT(1)
+#define TH_SDT_ARG_TEMPLATE_2    TH_SDT_ARG_TEMPLATE_1 TH_SDT_ARGFMT(2)
+#define TH_SDT_ARG_TEMPLATE_3    TH_SDT_ARG_TEMPLATE_2 TH_SDT_ARGFMT(3)
+#define TH_SDT_ARG_TEMPLATE_4    TH_SDT_ARG_TEMPLATE_3 TH_SDT_ARGFMT(4)
+#define TH_SDT_ARG_TEMPLATE_5    TH_SDT_ARG_TEMPLATE_4 TH_SDT_ARGFMT(5)
+#define TH_SDT_ARG_TEMPLATE_6    TH_SDT_ARG_TEMPLATE_5 TH_SDT_ARGFMT(6)
+#define TH_SDT_ARG_TEMPLATE_7    TH_SDT_ARG_TEMPLATE_6 TH_SDT_ARGFMT(7)
+#define TH_SDT_ARG_TEMPLATE_8    TH_SDT_ARG_TEMPLATE_7 TH_SDT_ARGFMT(8)
+
+// Structure of note section for the probe.
+#define TH_SDT_NOTE_CONTENT(provider, name, arg_template)                   \
+  TH_SDT_ASM_1(990: TH_SDT_NOP)                                          \
+  TH_SDT_ASM_3(     .pushsection .note.stapsdt,"","note")                   \
+  TH_SDT_ASM_1(     .balign 4)                                              \
+  TH_SDT_ASM_3(     .4byte 992f-991f, 994f-993f, TH_SDT_NOTE_TYPE)       \
+  TH_SDT_ASM_1(991: .asciz TH_SDT_NOTE_NAME)                             \
+  TH_SDT_ASM_1(992: .balign 4)                                              \
+  TH_SDT_ASM_1(993: TH_SDT_ASM_ADDR 990b)                                \
+  TH_SDT_ASM_1(     TH_SDT_ASM_ADDR 0) /*Reserved for Semaphore address*/\
+  TH_SDT_ASM_1(     TH_SDT_ASM_ADDR 0) /*Reserved for Semaphore name*/   \
+  TH_SDT_ASM_STRING(provider)                                               \
+  TH_SDT_ASM_STRING(name)                                                   \
+  TH_SDT_ASM_STRING(arg_template)                                           \
+  TH_SDT_ASM_1(994: .balign 4)                                              \
+  TH_SDT_ASM_1(     .popsection)
+
+// Main probe Macro.
+#define TH_SDT_PROBE(provider, name, n, arglist)                            \
+    __asm__ __volatile__ (                                                     \
+      TH_SDT_NOTE_CONTENT(provider, name, TH_SDT_ARG_TEMPLATE_##n)       \
+      :: TH_SDT_OPERANDS_##n arglist                                        \
+    )                                                                          \
+
+// Helper Macros to handle variadic arguments.
+#define TH_SDT_NARG_(_0, _1, _2, _3, _4, _5, _6, _7, _8, N, ...) N
+#define TH_SDT_NARG(...)                                                    \
+  TH_SDT_NARG_(__VA_ARGS__, 8, 7, 6, 5, 4, 3, 2, 1, 0)
+#define TH_SDT_PROBE_N(provider, name, N, ...)                              \
+  TH_SDT_PROBE(provider, name, N, (__VA_ARGS__))
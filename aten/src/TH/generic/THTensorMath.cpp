@@ -3443,6 +3443,46 @@ void THTensor_(median)(THTensor *values_, THLongTensor *indices_, THTensor *t, i
   THTensor_(kthvalue)(values_, indices_, t, k+1, dimension, keepdim);
 }
 
+/* Top k of the slice of sliceSize elements at t_data into rt_data and
+ * ri_data, with tmp and tmpi, of sliceSize elements, as scratch space */
+static void THTensor_(topkSlice)(real *t_data, int64_t t_stride,
+                                 real *rt_data, int64_t rt_stride,
+                                 int64_t *ri_data, int64_t ri_stride,
+                                 real *tmp, int64_t *tmpi,
+                                 int64_t sliceSize, int64_t k, int dir, int sorted)
+{
+  int64_t i;
+  for(i = 0; i < sliceSize; i++)
+  {
+    tmp[i] = t_data[i*t_stride];
+    tmpi[i] = i;
+  }
+  if (dir) {
+    /* k largest elements, descending order (optional: see sorted) */
+    int64_t K = sliceSize - k;
+    if (K > 0)
+      THTensor_(quickselect)(tmp, tmpi, K - 1, sliceSize, 1);
+    if (sorted)
+      THTensor_(quicksortdescend)(tmp + K, tmpi + K, k, 1);
+    for(i = 0; i < k; i++)
+    {
+      rt_data[i*rt_stride] = tmp[i + K];
+      ri_data[i*ri_stride] = tmpi[i + K];
+    }
+  }
+  else {
+    /* k smallest elements, ascending order (optional: see sorted) */
+    THTensor_(quickselect)(tmp, tmpi, k - 1, sliceSize, 1);
+    if (sorted)
+      THTensor_(quicksortascend)(tmp, tmpi, k - 1, 1);
+    for(i = 0; i < k; i++)
+    {
+      rt_data[i*rt_stride] = tmp[i];
+      ri_data[i*ri_stride] = tmpi[i];
+    }
+  }
+}
+
 void THTensor_(topk)(THTensor *rt_, THLongTensor *ri_, THTensor *t, int64_t k, int dim, int dir, int sorted)
 {
   int numDims = THTensor_(nDimension)(t);
@@ -3451,6 +3491,57 @@ void THTensor_(topk)(THTensor *rt_, THLongTensor *ri_, THTensor *t, int64_t k, i
   int64_t sliceSize = THTensor_(size)(t, dim);
   THArgCheck(k > 0 && k <= sliceSize, 2, "k not in range for dimension");
 
+  THLongStorage *topKSize = THTensor_(newSizeOf)(t);
+  THLongStorage_set(topKSize, dim, k);
+  THTensor_(resize)(rt_, topKSize, NULL);
+  THLongTensor_resize(ri_, topKSize, NULL);
+  THLongStorage_free(topKSize);
+
+#ifdef _OPENMP
+  /* Slices are independent and each writes its own part of the results, so
+   * many slices (e.g. rows of scores to rank) are spread across threads,
+   * each with its own scratch space */
+  ptrdiff_t numSlices = THTensor_(nElement)(t) / sliceSize;
+  if (numSlices > 1 && THTensor_(nElement)(t) > TH_OMP_OVERHEAD_THRESHOLD &&
+      !omp_in_parallel()) {
+    real *t_base = THTensor_(data)(t);
+    real *rt_base = THTensor_(data)(rt_);
+    int64_t *ri_base = THLongTensor_data(ri_);
+    int64_t t_stride = THTensor_(stride)(t, dim);
+    int64_t rt_stride = THTensor_(stride)(rt_, dim);
+    int64_t ri_stride = THLongTensor_stride(ri_, dim);
+    #pragma omp parallel
+    {
+      real *tmp = (real *)THAlloc(sliceSize * sizeof(real));
+      int64_t *tmpi = (int64_t *)THAlloc(sliceSize * sizeof(int64_t));
+      ptrdiff_t slice;
+      #pragma omp for
+      for (slice = 0; slice < numSlices; slice++) {
+        int64_t t_offset = 0, rt_offset = 0, ri_offset = 0;
+        int64_t rest = slice;
+        int d;
+        for (d = numDims - 1; d >= 0; d--) {
+          if (d == dim)
+            continue;
+          int64_t size = THTensor_(size)(t, d);
+          int64_t coord = rest % size;
+          rest /= size;
+          t_offset += coord * THTensor_(stride)(t, d);
+          rt_offset += coord * THTensor_(stride)(rt_, d);
+          ri_offset += coord * THLongTensor_stride(ri_, d);
+        }
+        THTensor_(topkSlice)(t_base + t_offset, t_stride,
+                             rt_base + rt_offset, rt_stride,
+                             ri_base + ri_offset, ri_stride,
+                             tmp, tmpi, sliceSize, k, dir, sorted);
+      }
+      THFree(tmp);
+      THFree(tmpi);
+    }
+    return;
+  }
+#endif
+
   THTensor *tmpResults = THTensor_(new)();
   THTensor_(resize1d)(tmpResults, sliceSize);
   real *tmp__data = THTensor_(data)(tmpResults);
@@ -3459,52 +3550,13 @@ void THTensor_(topk)(THTensor *rt_, THLongTensor *ri_, THTensor *t, int64_t k, i
   THLongTensor_resize1d(tmpIndices, sliceSize);
   int64_t *tmpi__data = THLongTensor_data(tmpIndices);
 
-  THLongStorage *topKSize = THTensor_(newSizeOf)(t);
-  THLongStorage_set(topKSize, dim, k);
-  THTensor_(resize)(rt_, topKSize, NULL);
-  THLongTensor_resize(ri_, topKSize, NULL);
-  THLongStorage_free(topKSize);
-
-  if (dir) {
-    /* k largest elements, descending order (optional: see sorted) */
-    int64_t K = sliceSize - k;
-    TH_TENSOR_DIM_APPLY3(real, t, real, rt_, int64_t, ri_, dim,
-                         TH_TENSOR_DIM_APPLY3_SIZE_EQ_EXCEPT_DIM,
-                         int64_t i;
-                         for(i = 0; i < sliceSize; i++)
-                         {
-                           tmp__data[i] = t_data[i*t_stride];
-                           tmpi__data[i] = i;
-                         }
-                         if (K > 0)
-                           THTensor_(quickselect)(tmp__data, tmpi__data, K - 1, sliceSize, 1);
-                         if (sorted)
-                           THTensor_(quicksortdescend)(tmp__data + K, tmpi__data + K, k, 1);
-                         for(i = 0; i < k; i++)
-                         {
-                           rt__data[i*rt__stride] = tmp__data[i + K];
-                           ri__data[i*ri__stride] = tmpi__data[i + K];
-                         })
-  }
-  else {
-    /* k smallest elements, ascending order (optional: see sorted) */
-    TH_TENSOR_DIM_APPLY3(real, t, real, rt_, int64_t, ri_, dim,
-                         TH_TENSOR_DIM_APPLY3_SIZE_EQ_EXCEPT_DIM,
-                         int64_t i;
-                         for(i = 0; i < sliceSize; i++)
-                         {
-                           tmp__data[i] = t_data[i*t_stride];
-                           tmpi__data[i] = i;
-                         }
-                         THTensor_(quickselect)(tmp__data, tmpi__data, k - 1, sliceSize, 1);
-                         if (sorted)
-                           THTensor_(quicksortascend)(tmp__data, tmpi__data, k - 1, 1);
-                         for(i = 0; i < k; i++)
-                         {
-                           rt__data[i*rt__stride] = tmp__data[i];
-                           ri__data[i*ri__stride] = tmpi__data[i];
-                         })
-  }
+  TH_TENSOR_DIM_APPLY3(real, t, real, rt_, int64_t, ri_, dim,
+                       TH_TENSOR_DIM_APPLY3_SIZE_EQ_EXCEPT_DIM,
+                       THTensor_(topkSlice)(t_data, t_stride,
+                                            rt__data, rt__stride,
+                                            ri__data, ri__stride,
+                                            tmp__data, tmpi__data,
+                                            sliceSize, k, dir, sorted);)
 
   THTensor_(free)(tmpResults);
   THLongTensor_free(tmpIndices);
@@ -4,6 +4,16 @@
 
 #include "THGenerator.hpp"
 
+#include <algorithm>
+
+/* Contiguous tensors are filled from the Philox stream (THRandom_philox4x32)
+   of a key drawn from the generator, in chunks of TH_RANDOM_FILL_CHUNK
+   elements run by OpenMP threads. Element i only depends on the key and i,
+   so the result does not depend on the number of threads. */
+#ifndef TH_RANDOM_FILL_CHUNK
+#define TH_RANDOM_FILL_CHUNK 65536
+#endif
+
 void THTensor_(random)(THTensor *self, THGenerator *_generator)
 {
   std::lock_guard<std::mutex> lock(_generator->mutex);
@@ -54,7 +64,25 @@ void THTensor_(geometric)(THTensor *self, THGenerator *_generator, double p)
 void THTensor_(bernoulli)(THTensor *self, THGenerator *_generator, double p)
 {
   std::lock_guard<std::mutex> lock(_generator->mutex);
-  TH_TENSOR_APPLY(real, self, *self_data = (real)THRandom_bernoulli(_generator, p););
+  if (!THTensor_(isContiguous)(self)) {
+    TH_TENSOR_APPLY(real, self, *self_data = (real)THRandom_bernoulli(_generator, p););
+    return;
+  }
+  THArgCheck(p >= 0 && p <= 1, 1, "must be >= 0 and <= 1");
+  const uint64_t key = THRandom_random64(_generator);
+  real *data = THTensor_(data)(self);
+  const int64_t size = THTensor_(nElement)(self);
+  int64_t chunk;
+#pragma omp parallel for if (size > TH_RANDOM_FILL_CHUNK) private(chunk)
+  for (chunk = 0; chunk < size; chunk += TH_RANDOM_FILL_CHUNK) {
+    const int64_t chunk_size = std::min<int64_t>(TH_RANDOM_FILL_CHUNK, size - chunk);
+    double *u = (double*)THAlloc(chunk_size * sizeof(double));
+    THDoubleVector_uniform_fill(u, chunk_size, key, chunk, 0, 1);
+    for (int64_t i = 0; i < chunk_size; i++) {
+      data[chunk + i] = (real)(u[i] < p);
+    }
+    THFree(u);
+  }
 }
 
 void THTensor_(bernoulli_FloatTensor)(THTensor *self, THGenerator *_generator, THFloatTensor *p)
@@ -89,6 +117,18 @@ void THTensor_(bernoulli_Tensor)(THTensor *self, THGenerator *_generator, THTens
 void THTensor_(uniform)(THTensor *self, THGenerator *_generator, double a, double b)
 {
   std::lock_guard<std::mutex> lock(_generator->mutex);
+  if (THTensor_(isContiguous)(self)) {
+    const uint64_t key = THRandom_random64(_generator);
+    real *data = THTensor_(data)(self);
+    const int64_t size = THTensor_(nElement)(self);
+    int64_t chunk;
+#pragma omp parallel for if (size > TH_RANDOM_FILL_CHUNK) private(chunk)
+    for (chunk = 0; chunk < size; chunk += TH_RANDOM_FILL_CHUNK) {
+      THVector_(uniform_fill)(data + chunk, std::min<int64_t>(TH_RANDOM_FILL_CHUNK, size - chunk),
+                              key, chunk, (real)a, (real)b);
+    }
+    return;
+  }
   #if defined(TH_REAL_IS_FLOAT)
   TH_TENSOR_APPLY(real, self, *self_data =
     (real)THRandom_uniformFloat(_generator, (real)a, (real)b););
@@ -101,9 +141,17 @@ void THTensor_(uniform)(THTensor *self, THGenerator *_generator, double a, doubl
 void THTensor_(normal)(THTensor *self, THGenerator *_generator, double mean, double stddev)
 {
   std::lock_guard<std::mutex> lock(_generator->mutex);
-  const int64_t size = THTensor_(numel)(self);
-  if (size >= 16 && THTensor_(isContiguous)(self)) {
-    THVector_(normal_fill)(self->storage->data, size, _generator, mean, stddev);
+  if (THTensor_(isContiguous)(self)) {
+    const uint64_t key = THRandom_random64(_generator);
+    real *data = THTensor_(data)(self);
+    const int64_t size = THTensor_(nElement)(self);
+    int64_t chunk;
+    // TH_RANDOM_FILL_CHUNK is a multiple of the 16 numbers of normal_fill
+#pragma omp parallel for if (size > TH_RANDOM_FILL_CHUNK) private(chunk)
+    for (chunk = 0; chunk < size; chunk += TH_RANDOM_FILL_CHUNK) {
+      THVector_(normal_fill)(data + chunk, std::min<int64_t>(TH_RANDOM_FILL_CHUNK, size - chunk),
+                             key, chunk, (real)mean, (real)stddev);
+    }
   } else {
     TH_TENSOR_APPLY(real, self, *self_data = (real)THRandom_normal(_generator, mean, stddev););
   }
@@ -263,14 +311,33 @@ void THTensor_(multinomialAliasDraw)(THLongTensor *self, THGenerator *_generator
       THTensor_fastSet1d(self, i, sample_idx-1L);
     }
 }
+/* Index of the first entry of the n increasing cdf that is >= u */
+static int64_t THTensor_(cdfSearch)(const double *cdf, int64_t n, double u)
+{
+  int64_t left = 0;
+  int64_t right = n;
+  while (right - left > 0) {
+    int64_t mid = left + (right - left) / 2;
+    if (cdf[mid] < u) {
+      left = mid + 1;
+    } else {
+      right = mid;
+    }
+  }
+  return left;
+}
+
+/* The uniform number of sample j of distribution i is element
+   i * n_sample + j of the Philox stream of a key drawn from the generator,
+   see THVector_(uniform_fill), so that the distributions, and with
+   replacement the samples, are drawn in parallel. */
 void THTensor_(multinomial)(THLongTensor *self, THGenerator *_generator, THTensor *prob_dist, int n_sample, int with_replacement)
 {
-  std::lock_guard<std::mutex> lock(_generator->mutex);
   int64_t start_dim = THTensor_(nDimension)(prob_dist);
   int64_t n_dist;
   int64_t n_categories;
   THDoubleTensor* cum_dist;
-  int64_t i,j,k;
+  int64_t i;
 
   if (start_dim == 1)
   {
@@ -293,129 +360,122 @@ void THTensor_(multinomial)(THLongTensor *self, THGenerator *_generator, THTenso
       "cannot sample n_sample > prob_dist.size(1) samples without replacement");
   }
 
-  /* cumulative probability distribution vector */
-  cum_dist = THDoubleTensor_newWithSize1d(n_categories);
-
-  /* will contain multinomial samples (category indices to be returned) */
-  THLongTensor_resize2d(self, n_dist , n_sample);
+  uint64_t key;
+  {
+    std::lock_guard<std::mutex> lock(_generator->mutex);
+    key = THRandom_random64(_generator);
+  }
 
-  for (i=0; i<n_dist; i++)
+  /* normalized cumulative distributions, one per row */
+  cum_dist = THDoubleTensor_newWithSize2d(n_dist, n_categories);
+  double *cum_data = THDoubleTensor_data(cum_dist);
+  real *prob_data = THTensor_(data)(prob_dist);
+  const int64_t prob_stride_0 = prob_dist->stride[0];
+  const int64_t prob_stride_1 = prob_dist->stride[1];
+
+  /* 1 if a probability is < 0, 2 if a row sums to <= 0: errors cannot be
+     raised from the parallel loop */
+  int invalid = 0;
+#pragma omp parallel for if (n_dist * n_categories > TH_RANDOM_FILL_CHUNK) reduction(max:invalid)
+  for (i = 0; i < n_dist; i++)
   {
-    /* Get normalized cumulative distribution from prob distribution */
+    double *cdf = cum_data + i * n_categories;
     double sum = 0;
-    double val;
-    for (j=0; j<n_categories; j++)
+    int64_t j;
+    for (j = 0; j < n_categories; j++)
     {
-      val = THStorage_(get)( \
-        prob_dist->storage, \
-        prob_dist->storageOffset+i*prob_dist->stride[0]+j*prob_dist->stride[1] \
-      );
-      THArgCheckWithCleanup((val >= 0),
-                            THCleanup(THDoubleTensor_free(cum_dist); if (start_dim == 1) THTensor_(squeeze1d)(prob_dist, prob_dist, 0);),
-                            2,
-                            "invalid multinomial distribution (encountering probability entry < 0)");
+      double val = prob_data[i * prob_stride_0 + j * prob_stride_1];
+      if (!(val >= 0))
+      {
+        invalid = 1;
+      }
       sum += val;
-      THDoubleStorage_set(
-        cum_dist->storage, \
-        cum_dist->storageOffset+j*cum_dist->stride[0], \
-        sum \
-      );
+      cdf[j] = sum;
+    }
+    if (!(sum > 0))
+    {
+      invalid = std::max(invalid, 2);
+      continue;
     }
-    THArgCheckWithCleanup((sum > 0),
-                          THCleanup(THDoubleTensor_free(cum_dist); if (start_dim == 1) THTensor_(squeeze1d)(prob_dist, prob_dist, 0);),
-                          2,
-                          "invalid multinomial distribution (sum of probabilities <= 0)");
     /* normalize cumulative probability distribution so that last val is 1
     i.e. doesn't assume original prob_dist row sums to one */
-    if ( (sum > 0) || ( ( sum < 1.00001) && (sum > 0.99999) ) )
+    for (j = 0; j < n_categories; j++)
     {
-      for (j=0; j<n_categories; j++)
-      {
-        THDoubleTensor_data(cum_dist)[j*cum_dist->stride[0]] /= sum;
-      }
+      cdf[j] /= sum;
     }
+    cdf[n_categories - 1] = 1;
+  }
+  THArgCheckWithCleanup(invalid != 1,
+                        THCleanup(THDoubleTensor_free(cum_dist); if (start_dim == 1) THTensor_(squeeze1d)(prob_dist, prob_dist, 0);),
+                        2,
+                        "invalid multinomial distribution (encountering probability entry < 0)");
+  THArgCheckWithCleanup(invalid != 2,
+                        THCleanup(THDoubleTensor_free(cum_dist); if (start_dim == 1) THTensor_(squeeze1d)(prob_dist, prob_dist, 0);),
+                        2,
+                        "invalid multinomial distribution (sum of probabilities <= 0)");
 
-    for (j=0; j<n_sample; j++)
+  /* will contain multinomial samples (category indices to be returned) */
+  THLongTensor_resize2d(self, n_dist , n_sample);
+  int64_t *self_data = THLongTensor_data(self);
+  const int64_t self_stride_0 = self->stride[0];
+  const int64_t self_stride_1 = self->stride[1];
+
+  if (with_replacement)
+  {
+    const int64_t size = n_dist * n_sample;
+    int64_t chunk;
+#pragma omp parallel for if (size > TH_RANDOM_FILL_CHUNK) private(chunk)
+    for (chunk = 0; chunk < size; chunk += TH_RANDOM_FILL_CHUNK)
     {
-      /* sample a probability mass from a uniform distribution */
-      double uniform_sample = THRandom_uniform(_generator, 0, 1);
-      /* Do a binary search for the slot in which the prob falls
-      ie cum_dist[row][slot-1] < uniform_prob < cum_distr[row][slot] */
-      int left_pointer = 0;
-      int right_pointer = n_categories;
-      int mid_pointer;
-      double cum_prob;
-      int sample_idx;
-      /* Make sure the last cumulative distribution bucket sums to 1 */
-      THDoubleTensor_data(cum_dist)[(n_categories-1)*cum_dist->stride[0]] = 1;
-
-      while(right_pointer - left_pointer > 0)
+      const int64_t chunk_size = std::min<int64_t>(TH_RANDOM_FILL_CHUNK, size - chunk);
+      double *u = (double*)THAlloc(chunk_size * sizeof(double));
+      THDoubleVector_uniform_fill(u, chunk_size, key, chunk, 0, 1);
+      for (int64_t k = 0; k < chunk_size; k++)
       {
-          mid_pointer = left_pointer + (right_pointer - left_pointer) / 2;
-          cum_prob = THDoubleStorage_get( \
-            cum_dist->storage, \
-            cum_dist->storageOffset+mid_pointer*cum_dist->stride[0] \
-          );
-          if (cum_prob < uniform_sample)
-          {
-            left_pointer = mid_pointer + 1;
-          }
-          else
-          {
-            right_pointer = mid_pointer;
-          }
+        const int64_t row = (chunk + k) / n_sample;
+        const int64_t j = (chunk + k) % n_sample;
+        /* store in result tensor (will be incremented for lua compat by wrapper) */
+        self_data[row * self_stride_0 + j * self_stride_1] =
+          THTensor_(cdfSearch)(cum_data + row * n_categories, n_categories, u[k]);
       }
-      sample_idx = left_pointer;
-
-       /* store in result tensor (will be incremented for lua compat by wrapper) */
-      THLongStorage_set( \
-        self->storage, \
-        self->storageOffset+i*self->stride[0]+j*self->stride[1], \
-        sample_idx \
-      );
-
-      /* Once a sample is drawn, it cannot be drawn again. ie sample without replacement */
-      if (!with_replacement && j < n_sample - 1)
+      THFree(u);
+    }
+  }
+  else
+  {
+#pragma omp parallel for if (n_dist > 1 && n_dist * n_categories > TH_RANDOM_FILL_CHUNK)
+    for (i = 0; i < n_dist; i++)
+    {
+      double *cdf = cum_data + i * n_categories;
+      double *u = (double*)THAlloc(n_sample * sizeof(double));
+      THDoubleVector_uniform_fill(u, n_sample, key, i * n_sample, 0, 1);
+      for (int64_t j = 0; j < n_sample; j++)
       {
-        /* update cumulative distribution so that sample cannot be drawn again */
-        double diff;
-        double new_val = 0;
-        double sum;
+        int64_t sample_idx = THTensor_(cdfSearch)(cdf, n_categories, u[j]);
+        self_data[i * self_stride_0 + j * self_stride_1] = sample_idx;
 
-        if (sample_idx != 0)
-        {
-          new_val = THDoubleStorage_get( \
-            cum_dist->storage, \
-            cum_dist->storageOffset+(sample_idx-1)*cum_dist->stride[0] \
-          );
-        }
-        /* marginal cumulative mass (i.e. original probability) of sample */
-        diff = THDoubleStorage_get( \
-          cum_dist->storage, \
-          cum_dist->storageOffset+sample_idx*cum_dist->stride[0] \
-        ) - new_val;
-        /* new sum of marginals is not one anymore... */
-        sum = 1.0 - diff;
-        for (k=0; k<n_categories; k++)
+        /* Once a sample is drawn, it cannot be drawn again. ie sample without replacement */
+        if (j < n_sample - 1)
         {
-          new_val = THDoubleStorage_get( \
-            cum_dist->storage, \
-            cum_dist->storageOffset+k*cum_dist->stride[0] \
-          );
-          if (k >= sample_idx)
+          /* marginal cumulative mass (i.e. original probability) of sample */
+          double diff = cdf[sample_idx] - (sample_idx != 0 ? cdf[sample_idx - 1] : 0);
+          /* new sum of marginals is not one anymore... */
+          double sum = 1.0 - diff;
+          for (int64_t k = 0; k < n_categories; k++)
           {
             /* remove sampled probability mass from later cumulative probabilities */
-            new_val -= diff;
+            if (k >= sample_idx)
+            {
+              cdf[k] -= diff;
+            }
+            /* make total marginals sum to one */
+            cdf[k] /= sum;
           }
-          /* make total marginals sum to one */
-          new_val /= sum;
-          THDoubleStorage_set( \
-            cum_dist->storage, \
-            cum_dist->storageOffset+k*cum_dist->stride[0], \
-            new_val \
-          );
+          /* Make sure the last cumulative distribution bucket sums to 1 */
+          cdf[n_categories - 1] = 1;
         }
       }
+      THFree(u);
     }
   }
 
@@ -2,9 +2,6 @@
 #define TH_GENERIC_FILE "generic/THVector.h"
 #else
 
-// Opaque C++ struct
-struct THGenerator;
-
 TH_API void THVector_(fill)(real *x, const real c, const ptrdiff_t n);
 TH_API void THVector_(cadd)(real *z, const real *x, const real *y, const real c, const ptrdiff_t n);
 TH_API void THVector_(adds)(real *y, const real *x, const real c, const ptrdiff_t n);
@@ -14,11 +11,6 @@ TH_API void THVector_(cdiv)(real *z, const real *x, const real *y, const ptrdiff
 TH_API void THVector_(divs)(real *y, const real *x, const real c, const ptrdiff_t n);
 TH_API void THVector_(copy)(real *y, const real *x, const ptrdiff_t n);
 TH_API void THVector_(neg)(real *y, const real *x, const ptrdiff_t n);
-TH_API void THVector_(normal_fill)(real *data,
-                                   const int64_t size,
-                                   struct THGenerator *generator,
-                                   const real mean,
-                                   const real stddev);
 
 #if defined(TH_REAL_IS_SHORT) || defined(TH_REAL_IS_INT) || defined(TH_REAL_IS_LONG)
 TH_API void THVector_(abs)(real *y, const real *x, const ptrdiff_t n);
@@ -27,6 +19,24 @@ TH_API void THVector_(abs)(real *y, const real *x, const ptrdiff_t n);
 /* floating point only now */
 #if defined(TH_REAL_IS_FLOAT) || defined(TH_REAL_IS_DOUBLE)
 
+/* Fills data[i] with element offset + i of the Philox stream of key (see
+   THRandom_philox4x32), scaled to [a, b). A float uses 24 bits of a 32 bits
+   word and a double 53 bits of two words, so data[i] only depends on key
+   and offset + i. */
+TH_API void THVector_(uniform_fill)(real *data,
+                                    const int64_t size,
+                                    const uint64_t key,
+                                    const uint64_t offset,
+                                    const real a,
+                                    const real b);
+/* Fills data[i] with the normal numbers of the same stream, offset must be
+   a multiple of 16. */
+TH_API void THVector_(normal_fill)(real *data,
+                                   const int64_t size,
+                                   const uint64_t key,
+                                   const uint64_t offset,
+                                   const real mean,
+                                   const real stddev);
 TH_API void THVector_(log)(real *y, const real *x, const ptrdiff_t n);
 TH_API void THVector_(lgamma)(real *y, const real *x, const ptrdiff_t n);
 TH_API void THVector_(digamma)(real *y, const real *x, const ptrdiff_t n);
@@ -130,58 +130,6 @@ void THVector_(divs_DEFAULT)(real *y, const real *x, const real c, const ptrdiff
     y[i] = x[i] / c;
 }
 
-// Fills 16 normally distributed samples into data, interleaved with a
-// stride of 8, i.e. in order of ([0], [8]), ([1], [9]), ...
-static void THVector_(interleaved_normal_fill_16)(real *data,
-                                                  const real mean,
-                                                  const real stddev)
-{
-  for (int j = 0; j < 8; ++j) {
-    const real u1 = 1 - data[j]; // [0, 1) -> (0, 1] for log.
-    const real u2 = data[j + 8];
-
-    const real radius = sqrt(-2 * log(u1));
-    const real theta = 2.0f * M_PI * u2;
-
-    data[j] = radius * cos(theta) * stddev + mean;
-    data[j + 8] = radius * sin(theta) * stddev + mean;
-  }
-}
-
-void THVector_(normal_fill_DEFAULT)(real *data,
-                                    int64_t size,
-                                    THGenerator *generator,
-                                    const real mean,
-                                    const real stddev)
-{
-  THAssert(size >= 16 && "Size must be >= 16 for normal fill");
-
-  for (int64_t i = 0; i < size; ++i) {
-#ifdef TH_REAL_IS_FLOAT
-    data[i] = THRandom_uniformFloat(generator, 0, 1);
-#else
-    data[i] = THRandom_uniform(generator, 0, 1);
-#endif
-  }
-
-  for (int64_t i = 0; i < size - 15; i += 16) {
-    THVector_(interleaved_normal_fill_16)(data + i, mean, stddev);
-  }
-
-  if (size % 16 != 0) {
-    // Recompute the last 16 values.
-    data = data + size - 16;
-    for (int64_t i = 0; i < 16; ++i) {
-#ifdef TH_REAL_IS_FLOAT
-      data[i] = THRandom_uniformFloat(generator, 0, 1);
-#else
-      data[i] = THRandom_uniform(generator, 0, 1);
-#endif
-    }
-    THVector_(interleaved_normal_fill_16)(data, mean, stddev);
-  }
-}
-
 #define VECTOR_IMPLEMENT_FUNCTION(NAME, CFUNC)  \
   void THVector_(NAME)(real *y, const real *x, const ptrdiff_t n) \
   { \
@@ -230,6 +178,83 @@ VECTOR_IMPLEMENT_FUNCTION(abs,abs)
 #define TH_MATH_NAME(fn) fn
 #endif
 
+void THVector_(uniform_fill_DEFAULT)(real *data,
+                                     const int64_t size,
+                                     const uint64_t key,
+                                     const uint64_t offset,
+                                     const real a,
+                                     const real b)
+{
+#ifdef TH_REAL_IS_FLOAT
+  const int per_block = 4;
+#else
+  const int per_block = 2;
+#endif
+  const real range = b - a;
+  uint32_t words[4];
+  int64_t i = 0;
+  while (i < size) {
+    const uint64_t index = offset + i;
+    THRandom_philox4x32(key, index / per_block, words);
+    for (int j = index % per_block; j < per_block && i < size; ++j, ++i) {
+#ifdef TH_REAL_IS_FLOAT
+      data[i] = (words[j] >> 8) * (1.0f / (1 << 24)) * range + a;
+#else
+      const uint64_t x = ((uint64_t)words[2 * j] << 32) | words[2 * j + 1];
+      data[i] = (x >> 11) * (1.0 / (1ULL << 53)) * range + a;
+#endif
+    }
+  }
+}
+
+// Fills 16 normally distributed samples into data, interleaved with a
+// stride of 8, i.e. in order of ([0], [8]), ([1], [9]), ...
+static void THVector_(interleaved_normal_fill_16)(real *data,
+                                                  const real mean,
+                                                  const real stddev)
+{
+  for (int j = 0; j < 8; ++j) {
+    const real u1 = 1 - data[j]; // [0, 1) -> (0, 1] for log.
+    const real u2 = data[j + 8];
+
+    const real radius = sqrt(-2 * log(u1));
+    const real theta = 2.0f * M_PI * u2;
+
+    data[j] = radius * cos(theta) * stddev + mean;
+    data[j + 8] = radius * sin(theta) * stddev + mean;
+  }
+}
+
+// Box-Muller maps each block of 16 uniform numbers of the stream, starting
+// at a multiple of 16, to 16 normal numbers, so offset must be a multiple
+// of 16 for data[i] to only depend on key and offset + i.
+void THVector_(normal_fill_DEFAULT)(real *data,
+                                    const int64_t size,
+                                    const uint64_t key,
+                                    const uint64_t offset,
+                                    const real mean,
+                                    const real stddev)
+{
+  THAssert(offset % 16 == 0 && "Offset must be a multiple of 16 for normal fill");
+  const int64_t blocks_size = size - size % 16;
+
+  THVector_(uniform_fill_DEFAULT)(data, blocks_size, key, offset, 0, 1);
+  for (int64_t i = 0; i < blocks_size; i += 16) {
+    THVector_(interleaved_normal_fill_16)(data + i, mean, stddev);
+  }
+
+  if (blocks_size != size) {
+    // The last block goes past the end of data.
+    real last[16];
+    THVector_(uniform_fill_DEFAULT)(last, 16, key, offset + blocks_size, 0, 1);
+    THVector_(interleaved_normal_fill_16)(last, mean, stddev);
+    for (int64_t i = blocks_size; i < size; ++i) {
+      data[i] = last[i - blocks_size];
+    }
+  }
+}
+
+
 VECTOR_IMPLEMENT_FUNCTION(log,TH_MATH_NAME(log))
 VECTOR_IMPLEMENT_FUNCTION(lgamma,TH_MATH_NAME(lgamma))
 VECTOR_IMPLEMENT_FUNCTION(digamma,TH_MATH_NAME(TH_digamma))
@@ -239,7 +239,25 @@ void THVector_(copy)(real *y, const real *x, const ptrdiff_t n) {
   THVector_(copy_DISPATCHPTR)(y, x, n);
 }
 
-static void (*THVector_(normal_fill_DISPATCHPTR))(real *, const int64_t, THGenerator *, const real, const real) = &THVector_(normal_fill_DEFAULT);
+#if defined(TH_REAL_IS_FLOAT) || defined(TH_REAL_IS_DOUBLE)
+static void (*THVector_(uniform_fill_DISPATCHPTR))(real *, const int64_t, const uint64_t, const uint64_t, const real, const real) = &THVector_(uniform_fill_DEFAULT);
+static FunctionDescription THVector_(uniform_fill_DISPATCHTABLE)[] = {
+  #if defined(TH_REAL_IS_FLOAT) && defined(USE_AVX2)
+      FUNCTION_IMPL(THVector_(uniform_fill_AVX2), SIMDExtension_AVX2),
+  #endif
+
+  FUNCTION_IMPL(THVector_(uniform_fill_DEFAULT), SIMDExtension_DEFAULT)
+};
+void THVector_(uniform_fill)(real *data,
+                             const int64_t size,
+                             const uint64_t key,
+                             const uint64_t offset,
+                             const real a,
+                             const real b) {
+  THVector_(uniform_fill_DISPATCHPTR)(data, size, key, offset, a, b);
+}
+
+static void (*THVector_(normal_fill_DISPATCHPTR))(real *, const int64_t, const uint64_t, const uint64_t, const real, const real) = &THVector_(normal_fill_DEFAULT);
 static FunctionDescription THVector_(normal_fill_DISPATCHTABLE)[] = {
   #if defined(TH_REAL_IS_FLOAT) && defined(USE_AVX2)
       FUNCTION_IMPL(THVector_(normal_fill_AVX2), SIMDExtension_AVX2),
@@ -249,13 +267,13 @@ static FunctionDescription THVector_(normal_fill_DISPATCHTABLE)[] = {
 };
 void THVector_(normal_fill)(real *data,
                             const int64_t size,
-                            struct THGenerator *generator,
+                            const uint64_t key,
+                            const uint64_t offset,
                             const real mean,
                             const real stddev) {
-  THVector_(normal_fill_DISPATCHPTR)(data, size, generator, mean, stddev);
+  THVector_(normal_fill_DISPATCHPTR)(data, size, key, offset, mean, stddev);
 }
 
-#if defined(TH_REAL_IS_FLOAT) || defined(TH_REAL_IS_DOUBLE)
 static void (*THVector_(sigmoid_DISPATCHPTR))(real *, const real *, const ptrdiff_t) = &THVector_(sigmoid_DEFAULT);
 static FunctionDescription THVector_(sigmoid_DISPATCHTABLE)[] = {
   #if defined(TH_REAL_IS_FLOAT) && defined(USE_AVX2)
@@ -288,9 +306,10 @@ struct THVector_(startup) {
     INIT_DISPATCH_PTR(cdiv);
     INIT_DISPATCH_PTR(divs);
     INIT_DISPATCH_PTR(copy);
-    INIT_DISPATCH_PTR(normal_fill);
 
 #if defined(TH_REAL_IS_FLOAT) || defined(TH_REAL_IS_DOUBLE)
+    INIT_DISPATCH_PTR(uniform_fill);
+    INIT_DISPATCH_PTR(normal_fill);
     INIT_DISPATCH_PTR(sigmoid);
 #endif
   }
@@ -9,6 +9,8 @@
 #include <ATen/native/cpu/avx_mathfun.h>
 #include "../THRandom.h"
 
+#include <algorithm>
+
 void THDoubleVector_cadd_AVX2(double *z, const double *x, const double *y, const double c, const ptrdiff_t n) {
   ptrdiff_t i;
   __m256d YMM15 = _mm256_set_pd(c, c, c, c);
@@ -47,6 +49,110 @@ void THFloatVector_cadd_AVX2(float *z, const float *x, const float *y, const flo
   }
 }
 
+// Element offset + i of the stream, like THFloatVector_uniform_fill_DEFAULT
+static void uniform_fill_scalar(float *data,
+                                const int64_t size,
+                                const uint64_t key,
+                                const uint64_t offset,
+                                const float a,
+                                const float range) {
+  uint32_t words[4];
+  int64_t i = 0;
+  while (i < size) {
+    const uint64_t index = offset + i;
+    THRandom_philox4x32(key, index / 4, words);
+    for (int j = index % 4; j < 4 && i < size; ++j, ++i) {
+      data[i] = (words[j] >> 8) * (1.0f / (1 << 24)) * range + a;
+    }
+  }
+}
+
+// (hi, lo) = a * b for the 8 32 bits lanes of a and the constant b
+static inline void mulhilo_AVX2(const __m256i a, const __m256i b, __m256i *hi, __m256i *lo) {
+  const __m256i even = _mm256_mul_epu32(a, b);
+  const __m256i odd = _mm256_mul_epu32(_mm256_srli_epi64(a, 32), b);
+  *lo = _mm256_blend_epi32(even, _mm256_slli_epi64(odd, 32), 0xAA);
+  *hi = _mm256_blend_epi32(_mm256_srli_epi64(even, 32), odd, 0xAA);
+}
+
+// Fills the 32 floats of the Philox blocks [counter, counter + 8), i.e.
+// THRandom_philox4x32 on 8 counters at once with word j of every block in
+// c[j], which is transposed back to the order of the blocks at the end.
+static void uniform_fill_32_AVX2(float *data,
+                                 const uint64_t key,
+                                 const uint64_t counter,
+                                 const __m256 *a,
+                                 const __m256 *range) {
+  const __m256i m0 = _mm256_set1_epi32((int)0xD2511F53U);
+  const __m256i m1 = _mm256_set1_epi32((int)0xCD9E8D57U);
+  uint32_t k0 = (uint32_t)key, k1 = (uint32_t)(key >> 32);
+  uint32_t lo[8], hi[8];
+  for (int b = 0; b < 8; ++b) {
+    lo[b] = (uint32_t)(counter + b);
+    hi[b] = (uint32_t)((counter + b) >> 32);
+  }
+  __m256i c0 = _mm256_loadu_si256((const __m256i*)lo);
+  __m256i c1 = _mm256_loadu_si256((const __m256i*)hi);
+  __m256i c2 = _mm256_setzero_si256();
+  __m256i c3 = _mm256_setzero_si256();
+  for (int round = 0; round < 10; ++round) {
+    __m256i hi0, lo0, hi1, lo1;
+    mulhilo_AVX2(c0, m0, &hi0, &lo0);
+    mulhilo_AVX2(c2, m1, &hi1, &lo1);
+    c0 = _mm256_xor_si256(_mm256_xor_si256(hi1, c1), _mm256_set1_epi32((int)k0));
+    c2 = _mm256_xor_si256(_mm256_xor_si256(hi0, c3), _mm256_set1_epi32((int)k1));
+    c1 = lo1;
+    c3 = lo0;
+    k0 += 0x9E3779B9U;
+    k1 += 0xBB67AE85U;
+  }
+
+  // 24 bits of every word to [0, 1), then to [a, b)
+  const __m256 scale = _mm256_set1_ps(1.0f / (1 << 24));
+  __m256 r0 = _mm256_cvtepi32_ps(_mm256_srli_epi32(c0, 8));
+  __m256 r1 = _mm256_cvtepi32_ps(_mm256_srli_epi32(c1, 8));
+  __m256 r2 = _mm256_cvtepi32_ps(_mm256_srli_epi32(c2, 8));
+  __m256 r3 = _mm256_cvtepi32_ps(_mm256_srli_epi32(c3, 8));
+  r0 = _mm256_add_ps(_mm256_mul_ps(_mm256_mul_ps(r0, scale), *range), *a);
+  r1 = _mm256_add_ps(_mm256_mul_ps(_mm256_mul_ps(r1, scale), *range), *a);
+  r2 = _mm256_add_ps(_mm256_mul_ps(_mm256_mul_ps(r2, scale), *range), *a);
+  r3 = _mm256_add_ps(_mm256_mul_ps(_mm256_mul_ps(r3, scale), *range), *a);
+
+  // Blocks (b, b + 4) in every half of t0, ..., and then in order in r0, ...
+  const __m256 t0 = _mm256_unpacklo_ps(r0, r1);
+  const __m256 t1 = _mm256_unpacklo_ps(r2, r3);
+  const __m256 t2 = _mm256_unpackhi_ps(r0, r1);
+  const __m256 t3 = _mm256_unpackhi_ps(r2, r3);
+  const __m256 b04 = _mm256_shuffle_ps(t0, t1, 0x44);
+  const __m256 b15 = _mm256_shuffle_ps(t0, t1, 0xEE);
+  const __m256 b26 = _mm256_shuffle_ps(t2, t3, 0x44);
+  const __m256 b37 = _mm256_shuffle_ps(t2, t3, 0xEE);
+  _mm256_storeu_ps(data, _mm256_permute2f128_ps(b04, b15, 0x20));
+  _mm256_storeu_ps(data + 8, _mm256_permute2f128_ps(b26, b37, 0x20));
+  _mm256_storeu_ps(data + 16, _mm256_permute2f128_ps(b04, b15, 0x31));
+  _mm256_storeu_ps(data + 24, _mm256_permute2f128_ps(b26, b37, 0x31));
+}
+
+void THFloatVector_uniform_fill_AVX2(float *data,
+                                     const int64_t size,
+                                     const uint64_t key,
+                                     const uint64_t offset,
+                                     const float a,
+                                     const float b)
+{
+  const float range = b - a;
+  const __m256 a_v = _mm256_set1_ps(a);
+  const __m256 range_v = _mm256_set1_ps(range);
+
+  // Up to the first element of a block
+  int64_t i = std::min<int64_t>(size, (4 - offset % 4) % 4);
+  uniform_fill_scalar(data, i, key, offset, a, range);
+  for (; i + 32 <= size; i += 32) {
+    uniform_fill_32_AVX2(data + i, key, (offset + i) / 4, &a_v, &range_v);
+  }
+  uniform_fill_scalar(data + i, size - i, key, offset + i, a, range);
+}
+
 static void normal_fill_16_AVX2(float *data,
                                 const __m256* two_pi,
                                 const __m256* one,
@@ -72,36 +178,36 @@ static void normal_fill_16_AVX2(float *data,
 
 void THFloatVector_normal_fill_AVX2(float *data,
                                     const int64_t size,
-                                    THGenerator *generator,
+                                    const uint64_t key,
+                                    const uint64_t offset,
                                     const float mean,
                                     const float stddev)
 {
-  THAssert(size >= 16 && "Size must be >= 16 for AVX2 normal fill");
+  THAssert(offset % 16 == 0 && "Offset must be a multiple of 16 for AVX2 normal fill");
   const __m256 two_pi = _mm256_set1_ps(2.0f * M_PI);
   const __m256 one = _mm256_set1_ps(1.0f);
   const __m256 minus_two = _mm256_set1_ps(-2.0f);
   const __m256 mean_v = _mm256_set1_ps(mean);
   const __m256 stddev_v = _mm256_set1_ps(stddev);
+  const int64_t blocks_size = size - size % 16;
 
   // First fill the data with the uniform numbers. Box-Mueller is a 2 -> 2
   // mapping of 2 uniform numbers to 2 normal numbers (per iteration), so we
   // we need exactly as much space for uniform and normal numbers and can just
   // use the single buffer for both.
-  for (int64_t i = 0; i < size; ++i) {
-    data[i] = THRandom_uniformFloat(generator, 0, 1);
-  }
-
-  for (int64_t i = 0; i < size - 15; i += 16) {
+  THFloatVector_uniform_fill_AVX2(data, blocks_size, key, offset, 0, 1);
+  for (int64_t i = 0; i < blocks_size; i += 16) {
     normal_fill_16_AVX2(data + i, &two_pi, &one, &minus_two, &mean_v, &stddev_v);
   }
 
-  if (size % 16 != 0) {
-    // We rewind so that we have 16 values and then compute them in one step.
-    data = data + size - 16;
-    for (int i = 0; i < 16; ++i) {
-      data[i] = THRandom_uniformFloat(generator, 0, 1);
+  if (blocks_size != size) {
+    // The last block goes past the end of data.
+    float last[16];
+    THFloatVector_uniform_fill_AVX2(last, 16, key, offset + blocks_size, 0, 1);
+    normal_fill_16_AVX2(last, &two_pi, &one, &minus_two, &mean_v, &stddev_v);
+    for (int64_t i = blocks_size; i < size; ++i) {
+      data[i] = last[i - blocks_size];
     }
-    normal_fill_16_AVX2(data, &two_pi, &one, &minus_two, &mean_v, &stddev_v);
   }
 }
 
@@ -259,6 +259,94 @@ void THCudaBlas_Sgemm(THCState *state, char transa, char transb, int64_t m, int6
 #  define CUDA_R_16F CUBLAS_DATA_HALF
 #endif
 
+#if CUDA_VERSION >= 9000
+// cublasGemmEx only uses the tensor cores when m, n, k and the leading
+// dimensions are all multiples of 8. Otherwise, products large enough to
+// amortize the O(mk + kn + mn) copies are computed on zero padded copies of
+// the operands, which leaves the result unchanged.
+#define THC_TENSOR_CORE_ALIGNMENT 8
+#define THC_MIN_PADDED_GEMM_MACS (1 << 24)
+
+static int64_t roundUpToTensorCoreAlignment(int64_t x)
+{
+  return (x + THC_TENSOR_CORE_ALIGNMENT - 1) / THC_TENSOR_CORE_ALIGNMENT * THC_TENSOR_CORE_ALIGNMENT;
+}
+
+static int isTensorCoreAligned(int64_t x)
+{
+  return x % THC_TENSOR_CORE_ALIGNMENT == 0;
+}
+
+static int shouldPadForTensorCores(int64_t m, int64_t n, int64_t k, int64_t lda, int64_t ldb, int64_t ldc)
+{
+  if (isTensorCoreAligned(m) && isTensorCoreAligned(n) && isTensorCoreAligned(k) &&
+      isTensorCoreAligned(lda) && isTensorCoreAligned(ldb) && isTensorCoreAligned(ldc)) {
+    return 0;
+  }
+  if ((double)m * n * k < THC_MIN_PADDED_GEMM_MACS) {
+    return 0;
+  }
+  return roundUpToTensorCoreAlignment(m) <= INT_MAX &&
+         roundUpToTensorCoreAlignment(n) <= INT_MAX &&
+         roundUpToTensorCoreAlignment(k) <= INT_MAX;
+}
+
+// Copies the rows x cols column-major matrix src into the top left corner of dst
+static void copyHalfMatrix(half *dst, int64_t ld_dst, const half *src, int64_t ld_src,
+                           int64_t rows, int64_t cols, cudaStream_t stream)
+{
+  THCudaCheck(cudaMemcpy2DAsync(dst, ld_dst * sizeof(half), src, ld_src * sizeof(half),
+                                rows * sizeof(half), cols, cudaMemcpyDeviceToDevice, stream));
+}
+
+// op(a) is m x k and op(b) is k x n
+static void THCudaBlas_HgemmPadded(THCState *state, cublasHandle_t handle,
+                                   cublasOperation_t opa, cublasOperation_t opb,
+                                   int64_t m, int64_t n, int64_t k, float alpha,
+                                   half *a, int64_t lda, half *b, int64_t ldb,
+                                   float beta, half *c, int64_t ldc)
+{
+  int64_t m8 = roundUpToTensorCoreAlignment(m);
+  int64_t n8 = roundUpToTensorCoreAlignment(n);
+  int64_t k8 = roundUpToTensorCoreAlignment(k);
+  int64_t a_rows = opa == CUBLAS_OP_N ? m : k, a_cols = opa == CUBLAS_OP_N ? k : m;
+  int64_t b_rows = opb == CUBLAS_OP_N ? k : n, b_cols = opb == CUBLAS_OP_N ? n : k;
+  int64_t a_rows8 = roundUpToTensorCoreAlignment(a_rows);
+  int64_t b_rows8 = roundUpToTensorCoreAlignment(b_rows);
+  size_t a_size = a_rows8 * roundUpToTensorCoreAlignment(a_cols) * sizeof(half);
+  size_t b_size = b_rows8 * roundUpToTensorCoreAlignment(b_cols) * sizeof(half);
+  size_t c_size = m8 * n8 * sizeof(half);
+
+  cudaStream_t stream = THCState_getCurrentStream(state);
+  half *a8, *b8, *c8;
+  THCudaCheck(THCudaMalloc(state, (void**)&a8, a_size));
+  THCudaCheck(THCudaMalloc(state, (void**)&b8, b_size));
+  THCudaCheck(THCudaMalloc(state, (void**)&c8, c_size));
+  // the padding of k must be zero; that of m and n only affects the rows and
+  // columns of c8 that are dropped
+  THCudaCheck(cudaMemsetAsync(a8, 0, a_size, stream));
+  THCudaCheck(cudaMemsetAsync(b8, 0, b_size, stream));
+  copyHalfMatrix(a8, a_rows8, a, lda, a_rows, a_cols, stream);
+  copyHalfMatrix(b8, b_rows8, b, ldb, b_rows, b_cols, stream);
+  if (beta != 0) {
+    copyHalfMatrix(c8, m8, c, ldc, m, n, stream);
+  }
+
+  THCublasCheck(cublasSetMathMode(handle, CUBLAS_TENSOR_OP_MATH));
+  THCublasCheck(cublasGemmEx(handle, opa, opb,
+                             (int)m8, (int)n8, (int)k8, &alpha,
+                             a8, CUDA_R_16F, (int)a_rows8, b8, CUDA_R_16F,
+                             (int)b_rows8, &beta, c8, CUDA_R_16F, (int)m8,
+                             CUDA_R_32F, CUBLAS_GEMM_DFALT_TENSOR_OP));
+  THCublasCheck(cublasSetMathMode(handle, CUBLAS_DEFAULT_MATH));
+  copyHalfMatrix(c, ldc, c8, m8, m, n, stream);
+
+  THCudaCheck(THCudaFree(state, a8));
+  THCudaCheck(THCudaFree(state, b8));
+  THCudaCheck(THCudaFree(state, c8));
+}
+#endif
+
 void THCudaBlas_Hgemm(THCState *state, char transa, char transb, int64_t m, int64_t n, int64_t k, half alpha, half *a, int64_t lda, half *b, int64_t ldb, half beta, half *c, int64_t ldc)
 {
   adjustLd(transa, transb, m, n, k, &lda, &ldb, &ldc);
@@ -288,7 +376,10 @@ void THCudaBlas_Hgemm(THCState *state, char transa, char transb, int64_t m, int6
                                   i_ldb, &fBeta, c, CUDA_R_16F, i_ldc));
 #else
       cudaDeviceProp* prop = THCState_getCurrentDeviceProperties(state);
-      if (prop->major >= 5){
+      if (prop->major >= 7 && shouldPadForTensorCores(m, n, k, lda, ldb, ldc)) {
+        THCudaBlas_HgemmPadded(state, handle, opa, opb, m, n, k, fAlpha,
+                               a, lda, b, ldb, fBeta, c, ldc);
+      } else if (prop->major >= 5){
         THCublasCheck(cublasSetMathMode(handle, CUBLAS_TENSOR_OP_MATH));
         THCublasCheck(cublasGemmEx(handle, opa, opb,
                                    i_m, i_n, i_k, &fAlpha,
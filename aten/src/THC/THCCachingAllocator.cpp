@@ -1,13 +1,18 @@
 #include "THCCachingAllocator.h"
 #include "THCStream.hpp"
+#include "THStaticTracepoint.h"
 
 #include <cuda_runtime_api.h>
 #include <algorithm>
+#include <cstdlib>
 #include <deque>
+#include <limits>
 #include <map>
 #include <memory>
 #include <mutex>
 #include <set>
+#include <sstream>
+#include <string>
 #include <unordered_map>
 #include <vector>
 
@@ -25,6 +30,25 @@
 //   allocation requests can be filled by a cudaMalloc call of the exact size.
 //   Small requests will allocate and split a 1MB buffer, if necessary.
 //
+// The handling of large requests can be tuned with the
+// THC_CACHING_ALLOCATOR_CONF environment variable, a comma-separated list of
+// option:value pairs, e.g.
+//
+//   THC_CACHING_ALLOCATOR_CONF=roundup_power2_divisions:4,max_split_size_mb:256
+//
+// - roundup_power2_divisions:N rounds large requests up to one of N evenly
+//   spaced sizes between consecutive powers of two (instead of to a multiple
+//   of 128 KiB), so that requests of slightly different sizes, e.g. from
+//   variable-length batches, are served by the same cached blocks.
+// - max_split_size_mb:M never splits cached blocks of M MiB or more. Such
+//   blocks are only reused for requests that are at most 20 MiB smaller, so
+//   that they stay whole and can be returned to CUDA when memory runs out.
+// - large_segment_size_mb:S carves large requests smaller than S MiB out of
+//   segments of S MiB (or the exact size, if that fails), the same way small
+//   requests share 1 MiB segments. Freed neighbours are merged back, so one
+//   segment can serve a sequence of differently sized requests. Must be
+//   smaller than max_split_size_mb.
+//
 // With this allocator, allocations and frees should logically be considered
 // "usages" of the memory segment associated with streams, just like kernel
 // launches. The programmer must insert the proper synchronization if memory
@@ -35,6 +59,13 @@
 // ensure that the block is not reused before each recorded stream completes
 // work.
 //
+// Outstanding events are queued per stream, so a block that was used on a
+// busy stream does not hold back the reuse of blocks whose streams have
+// already finished. The events themselves are recycled across frees. If an
+// allocation fails, or the cache is emptied, the allocator waits for all
+// outstanding events first so that blocks which are only waiting for another
+// stream can be released as well.
+//
 
 
 namespace {
@@ -45,16 +76,71 @@ typedef std::set<THCStreamPtr> stream_set;
 const size_t kRoundSmall = 512;     // round up small allocs to 512 bytes
 const size_t kRoundLarge = 131072;  // round up large allocs to 128 KiB
 const size_t kSmallAlloc = 1048576; // largest "small" allocation is 1 MiB
+const size_t kLargeBuffer = 20971520; // max slack when reusing unsplittable blocks
+
+struct AllocatorConfig {
+  size_t roundup_power2_divisions; // 0 or 1 means round to kRoundLarge
+  size_t max_split_size;           // blocks this large or larger are not split
+  size_t large_segment_size;       // minimum cudaMalloc size for large allocs
+
+  AllocatorConfig() :
+      roundup_power2_divisions(0),
+      max_split_size(std::numeric_limits<size_t>::max()),
+      large_segment_size(0) { }
+
+  void parse(const char* env)
+  {
+    std::stringstream ss(env);
+    std::string option;
+    while (std::getline(ss, option, ',')) {
+      if (option.empty()) {
+        continue;
+      }
+      size_t colon = option.find(':');
+      if (colon == std::string::npos) {
+        THError("THC_CACHING_ALLOCATOR_CONF: expected option:value, got '%s'", option.c_str());
+      }
+      std::string key = option.substr(0, colon);
+      char* end;
+      long long value = strtoll(option.c_str() + colon + 1, &end, 10);
+      if (*end != '\0' || value < 0) {
+        THError("THC_CACHING_ALLOCATOR_CONF: invalid value in '%s'", option.c_str());
+      }
+      if (key == "roundup_power2_divisions") {
+        roundup_power2_divisions = value;
+      } else if (key == "max_split_size_mb") {
+        if (value * 1048576 <= (long long)kSmallAlloc) {
+          THError("THC_CACHING_ALLOCATOR_CONF: max_split_size_mb must be larger than 1");
+        }
+        max_split_size = value * 1048576;
+      } else if (key == "large_segment_size_mb") {
+        large_segment_size = value * 1048576;
+      } else {
+        THError("THC_CACHING_ALLOCATOR_CONF: unknown option '%s'", key.c_str());
+      }
+    }
+    if (large_segment_size >= max_split_size) {
+      THError("THC_CACHING_ALLOCATOR_CONF: large_segment_size_mb must be "
+              "smaller than max_split_size_mb");
+    }
+  }
+};
 
 struct DeviceStats {
   uint64_t   amount_allocated;      // total amount allocated in bytes
   uint64_t   max_amount_allocated;  // max total amount allocated in bytes
   uint64_t   amount_cached;         // total amount in cache in bytes
   uint64_t   max_amount_cached;     // max total amount in cache in bytes
+  uint64_t   amount_inactive_split; // cached bytes in partially used segments
+  uint64_t   num_segments;          // number of live cudaMalloc allocations
+  uint64_t   num_alloc_retries;     // cudaMalloc failures that flushed the cache
+  uint64_t   num_ooms;              // allocations that failed after flushing
 
   DeviceStats() :
       amount_allocated(0), max_amount_allocated(0),
-      amount_cached(0), max_amount_cached(0) { }
+      amount_cached(0), max_amount_cached(0),
+      amount_inactive_split(0), num_segments(0),
+      num_alloc_retries(0), num_ooms(0) { }
 
   void increaseAllocated(size_t delta) {
     amount_allocated += delta;
@@ -127,15 +213,37 @@ struct THCCachingAllocator
   // cached blocks 1 MB or smaller
   FreeBlocks small_blocks;
 
+  // tunables from THC_CACHING_ALLOCATOR_CONF, parsed on first use
+  AllocatorConfig config;
+  bool config_parsed;
+
   // allocated blocks by device pointer
   std::unordered_map<void*, Block*> allocated_blocks;
 
-  // outstanding cuda events
-  std::deque<std::pair<cudaEvent_t, Block*>> cuda_events;
+  // outstanding cuda events, in recording order for each (device, stream)
+  typedef std::pair<int, cudaStream_t> StreamKey;
+  typedef std::deque<std::pair<cudaEvent_t, Block*>> EventQueue;
+  std::map<StreamKey, EventQueue> cuda_events;
+
+  // completed events available for reuse, by device
+  std::vector<std::vector<cudaEvent_t>> free_events;
+
+  // ring buffer of recent allocator events, see recordHistory()
+  bool trace_enabled;
+  size_t trace_max_entries;
+  size_t trace_next;
+  std::vector<THCCachingAllocatorTraceEntry> trace;
+  THCCachingAllocatorContextFn trace_context_fn;
+
+  // see THCCachingAllocator_setReportHandler()
+  THCCachingAllocatorReportFn report_fn;
 
   THCCachingAllocator() :
       large_blocks(BlockComparator),
-      small_blocks(BlockComparator) {}
+      small_blocks(BlockComparator),
+      config_parsed(false),
+      trace_enabled(false), trace_max_entries(0), trace_next(0),
+      trace_context_fn(NULL), report_fn(NULL) {}
 
   DeviceStats &get_stats_for_device(int device) {
     THAssert(device >= 0);
@@ -161,33 +269,44 @@ struct THCCachingAllocator
       return err;
     }
 
+    if (!config_parsed) {
+      const char* env = getenv("THC_CACHING_ALLOCATOR_CONF");
+      if (env) {
+        config.parse(env);
+      }
+      config_parsed = true;
+    }
+
     size = round_size(size);
     bool small = size <= kSmallAlloc;
 
     DeviceStats &stats = get_stats_for_device(device);
 
     Block search_key(device, stream, size);
-    auto& free_blocks = small ? large_blocks : small_blocks;
+    auto& free_blocks = small ? small_blocks : large_blocks;
 
     Block* block = NULL;
     Block* remaining = NULL;
 
     auto it = free_blocks.lower_bound(&search_key);
-    if (it != free_blocks.end() && (*it)->device == device && (*it)->stream == stream) {
+    if (it != free_blocks.end() && (*it)->device == device &&
+        (*it)->stream == stream && can_reuse(*it, size)) {
       block = *it;
-      free_blocks.erase(it);
+      erase_free_block(free_blocks, block);
     } else {
+      TH_SDT(cuda_malloc_miss, size, device, stream);
       void* ptr;
-      size_t alloc_size = small ? kSmallAlloc : size;
-      err = cuda_malloc_retry(device, &ptr, alloc_size);
+      size_t alloc_size = small ? kSmallAlloc : std::max(size, config.large_segment_size);
+      err = cuda_malloc_retry(device, &ptr, &alloc_size, size);
       if (err != cudaSuccess) {
         return err;
       }
       stats.increaseCached(alloc_size);
       block = new Block(device, stream, alloc_size, (char*)ptr);
+      record_trace(THC_TRACE_SEGMENT_ALLOC, block);
     }
 
-    if (block->size - size >= (small ? kRoundSmall : kSmallAlloc + 1)) {
+    if (should_split(block, size, small)) {
       remaining = block;
 
       block = new Block(device, stream, size, block->ptr);
@@ -200,7 +319,7 @@ struct THCCachingAllocator
       remaining->prev = block;
       remaining->ptr += size;
       remaining->size -= size;
-      free_blocks.insert(remaining);
+      insert_free_block(free_blocks, remaining);
     }
 
     block->allocated = true;
@@ -209,6 +328,11 @@ struct THCCachingAllocator
     *devPtr = (void*)block->ptr;
 
     stats.increaseAllocated(block->size);
+    record_trace(THC_TRACE_ALLOC, block);
+    TH_SDT(cuda_malloc, block->ptr, block->size, block->device, stream);
+    if (report_fn) {
+      report_fn(block->ptr, (int64_t)block->size, block->device);
+    }
     return cudaSuccess;
   }
 
@@ -229,6 +353,11 @@ struct THCCachingAllocator
     block->allocated = false;
 
     get_stats_for_device(block->device).decreaseAllocated(block->size);
+    record_trace(THC_TRACE_FREE, block);
+    TH_SDT(cuda_free, block->ptr, block->size, block->device, block->stream);
+    if (report_fn) {
+      report_fn(block->ptr, -(int64_t)block->size, block->device);
+    }
     if (!block->stream_uses.empty()) {
       return insert_events(block);
     }
@@ -241,7 +370,11 @@ struct THCCachingAllocator
   cudaError_t emptyCache()
   {
     std::lock_guard<std::mutex> lock(mutex);
-    cudaError_t err = free_blocks(large_blocks, large_blocks.begin(), large_blocks.end());
+    cudaError_t err = synchronize_and_free_events();
+    if (err != cudaSuccess) {
+      return err;
+    }
+    err = free_blocks(large_blocks, large_blocks.begin(), large_blocks.end());
     if (err != cudaSuccess) {
       return err;
     }
@@ -311,17 +444,159 @@ struct THCCachingAllocator
     block->stream_uses.insert(THCStreamPtr(stream, &THCStream_free));
   }
 
+  std::vector<THCCachingAllocatorSegmentInfo> snapshot()
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    // Every segment has at least one block in the free lists, in
+    // allocated_blocks or waiting for events; start from the first one.
+    std::vector<Block*> heads;
+    auto add_head = [&](Block* block) {
+      while (block->prev) {
+        block = block->prev;
+      }
+      heads.push_back(block);
+    };
+    for (Block* block : large_blocks) add_head(block);
+    for (Block* block : small_blocks) add_head(block);
+    for (auto& entry : allocated_blocks) add_head(entry.second);
+    for (auto& entry : cuda_events) {
+      for (auto& e : entry.second) add_head(e.second);
+    }
+    std::sort(heads.begin(), heads.end(), [](const Block* a, const Block* b) {
+      if (a->device != b->device) {
+        return a->device < b->device;
+      }
+      return (uintptr_t)a->ptr < (uintptr_t)b->ptr;
+    });
+    heads.erase(std::unique(heads.begin(), heads.end()), heads.end());
+
+    std::vector<THCCachingAllocatorSegmentInfo> result;
+    for (Block* head : heads) {
+      THCCachingAllocatorSegmentInfo segment;
+      segment.device = head->device;
+      segment.address = (uintptr_t)head->ptr;
+      segment.stream = head->stream;
+      segment.total_size = 0;
+      segment.allocated_size = 0;
+      for (Block* block = head; block; block = block->next) {
+        THCCachingAllocatorBlockInfo info;
+        info.size = block->size;
+        info.allocated = block->allocated;
+        info.pending_events = block->event_count > 0;
+        segment.blocks.push_back(info);
+        segment.total_size += block->size;
+        if (block->allocated) {
+          segment.allocated_size += block->size;
+        }
+      }
+      segment.is_large = segment.total_size > kSmallAlloc;
+      result.push_back(std::move(segment));
+    }
+    return result;
+  }
+
+  void recordHistory(bool enabled, size_t max_entries, THCCachingAllocatorContextFn context_fn)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    trace_enabled = enabled && max_entries > 0;
+    trace_context_fn = context_fn;
+    if (enabled) {
+      trace_max_entries = max_entries;
+      trace_next = 0;
+      trace.clear();
+      trace.reserve(max_entries);
+    }
+  }
+
+  void setReportHandler(THCCachingAllocatorReportFn fn)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    report_fn = fn;
+  }
+
+  std::vector<THCCachingAllocatorTraceEntry> getTrace()
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    // Once the buffer has wrapped around, the oldest entry is at trace_next.
+    std::vector<THCCachingAllocatorTraceEntry> result(
+        trace.begin() + trace_next, trace.end());
+    result.insert(result.end(), trace.begin(), trace.begin() + trace_next);
+    return result;
+  }
+
+  void record_trace(THCCachingAllocatorTraceAction action, const Block* block)
+  {
+    if (!trace_enabled) {
+      return;
+    }
+    THCCachingAllocatorTraceEntry entry;
+    entry.action = action;
+    entry.device = block->device;
+    entry.address = (uintptr_t)block->ptr;
+    entry.size = block->size;
+    entry.stream = block->stream;
+    entry.context = trace_context_fn ? trace_context_fn() : 0;
+    if (trace.size() < trace_max_entries) {
+      trace.push_back(entry);
+    } else {
+      trace[trace_next] = entry;
+      trace_next = (trace_next + 1) % trace_max_entries;
+    }
+  }
+
   /** moves a block into the free block list */
   void free_block(Block* block)
   {
     THAssert(!block->allocated && block->event_count == 0);
     bool small = block->size <= kSmallAlloc;
-    auto& free_blocks = small ? large_blocks : small_blocks;
+    auto& free_blocks = small ? small_blocks : large_blocks;
     try_merge_blocks(block, block->prev, free_blocks);
     try_merge_blocks(block, block->next, free_blocks);
+    insert_free_block(free_blocks, block);
+  }
+
+  // All insertions into and removals from the free lists go through these
+  // two functions so that amount_inactive_split stays accurate. A block's
+  // size and whether it is split from a larger segment do not change while
+  // it is in a free list.
+  void insert_free_block(FreeBlocks& free_blocks, Block* block)
+  {
+    if (block->prev || block->next) {
+      get_stats_for_device(block->device).amount_inactive_split += block->size;
+    }
     free_blocks.insert(block);
   }
 
+  void erase_free_block(FreeBlocks& free_blocks, Block* block)
+  {
+    if (block->prev || block->next) {
+      get_stats_for_device(block->device).amount_inactive_split -= block->size;
+    }
+    free_blocks.erase(block);
+  }
+
+  /** whether a cached block may be used for a request of the given size */
+  bool can_reuse(const Block* block, size_t size)
+  {
+    // Requests below max_split_size must not take unsplittable blocks, and
+    // requests above it only take blocks that would not waste too much.
+    if (size < config.max_split_size) {
+      return block->size < config.max_split_size;
+    }
+    return block->size < size + kLargeBuffer;
+  }
+
+  /** whether the rest of a block is worth keeping as a separate free block */
+  bool should_split(const Block* block, size_t size, bool small)
+  {
+    size_t remaining = block->size - size;
+    if (small) {
+      return remaining >= kRoundSmall;
+    }
+    return block->size < config.max_split_size && remaining > kSmallAlloc;
+  }
+
   /** combine previously split blocks */
   void try_merge_blocks(Block* dst, Block* src, FreeBlocks& free_blocks)
   {
@@ -341,7 +616,7 @@ struct THCCachingAllocator
       }
     }
     dst->size += src->size;
-    free_blocks.erase(src);
+    erase_free_block(free_blocks, src);
     delete src;
   }
 
@@ -351,28 +626,49 @@ struct THCCachingAllocator
       size = kRoundSmall;
     } else if (size < kSmallAlloc) {
       size += kRoundSmall - 1 - (size - 1) % kRoundSmall;
+    } else if (config.roundup_power2_divisions > 1) {
+      size_t power2 = 1;
+      while (power2 <= size / 2) {
+        power2 *= 2;
+      }
+      size_t step = std::max(power2 / config.roundup_power2_divisions, kRoundLarge);
+      size = power2 + (size - power2 + step - 1) / step * step;
     } else {
       size += kRoundLarge - 1 - (size - 1) % kRoundLarge;
     }
     return size;
   }
 
-  cudaError_t cuda_malloc_retry(int device, void** devPtr, size_t size)
+  cudaError_t cuda_malloc_retry(int device, void** devPtr, size_t* size, size_t min_size)
   {
-    // Try cudaMalloc. If cudaMalloc fails, frees all non-split cached blocks
-    // and retries.
-    cudaError_t err = cudaMalloc(devPtr, size);
+    // Try cudaMalloc of *size bytes, then (if that is more than requested)
+    // of exactly min_size bytes. If both fail, frees all non-split cached
+    // blocks and retries min_size. *size is set to the size allocated.
+    DeviceStats &stats = get_stats_for_device(device);
+    cudaError_t err = cudaMalloc(devPtr, *size);
+    if (err != cudaSuccess && *size > min_size) {
+      cudaGetLastError();
+      *size = min_size;
+      err = cudaMalloc(devPtr, *size);
+    }
     if (err != cudaSuccess) {
       cudaGetLastError();
+      stats.num_alloc_retries++;
+      err = synchronize_and_free_events();
+      if (err != cudaSuccess) {
+        return err;
+      }
       err = free_cached_blocks(device);
       if (err != cudaSuccess) {
         return err;
       }
-      err = cudaMalloc(devPtr, size);
+      err = cudaMalloc(devPtr, *size);
       if (err != cudaSuccess) {
+        stats.num_ooms++;
         return err;
       }
     }
+    stats.num_segments++;
     return cudaSuccess;
   }
 
@@ -407,10 +703,12 @@ struct THCCachingAllocator
         if (err != cudaSuccess) {
           return err;
         }
-        get_stats_for_device(block->device).decreaseCached(block->size);
-        auto cur = it;
+        DeviceStats &stats = get_stats_for_device(block->device);
+        stats.decreaseCached(block->size);
+        stats.num_segments--;
+        record_trace(THC_TRACE_SEGMENT_FREE, block);
         ++it;
-        blocks.erase(cur);
+        erase_free_block(blocks, block);
         delete block;
       } else {
         ++it;
@@ -444,49 +742,91 @@ struct THCCachingAllocator
       if (err != cudaSuccess) break;
 
       cudaEvent_t event;
-      err = cudaEventCreateWithFlags(&event, cudaEventDisableTiming);
+      err = get_free_event(stream->device, &event);
       if (err != cudaSuccess) break;
 
       err = cudaEventRecord(event, stream->stream);
       if (err != cudaSuccess) break;
 
       block->event_count++;
-      cuda_events.emplace_back(event, block);
+      cuda_events[StreamKey(stream->device, stream->stream)].emplace_back(event, block);
     }
 
     cudaSetDevice(prev_device);
     return err;
   }
 
+  /** returns a recycled event for device, or creates one; device must be current */
+  cudaError_t get_free_event(int device, cudaEvent_t* event)
+  {
+    if ((size_t) device < free_events.size() && !free_events[device].empty()) {
+      *event = free_events[device].back();
+      free_events[device].pop_back();
+      return cudaSuccess;
+    }
+    return cudaEventCreateWithFlags(event, cudaEventDisableTiming);
+  }
+
+  void release_event(int device, cudaEvent_t event, Block* block)
+  {
+    if ((size_t) device >= free_events.size()) {
+      free_events.resize(device + 1);
+    }
+    free_events[device].push_back(event);
+
+    block->event_count--;
+    if (block->event_count == 0) {
+      free_block(block);
+    }
+  }
+
   cudaError_t process_events()
   {
     // Process outstanding cudaEvents. Events that are completed are removed
-    // from the queue, and the 'event_count' for the corresponding allocation
-    // is decremented. Stops at the first event which has not been completed.
-    // Since events on different devices or streams may occur out of order,
-    // the processing of some events may be delayed.
-    while (!cuda_events.empty()) {
-      auto& e = cuda_events.front();
-      cudaEvent_t event = e.first;
-      Block* block = e.second;
-
-      cudaError_t err = cudaEventQuery(event);
-      if (err == cudaErrorNotReady) {
-        break;
-      } else if (err != cudaSuccess) {
-        return err;
+    // from their stream's queue, and the 'event_count' for the corresponding
+    // allocation is decremented. Events recorded on the same stream complete
+    // in order, so each queue is only scanned up to its first event which has
+    // not been completed; other streams are not held up by it.
+    for (auto it = cuda_events.begin(); it != cuda_events.end();) {
+      int device = it->first.first;
+      EventQueue& queue = it->second;
+      while (!queue.empty()) {
+        auto& e = queue.front();
+        cudaError_t err = cudaEventQuery(e.first);
+        if (err == cudaErrorNotReady) {
+          // cudaEventQuery leaves the error set; clear it
+          cudaGetLastError();
+          break;
+        } else if (err != cudaSuccess) {
+          return err;
+        }
+        release_event(device, e.first, e.second);
+        queue.pop_front();
       }
-      err = cudaEventDestroy(event);
-      if (err != cudaSuccess) {
-        return err;
+      if (queue.empty()) {
+        it = cuda_events.erase(it);
+      } else {
+        ++it;
       }
+    }
+    return cudaSuccess;
+  }
 
-      block->event_count--;
-      if (block->event_count == 0) {
-        free_block(block);
+  cudaError_t synchronize_and_free_events()
+  {
+    // Waits for all outstanding events, so that every block that is only
+    // waiting for work on another stream is returned to the free lists.
+    for (auto& entry : cuda_events) {
+      int device = entry.first.first;
+      for (auto& e : entry.second) {
+        cudaError_t err = cudaEventSynchronize(e.first);
+        if (err != cudaSuccess) {
+          return err;
+        }
+        release_event(device, e.first, e.second);
       }
-      cuda_events.pop_front();
     }
+    cuda_events.clear();
     return cudaSuccess;
   }
 };
@@ -573,3 +913,48 @@ THC_API uint64_t THCCachingAllocator_maxMemoryCached(int device) {
   assertValidDevice(device);
   return caching_allocator.get_stats_for_device(device).max_amount_cached;
 }
+
+THC_API uint64_t THCCachingAllocator_currentMemoryInactiveSplit(int device)
+{
+  assertValidDevice(device);
+  return caching_allocator.get_stats_for_device(device).amount_inactive_split;
+}
+
+THC_API uint64_t THCCachingAllocator_numSegments(int device)
+{
+  assertValidDevice(device);
+  return caching_allocator.get_stats_for_device(device).num_segments;
+}
+
+THC_API uint64_t THCCachingAllocator_numAllocRetries(int device)
+{
+  assertValidDevice(device);
+  return caching_allocator.get_stats_for_device(device).num_alloc_retries;
+}
+
+THC_API uint64_t THCCachingAllocator_numOOMs(int device)
+{
+  assertValidDevice(device);
+  return caching_allocator.get_stats_for_device(device).num_ooms;
+}
+
+THC_API std::vector<THCCachingAllocatorSegmentInfo> THCCachingAllocator_snapshot()
+{
+  return caching_allocator.snapshot();
+}
+
+THC_API void THCCachingAllocator_recordHistory(
+    bool enabled, size_t max_entries, THCCachingAllocatorContextFn context_fn)
+{
+  caching_allocator.recordHistory(enabled, max_entries, context_fn);
+}
+
+THC_API std::vector<THCCachingAllocatorTraceEntry> THCCachingAllocator_trace()
+{
+  return caching_allocator.getTrace();
+}
+
+THC_API void THCCachingAllocator_setReportHandler(THCCachingAllocatorReportFn fn)
+{
+  caching_allocator.setReportHandler(fn);
+}
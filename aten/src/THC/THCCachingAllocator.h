@@ -3,6 +3,7 @@
 
 #if (__cplusplus >= 201103L) || (defined(_MSC_VER) && defined(__cplusplus))
 #include <mutex>
+#include <vector>
 #endif
 
 #include "THCGeneral.h"
@@ -15,9 +16,71 @@ THC_API uint64_t THCCachingAllocator_currentMemoryAllocated(int device);
 THC_API uint64_t THCCachingAllocator_maxMemoryAllocated(int device);
 THC_API uint64_t THCCachingAllocator_currentMemoryCached(int device);
 THC_API uint64_t THCCachingAllocator_maxMemoryCached(int device);
+// Fragmentation statistics: cached bytes that cannot be returned to CUDA
+// because other parts of their segment are in use, the number of segments
+// obtained from cudaMalloc, and how often cudaMalloc failed (and the cache
+// was flushed) and failed again after flushing.
+THC_API uint64_t THCCachingAllocator_currentMemoryInactiveSplit(int device);
+THC_API uint64_t THCCachingAllocator_numSegments(int device);
+THC_API uint64_t THCCachingAllocator_numAllocRetries(int device);
+THC_API uint64_t THCCachingAllocator_numOOMs(int device);
 
 #if (__cplusplus >= 201103L) || (defined(_MSC_VER) && defined(__cplusplus))
 THC_API std::mutex* THCCachingAllocator_getCudaFreeMutex();
+
+// A block within a segment, in address order.
+struct THCCachingAllocatorBlockInfo {
+  uint64_t size;
+  bool allocated;       // in use by a tensor
+  bool pending_events;  // freed, but still waiting for a recorded stream
+};
+
+// A segment is one allocation obtained from cudaMalloc.
+struct THCCachingAllocatorSegmentInfo {
+  int device;
+  uintptr_t address;
+  cudaStream_t stream;
+  uint64_t total_size;
+  uint64_t allocated_size;
+  bool is_large;        // belongs to the pool for allocations > 1 MB
+  std::vector<THCCachingAllocatorBlockInfo> blocks;
+};
+
+// Returns every segment held by the allocator, on all devices.
+THC_API std::vector<THCCachingAllocatorSegmentInfo> THCCachingAllocator_snapshot();
+
+enum THCCachingAllocatorTraceAction {
+  THC_TRACE_ALLOC,          // block handed out by malloc
+  THC_TRACE_FREE,           // block returned by free
+  THC_TRACE_SEGMENT_ALLOC,  // cudaMalloc
+  THC_TRACE_SEGMENT_FREE,   // cudaFree
+};
+
+struct THCCachingAllocatorTraceEntry {
+  THCCachingAllocatorTraceAction action;
+  int device;
+  uintptr_t address;
+  uint64_t size;
+  cudaStream_t stream;
+  uint64_t context;         // value returned by the context function, or 0
+};
+
+// Called on every traced event, with the allocator lock held. Must not call
+// back into the allocator.
+typedef uint64_t (*THCCachingAllocatorContextFn)(void);
+
+// Starts (or stops) recording the last max_entries allocator events in a
+// ring buffer. Enabling clears the buffer. context_fn may be NULL.
+THC_API void THCCachingAllocator_recordHistory(
+    bool enabled, size_t max_entries, THCCachingAllocatorContextFn context_fn);
+// Returns the recorded events, oldest first.
+THC_API std::vector<THCCachingAllocatorTraceEntry> THCCachingAllocator_trace();
+
+// Called with the size of every block handed out by malloc, and with minus
+// the size of every block returned by free, with the allocator lock held.
+// Must not call back into the allocator. Pass NULL to remove it.
+typedef void (*THCCachingAllocatorReportFn)(void* ptr, int64_t size, int device);
+THC_API void THCCachingAllocator_setReportHandler(THCCachingAllocatorReportFn fn);
 #endif
 
 #endif
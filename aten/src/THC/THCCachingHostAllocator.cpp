@@ -2,18 +2,40 @@
 #include "THCStream.hpp"
 
 #include <cuda_runtime_api.h>
+#include <chrono>
+#include <condition_variable>
 #include <deque>
 #include <memory>
 #include <mutex>
 #include <set>
 #include <stdint.h>
+#include <thread>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 
 namespace {
 
 typedef std::shared_ptr<THCStream> THCStreamPtr;
+typedef std::chrono::steady_clock Clock;
+
+const size_t kMinBlockSize = 512; // smallest size class
+
+// Rounds size up to its size class, the next power of two. Pinned memory is
+// expensive to allocate, so a block that fits several nearby sizes is worth
+// the slack.
+static size_t roundSize(size_t size)
+{
+  if (size == 0) {
+    return 0;
+  }
+  size_t rounded = kMinBlockSize;
+  while (rounded < size) {
+    rounded *= 2;
+  }
+  return rounded;
+}
 
 struct BlockSize
 {
@@ -28,9 +50,11 @@ struct Block : public BlockSize
   bool  allocated;    // true if the block is currently allocated
   int   event_count;  // number of outstanding cuda events
   std::set<THCStreamPtr> streams;
+  Clock::time_point last_used; // when the block was last freed
 
   Block(size_t size, void* ptr, bool allocated) :
-      BlockSize(size, ptr), allocated(allocated), event_count(0), streams() {}
+      BlockSize(size, ptr), allocated(allocated), event_count(0), streams(),
+      last_used(Clock::now()) {}
 };
 
 static bool BlockComparator(const BlockSize& a, const BlockSize& b)
@@ -58,7 +82,27 @@ struct HostAllocator
   // outstanding cuda events
   std::deque<std::pair<cudaEvent_t, void*>> cuda_events;
 
-  HostAllocator() : available(BlockComparator) {}
+  // background thread which releases blocks that have not been used for
+  // trim_interval, started by setTrimInterval()
+  std::thread trim_thread;
+  std::condition_variable trim_cv;
+  std::chrono::milliseconds trim_interval;
+  bool stop_trim_thread;
+
+  HostAllocator() :
+      available(BlockComparator), trim_interval(0), stop_trim_thread(false) {}
+
+  ~HostAllocator()
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      stop_trim_thread = true;
+    }
+    trim_cv.notify_all();
+    if (trim_thread.joinable()) {
+      trim_thread.join();
+    }
+  }
 
   cudaError_t malloc(void** ptr, size_t size)
   {
@@ -70,6 +114,8 @@ struct HostAllocator
       return err;
     }
 
+    size = roundSize(size);
+
     // search for the smallest block which can hold this allocation
     BlockSize search_key(size);
     auto it = available.lower_bound(search_key);
@@ -125,6 +171,7 @@ struct HostAllocator
       return err;
     }
 
+    block.last_used = Clock::now();
     if (block.event_count == 0) {
       // the block can be re-used if there are no outstanding cuda events
       available.insert(block);
@@ -132,6 +179,72 @@ struct HostAllocator
     return cudaSuccess;
   }
 
+  /** allocates count blocks of the size class of size into the cache */
+  cudaError_t reserve(size_t size, size_t count)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    size = roundSize(size);
+    for (size_t i = 0; i < count; i++) {
+      void* ptr = 0;
+      cudaError_t err = cudaHostAlloc(&ptr, size, cudaHostAllocDefault);
+      if (err != cudaSuccess) {
+        return err;
+      }
+      auto inserted = blocks.insert({ptr, Block(size, ptr, false)});
+      available.insert(inserted.first->second);
+    }
+    return cudaSuccess;
+  }
+
+  void setTrimInterval(double seconds)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    trim_interval = std::chrono::milliseconds((int64_t)(seconds * 1000));
+    if (trim_interval.count() > 0 && !trim_thread.joinable()) {
+      trim_thread = std::thread([this] { trimLoop(); });
+    }
+    trim_cv.notify_all();
+  }
+
+  void trimLoop()
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!stop_trim_thread) {
+      if (trim_interval.count() <= 0) {
+        trim_cv.wait(lock);
+        continue;
+      }
+      trim_cv.wait_for(lock, trim_interval);
+      if (stop_trim_thread || trim_interval.count() <= 0) {
+        continue;
+      }
+
+      // Take the blocks that have been idle for a whole interval out of the
+      // cache, and free them without holding the lock: cudaFreeHost is slow
+      // and must not stall the threads that are pinning memory.
+      std::vector<void*> to_free;
+      auto deadline = Clock::now() - trim_interval;
+      for (auto it = available.begin(); it != available.end();) {
+        Block& block = blocks.at(it->ptr);
+        if (block.last_used <= deadline) {
+          to_free.push_back(block.ptr);
+          blocks.erase(block.ptr);
+          it = available.erase(it);
+        } else {
+          ++it;
+        }
+      }
+      if (to_free.empty()) {
+        continue;
+      }
+      lock.unlock();
+      for (void* ptr : to_free) {
+        THCudaCheckWarn(cudaFreeHost(ptr));
+      }
+      lock.lock();
+    }
+  }
+
   cudaError_t recordEvent(void* ptr, THCStream *stream)
   {
     std::lock_guard<std::mutex> lock(mutex);
@@ -274,6 +387,16 @@ void THCCachingHostAllocator_emptyCache()
   allocator.emptyCache();
 }
 
+cudaError_t THCCachingHostAllocator_reserve(size_t size, size_t count)
+{
+  return allocator.reserve(size, count);
+}
+
+void THCCachingHostAllocator_setTrimInterval(double seconds)
+{
+  allocator.setTrimInterval(seconds);
+}
+
 THAllocator THCCachingHostAllocator = {
   &THCCachingHostAllocator_malloc,
   NULL,
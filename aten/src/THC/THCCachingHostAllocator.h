@@ -17,7 +17,10 @@
 // and tensors in THCTensor_(copyAsyncCPU) and THCTensor_(copyAsyncCuda).
 //
 // Note that this allocator does not split larger allocations into smaller
-// blocks, unlike the caching device allocator.
+// blocks, unlike the caching device allocator. Instead, requests are rounded
+// up to the next power of two, so that a cached block can be reused for
+// requests of similar sizes (e.g. batches of varying shapes) instead of
+// page-locking new memory for every new size.
 //
 THC_API THAllocator THCCachingHostAllocator;
 
@@ -28,4 +31,13 @@ THC_API cudaError_t THCCachingHostAllocator_recordEvent(void *ptr, THCStream *st
 // Releases cached pinned memory allocations via cudaHostFree
 THC_API void THCCachingHostAllocator_emptyCache(void);
 
+// Allocates 'count' blocks that can hold 'size' bytes each and adds them to
+// the cache, so that later allocations of that size do not need to call
+// cudaHostAlloc.
+THC_API cudaError_t THCCachingHostAllocator_reserve(size_t size, size_t count);
+
+// Starts a background thread which releases cached blocks that have not been
+// used for the given number of seconds. A non-positive value stops trimming.
+THC_API void THCCachingHostAllocator_setTrimInterval(double seconds);
+
 #endif
@@ -0,0 +1,46 @@
+#ifndef THC_STREAM_COMPACTION_CUH
+#define THC_STREAM_COMPACTION_CUH
+
+#include "THCGeneral.h"
+
+#include <climits>
+#include <cub/device/device_select.cuh>
+
+/* Stream compaction with a single host synchronization.
+ *
+ * Copies the items of `in` whose flag is set to `out`, in order, and returns
+ * how many there are; `out` must have room for all `n` items.
+ * cub::DeviceSelect writes the count to device memory, from where it is read
+ * back through pinned memory. Waiting for that copy is the only
+ * synchronization, where thrust::copy_if, or summing the flags before
+ * scanning them, synchronize several times.
+ */
+template <typename InputIterator, typename FlagIterator, typename OutputIterator>
+int64_t THC_selectFlagged(THCState* state, InputIterator in, FlagIterator flags,
+                          OutputIterator out, int64_t n) {
+  THArgCheck(n <= INT_MAX, 1, "cannot compact more than INT_MAX elements");
+  cudaStream_t stream = THCState_getCurrentStream(state);
+
+  // The count lives right after cub's temporary storage, both from the
+  // caching allocator
+  size_t tempStorageBytes = 0;
+  THCudaCheck(cub::DeviceSelect::Flagged(
+    NULL, tempStorageBytes, in, flags, out, (int*)NULL, (int)n, stream));
+  size_t countOffset = (tempStorageBytes + sizeof(int) - 1) / sizeof(int) * sizeof(int);
+  void* tempStorage = NULL;
+  THCudaCheck(THCudaMalloc(state, &tempStorage, countOffset + sizeof(int)));
+  int* count = (int*)((char*)tempStorage + countOffset);
+  THCudaCheck(cub::DeviceSelect::Flagged(
+    tempStorage, tempStorageBytes, in, flags, out, count, (int)n, stream));
+
+  int* hostCount = (int*)THCudaHostAlloc(state, sizeof(int));
+  THCudaCheck(cudaMemcpyAsync(hostCount, count, sizeof(int),
+                              cudaMemcpyDeviceToHost, stream));
+  THCudaCheck(cudaStreamSynchronize(stream));
+  int64_t result = *hostCount;
+  THCudaHostFree(state, hostCount);
+  THCudaCheck(THCudaFree(state, tempStorage));
+  return result;
+}
+
+#endif // THC_STREAM_COMPACTION_CUH
@@ -12,6 +12,7 @@
 #include "THCAtomics.cuh"
 #include "THCThrustAllocator.cuh"
 #include "THCTensorSort.cuh"
+#include "THCTensorIndexRows.cuh"
 #include "THCTensor.hpp"
 #include "THCStorage.hpp"
 #include <thrust/device_ptr.h>
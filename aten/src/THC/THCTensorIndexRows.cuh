@@ -0,0 +1,191 @@
+#ifndef THC_TENSOR_INDEX_ROWS_CUH
+#define THC_TENSOR_INDEX_ROWS_CUH
+
+#include "THCGeneral.h"
+#include "THCAtomics.cuh"
+#include "THCDeviceUtils.cuh"
+#include "THCNumerics.cuh"
+
+#include <algorithm>
+#include <climits>
+#include <stdint.h>
+
+/* Index operations on whole rows.
+ *
+ * When the indexed dimension is the outermost one of contiguous tensors,
+ * every index picks a contiguous row (the slice of all other dimensions).
+ * Rather than computing the offsets of every element, these kernels give a
+ * row to each warp, whose lanes walk the row in coalesced accesses. Copies
+ * move the rows in vectors of up to 16 bytes, as far as the row size and the
+ * alignment of the data allow.
+ */
+
+// Rows narrower than this use the elementwise kernels, which keep all lanes
+// busy
+#define THC_INDEX_ROWS_MIN_SIZE 32
+
+#define THC_INDEX_ROWS_BLOCK_SIZE 256
+
+// Copies the rows of src to the rows of dst: row i of dst is row
+// indices[i * indexStride] of src or, if IndexIsDst, the reverse. Rows are
+// rowVecs vectors long, and indices must lie in [0, indexedDimSize).
+template <typename VecT, bool IndexIsDst>
+__global__ void indexCopyRowsKernel(VecT* dst,
+                                    const VecT* src,
+                                    const int64_t* indices,
+                                    int64_t indexStride,
+                                    int64_t numIndices,
+                                    int64_t rowVecs,
+                                    int64_t indexedDimSize) {
+  int64_t warpsPerBlock = blockDim.x / warpSize;
+  int lane = threadIdx.x % warpSize;
+  for (int64_t row = blockIdx.x * warpsPerBlock + threadIdx.x / warpSize;
+       row < numIndices;
+       row += gridDim.x * warpsPerBlock) {
+    // Lua indices begin at 1
+    int64_t index = indices[row * indexStride] - TH_INDEX_BASE;
+    assert(index >= 0 && index < indexedDimSize);
+
+    const VecT* srcRow = src + (IndexIsDst ? row : index) * rowVecs;
+    VecT* dstRow = dst + (IndexIsDst ? index : row) * rowVecs;
+    for (int64_t i = lane; i < rowVecs; i += warpSize) {
+      dstRow[i] = srcRow[i];
+    }
+  }
+}
+
+// Adds row i of src to row indices[i * indexStride] of dst. Each warp takes
+// a run of up to warpSize consecutive rows of src, and sums those with the
+// same destination in registers before adding them to dst, so that sorted or
+// repeated indices, as in the backward of embeddings, cost one atomic per
+// element and distinct destination rather than one per source row.
+template <typename T>
+__global__ void indexAddRowsKernel(T* dst,
+                                   const T* src,
+                                   const int64_t* indices,
+                                   int64_t indexStride,
+                                   int64_t numIndices,
+                                   int64_t rowSize,
+                                   int64_t indexedDimSize) {
+  int64_t warpsPerBlock = blockDim.x / warpSize;
+  int lane = threadIdx.x % warpSize;
+  for (int64_t first = (blockIdx.x * warpsPerBlock + threadIdx.x / warpSize) * warpSize;
+       first < numIndices;
+       first += gridDim.x * warpsPerBlock * warpSize) {
+    int count = numIndices - first < warpSize ? (int) (numIndices - first) : warpSize;
+
+    // Lane r holds the destination of row first + r, which the host checked
+    // to fit in an int
+    int index = -1;
+    if (lane < count) {
+      // Lua indices begin at 1
+      int64_t value = indices[(first + lane) * indexStride] - TH_INDEX_BASE;
+      assert(value >= 0 && value < indexedDimSize);
+      index = (int) value;
+    }
+    int next = WARP_SHFL_DOWN(index, 1);
+    // Bit r is set if row first + r is the last of its run
+    unsigned int runEnds = (unsigned int)
+      WARP_BALLOT(lane < count && (lane == count - 1 || next != index));
+
+    for (int64_t base = 0; base < rowSize; base += warpSize) {
+      int64_t col = base + lane;
+      bool valid = col < rowSize;
+      T sum = ScalarConvert<int, T>::to(0);
+      for (int r = 0; r < count; ++r) {
+        int dstRow = WARP_SHFL(index, r);
+        if (valid) {
+          sum = THCNumerics<T>::add(sum, src[(first + r) * rowSize + col]);
+          if (runEnds & (1u << r)) {
+            atomicAdd(&dst[dstRow * rowSize + col], sum);
+            sum = ScalarConvert<int, T>::to(0);
+          }
+        }
+      }
+    }
+  }
+}
+
+// Width in bytes of the vectors a row of rowBytes bytes at dst and src can be
+// copied in
+inline int THC_indexRowsVectorBytes(const void* dst, const void* src, int64_t rowBytes) {
+  uintptr_t bits = (uintptr_t) dst | (uintptr_t) src | (uintptr_t) rowBytes;
+  for (int bytes = 16; bytes > 1; bytes /= 2) {
+    if (bits % bytes == 0) {
+      return bytes;
+    }
+  }
+  return 1;
+}
+
+inline dim3 THC_indexRowsGrid(THCState* state, int64_t numWarps) {
+  int mpc = THCState_getCurrentDeviceProperties(state)->multiProcessorCount;
+  int64_t warpsPerBlock = THC_INDEX_ROWS_BLOCK_SIZE / 32;
+  return dim3(std::min(THCCeilDiv(numWarps, warpsPerBlock), (int64_t) mpc * 8));
+}
+
+template <typename VecT, bool IndexIsDst>
+void THC_indexCopyRowsVec(THCState* state, void* dst, const void* src,
+                          const int64_t* indices, int64_t indexStride,
+                          int64_t numIndices, int64_t rowBytes,
+                          int64_t indexedDimSize) {
+  indexCopyRowsKernel<VecT, IndexIsDst>
+    <<<THC_indexRowsGrid(state, numIndices), THC_INDEX_ROWS_BLOCK_SIZE, 0,
+       THCState_getCurrentStream(state)>>>(
+      (VecT*) dst, (const VecT*) src, indices, indexStride, numIndices,
+      rowBytes / (int64_t) sizeof(VecT), indexedDimSize);
+}
+
+// Copies rows of rowSize elements, see indexCopyRowsKernel
+template <typename T, bool IndexIsDst>
+void THC_indexCopyRows(THCState* state, T* dst, const T* src,
+                       const int64_t* indices, int64_t indexStride,
+                       int64_t numIndices, int64_t rowSize,
+                       int64_t indexedDimSize) {
+  if (numIndices == 0) {
+    return;
+  }
+  int64_t rowBytes = rowSize * (int64_t) sizeof(T);
+  switch (THC_indexRowsVectorBytes(dst, src, rowBytes)) {
+    case 16:
+      THC_indexCopyRowsVec<float4, IndexIsDst>(
+        state, dst, src, indices, indexStride, numIndices, rowBytes, indexedDimSize);
+      break;
+    case 8:
+      THC_indexCopyRowsVec<float2, IndexIsDst>(
+        state, dst, src, indices, indexStride, numIndices, rowBytes, indexedDimSize);
+      break;
+    case 4:
+      THC_indexCopyRowsVec<float, IndexIsDst>(
+        state, dst, src, indices, indexStride, numIndices, rowBytes, indexedDimSize);
+      break;
+    case 2:
+      THC_indexCopyRowsVec<int16_t, IndexIsDst>(
+        state, dst, src, indices, indexStride, numIndices, rowBytes, indexedDimSize);
+      break;
+    default:
+      THC_indexCopyRowsVec<uint8_t, IndexIsDst>(
+        state, dst, src, indices, indexStride, numIndices, rowBytes, indexedDimSize);
+      break;
+  }
+  THCudaCheck(cudaGetLastError());
+}
+
+// Adds rows of rowSize elements, see indexAddRowsKernel
+template <typename T>
+void THC_indexAddRows(THCState* state, T* dst, const T* src,
+                      const int64_t* indices, int64_t indexStride,
+                      int64_t numIndices, int64_t rowSize,
+                      int64_t indexedDimSize) {
+  THAssert(indexedDimSize <= INT_MAX);
+  if (numIndices == 0) {
+    return;
+  }
+  indexAddRowsKernel<T>
+    <<<THC_indexRowsGrid(state, THCCeilDiv(numIndices, (int64_t) 32)),
+       THC_INDEX_ROWS_BLOCK_SIZE, 0, THCState_getCurrentStream(state)>>>(
+      dst, src, indices, indexStride, numIndices, rowSize, indexedDimSize);
+  THCudaCheck(cudaGetLastError());
+}
+
+#endif // THC_TENSOR_INDEX_ROWS_CUH
@@ -5,13 +5,25 @@
 #include "THCTensorCopy.h"
 #include "THCApply.cuh"
 #include "THCReduce.cuh"
-#include "THCThrustAllocator.cuh"
+#include "THCStreamCompaction.cuh"
 
-#include <thrust/device_ptr.h>
-#include <thrust/scan.h>
-#if CUDA_VERSION >= 7000
-#include <thrust/system/cuda/execution_policy.h>
-#endif
+#include <algorithm>
+#include <cub/device/device_scan.cuh>
+
+// out[i] = in[0] + ... + in[i - 1], summed in the type of out
+template <typename InT, typename OutT>
+void THC_exclusiveSum(THCState* state, const InT* in, OutT* out, int64_t n) {
+  THArgCheck(n <= INT_MAX, 1, "cannot scan more than INT_MAX elements");
+  cudaStream_t stream = THCState_getCurrentStream(state);
+  size_t tempStorageBytes = 0;
+  THCudaCheck(cub::DeviceScan::ExclusiveSum(
+    NULL, tempStorageBytes, in, out, (int)n, stream));
+  void* tempStorage = NULL;
+  THCudaCheck(THCudaMalloc(state, &tempStorage, std::max<size_t>(tempStorageBytes, 1)));
+  THCudaCheck(cub::DeviceScan::ExclusiveSum(
+    tempStorage, tempStorageBytes, in, out, (int)n, stream));
+  THCudaCheck(THCudaFree(state, tempStorage));
+}
 
 template <typename T, typename MaskT>
 struct TensorMaskedFillOp {
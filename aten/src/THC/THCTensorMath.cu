@@ -7,6 +7,8 @@
 #include "THCThrustAllocator.cuh"
 #include "THCTensor.hpp"
 #include "THCStream.hpp"
+#include "THCStreamCompaction.cuh"
+#include "THCTensorInfo.cuh"
 
 #include <thrust/copy.h>
 #include <thrust/count.h>
@@ -20,7 +22,10 @@
 #if CUDA_VERSION >= 7000
 #include <thrust/system/cuda/execution_policy.h>
 #endif
+#include <algorithm>
 #include <cfloat>
+#include <cub/iterator/counting_input_iterator.cuh>
+#include <cub/iterator/transform_input_iterator.cuh>
 
 template <typename T>
 struct TensorFillOp {
@@ -30,71 +35,27 @@ struct TensorFillOp {
   const T val;
 };
 
-// copypasta from https://github.com/thrust/thrust/blob/master/examples/strided_range.cu
-template <typename Iterator>
-class strided_range
-{
- public:
-
-  typedef typename thrust::iterator_difference<Iterator>::type difference_type;
-
-  struct stride_functor : public thrust::unary_function<difference_type,
-                                                        difference_type>
-  {
-    difference_type stride;
-
-    stride_functor(difference_type stride)
-        : stride(stride) {}
-
-    __host__ __device__
-    difference_type operator()(const difference_type& i) const
-      {
-        return stride * i;
-      }
-  };
-
-  typedef typename thrust::counting_iterator<difference_type>                   CountingIterator;
-  typedef typename thrust::transform_iterator<stride_functor, CountingIterator> TransformIterator;
-  typedef typename thrust::permutation_iterator<Iterator,TransformIterator>     PermutationIterator;
-
-  // type of the strided_range iterator
-  typedef PermutationIterator iterator;
-
-  // construct strided_range for the range [first,last)
-  strided_range(Iterator first, Iterator last, difference_type stride)
-      : first(first), last(last), stride(stride) {}
-
-  iterator begin(void) const
-    {
-      return PermutationIterator(first,
-                                 TransformIterator(CountingIterator(0),
-                                                   stride_functor(stride)));
-    }
-
-  iterator end(void) const
-    {
-      return begin() + ((last - first) + (stride - 1)) / stride;
-    }
-
- protected:
-  Iterator first;
-  Iterator last;
-  difference_type stride;
+// The sizes of the tensor nonzero() is called on, for
+// THCTensor_kernel_nonzeroCoordinates
+struct THCNonzeroSizes {
+  int64_t sizes[MAX_CUTORCH_DIMS];
 };
 
-struct idx_functor
+// Turns the linear indices of the nonzero elements of a contiguous tensor into
+// their coordinates, one row of `coordinates` per element.
+__global__ void THCTensor_kernel_nonzeroCoordinates(
+    int64_t* coordinates, const int64_t* indices, int64_t num_nonzeros,
+    int num_dim, THCNonzeroSizes sizes)
 {
-  int64_t div;
-  int64_t size;
-
-  __host__ __device__
-  idx_functor(int64_t div, int64_t size) : div(div), size(size) {}
-
-  __host__ __device__
-  int64_t operator()(int64_t val) {
-    return (val / div) % size + TH_INDEX_BASE;
+  for (int64_t i = blockIdx.x * blockDim.x + threadIdx.x; i < num_nonzeros;
+       i += gridDim.x * blockDim.x) {
+    int64_t index = indices[i];
+    for (int dim = num_dim - 1; dim >= 0; dim--) {
+      coordinates[i * num_dim + dim] = index % sizes.sizes[dim] + TH_INDEX_BASE;
+      index /= sizes.sizes[dim];
+    }
   }
-};
+}
 
 template <typename T>
 struct NonZeroOp
@@ -6,8 +6,118 @@
 #include "THCReduce.cuh"
 #include "THCNumerics.cuh"
 #include "THCTensorMathReduce.cuh"
-#include <thrust/scan.h>
-#include <thrust/execution_policy.h>
+
+#include <algorithm>
+#include <climits>
+#include <iterator>
+#include <cub/device/device_scan.cuh>
+#include <cub/iterator/counting_input_iterator.cuh>
+#include <cub/iterator/transform_input_iterator.cuh>
+
+// Rows at least this long are scanned along the innermost dimension by a
+// single device-wide segmented scan rather than by one warp per row.
+#define THC_SEGMENTED_SCAN_MIN_ROW_SIZE 1024
+
+/* Device-wide inclusive scan of n items with cub, on the current stream and
+ * with temporary storage from the caching allocator.
+ */
+template <typename InputIterator, typename OutputIterator, class ScanOp>
+void THC_inclusiveScan(THCState *state, InputIterator in, OutputIterator out,
+                       ScanOp scan_op, int64_t n)
+{
+  THArgCheck(n <= INT_MAX, 1, "cannot scan more than INT_MAX elements");
+  cudaStream_t stream = THCState_getCurrentStream(state);
+  size_t temp_storage_bytes = 0;
+  THCudaCheck(cub::DeviceScan::InclusiveScan(
+    NULL, temp_storage_bytes, in, out, scan_op, (int)n, stream));
+  void *temp_storage = NULL;
+  THCudaCheck(THCudaMalloc(state, &temp_storage, std::max<size_t>(temp_storage_bytes, 1)));
+  THCudaCheck(cub::DeviceScan::InclusiveScan(
+    temp_storage, temp_storage_bytes, in, out, scan_op, (int)n, stream));
+  THCudaCheck(THCudaFree(state, temp_storage));
+}
+
+// cub calls the scan operator through a const reference, AddOp and MulOp
+// are not const
+template<typename T, class BinaryOp>
+struct THCScanOp {
+  THCScanOp(BinaryOp op) : op(op) {}
+  __device__ __forceinline__ T operator()(const T &a, const T &b) const {
+    return op(a, b);
+  }
+  mutable BinaryOp op;
+};
+
+/* A segmented scan runs as one flat scan over (segment, value) pairs: the
+ * operator restarts from b whenever a belongs to an earlier segment. Since
+ * segments are contiguous and increasing, this is still associative.
+ */
+template<typename T>
+struct THCSegmentedValue {
+  int64_t segment;
+  T value;
+};
+
+template<typename T, class BinaryOp>
+struct THCSegmentedScanOp {
+  THCSegmentedScanOp(BinaryOp op) : op(op) {}
+  __device__ __forceinline__ THCSegmentedValue<T>
+  operator()(const THCSegmentedValue<T> &a, const THCSegmentedValue<T> &b) const {
+    if (a.segment != b.segment) {
+      return b;
+    }
+    THCSegmentedValue<T> result;
+    result.segment = b.segment;
+    result.value = op(a.value, b.value);
+    return result;
+  }
+  mutable BinaryOp op;
+};
+
+// Reads element i of rows of row_size contiguous elements as a pair
+template<typename T>
+struct THCSegmentedLoad {
+  THCSegmentedLoad(const T *src, int64_t row_size) : src(src), row_size(row_size) {}
+  __device__ __forceinline__ THCSegmentedValue<T> operator()(const int64_t &i) const {
+    THCSegmentedValue<T> result;
+    result.segment = i / row_size;
+    result.value = src[i];
+    return result;
+  }
+  const T *src;
+  int64_t row_size;
+};
+
+// Output iterator writing only the value of each pair. Its value_type is
+// void, so cub scans in the value type of the input.
+template<typename T>
+struct THCSegmentedStore {
+  struct reference {
+    __device__ __forceinline__ void operator=(const THCSegmentedValue<T> &v) const {
+      *dst = v.value;
+    }
+    T *dst;
+  };
+  typedef THCSegmentedStore self_type;
+  typedef ptrdiff_t difference_type;
+  typedef void value_type;
+  typedef void pointer;
+  typedef std::random_access_iterator_tag iterator_category;
+
+  __host__ __device__ THCSegmentedStore(T *dst) : dst(dst) {}
+  __host__ __device__ __forceinline__ self_type operator+(difference_type n) const {
+    return self_type(dst + n);
+  }
+  __host__ __device__ __forceinline__ reference operator[](difference_type n) const {
+    reference r;
+    r.dst = dst + n;
+    return r;
+  }
+  __host__ __device__ __forceinline__ reference operator*() const {
+    return (*this)[0];
+  }
+  T *dst;
+};
 
 /* Perform an inclusive scan along an outer dimension of a tensor.
  *
@@ -2,6 +2,7 @@
 #include "THCGeneral.h"
 #include "THCAtomics.cuh"
 #include "THCApply.cuh"
+#include "THCTensorIndexRows.cuh"
 
 // Compute the offsets into the given tensors for a linear index. For the 't2'
 // tensor, dimension 'dim' is skipped. The tensors are assumed to have the same
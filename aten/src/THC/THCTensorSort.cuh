@@ -12,6 +12,12 @@
 #if CUDA_VERSION >= 7000
 #include <thrust/system/cuda/execution_policy.h>
 #endif
+#ifdef USE_CUB
+#include <climits>
+#include <cub/device/device_segmented_radix_sort.cuh>
+#include <cub/iterator/counting_input_iterator.cuh>
+#include <cub/iterator/transform_input_iterator.cuh>
+#endif
 
 template <typename T>
 struct ThrustGTOp {
@@ -80,6 +86,24 @@ struct GlobalIndexToPerSliceIndex {
   const int64_t sliceSize;
 };
 
+#ifdef USE_CUB
+// For segmented sorting in CUB; maps a slice number to the offset at which
+// the slice begins, the slices being innermost and contiguous
+struct SliceToOffset {
+  SliceToOffset(int size) : sliceSize(size) {}
+
+  __host__ __device__ __forceinline__ int operator()(const int& slice) const {
+    return slice * sliceSize;
+  }
+
+  const int sliceSize;
+};
+
+typedef cub::TransformInputIterator<int, SliceToOffset,
+                                    cub::CountingInputIterator<int> >
+  SliceOffsetIterator;
+#endif
+
 void THCudaLongTensor_fillSliceWithIndex(THCState* state,
                                          THCudaLongTensor* t,
                                          int dim);
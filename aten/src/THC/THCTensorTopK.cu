@@ -4,9 +4,11 @@
 #include "THCTensorMath.h"
 #include "THCAsmUtils.cuh"
 #include "THCScanUtils.cuh"
+#include "THCSortUtils.cuh"
 #include "THCTensorTypeUtils.cuh"
 #include "THCTensorMathReduce.cuh"
 #include <algorithm> // for std::min
+#include <climits>
 
 #if CUDA_VERSION >= 7000
 #include <thrust/system/cuda/execution_policy.h>
@@ -478,6 +478,426 @@ __global__ void gatherTopK(TensorInfo<T, IndexType> input,
   }
 }
 
+// Slices with at least this many elements, if there are fewer of them
+// than SMs, are selected by many blocks each rather than one
+#define TOPK_MULTI_BLOCK_MIN_SLICE_SIZE (1 << 17)
+
+// The multi-block selection counts a whole byte per pass, since the
+// histogram lives in shared memory and each pass rereads the slice
+#define MULTI_BLOCK_RADIX_BITS 8
+#define MULTI_BLOCK_RADIX_SIZE 256 // 2 ^ MULTI_BLOCK_RADIX_BITS
+#define MULTI_BLOCK_THREADS 256
+
+// The state of the multi-block radix selection of one slice.
+// The top-Kth element v is one such that (v & desiredMask) == desired,
+// and kToFind of the elements equal to it are in the top-K.
+template <typename RadixType>
+struct TopKMultiBlockState {
+  RadixType desired;
+  RadixType desiredMask;
+  unsigned int kToFind;
+};
+
+template <typename RadixType>
+__global__ void initTopKMultiBlock(TopKMultiBlockState<RadixType>* sliceState,
+                                   unsigned int* counts,
+                                   unsigned int numSlices,
+                                   unsigned int k) {
+  unsigned int slice = blockIdx.x * blockDim.x + threadIdx.x;
+  if (slice >= numSlices) {
+    return;
+  }
+
+  sliceState[slice].desired = 0;
+  sliceState[slice].desiredMask = 0;
+  sliceState[slice].kToFind = k;
+
+  // The digit histogram, then the counts of elements written that are
+  // strictly within and equal to the top-K
+  for (int i = 0; i < MULTI_BLOCK_RADIX_SIZE + 2; ++i) {
+    counts[slice * (MULTI_BLOCK_RADIX_SIZE + 2) + i] = 0;
+  }
+}
+
+// Adds the digit counts at radixDigitPos of this block's share of the
+// elements matching the slice's desired pattern to the slice histogram
+template <typename T, typename IndexType, int Dim>
+__global__ void countRadixMultiBlock(TensorInfo<T, IndexType> input,
+                                     IndexType sliceSize,
+                                     IndexType withinSliceStride,
+                                     TopKMultiBlockState<typename TopKTypeConfig<T>::RadixType>* sliceState,
+                                     unsigned int* counts,
+                                     int radixDigitPos) {
+  typedef typename TopKTypeConfig<T>::RadixType RadixType;
+  __shared__ unsigned int smem[MULTI_BLOCK_RADIX_SIZE];
+
+  for (int i = threadIdx.x; i < MULTI_BLOCK_RADIX_SIZE; i += blockDim.x) {
+    smem[i] = 0;
+  }
+  __syncthreads();
+
+  IndexType slice = blockIdx.y;
+  T* data = &input.data[IndexToOffset<T, IndexType, Dim>::get(slice, input)];
+  RadixType desired = sliceState[slice].desired;
+  RadixType desiredMask = sliceState[slice].desiredMask;
+
+  for (IndexType i = blockIdx.x * blockDim.x + threadIdx.x; i < sliceSize;
+       i += gridDim.x * blockDim.x) {
+    RadixType val = TopKTypeConfig<T>::convert(doLdg(&data[i * withinSliceStride]));
+    if ((val & desiredMask) == desired) {
+      atomicAdd(&smem[Bitfield<RadixType>::getBitfield(
+                  val, radixDigitPos, MULTI_BLOCK_RADIX_BITS)], 1);
+    }
+  }
+  __syncthreads();
+
+  unsigned int* sliceCounts = &counts[slice * (MULTI_BLOCK_RADIX_SIZE + 2)];
+  for (int i = threadIdx.x; i < MULTI_BLOCK_RADIX_SIZE; i += blockDim.x) {
+    if (smem[i] > 0) {
+      atomicAdd(&sliceCounts[i], smem[i]);
+    }
+  }
+}
+
+// Picks the digit at radixDigitPos of each slice's top-Kth element from
+// the slice histogram, and clears the histogram for the next digit
+template <typename RadixType, bool Order>
+__global__ void selectRadixMultiBlock(TopKMultiBlockState<RadixType>* sliceState,
+                                      unsigned int* counts,
+                                      unsigned int numSlices,
+                                      int radixDigitPos) {
+  unsigned int slice = blockIdx.x * blockDim.x + threadIdx.x;
+  if (slice >= numSlices) {
+    return;
+  }
+
+  unsigned int* sliceCounts = &counts[slice * (MULTI_BLOCK_RADIX_SIZE + 2)];
+  TopKMultiBlockState<RadixType> s = sliceState[slice];
+
+  for (int j = 0; j < MULTI_BLOCK_RADIX_SIZE; ++j) {
+    int digit = Order ? MULTI_BLOCK_RADIX_SIZE - 1 - j : j;
+    unsigned int count = sliceCounts[digit];
+
+    if (count >= s.kToFind) {
+      s.desired = Bitfield<RadixType>::setBitfield(
+        s.desired, digit, radixDigitPos, MULTI_BLOCK_RADIX_BITS);
+      s.desiredMask = Bitfield<RadixType>::setBitfield(
+        s.desiredMask, MULTI_BLOCK_RADIX_SIZE - 1, radixDigitPos, MULTI_BLOCK_RADIX_BITS);
+      break;
+    }
+
+    s.kToFind -= count;
+  }
+
+  for (int j = 0; j < MULTI_BLOCK_RADIX_SIZE; ++j) {
+    sliceCounts[j] = 0;
+  }
+  sliceState[slice] = s;
+}
+
+// Writes out the top-K of each slice once its top-Kth element is known.
+// Blocks reserve output positions with one atomic per warp, so the
+// order of the results is arbitrary.
+template <typename T, typename IndexType, int Dim, bool Order>
+__global__ void gatherTopKMultiBlock(TensorInfo<T, IndexType> input,
+                                     IndexType inputSliceSize,
+                                     IndexType outputSliceSize, // aka `k`
+                                     IndexType inputWithinSliceStride,
+
+                                     TensorInfo<T, IndexType> topK,
+                                     IndexType topKWithinSliceStride,
+
+                                     TensorInfo<int64_t, IndexType> indices,
+                                     IndexType indicesWithinSliceStride,
+
+                                     TopKMultiBlockState<typename TopKTypeConfig<T>::RadixType>* sliceState,
+                                     unsigned int* counts) {
+  typedef typename TopKTypeConfig<T>::RadixType RadixType;
+
+  IndexType slice = blockIdx.y;
+  T* inputSliceStart =
+    &input.data[IndexToOffset<T, IndexType, Dim>::get(slice, input)];
+  T* topKSliceStart =
+    &topK.data[IndexToOffset<T, IndexType, Dim>::get(slice, topK)];
+  int64_t* indicesSliceStart =
+    &indices.data[IndexToOffset<int64_t, IndexType, Dim>::get(slice, indices)];
+
+  RadixType topKValue = sliceState[slice].desired;
+  unsigned int topKRemaining = sliceState[slice].kToFind;
+  unsigned int numStrict = outputSliceSize - topKRemaining;
+  unsigned int* strictCount = &counts[slice * (MULTI_BLOCK_RADIX_SIZE + 2) + MULTI_BLOCK_RADIX_SIZE];
+  unsigned int* equalCount = strictCount + 1;
+
+  // All threads go through the same number of iterations, so that whole
+  // warps vote
+  IndexType stride = gridDim.x * blockDim.x;
+  IndexType numIterations = THCRoundUp(inputSliceSize, stride);
+
+  for (IndexType i = blockIdx.x * blockDim.x + threadIdx.x; i < numIterations; i += stride) {
+    bool inRange = (i < inputSliceSize);
+    RadixType v = inRange ?
+      TopKTypeConfig<T>::convert(doLdg(&inputSliceStart[i * inputWithinSliceStride])) : 0;
+    bool hasTopK = inRange && (Order ? (v > topKValue) : (v < topKValue));
+    bool isTopKValue = inRange && (v == topKValue);
+
+    unsigned int vote = WARP_BALLOT(hasTopK, ACTIVE_MASK());
+    unsigned int writeIndexStart = 0;
+    if (getLaneId() == 0 && vote) {
+      writeIndexStart = atomicAdd(strictCount, __popc(vote));
+    }
+    writeIndexStart = WARP_SHFL(writeIndexStart, 0);
+
+    if (hasTopK) {
+      IndexType writeIndex = writeIndexStart + __popc(vote & getLaneMaskLt());
+      topKSliceStart[writeIndex * topKWithinSliceStride] =
+        TopKTypeConfig<T>::deconvert(v);
+      indicesSliceStart[writeIndex * indicesWithinSliceStride] = i + TH_INDEX_BASE; // to Lua index
+    }
+
+    // Fill in the rest with the first elements equal to the top-Kth to
+    // claim a position
+    vote = WARP_BALLOT(isTopKValue, ACTIVE_MASK());
+    writeIndexStart = 0;
+    if (getLaneId() == 0 && vote) {
+      writeIndexStart = atomicAdd(equalCount, __popc(vote));
+    }
+    writeIndexStart = WARP_SHFL(writeIndexStart, 0);
+
+    unsigned int index = writeIndexStart + __popc(vote & getLaneMaskLt());
+    if (isTopKValue && index < topKRemaining) {
+      IndexType writeIndex = numStrict + index;
+      topKSliceStart[writeIndex * topKWithinSliceStride] =
+        TopKTypeConfig<T>::deconvert(v);
+      indicesSliceStart[writeIndex * indicesWithinSliceStride] = i + TH_INDEX_BASE; // to Lua index
+    }
+  }
+}
+
+// Whether topk should run the multi-block selection on slices of this
+// size. The counts it keeps are 32 bit.
+inline bool THC_topKUseMultiBlock(THCState* state, int64_t numSlices, int64_t sliceSize) {
+  int numSMs = THCState_getCurrentDeviceProperties(state)->multiProcessorCount;
+  return numSlices < numSMs &&
+    sliceSize >= TOPK_MULTI_BLOCK_MIN_SLICE_SIZE &&
+    sliceSize <= (int64_t) UINT_MAX;
+}
+
+// Selects the top-K of each slice with a radix selection spread over
+// many blocks per slice: each digit pass builds one histogram per slice
+// with global atomics, and a small kernel picks the digit from it.
+template <typename T, typename IndexType, int Dim, bool Order>
+void topKMultiBlock(THCState* state,
+                    TensorInfo<T, IndexType> input,
+                    IndexType inputSliceSize,
+                    IndexType outputSliceSize, // aka `k`
+                    IndexType numInputSlices,
+                    IndexType inputWithinSliceStride,
+                    TensorInfo<T, IndexType> topK,
+                    IndexType topKWithinSliceStride,
+                    TensorInfo<int64_t, IndexType> indices,
+                    IndexType indicesWithinSliceStride) {
+  typedef typename TopKTypeConfig<T>::RadixType RadixType;
+  cudaStream_t stream = THCState_getCurrentStream(state);
+  int numSMs = THCState_getCurrentDeviceProperties(state)->multiProcessorCount;
+
+  // Enough blocks to fill the device a few times over, as long as each
+  // thread still sees several elements
+  IndexType blocksPerSlice = std::max((IndexType) 1,
+                                      THCCeilDiv((IndexType) (8 * numSMs), numInputSlices));
+  blocksPerSlice = std::min(blocksPerSlice,
+                            THCCeilDiv(inputSliceSize, (IndexType) (MULTI_BLOCK_THREADS * 8)));
+  dim3 grid(blocksPerSlice, numInputSlices);
+  dim3 block(MULTI_BLOCK_THREADS);
+
+  TopKMultiBlockState<RadixType>* sliceState = NULL;
+  unsigned int* counts = NULL;
+  THCudaCheck(THCudaMalloc(state, (void**) &sliceState,
+                           numInputSlices * sizeof(TopKMultiBlockState<RadixType>)));
+  THCudaCheck(THCudaMalloc(state, (void**) &counts,
+                           numInputSlices * (MULTI_BLOCK_RADIX_SIZE + 2) * sizeof(unsigned int)));
+
+  dim3 sliceGrid(THCCeilDiv(numInputSlices, (IndexType) 32));
+  dim3 sliceBlock(32);
+  initTopKMultiBlock<RadixType><<<sliceGrid, sliceBlock, 0, stream>>>(
+    sliceState, counts, numInputSlices, outputSliceSize);
+
+  for (int digitPos = sizeof(T) * 8 - MULTI_BLOCK_RADIX_BITS;
+       digitPos >= 0;
+       digitPos -= MULTI_BLOCK_RADIX_BITS) {
+    countRadixMultiBlock<T, IndexType, Dim><<<grid, block, 0, stream>>>(
+      input, inputSliceSize, inputWithinSliceStride, sliceState, counts, digitPos);
+    selectRadixMultiBlock<RadixType, Order><<<sliceGrid, sliceBlock, 0, stream>>>(
+      sliceState, counts, numInputSlices, digitPos);
+  }
+
+  gatherTopKMultiBlock<T, IndexType, Dim, Order><<<grid, block, 0, stream>>>(
+    input, inputSliceSize, outputSliceSize, inputWithinSliceStride,
+    topK, topKWithinSliceStride, indices, indicesWithinSliceStride,
+    sliceState, counts);
+
+  THCudaCheck(THCudaFree(state, counts));
+  THCudaCheck(THCudaFree(state, sliceState));
+}
+
+#undef MULTI_BLOCK_RADIX_BITS
+#undef MULTI_BLOCK_RADIX_SIZE
+#undef MULTI_BLOCK_THREADS
+
+// Small k is selected with one heap per warp, kept in shared memory,
+// which needs a single pass over the slice, and whose merged contents
+// come out sorted. k must be less than the heap size, since the last
+// entry of each heap is spare to make the merge a power of 2.
+#define TOPK_HEAP_SIZE 64
+#define TOPK_HEAP_THREADS 128 // the merge sorts 2 entries per thread
+#define TOPK_HEAP_MAX_K (TOPK_HEAP_SIZE - 1)
+
+// Orders elements by value in the sorted radix format, and then by
+// index; the heaps start out filled with entries worse than any element
+template <typename RadixType, typename IndexType, bool Order>
+__device__ inline bool topKHeapBetter(RadixType kA, IndexType vA,
+                                      RadixType kB, IndexType vB) {
+  return (Order ? (kA > kB) : (kA < kB)) || ((kA == kB) && (vA < vB));
+}
+
+template <typename RadixType, bool Order>
+struct TopKHeapComp {
+  __device__ inline bool operator()(const RadixType& a, const RadixType& b) const {
+    return Order ? (a > b) : (a < b);
+  }
+};
+
+// Replaces the head of a warp heap, whose head is its worst entry, if
+// (k, v) is better, then moves it down to its place
+template <typename RadixType, typename IndexType, bool Order>
+__device__ inline void topKHeapInsert(RadixType k, IndexType v,
+                                      RadixType* keyHeap, IndexType* valueHeap) {
+  // Another lane may have inserted something better since we voted
+  if (!topKHeapBetter<RadixType, IndexType, Order>(k, v, keyHeap[0], valueHeap[0])) {
+    return;
+  }
+
+  int i = 0;
+#pragma unroll
+  for (int level = 1; level < TOPK_HEAP_SIZE / 2; level *= 2) {
+    int leftChild = i * 2 + 1;
+    int rightChild = leftChild + 1;
+
+    // Swap with the worse child, if it is worse than (k, v)
+    bool left = topKHeapBetter<RadixType, IndexType, Order>(
+      keyHeap[rightChild], valueHeap[rightChild],
+      keyHeap[leftChild], valueHeap[leftChild]);
+    int child = left ? leftChild : rightChild;
+
+    if (!topKHeapBetter<RadixType, IndexType, Order>(
+          k, v, keyHeap[child], valueHeap[child])) {
+      break;
+    }
+
+    keyHeap[i] = keyHeap[child];
+    valueHeap[i] = valueHeap[child];
+    i = child;
+  }
+
+  keyHeap[i] = k;
+  valueHeap[i] = v;
+}
+
+template <typename T, typename IndexType, int Dim, bool Order>
+__launch_bounds__(TOPK_HEAP_THREADS)
+__global__ void gatherTopKViaHeap(TensorInfo<T, IndexType> input,
+                                  IndexType inputSliceSize,
+                                  IndexType outputSliceSize, // aka `k`
+
+                                  IndexType numInputSlices,
+                                  IndexType inputWithinSliceStride,
+
+                                  TensorInfo<T, IndexType> topK,
+                                  IndexType numTopKSlices,
+                                  IndexType topKWithinSliceStride,
+
+                                  TensorInfo<int64_t, IndexType> indices,
+                                  IndexType indicesWithinSliceStride) {
+  typedef typename TopKTypeConfig<T>::RadixType RadixType;
+  const int allHeapSize = (TOPK_HEAP_THREADS / 32) * TOPK_HEAP_SIZE;
+  const RadixType initKey = Order ? (RadixType) 0 : ~((RadixType) 0);
+  const IndexType initValue = ~((IndexType) 0);
+
+  __shared__ RadixType heapKeys[allHeapSize];
+  __shared__ IndexType heapValues[allHeapSize];
+  __shared__ bool heapValid[allHeapSize];
+
+  IndexType slice = getLinearBlockId<IndexType>();
+  if (slice >= numInputSlices) {
+    return;
+  }
+
+  T* inputSliceStart =
+    &input.data[IndexToOffset<T, IndexType, Dim>::get(slice, input)];
+  T* topKSliceStart =
+    &topK.data[IndexToOffset<T, IndexType, Dim>::get(slice, topK)];
+  int64_t* indicesSliceStart =
+    &indices.data[IndexToOffset<int64_t, IndexType, Dim>::get(slice, indices)];
+
+  RadixType* keyHeap = &heapKeys[(threadIdx.x / 32) * TOPK_HEAP_SIZE];
+  IndexType* valueHeap = &heapValues[(threadIdx.x / 32) * TOPK_HEAP_SIZE];
+  for (int i = getLaneId(); i < TOPK_HEAP_SIZE; i += 32) {
+    keyHeap[i] = initKey;
+    valueHeap[i] = initValue;
+  }
+  __syncthreads();
+
+  RadixType headKey = initKey;
+  IndexType headValue = initValue;
+
+  // All threads need to participate in the loop, so that whole warps vote
+  IndexType numIterations = THCRoundUp(inputSliceSize, (IndexType) blockDim.x);
+  for (IndexType i = threadIdx.x; i < numIterations; i += blockDim.x) {
+    bool inRange = (i < inputSliceSize);
+    RadixType v = inRange ?
+      TopKTypeConfig<T>::convert(doLdg(&inputSliceStart[i * inputWithinSliceStride])) : initKey;
+    bool wantInsert = inRange &&
+      topKHeapBetter<RadixType, IndexType, Order>(v, i, headKey, headValue);
+
+    unsigned int mask = ACTIVE_MASK();
+    unsigned int vote = WARP_BALLOT(wantInsert, mask);
+    if (!vote) {
+      continue;
+    }
+
+    // The lanes with something to insert take turns
+    int index = __popc(vote & getLaneMaskLt());
+    int total = __popc(vote);
+    for (int j = 0; j < total; ++j) {
+      if (wantInsert && index == j) {
+        topKHeapInsert<RadixType, IndexType, Order>(v, i, keyHeap, valueHeap);
+        __threadfence_block();
+      }
+#if CUDA_VERSION >= 9000
+      __syncwarp(mask);
+#endif
+    }
+
+    headKey = keyHeap[0];
+    headValue = valueHeap[0];
+  }
+  __syncthreads();
+
+  // Merge the heaps; the entries they started out with sort last
+  for (int i = threadIdx.x; i < allHeapSize; i += blockDim.x) {
+    heapValid[i] = (heapValues[i] != initValue);
+  }
+
+  bitonicSort<TopKHeapComp<RadixType, Order>, RadixType, IndexType, IndexType, allHeapSize>(
+    heapKeys, heapValues, heapValid, TopKHeapComp<RadixType, Order>());
+
+  for (IndexType i = threadIdx.x; i < outputSliceSize; i += blockDim.x) {
+    topKSliceStart[i * topKWithinSliceStride] =
+      TopKTypeConfig<T>::deconvert(heapKeys[i]);
+    indicesSliceStart[i * indicesWithinSliceStride] =
+      heapValues[i] + TH_INDEX_BASE; // to Lua index
+  }
+}
+
 #undef RADIX_BITS
 #undef RADIX_SIZE
 #undef RADIX_MASK
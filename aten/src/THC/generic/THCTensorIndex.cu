@@ -92,6 +92,25 @@ bool THCTensor_(indexShouldBeMajor)(TensorInfo<real, unsigned int> &info,
   return false;
 }
 
+// Whether the row kernels of THCTensorIndexRows.cuh apply: `dim` is the
+// outermost dimension of contiguous tensors, so that every index picks a
+// contiguous row, and rows are wide enough to keep a warp busy.
+static bool THCTensor_(indexCanUseRows)(THCState *state, THCTensor *dst,
+                                        THCTensor *src, int dim,
+                                        ptrdiff_t sliceSize)
+{
+  return dim == 0 && sliceSize >= THC_INDEX_ROWS_MIN_SIZE &&
+         THCTensor_(size)(state, dst, 0) <= INT_MAX &&
+         THCTensor_(isContiguous)(state, dst) &&
+         THCTensor_(isContiguous)(state, src);
+}
+
+static int64_t THCTensor_(indexStride)(THCState *state, THCudaLongTensor *indices)
+{
+  return THCudaLongTensor_nDimension(state, indices) == 1
+    ? THCudaLongTensor_stride(state, indices, 0) : 1;
+}
+
 void THCTensor_(indexCopy)(THCState *state, THCTensor *dst, int dim, THCudaLongTensor *indices, THCTensor *src)
 {
   THCAssertSameGPU(THCTensor_(checkGPU)(state, 2, dst, src));
@@ -117,6 +136,15 @@ void THCTensor_(indexCopy)(THCState *state, THCTensor *dst, int dim, THCudaLongT
   cudaStream_t stream = THCState_getCurrentStream(state);
   int indContig = THCudaLongTensor_isContiguous(state, indices);
 
+  if (THCTensor_(indexCanUseRows)(state, dst, src, dim, sliceSize)) {
+    THC_indexCopyRows<real, true>(
+      state, THCTensor_(data)(state, dst), THCTensor_(data)(state, src),
+      THCudaLongTensor_data(state, indices),
+      THCTensor_(indexStride)(state, indices),
+      numIndices, sliceSize, dstCopyDimSize);
+    return;
+  }
+
   int mpc = THCState_getCurrentDeviceProperties(state)->multiProcessorCount;
 
 #define SMALL_INDEX(TENSOR_TYPE, TYPE, DST_DIM, SRC_DIM, IDX_DIM) \
@@ -306,6 +334,15 @@ void THCTensor_(indexAdd)(THCState *state, THCTensor *dst, int dim, THCudaLongTe
   cudaStream_t stream = THCState_getCurrentStream(state);
   int indContig = THCudaLongTensor_isContiguous(state, indices);
 
+  if (THCTensor_(indexCanUseRows)(state, dst, src, dim, sliceSize)) {
+    THC_indexAddRows<real>(
+      state, THCTensor_(data)(state, dst), THCTensor_(data)(state, src),
+      THCudaLongTensor_data(state, indices),
+      THCTensor_(indexStride)(state, indices),
+      numIndices, sliceSize, dstAddDimSize);
+    return;
+  }
+
   int mpc = THCState_getCurrentDeviceProperties(state)->multiProcessorCount;
 
 #define SMALL_INDEX(TENSOR_TYPE, TYPE, DST_DIM, SRC_DIM, IDX_DIM) \
@@ -555,6 +592,15 @@ void THCTensor_(indexSelect)(THCState *state, THCTensor *dst, THCTensor *src, in
   int64_t srcSelectDimSize = THCTensor_(size)(state, src, dim);
   ptrdiff_t sliceSize = dstTotalSize / numIndices;
 
+  if (THCTensor_(indexCanUseRows)(state, dst, src, dim, sliceSize)) {
+    THC_indexCopyRows<real, false>(
+      state, THCTensor_(data)(state, dst), THCTensor_(data)(state, src),
+      THCudaLongTensor_data(state, indices),
+      THCTensor_(indexStride)(state, indices),
+      numIndices, sliceSize, srcSelectDimSize);
+    return;
+  }
+
   int mpc = THCState_getCurrentDeviceProperties(state)->multiProcessorCount;
 
 #define SMALL_INDEX(TENSOR_TYPE, TYPE, DST_DIM, SRC_DIM, IDX_DIM) \
@@ -55,32 +55,14 @@ THCTensor_(maskedCopy)(THCState* state,
     THArgCheck(false, 2, "source nElements must be == mask `1` elements");
   }
 
-  // FIXME: there appears to be a bug in Thrust (CUDA 7.0) for mixed
-  // iterator prefix sums? Convert `mask` to the same datatype as what
-  // we're accumulating the prefix sum in (int64_t) to get around it
-  THCudaLongTensor* maskLong = THCudaLongTensor_new(state);
+  // Use a prefix sum to determine the output locations of the masked
+  // elements. cub sums the bytes of the mask in int64_t directly.
+  THCudaByteTensor* maskContig = THCudaByteTensor_newContiguous(state, mask);
   THLongStorage* maskSizes = THCudaByteTensor_newSizeOf(state, mask);
-  THCudaLongTensor_resize(state, maskLong, maskSizes, NULL);
-  THCudaLongTensor_copyCudaByte(state, maskLong, mask);
-
-  // Use a prefix sum to determine the output locations of the masked elements
-  THCudaLongTensor* maskPrefixSum = THCudaLongTensor_new(state);
-  THCudaLongTensor_resize(state, maskPrefixSum, maskSizes, NULL);
+  THCudaLongTensor* maskPrefixSum = THCudaLongTensor_newWithSize(state, maskSizes, NULL);
   THLongStorage_free(maskSizes);
-
-  THCThrustAllocator thrustAlloc(state);
-  thrust::device_ptr<int64_t>
-    maskData(THCudaLongTensor_data(state, maskLong));
-  thrust::device_ptr<int64_t>
-    maskPrefixSumData(THCudaLongTensor_data(state, maskPrefixSum));
-
-  thrust::exclusive_scan(
-#if CUDA_VERSION >= 7000
-    thrust::cuda::par(thrustAlloc).on(THCState_getCurrentStream(state)),
-#endif
-    maskData,
-    maskData + THCudaLongTensor_nElement(state, maskLong),
-    maskPrefixSumData);
+  THC_exclusiveSum(state, THCudaByteTensor_data(state, maskContig),
+                   THCudaLongTensor_data(state, maskPrefixSum), maskSize);
 
   // We are getting elements from `src` based on an offset from
   // `maskPrefixSum`, so that should be made contiguous too
@@ -94,7 +76,7 @@ THCTensor_(maskedCopy)(THCState* state,
       THCTensor_(data)(state, contigSrc)));
 
   THCTensor_(free)(state, contigSrc);
-  THCudaLongTensor_free(state, maskLong);
+  THCudaByteTensor_free(state, maskContig);
   THCudaLongTensor_free(state, maskPrefixSum);
 
   THArgCheck(status, 2, CUTORCH_DIM_WARNING);
@@ -121,59 +103,28 @@ THCTensor_(maskedSelect)(THCState* state,
              THCTensor_(nElement)(state, src),
              2, "sizes do not match");
 
-  // Determine our output size
-  ptrdiff_t totalElements = THCudaByteTensor_sumall(state, mask);
+  // Compact the selected elements, which also counts them, then copy them
+  // to the output once it can be sized
+  ptrdiff_t srcSize = THCTensor_(nElement)(state, src);
+  THCTensor* srcContig = THCTensor_(newContiguous)(state, src);
+  THCudaByteTensor* maskContig = THCudaByteTensor_newContiguous(state, mask);
+  real* selected = NULL;
+  THCudaCheck(THCudaMalloc(state, (void**)&selected,
+                           std::max<ptrdiff_t>(srcSize, 1) * sizeof(real)));
+  ptrdiff_t totalElements = THC_selectFlagged(
+    state, THCTensor_(data)(state, srcContig),
+    THCudaByteTensor_data(state, maskContig), selected, srcSize);
+  THCTensor_(free)(state, srcContig);
+  THCudaByteTensor_free(state, maskContig);
+
+  THCTensor_(resize1d)(state, tensor, totalElements);
   THCTensor* tensorContig = THCTensor_(newContiguous)(state, tensor);
-
-  THCTensor_(resize1d)(state, tensorContig, totalElements);
-  if (tensor != tensorContig) {
-    THCTensor_(resize1d)(state, tensor, totalElements);
-  }
-
-  // FIXME: there appears to be a bug in Thrust (CUDA 7.0) for mixed
-  // iterator prefix sums? Convert `mask` to the same datatype as what
-  // we're accumulating the prefix sum in (int64_t) to get around it
-  THCudaLongTensor* maskLong = THCudaLongTensor_new(state);
-  THLongStorage* maskSizes = THCudaByteTensor_newSizeOf(state, mask);
-  THCudaLongTensor_resize(state, maskLong, maskSizes, NULL);
-  THCudaLongTensor_copyCudaByte(state, maskLong, mask);
-
-  // Use a prefix sum to determine the output locations of the masked elements
-  THCudaLongTensor* maskPrefixSum = THCudaLongTensor_new(state);
-  THCudaLongTensor_resize(state, maskPrefixSum, maskSizes, NULL);
-  THLongStorage_free(maskSizes);
-
-  THCThrustAllocator thrustAlloc(state);
-  thrust::device_ptr<int64_t>
-    maskData(THCudaLongTensor_data(state, maskLong));
-  thrust::device_ptr<int64_t>
-    maskPrefixSumData(THCudaLongTensor_data(state, maskPrefixSum));
-
-  thrust::exclusive_scan(
-#if CUDA_VERSION >= 7000
-    thrust::cuda::par(thrustAlloc).on(THCState_getCurrentStream(state)),
-#endif
-    maskData,
-    maskData + THCudaLongTensor_nElement(state, maskLong),
-    maskPrefixSumData);
-
-  // Then copy over the masked elements at their desired output index
-  bool status = THC_pointwiseApply3(
-    state, mask, maskPrefixSum,
-    src, TensorMaskedSelectOp<real, unsigned char, int64_t>(
-      THCTensor_(data)(state, tensor)));
-
-  THCudaLongTensor_free(state, maskLong);
-  THCudaLongTensor_free(state, maskPrefixSum);
-
-  if (tensor != tensorContig) {
-    THCTensor_(freeCopyTo)(state, tensorContig, tensor);
-  } else {
-    THCTensor_(free)(state, tensorContig);
-  }
-
-  THArgCheck(status, 2, CUTORCH_DIM_WARNING);
-  THCudaCheck(cudaGetLastError());
+  THCudaCheck(cudaMemcpyAsync(
+    THCTensor_(data)(state, tensorContig), selected,
+    totalElements * sizeof(real), cudaMemcpyDeviceToDevice,
+    THCState_getCurrentStream(state)));
+  THCudaCheck(THCudaFree(state, selected));
+  THCTensor_(freeCopyTo)(state, tensorContig, tensor);
 }
 
 // FIXME: remove now that we have THCudaByteTensor?
@@ -305,63 +305,38 @@ void THCTensor_(nonzero)(THCState* state, THCudaLongTensor *tensor,
   THCAssertSameGPU(THCTensor_(checkGPU)(state, 1, self  ));
   THCAssertSameGPU(THCudaLongTensor_checkGPU(state, 1, tensor));
 
-
-  using namespace thrust::placeholders;
-  THCThrustAllocator thrustAlloc(state);
   self = THCTensor_(newContiguous)(state, self);
-  thrust::device_ptr<real> self_data(THCTensor_(data)(state, self));
-
   int num_dim = THCTensor_(nDimension)(state, self);
   int64_t N = THCTensor_(nElement)(state, self);
-
-  THCudaLongTensor_resize2d(state, tensor, N, num_dim);
-  tensor = THCudaLongTensor_newContiguous(state, tensor);
-  thrust::device_ptr<int64_t> tensor_data(THCudaLongTensor_data(state, tensor));
-
-  thrust::counting_iterator<int64_t> idxfirst(0);
-  thrust::counting_iterator<int64_t> idxlast = idxfirst + N;
-
-  typedef thrust::device_ptr<int64_t> Iter;
-  strided_range<Iter> strided_tensor(tensor_data,
-                                     tensor_data+N*num_dim, num_dim);
-
-#if CUDA_VERSION >= 7000
-  cudaStream_t stream = THCState_getCurrentStream(state);
-#endif
-
-  strided_range<Iter>::iterator dend = thrust::copy_if(
-#if CUDA_VERSION >= 7000
-    thrust::cuda::par(thrustAlloc).on(stream),
-#endif
-    idxfirst,
-    idxlast,
-    self_data,
-    strided_tensor.begin(),
-    NonZeroOp<real>()
-  );
-
-  int64_t num_nonzeros = thrust::distance(strided_tensor.begin(), dend);
-
-  int64_t div = 1;
-  for (int dim = num_dim-1; dim >= 0; dim--) {
-    strided_range<Iter> stride_dim(tensor_data+dim,
-                                   tensor_data+N*num_dim, num_dim);
-    thrust::transform(
-#if CUDA_VERSION >= 7000
-      thrust::cuda::par(thrustAlloc).on(stream),
-#endif
-      strided_tensor.begin(),
-      strided_tensor.end(),
-      stride_dim.begin(),
-      idx_functor(div, self->size[dim])
-    );
-    div *= self->size[dim];
-  }
+  THArgCheck(num_dim <= MAX_CUTORCH_DIMS, 2, CUTORCH_DIM_WARNING);
+
+  // Compact the linear indices of the nonzero elements, then turn them into
+  // coordinates once the output can be sized
+  int64_t* indices = NULL;
+  THCudaCheck(THCudaMalloc(state, (void**)&indices, std::max<int64_t>(N, 1) * sizeof(int64_t)));
+  int64_t num_nonzeros = THC_selectFlagged(
+    state,
+    cub::CountingInputIterator<int64_t>(0),
+    cub::TransformInputIterator<bool, NonZeroOp<real>, real*>(
+      THCTensor_(data)(state, self), NonZeroOp<real>()),
+    indices, N);
 
   THCudaLongTensor_resize2d(state, tensor, num_nonzeros, num_dim);
+  THCudaLongTensor* coordinates = THCudaLongTensor_newContiguous(state, tensor);
+  if (num_nonzeros > 0) {
+    THCNonzeroSizes sizes;
+    for (int dim = 0; dim < num_dim; dim++) {
+      sizes.sizes[dim] = THCTensor_(size)(state, self, dim);
+    }
+    dim3 threads(256);
+    dim3 grid(std::min<int64_t>(THCCeilDiv(num_nonzeros, (int64_t)threads.x), 1024));
+    THCTensor_kernel_nonzeroCoordinates<<<grid, threads, 0, THCState_getCurrentStream(state)>>>(
+      THCudaLongTensor_data(state, coordinates), indices, num_nonzeros, num_dim, sizes);
+  }
+  THCudaCheck(THCudaFree(state, indices));
 
   THCTensor_(free)(state, self);
-  THCudaLongTensor_free(state, tensor);
+  THCudaLongTensor_freeCopyTo(state, coordinates, tensor);
 
   THCudaCheck(cudaGetLastError());
 }
@@ -4,22 +4,32 @@
 
 #ifndef THC_REAL_IS_HALF
 template<class BinaryFunction>
-__host__ void THCTensor_(scanThrust)(
+__host__ void THCTensor_(scanFlat)(
     THCState *state,
     THCTensor *dst,
     THCTensor *src,
     BinaryFunction binary_op)
 {
-  THCThrustAllocator thrustAlloc(state);
-  thrust::device_ptr<real> src_data(THCTensor_(data)(state, src));
-  thrust::device_ptr<real> dst_data(THCTensor_(data)(state, dst));
-  ptrdiff_t size = THCTensor_(nElement)(state, src);
-  thrust::inclusive_scan(
-#if CUDA_VERSION >= 7000
-      thrust::cuda::par(thrustAlloc).on(THCState_getCurrentStream(state)),
-#endif
-      src_data, src_data + size, dst_data,
-      binary_op);
+  THC_inclusiveScan(state, THCTensor_(data)(state, src), THCTensor_(data)(state, dst),
+                    THCScanOp<real, BinaryFunction>(binary_op),
+                    THCTensor_(nElement)(state, src));
+}
+
+template<class BinaryFunction>
+__host__ void THCTensor_(scanSegmented)(
+    THCState *state,
+    THCTensor *dst,
+    THCTensor *src,
+    BinaryFunction binary_op)
+{
+  int64_t row_size = THCTensor_(size)(state, src, THCTensor_(nDimension)(state, src) - 1);
+  cub::TransformInputIterator<THCSegmentedValue<real>, THCSegmentedLoad<real>,
+                              cub::CountingInputIterator<int64_t> >
+    in(cub::CountingInputIterator<int64_t>(0),
+       THCSegmentedLoad<real>(THCTensor_(data)(state, src), row_size));
+  THC_inclusiveScan(state, in, THCSegmentedStore<real>(THCTensor_(data)(state, dst)),
+                    THCSegmentedScanOp<real, BinaryFunction>(binary_op),
+                    THCTensor_(nElement)(state, src));
 }
 #endif
 
@@ -88,9 +98,13 @@ void THCTensor_(scanDim)(THCState *state, THCTensor *self_, THCTensor *src,
   src = THCTensor_(newContiguous)(state, src);
 
 #ifndef THC_REAL_IS_HALF
-  if (ndim == 1) {
-    // thrust does not take an "init"
-    THCTensor_(scanThrust)(state, self, src, binary_op);
+  // cub does not take an "init", and counts items in int
+  bool use_cub = THCTensor_(nElement)(state, src) <= INT_MAX;
+  if (use_cub && ndim == 1) {
+    THCTensor_(scanFlat)(state, self, src, binary_op);
+  } else if (use_cub && dimension == ndim - 1 &&
+             THCTensor_(size)(state, src, dimension) >= THC_SEGMENTED_SCAN_MIN_ROW_SIZE) {
+    THCTensor_(scanSegmented)(state, self, src, binary_op);
   } else
 #endif
   if (dimension == ndim - 1) {
@@ -2,6 +2,33 @@
 #define THC_GENERIC_FILE "generic/THCTensorScatterGather.cu"
 #else
 
+// Whether every index picks a whole row: `dim` is the outermost dimension of
+// contiguous tensors, and the index is the same along each row of full width,
+// as when it was expanded from a (n, 1, ...) tensor. Returns the row size in
+// `rowSize`, for the row kernels of THCTensorIndexRows.cuh.
+static bool THCTensor_(scatterGatherCanUseRows)(THCState* state, THCTensor *tensor,
+                                                THCTensor *src, int dim,
+                                                THCudaLongTensor *index,
+                                                ptrdiff_t *rowSize) {
+  if (dim != 0 ||
+      THCTensor_(size)(state, tensor, 0) > INT_MAX ||
+      !THCTensor_(isContiguous)(state, tensor) ||
+      !THCTensor_(isContiguous)(state, src)) {
+    return false;
+  }
+  *rowSize = 1;
+  for (int d = 1; d < THCudaLongTensor_nDimension(state, index); d++) {
+    int64_t size = THCudaLongTensor_size(state, index, d);
+    if (size != THCTensor_(size)(state, tensor, d) ||
+        size != THCTensor_(size)(state, src, d) ||
+        (size > 1 && THCudaLongTensor_stride(state, index, d) != 0)) {
+      return false;
+    }
+    *rowSize *= size;
+  }
+  return *rowSize >= THC_INDEX_ROWS_MIN_SIZE;
+}
+
 #define RUN(TYPE, DIMS, REAL)                                           \
   THCudaTensor_gatherKernel<TYPE, REAL, DIMS>                                \
   <<<grid, block, 0, THCState_getCurrentStream(state)>>>(               \
@@ -33,6 +60,16 @@ void THCTensor_(gather)(THCState* state, THCTensor *tensor,
   THArgCheck(THCTensor_(nDimension)(state, tensor) <= MAX_CUTORCH_DIMS,
              1, CUTORCH_DIM_WARNING);
 
+  ptrdiff_t rowSize;
+  if (THCTensor_(scatterGatherCanUseRows)(state, tensor, src, dim, index, &rowSize)) {
+    THC_indexCopyRows<real, false>(
+      state, THCTensor_(data)(state, tensor), THCTensor_(data)(state, src),
+      THCudaLongTensor_data(state, index), THCudaLongTensor_stride(state, index, 0),
+      THCudaLongTensor_size(state, index, 0), rowSize,
+      THCTensor_(size)(state, src, 0));
+    return;
+  }
+
 
   const ptrdiff_t totalElements = THCudaLongTensor_nElement(state, index);
   const dim3 block = getApplyBlock();
@@ -127,6 +164,16 @@ void THCTensor_(scatter)(THCState* state, THCTensor *tensor, int dim, THCudaLong
   THArgCheck(THCTensor_(nDimension)(state, tensor) <= MAX_CUTORCH_DIMS,
              1, CUTORCH_DIM_WARNING);
 
+  ptrdiff_t rowSize;
+  if (THCTensor_(scatterGatherCanUseRows)(state, tensor, src, dim, index, &rowSize)) {
+    THC_indexCopyRows<real, true>(
+      state, THCTensor_(data)(state, tensor), THCTensor_(data)(state, src),
+      THCudaLongTensor_data(state, index), THCudaLongTensor_stride(state, index, 0),
+      THCudaLongTensor_size(state, index, 0), rowSize,
+      THCTensor_(size)(state, tensor, 0));
+    return;
+  }
+
   const ptrdiff_t totalElements = THCudaLongTensor_nElement(state, index);
   const dim3 block = getApplyBlock();
   dim3 grid;
@@ -214,6 +261,16 @@ void THCTensor_(scatterAdd)(THCState* state, THCTensor *tensor, int dim, THCudaL
   THArgCheck(THCTensor_(nDimension)(state, tensor) <= MAX_CUTORCH_DIMS,
              1, CUTORCH_DIM_WARNING);
 
+  ptrdiff_t rowSize;
+  if (THCTensor_(scatterGatherCanUseRows)(state, tensor, src, dim, index, &rowSize)) {
+    THC_indexAddRows<real>(
+      state, THCTensor_(data)(state, tensor), THCTensor_(data)(state, src),
+      THCudaLongTensor_data(state, index), THCudaLongTensor_stride(state, index, 0),
+      THCudaLongTensor_size(state, index, 0), rowSize,
+      THCTensor_(size)(state, tensor, 0));
+    return;
+  }
+
   const ptrdiff_t totalElements = THCudaLongTensor_nElement(state, index);
   const dim3 block = getApplyBlock();
   dim3 grid;
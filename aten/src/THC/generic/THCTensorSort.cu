@@ -276,6 +276,86 @@ void sortViaThrust(THCState* state,
   THCudaLongTensor_freeCopyTo(state, trContigIndices, indices);
 }
 
+#if defined(USE_CUB) && !defined(THC_REAL_IS_HALF)
+// Sorts all the slices in one segmented radix sort. Radix sort is stable,
+// like the Thrust path, and sorting in double buffers only takes one extra
+// copy of the keys and indices plus a small temporary storage.
+void sortViaCub(THCState* state,
+                THCTensor* sorted,
+                THCudaLongTensor* indices,
+                THCTensor* input,
+                int dim, bool dir) {
+  int nDims = THCTensor_(nDimension)(state, input);
+  int totalElements = (int) THCTensor_(nElement)(state, input);
+  int sliceSize = (int) THCTensor_(size)(state, input, dim);
+  int numSlices = totalElements / sliceSize;
+
+  // Lay the keys out with `dim` innermost, in a copy the sort can own
+  THCTensor* trKeys = THCTensor_(newWithTensor)(state, input);
+  if (dim != nDims - 1) {
+    THCTensor_(transpose)(state, trKeys, NULL, dim, nDims - 1);
+  }
+  THCTensor* keys = THCTensor_(newClone)(state, trKeys);
+  THCTensor_(free)(state, trKeys);
+  THCTensor* keysAlt = THCTensor_(new)(state);
+  THCTensor_(resizeAs)(state, keysAlt, keys);
+
+  THLongStorage* size = THCTensor_(newSizeOf)(state, keys);
+  THCudaLongTensor* values = THCudaLongTensor_newWithSize(state, size, NULL);
+  THCudaLongTensor* valuesAlt = THCudaLongTensor_newWithSize(state, size, NULL);
+  THLongStorage_free(size);
+  THCudaLongTensor_fillSliceWithIndex(state, values, nDims - 1);
+
+  cub::DoubleBuffer<real> keyBuffer(
+    THCTensor_(data)(state, keys), THCTensor_(data)(state, keysAlt));
+  cub::DoubleBuffer<int64_t> valueBuffer(
+    THCudaLongTensor_data(state, values),
+    THCudaLongTensor_data(state, valuesAlt));
+  SliceOffsetIterator beginOffsets(
+    cub::CountingInputIterator<int>(0), SliceToOffset(sliceSize));
+  SliceOffsetIterator endOffsets = beginOffsets + 1;
+  cudaStream_t stream = THCState_getCurrentStream(state);
+
+  // The first pass only computes the size of the temporary storage, which
+  // comes from the caching allocator
+  void* tempStorage = NULL;
+  size_t tempStorageBytes = 0;
+  for (int pass = 0; pass < 2; ++pass) {
+    if (dir) {
+      THCudaCheck(cub::DeviceSegmentedRadixSort::SortPairsDescending(
+        tempStorage, tempStorageBytes, keyBuffer, valueBuffer,
+        totalElements, numSlices, beginOffsets, endOffsets,
+        0, sizeof(real) * 8, stream));
+    } else {
+      THCudaCheck(cub::DeviceSegmentedRadixSort::SortPairs(
+        tempStorage, tempStorageBytes, keyBuffer, valueBuffer,
+        totalElements, numSlices, beginOffsets, endOffsets,
+        0, sizeof(real) * 8, stream));
+    }
+    if (pass == 0) {
+      tempStorageBytes = std::max<size_t>(tempStorageBytes, 1);
+      THCudaCheck(THCudaMalloc(state, &tempStorage, tempStorageBytes));
+    }
+  }
+  THCudaCheck(THCudaFree(state, tempStorage));
+
+  // The sorted slices are in whichever buffer the last pass wrote
+  THCTensor* sortedKeys = keyBuffer.selector == 0 ? keys : keysAlt;
+  THCudaLongTensor* sortedValues = valueBuffer.selector == 0 ? values : valuesAlt;
+  if (dim != nDims - 1) {
+    THCTensor_(transpose)(state, sortedKeys, NULL, dim, nDims - 1);
+    THCudaLongTensor_transpose(state, sortedValues, NULL, dim, nDims - 1);
+  }
+  THCTensor_(copy)(state, sorted, sortedKeys);
+  THCudaLongTensor_copy(state, indices, sortedValues);
+
+  THCTensor_(free)(state, keys);
+  THCTensor_(free)(state, keysAlt);
+  THCudaLongTensor_free(state, values);
+  THCudaLongTensor_free(state, valuesAlt);
+}
+#endif
+
 THC_API void THCTensor_(sort)(THCState* state,
                                THCTensor *sorted,
                                THCudaLongTensor *indices,
@@ -325,6 +405,15 @@ THC_API void THCTensor_(sort)(THCState* state,
     // layout
     THCTensor_(sortKeyValueInplace)(state, sorted, indices, dim, order);
   } else {
+#if defined(USE_CUB) && !defined(THC_REAL_IS_HALF)
+    // Sort all slices at once in a segmented radix sort, as long as CUB's
+    // int offsets can address the whole tensor
+    if (THCTensor_(nElement)(state, input) <= INT_MAX) {
+      sortViaCub(state, sorted, indices, input, dim, (bool) order);
+      THCudaCheck(cudaGetLastError());
+      return;
+    }
+#endif
     // Otherwise, fall back upon Thrust, which handles all other cases
     // (potentially slowly, with extra copies/memory allocations)
     sortViaThrust(state, sorted, indices, input, dim, (bool) order);
@@ -28,21 +28,54 @@ THC_API void THCTensor_(topk)(THCState* state,
   THCudaLongTensor_resize(state, indices, topKSize, NULL);
   THLongStorage_free(topKSize);
 
+  // A few huge slices are each selected by many blocks, and a small k
+  // through per-warp heaps; otherwise one block radix-selects each slice
+  int64_t numSlices = THCTensor_(nElement)(state, input) / sliceSize;
+  bool useMultiBlock = THC_topKUseMultiBlock(state, numSlices, sliceSize);
+  bool useHeap = !useMultiBlock && k <= TOPK_HEAP_MAX_K;
+
 #define RUN_K(INDEX_T, DIM, DIR)                                        \
-  gatherTopK<real, INDEX_T, DIM, DIR>                                   \
-    <<<grid, block, 0, THCState_getCurrentStream(state)>>>(             \
+  if (useMultiBlock) {                                                  \
+    topKMultiBlock<real, INDEX_T, DIM, DIR>(                            \
+      state,                                                            \
       inputInfo,                                                        \
       sliceSize,                                                        \
       k,                                                                \
       inputSlices,                                                      \
-      /* The actual dimension that the k-selection is running in */     \
-      /* may have changed from collapseDims() */                        \
       inputInfo.strides[collapseInputDim],                              \
       topKInfo,                                                         \
-      topKSlices,                                                       \
       topKInfo.strides[collapseTopKDim],                                \
       indicesInfo,                                                      \
-      indicesInfo.strides[collapseIndicesDim])
+      indicesInfo.strides[collapseIndicesDim]);                         \
+  } else if (useHeap) {                                                 \
+    gatherTopKViaHeap<real, INDEX_T, DIM, DIR>                          \
+      <<<grid, TOPK_HEAP_THREADS, 0, THCState_getCurrentStream(state)>>>( \
+        inputInfo,                                                      \
+        sliceSize,                                                      \
+        k,                                                              \
+        inputSlices,                                                    \
+        inputInfo.strides[collapseInputDim],                            \
+        topKInfo,                                                       \
+        topKSlices,                                                     \
+        topKInfo.strides[collapseTopKDim],                              \
+        indicesInfo,                                                    \
+        indicesInfo.strides[collapseIndicesDim]);                       \
+  } else {                                                              \
+    gatherTopK<real, INDEX_T, DIM, DIR>                                 \
+      <<<grid, block, 0, THCState_getCurrentStream(state)>>>(           \
+        inputInfo,                                                      \
+        sliceSize,                                                      \
+        k,                                                              \
+        inputSlices,                                                    \
+        /* The actual dimension that the k-selection is running in */   \
+        /* may have changed from collapseDims() */                      \
+        inputInfo.strides[collapseInputDim],                            \
+        topKInfo,                                                       \
+        topKSlices,                                                     \
+        topKInfo.strides[collapseTopKDim],                              \
+        indicesInfo,                                                    \
+        indicesInfo.strides[collapseIndicesDim]);                       \
+  }
 
 #define RUN_DIR(INDEX_T, DIM)                   \
   if (dir) {                                    \
@@ -123,8 +156,9 @@ THC_API void THCTensor_(topk)(THCState* state,
 #undef RUN_K
 
   // Sort the results if the user wants them sorted, since our
-  // selection routine does not ensure sorting
-  if (sorted) {
+  // selection routine does not ensure sorting; the heap selection
+  // already writes them out in order
+  if (sorted && !useHeap) {
     // FIXME: the k/v inplace sort along slice only works for size <=
     // 2048 at the moment
     if (sliceSize <= 2048) {
@@ -81,6 +81,52 @@ static void THNN_(im2col)(const real* data_im, const int channels,
   }
 }
 
+// col2im of a kernel whose windows tile the image without overlapping
+// (kernel == stride, no padding nor dilation, e.g. the kernel-2 stride-2
+// upsampling of decoders): every pixel takes at most one value of data_col,
+// which is stored rather than accumulated, a row of windows at a time.
+static void THNN_(col2im_tiled)(const real* data_col, const int channels,
+      const int height, const int width,
+      const int height_col, const int width_col,
+      const int kernel_h, const int kernel_w,
+      real* data_im) {
+  const int64_t plane_col = (int64_t)height_col * width_col;
+  // Pixels past the last window (output padding) take no value
+  const int covered = height_col * kernel_h == height && width_col * kernel_w == width;
+  int c_im;
+#pragma omp parallel for if(channels > 1) private(c_im)
+  for (c_im = 0; c_im < channels; ++c_im) {
+    real* im = data_im + (int64_t)c_im * height * width;
+    if (!covered) {
+      memset(im, 0, sizeof(real) * height * width);
+    }
+    for (int h_offset = 0; h_offset < kernel_h; ++h_offset) {
+      const real* col = data_col + (int64_t)(c_im * kernel_h + h_offset) * kernel_w * plane_col;
+      for (int h_col = 0; h_col < height_col; ++h_col) {
+        real* im_row = im + (int64_t)(h_col * kernel_h + h_offset) * width;
+        const real* col_row = col + h_col * width_col;
+        if (kernel_w == 2) {
+          const real* col_row1 = col_row + plane_col;
+          for (int w_col = 0; w_col < width_col; ++w_col) {
+            im_row[2 * w_col] = col_row[w_col];
+            im_row[2 * w_col + 1] = col_row1[w_col];
+          }
+        } else {
+          for (int w_offset = 0; w_offset < kernel_w; ++w_offset) {
+            const real* src = col_row + w_offset * plane_col;
+            for (int w_col = 0; w_col < width_col; ++w_col) {
+              im_row[w_col * kernel_w + w_offset] = src[w_col];
+            }
+          }
+        }
+      }
+    }
+  }
+}
+
+// Every channel of the image sums its own kernel_h * kernel_w rows of
+// data_col, so the channels are accumulated in parallel without races. Each
+// pixel still sums its values in the order of the rows of data_col.
 static void THNN_(col2im)(const real* data_col, const int channels,
       const int height, const int width,
       const int output_height, const int output_width,
@@ -89,21 +135,49 @@ static void THNN_(col2im)(const real* data_col, const int channels,
       const int stride_h, const int stride_w,
       const int dilation_h, const int dilation_w,
       real* data_im) {
-  memset(data_im, 0, sizeof(real) * height * width * channels);
   const int height_col = output_height;
   const int width_col = output_width;
-  const int channels_col = channels * kernel_h * kernel_w;
-  for (int c_col = 0; c_col < channels_col; ++c_col) {
-    int w_offset = c_col % kernel_w;
-    int h_offset = (c_col / kernel_w) % kernel_h;
-    int c_im = c_col / kernel_h / kernel_w;
-    for (int h_col = 0; h_col < height_col; ++h_col) {
-      for (int w_col = 0; w_col < width_col; ++w_col) {
-        int h_im = h_col * stride_h - pad_h + h_offset * dilation_h;
-        int w_im = w_col * stride_w - pad_w + w_offset * dilation_w;
-        if (h_im >= 0 && h_im < height && w_im >= 0 && w_im < width)
-          data_im[(c_im * height + h_im) * width + w_im] +=
-            data_col[(c_col * height_col + h_col) * width_col + w_col];
+  if (kernel_h == stride_h && kernel_w == stride_w && pad_h == 0 && pad_w == 0 &&
+      dilation_h == 1 && dilation_w == 1 &&
+      height_col * kernel_h <= height && width_col * kernel_w <= width) {
+    THNN_(col2im_tiled)(data_col, channels, height, width, height_col, width_col,
+                        kernel_h, kernel_w, data_im);
+    return;
+  }
+  const int64_t plane_col = (int64_t)height_col * width_col;
+  int c_im;
+#pragma omp parallel for if(channels > 1) private(c_im)
+  for (c_im = 0; c_im < channels; ++c_im) {
+    real* im = data_im + (int64_t)c_im * height * width;
+    memset(im, 0, sizeof(real) * height * width);
+    for (int h_offset = 0; h_offset < kernel_h; ++h_offset) {
+      for (int w_offset = 0; w_offset < kernel_w; ++w_offset) {
+        const real* col = data_col + (int64_t)((c_im * kernel_h + h_offset) * kernel_w + w_offset) * plane_col;
+        // The columns w_col of [w_begin, w_end) land inside the image, at
+        // w_col * stride_w + w_shift
+        int w_shift = w_offset * dilation_w - pad_w;
+        int w_begin = w_shift >= 0 ? 0 : (-w_shift + stride_w - 1) / stride_w;
+        int w_end = width - w_shift <= 0 ? 0 : (width - w_shift + stride_w - 1) / stride_w;
+        if (w_end > width_col) {
+          w_end = width_col;
+        }
+        for (int h_col = 0; h_col < height_col; ++h_col) {
+          int h_im = h_col * stride_h - pad_h + h_offset * dilation_h;
+          if (h_im < 0 || h_im >= height) {
+            continue;
+          }
+          real* im_row = im + (int64_t)h_im * width;
+          const real* col_row = col + h_col * width_col;
+          if (stride_w == 1) {
+            for (int w_col = w_begin; w_col < w_end; ++w_col) {
+              im_row[w_col + w_shift] += col_row[w_col];
+            }
+          } else {
+            for (int w_col = w_begin; w_col < w_end; ++w_col) {
+              im_row[w_col * stride_w + w_shift] += col_row[w_col];
+            }
+          }
+        }
       }
     }
   }
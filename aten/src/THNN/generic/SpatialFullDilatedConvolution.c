@@ -119,9 +119,10 @@ void THNN_(SpatialFullDilatedConvolution_updateOutput)(
   // Resize output
   THTensor_(resize4d)(output, batchSize, nOutputPlane, outputHeight, outputWidth);
 
-  // Resize temporary columns
-  THTensor_(resize2d)(columns, nOutputPlane*kW*kH, inputHeight*inputWidth);
-  THTensor_(zero)(columns);
+  // Resize temporary columns, one matrix per sample, so that the samples
+  // are computed in parallel like the frames of SpatialConvolutionMM. A
+  // single sample parallelizes its col2im over the output planes instead.
+  THTensor_(resize3d)(columns, batchSize, nOutputPlane*kW*kH, inputHeight*inputWidth);
 
   // Define a buffer of ones, for bias accumulation
   // Note: this buffer can be shared with other modules, it only ever gets increased,
@@ -132,21 +133,19 @@ void THNN_(SpatialFullDilatedConvolution_updateOutput)(
     THTensor_(fill)(ones, 1);
   }
 
-  // Helpers
-  THTensor *input_n = THTensor_(new)();
-  THTensor *output_n = THTensor_(new)();
-
-  int elt;
+  int64_t elt;
   // For each elt in batch, do:
+#pragma omp parallel for if(batchSize > 1) private(elt)
   for (elt = 0; elt < batchSize; elt ++) {
     // Matrix mulitply per output:
-    THTensor_(select)(input_n, input, 0, elt);
-    THTensor_(select)(output_n, output, 0, elt);
+    THTensor *input_n = THTensor_(newSelect)(input, 0, elt);
+    THTensor *output_n = THTensor_(newSelect)(output, 0, elt);
+    THTensor *columns_n = THTensor_(newSelect)(columns, 0, elt);
 
     // M,N,K are dims of matrix A and B
     // (see http://docs.nvidia.com/cuda/cublas/#cublas-lt-t-gt-gemm)
     int64_t m = weight->size[1] * weight->size[2] * weight->size[3];
-    int64_t n = columns->size[1];
+    int64_t n = columns_n->size[1];
     int64_t k = weight->size[0];
 
     // Do GEMM (note: this is a bit confusing because gemm assumes column-major matrices)
@@ -157,12 +156,12 @@ void THNN_(SpatialFullDilatedConvolution_updateOutput)(
         THTensor_(data)(input_n), n,
         THTensor_(data)(weight), m,
         0,
-        THTensor_(data)(columns), n
+        THTensor_(data)(columns_n), n
     );
 
     // Unpack columns back into input:
     THNN_(col2im)(
-      THTensor_(data)(columns),
+      THTensor_(data)(columns_n),
       nOutputPlane, outputHeight, outputWidth, inputHeight, inputWidth, kH, kW, padH, padW, dH, dW,
       dilationH, dilationW,
       THTensor_(data)(output_n)
@@ -187,11 +186,11 @@ void THNN_(SpatialFullDilatedConvolution_updateOutput)(
           THTensor_(data)(output_n), n_
       );
     }
-  }
 
-  // Free
-  THTensor_(free)(input_n);
-  THTensor_(free)(output_n);
+    THTensor_(free)(input_n);
+    THTensor_(free)(output_n);
+    THTensor_(free)(columns_n);
+  }
 
   // Resize output
   if (is_batch == 0) {
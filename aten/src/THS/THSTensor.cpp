@@ -1,6 +1,77 @@
 #include "THSTensor.hpp"
 
+#include <algorithm>
 #include <new>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#define THS_RADIX_BITS 11
+#define THS_RADIX_OMP_THRESHOLD 100000
+
+/* Sorts the n keys in [0, maxKey] and stores in perm the position each of
+   them came from. This is a stable least significant digit radix sort: each
+   pass counts the occurrences of one 11-bit digit in every chunk of the
+   keys, turns the counts into the position of every chunk's first key with
+   each digit, and scatters the chunks in parallel. Digits above the highest
+   bit of maxKey are skipped. */
+static void THS_radixSort(int64_t *keys, int64_t *perm, int64_t n, int64_t maxKey)
+{
+  const int64_t radix = 1 << THS_RADIX_BITS;
+  int nchunks = 1;
+#ifdef _OPENMP
+  if (n > THS_RADIX_OMP_THRESHOLD && !omp_in_parallel()) {
+    nchunks = omp_get_max_threads();
+  }
+#endif
+  std::vector<int64_t> keysBuffer(n), permBuffer(n), counts(nchunks * radix);
+  int64_t *srcKeys = keys, *srcPerm = perm;
+  int64_t *dstKeys = keysBuffer.data(), *dstPerm = permBuffer.data();
+  for (int64_t i = 0; i < n; i++) {
+    perm[i] = i;
+  }
+  int64_t chunkSize = (n + nchunks - 1) / nchunks;
+
+  for (int shift = 0; shift < 63 && (maxKey >> shift) > 0; shift += THS_RADIX_BITS) {
+    std::fill(counts.begin(), counts.end(), 0);
+    int64_t c;
+#pragma omp parallel for private(c) num_threads(nchunks) if (nchunks > 1)
+    for (c = 0; c < nchunks; c++) {
+      int64_t *count = counts.data() + c * radix;
+      int64_t end = std::min(n, (c + 1) * chunkSize);
+      for (int64_t i = c * chunkSize; i < end; i++) {
+        count[(srcKeys[i] >> shift) & (radix - 1)]++;
+      }
+    }
+    int64_t position = 0;
+    for (int64_t digit = 0; digit < radix; digit++) {
+      for (c = 0; c < nchunks; c++) {
+        int64_t count = counts[c * radix + digit];
+        counts[c * radix + digit] = position;
+        position += count;
+      }
+    }
+#pragma omp parallel for private(c) num_threads(nchunks) if (nchunks > 1)
+    for (c = 0; c < nchunks; c++) {
+      int64_t *next = counts.data() + c * radix;
+      int64_t end = std::min(n, (c + 1) * chunkSize);
+      for (int64_t i = c * chunkSize; i < end; i++) {
+        int64_t j = next[(srcKeys[i] >> shift) & (radix - 1)]++;
+        dstKeys[j] = srcKeys[i];
+        dstPerm[j] = srcPerm[i];
+      }
+    }
+    std::swap(srcKeys, dstKeys);
+    std::swap(srcPerm, dstPerm);
+  }
+
+  if (srcKeys != keys) {
+    std::copy(srcKeys, srcKeys + n, keys);
+    std::copy(srcPerm, srcPerm + n, perm);
+  }
+}
 
 #include "generic/THSTensor.cpp"
 #include "THSGenerateAllTypes.h"
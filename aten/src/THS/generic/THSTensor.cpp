@@ -436,8 +436,6 @@ THSTensor *THSTensor_(newCoalesce)(THSTensor *self) {
     return self;
   }
   THLongTensor *indices = THSTensor_(newIndices)(self);
-  THTensor *values_ = THSTensor_(newValues)(self);
-  THTensor *values = THTensor_(newContiguous)(values_);
   int64_t nDimI = THSTensor_(nDimensionI)(self);
   int64_t nDimV = THSTensor_(nDimensionV)(self);
 
@@ -453,6 +451,27 @@ THSTensor *THSTensor_(newCoalesce)(THSTensor *self) {
     factor *= self->size[d];
   }
 
+  // Tensors built from indices that are already sorted and unique (e.g. by
+  // another library, or from a coalesced tensor's indices) only need the flag
+  int64_t *keys = THLongTensor_data(indicesScalar);
+  int64_t sorted = 1;
+  for (int64_t j = 1; j < self->nnz && sorted; j++) {
+    sorted = keys[j - 1] < keys[j];
+  }
+  if (sorted) {
+    self->coalesced = 1;
+    THLongTensor_free(indicesScalar);
+    THLongTensor_free(indicesBuffer);
+    THLongTensor_free(indicesPermutation);
+    THLongTensor_free(indicesSlice);
+    THLongTensor_free(indices);
+    THSTensor_(retain)(self);
+    return self;
+  }
+
+  THTensor *values_ = THSTensor_(newValues)(self);
+  THTensor *values = THTensor_(newContiguous)(values_);
+
   THLongTensor *newIndices = THLongTensor_new();
   THTensor *newValues = THTensor_(new)();
   THLongTensor_resizeAs(newIndices, indices);
@@ -462,7 +481,9 @@ THSTensor *THSTensor_(newCoalesce)(THSTensor *self) {
   THSTensor_(rawResize)(dst, nDimI, nDimV, self->size);
   THSTensor_(_move)(dst, newIndices, newValues);
 
-  THLongTensor_sort(indicesBuffer, indicesPermutation, indicesScalar, 0, 0);
+  THLongTensor_copy(indicesBuffer, indicesScalar);
+  THS_radixSort(THLongTensor_data(indicesBuffer), THLongTensor_data(indicesPermutation),
+      self->nnz, factor - 1);
 
   int64_t i = -1;
   int64_t prev = -1;
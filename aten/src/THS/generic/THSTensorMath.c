@@ -527,14 +527,22 @@ void THSTensor_(hspmm)(THSTensor *r_, real alpha, THSTensor *sparse_, THTensor *
 
 void THSTensor_(spcadd)(THTensor *r_, THTensor *dense, real value, THSTensor *sparse_) {
   THTensor_(resizeAs)(r_, dense);
-  THSTensor *sparse = THSTensor_(newCoalesce)(sparse_);
+  // Duplicate indices just add up, so only the parallel scatter below, which
+  // can't have two threads update the same element, needs a coalesced tensor
+  int64_t       nDim = THTensor_(nDimension)(dense);
+  int64_t       nDimI = THSTensor_(nDimensionI)(sparse_);
+  THSTensor *sparse;
+  if (nDim > nDimI) {
+    sparse = sparse_;
+    THSTensor_(retain)(sparse);
+  } else {
+    sparse = THSTensor_(newCoalesce)(sparse_);
+  }
 
   int64_t k;
   THLongTensor  *indices = THSTensor_(newIndices)(sparse);
   THTensor      *values = THSTensor_(newValues)(sparse);
   THLongStorage *storage = THSTensor_(newSizeOf)(sparse);
-  int64_t       nDim = THTensor_(nDimension)(dense);
-  int64_t       nDimI = THSTensor_(nDimensionI)(sparse);
 
   if (r_ != dense) THTensor_(copy)(r_, dense);
 
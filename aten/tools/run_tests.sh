@@ -14,6 +14,7 @@ $BUILD_ROOT/src/ATen/test/dlconvertor_test
 $BUILD_ROOT/src/ATen/test/native_test
 $BUILD_ROOT/src/ATen/test/scalar_tensor_test
 $BUILD_ROOT/src/ATen/test/undefined_tensor_test
+$BUILD_ROOT/src/ATen/test/tensor_iterator_test
 if [[ -x $BUILD_ROOT/src/ATen/test/cudnn_test ]]; then
   $BUILD_ROOT/src/ATen/test/cudnn_test
 fi
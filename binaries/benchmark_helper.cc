@@ -17,6 +17,7 @@
 #include <string>
 
 #include "binaries/benchmark_helper.h"
+#include "binaries/benchmark_stats.h"
 #include "caffe2/core/blob_serialization.h"
 #ifdef __CUDA_ARCH__
 #include "caffe2/core/context_gpu.h"
@@ -176,7 +177,9 @@ void runNetwork(
     caffe2::NetDef& net_def,
     const bool run_individual,
     const int warmup,
-    const int iter) {
+    const int iter,
+    const bool auto_warmup,
+    const int max_warmup) {
   if (!net_def.has_name()) {
     net_def.set_name("benchmark");
   }
@@ -187,9 +190,7 @@ void runNetwork(
   LOG(INFO) << "Starting benchmark.";
   caffe2::ObserverConfig::initSampleRate(1, 1, 1, run_individual, warmup);
   LOG(INFO) << "Running warmup runs.";
-  for (int i = 0; i < warmup; ++i) {
-    CAFFE_ENFORCE(net->Run(), "Warmup run ", i, " has failed.");
-  }
+  warmupNetwork(net, warmup, auto_warmup, max_warmup);
 
   LOG(INFO) << "Main runs.";
   CAFFE_ENFORCE(
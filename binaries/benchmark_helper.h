@@ -88,4 +88,6 @@ void runNetwork(
     caffe2::NetDef&,
     const bool,
     const int,
-    const int);
+    const int,
+    const bool auto_warmup = false,
+    const int max_warmup = 0);
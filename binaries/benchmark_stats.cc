@@ -0,0 +1,441 @@
+/**
+ * Copyright (c) 2016-present, Facebook, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "binaries/benchmark_stats.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <utility>
+
+#include "caffe2/core/logging.h"
+#include "caffe2/core/operator.h"
+#include "caffe2/core/timer.h"
+
+using std::string;
+using std::vector;
+
+namespace {
+
+// Iterations compared by the steady state detector, and how close their
+// medians have to be
+constexpr int kSteadyWindow = 5;
+constexpr double kSteadyTolerance = 0.02;
+
+double median(vector<double> values) {
+  if (values.empty()) {
+    return 0;
+  }
+  std::sort(values.begin(), values.end());
+  size_t n = values.size();
+  return n % 2 ? values[n / 2] : (values[n / 2 - 1] + values[n / 2]) / 2;
+}
+
+string jsonEscape(const string& s) {
+  std::ostringstream out;
+  for (char c : s) {
+    switch (c) {
+      case '"':
+        out << "\\\"";
+        break;
+      case '\\':
+        out << "\\\\";
+        break;
+      case '\n':
+        out << "\\n";
+        break;
+      case '\t':
+        out << "\\t";
+        break;
+      default:
+        if ((unsigned char)c < 0x20) {
+          out << "\\u" << std::hex << std::setw(4) << std::setfill('0') << (int)c
+              << std::dec;
+        } else {
+          out << c;
+        }
+    }
+  }
+  return out.str();
+}
+
+// Just enough JSON to read back what writeOperatorStats writes
+struct JsonValue {
+  enum Kind { Null, Bool, Number, String, Array, Object };
+  Kind kind = Null;
+  double number = 0;
+  string str;
+  vector<JsonValue> items;
+  vector<std::pair<string, JsonValue>> members;
+
+  const JsonValue* get(const string& key) const {
+    for (const auto& member : members) {
+      if (member.first == key) {
+        return &member.second;
+      }
+    }
+    return nullptr;
+  }
+};
+
+class JsonParser {
+ public:
+  explicit JsonParser(const string& text) : text_(text) {}
+
+  JsonValue parse() {
+    JsonValue value = parseValue();
+    skipSpace();
+    CAFFE_ENFORCE_EQ(pos_, text_.size(), "Trailing characters in JSON");
+    return value;
+  }
+
+ private:
+  void skipSpace() {
+    while (pos_ < text_.size() && isspace((unsigned char)text_[pos_])) {
+      pos_++;
+    }
+  }
+
+  char peek() {
+    skipSpace();
+    CAFFE_ENFORCE_LT(pos_, text_.size(), "Unexpected end of JSON");
+    return text_[pos_];
+  }
+
+  void expect(char c) {
+    CAFFE_ENFORCE_EQ(peek(), c, "Malformed JSON at offset ", pos_);
+    pos_++;
+  }
+
+  JsonValue parseValue() {
+    JsonValue value;
+    char c = peek();
+    if (c == '{') {
+      value.kind = JsonValue::Object;
+      pos_++;
+      if (peek() != '}') {
+        do {
+          string key = parseString();
+          expect(':');
+          value.members.emplace_back(key, parseValue());
+        } while (peek() == ',' && ++pos_);
+      }
+      expect('}');
+    } else if (c == '[') {
+      value.kind = JsonValue::Array;
+      pos_++;
+      if (peek() != ']') {
+        do {
+          value.items.push_back(parseValue());
+        } while (peek() == ',' && ++pos_);
+      }
+      expect(']');
+    } else if (c == '"') {
+      value.kind = JsonValue::String;
+      value.str = parseString();
+    } else if (text_.compare(pos_, 4, "true") == 0) {
+      value.kind = JsonValue::Bool;
+      value.number = 1;
+      pos_ += 4;
+    } else if (text_.compare(pos_, 5, "false") == 0) {
+      value.kind = JsonValue::Bool;
+      pos_ += 5;
+    } else if (text_.compare(pos_, 4, "null") == 0) {
+      pos_ += 4;
+    } else {
+      value.kind = JsonValue::Number;
+      const char* begin = text_.c_str() + pos_;
+      char* end = nullptr;
+      value.number = strtod(begin, &end);
+      CAFFE_ENFORCE(end != begin, "Malformed JSON at offset ", pos_);
+      pos_ += end - begin;
+    }
+    return value;
+  }
+
+  string parseString() {
+    expect('"');
+    string result;
+    while (pos_ < text_.size() && text_[pos_] != '"') {
+      char c = text_[pos_++];
+      if (c == '\\') {
+        CAFFE_ENFORCE_LT(pos_, text_.size(), "Unexpected end of JSON");
+        char escaped = text_[pos_++];
+        switch (escaped) {
+          case 'n':
+            result += '\n';
+            break;
+          case 't':
+            result += '\t';
+            break;
+          case 'u':
+            CAFFE_ENFORCE_LE(pos_ + 4, text_.size(), "Unexpected end of JSON");
+            result += (char)strtol(text_.substr(pos_, 4).c_str(), nullptr, 16);
+            pos_ += 4;
+            break;
+          default:
+            result += escaped;
+        }
+      } else {
+        result += c;
+      }
+    }
+    expect('"');
+    return result;
+  }
+
+  const string& text_;
+  size_t pos_ = 0;
+};
+
+} // namespace
+
+double OperatorStats::mean() const {
+  double sum = 0;
+  for (double m : millis) {
+    sum += m;
+  }
+  return millis.empty() ? 0 : sum / millis.size();
+}
+
+double OperatorStats::stddev() const {
+  if (millis.size() < 2) {
+    return 0;
+  }
+  double m = mean();
+  double sum = 0;
+  for (double x : millis) {
+    sum += (x - m) * (x - m);
+  }
+  return std::sqrt(sum / (millis.size() - 1));
+}
+
+double OperatorStats::percentile(double p) const {
+  if (millis.empty()) {
+    return 0;
+  }
+  vector<double> sorted = millis;
+  std::sort(sorted.begin(), sorted.end());
+  double rank = p * (sorted.size() - 1);
+  size_t lower = (size_t)rank;
+  size_t upper = std::min(lower + 1, sorted.size() - 1);
+  return sorted[lower] + (rank - lower) * (sorted[upper] - sorted[lower]);
+}
+
+bool isSteady(const vector<double>& millis, int window, double tolerance) {
+  if (millis.size() < 2 * (size_t)window) {
+    return false;
+  }
+  auto end = millis.end();
+  double last = median(vector<double>(end - window, end));
+  double previous = median(vector<double>(end - 2 * window, end - window));
+  return std::abs(last - previous) <= tolerance * previous;
+}
+
+int warmupNetwork(
+    caffe2::NetBase* net,
+    int warmup,
+    bool auto_warmup,
+    int max_warmup) {
+  vector<double> millis;
+  caffe2::Timer timer;
+  int i = 0;
+  for (; i < warmup || (auto_warmup && i < max_warmup &&
+                        !isSteady(millis, kSteadyWindow, kSteadyTolerance));
+       ++i) {
+    timer.Start();
+    CAFFE_ENFORCE(net->Run(), "Warmup run ", i, " has failed.");
+    millis.push_back(timer.MilliSeconds());
+  }
+  if (auto_warmup) {
+    if (isSteady(millis, kSteadyWindow, kSteadyTolerance)) {
+      LOG(INFO) << "Steady after " << i << " warmup runs.";
+    } else {
+      LOG(WARNING) << "Not steady after " << i << " warmup runs.";
+    }
+  }
+  return i;
+}
+
+vector<OperatorStats> benchmarkOperators(caffe2::NetBase* net, int iter) {
+  auto operators = net->GetOperators();
+  vector<OperatorStats> stats(operators.size());
+  for (size_t j = 0; j < operators.size(); ++j) {
+    const auto& def = operators[j]->debug_def();
+    stats[j].index = j;
+    stats[j].name = def.name();
+    stats[j].type = def.type();
+    stats[j].millis.reserve(iter);
+  }
+  caffe2::Timer timer;
+  for (int i = 0; i < iter; ++i) {
+    for (size_t j = 0; j < operators.size(); ++j) {
+      // Run() finishes the computation on the device before returning
+      timer.Start();
+      CAFFE_ENFORCE(
+          operators[j]->Run(),
+          "Operator ",
+          stats[j].type,
+          " (",
+          stats[j].name,
+          ") failed in run ",
+          i);
+      stats[j].millis.push_back(timer.MilliSeconds());
+    }
+  }
+  return stats;
+}
+
+void writeOperatorStats(
+    const vector<OperatorStats>& stats,
+    const string& net_name,
+    int warmup,
+    const string& path) {
+  std::ofstream out(path);
+  CAFFE_ENFORCE(out, "Cannot open ", path);
+  out << std::setprecision(9);
+  out << "{\n  \"net\": \"" << jsonEscape(net_name) << "\",\n"
+      << "  \"warmup\": " << warmup << ",\n"
+      << "  \"operators\": [";
+  for (size_t j = 0; j < stats.size(); ++j) {
+    const auto& op = stats[j];
+    out << (j ? ",\n" : "\n") << "    {\"index\": " << op.index
+        << ", \"name\": \"" << jsonEscape(op.name) << "\", \"type\": \""
+        << jsonEscape(op.type) << "\", \"mean_ms\": " << op.mean()
+        << ", \"stddev_ms\": " << op.stddev()
+        << ", \"median_ms\": " << op.median()
+        << ", \"p90_ms\": " << op.percentile(0.9) << ", \"millis\": [";
+    for (size_t i = 0; i < op.millis.size(); ++i) {
+      out << (i ? ", " : "") << op.millis[i];
+    }
+    out << "]}";
+  }
+  out << "\n  ]\n}\n";
+  CAFFE_ENFORCE(out, "Failed writing ", path);
+}
+
+vector<OperatorStats> readOperatorStats(const string& path) {
+  std::ifstream in(path);
+  CAFFE_ENFORCE(in, "Cannot open ", path);
+  std::stringstream buffer;
+  buffer << in.rdbuf();
+  string text = buffer.str();
+  JsonValue root = JsonParser(text).parse();
+  const JsonValue* operators = root.get("operators");
+  CAFFE_ENFORCE(
+      operators && operators->kind == JsonValue::Array,
+      path,
+      " has no operators");
+  vector<OperatorStats> stats;
+  for (const auto& item : operators->items) {
+    OperatorStats op;
+    const JsonValue* index = item.get("index");
+    const JsonValue* name = item.get("name");
+    const JsonValue* type = item.get("type");
+    const JsonValue* millis = item.get("millis");
+    CAFFE_ENFORCE(index && type && millis, "Malformed operator in ", path);
+    op.index = (int)index->number;
+    op.name = name ? name->str : "";
+    op.type = type->str;
+    for (const auto& m : millis->items) {
+      op.millis.push_back(m.number);
+    }
+    stats.push_back(std::move(op));
+  }
+  return stats;
+}
+
+double mannWhitneyPValue(const vector<double>& a, const vector<double>& b) {
+  size_t n1 = a.size(), n2 = b.size();
+  if (n1 == 0 || n2 == 0) {
+    return 1;
+  }
+  vector<std::pair<double, int>> all;
+  for (double x : a) {
+    all.emplace_back(x, 0);
+  }
+  for (double x : b) {
+    all.emplace_back(x, 1);
+  }
+  std::sort(all.begin(), all.end());
+  // Rank sum of a, ties get their average rank
+  double rank_sum = 0;
+  double tie_term = 0;
+  for (size_t i = 0; i < all.size();) {
+    size_t j = i;
+    while (j < all.size() && all[j].first == all[i].first) {
+      j++;
+    }
+    double rank = (i + 1 + j) / 2.0;
+    for (size_t k = i; k < j; ++k) {
+      if (all[k].second == 0) {
+        rank_sum += rank;
+      }
+    }
+    double t = j - i;
+    tie_term += t * t * t - t;
+    i = j;
+  }
+  double n = n1 + n2;
+  double u = rank_sum - n1 * (n1 + 1) / 2.0;
+  double mu = n1 * n2 / 2.0;
+  double sigma = std::sqrt(n1 * n2 / 12.0 * ((n + 1) - tie_term / (n * (n - 1))));
+  if (sigma == 0) {
+    return 1;
+  }
+  double z = (u - mu) / sigma;
+  return std::erfc(std::abs(z) / std::sqrt(2.0));
+}
+
+int compareOperatorStats(
+    const vector<OperatorStats>& stats,
+    const vector<OperatorStats>& baseline,
+    double threshold,
+    double significance) {
+  if (stats.size() != baseline.size()) {
+    LOG(WARNING) << "The net has " << stats.size() << " operators, the baseline "
+                 << baseline.size();
+  }
+  int regressions = 0;
+  for (size_t j = 0; j < std::min(stats.size(), baseline.size()); ++j) {
+    const auto& op = stats[j];
+    const auto& base = baseline[j];
+    if (op.type != base.type) {
+      LOG(WARNING) << "Operator " << j << " is " << op.type
+                   << " but the baseline has " << base.type << ", skipping";
+      continue;
+    }
+    double median = op.median(), base_median = base.median();
+    double p = mannWhitneyPValue(op.millis, base.millis);
+    if (median > base_median * (1 + threshold) && p < significance) {
+      regressions++;
+      LOG(ERROR) << "Regression in operator " << j << " " << op.type << " ("
+                 << op.name << "): median " << median << " ms vs "
+                 << base_median << " ms ("
+                 << (base_median > 0 ? 100 * (median / base_median - 1) : 0)
+                 << "%), p = " << p;
+    } else {
+      VLOG(1) << "Operator " << j << " " << op.type << ": median " << median
+              << " ms vs " << base_median << " ms, p = " << p;
+    }
+  }
+  LOG(INFO) << regressions << " operators regressed against the baseline.";
+  return regressions;
+}
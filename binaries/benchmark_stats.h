@@ -0,0 +1,78 @@
+/**
+ * Copyright (c) 2016-present, Facebook, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "caffe2/core/net.h"
+
+// Latency of one operator of a benchmarked net, one sample per iteration
+struct OperatorStats {
+  int index;
+  std::string name;
+  std::string type;
+  std::vector<double> millis;
+
+  double mean() const;
+  double stddev() const;
+  double percentile(double p) const;
+  double median() const {
+    return percentile(0.5);
+  }
+};
+
+// Runs warmup iterations of net. With auto_warmup, keeps going until the
+// iteration times are steady (see isSteady) or max_warmup iterations have
+// run, whichever comes first, but runs at least warmup iterations. Returns
+// the number of iterations run.
+int warmupNetwork(
+    caffe2::NetBase* net,
+    int warmup,
+    bool auto_warmup,
+    int max_warmup);
+
+// Whether the last iterations in millis are steady: the median of the last
+// window of them is within tolerance (relative) of the median of the window
+// before.
+bool isSteady(const std::vector<double>& millis, int window, double tolerance);
+
+// Runs the operators of net one at a time, each synchronizing its device,
+// and returns the time each took in each of iter iterations.
+std::vector<OperatorStats> benchmarkOperators(caffe2::NetBase* net, int iter);
+
+// Writes stats as JSON: a summary (mean, stddev, median, p90) and the raw
+// samples of every operator, which readOperatorStats reads back.
+void writeOperatorStats(
+    const std::vector<OperatorStats>& stats,
+    const std::string& net_name,
+    int warmup,
+    const std::string& path);
+std::vector<OperatorStats> readOperatorStats(const std::string& path);
+
+// Two-sided p-value of the Mann-Whitney U test that a and b come from the
+// same distribution, with the normal approximation.
+double mannWhitneyPValue(const std::vector<double>& a, const std::vector<double>& b);
+
+// Logs the operators whose median latency grew by more than threshold
+// (relative) over baseline with a p-value below significance, and returns
+// how many there are. Operators are matched by position and type.
+int compareOperatorStats(
+    const std::vector<OperatorStats>& stats,
+    const std::vector<OperatorStats>& baseline,
+    double threshold,
+    double significance);
@@ -3,11 +3,17 @@
 #include <string>
 
 #include "binaries/benchmark_helper.h"
+#include "binaries/benchmark_stats.h"
 
 using std::make_shared;
 using std::string;
 using std::vector;
 
+CAFFE2_DEFINE_bool(
+    auto_warmup,
+    false,
+    "Once the --warmup iterations have run, keep warming up until the "
+    "iteration time is steady, up to max_warmup iterations in total.");
 CAFFE2_DEFINE_string(
     backend,
     "builtin",
@@ -43,7 +49,17 @@ CAFFE2_DEFINE_string(
     "float",
     "Input type when specifying the input dimension."
     "The supported types are float, uint8_t.");
+CAFFE2_DEFINE_string(
+    baseline_json,
+    "",
+    "A per_op_json file written by an earlier run. The operators are "
+    "benchmarked one at a time and compared against it; the benchmark exits "
+    "with status 1 if any operator regressed significantly.");
 CAFFE2_DEFINE_int(iter, 10, "The number of iterations to run.");
+CAFFE2_DEFINE_int(
+    max_warmup,
+    100,
+    "The maximum number of warmup iterations with auto_warmup.");
 CAFFE2_DEFINE_string(net, "", "The given net to benchmark.");
 CAFFE2_DEFINE_string(
     output,
@@ -57,10 +73,26 @@ CAFFE2_DEFINE_string(
     "",
     "The folder that the output should be written to. This "
     "folder must already exist in the file system.");
+CAFFE2_DEFINE_string(
+    per_op_json,
+    "",
+    "If set, benchmark the operators one at a time and write the latency "
+    "of every operator in every iteration, with summary statistics, to this "
+    "JSON file.");
+CAFFE2_DEFINE_double(
+    regression_threshold,
+    0.05,
+    "Relative increase of the median latency of an operator over "
+    "baseline_json that counts as a regression.");
 CAFFE2_DEFINE_bool(
     run_individual,
     false,
     "Whether to benchmark individual operators.");
+CAFFE2_DEFINE_double(
+    significance,
+    0.01,
+    "p-value of the Mann-Whitney U test below which a latency difference "
+    "against baseline_json is significant.");
 CAFFE2_DEFINE_bool(
     text_output,
     false,
@@ -100,12 +132,41 @@ int main(int argc, char** argv) {
       caffe2::FLAGS_input_dims,
       caffe2::FLAGS_input_type);
 
-  runNetwork(
-      workspace,
-      net_def,
-      caffe2::FLAGS_run_individual,
-      caffe2::FLAGS_warmup,
-      caffe2::FLAGS_iter);
+  int status = 0;
+  if (caffe2::FLAGS_per_op_json.size() || caffe2::FLAGS_baseline_json.size()) {
+    if (!net_def.has_name()) {
+      net_def.set_name("benchmark");
+    }
+    caffe2::NetBase* net = workspace->CreateNet(net_def);
+    CHECK_NOTNULL(net);
+    int warmup = warmupNetwork(
+        net,
+        caffe2::FLAGS_warmup,
+        caffe2::FLAGS_auto_warmup,
+        caffe2::FLAGS_max_warmup);
+    auto stats = benchmarkOperators(net, caffe2::FLAGS_iter);
+    if (caffe2::FLAGS_per_op_json.size()) {
+      writeOperatorStats(
+          stats, net_def.name(), warmup, caffe2::FLAGS_per_op_json);
+    }
+    if (caffe2::FLAGS_baseline_json.size()) {
+      int regressions = compareOperatorStats(
+          stats,
+          readOperatorStats(caffe2::FLAGS_baseline_json),
+          caffe2::FLAGS_regression_threshold,
+          caffe2::FLAGS_significance);
+      status = regressions > 0 ? 1 : 0;
+    }
+  } else {
+    runNetwork(
+        workspace,
+        net_def,
+        caffe2::FLAGS_run_individual,
+        caffe2::FLAGS_warmup,
+        caffe2::FLAGS_iter,
+        caffe2::FLAGS_auto_warmup,
+        caffe2::FLAGS_max_warmup);
+  }
 
   writeOutput(
       workspace,
@@ -114,5 +175,5 @@ int main(int argc, char** argv) {
       caffe2::FLAGS_output_folder,
       caffe2::FLAGS_text_output);
 
-  return 0;
+  return status;
 }
@@ -59,7 +59,14 @@ private:
   }
   at::Tensor tensorWrapping(const Tensor<Context>& ten_) {
     auto& ten = const_cast<Tensor<Context>&>(ten_);
-    return typeFor(ten).tensorFromBlob(ten.raw_mutable_data(), ten.dims());
+    void* data = ten.raw_mutable_data();
+    // the aten tensor holds a reference to the caffe2 memory, so that results
+    // that are views of an input stay valid after the input blob is reused
+    auto owner = std::make_shared<Tensor<Context>>();
+    owner->ResizeLike(ten);
+    owner->ShareData(ten);
+    return typeFor(ten).tensorFromBlob(
+        data, ten.dims(), [owner](void*) mutable { owner.reset(); });
   }
   at::Tensor loadInput(size_t i) {
     return tensorWrapping(Input(i));
@@ -80,10 +87,29 @@ private:
     #undef DEFINE_IF
     CAFFE_THROW("Unknown type meta"); // TODO: improve error message...
   }
+  // true if the memory of dst is part of the storage of t
+  bool aliases(Tensor<Context>* dst, const at::Tensor& t) {
+    if (dst->capacity_nbytes() == 0) {
+      return false;
+    }
+    auto storage = t.storage();
+    auto begin = static_cast<const char*>(storage->data());
+    auto end = begin + storage->size() * storage->elementSize();
+    auto data = static_cast<const char*>(dst->raw_data());
+    return data >= begin && data < end;
+  }
+  // the memory of contiguous results is adopted by the caffe2 output without
+  // copying, other results are copied into the memory of the output
   void assignTo(Tensor<Context> * dst, const at::Tensor & src_) {
-    at::Tensor src = src_.contiguous();
-    auto at_sizes = src.sizes();
+    auto at_sizes = src_.sizes();
     std::vector<int64_t> dims(at_sizes.begin(),at_sizes.end());
+    if (!src_.is_contiguous() && !aliases(dst, src_)) {
+      dst->Resize(dims);
+      void* data = dst->raw_mutable_data(typeMetaFor(src_));
+      src_.type().tensorFromBlob(data, src_.sizes()).copy_(src_);
+      return;
+    }
+    at::Tensor src = src_.contiguous();
     dst->Resize(dims);
     dst->ShareExternalPointer(
         src.data_ptr(), typeMetaFor(src), 0, [src](void* ptr) mutable {
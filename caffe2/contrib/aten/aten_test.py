@@ -67,6 +67,35 @@ class TestATen(hu.HypothesisTestCase):
 
         self.assertReferenceChecks(gc, op, inputs, ref)
 
+    @given(inputs=hu.tensors(n=1, min_dim=2, max_dim=2), **hu.gcs)
+    def test_transpose(self, inputs, gc, dc):
+        # the result is a non contiguous view, copied into the output
+        op = core.CreateOperator(
+            "ATen",
+            ["S"],
+            ["Z"],
+            operator="t")
+
+        def ref(X):
+            return [X.T]
+
+        self.assertReferenceChecks(gc, op, inputs, ref)
+
+    @given(inputs=hu.tensors(n=1), **hu.gcs)
+    def test_inplace_view(self, inputs, gc, dc):
+        # the result is a view of the input, which keeps its memory alive
+        # when the output replaces the input blob
+        op = core.CreateOperator(
+            "ATen",
+            ["S"],
+            ["S"],
+            operator="view", size=[-1])
+
+        def ref(X):
+            return [X.reshape(-1)]
+
+        self.assertReferenceChecks(gc, op, inputs, ref)
+
     @given(**hu.gcs)
     def test_ones(self, gc, dc):
         op = core.CreateOperator(
@@ -53,9 +53,37 @@ void AllreduceOp<Context>::initializeRingChunked() {
   }
 }
 
+template <class Context>
+void FusedAllreduceOp<Context>::initializeBuffers() {
+  buffers_.resize(num_devices_);
+  for (auto& buffer : buffers_) {
+    buffer.Resize(size_);
+    buffer.raw_mutable_data(meta_);
+  }
+}
+
+template <class Context>
+void FusedAllreduceOp<Context>::initializeHalvingDoubling() {
+  if (meta_.template Match<float>()) {
+    algorithm_.reset(new ::gloo::AllreduceHalvingDoubling<float>(
+        gloo_context_, getBuffers<float>(), size_));
+  } else if (meta_.template Match<::caffe2::float16>()) {
+    algorithm_.reset(new ::gloo::AllreduceHalvingDoubling<::gloo::float16>(
+        gloo_context_,
+        getBuffers<::gloo::float16>(),
+        size_));
+  } else {
+    CAFFE_ENFORCE(false, "Unhandled type: ", meta_.name());
+  }
+}
+
 namespace {
 
 REGISTER_CPU_OPERATOR_WITH_ENGINE(Allreduce, GLOO, AllreduceOp<CPUContext>);
+REGISTER_CPU_OPERATOR_WITH_ENGINE(
+    FusedAllreduce,
+    GLOO,
+    FusedAllreduceOp<CPUContext>);
 
 } // namespace
 } // namespace gloo
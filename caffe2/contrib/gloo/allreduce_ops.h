@@ -127,5 +127,141 @@ class AllreduceOp final : public Operator<Context> {
   const bool gpu_direct_;
 };
 
+// Allreduces blobs of possibly different sizes (e.g. the gradients of a
+// bucket of parameters) with a single Gloo algorithm. The blobs are copied
+// into persistent flat buffers, one per device, that the algorithm is
+// created for once and reused by every run.
+//
+// The inputs are the common world followed by the blobs, the copies of a
+// blob on the `num_devices` devices next to each other (blob 0 on device 0,
+// blob 0 on device 1, ..., blob 1 on device 0, ...). The outputs are the
+// same blobs.
+template <class Context>
+class FusedAllreduceOp final : public Operator<Context> {
+ public:
+  USE_OPERATOR_CONTEXT_FUNCTIONS;
+
+  FusedAllreduceOp(const OperatorDef& operator_def, Workspace* ws)
+      : Operator<Context>(operator_def, ws),
+        ws_(ws),
+        status_blob_(
+            OperatorBase::GetSingleArgument<std::string>("status_blob", "")),
+        gpu_direct_(
+            OperatorBase::GetSingleArgument<bool>("gpu_direct", false)),
+        num_devices_(
+            OperatorBase::GetSingleArgument<int>("num_devices", 1)) {
+    CAFFE_ENFORCE_GT(num_devices_, 0);
+    CAFFE_ENFORCE_EQ(
+        (InputSize() - 1) % num_devices_,
+        0,
+        "Every blob must be given for each of the ",
+        num_devices_,
+        " devices");
+    CAFFE_ENFORCE_EQ(InputSize() - 1, OutputSize());
+    if (status_blob_ != "") {
+      ws_->CreateBlob(status_blob_);
+    }
+  }
+
+  virtual ~FusedAllreduceOp() {}
+
+  bool RunOnDevice() override {
+    std::call_once(once_, [&] { initialize(); });
+
+    // The algorithm runs on the flat buffers, so only the common world and
+    // the sizes of the blobs have to stay the same
+    CAFFE_ENFORCE(
+        OperatorBase::Input<std::shared_ptr<::gloo::Context>>(0) ==
+            gloo_context_,
+        "Common world has changed");
+    for (auto i = 0; i < OutputSize(); i++) {
+      const auto& input = Input(i + 1);
+      CAFFE_ENFORCE_EQ(input.size(), sizes_[i / num_devices_],
+                       "Inputs have changed");
+      CAFFE_ENFORCE(input.meta() == meta_, "Inputs have changed");
+      context_.template CopyBytes<Context, Context>(
+          input.nbytes(), input.raw_data(), bufferData(i));
+    }
+    context_.FinishDeviceComputation();
+
+    try {
+      algorithm_->run();
+    } catch (::gloo::IoException& ioe) {
+      LOG(ERROR) << "Caught gloo IO exception: " << ioe.what();
+      if (status_blob_ != "") {
+        signalFailure(ws_->GetBlob(status_blob_), ioe);
+        return false;
+      } else {
+        throw ioe;
+      }
+    }
+
+    for (auto i = 0; i < OutputSize(); i++) {
+      auto* output = Output(i);
+      output->ResizeLike(Input(i + 1));
+      context_.template CopyBytes<Context, Context>(
+          output->nbytes(), bufferData(i), output->raw_mutable_data(meta_));
+    }
+    context_.FinishDeviceComputation();
+    return true;
+  }
+
+ protected:
+  void initialize() {
+    gloo_context_ = OperatorBase::Input<std::shared_ptr<::gloo::Context>>(0);
+
+    // Offsets of the blobs in the flat buffers
+    meta_ = Input(1).meta();
+    size_ = 0;
+    for (auto i = 0; i < OutputSize(); i += num_devices_) {
+      offsets_.push_back(size_);
+      sizes_.push_back(Input(i + 1).size());
+      size_ += sizes_.back();
+    }
+
+    for (auto i = 0; i < OutputSize(); i++) {
+      CAFFE_ENFORCE_EQ(Input(i + 1).size(), sizes_[i / num_devices_]);
+      CAFFE_ENFORCE(Input(i + 1).meta() == meta_);
+    }
+
+    initializeBuffers();
+    initializeHalvingDoubling();
+  }
+
+  // Allocates `buffers_`, the buffer of device `d` next to Input(d + 1)
+  void initializeBuffers();
+  void initializeHalvingDoubling();
+
+  // Where blob `i / num_devices_` of device `i % num_devices_` is copied
+  void* bufferData(int i) {
+    auto& buffer = buffers_[i % num_devices_];
+    return static_cast<char*>(buffer.raw_mutable_data(meta_)) +
+        offsets_[i / num_devices_] * meta_.itemsize();
+  }
+
+  template <typename T>
+  std::vector<T*> getBuffers() {
+    std::vector<T*> result;
+    for (auto& buffer : buffers_) {
+      result.push_back(buffer.template mutable_data<T>());
+    }
+    return result;
+  }
+
+  std::once_flag once_;
+  std::unique_ptr<::gloo::Algorithm> algorithm_;
+  std::shared_ptr<::gloo::Context> gloo_context_;
+  std::vector<Tensor<Context>> buffers_;
+  std::vector<size_t> offsets_;
+  std::vector<size_t> sizes_;
+  size_t size_;
+  TypeMeta meta_;
+
+  Workspace* ws_;
+  std::string status_blob_;
+  const bool gpu_direct_;
+  const int num_devices_;
+};
+
 } // namespace gloo
 } // namespace caffe2
@@ -100,9 +100,45 @@ void AllreduceOp<Context>::initializeRingChunked() {
   }
 }
 
+template <class Context>
+void FusedAllreduceOp<Context>::initializeBuffers() {
+  buffers_.resize(num_devices_);
+  for (auto d = 0; d < num_devices_; d++) {
+    // On the device of the blobs of the buffer
+    DeviceGuard guard(GetGPUIDForPointer(Input(d + 1).raw_data()));
+    buffers_[d].Resize(size_);
+    buffers_[d].raw_mutable_data(meta_);
+  }
+}
+
+template <class Context>
+void FusedAllreduceOp<Context>::initializeHalvingDoubling() {
+  if (meta_.template Match<float>()) {
+    algorithm_ =
+      initializeAlgorithm<::gloo::CudaAllreduceHalvingDoubling, float>(
+        gpu_direct_,
+        gloo_context_,
+        getBuffers<float>(),
+        size_);
+  } else if (meta_.template Match<float16>()) {
+    algorithm_ =
+      initializeAlgorithm<::gloo::CudaAllreduceHalvingDoubling, ::gloo::float16>(
+        gpu_direct_,
+        gloo_context_,
+        getBuffers<::gloo::float16>(),
+        size_);
+  } else {
+    CAFFE_ENFORCE(false, "Unhandled type: ", meta_.name());
+  }
+}
+
 namespace {
 
 REGISTER_CUDA_OPERATOR_WITH_ENGINE(Allreduce, GLOO, AllreduceOp<CUDAContext>);
+REGISTER_CUDA_OPERATOR_WITH_ENGINE(
+    FusedAllreduce,
+    GLOO,
+    FusedAllreduceOp<CUDAContext>);
 
 } // namespace
 } // namespace gloo
@@ -347,6 +347,91 @@ class TestCase(hu.HypothesisTestCase):
                     tmpdir=tmpdir,
                     use_float16=use_float16)
 
+    def _test_fused_allreduce(self,
+                              comm_rank=None,
+                              comm_size=None,
+                              blob_size=None,
+                              num_blobs=None,
+                              tmpdir=None,
+                              use_float16=False
+                              ):
+        store_handler, common_world = self.create_common_world(
+            comm_rank=comm_rank,
+            comm_size=comm_size,
+            tmpdir=tmpdir)
+
+        blob_size = self.synchronize(
+            store_handler,
+            blob_size,
+            comm_rank=comm_rank)
+
+        num_blobs = self.synchronize(
+            store_handler,
+            num_blobs,
+            comm_rank=comm_rank)
+
+        # Blobs of different sizes, reduced by a single op
+        blobs = []
+        for i in range(num_blobs):
+            blob = "blob_{}".format(i)
+            value = np.full((i + 1) * blob_size, comm_rank + i,
+                            np.float16 if use_float16 else np.float32)
+            workspace.FeedBlob(blob, value)
+            blobs.append(blob)
+
+        net = core.Net("fused_allreduce")
+        net.FusedAllreduce(
+            [common_world] + blobs,
+            blobs,
+            engine=op_engine)
+
+        workspace.CreateNet(net)
+        workspace.RunNet(net.Name())
+
+        rank_sum = comm_size * (comm_size - 1) / 2
+        for i in range(num_blobs):
+            np.testing.assert_array_equal(
+                workspace.FetchBlob(blobs[i]),
+                rank_sum + i * comm_size)
+
+        # The flat buffers and the algorithm are reused by later runs
+        for _tmp in range(4):
+            for i in range(num_blobs):
+                workspace.FeedBlob(blobs[i], np.full(
+                    (i + 1) * blob_size, comm_rank + i,
+                    np.float16 if use_float16 else np.float32))
+            workspace.RunNet(net.Name())
+            for i in range(num_blobs):
+                np.testing.assert_array_equal(
+                    workspace.FetchBlob(blobs[i]),
+                    rank_sum + i * comm_size)
+
+    @given(comm_size=st.integers(min_value=2, max_value=8),
+           blob_size=st.integers(min_value=1e3, max_value=1e5),
+           num_blobs=st.integers(min_value=1, max_value=4),
+           device_option=st.sampled_from([hu.cpu_do]),
+           use_float16=st.booleans())
+    def test_fused_allreduce(self, comm_size, blob_size, num_blobs,
+                             device_option, use_float16):
+        TestCase.test_counter += 1
+        if os.getenv('COMM_RANK') is not None:
+            self.run_test_distributed(
+                self._test_fused_allreduce,
+                blob_size=blob_size,
+                num_blobs=num_blobs,
+                use_float16=use_float16,
+                device_option=device_option)
+        else:
+            with TemporaryDirectory() as tmpdir:
+                self.run_test_locally(
+                    self._test_fused_allreduce,
+                    comm_size=comm_size,
+                    blob_size=blob_size,
+                    num_blobs=num_blobs,
+                    device_option=device_option,
+                    tmpdir=tmpdir,
+                    use_float16=use_float16)
+
     def _test_reduce_scatter(self,
                              comm_rank=None,
                              comm_size=None,
@@ -7,6 +7,12 @@
 #include "caffe2/core/logging.h"
 #include "onnx/onnx_pb.h"
 
+CAFFE2_DEFINE_string(
+    caffe2_tensorrt_engine_cache_dir,
+    "",
+    "Directory where TensorRT ops built from onnx_model cache their engines, "
+    "unless they set engine_cache_dir. Empty disables the cache.");
+
 namespace caffe2 {
 
 namespace {
@@ -91,13 +97,29 @@ TensorRTOp::TensorRTOp(const OperatorDef& operator_def, Workspace* ws)
       onnx_model_str.clear();
       onnx_model.SerializeToString(&onnx_model_str);
 
-      // Build the trt engine
-      trt_engine_ = tensorrt::BuildTrtEngine(
+      tensorrt::TrtBuildOptions build_options;
+      build_options.fp16_mode =
+          OperatorBase::GetSingleArgument<int>("fp16_mode", 0);
+      build_options.int8_mode =
+          OperatorBase::GetSingleArgument<int>("int8_mode", 0);
+      build_options.int8_calibration_db =
+          OperatorBase::GetSingleArgument<std::string>(
+              "int8_calibration_db", "");
+      build_options.int8_calibration_db_type =
+          OperatorBase::GetSingleArgument<std::string>(
+              "int8_calibration_db_type", "minidb");
+      build_options.engine_cache_dir =
+          OperatorBase::GetSingleArgument<std::string>(
+              "engine_cache_dir", FLAGS_caffe2_tensorrt_engine_cache_dir);
+
+      // Build the trt engine, or load it from the engine cache
+      trt_engine_ = tensorrt::LoadOrBuildTrtEngine(
           onnx_model_str,
           &logger_,
           max_batch_size_,
           max_workspace_size,
-          debug_builder);
+          debug_builder,
+          build_options);
     }
   }
 
@@ -252,7 +274,33 @@ This is a GPU only operator.
         "max_batch_size",
         "(int default 0) Batch size set by the TensorRT engine builder."
         "It must be no larger than the max_batch_size of the engine builder so "
-        "it is better not to edit this manually.");
+        "it is better not to edit this manually.")
+    .Arg(
+        "onnx_model",
+        "(string) Serialized ONNX model to build the engine from when "
+        "backend_buffer is not set. Its weights are pulled from the workspace "
+        "as listed by initializers.")
+    .Arg(
+        "fp16_mode",
+        "(int default 0) Build the engine from onnx_model with FP16 kernels "
+        "where the GPU has fast FP16. Inputs and outputs stay float.")
+    .Arg(
+        "int8_mode",
+        "(int default 0) Build the engine from onnx_model in INT8, calibrated "
+        "with int8_calibration_db.")
+    .Arg(
+        "int8_calibration_db",
+        "(string) DB of TensorProtos, one tensor per input, to calibrate the "
+        "INT8 engine with. Not needed once its calibration table is cached.")
+    .Arg(
+        "int8_calibration_db_type",
+        "(string default=\"minidb\") Type of int8_calibration_db.")
+    .Arg(
+        "engine_cache_dir",
+        "(string default=--caffe2_tensorrt_engine_cache_dir) Directory where "
+        "the engine built from onnx_model and its INT8 calibration table are "
+        "cached, keyed by the model, max_batch_size, max_workspace_size, "
+        "precision, GPU and TensorRT version.");
 
 REGISTER_CUDA_OPERATOR(TensorRT, TensorRTOp);
 } // namespace caffe2
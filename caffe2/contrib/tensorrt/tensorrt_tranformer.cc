@@ -247,6 +247,25 @@ OperatorDef TensorRTTransformer::BuildTrtOpLazy(
   auto* max_workspace_size_arg = op.add_arg();
   max_workspace_size_arg->set_name("max_workspace_size");
   max_workspace_size_arg->set_i(max_workspace_size_);
+  auto* fp16_mode_arg = op.add_arg();
+  fp16_mode_arg->set_name("fp16_mode");
+  fp16_mode_arg->set_i(build_options_.fp16_mode);
+  auto* int8_mode_arg = op.add_arg();
+  int8_mode_arg->set_name("int8_mode");
+  int8_mode_arg->set_i(build_options_.int8_mode);
+  if (build_options_.int8_mode) {
+    auto* calibration_db_arg = op.add_arg();
+    calibration_db_arg->set_name("int8_calibration_db");
+    calibration_db_arg->set_s(build_options_.int8_calibration_db);
+    auto* calibration_db_type_arg = op.add_arg();
+    calibration_db_type_arg->set_name("int8_calibration_db_type");
+    calibration_db_type_arg->set_s(build_options_.int8_calibration_db_type);
+  }
+  if (!build_options_.engine_cache_dir.empty()) {
+    auto* engine_cache_dir_arg = op.add_arg();
+    engine_cache_dir_arg->set_name("engine_cache_dir");
+    engine_cache_dir_arg->set_s(build_options_.engine_cache_dir);
+  }
   AddTrtOptions(&op, output_size_hints);
   return op;
 }
@@ -258,12 +277,13 @@ OperatorDef TensorRTTransformer::BuildTrtOp(
   op.set_type("TensorRT");
 
   tensorrt::TrtLogger logger;
-  auto trt_engine = tensorrt::BuildTrtEngine(
+  auto trt_engine = tensorrt::LoadOrBuildTrtEngine(
       onnx_model_str,
       &logger,
       max_batch_size_,
       max_workspace_size_,
-      debug_builder_);
+      debug_builder_,
+      build_options_);
 
   // Set up inputs/outputs in the order of they appearnce in getNbBindings
   int num_bindings = trt_engine->getNbBindings();
@@ -502,12 +522,20 @@ void TensorRTTransformer::Transform(
           return false;
         }
 
-        auto results = exporter.Caffe2OpToOnnxNodes(op, shape_hints);
-        for (const auto& n : results.first) {
-          if (!importer->supportsOperator(n.op_type().c_str())) {
-            LOG(INFO) << "TRT does not support ONNX node " << n.op_type();
-            return false;
+        // An op the exporter cannot convert, e.g. for lack of shapes, stays
+        // in Caffe2 instead of failing the whole transformation
+        try {
+          auto results = exporter.Caffe2OpToOnnxNodes(op, shape_hints);
+          for (const auto& n : results.first) {
+            if (!importer->supportsOperator(n.op_type().c_str())) {
+              LOG(INFO) << "TRT does not support ONNX node " << n.op_type();
+              return false;
+            }
           }
+        } catch (const std::exception& e) {
+          LOG(INFO) << "Cannot export c2 op " << op.type()
+                    << " to onnx: " << e.what();
+          return false;
         }
         return true;
       };
@@ -5,6 +5,7 @@
 #include <unordered_map>
 #include <vector>
 
+#include "caffe2/contrib/tensorrt/trt_utils.h"
 #include "caffe2/core/common.h"
 #include "caffe2/core/operator.h"
 #include "caffe2/core/workspace.h"
@@ -26,12 +27,15 @@ class TensorRTTransformer {
       size_t max_workspace_size,
       int verbosity,
       bool debug_builder,
-      bool build_serializable_op = true)
+      bool build_serializable_op = true,
+      const tensorrt::TrtBuildOptions& build_options =
+          tensorrt::TrtBuildOptions())
       : max_batch_size_(max_batch_size),
         max_workspace_size_(max_workspace_size),
         verbosity_(verbosity),
         debug_builder_(debug_builder),
-        build_serializable_op_(build_serializable_op) {}
+        build_serializable_op_(build_serializable_op),
+        build_options_(build_options) {}
 
   OperatorDef BuildTrtOp(
       const std::string& onnx_model_str,
@@ -87,5 +91,7 @@ class TensorRTTransformer {
   size_t max_workspace_size_{1024 * 1024 * 2};
   int verbosity_{2};
   bool debug_builder_{false};
+  // Precision and engine cache options
+  tensorrt::TrtBuildOptions build_options_;
 };
 } // namespace caffe2
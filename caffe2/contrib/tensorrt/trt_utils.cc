@@ -1,15 +1,193 @@
 #include "caffe2/contrib/tensorrt/trt_utils.h"
 
+#include <cstdio>
+#include <fstream>
+#include <unistd.h>
+
 #include <NvOnnxParser.h>
 
+#include "caffe2/core/blob_serialization.h"
+#include "caffe2/core/context_gpu.h"
+#include "caffe2/core/db.h"
+#include "caffe2/utils/proto_utils.h"
+
 namespace caffe2 {
 namespace tensorrt {
+namespace {
+
+// FNV-1a, which unlike std::hash is stable across processes and builds
+uint64_t StableHash(const std::string& str, uint64_t hash = 14695981039346656037ULL) {
+  for (const char c : str) {
+    hash ^= static_cast<unsigned char>(c);
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+bool WriteFileAtomically(const std::string& path, const void* data, size_t size) {
+  // Processes starting together may build the same engine, so each writes
+  // its own file and renames it in place
+  const std::string tmp_path = MakeString(path, ".tmp.", getpid());
+  {
+    std::ofstream out(tmp_path, std::ios::binary);
+    out.write(static_cast<const char*>(data), size);
+    if (!out.good()) {
+      std::remove(tmp_path.c_str());
+      return false;
+    }
+  }
+  return std::rename(tmp_path.c_str(), path.c_str()) == 0;
+}
+
+// Feeds TensorRT with the batches of a db during INT8 calibration, and keeps
+// the resulting calibration table in cache_file so that later builds skip the
+// calibration.
+class TrtInt8Calibrator : public nvinfer1::IInt8EntropyCalibrator {
+ public:
+  TrtInt8Calibrator(
+      const std::string& db_type,
+      const std::string& db_name,
+      const std::string& cache_file)
+      : cache_file_(cache_file) {
+    if (!cache_file_.empty() &&
+        ReadStringFromFile(cache_file_.c_str(), &cache_)) {
+      LOG(INFO) << "Using INT8 calibration table " << cache_file_;
+      return;
+    }
+    CAFFE_ENFORCE(
+        !db_name.empty(),
+        "INT8 mode needs either int8_calibration_db or a cached calibration "
+        "table");
+    db_ = db::CreateDB(db_type, db_name, db::READ);
+    CAFFE_ENFORCE(db_, "Cannot open calibration db ", db_name);
+    cursor_ = db_->NewCursor();
+    CAFFE_ENFORCE(cursor_->Valid(), "Calibration db ", db_name, " is empty");
+    TensorProtos protos;
+    CAFFE_ENFORCE(protos.ParseFromString(cursor_->value()));
+    CAFFE_ENFORCE_GT(protos.protos_size(), 0);
+    CAFFE_ENFORCE_GT(protos.protos(0).dims_size(), 0);
+    batch_size_ = protos.protos(0).dims(0);
+  }
+
+  int getBatchSize() const override {
+    return batch_size_;
+  }
+
+  bool getBatch(void* bindings[], const char* names[], int nbBindings)
+      override {
+    if (!cursor_ || !cursor_->Valid()) {
+      return false;
+    }
+    // TensorRT is not prepared for exceptions thrown across it
+    try {
+      TensorProtos protos;
+      CAFFE_ENFORCE(protos.ParseFromString(cursor_->value()));
+      CAFFE_ENFORCE_EQ(
+          protos.protos_size(),
+          nbBindings,
+          "Calibration batches need one tensor per engine input");
+      buffers_.resize(nbBindings);
+      TensorDeserializer<CPUContext> deserializer;
+      for (int i = 0; i < nbBindings; ++i) {
+        const TensorProto* proto = &protos.protos(i);
+        for (const auto& p : protos.protos()) {
+          if (p.has_name() && p.name() == names[i]) {
+            proto = &p;
+            break;
+          }
+        }
+        TensorCPU cpu_tensor;
+        deserializer.Deserialize(*proto, &cpu_tensor);
+        CAFFE_ENFORCE(
+            cpu_tensor.IsType<float>(), "Calibration inputs must be float");
+        CAFFE_ENFORCE_EQ(cpu_tensor.dim(0), batch_size_);
+        buffers_[i].CopyFrom(cpu_tensor, &context_);
+        bindings[i] = buffers_[i].mutable_data<float>();
+      }
+      context_.FinishDeviceComputation();
+    } catch (const std::exception& e) {
+      LOG(ERROR) << "Cannot read calibration batch: " << e.what();
+      return false;
+    }
+    cursor_->Next();
+    return true;
+  }
+
+  const void* readCalibrationCache(size_t& length) override {
+    length = cache_.size();
+    return cache_.empty() ? nullptr : cache_.data();
+  }
+
+  void writeCalibrationCache(const void* ptr, size_t length) override {
+    cache_.assign(static_cast<const char*>(ptr), length);
+    if (!cache_file_.empty() &&
+        !WriteFileAtomically(cache_file_, ptr, length)) {
+      LOG(WARNING) << "Cannot write INT8 calibration table " << cache_file_;
+    }
+  }
+
+ private:
+  std::string cache_file_;
+  std::string cache_;
+  std::unique_ptr<db::DB> db_;
+  std::unique_ptr<db::Cursor> cursor_;
+  int batch_size_{1};
+  CUDAContext context_;
+  std::vector<TensorCUDA> buffers_;
+};
+
+} // namespace
+
+std::string TrtEngineCacheKey(
+    const std::string& onnx_model_str,
+    size_t max_batch_size,
+    size_t max_workspace_size,
+    const TrtBuildOptions& options) {
+  auto hash = StableHash(onnx_model_str);
+  const char* precision = "fp32";
+  if (options.int8_mode) {
+    precision = "int8";
+    hash = StableHash(options.int8_calibration_db, hash);
+  } else if (options.fp16_mode) {
+    precision = "fp16";
+  }
+  const auto& prop = GetDeviceProperty(CaffeCudaGetDevice());
+  std::string gpu(prop.name);
+  for (auto& c : gpu) {
+    if (!isalnum(c)) {
+      c = '-';
+    }
+  }
+  char hash_str[17];
+  snprintf(hash_str, sizeof(hash_str), "%016llx", (unsigned long long)hash);
+  return MakeString(
+      hash_str,
+      "_b",
+      max_batch_size,
+      "_w",
+      max_workspace_size,
+      "_",
+      precision,
+      "_",
+      gpu,
+      "_sm",
+      prop.major,
+      prop.minor,
+      "_trt",
+      NV_TENSORRT_MAJOR,
+      ".",
+      NV_TENSORRT_MINOR,
+      ".",
+      NV_TENSORRT_PATCH);
+}
+
 std::shared_ptr<nvinfer1::ICudaEngine> BuildTrtEngine(
     const std::string& onnx_model_str,
     TrtLogger* logger,
     size_t max_batch_size,
     size_t max_workspace_size,
-    bool debug_builder) {
+    bool debug_builder,
+    const TrtBuildOptions& options) {
   auto trt_builder = TrtObject(nvinfer1::createInferBuilder(*logger));
   auto trt_network = TrtObject(trt_builder->createNetwork());
   auto trt_parser =
@@ -38,7 +216,86 @@ std::shared_ptr<nvinfer1::ICudaEngine> BuildTrtEngine(
   trt_builder->setMaxBatchSize(max_batch_size);
   trt_builder->setMaxWorkspaceSize(max_workspace_size);
   trt_builder->setDebugSync(debug_builder);
+  if (options.fp16_mode && !options.int8_mode) {
+    if (trt_builder->platformHasFastFp16()) {
+      trt_builder->setHalf2Mode(true);
+    } else {
+      LOG(WARNING) << "FP16 is not fast on this GPU, building an FP32 engine";
+    }
+  }
+  std::unique_ptr<TrtInt8Calibrator> calibrator;
+  if (options.int8_mode) {
+    CAFFE_ENFORCE(
+        trt_builder->platformHasFastInt8(), "INT8 is not fast on this GPU");
+    std::string cache_file;
+    if (!options.engine_cache_dir.empty()) {
+      cache_file = MakeString(
+          options.engine_cache_dir,
+          "/",
+          TrtEngineCacheKey(
+              onnx_model_str, max_batch_size, max_workspace_size, options),
+          ".calib");
+    }
+    calibrator.reset(new TrtInt8Calibrator(
+        options.int8_calibration_db_type,
+        options.int8_calibration_db,
+        cache_file));
+    trt_builder->setInt8Mode(true);
+    trt_builder->setInt8Calibrator(calibrator.get());
+  }
   return TrtObject(trt_builder->buildCudaEngine(*trt_network.get()));
 }
+
+std::shared_ptr<nvinfer1::ICudaEngine> LoadOrBuildTrtEngine(
+    const std::string& onnx_model_str,
+    TrtLogger* logger,
+    size_t max_batch_size,
+    size_t max_workspace_size,
+    bool debug_builder,
+    const TrtBuildOptions& options) {
+  if (options.engine_cache_dir.empty()) {
+    return BuildTrtEngine(
+        onnx_model_str,
+        logger,
+        max_batch_size,
+        max_workspace_size,
+        debug_builder,
+        options);
+  }
+
+  const auto path = MakeString(
+      options.engine_cache_dir,
+      "/",
+      TrtEngineCacheKey(
+          onnx_model_str, max_batch_size, max_workspace_size, options),
+      ".engine");
+  std::string plan;
+  if (ReadStringFromFile(path.c_str(), &plan)) {
+    auto trt_runtime = TrtObject(nvinfer1::createInferRuntime(*logger));
+    auto* engine =
+        trt_runtime->deserializeCudaEngine(plan.data(), plan.size(), nullptr);
+    if (engine) {
+      VLOG(1) << "Loaded TensorRT engine from " << path;
+      return TrtObject(engine);
+    }
+    LOG(WARNING) << "Cannot deserialize cached TensorRT engine " << path
+                 << ", rebuilding it";
+  }
+
+  auto engine = BuildTrtEngine(
+      onnx_model_str,
+      logger,
+      max_batch_size,
+      max_workspace_size,
+      debug_builder,
+      options);
+  auto engine_plan = TrtObject(engine->serialize());
+  if (WriteFileAtomically(path, engine_plan->data(), engine_plan->size())) {
+    LOG(INFO) << "Cached TensorRT engine in " << path;
+  } else {
+    LOG(WARNING) << "Cannot write TensorRT engine cache " << path;
+  }
+  return engine;
+}
 } // namespace tensorrt
 } // namespace caffe2
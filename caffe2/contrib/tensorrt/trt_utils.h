@@ -1,6 +1,7 @@
 #pragma once
 
 #include <iostream>
+#include <string>
 #include <NvInfer.h>
 
 #include "caffe2/core/logging.h"
@@ -44,12 +45,48 @@ inline std::shared_ptr<T> TrtObject(T* obj) {
   return std::shared_ptr<T>(obj, TrtDeleter());
 }
 
+// Precision and caching options of the TensorRT engine builder
+struct TrtBuildOptions {
+  // Let TensorRT pick FP16 kernels where the platform has fast FP16
+  bool fp16_mode{false};
+  // Quantize to INT8, calibrating with the batches of int8_calibration_db.
+  // Every entry of the db is a TensorProtos with one tensor per engine input,
+  // matched by name when set and by position otherwise.
+  bool int8_mode{false};
+  std::string int8_calibration_db;
+  std::string int8_calibration_db_type{"minidb"};
+  // Directory where serialized engines and INT8 calibration tables are cached.
+  // Caching is disabled when empty.
+  std::string engine_cache_dir;
+};
+
+// Key of an engine in the engine cache. It covers everything the engine
+// depends on: the model (weights included), the builder limits, the
+// precision, the GPU and the TensorRT version.
+std::string TrtEngineCacheKey(
+    const std::string& onnx_model_str,
+    size_t max_batch_size,
+    size_t max_workspace_size,
+    const TrtBuildOptions& options);
+
 std::shared_ptr<nvinfer1::ICudaEngine> BuildTrtEngine(
     const std::string& onnx_model_str,
     TrtLogger* logger,
     size_t max_batch_size,
     size_t max_workspace_size,
-    bool debug_builder);
+    bool debug_builder,
+    const TrtBuildOptions& options = TrtBuildOptions());
+
+// Same as BuildTrtEngine, but reuses the engine serialized in
+// options.engine_cache_dir by an earlier build with the same key, and
+// serializes newly built engines there.
+std::shared_ptr<nvinfer1::ICudaEngine> LoadOrBuildTrtEngine(
+    const std::string& onnx_model_str,
+    TrtLogger* logger,
+    size_t max_batch_size,
+    size_t max_workspace_size,
+    bool debug_builder,
+    const TrtBuildOptions& options);
 }
 }
 
@@ -11,6 +11,10 @@
 
 #include "caffe2/core/context_gpu.h"
 
+#ifdef CAFFE2_USE_ATEN
+#include "THC/THCCachingAllocator.h"
+#endif // CAFFE2_USE_ATEN
+
 //
 // Yet another caching allocator for CUDA device allocations.
 //
@@ -28,10 +32,14 @@
 // launches. The programmer must insert the proper synchronization if memory
 // segments are used from multiple streams.
 //
-// Thread Safety: the allocator is NOT thread safe. Calls to { Alloc, Free }
-// must be synchronized by the programmer.
+// Thread Safety: all the operations hold the lock of the allocator.
+//
+// When Caffe2 is built with ATen, this implementation is not used: the
+// allocator of THC, which this one is a copy of, serves Caffe2 as well.
 //
 
+#ifndef CAFFE2_USE_ATEN
+
 namespace {
 
 const size_t kRoundSmall = 512; // round up small allocs to 512 bytes
@@ -92,7 +100,7 @@ struct THCCachingAllocatorImpl {
   typedef std::set<Block*, Comparison> FreeBlocks;
 
   // lock around all operations
-  std::mutex mutex;
+  mutable std::mutex mutex;
 
   // cached blocks larger than 1 MB
   FreeBlocks largeBlocks_;
@@ -103,6 +111,28 @@ struct THCCachingAllocatorImpl {
   // allocated blocks by device pointer
   std::unordered_map<void*, Block*> allocatedBlocks_;
 
+  struct DeviceStats {
+    uint64_t allocated{0};
+    uint64_t max_allocated{0};
+    uint64_t cached{0};
+    uint64_t max_cached{0};
+  };
+
+  // statistics by device
+  std::vector<DeviceStats> stats_;
+
+  DeviceStats& getStats(int device) {
+    if (device >= stats_.size()) {
+      stats_.resize(device + 1);
+    }
+    return stats_[device];
+  }
+
+  DeviceStats stats(int device) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return device < stats_.size() ? stats_[device] : DeviceStats();
+  }
+
   THCCachingAllocatorImpl()
       : largeBlocks_(BlockComparator), smallBlocks_(BlockComparator) {}
 
@@ -112,6 +142,7 @@ struct THCCachingAllocatorImpl {
 
   /** allocates a block which is safe to use from the provided stream */
   cudaError_t Alloc(void** devPtr, size_t size, cudaStream_t stream) {
+    std::lock_guard<std::mutex> lock(mutex);
     int device;
     cudaError_t err = cudaGetDevice(&device);
     if (err != cudaSuccess) {
@@ -140,6 +171,9 @@ struct THCCachingAllocatorImpl {
         return err;
       }
       block = new Block(device, stream, alloc_size, (char*)ptr);
+      auto& stats = getStats(device);
+      stats.cached += alloc_size;
+      stats.max_cached = std::max(stats.max_cached, stats.cached);
     }
 
     if (block->size - size >= (small ? kRoundSmall : kSmallAlloc + 1)) {
@@ -160,6 +194,9 @@ struct THCCachingAllocatorImpl {
 
     block->allocated = true;
     allocatedBlocks_[block->ptr] = block;
+    auto& stats = getStats(device);
+    stats.allocated += block->size;
+    stats.max_allocated = std::max(stats.max_allocated, stats.allocated);
 
     *devPtr = (void*)block->ptr;
     return cudaSuccess;
@@ -169,6 +206,7 @@ struct THCCachingAllocatorImpl {
     if (!ptr) {
       return cudaSuccess;
     }
+    std::lock_guard<std::mutex> lock(mutex);
 
     auto it = allocatedBlocks_.find(ptr);
     if (it == allocatedBlocks_.end()) {
@@ -178,12 +216,18 @@ struct THCCachingAllocatorImpl {
     Block* block = it->second;
     allocatedBlocks_.erase(it);
     block->allocated = false;
+    getStats(block->device).allocated -= block->size;
 
     freeBlock(block);
     return cudaSuccess;
   }
 
   /** returns cached blocks to the system allocator */
+  cudaError_t EmptyCache() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return emptyCache();
+  }
+
   cudaError_t emptyCache() {
     cudaError_t err =
         freeBlocks(largeBlocks_, largeBlocks_.begin(), largeBlocks_.end());
@@ -278,6 +322,7 @@ struct THCCachingAllocatorImpl {
         if (err != cudaSuccess) {
           return err;
         }
+        getStats(block->device).cached -= block->size;
         auto cur = it;
         ++it;
         blocks.erase(cur);
@@ -288,6 +333,43 @@ struct THCCachingAllocatorImpl {
     }
     return cudaSuccess;
   }
+
+  std::vector<THCCachingAllocatorSegmentInfo> snapshot() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    // The first block of each segment has no previous block
+    std::vector<const Block*> heads;
+    for (const auto& kv : allocatedBlocks_) {
+      if (!kv.second->prev) {
+        heads.push_back(kv.second);
+      }
+    }
+    for (const auto* blocks : {&largeBlocks_, &smallBlocks_}) {
+      for (const Block* block : *blocks) {
+        if (!block->prev) {
+          heads.push_back(block);
+        }
+      }
+    }
+    std::vector<THCCachingAllocatorSegmentInfo> segments;
+    for (const Block* head : heads) {
+      THCCachingAllocatorSegmentInfo segment;
+      segment.device = head->device;
+      segment.address = reinterpret_cast<uintptr_t>(head->ptr);
+      segment.stream = head->stream;
+      segment.total_size = 0;
+      segment.allocated_size = 0;
+      for (const Block* block = head; block; block = block->next) {
+        segment.total_size += block->size;
+        if (block->allocated) {
+          segment.allocated_size += block->size;
+        }
+        segment.blocks.push_back({block->size, block->allocated});
+      }
+      segment.is_large = segment.total_size > kSmallAlloc;
+      segments.push_back(std::move(segment));
+    }
+    return segments;
+  }
 };
 
 THCCachingAllocator::THCCachingAllocator()
@@ -306,4 +388,94 @@ cudaError_t THCCachingAllocator::Free(void* ptr) {
   return _impl->Free(ptr);
 }
 
+cudaError_t THCCachingAllocator::EmptyCache() {
+  return _impl->EmptyCache();
+}
+
+uint64_t THCCachingAllocator::CurrentMemoryAllocated(int device) const {
+  return _impl->stats(device).allocated;
+}
+
+uint64_t THCCachingAllocator::MaxMemoryAllocated(int device) const {
+  return _impl->stats(device).max_allocated;
+}
+
+uint64_t THCCachingAllocator::CurrentMemoryCached(int device) const {
+  return _impl->stats(device).cached;
+}
+
+uint64_t THCCachingAllocator::MaxMemoryCached(int device) const {
+  return _impl->stats(device).max_cached;
+}
+
+std::vector<THCCachingAllocatorSegmentInfo> THCCachingAllocator::Snapshot()
+    const {
+  return _impl->snapshot();
+}
+
 } // namespace caffe2
+
+#else // CAFFE2_USE_ATEN
+
+namespace caffe2 {
+
+// The allocator of THC is a process wide singleton, which also serves the
+// CUDA tensors of ATen
+THCCachingAllocator::THCCachingAllocator() : _impl(nullptr) {}
+
+THCCachingAllocator::~THCCachingAllocator() {}
+
+cudaError_t
+THCCachingAllocator::Alloc(void** refPtr, size_t nbytes, cudaStream_t stream) {
+  THCDeviceAllocator* allocator = THCCachingAllocator_get();
+  return allocator->malloc(allocator->state, refPtr, nbytes, stream);
+}
+
+cudaError_t THCCachingAllocator::Free(void* ptr) {
+  THCDeviceAllocator* allocator = THCCachingAllocator_get();
+  return allocator->free(allocator->state, ptr);
+}
+
+cudaError_t THCCachingAllocator::EmptyCache() {
+  THCDeviceAllocator* allocator = THCCachingAllocator_get();
+  return allocator->emptyCache(allocator->state);
+}
+
+uint64_t THCCachingAllocator::CurrentMemoryAllocated(int device) const {
+  return THCCachingAllocator_currentMemoryAllocated(device);
+}
+
+uint64_t THCCachingAllocator::MaxMemoryAllocated(int device) const {
+  return THCCachingAllocator_maxMemoryAllocated(device);
+}
+
+uint64_t THCCachingAllocator::CurrentMemoryCached(int device) const {
+  return THCCachingAllocator_currentMemoryCached(device);
+}
+
+uint64_t THCCachingAllocator::MaxMemoryCached(int device) const {
+  return THCCachingAllocator_maxMemoryCached(device);
+}
+
+std::vector<THCCachingAllocatorSegmentInfo> THCCachingAllocator::Snapshot()
+    const {
+  std::vector<THCCachingAllocatorSegmentInfo> segments;
+  for (const auto& thc_segment : THCCachingAllocator_snapshot()) {
+    THCCachingAllocatorSegmentInfo segment;
+    segment.device = thc_segment.device;
+    segment.address = thc_segment.address;
+    segment.stream = thc_segment.stream;
+    segment.total_size = thc_segment.total_size;
+    segment.allocated_size = thc_segment.allocated_size;
+    segment.is_large = thc_segment.is_large;
+    for (const auto& thc_block : thc_segment.blocks) {
+      segment.blocks.push_back({thc_block.size, thc_block.allocated});
+    }
+    segments.push_back(std::move(segment));
+  }
+  return segments;
+}
+
+} // namespace caffe2
+
+#endif // CAFFE2_USE_ATEN
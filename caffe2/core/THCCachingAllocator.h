@@ -1,12 +1,38 @@
 #ifndef THC_CACHING_ALLOCATOR_H
 #define THC_CACHING_ALLOCATOR_H
 
+#include <cstdint>
+#include <vector>
+
 #include <cuda_runtime.h>
 
+#include "caffe2/core/macros.h"
+
 namespace caffe2 {
 
 struct THCCachingAllocatorImpl;
 
+// A block within a segment, in address order.
+struct THCCachingAllocatorBlockInfo {
+  uint64_t size;
+  bool allocated; // in use
+};
+
+// A segment is one allocation obtained from cudaMalloc.
+struct THCCachingAllocatorSegmentInfo {
+  int device;
+  uintptr_t address;
+  cudaStream_t stream;
+  uint64_t total_size;
+  uint64_t allocated_size;
+  bool is_large; // belongs to the pool for allocations > 1 MB
+  std::vector<THCCachingAllocatorBlockInfo> blocks;
+};
+
+// When Caffe2 is built with ATen (CAFFE2_USE_ATEN), every instance forwards to
+// the caching allocator of THC, which also holds the CUDA tensors of ATen, so
+// that memory cached by one framework can be reused by the other in the same
+// process. Otherwise each instance holds its own cache.
 class THCCachingAllocator {
  public:
   THCCachingAllocator();
@@ -15,6 +41,18 @@ class THCCachingAllocator {
   cudaError_t Alloc(void** refPtr, size_t nbytes, cudaStream_t stream);
   cudaError_t Free(void* ptr);
 
+  // Returns the cached blocks that are not in use to cudaFree
+  cudaError_t EmptyCache();
+
+  // Bytes handed out by Alloc, and bytes obtained from cudaMalloc, on device
+  uint64_t CurrentMemoryAllocated(int device) const;
+  uint64_t MaxMemoryAllocated(int device) const;
+  uint64_t CurrentMemoryCached(int device) const;
+  uint64_t MaxMemoryCached(int device) const;
+
+  // Every segment held by the allocator, on all devices
+  std::vector<THCCachingAllocatorSegmentInfo> Snapshot() const;
+
  private:
   THCCachingAllocatorImpl* _impl;
 };
@@ -54,8 +54,8 @@ struct DefaultCPUAllocator final : CPUAllocator {
     CAFFE_ENFORCE_EQ(posix_memalign(&data, gCaffe2Alignment, nbytes), 0);
 #endif
     CAFFE_ENFORCE(data);
-    // move data to a thread's NUMA node
-    NUMAMove(data, nbytes, GetCurrentNUMANode());
+    // move data to the NUMA node of the thread, or of the running operator
+    NUMAMove(data, nbytes, GetAllocationNUMANode());
     if (FLAGS_caffe2_cpu_allocator_do_zero_fill) {
       memset(data, 0, nbytes);
     }
@@ -0,0 +1,214 @@
+#include "caffe2/core/batching_predictor.h"
+
+#include "caffe2/core/timer.h"
+
+namespace caffe2 {
+
+namespace {
+
+// Requests can share a batch if their inputs only differ in the first
+// dimension.
+bool sameExampleShape(const TensorCPU& a, const TensorCPU& b) {
+  if (a.meta() != b.meta() || a.ndim() != b.ndim()) {
+    return false;
+  }
+  for (int d = 1; d < a.ndim(); ++d) {
+    if (a.dim(d) != b.dim(d)) {
+      return false;
+    }
+  }
+  return true;
+}
+} // namespace
+
+BatchingPredictor::BatchingPredictor(
+    std::unique_ptr<Predictor> predictor,
+    size_t max_batch_size,
+    std::chrono::microseconds max_wait,
+    const std::string& name)
+    : predictor_(std::move(predictor)),
+      maxBatchSize_(max_batch_size),
+      maxWait_(max_wait),
+      stats_(name) {
+  CAFFE_ENFORCE(predictor_, "BatchingPredictor: predictor must not be null");
+  CAFFE_ENFORCE_GT(max_batch_size, 0);
+  worker_ = std::thread([this] { work(); });
+}
+
+BatchingPredictor::~BatchingPredictor() {
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    stopping_ = true;
+  }
+  requestCv_.notify_all();
+  worker_.join();
+}
+
+bool BatchingPredictor::run(
+    const TensorVector& inputs,
+    const TensorVector& outputs) {
+  const auto& def = predictor_->def();
+  CAFFE_ENFORCE(!inputs.empty());
+  CAFFE_ENFORCE(inputs.size() <= def.external_input_size());
+  CAFFE_ENFORCE_EQ(outputs.size(), def.external_output_size());
+  for (const auto* input : inputs) {
+    CAFFE_ENFORCE(
+        input->ndim() > 0 && input->dim(0) == inputs[0]->dim(0),
+        "BatchingPredictor: all inputs must have the same first dimension");
+  }
+
+  Request request;
+  request.inputs = &inputs;
+  request.outputs = &outputs;
+  request.rows = inputs[0]->dim(0);
+  request.enqueued = std::chrono::steady_clock::now();
+  CAFFE_EVENT(stats_, num_requests);
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  CAFFE_ENFORCE(!stopping_, "BatchingPredictor is shutting down");
+  queue_.push_back(&request);
+  queuedRows_ += request.rows;
+  requestCv_.notify_one();
+  doneCv_.wait(lock, [&] { return request.done; });
+  lock.unlock();
+
+  if (request.error) {
+    std::rethrow_exception(request.error);
+  }
+  return request.success;
+}
+
+void BatchingPredictor::work() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    requestCv_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+    if (queue_.empty()) {
+      return;
+    }
+    // wait for a full batch, or until the oldest request is due
+    const auto deadline = queue_.front()->enqueued + maxWait_;
+    while (!stopping_ && queuedRows_ < maxBatchSize_ &&
+           std::chrono::steady_clock::now() < deadline) {
+      requestCv_.wait_until(lock, deadline);
+    }
+    auto batch = takeBatch();
+    lock.unlock();
+
+    bool success = false;
+    std::exception_ptr error;
+    try {
+      success = runBatch(batch);
+    } catch (...) {
+      error = std::current_exception();
+    }
+
+    lock.lock();
+    for (auto* request : batch) {
+      request->success = success;
+      request->error = error;
+      request->done = true;
+    }
+    doneCv_.notify_all();
+  }
+}
+
+std::vector<BatchingPredictor::Request*> BatchingPredictor::takeBatch() {
+  std::vector<Request*> batch{queue_.front()};
+  queue_.pop_front();
+  size_t rows = batch.front()->rows;
+  const auto& first = *batch.front()->inputs;
+  while (!queue_.empty() && rows + queue_.front()->rows <= maxBatchSize_) {
+    const auto& inputs = *queue_.front()->inputs;
+    if (inputs.size() != first.size()) {
+      break;
+    }
+    bool compatible = true;
+    for (size_t i = 0; i < inputs.size() && compatible; ++i) {
+      compatible = sameExampleShape(*inputs[i], *first[i]);
+    }
+    if (!compatible) {
+      break;
+    }
+    rows += queue_.front()->rows;
+    batch.push_back(queue_.front());
+    queue_.pop_front();
+  }
+  for (auto* request : batch) {
+    queuedRows_ -= request->rows;
+  }
+  return batch;
+}
+
+bool BatchingPredictor::runBatch(const std::vector<Request*>& batch) {
+  const auto now = std::chrono::steady_clock::now();
+  TIndex rows = 0;
+  for (auto* request : batch) {
+    CAFFE_EVENT(
+        stats_,
+        queue_delay_ns,
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            now - request->enqueued)
+            .count());
+    rows += request->rows;
+  }
+  CAFFE_EVENT(stats_, num_batches);
+  CAFFE_EVENT(stats_, batch_size, rows);
+
+  // a single request runs on its own inputs
+  const auto& first = *batch.front()->inputs;
+  TensorVector inputs(first.begin(), first.end());
+  if (batch.size() > 1) {
+    while (batchInputs_.size() < first.size()) {
+      batchInputs_.emplace_back(caffe2::make_unique<TensorCPU>());
+    }
+    for (size_t i = 0; i < first.size(); ++i) {
+      auto dims = first[i]->dims();
+      dims[0] = rows;
+      auto* input = batchInputs_[i].get();
+      input->Resize(dims);
+      auto* dst = static_cast<char*>(input->raw_mutable_data(first[i]->meta()));
+      for (auto* request : batch) {
+        const auto* src = (*request->inputs)[i];
+        context_.CopyItems<CPUContext, CPUContext>(
+            src->meta(), src->size(), src->raw_data(), dst);
+        dst += src->nbytes();
+      }
+      inputs[i] = input;
+    }
+  }
+
+  TensorVector outputs;
+  Timer timer;
+  bool success = predictor_->run(inputs, &outputs);
+  CAFFE_EVENT(stats_, run_time_ns, timer.NanoSeconds());
+  if (!success) {
+    return false;
+  }
+
+  const auto& def = predictor_->def();
+  for (size_t i = 0; i < outputs.size(); ++i) {
+    const auto* output = outputs[i];
+    CAFFE_ENFORCE(
+        output->ndim() > 0 && output->dim(0) == rows,
+        "BatchingPredictor: the first dimension of output ",
+        def.external_output(i),
+        " is not the batch");
+    const auto* src = static_cast<const char*>(output->raw_data());
+    const TIndex example_size = output->size_from_dim(1);
+    for (auto* request : batch) {
+      auto dims = output->dims();
+      dims[0] = request->rows;
+      auto* dst = (*request->outputs)[i];
+      dst->Resize(dims);
+      context_.CopyItems<CPUContext, CPUContext>(
+          output->meta(),
+          request->rows * example_size,
+          src,
+          dst->raw_mutable_data(output->meta()));
+      src += request->rows * example_size * output->itemsize();
+    }
+  }
+  return true;
+}
+
+} // namespace caffe2
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "caffe2/core/predictor.h"
+#include "caffe2/core/stats.h"
+
+namespace caffe2 {
+
+// Runs concurrent requests to a Predictor as batches.
+//
+// Requests are queued, and a worker thread concatenates the inputs of the
+// queued requests along the first (batch) dimension, runs `run_net` once and
+// slices the outputs back into the requests' output tensors. A batch is run
+// as soon as it holds `max_batch_size` examples, or once its oldest request
+// has waited `max_wait`, whichever comes first. Requests whose inputs differ
+// in type or in any dimension but the first go into different batches.
+//
+// Every output of `run_net` must have the batch as its first dimension.
+//
+// The following counters are exported under `name`:
+//   num_requests, num_batches
+//   batch_size      examples per batch (sum/count)
+//   queue_delay_ns  time from enqueueing a request to running its batch
+//   run_time_ns     time spent in Predictor::run per batch
+class BatchingPredictor {
+ public:
+  using TensorVector = Predictor::TensorVector;
+
+  BatchingPredictor(
+      std::unique_ptr<Predictor> predictor,
+      size_t max_batch_size,
+      std::chrono::microseconds max_wait,
+      const std::string& name = "batching_predictor");
+
+  // Runs the queued requests before returning.
+  ~BatchingPredictor();
+
+  // Executes `run_net` on the inputs as part of a batch and copies the
+  // slices of the results belonging to this request into `outputs`.
+  // Blocks until the batch has run. Thread safe.
+
+  // Precondition:
+  //   0 < inputs.size() <= run_net.external_inputs.size()
+  //   every input has the same first dimension
+  //   outputs.size() == run_net.external_outputs.size()
+
+  // Returns true on success
+  bool run(const TensorVector& inputs, const TensorVector& outputs);
+
+  const NetDef& def() const {
+    return predictor_->def();
+  }
+
+ private:
+  struct Request {
+    const TensorVector* inputs;
+    const TensorVector* outputs;
+    TIndex rows;
+    std::chrono::steady_clock::time_point enqueued;
+    bool done = false;
+    bool success = false;
+    std::exception_ptr error;
+  };
+
+  struct BatchingStats {
+    CAFFE_STAT_CTOR(BatchingStats);
+    CAFFE_EXPORTED_STAT(num_requests);
+    CAFFE_EXPORTED_STAT(num_batches);
+    CAFFE_AVG_EXPORTED_STAT(batch_size);
+    CAFFE_AVG_EXPORTED_STAT(queue_delay_ns);
+    CAFFE_AVG_EXPORTED_STAT(run_time_ns);
+  };
+
+  void work();
+  // Pops the requests of the next batch off the queue. Requires mutex_.
+  std::vector<Request*> takeBatch();
+  bool runBatch(const std::vector<Request*>& batch);
+
+  std::unique_ptr<Predictor> predictor_;
+  const size_t maxBatchSize_;
+  const std::chrono::microseconds maxWait_;
+  BatchingStats stats_;
+
+  std::mutex mutex_; // protects the queue and the requests' done flags
+  std::condition_variable requestCv_;
+  std::condition_variable doneCv_;
+  std::deque<Request*> queue_;
+  size_t queuedRows_ = 0;
+  bool stopping_ = false;
+
+  // only used by the worker thread
+  std::vector<std::unique_ptr<TensorCPU>> batchInputs_;
+  CPUContext context_;
+  std::thread worker_;
+};
+} // namespace caffe2
@@ -0,0 +1,152 @@
+#include "caffe2/core/batching_predictor.h"
+#include "caffe2/core/context.h"
+#include "caffe2/core/operator.h"
+#include "caffe2/core/tensor.h"
+#include "caffe2/utils/math.h"
+
+#include <gtest/gtest.h>
+
+#include <thread>
+
+namespace caffe2 {
+
+namespace {
+
+const char* predictSpec = R"DOC(
+        name: "predict"
+        type: "dag"
+        external_input: "data"
+        external_input: "W"
+        external_input: "b"
+        external_output: "y"
+        op {
+          input: "data"
+          input: "W"
+          input: "b"
+          output: "y"
+          type: "FC"
+        }
+)DOC";
+
+const char* initSpec = R"DOC(
+        name: "init"
+        type: "dag"
+        op {
+          type: "GivenTensorFill"
+          output: "W"
+          arg {
+            name: "shape"
+            ints: 2
+            ints: 3
+          }
+          arg {
+            name: "values"
+            floats: 1
+            floats: 2
+            floats: 3
+            floats: 4
+            floats: 5
+            floats: 6
+          }
+        }
+        op {
+          type: "ConstantFill"
+          output: "b"
+          arg {
+            name: "shape"
+            ints: 2
+          }
+          arg {
+            name: "value"
+            f: 1.0
+          }
+        }
+)DOC";
+
+NetDef parseNetDef(const std::string& value) {
+  NetDef def;
+  CAFFE_ENFORCE(
+      TextFormat::ParseFromString(value, &def),
+      "Failed to parse NetDef with value: ",
+      value);
+  return def;
+}
+
+std::unique_ptr<BatchingPredictor> makePredictor(
+    size_t maxBatchSize,
+    std::chrono::microseconds maxWait,
+    const std::string& name) {
+  return caffe2::make_unique<BatchingPredictor>(
+      caffe2::make_unique<Predictor>(
+          parseNetDef(initSpec), parseNetDef(predictSpec)),
+      maxBatchSize,
+      maxWait,
+      name);
+}
+
+// y = x W^T + 1 for W = [[1, 2, 3], [4, 5, 6]]
+void expectOutput(const TensorCPU& x, const TensorCPU& y) {
+  ASSERT_EQ(y.ndim(), 2);
+  ASSERT_EQ(y.dim(0), x.dim(0));
+  ASSERT_EQ(y.dim(1), 2);
+  for (int i = 0; i < x.dim(0); ++i) {
+    const float* row = x.data<float>() + i * 3;
+    EXPECT_FLOAT_EQ(
+        y.data<float>()[i * 2], row[0] + 2 * row[1] + 3 * row[2] + 1);
+    EXPECT_FLOAT_EQ(
+        y.data<float>()[i * 2 + 1], 4 * row[0] + 5 * row[1] + 6 * row[2] + 1);
+  }
+}
+} // namespace
+
+TEST(BatchingPredictorTest, ConcurrentRequests) {
+  const int kThreads = 8;
+  auto p = makePredictor(kThreads, std::chrono::seconds(1), "batching_test");
+  std::vector<TensorCPU> inputs(kThreads), outputs(kThreads);
+  std::vector<int> success(kThreads, 0);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreads; ++t) {
+    inputs[t].Resize(1, 3);
+    for (int j = 0; j < 3; ++j) {
+      inputs[t].mutable_data<float>()[j] = t + j;
+    }
+    threads.emplace_back([&, t] {
+      success[t] = p->run({&inputs[t]}, {&outputs[t]});
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  for (int t = 0; t < kThreads; ++t) {
+    EXPECT_TRUE(success[t]);
+    expectOutput(inputs[t], outputs[t]);
+  }
+
+  auto stats = toMap(StatRegistry::get().publish());
+  EXPECT_EQ(stats["batching_test/num_requests"], kThreads);
+  EXPECT_EQ(stats["batching_test/batch_size/sum"], kThreads);
+  EXPECT_GE(stats["batching_test/num_batches"], 1);
+  EXPECT_LE(stats["batching_test/num_batches"], kThreads);
+}
+
+TEST(BatchingPredictorTest, MultiExampleRequest) {
+  // with no waiting, a request is run right away
+  auto p = makePredictor(4, std::chrono::microseconds(0), "batching_test_2");
+  TensorCPU input, output;
+  input.Resize(3, 3);
+  for (int j = 0; j < 9; ++j) {
+    input.mutable_data<float>()[j] = j;
+  }
+  EXPECT_TRUE(p->run({&input}, {&output}));
+  expectOutput(input, output);
+
+  // requests larger than the maximum batch size run on their own
+  input.Resize(5, 3);
+  for (int j = 0; j < 15; ++j) {
+    input.mutable_data<float>()[j] = -j;
+  }
+  EXPECT_TRUE(p->run({&input}, {&output}));
+  expectOutput(input, output);
+  EXPECT_THROW(p->run({&input}, {}), EnforceNotMet);
+}
+} // namespace caffe2
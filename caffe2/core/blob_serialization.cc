@@ -21,7 +21,78 @@ CAFFE2_DEFINE_bool(
     false,
     "Serialize FLOAT16 tensors using byte_data field");
 
+CAFFE2_DEFINE_string(
+    caffe2_tensor_compression,
+    "",
+    "If not empty, the TensorCompressor to compress serialized tensors with, "
+    "e.g. zstd");
+
 namespace caffe2 {
+
+CAFFE_DEFINE_REGISTRY(TensorCompressorRegistry, TensorCompressor);
+
+namespace {
+
+// Swaps the data fields of two TensorProtos
+void SwapTensorProtoData(TensorProto* a, TensorProto* b) {
+  a->mutable_float_data()->Swap(b->mutable_float_data());
+  a->mutable_int32_data()->Swap(b->mutable_int32_data());
+  a->mutable_string_data()->Swap(b->mutable_string_data());
+  a->mutable_double_data()->Swap(b->mutable_double_data());
+  a->mutable_int64_data()->Swap(b->mutable_int64_data());
+  bool a_has_bytes = a->has_byte_data();
+  bool b_has_bytes = b->has_byte_data();
+  a->mutable_byte_data()->swap(*b->mutable_byte_data());
+  if (!b_has_bytes) {
+    a->clear_byte_data();
+  }
+  if (!a_has_bytes) {
+    b->clear_byte_data();
+  }
+}
+
+unique_ptr<TensorCompressor> CreateCompressor(const string& compression) {
+  auto compressor = TensorCompressorRegistry()->Create(compression);
+  CAFFE_ENFORCE(
+      compressor,
+      "Unknown tensor compression ",
+      compression,
+      ". Is caffe2 built with it?");
+  return compressor;
+}
+
+} // namespace
+
+void CompressTensorProto(const string& compression, TensorProto* proto) {
+  CAFFE_ENFORCE(!proto->has_compression(), "Tensor is already compressed");
+  TensorProto data;
+  SwapTensorProtoData(&data, proto);
+  proto->set_compression(compression);
+  proto->set_compressed_data(
+      CreateCompressor(compression)->Compress(data.SerializeAsString()));
+}
+
+TensorProto DecompressTensorProto(const TensorProto& proto) {
+  CAFFE_ENFORCE(proto.has_compression(), "Tensor is not compressed");
+  TensorProto result;
+  CAFFE_ENFORCE(
+      result.ParseFromString(CreateCompressor(proto.compression())
+                                 ->Decompress(proto.compressed_data())),
+      "Cannot parse the decompressed data of tensor ",
+      proto.name());
+  *result.mutable_dims() = proto.dims();
+  result.set_data_type(proto.data_type());
+  if (proto.has_name()) {
+    result.set_name(proto.name());
+  }
+  if (proto.has_device_detail()) {
+    *result.mutable_device_detail() = proto.device_detail();
+  }
+  if (proto.has_segment()) {
+    *result.mutable_segment() = proto.segment();
+  }
+  return result;
+}
 /**
  * @brief StringSerializer is the serializer for String.
  *
@@ -16,6 +16,7 @@
 CAFFE2_DECLARE_int(caffe2_tensor_chunk_size);
 CAFFE2_DECLARE_int(caffe2_max_tensor_serializer_threads);
 CAFFE2_DECLARE_bool(caffe2_serialize_fp16_as_bytes);
+CAFFE2_DECLARE_string(caffe2_tensor_compression);
 
 namespace caffe2 {
 
@@ -36,6 +37,39 @@ inline unique_ptr<BlobSerializerBase> CreateSerializer(CaffeTypeId id) {
   return BlobSerializerRegistry()->Create(id);
 }
 
+/**
+ * @brief TensorCompressor compresses the data of serialized tensors.
+ *
+ * Compressors are registered by name, e.g. zstd by the zstd contrib when
+ * caffe2 is built with it. With --caffe2_tensor_compression=<name>,
+ * TensorSerializer compresses the data of every chunk, and TensorDeserializer
+ * decompresses the chunks compressed by any registered compressor. Chunks are
+ * compressed and decompressed independently, so on as many threads as they
+ * are serialized and deserialized on.
+ */
+class TensorCompressor {
+ public:
+  virtual ~TensorCompressor() {}
+  virtual string Compress(const string& data) = 0;
+  virtual string Decompress(const string& data) = 0;
+};
+
+CAFFE_DECLARE_REGISTRY(TensorCompressorRegistry, TensorCompressor);
+#define REGISTER_TENSOR_COMPRESSOR(name, ...) \
+  CAFFE_REGISTER_CLASS(TensorCompressorRegistry, name, __VA_ARGS__)
+
+/**
+ * Moves the data fields of the proto, compressed with the given compressor,
+ * to its compressed_data field.
+ */
+void CompressTensorProto(const string& compression, TensorProto* proto);
+
+/**
+ * Returns the proto, compressed by CompressTensorProto, with its data
+ * decompressed.
+ */
+TensorProto DecompressTensorProto(const TensorProto& proto);
+
 /**
  * @brief TensorSerializer is the serializer for Tensors.
  *
@@ -413,6 +447,9 @@ void TensorSerializer<Context>::Serialize(
     // Note: we intentially do not provide "default:" so if any new data types
     // are added, the compiler should warn the user to add the case here.
   }
+  if (!FLAGS_caffe2_tensor_compression.empty()) {
+    CompressTensorProto(FLAGS_caffe2_tensor_compression, &proto);
+  }
 }
 
 template <class Context>
@@ -426,6 +463,10 @@ template <class Context>
 void TensorDeserializer<Context>::Deserialize(
     const TensorProto& proto,
     Tensor<Context>* tensor) {
+  if (proto.has_compression()) {
+    Deserialize(DecompressTensorProto(proto), tensor);
+    return;
+  }
   // We create a local context for deserializing. Since Caffe2 contexts are
   // usually lightweighted, this should not involve too much overhead.
   Context context(proto.device_detail());
@@ -434,7 +475,12 @@ void TensorDeserializer<Context>::Deserialize(
   for (const TIndex d : proto.dims()) {
     dims.push_back(d);
   }
-  tensor->Resize(dims);
+  // The chunks of a tensor that has been allocated already are deserialized
+  // without touching anything but their own part of its data, so that they
+  // can be deserialized concurrently
+  if (tensor->size() < 0 || tensor->dims() != dims) {
+    tensor->Resize(dims);
+  }
 
   int64_t chunkBegin = 0;
   auto chunkEnd = tensor->size();
@@ -478,6 +478,32 @@ TYPED_TEST(TensorCPUTest, MaxKeepOnShrink) {
   FLAGS_caffe2_max_keep_on_shrink_memory = LLONG_MAX;
 }
 
+TYPED_TEST(TensorCPUTest, GrowthPolicy) {
+  vector<int> dims{4, 10};
+  TensorCPU tensor(dims);
+  tensor.SetGrowthPolicy(50, 3);
+  TypeParam* ptr = tensor.mutable_data<TypeParam>();
+  EXPECT_EQ(tensor.capacity_nbytes(), 60 * sizeof(TypeParam));
+  EXPECT_EQ(tensor.num_allocations(), 1);
+  // Expanding within the headroom - will not reallocate
+  tensor.Resize(5, 10);
+  EXPECT_EQ(ptr, tensor.mutable_data<TypeParam>());
+  // Expanding beyond the headroom - will reallocate for the new maximum
+  tensor.Resize(8, 10);
+  ptr = tensor.mutable_data<TypeParam>();
+  EXPECT_EQ(tensor.capacity_nbytes(), 120 * sizeof(TypeParam));
+  EXPECT_EQ(tensor.num_allocations(), 2);
+  // Shrinking - will not reallocate until the maximum decays
+  tensor.Resize(2, 10);
+  tensor.Resize(3, 10);
+  EXPECT_EQ(ptr, tensor.mutable_data<TypeParam>());
+  EXPECT_EQ(tensor.num_allocations(), 2);
+  tensor.Resize(2, 10);
+  EXPECT_TRUE(tensor.mutable_data<TypeParam>() != nullptr);
+  EXPECT_EQ(tensor.capacity_nbytes(), 30 * sizeof(TypeParam));
+  EXPECT_EQ(tensor.num_allocations(), 3);
+}
+
 TYPED_TEST(TensorCPUDeathTest, CannotAccessRawDataWhenEmpty) {
   TensorCPU tensor;
   EXPECT_EQ(tensor.ndim(), 0);
@@ -692,6 +718,49 @@ TEST(TensorTest, float16) {
   }
 }
 
+// Reverses the data, so that the compressed data differs from it
+class ReverseTensorCompressor : public TensorCompressor {
+ public:
+  string Compress(const string& data) override {
+    return string(data.rbegin(), data.rend());
+  }
+  string Decompress(const string& data) override {
+    return string(data.rbegin(), data.rend());
+  }
+};
+
+REGISTER_TENSOR_COMPRESSOR(blob_test_reverse, ReverseTensorCompressor);
+
+TEST(TensorTest, CompressedSerialization) {
+  Blob blob;
+  TensorCPU* tensor = blob.GetMutable<TensorCPU>();
+  tensor->Resize(2, 3);
+  for (int i = 0; i < 6; ++i) {
+    tensor->mutable_data<float>()[i] = i;
+  }
+  FLAGS_caffe2_tensor_compression = "blob_test_reverse";
+  string serialized = blob.Serialize("test");
+  FLAGS_caffe2_tensor_compression = "";
+  BlobProto proto;
+  CHECK(proto.ParseFromString(serialized));
+  const TensorProto& tensor_proto = proto.tensor();
+  EXPECT_EQ(tensor_proto.compression(), "blob_test_reverse");
+  EXPECT_EQ(tensor_proto.float_data_size(), 0);
+  EXPECT_EQ(tensor_proto.dims_size(), 2);
+  EXPECT_EQ(DecompressTensorProto(tensor_proto).float_data_size(), 6);
+  Blob new_blob;
+  EXPECT_NO_THROW(new_blob.Deserialize(serialized));
+  const TensorCPU& new_tensor = new_blob.Get<TensorCPU>();
+  EXPECT_EQ(new_tensor.dims(), tensor->dims());
+  for (int i = 0; i < 6; ++i) {
+    EXPECT_EQ(new_tensor.data<float>()[i], i);
+  }
+
+  proto.mutable_tensor()->set_compression("blob_test_unknown");
+  EXPECT_THROW(
+      new_blob.Deserialize(proto.SerializeAsString()), EnforceNotMet);
+}
+
 TEST(QTensorTest, QTensorSerialization) {
   Blob blob;
   QTensor<CPUContext>* qtensor = blob.GetMutable<QTensor<CPUContext>>();
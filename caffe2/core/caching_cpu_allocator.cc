@@ -0,0 +1,279 @@
+#include "caffe2/core/caching_cpu_allocator.h"
+
+#include <atomic>
+#include <cstring>
+#include <mutex>
+#include <vector>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+#include "caffe2/core/init.h"
+
+CAFFE2_DEFINE_string(
+    caffe2_cpu_memory_pool,
+    "",
+    "Sets the CPU memory pool used by caffe2. Possible values are "
+    "none and caching.");
+CAFFE2_DEFINE_int64(
+    caffe2_cpu_memory_pool_max_cached_bytes,
+    -1,
+    "Maximum number of bytes in free blocks kept by the caching CPU memory "
+    "pool; -1 for no limit.");
+
+namespace caffe2 {
+
+namespace {
+
+constexpr size_t kMinBlockSize = 64;
+constexpr size_t kHugePageSize = 2 << 20;
+// Free blocks kept per size class by each thread before using the pool
+constexpr size_t kMaxThreadBlocks = 4;
+// Holds the size class of the block; keeps the data aligned
+constexpr size_t kHeaderSize = gCaffe2Alignment;
+
+// Four size classes per power of two: 64, 80, 96, 112, 128, 160, ...
+size_t sizeClass(size_t nbytes) {
+  if (nbytes <= kMinBlockSize) {
+    return 0;
+  }
+  size_t log2 = 0;
+  while ((size_t(1) << (log2 + 1)) < nbytes) {
+    ++log2;
+  }
+  const size_t base = size_t(1) << log2;
+  const size_t step = base >> 2;
+  return (log2 - 6) * 4 + (nbytes - base + step - 1) / step;
+}
+
+size_t classSize(size_t size_class) {
+  if (size_class == 0) {
+    return kMinBlockSize;
+  }
+  const size_t log2 = (size_class - 1) / 4 + 6;
+  const size_t base = size_t(1) << log2;
+  return base + ((size_class - 1) % 4 + 1) * (base >> 2);
+}
+
+void* allocateBlock(size_t size_class) {
+  const size_t size = classSize(size_class);
+  const size_t alignment =
+      size >= kHugePageSize ? kHugePageSize : gCaffe2Alignment;
+  void* raw = nullptr;
+#ifdef __ANDROID__
+  raw = memalign(alignment, kHeaderSize + size);
+#elif defined(_MSC_VER)
+  raw = _aligned_malloc(kHeaderSize + size, alignment);
+#else
+  CAFFE_ENFORCE_EQ(posix_memalign(&raw, alignment, kHeaderSize + size), 0);
+#endif
+  CAFFE_ENFORCE(raw);
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+  if (size >= kHugePageSize) {
+    madvise(raw, kHeaderSize + size, MADV_HUGEPAGE);
+  }
+#endif
+  *static_cast<size_t*>(raw) = size_class;
+  void* data = static_cast<char*>(raw) + kHeaderSize;
+  // move data to the NUMA node of the thread, or of the running operator
+  NUMAMove(data, size, GetAllocationNUMANode());
+  return data;
+}
+
+void* rawBlock(void* data) {
+  return static_cast<char*>(data) - kHeaderSize;
+}
+
+size_t blockSizeClass(void* data) {
+  return *static_cast<size_t*>(rawBlock(data));
+}
+
+void freeBlock(void* data) {
+#ifdef _MSC_VER
+  _aligned_free(rawBlock(data));
+#else
+  free(rawBlock(data));
+#endif
+}
+
+// Free blocks shared by all threads. Never destroyed, since threads give
+// their free blocks back on exit.
+class BlockPool {
+ public:
+  static BlockPool& get() {
+    static auto* pool = new BlockPool();
+    return *pool;
+  }
+
+  void* take(size_t size_class) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    if (size_class >= blocks_.size() || blocks_[size_class].empty()) {
+      return nullptr;
+    }
+    void* data = blocks_[size_class].back();
+    blocks_[size_class].pop_back();
+    return data;
+  }
+
+  void put(size_t size_class, void* data) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    if (size_class >= blocks_.size()) {
+      blocks_.resize(size_class + 1);
+    }
+    blocks_[size_class].push_back(data);
+  }
+
+  void takeAll(std::vector<void*>* blocks) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    for (auto& size_class_blocks : blocks_) {
+      blocks->insert(
+          blocks->end(), size_class_blocks.begin(), size_class_blocks.end());
+      size_class_blocks.clear();
+    }
+  }
+
+  // Reserves room for a block of the given size in the cache, false if over
+  // the limit
+  bool reserve(size_t size) {
+    const auto limit = FLAGS_caffe2_cpu_memory_pool_max_cached_bytes;
+    const auto cached = cached_bytes_.fetch_add(size) + size;
+    if (limit >= 0 && cached > static_cast<size_t>(limit)) {
+      cached_bytes_ -= size;
+      return false;
+    }
+    return true;
+  }
+
+  void unreserve(size_t size) {
+    cached_bytes_ -= size;
+  }
+
+  size_t cachedBytes() const {
+    return cached_bytes_;
+  }
+
+ private:
+  std::mutex mutex_;
+  std::vector<std::vector<void*>> blocks_;
+  std::atomic<size_t> cached_bytes_{0};
+};
+
+// Trivially destructible, so that it can be checked during thread exit
+thread_local bool thread_cache_destroyed = false;
+
+struct ThreadCache {
+  std::vector<std::vector<void*>> blocks;
+
+  ~ThreadCache() {
+    for (size_t size_class = 0; size_class < blocks.size(); ++size_class) {
+      for (auto* data : blocks[size_class]) {
+        BlockPool::get().put(size_class, data);
+      }
+    }
+    thread_cache_destroyed = true;
+  }
+
+  static ThreadCache* get() {
+    if (thread_cache_destroyed) {
+      return nullptr;
+    }
+    static thread_local ThreadCache cache;
+    return &cache;
+  }
+};
+
+void* takeBlock(size_t size_class) {
+  auto* cache = ThreadCache::get();
+  if (cache && size_class < cache->blocks.size() &&
+      !cache->blocks[size_class].empty()) {
+    void* data = cache->blocks[size_class].back();
+    cache->blocks[size_class].pop_back();
+    return data;
+  }
+  return BlockPool::get().take(size_class);
+}
+
+void Delete(void* data) {
+  if (!data) {
+    return;
+  }
+  const size_t size_class = blockSizeClass(data);
+  auto& pool = BlockPool::get();
+  if (!pool.reserve(classSize(size_class))) {
+    freeBlock(data);
+    return;
+  }
+  auto* cache = ThreadCache::get();
+  if (cache) {
+    if (size_class >= cache->blocks.size()) {
+      cache->blocks.resize(size_class + 1);
+    }
+    if (cache->blocks[size_class].size() < kMaxThreadBlocks) {
+      cache->blocks[size_class].push_back(data);
+      return;
+    }
+  }
+  pool.put(size_class, data);
+}
+} // namespace
+
+std::pair<void*, MemoryDeleter> CachingCPUAllocator::New(size_t nbytes) {
+  const size_t size_class = sizeClass(nbytes);
+  void* data = takeBlock(size_class);
+  if (data) {
+    BlockPool::get().unreserve(classSize(size_class));
+  } else {
+    data = allocateBlock(size_class);
+  }
+  if (FLAGS_caffe2_cpu_allocator_do_zero_fill) {
+    memset(data, 0, nbytes);
+  }
+  return {data, Delete};
+}
+
+MemoryDeleter CachingCPUAllocator::GetDeleter() {
+  return Delete;
+}
+
+void CachingCPUAllocator::EmptyCache() {
+  std::vector<void*> blocks;
+  auto* cache = ThreadCache::get();
+  if (cache) {
+    for (auto& size_class_blocks : cache->blocks) {
+      blocks.insert(
+          blocks.end(), size_class_blocks.begin(), size_class_blocks.end());
+      size_class_blocks.clear();
+    }
+  }
+  auto& pool = BlockPool::get();
+  pool.takeAll(&blocks);
+  for (auto* data : blocks) {
+    pool.unreserve(classSize(blockSizeClass(data)));
+    freeBlock(data);
+  }
+}
+
+size_t CachingCPUAllocator::CachedBytes() {
+  return BlockPool::get().cachedBytes();
+}
+
+static bool Caffe2SetCPUMemoryPool(int*, char***) {
+  if (FLAGS_caffe2_cpu_memory_pool == "" ||
+      FLAGS_caffe2_cpu_memory_pool == "none") {
+    return true;
+  } else if (FLAGS_caffe2_cpu_memory_pool == "caching") {
+    VLOG(1) << "Using the caching CPU memory pool";
+    SetCPUAllocator(new CachingCPUAllocator());
+    return true;
+  }
+  CAFFE_THROW(
+      "Unrecognized CPU memory pool type: ", FLAGS_caffe2_cpu_memory_pool);
+}
+
+REGISTER_CAFFE2_INIT_FUNCTION(
+    Caffe2SetCPUMemoryPool,
+    &Caffe2SetCPUMemoryPool,
+    "Set the CPU memory pool.");
+
+} // namespace caffe2
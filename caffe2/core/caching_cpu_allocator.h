@@ -0,0 +1,37 @@
+#ifndef CAFFE2_CORE_CACHING_CPU_ALLOCATOR_H_
+#define CAFFE2_CORE_CACHING_CPU_ALLOCATOR_H_
+
+#include "caffe2/core/allocator.h"
+
+CAFFE2_DECLARE_string(caffe2_cpu_memory_pool);
+CAFFE2_DECLARE_int64(caffe2_cpu_memory_pool_max_cached_bytes);
+
+namespace caffe2 {
+
+// A CPU allocator that keeps freed blocks for reuse instead of returning
+// them to the system, so that tensors reallocated every iteration do not
+// pay for malloc and for page faults on fresh memory.
+//
+// Sizes are rounded up to size classes, four per power of two. Freed blocks
+// first go to a small free list of the freeing thread, then to a shared
+// pool. Once the cached (free) blocks add up to
+// caffe2_cpu_memory_pool_max_cached_bytes, further frees go to the system.
+// Blocks of 2MB and more are huge page aligned and, on Linux, marked for
+// transparent huge pages.
+//
+// Selected with --caffe2_cpu_memory_pool=caching.
+struct CachingCPUAllocator final : CPUAllocator {
+  std::pair<void*, MemoryDeleter> New(size_t nbytes) override;
+  MemoryDeleter GetDeleter() override;
+
+  // Returns the blocks cached in the shared pool and in the calling thread's
+  // free lists to the system. Blocks cached by other threads are kept.
+  static void EmptyCache();
+
+  // Number of bytes in blocks cached by all threads and the shared pool
+  static size_t CachedBytes();
+};
+
+} // namespace caffe2
+
+#endif // CAFFE2_CORE_CACHING_CPU_ALLOCATOR_H_
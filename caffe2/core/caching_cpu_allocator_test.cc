@@ -0,0 +1,80 @@
+#include "caffe2/core/caching_cpu_allocator.h"
+#include "caffe2/core/scope_guard.h"
+
+#include <gtest/gtest.h>
+
+#include <thread>
+
+namespace caffe2 {
+
+TEST(CachingCPUAllocatorTest, ReusesBlocks) {
+  CachingCPUAllocator allocator;
+  CachingCPUAllocator::EmptyCache();
+  auto data = allocator.New(1000);
+  EXPECT_EQ(reinterpret_cast<size_t>(data.first) % gCaffe2Alignment, 0);
+  data.second(data.first);
+  // 1000 and 1010 bytes are in the same size class
+  EXPECT_EQ(CachingCPUAllocator::CachedBytes(), 1024);
+  auto reused = allocator.New(1010);
+  EXPECT_EQ(reused.first, data.first);
+  EXPECT_EQ(CachingCPUAllocator::CachedBytes(), 0);
+
+  auto other = allocator.New(2000);
+  EXPECT_NE(other.first, reused.first);
+  reused.second(reused.first);
+  other.second(other.first);
+  EXPECT_EQ(CachingCPUAllocator::CachedBytes(), 1024 + 2048);
+  CachingCPUAllocator::EmptyCache();
+  EXPECT_EQ(CachingCPUAllocator::CachedBytes(), 0);
+}
+
+TEST(CachingCPUAllocatorTest, ZeroFill) {
+  CachingCPUAllocator allocator;
+  auto data = allocator.New(64);
+  memset(data.first, 1, 64);
+  data.second(data.first);
+  auto reused = allocator.New(64);
+  ASSERT_EQ(reused.first, data.first);
+  for (int i = 0; i < 64; ++i) {
+    EXPECT_EQ(static_cast<char*>(reused.first)[i], 0);
+  }
+  reused.second(reused.first);
+  CachingCPUAllocator::EmptyCache();
+}
+
+TEST(CachingCPUAllocatorTest, MaxCachedBytes) {
+  auto old_limit = FLAGS_caffe2_cpu_memory_pool_max_cached_bytes;
+  auto g = MakeGuard(
+      [&]() { FLAGS_caffe2_cpu_memory_pool_max_cached_bytes = old_limit; });
+  FLAGS_caffe2_cpu_memory_pool_max_cached_bytes = 4096;
+
+  CachingCPUAllocator allocator;
+  CachingCPUAllocator::EmptyCache();
+  auto small = allocator.New(4096);
+  auto large = allocator.New(8192);
+  large.second(large.first);
+  EXPECT_EQ(CachingCPUAllocator::CachedBytes(), 0);
+  small.second(small.first);
+  EXPECT_EQ(CachingCPUAllocator::CachedBytes(), 4096);
+  CachingCPUAllocator::EmptyCache();
+}
+
+TEST(CachingCPUAllocatorTest, ThreadExit) {
+  CachingCPUAllocator allocator;
+  CachingCPUAllocator::EmptyCache();
+  void* data = nullptr;
+  // blocks freed by a thread go to the shared pool when it exits
+  std::thread([&]() {
+    auto block = allocator.New(256);
+    data = block.first;
+    block.second(block.first);
+  }).join();
+  EXPECT_EQ(CachingCPUAllocator::CachedBytes(), 256);
+  auto reused = allocator.New(256);
+  EXPECT_EQ(reused.first, data);
+  reused.second(reused.first);
+  CachingCPUAllocator::EmptyCache();
+  EXPECT_EQ(CachingCPUAllocator::CachedBytes(), 0);
+}
+
+} // namespace caffe2
@@ -70,13 +70,18 @@ class CPUContext final {
   explicit CPUContext(const DeviceOption& option)
       : random_seed_(
             option.has_random_seed() ? option.random_seed()
-                                     : RandomNumberSeed()) {
+                                     : RandomNumberSeed()),
+        numa_node_id_(option.numa_node_id()) {
     CAFFE_ENFORCE_EQ(option.device_type(), CPU);
   }
 
   ~CPUContext() noexcept {}
 
-  inline void SwitchToDevice(int /*stream_id*/) {}
+  // Allocations made on this thread from now on go to the context's NUMA
+  // node, if it has one
+  inline void SwitchToDevice(int /*stream_id*/) {
+    SetAllocationNUMANode(numa_node_id_);
+  }
   inline void SwitchToDevice() {
     SwitchToDevice(0);
   }
@@ -155,6 +160,7 @@ class CPUContext final {
   // TODO(jiayq): instead of hard-coding a generator, make it more flexible.
   int random_seed_{1701};
   std::unique_ptr<rand_gen_type> random_generator_;
+  int numa_node_id_{-1};
   CAFFE2_API static MemoryAllocationReporter reporter_;
 
  private:
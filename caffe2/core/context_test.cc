@@ -34,4 +34,17 @@ TEST(CPUContextTest, TestAllocDealloc) {
   dst_data_and_deleter.second(dst_data);
 }
 
+TEST(CPUContextTest, TestAllocationNUMANode) {
+  DeviceOption option;
+  option.set_numa_node_id(1);
+  CPUContext numa_context(option);
+  numa_context.SwitchToDevice();
+  EXPECT_EQ(GetAllocationNUMANode(), 1);
+
+  // without a NUMA node, allocations follow the thread
+  CPUContext context;
+  context.SwitchToDevice();
+  EXPECT_EQ(GetAllocationNUMANode(), GetCurrentNUMANode());
+}
+
 }  // namespace caffe2
@@ -1,7 +1,13 @@
 #include "caffe2/core/db.h"
 
+#include <cstring>
 #include <mutex>
 
+#ifndef _MSC_VER
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
 #include "caffe2/core/blob_serialization.h"
 #include "caffe2/core/logging.h"
 
@@ -89,6 +95,79 @@ class MiniDBCursor : public Cursor {
   vector<char> value_;
 };
 
+// Reads the entries of a minidb file mapped into memory, so that values can
+// be used without copying them out of the file.
+class MiniDBMappedCursor : public Cursor {
+ public:
+  MiniDBMappedCursor(const char* data, size_t size, std::mutex* mutex)
+    : data_(data), size_(size), lock_(*mutex), valid_(true), next_(0) {
+    Next();
+  }
+  ~MiniDBMappedCursor() {}
+
+  void Seek(const string& /*key*/) override {
+    LOG(FATAL) << "MiniDB does not support seeking to a specific key.";
+  }
+
+  void SeekToFirst() override {
+    CAFFE_ENFORCE_GT(size_, 0, "Hmm, empty file?");
+    valid_ = true;
+    next_ = 0;
+    Next();
+  }
+
+  void Next() override {
+    if (next_ == size_) {
+      VLOG(1) << "EOF reached, setting valid to false";
+      valid_ = false;
+      return;
+    }
+    CAFFE_ENFORCE_LE(next_ + 2 * sizeof(int), size_, "Truncated minidb entry");
+    int key_len, value_len;
+    std::memcpy(&key_len, data_ + next_, sizeof(int));
+    std::memcpy(&value_len, data_ + next_ + sizeof(int), sizeof(int));
+    CAFFE_ENFORCE_GT(key_len, 0);
+    CAFFE_ENFORCE_GT(value_len, 0);
+    key_ = data_ + next_ + 2 * sizeof(int);
+    key_len_ = key_len;
+    value_ = key_ + key_len;
+    value_len_ = value_len;
+    next_ += 2 * sizeof(int) + key_len_ + value_len_;
+    CAFFE_ENFORCE_LE(next_, size_, "Truncated minidb entry");
+  }
+
+  string key() override {
+    CAFFE_ENFORCE(valid_, "Cursor is at invalid location!");
+    return string(key_, key_len_);
+  }
+
+  string value() override {
+    CAFFE_ENFORCE(valid_, "Cursor is at invalid location!");
+    return string(value_, value_len_);
+  }
+
+  bool RawValue(const char** data, size_t* size) override {
+    CAFFE_ENFORCE(valid_, "Cursor is at invalid location!");
+    *data = value_;
+    *size = value_len_;
+    return true;
+  }
+
+  bool Valid() override { return valid_; }
+
+ private:
+  const char* data_;
+  size_t size_;
+  std::lock_guard<std::mutex> lock_;
+  bool valid_;
+  // The offset of the entry after the current one
+  size_t next_;
+  const char* key_;
+  size_t key_len_;
+  const char* value_;
+  size_t value_len_;
+};
+
 class MiniDBTransaction : public Transaction {
  public:
   explicit MiniDBTransaction(FILE* f, std::mutex* mutex)
@@ -124,7 +203,8 @@ class MiniDBTransaction : public Transaction {
 
 class MiniDB : public DB {
  public:
-  MiniDB(const string& source, Mode mode) : DB(source, mode), file_(nullptr) {
+  MiniDB(const string& source, Mode mode)
+      : DB(source, mode), file_(nullptr), data_(nullptr), size_(0) {
     switch (mode) {
       case NEW:
         file_ = fopen(source.c_str(), "wb");
@@ -138,11 +218,35 @@ class MiniDB : public DB {
         break;
     }
     CAFFE_ENFORCE(file_, "Cannot open file: " + source);
+#ifndef _MSC_VER
+    if (mode == READ) {
+      // Fall back to reading the file if it cannot be mapped
+      struct stat st;
+      if (fstat(fileno(file_), &st) == 0 && st.st_size > 0) {
+        void* data = mmap(
+            nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fileno(file_), 0);
+        if (data != MAP_FAILED) {
+          // Cursors read the entries in file order, so let the kernel read
+          // ahead aggressively
+          madvise(data, st.st_size, MADV_SEQUENTIAL);
+          data_ = static_cast<const char*>(data);
+          size_ = st.st_size;
+        }
+      }
+    }
+#endif
     VLOG(1) << "Opened MiniDB " << source;
   }
   ~MiniDB() { Close(); }
 
   void Close() override {
+#ifndef _MSC_VER
+    if (data_) {
+      munmap(const_cast<char*>(data_), size_);
+    }
+#endif
+    data_ = nullptr;
+    size_ = 0;
     if (file_) {
       fclose(file_);
     }
@@ -151,6 +255,9 @@ class MiniDB : public DB {
 
   unique_ptr<Cursor> NewCursor() override {
     CAFFE_ENFORCE_EQ(this->mode_, READ);
+    if (data_) {
+      return make_unique<MiniDBMappedCursor>(data_, size_, &file_access_mutex_);
+    }
     return make_unique<MiniDBCursor>(file_, &file_access_mutex_);
   }
 
@@ -161,6 +268,9 @@ class MiniDB : public DB {
 
  private:
   FILE* file_;
+  // The file mapped into memory, when reading and the platform allows
+  const char* data_;
+  size_t size_;
   // access mutex makes sure we don't have multiple cursors/transactions
   // reading the same file.
   std::mutex file_access_mutex_;
@@ -169,6 +279,121 @@ class MiniDB : public DB {
 REGISTER_CAFFE2_DB(MiniDB, MiniDB);
 REGISTER_CAFFE2_DB(minidb, MiniDB);
 
+PrefetchCursor::PrefetchCursor(
+    std::unique_ptr<Cursor> cursor,
+    const int batch_size,
+    const int num_batches)
+    : cursor_(std::move(cursor)),
+      batch_size_(batch_size),
+      num_batches_(num_batches) {
+  CAFFE_ENFORCE(cursor_, "Passed null cursor");
+  CAFFE_ENFORCE_GT(batch_size, 0);
+  CAFFE_ENFORCE_GT(num_batches, 0);
+  Start();
+}
+
+PrefetchCursor::~PrefetchCursor() {
+  Stop();
+}
+
+void PrefetchCursor::Seek(const string& key) {
+  Stop();
+  cursor_->Seek(key);
+  Start();
+}
+
+void PrefetchCursor::SeekToFirst() {
+  Stop();
+  cursor_->SeekToFirst();
+  Start();
+}
+
+void PrefetchCursor::Next() {
+  CAFFE_ENFORCE(valid_, "Cursor is at invalid location!");
+  if (++index_ == batch_.size()) {
+    NextBatch();
+  }
+}
+
+string PrefetchCursor::key() {
+  CAFFE_ENFORCE(valid_, "Cursor is at invalid location!");
+  return batch_[index_].first;
+}
+
+string PrefetchCursor::value() {
+  CAFFE_ENFORCE(valid_, "Cursor is at invalid location!");
+  return batch_[index_].second;
+}
+
+void PrefetchCursor::Start() {
+  thread_ = std::thread([this]() { Prefetch(); });
+  NextBatch();
+}
+
+void PrefetchCursor::Stop() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  cv_.notify_all();
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+  batches_.clear();
+  stop_ = false;
+  done_ = false;
+  exception_ = nullptr;
+  batch_.clear();
+  index_ = 0;
+  valid_ = false;
+}
+
+void PrefetchCursor::Prefetch() {
+  try {
+    while (cursor_->Valid()) {
+      Batch batch;
+      batch.reserve(batch_size_);
+      for (; batch.size() < batch_size_ && cursor_->Valid(); cursor_->Next()) {
+        batch.emplace_back(cursor_->key(), cursor_->value());
+      }
+      std::unique_lock<std::mutex> lock(mutex_);
+      cv_.wait(lock, [this]() {
+        return stop_ || batches_.size() < num_batches_;
+      });
+      if (stop_) {
+        return;
+      }
+      batches_.push_back(std::move(batch));
+      cv_.notify_all();
+    }
+  } catch (...) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    exception_ = std::current_exception();
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  done_ = true;
+  cv_.notify_all();
+}
+
+void PrefetchCursor::NextBatch() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  cv_.wait(lock, [this]() { return done_ || !batches_.empty(); });
+  if (batches_.empty()) {
+    valid_ = false;
+    if (exception_) {
+      std::rethrow_exception(exception_);
+    }
+    return;
+  }
+  batch_ = std::move(batches_.front());
+  batches_.pop_front();
+  index_ = 0;
+  valid_ = true;
+  cv_.notify_all();
+}
+
+constexpr int DBReader::kPrefetchBatches;
+
 void DBReaderSerializer::Serialize(
     const Blob& blob,
     const string& name,
@@ -1,7 +1,12 @@
 #ifndef CAFFE2_CORE_DB_H_
 #define CAFFE2_CORE_DB_H_
 
+#include <condition_variable>
+#include <deque>
+#include <exception>
 #include <mutex>
+#include <thread>
+#include <utility>
 
 #include "caffe2/core/blob_serialization.h"
 #include "caffe2/core/registry.h"
@@ -46,6 +51,15 @@ class Cursor {
    * Returns the current value.
    */
   virtual string value() = 0;
+  /**
+   * Points data and size at the current value without copying it, if the db
+   * keeps its values in memory, and returns true. The memory stays valid as
+   * long as the cursor does, even after it moves. Returns false, and leaves
+   * the arguments alone, otherwise; in that case use value().
+   */
+  virtual bool RawValue(const char** /*data*/, size_t* /*size*/) {
+    return false;
+  }
   /**
    * Returns whether the current location is valid - for example, if we have
    * reached the end of the database, return false.
@@ -95,6 +109,13 @@ class DB {
    * ownership of the pointer.
    */
   virtual std::unique_ptr<Transaction> NewTransaction() = 0;
+  /**
+   * Returns the number of entries in the database if the db can tell it
+   * without reading them, and -1 otherwise.
+   */
+  virtual int64_t NumEntries() {
+    return -1;
+  }
 
  protected:
   Mode mode_;
@@ -138,8 +159,73 @@ inline bool DBExists(const string& db_type, const string& full_db_name) {
   }
 }
 
+/**
+ * A cursor that reads ahead of another one: a background thread moves the
+ * wrapped cursor over the db and copies its entries in batches of batch_size,
+ * keeping at most num_batches batches ready. Seeking stops the thread, seeks
+ * the wrapped cursor and starts it again.
+ *
+ * The wrapped cursor is only used from one thread at a time, but not always
+ * from the thread that created it.
+ */
+class PrefetchCursor : public Cursor {
+ public:
+  PrefetchCursor(
+      std::unique_ptr<Cursor> cursor,
+      const int batch_size,
+      const int num_batches);
+  ~PrefetchCursor();
+
+  void Seek(const string& key) override;
+  bool SupportsSeek() override {
+    return cursor_->SupportsSeek();
+  }
+  void SeekToFirst() override;
+  void Next() override;
+  string key() override;
+  string value() override;
+  bool Valid() override {
+    return valid_;
+  }
+
+ private:
+  using Batch = std::vector<std::pair<string, string>>;
+
+  void Start();
+  void Stop();
+  void Prefetch();
+  void NextBatch();
+
+  std::unique_ptr<Cursor> cursor_;
+  const size_t batch_size_;
+  const size_t num_batches_;
+
+  std::thread thread_;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<Batch> batches_;
+  bool stop_ = false;
+  // whether the wrapped cursor reached the end of the db
+  bool done_ = false;
+  std::exception_ptr exception_;
+
+  Batch batch_;
+  size_t index_ = 0;
+  bool valid_ = false;
+};
+
 /**
  * A reader wrapper for DB that also allows us to serialize it.
+ *
+ * In sharded mode, num_shards readers, with shard ids 0 to num_shards - 1,
+ * read disjoint parts of the db. By default shard i reads the entries i,
+ * i + num_shards, ..., so each reader still moves over the whole db. With
+ * shard_by_range, shard i reads the i-th of num_shards contiguous ranges of
+ * entries instead, and only moves over that range. The readers share no
+ * lock.
+ *
+ * With a positive prefetch, the reader reads ahead of Read() on a background
+ * thread, in batches of prefetch entries (see PrefetchCursor).
  */
 class DBReader {
  public:
@@ -151,8 +237,10 @@ class DBReader {
       const string& db_type,
       const string& source,
       const int32_t num_shards = 1,
-      const int32_t shard_id = 0) {
-    Open(db_type, source, num_shards, shard_id);
+      const int32_t shard_id = 0,
+      const int32_t prefetch = 0,
+      const bool shard_by_range = false) {
+    Open(db_type, source, num_shards, shard_id, prefetch, shard_by_range);
   }
 
   explicit DBReader(const DBReaderProto& proto) {
@@ -179,7 +267,9 @@ class DBReader {
       const string& db_type,
       const string& source,
       const int32_t num_shards = 1,
-      const int32_t shard_id = 0) {
+      const int32_t shard_id = 0,
+      const int32_t prefetch = 0,
+      const bool shard_by_range = false) {
     // Note(jiayq): resetting is needed when we re-open e.g. leveldb where no
     // concurrent access is allowed.
     cursor_.reset();
@@ -188,18 +278,20 @@ class DBReader {
     source_ = source;
     db_ = CreateDB(db_type_, source_, READ);
     CAFFE_ENFORCE(db_, "Cannot open db: ", source_, " of type ", db_type_);
-    InitializeCursor(num_shards, shard_id);
+    InitializeCursor(num_shards, shard_id, prefetch, shard_by_range);
   }
 
   void Open(
       unique_ptr<DB>&& db,
       const int32_t num_shards = 1,
-      const int32_t shard_id = 0) {
+      const int32_t shard_id = 0,
+      const int32_t prefetch = 0,
+      const bool shard_by_range = false) {
     cursor_.reset();
     db_.reset();
     db_ = std::move(db);
     CAFFE_ENFORCE(db_.get(), "Passed null db");
-    InitializeCursor(num_shards, shard_id);
+    InitializeCursor(num_shards, shard_id, prefetch, shard_by_range);
   }
 
  public:
@@ -225,6 +317,13 @@ class DBReader {
     *key = cursor_->key();
     *value = cursor_->value();
 
+    if (shard_by_range_) {
+      cursor_->Next();
+      if (++position_ == range_end_ || !cursor_->Valid()) {
+        MoveToBeginning();
+      }
+      return;
+    }
     // In sharded mode, each read skips num_shards_ records
     for (int s = 0; s < num_shards_; s++) {
       cursor_->Next();
@@ -258,25 +357,80 @@ class DBReader {
   }
 
  private:
-  void InitializeCursor(const int32_t num_shards, const int32_t shard_id) {
+  void InitializeCursor(
+      const int32_t num_shards,
+      const int32_t shard_id,
+      const int32_t prefetch,
+      const bool shard_by_range) {
     CAFFE_ENFORCE(num_shards >= 1);
     CAFFE_ENFORCE(shard_id >= 0);
     CAFFE_ENFORCE(shard_id < num_shards);
+    CAFFE_ENFORCE(prefetch >= 0);
     num_shards_ = num_shards;
     shard_id_ = shard_id;
+    shard_by_range_ = shard_by_range && num_shards > 1;
     cursor_ = db_->NewCursor();
+    if (shard_by_range_) {
+      InitializeRange();
+    }
+    if (prefetch > 0) {
+      cursor_ = make_unique<PrefetchCursor>(
+          std::move(cursor_), prefetch, kPrefetchBatches);
+    }
     SeekToFirst();
   }
 
+  // Finds the entries [range_begin_, range_end_) of the shard, and the key of
+  // its first entry if the cursor can seek to it
+  void InitializeRange() {
+    int64_t num_entries = db_->NumEntries();
+    if (num_entries < 0) {
+      num_entries = 0;
+      for (cursor_->SeekToFirst(); cursor_->Valid(); cursor_->Next()) {
+        ++num_entries;
+      }
+    }
+    range_begin_ = num_entries * shard_id_ / num_shards_;
+    range_end_ = num_entries * (shard_id_ + 1) / num_shards_;
+    CAFFE_ENFORCE_LT(
+        range_begin_,
+        range_end_,
+        "Db has too few rows for shard ",
+        shard_id_,
+        " of ",
+        num_shards_);
+    range_key_.clear();
+    if (cursor_->SupportsSeek()) {
+      MoveToBeginning();
+      range_key_ = cursor_->key();
+    }
+  }
+
   void MoveToBeginning() const {
-    cursor_->SeekToFirst();
-    for (auto s = 0; s < shard_id_; s++) {
-      cursor_->Next();
-      CAFFE_ENFORCE(
-          cursor_->Valid(), "Db has less rows than shard id: ", s, shard_id_);
+    if (!shard_by_range_) {
+      cursor_->SeekToFirst();
+      for (auto s = 0; s < shard_id_; s++) {
+        cursor_->Next();
+        CAFFE_ENFORCE(
+            cursor_->Valid(), "Db has less rows than shard id: ", s, shard_id_);
+      }
+      return;
+    }
+    if (!range_key_.empty()) {
+      cursor_->Seek(range_key_);
+    } else {
+      cursor_->SeekToFirst();
+      for (int64_t s = 0; s < range_begin_; s++) {
+        cursor_->Next();
+      }
     }
+    CAFFE_ENFORCE(cursor_->Valid(), "Db has less rows than shard range");
+    position_ = range_begin_;
   }
 
+  // The number of batches a prefetching reader keeps ready
+  static constexpr int kPrefetchBatches = 4;
+
   string db_type_;
   string source_;
   unique_ptr<DB> db_;
@@ -284,6 +438,12 @@ class DBReader {
   mutable std::mutex reader_mutex_;
   uint32_t num_shards_;
   uint32_t shard_id_;
+  bool shard_by_range_ = false;
+  int64_t range_begin_ = 0;
+  int64_t range_end_ = 0;
+  string range_key_;
+  // The index of the entry of the cursor, when sharding by range
+  mutable int64_t position_ = 0;
 
   DISABLE_COPY_AND_ASSIGN(DBReader);
 };
@@ -3,9 +3,75 @@
 #include "caffe2/core/operator.h"
 
 #include <atomic>
+#include <deque>
+#include <unordered_map>
 
 namespace caffe2 {
 
+namespace {
+
+/**
+ * Creating and destroying CUDA events costs enough CPU time to show up when
+ * nets with thousands of operators are created over and over (e.g. the step
+ * nets of recurrent networks), so CudaEventWrapper takes its event from a
+ * per-device pool and gives it back when destroyed.
+ *
+ * An event given back may still be pending on a stream. Events are handed
+ * out again in the order they were given back, and only once
+ * cudaEventQuery reports them done, so a new wrapper never starts with an
+ * event someone else's work is still recorded on.
+ *
+ * The pool is never destroyed, so that wrappers destroyed at exit can still
+ * give their events back.
+ */
+class CudaEventPool {
+ public:
+  static CudaEventPool& instance() {
+    static CudaEventPool* pool = new CudaEventPool();
+    return *pool;
+  }
+
+  // Must be called with gpu_id as the current device
+  cudaEvent_t acquire(int gpu_id) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto& events = free_[gpu_id];
+      while (!events.empty()) {
+        auto event = events.front();
+        auto status = cudaEventQuery(event);
+        if (status == cudaErrorNotReady) {
+          break;
+        }
+        events.pop_front();
+        if (status == cudaSuccess) {
+          return event;
+        }
+        // The error was about the work recorded on the event; it's not
+        // sticky, but don't hand out the event again
+        cudaGetLastError();
+        CUDA_CHECK(cudaEventDestroy(event));
+      }
+    }
+    cudaEvent_t event;
+    CUDA_ENFORCE(
+        cudaEventCreate(&event, cudaEventDefault | cudaEventDisableTiming));
+    return event;
+  }
+
+  void release(int gpu_id, cudaEvent_t event) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    free_[gpu_id].push_back(event);
+  }
+
+ private:
+  CudaEventPool() {}
+
+  std::mutex mutex_;
+  std::unordered_map<int, std::deque<cudaEvent_t>> free_;
+};
+
+} // namespace
+
 struct CudaEventWrapper {
   explicit CudaEventWrapper(const DeviceOption& option)
       : cuda_stream_(nullptr),
@@ -13,12 +79,10 @@ struct CudaEventWrapper {
         status_(EventStatus::EVENT_INITIALIZED) {
     CAFFE_ENFORCE(option.device_type(), CUDA);
     DeviceGuard g(cuda_gpu_id_);
-    CUDA_ENFORCE(cudaEventCreate(
-        &cuda_event_, cudaEventDefault | cudaEventDisableTiming));
+    cuda_event_ = CudaEventPool::instance().acquire(cuda_gpu_id_);
   }
   ~CudaEventWrapper() {
-    DeviceGuard g(cuda_gpu_id_);
-    CUDA_CHECK(cudaEventDestroy(cuda_event_));
+    CudaEventPool::instance().release(cuda_gpu_id_, cuda_event_);
   }
 
   cudaEvent_t cuda_event_;
@@ -47,4 +47,25 @@ TEST(EventCUDATest, EventBasics) {
   context_cuda.WaitEvent(event_cpu);
 }
 
+TEST(EventCUDATest, EventReuse) {
+  if (!HasCudaGPU())
+    return;
+  DeviceOption device_cuda;
+  device_cuda.set_device_type(CUDA);
+  CUDAContext context_cuda(device_cuda);
+  context_cuda.SwitchToDevice();
+
+  // Events given back to the pool, pending or not, come back initialized
+  for (int i = 0; i < 10; ++i) {
+    Event event_cuda(device_cuda);
+    EXPECT_EQ(event_cuda.Query(), EventStatus::EVENT_INITIALIZED);
+    context_cuda.Record(&event_cuda);
+    if (i % 2 == 0) {
+      event_cuda.Finish();
+      EXPECT_EQ(event_cuda.Query(), EventStatus::EVENT_SUCCESS);
+    }
+  }
+  context_cuda.FinishDeviceComputation();
+}
+
 } // namespace caffe2
@@ -168,7 +168,7 @@ OperatorDef* AddOp(
  * For example, if we wanted to match an operator to Conv or FC, we can give:
  * "Conv|FC" as the type() of that op.
  */
-bool MatchStrings(string p, string s);
+bool MatchStrings(const string& p, const string& s);
 
 /**
  * This ensures that each named arg that exists in the pattern exists in g_op,
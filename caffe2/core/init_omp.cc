@@ -11,6 +11,7 @@
 #endif // CAFFE2_USE_MKL
 
 #include "caffe2/core/init.h"
+#include "caffe2/core/thread_budget.h"
 
 CAFFE2_DEFINE_int(
     caffe2_omp_num_threads, 0,
@@ -34,6 +35,14 @@ bool Caffe2SetOpenMPThreads(int*, char***) {
     omp_set_num_threads(1);
   }
 
+  if (IsThreadBudgetEnabled()) {
+    // The main thread gets the same share as a CPU pool worker
+    const int num_threads = GetThreadBudget().intra_op_threads;
+    VLOG(1) << "Setting omp_num_threads to " << num_threads
+            << " from the CPU thread budget";
+    omp_set_num_threads(num_threads);
+  }
+
   if (FLAGS_caffe2_omp_num_threads > 0) {
     VLOG(1) << "Setting omp_num_threads to " << FLAGS_caffe2_omp_num_threads;
     omp_set_num_threads(FLAGS_caffe2_omp_num_threads);
@@ -53,6 +62,13 @@ bool Caffe2SetMKLThreads(int*, char***) {
     mkl_set_num_threads(1);
   }
 
+  if (IsThreadBudgetEnabled()) {
+    const int num_threads = GetThreadBudget().intra_op_threads;
+    VLOG(1) << "Setting mkl_num_threads to " << num_threads
+            << " from the CPU thread budget";
+    mkl_set_num_threads(num_threads);
+  }
+
   // If caffe2_omp_num_threads is set, we use that for MKL as well.
   if (FLAGS_caffe2_omp_num_threads > 0) {
     VLOG(1) << "Setting mkl_num_threads to " << FLAGS_caffe2_omp_num_threads
@@ -0,0 +1,285 @@
+#include "caffe2/core/mapped_params.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <unordered_set>
+
+#ifndef _MSC_VER
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "caffe2/core/logging.h"
+#include "caffe2/core/tensor.h"
+#include "caffe2/core/types.h"
+
+namespace caffe2 {
+
+namespace {
+
+// Layout of a parameter file:
+//
+//   char[8]  magic
+//   uint32   version
+//   uint32   number of tensors
+//   for every tensor:
+//     uint32   length of the name, followed by the name
+//     int32    TensorProto::DataType
+//     uint32   number of dims, followed by the dims as int64
+//     uint64   offset of the data in the file
+//     uint64   size of the data in bytes
+//   the data of every tensor, at the offsets of the index
+const char kMagic[8] = {'C', '2', 'P', 'A', 'R', 'A', 'M', 'S'};
+const uint32_t kVersion = 1;
+
+size_t alignUp(size_t n) {
+  return (n + kMappedParamsAlignment - 1) / kMappedParamsAlignment *
+      kMappedParamsAlignment;
+}
+
+template <typename T>
+void append(std::string* out, T value) {
+  out->append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+void writeBytes(FILE* file, const void* data, size_t nbytes) {
+  CAFFE_ENFORCE_EQ(fwrite(data, 1, nbytes, file), nbytes);
+}
+
+class IndexReader {
+ public:
+  IndexReader(const char* data, size_t size, const std::string& path)
+      : data_(data), size_(size), pos_(0), path_(path) {}
+
+  template <typename T>
+  T read() {
+    T value;
+    memcpy(&value, take(sizeof(T)), sizeof(T));
+    return value;
+  }
+
+  std::string readString(size_t length) {
+    return std::string(take(length), length);
+  }
+
+ private:
+  const char* take(size_t n) {
+    CAFFE_ENFORCE_LE(n, size_ - pos_, "Truncated parameter file: ", path_);
+    const char* p = data_ + pos_;
+    pos_ += n;
+    return p;
+  }
+
+  const char* data_;
+  size_t size_;
+  size_t pos_;
+  const std::string& path_;
+};
+
+// The contents of a parameter file, mapped read-only if possible
+class MappedFile {
+ public:
+  explicit MappedFile(const std::string& path) {
+#ifndef _MSC_VER
+    int fd = open(path.c_str(), O_RDONLY);
+    CAFFE_ENFORCE(fd >= 0, "Cannot open file: ", path);
+    struct stat st;
+    CAFFE_ENFORCE_EQ(fstat(fd, &st), 0, "Cannot stat file: ", path);
+    size_ = st.st_size;
+    void* data = size_ > 0
+        ? mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0)
+        : MAP_FAILED;
+    close(fd);
+    if (data != MAP_FAILED) {
+      // Embedding lookups touch rows all over the tensors, so read ahead
+      // would mostly bring in cold rows
+      madvise(data, size_, MADV_RANDOM);
+      data_ = static_cast<char*>(data);
+      mapped_ = true;
+      return;
+    }
+#endif
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    CAFFE_ENFORCE(file, "Cannot open file: ", path);
+    size_ = file.tellg();
+    buffer_.reset(new char[size_]);
+    file.seekg(0);
+    CAFFE_ENFORCE(file.read(buffer_.get(), size_), "Cannot read file: ", path);
+    data_ = buffer_.get();
+  }
+
+  ~MappedFile() {
+#ifndef _MSC_VER
+    if (mapped_) {
+      munmap(data_, size_);
+    }
+#endif
+  }
+
+  char* data() const {
+    return data_;
+  }
+
+  size_t size() const {
+    return size_;
+  }
+
+ private:
+  char* data_ = nullptr;
+  size_t size_ = 0;
+  bool mapped_ = false;
+  std::unique_ptr<char[]> buffer_;
+
+  DISABLE_COPY_AND_ASSIGN(MappedFile);
+};
+
+} // namespace
+
+void SaveMappedParams(
+    const Workspace& ws,
+    const std::vector<std::string>& names,
+    const std::string& path) {
+  std::vector<const TensorCPU*> tensors;
+  for (const auto& name : names) {
+    const auto* blob = ws.GetBlob(name);
+    CAFFE_ENFORCE(blob, "Blob does not exist: ", name);
+    CAFFE_ENFORCE(
+        blob->IsType<TensorCPU>(), "Blob is not a CPU Tensor: ", name);
+    const auto& tensor = blob->Get<TensorCPU>();
+    CAFFE_ENFORCE(
+        tensor.meta().id() && !tensor.meta().copy(),
+        "Only tensors of fixed size types can be mapped: ",
+        name);
+    CAFFE_ENFORCE(
+        TypeMetaToDataType(tensor.meta()) != TensorProto::UNDEFINED,
+        "Unsupported type ",
+        tensor.meta().name(),
+        " of tensor: ",
+        name);
+    tensors.push_back(&tensor);
+  }
+
+  size_t index_size = sizeof(kMagic) + 2 * sizeof(uint32_t);
+  for (size_t i = 0; i < names.size(); ++i) {
+    index_size += sizeof(uint32_t) + names[i].size() + sizeof(int32_t) +
+        sizeof(uint32_t) + tensors[i]->ndim() * sizeof(int64_t) +
+        2 * sizeof(uint64_t);
+  }
+
+  std::string index(kMagic, sizeof(kMagic));
+  append<uint32_t>(&index, kVersion);
+  append<uint32_t>(&index, names.size());
+  std::vector<size_t> offsets;
+  size_t offset = alignUp(index_size);
+  for (size_t i = 0; i < names.size(); ++i) {
+    const auto* tensor = tensors[i];
+    append<uint32_t>(&index, names[i].size());
+    index.append(names[i]);
+    append<int32_t>(&index, TypeMetaToDataType(tensor->meta()));
+    append<uint32_t>(&index, tensor->ndim());
+    for (auto d : tensor->dims()) {
+      append<int64_t>(&index, d);
+    }
+    append<uint64_t>(&index, offset);
+    append<uint64_t>(&index, tensor->nbytes());
+    offsets.push_back(offset);
+    offset = alignUp(offset + tensor->nbytes());
+  }
+  CAFFE_ENFORCE_EQ(index.size(), index_size);
+
+  std::unique_ptr<FILE, int (*)(FILE*)> file(
+      fopen(path.c_str(), "wb"), &fclose);
+  CAFFE_ENFORCE(file, "Cannot open file: ", path);
+  const std::vector<char> padding(kMappedParamsAlignment, 0);
+  writeBytes(file.get(), index.data(), index.size());
+  size_t written = index.size();
+  for (size_t i = 0; i < tensors.size(); ++i) {
+    writeBytes(file.get(), padding.data(), offsets[i] - written);
+    writeBytes(file.get(), tensors[i]->raw_data(), tensors[i]->nbytes());
+    written = offsets[i] + tensors[i]->nbytes();
+  }
+  CAFFE_ENFORCE_EQ(fflush(file.get()), 0, "Cannot write file: ", path);
+}
+
+std::vector<std::string> LoadMappedParams(
+    const std::string& path,
+    Workspace* ws) {
+  CAFFE_ENFORCE(ws);
+  auto file = std::make_shared<MappedFile>(path);
+  IndexReader reader(file->data(), file->size(), path);
+  CAFFE_ENFORCE(
+      reader.readString(sizeof(kMagic)) ==
+          std::string(kMagic, sizeof(kMagic)),
+      "Not a parameter file: ",
+      path);
+  auto version = reader.read<uint32_t>();
+  CAFFE_ENFORCE_EQ(
+      version, kVersion, "Unsupported version of parameter file: ", path);
+
+  auto num_tensors = reader.read<uint32_t>();
+  std::vector<std::string> names;
+  for (uint32_t i = 0; i < num_tensors; ++i) {
+    auto name = reader.readString(reader.read<uint32_t>());
+    const auto& meta = DataTypeToTypeMeta(
+        static_cast<TensorProto::DataType>(reader.read<int32_t>()));
+    std::vector<TIndex> dims(reader.read<uint32_t>());
+    for (auto& d : dims) {
+      d = reader.read<int64_t>();
+    }
+    auto offset = reader.read<uint64_t>();
+    auto nbytes = reader.read<uint64_t>();
+    CAFFE_ENFORCE(
+        offset <= file->size() && nbytes <= file->size() - offset,
+        "Tensor ",
+        name,
+        " lies outside of parameter file: ",
+        path);
+
+    auto* tensor = ws->CreateBlob(name)->GetMutable<TensorCPU>();
+    tensor->Resize(dims);
+    CAFFE_ENFORCE_EQ(
+        static_cast<uint64_t>(tensor->size()) * meta.itemsize(),
+        nbytes,
+        "Size mismatch of tensor ",
+        name,
+        " in parameter file: ",
+        path);
+    // Every tensor holds on to the file, which is unmapped with the last one
+    tensor->ShareExternalPointer(
+        file->data() + offset, meta, nbytes, [file](void*) {});
+    names.push_back(name);
+  }
+  VLOG(1) << "Mapped " << names.size() << " parameters from " << path;
+  return names;
+}
+
+NetDef StripMappedParams(
+    const NetDef& init_net,
+    const std::vector<std::string>& params) {
+  const std::unordered_set<std::string> mapped(params.begin(), params.end());
+  NetDef stripped(init_net);
+  stripped.clear_op();
+  for (const auto& op : init_net.op()) {
+    int num_mapped = 0;
+    for (const auto& output : op.output()) {
+      num_mapped += mapped.count(output);
+    }
+    if (num_mapped == 0) {
+      stripped.add_op()->CopyFrom(op);
+      continue;
+    }
+    CAFFE_ENFORCE_EQ(
+        num_mapped,
+        op.output_size(),
+        "Operator ",
+        op.type(),
+        " creates both mapped parameters and other blobs");
+  }
+  return stripped;
+}
+
+} // namespace caffe2
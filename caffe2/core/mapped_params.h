@@ -0,0 +1,61 @@
+#ifndef CAFFE2_CORE_MAPPED_PARAMS_H_
+#define CAFFE2_CORE_MAPPED_PARAMS_H_
+
+#include <string>
+#include <vector>
+
+#include "caffe2/core/workspace.h"
+#include "caffe2/proto/caffe2.pb.h"
+
+namespace caffe2 {
+
+// Parameter files hold CPU tensors of fixed size types laid out so that they
+// can be used in place from a read-only mapping of the file: a small index
+// (names, types and shapes) followed by the data of every tensor, each
+// starting at a multiple of kMappedParamsAlignment. Numbers are stored in the
+// byte order of the machine writing the file.
+//
+// Loading a parameter file only maps it, so it takes about as long for 20GB
+// of parameters as for 20MB. Pages are read on first access, and as they are
+// clean file pages, processes serving the same file share them, and the
+// kernel can drop the pages of rows which are not used any more.
+//
+// Typical use with a Predictor:
+//
+//   // Once, offline
+//   SaveMappedParams(trained_ws, params, "model.params");
+//
+//   // In every serving process
+//   Workspace params_ws;
+//   auto params = LoadMappedParams("model.params", &params_ws);
+//   Predictor predictor(
+//       StripMappedParams(init_net, params), run_net, &params_ws);
+//
+// The mapped tensors must not be written to, nor resized: their memory is
+// read-only, and writing to it crashes the process.
+constexpr size_t kMappedParamsAlignment = 4096;
+
+// Writes the tensors `names` of `ws` to the parameter file `path`
+void SaveMappedParams(
+    const Workspace& ws,
+    const std::vector<std::string>& names,
+    const std::string& path);
+
+// Maps the parameter file `path` and creates a blob in `ws` for each of its
+// tensors, which uses the mapped memory. The file is unmapped once all of
+// these tensors are gone. Returns the names of the blobs, in file order.
+//
+// On platforms without mmap, the file is read into memory instead.
+std::vector<std::string> LoadMappedParams(
+    const std::string& path,
+    Workspace* ws);
+
+// Returns `init_net` without the operators that create one of `params`. These
+// operators must not have other outputs.
+NetDef StripMappedParams(
+    const NetDef& init_net,
+    const std::vector<std::string>& params);
+
+} // namespace caffe2
+
+#endif // CAFFE2_CORE_MAPPED_PARAMS_H_
@@ -2,8 +2,11 @@
 
 #include "caffe2/core/net_async_tracing.h"
 #include "caffe2/core/operator.h"
+#include "caffe2/core/thread_budget.h"
 #include "caffe2/core/timer.h"
 
+#include <numeric>
+
 CAFFE2_DEFINE_int(
     caffe2_streams_per_gpu,
     32,
@@ -36,6 +39,12 @@ CAFFE2_DEFINE_bool(
     true,
     "Select next non-busy stream");
 
+CAFFE2_DEFINE_bool(
+    caffe2_net_async_work_stealing,
+    false,
+    "Use per-thread work-stealing queues in CPU pools; tasks scheduled from "
+    "a pool thread (e.g. successor chains) go to that thread's queue");
+
 namespace caffe2 {
 
 thread_local std::vector<int> AsyncNetBase::stream_counters_;
@@ -60,10 +69,32 @@ AsyncNetBase::AsyncNetBase(
   }
   chain_nodes_ = dag_utils::prepareChainGraphNodes(operator_nodes_, chains_);
 
+  task_order_.resize(chains_.size());
+  std::iota(task_order_.begin(), task_order_.end(), 0);
+  if (FLAGS_caffe2_net_critical_path_priority) {
+    const auto critical_paths = dag_utils::computeCriticalPaths(
+        operator_nodes_, dag_utils::estimateOperatorCosts(*net_def, ws));
+    // a chain's first operator precedes all of the chain
+    auto by_critical_path = [&](int a, int b) {
+      return critical_paths[chains_[a].front()] >
+          critical_paths[chains_[b].front()];
+    };
+    std::stable_sort(task_order_.begin(), task_order_.end(), by_critical_path);
+    for (auto& chain_node : chain_nodes_) {
+      std::stable_sort(
+          chain_node.children_.begin(),
+          chain_node.children_.end(),
+          by_critical_path);
+    }
+  }
+
   events_.reserve(chains_.size());
   for (const auto& chain : chains_) {
     const auto& op = operators_[chain.back()];
     events_.push_back(&op->event());
+    for (size_t i = 0; i + 1 < chain.size(); ++i) {
+      operators_[chain[i]]->DisableEventRecording();
+    }
   }
 
   num_workers_ = net_def->has_num_workers() ? net_def->num_workers() : -1;
@@ -316,7 +347,11 @@ std::shared_ptr<TaskThreadPool> GetAsyncNetCPUThreadPool(
   std::lock_guard<std::mutex> lock(pool_mutex);
 
   if (pool_size <= 0) {
-    if (FLAGS_caffe2_net_async_cpu_pool_size > 0) {
+    if (IsThreadBudgetEnabled()) {
+      pool_size = GetThreadBudget(numa_node_id).inter_op_threads;
+      LOG(INFO) << "Using CPU pool size from thread budget: " << pool_size
+                << "; NUMA node id: " << numa_node_id;
+    } else if (FLAGS_caffe2_net_async_cpu_pool_size > 0) {
       pool_size = FLAGS_caffe2_net_async_cpu_pool_size;
       LOG(INFO) << "Using default CPU pool size: " << pool_size
                 << "; NUMA node id: " << numa_node_id;
@@ -330,13 +365,23 @@ std::shared_ptr<TaskThreadPool> GetAsyncNetCPUThreadPool(
   } else {
     LOG(INFO) << "Using specified CPU pool size: " << pool_size
               << "; NUMA node id: " << numa_node_id;
+    if (IsThreadBudgetEnabled()) {
+      const auto budget = GetThreadBudget(numa_node_id);
+      if (pool_size > budget.inter_op_threads) {
+        LOG(WARNING) << "CPU pool size " << pool_size << " exceeds the thread "
+                     << "budget, using " << budget.inter_op_threads;
+        pool_size = budget.inter_op_threads;
+      }
+    }
   }
 
   auto shared_pool = pools[numa_node_id][pool_size].lock();
   if (!shared_pool) {
     LOG(INFO) << "Created CPU pool, size: " << pool_size
-              << "; NUMA node id: " << numa_node_id;
-    shared_pool = std::make_shared<TaskThreadPool>(pool_size, numa_node_id);
+              << "; NUMA node id: " << numa_node_id
+              << "; work stealing: " << FLAGS_caffe2_net_async_work_stealing;
+    shared_pool = std::make_shared<TaskThreadPool>(
+        pool_size, numa_node_id, FLAGS_caffe2_net_async_work_stealing);
     pools[numa_node_id][pool_size] = shared_pool;
   }
   return shared_pool;
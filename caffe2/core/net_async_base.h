@@ -68,6 +68,10 @@ class AsyncNetBase : public NetBase {
   std::vector<dag_utils::OperatorNode> operator_nodes_;
   std::vector<std::vector<int>> chains_;
   std::vector<dag_utils::OpGraphNode> chain_nodes_; // chains' parents/children
+  // Order in which to schedule ready tasks; with
+  // caffe2_net_critical_path_priority, by decreasing critical path (children
+  // in chain_nodes_ are sorted the same way), otherwise by task id
+  std::vector<int> task_order_;
 
   // Pools and streams
   std::mutex pools_mutex_;
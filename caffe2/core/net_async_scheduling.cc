@@ -35,7 +35,12 @@ void AsyncSchedulingNet::Wait() {
 
 void AsyncSchedulingNet::schedule(int task_id) {
   const auto& device_option = event(task_id).GetDeviceOption();
-  pool(device_option)->run([this, task_id]() {
+  long enqueue_ts =
+      (tracer_ && tracer_->isEnabled()) ? tracer_->timestamp() : -1;
+  pool(device_option)->run([this, task_id, enqueue_ts]() {
+    if (enqueue_ts >= 0) {
+      tracer_->recordQueueing(task_id, enqueue_ts);
+    }
     if (success_) {
       int stream_id = stream(task_id);
       asyncWait(task_id, stream_id, parents(task_id));
@@ -48,6 +53,9 @@ void AsyncSchedulingNet::schedule(int task_id) {
 
     auto task_count = ++processed_tasks_num_;
 
+    // With work-stealing pools (caffe2_net_async_work_stealing), children
+    // scheduled here go to this thread's own queue and, unless stolen, run
+    // next on this thread while the parent's outputs are still in cache
     for (auto child_id : children(task_id)) {
       int parent_count = updateParentCount(child_id);
       if (parent_count == 0) {
@@ -142,7 +150,7 @@ bool AsyncSchedulingNet::DoRunAsync() {
 
   StartAllObservers();
 
-  for (auto task_id = 0; task_id < tasksNum(); ++task_id) {
+  for (auto task_id : task_order_) {
     if (parents(task_id).empty()) {
       schedule(task_id);
     }
@@ -18,6 +18,11 @@
 
 #include "caffe2/utils/string_utils.h"
 
+#include <atomic>
+#include <csignal>
+#include <map>
+#include <mutex>
+
 CAFFE2_DEFINE_string(
     caffe2_net_async_tracing_filepath,
     "/tmp",
@@ -28,17 +33,54 @@ CAFFE2_DEFINE_string(
     "",
     "Comma-separated list of net names to trace");
 
-CAFFE2_DEFINE_int(caffe2_net_async_tracing_nth, 100, "Trace every Nth batch");
+CAFFE2_DEFINE_int(
+    caffe2_net_async_tracing_nth,
+    100,
+    "Trace every Nth batch, into a file per batch; 0 to trace only on request");
+
+CAFFE2_DEFINE_bool(
+    caffe2_net_async_tracing_on_signal,
+    false,
+    "Trace the next batch of traced nets when the process receives SIGUSR2");
 
 namespace caffe2 {
 namespace tracing {
 
+namespace {
+
+// Bumped by requestTrace(), tracers trace a batch when it changes
+std::atomic<int> trace_requests(0);
+
+void traceRequestHandler(int /* signum */) {
+  trace_requests.fetch_add(1);
+}
+
+void installTraceRequestHandler() {
+#ifndef _WIN32
+  static std::once_flag installed;
+  std::call_once(
+      installed, []() { std::signal(SIGUSR2, traceRequestHandler); });
+#endif
+}
+
+// GPU operators are also shown on a lane per device and stream, above the
+// thread labels of renameThreads
+const long kStreamLaneBase = 1000000000000L;
+const long kStreamsPerDevice = 1000;
+
+} // namespace
+
+void requestTrace() {
+  trace_requests.fetch_add(1);
+}
+
 Tracer::Tracer(const NetBase* net, const std::string& net_name)
     : net_(net), filename_(net_name), iter_(0) {
   std::replace(filename_.begin(), filename_.end(), '/', '_');
-  filename_ =
-      FLAGS_caffe2_net_async_tracing_filepath + "/" + filename_ + ".json";
+  filename_ = FLAGS_caffe2_net_async_tracing_filepath + "/" + filename_;
+  seen_requests_ = trace_requests.load();
   timer_.Start();
+  writer_ = std::thread(&Tracer::writerLoop, this);
 }
 
 void Tracer::recordEvent(const TracerEvent& event) {
@@ -46,6 +88,25 @@ void Tracer::recordEvent(const TracerEvent& event) {
   events_.push_back(event);
 }
 
+long Tracer::timestamp() {
+  return (long)caffe2::round(timer_.MicroSeconds());
+}
+
+void Tracer::recordQueueing(int task_id, long enqueue_ts) {
+  TracerEvent event;
+  event.task_id_ = task_id;
+  event.tid_ = std::this_thread::get_id();
+  event.is_queueing_ = true;
+  event.is_beginning_ = true;
+  event.timestamp_ = enqueue_ts;
+  auto start_ts = timestamp();
+  std::lock_guard<std::mutex> lock(tracer_mutex_);
+  events_.push_back(event);
+  event.is_beginning_ = false;
+  event.timestamp_ = start_ts;
+  events_.push_back(event);
+}
+
 // Special handling of shard blob annotations
 std::string Tracer::opTraceName(const OperatorBase* op) {
   if (!op->has_debug_def()) {
@@ -105,7 +166,18 @@ std::string Tracer::serializeEvent(const TracerEvent& event) {
     serialized_event << " \"tid\": " << event.tid_ << ",\n";
   }
 
-  if (event.is_beginning_) {
+  if (event.is_queueing_) {
+    serialized_event << " \"name\": \"queue\",\n";
+    serialized_event << " \"cat\": \"queue\",\n";
+    serialized_event << " \"id\": " << event.task_id_ << ",\n";
+    if (event.is_beginning_) {
+      serialized_event << " \"ph\": \"b\",\n";
+      serialized_event << " \"args\": {\n  \"task_id\": " << event.task_id_
+                       << "\n }";
+    } else {
+      serialized_event << " \"ph\": \"e\"";
+    }
+  } else if (event.is_beginning_) {
     std::unordered_map<std::string, int> int_args;
     std::unordered_map<std::string, std::string> string_args;
     if (event.name_) {
@@ -168,12 +240,16 @@ std::string Tracer::serializeEvent(const TracerEvent& event) {
 }
 
 // fix occasional cases with zero duration events
-void Tracer::linearizeEvents() {
+void Tracer::linearizeEvents(std::vector<TracerEvent>& events) {
   std::unordered_map<long, long> time_offsets;
   std::unordered_map<long, long> last_times;
   std::hash<std::thread::id> hasher;
   const long time_eps = 1; // us
-  for (auto& event : events_) {
+  for (auto& event : events) {
+    // queueing events are recorded out of order and may overlap
+    if (event.is_queueing_) {
+      continue;
+    }
     long tid =
         (event.thread_label_ >= 0) ? event.thread_label_ : hasher(event.tid_);
     auto event_ts = event.timestamp_;
@@ -202,13 +278,13 @@ void Tracer::linearizeEvents() {
   }
 }
 
-void Tracer::renameThreads() {
+void Tracer::renameThreads(std::vector<TracerEvent>& events) {
   std::unordered_map<long, int> tids;
   std::unordered_map<int, int> numa_counters;
   std::unordered_map<long, int> tid_to_numa;
   std::hash<std::thread::id> hasher;
   const long numa_multiplier = 10e9;
-  for (auto& event : events_) {
+  for (auto& event : events) {
     if (event.thread_label_ >= 0 || event.op_id_ < 0) {
       continue;
     }
@@ -247,22 +323,100 @@ int Tracer::bumpIter() {
   return iter_++;
 }
 
-Tracer::~Tracer() {
-  if (events_.empty() || filename_.empty()) {
+bool Tracer::takeRequest() {
+  auto requests = trace_requests.load();
+  if (requests == seen_requests_) {
+    return false;
+  }
+  seen_requests_ = requests;
+  return true;
+}
+
+void Tracer::flushIter(int iter) {
+  std::vector<TracerEvent> events;
+  {
+    std::lock_guard<std::mutex> lock(tracer_mutex_);
+    events.swap(events_);
+  }
+  if (events.empty()) {
     return;
   }
-  linearizeEvents();
-  renameThreads();
+  {
+    std::lock_guard<std::mutex> lock(writer_mutex_);
+    pending_.emplace_back(iter, std::move(events));
+  }
+  writer_cv_.notify_one();
+}
+
+std::string Tracer::serializeIter(std::vector<TracerEvent>& events) {
+  linearizeEvents(events);
+  renameThreads(events);
+
+  std::vector<TracerEvent> stream_events;
+  std::map<long, std::string> stream_lanes;
+  for (const auto& event : events) {
+    if (event.op_id_ < 0 || event.stream_id_ < 0 || event.is_queueing_) {
+      continue;
+    }
+    const auto& device_option =
+        net_->GetOperators().at(event.op_id_)->device_option();
+    if (device_option.device_type() != CUDA) {
+      continue;
+    }
+    auto device_id = DeviceId(device_option);
+    auto lane = kStreamLaneBase + device_id * kStreamsPerDevice +
+        event.stream_id_;
+    stream_lanes[lane] = "GPU " + caffe2::to_string(device_id) + " stream " +
+        caffe2::to_string(event.stream_id_);
+    stream_events.push_back(event);
+    stream_events.back().thread_label_ = lane;
+  }
+
   std::stringstream serialized;
   serialized << "[\n";
-  for (auto idx = 0; idx < events_.size(); ++idx) {
-    serialized << serializeEvent(events_[idx]);
-    if (idx != events_.size() - 1) {
+  for (const auto& kv : stream_lanes) {
+    serialized << "{\n \"name\": \"thread_name\",\n \"ph\": \"M\",\n"
+               << " \"pid\": 0,\n \"tid\": " << kv.first << ",\n"
+               << " \"args\": {\n  \"name\": \"" << kv.second << "\"\n }\n},\n";
+  }
+  events.insert(events.end(), stream_events.begin(), stream_events.end());
+  for (auto idx = 0; idx < events.size(); ++idx) {
+    serialized << serializeEvent(events[idx]);
+    if (idx != events.size() - 1) {
       serialized << ",\n";
     }
   }
   serialized << "\n]\n";
-  WriteStringToFile(serialized.str(), filename_.c_str());
+  return serialized.str();
+}
+
+void Tracer::writerLoop() {
+  std::unique_lock<std::mutex> lock(writer_mutex_);
+  while (true) {
+    writer_cv_.wait(lock, [this]() { return stop_writer_ || !pending_.empty(); });
+    if (pending_.empty()) {
+      return;
+    }
+    auto iter_events = std::move(pending_.front());
+    pending_.pop_front();
+    lock.unlock();
+    auto filename =
+        filename_ + "_" + caffe2::to_string(iter_events.first) + ".json";
+    WriteStringToFile(serializeIter(iter_events.second), filename.c_str());
+    lock.lock();
+  }
+}
+
+Tracer::~Tracer() {
+  if (traced_iter_ >= 0) {
+    flushIter(traced_iter_);
+  }
+  {
+    std::lock_guard<std::mutex> lock(writer_mutex_);
+    stop_writer_ = true;
+  }
+  writer_cv_.notify_one();
+  writer_.join();
 }
 
 void TracerGuard::init(Tracer* tracer) {
@@ -338,6 +492,9 @@ std::shared_ptr<Tracer> create(
     const NetBase* net,
     const std::string& net_name) {
   bool trace_net = isTraceableNet(net_name);
+  if (trace_net && FLAGS_caffe2_net_async_tracing_on_signal) {
+    installTraceRequestHandler();
+  }
   return trace_net ? std::make_shared<Tracer>(net, net_name) : nullptr;
 }
 
@@ -346,7 +503,14 @@ bool startIter(const std::shared_ptr<Tracer>& tracer) {
     return false;
   }
   auto iter = tracer->bumpIter();
-  auto is_enabled = iter % FLAGS_caffe2_net_async_tracing_nth == 0;
+  // the previous run is over, hand its events to the writer
+  if (tracer->traced_iter_ >= 0) {
+    tracer->flushIter(tracer->traced_iter_);
+  }
+  auto is_enabled = tracer->takeRequest() ||
+      (FLAGS_caffe2_net_async_tracing_nth > 0 &&
+       iter % FLAGS_caffe2_net_async_tracing_nth == 0);
+  tracer->traced_iter_ = is_enabled ? iter : -1;
   tracer->setEnabled(is_enabled);
   return is_enabled;
 }
@@ -22,9 +22,14 @@
 #include "caffe2/core/operator.h"
 #include "caffe2/core/timer.h"
 
+#include <condition_variable>
+#include <deque>
+#include <thread>
+
 CAFFE2_DECLARE_string(caffe2_net_async_tracing_filepath);
 CAFFE2_DECLARE_string(caffe2_net_async_names_to_trace);
 CAFFE2_DECLARE_int(caffe2_net_async_tracing_nth);
+CAFFE2_DECLARE_bool(caffe2_net_async_tracing_on_signal);
 
 namespace caffe2 {
 namespace tracing {
@@ -39,6 +44,8 @@ struct TracerEvent {
   bool is_beginning_ = false;
   long thread_label_ = -1;
   std::thread::id tid_;
+  // Time task_id_ waited in the thread pool, as a Chrome async event
+  bool is_queueing_ = false;
 };
 
 enum TracingField {
@@ -50,23 +57,45 @@ enum TracingField {
   TRACE_CATEGORY,
 };
 
+// Records the events of sampled iterations of a net: every
+// caffe2_net_async_tracing_nth iteration, and the next one after each
+// requestTrace(). When the next iteration starts, the events of a traced
+// iteration are handed to a writer thread, which writes them to
+// <caffe2_net_async_tracing_filepath>/<net name>_<iteration>.json in the
+// Chrome trace format, so that the net only pays for recording them.
+//
+// Operators appear on the lane of the thread that ran them and, for GPU
+// operators, on the lane of their stream. The time a task waited in the
+// thread pool between being scheduled and starting is shown as an async
+// "queue" event.
 class Tracer {
  public:
   Tracer(const NetBase* net, const std::string& net_name);
 
   void recordEvent(const TracerEvent& event);
+  // Records that task_id was scheduled at enqueue_ts and starts now
+  void recordQueueing(int task_id, long enqueue_ts);
+  // Microseconds since the tracer was created
+  long timestamp();
   std::string opTraceName(const OperatorBase* op);
   std::string opBlobsInfo(const OperatorBase& op);
   std::string serializeEvent(const TracerEvent& event);
-  void linearizeEvents();
-  void renameThreads();
+  void linearizeEvents(std::vector<TracerEvent>& events);
+  void renameThreads(std::vector<TracerEvent>& events);
   void setEnabled(bool enabled);
   bool isEnabled() const;
   int bumpIter();
+  // Whether requestTrace() was called since the last call
+  bool takeRequest();
+  // Queues the events recorded so far, as iteration iter, for writing
+  void flushIter(int iter);
 
   virtual ~Tracer();
 
  private:
+  std::string serializeIter(std::vector<TracerEvent>& events);
+  void writerLoop();
+
   const NetBase* net_ = nullptr;
   std::string filename_;
   std::vector<TracerEvent> events_;
@@ -74,8 +103,18 @@ class Tracer {
   bool enabled_ = false;
   Timer timer_;
   int iter_;
+  // The iteration whose events are being recorded, -1 if none
+  int traced_iter_ = -1;
+  int seen_requests_ = 0;
+
+  std::thread writer_;
+  std::mutex writer_mutex_;
+  std::condition_variable writer_cv_;
+  std::deque<std::pair<int, std::vector<TracerEvent>>> pending_;
+  bool stop_writer_ = false;
 
   friend class TracerGuard;
+  friend bool startIter(const std::shared_ptr<Tracer>& tracer);
 };
 
 class TracerGuard {
@@ -106,6 +145,10 @@ class TracerGuard {
 
 bool isTraceableNet(const std::string& net_name);
 
+// Makes every traced net trace its next iteration. Also called on SIGUSR2
+// with caffe2_net_async_tracing_on_signal.
+void requestTrace();
+
 std::shared_ptr<Tracer> create(const NetBase* net, const std::string& net_name);
 bool startIter(const std::shared_ptr<Tracer>& tracer);
 
@@ -1,5 +1,6 @@
 #include "caffe2/core/net_dag.h"
 
+#include <algorithm>
 #include <iostream>
 #include <set>
 #include <stack>
@@ -56,6 +57,11 @@ DAGNetBase::DAGNetBase(
       initial_frontier_.push_back(idx);
     }
   }
+  if (FLAGS_caffe2_net_critical_path_priority) {
+    critical_paths_ = dag_utils::computeCriticalPaths(
+        operator_nodes_, dag_utils::estimateOperatorCosts(*net_def, ws));
+    sortByCriticalPath(initial_frontier_);
+  }
   // Finally, start the workers.
   int num_workers = net_def->has_num_workers() ? net_def->num_workers() : 1;
   CAFFE_ENFORCE(num_workers > 0, "Must have a positive number of workers.");
@@ -199,6 +205,15 @@ void DAGNetBase::HandleException(
 #endif // CAFFE2_USE_EXCEPTION_PTR
 }
 
+void DAGNetBase::sortByCriticalPath(std::vector<int>& chain_ids) const {
+  if (critical_paths_.empty()) {
+    return;
+  }
+  std::stable_sort(chain_ids.begin(), chain_ids.end(), [this](int a, int b) {
+    return critical_paths_[a] > critical_paths_[b];
+  });
+}
+
 void DAGNetBase::WorkerFunction() {
   // WorkerFunctions() is an infinite loop until there are no more jobs to run.
   while (true) {
@@ -272,6 +287,8 @@ void DAGNetBase::WorkerFunction() {
       }
     }
 
+    sortByCriticalPath(chains_to_queue);
+
     // Notify the caller of Run
     {
       std::unique_lock<std::mutex> mutex_lock(remaining_ops_mutex_);
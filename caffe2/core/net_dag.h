@@ -54,11 +54,16 @@ class DAGNetBase : public NetBase {
 
   virtual bool RunAt(int chain_id, const std::vector<int>& chain) = 0;
   void HandleException(int operator_idx, const std::string& exception_str);
+  // Orders ready chains by decreasing critical path
+  void sortByCriticalPath(std::vector<int>& chain_ids) const;
 
   vector<dag_utils::OperatorNode> operator_nodes_;
   vector<OperatorBase*> operators_;
   dag_utils::ExecutionChains execution_chains_;
   vector<int> initial_frontier_;
+  // Only with caffe2_net_critical_path_priority, see
+  // dag_utils::computeCriticalPaths
+  std::vector<uint64_t> critical_paths_;
   std::unique_ptr<SimpleQueue<int>> job_queue_;
   std::vector<std::thread> workers_;
   int num_workers_;
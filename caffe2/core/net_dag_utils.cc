@@ -11,6 +11,12 @@
 #include "caffe2/proto/caffe2.pb.h"
 #include "caffe2/utils/proto_utils.h"
 
+CAFFE2_DEFINE_bool(
+    caffe2_net_critical_path_priority,
+    false,
+    "In DAG and async nets, run ready chains with the most expensive path to "
+    "the end of the net (estimated with operator cost inference) first");
+
 namespace caffe2 {
 namespace dag_utils {
 
@@ -425,5 +431,69 @@ std::vector<OpGraphNode> prepareChainGraphNodes(
   return chain_nodes;
 }
 
+std::vector<uint64_t> estimateOperatorCosts(
+    const NetDef& net_def,
+    Workspace* ws) {
+  std::vector<uint64_t> costs(net_def.op_size(), 1);
+  NetDef net(net_def);
+  CaffeMap<string, TensorShape> shapes;
+  try {
+    const auto inferred = InferBlobShapesAndTypesFromWorkspace(ws, {&net});
+    for (const auto& shape : inferred.shapes()) {
+      if (!shape.unknown_shape()) {
+        shapes[shape.name()] = shape;
+      }
+    }
+  } catch (const std::exception& e) {
+    LOG(WARNING) << "Shape inference failed, assuming unit operator costs: "
+                 << e.what();
+    return costs;
+  }
+
+  for (int idx = 0; idx < net.op_size(); ++idx) {
+    const auto& op = net.op(idx);
+    const auto* schema = OpSchemaRegistry::Schema(op.type());
+    if (!schema || !schema->HasCostInferenceFunction()) {
+      continue;
+    }
+    std::vector<TensorShape> inputs;
+    for (const auto& input : op.input()) {
+      auto it = shapes.find(input);
+      if (it == shapes.end()) {
+        break;
+      }
+      inputs.push_back(it->second);
+    }
+    if (inputs.size() != op.input_size()) {
+      continue;
+    }
+    try {
+      auto cost = schema->InferCost(op, inputs);
+      costs[idx] = std::max<uint64_t>(
+          1, cost.flops > 0 ? cost.flops : cost.bytes_moved);
+    } catch (const std::exception& e) {
+      VLOG(1) << "Cost inference failed for " << op.type() << ": " << e.what();
+    }
+  }
+  return costs;
+}
+
+std::vector<uint64_t> computeCriticalPaths(
+    const std::vector<OperatorNode>& operator_nodes,
+    const std::vector<uint64_t>& costs) {
+  CAFFE_ENFORCE_EQ(operator_nodes.size(), costs.size());
+  // operators only depend on earlier operators
+  std::vector<uint64_t> paths(costs);
+  for (int idx = operator_nodes.size() - 1; idx >= 0; --idx) {
+    uint64_t longest_child = 0;
+    for (auto child : operator_nodes[idx].children_) {
+      CAFFE_ENFORCE_GT(child, idx);
+      longest_child = std::max(longest_child, paths[child]);
+    }
+    paths[idx] += longest_child;
+  }
+  return paths;
+}
+
 } // namespace dag_utils
 } // namespace caffe2
@@ -22,6 +22,8 @@
 #include "caffe2/proto/caffe2.pb.h"
 #include "caffe2/utils/simple_queue.h"
 
+CAFFE2_DECLARE_bool(caffe2_net_critical_path_priority);
+
 namespace caffe2 {
 namespace dag_utils {
 
@@ -54,6 +56,22 @@ std::vector<OpGraphNode> prepareChainGraphNodes(
     const std::vector<dag_utils::OperatorNode>& operator_nodes,
     const std::vector<std::vector<int>>& execution_chains);
 
+// Static estimate of the cost of every operator: the FLOPs (or, failing that,
+// the bytes moved) given by its schema's cost inference function for the
+// blob shapes inferred from the workspace. Operators without cost inference
+// or with inputs of unknown shape cost 1.
+std::vector<uint64_t> estimateOperatorCosts(
+    const NetDef& net_def,
+    Workspace* ws);
+
+// For every operator, the total cost of the most expensive path from the
+// operator (included) to the end of the net. With
+// caffe2_net_critical_path_priority, DAG and async nets use it to run the
+// ready chains on the critical path first.
+std::vector<uint64_t> computeCriticalPaths(
+    const std::vector<OperatorNode>& operator_nodes,
+    const std::vector<uint64_t>& costs);
+
 } // namespace dag_utils
 } // namespace caffe2
 
@@ -0,0 +1,71 @@
+#include "caffe2/core/net_static.h"
+
+#include "caffe2/core/operator.h"
+#include "caffe2/core/static_tracepoint.h"
+#include "caffe2/proto/caffe2.pb.h"
+#include "caffe2/utils/proto_utils.h"
+
+namespace caffe2 {
+
+StaticSimpleNet::StaticSimpleNet(
+    const std::shared_ptr<const NetDef>& net_def,
+    Workspace* ws)
+    : SimpleNet(net_def, ws) {
+  VLOG(1) << "Constructing StaticSimpleNet " << net_def->name();
+  sync_after_.resize(operators_.size());
+  for (int idx = 0; idx < operators_.size(); ++idx) {
+    auto* op = operators_[idx].get();
+    const auto& device_option = op->device_option();
+    // The work of CUDA operators on the same device is ordered by the stream
+    // they share, so that only the last of them needs to be waited for
+    const bool last_on_device = idx + 1 == operators_.size() ||
+        !IsSameDevice(device_option, operators_[idx + 1]->device_option());
+    sync_after_[idx] = op->HasAsyncPart() &&
+        (last_on_device || device_option.device_type() != CUDA);
+    if (!sync_after_[idx]) {
+      op->DisableEvent();
+    }
+  }
+}
+
+bool StaticSimpleNet::Run() {
+  StartAllObservers();
+  for (int idx = 0; idx < operators_.size(); ++idx) {
+    auto* op = operators_[idx].get();
+#ifdef CAFFE2_ENABLE_SDT
+    const auto& op_name = op->debug_def().name().c_str();
+    const auto& op_type = op->debug_def().type().c_str();
+    const auto& net_name = name_.c_str();
+    CAFFE_SDT(operator_start, net_name, op_name, op_type, op);
+#endif
+    bool res;
+    if (op->NumObservers() > 0) {
+      res = op->Run();
+    } else if (sync_after_[idx]) {
+      op->ResetEvent();
+      res = op->RunAsync();
+      if (res) {
+        op->Finish();
+        res = op->event().Query() == EventStatus::EVENT_SUCCESS;
+        if (!res) {
+          LOG(ERROR) << "Device error: " << op->event().ErrorMessage();
+        }
+      }
+    } else {
+      res = op->RunAsync();
+    }
+#ifdef CAFFE2_ENABLE_SDT
+    CAFFE_SDT(operator_done, net_name, op_name, op_type, op);
+#endif
+    if (!res) {
+      LOG(ERROR) << "Operator failed: " << ProtoDebugString(op->debug_def());
+      return false;
+    }
+  }
+  StopAllObservers();
+  return true;
+}
+
+REGISTER_NET(static_simple, StaticSimpleNet);
+
+} // namespace caffe2
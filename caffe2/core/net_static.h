@@ -0,0 +1,37 @@
+#ifndef CAFFE2_CORE_NET_STATIC_H_
+#define CAFFE2_CORE_NET_STATIC_H_
+
+#include <vector>
+
+#include "caffe2/core/common.h"
+#include "caffe2/core/net_simple.h"
+#include "caffe2/core/workspace.h"
+#include "caffe2/proto/caffe2.pb.h"
+
+namespace caffe2 {
+
+// A SimpleNet with less fixed cost per operator, for nets of many tiny
+// operators. The operators run in sequence with RunAsync(), so they neither
+// wait for their device to finish nor go through their (empty) observer
+// lists, and the device is waited for only where the net needs it: after the
+// last operator of each run of CUDA operators on the same device, which share
+// a stream, and after any other operator with an async part. Only the
+// operators waited on keep their events; the others have them disabled.
+// Operators with observers attached run with Run(), which waits for the
+// device, so that the observers time the work done on the device.
+class StaticSimpleNet : public SimpleNet {
+ public:
+  StaticSimpleNet(const std::shared_ptr<const NetDef>& net_def, Workspace* ws);
+
+ protected:
+  bool Run() override;
+
+  // Whether the device of each operator has to finish after it
+  std::vector<bool> sync_after_;
+
+  DISABLE_COPY_AND_ASSIGN(StaticSimpleNet);
+};
+
+} // namespace caffe2
+
+#endif // CAFFE2_CORE_NET_STATIC_H_
@@ -7,7 +7,11 @@
 
 #include <google/protobuf/text_format.h>
 
+#include <mutex>
+
 CAFFE2_DECLARE_bool(caffe2_disable_chaining);
+CAFFE2_DECLARE_bool(caffe2_net_async_work_stealing);
+CAFFE2_DECLARE_bool(caffe2_net_critical_path_priority);
 
 namespace caffe2 {
 
@@ -61,6 +65,40 @@ OPERATOR_SCHEMA(NetTestDummy2)
     .NumOutputs(0, INT_MAX)
     .AllowInplace({{1, 0}});
 
+// Records its "flops" argument, which is also its cost as given by cost
+// inference, when run.
+static std::mutex costly_mutex;
+static std::vector<int> costly_runs;
+
+class NetTestCostlyOp final : public OperatorBase {
+ public:
+  NetTestCostlyOp(const OperatorDef& operator_def, Workspace* ws)
+      : OperatorBase(operator_def, ws),
+        flops_(OperatorBase::GetSingleArgument<int>("flops", 1)) {}
+
+  bool Run(int /* unused */ /*stream_id*/) override {
+    std::lock_guard<std::mutex> guard(costly_mutex);
+    costly_runs.push_back(flops_);
+    return true;
+  }
+
+ protected:
+  const int flops_;
+};
+
+REGISTER_CPU_OPERATOR(NetTestCostly, NetTestCostlyOp);
+
+OPERATOR_SCHEMA(NetTestCostly)
+    .NumInputs(1)
+    .NumOutputs(1)
+    .IdenticalTypeAndShape()
+    .CostInferenceFunction([](const OperatorDef& def,
+                              const vector<TensorShape>& /* unused */) {
+      OpSchema::Cost cost;
+      cost.flops = ArgumentHelper(def).GetSingleArgument<int>("flops", 1);
+      return cost;
+    });
+
 unique_ptr<NetBase> CreateNetTestHelper(
     Workspace* ws,
     const vector<string>& input,
@@ -585,6 +623,54 @@ TEST(NetTest, FailingOperator) {
   }
 }
 
+TEST(NetTest, StaticSimpleNet) {
+  const auto spec = R"DOC(
+        name: "example"
+        type: "static_simple"
+        external_input: "in"
+        op {
+          input: "in"
+          output: "hidden"
+          type: "NetTestDummy"
+        }
+        op {
+          input: "hidden"
+          output: "out"
+          type: "NetTestDummy"
+        }
+)DOC";
+
+  Workspace ws;
+  ws.CreateBlob("in");
+
+  NetDef net_def;
+  CAFFE_ENFORCE(
+      ::google::protobuf::TextFormat::ParseFromString(spec, &net_def));
+
+  {
+    std::unique_ptr<NetBase> net(CreateNet(net_def, &ws));
+    // CPU operators without async parts are never waited for
+    for (auto* op : net->GetOperators()) {
+      ASSERT_TRUE(op->IsEventDisabled());
+    }
+    for (int i = 0; i < 10; i++) {
+      counter.exchange(0);
+      ASSERT_TRUE(net->Run());
+      ASSERT_EQ(2, counter.load());
+    }
+  }
+
+  auto* arg = net_def.mutable_op(0)->add_arg();
+  arg->set_name("fail");
+  arg->set_i(1);
+  {
+    std::unique_ptr<NetBase> net(CreateNet(net_def, &ws));
+    counter.exchange(0);
+    ASSERT_FALSE(net->Run());
+    ASSERT_EQ(0, counter.load());
+  }
+}
+
 const int kTestPoolSize = 4;
 
 class ExecutorHelperDummyOp final : public OperatorBase {
@@ -720,4 +806,134 @@ TEST(NetTest, AsyncEmptyNet) {
   }
 }
 
+TEST(NetTest, AsyncWorkStealing) {
+  // b and c are scheduled from a's pool thread, d from b's or c's
+  const auto spec = R"DOC(
+        name: "example"
+        type: "async_scheduling"
+        num_workers: 3
+        external_input: "in"
+        op {
+          input: "in"
+          output: "a"
+          type: "NetTestDummy"
+        }
+        op {
+          input: "a"
+          output: "b"
+          type: "NetTestDummy"
+        }
+        op {
+          input: "a"
+          output: "c"
+          type: "NetTestDummy"
+        }
+        op {
+          input: "b"
+          input: "c"
+          output: "d"
+          type: "NetTestDummy"
+        }
+)DOC";
+
+  auto old_stealing = FLAGS_caffe2_net_async_work_stealing;
+  auto g = MakeGuard(
+      [&]() { FLAGS_caffe2_net_async_work_stealing = old_stealing; });
+  FLAGS_caffe2_net_async_work_stealing = true;
+
+  Workspace ws;
+  ws.CreateBlob("in");
+  NetDef net_def;
+  CAFFE_ENFORCE(
+      ::google::protobuf::TextFormat::ParseFromString(spec, &net_def));
+  std::unique_ptr<NetBase> net(CreateNet(net_def, &ws));
+  counter = 0;
+  for (int i = 0; i < 20; ++i) {
+    ASSERT_TRUE(net->Run());
+  }
+  ASSERT_EQ(counter.load(), 80);
+}
+
+namespace {
+// op1 and op2 are on the critical path, although op0 comes first
+const auto kCriticalPathSpec = R"DOC(
+        name: "example"
+        num_workers: 1
+        external_input: "in"
+        op {
+          input: "in"
+          output: "a"
+          type: "NetTestCostly"
+          arg {
+            name: "flops"
+            i: 1
+          }
+        }
+        op {
+          input: "in"
+          output: "b"
+          type: "NetTestCostly"
+          arg {
+            name: "flops"
+            i: 100
+          }
+        }
+        op {
+          input: "b"
+          output: "c"
+          type: "NetTestCostly"
+          arg {
+            name: "flops"
+            i: 10
+          }
+        }
+        op {
+          input: "a"
+          input: "c"
+          output: "d"
+          type: "NetTestDummy"
+        }
+)DOC";
+
+void testCriticalPathOrder(const std::string& net_type) {
+  auto old_priority = FLAGS_caffe2_net_critical_path_priority;
+  auto g = MakeGuard(
+      [&]() { FLAGS_caffe2_net_critical_path_priority = old_priority; });
+  FLAGS_caffe2_net_critical_path_priority = true;
+
+  Workspace ws;
+  ws.CreateBlob("in")->GetMutable<TensorCPU>()->Resize(2, 3);
+  NetDef net_def;
+  CAFFE_ENFORCE(::google::protobuf::TextFormat::ParseFromString(
+      kCriticalPathSpec, &net_def));
+  net_def.set_type(net_type);
+  std::unique_ptr<NetBase> net(CreateNet(net_def, &ws));
+  costly_runs.clear();
+  ASSERT_TRUE(net->Run());
+  ASSERT_EQ(costly_runs, std::vector<int>({100, 10, 1}));
+}
+} // namespace
+
+TEST(NetTest, CriticalPaths) {
+  Workspace ws;
+  ws.CreateBlob("in")->GetMutable<TensorCPU>()->Resize(2, 3);
+  auto net_def = std::make_shared<NetDef>();
+  CAFFE_ENFORCE(::google::protobuf::TextFormat::ParseFromString(
+      kCriticalPathSpec, net_def.get()));
+  const auto costs = dag_utils::estimateOperatorCosts(*net_def, &ws);
+  ASSERT_EQ(costs, std::vector<uint64_t>({1, 100, 10, 1}));
+  const auto nodes = dag_utils::prepareOperatorNodes(net_def, &ws);
+  ASSERT_EQ(
+      dag_utils::computeCriticalPaths(nodes, costs),
+      std::vector<uint64_t>({2, 111, 11, 1}));
+}
+
+TEST(NetTest, CriticalPathPriorityDAG) {
+  testCriticalPathOrder("dag");
+}
+
+TEST(NetTest, CriticalPathPriorityAsyncScheduling) {
+  testCriticalPathOrder("async_scheduling");
+}
+
 } // namespace caffe2
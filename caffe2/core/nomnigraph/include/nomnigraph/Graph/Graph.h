@@ -17,6 +17,7 @@
 #include <algorithm>
 #include <iterator>
 #include <list>
+#include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
@@ -196,6 +197,8 @@ class Subgraph {
 /// \brief A simple graph implementation
 ///
 /// Everything is owned by the graph to simplify storage concerns.
+/// Nodes and edges are indexed by reference, so that deleting, importing
+/// or looking them up takes constant time even on large graphs.
 ///
 template <typename T, typename U /* optional */>
 class Graph {
@@ -219,27 +222,39 @@ class Graph {
   NodeRef createNode(T&& data) {
     Nodes.emplace_back(Node<T, U>(std::move(data)));
     DEBUG_PRINT("Creating node (%p)\n", &Nodes.back());
-    return &Nodes.back();
+    return indexNode();
   }
 
   void importNode(NodeRef node, Graph<T, U>& otherGraph) {
-    std::list<Node<T, U>>& otherNodes = otherGraph.Nodes;
-    for (auto it = Nodes.begin(); it != Nodes.end(); ++it) {
-      if (&(*it) == node) {
-        otherNodes.splice(otherNodes.end(), Nodes, it, ++it);
-        break;
-      }
+    auto it = NodeIndex.find(node);
+    if (it == NodeIndex.end()) {
+      return;
     }
+    std::list<Node<T, U>>& otherNodes = otherGraph.Nodes;
+    otherNodes.splice(otherNodes.end(), Nodes, it->second);
+    otherGraph.NodeIndex.emplace(node, it->second);
+    NodeIndex.erase(it);
   }
 
   void importEdge(EdgeRef edge, Graph<T, U>& otherGraph) {
-    std::list<Edge<T, U>>& otherEdges = otherGraph.Edges;
-    for (auto it = Edges.begin(); it != Edges.end(); ++it) {
-      if (&(*it) == edge) {
-        otherEdges.splice(otherEdges.end(), Edges, it, ++it);
-        break;
-      }
+    auto it = EdgeIndex.find(edge);
+    if (it == EdgeIndex.end()) {
+      return;
     }
+    std::list<Edge<T, U>>& otherEdges = otherGraph.Edges;
+    otherEdges.splice(otherEdges.end(), Edges, it->second);
+    otherGraph.EdgeIndex.emplace(edge, it->second);
+    EdgeIndex.erase(it);
+  }
+
+  /// \brief Whether \p n is a node of this graph.
+  bool hasNode(NodeRef n) const {
+    return NodeIndex.count(n) != 0;
+  }
+
+  /// \brief Whether \p e is an edge of this graph.
+  bool hasEdge(EdgeRef e) const {
+    return EdgeIndex.count(e) != 0;
   }
 
   void swapNodes(NodeRef n1, NodeRef n2) {
@@ -271,7 +286,7 @@ class Graph {
   NodeRef createNode() {
     Nodes.emplace_back(Node<T, U>());
     DEBUG_PRINT("Creating node (%p)\n", &Nodes.back());
-    return &Nodes.back();
+    return indexNode();
   }
 
   /// \brief Replace a node in the graph with a generic
@@ -311,7 +326,7 @@ class Graph {
   EdgeRef createEdge(NodeRef tail, NodeRef head) {
     DEBUG_PRINT("Creating edge (%p -> %p)\n", tail, head);
     Edges.emplace_back(Edge<T, U>(tail, head));
-    EdgeRef e = &Edges.back();
+    EdgeRef e = indexEdge();
     head->addInEdge(e);
     tail->addOutEdge(e);
     return e;
@@ -320,7 +335,7 @@ class Graph {
   EdgeRef createEdge(NodeRef tail, NodeRef head, U&& data) {
     DEBUG_PRINT("Creating edge (%p -> %p)\n", tail, head);
     Edges.emplace_back(Edge<T, U>(tail, head, std::move(data)));
-    EdgeRef e = &Edges.back();
+    EdgeRef e = indexEdge();
     head->addInEdge(e);
     tail->addOutEdge(e);
     return e;
@@ -353,11 +368,10 @@ class Graph {
         deleteEdge(edge);
       }
     }
-    for (auto i = Nodes.begin(); i != Nodes.end(); ++i) {
-      if (&*i == n) {
-        Nodes.erase(i);
-        break;
-      }
+    auto it = NodeIndex.find(n);
+    if (it != NodeIndex.end()) {
+      Nodes.erase(it->second);
+      NodeIndex.erase(it);
     }
   }
 
@@ -368,11 +382,10 @@ class Graph {
       e->Tail->removeOutEdge(e);
       e->Head->removeInEdge(e);
     }
-    for (auto i = Edges.begin(); i != Edges.end(); ++i) {
-      if (&*i == e) {
-        Edges.erase(i);
-        break;
-      }
+    auto it = EdgeIndex.find(e);
+    if (it != EdgeIndex.end()) {
+      Edges.erase(it->second);
+      EdgeIndex.erase(it);
     }
   }
 
@@ -407,8 +420,25 @@ class Graph {
   }
 
  private:
+  NodeRef indexNode() {
+    NodeRef n = &Nodes.back();
+    NodeIndex.emplace(n, std::prev(Nodes.end()));
+    return n;
+  }
+
+  EdgeRef indexEdge() {
+    EdgeRef e = &Edges.back();
+    EdgeIndex.emplace(e, std::prev(Edges.end()));
+    return e;
+  }
+
   std::list<Node<T, U>> Nodes;
   std::list<Edge<T, U>> Edges;
+  // std::list iterators stay valid across splices and moves of the lists
+  std::unordered_map<NodeRef, typename std::list<Node<T, U>>::iterator>
+      NodeIndex;
+  std::unordered_map<EdgeRef, typename std::list<Edge<T, U>>::iterator>
+      EdgeIndex;
 };
 
 } // namespace nom
@@ -14,6 +14,8 @@
 #include "nomnigraph/Graph/Algorithms.h"
 
 #include <algorithm>
+#include <functional>
+#include <unordered_set>
 #include <vector>
 
 namespace nom {
@@ -48,52 +50,109 @@ class Match {
       typename G::NodeRef candidateNode,
       std::vector<typename G::NodeRef> stack,
       SubgraphType currentSubgraph) {
-    if (EqualityClass::equal(stack.back(), candidateNode)) {
-      currentSubgraph.addNode(candidateNode);
+    std::vector<SubgraphType> matchingSubgraphs;
+    accumulateMatches(
+        candidateNode, &stack, &currentSubgraph, &matchingSubgraphs);
+    return matchingSubgraphs;
+  }
 
-      // Base case
-      if (stack.size() == MatchNodeList.size()) {
-        return std::vector<SubgraphType>{currentSubgraph};
-      }
+  std::vector<SubgraphType> match(G& g) {
+    return match(g.getMutableNodes());
+  }
 
-      // Recurse and accumulate matches
-      stack.emplace_back(MatchNodeList.at(stack.size()));
+  /// \brief Matches anchored at the given candidate nodes only.
+  ///
+  /// Callers that index their graph (e.g. by operator type) pass the nodes
+  /// that can match the first node of the pattern, which skips trying every
+  /// node of a large graph as the anchor.
+  std::vector<SubgraphType> match(
+      const std::vector<typename G::NodeRef>& anchors) {
+    std::vector<SubgraphType> out;
+    if (MatchNodeList.empty()) {
+      return out;
+    }
 
-      std::vector<SubgraphType> matchingSubgraphs;
-      for (auto outEdge : candidateNode->getOutEdges()) {
-        for (auto subgraph :
-             recursiveMatch(outEdge->head(), stack, currentSubgraph)) {
-          matchingSubgraphs.emplace_back(subgraph);
-        }
-      }
-      return matchingSubgraphs;
+    std::vector<typename G::NodeRef> stack;
+    SubgraphType currentSubgraph;
+    for (auto n : anchors) {
+      stack.assign(1, MatchNodeList.front());
+      accumulateMatches(n, &stack, &currentSubgraph, &out);
     }
 
-    // No match here, early bailout
-    return std::vector<SubgraphType>{};
+    return out;
   }
 
-  std::vector<SubgraphType> match(G& g) {
-    std::vector<SubgraphType> out;
-
-    std::vector<typename G::NodeRef> stack;
-    stack.emplace_back(MatchNodeList.front());
+ private:
+  // Extends the match in place and undoes the extension on the way back, so
+  // that the expansion does not copy the partial match at every step.
+  void accumulateMatches(
+      typename G::NodeRef candidateNode,
+      std::vector<typename G::NodeRef>* stack,
+      SubgraphType* currentSubgraph,
+      std::vector<SubgraphType>* matchingSubgraphs) {
+    if (!EqualityClass::equal(stack->back(), candidateNode)) {
+      // No match here, early bailout
+      return;
+    }
+    const bool added = !currentSubgraph->hasNode(candidateNode);
+    currentSubgraph->addNode(candidateNode);
 
-    // Try each node in the candidate graph as the anchor.
-    for (auto n : g.getMutableNodes()) {
-      for (auto subgraph : recursiveMatch(n, stack, SubgraphType())) {
-        out.emplace_back(subgraph);
+    if (stack->size() == MatchNodeList.size()) {
+      // Base case
+      matchingSubgraphs->emplace_back(*currentSubgraph);
+    } else {
+      // Recurse and accumulate matches
+      stack->emplace_back(MatchNodeList.at(stack->size()));
+      for (auto outEdge : candidateNode->getOutEdges()) {
+        accumulateMatches(
+            outEdge->head(), stack, currentSubgraph, matchingSubgraphs);
       }
+      stack->pop_back();
     }
 
-    return out;
+    if (added) {
+      currentSubgraph->removeNode(candidateNode);
+    }
   }
 
- private:
   G& MatchGraph;
   std::vector<typename G::NodeRef> MatchNodeList;
 };
 
+/// \brief Applies \p rewrite to a batch of matches found up front.
+///
+/// Finding every match before rewriting lets a pass make a single sweep over
+/// the graph instead of restarting the search after each rewrite. A match
+/// that shares a node with a match rewritten before it is skipped, since that
+/// node may have been changed or deleted; \p rewrite must therefore only
+/// delete nodes of its own match, and returns whether it rewrote it.
+///
+/// \return The number of matches rewritten.
+template <typename G>
+size_t rewriteMatches(
+    const std::vector<Subgraph<typename G::NodeType, typename G::EdgeType>>&
+        matches,
+    std::function<bool(
+        const Subgraph<typename G::NodeType, typename G::EdgeType>&)> rewrite) {
+  std::unordered_set<typename G::NodeRef> consumed;
+  size_t count = 0;
+  for (const auto& match : matches) {
+    bool overlaps = false;
+    for (auto node : match.getNodes()) {
+      if (consumed.count(node)) {
+        overlaps = true;
+        break;
+      }
+    }
+    if (overlaps || !rewrite(match)) {
+      continue;
+    }
+    consumed.insert(match.getNodes().begin(), match.getNodes().end());
+    ++count;
+  }
+  return count;
+}
+
 } // namespace nom
 
 #endif // NOM_TRANFORMATIONS_MATCH_H
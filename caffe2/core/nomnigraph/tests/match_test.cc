@@ -35,3 +35,60 @@ TEST(Match, Basic) {
   nom::Match<decltype(graph)> m(match_graph);
   EXPECT_EQ(m.match(graph).size(), 1);
 }
+
+TEST(Match, Anchored) {
+  nom::Graph<std::string> graph;
+  auto a1 = graph.createNode(std::string("1"));
+  auto a2 = graph.createNode(std::string("2"));
+  auto b1 = graph.createNode(std::string("1"));
+  auto b2 = graph.createNode(std::string("2"));
+  graph.createEdge(a1, a2);
+  graph.createEdge(b1, b2);
+
+  nom::Graph<std::string> match_graph;
+  auto m1 = match_graph.createNode(std::string("1"));
+  auto m2 = match_graph.createNode(std::string("2"));
+  match_graph.createEdge(m1, m2);
+
+  nom::Match<decltype(graph)> m(match_graph);
+  EXPECT_EQ(m.match(graph).size(), 2);
+  auto matches = m.match({b1});
+  EXPECT_EQ(matches.size(), 1);
+  EXPECT_TRUE(matches.front().hasNode(b1));
+  EXPECT_TRUE(matches.front().hasNode(b2));
+  EXPECT_EQ(m.match({a2, b2}).size(), 0);
+}
+
+TEST(Match, RewriteMatches) {
+  nom::Graph<std::string> graph;
+  auto n1 = graph.createNode(std::string("1"));
+  auto n2 = graph.createNode(std::string("2"));
+  auto n3 = graph.createNode(std::string("3"));
+  graph.createEdge(n1, n2);
+  graph.createEdge(n2, n3);
+
+  using SubgraphType = nom::Subgraph<std::string, std::string>;
+  SubgraphType s12, s23, s3;
+  s12.addNode(n1);
+  s12.addNode(n2);
+  s23.addNode(n2);
+  s23.addNode(n3);
+  s3.addNode(n3);
+
+  // s23 overlaps with the rewritten s12 and is skipped
+  std::vector<SubgraphType> rewritten;
+  auto count = nom::rewriteMatches<decltype(graph)>(
+      {s12, s23, s3}, [&](const SubgraphType& s) {
+        if (s.hasNode(n2)) {
+          graph.deleteNode(n2);
+        }
+        rewritten.emplace_back(s);
+        return true;
+      });
+  EXPECT_EQ(count, 2);
+  EXPECT_EQ(rewritten.size(), 2);
+  EXPECT_FALSE(graph.hasNode(n2));
+  EXPECT_TRUE(graph.hasNode(n3));
+  EXPECT_EQ(graph.getMutableNodes().size(), 2);
+  EXPECT_EQ(graph.getMutableEdges().size(), 0);
+}
@@ -13,6 +13,22 @@ CAFFE2_DEFINE_bool(
 
 namespace caffe2 {
 
+namespace {
+int& allocationNUMANode() {
+  static thread_local int numa_node_id = -1;
+  return numa_node_id;
+}
+} // namespace
+
+void SetAllocationNUMANode(int numa_node_id) {
+  allocationNUMANode() = numa_node_id;
+}
+
+int GetAllocationNUMANode() {
+  const int numa_node_id = allocationNUMANode();
+  return numa_node_id >= 0 ? numa_node_id : GetCurrentNUMANode();
+}
+
 #ifdef CAFFE2_NUMA_ENABLED
 bool IsNUMAEnabled() {
   return FLAGS_caffe2_cpu_numa_enabled && numa_available() >= 0;
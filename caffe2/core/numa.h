@@ -19,6 +19,14 @@ void NUMAMove(void* ptr, size_t size, int numa_node_id);
 
 int GetCurrentNUMANode();
 
+// The NUMA node the CPU allocator places the calling thread's allocations on.
+// CPUContext sets it from DeviceOption.numa_node_id when switching to its
+// device, like CUDAContext sets the current GPU; -1 (the default) stands for
+// the node the thread is running on.
+void SetAllocationNUMANode(int numa_node_id);
+
+int GetAllocationNUMANode();
+
 } // namespace caffe2
 
 #endif // CAFFE2_CORE_NUMA_H_
@@ -266,6 +266,14 @@ class OperatorBase : public Observable<OperatorBase> {
     event_ = nullptr;
   }
 
+  // Operators whose event is never waited on can skip recording it. Async
+  // nets do this for all but the last operator of a chain: the operators of
+  // a chain run on the same stream, so the last one's event covers them all.
+  // The events of such operators stay in the initialized state.
+  void DisableEventRecording() {
+    record_event_ = false;
+  }
+
   bool IsEventDisabled() const {
     return !event_;
   }
@@ -334,6 +342,8 @@ class OperatorBase : public Observable<OperatorBase> {
 
   // An event used by asynchronous execution.
   std::unique_ptr<Event> event_;
+  // Whether RecordEvent records event_, see DisableEventRecording()
+  bool record_event_{true};
 
   DISABLE_COPY_AND_ASSIGN(OperatorBase);
 };
@@ -513,7 +523,7 @@ class Operator : public OperatorBase {
 
  protected:
   void RecordEvent(const char* err_msg = nullptr) final {
-    if (event_) {
+    if (event_ && (record_event_ || err_msg)) {
       context_.Record(event_.get(), err_msg);
     }
   }
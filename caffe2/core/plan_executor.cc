@@ -1,12 +1,18 @@
 #include "caffe2/core/plan_executor.h"
 
+#include <algorithm>
 #include <condition_variable>
+#include <deque>
 #include <memory>
 #include <mutex>
 #include <thread>
 #include <unordered_map>
 #include <vector>
 
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
 #include "caffe2/core/timer.h"
 #include "caffe2/core/workspace.h"
 #include "caffe2/proto/caffe2.pb.h"
@@ -17,6 +23,25 @@ CAFFE2_DEFINE_bool(
     "If used we will handle exceptions in executor threads. "
     "This avoids SIGABRT but may cause process to deadlock");
 
+CAFFE2_DEFINE_int(
+    caffe2_plan_executor_max_idle_threads,
+    64,
+    "The number of threads kept around to run the concurrent substeps of "
+    "later steps once their substep is done.");
+
+CAFFE2_DEFINE_bool(
+    caffe2_plan_executor_pin_threads,
+    false,
+    "If set, pins every thread running concurrent substeps to a core, "
+    "assigned round-robin in the order in which the threads are created.");
+
+CAFFE2_DEFINE_int(
+    caffe2_plan_executor_substep_timing_ms,
+    0,
+    "If positive, every that many milliseconds, steps with concurrent "
+    "substeps log the number of runs and the average and maximum run time "
+    "of each substep since the last report.");
+
 namespace caffe2 {
 
 namespace {
@@ -69,6 +94,105 @@ struct Reporter {
   bool done{false};
 };
 
+/**
+ * Runs the concurrent substeps of execution steps. Plans that run a
+ * concurrent step many times (e.g. once per epoch) would otherwise create
+ * and join a thread for every substep and instance each time.
+ *
+ * Every task gets a thread right away: an idle one if there is any, or a new
+ * one. A fixed number of threads won't do, since concurrent substeps may wait
+ * on each other (e.g. through a queue) and may have concurrent substeps of
+ * their own. Once its task is done a thread stays around for the next one,
+ * unless caffe2_plan_executor_max_idle_threads threads are already idle.
+ *
+ * The pool is never destroyed, so that idle threads don't outlive it at
+ * exit.
+ */
+class SubstepThreadPool {
+ public:
+  static SubstepThreadPool& instance() {
+    static SubstepThreadPool* pool = new SubstepThreadPool();
+    return *pool;
+  }
+
+  void run(std::function<void()> task) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    tasks_.push_back(std::move(task));
+    // Threads waiting on cv_ that haven't been woken up yet are still
+    // counted in idle_
+    if (tasks_.size() > idle_) {
+      std::thread(&SubstepThreadPool::workerLoop, this, num_threads_++)
+          .detach();
+    } else {
+      cv_.notify_one();
+    }
+  }
+
+ private:
+  SubstepThreadPool() {}
+
+  static void pinToCore(size_t index) {
+#if defined(__linux__)
+    int num_cores = std::thread::hardware_concurrency();
+    if (num_cores > 0) {
+      cpu_set_t mask;
+      CPU_ZERO(&mask);
+      CPU_SET(index % num_cores, &mask);
+      if (sched_setaffinity(0, sizeof(cpu_set_t), &mask)) {
+        LOG(WARNING) << "Could not set CPU affinity";
+      }
+    }
+#endif
+  }
+
+  void workerLoop(size_t index) {
+    if (FLAGS_caffe2_plan_executor_pin_threads) {
+      pinToCore(index);
+    }
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+      if (!tasks_.empty()) {
+        auto task = std::move(tasks_.front());
+        tasks_.pop_front();
+        lock.unlock();
+        task();
+        task = nullptr;
+        lock.lock();
+      }
+      const size_t max_idle =
+          std::max(FLAGS_caffe2_plan_executor_max_idle_threads, 0);
+      if (tasks_.empty() && idle_ >= max_idle) {
+        return;
+      }
+      ++idle_;
+      cv_.wait(lock, [this] { return !tasks_.empty(); });
+      --idle_;
+    }
+  }
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<std::function<void()>> tasks_;
+  size_t idle_{0};
+  size_t num_threads_{0};
+};
+
+// Run times of a concurrent substep since the last report, see
+// caffe2_plan_executor_substep_timing_ms
+struct SubstepTiming {
+  std::mutex mutex;
+  int64_t runs{0};
+  double total_ms{0};
+  double max_ms{0};
+
+  void add(double ms) {
+    std::lock_guard<std::mutex> lock(mutex);
+    ++runs;
+    total_ms += ms;
+    max_ms = std::max(max_ms, ms);
+  }
+};
+
 // Returns a function that returns `true` if we should continue
 // iterating, given the current iteration count.
 std::function<bool(int64_t)> getContinuationTest(
@@ -292,6 +416,7 @@ struct CompiledExecutionStep {
           reportSubsteps.push_back(compiledSubstep);
         } else {
           recurringSubsteps.push_back(compiledSubstep);
+          substepTimings.emplace_back(new SubstepTiming());
         }
       }
     } else {
@@ -325,6 +450,8 @@ struct CompiledExecutionStep {
   Workspace* workspace;
   vector<std::shared_ptr<ExecutionStepWrapper>> reportSubsteps;
   vector<std::shared_ptr<ExecutionStepWrapper>> recurringSubsteps;
+  // One per recurring substep, only filled in for concurrent substeps
+  vector<std::unique_ptr<SubstepTiming>> substepTimings;
 
   vector<NetBase*> networks;
   NetBase* reportNet;
@@ -359,8 +486,16 @@ bool ExecuteStepRecursive(ExecutionStepWrapper& stepWrapper) {
 
   VLOG(1) << "Running execution step " << step.name();
 
+  const bool sequential =
+      (!step.concurrent_substeps() || step.substep().size() <= 1) &&
+      (!step.has_num_concurrent_instances() ||
+       step.num_concurrent_instances() <= 1);
+  const bool reportTimings = step.substep_size() && !sequential &&
+      FLAGS_caffe2_plan_executor_substep_timing_ms > 0;
+
   std::unique_ptr<Reporter> reporter;
-  if (step.has_report_net() || compiledStep->reportSubsteps.size() > 0) {
+  if (step.has_report_net() || compiledStep->reportSubsteps.size() > 0 ||
+      reportTimings) {
     reporter = caffe2::make_unique<Reporter>();
     auto* reportNet = compiledStep->reportNet;
     if (reportNet) {
@@ -379,15 +514,32 @@ bool ExecuteStepRecursive(ExecutionStepWrapper& stepWrapper) {
             }
           });
     }
+    if (reportTimings) {
+      auto* compiled = compiledStep.operator->();
+      reporter->start(
+          FLAGS_caffe2_plan_executor_substep_timing_ms, [compiled]() {
+            for (size_t i = 0; i < compiled->recurringSubsteps.size(); ++i) {
+              auto& timing = *compiled->substepTimings[i];
+              std::lock_guard<std::mutex> lock(timing.mutex);
+              if (timing.runs == 0) {
+                continue;
+              }
+              LOG(INFO) << "Step " << compiled->step->name() << " substep "
+                        << compiled->recurringSubsteps[i]->step().name()
+                        << ": " << timing.runs << " runs, average "
+                        << timing.total_ms / timing.runs << " ms, max "
+                        << timing.max_ms << " ms";
+              timing.runs = 0;
+              timing.total_ms = 0;
+              timing.max_ms = 0;
+            }
+          });
+    }
   }
 
   const Blob* shouldStop = compiledStep->shouldStop;
 
   if (step.substep_size()) {
-    bool sequential =
-        (!step.concurrent_substeps() || step.substep().size() <= 1) &&
-        (!step.has_num_concurrent_instances() ||
-         step.num_concurrent_instances() <= 1);
     for (int64_t iter = 0; compiledStep->shouldContinue(iter); ++iter) {
       if (sequential) {
         VLOG(1) << "Executing step " << step.name() << " iteration " << iter;
@@ -411,10 +563,13 @@ bool ExecuteStepRecursive(ExecutionStepWrapper& stepWrapper) {
             return;
           }
           try {
+            Timer timer;
             if (!ExecuteStepRecursive(
                     *compiledStep->recurringSubsteps.at(substep_id))) {
               compiledStep->gotFailure = true;
             }
+            compiledStep->substepTimings.at(substep_id)->add(
+                timer.MilliSeconds());
           } catch (const std::exception& ex) {
             std::lock_guard<std::mutex> guard(exception_mutex);
             if (!first_exception.size()) {
@@ -432,16 +587,27 @@ bool ExecuteStepRecursive(ExecutionStepWrapper& stepWrapper) {
           }
         };
 
-        std::vector<std::thread> threads;
         auto numThreads = compiledStep->recurringSubsteps.size();
         if (step.has_num_concurrent_instances()) {
           numThreads *= step.num_concurrent_instances();
         }
+        std::mutex done_mutex;
+        std::condition_variable done_cv;
+        size_t num_running = numThreads;
         for (int64_t i = 0; i < numThreads; ++i) {
-          threads.emplace_back(worker);
+          SubstepThreadPool::instance().run([&]() {
+            // An exception escaping worker terminates the process, as it
+            // would from a thread of its own
+            worker();
+            std::lock_guard<std::mutex> guard(done_mutex);
+            if (--num_running == 0) {
+              done_cv.notify_all();
+            }
+          });
         }
-        for (auto& thread : threads) {
-          thread.join();
+        {
+          std::unique_lock<std::mutex> lock(done_mutex);
+          done_cv.wait(lock, [&] { return num_running == 0; });
         }
         if (compiledStep->gotFailure) {
           LOG(ERROR) << "One of the workers failed.";
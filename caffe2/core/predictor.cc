@@ -1,7 +1,16 @@
 #include "caffe2/core/predictor.h"
 
+#include <set>
 #include <unordered_set>
 
+#include "caffe2/core/memonger.h"
+
+CAFFE2_DEFINE_bool(
+    caffe2_predictor_memonger,
+    false,
+    "Let activations of simple run_nets share blobs when their lifetimes "
+    "don't overlap, to lower the memory used per Predictor and per request");
+
 namespace caffe2 {
 
 namespace {
@@ -54,6 +63,22 @@ const ::google::protobuf::RepeatedPtrField<::std::string>& getBlobs(
   }
   CAFFE_THROW("Blob not found: ", name);
 }
+
+// Run_net with its activations recycled by memonger, if
+// caffe2_predictor_memonger is set. Parameters, inputs and outputs keep their
+// own blobs.
+NetDef optimizeRunNet(const NetDef& run_net, const Workspace& ws) {
+  if (!FLAGS_caffe2_predictor_memonger) {
+    return run_net;
+  }
+  const auto& blobs = ws.Blobs();
+  std::set<std::string> static_blobs{blobs.begin(), blobs.end()};
+  static_blobs.insert(
+      run_net.external_input().begin(), run_net.external_input().end());
+  static_blobs.insert(
+      run_net.external_output().begin(), run_net.external_output().end());
+  return memonger::optimize_inference_net(run_net, static_blobs);
+}
 } // namespace
 
 Predictor::Predictor(const MetaNetDef& def, Workspace* parent, bool run_init)
@@ -86,6 +111,7 @@ Predictor::Predictor(
   if (run_init) {
     CAFFE_ENFORCE(ws_.RunNetOnce(init_net));
   }
+  run_net_ = optimizeRunNet(run_net_, ws_);
 
   // real model inputs can be fed later in run* functions
   const auto& initialized_vec = ws_.Blobs();
@@ -97,7 +123,7 @@ Predictor::Predictor(
       blob->template GetMutable<TensorCPU>();
     }
   }
-  CAFFE_ENFORCE(ws_.CreateNet(run_net));
+  CAFFE_ENFORCE(ws_.CreateNet(run_net_));
 }
 
 bool Predictor::run(const TensorVector& inputs, TensorVector* outputs) {
@@ -155,4 +181,171 @@ bool Predictor::run_map_outputs(const TensorMap& inputs, TensorMap* outputs) {
   return true;
 }
 
+ConcurrentPredictor::ConcurrentPredictor(
+    const MetaNetDef& def,
+    Workspace* parent,
+    bool run_init)
+    : run_net_(
+          getNet(def, PredictorConsts::default_instance().predict_net_type())),
+      ws_(parent) {
+  const auto& inputs =
+      getBlobs(def, PredictorConsts::default_instance().inputs_blob_type());
+  for (const auto& input : inputs) {
+    inputNames_.insert(input);
+  }
+
+  const auto& outputs =
+      getBlobs(def, PredictorConsts::default_instance().outputs_blob_type());
+  for (const auto& output : outputs) {
+    outputNames_.emplace_back(output);
+  }
+
+  init(
+      getNet(def, PredictorConsts::default_instance().global_init_net_type()),
+      run_init);
+}
+
+ConcurrentPredictor::ConcurrentPredictor(
+    const NetDef& init_net,
+    const NetDef& run_net,
+    Workspace* parent,
+    bool run_init)
+    : run_net_(run_net), ws_(parent) {
+  init(init_net, run_init);
+}
+
+void ConcurrentPredictor::init(const NetDef& init_net, bool run_init) {
+  if (run_init) {
+    CAFFE_ENFORCE(ws_.RunNetOnce(init_net));
+  }
+  run_net_ = optimizeRunNet(run_net_, ws_);
+
+  // Inputs that init_net doesn't create are fed in run*, and so are the
+  // declared model inputs even if init_net creates them. Everything else
+  // stays in the parameter workspace.
+  const auto& initialized_vec = ws_.Blobs();
+  const std::unordered_set<std::string> initialized{initialized_vec.begin(),
+                                                    initialized_vec.end()};
+  for (const auto& name : run_net_.external_input()) {
+    if (!initialized.count(name) || inputNames_.count(name)) {
+      localInputs_.insert(name);
+    }
+  }
+
+  // Operator outputs that aren't in the parameter workspace are created in
+  // each request workspace, so they can't race; writing to a parameter
+  // would.
+  for (const auto& op : run_net_.op()) {
+    for (const auto& output : op.output()) {
+      CAFFE_ENFORCE(
+          !initialized.count(output) || localInputs_.count(output),
+          "ConcurrentPredictor: run_net writes to ",
+          output,
+          ", which is created by init_net and shared by all requests");
+    }
+  }
+
+  // Instantiate one request workspace right away so that errors in run_net
+  // are reported here rather than on the first request.
+  releaseWorkspace(acquireWorkspace());
+}
+
+std::unique_ptr<Workspace> ConcurrentPredictor::acquireWorkspace() {
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    if (!freeWorkspaces_.empty()) {
+      auto ws = std::move(freeWorkspaces_.back());
+      freeWorkspaces_.pop_back();
+      return ws;
+    }
+  }
+
+  const Workspace* shared = &ws_;
+  auto ws = caffe2::make_unique<Workspace>(shared);
+  for (const auto& name : localInputs_) {
+    ws->CreateLocalBlob(name)->template GetMutable<TensorCPU>();
+  }
+  CAFFE_ENFORCE(ws->CreateNet(run_net_));
+
+  std::lock_guard<std::mutex> guard(mutex_);
+  numWorkspaces_++;
+  return ws;
+}
+
+void ConcurrentPredictor::releaseWorkspace(std::unique_ptr<Workspace> ws) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  freeWorkspaces_.push_back(std::move(ws));
+}
+
+size_t ConcurrentPredictor::num_workspaces() {
+  std::lock_guard<std::mutex> guard(mutex_);
+  return numWorkspaces_;
+}
+
+bool ConcurrentPredictor::runInWorkspace(
+    Workspace* ws,
+    const std::vector<std::pair<std::string, TensorCPU*>>& inputs,
+    const TensorVector& outputs) {
+  CAFFE_ENFORCE_EQ(outputs.size(), run_net_.external_output_size());
+  for (const auto& input : inputs) {
+    CAFFE_ENFORCE(
+        localInputs_.count(input.first),
+        "ConcurrentPredictor: ",
+        input.first,
+        " is created by init_net and is not a model input");
+    shareInputTensor(ws, input.first, input.second);
+  }
+
+  if (!ws->RunNet(run_net_.name())) {
+    return false;
+  }
+
+  for (auto i = 0; i < outputs.size(); ++i) {
+    outputs[i]->CopyFrom(*extractOutputTensor(ws, run_net_.external_output(i)));
+  }
+  return true;
+}
+
+bool ConcurrentPredictor::runInPooledWorkspace(
+    const std::vector<std::pair<std::string, TensorCPU*>>& inputs,
+    const TensorVector& outputs) {
+  auto ws = acquireWorkspace();
+  bool success;
+  try {
+    success = runInWorkspace(ws.get(), inputs, outputs);
+  } catch (...) {
+    releaseWorkspace(std::move(ws));
+    throw;
+  }
+  releaseWorkspace(std::move(ws));
+  return success;
+}
+
+bool ConcurrentPredictor::run(
+    const TensorVector& inputs,
+    const TensorVector& outputs) {
+  CAFFE_ENFORCE(inputs.size() <= run_net_.external_input_size());
+  std::vector<std::pair<std::string, TensorCPU*>> named;
+  for (auto i = 0; i < inputs.size(); ++i) {
+    named.emplace_back(run_net_.external_input(i), inputs[i]);
+  }
+  return runInPooledWorkspace(named, outputs);
+}
+
+bool ConcurrentPredictor::run_map(
+    const TensorMap& inputs,
+    const TensorVector& outputs) {
+  if (!inputNames_.empty()) {
+    CAFFE_ENFORCE_EQ(inputs.size(), inputNames_.size());
+  }
+  std::vector<std::pair<std::string, TensorCPU*>> named;
+  for (const auto& input : inputs) {
+    if (!inputNames_.empty()) {
+      CAFFE_ENFORCE_GT(inputNames_.count(input.first), 0);
+    }
+    named.emplace_back(input.first, input.second);
+  }
+  return runInPooledWorkspace(named, outputs);
+}
+
 } // namespace caffe2
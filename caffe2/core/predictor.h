@@ -1,5 +1,6 @@
 #pragma once
 
+#include <mutex>
 #include <unordered_set>
 #include "caffe2/core/net.h"
 #include "caffe2/core/tensor.h"
@@ -76,4 +77,90 @@ class Predictor {
   // being in a certain order.
   std::vector<std::string> outputNames_;
 };
+
+// Predictor that can serve requests from several threads at once while
+// keeping a single copy of the parameters.
+//
+// The `init_net` is run once in a parameter workspace, which is never written
+// to afterwards. Every call to `run` borrows a request workspace from a pool
+// (creating one if the pool is empty). Request workspaces use the parameter
+// workspace as their shared workspace, so they only hold the model inputs and
+// the activations, and each instantiates its own `run_net`. The pool grows to
+// the largest number of concurrent requests seen.
+//
+// Since request workspaces are reused, the outputs are copied into tensors
+// owned by the caller.
+class ConcurrentPredictor {
+ public:
+  using TensorVector = Predictor::TensorVector;
+  using TensorMap = Predictor::TensorMap;
+
+  ConcurrentPredictor(
+      const MetaNetDef& net,
+      Workspace* parent = nullptr,
+      bool run_init = true);
+
+  ConcurrentPredictor(
+      const NetDef& init_net,
+      const NetDef& run_net,
+      Workspace* parent = nullptr,
+      bool run_init = true);
+
+  // Executes `run_net` on the inputs, like Predictor::run, and copies the
+  // results into `outputs`. Thread safe.
+
+  // Precondition:
+  //   inputs.size() <= run_net_.external_inputs.size()
+  //   outputs.size() == run_net_.external_outputs.size()
+
+  // Returns true on success
+  bool run(const TensorVector& inputs, const TensorVector& outputs);
+
+  // Similar to run, but consumes a map of name to tensor as input
+  bool run_map(const TensorMap& inputs, const TensorVector& outputs);
+
+  const NetDef& def() const {
+    return run_net_;
+  };
+
+  // The workspace holding the parameters.
+  Workspace* ws() {
+    return &ws_;
+  };
+
+  const std::unordered_set<std::string>& input_names() const {
+    return inputNames_;
+  }
+
+  const std::vector<std::string>& output_names() const {
+    return outputNames_;
+  }
+
+  // Number of request workspaces created so far.
+  size_t num_workspaces();
+
+ private:
+  void init(const NetDef& init_net, bool run_init);
+  std::unique_ptr<Workspace> acquireWorkspace();
+  void releaseWorkspace(std::unique_ptr<Workspace> ws);
+  bool runInWorkspace(
+      Workspace* ws,
+      const std::vector<std::pair<std::string, TensorCPU*>>& inputs,
+      const TensorVector& outputs);
+  bool runInPooledWorkspace(
+      const std::vector<std::pair<std::string, TensorCPU*>>& inputs,
+      const TensorVector& outputs);
+
+  NetDef run_net_;
+  Workspace ws_;
+  std::unordered_set<std::string> inputNames_;
+  std::vector<std::string> outputNames_;
+  // Blobs that live in every request workspace: the model inputs, which hide
+  // any blob of the same name in the parameter workspace.
+  std::unordered_set<std::string> localInputs_;
+
+  std::mutex mutex_;
+  std::vector<std::unique_ptr<Workspace>> freeWorkspaces_;
+  size_t numWorkspaces_ = 0;
+};
 }
@@ -1,11 +1,18 @@
 #include "caffe2/core/context.h"
+#include "caffe2/core/mapped_params.h"
 #include "caffe2/core/operator.h"
 #include "caffe2/core/predictor.h"
+#include "caffe2/core/scope_guard.h"
 #include "caffe2/core/tensor.h"
 #include "caffe2/utils/math.h"
 
 #include <gtest/gtest.h>
 
+#include <cstdio>
+#include <thread>
+
+CAFFE2_DECLARE_bool(caffe2_predictor_memonger);
+
 namespace caffe2 {
 
 namespace {
@@ -57,6 +64,72 @@ const char* initSpec = R"DOC(
 
 )DOC";
 
+// h1 is last used by the op producing h2, so h3 can reuse its blob
+const char* deepPredictSpec = R"DOC(
+        name: "predict"
+        external_input: "data"
+        external_input: "W"
+        external_input: "b"
+        external_output: "y"
+        op {
+          input: "data"
+          input: "W"
+          input: "b"
+          output: "h1"
+          type: "FC"
+        }
+        op {
+          input: "h1"
+          input: "W"
+          input: "b"
+          output: "h2"
+          type: "FC"
+        }
+        op {
+          input: "h2"
+          input: "W"
+          input: "b"
+          output: "h3"
+          type: "FC"
+        }
+        op {
+          input: "h3"
+          input: "W"
+          input: "b"
+          output: "y"
+          type: "FC"
+        }
+)DOC";
+
+const char* deepInitSpec = R"DOC(
+        name: "init"
+        op {
+          type: "ConstantFill"
+          output: "W"
+          arg {
+            name: "shape"
+            ints: 4
+            ints: 4
+          }
+          arg {
+            name: "value"
+            f: 0.5
+          }
+        }
+        op {
+          type: "ConstantFill"
+          output: "b"
+          arg {
+            name: "shape"
+            ints: 4
+          }
+          arg {
+            name: "value"
+            f: 1.0
+          }
+        }
+)DOC";
+
 const char* metaSpec = R"DOC(
   blobs {
     key: "INPUTS_BLOB_TYPE"
@@ -226,4 +299,144 @@ TEST_F(PredictorMetaNetDefTest, SimpleMetaNetDefInitializer) {
   EXPECT_TRUE(output.front()->dim(1) == 10);
   EXPECT_NEAR(output.front()->data<float>()[4], 0.1209, 1E-4);
 }
+
+TEST(MappedParamsTest, PredictorOnMappedParams) {
+  Workspace init_ws;
+  ASSERT_TRUE(init_ws.RunNetOnce(parseNetDef(initSpec)));
+  const std::string path = std::tmpnam(nullptr);
+  SaveMappedParams(init_ws, {"W", "b"}, path);
+  auto guard = MakeGuard([&] { std::remove(path.c_str()); });
+
+  Workspace params_ws;
+  auto params = LoadMappedParams(path, &params_ws);
+  EXPECT_EQ(params, std::vector<std::string>({"W", "b"}));
+  for (const auto& name : params) {
+    const auto& mapped = params_ws.GetBlob(name)->Get<TensorCPU>();
+    const auto& original = init_ws.GetBlob(name)->Get<TensorCPU>();
+    EXPECT_EQ(mapped.dims(), original.dims());
+    EXPECT_EQ(
+        reinterpret_cast<size_t>(mapped.raw_data()) % kMappedParamsAlignment,
+        0);
+    EXPECT_EQ(
+        memcmp(mapped.raw_data(), original.raw_data(), original.nbytes()), 0);
+  }
+
+  // The init net only filled parameters, so nothing is left of it
+  auto init = StripMappedParams(parseNetDef(initSpec), params);
+  EXPECT_EQ(init.op_size(), 0);
+  Predictor p(init, parseNetDef(predictSpec), &params_ws);
+
+  DeviceOption op;
+  op.set_random_seed(1701);
+  CPUContext ctx(op);
+  auto inputData = randomTensor({1, 4}, &ctx);
+  Predictor::TensorVector input{inputData->template GetMutable<TensorCPU>()};
+  Predictor::TensorVector output;
+  ASSERT_TRUE(p.run(input, &output));
+  EXPECT_EQ(output.size(), 1);
+  EXPECT_NEAR(output.front()->data<float>()[4], 0.1209, 1E-4);
+}
+
+TEST(MappedParamsTest, RejectsStringTensors) {
+  Workspace ws;
+  auto* tensor = ws.CreateBlob("s")->GetMutable<TensorCPU>();
+  tensor->Resize(1);
+  tensor->mutable_data<std::string>()[0] = "x";
+  EXPECT_THROW(
+      SaveMappedParams(ws, {"s"}, std::tmpnam(nullptr)), EnforceNotMet);
+}
+
+TEST(ConcurrentPredictorTest, SharedParameters) {
+  DeviceOption op;
+  op.set_random_seed(1701);
+  CPUContext ctx(op);
+  ConcurrentPredictor p(parseNetDef(initSpec), parseNetDef(predictSpec));
+  auto inputData = randomTensor({1, 4}, &ctx);
+  ConcurrentPredictor::TensorVector input{
+      inputData->template GetMutable<TensorCPU>()};
+
+  const int kThreads = 4;
+  std::vector<TensorCPU> outputs(kThreads);
+  std::vector<int> success(kThreads, 1);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreads; t++) {
+    threads.emplace_back([&, t] {
+      for (int i = 0; i < 10; i++) {
+        success[t] = success[t] && p.run(input, {&outputs[t]});
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  for (int t = 0; t < kThreads; t++) {
+    EXPECT_TRUE(success[t]);
+    EXPECT_TRUE(outputs[t].dims().size() == 2);
+    EXPECT_TRUE(outputs[t].dim(0) == 1);
+    EXPECT_TRUE(outputs[t].dim(1) == 10);
+    EXPECT_NEAR(outputs[t].data<float>()[4], 0.1209, 1E-4);
+  }
+  EXPECT_GE(p.num_workspaces(), 1);
+  EXPECT_LE(p.num_workspaces(), kThreads);
+  // activations live in the request workspaces only
+  EXPECT_TRUE(p.ws()->HasBlob("W"));
+  EXPECT_FALSE(p.ws()->HasBlob("y"));
+}
+
+TEST(ConcurrentPredictorTest, MetaNetDefInputs) {
+  DeviceOption op;
+  op.set_random_seed(1701);
+  CPUContext ctx(op);
+  // init_net creates "data", but it is a model input, so it is fed per request
+  ConcurrentPredictor p(parseMetaNetDef(metaSpec));
+  auto inputData = randomTensor({1, 4}, &ctx);
+  ConcurrentPredictor::TensorMap input{
+      {"data", inputData->template GetMutable<TensorCPU>()}};
+  TensorCPU output;
+  EXPECT_TRUE(p.run_map(input, {&output}));
+  EXPECT_NEAR(output.data<float>()[4], 0.1209, 1E-4);
+  ConcurrentPredictor::TensorMap parameter{
+      {"W", inputData->template GetMutable<TensorCPU>()}};
+  EXPECT_THROW(p.run_map(parameter, {&output}), EnforceNotMet);
+}
+
+TEST(ConcurrentPredictorTest, RejectsWritesToParameters) {
+  auto run = parseNetDef(predictSpec);
+  auto* fill = run.add_op();
+  fill->set_type("ConstantFill");
+  fill->add_output("W");
+  EXPECT_THROW(
+      ConcurrentPredictor(parseNetDef(initSpec), run), EnforceNotMet);
+}
+
+TEST(PredictorMemongerTest, SharesActivations) {
+  auto old_memonger = FLAGS_caffe2_predictor_memonger;
+  auto g = MakeGuard([&]() { FLAGS_caffe2_predictor_memonger = old_memonger; });
+
+  DeviceOption op;
+  op.set_random_seed(1701);
+  CPUContext ctx(op);
+  auto inputData = randomTensor({2, 4}, &ctx);
+  Predictor::TensorVector input{inputData->template GetMutable<TensorCPU>()};
+
+  FLAGS_caffe2_predictor_memonger = false;
+  Predictor reference(parseNetDef(deepInitSpec), parseNetDef(deepPredictSpec));
+  Predictor::TensorVector expected;
+  ASSERT_TRUE(reference.run(input, &expected));
+
+  FLAGS_caffe2_predictor_memonger = true;
+  Predictor p(parseNetDef(deepInitSpec), parseNetDef(deepPredictSpec));
+  const auto& def = p.def();
+  EXPECT_EQ(def.op(2).output(0), def.op(0).output(0));
+  EXPECT_NE(def.op(1).output(0), def.op(0).output(0));
+  EXPECT_EQ(def.op(3).output(0), "y");
+
+  Predictor::TensorVector output;
+  ASSERT_TRUE(p.run(input, &output));
+  ASSERT_EQ(output.size(), 1);
+  ASSERT_EQ(output[0]->dims(), expected[0]->dims());
+  for (int i = 0; i < output[0]->size(); ++i) {
+    EXPECT_FLOAT_EQ(output[0]->data<float>()[i], expected[0]->data<float>()[i]);
+  }
+}
 } // namespace caffe2
@@ -1,8 +1,12 @@
 #include "caffe2/core/stats.h"
 
+#include <algorithm>
+#include <cmath>
 #include <condition_variable>
 #include <thread>
 
+#include "caffe2/core/common.h"
+
 namespace caffe2 {
 
 ExportedStatMap toMap(const ExportedStatList& stats) {
@@ -46,6 +50,46 @@ void StatRegistry::update(const ExportedStatList& data) {
 
 StatRegistry::~StatRegistry() {}
 
+constexpr int HistogramExportedStat::kNumBuckets;
+
+HistogramExportedStat::HistogramExportedStat(
+    const std::string& gn,
+    const std::string& n)
+    : ExportedStat(gn, n + "/sum"), count_(gn, n + "/count") {
+  buckets_.reserve(kNumBuckets);
+  for (int i = 0; i < kNumBuckets; ++i) {
+    buckets_.emplace_back(gn, n + "/bucket_" + caffe2::to_string(i));
+  }
+}
+
+int64_t histogramPercentile(
+    const ExportedStatMap& stats,
+    const std::string& key,
+    double p) {
+  std::vector<int64_t> counts(HistogramExportedStat::kNumBuckets, 0);
+  int64_t total = 0;
+  for (int i = 0; i < counts.size(); ++i) {
+    auto it = stats.find(key + "/bucket_" + caffe2::to_string(i));
+    if (it != stats.end()) {
+      counts[i] = it->second;
+      total += it->second;
+    }
+  }
+  if (total <= 0) {
+    return -1;
+  }
+  // the rank of the percentile, from 1 to total
+  int64_t rank = std::max<int64_t>(1, std::ceil(p * total));
+  int64_t seen = 0;
+  for (int i = 0; i + 1 < counts.size(); ++i) {
+    seen += counts[i];
+    if (seen >= rank) {
+      return int64_t(2) << i;
+    }
+  }
+  return int64_t(1) << (counts.size() - 1);
+}
+
 StatRegistry& StatRegistry::get() {
   static StatRegistry r;
   return r;
@@ -258,6 +258,55 @@ class DetailedExportedStat : public ExportedStat {
   }
 };
 
+/**
+ * Counts values in buckets of powers of two: bucket i counts the values in
+ * [2^i, 2^(i+1)), except that bucket 0 also counts the values below 1 and the
+ * last bucket all the values from 2^(kNumBuckets - 1). Besides n/count and
+ * n/sum, it exports bucket i as n/bucket_<i>. histogramPercentile() estimates
+ * percentiles from an export.
+ */
+class HistogramExportedStat : public ExportedStat {
+ public:
+  static constexpr int kNumBuckets = 32;
+
+ private:
+  ExportedStat count_;
+  std::vector<ExportedStat> buckets_;
+
+ public:
+  HistogramExportedStat(const std::string& gn, const std::string& n);
+
+  static int bucket(int64_t value) {
+    int b = 0;
+    while (b + 1 < kNumBuckets && value >= (int64_t(2) << b)) {
+      ++b;
+    }
+    return b;
+  }
+
+  int64_t increment(int64_t value = 1) {
+    count_.increment();
+    buckets_[bucket(value)].increment();
+    return ExportedStat::increment(value);
+  }
+
+  template <typename T, typename Unused1, typename... Unused>
+  int64_t increment(T value, Unused1, Unused...) {
+    return increment(value);
+  }
+};
+
+/**
+ * Estimates the p-th percentile (p in [0, 1]) of the values counted by the
+ * HistogramExportedStat exported as `key` (i.e. groupName/name), as the upper
+ * bound of the bucket the percentile falls in, or the lower bound for the last
+ * bucket. Returns -1 if the histogram has no values.
+ */
+int64_t histogramPercentile(
+    const ExportedStatMap& stats,
+    const std::string& key,
+    double p);
+
 namespace detail {
 
 template <class T>
@@ -311,6 +360,11 @@ _ScopeGuard<T> ScopeGuard(T f) {
     groupName, #name                       \
   }
 
+#define CAFFE_HISTOGRAM_EXPORTED_STAT(name) \
+  HistogramExportedStat name {              \
+    groupName, #name                        \
+  }
+
 #define CAFFE_STAT(name) \
   Stat name {            \
     groupName, #name     \
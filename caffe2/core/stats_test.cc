@@ -117,5 +117,35 @@ TEST(StatsTest, StatsTestSimple) {
       toMap(reg2.publish()), ExportedStatMap({{"i1/s3", 0}, {"i2/s3", 0}}));
 }
 
+TEST(StatsTest, StatsTestHistogram) {
+  struct TestHistogram {
+    CAFFE_STAT_CTOR(TestHistogram);
+    CAFFE_HISTOGRAM_EXPORTED_STAT(h);
+  } stats("histogram");
+  EXPECT_EQ(histogramPercentile(
+                toMap(StatRegistry::get().publish()), "histogram/h", 0.5),
+            -1);
+  // 0, 1 in bucket 0, 2, 3 in bucket 1, ..., 64 .. 99 in bucket 6
+  for (int i = 0; i < 100; ++i) {
+    CAFFE_EVENT(stats, h, i);
+  }
+  CAFFE_EVENT(stats, h, int64_t(1) << 40);
+  auto map = toMap(StatRegistry::get().publish(true));
+  EXPECT_SUBSET(
+      map,
+      ExportedStatMap({{"histogram/h/count", 101},
+                       {"histogram/h/sum", 4950 + (int64_t(1) << 40)},
+                       {"histogram/h/bucket_0", 2},
+                       {"histogram/h/bucket_1", 2},
+                       {"histogram/h/bucket_5", 32},
+                       {"histogram/h/bucket_6", 36},
+                       {"histogram/h/bucket_31", 1}}));
+  EXPECT_EQ(histogramPercentile(map, "histogram/h", 0), 2);
+  EXPECT_EQ(histogramPercentile(map, "histogram/h", 0.5), 64);
+  EXPECT_EQ(histogramPercentile(map, "histogram/h", 0.99), 128);
+  EXPECT_EQ(
+      histogramPercentile(map, "histogram/h", 1), int64_t(1) << 31);
+}
+
 } // namespace
 } // namespace caffe2
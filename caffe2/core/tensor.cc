@@ -14,6 +14,18 @@ CAFFE2_DEFINE_int64(
     "The maximum memory in bytes to keep on shrink, if the difference between "
     "tensor sizes is bigger than this then tensor will be reset.");
 
+CAFFE2_DEFINE_double(
+    caffe2_tensor_growth_headroom_pct,
+    -1,
+    "If non negative, new tensors keep memory for the largest size they were "
+    "resized to plus this percentage, see Tensor::SetGrowthPolicy.");
+
+CAFFE2_DEFINE_int(
+    caffe2_tensor_growth_decay_resizes,
+    0,
+    "If positive, the memory kept by the growth policy of new tensors decays "
+    "to the current size after this many resizes below the largest size.");
+
 namespace caffe2 {
 // declaring it here instead of context.cc because tensor.h includes context.h
 CAFFE_KNOWN_TYPE(Tensor<CPUContext>);
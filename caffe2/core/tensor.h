@@ -25,6 +25,11 @@ CAFFE2_DECLARE_bool(caffe2_keep_on_shrink);
 // is larger than this flag in bytes.
 CAFFE2_DECLARE_int64(caffe2_max_keep_on_shrink_memory);
 
+// The default growth policy of new tensors, see Tensor::SetGrowthPolicy. A
+// negative headroom disables the policy.
+CAFFE2_DECLARE_double(caffe2_tensor_growth_headroom_pct);
+CAFFE2_DECLARE_int(caffe2_tensor_growth_decay_resizes);
+
 namespace caffe2 {
 
 /**
@@ -287,7 +292,8 @@ class Tensor {
   template <typename... Ts>
   void Resize(Ts... dim_source) {
     bool size_changed = SetDims(dim_source...);
-    if (size_changed) {
+    bool decayed = headroom_pct_ >= 0 && UpdateHighWaterMark();
+    if (size_changed || decayed) {
       // If needed, we will free the data. the next mutable_data() call
       // will create the data storage.
       int64_t new_size = size_ * meta_.itemsize();
@@ -296,6 +302,11 @@ class Tensor {
         // If tensor is reserved then don't claim its memeory unless capacity_
         // is smaller than new size
         reset_tensor = capacity_ < new_size;
+      } else if (headroom_pct_ >= 0) {
+        // With a growth policy the memory is kept until the high-water mark
+        // decays
+        reset_tensor = capacity_ < new_size ||
+            (decayed && capacity_ > AllocationNBytes());
       } else {
         reset_tensor = capacity_ < new_size || !FLAGS_caffe2_keep_on_shrink ||
             capacity_ - new_size > FLAGS_caffe2_max_keep_on_shrink_memory;
@@ -307,6 +318,32 @@ class Tensor {
     }
   }
 
+  /**
+   * @brief Sets the growth policy of the tensor for sizes that vary between
+   * runs, e.g. with the batch size in serving.
+   *
+   * With a non-negative headroomPct, the memory allocated for the tensor is
+   * the largest size it was resized to (its high-water mark) plus headroomPct
+   * percent, and is kept when the tensor shrinks. If decayResizes is
+   * positive and the high-water mark is not reached again in decayResizes
+   * consecutive calls to Resize, it decays to the current size, and memory
+   * above the new mark is released. A negative headroomPct restores the
+   * default behavior of keep_on_shrink.
+   */
+  void SetGrowthPolicy(float headroomPct, int decayResizes = 0) {
+    headroom_pct_ = headroomPct;
+    decay_resizes_ = decayResizes;
+    high_water_size_ = std::max<TIndex>(size_, 0);
+    resizes_below_high_water_ = 0;
+  }
+
+  /**
+   * Returns the number of times memory was allocated for the tensor.
+   */
+  inline size_t num_allocations() const {
+    return num_allocations_;
+  }
+
   /**
    * Resize the tensor like the source tensor. Note that this is just a
    * sugar wrapper that essentially calls Resize(src_tensor.dims()).
@@ -383,6 +420,11 @@ class Tensor {
     std::swap(shares_data_, other.shares_data_);
     std::swap(capacity_, other.capacity_);
     std::swap(reserved_, other.reserved_);
+    std::swap(headroom_pct_, other.headroom_pct_);
+    std::swap(decay_resizes_, other.decay_resizes_);
+    std::swap(high_water_size_, other.high_water_size_);
+    std::swap(resizes_below_high_water_, other.resizes_below_high_water_);
+    std::swap(num_allocations_, other.num_allocations_);
   }
 
   /**
@@ -541,12 +583,14 @@ class Tensor {
               deleter(ptr);
             });
         meta_.ctor()(data_.get(), size_);
+        capacity_ = size_ * meta_.itemsize();
       } else {
         // For fundamental type, new and delete is easier.
-        auto ptr_and_deleter = Context::New(size_ * meta_.itemsize());
+        capacity_ = AllocationNBytes();
+        auto ptr_and_deleter = Context::New(capacity_);
         data_.reset(ptr_and_deleter.first, ptr_and_deleter.second);
       }
-      capacity_ = size_ * meta_.itemsize();
+      ++num_allocations_;
       return data_.get();
     }
   }
@@ -684,9 +728,42 @@ class Tensor {
   bool shares_data_ = false;
   size_t capacity_ = 0;
   bool reserved_ = false;
+  // Growth policy, see SetGrowthPolicy()
+  float headroom_pct_ = FLAGS_caffe2_tensor_growth_headroom_pct;
+  int decay_resizes_ = FLAGS_caffe2_tensor_growth_decay_resizes;
+  TIndex high_water_size_ = 0;
+  int resizes_below_high_water_ = 0;
+  size_t num_allocations_ = 0;
   // In case of chunk load we store how much data was already loaded
 
  private:
+  // Updates the high-water mark of the growth policy with the new size, and
+  // returns true if it decayed
+  bool UpdateHighWaterMark() {
+    if (size_ >= high_water_size_) {
+      high_water_size_ = size_;
+      resizes_below_high_water_ = 0;
+      return false;
+    }
+    if (decay_resizes_ <= 0 ||
+        ++resizes_below_high_water_ < decay_resizes_) {
+      return false;
+    }
+    high_water_size_ = std::max<TIndex>(size_, 0);
+    resizes_below_high_water_ = 0;
+    return true;
+  }
+
+  // Bytes to allocate for the current size, following the growth policy
+  size_t AllocationNBytes() const {
+    if (headroom_pct_ < 0) {
+      return size_ * meta_.itemsize();
+    }
+    TIndex size = std::max(size_, high_water_size_);
+    size += static_cast<TIndex>(size * headroom_pct_ / 100);
+    return size * meta_.itemsize();
+  }
+
   template <
       typename T,
       typename = typename std::enable_if<std::is_integral<T>::value>::type>
@@ -0,0 +1,66 @@
+#include "caffe2/core/thread_budget.h"
+
+#include <algorithm>
+#include <thread>
+
+#include "caffe2/core/numa.h"
+
+#ifdef _OPENMP
+#include "caffe2/core/common_omp.h"
+#endif // _OPENMP
+
+#ifdef CAFFE2_USE_MKL
+#include <mkl.h>
+#endif // CAFFE2_USE_MKL
+
+CAFFE2_DEFINE_int(
+    caffe2_cpu_thread_budget,
+    0,
+    "Total number of CPU threads running operators, shared between async net "
+    "CPU pool workers and their OpenMP/MKL threads. 0 for no budget, -1 for "
+    "the number of cores.");
+CAFFE2_DEFINE_int(
+    caffe2_intra_op_threads,
+    1,
+    "With caffe2_cpu_thread_budget, the number of OpenMP/MKL threads per "
+    "CPU pool worker; the rest of the budget goes to the number of workers.");
+
+namespace caffe2 {
+
+bool IsThreadBudgetEnabled() {
+  return FLAGS_caffe2_cpu_thread_budget != 0;
+}
+
+ThreadBudget GetThreadBudget(int numa_node_id) {
+  CAFFE_ENFORCE(IsThreadBudgetEnabled(), "CPU thread budget is not set");
+  int total = FLAGS_caffe2_cpu_thread_budget;
+  if (total < 0) {
+    total = std::thread::hardware_concurrency();
+    CAFFE_ENFORCE(total > 0, "Failed to get number of CPU cores");
+  }
+  if (numa_node_id >= 0 && IsNUMAEnabled()) {
+    const int num_nodes = GetNumNUMANodes();
+    CAFFE_ENFORCE(
+        numa_node_id < num_nodes,
+        "Invalid NUMA node id: " + caffe2::to_string(numa_node_id));
+    total = std::max(1, total / num_nodes);
+  }
+
+  ThreadBudget budget;
+  budget.intra_op_threads =
+      std::min(std::max(1, FLAGS_caffe2_intra_op_threads), total);
+  budget.inter_op_threads = total / budget.intra_op_threads;
+  return budget;
+}
+
+void SetIntraOpThreads(int num_threads) {
+  CAFFE_ENFORCE_GT(num_threads, 0);
+#ifdef _OPENMP
+  omp_set_num_threads(num_threads);
+#endif // _OPENMP
+#ifdef CAFFE2_USE_MKL
+  mkl_set_num_threads_local(num_threads);
+#endif // CAFFE2_USE_MKL
+}
+
+} // namespace caffe2
@@ -0,0 +1,34 @@
+#ifndef CAFFE2_CORE_THREAD_BUDGET_H_
+#define CAFFE2_CORE_THREAD_BUDGET_H_
+
+#include "caffe2/core/logging.h"
+
+CAFFE2_DECLARE_int(caffe2_cpu_thread_budget);
+CAFFE2_DECLARE_int(caffe2_intra_op_threads);
+
+namespace caffe2 {
+
+// A process-wide number of CPU threads (caffe2_cpu_thread_budget), split
+// between the workers of a CPU pool running operators in parallel
+// (inter-op) and the OpenMP/MKL threads each worker uses inside an
+// operator (intra-op), so that their product does not exceed the budget.
+// With NUMA enabled, the budget of a NUMA node is its share of the total.
+struct ThreadBudget {
+  int inter_op_threads;
+  int intra_op_threads;
+};
+
+// Whether caffe2_cpu_thread_budget is set
+bool IsThreadBudgetEnabled();
+
+// The split of the budget for threads bound to numa_node_id; -1 stands for
+// the whole process. Requires IsThreadBudgetEnabled().
+ThreadBudget GetThreadBudget(int numa_node_id = -1);
+
+// Sets the number of OpenMP and MKL threads used by operators running on the
+// calling thread. No-op without OpenMP and MKL.
+void SetIntraOpThreads(int num_threads);
+
+} // namespace caffe2
+
+#endif // CAFFE2_CORE_THREAD_BUDGET_H_
@@ -0,0 +1,64 @@
+#include "caffe2/core/scope_guard.h"
+#include "caffe2/core/thread_budget.h"
+#include "caffe2/utils/thread_pool.h"
+
+#include <gtest/gtest.h>
+
+#ifdef _OPENMP
+#include "caffe2/core/common_omp.h"
+#endif // _OPENMP
+
+#include <future>
+
+namespace caffe2 {
+namespace {
+
+void setBudget(int total, int intra_op) {
+  FLAGS_caffe2_cpu_thread_budget = total;
+  FLAGS_caffe2_intra_op_threads = intra_op;
+}
+
+TEST(ThreadBudgetTest, Split) {
+  auto old_total = FLAGS_caffe2_cpu_thread_budget;
+  auto old_intra_op = FLAGS_caffe2_intra_op_threads;
+  auto g = MakeGuard([&]() { setBudget(old_total, old_intra_op); });
+
+  setBudget(0, 1);
+  EXPECT_FALSE(IsThreadBudgetEnabled());
+  EXPECT_THROW(GetThreadBudget(), EnforceNotMet);
+
+  setBudget(16, 1);
+  EXPECT_TRUE(IsThreadBudgetEnabled());
+  EXPECT_EQ(GetThreadBudget().inter_op_threads, 16);
+  EXPECT_EQ(GetThreadBudget().intra_op_threads, 1);
+
+  setBudget(16, 3);
+  EXPECT_EQ(GetThreadBudget().inter_op_threads, 5);
+  EXPECT_EQ(GetThreadBudget().intra_op_threads, 3);
+
+  // a worker never gets more threads than the whole budget
+  setBudget(4, 8);
+  EXPECT_EQ(GetThreadBudget().inter_op_threads, 1);
+  EXPECT_EQ(GetThreadBudget().intra_op_threads, 4);
+
+  setBudget(-1, 1);
+  EXPECT_EQ(
+      GetThreadBudget().inter_op_threads, std::thread::hardware_concurrency());
+}
+
+#ifdef _OPENMP
+TEST(ThreadBudgetTest, PoolThreadsUseIntraOpShare) {
+  auto old_total = FLAGS_caffe2_cpu_thread_budget;
+  auto old_intra_op = FLAGS_caffe2_intra_op_threads;
+  auto g = MakeGuard([&]() { setBudget(old_total, old_intra_op); });
+  setBudget(8, 2);
+
+  TaskThreadPool pool(2);
+  std::promise<int> num_threads;
+  pool.run([&]() { num_threads.set_value(omp_get_max_threads()); });
+  EXPECT_EQ(num_threads.get_future().get(), 2);
+}
+#endif // _OPENMP
+
+} // namespace
+} // namespace caffe2
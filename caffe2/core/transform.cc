@@ -1,5 +1,7 @@
 #include "caffe2/core/transform.h"
 
+#include <numeric>
+
 #include "caffe2/core/common.h"
 #include "caffe2/core/logging.h"
 #include "caffe2/core/net.h"
@@ -19,8 +21,8 @@ std::vector<std::vector<int>> Transform::PatternMatch(const Graph& graph) {
   // stores matches, which are ordered subgraphs of G
   std::vector<std::vector<int>> matches;
 
-  // Consider every possible node as the starting point.
-  for (int idx = 0; idx < graph.size(); ++idx) {
+  // Consider every possible starting point.
+  for (int idx : PatternAnchors(graph)) {
     // The current working subgraph. We will try to add new nodes to this,
     // when invoking the PatternRule.
     std::vector<int> subgraph;
@@ -45,6 +47,12 @@ std::vector<std::vector<int>> Transform::PatternMatch(const Graph& graph) {
   return matches;
 }
 
+std::vector<int> Transform::PatternAnchors(const Graph& graph) {
+  std::vector<int> anchors(graph.size());
+  std::iota(anchors.begin(), anchors.end(), 0);
+  return anchors;
+}
+
 void Transform::TryNeighbors(
     const Graph& graph,
     const std::map<int, std::vector<string>>& neighbors,
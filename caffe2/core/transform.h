@@ -100,6 +100,15 @@ class Transform {
     CAFFE_NOT_IMPLEMENTED;
   }
 
+  /**
+   * The nodes PatternMatch tries to start a match at, in increasing order.
+   * It must contain every node idx for which PatternRule(g, {}, idx) holds.
+   * Returns every node by default; transforms that know what their matches
+   * start with can look it up in an index instead, which saves trying each
+   * node of a large graph.
+   */
+  virtual std::vector<int> PatternAnchors(const transform::Graph& g);
+
   /**
    * The ValidatorRule essentially answers:
    * Given a subgraph, can we accept it?
@@ -2,6 +2,7 @@
 
 #include <algorithm>
 #include <ctime>
+#include <deque>
 #include <mutex>
 
 #include "caffe2/core/logging.h"
@@ -101,6 +102,58 @@ vector<string> Workspace::Blobs() const {
   return names;
 }
 
+namespace {
+
+struct BlobNames {
+  std::mutex mutex;
+  std::unordered_map<string, int> ids;
+  // deque, so that the names stay in place as more are interned
+  std::deque<string> names;
+};
+
+BlobNames& blobNames() {
+  static BlobNames names;
+  return names;
+}
+
+} // namespace
+
+int Workspace::InternBlobName(const string& name) {
+  auto& names = blobNames();
+  std::lock_guard<std::mutex> guard(names.mutex);
+  auto it = names.ids.find(name);
+  if (it != names.ids.end()) {
+    return it->second;
+  }
+  int id = names.names.size();
+  names.names.push_back(name);
+  names.ids.emplace(name, id);
+  return id;
+}
+
+const string& Workspace::InternedBlobName(int id) {
+  auto& names = blobNames();
+  std::lock_guard<std::mutex> guard(names.mutex);
+  CAFFE_ENFORCE(
+      id >= 0 && id < static_cast<int>(names.names.size()),
+      "Blob id ",
+      id,
+      " is not interned");
+  return names.names[id];
+}
+
+bool Workspace::HasBlob(int id) const {
+  return FindBlob(id) != nullptr;
+}
+
+Blob* Workspace::AddLocalBlob(const string& name) {
+  VLOG(1) << "Creating blob " << name;
+  auto* blob = new Blob();
+  blob_map_[name] = unique_ptr<Blob>(blob);
+  blob_ids_[InternBlobName(name)] = blob;
+  return blob;
+}
+
 Blob* Workspace::CreateBlob(const string& name) {
   if (HasBlob(name)) {
     VLOG(1) << "Blob " << name << " already exists. Skipping.";
@@ -109,20 +162,25 @@ Blob* Workspace::CreateBlob(const string& name) {
     VLOG(1) << "Blob " << name << " is already forwarded from parent workspace "
             << "(blob " << forwarded_blobs_[name].second << "). Skipping.";
   } else {
-    VLOG(1) << "Creating blob " << name;
-    blob_map_[name] = unique_ptr<Blob>(new Blob());
+    return AddLocalBlob(name);
   }
   return GetBlob(name);
 }
 
+Blob* Workspace::CreateBlob(int id) {
+  auto it = blob_ids_.find(id);
+  if (it != blob_ids_.end()) {
+    return it->second;
+  }
+  return CreateBlob(InternedBlobName(id));
+}
+
 Blob* Workspace::CreateLocalBlob(const string& name) {
   if (blob_map_.count(name)) {
     VLOG(1) << "Blob " << name << " already exists. Skipping.";
-  } else {
-    VLOG(1) << "Creating blob " << name;
-    blob_map_[name] = unique_ptr<Blob>(new Blob());
+    return blob_map_.at(name).get();
   }
-  return GetBlob(name);
+  return AddLocalBlob(name);
 }
 
 Blob* Workspace::RenameBlob(const string& old_name, const string& new_name) {
@@ -142,9 +200,11 @@ Blob* Workspace::RenameBlob(const string& old_name, const string& new_name) {
   // First delete the old record
   auto value = std::move(it->second);
   blob_map_.erase(it);
+  blob_ids_.erase(InternBlobName(old_name));
 
   auto* raw_ptr = value.get();
   blob_map_[new_name] = std::move(value);
+  blob_ids_[InternBlobName(new_name)] = raw_ptr;
   return raw_ptr;
 }
 
@@ -153,6 +213,7 @@ bool Workspace::RemoveBlob(const string& name) {
   if (it != blob_map_.end()) {
     VLOG(1) << "Removing blob " << name << " from this workspace.";
     blob_map_.erase(it);
+    blob_ids_.erase(InternBlobName(name));
     return true;
   }
 
@@ -215,6 +276,30 @@ Blob* Workspace::GetBlob(const string& name) {
   return const_cast<Blob*>(static_cast<const Workspace*>(this)->GetBlob(name));
 }
 
+const Blob* Workspace::FindBlob(int id) const {
+  auto it = blob_ids_.find(id);
+  if (it != blob_ids_.end()) {
+    return it->second;
+  }
+  if (!forwarded_blobs_.empty()) {
+    const auto& name = InternedBlobName(id);
+    return HasBlob(name) ? GetBlob(name) : nullptr;
+  }
+  return shared_ ? shared_->FindBlob(id) : nullptr;
+}
+
+const Blob* Workspace::GetBlob(int id) const {
+  auto* blob = FindBlob(id);
+  if (!blob) {
+    LOG(WARNING) << "Blob " << InternedBlobName(id) << " not in the workspace.";
+  }
+  return blob;
+}
+
+Blob* Workspace::GetBlob(int id) {
+  return const_cast<Blob*>(static_cast<const Workspace*>(this)->GetBlob(id));
+}
+
 NetBase* Workspace::CreateNet(const NetDef& net_def, bool overwrite) {
   std::shared_ptr<NetDef> tmp_net_def(new NetDef(net_def));
   return CreateNet(tmp_net_def, overwrite);
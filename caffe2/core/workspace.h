@@ -8,6 +8,7 @@
 #include <cstddef>
 #include <mutex>
 #include <typeinfo>
+#include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
@@ -183,6 +184,23 @@ class Workspace {
     return false;
   }
 
+  /**
+   * Returns the id of a blob name, which is the same in every workspace of the
+   * process. HasBlob(), CreateBlob() and GetBlob() also take blob ids, which
+   * they look up in a hash table rather than in the map of names: code that
+   * accesses the same blobs over and over can intern their names once.
+   */
+  static int InternBlobName(const string& name);
+  /**
+   * Returns the name of a blob id returned by InternBlobName().
+   */
+  static const string& InternedBlobName(int id);
+
+  /**
+   * Checks if the blob of the given id is present in the current workspace.
+   */
+  bool HasBlob(int id) const;
+
   void PrintBlobSizes();
 
   /**
@@ -191,6 +209,11 @@ class Workspace {
    * already exists, the creation is skipped and the existing blob is returned.
    */
   Blob* CreateBlob(const string& name);
+  /**
+   * Same as CreateBlob(InternedBlobName(id)), without the lookup by name of a
+   * blob that already exists in the local workspace.
+   */
+  Blob* CreateBlob(int id);
   /**
    * Similar to CreateBlob(), but it creates a blob in the local workspace even
    * if another blob with the same name already exists in the parent workspace
@@ -215,6 +238,12 @@ class Workspace {
    * not exist, a nullptr is returned.
    */
   Blob* GetBlob(const string& name);
+  /**
+   * Gets the blob of the given id, see InternBlobName(). If the blob does not
+   * exist, a nullptr is returned.
+   */
+  const Blob* GetBlob(int id) const;
+  Blob* GetBlob(int id);
 
   /**
    * Renames a local workspace blob. If blob is not found in the local blob list
@@ -288,7 +317,13 @@ class Workspace {
   std::atomic<int> last_failed_op_net_position;
 
  private:
+  Blob* AddLocalBlob(const string& name);
+  // The blob of the given id, or nullptr without a warning
+  const Blob* FindBlob(int id) const;
+
   BlobMap blob_map_;
+  // The blobs of blob_map_ by the ids of their names
+  std::unordered_map<int, Blob*> blob_ids_;
   NetMap net_map_;
   const string root_folder_;
   const Workspace* shared_;
@@ -115,4 +115,48 @@ TEST(WorkspaceTest, BlobMapping) {
   }
 }
 
+TEST(WorkspaceTest, BlobIds) {
+  int a = Workspace::InternBlobName("a");
+  int b = Workspace::InternBlobName("b");
+  int inner_a = Workspace::InternBlobName("inner_a");
+  EXPECT_NE(a, b);
+  EXPECT_EQ(a, Workspace::InternBlobName("a"));
+  EXPECT_EQ("b", Workspace::InternedBlobName(b));
+
+  Workspace parent;
+  EXPECT_FALSE(parent.HasBlob(a));
+  EXPECT_FALSE(parent.GetBlob(a));
+  Blob* blob = parent.CreateBlob(a);
+  EXPECT_TRUE(blob);
+  EXPECT_EQ(blob, parent.GetBlob("a"));
+  EXPECT_EQ(blob, parent.GetBlob(a));
+  EXPECT_EQ(blob, parent.CreateBlob(a));
+  {
+    Workspace child(&parent);
+    // Child finds parent blobs by id, and creates local ones
+    EXPECT_EQ(blob, child.GetBlob(a));
+    EXPECT_EQ(blob, child.CreateBlob(a));
+    EXPECT_TRUE(child.CreateBlob("b"));
+    EXPECT_EQ(child.GetBlob("b"), child.GetBlob(b));
+    EXPECT_FALSE(parent.HasBlob(b));
+    // Local blobs hide parent blobs
+    Blob* local = child.CreateLocalBlob("a");
+    EXPECT_NE(blob, local);
+    EXPECT_EQ(local, child.GetBlob(a));
+    EXPECT_TRUE(child.RemoveBlob("a"));
+    EXPECT_EQ(blob, child.GetBlob(a));
+  }
+  {
+    std::unordered_map<string, string> forwarded_blobs;
+    forwarded_blobs["inner_a"] = "a";
+    Workspace child(&parent, forwarded_blobs);
+    EXPECT_FALSE(child.HasBlob(a));
+    EXPECT_EQ(blob, child.GetBlob(inner_a));
+  }
+  // Renamed blobs move to the id of their new name
+  EXPECT_EQ(blob, parent.RenameBlob("a", "b"));
+  EXPECT_FALSE(parent.HasBlob(a));
+  EXPECT_EQ(blob, parent.GetBlob(b));
+}
+
 }  // namespace caffe2
@@ -3,7 +3,22 @@
 namespace caffe2 {
 REGISTER_CPU_OPERATOR(CreateDB, CreateDBOp<CPUContext>);
 
-OPERATOR_SCHEMA(CreateDB).NumInputs(0).NumOutputs(1);
+OPERATOR_SCHEMA(CreateDB)
+    .NumInputs(0)
+    .NumOutputs(1)
+    .Arg("db_type", "Type of the db, e.g. leveldb, lmdb or minidb")
+    .Arg("db", "Path of the db")
+    .Arg("num_shards", "(int, default 1) Number of shards the db is read in")
+    .Arg("shard_id", "(int, default 0) Shard of the db this reader reads")
+    .Arg(
+        "shard_by_range",
+        "(bool, default false) Read a contiguous range of the entries as the "
+        "shard, instead of every num_shards-th entry, so the reader does not "
+        "move over the whole db")
+    .Arg(
+        "prefetch",
+        "(int, default 0) If positive, read ahead on a background thread in "
+        "batches of this many entries");
 
 NO_GRADIENT(CreateDB);
 }  // namespace caffe2
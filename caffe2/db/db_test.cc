@@ -196,5 +196,59 @@ TEST(DBReaderShardedTest, Reader) {
   EXPECT_EQ(value, "05");
 }
 
+TEST(PrefetchCursorTest, Cursor) {
+  std::string name = std::tmpnam(nullptr);
+  CreateAndFill("minidb", name);
+  std::unique_ptr<DB> db(CreateDB("minidb", name, READ));
+  // batches that do not divide the db
+  PrefetchCursor cursor(db->NewCursor(), 3, 2);
+  for (int pass = 0; pass < 2; ++pass) {
+    for (int i = 0; i < kMaxItems; ++i) {
+      std::stringstream ss;
+      ss << std::setw(2) << std::setfill('0') << i;
+      EXPECT_TRUE(cursor.Valid());
+      EXPECT_EQ(cursor.key(), ss.str());
+      EXPECT_EQ(cursor.value(), ss.str());
+      cursor.Next();
+    }
+    EXPECT_FALSE(cursor.Valid());
+    cursor.SeekToFirst();
+  }
+  EXPECT_EQ(cursor.key(), "00");
+}
+
+TEST(DBReaderShardedTest, RangeReader) {
+  std::string name = std::tmpnam(nullptr);
+  CreateAndFill("minidb", name);
+  string key;
+  string value;
+  // shards of 3, 3 and 4 entries
+  DBReader reader0("minidb", name, 3, 0, 0, true);
+  for (const char* expected : {"00", "01", "02", "00"}) {
+    reader0.Read(&key, &value);
+    EXPECT_EQ(key, expected);
+    EXPECT_EQ(value, expected);
+  }
+  DBReader reader2("minidb", name, 3, 2, 2, true);
+  for (const char* expected : {"06", "07", "08", "09", "06", "07"}) {
+    reader2.Read(&key, &value);
+    EXPECT_EQ(key, expected);
+    EXPECT_EQ(value, expected);
+  }
+}
+
+TEST(DBReaderTest, PrefetchReader) {
+  std::string name = std::tmpnam(nullptr);
+  CreateAndFill("minidb", name);
+  DBReader reader("minidb", name, 2, 1, 4);
+  string key;
+  string value;
+  for (const char* expected : {"01", "03", "05", "07", "09", "01"}) {
+    reader.Read(&key, &value);
+    EXPECT_EQ(key, expected);
+    EXPECT_EQ(value, expected);
+  }
+}
+
 }  // namespace db
 }  // namespace caffe2
@@ -68,6 +68,14 @@ class LMDBCursor : public Cursor {
         mdb_value_.mv_size);
   }
 
+  // The values live in the memory map of the db, and stay valid until the
+  // read-only transaction of the cursor ends
+  bool RawValue(const char** data, size_t* size) override {
+    *data = static_cast<const char*>(mdb_value_.mv_data);
+    *size = mdb_value_.mv_size;
+    return true;
+  }
+
   bool Valid() override { return valid_; }
 
  private:
@@ -133,6 +141,11 @@ class LMDB : public DB {
   unique_ptr<Transaction> NewTransaction() override {
     return make_unique<LMDBTransaction>(mdb_env_);
   }
+  int64_t NumEntries() override {
+    MDB_stat stat;
+    MDB_CHECK(mdb_env_stat(mdb_env_, &stat));
+    return stat.ms_entries;
+  }
 
  private:
   MDB_env* mdb_env_;
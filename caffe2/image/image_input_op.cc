@@ -86,6 +86,9 @@ The dimension of the output image will always be cropxcrop
     .Arg("use_caffe_datum", "1 if the input is in Caffe format. Defaults to 0")
     .Arg("use_gpu_transform", "1 if GPU acceleration should be used."
          " Defaults to 0. Can only be 1 in a CUDAContext")
+    .Arg("use_gpu_augmentation", "1 if the decode threads should only decode,"
+         " and the images be scaled, cropped and mirrored on the GPU while"
+         " prefetching. Requires use_gpu_transform. Defaults to 0")
     .Arg("decode_threads", "Number of CPU decode/transform threads."
          " Defaults to 4")
     .Arg("output_type", "If gpu_transform, can set to FLOAT or FLOAT16.")
@@ -4,6 +4,7 @@
 
 #include <opencv2/opencv.hpp>
 
+#include <cstring>
 #include <iostream>
 #include <algorithm>
 
@@ -76,13 +77,19 @@ class ImageInputOp final
 
   bool GetImageAndLabelAndInfoFromDBValue(
       const string& value, cv::Mat* img, PerImageArg& info, int item_id,
-      std::mt19937* randgen);
+      std::mt19937* randgen, bool scale = true);
+  void GetScaledSize(
+      int rows, int cols, std::mt19937* randgen, int* scaled_height,
+      int* scaled_width);
   void DecodeAndTransform(
       const std::string& value, float *image_data, int item_id,
       const int channels, std::size_t thread_index);
   void DecodeAndTransposeOnly(
       const std::string& value, uint8_t *image_data, int item_id,
       const int channels, std::size_t thread_index);
+  void DecodeAndPlanCrop(
+      const std::string& value, int item_id, const int channels,
+      std::size_t thread_index);
 
   unique_ptr<db::DBReader> owned_reader_;
   const db::DBReader* reader_;
@@ -124,8 +131,19 @@ class ImageInputOp final
   bool is_test_;
   bool use_caffe_datum_;
   bool gpu_transform_;
+  bool gpu_augmentation_;
   bool mean_std_copied_ = false;
 
+  // With gpu_augmentation_, the decoded images of a batch, where to crop them
+  // and whether to mirror them (see ScaleAndCropOnGPU)
+  std::vector<cv::Mat> decoded_images_;
+  TensorCPU prefetched_decoded_;
+  TensorCPU prefetched_layouts_;
+  TensorCPU prefetched_regions_;
+  Tensor<Context> prefetched_decoded_on_device_;
+  Tensor<Context> prefetched_layouts_on_device_;
+  Tensor<Context> prefetched_regions_on_device_;
+
   // thread pool for parse + decode
   int num_decode_threads_;
   int additional_inputs_offset_;
@@ -191,6 +209,9 @@ ImageInputOp<Context>::ImageInputOp(
       gpu_transform_(OperatorBase::template GetSingleArgument<int>(
           "use_gpu_transform",
           0)),
+      gpu_augmentation_(OperatorBase::template GetSingleArgument<int>(
+          "use_gpu_augmentation",
+          0)),
       num_decode_threads_(
           OperatorBase::template GetSingleArgument<int>("decode_threads", 4)),
       thread_pool_(std::make_shared<TaskThreadPool>(num_decode_threads_)),
@@ -287,6 +308,13 @@ ImageInputOp<Context>::ImageInputOp(
       "If the output sizes are specified, they must be specified for all "
       "additional outputs");
 
+  CAFFE_ENFORCE(
+      !gpu_augmentation_ || gpu_transform_,
+      "use_gpu_augmentation requires use_gpu_transform");
+  CAFFE_ENFORCE(
+      !(gpu_augmentation_ && std::is_same<Context, CPUContext>::value),
+      "use_gpu_augmentation is only supported with CUDA");
+
   CAFFE_ENFORCE(random_scale_.size() == 2,
       "Must provide [scale_min, scale_max]");
   CAFFE_ENFORCE_GE(random_scale_[1], random_scale_[0],
@@ -312,6 +340,9 @@ ImageInputOp<Context>::ImageInputOp(
   if (gpu_transform_) {
     LOG(INFO) << "    Performing transformation on GPU";
   }
+  if (gpu_augmentation_) {
+    LOG(INFO) << "    Scaling, cropping and mirroring on GPU";
+  }
   LOG(INFO) << "    Outputting in batches of " << batch_size_ << " images;";
   LOG(INFO) << "    Treating input image as "
             << (color_ ? "color " : "grayscale ") << "image;";
@@ -375,6 +406,11 @@ ImageInputOp<Context>::ImageInputOp(
   } else {
     prefetched_label_.Resize(vector<TIndex>(1, batch_size_));
   }
+  if (gpu_augmentation_) {
+    decoded_images_.resize(batch_size_);
+    prefetched_layouts_.Resize(TIndex(batch_size_), TIndex(4));
+    prefetched_regions_.Resize(TIndex(batch_size_), TIndex(4));
+  }
 
   for (int i = 0; i < additional_output_sizes.size(); ++i) {
     prefetched_additional_outputs_[i].Resize(
@@ -382,21 +418,18 @@ ImageInputOp<Context>::ImageInputOp(
   }
 }
 
-// Inception-stype scale jittering
-template <class Context>
-bool RandomSizedCropping(
-  cv::Mat* img,
-  const int crop,
-  std::mt19937* randgen
+// Picks the region of an im_height x im_width image that inception-style
+// scale jittering crops. Returns false if none was found.
+inline bool RandomSizedCrop(
+  const int im_height,
+  const int im_width,
+  std::mt19937* randgen,
+  cv::Rect* roi
 ) {
-  cv::Mat scaled_img;
-  bool inception_scale_jitter = false;
-  int im_height = img->rows, im_width = img->cols;
   int area = im_height * im_width;
   std::uniform_real_distribution<> area_dis(0.08, 1.0);
   std::uniform_real_distribution<> aspect_ratio_dis(3.0 / 4.0, 4.0 / 3.0);
 
-  cv::Mat cropping;
   for (int i = 0; i < 10; ++i) {
     int target_area = int(ceil(area_dis(*randgen) * area));
     float aspect_ratio = aspect_ratio_dis(*randgen);
@@ -407,21 +440,34 @@ bool RandomSizedCropping(
         0, im_height - nh)(*randgen);
       int width_offset = std::uniform_int_distribution<>(
         0,im_width - nw)(*randgen);
-      cv::Rect ROI(width_offset, height_offset, nw, nh);
-      cropping = (*img)(ROI);
-      cv::resize(
-          cropping,
-          scaled_img,
-          cv::Size(crop, crop),
-          0,
-          0,
-          cv::INTER_AREA);
-      *img = scaled_img;
-      inception_scale_jitter = true;
-      break;
+      *roi = cv::Rect(width_offset, height_offset, nw, nh);
+      return true;
     }
   }
-  return inception_scale_jitter;
+  return false;
+}
+
+// Inception-stype scale jittering
+template <class Context>
+bool RandomSizedCropping(
+  cv::Mat* img,
+  const int crop,
+  std::mt19937* randgen
+) {
+  cv::Rect ROI;
+  if (!RandomSizedCrop(img->rows, img->cols, randgen, &ROI)) {
+    return false;
+  }
+  cv::Mat scaled_img;
+  cv::resize(
+      (*img)(ROI),
+      scaled_img,
+      cv::Size(crop, crop),
+      0,
+      0,
+      cv::INTER_AREA);
+  *img = scaled_img;
+  return true;
 }
 
 template <class Context>
@@ -430,7 +476,8 @@ bool ImageInputOp<Context>::GetImageAndLabelAndInfoFromDBValue(
     cv::Mat* img,
     PerImageArg& info,
     int item_id,
-    std::mt19937* randgen) {
+    std::mt19937* randgen,
+    bool scale) {
   //
   // recommend using --caffe2_use_fatal_for_enforce=1 when using ImageInputOp
   // as this function runs on a worker thread and the exceptions from
@@ -676,6 +723,10 @@ bool ImageInputOp<Context>::GetImageAndLabelAndInfoFromDBValue(
     // LOG(INFO) << "No bounding\n";
   }
 
+  if (!scale) {
+    return true;
+  }
+
   cv::Mat scaled_img;
   bool inception_scale_jitter = false;
   if (scale_jitter_type_ == INCEPTION_STYLE) {
@@ -689,31 +740,9 @@ bool ImageInputOp<Context>::GetImageAndLabelAndInfoFromDBValue(
   if ((scale_jitter_type_ == NO_SCALE_JITTER) ||
     (scale_jitter_type_ == INCEPTION_STYLE && !inception_scale_jitter)) {
       int scaled_width, scaled_height;
-      int scale_to_use = scale_ > 0 ? scale_ : minsize_;
-
-      // set the random minsize
-      if (random_scaling_) {
-        scale_to_use = std::uniform_int_distribution<>(random_scale_[0],
-                                                       random_scale_[1])(*randgen);
-      }
-
-      if (warp_) {
-        scaled_width = scale_to_use;
-        scaled_height = scale_to_use;
-      } else if (img->rows > img->cols) {
-        scaled_width = scale_to_use;
-        scaled_height =
-            static_cast<float>(img->rows) * scale_to_use / img->cols;
-      } else {
-        scaled_height = scale_to_use;
-        scaled_width =
-            static_cast<float>(img->cols) * scale_to_use / img->rows;
-      }
-      if ((scale_ > 0 &&
-           (scaled_height != img->rows || scaled_width != img->cols))
-          || (scaled_height > img->rows || scaled_width > img->cols)) {
-        // We rescale in all cases if we are using scale_
-        // but only to make the image bigger if using minsize_
+      GetScaledSize(img->rows, img->cols, randgen, &scaled_height,
+                    &scaled_width);
+      if (scaled_height != img->rows || scaled_width != img->cols) {
         /*
         LOG(INFO) << "Scaling to " << scaled_width << " x " << scaled_height
                   << " From " << img->cols << " x " << img->rows;
@@ -732,6 +761,41 @@ bool ImageInputOp<Context>::GetImageAndLabelAndInfoFromDBValue(
   return true;
 }
 
+// The size a rows x cols image is scaled to before cropping it, unless
+// inception-style scale jittering crops it
+template <class Context>
+void ImageInputOp<Context>::GetScaledSize(
+    int rows,
+    int cols,
+    std::mt19937* randgen,
+    int* scaled_height,
+    int* scaled_width) {
+  int scale_to_use = scale_ > 0 ? scale_ : minsize_;
+
+  // set the random minsize
+  if (random_scaling_) {
+    scale_to_use = std::uniform_int_distribution<>(random_scale_[0],
+                                                   random_scale_[1])(*randgen);
+  }
+
+  if (warp_) {
+    *scaled_width = scale_to_use;
+    *scaled_height = scale_to_use;
+  } else if (rows > cols) {
+    *scaled_width = scale_to_use;
+    *scaled_height = static_cast<float>(rows) * scale_to_use / cols;
+  } else {
+    *scaled_height = scale_to_use;
+    *scaled_width = static_cast<float>(cols) * scale_to_use / rows;
+  }
+  // We rescale in all cases if we are using scale_
+  // but only to make the image bigger if using minsize_
+  if (scale_ <= 0 && *scaled_height <= rows && *scaled_width <= cols) {
+    *scaled_height = rows;
+    *scaled_width = cols;
+  }
+}
+
 // assume HWC order and color channels BGR
 template <class Context>
 void Saturation(
@@ -1062,6 +1126,67 @@ void ImageInputOp<Context>::DecodeAndTransposeOnly(
                               randgen, &mirror_this_image, is_test_);
 }
 
+// Only decode the image, and pick the region ScaleAndCropOnGPU scales to
+// crop x crop and whether it mirrors it, drawing the same random numbers as
+// DecodeAndTransposeOnly
+template <class Context>
+void ImageInputOp<Context>::DecodeAndPlanCrop(
+    const std::string& value, int item_id, const int channels,
+    std::size_t thread_index) {
+
+  CAFFE_ENFORCE((int)thread_index < num_decode_threads_);
+
+  std::bernoulli_distribution mirror_this_image(0.5f);
+  std::mt19937* randgen = &(randgen_per_thread_[thread_index]);
+
+  cv::Mat& img = decoded_images_[item_id];
+  // Decode the image
+  PerImageArg info;
+  CHECK(GetImageAndLabelAndInfoFromDBValue(value, &img, info, item_id,
+    randgen, false));
+  CAFFE_ENFORCE_EQ(img.channels(), channels);
+
+  float* region = prefetched_regions_.mutable_data<float>() + 4 * item_id;
+  cv::Rect roi;
+  if (scale_jitter_type_ == INCEPTION_STYLE && !is_test_ &&
+      RandomSizedCrop(img.rows, img.cols, randgen, &roi)) {
+    region[0] = roi.x;
+    region[1] = roi.y;
+    region[2] = roi.width;
+    region[3] = roi.height;
+  } else {
+    int scaled_height, scaled_width;
+    GetScaledSize(img.rows, img.cols, randgen, &scaled_height, &scaled_width);
+    CAFFE_ENFORCE_GE(
+        scaled_height, crop_, "Image height must be bigger than crop.");
+    CAFFE_ENFORCE_GE(
+        scaled_width, crop_, "Image width must be bigger than crop.");
+
+    int width_offset, height_offset;
+    if (is_test_) {
+      width_offset = (scaled_width - crop_) / 2;
+      height_offset = (scaled_height - crop_) / 2;
+    } else {
+      width_offset =
+        std::uniform_int_distribution<>(0, scaled_width - crop_)(*randgen);
+      height_offset =
+        std::uniform_int_distribution<>(0, scaled_height - crop_)(*randgen);
+    }
+    // the crop of the scaled image, in pixels of the decoded one
+    const float sx = static_cast<float>(img.cols) / scaled_width;
+    const float sy = static_cast<float>(img.rows) / scaled_height;
+    region[0] = width_offset * sx;
+    region[1] = height_offset * sy;
+    region[2] = crop_ * sx;
+    region[3] = crop_ * sy;
+  }
+
+  int64_t* layout = prefetched_layouts_.mutable_data<int64_t>() + 4 * item_id;
+  layout[1] = img.rows;
+  layout[2] = img.cols;
+  layout[3] = mirror_ && mirror_this_image(*randgen);
+}
+
 
 template <class Context>
 bool ImageInputOp<Context>::Prefetch() {
@@ -1073,7 +1198,10 @@ bool ImageInputOp<Context>::Prefetch() {
   }
   const int channels = color_ ? 3 : 1;
   // Call mutable_data() once to allocate the underlying memory.
-  if (gpu_transform_) {
+  if (gpu_augmentation_) {
+    prefetched_layouts_.mutable_data<int64_t>();
+    prefetched_regions_.mutable_data<float>();
+  } else if (gpu_transform_) {
     // we'll transfer up in int8, then convert later
     prefetched_image_.mutable_data<uint8_t>();
   } else {
@@ -1127,7 +1255,15 @@ bool ImageInputOp<Context>::Prefetch() {
 
     // launch into thread pool for processing
     // TODO: support color jitter and color lighting in gpu_transform
-    if (gpu_transform_) {
+    if (gpu_augmentation_) {
+      thread_pool_->runTaskWithID(std::bind(
+          &ImageInputOp<Context>::DecodeAndPlanCrop,
+          this,
+          std::string(value),
+          item_id,
+          channels,
+          std::placeholders::_1));
+    } else if (gpu_transform_) {
       // output of decode will still be int8
       uint8_t* image_data = prefetched_image_.mutable_data<uint8_t>() +
           crop_ * crop_ * channels * item_id;
@@ -1154,10 +1290,44 @@ bool ImageInputOp<Context>::Prefetch() {
   }
   thread_pool_->waitWorkComplete();
 
+  if (gpu_augmentation_) {
+    // pack the decoded images one after the other
+    int64_t* layouts = prefetched_layouts_.mutable_data<int64_t>();
+    TIndex size = 0;
+    for (int item_id = 0; item_id < batch_size_; ++item_id) {
+      layouts[4 * item_id] = size;
+      size += decoded_images_[item_id].total() * channels;
+    }
+    prefetched_decoded_.Resize(size);
+    uint8_t* decoded = prefetched_decoded_.mutable_data<uint8_t>();
+    for (int item_id = 0; item_id < batch_size_; ++item_id) {
+      cv::Mat& img = decoded_images_[item_id];
+      const size_t row_size = img.cols * channels;
+      for (int h = 0; h < img.rows; ++h) {
+        memcpy(decoded, img.ptr(h), row_size);
+        decoded += row_size;
+      }
+      img.release();
+    }
+  }
+
   // If the context is not CPUContext, we will need to do a copy in the
   // prefetch function as well.
   if (!std::is_same<Context, CPUContext>::value) {
-    prefetched_image_on_device_.CopyFrom(prefetched_image_, &context_);
+    if (gpu_augmentation_) {
+      // scaled and cropped here rather than in CopyPrefetched, so that it
+      // overlaps with the computation on the batch before
+      prefetched_decoded_on_device_.CopyFrom(prefetched_decoded_, &context_);
+      prefetched_layouts_on_device_.CopyFrom(prefetched_layouts_, &context_);
+      prefetched_regions_on_device_.CopyFrom(prefetched_regions_, &context_);
+      ScaleAndCropOnGPU<Context>(prefetched_decoded_on_device_,
+                                 prefetched_layouts_on_device_,
+                                 prefetched_regions_on_device_, crop_,
+                                 channels, &prefetched_image_on_device_,
+                                 &context_);
+    } else {
+      prefetched_image_on_device_.CopyFrom(prefetched_image_, &context_);
+    }
     prefetched_label_on_device_.CopyFrom(prefetched_label_, &context_);
 
     for (int i = 0; i < prefetched_additional_outputs_on_device_.size(); ++i) {
@@ -46,6 +46,91 @@ __global__ void transform_kernel(
   }
 }
 
+// The source pixels [begin, end) along one axis that make up an output pixel
+// covering [lo, lo + scale) of the source, and their weights
+struct Taps {
+  __device__ Taps(float lo, float scale, int size) {
+    area_ = scale >= 1.f;
+    if (area_) {
+      lo_ = lo;
+      hi_ = lo + scale;
+      inv_scale_ = 1.f / scale;
+      begin = max(static_cast<int>(floorf(lo_)), 0);
+      end = min(static_cast<int>(ceilf(hi_)), size);
+    } else {
+      // between the two source pixels nearest to the center
+      float center = lo + 0.5f * scale - 0.5f;
+      int left = static_cast<int>(floorf(center));
+      frac_ = center - left;
+      begin = max(left, 0);
+      end = min(left + 2, size);
+      left_ = left;
+      if (left < 0) {
+        frac_ = 1.f;
+      } else if (left + 1 >= size) {
+        frac_ = 0.f;
+      }
+    }
+  }
+
+  __device__ float weight(int i) const {
+    if (area_) {
+      return (fminf(hi_, i + 1.f) - fmaxf(lo_, static_cast<float>(i))) *
+          inv_scale_;
+    }
+    return i == left_ ? 1.f - frac_ : frac_;
+  }
+
+  int begin;
+  int end;
+
+ private:
+  bool area_;
+  float lo_, hi_, inv_scale_;
+  int left_;
+  float frac_;
+};
+
+// One block per image; images and output in HWC
+__global__ void scale_and_crop_kernel(
+    const int crop,
+    const int C,
+    const uint8_t* images,
+    const int64_t* layouts,
+    const float* regions,
+    uint8_t* out) {
+  const int n = blockIdx.x;
+  const uint8_t* image = images + layouts[4 * n];
+  const int H = layouts[4 * n + 1];
+  const int W = layouts[4 * n + 2];
+  const bool mirror = layouts[4 * n + 3];
+  const float x0 = regions[4 * n];
+  const float y0 = regions[4 * n + 1];
+  const float sx = regions[4 * n + 2] / crop;
+  const float sy = regions[4 * n + 3] / crop;
+  uint8_t* output = out + n * crop * crop * C;
+
+  for (int h = threadIdx.y; h < crop; h += blockDim.y) {
+    Taps ys(y0 + h * sy, sy, H);
+    for (int w = threadIdx.x; w < crop; w += blockDim.x) {
+      // mirroring reverses the order of the output columns
+      Taps xs(x0 + (mirror ? crop - 1 - w : w) * sx, sx, W);
+      for (int c = 0; c < C; ++c) {
+        float sum = 0.f;
+        for (int y = ys.begin; y < ys.end; ++y) {
+          float row = 0.f;
+          for (int x = xs.begin; x < xs.end; ++x) {
+            row += xs.weight(x) * image[(y * W + x) * C + c];
+          }
+          sum += ys.weight(y) * row;
+        }
+        output[(h * crop + w) * C + c] =
+            static_cast<uint8_t>(fminf(fmaxf(sum + 0.5f, 0.f), 255.f));
+      }
+    }
+  }
+}
+
 }
 
 template <typename T_IN, typename T_OUT, class Context>
@@ -68,6 +153,28 @@ bool TransformOnGPU(Tensor<Context>& X, Tensor<Context> *Y,
   return true;
 };
 
+template <class Context>
+bool ScaleAndCropOnGPU(const Tensor<Context>& images,
+                       const Tensor<Context>& layouts,
+                       const Tensor<Context>& regions,
+                       int crop, int C, Tensor<Context>* Y,
+                       Context* context) {
+  const int N = layouts.dim32(0);
+  Y->Resize(std::vector<int>{N, crop, crop, C});
+  scale_and_crop_kernel<<<N, dim3(16, 16), 0, context->cuda_stream()>>>(
+      crop, C, images.template data<uint8_t>(),
+      layouts.template data<int64_t>(), regions.template data<float>(),
+      Y->template mutable_data<uint8_t>());
+  return true;
+}
+
+template bool ScaleAndCropOnGPU<CUDAContext>(const Tensor<CUDAContext>& images,
+                                             const Tensor<CUDAContext>& layouts,
+                                             const Tensor<CUDAContext>& regions,
+                                             int crop, int C,
+                                             Tensor<CUDAContext>* Y,
+                                             CUDAContext* context);
+
 template bool TransformOnGPU<uint8_t, float, CUDAContext>(Tensor<CUDAContext>& X,
                                                           Tensor<CUDAContext> *Y,
                                                           Tensor<CUDAContext>& mean,
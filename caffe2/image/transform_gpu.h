@@ -35,6 +35,20 @@ bool TransformOnGPU(Tensor<Context>& X, Tensor<Context>* Y,
                     Tensor<Context>& mean, Tensor<Context>& std,
                     Context* context);
 
+// Scales and crops N images of C channels, decoded as uint8 HWC and packed one
+// after the other in images, to Y (N x crop x crop x C, uint8). Row n of
+// layouts holds the offset of image n in images, its height and width, and
+// whether to mirror it. Row n of regions holds the left, top, width and height
+// of the part of it that is scaled to crop x crop, in its pixels. Downscaling
+// averages the pixels covered by each output pixel, as cv::INTER_AREA does,
+// and upscaling interpolates linearly.
+template <class Context>
+bool ScaleAndCropOnGPU(const Tensor<Context>& images,
+                       const Tensor<Context>& layouts,
+                       const Tensor<Context>& regions,
+                       int crop, int C, Tensor<Context>* Y,
+                       Context* context);
+
 }  // namespace caffe2
 
 #endif
@@ -37,12 +37,7 @@ bool NNApi::loadNNApiLibrary() {
 }
 
 NNApi::~NNApi() {
-  if (run_end_) {
-    libnnapi_.ANeuralNetworksEvent_free(run_end_);
-  }
-  if (run_) {
-    libnnapi_.ANeuralNetworksExecution_free(run_);
-  }
+  freeExecution();
   if (compilation_) {
     libnnapi_.ANeuralNetworksCompilation_free(compilation_);
   }
@@ -51,34 +46,117 @@ NNApi::~NNApi() {
   }
 }
 
+const std::unordered_map<std::string, NNApi::OperatorType>&
+NNApi::operatorMap() {
+  static const std::unordered_map<std::string, OperatorType> operator_map{
+      {"AveragePool", AVERAGEPOOL},
+      {"Conv", CONV},
+      {"MaxPool", MAXPOOL},
+      {"Relu", RELU},
+      {"Softmax", SOFTMAX}};
+  return operator_map;
+}
+
+bool NNApi::isSupported(const OperatorDef& op) {
+  const auto found = operatorMap().find(op.type());
+  if (found == operatorMap().end()) {
+    return false;
+  }
+  ArgumentHelper helper(op);
+  switch (found->second) {
+    case AVERAGEPOOL:
+    case MAXPOOL:
+    case CONV: {
+      if (helper.GetSingleArgument<std::string>("order", "NCHW") != "NHWC") {
+        return false;
+      }
+      if (helper.GetSingleArgument<int>("global_pooling", 0)) {
+        return false;
+      }
+      ConvPoolArgs args;
+      getConvPoolArgs(helper, args);
+      if (args.stride_x != args.stride_y) {
+        return false;
+      }
+      if (found->second != CONV) {
+        return op.input_size() == 1 && op.output_size() == 1;
+      }
+      for (auto d : helper.GetRepeatedArgument<int>("dilations")) {
+        if (d != 1) {
+          return false;
+        }
+      }
+      if (helper.GetSingleArgument<int>("dilation", 1) != 1) {
+        return false;
+      }
+      return op.input_size() == 3 && op.output_size() == 1;
+    }
+    case RELU:
+      return op.input_size() == 1 && op.output_size() == 1;
+    case SOFTMAX:
+      return helper.GetSingleArgument<int>("axis", 1) == 1 &&
+          op.input_size() == 1 && op.output_size() == 1;
+    default:
+      return false;
+  }
+}
+
 bool NNApi::run(const TensorVector& inputs, TensorVector* outputs) {
+  return runAsync(inputs, outputs) && wait();
+}
+
+bool NNApi::runAsync(const TensorVector& inputs, TensorVector* outputs) {
   CAFFE_ENFORCE(inputs.size() <= run_net_.external_input_size());
   try {
-    init(inputs, outputs);
+    init(inputs);
   } catch (const std::exception& e) {
     LOG(ERROR) << "Error duing model initialization: " << e.what();
     return false;
   }
 
   try {
+    prepareExecution(inputs, outputs);
     VLOG(1) << "Start compute";
     int result_code =
         libnnapi_.ANeuralNetworksExecution_startCompute(run_, &run_end_);
     if (result_code != ANEURALNETWORKS_NO_ERROR) {
       reportError(result_code);
     }
-    result_code = libnnapi_.ANeuralNetworksEvent_wait(run_end_);
+  } catch (const std::exception& e) {
+    LOG(ERROR) << "Error during model run: " << e.what();
+    return false;
+  }
+  return true;
+}
+
+bool NNApi::wait() {
+  CAFFE_ENFORCE(run_end_, "No execution was started");
+  try {
+    int result_code = libnnapi_.ANeuralNetworksEvent_wait(run_end_);
     if (result_code != ANEURALNETWORKS_NO_ERROR) {
       reportError(result_code);
     }
     VLOG(1) << "Finish compute";
   } catch (const std::exception& e) {
     LOG(ERROR) << "Error during model run: " << e.what();
+    freeExecution();
     return false;
   }
+  freeExecution();
   return true;
 }
 
+void NNApi::freeExecution() {
+  if (run_end_) {
+    libnnapi_.ANeuralNetworksEvent_free(run_end_);
+    run_end_ = nullptr;
+  }
+  if (run_) {
+    libnnapi_.ANeuralNetworksExecution_free(run_);
+    run_ = nullptr;
+  }
+}
+
 void NNApi::getConvPoolArgs(const ArgumentHelper& helper, ConvPoolArgs& args) {
   std::vector<int> kernel(helper.GetRepeatedArgument<int>("kernels"));
   std::vector<int> stride(helper.GetRepeatedArgument<int>("strides"));
@@ -532,7 +610,7 @@ uint32_t NNApi::addTensorOperand(
   return operand_map_[blob];
 }
 
-void NNApi::init(const TensorVector& inputs, TensorVector* outputs) {
+void NNApi::init(const TensorVector& inputs) {
   // model
   if (!model_) {
     int result_code = libnnapi_.ANeuralNetworksModel_create(&model_);
@@ -568,10 +646,11 @@ void NNApi::init(const TensorVector& inputs, TensorVector* outputs) {
 
     // add operands and operations
     for (const auto& op : run_net_.op()) {
-      if (operator_map_.count(op.type()) == 0) {
+      const auto found = operatorMap().find(op.type());
+      if (found == operatorMap().end()) {
         CAFFE_THROW("Unsupported operator");
       }
-      switch (operator_map_[op.type()]) {
+      switch (found->second) {
         case AVERAGEPOOL:
           addPooling(op, ANEURALNETWORKS_AVERAGE_POOL_2D);
           break;
@@ -642,73 +721,76 @@ void NNApi::init(const TensorVector& inputs, TensorVector* outputs) {
 
       LOG(INFO) << "Finish compilation";
     }
+  }
+}
 
-    // pre-execution
-    if (!run_) {
-      result_code =
-          libnnapi_.ANeuralNetworksExecution_create(compilation_, &run_);
-      if (result_code != ANEURALNETWORKS_NO_ERROR) {
-        reportError(result_code);
-      }
-      LOG(INFO) << "Created model execution";
-    }
+void NNApi::prepareExecution(
+    const TensorVector& inputs,
+    TensorVector* outputs) {
+  freeExecution();
+  int result_code =
+      libnnapi_.ANeuralNetworksExecution_create(compilation_, &run_);
+  if (result_code != ANEURALNETWORKS_NO_ERROR) {
+    reportError(result_code);
+  }
+  VLOG(1) << "Created model execution";
 
-    // set external input and output
-    for (int i = 0; i < inputs.size(); i++) {
-      result_code = libnnapi_.ANeuralNetworksExecution_setInput(
-          run_, i, NULL, inputs[i]->raw_data(), inputs[i]->size());
-      if (result_code != ANEURALNETWORKS_NO_ERROR) {
-        reportError(result_code);
-      }
+  // set external input and output
+  for (int i = 0; i < inputs.size(); i++) {
+    result_code = libnnapi_.ANeuralNetworksExecution_setInput(
+        run_, i, NULL, inputs[i]->raw_data(), inputs[i]->nbytes());
+    if (result_code != ANEURALNETWORKS_NO_ERROR) {
+      reportError(result_code);
+    }
 
-      VLOG(1) << "Set external input " << i << " at " << inputs[i]->raw_data()
-              << ", size = " << inputs[i]->size();
+    VLOG(1) << "Set external input " << i << " at " << inputs[i]->raw_data()
+            << ", size = " << inputs[i]->size();
+  }
+  // allocate memory for outputs
+  const int output_size = run_net_.external_output_size();
+  const bool allocate_outputs = outputs->empty();
+  CAFFE_ENFORCE(
+      allocate_outputs || outputs->size() == output_size,
+      "Expected ",
+      output_size,
+      " output tensors, got ",
+      outputs->size());
+  for (int i = 0; i < output_size; i++) {
+    const std::string& blob = run_net_.external_output(i);
+    if (operand_map_.find(blob) == operand_map_.end()) {
+      CAFFE_THROW("Unknown external output, ", blob);
+    }
+    if (tensor_dims_.find(blob) == tensor_dims_.end()) {
+      CAFFE_THROW("Operand dimension unknown");
+    }
+    std::vector<int> output_dims;
+    for (auto dim : tensor_dims_[blob]) {
+      output_dims.push_back(dim);
     }
-    // allocate memory for outputs
-    for (int i = 0; i < output_size; i++) {
-      const std::string& blob = run_net_.external_output(i);
-      if (operand_map_.find(blob) == operand_map_.end()) {
-        CAFFE_THROW("Unknown external output, ", blob);
-      }
-      uint32_t idx = operand_map_[blob];
-      if (tensor_dims_.find(blob) == tensor_dims_.end()) {
-        CAFFE_THROW("Operand dimension unknown");
-      }
-      std::vector<int> output_dims;
-      for (auto dim : tensor_dims_[blob]) {
-        output_dims.push_back(dim);
-      }
 
-      auto* tensor = ws_.CreateBlob(blob)->GetMutable<TensorCPU>();
-      tensor->Resize(output_dims);
+    TensorCPU* tensor = nullptr;
+    if (allocate_outputs) {
+      tensor = ws_.CreateBlob(blob)->GetMutable<TensorCPU>();
       outputs->push_back(tensor);
+    } else {
+      tensor = (*outputs)[i];
+    }
+    tensor->Resize(output_dims);
 
-      if (tensor_type_ == ANEURALNETWORKS_TENSOR_FLOAT32) {
-        result_code = libnnapi_.ANeuralNetworksExecution_setOutput(
-            run_,
-            i,
-            NULL,
-            (void*)tensor->template mutable_data<float>(),
-            tensor->size());
-        if (result_code != ANEURALNETWORKS_NO_ERROR) {
-          reportError(result_code);
-        }
-
-      } else {
-        result_code = libnnapi_.ANeuralNetworksExecution_setOutput(
-            run_,
-            i,
-            NULL,
-            (void*)tensor->template mutable_data<uint8_t>(),
-            tensor->size());
-        if (result_code != ANEURALNETWORKS_NO_ERROR) {
-          reportError(result_code);
-        }
-      }
-
-      VLOG(1) << "Set external output " << i << " at " << tensor->raw_data()
-              << ", size = " << tensor->size();
+    void* data = nullptr;
+    if (tensor_type_ == ANEURALNETWORKS_TENSOR_FLOAT32) {
+      data = tensor->template mutable_data<float>();
+    } else {
+      data = tensor->template mutable_data<uint8_t>();
     }
+    result_code = libnnapi_.ANeuralNetworksExecution_setOutput(
+        run_, i, NULL, data, tensor->nbytes());
+    if (result_code != ANEURALNETWORKS_NO_ERROR) {
+      reportError(result_code);
+    }
+
+    VLOG(1) << "Set external output " << i << " at " << tensor->raw_data()
+            << ", size = " << tensor->size();
   }
 }
 
@@ -1,3 +1,5 @@
+#pragma once
+
 #include "caffe2/core/operator.h"
 #include "caffe2/core/tensor.h"
 #include "caffe2/core/types.h"
@@ -35,8 +37,24 @@ class NNApi {
 
   bool loadNNApiLibrary();
 
+  // Runs the model and waits for its completion. If outputs is empty, the
+  // output tensors are created in the internal workspace and appended to it,
+  // otherwise it must hold one tensor per external output of run_net, which
+  // are resized and written in place.
   bool run(const TensorVector& inputs, TensorVector* outputs);
 
+  // Asynchronous version of run(): schedules the execution and returns without
+  // waiting for it, so that the caller can do other work on the CPU meanwhile.
+  // The inputs must stay alive and the outputs must not be read until wait()
+  // returns.
+  bool runAsync(const TensorVector& inputs, TensorVector* outputs);
+
+  bool wait();
+
+  // Whether op can be translated to NN API, judging from its type and
+  // arguments only
+  static bool isSupported(const OperatorDef& op);
+
  private:
   dlnnapi libnnapi_;
   ANeuralNetworksModel* model_{nullptr};
@@ -62,12 +80,7 @@ class NNApi {
     SOFTMAX,
   };
 
-  std::unordered_map<std::string, OperatorType> operator_map_{
-      {"AveragePool", AVERAGEPOOL},
-      {"Conv", CONV},
-      {"MaxPool", MAXPOOL},
-      {"Relu", RELU},
-      {"Softmax", SOFTMAX}};
+  static const std::unordered_map<std::string, OperatorType>& operatorMap();
 
   struct ConvPoolArgs {
     int kernel_h{0};
@@ -80,7 +93,9 @@ class NNApi {
     int pad_r{0};
   };
 
-  void getConvPoolArgs(const ArgumentHelper& helper, ConvPoolArgs& args);
+  static void getConvPoolArgs(
+      const ArgumentHelper& helper,
+      ConvPoolArgs& args);
 
   uint32_t addScalarOperand(int32_t val);
 
@@ -93,8 +108,15 @@ class NNApi {
       float scale = 1.0,
       int32_t zero_point = 0);
 
-  // lazily initialize model_ in run()
-  void init(const TensorVector& inputs, TensorVector* outputs);
+  // lazily initialize model_ and compilation_ in run(), which are then reused
+  // by all the subsequent runs
+  void init(const TensorVector& inputs);
+
+  // An execution can only be computed once, so a new one is created for each
+  // run from the compiled model
+  void prepareExecution(const TensorVector& inputs, TensorVector* outputs);
+
+  void freeExecution();
 
   void addConv(const OperatorDef& op, bool fuse_relu = false);
 
@@ -21,6 +21,7 @@
 #include "caffe2/utils/math.h"
 #include "caffe2/utils/proto_utils.h"
 #include "nnapi.h"
+#include "nnapi_op.h"
 
 namespace caffe2 {
 
@@ -336,6 +337,72 @@ static double benchmark_conv_nnapi_int8(
   return double(timer.MilliSeconds()) / run;
 }
 
+static double benchmark_net(
+    Workspace* ws,
+    const NetDef& netdef,
+    int warmup = 5,
+    int run = 10) {
+  NetBase* net = ws->CreateNet(netdef, true);
+  CAFFE_ENFORCE(net);
+  // The first run also builds and compiles the NN API models
+  CAFFE_ENFORCE(net->Run());
+  for (int i = 0; i < warmup; i++) {
+    net->Run();
+  }
+  Timer timer;
+  timer.Start();
+  for (int i = 0; i < run; i++) {
+    net->Run();
+  }
+  return double(timer.MilliSeconds()) / run;
+}
+
+// A chain of 3x3 and 1x1 convolutions with relus, in which a
+// Sigmoid that NN API doesn't support splits the net into two subgraphs
+static NetDef partition_net(Workspace* ws, int C, int H, int W, int blocks) {
+  auto fill = [ws](const std::string& name, std::vector<int> dims) {
+    auto* t = ws->CreateBlob(name)->GetMutable<TensorCPU>();
+    t->Resize(dims);
+    CPUContext ctx;
+    math::RandGaussian<float, CPUContext>(
+        t->size(), 0, 0.1, t->mutable_data<float>(), &ctx);
+  };
+  fill("X_cpu", {1, H, W, C});
+
+  NetDef netdef;
+  netdef.set_name("partition");
+  netdef.add_external_input("X_cpu");
+  std::string blob = "X_cpu";
+  for (int i = 0; i < blocks; i++) {
+    for (int kernel : {3, 1}) {
+      const std::string name = caffe2::to_string(i) + "_" +
+          caffe2::to_string(kernel);
+      fill("W" + name, {C, kernel, kernel, C});
+      fill("B" + name, {C});
+      netdef.add_external_input("W" + name);
+      netdef.add_external_input("B" + name);
+
+      auto& op = *(netdef.add_op());
+      op.set_type("Conv");
+      op.add_input(blob);
+      op.add_input("W" + name);
+      op.add_input("B" + name);
+      op.add_output("C" + name);
+      op.add_arg()->CopyFrom(MakeArgument<std::string>("order", "NHWC"));
+      op.add_arg()->CopyFrom(MakeArgument<int>("kernel", kernel));
+      op.add_arg()->CopyFrom(MakeArgument<int>("pad", kernel / 2));
+
+      auto& relu = *(netdef.add_op());
+      relu.set_type(i == blocks / 2 && kernel == 1 ? "Sigmoid" : "Relu");
+      relu.add_input("C" + name);
+      relu.add_output("R" + name);
+      blob = "R" + name;
+    }
+  }
+  netdef.add_external_output(blob);
+  return netdef;
+}
+
 } // namespace
 
 } // namespace caffe2
@@ -463,4 +530,25 @@ int main(int argc, char** argv) {
       }
     }
   }
+  fflush(stdout);
+
+  // partitioned net
+  for (int space : {14, 28, 56}) {
+    for (int channel : {32, 128}) {
+      caffe2::Workspace net_ws(&ws);
+      const caffe2::NetDef netdef =
+          caffe2::partition_net(&net_ws, channel, space, space, 4);
+      const double cpu_time =
+          caffe2::benchmark_net(&net_ws, netdef, warmup, mainrun);
+      const double nn_time = caffe2::benchmark_net(
+          &net_ws, caffe2::OptimizeForNNApi(netdef), warmup, mainrun);
+      printf(
+          "Net: X: %ix%i  \tC: %i\tCaffe2 ms: %.2f\tNN-API + Caffe2 ms: %.2f\n",
+          space,
+          space,
+          channel,
+          cpu_time,
+          nn_time);
+    }
+  }
 }
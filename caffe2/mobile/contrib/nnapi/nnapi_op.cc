@@ -0,0 +1,168 @@
+#include "nnapi_op.h"
+
+#include <unordered_set>
+
+#include "caffe2/opt/backend_cutting.h"
+
+namespace caffe2 {
+
+NNApiOp::NNApiOp(const OperatorDef& operator_def, Workspace* ws)
+    : Operator<CPUContext>(operator_def, ws),
+      ws_(ws),
+      preference_(static_cast<PreferenceCode>(
+          OperatorBase::GetSingleArgument<int>(
+              "preference", ANEURALNETWORKS_PREFER_SUSTAINED_SPEED))) {
+  CAFFE_ENFORCE(
+      net_.ParseFromString(
+          OperatorBase::GetSingleArgument<std::string>("net", "")),
+      "Cannot parse the subnet of the NNApi operator");
+  CAFFE_ENFORCE_EQ(OutputSize(), net_.external_output_size());
+  for (int i = 0; i < InputSize(); i++) {
+    CAFFE_ENFORCE_EQ(debug_def().input(i), net_.external_input(i));
+  }
+}
+
+NNApi* NNApiOp::getModel(const NNApi::TensorVector& inputs) {
+  std::vector<std::vector<TIndex>> shapes;
+  for (const auto* input : inputs) {
+    shapes.push_back(input->dims());
+  }
+  auto& model = models_[shapes];
+  if (!model) {
+    NetDef init_net;
+    model.reset(new NNApi(init_net, net_, ws_, preference_));
+  }
+  return model.get();
+}
+
+bool NNApiOp::runOnCpu() {
+  if (!cpu_net_) {
+    cpu_net_ = CreateNet(net_, ws_);
+    CAFFE_ENFORCE(cpu_net_, "Cannot create the CPU net of the NNApi operator");
+  }
+  return cpu_net_->Run();
+}
+
+bool NNApiOp::RunOnDevice() {
+  if (fallback_) {
+    return runOnCpu();
+  }
+  NNApi::TensorVector inputs;
+  for (int i = 0; i < InputSize(); i++) {
+    inputs.push_back(const_cast<TensorCPU*>(&Input(i)));
+  }
+  NNApi::TensorVector outputs;
+  for (int i = 0; i < OutputSize(); i++) {
+    outputs.push_back(Output(i));
+  }
+  try {
+    // Building and compiling the model is only done on the first run with
+    // these shapes, the execution itself is scheduled on the NN API driver
+    // and signals its completion with an event
+    NNApi* model = getModel(inputs);
+    if (model->runAsync(inputs, &outputs) && model->wait()) {
+      return true;
+    }
+  } catch (const std::exception& e) {
+    LOG(WARNING) << "NN API cannot run " << debug_def().output(0) << ": "
+                 << e.what();
+  }
+  LOG(WARNING) << "Falling back to the CPU for " << debug_def().output(0);
+  fallback_ = true;
+  models_.clear();
+  return runOnCpu();
+}
+
+REGISTER_CPU_OPERATOR(NNApi, NNApiOp);
+OPERATOR_SCHEMA(NNApi)
+    .NumInputs(0, INT_MAX)
+    .NumOutputs(1, INT_MAX)
+    .SetDoc(R"DOC(
+Runs a subnet of NN API compatible operators with NN API, falling back to the
+CPU when NN API cannot run it. The operators are created by OptimizeForNNApi.
+)DOC")
+    .Arg("net", "Serialized NetDef of the subnet")
+    .Arg(
+        "preference",
+        "Execution preference of the compilation, e.g. "
+        "ANEURALNETWORKS_PREFER_SUSTAINED_SPEED");
+NO_GRADIENT(NNApi);
+
+NetDef OptimizeForNNApi(const NetDef& net, PreferenceCode pref) {
+  // Filters and biases are constants of the NN API model, so they cannot be
+  // computed by the net
+  std::unordered_set<std::string> produced;
+  for (const auto& op : net.op()) {
+    for (const auto& output : op.output()) {
+      produced.insert(output);
+    }
+  }
+  auto supports = [&produced](const OperatorDef& op) {
+    if (!NNApi::isSupported(op)) {
+      return false;
+    }
+    if (op.type() == "Conv") {
+      for (int i = 1; i < op.input_size(); i++) {
+        if (produced.count(op.input(i))) {
+          return false;
+        }
+      }
+    }
+    return true;
+  };
+
+  auto to_nnapi_op = [&net, pref](const NetDef& subnet) {
+    std::unordered_set<std::string> weights;
+    for (const auto& op : subnet.op()) {
+      if (op.type() == "Conv") {
+        for (int i = 1; i < op.input_size(); i++) {
+          weights.insert(op.input(i));
+        }
+      }
+    }
+
+    // NNApi binds its inputs to the first external inputs of the model, so
+    // the weights go last
+    NetDef model(subnet);
+    model.clear_external_input();
+    // The quantization parameters of the input tensors are arguments of the
+    // net
+    model.mutable_arg()->CopyFrom(net.arg());
+    NetDef net_opt;
+    auto* op = net_opt.add_op();
+    op->set_type("NNApi");
+    for (const auto& i : subnet.external_input()) {
+      if (!weights.count(i)) {
+        model.add_external_input(i);
+        op->add_input(i);
+        net_opt.add_external_input(i);
+      }
+    }
+    for (const auto& i : subnet.external_input()) {
+      if (weights.count(i)) {
+        model.add_external_input(i);
+      }
+    }
+    for (const auto& i : subnet.external_output()) {
+      op->add_output(i);
+      net_opt.add_external_output(i);
+    }
+
+    std::string model_str;
+    model.SerializeToString(&model_str);
+    op->add_arg()->CopyFrom(MakeArgument<std::string>("net", model_str));
+    op->add_arg()->CopyFrom(
+        MakeArgument<int>("preference", static_cast<int>(pref)));
+    return net_opt;
+  };
+
+  NetDef net_copy(net);
+  NetDef net_opt = opt::OptimizeForBackend(net_copy, supports, to_nnapi_op);
+  net_opt.mutable_device_option()->CopyFrom(net.device_option());
+  for (const auto& arg : net.arg()) {
+    net_opt.add_arg()->CopyFrom(arg);
+  }
+  return net_opt;
+}
+
+} // namespace caffe2
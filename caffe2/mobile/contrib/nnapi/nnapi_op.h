@@ -0,0 +1,46 @@
+#pragma once
+
+#include <map>
+
+#include "caffe2/core/net.h"
+#include "caffe2/core/operator.h"
+
+#include "nnapi.h"
+
+namespace caffe2 {
+
+// Runs the subnet given by the serialized NetDef argument "net" with NN API.
+// The inputs of the operator are the first external inputs of the subnet,
+// followed in the subnet by the filters and biases, which are read from the
+// workspace when the model is built and must not change afterwards. A model
+// is built and compiled for each new shape of the inputs and cached. If NN API
+// is not available or rejects the subnet, its operators run on the CPU
+// instead.
+class NNApiOp final : public Operator<CPUContext> {
+ public:
+  USE_OPERATOR_FUNCTIONS(CPUContext);
+  NNApiOp(const OperatorDef& operator_def, Workspace* ws);
+
+  bool RunOnDevice() override;
+
+ private:
+  NNApi* getModel(const NNApi::TensorVector& inputs);
+  bool runOnCpu();
+
+  Workspace* ws_;
+  NetDef net_;
+  PreferenceCode preference_;
+  bool fallback_{false};
+  std::unique_ptr<NetBase> cpu_net_;
+  std::map<std::vector<std::vector<TIndex>>, std::unique_ptr<NNApi>> models_;
+};
+
+// Offloads the subgraphs of net that NN API supports to NNApi operators, with
+// the help of opt::OptimizeForBackend, and leaves the rest to run on the CPU.
+// The filters and biases of the offloaded convolutions must be external inputs
+// of net.
+NetDef OptimizeForNNApi(
+    const NetDef& net,
+    PreferenceCode pref = ANEURALNETWORKS_PREFER_SUSTAINED_SPEED);
+
+} // namespace caffe2
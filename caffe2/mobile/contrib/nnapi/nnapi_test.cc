@@ -8,6 +8,7 @@
 
 #include "NeuralNetworks.h"
 #include "nnapi.h"
+#include "nnapi_op.h"
 
 namespace caffe2 {
 
@@ -545,6 +546,69 @@ static void test_softmax(int N, int C, int H = 1, int W = 1) {
   checkError(t_cpu, t_nn, 0.01);
 }
 
+// Conv -> Relu -> Sigmoid -> Conv -> MaxPool, where Sigmoid stays on the CPU
+static void test_partition(int N, int C, int H, int W) {
+  Workspace ws;
+  auto fill = [&ws](const std::string& name, std::vector<int> dims) {
+    auto* t = ws.CreateBlob(name)->GetMutable<TensorCPU>();
+    t->Resize(dims);
+    CPUContext ctx;
+    math::RandGaussian<float, CPUContext>(
+        t->size(), 0, 0.5, t->mutable_data<float>(), &ctx);
+  };
+  fill("X_cpu", {N, H, W, C});
+  fill("W1", {C, 3, 3, C});
+  fill("B1", {C});
+  fill("W2", {C, 1, 1, C});
+  fill("B2", {C});
+
+  NetDef netdef;
+  {
+    auto add_op = [&netdef](
+                      const std::string& type,
+                      const std::vector<std::string>& inputs,
+                      const std::string& output,
+                      int kernel) {
+      auto& op = *(netdef.add_op());
+      op.set_type(type);
+      for (const auto& input : inputs) {
+        op.add_input(input);
+      }
+      op.add_output(output);
+      if (kernel > 0) {
+        op.add_arg()->CopyFrom(MakeArgument<std::string>("order", "NHWC"));
+        op.add_arg()->CopyFrom(MakeArgument<int>("kernel", kernel));
+        op.add_arg()->CopyFrom(MakeArgument<int>("pad", type == "Conv"));
+      }
+    };
+    add_op("Conv", {"X_cpu", "W1", "B1"}, "C1", 3);
+    add_op("Relu", {"C1"}, "R1", 0);
+    add_op("Sigmoid", {"R1"}, "S1", 0);
+    add_op("Conv", {"S1", "W2", "B2"}, "C2", 1);
+    add_op("MaxPool", {"C2"}, "Y_cpu", 2);
+    netdef.add_external_input("X_cpu");
+    netdef.add_external_input("W1");
+    netdef.add_external_input("B1");
+    netdef.add_external_input("W2");
+    netdef.add_external_input("B2");
+    netdef.add_external_output("Y_cpu");
+  }
+  ws.RunNetOnce(netdef);
+  TensorCPU t_cpu(ws.GetBlob("Y_cpu")->Get<TensorCPU>());
+
+  // NN API
+  NetDef netdef_nn = OptimizeForNNApi(netdef);
+  ASSERT_EQ(netdef_nn.op_size(), 3);
+  EXPECT_EQ(netdef_nn.op(0).type(), "NNApi");
+  EXPECT_EQ(netdef_nn.op(1).type(), "Sigmoid");
+  EXPECT_EQ(netdef_nn.op(2).type(), "NNApi");
+  ws.RemoveBlob("Y_cpu");
+  for (int i = 0; i < 2; i++) {
+    ASSERT_TRUE(ws.RunNetOnce(netdef_nn));
+    checkError(t_cpu, ws.GetBlob("Y_cpu")->Get<TensorCPU>(), 0.01);
+  }
+}
+
 TEST(NNApi, TestConv) {
   for (int C : {13, 32}) {
     for (int M : {4, 7, 17}) {
@@ -637,6 +701,11 @@ TEST(NNApi, TestSoftmax) {
   // test_softmax(5, 17, 13, 13);
 }
 
+TEST(NNApi, TestPartition) {
+  test_partition(1, 8, 13, 13);
+  test_partition(2, 16, 26, 26);
+}
+
 } // namespace
 
 } // namespace caffe2
@@ -0,0 +1,43 @@
+#include "op_latency_observer.h"
+
+namespace caffe2 {
+
+OpLatencyOperatorObserver::OpLatencyOperatorObserver(
+    OperatorBase* subject,
+    const OpLatencyNetObserver* netObserver,
+    int sample_every)
+    : ObserverBase<OperatorBase>(subject),
+      netObserver_(netObserver),
+      sample_every_(sample_every),
+      stats_("op_latency/" + subject->type()) {}
+
+void OpLatencyOperatorObserver::Start() {
+  if (!sample_every_) {
+    sample_every_ = netObserver_ ? netObserver_->sample_every() : 1;
+  }
+  sampled_ = runs_++ % sample_every_ == 0;
+  if (sampled_) {
+    timer_.Start();
+  }
+}
+
+void OpLatencyOperatorObserver::Stop() {
+  if (!sampled_) {
+    return;
+  }
+  CAFFE_EVENT(
+      stats_, latency_us, static_cast<int64_t>(timer_.MicroSeconds()));
+}
+
+std::unique_ptr<ObserverBase<OperatorBase>> OpLatencyOperatorObserver::rnnCopy(
+    OperatorBase* subject,
+    int /* rnn_order */) const {
+  return std::unique_ptr<ObserverBase<OperatorBase>>(
+      new OpLatencyOperatorObserver(
+          subject,
+          nullptr,
+          sample_every_ ? sample_every_
+                        : (netObserver_ ? netObserver_->sample_every() : 1)));
+}
+
+} // namespace caffe2
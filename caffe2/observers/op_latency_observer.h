@@ -0,0 +1,80 @@
+#ifndef CAFFE2_CONTRIB_OBSERVERS_OP_LATENCY_OBSERVER_H_
+#define CAFFE2_CONTRIB_OBSERVERS_OP_LATENCY_OBSERVER_H_
+
+#include <memory>
+#include <string>
+
+#include "caffe2/core/common.h"
+#include "caffe2/core/net.h"
+#include "caffe2/core/observer.h"
+#include "caffe2/core/operator.h"
+#include "caffe2/core/stats.h"
+#include "caffe2/core/timer.h"
+#include "caffe2/observers/operator_attaching_net_observer.h"
+
+namespace caffe2 {
+
+class OpLatencyNetObserver;
+
+// Records the latency of one in sample_every runs of an operator, in
+// microseconds, in the histogram op_latency/<op type>/latency_us of the
+// StatRegistry singleton. All the operators of a type share the histogram, so
+// histogramPercentile() on a published ExportedStatMap gives the latency
+// percentiles per operator type.
+class OpLatencyOperatorObserver final : public ObserverBase<OperatorBase> {
+ public:
+  explicit OpLatencyOperatorObserver(OperatorBase* subject) = delete;
+  OpLatencyOperatorObserver(
+      OperatorBase* subject,
+      const OpLatencyNetObserver* netObserver,
+      int sample_every = 0);
+  std::unique_ptr<ObserverBase<OperatorBase>> rnnCopy(
+      OperatorBase* subject,
+      int rnn_order) const override;
+
+ private:
+  void Start() override;
+  void Stop() override;
+
+  struct OpLatencyStats {
+    CAFFE_STAT_CTOR(OpLatencyStats);
+    CAFFE_HISTOGRAM_EXPORTED_STAT(latency_us);
+  };
+
+  // The net observer is not constructed yet when it attaches this observer,
+  // so sample_every_ is read from it on the first run (0 until then).
+  const OpLatencyNetObserver* netObserver_;
+  int sample_every_;
+  int64_t runs_ = 0;
+  bool sampled_ = false;
+  Timer timer_;
+  OpLatencyStats stats_;
+};
+
+class OpLatencyNetObserver final
+    : public OperatorAttachingNetObserver<
+          OpLatencyOperatorObserver,
+          OpLatencyNetObserver> {
+ public:
+  explicit OpLatencyNetObserver(NetBase* subject, int sample_every = 1)
+      : OperatorAttachingNetObserver<
+            OpLatencyOperatorObserver,
+            OpLatencyNetObserver>(subject, this),
+        sample_every_(sample_every) {
+    CAFFE_ENFORCE_GT(sample_every_, 0);
+  }
+
+  int sample_every() const {
+    return sample_every_;
+  }
+
+ private:
+  void Start() override {}
+  void Stop() override {}
+
+  const int sample_every_;
+};
+
+} // namespace caffe2
+
+#endif // CAFFE2_CONTRIB_OBSERVERS_OP_LATENCY_OBSERVER_H_
@@ -0,0 +1,70 @@
+#include "caffe2/core/common.h"
+#include "caffe2/core/net.h"
+#include "caffe2/core/operator.h"
+#include "caffe2/core/stats.h"
+#include "op_latency_observer.h"
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include <thread>
+
+namespace caffe2 {
+
+namespace {
+
+class LatencySleepOp final : public OperatorBase {
+ public:
+  using OperatorBase::OperatorBase;
+  bool Run(int /* unused */) override {
+    StartAllObservers();
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    StopAllObservers();
+    return true;
+  }
+};
+
+REGISTER_CPU_OPERATOR(LatencySleepOp, LatencySleepOp);
+
+OPERATOR_SCHEMA(LatencySleepOp)
+    .NumInputs(0, INT_MAX)
+    .NumOutputs(0, INT_MAX)
+    .AllowInplace({{0, 0}, {1, 1}});
+
+unique_ptr<NetBase> CreateNetTestHelper(Workspace* ws) {
+  NetDef net_def;
+  {
+    auto& op = *(net_def.add_op());
+    op.set_type("LatencySleepOp");
+    op.add_input("in");
+    op.add_output("hidden");
+  }
+  {
+    auto& op = *(net_def.add_op());
+    op.set_type("LatencySleepOp");
+    op.add_input("hidden");
+    op.add_output("out");
+  }
+  net_def.add_external_input("in");
+  net_def.add_external_output("out");
+
+  return CreateNet(net_def, ws);
+}
+} // namespace
+
+TEST(OpLatencyObserverTest, SampledHistogram) {
+  Workspace ws;
+  ws.CreateBlob("in");
+  unique_ptr<NetBase> net(CreateNetTestHelper(&ws));
+  net->AttachObserver(caffe2::make_unique<OpLatencyNetObserver>(net.get(), 2));
+  StatRegistry::get().publish(true);
+  for (int i = 0; i < 4; ++i) {
+    net->Run();
+  }
+  auto stats = toMap(StatRegistry::get().publish(true));
+  const std::string key = "op_latency/LatencySleepOp/latency_us";
+  // both operators, every other run
+  EXPECT_EQ(stats[key + "/count"], 4);
+  EXPECT_GE(stats[key + "/sum"], 4 * 5000);
+  EXPECT_GE(histogramPercentile(stats, key, 0.5), 4096);
+}
+} // namespace caffe2
@@ -56,6 +56,27 @@ class BoxWithNMSLimitOp final : public Operator<Context> {
   float soft_nms_sigma_ = 0.5;
   // Lower-bound on updated scores to discard boxes
   float soft_nms_min_score_thres_ = 0.001;
+
+  // Scratch space of the CUDA implementation, see box_with_nms_limit_op_gpu.cu
+  Tensor<Context> dev_image_offsets_;
+  Tensor<Context> dev_keys_;
+  Tensor<Context> dev_sorted_keys_;
+  Tensor<Context> dev_values_;
+  Tensor<Context> dev_sorted_values_;
+  Tensor<Context> dev_segment_offsets_;
+  Tensor<Context> dev_sort_buffer_;
+  Tensor<Context> dev_sorted_boxes_;
+  Tensor<Context> dev_num_valid_;
+  Tensor<Context> dev_keep_;
+  Tensor<Context> dev_num_keep_;
+  Tensor<Context> dev_nms_mask_;
+  Tensor<Context> dev_image_scores_;
+  Tensor<Context> dev_sorted_image_scores_;
+  Tensor<Context> dev_num_final_;
+  Tensor<Context> dev_out_offsets_;
+  TensorCPU host_batch_splits_;
+  TensorCPU host_image_offsets_;
+  TensorCPU host_num_final_;
 };
 
 } // namespace caffe2
@@ -0,0 +1,528 @@
+#include <cfloat>
+#include <numeric>
+
+#include <cub/cub.cuh>
+
+#include "caffe2/core/context_gpu.h"
+#include "caffe2/operators/box_with_nms_limit_op.h"
+#include "caffe2/operators/generate_proposals_op_util_nms_gpu.h"
+
+// CUDA implementation of BoxWithNMSLimitOp. Every (image, foreground class)
+//    pair is a segment, with room for the boxes of the largest image: the
+//    boxes above score_thresh are sorted per segment, suppressed per segment
+//    by a single batched NMS, and limited to detections_per_im per image
+//    with a segmented sort of the kept scores, all on the device. The batch
+//    splits are copied to the host before, and the number of detections per
+//    segment after, to size the outputs.
+
+namespace caffe2 {
+
+namespace {
+
+// Scores of segment s = b * num_fg + j - 1, the boxes of image b for class
+//    j, to be sorted with their rows in the image: the scores above
+//    score_thresh, or -FLT_MAX, which also pads the segment
+__global__ void PrepareClassScoresKernel(
+    const int num_segments,
+    const int max_boxes,
+    const int num_classes,
+    const int* image_offsets,
+    const float* scores,
+    const float score_thresh,
+    float* keys,
+    int* values,
+    int* num_valid) {
+  const int num_fg = num_classes - 1;
+  CUDA_1D_KERNEL_LOOP(index, num_segments * max_boxes) {
+    const int s = index / max_boxes;
+    const int i = index % max_boxes;
+    const int b = s / num_fg;
+    const int j = s % num_fg + 1;
+    const int start = image_offsets[b];
+    float key = -FLT_MAX;
+    if (i < image_offsets[b + 1] - start) {
+      const float score = scores[(start + i) * num_classes + j];
+      if (score > score_thresh) {
+        key = score;
+        atomicAdd(&num_valid[s], 1);
+      }
+    }
+    keys[index] = key;
+    values[index] = i;
+  }
+}
+
+__global__ void InitSegmentOffsetsKernel(
+    const int num_segments,
+    const int segment_size,
+    int* offsets) {
+  CUDA_1D_KERNEL_LOOP(i, num_segments + 1) {
+    offsets[i] = i * segment_size;
+  }
+}
+
+// Gathers the boxes of each segment above score_thresh, in score order
+__global__ void GatherClassBoxesKernel(
+    const int num_segments,
+    const int max_boxes,
+    const int num_classes,
+    const int* image_offsets,
+    const float* boxes,
+    const int* sorted_values,
+    const int* num_valid,
+    float* sorted_boxes) {
+  const int num_fg = num_classes - 1;
+  CUDA_1D_KERNEL_LOOP(index, num_segments * max_boxes) {
+    const int s = index / max_boxes;
+    const int i = index % max_boxes;
+    if (i >= num_valid[s]) {
+      continue;
+    }
+    const int b = s / num_fg;
+    const int j = s % num_fg + 1;
+    const int row = image_offsets[b] + sorted_values[index];
+    for (int c = 0; c < 4; ++c) {
+      sorted_boxes[index * 4 + c] = boxes[(row * num_classes + j) * 4 + c];
+    }
+  }
+}
+
+// Gathers the scores of the boxes kept by the NMS of all the classes of each
+//    image, in a segment of num_fg * max_boxes per image
+__global__ void GatherImageScoresKernel(
+    const int num_segments,
+    const int max_boxes,
+    const int num_fg,
+    const float* sorted_keys,
+    const int* keep,
+    const int* num_keep,
+    float* image_scores) {
+  CUDA_1D_KERNEL_LOOP(index, num_segments * max_boxes) {
+    const int s = index / max_boxes;
+    const int k = index % max_boxes;
+    if (k >= num_keep[s]) {
+      continue;
+    }
+    const int b = s / num_fg;
+    int pos = k;
+    for (int t = b * num_fg; t < s; ++t) {
+      pos += num_keep[t];
+    }
+    image_scores[b * num_fg * max_boxes + pos] =
+        sorted_keys[s * max_boxes + keep[index]];
+  }
+}
+
+// Keeps, in each segment, the boxes with a score of at least the
+//    detections_per_im-th highest score of their image, if the image has
+//    more boxes than that
+__global__ void LimitDetectionsKernel(
+    const int num_segments,
+    const int max_boxes,
+    const int num_fg,
+    const int detections_per_im,
+    const float* sorted_keys,
+    const float* sorted_image_scores,
+    const int* num_keep,
+    int* keep,
+    int* num_final) {
+  CUDA_1D_KERNEL_LOOP(s, num_segments) {
+    const int b = s / num_fg;
+    int image_count = 0;
+    for (int t = b * num_fg; t < (b + 1) * num_fg; ++t) {
+      image_count += num_keep[t];
+    }
+    const float thresh = image_count > detections_per_im
+        ? sorted_image_scores[b * num_fg * max_boxes + detections_per_im - 1]
+        : -FLT_MAX;
+    int* segment_keep = keep + s * max_boxes;
+    int count = 0;
+    for (int k = 0; k < num_keep[s]; ++k) {
+      if (sorted_keys[s * max_boxes + segment_keep[k]] >= thresh) {
+        segment_keep[count++] = segment_keep[k];
+      }
+    }
+    num_final[s] = count;
+  }
+}
+
+// Lays the detections out image after image, class after class: the first
+//    output row of each segment, and the batch splits and keeps sizes
+//    outputs, if given. The segments are few, so a single thread does it.
+__global__ void LayoutDetectionsKernel(
+    const int num_images,
+    const int num_classes,
+    const int* num_final,
+    int* out_offsets,
+    float* out_batch_splits,
+    int* out_keeps_size) {
+  const int num_fg = num_classes - 1;
+  int offset = 0;
+  for (int b = 0; b < num_images; ++b) {
+    int image_count = 0;
+    if (out_keeps_size) {
+      out_keeps_size[b * num_classes] = 0;
+    }
+    for (int j = 1; j < num_classes; ++j) {
+      const int s = b * num_fg + j - 1;
+      out_offsets[s] = offset + image_count;
+      image_count += num_final[s];
+      if (out_keeps_size) {
+        out_keeps_size[b * num_classes + j] = num_final[s];
+      }
+    }
+    if (out_batch_splits) {
+      out_batch_splits[b] = image_count;
+    }
+    offset += image_count;
+  }
+}
+
+__global__ void WriteDetectionsKernel(
+    const int num_segments,
+    const int max_boxes,
+    const int num_fg,
+    const float* sorted_keys,
+    const int* sorted_values,
+    const float* sorted_boxes,
+    const int* keep,
+    const int* num_final,
+    const int* out_offsets,
+    float* out_scores,
+    float* out_boxes,
+    float* out_classes,
+    int* out_keeps) {
+  CUDA_1D_KERNEL_LOOP(index, num_segments * max_boxes) {
+    const int s = index / max_boxes;
+    const int k = index % max_boxes;
+    if (k >= num_final[s]) {
+      continue;
+    }
+    const int out = out_offsets[s] + k;
+    const int box = s * max_boxes + keep[index];
+    out_scores[out] = sorted_keys[box];
+    for (int c = 0; c < 4; ++c) {
+      out_boxes[out * 4 + c] = sorted_boxes[box * 4 + c];
+    }
+    out_classes[out] = s % num_fg + 1;
+    if (out_keeps) {
+      out_keeps[out] = sorted_values[box];
+    }
+  }
+}
+
+// Sorts num_segments segments of segment_size keys, and values if given, in
+//    decreasing order
+void SortSegmentsDescending(
+    int num_segments,
+    int segment_size,
+    const float* keys,
+    float* sorted_keys,
+    const int* values,
+    int* sorted_values,
+    TensorCUDA* offsets_buffer,
+    TensorCUDA* sort_buffer,
+    CUDAContext* context) {
+  const int total = num_segments * segment_size;
+  offsets_buffer->Resize(num_segments + 1);
+  int* offsets = offsets_buffer->mutable_data<int>();
+  InitSegmentOffsetsKernel<<<
+      CAFFE_GET_BLOCKS(num_segments + 1),
+      CAFFE_CUDA_NUM_THREADS,
+      0,
+      context->cuda_stream()>>>(num_segments, segment_size, offsets);
+  size_t sort_bytes = 0;
+  for (int pass = 0; pass < 2; ++pass) {
+    void* temp_storage = nullptr;
+    if (pass == 1) {
+      sort_buffer->Resize(sort_bytes);
+      temp_storage = static_cast<void*>(sort_buffer->mutable_data<char>());
+    }
+    if (values) {
+      cub::DeviceSegmentedRadixSort::SortPairsDescending(
+          temp_storage,
+          sort_bytes,
+          keys,
+          sorted_keys,
+          values,
+          sorted_values,
+          total,
+          num_segments,
+          offsets,
+          offsets + 1,
+          0,
+          8 * sizeof(float),
+          context->cuda_stream());
+    } else {
+      cub::DeviceSegmentedRadixSort::SortKeysDescending(
+          temp_storage,
+          sort_bytes,
+          keys,
+          sorted_keys,
+          total,
+          num_segments,
+          offsets,
+          offsets + 1,
+          0,
+          8 * sizeof(float),
+          context->cuda_stream());
+    }
+  }
+}
+
+} // namespace
+
+template <>
+bool BoxWithNMSLimitOp<CUDAContext>::RunOnDevice() {
+  CAFFE_ENFORCE(!soft_nms_enabled_, "Soft-NMS is only supported on the CPU");
+  const auto& tscores = Input(0);
+  const auto& tboxes = Input(1);
+  auto* out_scores = Output(0);
+  auto* out_boxes = Output(1);
+  auto* out_classes = Output(2);
+
+  // tscores: (num_boxes, num_classes), 0 for background
+  if (tscores.ndim() == 4) {
+    CAFFE_ENFORCE_EQ(tscores.dim(2), 1, tscores.dim(2));
+    CAFFE_ENFORCE_EQ(tscores.dim(3), 1, tscores.dim(3));
+  } else {
+    CAFFE_ENFORCE_EQ(tscores.ndim(), 2, tscores.ndim());
+  }
+  CAFFE_ENFORCE(tscores.template IsType<float>(), tscores.meta().name());
+  // tboxes: (num_boxes, num_classes * 4)
+  if (tboxes.ndim() == 4) {
+    CAFFE_ENFORCE_EQ(tboxes.dim(2), 1, tboxes.dim(2));
+    CAFFE_ENFORCE_EQ(tboxes.dim(3), 1, tboxes.dim(3));
+  } else {
+    CAFFE_ENFORCE_EQ(tboxes.ndim(), 2, tboxes.ndim());
+  }
+  CAFFE_ENFORCE(tboxes.template IsType<float>(), tboxes.meta().name());
+
+  const int N = tscores.dim32(0);
+  const int num_classes = tscores.dim32(1);
+  CAFFE_ENFORCE_EQ(N, tboxes.dim(0));
+  CAFFE_ENFORCE_EQ(num_classes * 4, tboxes.dim(1));
+
+  int batch_size = 1;
+  host_image_offsets_.Resize(2);
+  int* image_offsets = host_image_offsets_.mutable_data<int>();
+  image_offsets[0] = 0;
+  image_offsets[1] = N;
+  if (InputSize() > 2) {
+    const auto& tbatch_splits = Input(2);
+    CAFFE_ENFORCE_EQ(tbatch_splits.ndim(), 1);
+    batch_size = tbatch_splits.dim32(0);
+    host_batch_splits_.CopyFrom(tbatch_splits, &context_);
+    context_.FinishDeviceComputation();
+    const float* batch_splits = host_batch_splits_.data<float>();
+    host_image_offsets_.Resize(batch_size + 1);
+    image_offsets = host_image_offsets_.mutable_data<int>();
+    image_offsets[0] = 0;
+    for (int b = 0; b < batch_size; ++b) {
+      image_offsets[b + 1] =
+          image_offsets[b] + static_cast<int>(batch_splits[b]);
+    }
+  }
+  CAFFE_ENFORCE_EQ(image_offsets[batch_size], N);
+  int max_boxes = 0;
+  for (int b = 0; b < batch_size; ++b) {
+    max_boxes = std::max(max_boxes, image_offsets[b + 1] - image_offsets[b]);
+  }
+
+  const int num_fg = std::max(num_classes - 1, 0);
+  const int num_segments = batch_size * num_fg;
+  const int total = num_segments * max_boxes;
+  host_num_final_.Resize(num_segments);
+  int* host_num_final = host_num_final_.mutable_data<int>();
+  std::fill(host_num_final, host_num_final + num_segments, 0);
+
+  if (total > 0) {
+    dev_image_offsets_.CopyFrom(host_image_offsets_, &context_);
+
+    // sort the boxes above score_thresh of each class of each image
+    dev_keys_.Resize(total);
+    dev_values_.Resize(total);
+    dev_num_valid_.Resize(num_segments);
+    int* num_valid = dev_num_valid_.mutable_data<int>();
+    math::Set<int, CUDAContext>(num_segments, 0, num_valid, &context_);
+    PrepareClassScoresKernel<<<
+        CAFFE_GET_BLOCKS(total),
+        CAFFE_CUDA_NUM_THREADS,
+        0,
+        context_.cuda_stream()>>>(
+        num_segments,
+        max_boxes,
+        num_classes,
+        dev_image_offsets_.data<int>(),
+        tscores.data<float>(),
+        score_thres_,
+        dev_keys_.mutable_data<float>(),
+        dev_values_.mutable_data<int>(),
+        num_valid);
+    dev_sorted_keys_.Resize(total);
+    dev_sorted_values_.Resize(total);
+    SortSegmentsDescending(
+        num_segments,
+        max_boxes,
+        dev_keys_.data<float>(),
+        dev_sorted_keys_.mutable_data<float>(),
+        dev_values_.data<int>(),
+        dev_sorted_values_.mutable_data<int>(),
+        &dev_segment_offsets_,
+        &dev_sort_buffer_,
+        &context_);
+    dev_sorted_boxes_.Resize(total, 4);
+    GatherClassBoxesKernel<<<
+        CAFFE_GET_BLOCKS(total),
+        CAFFE_CUDA_NUM_THREADS,
+        0,
+        context_.cuda_stream()>>>(
+        num_segments,
+        max_boxes,
+        num_classes,
+        dev_image_offsets_.data<int>(),
+        tboxes.data<float>(),
+        dev_sorted_values_.data<int>(),
+        num_valid,
+        dev_sorted_boxes_.mutable_data<float>());
+
+    // apply the nms to each class of each image
+    dev_keep_.Resize(total);
+    dev_num_keep_.Resize(num_segments);
+    utils::nms_gpu(
+        dev_sorted_boxes_.data<float>(),
+        num_valid,
+        num_segments,
+        max_boxes,
+        nms_thres_,
+        -1,
+        dev_keep_.mutable_data<int>(),
+        dev_num_keep_.mutable_data<int>(),
+        &dev_nms_mask_,
+        &context_);
+
+    // limit to detections_per_im detections *over all classes*
+    const int* num_final = dev_num_keep_.data<int>();
+    if (detections_per_im_ > 0) {
+      dev_image_scores_.Resize(total);
+      math::Set<float, CUDAContext>(
+          total, -FLT_MAX, dev_image_scores_.mutable_data<float>(), &context_);
+      GatherImageScoresKernel<<<
+          CAFFE_GET_BLOCKS(total),
+          CAFFE_CUDA_NUM_THREADS,
+          0,
+          context_.cuda_stream()>>>(
+          num_segments,
+          max_boxes,
+          num_fg,
+          dev_sorted_keys_.data<float>(),
+          dev_keep_.data<int>(),
+          dev_num_keep_.data<int>(),
+          dev_image_scores_.mutable_data<float>());
+      dev_sorted_image_scores_.Resize(total);
+      SortSegmentsDescending(
+          batch_size,
+          num_fg * max_boxes,
+          dev_image_scores_.data<float>(),
+          dev_sorted_image_scores_.mutable_data<float>(),
+          nullptr,
+          nullptr,
+          &dev_segment_offsets_,
+          &dev_sort_buffer_,
+          &context_);
+      dev_num_final_.Resize(num_segments);
+      LimitDetectionsKernel<<<
+          CAFFE_GET_BLOCKS(num_segments),
+          CAFFE_CUDA_NUM_THREADS,
+          0,
+          context_.cuda_stream()>>>(
+          num_segments,
+          max_boxes,
+          num_fg,
+          detections_per_im_,
+          dev_sorted_keys_.data<float>(),
+          dev_sorted_image_scores_.data<float>(),
+          dev_num_keep_.data<int>(),
+          dev_keep_.mutable_data<int>(),
+          dev_num_final_.mutable_data<int>());
+      num_final = dev_num_final_.data<int>();
+    }
+
+    context_.Copy<int, CUDAContext, CPUContext>(
+        num_segments, num_final, host_num_final);
+    context_.FinishDeviceComputation();
+  }
+
+  const int total_keep =
+      std::accumulate(host_num_final, host_num_final + num_segments, 0);
+  out_scores->Resize(total_keep);
+  out_boxes->Resize(total_keep, 4);
+  out_classes->Resize(total_keep);
+  float* out_scores_data = out_scores->mutable_data<float>();
+  float* out_boxes_data = out_boxes->mutable_data<float>();
+  float* out_classes_data = out_classes->mutable_data<float>();
+  float* out_batch_splits_data = nullptr;
+  if (OutputSize() > 3) {
+    auto* out_batch_splits = Output(3);
+    out_batch_splits->Resize(batch_size);
+    out_batch_splits_data = out_batch_splits->mutable_data<float>();
+  }
+  int* out_keeps_data = nullptr;
+  int* out_keeps_size_data = nullptr;
+  if (OutputSize() > 4) {
+    auto* out_keeps = Output(4);
+    auto* out_keeps_size = Output(5);
+    out_keeps->Resize(total_keep);
+    out_keeps_size->Resize(batch_size, num_classes);
+    out_keeps_data = out_keeps->mutable_data<int>();
+    out_keeps_size_data = out_keeps_size->mutable_data<int>();
+  }
+
+  if (total == 0) {
+    if (out_batch_splits_data) {
+      math::Set<float, CUDAContext>(
+          batch_size, 0, out_batch_splits_data, &context_);
+    }
+    if (out_keeps_size_data) {
+      math::Set<int, CUDAContext>(
+          batch_size * num_classes, 0, out_keeps_size_data, &context_);
+    }
+    return true;
+  }
+
+  const int* num_final = detections_per_im_ > 0 ? dev_num_final_.data<int>()
+                                                : dev_num_keep_.data<int>();
+  dev_out_offsets_.Resize(num_segments);
+  LayoutDetectionsKernel<<<1, 1, 0, context_.cuda_stream()>>>(
+      batch_size,
+      num_classes,
+      num_final,
+      dev_out_offsets_.mutable_data<int>(),
+      out_batch_splits_data,
+      out_keeps_size_data);
+  if (total_keep > 0) {
+    WriteDetectionsKernel<<<
+        CAFFE_GET_BLOCKS(total),
+        CAFFE_CUDA_NUM_THREADS,
+        0,
+        context_.cuda_stream()>>>(
+        num_segments,
+        max_boxes,
+        num_fg,
+        dev_sorted_keys_.data<float>(),
+        dev_sorted_values_.data<int>(),
+        dev_sorted_boxes_.data<float>(),
+        dev_keep_.data<int>(),
+        num_final,
+        dev_out_offsets_.data<int>(),
+        out_scores_data,
+        out_boxes_data,
+        out_classes_data,
+        out_keeps_data);
+  }
+  return true;
+}
+
+REGISTER_CUDA_OPERATOR(BoxWithNMSLimit, BoxWithNMSLimitOp<CUDAContext>);
+
+} // namespace caffe2
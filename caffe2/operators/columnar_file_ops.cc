@@ -0,0 +1,492 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+
+#ifndef _MSC_VER
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#include "caffe2/core/blob_serialization.h"
+#include "caffe2/core/context.h"
+#include "caffe2/core/db.h"
+#include "caffe2/core/operator.h"
+#include "caffe2/core/tensor.h"
+#include "caffe2/core/types.h"
+
+namespace caffe2 {
+
+namespace {
+
+// A columnar file holds the fields of a dataset one after the other:
+//
+//   "C2COLUMN" | uint64 header size | TensorProtos header | data
+//
+// The header has a TensorProto per field, with its name, data type and dims
+// but no data. Its segment is the byte range of the field in the data. The
+// data and every field in it start at a multiple of kColumnarPageSize, so the
+// fields of a mapped file are page aligned and can be used in place.
+constexpr char kColumnarMagic[] = "C2COLUMN";
+constexpr size_t kColumnarMagicSize = 8;
+constexpr size_t kColumnarPageSize = 4096;
+
+size_t RoundUpToPage(size_t n) {
+  return (n + kColumnarPageSize - 1) / kColumnarPageSize * kColumnarPageSize;
+}
+
+size_t FieldBytes(const TensorProto& field) {
+  CAFFE_ENFORCE(
+      field.data_type() != TensorProto_DataType_STRING &&
+          field.data_type() != TensorProto_DataType_UNDEFINED,
+      "Columnar files only hold fields of fixed size types, not ",
+      field.name());
+  size_t size = 1;
+  for (auto d : field.dims()) {
+    size *= d;
+  }
+  return size * DataTypeToTypeMeta(field.data_type()).itemsize();
+}
+
+// Sets the segments of the fields of the header from their dims and types
+void LayoutFields(TensorProtos* header) {
+  size_t offset = 0;
+  for (auto& field : *header->mutable_protos()) {
+    field.mutable_segment()->set_begin(offset);
+    field.mutable_segment()->set_end(offset + FieldBytes(field));
+    offset = RoundUpToPage(field.segment().end());
+  }
+}
+
+// Writes a columnar file with the given header, laid out by LayoutFields().
+// The data of the fields can be written in any order.
+class ColumnarFileWriter {
+ public:
+  ColumnarFileWriter(const string& filename, const TensorProtos& header)
+      : header_(header), file_(fopen(filename.c_str(), "wb")) {
+    CAFFE_ENFORCE(file_, "Cannot open file: ", filename);
+    string serialized = header_.SerializeAsString();
+    uint64_t header_size = serialized.size();
+    CAFFE_ENFORCE_EQ(
+        fwrite(kColumnarMagic, 1, kColumnarMagicSize, file_),
+        kColumnarMagicSize);
+    CAFFE_ENFORCE_EQ(fwrite(&header_size, sizeof(header_size), 1, file_), 1);
+    CAFFE_ENFORCE_EQ(
+        fwrite(serialized.data(), 1, serialized.size(), file_),
+        serialized.size());
+    data_start_ =
+        RoundUpToPage(kColumnarMagicSize + sizeof(header_size) + header_size);
+    // Ends the file with the data, even if the last fields are not written
+    size_t end = data_start_;
+    for (const auto& field : header_.protos()) {
+      end = std::max<size_t>(end, data_start_ + field.segment().end());
+    }
+    if (end > kColumnarMagicSize + sizeof(header_size) + header_size) {
+      CAFFE_ENFORCE_EQ(fseek(file_, end - 1, SEEK_SET), 0);
+      CAFFE_ENFORCE_EQ(fputc(0, file_), 0);
+    }
+  }
+
+  ~ColumnarFileWriter() {
+    if (file_) {
+      fclose(file_);
+    }
+  }
+
+  // Writes nbytes of data to the given field, offset bytes from its start
+  void Write(int field, size_t offset, const void* data, size_t nbytes) {
+    const auto& segment = header_.protos(field).segment();
+    CAFFE_ENFORCE_LE(segment.begin() + offset + nbytes, segment.end());
+    if (nbytes == 0) {
+      return;
+    }
+    CAFFE_ENFORCE_EQ(
+        fseek(file_, data_start_ + segment.begin() + offset, SEEK_SET), 0);
+    CAFFE_ENFORCE_EQ(fwrite(data, 1, nbytes, file_), nbytes);
+  }
+
+  void Close() {
+    CAFFE_ENFORCE_EQ(fclose(file_), 0);
+    file_ = nullptr;
+  }
+
+ private:
+  TensorProtos header_;
+  FILE* file_;
+  size_t data_start_;
+};
+
+// A columnar file mapped into memory. The mapping is private and writable, so
+// the tensors viewing it can be written to without changing the file. Where
+// files cannot be mapped, the file is read into memory instead.
+class ColumnarFile {
+ public:
+  explicit ColumnarFile(const string& filename) {
+    FILE* file = fopen(filename.c_str(), "rb");
+    CAFFE_ENFORCE(file, "Cannot open file: ", filename);
+    std::unique_ptr<FILE, int (*)(FILE*)> guard(file, fclose);
+    char magic[kColumnarMagicSize];
+    uint64_t header_size;
+    CAFFE_ENFORCE(
+        fread(magic, 1, kColumnarMagicSize, file) == kColumnarMagicSize &&
+            std::memcmp(magic, kColumnarMagic, kColumnarMagicSize) == 0,
+        "Not a columnar file: ",
+        filename);
+    CAFFE_ENFORCE_EQ(fread(&header_size, sizeof(header_size), 1, file), 1);
+    string serialized(header_size, '\0');
+    CAFFE_ENFORCE_EQ(
+        fread(&serialized[0], 1, header_size, file), header_size);
+    CAFFE_ENFORCE(
+        header_.ParseFromString(serialized),
+        "Cannot parse the header of ",
+        filename);
+    data_start_ =
+        RoundUpToPage(kColumnarMagicSize + sizeof(header_size) + header_size);
+
+    CAFFE_ENFORCE_EQ(fseek(file, 0, SEEK_END), 0);
+    size_ = ftell(file);
+    for (const auto& field : header_.protos()) {
+      CAFFE_ENFORCE_EQ(
+          field.segment().end() - field.segment().begin(), FieldBytes(field));
+      CAFFE_ENFORCE_LE(
+          data_start_ + field.segment().end(),
+          std::max(size_, data_start_),
+          "Truncated columnar file: ",
+          filename);
+    }
+    if (size_ <= data_start_) {
+      return;
+    }
+#ifndef _MSC_VER
+    void* data = mmap(
+        nullptr,
+        size_,
+        PROT_READ | PROT_WRITE,
+        MAP_PRIVATE,
+        fileno(file),
+        0);
+    if (data != MAP_FAILED) {
+      mapped_ = static_cast<char*>(data);
+      return;
+    }
+#endif
+    buffer_.reset(new char[size_]);
+    CAFFE_ENFORCE_EQ(fseek(file, 0, SEEK_SET), 0);
+    CAFFE_ENFORCE_EQ(fread(buffer_.get(), 1, size_, file), size_);
+  }
+
+  ~ColumnarFile() {
+#ifndef _MSC_VER
+    if (mapped_) {
+      munmap(mapped_, size_);
+    }
+#endif
+  }
+
+  const TensorProtos& header() const {
+    return header_;
+  }
+
+  // The data of the given field
+  char* field(int i) {
+    char* base = mapped_ ? mapped_ : buffer_.get();
+    return base ? base + data_start_ + header_.protos(i).segment().begin()
+                : nullptr;
+  }
+
+ private:
+  TensorProtos header_;
+  size_t data_start_;
+  size_t size_;
+  char* mapped_ = nullptr;
+  std::unique_ptr<char[]> buffer_;
+
+  DISABLE_COPY_AND_ASSIGN(ColumnarFile);
+};
+
+} // namespace
+
+class SaveColumnarFileOp final : public Operator<CPUContext> {
+ public:
+  SaveColumnarFileOp(const OperatorDef& operator_def, Workspace* ws)
+      : Operator<CPUContext>(operator_def, ws),
+        filename_(GetSingleArgument<string>("filename", "")),
+        fieldNames_(GetRepeatedArgument<string>("field_names")) {
+    CAFFE_ENFORCE(!filename_.empty(), "Must specify a filename.");
+    if (fieldNames_.empty()) {
+      fieldNames_.assign(
+          operator_def.input().begin(), operator_def.input().end());
+    }
+    CAFFE_ENFORCE_EQ(fieldNames_.size(), InputSize());
+  }
+
+  bool RunOnDevice() override {
+    TensorProtos header;
+    for (int i = 0; i < InputSize(); ++i) {
+      auto* field = header.add_protos();
+      field->set_name(fieldNames_[i]);
+      field->set_data_type(TypeMetaToDataType(Input(i).meta()));
+      for (auto d : Input(i).dims()) {
+        field->add_dims(d);
+      }
+    }
+    LayoutFields(&header);
+    ColumnarFileWriter writer(filename_, header);
+    for (int i = 0; i < InputSize(); ++i) {
+      writer.Write(i, 0, Input(i).raw_data(), Input(i).nbytes());
+    }
+    writer.Close();
+    return true;
+  }
+
+ private:
+  string filename_;
+  std::vector<string> fieldNames_;
+};
+
+class LoadColumnarFileOp final : public Operator<CPUContext> {
+ public:
+  LoadColumnarFileOp(const OperatorDef& operator_def, Workspace* ws)
+      : Operator<CPUContext>(operator_def, ws),
+        filename_(GetSingleArgument<string>("filename", "")) {
+    CAFFE_ENFORCE(!filename_.empty(), "Must specify a filename.");
+  }
+
+  bool RunOnDevice() override {
+    auto file = std::make_shared<ColumnarFile>(filename_);
+    const auto& header = file->header();
+    CAFFE_ENFORCE_EQ(
+        header.protos_size(),
+        OutputSize(),
+        "Expected one output per field of ",
+        filename_);
+    for (int i = 0; i < OutputSize(); ++i) {
+      const auto& field = header.protos(i);
+      auto* output = Output(i);
+      output->Resize(
+          std::vector<TIndex>(field.dims().begin(), field.dims().end()));
+      // The tensors keep the file mapped for as long as any of them views it
+      output->ShareExternalPointer(
+          file->field(i),
+          DataTypeToTypeMeta(field.data_type()),
+          0,
+          [file](void*) {});
+    }
+    return true;
+  }
+
+ private:
+  string filename_;
+};
+
+// Converts a db of TensorProtos, as read by TensorProtosDBInput, to a
+// columnar file, in two passes over the db: the first finds the shape of the
+// fields, the second writes them.
+class ConvertDBToColumnarFileOp final : public Operator<CPUContext> {
+ public:
+  ConvertDBToColumnarFileOp(const OperatorDef& operator_def, Workspace* ws)
+      : Operator<CPUContext>(operator_def, ws),
+        dbType_(GetSingleArgument<string>("db_type", "leveldb")),
+        dbName_(GetSingleArgument<string>("db", "")),
+        filename_(GetSingleArgument<string>("filename", "")),
+        fieldNames_(GetRepeatedArgument<string>("field_names")) {
+    CAFFE_ENFORCE(!dbName_.empty(), "Must specify a db name.");
+    CAFFE_ENFORCE(!filename_.empty(), "Must specify a filename.");
+  }
+
+  bool RunOnDevice() override {
+    auto db = db::CreateDB(dbType_, dbName_, db::READ);
+    CAFFE_ENFORCE(db, "Cannot open db: ", dbName_, " of type ", dbType_);
+
+    // The shape of each record field, or only the dims after the first with
+    // the first dim of each record in lengths if the records do not all
+    // have the same shape
+    struct FieldShape {
+      TensorProto first;
+      bool ragged = false;
+      int64_t rows = 0;
+      std::vector<int32_t> lengths;
+    };
+    std::vector<FieldShape> shapes;
+    int64_t numRecords = 0;
+    {
+      auto cursor = db->NewCursor();
+      for (cursor->SeekToFirst(); cursor->Valid(); cursor->Next()) {
+        TensorProtos protos;
+        CAFFE_ENFORCE(protos.ParseFromString(cursor->value()));
+        if (shapes.empty()) {
+          CAFFE_ENFORCE_GT(protos.protos_size(), 0);
+          shapes.resize(protos.protos_size());
+          for (int i = 0; i < protos.protos_size(); ++i) {
+            shapes[i].first.set_data_type(protos.protos(i).data_type());
+            *shapes[i].first.mutable_dims() = protos.protos(i).dims();
+          }
+        }
+        CAFFE_ENFORCE_EQ(protos.protos_size(), shapes.size());
+        for (int i = 0; i < protos.protos_size(); ++i) {
+          const auto& proto = protos.protos(i);
+          auto& shape = shapes[i];
+          CAFFE_ENFORCE_EQ(proto.data_type(), shape.first.data_type());
+          CAFFE_ENFORCE_EQ(proto.dims_size(), shape.first.dims_size());
+          if (!shape.ragged &&
+              !std::equal(
+                  proto.dims().begin(),
+                  proto.dims().end(),
+                  shape.first.dims().begin())) {
+            CAFFE_ENFORCE_GT(
+                proto.dims_size(),
+                0,
+                "Scalar fields of different shapes in field ",
+                i);
+            shape.ragged = true;
+            shape.lengths.assign(numRecords, shape.first.dims(0));
+          }
+          CAFFE_ENFORCE(
+              std::equal(
+                  proto.dims().begin() + (proto.dims_size() > 0),
+                  proto.dims().end(),
+                  shape.first.dims().begin() + (proto.dims_size() > 0)),
+              "Records differ in more than their first dim in field ",
+              i);
+          if (proto.dims_size() > 0) {
+            shape.rows += proto.dims(0);
+            if (shape.ragged) {
+              shape.lengths.push_back(proto.dims(0));
+            }
+          }
+        }
+        ++numRecords;
+      }
+    }
+    CAFFE_ENFORCE_GT(numRecords, 0, "Empty db: ", dbName_);
+    if (fieldNames_.empty()) {
+      for (int i = 0; i < shapes.size(); ++i) {
+        fieldNames_.push_back("field_" + caffe2::to_string(i));
+      }
+    }
+    CAFFE_ENFORCE_EQ(fieldNames_.size(), shapes.size());
+
+    // A field of [numRecords, dims...], or lengths and values fields of
+    // [numRecords] and [rows, dims...] for the ragged ones, as in datasets
+    TensorProtos header;
+    std::vector<int> valueFields;
+    for (int i = 0; i < shapes.size(); ++i) {
+      const auto& shape = shapes[i];
+      if (shape.ragged) {
+        auto* lengths = header.add_protos();
+        lengths->set_name(fieldNames_[i] + ":lengths");
+        lengths->set_data_type(TensorProto_DataType_INT32);
+        lengths->add_dims(numRecords);
+      }
+      valueFields.push_back(header.protos_size());
+      auto* values = header.add_protos();
+      values->CopyFrom(shape.first);
+      values->set_name(
+          shape.ragged ? fieldNames_[i] + ":values" : fieldNames_[i]);
+      if (shape.ragged) {
+        values->set_dims(0, shape.rows);
+      } else {
+        values->mutable_dims()->Clear();
+        values->add_dims(numRecords);
+        for (auto d : shape.first.dims()) {
+          values->add_dims(d);
+        }
+      }
+    }
+    LayoutFields(&header);
+
+    ColumnarFileWriter writer(filename_, header);
+    for (int i = 0; i < shapes.size(); ++i) {
+      if (shapes[i].ragged) {
+        writer.Write(
+            valueFields[i] - 1,
+            0,
+            shapes[i].lengths.data(),
+            shapes[i].lengths.size() * sizeof(int32_t));
+      }
+    }
+    std::vector<size_t> written(shapes.size(), 0);
+    TensorDeserializer<CPUContext> deserializer;
+    TensorCPU record;
+    auto cursor = db->NewCursor();
+    for (cursor->SeekToFirst(); cursor->Valid(); cursor->Next()) {
+      TensorProtos protos;
+      CAFFE_ENFORCE(protos.ParseFromString(cursor->value()));
+      for (int i = 0; i < protos.protos_size(); ++i) {
+        if (protos.protos(i).has_device_detail()) {
+          protos.mutable_protos(i)->clear_device_detail();
+        }
+        deserializer.Deserialize(protos.protos(i), &record);
+        writer.Write(
+            valueFields[i], written[i], record.raw_data(), record.nbytes());
+        written[i] += record.nbytes();
+      }
+    }
+    writer.Close();
+    return true;
+  }
+
+ private:
+  string dbType_;
+  string dbName_;
+  string filename_;
+  std::vector<string> fieldNames_;
+};
+
+REGISTER_CPU_OPERATOR(SaveColumnarFile, SaveColumnarFileOp);
+REGISTER_CPU_OPERATOR(LoadColumnarFile, LoadColumnarFileOp);
+REGISTER_CPU_OPERATOR(ConvertDBToColumnarFile, ConvertDBToColumnarFileOp);
+
+OPERATOR_SCHEMA(SaveColumnarFile)
+    .NumInputs(1, INT_MAX)
+    .NumOutputs(0)
+    .SetDoc(R"DOC(
+Saves the input tensors, e.g. the fields of a dataset, to a columnar file:
+after a header with the names, types and shapes of the fields, the data of
+each field is stored contiguously and page aligned, so that
+LoadColumnarFile can map it into memory instead of parsing it. The tensors
+must have fixed size types (not strings).
+)DOC")
+    .Arg("filename", "Path of the file to write.")
+    .Arg(
+        "field_names",
+        "(list of strings) Names of the fields, by default the names of the "
+        "input blobs.");
+
+OPERATOR_SCHEMA(LoadColumnarFile)
+    .NumInputs(0)
+    .NumOutputs(1, INT_MAX)
+    .SetDoc(R"DOC(
+Loads the fields of a columnar file, as written by SaveColumnarFile or
+ConvertDBToColumnarFile, one per output. The outputs view the file mapped into
+memory, without parsing or copying it; the mapping is private, so writing to
+the outputs does not change the file, and it lasts until no output uses it.
+Batches can be read from the fields with the dataset ops, e.g. ReadNextBatch.
+)DOC")
+    .Arg("filename", "Path of the file to load.");
+
+OPERATOR_SCHEMA(ConvertDBToColumnarFile)
+    .NumInputs(0)
+    .NumOutputs(0)
+    .SetDoc(R"DOC(
+Converts a db with TensorProtos values, as read by TensorProtosDBInput, to a
+columnar file. The i-th tensor of every record goes to the field named
+field_names[i]: if it has the same shape in every record, the field holds the
+tensors stacked, with the number of records as its first dim. Otherwise the
+tensors may only differ in their first dim, and they are concatenated along it
+into the field <name>:values, with their first dims in the field
+<name>:lengths, as in a dataset.
+)DOC")
+    .Arg("db_type", "Type of the db, e.g. leveldb, lmdb or minidb.")
+    .Arg("db", "Path of the db.")
+    .Arg("filename", "Path of the file to write.")
+    .Arg(
+        "field_names",
+        "(list of strings) Names of the tensors of the records, by default "
+        "field_<i>.");
+
+NO_GRADIENT(SaveColumnarFile);
+NO_GRADIENT(LoadColumnarFile);
+NO_GRADIENT(ConvertDBToColumnarFile);
+
+} // namespace caffe2
@@ -0,0 +1,135 @@
+#include <cstdio>
+#include <cstdint>
+
+#include "caffe2/core/db.h"
+#include "caffe2/core/operator.h"
+#include "caffe2/utils/proto_utils.h"
+#include <gtest/gtest.h>
+
+namespace caffe2 {
+
+namespace {
+
+void RunOp(const OperatorDef& def, Workspace* ws) {
+  unique_ptr<OperatorBase> op(CreateOperator(def, ws));
+  EXPECT_TRUE(op->Run());
+}
+
+template <typename T>
+void FillTensor(
+    Workspace* ws,
+    const string& name,
+    const vector<TIndex>& shape,
+    const vector<T>& values) {
+  auto* tensor = ws->CreateBlob(name)->GetMutable<TensorCPU>();
+  tensor->Resize(shape);
+  std::copy(values.begin(), values.end(), tensor->mutable_data<T>());
+}
+
+template <typename T>
+void ExpectTensor(
+    Workspace* ws,
+    const string& name,
+    const vector<TIndex>& shape,
+    const vector<T>& values) {
+  const auto& tensor = ws->GetBlob(name)->Get<TensorCPU>();
+  EXPECT_EQ(tensor.dims(), shape);
+  ASSERT_EQ(tensor.size(), values.size());
+  for (int i = 0; i < values.size(); ++i) {
+    EXPECT_EQ(tensor.data<T>()[i], values[i]);
+  }
+}
+
+} // namespace
+
+TEST(ColumnarFileTest, SaveAndLoad) {
+  string filename = std::tmpnam(nullptr);
+  Workspace ws;
+  FillTensor<float>(&ws, "x", {2, 3}, {1, 2, 3, 4, 5, 6});
+  FillTensor<int64_t>(&ws, "ids", {3}, {7, 8, 9});
+  FillTensor<int>(&ws, "empty", {0}, {});
+  RunOp(
+      CreateOperatorDef(
+          "SaveColumnarFile",
+          "",
+          {"x", "ids", "empty"},
+          {},
+          {MakeArgument<string>("filename", filename)}),
+      &ws);
+  RunOp(
+      CreateOperatorDef(
+          "LoadColumnarFile",
+          "",
+          {},
+          {"x2", "ids2", "empty2"},
+          {MakeArgument<string>("filename", filename)}),
+      &ws);
+  ExpectTensor<float>(&ws, "x2", {2, 3}, {1, 2, 3, 4, 5, 6});
+  ExpectTensor<int64_t>(&ws, "ids2", {3}, {7, 8, 9});
+  ExpectTensor<int>(&ws, "empty2", {0}, {});
+  // the fields are page aligned views of the file
+  EXPECT_EQ(
+      reinterpret_cast<uintptr_t>(
+          ws.GetBlob("ids2")->Get<TensorCPU>().raw_data()) %
+          4096,
+      0);
+  std::remove(filename.c_str());
+}
+
+TEST(ColumnarFileTest, ConvertDB) {
+  string dbname = std::tmpnam(nullptr);
+  string filename = std::tmpnam(nullptr);
+  {
+    std::unique_ptr<db::DB> db(db::CreateDB("minidb", dbname, db::NEW));
+    std::unique_ptr<db::Transaction> trans(db->NewTransaction());
+    for (int i = 0; i < 3; ++i) {
+      TensorProtos protos;
+      // a float label of the same shape in every record
+      auto* label = protos.add_protos();
+      label->set_data_type(TensorProto_DataType_FLOAT);
+      label->add_dims(1);
+      label->add_float_data(i);
+      // i + 1 ids of 2 ints
+      auto* ids = protos.add_protos();
+      ids->set_data_type(TensorProto_DataType_INT32);
+      ids->add_dims(i + 1);
+      ids->add_dims(2);
+      for (int j = 0; j < 2 * (i + 1); ++j) {
+        ids->add_int32_data(10 * i + j);
+      }
+      trans->Put(caffe2::to_string(i), protos.SerializeAsString());
+    }
+    trans->Commit();
+  }
+  Workspace ws;
+  RunOp(
+      CreateOperatorDef(
+          "ConvertDBToColumnarFile",
+          "",
+          {},
+          {},
+          {MakeArgument<string>("db_type", "minidb"),
+           MakeArgument<string>("db", dbname),
+           MakeArgument<string>("filename", filename),
+           MakeArgument<vector<string>>("field_names", {"label", "ids"})}),
+      &ws);
+  RunOp(
+      CreateOperatorDef(
+          "LoadColumnarFile",
+          "",
+          {},
+          {"label", "ids:lengths", "ids:values"},
+          {MakeArgument<string>("filename", filename)}),
+      &ws);
+  ExpectTensor<float>(&ws, "label", {3, 1}, {0, 1, 2});
+  ExpectTensor<int>(&ws, "ids:lengths", {3}, {1, 2, 3});
+  ExpectTensor<int>(
+      &ws,
+      "ids:values",
+      {6, 2},
+      {0, 1, 10, 11, 12, 13, 20, 21, 22, 23, 24, 25});
+  std::remove(dbname.c_str());
+  std::remove(filename.c_str());
+}
+
+} // namespace caffe2
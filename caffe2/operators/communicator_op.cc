@@ -74,6 +74,29 @@ Does an allreduce operation among the nodes. Currently only Sum is supported.
     .Input(1, "X", "A tensor to be allreduced.")
     .Output(0, "Y", "The allreduced tensor, same on all nodes.");
 
+OPERATOR_SCHEMA(FusedAllreduce)
+    .NumInputsOutputs([](int in, int out) {
+      return in >= 2 && out == (in - 1);
+    })
+    .EnforceInplace([](int in, int out) { return (in - 1) == out; })
+    .TensorInferenceFunction([](const OperatorDef& /* unused */,
+                                const vector<TensorShape>& in) {
+      return vector<TensorShape>(in.begin() + 1, in.end());
+    })
+    .InputsCanCrossDevices()
+    .SetDoc(R"DOC(
+Does an allreduce operation among the nodes of several tensors of the same
+type but possibly different sizes, e.g. the gradients of a bucket of
+parameters, at the cost of a single allreduce of their total size. Currently
+only Sum is supported.
+)DOC")
+    .Input(0, "comm_world", "The common world.")
+    .Input(1, "X", "Tensors to be allreduced, the copies of every tensor on "
+           "the num_devices devices next to each other.")
+    .Output(0, "Y", "The allreduced tensors, same on all nodes.")
+    .Arg("num_devices", "(int, default 1) number of devices with a copy of "
+         "every tensor.");
+
 OPERATOR_SCHEMA(ReduceScatter)
     .NumInputsOutputs([](int in, int out) {
       return in >= 2 && out == (in - 1);
@@ -182,6 +205,7 @@ SHOULD_NOT_DO_GRADIENT(Broadcast);
 SHOULD_NOT_DO_GRADIENT(Reduce);
 SHOULD_NOT_DO_GRADIENT(Allgather);
 SHOULD_NOT_DO_GRADIENT(Allreduce);
+SHOULD_NOT_DO_GRADIENT(FusedAllreduce);
 SHOULD_NOT_DO_GRADIENT(ReduceScatter);
 SHOULD_NOT_DO_GRADIENT(Barrier);
 SHOULD_NOT_DO_GRADIENT(SendTensor);
@@ -195,6 +219,7 @@ REGISTER_CPU_OPERATOR(Broadcast, NoDefaultEngineOp<CPUContext>);
 REGISTER_CPU_OPERATOR(Reduce, NoDefaultEngineOp<CPUContext>);
 REGISTER_CPU_OPERATOR(Allgather, NoDefaultEngineOp<CPUContext>);
 REGISTER_CPU_OPERATOR(Allreduce, NoDefaultEngineOp<CPUContext>);
+REGISTER_CPU_OPERATOR(FusedAllreduce, NoDefaultEngineOp<CPUContext>);
 REGISTER_CPU_OPERATOR(ReduceScatter, NoDefaultEngineOp<CPUContext>);
 REGISTER_CPU_OPERATOR(Barrier, NoDefaultEngineOp<CPUContext>);
 REGISTER_CPU_OPERATOR(SendTensor, NoDefaultEngineOp<CPUContext>);
@@ -10,6 +10,7 @@ REGISTER_CUDA_OPERATOR(Broadcast, NoDefaultEngineOp<CUDAContext>);
 REGISTER_CUDA_OPERATOR(Reduce, NoDefaultEngineOp<CUDAContext>);
 REGISTER_CUDA_OPERATOR(Allgather, NoDefaultEngineOp<CUDAContext>);
 REGISTER_CUDA_OPERATOR(Allreduce, NoDefaultEngineOp<CUDAContext>);
+REGISTER_CUDA_OPERATOR(FusedAllreduce, NoDefaultEngineOp<CUDAContext>);
 REGISTER_CUDA_OPERATOR(SendTensor, NoDefaultEngineOp<CUDAContext>);
 REGISTER_CUDA_OPERATOR(ReceiveTensor, NoDefaultEngineOp<CUDAContext>);
 
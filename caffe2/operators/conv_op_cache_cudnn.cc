@@ -1,14 +1,131 @@
 #include "caffe2/operators/conv_op_cache_cudnn.h"
 
 #include <cudnn.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <fstream>
 
 #include "caffe2/core/logging.h"
 #include "caffe2/core/tensor.h"
 
+CAFFE2_DEFINE_string(
+    caffe2_cudnn_conv_algo_cache_file,
+    "",
+    "File that persists the algorithms found by exhaustive search of the "
+    "cuDNN conv ops across processes: loaded on first use and updated with "
+    "every new search");
+
 namespace caffe2 {
 
 template class AlgorithmsCache<cudnnConvolutionFwdAlgo_t>;
 template class AlgorithmsCache<cudnnConvolutionBwdFilterAlgo_t>;
 template class AlgorithmsCache<cudnnConvolutionBwdDataAlgo_t>;
 template class AlgorithmsCache<int>; // For testing.
+
+SharedAlgorithmsCache& SharedAlgorithmsCache::Instance() {
+  static SharedAlgorithmsCache* cache = []() {
+    auto* cache = new SharedAlgorithmsCache();
+    cache->file_ = FLAGS_caffe2_cudnn_conv_algo_cache_file;
+    if (!cache->file_.empty() && cache->Load(cache->file_)) {
+      VLOG(1) << "Loaded " << cache->Size() << " cuDNN conv algorithms from "
+              << cache->file_;
+    }
+    return cache;
+  }();
+  return *cache;
+}
+
+bool SharedAlgorithmsCache::Find(
+    const std::string& key,
+    int* algorithm,
+    float* time) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  auto it = entries_.find(key);
+  if (it == entries_.end()) {
+    return false;
+  }
+  *algorithm = it->second.first;
+  *time = it->second.second;
+  return true;
+}
+
+void SharedAlgorithmsCache::Insert(
+    const std::string& key,
+    int algorithm,
+    float time) {
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    entries_[key] = std::make_pair(algorithm, time);
+  }
+  if (!file_.empty()) {
+    Save(file_);
+  }
+}
+
+size_t SharedAlgorithmsCache::Size() {
+  std::lock_guard<std::mutex> guard(mutex_);
+  return entries_.size();
+}
+
+void SharedAlgorithmsCache::Clear() {
+  std::lock_guard<std::mutex> guard(mutex_);
+  entries_.clear();
+}
+
+// One entry per line: key, algorithm and time separated by tabs. Keys have
+// no tabs or newlines.
+bool SharedAlgorithmsCache::Load(const std::string& path) {
+  std::ifstream file(path);
+  if (!file) {
+    return false;
+  }
+  std::unordered_map<std::string, std::pair<int, float>> loaded;
+  std::string line;
+  while (std::getline(file, line)) {
+    auto time_pos = line.rfind('\t');
+    auto algorithm_pos = time_pos == std::string::npos || time_pos == 0
+        ? std::string::npos
+        : line.rfind('\t', time_pos - 1);
+    if (algorithm_pos == std::string::npos) {
+      LOG(WARNING) << "Skipping malformed line of " << path << ": " << line;
+      continue;
+    }
+    loaded[line.substr(0, algorithm_pos)] = std::make_pair(
+        std::stoi(line.substr(algorithm_pos + 1, time_pos - algorithm_pos - 1)),
+        std::stof(line.substr(time_pos + 1)));
+  }
+  std::lock_guard<std::mutex> guard(mutex_);
+  // entries found by this process win
+  loaded.insert(entries_.begin(), entries_.end());
+  entries_.swap(loaded);
+  return true;
+}
+
+void SharedAlgorithmsCache::Save(const std::string& path) {
+  // Pick up what other processes wrote since, then replace the file
+  // atomically so that readers never see a partial one
+  std::lock_guard<std::mutex> file_guard(file_mutex_);
+  Load(path);
+  auto tmp_path = path + ".tmp" + caffe2::to_string(getpid());
+  std::ofstream file(tmp_path);
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    for (const auto& entry : entries_) {
+      file << entry.first << '\t' << entry.second.first << '\t'
+           << entry.second.second << '\n';
+    }
+  }
+  file.close();
+  if (!file) {
+    LOG(WARNING) << "Failed to write the cuDNN conv algorithms to "
+                 << tmp_path;
+    std::remove(tmp_path.c_str());
+    return;
+  }
+  if (std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+    LOG(WARNING) << "Failed to write the cuDNN conv algorithms to " << path;
+    std::remove(tmp_path.c_str());
+  }
+}
 } // namespace caffe2
@@ -2,12 +2,18 @@
 #define CAFFE2_OPERATORS_CONV_OP_CACHE_H_
 
 #include <functional>
+#include <mutex>
+#include <string>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "caffe2/core/logging.h"
+#include "caffe2/core/flags.h"
 #include "caffe2/core/tensor.h"
 
+CAFFE2_DECLARE_string(caffe2_cudnn_conv_algo_cache_file);
+
 namespace caffe2 {
 template <typename TAlgorithm>
 class AlgorithmsCache {
@@ -61,6 +67,38 @@ TAlgorithm AlgorithmsCache<TAlgorithm>::getAlgorithm(
 
   return hash_[seed];
 }
+
+// Results of cuDNN algorithm searches, shared by all the conv ops of the
+// process so that an op configured like one seen before skips the search.
+// Keys are strings that describe everything the result depends on: the
+// pass, the tensor, filter and convolution descriptors, the GPU model and
+// the cuDNN version; values are the algorithm and its time.
+//
+// With --caffe2_cudnn_conv_algo_cache_file, Instance() is preloaded from
+// that file and every new result is written back to it, so later processes
+// skip the searches too.
+class SharedAlgorithmsCache {
+ public:
+  static SharedAlgorithmsCache& Instance();
+
+  bool Find(const std::string& key, int* algorithm, float* time);
+  void Insert(const std::string& key, int algorithm, float time);
+  size_t Size();
+  void Clear();
+
+  // Adds the entries of a file written by Save, keeping the existing ones.
+  // Returns false if the file can't be read.
+  bool Load(const std::string& path);
+  // Writes all entries, plus those already in the file, to path
+  void Save(const std::string& path);
+
+ private:
+  std::mutex mutex_;
+  // Serializes Save, which writes through a temporary file per process
+  std::mutex file_mutex_;
+  std::unordered_map<std::string, std::pair<int, float>> entries_;
+  std::string file_;
+};
 } // namespace caffe2
 
 #endif
@@ -1,3 +1,4 @@
+#include <cstdio>
 #include <vector>
 
 #include "caffe2/core/context_gpu.h"
@@ -58,4 +59,30 @@ TEST(AlgorithmsCacheTest, KeysDifferIfFlagsAreDifferent) {
   EXPECT_EQ(res3, 10);
 }
 
+TEST(SharedAlgorithmsCacheTest, SavesAndLoads) {
+  auto path = std::string(std::tmpnam(nullptr));
+  SharedAlgorithmsCache cache;
+  cache.Insert("fwd;X=float;1,3,224,224,;gpu=Tesla P100", 2, 0.5);
+  cache.Insert("bwd_data;X=float;1,3,224,224,;gpu=Tesla P100", 1, 1.5);
+  cache.Save(path);
+
+  SharedAlgorithmsCache loaded;
+  loaded.Insert("fwd;X=float16;1,3,224,224,;gpu=Tesla P100", 6, 0.25);
+  EXPECT_TRUE(loaded.Load(path));
+  EXPECT_EQ(loaded.Size(), 3);
+  int algorithm;
+  float time;
+  EXPECT_TRUE(loaded.Find(
+      "fwd;X=float;1,3,224,224,;gpu=Tesla P100", &algorithm, &time));
+  EXPECT_EQ(algorithm, 2);
+  EXPECT_FLOAT_EQ(time, 0.5);
+  EXPECT_TRUE(loaded.Find(
+      "fwd;X=float16;1,3,224,224,;gpu=Tesla P100", &algorithm, &time));
+  EXPECT_EQ(algorithm, 6);
+  EXPECT_FALSE(loaded.Find("fwd;X=float;gpu=Tesla K80", &algorithm, &time));
+  std::remove(path.c_str());
+
+  EXPECT_FALSE(loaded.Load(path));
+}
+
 } // namespace caffe2
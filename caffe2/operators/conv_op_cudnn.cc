@@ -402,6 +402,64 @@ class CudnnConvOpBase : public ConvPoolOpBase<CUDAContext> {
     }
   }
 
+  // Key of the algorithms found for pass in SharedAlgorithmsCache: the
+  // input and filter, everything about the convolution, the GPU model and
+  // the cuDNN version
+  std::string SharedAlgoCacheKey(
+      const char* pass,
+      const TypeMeta& X_type,
+      const vector<TIndex>& X_dims,
+      const TypeMeta& filter_type,
+      const vector<TIndex>& filter_dims,
+      cudnnDataType_t compute_type) {
+    std::stringstream key;
+    auto append = [&key](const char* name, const vector<TIndex>& values) {
+      key << ";" << name << "=";
+      for (auto value : values) {
+        key << value << ",";
+      }
+    };
+    key << pass << ";X=" << X_type.name();
+    append("", X_dims);
+    key << ";filter=" << filter_type.name();
+    append("", filter_dims);
+    append("kernel", vector<TIndex>(kernel_.begin(), kernel_.end()));
+    append("stride", vector<TIndex>(stride_.begin(), stride_.end()));
+    append("pads", vector<TIndex>(pads_.begin(), pads_.end()));
+    append("dilation", vector<TIndex>(dilation_.begin(), dilation_.end()));
+    key << ";group=" << group_ << ";order=" << static_cast<int>(order_)
+        << ";compute=" << compute_type << ";tensor_core=" << enable_tensor_core_
+        << ";ws_limit=" << cudnn_ws_nbytes_limit_
+        << ";gpu=" << GetDeviceProperty(context_.cuda_gpu_id()).name
+        << ";cudnn=" << CUDNN_VERSION;
+    auto str = key.str();
+    std::replace(str.begin(), str.end(), '\t', ' ');
+    std::replace(str.begin(), str.end(), '\n', ' ');
+    return str;
+  }
+
+  template <typename TAlgorithm>
+  bool FindSharedAlgorithm(
+      const std::string& key,
+      std::tuple<TAlgorithm, float>* result) {
+    int algorithm;
+    float time;
+    if (!SharedAlgorithmsCache::Instance().Find(key, &algorithm, &time)) {
+      return false;
+    }
+    *result = std::make_tuple(static_cast<TAlgorithm>(algorithm), time);
+    return true;
+  }
+
+  template <typename TAlgorithm>
+  std::tuple<TAlgorithm, float> InsertSharedAlgorithm(
+      const std::string& key,
+      const std::tuple<TAlgorithm, float>& result) {
+    SharedAlgorithmsCache::Instance().Insert(
+        key, static_cast<int>(std::get<0>(result)), std::get<1>(result));
+    return result;
+  }
+
   vector<TIndex> cudnn_input_dims_;
   vector<TIndex> cudnn_filter_dims_;
 
@@ -684,6 +742,17 @@ bool CudnnConvOp::DoRunWithType() {
 
         algosToCompare[i] = algo_cache_.getAlgorithm(
             X.dims(), filter.dims(), kComputeTypesToTry[i], [&]() {
+              auto key = SharedAlgoCacheKey(
+                  "fwd",
+                  X.meta(),
+                  X.dims(),
+                  filter.meta(),
+                  filter.dims(),
+                  kComputeTypesToTry[i]);
+              ConvFwdAlgorithmWithCost cached;
+              if (FindSharedAlgorithm(key, &cached)) {
+                return cached;
+              }
               VLOG(1) << "CUDNN Convolution fwd: doing exhaustive "
                       << "search for " << kComputePassNames[i];
               // When we do an exhaustive search, we will ignore the workspace
@@ -716,7 +785,9 @@ bool CudnnConvOp::DoRunWithType() {
               float algo_time = fwd_perf_stat[0].status == CUDNN_STATUS_SUCCESS
                   ? fwd_perf_stat[0].time
                   : 1e10;
-              return ConvFwdAlgorithmWithCost(fwd_perf_stat[0].algo, algo_time);
+              return InsertSharedAlgorithm(
+                  key,
+                  ConvFwdAlgorithmWithCost(fwd_perf_stat[0].algo, algo_time));
             });
 
         // When set to fp32 compute, don't try fp16
@@ -1049,6 +1120,17 @@ bool CudnnConvGradientOp::DoRunWithType() {
 
         algosToCompare[i] = filter_algo_cache_.getAlgorithm(
             X.dims(), filter.dims(), kComputeTypesToTry[i], [&]() {
+              auto key = SharedAlgoCacheKey(
+                  "bwd_filter",
+                  X.meta(),
+                  X.dims(),
+                  filter.meta(),
+                  filter.dims(),
+                  kComputeTypesToTry[i]);
+              ConvBwdFilterAlgorithmWithCost cached;
+              if (FindSharedAlgorithm(key, &cached)) {
+                return cached;
+              }
               VLOG(1) << "CUDNN Convolution bwd: doing filter exhaustive"
                       << "search for " << kComputePassNames[i];
               // When we do an exhaustive search, we will ignore the workspace
@@ -1085,8 +1167,10 @@ bool CudnnConvGradientOp::DoRunWithType() {
                   filter_perf_stat[0].status == CUDNN_STATUS_SUCCESS
                   ? filter_perf_stat[0].time
                   : 1e10;
-              return ConvBwdFilterAlgorithmWithCost(
-                  filter_perf_stat[0].algo, algo_time);
+              return InsertSharedAlgorithm(
+                  key,
+                  ConvBwdFilterAlgorithmWithCost(
+                      filter_perf_stat[0].algo, algo_time));
             });
 
         // When set to fp32 compute, don't try fp16
@@ -1136,6 +1220,17 @@ bool CudnnConvGradientOp::DoRunWithType() {
 
           algosToCompare[i] = data_algo_cache_.getAlgorithm(
               X.dims(), filter.dims(), kComputeTypesToTry[i], [&]() {
+                auto key = SharedAlgoCacheKey(
+                    "bwd_data",
+                    X.meta(),
+                    X.dims(),
+                    filter.meta(),
+                    filter.dims(),
+                    kComputeTypesToTry[i]);
+                ConvBwdDataAlgorithmWithCost cached;
+                if (FindSharedAlgorithm(key, &cached)) {
+                  return cached;
+                }
                 VLOG(1) << "CUDNN Convolution bwd: doing data exhaustive"
                         << "search for " << kComputePassNames[i];
                 int returned_algo_count;
@@ -1173,8 +1268,10 @@ bool CudnnConvGradientOp::DoRunWithType() {
                     data_perf_stat[0].status == CUDNN_STATUS_SUCCESS
                     ? data_perf_stat[0].time
                     : 1e10;
-                return ConvBwdDataAlgorithmWithCost(
-                    data_perf_stat[0].algo, algo_time);
+                return InsertSharedAlgorithm(
+                    key,
+                    ConvBwdDataAlgorithmWithCost(
+                        data_perf_stat[0].algo, algo_time));
               });
 
           // When set to fp32 compute, don't try fp16
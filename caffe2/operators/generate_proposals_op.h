@@ -116,6 +116,22 @@ class GenerateProposalsOp final : public Operator<Context> {
   // Set to true to match the detectron code, set to false for backward
   // compatibility
   bool correct_transform_coords_{false};
+
+  // Scratch space of the CUDA implementation, see generate_proposals_op_gpu.cu
+  Tensor<Context> dev_proposals_;
+  Tensor<Context> dev_sorted_proposals_;
+  Tensor<Context> dev_keys_;
+  Tensor<Context> dev_sorted_keys_;
+  Tensor<Context> dev_values_;
+  Tensor<Context> dev_sorted_values_;
+  Tensor<Context> dev_segment_offsets_;
+  Tensor<Context> dev_sort_buffer_;
+  Tensor<Context> dev_num_valid_;
+  Tensor<Context> dev_num_boxes_;
+  Tensor<Context> dev_keep_;
+  Tensor<Context> dev_num_keep_;
+  Tensor<Context> dev_nms_mask_;
+  TensorCPU host_num_keep_;
 };
 
 } // namespace caffe2
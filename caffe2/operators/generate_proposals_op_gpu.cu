@@ -0,0 +1,343 @@
+#include <cfloat>
+#include <numeric>
+
+#include <cub/cub.cuh>
+
+#include "caffe2/core/context_gpu.h"
+#include "caffe2/operators/generate_proposals_op.h"
+#include "caffe2/operators/generate_proposals_op_util_boxes.h"
+#include "caffe2/operators/generate_proposals_op_util_nms_gpu.h"
+
+// CUDA implementation of GenerateProposalsOp. The proposals of all the
+//    images are decoded, filtered, sorted (one radix sort segment per image),
+//    cut to pre_nms_topN and suppressed (one NMS segment per image) on the
+//    device. The only copy to the host is the number of proposals kept per
+//    image, to size the outputs.
+
+namespace caffe2 {
+
+namespace {
+
+// Decodes the proposal of every anchor of every image like
+//    ProposalsForOneImage: bbox_transform, clip_boxes and filter_boxes.
+//    Proposal i of image n is anchor a at pixel (h, w), with
+//    i = (h * W + w) * A + a. Writes the proposals, their scores, or -FLT_MAX
+//    for those filtered out, to be sorted with i, and counts the proposals
+//    not filtered out in num_valid.
+__global__ void GenerateProposalsDecodeKernel(
+    const int num_images,
+    const int A,
+    const int H,
+    const int W,
+    const float* anchors,
+    const float* bbox_deltas,
+    const float* scores,
+    const float* im_info,
+    const float feat_stride,
+    const float min_size,
+    const float bbox_xform_clip,
+    const bool correct_transform_coords,
+    float* proposals,
+    float* keys,
+    int* values,
+    int* num_valid) {
+  const int K = H * W;
+  CUDA_1D_KERNEL_LOOP(index, num_images * K * A) {
+    const int a = index % A;
+    const int k = (index / A) % K;
+    const int n = index / (K * A);
+    const int i = index % (K * A);
+    const float shift_x = (k % W) * feat_stride;
+    const float shift_y = (k / W) * feat_stride;
+    const float* anchor = anchors + a * 4;
+    const float x1 = anchor[0] + shift_x;
+    const float y1 = anchor[1] + shift_y;
+    const float x2 = anchor[2] + shift_x;
+    const float y2 = anchor[3] + shift_y;
+
+    // deltas of anchor a at k, in (N, 4 * A, H, W)
+    const float* delta = bbox_deltas + (n * A + a) * 4 * K + k;
+    const float dx = delta[0];
+    const float dy = delta[K];
+    const float dw = fminf(delta[2 * K], bbox_xform_clip);
+    const float dh = fminf(delta[3 * K], bbox_xform_clip);
+
+    const float width = x2 - x1 + 1.0f;
+    const float height = y2 - y1 + 1.0f;
+    const float pred_ctr_x = dx * width + (x1 + 0.5f * width);
+    const float pred_ctr_y = dy * height + (y1 + 0.5f * height);
+    const float pred_w = expf(dw) * width;
+    const float pred_h = expf(dh) * height;
+    const float offset = correct_transform_coords ? 1.0f : 0.0f;
+
+    // clip_boxes takes the image size as ints
+    const float* info = im_info + n * 3;
+    const float max_x = static_cast<int>(info[1]) - 1;
+    const float max_y = static_cast<int>(info[0]) - 1;
+    float box[4];
+    box[0] = fmaxf(fminf(pred_ctr_x - 0.5f * pred_w, max_x), 0.0f);
+    box[1] = fmaxf(fminf(pred_ctr_y - 0.5f * pred_h, max_y), 0.0f);
+    box[2] = fmaxf(fminf(pred_ctr_x + 0.5f * pred_w - offset, max_x), 0.0f);
+    box[3] = fmaxf(fminf(pred_ctr_y + 0.5f * pred_h - offset, max_y), 0.0f);
+    for (int c = 0; c < 4; ++c) {
+      proposals[index * 4 + c] = box[c];
+    }
+
+    const float scaled_min_size = min_size * info[2];
+    const float ws = box[2] - box[0] + 1.0f;
+    const float hs = box[3] - box[1] + 1.0f;
+    const bool keep = ws >= scaled_min_size && hs >= scaled_min_size &&
+        box[0] + ws / 2 < info[1] && box[1] + hs / 2 < info[0];
+    keys[index] = keep ? scores[(n * A + a) * K + k] : -FLT_MAX;
+    values[index] = i;
+    if (keep) {
+      atomicAdd(&num_valid[n], 1);
+    }
+  }
+}
+
+__global__ void InitSegmentOffsetsKernel(
+    const int num_segments,
+    const int segment_size,
+    int* offsets) {
+  CUDA_1D_KERNEL_LOOP(i, num_segments + 1) {
+    offsets[i] = i * segment_size;
+  }
+}
+
+// Gathers the top num_top proposals of each image in the order of their
+//    scores, and the number of them that weren't filtered out
+__global__ void GatherTopProposalsKernel(
+    const int num_images,
+    const int num_proposals,
+    const int num_top,
+    const float* proposals,
+    const int* sorted_values,
+    const int* num_valid,
+    float* sorted_proposals,
+    int* num_boxes) {
+  CUDA_1D_KERNEL_LOOP(index, num_images * num_top) {
+    const int n = index / num_top;
+    const int i = index % num_top;
+    const int src = n * num_proposals + sorted_values[n * num_proposals + i];
+    for (int c = 0; c < 4; ++c) {
+      sorted_proposals[index * 4 + c] = proposals[src * 4 + c];
+    }
+    if (i == 0) {
+      num_boxes[n] = min(num_valid[n], num_top);
+    }
+  }
+}
+
+// Writes the proposals kept by the NMS, image after image, as
+//    (image_index, x1, y1, x2, y2) rois and their scores
+__global__ void WriteProposalsKernel(
+    const int num_images,
+    const int num_proposals,
+    const int num_top,
+    const float* sorted_proposals,
+    const float* sorted_keys,
+    const int* keep,
+    const int* num_keep,
+    float* rois,
+    float* rois_probs) {
+  CUDA_1D_KERNEL_LOOP(index, num_images * num_top) {
+    const int n = index / num_top;
+    const int i = index % num_top;
+    if (i >= num_keep[n]) {
+      continue;
+    }
+    int out = i;
+    for (int j = 0; j < n; ++j) {
+      out += num_keep[j];
+    }
+    const int box = keep[index];
+    rois[out * 5] = n;
+    for (int c = 0; c < 4; ++c) {
+      rois[out * 5 + 1 + c] = sorted_proposals[(n * num_top + box) * 4 + c];
+    }
+    rois_probs[out] = sorted_keys[n * num_proposals + box];
+  }
+}
+
+} // namespace
+
+template <>
+bool GenerateProposalsOp<CUDAContext>::RunOnDevice() {
+  const auto& scores = Input(0);
+  const auto& bbox_deltas = Input(1);
+  const auto& im_info_tensor = Input(2);
+  const auto& anchors = Input(3);
+  auto* out_rois = Output(0);
+  auto* out_rois_probs = Output(1);
+
+  CAFFE_ENFORCE_EQ(scores.ndim(), 4, scores.ndim());
+  CAFFE_ENFORCE(scores.template IsType<float>(), scores.meta().name());
+  const int num_images = scores.dim32(0);
+  const int A = scores.dim32(1);
+  const int height = scores.dim32(2);
+  const int width = scores.dim32(3);
+  const int num_proposals = height * width * A;
+
+  CAFFE_ENFORCE_EQ(
+      bbox_deltas.dims(), (vector<TIndex>{num_images, 4 * A, height, width}));
+  CAFFE_ENFORCE_EQ(im_info_tensor.dims(), (vector<TIndex>{num_images, 3}));
+  CAFFE_ENFORCE(
+      im_info_tensor.template IsType<float>(), im_info_tensor.meta().name());
+  CAFFE_ENFORCE_EQ(anchors.dims(), (vector<TIndex>{A, 4}));
+  CAFFE_ENFORCE(anchors.template IsType<float>(), anchors.meta().name());
+
+  const int roi_col_count = 5;
+  if (num_images == 0 || num_proposals == 0) {
+    out_rois->Resize(0, roi_col_count);
+    out_rois_probs->Resize(0);
+    out_rois->mutable_data<float>();
+    out_rois_probs->mutable_data<float>();
+    return true;
+  }
+
+  // 1. decode, clip and filter the proposals
+  const int total = num_images * num_proposals;
+  dev_proposals_.Resize(total, 4);
+  dev_keys_.Resize(total);
+  dev_values_.Resize(total);
+  dev_num_valid_.Resize(num_images);
+  int* num_valid = dev_num_valid_.mutable_data<int>();
+  math::Set<int, CUDAContext>(num_images, 0, num_valid, &context_);
+  GenerateProposalsDecodeKernel<<<
+      CAFFE_GET_BLOCKS(total),
+      CAFFE_CUDA_NUM_THREADS,
+      0,
+      context_.cuda_stream()>>>(
+      num_images,
+      A,
+      height,
+      width,
+      anchors.data<float>(),
+      bbox_deltas.data<float>(),
+      scores.data<float>(),
+      im_info_tensor.data<float>(),
+      feat_stride_,
+      rpn_min_size_,
+      utils::BBOX_XFORM_CLIP_DEFAULT,
+      correct_transform_coords_,
+      dev_proposals_.mutable_data<float>(),
+      dev_keys_.mutable_data<float>(),
+      dev_values_.mutable_data<int>(),
+      num_valid);
+
+  // 2. sort the proposals of each image by score, the filtered ones last
+  dev_segment_offsets_.Resize(num_images + 1);
+  int* offsets = dev_segment_offsets_.mutable_data<int>();
+  InitSegmentOffsetsKernel<<<
+      CAFFE_GET_BLOCKS(num_images + 1),
+      CAFFE_CUDA_NUM_THREADS,
+      0,
+      context_.cuda_stream()>>>(num_images, num_proposals, offsets);
+  dev_sorted_keys_.Resize(total);
+  dev_sorted_values_.Resize(total);
+  size_t sort_bytes = 0;
+  cub::DeviceSegmentedRadixSort::SortPairsDescending(
+      nullptr,
+      sort_bytes,
+      dev_keys_.data<float>(),
+      dev_sorted_keys_.mutable_data<float>(),
+      dev_values_.data<int>(),
+      dev_sorted_values_.mutable_data<int>(),
+      total,
+      num_images,
+      offsets,
+      offsets + 1,
+      0,
+      8 * sizeof(float),
+      context_.cuda_stream());
+  dev_sort_buffer_.Resize(sort_bytes);
+  cub::DeviceSegmentedRadixSort::SortPairsDescending(
+      static_cast<void*>(dev_sort_buffer_.mutable_data<char>()),
+      sort_bytes,
+      dev_keys_.data<float>(),
+      dev_sorted_keys_.mutable_data<float>(),
+      dev_values_.data<int>(),
+      dev_sorted_values_.mutable_data<int>(),
+      total,
+      num_images,
+      offsets,
+      offsets + 1,
+      0,
+      8 * sizeof(float),
+      context_.cuda_stream());
+
+  // 3. take the top pre_nms_topN of each image
+  const int num_top =
+      (rpn_pre_nms_topN_ > 0 && rpn_pre_nms_topN_ < num_proposals)
+      ? rpn_pre_nms_topN_
+      : num_proposals;
+  dev_sorted_proposals_.Resize(num_images * num_top, 4);
+  dev_num_boxes_.Resize(num_images);
+  GatherTopProposalsKernel<<<
+      CAFFE_GET_BLOCKS(num_images * num_top),
+      CAFFE_CUDA_NUM_THREADS,
+      0,
+      context_.cuda_stream()>>>(
+      num_images,
+      num_proposals,
+      num_top,
+      dev_proposals_.data<float>(),
+      dev_sorted_values_.data<int>(),
+      num_valid,
+      dev_sorted_proposals_.mutable_data<float>(),
+      dev_num_boxes_.mutable_data<int>());
+
+  // 4. apply the nms, keeping up to post_nms_topN proposals per image
+  dev_keep_.Resize(num_images * num_top);
+  dev_num_keep_.Resize(num_images);
+  utils::nms_gpu(
+      dev_sorted_proposals_.data<float>(),
+      dev_num_boxes_.data<int>(),
+      num_images,
+      num_top,
+      rpn_nms_thresh_,
+      rpn_post_nms_topN_ > 0 ? rpn_post_nms_topN_ : -1,
+      dev_keep_.mutable_data<int>(),
+      dev_num_keep_.mutable_data<int>(),
+      &dev_nms_mask_,
+      &context_);
+
+  // 5. write the outputs, which are sized on the host
+  host_num_keep_.Resize(num_images);
+  context_.Copy<int, CUDAContext, CPUContext>(
+      num_images,
+      dev_num_keep_.data<int>(),
+      host_num_keep_.mutable_data<int>());
+  context_.FinishDeviceComputation();
+  const int* num_keep = host_num_keep_.data<int>();
+  const int total_keep = std::accumulate(num_keep, num_keep + num_images, 0);
+
+  out_rois->Resize(total_keep, roi_col_count);
+  out_rois_probs->Resize(total_keep);
+  float* rois = out_rois->mutable_data<float>();
+  float* rois_probs = out_rois_probs->mutable_data<float>();
+  if (total_keep > 0) {
+    WriteProposalsKernel<<<
+        CAFFE_GET_BLOCKS(num_images * num_top),
+        CAFFE_CUDA_NUM_THREADS,
+        0,
+        context_.cuda_stream()>>>(
+        num_images,
+        num_proposals,
+        num_top,
+        dev_sorted_proposals_.data<float>(),
+        dev_sorted_keys_.data<float>(),
+        dev_keep_.data<int>(),
+        dev_num_keep_.data<int>(),
+        rois,
+        rois_probs);
+  }
+  return true;
+}
+
+REGISTER_CUDA_OPERATOR(GenerateProposals, GenerateProposalsOp<CUDAContext>);
+// For backward compatibility
+REGISTER_CUDA_OPERATOR(GenerateProposalsCPP, GenerateProposalsOp<CUDAContext>);
+
+} // namespace caffe2
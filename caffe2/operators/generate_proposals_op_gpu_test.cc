@@ -0,0 +1,186 @@
+#include <random>
+
+#include "caffe2/utils/eigen_utils.h"
+#include "generate_proposals_op.h"
+
+#include "caffe2/core/context_gpu.h"
+#include "caffe2/core/flags.h"
+#include "caffe2/utils/math.h"
+#include "gtest/gtest.h"
+
+namespace caffe2 {
+namespace {
+
+template <class Context>
+void AddInput(
+    const vector<TIndex>& shape,
+    const vector<float>& values,
+    const string& name,
+    Workspace* ws) {
+  TensorCPU tmp(shape);
+  EigenVectorMap<float> tmp_vec(tmp.mutable_data<float>(), tmp.size());
+  tmp_vec.array() = utils::AsEArrXt(values);
+
+  Blob* blob = ws->CreateBlob(name);
+  auto* tensor = blob->template GetMutable<Tensor<Context>>();
+  tensor->CopyFrom(tmp);
+}
+
+template <class Context>
+DeviceType GetDeviceType() {
+  return CPU;
+}
+template <>
+DeviceType GetDeviceType<CUDAContext>() {
+  return CUDA;
+}
+
+vector<float> RandomValues(int n, float min_val, float max_val, int seed) {
+  std::mt19937 gen(seed);
+  std::uniform_real_distribution<float> dist(min_val, max_val);
+  vector<float> values(n);
+  for (auto& v : values) {
+    v = dist(gen);
+  }
+  return values;
+}
+
+// Boxes [x1, y1, x2, y2] of random positions and sizes in a 200 x 200
+// image, crowded enough for the NMS to suppress many of them
+vector<float> RandomBoxes(int n, int seed) {
+  auto corners = RandomValues(2 * n, 0, 150, seed);
+  auto sizes = RandomValues(2 * n, 5, 50, seed + 1);
+  vector<float> boxes(4 * n);
+  for (int i = 0; i < n; i++) {
+    boxes[4 * i] = corners[2 * i];
+    boxes[4 * i + 1] = corners[2 * i + 1];
+    boxes[4 * i + 2] = corners[2 * i] + sizes[2 * i];
+    boxes[4 * i + 3] = corners[2 * i + 1] + sizes[2 * i + 1];
+  }
+  return boxes;
+}
+
+// Runs op on the device of Context and copies its outputs to the host
+template <class Context>
+vector<TensorCPU> RunOnContext(
+    OperatorDef def,
+    const std::map<string, std::pair<vector<TIndex>, vector<float>>>& inputs) {
+  Workspace ws;
+  Context context;
+  for (const auto& input : inputs) {
+    AddInput<Context>(
+        input.second.first, input.second.second, input.first, &ws);
+  }
+  def.mutable_device_option()->set_device_type(GetDeviceType<Context>());
+  unique_ptr<OperatorBase> op(CreateOperator(def, &ws));
+  EXPECT_NE(nullptr, op.get());
+  EXPECT_TRUE(op->Run());
+
+  vector<TensorCPU> outputs(def.output_size());
+  for (int i = 0; i < def.output_size(); i++) {
+    const auto& output = ws.GetBlob(def.output(i))->Get<Tensor<Context>>();
+    outputs[i].CopyFrom(output, &context);
+  }
+  context.FinishDeviceComputation();
+  return outputs;
+}
+
+template <typename T>
+void ExpectTensorsNear(const TensorCPU& expected, const TensorCPU& result) {
+  ASSERT_EQ(expected.dims(), result.dims());
+  for (int i = 0; i < expected.size(); i++) {
+    EXPECT_NEAR(expected.data<T>()[i], result.data<T>()[i], 1e-3) << i;
+  }
+}
+
+} // namespace
+
+TEST(GenerateProposalsGPUTest, TestCPUGPUEqual) {
+  if (!caffe2::HasCudaGPU()) {
+    return;
+  }
+  const int img_count = 2;
+  const int A = 3;
+  const int H = 12;
+  const int W = 10;
+
+  OperatorDef def;
+  def.set_name("test");
+  def.set_type("GenerateProposals");
+  def.add_input("scores");
+  def.add_input("bbox_deltas");
+  def.add_input("im_info");
+  def.add_input("anchors");
+  def.add_output("rois");
+  def.add_output("rois_probs");
+  def.add_arg()->CopyFrom(MakeArgument("spatial_scale", 1.0f / 16.0f));
+  def.add_arg()->CopyFrom(MakeArgument("pre_nms_topN", 200));
+  def.add_arg()->CopyFrom(MakeArgument("post_nms_topN", 50));
+  def.add_arg()->CopyFrom(MakeArgument("nms_thresh", 0.7f));
+  def.add_arg()->CopyFrom(MakeArgument("min_size", 4.0f));
+
+  std::map<string, std::pair<vector<TIndex>, vector<float>>> inputs;
+  inputs["scores"] = {{img_count, A, H, W},
+                      RandomValues(img_count * A * H * W, 0, 1, 1)};
+  inputs["bbox_deltas"] = {{img_count, 4 * A, H, W},
+                           RandomValues(img_count * 4 * A * H * W, -1, 1, 2)};
+  // the second image is smaller, so some proposals are clipped and filtered
+  inputs["im_info"] = {{img_count, 3}, {192, 160, 1.0, 120, 100, 0.5}};
+  inputs["anchors"] = {
+      {A, 4}, {-8, -8, 23, 23, -24, -8, 39, 23, -8, -24, 23, 39}};
+
+  auto cpu = RunOnContext<CPUContext>(def, inputs);
+  auto gpu = RunOnContext<CUDAContext>(def, inputs);
+  EXPECT_GT(cpu[0].dim(0), img_count);
+  ExpectTensorsNear<float>(cpu[0], gpu[0]);
+  ExpectTensorsNear<float>(cpu[1], gpu[1]);
+}
+
+TEST(BoxWithNMSLimitGPUTest, TestCPUGPUEqual) {
+  if (!caffe2::HasCudaGPU()) {
+    return;
+  }
+  const int N = 80;
+  const int num_classes = 5;
+
+  OperatorDef def;
+  def.set_name("test");
+  def.set_type("BoxWithNMSLimit");
+  def.add_input("scores");
+  def.add_input("boxes");
+  def.add_input("batch_splits");
+  def.add_output("out_scores");
+  def.add_output("out_boxes");
+  def.add_output("out_classes");
+  def.add_output("out_batch_splits");
+  def.add_output("out_keeps");
+  def.add_output("out_keeps_size");
+  def.add_arg()->CopyFrom(MakeArgument("score_thresh", 0.2f));
+  def.add_arg()->CopyFrom(MakeArgument("nms", 0.4f));
+
+  std::map<string, std::pair<vector<TIndex>, vector<float>>> inputs;
+  inputs["scores"] = {{N, num_classes}, RandomValues(N * num_classes, 0, 1, 3)};
+  inputs["boxes"] = {{N, num_classes * 4}, RandomBoxes(N * num_classes, 4)};
+  inputs["batch_splits"] = {{2}, {30, 50}};
+
+  // with and without the limit of detections per image
+  for (int detections_per_im : {15, 0}) {
+    OperatorDef limited_def = def;
+    limited_def.add_arg()->CopyFrom(
+        MakeArgument("detections_per_im", detections_per_im));
+    auto cpu = RunOnContext<CPUContext>(limited_def, inputs);
+    auto gpu = RunOnContext<CUDAContext>(limited_def, inputs);
+    EXPECT_GT(cpu[0].size(), 0);
+    for (int i = 0; i < 4; i++) {
+      ExpectTensorsNear<float>(cpu[i], gpu[i]);
+    }
+    for (int i = 4; i < 6; i++) {
+      ASSERT_EQ(cpu[i].dims(), gpu[i].dims());
+      for (int j = 0; j < cpu[i].size(); j++) {
+        EXPECT_EQ(cpu[i].data<int>()[j], gpu[i].data<int>()[j]);
+      }
+    }
+  }
+}
+
+} // namespace caffe2
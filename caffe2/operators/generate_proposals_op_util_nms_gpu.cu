@@ -0,0 +1,172 @@
+#include "caffe2/operators/generate_proposals_op_util_nms_gpu.h"
+
+#include "caffe2/utils/math.h"
+
+namespace caffe2 {
+namespace utils {
+
+namespace {
+
+typedef unsigned long long mask_t;
+
+// Boxes per word of a mask, and threads per block of NMSMaskKernel
+constexpr int kBoxesPerWord = 64;
+// Threads per block of NMSScanKernel
+constexpr int kScanThreads = 128;
+
+// IoU of boxes a and b in pixel coordinates, as computed by nms_cpu
+__device__ inline float BoxIoU(const float* a, const float* b) {
+  const float width = fmaxf(fminf(a[2], b[2]) - fmaxf(a[0], b[0]) + 1.f, 0.f);
+  const float height = fmaxf(fminf(a[3], b[3]) - fmaxf(a[1], b[1]) + 1.f, 0.f);
+  const float inter = width * height;
+  const float area_a = (a[2] - a[0] + 1.f) * (a[3] - a[1] + 1.f);
+  const float area_b = (b[2] - b[0] + 1.f) * (b[3] - b[1] + 1.f);
+  return inter / (area_a + area_b - inter);
+}
+
+// Grid: (num_words, num_words, num_segments). Block (x, y) of a segment
+//    compares its boxes [64 * y, 64 * y + 64) with its boxes
+//    [64 * x, 64 * x + 64), and writes word x of the mask of each of the
+//    former. Only the words at or after the diagonal are needed.
+__global__ void NMSMaskKernel(
+    const float* sorted_boxes,
+    const int* num_boxes,
+    const int max_boxes,
+    const int num_words,
+    const float thresh,
+    mask_t* mask) {
+  const int segment = blockIdx.z;
+  const int n = num_boxes[segment];
+  const int row_start = blockIdx.y * kBoxesPerWord;
+  const int col_start = blockIdx.x * kBoxesPerWord;
+  if (blockIdx.x < blockIdx.y || row_start >= n || col_start >= n) {
+    return;
+  }
+  const float* boxes =
+      sorted_boxes + static_cast<size_t>(segment) * max_boxes * 4;
+
+  __shared__ float col_boxes[kBoxesPerWord * 4];
+  const int num_cols = min(n - col_start, kBoxesPerWord);
+  if (threadIdx.x < num_cols) {
+    for (int k = 0; k < 4; ++k) {
+      col_boxes[threadIdx.x * 4 + k] =
+          boxes[(col_start + threadIdx.x) * 4 + k];
+    }
+  }
+  __syncthreads();
+
+  const int row = row_start + threadIdx.x;
+  if (row >= n) {
+    return;
+  }
+  const float* row_box = boxes + row * 4;
+  mask_t bits = 0;
+  const int first_col = (blockIdx.x == blockIdx.y) ? threadIdx.x + 1 : 0;
+  for (int j = first_col; j < num_cols; ++j) {
+    // nms_cpu keeps a box if its overlap is <= thresh, so a NaN overlap
+    // suppresses it as well
+    if (!(BoxIoU(row_box, col_boxes + j * 4) <= thresh)) {
+      bits |= 1ULL << j;
+    }
+  }
+  mask[(static_cast<size_t>(segment) * max_boxes + row) * num_words +
+       blockIdx.x] = bits;
+}
+
+// One block per segment. removed, in shared memory, has a bit per box of the
+// segment. Every thread tests the same bit of each box, so that the block
+// takes the same branches and only synchronizes for the boxes kept.
+__global__ void NMSScanKernel(
+    const mask_t* mask,
+    const int* num_boxes,
+    const int max_boxes,
+    const int num_words,
+    const int topN,
+    int* keep,
+    int* num_keep) {
+  extern __shared__ mask_t removed[];
+  const int segment = blockIdx.x;
+  const int n = num_boxes[segment];
+  const int words = (n + kBoxesPerWord - 1) / kBoxesPerWord;
+  for (int w = threadIdx.x; w < words; w += blockDim.x) {
+    removed[w] = 0;
+  }
+  __syncthreads();
+
+  const mask_t* segment_mask =
+      mask + static_cast<size_t>(segment) * max_boxes * num_words;
+  int* segment_keep = keep + segment * max_boxes;
+  int kept = 0;
+  for (int i = 0; i < n && (topN < 0 || kept < topN); ++i) {
+    const int word = i / kBoxesPerWord;
+    if (removed[word] & (1ULL << (i % kBoxesPerWord))) {
+      continue;
+    }
+    if (threadIdx.x == 0) {
+      segment_keep[kept] = i;
+    }
+    ++kept;
+    // all the threads have to test removed[word] before it is updated
+    __syncthreads();
+    const mask_t* row = segment_mask + static_cast<size_t>(i) * num_words;
+    for (int w = word + threadIdx.x; w < words; w += blockDim.x) {
+      removed[w] |= row[w];
+    }
+    __syncthreads();
+  }
+  if (threadIdx.x == 0) {
+    num_keep[segment] = kept;
+  }
+}
+
+} // namespace
+
+void nms_gpu(
+    const float* d_sorted_boxes,
+    const int* d_num_boxes,
+    int num_segments,
+    int max_boxes,
+    float thresh,
+    int topN,
+    int* d_keep,
+    int* d_num_keep,
+    TensorCUDA* dev_mask,
+    CUDAContext* context) {
+  CAFFE_ENFORCE_GE(num_segments, 0);
+  CAFFE_ENFORCE_GE(max_boxes, 0);
+  if (num_segments == 0) {
+    return;
+  }
+  if (max_boxes == 0) {
+    math::Set<int, CUDAContext>(num_segments, 0, d_num_keep, context);
+    return;
+  }
+  const int num_words = (max_boxes + kBoxesPerWord - 1) / kBoxesPerWord;
+  // limits of the grid of NMSMaskKernel and of the shared memory of
+  // NMSScanKernel
+  CAFFE_ENFORCE_LE(num_segments, 65535, "Too many NMS segments");
+  CAFFE_ENFORCE_LE(
+      num_words * sizeof(mask_t),
+      48 * 1024,
+      "Too many boxes per NMS segment: ",
+      max_boxes);
+
+  dev_mask->Resize(static_cast<TIndex>(num_segments) * max_boxes * num_words);
+  mask_t* mask = reinterpret_cast<mask_t*>(dev_mask->mutable_data<int64_t>());
+
+  NMSMaskKernel<<<
+      dim3(num_words, num_words, num_segments),
+      kBoxesPerWord,
+      0,
+      context->cuda_stream()>>>(
+      d_sorted_boxes, d_num_boxes, max_boxes, num_words, thresh, mask);
+  NMSScanKernel<<<
+      num_segments,
+      kScanThreads,
+      num_words * sizeof(mask_t),
+      context->cuda_stream()>>>(
+      mask, d_num_boxes, max_boxes, num_words, topN, d_keep, d_num_keep);
+}
+
+} // namespace utils
+} // namespace caffe2
@@ -0,0 +1,46 @@
+#ifndef CAFFE2_OPERATORS_UTILS_NMS_GPU_H_
+#define CAFFE2_OPERATORS_UTILS_NMS_GPU_H_
+
+#include "caffe2/core/context_gpu.h"
+
+namespace caffe2 {
+namespace utils {
+
+// Greedy non-maximum suppression of a batch of independent sets of boxes
+//    ("segments", e.g. the proposals of each image, or the detections of
+//    each class of each image) on the GPU, with the result of nms_cpu for
+//    each segment.
+// One kernel computes, for every box, the bitmask of the lower scoring boxes
+//    of its segment whose IoU with it is larger than thresh, 64 boxes per
+//    word. A second kernel, with one block per segment, walks the boxes in
+//    order and removes the boxes masked by every box it keeps; the walk only
+//    synchronizes its threads for the boxes kept.
+// d_sorted_boxes: pixel coordinates of the boxes, size (num_segments *
+//    max_boxes, 4), format: [x1; y1; x2; y2]. The boxes of segment s start at
+//    row s * max_boxes, sorted by decreasing score.
+// d_num_boxes: the number of boxes of each segment, at most max_boxes,
+//    size (num_segments). On the device.
+// topN: the maximum number of boxes kept per segment, -1 for no limit
+// d_keep: output, the kept rows of segment s, relative to its first row, are
+//    written from d_keep[s * max_boxes], in decreasing order of score.
+//    Size (num_segments * max_boxes). On the device.
+// d_num_keep: output, the number of kept boxes of each segment, size
+//    (num_segments). On the device.
+// dev_mask: scratch space of the bitmasks, resized as needed
+// Nothing is synchronized with the host.
+void nms_gpu(
+    const float* d_sorted_boxes,
+    const int* d_num_boxes,
+    int num_segments,
+    int max_boxes,
+    float thresh,
+    int topN,
+    int* d_keep,
+    int* d_num_keep,
+    TensorCUDA* dev_mask,
+    CUDAContext* context);
+
+} // namespace utils
+} // namespace caffe2
+
+#endif // CAFFE2_OPERATORS_UTILS_NMS_GPU_H_
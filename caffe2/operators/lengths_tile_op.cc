@@ -1,6 +1,48 @@
 #include "caffe2/operators/lengths_tile_op.h"
 
 namespace caffe2 {
+
+template <>
+bool LengthsTileOp<CPUContext>::RunOnDevice() {
+  auto& data = Input(DATA);
+  auto& lengths = Input(LENGTHS);
+  auto* output = Output(0);
+
+  CAFFE_ENFORCE_EQ(lengths.ndim(), 1, "LENGTHS must be 1-D");
+  CAFFE_ENFORCE_GE(data.ndim(), 1, "DATA should be at least 1-D");
+  CAFFE_ENFORCE_EQ(lengths.size(), data.dim(0));
+
+  // Context::CopyFrom and math::Sum need the same context to avoid race
+  // conditions
+  CPUContext cpuContext;
+  lengths_host_.CopyFrom(lengths, &cpuContext);
+  auto lengths_size = lengths_host_.size();
+  auto* lengths_data = lengths_host_.data<int32_t>();
+
+  int32_t total_length = 0;
+  math::Sum<int32_t, CPUContext>(
+      lengths_size, lengths_data, &total_length, &cpuContext);
+
+  auto shape = data.dims();
+  shape[0] = total_length;
+  output->Resize(shape);
+
+  auto block_bytesize = data.size_from_dim(1) * data.meta().itemsize();
+  auto src = static_cast<const char*>(data.raw_data());
+  auto out = static_cast<char*>(output->raw_mutable_data(data.meta()));
+
+  for (TIndex i = 0; i < lengths_size; ++i) {
+    auto length = lengths_data[i];
+    CAFFE_ENFORCE_GE(length, 0);
+    for (int32_t j = 0; j < length; ++j) {
+      context_.CopyBytes<CPUContext, CPUContext>(block_bytesize, src, out);
+      out += block_bytesize;
+    }
+    src += block_bytesize;
+  }
+  return true;
+}
+
 REGISTER_CPU_OPERATOR(LengthsTile, LengthsTileOp<CPUContext>);
 
 OPERATOR_SCHEMA(LengthsTile)
@@ -0,0 +1,155 @@
+#include <cub/device/device_scan.cuh>
+#include "caffe2/core/context_gpu.h"
+#include "caffe2/operators/lengths_tile_op.h"
+
+namespace caffe2 {
+
+namespace {
+
+// One thread per element of the output, which copies it from the row of DATA
+// whose segment covers the output row: the first one that ends after it,
+// found by a binary search of the inclusive prefix sum of the lengths.
+template <typename T>
+__global__ void LengthsTileKernel(
+    const T* data,
+    const int32_t* lengths_inclusive_sum,
+    const int64_t num_segments,
+    const int64_t num_rows,
+    const int64_t block_size,
+    T* out) {
+  CUDA_1D_KERNEL_LOOP(i, num_rows * block_size) {
+    int64_t row = i / block_size;
+    int64_t lo = 0;
+    int64_t hi = num_segments - 1;
+    while (lo < hi) {
+      int64_t mid = (lo + hi) / 2;
+      if (lengths_inclusive_sum[mid] > row) {
+        hi = mid;
+      } else {
+        lo = mid + 1;
+      }
+    }
+    out[i] = data[lo * block_size + i % block_size];
+  }
+}
+
+template <typename T>
+void LengthsTile(
+    const void* data,
+    const int32_t* lengths_inclusive_sum,
+    int64_t num_segments,
+    int64_t num_rows,
+    int64_t block_bytesize,
+    void* out,
+    CUDAContext* context) {
+  const int64_t block_size = block_bytesize / sizeof(T);
+  LengthsTileKernel<T><<<
+      CAFFE_GET_BLOCKS(num_rows * block_size),
+      CAFFE_CUDA_NUM_THREADS,
+      0,
+      context->cuda_stream()>>>(
+      static_cast<const T*>(data),
+      lengths_inclusive_sum,
+      num_segments,
+      num_rows,
+      block_size,
+      static_cast<T*>(out));
+}
+
+} // namespace
+
+template <>
+bool LengthsTileOp<CUDAContext>::RunOnDevice() {
+  auto& data = Input(DATA);
+  auto& lengths = Input(LENGTHS);
+  auto* output = Output(0);
+
+  CAFFE_ENFORCE_EQ(lengths.ndim(), 1, "LENGTHS must be 1-D");
+  CAFFE_ENFORCE_GE(data.ndim(), 1, "DATA should be at least 1-D");
+  CAFFE_ENFORCE_EQ(lengths.size(), data.dim(0));
+
+  // The ends of the segments are computed on the device. The last one, the
+  // size of the output, is the only value copied to the host.
+  const int num_segments = lengths.size();
+  lengths_inclusive_sum_.ResizeLike(lengths);
+  int32_t total_length = 0;
+  if (num_segments > 0) {
+    size_t temp_storage_bytes = 0;
+    cub::DeviceScan::InclusiveSum(
+        nullptr,
+        temp_storage_bytes,
+        lengths.data<int32_t>(),
+        lengths_inclusive_sum_.mutable_data<int32_t>(),
+        num_segments,
+        context_.cuda_stream());
+    scan_buffer_.Resize(
+        (temp_storage_bytes + sizeof(int32_t)) / sizeof(int32_t));
+    cub::DeviceScan::InclusiveSum(
+        static_cast<void*>(scan_buffer_.mutable_data<int32_t>()),
+        temp_storage_bytes,
+        lengths.data<int32_t>(),
+        lengths_inclusive_sum_.mutable_data<int32_t>(),
+        num_segments,
+        context_.cuda_stream());
+    context_.Copy<int32_t, CUDAContext, CPUContext>(
+        1,
+        lengths_inclusive_sum_.data<int32_t>() + num_segments - 1,
+        &total_length);
+    context_.FinishDeviceComputation();
+  }
+
+  auto shape = data.dims();
+  shape[0] = total_length;
+  output->Resize(shape);
+  auto* out = output->raw_mutable_data(data.meta());
+
+  const int64_t block_bytesize = data.size_from_dim(1) * data.itemsize();
+  if (total_length == 0 || block_bytesize == 0) {
+    return true;
+  }
+
+  // Rows are copied in the widest words that divide them, whatever the type
+  // of DATA
+  const int32_t* ends = lengths_inclusive_sum_.data<int32_t>();
+  if (block_bytesize % sizeof(int64_t) == 0) {
+    LengthsTile<int64_t>(
+        data.raw_data(),
+        ends,
+        num_segments,
+        total_length,
+        block_bytesize,
+        out,
+        &context_);
+  } else if (block_bytesize % sizeof(int32_t) == 0) {
+    LengthsTile<int32_t>(
+        data.raw_data(),
+        ends,
+        num_segments,
+        total_length,
+        block_bytesize,
+        out,
+        &context_);
+  } else if (block_bytesize % sizeof(int16_t) == 0) {
+    LengthsTile<int16_t>(
+        data.raw_data(),
+        ends,
+        num_segments,
+        total_length,
+        block_bytesize,
+        out,
+        &context_);
+  } else {
+    LengthsTile<char>(
+        data.raw_data(),
+        ends,
+        num_segments,
+        total_length,
+        block_bytesize,
+        out,
+        &context_);
+  }
+  return true;
+}
+
+REGISTER_CUDA_OPERATOR(LengthsTile, LengthsTileOp<CUDAContext>);
+} // namespace caffe2
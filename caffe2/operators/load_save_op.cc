@@ -82,7 +82,12 @@ to specify the type of the input db/dbs.
         "source_blob_names",
         "(list of strings) if set, used instead of output "
         "blob names, to specify which blobs in the db shall be loaded. Must be "
-        "the same length as number of output blobs.");
+        "the same length as number of output blobs.")
+    .Arg(
+        "num_threads",
+        "(int, default 1) the number of threads to parse and deserialize the "
+        "values on, while the db is read. The chunks of a tensor are "
+        "deserialized in parallel as well.");
 
 OPERATOR_SCHEMA(Save)
     .NumInputs(1, INT_MAX)
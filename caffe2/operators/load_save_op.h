@@ -1,8 +1,15 @@
 #ifndef CAFFE2_OPERATORS_LOAD_SAVE_OP_H_
 #define CAFFE2_OPERATORS_LOAD_SAVE_OP_H_
 
+#include <atomic>
+#include <condition_variable>
 #include <cstdio>
+#include <exception>
+#include <limits>
 #include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
 #include <unordered_set>
 
 #include "caffe2/core/blob_serialization.h"
@@ -12,6 +19,7 @@
 #include "caffe2/core/operator.h"
 #include "caffe2/utils/math.h"
 #include "caffe2/utils/proto_utils.h"
+#include "caffe2/utils/simple_queue.h"
 
 namespace caffe2 {
 
@@ -85,8 +93,10 @@ class LoadOp final : public Operator<Context> {
         load_all_(OperatorBase::GetSingleArgument<int>("load_all", 0)),
         allow_incomplete_(
             OperatorBase::GetSingleArgument<bool>("allow_incomplete", false)),
+        num_threads_(OperatorBase::GetSingleArgument<int>("num_threads", 1)),
         blob_names_(
             OperatorBase::GetRepeatedArgument<string>("source_blob_names")) {
+    CAFFE_ENFORCE_GE(num_threads_, 1, "num_threads must be positive.");
     if (InputSize() == 0) {
       CAFFE_ENFORCE_GT(db_type_.size(), 0, "Must specify a db type.");
       if (db_names_.empty()) {
@@ -133,12 +143,12 @@ class LoadOp final : public Operator<Context> {
   void SetCurrentDevice(BlobProto* proto);
 
   bool RunOnDevice() override {
-    int total_loaded_blobs = 0;
     std::unordered_map<string, BlobState> blob_states;
+    BlobLoader loader(this, &blob_states);
     if (InputSize() > 0) {
       for (int i = 0; i < InputSize(); ++i) {
         const db::DBReader& reader = OperatorBase::Input<db::DBReader>(i);
-        extract(i, reader.cursor(), &blob_states, &total_loaded_blobs);
+        extract(i, reader.cursor(), &loader);
       }
     } else {
       for (int i = 0; i < db_names_.size(); ++i) {
@@ -149,9 +159,10 @@ class LoadOp final : public Operator<Context> {
             caffe2::db::CreateDB(db_type_, full_db_name, caffe2::db::READ));
         CAFFE_ENFORCE(in_db.get(), "Cannot open db: ", full_db_name);
         std::unique_ptr<Cursor> cursor(in_db->NewCursor());
-        extract(i, cursor.get(), &blob_states, &total_loaded_blobs);
+        extract(i, cursor.get(), &loader);
       }
     }
+    int total_loaded_blobs = loader.loaded_blobs();
 
     validateBlobStates(blob_states);
     // Loaded all the needed blobs.
@@ -182,30 +193,205 @@ class LoadOp final : public Operator<Context> {
   }
 
  private:
-  void extract(
-      int db_id,
-      Cursor* cursor,
-      std::unordered_map<string, BlobState>* blob_states,
-      int* total_loaded_blobs) {
-    if (load_all_) {
-      extractAll(db_id, cursor, blob_states, total_loaded_blobs);
-    } else {
-      extractFrom(
-          db_id,
-          cursor,
-          OperatorBase::Outputs(),
-          blob_states,
-          total_loaded_blobs);
+  // Loads db values into their blobs, and keeps track of what was loaded.
+  // With num_threads > 1, values are parsed and deserialized on that many
+  // threads while the caller reads the next ones from the db. The chunks of a
+  // tensor go to disjoint parts of it, so only the first value of each blob,
+  // which resets and allocates it, has to be deserialized on its own. Values
+  // are parsed straight from the memory of dbs that support
+  // Cursor::RawValue.
+  class BlobLoader {
+   public:
+    BlobLoader(LoadOp* op, std::unordered_map<string, BlobState>* blob_states)
+        : op_(op),
+          blob_states_(blob_states),
+          loaded_blobs_(0),
+          pending_(0),
+          cancelled_(false) {
+      for (int i = 0; op_->num_threads_ > 1 && i < op_->num_threads_; ++i) {
+        threads_.emplace_back([this]() { this->work(); });
+      }
+    }
+
+    ~BlobLoader() {
+      jobs_.NoMoreJobs();
+      for (auto& thread : threads_) {
+        thread.join();
+      }
+    }
+
+    // Drops the values passed to Load() that have not been loaded yet, and
+    // waits for the others
+    void Cancel() {
+      std::unique_lock<std::mutex> lock(mutex_);
+      cancelled_ = true;
+      done_.wait(lock, [this]() { return pending_ == 0; });
+    }
+
+    // Loads the current value of cursor into blob. It may be read after the
+    // call returns, until Wait() does.
+    void Load(Blob* blob, const string& key, Cursor* cursor) {
+      Job job{blob, key, nullptr, nullptr, 0};
+      if (!cursor->RawValue(&job.data, &job.size)) {
+        job.value = std::make_shared<string>(cursor->value());
+      }
+      if (threads_.empty()) {
+        BlobProto proto;
+        job.Parse(&proto);
+        if (!op_->keep_device_) {
+          // If we are not keeping the device as the one specified in the
+          // proto, we will set the current device.
+          op_->SetCurrentDevice(&proto);
+        }
+        op_->ProcessBlob(blob, proto, blob_states_, key, &loaded_blobs_);
+        return;
+      }
+      std::unique_lock<std::mutex> lock(mutex_);
+      // Bounds the memory held by values waiting to be loaded
+      done_.wait(lock, [this]() {
+        return pending_ < 2 * threads_.size() || error_;
+      });
+      rethrowError();
+      pending_++;
+      lock.unlock();
+      jobs_.Push(std::move(job));
+    }
+
+    // Waits for every value passed to Load() to be loaded, and rethrows the
+    // first error a thread ran into
+    void Wait() {
+      std::unique_lock<std::mutex> lock(mutex_);
+      done_.wait(lock, [this]() { return pending_ == 0; });
+      rethrowError();
+    }
+
+    int loaded_blobs() {
+      std::lock_guard<std::mutex> lock(mutex_);
+      return loaded_blobs_;
+    }
+
+   private:
+    struct Job {
+      Blob* blob;
+      string key;
+      std::shared_ptr<string> value;
+      // The value in the memory of the db, or null if it was copied to value
+      const char* data;
+      size_t size;
+
+      void Parse(BlobProto* proto) {
+        if (data) {
+          CAFFE_ENFORCE_LE(size, std::numeric_limits<int>::max());
+          CAFFE_ENFORCE(
+              proto->ParseFromArray(data, size), "Couldn't parse Proto");
+        } else {
+          CAFFE_ENFORCE(
+              proto->ParseFromString(*value), "Couldn't parse Proto");
+        }
+      }
+    };
+
+    struct KeyState {
+      std::mutex mutex;
+      bool reset = false;
+      std::atomic<bool> allocated{false};
+    };
+
+    void work() {
+      // SetCurrentDevice uses the current device of the thread
+      Context context(op_->device_option());
+      context.SwitchToDevice(0);
+      Job job{};
+      while (jobs_.Pop(&job)) {
+        try {
+          bool skip;
+          {
+            std::lock_guard<std::mutex> lock(mutex_);
+            skip = cancelled_ || error_;
+          }
+          if (!skip) {
+            process(job);
+          }
+        } catch (...) {
+          std::lock_guard<std::mutex> lock(mutex_);
+          if (!error_) {
+            error_ = std::current_exception();
+          }
+        }
+        {
+          std::lock_guard<std::mutex> lock(mutex_);
+          pending_--;
+        }
+        done_.notify_all();
+      }
+    }
+
+    void process(Job& job) {
+      BlobProto proto;
+      job.Parse(&proto);
+      if (!op_->keep_device_) {
+        op_->SetCurrentDevice(&proto);
+      }
+      KeyState* state;
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        state = &key_states_[job.key];
+      }
+      if (proto.has_tensor() && proto.tensor().has_segment() &&
+          state->allocated) {
+        job.blob->Deserialize(proto);
+      } else {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        if (!state->reset) {
+          // See ProcessBlob
+          job.blob->Reset();
+          state->reset = true;
+        }
+        job.blob->Deserialize(proto);
+        state->allocated = proto.has_tensor();
+      }
+      std::lock_guard<std::mutex> lock(mutex_);
+      op_->RecordBlob(proto, blob_states_, job.key, &loaded_blobs_);
+    }
+
+    void rethrowError() {
+      if (error_) {
+        std::rethrow_exception(error_);
+      }
+    }
+
+    LoadOp* op_;
+    std::unordered_map<string, BlobState>* blob_states_;
+    std::vector<std::thread> threads_;
+    SimpleQueue<Job> jobs_;
+    // Guards everything below, and blob_states_
+    std::mutex mutex_;
+    std::condition_variable done_;
+    int loaded_blobs_;
+    size_t pending_;
+    bool cancelled_;
+    std::exception_ptr error_;
+    // unordered_map never moves its elements
+    std::unordered_map<string, KeyState> key_states_;
+  };
+
+  void extract(int db_id, Cursor* cursor, BlobLoader* loader) {
+    // The values of cursor must not be used once it is gone
+    try {
+      if (load_all_) {
+        extractAll(db_id, cursor, loader);
+      } else {
+        extractFrom(db_id, cursor, OperatorBase::Outputs(), loader);
+      }
+    } catch (...) {
+      loader->Cancel();
+      throw;
     }
+    loader->Wait();
   }
 
-  void extractAll(
-      int db_id,
-      Cursor* cursor,
-      std::unordered_map<string, BlobState>* blob_states,
-      int* total_loaded_blobs) {
+  void extractAll(int db_id, Cursor* cursor, BlobLoader* loader) {
     CAFFE_ENFORCE(cursor, "cursor is not valid");
-    int loaded_blobs = 0;
     for (; cursor->Valid(); cursor->Next()) {
       const auto key = buildBlobNameFromDbKey(cursor->key());
       if (key_to_dbid_.count(key) && key_to_dbid_[key] != db_id) {
@@ -214,28 +400,17 @@ class LoadOp final : public Operator<Context> {
         key_to_dbid_[key] = db_id;
       }
 
-      BlobProto proto;
-      CAFFE_ENFORCE(
-          proto.ParseFromString(cursor->value()), "Couldn't parse Proto");
-      if (!keep_device_) {
-        // If we are not keeping the device as the one specified in the
-        // proto, we will set the current device.
-        SetCurrentDevice(&proto);
-      }
       Blob* blob = ws_->CreateBlob(key);
-      ProcessBlob(blob, proto, blob_states, key, &loaded_blobs);
+      loader->Load(blob, key, cursor);
     }
-    *total_loaded_blobs += loaded_blobs;
   }
 
   void extractFrom(
       int db_id,
       Cursor* cursor,
       const vector<Blob*>& outputs,
-      std::unordered_map<string, BlobState>* blob_states,
-      int* total_loaded_blobs) {
+      BlobLoader* loader) {
     CAFFE_ENFORCE(cursor);
-    int loaded_blobs = 0;
     for (; cursor->Valid(); cursor->Next()) {
       const auto key = buildBlobNameFromDbKey(cursor->key());
       if (!output_indices_.count(key)) {
@@ -248,24 +423,17 @@ class LoadOp final : public Operator<Context> {
         }
 
         VLOG(2) << "Deserializing blob " << key;
-        BlobProto proto;
-        CAFFE_ENFORCE(proto.ParseFromString(cursor->value()));
-        if (!keep_device_) {
-          // If we are not keeping the device as the one specified in the
-          // proto, we will set the current device.
-          SetCurrentDevice(&proto);
-        }
         auto blobIndex = output_indices_[key];
         Blob* blob = outputs.at(blobIndex);
-        ProcessBlob(blob, proto, blob_states, key, &loaded_blobs);
+        loader->Load(blob, key, cursor);
 
-        if (*total_loaded_blobs + loaded_blobs == OutputSize()) {
+        // Lags behind the values loaded on other threads, so that the db may
+        // be read further than needed
+        if (loader->loaded_blobs() == OutputSize()) {
           break;
         }
       }
     }
-
-    *total_loaded_blobs += loaded_blobs;
   }
 
   string buildBlobNameFromDbKey(const string& dbKey) {
@@ -299,6 +467,15 @@ class LoadOp final : public Operator<Context> {
       blob->Reset();
     }
     blob->Deserialize(proto);
+    RecordBlob(proto, blob_states_ptr, key, loaded_blobs);
+  }
+
+  void RecordBlob(
+      const BlobProto& proto,
+      std::unordered_map<string, BlobState>* blob_states_ptr,
+      const string& key,
+      int* loaded_blobs) {
+    auto& blob_states = *blob_states_ptr;
     if (proto.has_content_num_chunks()) {
       if (!blob_states.count(key)) {
         blob_states[key] = BlobState(proto.content_num_chunks());
@@ -399,6 +576,7 @@ class LoadOp final : public Operator<Context> {
   bool keep_device_;
   bool load_all_;
   bool allow_incomplete_;
+  int num_threads_;
   std::map<string, int> output_indices_;
   std::map<string, int> key_to_dbid_;
   std::vector<std::string> blob_names_;
@@ -41,6 +41,9 @@ bool PackSegmentsOp<CPUContext>::DoRunWithType2() {
       total_length,
       " is equal to the first data dimension ",
       data.dim(0));
+  if (max_length_ >= 0) {
+    max_length = static_cast<T>(max_length_);
+  }
 
   auto shape = data.dims(); // Shape of output is batch_size x max_len x ...
   shape[0] = max_length;
@@ -80,13 +83,15 @@ bool PackSegmentsOp<CPUContext>::DoRunWithType2() {
   const auto* d = static_cast<const char*>(data.raw_data());
   TIndex start = 0;
   for (TIndex i = 0; i < lengths.dim(0); ++i) {
+    // Sequences longer than max_length are truncated
+    const T length = std::min(l[i], max_length);
     context_.template CopyItems<CPUContext, CPUContext>(
         data.meta(),
-        l[i] * block_size,
+        length * block_size,
         d + block_bytesize * start,
         out + block_bytesize * max_length * i);
     if (return_presence_mask_) {
-      memset(presence_mask_data + max_length * i, (int)true, l[i]);
+      memset(presence_mask_data + max_length * i, (int)true, length);
     }
     start += l[i];
   }
@@ -132,11 +137,22 @@ bool UnpackSegmentsOp<CPUContext>::DoRunWithType2() {
   const auto* d = static_cast<const char*>(data.raw_data());
   TIndex start = 0;
   for (TIndex i = 0; i < lengths.dim(0); ++i) {
+    // The rows of sequences truncated by PackSegments' max_length are zeros
+    const TIndex length = std::min<TIndex>(l[i], data.dim(1));
     context_.template CopyItems<CPUContext, CPUContext>(
         data.meta(),
-        l[i] * block_size,
+        length * block_size,
         d + block_bytesize * data.dim(1) * i,
         out + block_bytesize * start);
+    if (l[i] > length) {
+      CAFFE_ENFORCE(
+          !data.meta().ctor(),
+          "Sequences longer than DATA can only be unpacked for fixed size types");
+      memset(
+          out + block_bytesize * (start + length),
+          0,
+          block_bytesize * (l[i] - length));
+    }
     start += l[i];
   }
   return true;
@@ -173,7 +189,12 @@ OPERATOR_SCHEMA(PackSegments)
     -infinity, otherwise pad zeros")
     .Arg(
         "return_presence_mask",
-        "bool whether to return presence mask, false by default");
+        "bool whether to return presence mask, false by default")
+    .Arg(
+        "max_length",
+        "The length to pack the sequences to, by default the length of the "
+        "longest sequence. Longer sequences are truncated. Setting it lets "
+        "the CUDA version run without copying the lengths to the host.");
 OPERATOR_SCHEMA(UnpackSegments)
     .NumInputs(2)
     .NumOutputs(1)
@@ -15,118 +15,131 @@ __global__ void PackSegmentsKernel(
     const int64_t num_seq,
     const int64_t cell_size,
     Data_T padding,
-    Data_T* out_ptr) {
+    Data_T* out_ptr,
+    bool* presence_mask_ptr) {
   CUDA_1D_KERNEL_LOOP(i, num_seq * max_length * cell_size) {
     int seq = (i / cell_size) / max_length;
     int cell = (i / cell_size) % max_length;
     int offset = i % cell_size;
-    if (cell >= lengths_ptr[seq]) {
+    bool present = cell < lengths_ptr[seq];
+    if (!present) {
       out_ptr[i] = padding;
     } else {
       int32_t idx = (lengths_cum_sum[seq] + cell) * cell_size + offset;
       out_ptr[i] = data_ptr[idx];
     }
+    if (presence_mask_ptr && offset == 0) {
+      presence_mask_ptr[i / cell_size] = present;
+    }
   }
 }
 
+// One thread per element of the output. The sequence of an output row is
+// found by a binary search of the ends of the sequences, the inclusive prefix
+// sum of the lengths. Rows past the packed length max_length are zeros.
 template <typename T, typename Data_T>
 __global__ void UnpackSegmentsKernel(
     const Data_T* data_ptr,
-    const T* lengths_ptr,
-    const T* lengths_cum_sum,
+    const T* lengths_inclusive_sum,
     const T max_length,
     const int64_t num_seq,
+    const int64_t num_cell,
     const int64_t cell_size,
     Data_T* out_ptr) {
-  CUDA_1D_KERNEL_LOOP(i, num_seq * max_length * cell_size) {
-    int seq = (i / cell_size) / max_length;
-    int cell = (i / cell_size) % max_length;
-    int offset = i % cell_size;
-    if (cell < lengths_ptr[seq]) {
-      int idx = (lengths_cum_sum[seq] + cell) * cell_size + offset;
-      out_ptr[idx] = data_ptr[i];
+  CUDA_1D_KERNEL_LOOP(i, num_cell * cell_size) {
+    int64_t row = i / cell_size;
+    int64_t offset = i % cell_size;
+    // The first sequence that ends after row
+    int64_t lo = 0;
+    int64_t hi = num_seq - 1;
+    while (lo < hi) {
+      int64_t mid = (lo + hi) / 2;
+      if (lengths_inclusive_sum[mid] > row) {
+        hi = mid;
+      } else {
+        lo = mid + 1;
+      }
     }
+    int64_t cell = row - (lo == 0 ? 0 : lengths_inclusive_sum[lo - 1]);
+    out_ptr[i] = cell < max_length
+        ? data_ptr[(lo * max_length + cell) * cell_size + offset]
+        : Data_T(0);
   }
 }
 
 template <typename T>
-int64_t int_array_sum(
+T array_max(
     const T* dev_array,
     int64_t num_items,
-    Tensor<CUDAContext>& dev_buffer,
-    Tensor<CUDAContext>& dev_sum,
-    Tensor<CPUContext>& host_sum,
+    Tensor<CUDAContext>& dev_max_buffer,
+    Tensor<CUDAContext>& dev_max,
+    Tensor<CPUContext>& host_max,
     CUDAContext& context) {
   // Retrieve buffer size
   size_t temp_storage_bytes = 0;
-  cub::DeviceReduce::Sum(
+  cub::DeviceReduce::Max(
       nullptr,
       temp_storage_bytes,
       dev_array,
-      dev_sum.mutable_data<int64_t>(),
+      dev_max.mutable_data<T>(),
       num_items,
       context.cuda_stream());
 
   // Allocate temporary storage
   auto buffer_size = (temp_storage_bytes + sizeof(T)) / sizeof(T);
-  dev_buffer.Resize(buffer_size);
-  void* dev_temp_storage = static_cast<void*>(dev_buffer.mutable_data<T>());
+  dev_max_buffer.Resize(buffer_size);
+  void* dev_temp_storage = static_cast<void*>(dev_max_buffer.mutable_data<T>());
 
-  // Find sumimum
-  cub::DeviceReduce::Sum(
+  // Find maximum
+  cub::DeviceReduce::Max(
       dev_temp_storage,
       temp_storage_bytes,
       dev_array,
-      dev_sum.mutable_data<int64_t>(),
+      dev_max.mutable_data<T>(),
       num_items,
       context.cuda_stream());
 
   // Copy to host
-  host_sum.CopyFrom<CUDAContext>(dev_sum);
+  host_max.CopyFrom<CUDAContext>(dev_max);
   context.FinishDeviceComputation();
-  return *host_sum.data<int64_t>();
+  return *host_max.data<T>();
 }
 
 template <typename T>
-T array_max(
+void array_prefix_sum_exclusive(
     const T* dev_array,
-    int64_t num_items,
-    Tensor<CUDAContext>& dev_max_buffer,
-    Tensor<CUDAContext>& dev_max,
-    Tensor<CPUContext>& host_max,
+    const int32_t num_items,
+    Tensor<CUDAContext>& prefix_buffer,
+    Tensor<CUDAContext>& prefix_sum,
     CUDAContext& context) {
   // Retrieve buffer size
   size_t temp_storage_bytes = 0;
-  cub::DeviceReduce::Max(
+  prefix_sum.Resize(num_items);
+  cub::DeviceScan::ExclusiveSum(
       nullptr,
       temp_storage_bytes,
       dev_array,
-      dev_max.mutable_data<T>(),
+      prefix_sum.mutable_data<T>(),
       num_items,
       context.cuda_stream());
 
   // Allocate temporary storage
   auto buffer_size = (temp_storage_bytes + sizeof(T)) / sizeof(T);
-  dev_max_buffer.Resize(buffer_size);
-  void* dev_temp_storage = static_cast<void*>(dev_max_buffer.mutable_data<T>());
+  prefix_buffer.Resize(buffer_size);
+  void* dev_temp_storage = static_cast<void*>(prefix_buffer.mutable_data<T>());
 
-  // Find maximum
-  cub::DeviceReduce::Max(
+  // Exclusive sum
+  cub::DeviceScan::ExclusiveSum(
       dev_temp_storage,
       temp_storage_bytes,
       dev_array,
-      dev_max.mutable_data<T>(),
+      prefix_sum.mutable_data<T>(),
       num_items,
       context.cuda_stream());
-
-  // Copy to host
-  host_max.CopyFrom<CUDAContext>(dev_max);
-  context.FinishDeviceComputation();
-  return *host_max.data<T>();
 }
 
 template <typename T>
-void array_prefix_sum_exclusive(
+void array_prefix_sum_inclusive(
     const T* dev_array,
     const int32_t num_items,
     Tensor<CUDAContext>& prefix_buffer,
@@ -135,7 +148,7 @@ void array_prefix_sum_exclusive(
   // Retrieve buffer size
   size_t temp_storage_bytes = 0;
   prefix_sum.Resize(num_items);
-  cub::DeviceScan::ExclusiveSum(
+  cub::DeviceScan::InclusiveSum(
       nullptr,
       temp_storage_bytes,
       dev_array,
@@ -148,8 +161,8 @@ void array_prefix_sum_exclusive(
   prefix_buffer.Resize(buffer_size);
   void* dev_temp_storage = static_cast<void*>(prefix_buffer.mutable_data<T>());
 
-  // Exclusive sum
-  cub::DeviceScan::ExclusiveSum(
+  // Inclusive sum
+  cub::DeviceScan::InclusiveSum(
       dev_temp_storage,
       temp_storage_bytes,
       dev_array,
@@ -177,22 +190,26 @@ bool PackSegmentsOp<CUDAContext>::DoRunWithType2() {
   const T* lengths_ptr = lengths.data<T>();
   auto* out = Output(0);
 
-  if (return_presence_mask_) {
-    CAFFE_THROW("CUDA version of PackSegments does not support presence mask.");
-  }
   CAFFE_ENFORCE(data.ndim() >= 1, "DATA should be at least 1-D");
   CAFFE_ENFORCE(lengths.ndim() == 1, "LENGTH should be 1-D");
 
-  // Find the length of the longest sequence.
-  dev_max_length_.Resize(1);
-  host_max_length_.Resize(1);
-  const T max_length = array_max<T>(
-      lengths_ptr,
-      num_seq,
-      dev_buffer_,
-      dev_max_length_,
-      host_max_length_,
-      context_);
+  T max_length;
+  if (max_length_ >= 0) {
+    // Sequences longer than max_length are truncated by the kernel
+    max_length = static_cast<T>(max_length_);
+  } else {
+    // Find the length of the longest sequence, which has to wait for the
+    // lengths to reach the host
+    dev_max_length_.Resize(1);
+    host_max_length_.Resize(1);
+    max_length = array_max<T>(
+        lengths_ptr,
+        num_seq,
+        dev_buffer_,
+        dev_max_length_,
+        host_max_length_,
+        context_);
+  }
 
   // Compute prefix sum over the lengths
   array_prefix_sum_exclusive<T>(
@@ -205,8 +222,24 @@ bool PackSegmentsOp<CUDAContext>::DoRunWithType2() {
   out->Resize(shape);
   Data_T* out_ptr = static_cast<Data_T*>(out->raw_mutable_data(data.meta()));
 
-  // Return empty out (with the proper shape) if first dim is 0.
-  if (!data.dim(0)) {
+  bool* presence_mask_ptr = nullptr;
+  if (return_presence_mask_) {
+    // Shape of presence is batch_size x max_len
+    auto* presence_mask = Output(1);
+    presence_mask->Resize(num_seq, max_length);
+    presence_mask_ptr = presence_mask->template mutable_data<bool>();
+  }
+
+  // Return empty out (with the proper shape) if first dim is 0, or if
+  // max_length is.
+  if (!data.dim(0) || !max_length) {
+    if (presence_mask_ptr) {
+      CUDA_ENFORCE(cudaMemsetAsync(
+          presence_mask_ptr,
+          0,
+          num_seq * max_length * sizeof(bool),
+          context_.cuda_stream()));
+    }
     return true;
   }
 
@@ -225,7 +258,8 @@ bool PackSegmentsOp<CUDAContext>::DoRunWithType2() {
       num_seq,
       cell_size,
       padding,
-      out_ptr);
+      out_ptr,
+      presence_mask_ptr);
   return true;
 }
 
@@ -245,34 +279,20 @@ bool UnpackSegmentsOp<CUDAContext>::DoRunWithType2() {
   const T* lengths_ptr = lengths.data<T>();
   auto* out = Output(0);
 
-  CAFFE_ENFORCE(data.ndim() >= 1, "DATA should be at least 1-D");
+  CAFFE_ENFORCE(data.ndim() >= 2, "DATA should be at least 2-D");
   CAFFE_ENFORCE(lengths.ndim() == 1, "LENGTH should be 1-D");
 
-  // Compute prefix sum over the lengths
-  array_prefix_sum_exclusive<T>(
+  // The ends of the sequences, the last of which is the number of cells: the
+  // only value that needs to be copied to the host. The packed length is the
+  // second dimension of DATA.
+  array_prefix_sum_inclusive<T>(
       lengths_ptr, num_seq, dev_buffer_, dev_lengths_prefix_sum_, context_);
-
-  // compute max of the lengths
-  dev_max_length_.Resize(1);
-  host_max_length_.Resize(1);
-  const T max_length = array_max<T>(
-      lengths_ptr,
-      num_seq,
-      dev_buffer_,
-      dev_max_length_,
-      host_max_length_,
-      context_);
-
-  // compute num of cells: sum of the lengths
-  dev_num_cell_.Resize(1);
-  host_num_cell_.Resize(1);
-  const int64_t num_cell = int_array_sum<T>(
-      lengths_ptr,
-      num_seq,
-      dev_buffer_,
-      dev_num_cell_,
-      host_num_cell_,
-      context_);
+  T num_cell = 0;
+  if (num_seq > 0) {
+    context_.Copy<T, CUDAContext, CPUContext>(
+        1, dev_lengths_prefix_sum_.data<T>() + num_seq - 1, &num_cell);
+    context_.FinishDeviceComputation();
+  }
 
   // create output tensor
   auto shape = data.dims();
@@ -283,23 +303,21 @@ bool UnpackSegmentsOp<CUDAContext>::DoRunWithType2() {
   out->Resize(shape);
   Data_T* out_ptr = static_cast<Data_T*>(out->raw_mutable_data(data.meta()));
 
-  // Return empty out (with the proper shape) if any of the dimensions is 0.
-  if (!(data.dim(0) * data.dim(1))) {
+  // Unpack
+  int64_t cell_size = data.size_from_dim(2);
+  if (!(num_cell * cell_size)) {
     return true;
   }
-
-  // Unpack
-  int64_t cell_size = data.size() / (data.dim(0) * data.dim(1));
   UnpackSegmentsKernel<<<
-      CAFFE_GET_BLOCKS(num_seq * max_length * cell_size),
+      CAFFE_GET_BLOCKS(num_cell * cell_size),
       CAFFE_CUDA_NUM_THREADS,
       0,
       context_.cuda_stream()>>>(
       data_ptr,
-      lengths_ptr,
       dev_lengths_prefix_sum_.data<T>(),
-      max_length,
+      static_cast<T>(data.dim(1)),
       num_seq,
+      num_cell,
       cell_size,
       out_ptr);
   return true;
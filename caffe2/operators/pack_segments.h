@@ -24,7 +24,8 @@ class PackSegmentsOp final : public Operator<Context> {
         pad_minf_(OperatorBase::GetSingleArgument<bool>("pad_minf", false)),
         return_presence_mask_(OperatorBase::GetSingleArgument<bool>(
             "return_presence_mask",
-            false)) {
+            false)),
+        max_length_(OperatorBase::GetSingleArgument<int64_t>("max_length", -1)) {
     if (pad_minf_) {
       padding_ = -1.0 * std::numeric_limits<float>::infinity();
     } else {
@@ -48,6 +49,8 @@ class PackSegmentsOp final : public Operator<Context> {
   bool pad_minf_;
   float padding_;
   bool return_presence_mask_;
+  // Length of the packed sequences, if given, instead of the longest length
+  int64_t max_length_;
 
   // Scratch space required by the CUDA version
   Tensor<Context> dev_buffer_;
@@ -76,12 +79,9 @@ class UnpackSegmentsOp final : public Operator<Context> {
   INPUT_TAGS(LENGTHS, DATA);
 
  private:
+  // Scratch space required by the CUDA version
   Tensor<Context> dev_buffer_;
   Tensor<Context> dev_lengths_prefix_sum_;
-  Tensor<Context> dev_max_length_;
-  Tensor<Context> dev_num_cell_;
-  Tensor<CPUContext> host_max_length_;
-  Tensor<CPUContext> host_num_cell_;
 };
 
 } // namespace caffe2
@@ -0,0 +1,91 @@
+#include "caffe2/operators/quantized/int8_add_op.h"
+
+namespace caffe2 {
+
+namespace {
+
+// Both inputs are shifted left by kInputLeftShift bits before their
+// rescaling to a common scale, which keeps the precision of the sum
+constexpr int kInputLeftShift = 20;
+
+} // namespace
+
+template <bool ReluFused>
+bool Int8AddOp<ReluFused>::RunOnDevice() {
+  const auto& A = Inputs()[0]->Get<int8::Int8TensorCPU>();
+  const auto& B = Inputs()[1]->Get<int8::Int8TensorCPU>();
+  CAFFE_ENFORCE_EQ(A.t.dims(), B.t.dims(), "Int8Add does not broadcast");
+
+  // The sum of A_scale (a - A_zero_point) and B_scale (b - B_zero_point) in
+  // units of 2 max(A_scale, B_scale) / 2^kInputLeftShift, which makes all
+  // the multipliers smaller than one
+  const double twice_max_scale = 2.0 * std::max(A.scale, B.scale);
+  int32_t A_multiplier, B_multiplier;
+  int A_shift, B_shift;
+  int8::QuantizeMultiplierSmallerThanOne(
+      A.scale / twice_max_scale, &A_multiplier, &A_shift);
+  int8::QuantizeMultiplierSmallerThanOne(
+      B.scale / twice_max_scale, &B_multiplier, &B_shift);
+  const auto params = int8::GetRequantizationParams(
+      twice_max_scale / ((1 << kInputLeftShift) * double(Y_scale_)),
+      Y_zero_point_,
+      ReluFused);
+  const int32_t A_zero_point = A.zero_point;
+  const int32_t B_zero_point = B.zero_point;
+
+  // Y may be A or B
+  auto* Y = Outputs()[0]->GetMutable<int8::Int8TensorCPU>();
+  Y->t.ResizeLike(A.t);
+  Y->scale = Y_scale_;
+  Y->zero_point = Y_zero_point_;
+  const uint8_t* A_data = A.t.data<uint8_t>();
+  const uint8_t* B_data = B.t.data<uint8_t>();
+  uint8_t* Y_data = Y->t.mutable_data<uint8_t>();
+  for (int i = 0; i < Y->t.size(); i++) {
+    const int32_t a = int8::MultiplyByQuantizedMultiplierSmallerThanOne(
+        (A_data[i] - A_zero_point) * (1 << kInputLeftShift),
+        A_multiplier,
+        A_shift);
+    const int32_t b = int8::MultiplyByQuantizedMultiplierSmallerThanOne(
+        (B_data[i] - B_zero_point) * (1 << kInputLeftShift),
+        B_multiplier,
+        B_shift);
+    Y_data[i] = int8::Requantize(a + b, params);
+  }
+  return true;
+}
+
+REGISTER_CPU_OPERATOR(Int8Add, Int8AddOp<false>);
+REGISTER_CPU_OPERATOR(Int8AddRelu, Int8AddOp<true>);
+
+OPERATOR_SCHEMA(Int8Add)
+    .NumInputs(2)
+    .NumOutputs(1)
+    .AllowInplace({{0, 0}, {1, 0}})
+    .SetDoc(R"DOC(
+Elementwise sum of the Int8TensorCPU A and B of the same shape, computed in
+fixed-point arithmetic and quantized with Y_scale and Y_zero_point.
+)DOC")
+    .Arg("Y_scale", "Scale of the output.")
+    .Arg("Y_zero_point", "Zero point of the output.")
+    .Input(0, "A", "Int8TensorCPU of uint8 values.")
+    .Input(1, "B", "Int8TensorCPU of uint8 values, of the shape of A.")
+    .Output(0, "Y", "Int8TensorCPU of the shape of A.");
+
+OPERATOR_SCHEMA(Int8AddRelu)
+    .NumInputs(2)
+    .NumOutputs(1)
+    .AllowInplace({{0, 0}, {1, 0}})
+    .SetDoc(R"DOC(
+Int8Add followed by a Relu, fused into the clamping of the output.
+)DOC")
+    .Arg("Y_scale", "Scale of the output.")
+    .Arg("Y_zero_point", "Zero point of the output.")
+    .Input(0, "A", "Int8TensorCPU of uint8 values.")
+    .Input(1, "B", "Int8TensorCPU of uint8 values, of the shape of A.")
+    .Output(0, "Y", "Int8TensorCPU of the shape of A.");
+
+NO_GRADIENT(Int8Add);
+NO_GRADIENT(Int8AddRelu);
+
+} // namespace caffe2
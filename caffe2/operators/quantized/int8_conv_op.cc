@@ -0,0 +1,332 @@
+#include "caffe2/operators/quantized/int8_conv_op.h"
+
+#include <cstring>
+
+namespace caffe2 {
+
+namespace {
+
+// Copies the patches of channels [c_begin, c_begin + Cg) of the NHWC image X
+// to the rows of col, one row per output pixel, with the padding filled with
+// the zero point of X
+void Im2colNHWC(
+    const uint8_t* X,
+    int H,
+    int W,
+    int C,
+    int c_begin,
+    int Cg,
+    int kernel_h,
+    int kernel_w,
+    int dilation_h,
+    int dilation_w,
+    int pad_t,
+    int pad_l,
+    int stride_h,
+    int stride_w,
+    int OH,
+    int OW,
+    uint8_t zero_point,
+    uint8_t* col) {
+  for (int oh = 0; oh < OH; oh++) {
+    for (int ow = 0; ow < OW; ow++) {
+      for (int kh = 0; kh < kernel_h; kh++) {
+        const int ih = oh * stride_h - pad_t + kh * dilation_h;
+        for (int kw = 0; kw < kernel_w; kw++) {
+          const int iw = ow * stride_w - pad_l + kw * dilation_w;
+          if (ih >= 0 && ih < H && iw >= 0 && iw < W) {
+            memcpy(col, X + (ih * W + iw) * C + c_begin, Cg);
+          } else {
+            memset(col, zero_point, Cg);
+          }
+          col += Cg;
+        }
+      }
+    }
+  }
+}
+
+// Computes the output row oh of the depthwise convolution of the NHWC image
+// X by the filters w = W - W_zero_point, in [kernel_h, kernel_w, C] order
+void DepthwiseConvRow(
+    const uint8_t* X,
+    int H,
+    int W,
+    int C,
+    int kernel_h,
+    int kernel_w,
+    int dilation_h,
+    int dilation_w,
+    int pad_t,
+    int pad_l,
+    int stride_h,
+    int stride_w,
+    int oh,
+    int OW,
+    int32_t X_zero_point,
+    const int16_t* w,
+    const int32_t* bias,
+    const int8::RequantizationParams& params,
+    uint8_t* Y) {
+  for (int ow = 0; ow < OW; ow++) {
+    uint8_t* y = Y + ow * C;
+    int c = 0;
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+    const uint8x8_t vX_zero_point = vdup_n_u8(X_zero_point);
+    for (; c + 8 <= C; c += 8) {
+      int32x4_t acc_lo = vld1q_s32(bias + c);
+      int32x4_t acc_hi = vld1q_s32(bias + c + 4);
+      for (int kh = 0; kh < kernel_h; kh++) {
+        const int ih = oh * stride_h - pad_t + kh * dilation_h;
+        if (ih < 0 || ih >= H) {
+          continue;
+        }
+        for (int kw = 0; kw < kernel_w; kw++) {
+          const int iw = ow * stride_w - pad_l + kw * dilation_w;
+          if (iw < 0 || iw >= W) {
+            continue;
+          }
+          const int16x8_t vx = vreinterpretq_s16_u16(
+              vsubl_u8(vld1_u8(X + (ih * W + iw) * C + c), vX_zero_point));
+          const int16x8_t vw = vld1q_s16(w + (kh * kernel_w + kw) * C + c);
+          acc_lo = vmlal_s16(acc_lo, vget_low_s16(vx), vget_low_s16(vw));
+          acc_hi = vmlal_s16(acc_hi, vget_high_s16(vx), vget_high_s16(vw));
+        }
+      }
+      vst1_u8(y + c, int8::RequantizeNeon(acc_lo, acc_hi, params));
+    }
+#endif // defined(__ARM_NEON__) || defined(__ARM_NEON)
+    for (; c < C; c++) {
+      int32_t acc = bias[c];
+      for (int kh = 0; kh < kernel_h; kh++) {
+        const int ih = oh * stride_h - pad_t + kh * dilation_h;
+        if (ih < 0 || ih >= H) {
+          continue;
+        }
+        for (int kw = 0; kw < kernel_w; kw++) {
+          const int iw = ow * stride_w - pad_l + kw * dilation_w;
+          if (iw < 0 || iw >= W) {
+            continue;
+          }
+          acc += (X[(ih * W + iw) * C + c] - X_zero_point) *
+              w[(kh * kernel_w + kw) * C + c];
+        }
+      }
+      y[c] = int8::Requantize(acc, params);
+    }
+  }
+}
+
+} // namespace
+
+template <bool ReluFused>
+void Int8ConvOp<ReluFused>::PackFilters(
+    const int8::Int8TensorCPU& filter,
+    const int32_t* bias,
+    bool depthwise) {
+  const int M = filter.t.dim32(0);
+  const int K = filter.t.size_from_dim(1);
+  const uint8_t* filter_data = filter.t.data<uint8_t>();
+  packed_W_.clear();
+  depthwise_W_.clear();
+  depthwise_bias_.clear();
+  if (depthwise) {
+    depthwise_W_.resize(K * M);
+    for (int m = 0; m < M; m++) {
+      for (int k = 0; k < K; k++) {
+        depthwise_W_[k * M + m] = filter_data[m * K + k] - filter.zero_point;
+      }
+    }
+    depthwise_bias_.assign(M, 0);
+    if (bias) {
+      std::copy(bias, bias + M, depthwise_bias_.begin());
+    }
+  } else {
+    const int Mg = M / group_;
+    for (int g = 0; g < group_; g++) {
+      packed_W_.emplace_back(
+          Mg,
+          K,
+          filter_data + g * Mg * K,
+          filter.zero_point,
+          bias ? bias + g * Mg : nullptr);
+    }
+  }
+}
+
+template <bool ReluFused>
+bool Int8ConvOp<ReluFused>::RunOnDeviceWithOrderNHWC() {
+  const auto& X = Inputs()[0]->Get<int8::Int8TensorCPU>();
+  const auto& filter = Inputs()[1]->Get<int8::Int8TensorCPU>();
+  auto* Y = Outputs()[0]->GetMutable<int8::Int8TensorCPU>();
+  CAFFE_ENFORCE_EQ(X.t.ndim(), 4);
+  CAFFE_ENFORCE_EQ(filter.t.ndim(), 4);
+  const int N = X.t.dim32(0);
+  const int H = X.t.dim32(1);
+  const int W = X.t.dim32(2);
+  const int C = X.t.dim32(3);
+  const int M = filter.t.dim32(0);
+  CAFFE_ENFORCE_EQ(
+      C % group_, 0, "The number of input channels is not divisible by group");
+  CAFFE_ENFORCE_EQ(
+      M % group_, 0, "The number of output channels is not divisible by group");
+  CAFFE_ENFORCE_EQ(filter.t.dim32(1), kernel_h());
+  CAFFE_ENFORCE_EQ(filter.t.dim32(2), kernel_w());
+  CAFFE_ENFORCE_EQ(filter.t.dim32(3), C / group_);
+  const int32_t* bias = nullptr;
+  if (InputSize() == 3) {
+    const auto& B = Inputs()[2]->Get<int8::Int8TensorCPU>();
+    CAFFE_ENFORCE_EQ(B.t.size(), M, "Wrong size of bias");
+    CAFFE_ENFORCE_EQ(B.zero_point, 0, "Bias must have a zero point 0");
+    CAFFE_ENFORCE_LE(
+        std::abs(B.scale - X.scale * filter.scale),
+        1e-3 * X.scale * filter.scale,
+        "Bias must be quantized with the scale X_scale * W_scale");
+    bias = B.t.data<int32_t>();
+  }
+
+  const bool depthwise = group_ > 1 && group_ == C && group_ == M;
+  if (packed_W_data_ != filter.t.raw_data() || packed_B_data_ != bias) {
+    PackFilters(filter, bias, depthwise);
+    packed_W_data_ = filter.t.raw_data();
+    packed_B_data_ = bias;
+  }
+  const auto params = int8::GetRequantizationParams(
+      double(X.scale) * filter.scale / Y_scale_, Y_zero_point_, ReluFused);
+  const int32_t X_zero_point = X.zero_point;
+
+  ConvPoolOpBase<CPUContext>::SetOutputSize(X.t, &(Y->t), M);
+  Y->scale = Y_scale_;
+  Y->zero_point = Y_zero_point_;
+  const int OH = Y->t.dim32(1);
+  const int OW = Y->t.dim32(2);
+  const uint8_t* X_data = X.t.data<uint8_t>();
+  uint8_t* Y_data = Y->t.mutable_data<uint8_t>();
+  ThreadPool* pool = ws_->GetThreadPool();
+
+  if (depthwise) {
+    pool->run(
+        [&](int, size_t n_oh) {
+          const int n = n_oh / OH;
+          const int oh = n_oh % OH;
+          DepthwiseConvRow(
+              X_data + n * H * W * C,
+              H,
+              W,
+              C,
+              kernel_h(),
+              kernel_w(),
+              dilation_h(),
+              dilation_w(),
+              pad_t(),
+              pad_l(),
+              stride_h(),
+              stride_w(),
+              oh,
+              OW,
+              X_zero_point,
+              depthwise_W_.data(),
+              depthwise_bias_.data(),
+              params,
+              Y_data + (n * OH + oh) * OW * M);
+        },
+        N * OH);
+    return true;
+  }
+
+  if (group_ == 1 && kernel_h() == 1 && kernel_w() == 1 && stride_h() == 1 &&
+      stride_w() == 1 && pad_t() == 0 && pad_l() == 0 && pad_b() == 0 &&
+      pad_r() == 0) {
+    // The pixels of X are already the rows of the GEMM
+    int8::Int8Gemm(
+        N * H * W,
+        X_data,
+        C,
+        X_zero_point,
+        packed_W_[0],
+        params,
+        Y_data,
+        M,
+        pool);
+    return true;
+  }
+
+  const int Cg = C / group_;
+  const int Mg = M / group_;
+  const int K = kernel_h() * kernel_w() * Cg;
+  col_buffer_.Resize(OH * OW, K);
+  uint8_t* col_data = col_buffer_.mutable_data<uint8_t>();
+  for (int n = 0; n < N; n++) {
+    for (int g = 0; g < group_; g++) {
+      Im2colNHWC(
+          X_data + n * H * W * C,
+          H,
+          W,
+          C,
+          g * Cg,
+          Cg,
+          kernel_h(),
+          kernel_w(),
+          dilation_h(),
+          dilation_w(),
+          pad_t(),
+          pad_l(),
+          stride_h(),
+          stride_w(),
+          OH,
+          OW,
+          static_cast<uint8_t>(X_zero_point),
+          col_data);
+      int8::Int8Gemm(
+          OH * OW,
+          col_data,
+          K,
+          X_zero_point,
+          packed_W_[g],
+          params,
+          Y_data + n * OH * OW * M + g * Mg,
+          M,
+          pool);
+    }
+  }
+  return true;
+}
+
+REGISTER_CPU_OPERATOR(Int8Conv, Int8ConvOp<false>);
+REGISTER_CPU_OPERATOR(Int8ConvRelu, Int8ConvOp<true>);
+
+OPERATOR_SCHEMA(Int8Conv)
+    .NumInputs(2, 3)
+    .NumOutputs(1)
+    .SetDoc(R"DOC(
+The quantized convolution of the NHWC Int8TensorCPU X of uint8 values by the
+Int8TensorCPU filters W of uint8 values of shape [M, kernel_h, kernel_w,
+C / group], with the arguments of Conv and order NHWC. The optional bias B is
+an Int8TensorCPU of int32 values quantized with the scale X_scale * W_scale
+and a zero point 0. Y is quantized with Y_scale and Y_zero_point, which
+requires X_scale * W_scale < Y_scale.
+)DOC")
+    .Arg("Y_scale", "Scale of the output.")
+    .Arg("Y_zero_point", "Zero point of the output.")
+    .Input(0, "X", "NHWC Int8TensorCPU of uint8 values.")
+    .Input(1, "W", "Int8TensorCPU of uint8 values.")
+    .Input(2, "B", "Optional Int8TensorCPU of int32 values of size M.")
+    .Output(0, "Y", "NHWC Int8TensorCPU of uint8 values.");
+
+OPERATOR_SCHEMA(Int8ConvRelu)
+    .NumInputs(2, 3)
+    .NumOutputs(1)
+    .SetDoc(R"DOC(
+Int8Conv followed by a Relu, fused into the clamping of the output.
+)DOC")
+    .Arg("Y_scale", "Scale of the output.")
+    .Arg("Y_zero_point", "Zero point of the output.")
+    .Input(0, "X", "NHWC Int8TensorCPU of uint8 values.")
+    .Input(1, "W", "Int8TensorCPU of uint8 values.")
+    .Input(2, "B", "Optional Int8TensorCPU of int32 values of size M.")
+    .Output(0, "Y", "NHWC Int8TensorCPU of uint8 values.");
+
+NO_GRADIENT(Int8Conv);
+NO_GRADIENT(Int8ConvRelu);
+
+} // namespace caffe2
@@ -0,0 +1,57 @@
+#ifndef CAFFE2_OPERATORS_INT8_CONV_OP_H_
+#define CAFFE2_OPERATORS_INT8_CONV_OP_H_
+
+#include <vector>
+
+#include "caffe2/core/context.h"
+#include "caffe2/core/operator.h"
+#include "caffe2/core/tensor_int8.h"
+#include "caffe2/operators/conv_pool_op_base.h"
+#include "caffe2/operators/quantized/int8_gemm.h"
+
+namespace caffe2 {
+
+// The quantized NHWC convolution of X by the filters W of shape
+// [M, kernel_h, kernel_w, C / group], as im2col and Int8Gemm per group, or
+// with a direct kernel for depthwise convolutions
+template <bool ReluFused>
+class Int8ConvOp final : public ConvPoolOpBase<CPUContext> {
+ public:
+  USE_CONV_POOL_BASE_FUNCTIONS(CPUContext);
+  Int8ConvOp(const OperatorDef& operator_def, Workspace* ws)
+      : ConvPoolOpBase<CPUContext>(operator_def, ws),
+        Y_scale_(OperatorBase::GetSingleArgument<float>("Y_scale", 1.0)),
+        Y_zero_point_(
+            OperatorBase::GetSingleArgument<int>("Y_zero_point", 0)) {
+    OPERATOR_NEEDS_FEATURE(
+        order_ == StorageOrder::NHWC, "Int8Conv only supports NHWC order");
+    CAFFE_ENFORCE_EQ(
+        kernel_.size(), 2, "Int8Conv only supports 2D convolution");
+    CAFFE_ENFORCE_GT(Y_scale_, 0);
+    CAFFE_ENFORCE(Y_zero_point_ >= 0 && Y_zero_point_ <= 255);
+  }
+
+  bool RunOnDeviceWithOrderNHWC() override;
+
+ private:
+  void PackFilters(
+      const int8::Int8TensorCPU& W,
+      const int32_t* bias,
+      bool depthwise);
+
+  float Y_scale_;
+  int32_t Y_zero_point_;
+  // Filters packed on the first run for Int8Gemm, one matrix per group, or
+  // as W - W_zero_point in [kernel_h, kernel_w, C] order for the depthwise
+  // kernel, and the data they come from
+  std::vector<int8::PackedGemmMatrixB> packed_W_;
+  std::vector<int16_t> depthwise_W_;
+  std::vector<int32_t> depthwise_bias_;
+  const void* packed_W_data_{nullptr};
+  const void* packed_B_data_{nullptr};
+  TensorCPU col_buffer_;
+};
+
+} // namespace caffe2
+
+#endif // CAFFE2_OPERATORS_INT8_CONV_OP_H_
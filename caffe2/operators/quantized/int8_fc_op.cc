@@ -0,0 +1,69 @@
+#include "caffe2/operators/quantized/int8_fc_op.h"
+
+namespace caffe2 {
+
+bool Int8FCOp::RunOnDevice() {
+  const auto& X = Inputs()[0]->Get<int8::Int8TensorCPU>();
+  const auto& W = Inputs()[1]->Get<int8::Int8TensorCPU>();
+  const auto& B = Inputs()[2]->Get<int8::Int8TensorCPU>();
+  CAFFE_ENFORCE_GE(X.t.ndim(), 1);
+  CAFFE_ENFORCE_EQ(W.t.ndim(), 2);
+  const int M = X.t.size_to_dim(1);
+  const int K = X.t.size_from_dim(1);
+  const int N = W.t.dim32(0);
+  CAFFE_ENFORCE_EQ(K, W.t.dim32(1), "Wrong shape of W");
+  CAFFE_ENFORCE_EQ(N, B.t.size(), "Wrong size of B");
+  CAFFE_ENFORCE_EQ(B.zero_point, 0, "B must be quantized with a zero point 0");
+  CAFFE_ENFORCE_LE(
+      std::abs(B.scale - X.scale * W.scale),
+      1e-3 * X.scale * W.scale,
+      "B must be quantized with the scale X_scale * W_scale");
+
+  if (packed_W_data_ != W.t.raw_data() || packed_B_data_ != B.t.raw_data()) {
+    packed_W_ = int8::PackedGemmMatrixB(
+        N, K, W.t.data<uint8_t>(), W.zero_point, B.t.data<int32_t>());
+    packed_W_data_ = W.t.raw_data();
+    packed_B_data_ = B.t.raw_data();
+  }
+  const auto params = int8::GetRequantizationParams(
+      double(X.scale) * W.scale / Y_scale_, Y_zero_point_, false);
+
+  auto* Y = Outputs()[0]->GetMutable<int8::Int8TensorCPU>();
+  Y->t.Resize(M, N);
+  Y->scale = Y_scale_;
+  Y->zero_point = Y_zero_point_;
+  int8::Int8Gemm(
+      M,
+      X.t.data<uint8_t>(),
+      K,
+      X.zero_point,
+      packed_W_,
+      params,
+      Y->t.mutable_data<uint8_t>(),
+      N,
+      ws_->GetThreadPool());
+  return true;
+}
+
+REGISTER_CPU_OPERATOR(Int8FC, Int8FCOp);
+
+OPERATOR_SCHEMA(Int8FC)
+    .NumInputs(3)
+    .NumOutputs(1)
+    .SetDoc(R"DOC(
+The quantized fully connected layer Y = X W^T + B, where X of uint8 values is
+flattened to 2D at its first axis, W of uint8 values has shape [N, K] and B is
+an Int8TensorCPU of int32 values quantized with the scale
+X_scale * W_scale and a zero point 0. Y is quantized with Y_scale and
+Y_zero_point.
+)DOC")
+    .Arg("Y_scale", "Scale of the output.")
+    .Arg("Y_zero_point", "Zero point of the output.")
+    .Input(0, "X", "Int8TensorCPU of uint8 values.")
+    .Input(1, "W", "Int8TensorCPU of uint8 values of shape [N, K].")
+    .Input(2, "B", "Int8TensorCPU of int32 values of size N.")
+    .Output(0, "Y", "Int8TensorCPU of uint8 values of shape [M, N].");
+
+NO_GRADIENT(Int8FC);
+
+} // namespace caffe2
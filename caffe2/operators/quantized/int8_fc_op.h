@@ -0,0 +1,37 @@
+#ifndef CAFFE2_OPERATORS_INT8_FC_OP_H_
+#define CAFFE2_OPERATORS_INT8_FC_OP_H_
+
+#include "caffe2/core/context.h"
+#include "caffe2/core/operator.h"
+#include "caffe2/core/tensor_int8.h"
+#include "caffe2/operators/quantized/int8_gemm.h"
+
+namespace caffe2 {
+
+class Int8FCOp final : public Operator<CPUContext> {
+ public:
+  USE_OPERATOR_FUNCTIONS(CPUContext);
+  Int8FCOp(const OperatorDef& operator_def, Workspace* ws)
+      : Operator<CPUContext>(operator_def, ws),
+        Y_scale_(OperatorBase::GetSingleArgument<float>("Y_scale", 1.0)),
+        Y_zero_point_(OperatorBase::GetSingleArgument<int>("Y_zero_point", 0)),
+        ws_(ws) {
+    CAFFE_ENFORCE_GT(Y_scale_, 0);
+    CAFFE_ENFORCE(Y_zero_point_ >= 0 && Y_zero_point_ <= 255);
+  }
+
+  bool RunOnDevice() override;
+
+ private:
+  float Y_scale_;
+  int32_t Y_zero_point_;
+  Workspace* ws_;
+  // W and B packed for Int8Gemm on the first run, and the data they come from
+  int8::PackedGemmMatrixB packed_W_;
+  const void* packed_W_data_{nullptr};
+  const void* packed_B_data_{nullptr};
+};
+
+} // namespace caffe2
+
+#endif // CAFFE2_OPERATORS_INT8_FC_OP_H_
@@ -0,0 +1,184 @@
+#include "caffe2/operators/quantized/int8_gemm.h"
+
+#include <cstring>
+
+namespace caffe2 {
+namespace int8 {
+
+PackedGemmMatrixB::PackedGemmMatrixB(
+    int n,
+    int k,
+    const uint8_t* B,
+    int32_t zero_point,
+    const int32_t* bias)
+    : n_(n), k_(k), zero_point_(zero_point) {
+  CAFFE_ENFORCE(zero_point >= 0 && zero_point <= 255);
+  const int n_panels = (n + kGemmNR - 1) / kGemmNR;
+  data_.assign(n_panels * k * kGemmNR, static_cast<uint8_t>(zero_point));
+  bias_.assign(n_panels * kGemmNR, 0);
+  for (int i = 0; i < n; i++) {
+    uint8_t* panel = data_.data() + (i / kGemmNR) * k * kGemmNR + i % kGemmNR;
+    for (int kk = 0; kk < k; kk++) {
+      panel[kk * kGemmNR] = B[i * k + kk];
+    }
+    if (bias) {
+      bias_[i] = bias[i];
+    }
+  }
+}
+
+namespace {
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+
+// Accumulates step j of 8 along k into the 4 x 8 tile acc, where va holds
+// the 8 values of A of each row for these steps
+template <int j>
+inline void GemmStepNeon(
+    const uint8_t* b,
+    uint8x8_t vb_zero_point,
+    const int16x8_t* va,
+    int32x4_t* acc) {
+  const int16x8_t vb = vreinterpretq_s16_u16(
+      vsubl_u8(vld1_u8(b + j * kGemmNR), vb_zero_point));
+  for (int r = 0; r < kGemmMR; r++) {
+    const int16x4_t va_half =
+        j < 4 ? vget_low_s16(va[r]) : vget_high_s16(va[r]);
+    acc[2 * r] =
+        vmlal_lane_s16(acc[2 * r], vget_low_s16(vb), va_half, j % 4);
+    acc[2 * r + 1] =
+        vmlal_lane_s16(acc[2 * r + 1], vget_high_s16(vb), va_half, j % 4);
+  }
+}
+
+#endif // defined(__ARM_NEON__) || defined(__ARM_NEON)
+
+// Computes an mr x nr tile of C with mr <= kGemmMR and nr <= kGemmNR, from
+// the panel b of packed B
+void GemmKernel(
+    int mr,
+    int nr,
+    int k,
+    const uint8_t* a,
+    int lda,
+    int32_t a_zero_point,
+    const uint8_t* b,
+    int32_t b_zero_point,
+    const int32_t* bias,
+    const RequantizationParams& params,
+    uint8_t* c,
+    int ldc) {
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+  // Missing rows read the last valid one, and are not stored
+  const uint8_t* a_rows[kGemmMR];
+  a_rows[0] = a;
+  for (int r = 1; r < kGemmMR; r++) {
+    a_rows[r] = r < mr ? a_rows[r - 1] + lda : a_rows[r - 1];
+  }
+  const uint8x8_t va_zero_point = vdup_n_u8(a_zero_point);
+  const uint8x8_t vb_zero_point = vdup_n_u8(b_zero_point);
+  int32x4_t acc[2 * kGemmMR];
+  for (int r = 0; r < kGemmMR; r++) {
+    acc[2 * r] = vld1q_s32(bias);
+    acc[2 * r + 1] = vld1q_s32(bias + 4);
+  }
+  int kk = 0;
+  for (; kk + 8 <= k; kk += 8) {
+    int16x8_t va[kGemmMR];
+    for (int r = 0; r < kGemmMR; r++) {
+      va[r] = vreinterpretq_s16_u16(
+          vsubl_u8(vld1_u8(a_rows[r] + kk), va_zero_point));
+    }
+    const uint8_t* bk = b + kk * kGemmNR;
+    GemmStepNeon<0>(bk, vb_zero_point, va, acc);
+    GemmStepNeon<1>(bk, vb_zero_point, va, acc);
+    GemmStepNeon<2>(bk, vb_zero_point, va, acc);
+    GemmStepNeon<3>(bk, vb_zero_point, va, acc);
+    GemmStepNeon<4>(bk, vb_zero_point, va, acc);
+    GemmStepNeon<5>(bk, vb_zero_point, va, acc);
+    GemmStepNeon<6>(bk, vb_zero_point, va, acc);
+    GemmStepNeon<7>(bk, vb_zero_point, va, acc);
+  }
+  for (; kk < k; kk++) {
+    const int16x8_t vb = vreinterpretq_s16_u16(
+        vsubl_u8(vld1_u8(b + kk * kGemmNR), vb_zero_point));
+    for (int r = 0; r < kGemmMR; r++) {
+      const int16_t va = static_cast<int16_t>(a_rows[r][kk] - a_zero_point);
+      acc[2 * r] = vmlal_n_s16(acc[2 * r], vget_low_s16(vb), va);
+      acc[2 * r + 1] = vmlal_n_s16(acc[2 * r + 1], vget_high_s16(vb), va);
+    }
+  }
+  for (int r = 0; r < mr; r++) {
+    const uint8x8_t out = RequantizeNeon(acc[2 * r], acc[2 * r + 1], params);
+    if (nr == kGemmNR) {
+      vst1_u8(c + r * ldc, out);
+    } else {
+      uint8_t tmp[kGemmNR];
+      vst1_u8(tmp, out);
+      memcpy(c + r * ldc, tmp, nr);
+    }
+  }
+#else
+  for (int r = 0; r < mr; r++) {
+    int32_t acc[kGemmNR];
+    std::copy(bias, bias + kGemmNR, acc);
+    const uint8_t* a_row = a + r * lda;
+    for (int kk = 0; kk < k; kk++) {
+      const int32_t va = static_cast<int32_t>(a_row[kk]) - a_zero_point;
+      const uint8_t* bk = b + kk * kGemmNR;
+      for (int j = 0; j < kGemmNR; j++) {
+        acc[j] += va * (static_cast<int32_t>(bk[j]) - b_zero_point);
+      }
+    }
+    for (int j = 0; j < nr; j++) {
+      c[r * ldc + j] = Requantize(acc[j], params);
+    }
+  }
+#endif // defined(__ARM_NEON__) || defined(__ARM_NEON)
+}
+
+} // namespace
+
+void Int8Gemm(
+    int m,
+    const uint8_t* A,
+    int lda,
+    int32_t a_zero_point,
+    const PackedGemmMatrixB& B,
+    const RequantizationParams& params,
+    uint8_t* C,
+    int ldc,
+    ThreadPool* pool) {
+  const int n = B.n();
+  const int m_tiles = (m + kGemmMR - 1) / kGemmMR;
+  const int n_panels = (n + kGemmNR - 1) / kGemmNR;
+  // Consecutive tiles share their rows of A, while all of B stays in cache
+  auto tile = [&](int, size_t index) {
+    const int row = (index / n_panels) * kGemmMR;
+    const int p = index % n_panels;
+    const int col = p * kGemmNR;
+    GemmKernel(
+        std::min(kGemmMR, m - row),
+        std::min(kGemmNR, n - col),
+        B.k(),
+        A + row * lda,
+        lda,
+        a_zero_point,
+        B.panel(p),
+        B.zero_point(),
+        B.bias(p),
+        params,
+        C + row * ldc + col,
+        ldc);
+  };
+  if (pool) {
+    pool->run(tile, m_tiles * n_panels);
+  } else {
+    for (int index = 0; index < m_tiles * n_panels; index++) {
+      tile(0, index);
+    }
+  }
+}
+
+} // namespace int8
+} // namespace caffe2
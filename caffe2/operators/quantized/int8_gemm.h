@@ -0,0 +1,74 @@
+#ifndef CAFFE2_INT8_GEMM_H_
+#define CAFFE2_INT8_GEMM_H_
+
+#include <vector>
+
+#include "caffe2/operators/quantized/int8_utils.h"
+#include "caffe2/utils/threadpool/ThreadPool.h"
+
+namespace caffe2 {
+namespace int8 {
+
+// Tile of C computed by the micro-kernel: kGemmMR rows by kGemmNR columns
+constexpr int kGemmMR = 4;
+constexpr int kGemmNR = 8;
+
+// The right-hand side of Int8Gemm, n x k in row-major order (one row per
+// output channel, as the filters of the NHWC convolution and of FC), packed
+// into panels of kGemmNR rows interleaved along k, so that the micro-kernel
+// reads its kGemmNR values of a step with one load. Weights are constant
+// during inference, so the operators pack them once.
+class PackedGemmMatrixB {
+ public:
+  PackedGemmMatrixB() {}
+  PackedGemmMatrixB(
+      int n,
+      int k,
+      const uint8_t* B,
+      int32_t zero_point,
+      const int32_t* bias);
+
+  int n() const {
+    return n_;
+  }
+  int k() const {
+    return k_;
+  }
+  int32_t zero_point() const {
+    return zero_point_;
+  }
+  const uint8_t* panel(int p) const {
+    return data_.data() + p * k_ * kGemmNR;
+  }
+  const int32_t* bias(int p) const {
+    return bias_.data() + p * kGemmNR;
+  }
+
+ private:
+  int n_{0};
+  int k_{0};
+  int32_t zero_point_{0};
+  // Columns past n are padded with the zero point and contribute nothing
+  std::vector<uint8_t> data_;
+  std::vector<int32_t> bias_;
+};
+
+// C = requantize((A - a_zero_point) (B - B.zero_point())^T + B.bias()), with
+// A of size m x B.k() and leading dimension lda, and C of size m x B.n() and
+// leading dimension ldc. The tiles of C are computed in parallel on pool if
+// it is not null.
+void Int8Gemm(
+    int m,
+    const uint8_t* A,
+    int lda,
+    int32_t a_zero_point,
+    const PackedGemmMatrixB& B,
+    const RequantizationParams& params,
+    uint8_t* C,
+    int ldc,
+    ThreadPool* pool);
+
+} // namespace int8
+} // namespace caffe2
+
+#endif // CAFFE2_INT8_GEMM_H_
@@ -0,0 +1,62 @@
+#include "caffe2/operators/quantized/int8_given_tensor_fill_op.h"
+
+#include <cstring>
+
+namespace caffe2 {
+
+bool Int8GivenTensorFillOp::RunOnDevice() {
+  auto* Y = Outputs()[0]->GetMutable<int8::Int8TensorCPU>();
+  Y->t.Resize(shape_);
+  CAFFE_ENFORCE_EQ(Y->t.size(), values_.size(), "Wrong number of values");
+  Y->scale = Y_scale_;
+  Y->zero_point = Y_zero_point_;
+  memcpy(Y->t.mutable_data<uint8_t>(), values_.data(), values_.size());
+  return true;
+}
+
+bool Int8GivenIntTensorFillOp::RunOnDevice() {
+  auto* Y = Outputs()[0]->GetMutable<int8::Int8TensorCPU>();
+  Y->t.Resize(shape_);
+  CAFFE_ENFORCE_EQ(Y->t.size(), values_.size(), "Wrong number of values");
+  Y->scale = Y_scale_;
+  Y->zero_point = Y_zero_point_;
+  int32_t* Y_data = Y->t.mutable_data<int32_t>();
+  for (int i = 0; i < values_.size(); i++) {
+    Y_data[i] = values_[i];
+  }
+  return true;
+}
+
+REGISTER_CPU_OPERATOR(Int8GivenTensorFill, Int8GivenTensorFillOp);
+REGISTER_CPU_OPERATOR(Int8GivenIntTensorFill, Int8GivenIntTensorFillOp);
+
+OPERATOR_SCHEMA(Int8GivenTensorFill)
+    .NumInputs(0)
+    .NumOutputs(1)
+    .SetDoc(R"DOC(
+Creates an Int8TensorCPU of the given shape, uint8 values and quantization
+parameters.
+)DOC")
+    .Arg("shape", "Shape of the output.")
+    .Arg("values", "The uint8 values, as the bytes of a string.")
+    .Arg("Y_scale", "Scale of the output.")
+    .Arg("Y_zero_point", "Zero point of the output.")
+    .Output(0, "Y", "Int8TensorCPU of uint8 values.");
+
+OPERATOR_SCHEMA(Int8GivenIntTensorFill)
+    .NumInputs(0)
+    .NumOutputs(1)
+    .SetDoc(R"DOC(
+Creates an Int8TensorCPU of the given shape, int32 values and quantization
+parameters, such as the bias of Int8Conv and Int8FC.
+)DOC")
+    .Arg("shape", "Shape of the output.")
+    .Arg("values", "The int32 values.")
+    .Arg("Y_scale", "Scale of the output.")
+    .Arg("Y_zero_point", "Zero point of the output.")
+    .Output(0, "Y", "Int8TensorCPU of int32 values.");
+
+NO_GRADIENT(Int8GivenTensorFill);
+NO_GRADIENT(Int8GivenIntTensorFill);
+
+} // namespace caffe2
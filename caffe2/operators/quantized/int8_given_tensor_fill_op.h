@@ -0,0 +1,57 @@
+#ifndef CAFFE2_OPERATORS_INT8_GIVEN_TENSOR_FILL_OP_H_
+#define CAFFE2_OPERATORS_INT8_GIVEN_TENSOR_FILL_OP_H_
+
+#include "caffe2/core/context.h"
+#include "caffe2/core/operator.h"
+#include "caffe2/core/tensor_int8.h"
+
+namespace caffe2 {
+
+// Fills an Int8TensorCPU of uint8 values, e.g. the quantized weights of a
+// model in its init net
+class Int8GivenTensorFillOp final : public Operator<CPUContext> {
+ public:
+  USE_OPERATOR_FUNCTIONS(CPUContext);
+  Int8GivenTensorFillOp(const OperatorDef& operator_def, Workspace* ws)
+      : Operator<CPUContext>(operator_def, ws),
+        shape_(OperatorBase::GetRepeatedArgument<TIndex>("shape")),
+        values_(OperatorBase::GetSingleArgument<string>("values", "")),
+        Y_scale_(OperatorBase::GetSingleArgument<float>("Y_scale", 1.0)),
+        Y_zero_point_(
+            OperatorBase::GetSingleArgument<int>("Y_zero_point", 0)) {}
+
+  bool RunOnDevice() override;
+
+ private:
+  vector<TIndex> shape_;
+  // The uint8 values as the bytes of a string
+  string values_;
+  float Y_scale_;
+  int32_t Y_zero_point_;
+};
+
+// Fills an Int8TensorCPU of int32 values, e.g. the quantized bias of a
+// convolution
+class Int8GivenIntTensorFillOp final : public Operator<CPUContext> {
+ public:
+  USE_OPERATOR_FUNCTIONS(CPUContext);
+  Int8GivenIntTensorFillOp(const OperatorDef& operator_def, Workspace* ws)
+      : Operator<CPUContext>(operator_def, ws),
+        shape_(OperatorBase::GetRepeatedArgument<TIndex>("shape")),
+        values_(OperatorBase::GetRepeatedArgument<int>("values")),
+        Y_scale_(OperatorBase::GetSingleArgument<float>("Y_scale", 1.0)),
+        Y_zero_point_(
+            OperatorBase::GetSingleArgument<int>("Y_zero_point", 0)) {}
+
+  bool RunOnDevice() override;
+
+ private:
+  vector<TIndex> shape_;
+  vector<int> values_;
+  float Y_scale_;
+  int32_t Y_zero_point_;
+};
+
+} // namespace caffe2
+
+#endif // CAFFE2_OPERATORS_INT8_GIVEN_TENSOR_FILL_OP_H_
@@ -0,0 +1,136 @@
+#include "caffe2/operators/quantized/int8_pool_op.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace caffe2 {
+
+bool Int8MaxPoolOp::RunOnDeviceWithOrderNHWC() {
+  const auto& X = Inputs()[0]->Get<int8::Int8TensorCPU>();
+  auto* Y = Outputs()[0]->GetMutable<int8::Int8TensorCPU>();
+  CAFFE_ENFORCE_EQ(X.t.ndim(), 4);
+  const int N = X.t.dim32(0);
+  const int H = X.t.dim32(1);
+  const int W = X.t.dim32(2);
+  const int C = X.t.dim32(3);
+  ConvPoolOpBase<CPUContext>::SetOutputSize(X.t, &(Y->t), C);
+  Y->scale = X.scale;
+  Y->zero_point = X.zero_point;
+  const int OH = Y->t.dim32(1);
+  const int OW = Y->t.dim32(2);
+
+  const uint8_t* X_data = X.t.data<uint8_t>();
+  uint8_t* Y_data = Y->t.mutable_data<uint8_t>();
+  ws_->GetThreadPool()->run(
+      [&](int, size_t n_oh) {
+        const int n = n_oh / OH;
+        const int oh = n_oh % OH;
+        const int hstart = std::max(oh * stride_h() - pad_t(), 0);
+        const int hend = std::min(oh * stride_h() - pad_t() + kernel_h(), H);
+        for (int ow = 0; ow < OW; ow++) {
+          const int wstart = std::max(ow * stride_w() - pad_l(), 0);
+          const int wend = std::min(ow * stride_w() - pad_l() + kernel_w(), W);
+          uint8_t* y = Y_data + ((n * OH + oh) * OW + ow) * C;
+          std::fill(y, y + C, 0);
+          for (int h = hstart; h < hend; h++) {
+            for (int w = wstart; w < wend; w++) {
+              const uint8_t* x = X_data + ((n * H + h) * W + w) * C;
+              int c = 0;
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+              for (; c + 16 <= C; c += 16) {
+                vst1q_u8(y + c, vmaxq_u8(vld1q_u8(y + c), vld1q_u8(x + c)));
+              }
+#endif
+              for (; c < C; c++) {
+                y[c] = std::max(y[c], x[c]);
+              }
+            }
+          }
+        }
+      },
+      N * OH);
+  return true;
+}
+
+bool Int8AveragePoolOp::RunOnDeviceWithOrderNHWC() {
+  const auto& X = Inputs()[0]->Get<int8::Int8TensorCPU>();
+  auto* Y = Outputs()[0]->GetMutable<int8::Int8TensorCPU>();
+  CAFFE_ENFORCE_EQ(X.t.ndim(), 4);
+  const int N = X.t.dim32(0);
+  const int H = X.t.dim32(1);
+  const int W = X.t.dim32(2);
+  const int C = X.t.dim32(3);
+  const float X_scale = X.scale;
+  const int32_t X_zero_point = X.zero_point;
+  ConvPoolOpBase<CPUContext>::SetOutputSize(X.t, &(Y->t), C);
+  Y->scale = Y_scale_;
+  Y->zero_point = Y_zero_point_;
+  const int OH = Y->t.dim32(1);
+  const int OW = Y->t.dim32(2);
+
+  const uint8_t* X_data = X.t.data<uint8_t>();
+  uint8_t* Y_data = Y->t.mutable_data<uint8_t>();
+  ws_->GetThreadPool()->run(
+      [&](int, size_t n_oh) {
+        const int n = n_oh / OH;
+        const int oh = n_oh % OH;
+        const int hstart = std::max(oh * stride_h() - pad_t(), 0);
+        const int hend = std::min(oh * stride_h() - pad_t() + kernel_h(), H);
+        std::vector<int32_t> sums(C);
+        for (int ow = 0; ow < OW; ow++) {
+          const int wstart = std::max(ow * stride_w() - pad_l(), 0);
+          const int wend = std::min(ow * stride_w() - pad_l() + kernel_w(), W);
+          std::fill(sums.begin(), sums.end(), 0);
+          for (int h = hstart; h < hend; h++) {
+            for (int w = wstart; w < wend; w++) {
+              const uint8_t* x = X_data + ((n * H + h) * W + w) * C;
+              for (int c = 0; c < C; c++) {
+                sums[c] += x[c];
+              }
+            }
+          }
+          const int count = (hend - hstart) * (wend - wstart);
+          const float multiplier = X_scale / (Y_scale_ * count);
+          uint8_t* y = Y_data + ((n * OH + oh) * OW + ow) * C;
+          for (int c = 0; c < C; c++) {
+            const int32_t q = Y_zero_point_ +
+                static_cast<int32_t>(std::nearbyint(
+                    multiplier * (sums[c] - count * X_zero_point)));
+            y[c] = static_cast<uint8_t>(std::min(std::max(q, 0), 255));
+          }
+        }
+      },
+      N * OH);
+  return true;
+}
+
+REGISTER_CPU_OPERATOR(Int8MaxPool, Int8MaxPoolOp);
+REGISTER_CPU_OPERATOR(Int8AveragePool, Int8AveragePoolOp);
+
+OPERATOR_SCHEMA(Int8MaxPool)
+    .NumInputs(1)
+    .NumOutputs(1)
+    .SetDoc(R"DOC(
+Max pooling of the NHWC Int8TensorCPU X, with the arguments of MaxPool. The
+output keeps the quantization of X.
+)DOC")
+    .Input(0, "X", "NHWC Int8TensorCPU of uint8 values.")
+    .Output(0, "Y", "NHWC Int8TensorCPU of uint8 values.");
+
+OPERATOR_SCHEMA(Int8AveragePool)
+    .NumInputs(1)
+    .NumOutputs(1)
+    .SetDoc(R"DOC(
+Average pooling of the NHWC Int8TensorCPU X, with the arguments of
+AveragePool. Padding is excluded from the averages, and the output is
+quantized with Y_scale and Y_zero_point.
+)DOC")
+    .Arg("Y_scale", "Scale of the output.")
+    .Arg("Y_zero_point", "Zero point of the output.")
+    .Input(0, "X", "NHWC Int8TensorCPU of uint8 values.")
+    .Output(0, "Y", "NHWC Int8TensorCPU of uint8 values.");
+
+NO_GRADIENT(Int8MaxPool);
+NO_GRADIENT(Int8AveragePool);
+
+} // namespace caffe2
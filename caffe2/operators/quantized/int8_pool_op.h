@@ -0,0 +1,53 @@
+#ifndef CAFFE2_OPERATORS_INT8_POOL_OP_H_
+#define CAFFE2_OPERATORS_INT8_POOL_OP_H_
+
+#include "caffe2/core/context.h"
+#include "caffe2/core/operator.h"
+#include "caffe2/core/tensor_int8.h"
+#include "caffe2/operators/conv_pool_op_base.h"
+#include "caffe2/operators/quantized/int8_utils.h"
+
+namespace caffe2 {
+
+// Max pooling of uint8 values, which keeps the quantization of X since the
+// max commutes with the dequantization
+class Int8MaxPoolOp final : public ConvPoolOpBase<CPUContext> {
+ public:
+  USE_CONV_POOL_BASE_FUNCTIONS(CPUContext);
+  Int8MaxPoolOp(const OperatorDef& operator_def, Workspace* ws)
+      : ConvPoolOpBase<CPUContext>(operator_def, ws) {
+    OPERATOR_NEEDS_FEATURE(
+        order_ == StorageOrder::NHWC, "Int8MaxPool only supports NHWC order");
+    CAFFE_ENFORCE_EQ(kernel_.size(), 2, "Int8MaxPool only supports 2D pooling");
+  }
+
+  bool RunOnDeviceWithOrderNHWC() override;
+};
+
+// Average pooling over the valid elements of each window, quantized with
+// Y_scale and Y_zero_point
+class Int8AveragePoolOp final : public ConvPoolOpBase<CPUContext> {
+ public:
+  USE_CONV_POOL_BASE_FUNCTIONS(CPUContext);
+  Int8AveragePoolOp(const OperatorDef& operator_def, Workspace* ws)
+      : ConvPoolOpBase<CPUContext>(operator_def, ws),
+        Y_scale_(OperatorBase::GetSingleArgument<float>("Y_scale", 1.0)),
+        Y_zero_point_(
+            OperatorBase::GetSingleArgument<int>("Y_zero_point", 0)) {
+    OPERATOR_NEEDS_FEATURE(
+        order_ == StorageOrder::NHWC,
+        "Int8AveragePool only supports NHWC order");
+    CAFFE_ENFORCE_EQ(
+        kernel_.size(), 2, "Int8AveragePool only supports 2D pooling");
+  }
+
+  bool RunOnDeviceWithOrderNHWC() override;
+
+ private:
+  float Y_scale_;
+  int32_t Y_zero_point_;
+};
+
+} // namespace caffe2
+
+#endif // CAFFE2_OPERATORS_INT8_POOL_OP_H_
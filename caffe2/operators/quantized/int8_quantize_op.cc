@@ -0,0 +1,59 @@
+#include "caffe2/operators/quantized/int8_quantize_op.h"
+
+namespace caffe2 {
+
+bool Int8QuantizeOp::RunOnDevice() {
+  const auto& X = Input(0);
+  auto* Y = Outputs()[0]->GetMutable<int8::Int8TensorCPU>();
+  Y->t.ResizeLike(X);
+  Y->scale = Y_scale_;
+  Y->zero_point = Y_zero_point_;
+  const float* X_data = X.data<float>();
+  uint8_t* Y_data = Y->t.mutable_data<uint8_t>();
+  for (int i = 0; i < X.size(); i++) {
+    Y_data[i] = int8::QuantizeUint8(Y_scale_, Y_zero_point_, X_data[i]);
+  }
+  return true;
+}
+
+bool Int8DequantizeOp::RunOnDevice() {
+  const auto& X = Inputs()[0]->Get<int8::Int8TensorCPU>();
+  auto* Y = Output(0);
+  Y->ResizeLike(X.t);
+  const uint8_t* X_data = X.t.data<uint8_t>();
+  float* Y_data = Y->mutable_data<float>();
+  for (int i = 0; i < X.t.size(); i++) {
+    Y_data[i] = int8::DequantizeUint8(X.scale, X.zero_point, X_data[i]);
+  }
+  return true;
+}
+
+REGISTER_CPU_OPERATOR(Int8Quantize, Int8QuantizeOp);
+REGISTER_CPU_OPERATOR(Int8Dequantize, Int8DequantizeOp);
+
+OPERATOR_SCHEMA(Int8Quantize)
+    .NumInputs(1)
+    .NumOutputs(1)
+    .SetDoc(R"DOC(
+Quantizes the float tensor X to the Int8TensorCPU Y of uint8 values
+q = clamp(round(x / Y_scale) + Y_zero_point, 0, 255).
+)DOC")
+    .Arg("Y_scale", "Scale of the quantized output.")
+    .Arg("Y_zero_point", "Quantized value of the real zero, in [0, 255].")
+    .Input(0, "X", "Float tensor.")
+    .Output(0, "Y", "Int8TensorCPU of the same shape as X.");
+
+OPERATOR_SCHEMA(Int8Dequantize)
+    .NumInputs(1)
+    .NumOutputs(1)
+    .SetDoc(R"DOC(
+Converts the Int8TensorCPU X back to the float tensor Y of values
+y = X.scale * (q - X.zero_point).
+)DOC")
+    .Input(0, "X", "Int8TensorCPU.")
+    .Output(0, "Y", "Float tensor of the same shape as X.");
+
+NO_GRADIENT(Int8Quantize);
+NO_GRADIENT(Int8Dequantize);
+
+} // namespace caffe2
@@ -0,0 +1,37 @@
+#include "caffe2/operators/quantized/int8_relu_op.h"
+
+#include <algorithm>
+
+namespace caffe2 {
+
+bool Int8ReluOp::RunOnDevice() {
+  const auto& X = Inputs()[0]->Get<int8::Int8TensorCPU>();
+  auto* Y = Outputs()[0]->GetMutable<int8::Int8TensorCPU>();
+  const uint8_t zero_point = static_cast<uint8_t>(X.zero_point);
+  Y->scale = X.scale;
+  Y->zero_point = X.zero_point;
+  Y->t.ResizeLike(X.t);
+  const uint8_t* X_data = X.t.data<uint8_t>();
+  uint8_t* Y_data = Y->t.mutable_data<uint8_t>();
+  for (int i = 0; i < X.t.size(); i++) {
+    Y_data[i] = std::max(X_data[i], zero_point);
+  }
+  return true;
+}
+
+REGISTER_CPU_OPERATOR(Int8Relu, Int8ReluOp);
+
+OPERATOR_SCHEMA(Int8Relu)
+    .NumInputs(1)
+    .NumOutputs(1)
+    .AllowInplace({{0, 0}})
+    .SetDoc(R"DOC(
+Int8Relu applies y = max(0, x) elementwise to the Int8TensorCPU X, which is
+max(q, X.zero_point) on its quantized values. Y has the quantization of X.
+)DOC")
+    .Input(0, "X", "Int8TensorCPU of uint8 values.")
+    .Output(0, "Y", "Int8TensorCPU of the same shape and quantization as X.");
+
+NO_GRADIENT(Int8Relu);
+
+} // namespace caffe2
@@ -0,0 +1,318 @@
+#include <random>
+
+#include "caffe2/core/operator.h"
+#include "caffe2/core/tensor_int8.h"
+#include "caffe2/operators/quantized/int8_gemm.h"
+#include "caffe2/operators/quantized/int8_utils.h"
+#include "gtest/gtest.h"
+
+namespace caffe2 {
+namespace {
+
+vector<uint8_t> RandomUint8(int n, int seed) {
+  std::mt19937 gen(seed);
+  std::uniform_int_distribution<int> dist(0, 255);
+  vector<uint8_t> values(n);
+  for (auto& v : values) {
+    v = dist(gen);
+  }
+  return values;
+}
+
+void AddInt8Input(
+    const vector<TIndex>& shape,
+    const vector<uint8_t>& values,
+    float scale,
+    int32_t zero_point,
+    const string& name,
+    Workspace* ws) {
+  auto* tensor = ws->CreateBlob(name)->GetMutable<int8::Int8TensorCPU>();
+  tensor->t.Resize(shape);
+  std::copy(
+      values.begin(), values.end(), tensor->t.mutable_data<uint8_t>());
+  tensor->scale = scale;
+  tensor->zero_point = zero_point;
+}
+
+void AddInt32Input(
+    const vector<TIndex>& shape,
+    const vector<int32_t>& values,
+    float scale,
+    const string& name,
+    Workspace* ws) {
+  auto* tensor = ws->CreateBlob(name)->GetMutable<int8::Int8TensorCPU>();
+  tensor->t.Resize(shape);
+  std::copy(
+      values.begin(), values.end(), tensor->t.mutable_data<int32_t>());
+  tensor->scale = scale;
+  tensor->zero_point = 0;
+}
+
+float Dequantize(const int8::Int8TensorCPU& X, int i) {
+  return int8::DequantizeUint8(X.scale, X.zero_point, X.t.data<uint8_t>()[i]);
+}
+
+// Expects the quantized values of Y to be within one quantization step of
+// the real values expected
+void ExpectNear(const vector<float>& expected, const int8::Int8TensorCPU& Y) {
+  ASSERT_EQ(expected.size(), Y.t.size());
+  for (int i = 0; i < expected.size(); i++) {
+    const float clamped = std::min(
+        std::max(expected[i], Y.scale * (0 - Y.zero_point)),
+        Y.scale * (255 - Y.zero_point));
+    EXPECT_NEAR(clamped, Dequantize(Y, i), Y.scale * 1.01) << i;
+  }
+}
+
+} // namespace
+
+TEST(Int8Test, Requantization) {
+  std::mt19937 gen(1);
+  std::uniform_real_distribution<double> multiplier_dist(1e-4, 0.999);
+  for (int i = 0; i < 10000; i++) {
+    const double real_multiplier = multiplier_dist(gen);
+    int32_t multiplier;
+    int right_shift;
+    int8::QuantizeMultiplierSmallerThanOne(
+        real_multiplier, &multiplier, &right_shift);
+    const int32_t x = static_cast<int32_t>(gen()) >> (gen() % 31);
+    const double expected = x * real_multiplier;
+    // Off by at most the rounding of the result and of the multiplier
+    EXPECT_NEAR(
+        expected,
+        int8::MultiplyByQuantizedMultiplierSmallerThanOne(
+            x, multiplier, right_shift),
+        1.0 + 1e-9 * std::abs(expected));
+  }
+  EXPECT_EQ(int8::RoundingDivideByPOT(5, 1), 3);
+  EXPECT_EQ(int8::RoundingDivideByPOT(-5, 1), -3);
+  EXPECT_EQ(int8::RoundingDivideByPOT(-6, 2), -2);
+}
+
+TEST(Int8Test, Gemm) {
+  // Sizes with partial tiles of the micro-kernel, and depths with remainders
+  for (const auto& size : vector<vector<int>>{
+           {1, 1, 1}, {13, 19, 21}, {4, 8, 8}, {37, 64, 75}, {5, 3, 300}}) {
+    const int m = size[0];
+    const int n = size[1];
+    const int k = size[2];
+    const auto A = RandomUint8(m * k, m);
+    const auto B = RandomUint8(n * k, n);
+    vector<int32_t> bias(n);
+    for (int j = 0; j < n; j++) {
+      bias[j] = 97 * j - 1000;
+    }
+    const int32_t A_zero_point = 127;
+    const int32_t B_zero_point = 140;
+    const auto params =
+        int8::GetRequantizationParams(1.0 / (300.0 * k), 100, false);
+    int8::PackedGemmMatrixB packed(n, k, B.data(), B_zero_point, bias.data());
+    vector<uint8_t> C(m * n);
+    int8::Int8Gemm(
+        m, A.data(), k, A_zero_point, packed, params, C.data(), n, nullptr);
+    for (int i = 0; i < m; i++) {
+      for (int j = 0; j < n; j++) {
+        int32_t acc = bias[j];
+        for (int kk = 0; kk < k; kk++) {
+          acc +=
+              (A[i * k + kk] - A_zero_point) * (B[j * k + kk] - B_zero_point);
+        }
+        EXPECT_EQ(int8::Requantize(acc, params), C[i * n + j]);
+      }
+    }
+  }
+}
+
+TEST(Int8Test, Conv) {
+  // {C, M, kernel, stride, pad, group}: the 1x1 convolution without im2col,
+  // a strided group convolution and a depthwise convolution
+  for (const auto& config : vector<vector<int>>{{8, 16, 1, 1, 0, 1},
+                                                {6, 20, 3, 1, 1, 1},
+                                                {12, 8, 3, 2, 1, 2},
+                                                {20, 20, 3, 1, 1, 20},
+                                                {11, 11, 5, 2, 2, 11}}) {
+    const int N = 2;
+    const int H = 9;
+    const int W = 7;
+    const int C = config[0];
+    const int M = config[1];
+    const int kernel = config[2];
+    const int stride = config[3];
+    const int pad = config[4];
+    const int group = config[5];
+    const int Cg = C / group;
+    const int K = kernel * kernel * Cg;
+
+    for (bool relu : {false, true}) {
+      Workspace ws;
+      AddInt8Input(
+          {N, H, W, C}, RandomUint8(N * H * W * C, C), 0.05, 120, "X", &ws);
+      AddInt8Input(
+          {M, kernel, kernel, Cg}, RandomUint8(M * K, M), 0.01, 130, "W", &ws);
+      vector<int32_t> bias(M);
+      for (int m = 0; m < M; m++) {
+        bias[m] = 53 * m - 300;
+      }
+      AddInt32Input({M}, bias, 0.05 * 0.01, "B", &ws);
+
+      OperatorDef def;
+      def.set_type(relu ? "Int8ConvRelu" : "Int8Conv");
+      def.add_input("X");
+      def.add_input("W");
+      def.add_input("B");
+      def.add_output("Y");
+      def.add_arg()->CopyFrom(MakeArgument("kernel", kernel));
+      def.add_arg()->CopyFrom(MakeArgument("stride", stride));
+      def.add_arg()->CopyFrom(MakeArgument("pad", pad));
+      def.add_arg()->CopyFrom(MakeArgument("group", group));
+      def.add_arg()->CopyFrom(MakeArgument<string>("order", "NHWC"));
+      def.add_arg()->CopyFrom(MakeArgument("Y_scale", 0.05f * K / 10));
+      def.add_arg()->CopyFrom(MakeArgument("Y_zero_point", 110));
+      unique_ptr<OperatorBase> op(CreateOperator(def, &ws));
+      ASSERT_NE(nullptr, op.get());
+      ASSERT_TRUE(op->Run());
+
+      const auto& X = ws.GetBlob("X")->Get<int8::Int8TensorCPU>();
+      const auto& filter = ws.GetBlob("W")->Get<int8::Int8TensorCPU>();
+      const auto& Y = ws.GetBlob("Y")->Get<int8::Int8TensorCPU>();
+      const int OH = (H + 2 * pad - kernel) / stride + 1;
+      const int OW = (W + 2 * pad - kernel) / stride + 1;
+      ASSERT_EQ(Y.t.dims(), (vector<TIndex>{N, OH, OW, M}));
+      vector<float> expected(N * OH * OW * M);
+      for (int n = 0; n < N; n++) {
+        for (int oh = 0; oh < OH; oh++) {
+          for (int ow = 0; ow < OW; ow++) {
+            for (int m = 0; m < M; m++) {
+              const int g = m / (M / group);
+              float y = bias[m] * 0.05 * 0.01;
+              for (int kh = 0; kh < kernel; kh++) {
+                for (int kw = 0; kw < kernel; kw++) {
+                  const int ih = oh * stride - pad + kh;
+                  const int iw = ow * stride - pad + kw;
+                  if (ih < 0 || ih >= H || iw < 0 || iw >= W) {
+                    continue;
+                  }
+                  const int x_offset = ((n * H + ih) * W + iw) * C + g * Cg;
+                  const int w_offset = ((m * kernel + kh) * kernel + kw) * Cg;
+                  for (int c = 0; c < Cg; c++) {
+                    y += Dequantize(X, x_offset + c) *
+                        Dequantize(filter, w_offset + c);
+                  }
+                }
+              }
+              expected[((n * OH + oh) * OW + ow) * M + m] =
+                  relu ? std::max(y, 0.0f) : y;
+            }
+          }
+        }
+      }
+      ExpectNear(expected, Y);
+
+      // The filters are packed once and reused
+      ASSERT_TRUE(op->Run());
+      ExpectNear(expected, ws.GetBlob("Y")->Get<int8::Int8TensorCPU>());
+    }
+  }
+}
+
+TEST(Int8Test, FC) {
+  const int M = 3;
+  const int K = 50;
+  const int N = 10;
+  Workspace ws;
+  AddInt8Input({M, K}, RandomUint8(M * K, 1), 0.1, 128, "X", &ws);
+  AddInt8Input({N, K}, RandomUint8(N * K, 2), 0.02, 100, "W", &ws);
+  vector<int32_t> bias(N);
+  for (int n = 0; n < N; n++) {
+    bias[n] = 200 * n - 1000;
+  }
+  AddInt32Input({N}, bias, 0.1 * 0.02, "B", &ws);
+
+  OperatorDef def;
+  def.set_type("Int8FC");
+  def.add_input("X");
+  def.add_input("W");
+  def.add_input("B");
+  def.add_output("Y");
+  def.add_arg()->CopyFrom(MakeArgument("Y_scale", 0.5f));
+  def.add_arg()->CopyFrom(MakeArgument("Y_zero_point", 128));
+  unique_ptr<OperatorBase> op(CreateOperator(def, &ws));
+  ASSERT_NE(nullptr, op.get());
+  ASSERT_TRUE(op->Run());
+
+  const auto& X = ws.GetBlob("X")->Get<int8::Int8TensorCPU>();
+  const auto& W = ws.GetBlob("W")->Get<int8::Int8TensorCPU>();
+  vector<float> expected(M * N);
+  for (int i = 0; i < M; i++) {
+    for (int j = 0; j < N; j++) {
+      float y = bias[j] * 0.1 * 0.02;
+      for (int k = 0; k < K; k++) {
+        y += Dequantize(X, i * K + k) * Dequantize(W, j * K + k);
+      }
+      expected[i * N + j] = y;
+    }
+  }
+  ExpectNear(expected, ws.GetBlob("Y")->Get<int8::Int8TensorCPU>());
+}
+
+TEST(Int8Test, Add) {
+  const int size = 100;
+  Workspace ws;
+  AddInt8Input({size}, RandomUint8(size, 1), 0.1, 128, "A", &ws);
+  AddInt8Input({size}, RandomUint8(size, 2), 0.03, 10, "B", &ws);
+
+  for (bool relu : {false, true}) {
+    OperatorDef def;
+    def.set_type(relu ? "Int8AddRelu" : "Int8Add");
+    def.add_input("A");
+    def.add_input("B");
+    def.add_output("Y");
+    def.add_arg()->CopyFrom(MakeArgument("Y_scale", 0.15f));
+    def.add_arg()->CopyFrom(MakeArgument("Y_zero_point", 100));
+    unique_ptr<OperatorBase> op(CreateOperator(def, &ws));
+    ASSERT_NE(nullptr, op.get());
+    ASSERT_TRUE(op->Run());
+
+    const auto& A = ws.GetBlob("A")->Get<int8::Int8TensorCPU>();
+    const auto& B = ws.GetBlob("B")->Get<int8::Int8TensorCPU>();
+    vector<float> expected(size);
+    for (int i = 0; i < size; i++) {
+      const float y = Dequantize(A, i) + Dequantize(B, i);
+      expected[i] = relu ? std::max(y, 0.0f) : y;
+    }
+    ExpectNear(expected, ws.GetBlob("Y")->Get<int8::Int8TensorCPU>());
+  }
+}
+
+TEST(Int8Test, AveragePool) {
+  const int H = 7;
+  const int W = 7;
+  const int C = 19;
+  Workspace ws;
+  AddInt8Input({1, H, W, C}, RandomUint8(H * W * C, 1), 0.1, 128, "X", &ws);
+
+  OperatorDef def;
+  def.set_type("Int8AveragePool");
+  def.add_input("X");
+  def.add_output("Y");
+  def.add_arg()->CopyFrom(MakeArgument("global_pooling", 1));
+  def.add_arg()->CopyFrom(MakeArgument<string>("order", "NHWC"));
+  def.add_arg()->CopyFrom(MakeArgument("Y_scale", 0.05f));
+  def.add_arg()->CopyFrom(MakeArgument("Y_zero_point", 128));
+  unique_ptr<OperatorBase> op(CreateOperator(def, &ws));
+  ASSERT_NE(nullptr, op.get());
+  ASSERT_TRUE(op->Run());
+
+  const auto& X = ws.GetBlob("X")->Get<int8::Int8TensorCPU>();
+  const auto& Y = ws.GetBlob("Y")->Get<int8::Int8TensorCPU>();
+  ASSERT_EQ(Y.t.dims(), (vector<TIndex>{1, 1, 1, C}));
+  vector<float> expected(C, 0);
+  for (int i = 0; i < H * W; i++) {
+    for (int c = 0; c < C; c++) {
+      expected[c] += Dequantize(X, i * C + c) / (H * W);
+    }
+  }
+  ExpectNear(expected, Y);
+}
+
+} // namespace caffe2
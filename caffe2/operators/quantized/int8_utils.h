@@ -0,0 +1,149 @@
+#ifndef CAFFE2_INT8_UTILS_H_
+#define CAFFE2_INT8_UTILS_H_
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+#include "caffe2/core/logging.h"
+#include "caffe2/core/tensor_int8.h"
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace caffe2 {
+namespace int8 {
+
+// Fixed-point arithmetic for the requantization of int32 accumulators to
+// uint8, bit-exact with gemmlowp and its NEON instructions. A real multiplier
+// in (0, 1) is stored as a Q31 fixed-point multiplier and a right shift.
+
+// Equivalent to vqrdmulh: the high 32 bits of 2 * a * b, rounded
+inline int32_t SaturatingRoundingDoublingHighMul(int32_t a, int32_t b) {
+  const bool overflow = a == b && a == std::numeric_limits<int32_t>::min();
+  const int64_t ab_64 = static_cast<int64_t>(a) * static_cast<int64_t>(b);
+  const int32_t nudge = ab_64 >= 0 ? (1 << 30) : (1 - (1 << 30));
+  const int32_t ab_x2_high32 =
+      static_cast<int32_t>((ab_64 + nudge) / (1ll << 31));
+  return overflow ? std::numeric_limits<int32_t>::max() : ab_x2_high32;
+}
+
+// Division by 2^exponent, rounding half away from zero
+inline int32_t RoundingDivideByPOT(int32_t x, int exponent) {
+  const int32_t mask = static_cast<int32_t>((1ll << exponent) - 1);
+  const int32_t remainder = x & mask;
+  const int32_t threshold = (mask >> 1) + (x < 0 ? 1 : 0);
+  return (x >> exponent) + (remainder > threshold ? 1 : 0);
+}
+
+inline int32_t MultiplyByQuantizedMultiplierSmallerThanOne(
+    int32_t x,
+    int32_t quantized_multiplier,
+    int right_shift) {
+  return RoundingDivideByPOT(
+      SaturatingRoundingDoublingHighMul(x, quantized_multiplier), right_shift);
+}
+
+inline void QuantizeMultiplierSmallerThanOne(
+    double real_multiplier,
+    int32_t* quantized_multiplier,
+    int* right_shift) {
+  CAFFE_ENFORCE(
+      real_multiplier > 0. && real_multiplier < 1.,
+      "Requantization multiplier must be in (0, 1), got ",
+      real_multiplier);
+  int s = 0;
+  while (real_multiplier < 0.5) {
+    real_multiplier *= 2.0;
+    s++;
+  }
+  int64_t q = static_cast<int64_t>(std::round(real_multiplier * (1ll << 31)));
+  CAFFE_ENFORCE_LE(q, 1ll << 31);
+  if (q == (1ll << 31)) {
+    q /= 2;
+    --s;
+  }
+  if (s > 31) {
+    // Any int32 accumulator rounds to zero
+    q = 0;
+    s = 0;
+  }
+  *quantized_multiplier = static_cast<int32_t>(q);
+  *right_shift = s;
+}
+
+inline uint8_t QuantizeUint8(float scale, int32_t zero_point, float value) {
+  const int32_t qmin = std::numeric_limits<uint8_t>::min();
+  const int32_t qmax = std::numeric_limits<uint8_t>::max();
+  const int32_t q =
+      zero_point + static_cast<int32_t>(std::nearbyint(value / scale));
+  return static_cast<uint8_t>(std::min(std::max(q, qmin), qmax));
+}
+
+inline float DequantizeUint8(float scale, int32_t zero_point, uint8_t value) {
+  return scale * (static_cast<int32_t>(value) - zero_point);
+}
+
+// Parameters of the requantization of int32 accumulators to uint8 outputs
+// with the given zero point, clamped to [min, max]
+struct RequantizationParams {
+  int32_t multiplier{0};
+  int right_shift{0};
+  int32_t zero_point{0};
+  uint8_t min{0};
+  uint8_t max{255};
+};
+
+inline RequantizationParams GetRequantizationParams(
+    double real_multiplier,
+    int32_t zero_point,
+    bool relu) {
+  RequantizationParams params;
+  QuantizeMultiplierSmallerThanOne(
+      real_multiplier, &params.multiplier, &params.right_shift);
+  params.zero_point = zero_point;
+  params.min = relu ? static_cast<uint8_t>(zero_point) : 0;
+  params.max = 255;
+  return params;
+}
+
+inline uint8_t Requantize(int32_t acc, const RequantizationParams& params) {
+  const int32_t scaled = MultiplyByQuantizedMultiplierSmallerThanOne(
+      acc, params.multiplier, params.right_shift);
+  const int32_t q = std::min<int32_t>(
+      std::max<int32_t>(scaled + params.zero_point, params.min), params.max);
+  return static_cast<uint8_t>(q);
+}
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+
+// Requantizes 8 accumulators, bit-exact with Requantize
+inline uint8x8_t RequantizeNeon(
+    int32x4_t lo,
+    int32x4_t hi,
+    const RequantizationParams& params) {
+  const int32x4_t vmultiplier = vdupq_n_s32(params.multiplier);
+  const int32x4_t vshift = vdupq_n_s32(-params.right_shift);
+  lo = vqrdmulhq_s32(lo, vmultiplier);
+  hi = vqrdmulhq_s32(hi, vmultiplier);
+  // vrshl rounds half up, so negative values are nudged down first to round
+  // half away from zero like RoundingDivideByPOT
+  lo = vqaddq_s32(lo, vshrq_n_s32(vandq_s32(lo, vshift), 31));
+  hi = vqaddq_s32(hi, vshrq_n_s32(vandq_s32(hi, vshift), 31));
+  lo = vrshlq_s32(lo, vshift);
+  hi = vrshlq_s32(hi, vshift);
+  const int16x8_t acc = vqaddq_s16(
+      vcombine_s16(vqmovn_s32(lo), vqmovn_s32(hi)),
+      vdupq_n_s16(static_cast<int16_t>(params.zero_point)));
+  const uint8x8_t out = vmax_u8(vqmovun_s16(acc), vdup_n_u8(params.min));
+  return vmin_u8(out, vdup_n_u8(params.max));
+}
+
+#endif // defined(__ARM_NEON__) || defined(__ARM_NEON)
+
+} // namespace int8
+} // namespace caffe2
+
+#endif // CAFFE2_INT8_UTILS_H_
@@ -111,10 +111,11 @@ class RecurrentNetworkExecutorBase {
       // the forward-only mode.
       std::string this_timestep_blob =
           timestep_blob_ + "_rnnexec_t" + caffe2::to_string(t);
-      ws->CreateBlob(this_timestep_blob)->GetMutable<TensorCPU>()->Resize(1);
-      auto b = ws->GetBlob(this_timestep_blob);
+      auto b = ws->CreateBlob(Workspace::InternBlobName(this_timestep_blob));
       CAFFE_ENFORCE(b);
-      b->GetMutable<TensorCPU>()->mutable_data<int32_t>()[0] = t;
+      auto* timestep = b->GetMutable<TensorCPU>();
+      timestep->Resize(1);
+      timestep->mutable_data<int32_t>()[0] = t;
 
       // Copy the operators from template
       for (auto& template_rnn_op : timestep_ops_template_) {
@@ -38,9 +38,11 @@ CUDARecurrentNetworkExecutor::~CUDARecurrentNetworkExecutor() {
 void CUDARecurrentNetworkExecutor::_ExecRange(int from, int to) {
   int direction = to > from ? 1 : -1;
 
-  int max_streams = max_parallel_timesteps_ > 0 ?
-                    std::min(max_parallel_timesteps_, max_cuda_streams_)
-                    : max_cuda_streams_;
+  int max_streams =
+      max_cuda_streams_ > 0 ? max_cuda_streams_ : wavefront_width_;
+  if (max_parallel_timesteps_ > 0) {
+    max_streams = std::min(max_parallel_timesteps_, max_streams);
+  }
   int stream_seq = 0;
   int num_ops = timestep_ops_[0].size();
 
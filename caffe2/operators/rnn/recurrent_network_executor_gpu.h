@@ -5,7 +5,9 @@
 #include "caffe2/operators/rnn/recurrent_network_executor.h"
 
 
+#include <algorithm>
 #include <map>
+#include <vector>
 
 namespace caffe2 {
 
@@ -30,39 +32,64 @@ class CUDARecurrentNetworkExecutor : public RecurrentNetworkExecutorBase {
 
   void AnalyzeOps() override {
     /**
-      * Check if there is an op that only depends on ops from previous
-      * timestep, and that ops is not the last op. Then we can start computation
-      * in subsequent timesteps before the whole previous timestep has finished.
-      * If there is no parallelism, we can avoid overhead of event-based
-      * dependency management.
+      * Each timestep runs its ops in order on one stream, and waits with
+      * events only for the ops of the previous timestep its ops depend on.
+      * A timestep can thus start before the previous one has finished, e.g.
+      * the first layer of a stacked LSTM can run while the layers above it
+      * finish the previous timestep, so that timesteps run in a wavefront.
+      * Estimate how many timesteps are in flight at once by scheduling the
+      * ops with a unit cost (link ops run no kernels), and give each of them
+      * its own stream. Without parallelism, we avoid the overhead of
+      * event-based dependency management.
       */
-    has_timestep_parallelism_ = false;
-    for (auto& rnn_op : timestep_ops_template_) {
-      int i = rnn_op.order;
-      if (rnn_op.parents.size() >= 1 && i < timestep_ops_template_.size() - 1) {
-        bool only_recurrent_deps = std::all_of(
-                  rnn_op.parents.begin(),
-                  rnn_op.parents.end(), [&](const int &parent) {
-                    return parent > i;
-                  }
-        );
-        if (only_recurrent_deps) {
-          VLOG(1) << "Timestep parallel op: " << ProtoDebugString(step_net_def_.op(i));
-          has_timestep_parallelism_ = true;
-
-          for (int dep : rnn_op.parents) {
-            if (dep == timestep_ops_template_.size() - 1) {
-              // This op depends on the last op of the previous iteration,
-              // so it will block any parallelism
-              has_timestep_parallelism_ = false;
-              break;
+    int num_ops = timestep_ops_template_.size();
+    int num_timesteps = 2 * num_ops + 2;
+    std::vector<int> finish(num_ops, 0);
+    std::vector<int> begins, ends;
+    for (int t = 0; t < num_timesteps; t++) {
+      std::vector<int> prev_finish = finish;
+      int time = 0;
+      int begin = -1;
+      for (int i = 0; i < num_ops; i++) {
+        auto& rnn_op = timestep_ops_template_[i];
+        if (t > 0) {
+          for (int parent : rnn_op.parents) {
+            if (parent > i) {
+              time = std::max(time, prev_finish[parent]);
             }
           }
-          break;
+        }
+        if (begin < 0) {
+          begin = time;
+        }
+        time += rnn_op.link_op ? 0 : 1;
+        finish[i] = time;
+      }
+      begins.push_back(begin);
+      ends.push_back(time);
+    }
+    // Beyond one timestep per op, there is more work in flight than ops that
+    // can run at once
+    int num_kernel_ops = std::count_if(
+        timestep_ops_template_.begin(),
+        timestep_ops_template_.end(),
+        [](const RNNNetOperator& rnn_op) { return !rnn_op.link_op; });
+    wavefront_width_ = 1;
+    for (int t = 0; t < num_timesteps; t++) {
+      int in_flight = 1;
+      for (int s = 0; s < t; s++) {
+        if (ends[s] > begins[t]) {
+          in_flight++;
         }
       }
+      wavefront_width_ = std::max(wavefront_width_, in_flight);
     }
-    LOG(INFO) << "Analyzed ops for timestep parallelism: " << has_timestep_parallelism_;
+    wavefront_width_ =
+        std::max(1, std::min(wavefront_width_, num_kernel_ops));
+    has_timestep_parallelism_ = wavefront_width_ > 1;
+    LOG(INFO) << "Analyzed ops for timestep parallelism: "
+              << has_timestep_parallelism_ << " (up to " << wavefront_width_
+              << " timesteps in flight)";
  }
 
  public:
@@ -76,7 +103,10 @@ class CUDARecurrentNetworkExecutor : public RecurrentNetworkExecutorBase {
 
   std::vector<cudaEvent_t> events_;
   bool has_timestep_parallelism_ = false;
-  int max_cuda_streams_ = 2;
+  // Number of timesteps that can run at once, see AnalyzeOps()
+  int wavefront_width_ = 1;
+  // Number of streams to use; 0 for one per timestep in flight
+  int max_cuda_streams_ = 0;
 };
 }
 #endif
@@ -51,11 +51,14 @@ struct ScratchWorkspaces {
   std::shared_ptr<Workspace> sharedBlobsWs = nullptr;
 };
 
-inline void UpdateTimestepBlob(Workspace* ws, std::string blob_name, int t) {
-  ws->CreateBlob(blob_name)->GetMutable<TensorCPU>()->Resize(1);
-  auto timestepBlob = ws->GetBlob(blob_name);
+// blob_id is the interned name of the timestep blob, see
+// Workspace::InternBlobName
+inline void UpdateTimestepBlob(Workspace* ws, int blob_id, int t) {
+  auto timestepBlob = ws->CreateBlob(blob_id);
   CAFFE_ENFORCE(timestepBlob);
-  timestepBlob->GetMutable<TensorCPU>()->mutable_data<int32_t>()[0] = t;
+  auto* timestep = timestepBlob->GetMutable<TensorCPU>();
+  timestep->Resize(1);
+  timestep->mutable_data<int32_t>()[0] = t;
 }
 
 std::map<string, string> GetRecurrentMapping(
@@ -181,7 +184,8 @@ class RecurrentNetworkOp final : public Operator<Context> {
             false)),
         timestep_(OperatorBase::template GetSingleArgument<std::string>(
             "timestep",
-            "timestep")) {
+            "timestep")),
+        timestepId_(Workspace::InternBlobName(timestep_)) {
     CAFFE_ENFORCE(ws);
 
     stepNetDef_ = detail::extractNetDef(operator_def, "step_net");
@@ -357,7 +361,7 @@ class RecurrentNetworkOp final : public Operator<Context> {
             t, currentStepWorkspace.get(), this->observers_list_);
       } else {
         // Use plain Caffe2 nets
-        detail::UpdateTimestepBlob(currentStepWorkspace.get(), timestep_, t);
+        detail::UpdateTimestepBlob(currentStepWorkspace.get(), timestepId_, t);
         auto* stepNet = currentStepWorkspace->GetNet(stepNetDef_.name());
         if (stepNet == nullptr) {
           stepNet = currentStepWorkspace->CreateNet(stepNetDef_);
@@ -393,6 +397,7 @@ class RecurrentNetworkOp final : public Operator<Context> {
   std::vector<detail::OffsetAlias> aliases_;
   std::vector<detail::RecurrentInput> recurrentInputs_;
   std::string timestep_;
+  int timestepId_;
 };
 
 template <class Context>
@@ -1,7 +1,7 @@
 // Copyright 2004-present Facebook. All Rights Reserved.
 
-#ifndef ROI_ALIGN_OP_H_
-#define ROI_ALIGN_OP_H_
+#ifndef ROI_ALIGN_GRADIENT_OP_H_
+#define ROI_ALIGN_GRADIENT_OP_H_
 
 #include "caffe2/core/context.h"
 #include "caffe2/core/logging.h"
@@ -40,4 +40,4 @@ class RoIAlignGradientOp final : public Operator<Context> {
 
 } // namespace caffe2
 
-#endif // ROI_ALIGN_OP_H_
+#endif // ROI_ALIGN_GRADIENT_OP_H_
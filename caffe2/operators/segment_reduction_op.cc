@@ -54,6 +54,30 @@ REGISTER_CPU_OPERATOR(
         SumReducerDef::template ReducerGradient<float, CPUContext>,
         true /*GradientNeedIndices*/>);
 
+OPERATOR_SCHEMA(SparseLengthsSumDedupGradient)
+    .NumInputs(3)
+    .NumOutputs(2)
+    .SetDoc(R"DOC(
+Gradient of SparseLengthsSum with respect to DATA, as a sparse gradient
+without duplicate indices. Where SparseLengthsIndicesInGradientSumGradient
+outputs one gradient row per entry of INDICES, this op sums the rows of the
+entries with the same index, so that UNIQUE_INDICES and GRAD can be given to a
+sparse optimizer (e.g. SparseAdagrad) directly, with no deduplication pass in
+between. The unique indices come out sorted in ascending order.
+)DOC")
+    .Input(0, "SEGMENT_GRADS", "Gradient of the output of SparseLengthsSum")
+    .Input(1, "LENGTHS", "Lengths input of SparseLengthsSum")
+    .Input(2, "INDICES", "Integer indices input of SparseLengthsSum")
+    .Output(0, "UNIQUE_INDICES", "Distinct values of INDICES, sorted")
+    .Output(
+        1,
+        "GRAD",
+        "Gradient of the rows of DATA at UNIQUE_INDICES, with the same inner "
+        "dims as SEGMENT_GRADS");
+REGISTER_CPU_OPERATOR(
+    SparseLengthsSumDedupGradient,
+    SparseLengthsSumDedupGradientOp<float, CPUContext>);
+
 namespace {
 
 template <typename Def>
@@ -6,6 +6,9 @@
 #include "caffe2/core/operator.h"
 #include "caffe2/operators/reducer_functors.h"
 
+#include <algorithm>
+#include <numeric>
+
 namespace caffe2 {
 
 template <typename TData>
@@ -2040,6 +2043,100 @@ i.e. `len(LENGTHS)`. Other dimensions are inherited from the input tensor.
       true /*SparseFused*/,
       GradientNeedIndices>;
 };
+
+// Gradient of SparseLengthsSum with respect to the rows of DATA it gathered,
+// with the lines of the same row summed: INDICES is sorted (stably) and each
+// run of equal indices reduced to one gradient row. The outputs are a sparse
+// gradient without duplicates, which the sparse optimizers take as is.
+template <typename T, class Context>
+class SparseLengthsSumDedupGradientOp : public Operator<Context> {
+ public:
+  USE_OPERATOR_CONTEXT_FUNCTIONS;
+  USE_SIMPLE_CTOR_DTOR(SparseLengthsSumDedupGradientOp);
+
+  bool RunOnDevice() override {
+    return DispatchHelper<TensorTypes<int32_t, int64_t>>::call(
+        this, Input(INDICES));
+  }
+
+  template <typename IndexType>
+  bool DoRunWithType() {
+    auto& segmentGradsInput = Input(SEGMENT_GRADS);
+    auto& lengthsInput = Input(LENGTHS);
+    auto& indicesInput = Input(INDICES);
+    auto* uniqueIndicesOutput = Output(UNIQUE_INDICES);
+    auto* dataGradsOutput = Output(DATA_GRADS);
+
+    CAFFE_ENFORCE_EQ(1, lengthsInput.ndim(), "LENGTHS must be a vector");
+    CAFFE_ENFORCE_EQ(1, indicesInput.ndim(), "INDICES must be a vector");
+    CAFFE_ENFORCE(segmentGradsInput.ndim() > 0);
+    const TIndex numSegments = lengthsInput.dim(0);
+    CAFFE_ENFORCE(numSegments == segmentGradsInput.dim(0));
+    const TIndex numIndices = indicesInput.dim(0);
+    const int* lengths = lengthsInput.template data<int>();
+    const IndexType* indices = indicesInput.template data<IndexType>();
+
+    segmentIds_.resize(numIndices);
+    TIndex line = 0;
+    for (TIndex i = 0; i < numSegments; ++i) {
+      CAFFE_ENFORCE_LE(
+          line + lengths[i],
+          numIndices,
+          "LENGTHS sum up to more than the size of INDICES");
+      for (int j = 0; j < lengths[i]; ++j) {
+        segmentIds_[line++] = i;
+      }
+    }
+    CAFFE_ENFORCE_EQ(
+        line, numIndices, "LENGTHS must sum up to the size of INDICES");
+
+    order_.resize(numIndices);
+    std::iota(order_.begin(), order_.end(), 0);
+    std::stable_sort(
+        order_.begin(), order_.end(), [indices](TIndex a, TIndex b) {
+          return indices[a] < indices[b];
+        });
+
+    TIndex numUnique = 0;
+    for (TIndex i = 0; i < numIndices; ++i) {
+      if (i == 0 || indices[order_[i]] != indices[order_[i - 1]]) {
+        ++numUnique;
+      }
+    }
+
+    auto shape = segmentGradsInput.dims();
+    shape[0] = numUnique;
+    uniqueIndicesOutput->Resize(numUnique);
+    dataGradsOutput->Resize(shape);
+    IndexType* uniqueIndices =
+        uniqueIndicesOutput->template mutable_data<IndexType>();
+    T* dataGrads = dataGradsOutput->template mutable_data<T>();
+    const T* segmentGrads = segmentGradsInput.template data<T>();
+    const TIndex blockSize = segmentGradsInput.size_from_dim(1);
+
+    math::Set<T, Context>(dataGradsOutput->size(), T(0), dataGrads, &context_);
+    TIndex row = -1;
+    for (TIndex i = 0; i < numIndices; ++i) {
+      if (i == 0 || indices[order_[i]] != indices[order_[i - 1]]) {
+        uniqueIndices[++row] = indices[order_[i]];
+      }
+      math::Axpy<T, Context>(
+          blockSize,
+          1.0f,
+          segmentGrads + segmentIds_[order_[i]] * blockSize,
+          dataGrads + row * blockSize,
+          &context_);
+    }
+    return true;
+  }
+
+  enum _InputTags { SEGMENT_GRADS, LENGTHS, INDICES };
+  enum _OutputTags { UNIQUE_INDICES, DATA_GRADS };
+
+ private:
+  vector<TIndex> segmentIds_;
+  vector<TIndex> order_;
+};
 } // namespace caffe2
 
 #endif // CAFFE2_OPERATORS_SEGMENT_REDUCTION_OP_H_
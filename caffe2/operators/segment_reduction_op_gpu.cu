@@ -1,5 +1,7 @@
 #include <cub/block/block_reduce.cuh>
+#include <cub/device/device_radix_sort.cuh>
 #include <cub/device/device_reduce.cuh>
+#include <cub/device/device_run_length_encode.cuh>
 #include <cub/device/device_scan.cuh>
 #include "caffe2/core/context_gpu.h"
 #include "caffe2/core/operator.h"
@@ -274,6 +276,29 @@ __global__ void sparse_length_sum_kernel(
   }
 }
 
+// Segment of each line, from the inclusive prefix sums of the lengths
+__global__ void length_segment_ids_kernel(
+    const int* __restrict__ prefix_sum_length_data,
+    int* __restrict__ segment_ids,
+    int len_length,
+    int len_indices) {
+  CUDA_1D_KERNEL_LOOP(line, len_indices) {
+    // first segment ending past line
+    int lo = 0;
+    int hi = len_length;
+    while (lo < hi) {
+      int mid = (lo + hi) / 2;
+      if (prefix_sum_length_data[mid] <= line) {
+        lo = mid + 1;
+      } else {
+        hi = mid;
+      }
+    }
+    CUDA_KERNEL_ASSERT(lo < len_length);
+    segment_ids[line] = lo;
+  }
+}
+
 template <typename T, typename IndexType, bool ExactBlock = false>
 __global__ void sparse_length_max_kernel(
     const T* __restrict__ in,
@@ -1564,6 +1589,208 @@ class CUDASparseLengthsIndicesInGradientWeightedSumWithMainInputGradientOp
   Tensor<Context> inclusive_scan_length_buffer_;
 };
 
+template <typename T, class Context = CUDAContext>
+class CUDASparseLengthsSumDedupGradientOp : public Operator<CUDAContext> {
+ public:
+  USE_OPERATOR_CONTEXT_FUNCTIONS;
+  CUDASparseLengthsSumDedupGradientOp(
+      const OperatorDef& operator_def,
+      Workspace* ws)
+      : Operator<CUDAContext>(operator_def, ws) {}
+
+  ~CUDASparseLengthsSumDedupGradientOp() {}
+
+  bool RunOnDevice() override {
+    return DispatchHelper<TensorTypes<int32_t, int64_t>>::call(this, Input(2));
+  }
+
+  template <typename IndexType>
+  bool DoRunWithType() {
+    auto& segmentGradsInput = Input(0);
+    auto& lengthsInput = Input(1);
+    auto& indicesInput = Input(2);
+    auto* uniqueIndicesOutput = Output(0);
+    auto* dataGradsOutput = Output(1);
+    CAFFE_ENFORCE_EQ(1, lengthsInput.ndim(), "LENGTHS must be a vector");
+    CAFFE_ENFORCE_EQ(1, indicesInput.ndim(), "INDICES must be a vector");
+
+    const int len_length = lengthsInput.dim(0);
+    const int len_indices = indicesInput.dim(0);
+    CAFFE_ENFORCE(segmentGradsInput.ndim() > 0);
+    CAFFE_ENFORCE(len_length == segmentGradsInput.dim(0));
+
+    auto shape = segmentGradsInput.dims();
+    if (len_length <= 0 || len_indices <= 0) {
+      // return early to avoid invalid empty kernel
+      shape[0] = 0;
+      uniqueIndicesOutput->Resize(0);
+      uniqueIndicesOutput->template mutable_data<IndexType>();
+      dataGradsOutput->Resize(shape);
+      dataGradsOutput->template mutable_data<T>();
+      return true;
+    }
+
+    inclusive_scan_length_buffer_.ResizeLike(lengthsInput);
+    inclusive_scan_wrapper(
+        lengthsInput.template data<int>(),
+        len_length,
+        &inclusive_scan_buffer_,
+        &inclusive_scan_length_buffer_,
+        &context_);
+
+    segment_ids_.Resize(len_indices);
+    length_segment_ids_kernel<<<
+        CAFFE_GET_BLOCKS(len_indices),
+        CAFFE_CUDA_NUM_THREADS,
+        0,
+        context_.cuda_stream()>>>(
+        inclusive_scan_length_buffer_.template data<int>(),
+        segment_ids_.template mutable_data<int>(),
+        len_length,
+        len_indices);
+
+    // Sort the lines by index, keeping their segments. The sort is stable, so
+    // the lines of a row are summed in their original order.
+    sorted_indices_.Resize(len_indices);
+    sorted_segment_ids_.Resize(len_indices);
+    unique_indices_.Resize(len_indices);
+    // run lengths, followed by the number of runs
+    run_lengths_.Resize(len_indices + 1);
+    const IndexType* indices = indicesInput.template data<IndexType>();
+    IndexType* sorted_indices =
+        sorted_indices_.template mutable_data<IndexType>();
+    IndexType* unique_indices =
+        unique_indices_.template mutable_data<IndexType>();
+    int* sorted_segment_ids = sorted_segment_ids_.template mutable_data<int>();
+    int* run_lengths = run_lengths_.template mutable_data<int>();
+    int* num_runs = run_lengths + len_indices;
+
+    size_t sort_bytes = 0;
+    cub::DeviceRadixSort::SortPairs(
+        nullptr,
+        sort_bytes,
+        indices,
+        sorted_indices,
+        segment_ids_.template data<int>(),
+        sorted_segment_ids,
+        len_indices,
+        0,
+        sizeof(IndexType) * 8,
+        context_.cuda_stream());
+    size_t encode_bytes = 0;
+    cub::DeviceRunLengthEncode::Encode(
+        nullptr,
+        encode_bytes,
+        sorted_indices,
+        unique_indices,
+        run_lengths,
+        num_runs,
+        len_indices,
+        context_.cuda_stream());
+    size_t temp_storage_bytes = std::max(sort_bytes, encode_bytes);
+    cub_buffer_.Resize(temp_storage_bytes);
+    void* d_temp_storage =
+        static_cast<void*>(cub_buffer_.template mutable_data<char>());
+
+    cub::DeviceRadixSort::SortPairs(
+        d_temp_storage,
+        sort_bytes,
+        indices,
+        sorted_indices,
+        segment_ids_.template data<int>(),
+        sorted_segment_ids,
+        len_indices,
+        0,
+        sizeof(IndexType) * 8,
+        context_.cuda_stream());
+    cub::DeviceRunLengthEncode::Encode(
+        d_temp_storage,
+        encode_bytes,
+        sorted_indices,
+        unique_indices,
+        run_lengths,
+        num_runs,
+        len_indices,
+        context_.cuda_stream());
+
+    int num_unique = 0;
+    context_.CopyBytes<CUDAContext, CPUContext>(
+        sizeof(int), num_runs, &num_unique);
+    context_.FinishDeviceComputation();
+
+    shape[0] = num_unique;
+    uniqueIndicesOutput->Resize(num_unique);
+    dataGradsOutput->Resize(shape);
+    context_.template CopyItems<CUDAContext, CUDAContext>(
+        unique_indices_.meta(),
+        num_unique,
+        unique_indices,
+        uniqueIndicesOutput->template mutable_data<IndexType>());
+
+    // Each run of equal indices is a segment of the sorted lines, which sums
+    // the gradients of the segments of SparseLengthsSum its lines were in
+    run_ends_.Resize(num_unique);
+    inclusive_scan_wrapper(
+        run_lengths,
+        num_unique,
+        &inclusive_scan_buffer_,
+        &run_ends_,
+        &context_);
+
+    const T* in_data = segmentGradsInput.template data<T>();
+    T* out_data = dataGradsOutput->template mutable_data<T>();
+    auto* prefix_sum_run_data = run_ends_.template data<int>();
+
+    int N = len_length;
+    int post = segmentGradsInput.size_from_dim(1);
+
+    auto maxThreads =
+        GetDeviceProperty(CaffeCudaGetDevice()).maxThreadsPerBlock;
+
+    if (post <= maxThreads) {
+      int multiple = std::min(maxThreads / post, 16);
+      dim3 block(post, multiple);
+      size_t smem = sizeof(T) * post * multiple;
+
+      sparse_length_sum_kernel<T, int, true>
+          <<<num_unique, block, smem, context_.cuda_stream()>>>(
+              in_data,
+              out_data,
+              prefix_sum_run_data,
+              sorted_segment_ids,
+              N,
+              post,
+              num_unique,
+              len_indices);
+    } else {
+      sparse_length_sum_kernel<T, int, false>
+          <<<num_unique, maxThreads, 0, context_.cuda_stream()>>>(
+              in_data,
+              out_data,
+              prefix_sum_run_data,
+              sorted_segment_ids,
+              N,
+              post,
+              num_unique,
+              len_indices);
+    }
+
+    return true;
+  }
+
+ private:
+  // menber field to manage memory
+  Tensor<Context> inclusive_scan_buffer_;
+  Tensor<Context> inclusive_scan_length_buffer_;
+  Tensor<Context> segment_ids_;
+  Tensor<Context> sorted_indices_;
+  Tensor<Context> sorted_segment_ids_;
+  Tensor<Context> unique_indices_;
+  Tensor<Context> run_lengths_;
+  Tensor<Context> run_ends_;
+  Tensor<Context> cub_buffer_;
+};
+
 // Needed because name is auto-generated in segment_reduction_op.cc:224
 REGISTER_CUDA_OPERATOR_STR(
     "LengthsMaxWithMainInputAndForwardOutputGradient",
@@ -1586,4 +1813,8 @@ REGISTER_CUDA_OPERATOR(
 REGISTER_CUDA_OPERATOR(
     LengthsIndicesInGradientSumGradient,
     CUDASparseLengthsSumGradientWithIndicesOp<float, CUDAContext>);
+
+REGISTER_CUDA_OPERATOR(
+    SparseLengthsSumDedupGradient,
+    CUDASparseLengthsSumDedupGradientOp<float, CUDAContext>);
 } // namespace caffe2
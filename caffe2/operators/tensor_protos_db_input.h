@@ -1,11 +1,14 @@
 #ifndef CAFFE2_OPERATORS_TENSOR_PROTOS_DB_INPUT_H_
 #define CAFFE2_OPERATORS_TENSOR_PROTOS_DB_INPUT_H_
 
+#include <exception>
 #include <iostream>
+#include <memory>
 #include <mutex>
 
 #include "caffe2/core/db.h"
 #include "caffe2/operators/prefetch_op.h"
+#include "caffe2/utils/thread_pool.h"
 
 namespace caffe2 {
 
@@ -23,12 +26,21 @@ class TensorProtosDBInput final : public PrefetchOperator<Context> {
   bool CopyPrefetched() override;
 
  private:
+  // Parses and deserializes the value of the item_id-th item of the batch,
+  // into its place in the prefetched blobs
+  void DecodeItem(int item_id);
+
   // Prefetch will always just happen on the CPU side.
   vector<Blob> prefetched_blobs_;
   int batch_size_;
-  bool shape_inferred_ = false;
   string key_;
   string value_;
+  // The values of the batch, decoded on num_decode_threads threads
+  vector<string> values_;
+  int num_decode_threads_;
+  std::unique_ptr<TaskThreadPool> thread_pool_;
+  std::mutex decode_mutex_;
+  std::exception_ptr decode_exception_;
 };
 
 template <class Context>
@@ -38,7 +50,15 @@ TensorProtosDBInput<Context>::TensorProtosDBInput(
     : PrefetchOperator<Context>(operator_def, ws),
       prefetched_blobs_(operator_def.output_size()),
       batch_size_(
-          OperatorBase::template GetSingleArgument<int>("batch_size", 0)) {}
+          OperatorBase::template GetSingleArgument<int>("batch_size", 0)),
+      num_decode_threads_(OperatorBase::template GetSingleArgument<int>(
+          "num_decode_threads",
+          1)) {
+  CAFFE_ENFORCE_GT(num_decode_threads_, 0);
+  if (num_decode_threads_ > 1 && batch_size_ > 1) {
+    thread_pool_.reset(new TaskThreadPool(num_decode_threads_));
+  }
+}
 
 template <class Context>
 bool TensorProtosDBInput<Context>::Prefetch() {
@@ -60,41 +80,74 @@ bool TensorProtosDBInput<Context>::Prefetch() {
           prefetched_blobs_[i].template GetMutable<TensorCPU>());
     }
   } else {
-    vector<TensorCPU> temp_tensors(OutputSize());
+    values_.resize(batch_size_);
     for (int item_id = 0; item_id < batch_size_; ++item_id) {
-      reader.Read(&key_, &value_);
-      TensorProtos protos;
-      CAFFE_ENFORCE(protos.ParseFromString(value_));
-      CAFFE_ENFORCE(protos.protos_size() == OutputSize());
-      if (!shape_inferred_) {
-        // First, set the shape of all the blobs.
-        for (int i = 0; i < protos.protos_size(); ++i) {
-          vector<int> dims(
-              protos.protos(i).dims().begin(), protos.protos(i).dims().end());
-          dims.insert(dims.begin(), batch_size_);
-          prefetched_blobs_[i].template GetMutable<TensorCPU>()->Resize(dims);
-        }
+      reader.Read(&key_, &values_[item_id]);
+    }
+    // The first item sets the shape of the blobs, so that the others can be
+    // decoded concurrently
+    DecodeItem(0);
+    if (!thread_pool_) {
+      for (int item_id = 1; item_id < batch_size_; ++item_id) {
+        DecodeItem(item_id);
       }
-      for (int i = 0; i < protos.protos_size(); ++i) {
-        TensorCPU* dst = prefetched_blobs_[i].template GetMutable<TensorCPU>();
-        TensorCPU& src = temp_tensors[i];
-        if (protos.protos(i).has_device_detail()) {
-          protos.mutable_protos(i)->clear_device_detail();
+      return true;
+    }
+    decode_exception_ = nullptr;
+    for (int item_id = 1; item_id < batch_size_; ++item_id) {
+      thread_pool_->runTask([this, item_id]() {
+        try {
+          DecodeItem(item_id);
+        } catch (...) {
+          std::lock_guard<std::mutex> lock(decode_mutex_);
+          decode_exception_ = std::current_exception();
         }
-        deserializer.Deserialize(protos.protos(i), &src);
-        DCHECK_EQ(src.size() * batch_size_, dst->size());
-        this->context_.template CopyItems<CPUContext, CPUContext>(
-            src.meta(),
-            src.size(),
-            src.raw_data(),
-            static_cast<char*>(dst->raw_mutable_data(src.meta())) +
-                src.nbytes() * item_id);
-      }
+      });
+    }
+    thread_pool_->waitWorkComplete();
+    if (decode_exception_) {
+      std::rethrow_exception(decode_exception_);
     }
   }
   return true;
 }
 
+template <class Context>
+void TensorProtosDBInput<Context>::DecodeItem(int item_id) {
+  TensorProtos protos;
+  CAFFE_ENFORCE(protos.ParseFromString(values_[item_id]));
+  CAFFE_ENFORCE(protos.protos_size() == OutputSize());
+  if (item_id == 0) {
+    // First, set the shape of all the blobs.
+    for (int i = 0; i < protos.protos_size(); ++i) {
+      vector<int> dims(
+          protos.protos(i).dims().begin(), protos.protos(i).dims().end());
+      dims.insert(dims.begin(), batch_size_);
+      prefetched_blobs_[i].template GetMutable<TensorCPU>()->Resize(dims);
+    }
+  }
+  TensorDeserializer<CPUContext> deserializer;
+  CPUContext context;
+  TensorCPU src;
+  for (int i = 0; i < protos.protos_size(); ++i) {
+    TensorCPU* dst = prefetched_blobs_[i].template GetMutable<TensorCPU>();
+    if (protos.protos(i).has_device_detail()) {
+      protos.mutable_protos(i)->clear_device_detail();
+    }
+    deserializer.Deserialize(protos.protos(i), &src);
+    CAFFE_ENFORCE_EQ(
+        src.size() * batch_size_,
+        dst->size(),
+        "The tensors of the records differ in size");
+    context.template CopyItems<CPUContext, CPUContext>(
+        src.meta(),
+        src.size(),
+        src.raw_data(),
+        static_cast<char*>(dst->raw_mutable_data(src.meta())) +
+            src.nbytes() * item_id);
+  }
+}
+
 template <class Context>
 bool TensorProtosDBInput<Context>::CopyPrefetched() {
   for (int i = 0; i < OutputSize(); ++i) {
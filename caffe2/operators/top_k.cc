@@ -13,6 +13,24 @@ namespace caffe2 {
 
 namespace {
 
+// Rows of contiguous candidates are scanned in blocks of this many, which
+// are skipped when none of them beats the k-th largest value so far
+constexpr TIndex kTopKBlockSize = 16;
+
+// Inputs smaller than this are not worth splitting across threads
+constexpr TIndex kTopKParallelThreshold = 1 << 15;
+
+// Whether any of x[0..kTopKBlockSize) is greater than threshold. There is no
+// early exit and no data-dependent branch, so the loop vectorizes.
+template <typename T>
+inline bool AnyGreater(const T* x, const T threshold) {
+  int any = 0;
+  for (TIndex i = 0; i < kTopKBlockSize; ++i) {
+    any |= x[i] > threshold;
+  }
+  return any != 0;
+}
+
 template <typename T>
 struct ValueComp {
   bool operator()(
@@ -46,7 +64,23 @@ void GetTopK(
       std::vector<std::pair<T, TIndex>>,
       ValueComp<T>>
       pq(ValueComp<T>(), std::move(heap_data));
-  for (TIndex i = k; i < n; ++i) {
+  TIndex i = k;
+  if (stride == 1) {
+    for (; i + kTopKBlockSize <= n; i += kTopKBlockSize) {
+      if (!AnyGreater(src_ptr, pq.top().first)) {
+        src_ptr += kTopKBlockSize;
+        continue;
+      }
+      for (TIndex j = 0; j < kTopKBlockSize; ++j) {
+        if (pq.top().first < *src_ptr) {
+          pq.pop();
+          pq.emplace(*src_ptr, i + j);
+        }
+        ++src_ptr;
+      }
+    }
+  }
+  for (; i < n; ++i) {
     if (pq.top().first < *src_ptr) {
       pq.pop();
       pq.emplace(*src_ptr, i);
@@ -66,6 +100,50 @@ void GetTopK(
   }
 }
 
+// GetTopK for k = 1, without the heap. Ties go to the first index, as there.
+template <typename T>
+void GetArgMax(
+    const T* input,
+    const TIndex n,
+    const TIndex src_offset,
+    const TIndex dst_offset,
+    const TIndex stride,
+    T* values,
+    TIndex* indices,
+    TIndex* flatten_indices) {
+  if (n == 0) {
+    return;
+  }
+  const T* src_ptr = input + src_offset;
+  T best = src_ptr[0];
+  TIndex best_index = 0;
+  TIndex i = 1;
+  if (stride == 1) {
+    for (; i + kTopKBlockSize <= n; i += kTopKBlockSize) {
+      if (!AnyGreater(src_ptr + i, best)) {
+        continue;
+      }
+      for (TIndex j = i; j < i + kTopKBlockSize; ++j) {
+        if (best < src_ptr[j]) {
+          best = src_ptr[j];
+          best_index = j;
+        }
+      }
+    }
+  }
+  for (; i < n; ++i) {
+    if (best < src_ptr[i * stride]) {
+      best = src_ptr[i * stride];
+      best_index = i;
+    }
+  }
+  values[dst_offset] = best;
+  indices[dst_offset] = best_index;
+  if (flatten_indices != nullptr) {
+    flatten_indices[dst_offset] = src_offset + best_index * stride;
+  }
+}
+
 template <typename T>
 void SetTopKGradient(
     const T* values,
@@ -135,23 +213,40 @@ bool TopKOp<T, Context>::RunOnDevice() {
       std::multiplies<TIndex>());
   const TIndex src_offset_stride = input_dims[axis_] * next_size;
   const TIndex dst_offset_stride = k_ * next_size;
-  TIndex src_offset = 0;
-  TIndex dst_offset = 0;
-  for (TIndex i = 0; i < prev_size; ++i) {
-    for (TIndex j = 0; j < next_size; ++j) {
+  const TIndex num_rows = prev_size * next_size;
+  const TIndex n = input_dims[axis_];
+  const TIndex k = k_;
+  // Every row writes its own slice of the outputs
+#ifdef _OPENMP
+#pragma omp parallel for if (num_rows > 1 && input.size() >= kTopKParallelThreshold)
+#endif // _OPENMP
+  for (TIndex row = 0; row < num_rows; ++row) {
+    const TIndex i = row / next_size;
+    const TIndex j = row % next_size;
+    const TIndex src_offset = i * src_offset_stride + j;
+    const TIndex dst_offset = i * dst_offset_stride + j;
+    if (k == 1) {
+      GetArgMax(
+          input_data,
+          n,
+          src_offset,
+          dst_offset,
+          next_size,
+          values_data,
+          indices_data,
+          flatten_indices_data);
+    } else {
       GetTopK(
           input_data,
-          input_dims[axis_],
-          k_,
-          src_offset + j,
-          dst_offset + j,
+          n,
+          k,
+          src_offset,
+          dst_offset,
           next_size,
           values_data,
           indices_data,
           flatten_indices_data);
     }
-    src_offset += src_offset_stride;
-    dst_offset += dst_offset_stride;
   }
   return true;
 }
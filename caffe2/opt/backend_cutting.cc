@@ -222,10 +222,16 @@ void DetectBoundaryReferences(
       }
     }
 
-    // outputs
+    // outputs, including the ones without consumers, which are the outputs of
+    // the whole net
     if (!nn::is<NeuralNetData>(node)) {
       continue;
     }
+    if (!nn::hasConsumer(node)) {
+      const auto* nn_tensor = nn::get<const NeuralNetData>(node);
+      subgraph->external_output_refs.emplace(nn_tensor->getName(), node);
+      continue;
+    }
     for (auto child_node : nn::getConsumers(node)) {
       const auto& info = infos.at(child_node);
       if (info.group != subgraph->group_id) {
@@ -64,6 +64,27 @@ TEST(BackendCuttingTest, line) {
   EXPECT_EQ(3, net_opt.op_size());
 }
 
+// X -> CopyIn -> MyConv -> MyConv -> N2
+TEST(BackendCuttingTest, supportedOutput) {
+  caffe2::NetDef net;
+  net.add_external_input("X");
+  net.add_external_output("N2");
+  auto* op = net.add_op();
+  op->set_type("CopyIn");
+  op->add_input("X");
+  op->add_output("N0");
+  for (int i = 0; i < 2; ++i) {
+    AddConv(&net, i);
+  }
+
+  auto net_opt = caffe2::opt::OptimizeForBackend(net, Supports, Transform);
+  ASSERT_EQ(2, net_opt.op_size());
+  const auto& big = net_opt.op(1);
+  EXPECT_EQ("BigOpt", big.type());
+  ASSERT_EQ(1, big.output_size());
+  EXPECT_EQ("N2", big.output(0));
+}
+
 //  X0 -> CopyIn -> MyConv -\
 //                           > Concat -> CopyOut -> Y
 //  N2 -> MyConv -> MyRelu -/ 
@@ -21,6 +21,7 @@
 #include "caffe2/core/workspace.h"
 #include "caffe2/proto/caffe2.pb.h"
 #include "nomnigraph/Representations/NeuralNet.h"
+#include "nomnigraph/Transformations/Match.h"
 
 namespace caffe2 {
 namespace opt {
@@ -43,6 +44,8 @@ void fuseActivation(
     repr::NNModule* nn,
     std::function<bool(const OperationT& conv)> should_fuse,
     std::function<void(repr::NNGraph::NodeRef conv_node)> postprocess) {
+  // Find all fusible pairs in one sweep, then rewrite them as a batch
+  std::vector<repr::NNSubgraph> matches;
   for (auto node_pair : repr::nn::dataIterator<OperationT>(nn->dataFlow)) {
     repr::NNGraph::NodeRef conv_node;
     OperationT* conv;
@@ -74,48 +77,72 @@ void fuseActivation(
       continue;
     }
 
-    // Ready to fuse
-    auto relu_output = relu_outputs.front();
-    auto output_tensor = repr::nn::get<repr::Tensor>(relu_output);
-    auto output_node = relu_output;
-    auto input_tensor =
-        repr::nn::get<repr::Tensor>(repr::nn::getInputs(conv_node).front());
-
-    // Conv cannot be in-place
-    if (output_tensor->getName() != input_tensor->getName()) {
-      nn->dataFlow.replaceNode(conv_output, relu_output);
-      nn->dataFlow.deleteNode(relu_node);
-      nn->dataFlow.deleteNode(conv_output);
-    } else {
-      nn->dataFlow.replaceNode(relu_output, conv_output);
-      output_tensor = repr::nn::get<repr::Tensor>(conv_output);
-      output_node = conv_output;
-      nn->dataFlow.deleteNode(relu_node);
-      nn->dataFlow.deleteNode(relu_output);
-    }
+    repr::NNSubgraph match;
+    match.addNode(conv_node);
+    match.addNode(conv_output);
+    match.addNode(relu_node);
+    match.addNode(relu_outputs.front());
+    matches.emplace_back(std::move(match));
+  }
 
-    // We may have accidentally made the next op in-place
-    // In future iterations of transformations this won't be an issue,
-    // but current caffe2 predictor usage requires things like
-    // external_input and output to be unchanged.
-    bool rectify_inplace = false;
-    for (auto& consumer : repr::nn::getConsumers(output_node)) {
-      for (auto& consumer_output : repr::nn::getOutputs(consumer)) {
-        auto co_name = repr::nn::get<repr::Tensor>(consumer_output)->getName();
-        if (co_name == output_tensor->getName()) {
-          rectify_inplace = true;
+  nom::rewriteMatches<repr::NNGraph>(
+      matches, [nn, &postprocess](const repr::NNSubgraph& match) {
+        repr::NNGraph::NodeRef conv_node = nullptr;
+        for (auto node : match.getNodes()) {
+          if (repr::nn::is<OperationT>(node)) {
+            conv_node = node;
+          }
+        }
+        if (!conv_node) {
+          return false;
+        }
+        auto conv_output = repr::nn::getOutputs(conv_node).front();
+        auto relu_node = repr::nn::getConsumers(conv_output).front();
+        auto relu_output = repr::nn::getOutputs(relu_node).front();
+
+        // Ready to fuse
+        auto output_tensor = repr::nn::get<repr::Tensor>(relu_output);
+        auto output_node = relu_output;
+        auto input_tensor = repr::nn::get<repr::Tensor>(
+            repr::nn::getInputs(conv_node).front());
+
+        // Conv cannot be in-place
+        if (output_tensor->getName() != input_tensor->getName()) {
+          nn->dataFlow.replaceNode(conv_output, relu_output);
+          nn->dataFlow.deleteNode(relu_node);
+          nn->dataFlow.deleteNode(conv_output);
+        } else {
+          nn->dataFlow.replaceNode(relu_output, conv_output);
+          output_tensor = repr::nn::get<repr::Tensor>(conv_output);
+          output_node = conv_output;
+          nn->dataFlow.deleteNode(relu_node);
+          nn->dataFlow.deleteNode(relu_output);
         }
-      }
-    }
-    if (rectify_inplace) {
-      auto new_output = nn->dataFlow.createNode(
-          make_unique<repr::Tensor>(output_tensor->getName() + "_fusion_fix"));
-      nn->dataFlow.replaceNode(output_node, new_output);
-    }
 
-    // Application specific logic for postprocessing the conv node
-    postprocess(conv_node);
-  }
+        // We may have accidentally made the next op in-place
+        // In future iterations of transformations this won't be an issue,
+        // but current caffe2 predictor usage requires things like
+        // external_input and output to be unchanged.
+        bool rectify_inplace = false;
+        for (auto& consumer : repr::nn::getConsumers(output_node)) {
+          for (auto& consumer_output : repr::nn::getOutputs(consumer)) {
+            auto co_name =
+                repr::nn::get<repr::Tensor>(consumer_output)->getName();
+            if (co_name == output_tensor->getName()) {
+              rectify_inplace = true;
+            }
+          }
+        }
+        if (rectify_inplace) {
+          auto new_output = nn->dataFlow.createNode(make_unique<repr::Tensor>(
+              output_tensor->getName() + "_fusion_fix"));
+          nn->dataFlow.replaceNode(output_node, new_output);
+        }
+
+        // Application specific logic for postprocessing the conv node
+        postprocess(conv_node);
+        return true;
+      });
 }
 
 } // namespace opt
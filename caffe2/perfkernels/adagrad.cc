@@ -0,0 +1,168 @@
+#include "caffe2/perfkernels/adagrad.h"
+
+#include <cmath>
+
+#include "caffe2/core/types.h"
+#include "caffe2/perfkernels/common.h"
+#include "caffe2/utils/conversions.h"
+#include "caffe2/utils/cpuid.h"
+
+namespace caffe2 {
+
+template <typename IndexType, typename ParamType>
+static void SparseAdagradGenericSlow(
+    const TIndex block_size,
+    const TIndex num_rows,
+    const IndexType* indices,
+    const float* grad,
+    ParamType* param,
+    ParamType* moment,
+    float epsilon,
+    float lr) {
+  for (TIndex i = 0; i < num_rows; ++i) {
+    TIndex offset = indices[i] * block_size;
+#ifdef __GNUC__
+    if (i + 1 < num_rows) {
+      __builtin_prefetch(param + indices[i + 1] * block_size, 1, 1);
+      __builtin_prefetch(moment + indices[i + 1] * block_size, 1, 1);
+    }
+#endif // __GNUC__
+    for (TIndex k = 0; k < block_size; ++k) {
+      float g = grad[i * block_size + k];
+      float h = convert::To<ParamType, float>(moment[offset + k]) + g * g;
+      float w = convert::To<ParamType, float>(param[offset + k]) +
+          lr * g / (std::sqrt(h) + epsilon);
+      moment[offset + k] = convert::To<float, ParamType>(h);
+      param[offset + k] = convert::To<float, ParamType>(w);
+    }
+  }
+}
+
+template <typename IndexType, typename ParamType>
+static void RowWiseSparseAdagradGenericSlow(
+    const TIndex block_size,
+    const TIndex num_rows,
+    const IndexType* indices,
+    const float* grad,
+    ParamType* param,
+    float* moment,
+    float epsilon,
+    float lr) {
+  for (TIndex i = 0; i < num_rows; ++i) {
+    const float* g = grad + i * block_size;
+    ParamType* w = param + indices[i] * block_size;
+#ifdef __GNUC__
+    if (i + 1 < num_rows) {
+      __builtin_prefetch(param + indices[i + 1] * block_size, 1, 1);
+    }
+#endif // __GNUC__
+    float hs = 0.;
+    for (TIndex k = 0; k < block_size; ++k) {
+      hs += g[k] * g[k];
+    }
+    float h = moment[indices[i]] += hs / block_size;
+    float step = lr / (std::sqrt(h) + epsilon);
+    for (TIndex k = 0; k < block_size; ++k) {
+      w[k] = convert::To<float, ParamType>(
+          convert::To<ParamType, float>(w[k]) + g[k] * step);
+    }
+  }
+}
+
+// Proxy back to generic implementation
+#define ADAGRAD_SPECIALIZATION(IndexType, ParamType)                      \
+  void SparseAdagrad_##IndexType##_##ParamType##__base(                   \
+      const TIndex block_size,                                            \
+      const TIndex num_rows,                                              \
+      const IndexType* indices,                                           \
+      const float* grad,                                                  \
+      ParamType* param,                                                   \
+      ParamType* moment,                                                  \
+      float epsilon,                                                      \
+      float lr) {                                                         \
+    SparseAdagradGenericSlow<IndexType, ParamType>(                       \
+        block_size, num_rows, indices, grad, param, moment, epsilon, lr); \
+  }                                                                       \
+  template <>                                                             \
+  void SparseAdagrad<IndexType, ParamType>(                               \
+      const TIndex block_size,                                            \
+      const TIndex num_rows,                                              \
+      const IndexType* indices,                                           \
+      const float* grad,                                                  \
+      ParamType* param,                                                   \
+      ParamType* moment,                                                  \
+      float epsilon,                                                      \
+      float lr) {                                                         \
+    AVX2_FMA_DO(                                                          \
+        SparseAdagrad_##IndexType##_##ParamType,                          \
+        block_size,                                                       \
+        num_rows,                                                         \
+        indices,                                                          \
+        grad,                                                             \
+        param,                                                            \
+        moment,                                                           \
+        epsilon,                                                          \
+        lr);                                                              \
+    BASE_DO(                                                              \
+        SparseAdagrad_##IndexType##_##ParamType,                          \
+        block_size,                                                       \
+        num_rows,                                                         \
+        indices,                                                          \
+        grad,                                                             \
+        param,                                                            \
+        moment,                                                           \
+        epsilon,                                                          \
+        lr);                                                              \
+  }                                                                       \
+  void RowWiseSparseAdagrad_##IndexType##_##ParamType##__base(            \
+      const TIndex block_size,                                            \
+      const TIndex num_rows,                                              \
+      const IndexType* indices,                                           \
+      const float* grad,                                                  \
+      ParamType* param,                                                   \
+      float* moment,                                                      \
+      float epsilon,                                                      \
+      float lr) {                                                         \
+    RowWiseSparseAdagradGenericSlow<IndexType, ParamType>(                \
+        block_size, num_rows, indices, grad, param, moment, epsilon, lr); \
+  }                                                                       \
+  template <>                                                             \
+  void RowWiseSparseAdagrad<IndexType, ParamType>(                        \
+      const TIndex block_size,                                            \
+      const TIndex num_rows,                                              \
+      const IndexType* indices,                                           \
+      const float* grad,                                                  \
+      ParamType* param,                                                   \
+      float* moment,                                                      \
+      float epsilon,                                                      \
+      float lr) {                                                         \
+    AVX2_FMA_DO(                                                          \
+        RowWiseSparseAdagrad_##IndexType##_##ParamType,                   \
+        block_size,                                                       \
+        num_rows,                                                         \
+        indices,                                                          \
+        grad,                                                             \
+        param,                                                            \
+        moment,                                                           \
+        epsilon,                                                          \
+        lr);                                                              \
+    BASE_DO(                                                              \
+        RowWiseSparseAdagrad_##IndexType##_##ParamType,                   \
+        block_size,                                                       \
+        num_rows,                                                         \
+        indices,                                                          \
+        grad,                                                             \
+        param,                                                            \
+        moment,                                                           \
+        epsilon,                                                          \
+        lr);                                                              \
+  }
+
+ADAGRAD_SPECIALIZATION(int32_t, float);
+ADAGRAD_SPECIALIZATION(int64_t, float);
+ADAGRAD_SPECIALIZATION(int32_t, float16);
+ADAGRAD_SPECIALIZATION(int64_t, float16);
+
+#undef ADAGRAD_SPECIALIZATION
+
+} // namespace caffe2
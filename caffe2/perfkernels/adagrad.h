@@ -0,0 +1,58 @@
+#pragma once
+
+#include "caffe2/core/common.h"
+
+namespace caffe2 {
+
+/**
+ * Sparse Adagrad update, in place.
+ *
+ * `indices` of size num_rows
+ * `grad` of size num_rows * block_size
+ * `param` and `moment` of size (max(indices) + 1) * block_size
+ *
+ * Behavior is roughly equivalent to pseudocode:
+ *
+ * for (i = 0..num_rows-1)
+ *   for (k = 0..block_size-1)
+ *     g = grad[i*block_size + k]
+ *     h = moment[indices[i]*block_size + k] += g * g
+ *     param[indices[i]*block_size + k] += lr * g / (sqrt(h) + epsilon)
+ *
+ * float16 param and moment are computed on in float. The rows of the next
+ * indices are prefetched.
+ */
+template <typename IndexType, typename ParamType>
+void SparseAdagrad(
+    const TIndex block_size,
+    const TIndex num_rows,
+    const IndexType* indices,
+    const float* grad,
+    ParamType* param,
+    ParamType* moment,
+    float epsilon,
+    float lr);
+
+/**
+ * Row-wise sparse Adagrad update, in place, where `moment` holds one value per
+ * row of `param`:
+ *
+ * for (i = 0..num_rows-1)
+ *   h = moment[indices[i]] +=
+ *       sum(grad[i*block_size + k]^2 for k = 0..block_size-1) / block_size
+ *   for (k = 0..block_size-1)
+ *     param[indices[i]*block_size + k] +=
+ *         lr / (sqrt(h) + epsilon) * grad[i*block_size + k]
+ */
+template <typename IndexType, typename ParamType>
+void RowWiseSparseAdagrad(
+    const TIndex block_size,
+    const TIndex num_rows,
+    const IndexType* indices,
+    const float* grad,
+    ParamType* param,
+    float* moment,
+    float epsilon,
+    float lr);
+
+} // namespace caffe2
@@ -0,0 +1,183 @@
+#include "caffe2/core/types.h"
+#include "caffe2/perfkernels/cvtsh_ss_bugfix.h"
+
+#include <cmath>
+
+#include <emmintrin.h>
+#include <immintrin.h>
+
+namespace caffe2 {
+
+namespace {
+
+// Rows this many indices ahead are prefetched
+const TIndex kPrefetchDistance = 16;
+
+inline __m256 Load(const float* x) {
+  return _mm256_loadu_ps(x);
+}
+
+inline __m256 Load(const float16* x) {
+  return _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(x)));
+}
+
+inline void Store(float* x, __m256 v) {
+  _mm256_storeu_ps(x, v);
+}
+
+inline void Store(float16* x, __m256 v) {
+  _mm_storeu_si128(
+      reinterpret_cast<__m128i*>(x),
+      _mm256_cvtps_ph(v, _MM_FROUND_TO_NEAREST_INT));
+}
+
+inline float LoadScalar(const float* x) {
+  return *x;
+}
+
+inline float LoadScalar(const float16* x) {
+  return _cvtsh_ss(x->x);
+}
+
+inline void StoreScalar(float* x, float v) {
+  *x = v;
+}
+
+inline void StoreScalar(float16* x, float v) {
+  x->x = _cvtss_sh(v, _MM_FROUND_TO_NEAREST_INT);
+}
+
+// Prefetches the row of block_size elements at row for writing
+template <typename T>
+inline void PrefetchRow(const T* row, TIndex block_size) {
+  const char* p = reinterpret_cast<const char*>(row);
+  const char* end = reinterpret_cast<const char*>(row + block_size);
+  for (; p < end; p += 64) {
+    _mm_prefetch(p, _MM_HINT_T0);
+  }
+}
+
+template <typename IndexType, typename ParamType>
+void SparseAdagradImpl(
+    const TIndex block_size,
+    const TIndex num_rows,
+    const IndexType* indices,
+    const float* grad,
+    ParamType* param,
+    ParamType* moment,
+    float epsilon,
+    float lr) {
+  const __m256 lr_v = _mm256_set1_ps(lr);
+  const __m256 epsilon_v = _mm256_set1_ps(epsilon);
+  for (TIndex i = 0; i < num_rows; ++i) {
+    if (i + kPrefetchDistance < num_rows) {
+      TIndex next = indices[i + kPrefetchDistance] * block_size;
+      PrefetchRow(param + next, block_size);
+      PrefetchRow(moment + next, block_size);
+    }
+    const float* g = grad + i * block_size;
+    ParamType* w = param + indices[i] * block_size;
+    ParamType* h = moment + indices[i] * block_size;
+    TIndex k = 0;
+    for (; k + 8 <= block_size; k += 8) {
+      __m256 g_v = _mm256_loadu_ps(g + k);
+      __m256 h_v = _mm256_fmadd_ps(g_v, g_v, Load(h + k));
+      Store(h + k, h_v);
+      __m256 step = _mm256_div_ps(
+          _mm256_mul_ps(lr_v, g_v),
+          _mm256_add_ps(_mm256_sqrt_ps(h_v), epsilon_v));
+      Store(w + k, _mm256_add_ps(Load(w + k), step));
+    }
+    for (; k < block_size; ++k) {
+      float h_k = LoadScalar(h + k) + g[k] * g[k];
+      StoreScalar(h + k, h_k);
+      StoreScalar(
+          w + k, LoadScalar(w + k) + lr * g[k] / (std::sqrt(h_k) + epsilon));
+    }
+  }
+}
+
+template <typename IndexType, typename ParamType>
+void RowWiseSparseAdagradImpl(
+    const TIndex block_size,
+    const TIndex num_rows,
+    const IndexType* indices,
+    const float* grad,
+    ParamType* param,
+    float* moment,
+    float epsilon,
+    float lr) {
+  for (TIndex i = 0; i < num_rows; ++i) {
+    if (i + kPrefetchDistance < num_rows) {
+      IndexType next = indices[i + kPrefetchDistance];
+      PrefetchRow(param + next * block_size, block_size);
+      _mm_prefetch(reinterpret_cast<const char*>(moment + next), _MM_HINT_T0);
+    }
+    const float* g = grad + i * block_size;
+    ParamType* w = param + indices[i] * block_size;
+
+    __m256 hs_v = _mm256_setzero_ps();
+    TIndex k = 0;
+    for (; k + 8 <= block_size; k += 8) {
+      __m256 g_v = _mm256_loadu_ps(g + k);
+      hs_v = _mm256_fmadd_ps(g_v, g_v, hs_v);
+    }
+    alignas(32) float hs_lanes[8];
+    _mm256_store_ps(hs_lanes, hs_v);
+    float hs = 0.;
+    for (int j = 0; j < 8; ++j) {
+      hs += hs_lanes[j];
+    }
+    for (; k < block_size; ++k) {
+      hs += g[k] * g[k];
+    }
+
+    float h = moment[indices[i]] += hs / block_size;
+    float step = lr / (std::sqrt(h) + epsilon);
+    const __m256 step_v = _mm256_set1_ps(step);
+    for (k = 0; k + 8 <= block_size; k += 8) {
+      Store(
+          w + k, _mm256_fmadd_ps(_mm256_loadu_ps(g + k), step_v, Load(w + k)));
+    }
+    for (; k < block_size; ++k) {
+      StoreScalar(w + k, LoadScalar(w + k) + g[k] * step);
+    }
+  }
+}
+
+} // namespace
+
+#define ADAGRAD_SPECIALIZATION(IndexType, ParamType)                      \
+  void SparseAdagrad_##IndexType##_##ParamType##__avx2_fma(               \
+      const TIndex block_size,                                            \
+      const TIndex num_rows,                                              \
+      const IndexType* indices,                                           \
+      const float* grad,                                                  \
+      ParamType* param,                                                   \
+      ParamType* moment,                                                  \
+      float epsilon,                                                      \
+      float lr) {                                                         \
+    SparseAdagradImpl<IndexType, ParamType>(                              \
+        block_size, num_rows, indices, grad, param, moment, epsilon, lr); \
+  }                                                                       \
+  void RowWiseSparseAdagrad_##IndexType##_##ParamType##__avx2_fma(        \
+      const TIndex block_size,                                            \
+      const TIndex num_rows,                                              \
+      const IndexType* indices,                                           \
+      const float* grad,                                                  \
+      ParamType* param,                                                   \
+      float* moment,                                                      \
+      float epsilon,                                                      \
+      float lr) {                                                         \
+    RowWiseSparseAdagradImpl<IndexType, ParamType>(                       \
+        block_size, num_rows, indices, grad, param, moment, epsilon, lr); \
+  }
+
+ADAGRAD_SPECIALIZATION(int32_t, float);
+ADAGRAD_SPECIALIZATION(int64_t, float);
+ADAGRAD_SPECIALIZATION(int32_t, float16);
+ADAGRAD_SPECIALIZATION(int64_t, float16);
+
+#undef ADAGRAD_SPECIALIZATION
+
+} // namespace caffe2
@@ -0,0 +1,69 @@
+#include "caffe2/perfkernels/transpose.h"
+
+#include <algorithm>
+#include <cstdint>
+
+#include "caffe2/core/types.h"
+#include "caffe2/perfkernels/common.h"
+#include "caffe2/utils/cpuid.h"
+
+namespace caffe2 {
+
+namespace {
+
+// A tile of 32 x 32 elements of X and of Y stays in the L1 cache
+constexpr int kTransposeTile = 32;
+
+template <typename T>
+void BatchedTranspose2DImpl(int N, int M, int K, const T* X, T* Y) {
+  for (int n = 0; n < N; ++n) {
+    const T* X_n = X + n * M * K;
+    T* Y_n = Y + n * M * K;
+    for (int i = 0; i < M; i += kTransposeTile) {
+      const int i_end = std::min(i + kTransposeTile, M);
+      for (int j = 0; j < K; j += kTransposeTile) {
+        const int j_end = std::min(j + kTransposeTile, K);
+        for (int ii = i; ii < i_end; ++ii) {
+          for (int jj = j; jj < j_end; ++jj) {
+            Y_n[jj * M + ii] = X_n[ii * K + jj];
+          }
+        }
+      }
+    }
+  }
+}
+
+} // namespace
+
+void BatchedTranspose2D_float__base(
+    int N,
+    int M,
+    int K,
+    const float* X,
+    float* Y) {
+  BatchedTranspose2DImpl(N, M, K, X, Y);
+}
+
+template <>
+void BatchedTranspose2D<float>(int N, int M, int K, const float* X, float* Y) {
+  AVX2_DO(BatchedTranspose2D_float, N, M, K, X, Y);
+  BASE_DO(BatchedTranspose2D_float, N, M, K, X, Y);
+}
+
+#define CAFFE2_SPECIALIZED_BATCHED_TRANSPOSE_2D(T) \
+  template <>                                      \
+  void BatchedTranspose2D<T>(                      \
+      int N, int M, int K, const T* X, T* Y) {     \
+    BatchedTranspose2DImpl(N, M, K, X, Y);         \
+  }
+CAFFE2_SPECIALIZED_BATCHED_TRANSPOSE_2D(double)
+CAFFE2_SPECIALIZED_BATCHED_TRANSPOSE_2D(int)
+CAFFE2_SPECIALIZED_BATCHED_TRANSPOSE_2D(TIndex)
+#ifdef CAFFE2_UNIQUE_LONG_TYPEMETA
+CAFFE2_SPECIALIZED_BATCHED_TRANSPOSE_2D(long)
+#endif
+CAFFE2_SPECIALIZED_BATCHED_TRANSPOSE_2D(std::uint8_t)
+CAFFE2_SPECIALIZED_BATCHED_TRANSPOSE_2D(std::uint16_t)
+#undef CAFFE2_SPECIALIZED_BATCHED_TRANSPOSE_2D
+
+} // namespace caffe2
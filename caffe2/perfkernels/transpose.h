@@ -0,0 +1,10 @@
+#pragma once
+
+namespace caffe2 {
+
+// Transposes the N matrices of size M x K stored contiguously in X into the
+// K x M matrices of Y, i.e. Y[n] = X[n]^T, one cache-sized tile at a time.
+template <typename T>
+void BatchedTranspose2D(int N, int M, int K, const T* X, T* Y);
+
+} // namespace caffe2
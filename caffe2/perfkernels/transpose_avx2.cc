@@ -0,0 +1,74 @@
+#include <algorithm>
+
+#include <immintrin.h>
+
+namespace caffe2 {
+
+namespace {
+
+constexpr int kTransposeTile = 32;
+
+// Transposes the 8 x 8 block of X with leading dimension ldx into Y with
+// leading dimension ldy
+inline void Transpose8x8(const float* X, int ldx, float* Y, int ldy) {
+  __m256 r[8];
+  for (int i = 0; i < 8; ++i) {
+    r[i] = _mm256_loadu_ps(X + i * ldx);
+  }
+  __m256 t[8];
+  for (int i = 0; i < 8; i += 2) {
+    t[i] = _mm256_unpacklo_ps(r[i], r[i + 1]);
+    t[i + 1] = _mm256_unpackhi_ps(r[i], r[i + 1]);
+  }
+  __m256 s[8];
+  for (int i = 0; i < 8; i += 4) {
+    s[i] = _mm256_shuffle_ps(t[i], t[i + 2], _MM_SHUFFLE(1, 0, 1, 0));
+    s[i + 1] = _mm256_shuffle_ps(t[i], t[i + 2], _MM_SHUFFLE(3, 2, 3, 2));
+    s[i + 2] = _mm256_shuffle_ps(t[i + 1], t[i + 3], _MM_SHUFFLE(1, 0, 1, 0));
+    s[i + 3] = _mm256_shuffle_ps(t[i + 1], t[i + 3], _MM_SHUFFLE(3, 2, 3, 2));
+  }
+  for (int i = 0; i < 4; ++i) {
+    _mm256_storeu_ps(Y + i * ldy, _mm256_permute2f128_ps(s[i], s[i + 4], 0x20));
+    _mm256_storeu_ps(
+        Y + (i + 4) * ldy, _mm256_permute2f128_ps(s[i], s[i + 4], 0x31));
+  }
+}
+
+} // namespace
+
+void BatchedTranspose2D_float__avx2(
+    int N,
+    int M,
+    int K,
+    const float* X,
+    float* Y) {
+  for (int n = 0; n < N; ++n) {
+    const float* X_n = X + n * M * K;
+    float* Y_n = Y + n * M * K;
+    for (int i = 0; i < M; i += kTransposeTile) {
+      const int i_end = std::min(i + kTransposeTile, M);
+      for (int j = 0; j < K; j += kTransposeTile) {
+        const int j_end = std::min(j + kTransposeTile, K);
+        int ii = i;
+        for (; ii + 8 <= i_end; ii += 8) {
+          int jj = j;
+          for (; jj + 8 <= j_end; jj += 8) {
+            Transpose8x8(X_n + ii * K + jj, K, Y_n + jj * M + ii, M);
+          }
+          for (; jj < j_end; ++jj) {
+            for (int r = ii; r < ii + 8; ++r) {
+              Y_n[jj * M + r] = X_n[r * K + jj];
+            }
+          }
+        }
+        for (; ii < i_end; ++ii) {
+          for (int jj = j; jj < j_end; ++jj) {
+            Y_n[jj * M + ii] = X_n[ii * K + jj];
+          }
+        }
+      }
+    }
+  }
+}
+
+} // namespace caffe2
@@ -59,6 +59,7 @@ def Parallelize(
     shared_model=False,
     combine_spatial_bn=False,
     barrier_net_timeout_sec=_DEFAULT_BARRIER_NET_TIMEOUT_SEC,
+    allreduce_bucket_bytes=0,
 ):
     '''
     Function to create a model that can run on many GPUs or CPUs.
@@ -120,6 +121,13 @@ def Parallelize(
                         The timeout in seconds of the barrier net, which is run
                         to synchronize shards before a training epoch starts.
                         Defaults to 300 seconds.
+      allreduce_bucket_bytes:
+                        (distributed training with Gloo only) When positive,
+                        consecutive gradients of the same type are grouped
+                        into buckets of about this many bytes, each reduced
+                        by a single FusedAllreduce op that runs as soon as
+                        all of its gradients are computed. Defaults to 0,
+                        one Allreduce op per gradient.
     '''
     assert scope.CurrentDeviceScope() is None \
         or scope.CurrentDeviceScope().device_type == caffe2_pb2.CPU, \
@@ -294,6 +302,7 @@ def Parallelize(
             rendezvous,
             use_nccl,
             max_concurrent_distributed_ops,
+            allreduce_bucket_bytes=allreduce_bucket_bytes,
         )
     else:
         log.info("NOTE: Param builder function did not create any parameters.")
@@ -1194,7 +1203,7 @@ def _SyncAllParamsSingleHost(devices, model, net, unique_param_names):
 
 
 def _AllReduceBlobs(blob_names, devices, model, net, rendezvous, use_nccl,
-                    max_concurrent_distributed_ops):
+                    max_concurrent_distributed_ops, allreduce_bucket_bytes=0):
     if rendezvous is None or rendezvous['num_shards'] <= 1:
         _AllReduceBlobsSingleHost(
             blob_names,
@@ -1211,6 +1220,7 @@ def _AllReduceBlobs(blob_names, devices, model, net, rendezvous, use_nccl,
             net,
             rendezvous,
             max_concurrent_distributed_ops,
+            allreduce_bucket_bytes,
         )
 
 
@@ -1314,6 +1324,7 @@ def _AllReduceBlobsDistributed(
     net,
     rendezvous,
     max_concurrent_distributed_ops,
+    allreduce_bucket_bytes=0,
 ):
     num_workers = model.net.Proto().num_workers
     assert num_workers > 1, "Please specify more than 1 worker"
@@ -1332,7 +1343,36 @@ def _AllReduceBlobsDistributed(
 
     nccl_control_blob = None
 
-    for blob_name in blob_names:
+    if all_reduce_engine == 'GLOO' and allreduce_bucket_bytes > 0:
+        buckets = _GetGradientBuckets(
+            model, blob_names, devices, allreduce_bucket_bytes)
+    else:
+        buckets = [[blob_name] for blob_name in blob_names]
+
+    for bucket in buckets:
+        if len(bucket) > 1:
+            # The copies of every gradient on all devices next to each other
+            blobs = [
+                model._device_grouped_blobs[blob_name][device]
+                for blob_name in bucket for device in devices
+            ]
+            bucket_name = "{}_bucket".format(bucket[0])
+            with core.DeviceScope(reducing_device_opt):
+                comm_world, control_input = \
+                    context.get_control_and_context(blobs[0])
+                net.FusedAllreduce(
+                    inputs=[comm_world] + blobs,
+                    outputs=blobs,
+                    name=bucket_name,
+                    engine=all_reduce_engine,
+                    control_input=control_input,
+                    status_blob="allreduce_{}_status".format(bucket_name),
+                    num_devices=len(devices),
+                    gpu_direct=(rendezvous.get("transport", None) == "ibverbs"),
+                )
+            continue
+
+        blob_name = bucket[0]
         master_blob = model._device_grouped_blobs[blob_name][devices[0]]
         blobs_group = list(viewvalues(model._device_grouped_blobs[blob_name]))
 
@@ -1388,6 +1428,56 @@ def _AllReduceBlobsDistributed(
             _Broadcast(devices, model, net, blob_name)
 
 
+def _GetGradientBuckets(model, blob_names, devices, bucket_bytes):
+    '''
+    Groups consecutive dense gradients of the same type into buckets of at
+    least bucket_bytes (but the last one), keeping their order. The sizes are
+    those of the parameters, inferred from the param init net; a gradient of
+    unknown size gets a bucket of its own.
+    '''
+    itemsizes = {
+        caffe2_pb2.TensorProto.FLOAT: 4,
+        caffe2_pb2.TensorProto.FLOAT16: 2,
+    }
+    try:
+        shapes, types = workspace.InferShapesAndTypes([model.param_init_net])
+    except Exception as e:
+        log.warning("Cannot infer the sizes of the parameters ({}), "
+                    "gradients are all-reduced one by one".format(e))
+        return [[blob_name] for blob_name in blob_names]
+
+    grad_to_param = {
+        str(grad): str(param) for param, grad in viewitems(model.param_to_grad)
+        if not isinstance(grad, core.GradientSlice)
+    }
+
+    buckets = []
+    bucket, bucket_type, bucket_size = [], None, 0
+    for blob_name in blob_names:
+        grad = model._device_grouped_blobs[blob_name][devices[0]]
+        param = grad_to_param.get(str(grad))
+        if param not in shapes or types[param] not in itemsizes:
+            if bucket:
+                buckets.append(bucket)
+            buckets.append([blob_name])
+            bucket, bucket_size = [], 0
+            continue
+
+        if bucket and types[param] != bucket_type:
+            buckets.append(bucket)
+            bucket, bucket_size = [], 0
+        bucket.append(blob_name)
+        bucket_type = types[param]
+        bucket_size += int(np.prod(shapes[param])) * itemsizes[bucket_type]
+        if bucket_size >= bucket_bytes:
+            buckets.append(bucket)
+            bucket, bucket_size = [], 0
+
+    if bucket:
+        buckets.append(bucket)
+    return buckets
+
+
 def _AllReduceBlobsSingleHost(blob_names, devices, model, net, use_nccl):
     """Performs NCCL AllReduce to distribute blobs to all the GPUs."""
 
@@ -407,6 +407,77 @@ class DataParallelModelTest(TestCase):
                 device_option=None,
                 tmpdir=tmpdir)
 
+    def test_fused_allreduce_buckets(self):
+        def run(comm_rank, comm_size, tmpdir):
+            def add_input_ops(model):
+                model.param_init_net.UniformFill([], ["data"], shape=[16, 8])
+                model.param_init_net.UniformFill([], ["label"], shape=[16, 4])
+
+            def add_model_ops(model, loss_scale):
+                fc1 = brew.fc(model, "data", "fc1", dim_in=8, dim_out=64)
+                fc2 = brew.fc(model, fc1, "fc2", dim_in=64, dim_out=64)
+                fc3 = brew.fc(model, fc2, "fc3", dim_in=64, dim_out=4)
+                dist = model.net.SquaredL2Distance([fc3, "label"], "dist")
+                loss = model.net.AveragedLoss(dist, "loss")
+                return [loss]
+
+            def add_optimizer(model):
+                optimizer.build_sgd(model, 0.1)
+
+            workspace.ResetWorkspace()
+            store_handler = "store_handler"
+            workspace.RunOperatorOnce(
+                core.CreateOperator(
+                    "FileStoreHandlerCreate",
+                    [],
+                    [store_handler],
+                    path=tmpdir))
+            rendezvous = dict(
+                kv_handler=store_handler,
+                shard_id=comm_rank,
+                num_shards=comm_size,
+                engine='GLOO',
+            )
+
+            model = cnn.CNNModelHelper(
+                order="NHWC",
+                name="test",
+            )
+            # Big enough for the weight gradients to share buckets with
+            # the following bias gradients
+            data_parallel_model.Parallelize_CPU(
+                model,
+                input_builder_fun=add_input_ops,
+                forward_pass_builder_fun=add_model_ops,
+                optimizer_builder_fun=add_optimizer,
+                devices=[0, 1],
+                rendezvous=rendezvous,
+                allreduce_bucket_bytes=64 * 64 * 4,
+            )
+            fused_ops = [
+                op for op in model.net.Proto().op if op.type == "FusedAllreduce"
+            ]
+            self.assertGreater(len(fused_ops), 0)
+            for op in fused_ops:
+                self.assertEqual(op.input[1:], op.output)
+
+            data_parallel_model.RunInitNet(model)
+            data_parallel_model.RunNet(model, 2)
+
+            # The gradients are the same on both devices
+            for param in model.GetParams("cpu_0/"):
+                grad = model.param_to_grad[param]
+                other = str(grad).replace("cpu_0/", "cpu_1/")
+                np.testing.assert_allclose(
+                    workspace.FetchBlob(grad), workspace.FetchBlob(other))
+
+        with TemporaryDirectory() as tmpdir:
+            self.run_test_locally(
+                run,
+                comm_size=2,
+                device_option=None,
+                tmpdir=tmpdir)
+
     def test_device_scope_check(self):
         with self.assertRaises(AssertionError):
             with core.DeviceScope(core.DeviceOption(caffe2_pb2.CUDA, 0)):
@@ -1124,9 +1124,10 @@ class TestOperators(hu.HypothesisTestCase):
            num_elements=st.integers(1, 100),
            capacity=st.integers(1, 5),
            num_blobs=st.integers(1, 3),
+           lock_free=st.booleans(),
            do=st.sampled_from(hu.device_options))
     def test_blobs_queue_threading(self, num_threads, num_elements,
-                                   capacity, num_blobs, do):
+                                   capacity, num_blobs, lock_free, do):
         """
         - Construct matrices of size N x D
         - Start K threads
@@ -1147,6 +1148,7 @@ class TestOperators(hu.HypothesisTestCase):
             ["queue"],
             capacity=capacity,
             num_blobs=num_blobs,
+            lock_free=lock_free,
             device_option=do)
         self.ws.run(op)
 
@@ -1213,12 +1215,14 @@ class TestOperators(hu.HypothesisTestCase):
            num_consumers=st.integers(1, 10),
            capacity=st.integers(1, 5),
            num_blobs=st.integers(1, 3),
+           lock_free=st.booleans(),
            do=st.sampled_from(hu.device_options))
     def test_safe_blobs_queue(self, num_producers, num_consumers,
-                              capacity, num_blobs, do):
+                              capacity, num_blobs, lock_free, do):
         init_net = core.Net('init_net')
         queue = init_net.CreateBlobsQueue(
-            [], 1, capacity=capacity, num_blobs=num_blobs)
+            [], 1, capacity=capacity, num_blobs=num_blobs,
+            lock_free=lock_free)
         producer_steps = []
         truth = 0
         for i in range(num_producers):
@@ -0,0 +1,446 @@
+## @package int8_quantization
+# Module caffe2.python.int8_quantization
+"""Post-training quantization of fp32 CNNs to the Int8 operators.
+
+quantize_model() calibrates the ranges of the activations by running the fp32
+model on representative inputs, and rewrites it to the NHWC Int8 operators of
+caffe2/operators/quantized, e.g. for inference on mobile CPUs:
+
+    int8_init_net, int8_predict_net = int8_quantization.quantize_model(
+        init_net, predict_net, [{'data': batch} for batch in batches])
+
+The rewritten model has the fp32 NCHW inputs and outputs of the original one.
+Convolutions are folded with the SpatialBN and fused with the Relu that follow
+them, and operators without an Int8 counterpart run in fp32 between
+Int8Dequantize and Int8Quantize.
+"""
+
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+from __future__ import unicode_literals
+
+import numpy as np
+
+from caffe2.proto import caffe2_pb2
+from caffe2.python import core, workspace
+
+
+def choose_quantization_params(min_value, max_value):
+    """Returns the (scale, zero_point) of the uint8 quantization of the range
+    [min_value, max_value], extended to contain 0 so that it is exact."""
+    min_value = min(float(min_value), 0.0)
+    max_value = max(float(max_value), 0.0)
+    if max_value == min_value:
+        return 1.0, 0
+    scale = (max_value - min_value) / 255.0
+    zero_point = int(np.clip(np.round(-min_value / scale), 0, 255))
+    return scale, zero_point
+
+
+def quantize(values, scale, zero_point):
+    return np.clip(
+        np.round(values / scale) + zero_point, 0, 255).astype(np.uint8)
+
+
+def calibrate(init_net, predict_net, calibration_inputs):
+    """Runs the fp32 model on each dict of inputs of calibration_inputs.
+
+    Returns the parameters created by init_net, and the (min, max) range and
+    the shape of each float blob of predict_net.
+    """
+    ranges = {}
+    shapes = {}
+    with workspace.WorkspaceGuard('__int8_calibration__'):
+        workspace.ResetWorkspace()
+        workspace.RunNetOnce(init_net)
+        params = {
+            name: workspace.FetchBlob(name)
+            for op in init_net.op for name in op.output
+        }
+        for inputs in calibration_inputs:
+            for name, value in inputs.items():
+                workspace.FeedBlob(name, value)
+            workspace.RunNetOnce(predict_net)
+            for op in predict_net.op:
+                for name in list(op.input) + list(op.output):
+                    if name in params:
+                        continue
+                    value = workspace.FetchBlob(name)
+                    if (not isinstance(value, np.ndarray) or
+                            value.dtype != np.float32 or value.size == 0):
+                        continue
+                    min_value, max_value = ranges.get(name, (0.0, 0.0))
+                    ranges[name] = (
+                        min(min_value, float(value.min())),
+                        max(max_value, float(value.max())))
+                    shapes[name] = value.shape
+        workspace.ResetWorkspace()
+    return params, ranges, shapes
+
+
+def _get_arg(op, name, default):
+    for arg in op.arg:
+        if arg.name == name:
+            if arg.HasField('i'):
+                return arg.i
+            if arg.HasField('f'):
+                return arg.f
+            if arg.HasField('s'):
+                return arg.s.decode('utf-8')
+    return default
+
+
+def _copy_args(op, new_op, exclude=('order',)):
+    new_op.arg.extend([arg for arg in op.arg if arg.name not in exclude])
+    return new_op
+
+
+def _consumers(ops, blob):
+    return [op for op in ops if blob in op.input]
+
+
+def fold_spatial_bn(ops, params, external_outputs):
+    """Folds the inference SpatialBN that directly follow a convolution into
+    its filters and bias, which are added to params."""
+    folded = []
+    skip = set()
+    for i, op in enumerate(ops):
+        if i in skip:
+            continue
+        bn = ops[i + 1] if i + 1 < len(ops) else None
+        out = op.output[0] if op.output else None
+        if (op.type != 'Conv' or bn is None or bn.type != 'SpatialBN' or
+                bn.input[0] != out or len(bn.output) != 1 or
+                not _get_arg(bn, 'is_test', 0) or
+                _get_arg(op, 'order', 'NCHW') != 'NCHW' or
+                _get_arg(bn, 'order', 'NCHW') != 'NCHW' or
+                not all(name in params for name in op.input[1:]) or
+                not all(name in params for name in bn.input[1:])):
+            folded.append(op)
+            continue
+        if bn.output[0] != out and (
+                len(_consumers(ops, out)) > 1 or out in external_outputs):
+            folded.append(op)
+            continue
+        scale, bias, mean, var = [params[name] for name in bn.input[1:5]]
+        multiplier = scale / np.sqrt(var + _get_arg(bn, 'epsilon', 1e-5))
+        W = params[op.input[1]]
+        b = params[op.input[2]] if len(op.input) > 2 else np.zeros(
+            W.shape[0], dtype=np.float32)
+        W_name = '{}_bn_folded'.format(op.input[1])
+        b_name = '{}_bn_folded'.format(bn.output[0])
+        params[W_name] = (
+            W * multiplier.reshape(-1, 1, 1, 1)).astype(np.float32)
+        params[b_name] = ((b - mean) * multiplier + bias).astype(np.float32)
+        new_op = caffe2_pb2.OperatorDef()
+        new_op.CopyFrom(op)
+        new_op.input[:] = [op.input[0], W_name, b_name]
+        new_op.output[:] = [bn.output[0]]
+        folded.append(new_op)
+        skip.add(i + 1)
+    return folded
+
+
+class _Int8Rewriter(object):
+    """Rewrites the ops of a net one by one, keeping track of which blobs are
+    available as fp32 NCHW blobs under their original names, and as NHWC
+    Int8TensorCPU under the names of _int8_name()."""
+
+    def __init__(self, params, ranges, shapes, fp32_inputs):
+        self.params = params
+        self.ranges = ranges
+        self.shapes = shapes
+        self.ops = []
+        # Int8GivenTensorFill and Int8GivenIntTensorFill of the init net
+        self.init_ops = []
+        self.int8_params = {}
+        # (scale, zero_point) of the available Int8 blobs
+        self.int8_blobs = {}
+        self.fp32_blobs = set(fp32_inputs)
+
+    @staticmethod
+    def _int8_name(name):
+        return '{}_int8'.format(name)
+
+    @staticmethod
+    def _nhwc_name(name):
+        return '{}_nhwc'.format(name)
+
+    def _is_4d(self, name):
+        return name in self.shapes and len(self.shapes[name]) == 4
+
+    def _written(self, name):
+        self.fp32_blobs.discard(name)
+        self.int8_blobs.pop(name, None)
+
+    def output_params(self, name):
+        return choose_quantization_params(*self.ranges[name])
+
+    def input_params(self, name):
+        if name in self.int8_blobs:
+            return self.int8_blobs[name]
+        return self.output_params(name)
+
+    def int8_input(self, name):
+        if name in self.int8_blobs:
+            return self._int8_name(name)
+        assert name in self.fp32_blobs, 'Blob {} is not available'.format(name)
+        scale, zero_point = self.output_params(name)
+        fp32 = name
+        if self._is_4d(name):
+            fp32 = self._nhwc_name(name)
+            self.ops.append(core.CreateOperator('NCHW2NHWC', name, fp32))
+        self.ops.append(core.CreateOperator(
+            'Int8Quantize', fp32, self._int8_name(name),
+            Y_scale=scale, Y_zero_point=zero_point))
+        self.int8_blobs[name] = (scale, zero_point)
+        return self._int8_name(name)
+
+    def fp32_input(self, name):
+        if name in self.fp32_blobs:
+            return name
+        assert name in self.int8_blobs, 'Blob {} is not available'.format(name)
+        if self._is_4d(name):
+            self.ops.append(core.CreateOperator(
+                'Int8Dequantize', self._int8_name(name), self._nhwc_name(name)))
+            self.ops.append(core.CreateOperator(
+                'NHWC2NCHW', self._nhwc_name(name), name))
+        else:
+            self.ops.append(core.CreateOperator(
+                'Int8Dequantize', self._int8_name(name), name))
+        self.fp32_blobs.add(name)
+        return name
+
+    def add_int8_op(self, op_type, inputs, output, scale, zero_point, **kwargs):
+        self._written(output)
+        self.int8_blobs[output] = (scale, zero_point)
+        op = core.CreateOperator(
+            op_type, inputs, self._int8_name(output), **kwargs)
+        self.ops.append(op)
+        return op
+
+    def add_fp32_op(self, op):
+        new_op = caffe2_pb2.OperatorDef()
+        new_op.CopyFrom(op)
+        new_op.input[:] = [self.fp32_input(name) for name in op.input]
+        for name in op.output:
+            self._written(name)
+            self.fp32_blobs.add(name)
+        self.ops.append(new_op)
+
+    def int8_weights(self, name, values):
+        scale, zero_point = choose_quantization_params(
+            values.min(), values.max())
+        int8_name = self._int8_name(name)
+        if int8_name not in self.int8_params:
+            self.init_ops.append(core.CreateOperator(
+                'Int8GivenTensorFill', [], int8_name,
+                shape=list(values.shape),
+                values=quantize(values, scale, zero_point).tobytes(),
+                Y_scale=scale, Y_zero_point=zero_point))
+            self.int8_params[int8_name] = (scale, zero_point)
+        return int8_name
+
+    def int8_bias(self, name, values, scale):
+        # The bias is scaled like the int32 accumulators of the op, so its
+        # scale depends on the input
+        scale = float(np.float32(scale))
+        int8_name = '{}_int8_{}'.format(name, len(self.init_ops))
+        self.init_ops.append(core.CreateOperator(
+            'Int8GivenIntTensorFill', [], int8_name,
+            shape=list(values.shape),
+            values=np.round(values / scale).astype(np.int32),
+            Y_scale=scale, Y_zero_point=0))
+        return int8_name
+
+    def rewrite_conv(self, op, output, relu):
+        if (_get_arg(op, 'order', 'NCHW') != 'NCHW' or
+                not all(name in self.params for name in op.input[1:]) or
+                self.params[op.input[1]].ndim != 4 or
+                op.input[0] not in self.ranges or output not in self.ranges):
+            return False
+        X_scale, _ = self.input_params(op.input[0])
+        Y_scale, Y_zero_point = self.output_params(output)
+        # Filters [M, C / group, kernel_h, kernel_w] to NHWC
+        W_values = self.params[op.input[1]].transpose(0, 2, 3, 1)
+        W_scale, _ = choose_quantization_params(
+            W_values.min(), W_values.max())
+        if X_scale * W_scale >= Y_scale:
+            return False
+        inputs = [self.int8_input(op.input[0])]
+        inputs.append(self.int8_weights(op.input[1], W_values))
+        if len(op.input) > 2:
+            inputs.append(self.int8_bias(
+                op.input[2], self.params[op.input[2]], X_scale * W_scale))
+        new_op = self.add_int8_op(
+            'Int8ConvRelu' if relu else 'Int8Conv', inputs, output,
+            Y_scale, Y_zero_point,
+            order='NHWC', Y_scale=Y_scale, Y_zero_point=Y_zero_point)
+        _copy_args(op, new_op)
+        return True
+
+    def rewrite_fc(self, op):
+        if (_get_arg(op, 'axis', 1) != 1 or _get_arg(op, 'axis_w', 1) != 1 or
+                not all(name in self.params for name in op.input[1:]) or
+                op.input[0] not in self.ranges or
+                op.output[0] not in self.ranges):
+            return False
+        X_scale, _ = self.input_params(op.input[0])
+        Y_scale, Y_zero_point = self.output_params(op.output[0])
+        W_values = self.params[op.input[1]]
+        if self._is_4d(op.input[0]):
+            # X is flattened in NHWC rather than NCHW order
+            _, C, H, W = self.shapes[op.input[0]]
+            W_values = W_values.reshape(-1, C, H, W).transpose(
+                0, 2, 3, 1).reshape(W_values.shape[0], -1)
+            W_name = self._nhwc_name(op.input[1])
+        else:
+            W_name = op.input[1]
+        W_scale, _ = choose_quantization_params(
+            W_values.min(), W_values.max())
+        if X_scale * W_scale >= Y_scale:
+            return False
+        inputs = [
+            self.int8_input(op.input[0]),
+            self.int8_weights(W_name, W_values),
+            self.int8_bias(
+                op.input[2], self.params[op.input[2]], X_scale * W_scale),
+        ]
+        self.add_int8_op(
+            'Int8FC', inputs, op.output[0], Y_scale, Y_zero_point,
+            Y_scale=Y_scale, Y_zero_point=Y_zero_point)
+        return True
+
+    def rewrite_pool(self, op):
+        if (op.input[0] not in self.int8_blobs or
+                _get_arg(op, 'order', 'NCHW') != 'NCHW' or
+                not self._is_4d(op.input[0]) or
+                op.output[0] not in self.ranges):
+            return False
+        X = self.int8_input(op.input[0])
+        if op.type == 'MaxPool':
+            # The max keeps the quantization of X
+            scale, zero_point = self.int8_blobs[op.input[0]]
+            new_op = self.add_int8_op(
+                'Int8MaxPool', X, op.output[0], scale, zero_point,
+                order='NHWC')
+        else:
+            scale, zero_point = self.output_params(op.output[0])
+            new_op = self.add_int8_op(
+                'Int8AveragePool', X, op.output[0], scale, zero_point,
+                order='NHWC', Y_scale=scale, Y_zero_point=zero_point)
+        _copy_args(op, new_op)
+        return True
+
+    def rewrite_add(self, op, output, relu):
+        if (len(op.input) != 2 or
+                not any(name in self.int8_blobs for name in op.input) or
+                (op.type == 'Add' and _get_arg(op, 'broadcast', 0)) or
+                any(name not in self.shapes for name in op.input) or
+                self.shapes[op.input[0]] != self.shapes[op.input[1]] or
+                output not in self.ranges):
+            return False
+        scale, zero_point = self.output_params(output)
+        inputs = [self.int8_input(name) for name in op.input]
+        self.add_int8_op(
+            'Int8AddRelu' if relu else 'Int8Add', inputs, output,
+            scale, zero_point, Y_scale=scale, Y_zero_point=zero_point)
+        return True
+
+    def rewrite_relu(self, op):
+        if op.input[0] not in self.int8_blobs:
+            return False
+        X = self.int8_input(op.input[0])
+        scale, zero_point = self.int8_blobs[op.input[0]]
+        self.add_int8_op('Int8Relu', X, op.output[0], scale, zero_point)
+        return True
+
+
+def quantize_nets(init_net, predict_net, params, ranges, shapes):
+    """Rewrites predict_net to the Int8 operators, with the parameters,
+    activation ranges and shapes returned by calibrate().
+
+    Returns the init net and the predict net of the quantized model.
+    """
+    params = dict(params)
+    external_outputs = set(predict_net.external_output)
+    ops = fold_spatial_bn(list(predict_net.op), params, external_outputs)
+    rewriter = _Int8Rewriter(
+        params, ranges, shapes,
+        list(predict_net.external_input) + list(params.keys()))
+
+    i = 0
+    while i < len(ops):
+        op = ops[i]
+        # The Relu that directly follows an op is fused into it if it is the
+        # only consumer of its output
+        relu = ops[i + 1] if i + 1 < len(ops) else None
+        out = op.output[0] if op.output else None
+        fuse_relu = (
+            relu is not None and relu.type == 'Relu' and
+            relu.input[0] == out and
+            (relu.output[0] == out or (
+                len(_consumers(ops, out)) == 1 and
+                out not in external_outputs)))
+        output = relu.output[0] if fuse_relu else out
+        if op.type == 'Conv':
+            done = rewriter.rewrite_conv(op, output, fuse_relu)
+        elif op.type in ('Sum', 'Add'):
+            done = rewriter.rewrite_add(op, output, fuse_relu)
+        else:
+            fuse_relu = False
+            if op.type == 'FC':
+                done = rewriter.rewrite_fc(op)
+            elif op.type in ('MaxPool', 'AveragePool'):
+                done = rewriter.rewrite_pool(op)
+            elif op.type == 'Relu':
+                done = rewriter.rewrite_relu(op)
+            else:
+                done = False
+        if not done:
+            rewriter.add_fp32_op(op)
+            fuse_relu = False
+        i += 2 if fuse_relu else 1
+    for name in predict_net.external_output:
+        rewriter.fp32_input(name)
+
+    int8_predict_net = caffe2_pb2.NetDef()
+    int8_predict_net.name = predict_net.name + '_int8'
+    int8_predict_net.op.extend(rewriter.ops)
+    int8_predict_net.external_output.extend(predict_net.external_output)
+
+    # The fp32 parameters of the ops that stay in fp32, and the Int8 ones
+    int8_init_net = caffe2_pb2.NetDef()
+    int8_init_net.name = init_net.name + '_int8'
+    used = set(name for op in rewriter.ops for name in op.input)
+    initialized = set()
+    for op in init_net.op:
+        if any(name in used for name in op.output):
+            int8_init_net.op.extend([op])
+            initialized.update(op.output)
+    for name in sorted(used):
+        if name in params and name not in initialized:
+            # Folded with a SpatialBN
+            int8_init_net.op.extend([core.CreateOperator(
+                'GivenTensorFill', [], name,
+                shape=list(params[name].shape), values=params[name])])
+            initialized.add(name)
+    int8_init_net.op.extend(rewriter.init_ops)
+
+    int8_predict_net.external_input.extend(
+        [name for name in predict_net.external_input if name not in params] +
+        [name for op in int8_init_net.op for name in op.output])
+    return int8_init_net, int8_predict_net
+
+
+def quantize_model(init_net, predict_net, calibration_inputs):
+    """Quantizes the fp32 model of init_net and predict_net to the Int8
+    operators, with the ranges of the activations on calibration_inputs, a
+    list of dicts from input names to numpy arrays.
+
+    Returns the init net and the predict net of the quantized model.
+    """
+    params, ranges, shapes = calibrate(
+        init_net, predict_net, calibration_inputs)
+    return quantize_nets(init_net, predict_net, params, ranges, shapes)
@@ -0,0 +1,104 @@
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+from __future__ import unicode_literals
+
+import unittest
+import numpy as np
+
+from caffe2.proto import caffe2_pb2
+from caffe2.python import brew, core, workspace
+from caffe2.python.model_helper import ModelHelper
+import caffe2.python.int8_quantization as int8_quantization
+
+
+def residual_cnn():
+    model = ModelHelper(name="r", arg_scope={"order": "NCHW", "is_test": True})
+    brew.conv(model, "data", "conv1", 3, 16, kernel=3, pad=1)
+    brew.spatial_bn(model, "conv1", "conv1_bn", 16, epsilon=1e-3)
+    brew.relu(model, "conv1_bn", "relu1")
+    brew.max_pool(model, "relu1", "pool1", kernel=2, stride=2)
+    brew.conv(model, "pool1", "conv2", 16, 16, kernel=3, pad=1, group=4)
+    brew.relu(model, "conv2", "conv2")
+    brew.conv(model, "conv2", "conv3", 16, 16, kernel=1)
+    brew.sum(model, ["pool1", "conv3"], "sum")
+    brew.relu(model, "sum", "sum")
+    brew.average_pool(model, "sum", "pool2", kernel=2, stride=2)
+    brew.fc(model, "pool2", "fc", 16 * 4 * 4, 10)
+    brew.softmax(model, "fc", "softmax")
+    model.net.Proto().external_output.extend(["fc", "softmax"])
+    return model
+
+
+def random_init_net(model):
+    # Random parameters, with non trivial SpatialBN statistics
+    workspace.RunNetOnce(model.param_init_net)
+    init_net = caffe2_pb2.NetDef()
+    np.random.seed(0)
+    params = [
+        name for op in model.param_init_net.Proto().op for name in op.output]
+    for name in params:
+        shape = workspace.FetchBlob(name).shape
+        if name.endswith("_riv"):
+            values = np.random.uniform(0.5, 2, shape)
+        else:
+            values = np.random.uniform(-0.5, 0.5, shape)
+        init_net.op.extend([core.CreateOperator(
+            "GivenTensorFill", [], name,
+            shape=list(shape), values=values.astype(np.float32))])
+    return init_net
+
+
+class Int8QuantizationTest(unittest.TestCase):
+    def test_choose_quantization_params(self):
+        scale, zero_point = int8_quantization.choose_quantization_params(
+            -1.0, 3.0)
+        self.assertAlmostEqual(scale, 4.0 / 255)
+        self.assertEqual(zero_point, 64)
+        # The range is extended to contain zero
+        scale, zero_point = int8_quantization.choose_quantization_params(
+            1.0, 2.0)
+        self.assertAlmostEqual(scale, 2.0 / 255)
+        self.assertEqual(zero_point, 0)
+
+    def test_quantize_model(self):
+        workspace.ResetWorkspace()
+        model = residual_cnn()
+        init_net = random_init_net(model)
+        predict_net = model.net.Proto()
+        predict_net.external_input[:] = (
+            ["data"] + [op.output[0] for op in init_net.op])
+        np.random.seed(1)
+        calibration_inputs = [
+            {"data": np.random.rand(2, 3, 16, 16).astype(np.float32)}
+            for _ in range(4)]
+
+        int8_init_net, int8_predict_net = int8_quantization.quantize_model(
+            init_net, predict_net, calibration_inputs)
+        op_types = [op.type for op in int8_predict_net.op]
+        self.assertEqual(op_types.count("Int8ConvRelu"), 2)
+        self.assertEqual(op_types.count("Int8Conv"), 1)
+        for op_type in ["Int8MaxPool", "Int8AddRelu", "Int8AveragePool",
+                        "Int8FC", "Softmax"]:
+            self.assertIn(op_type, op_types)
+        self.assertNotIn("SpatialBN", op_types)
+
+        data = np.random.rand(2, 3, 16, 16).astype(np.float32)
+        workspace.ResetWorkspace()
+        workspace.RunNetOnce(init_net)
+        workspace.FeedBlob("data", data)
+        workspace.RunNetOnce(predict_net)
+        expected = workspace.FetchBlob("fc")
+        workspace.ResetWorkspace()
+        workspace.RunNetOnce(int8_init_net)
+        workspace.FeedBlob("data", data)
+        workspace.RunNetOnce(int8_predict_net)
+        fc = workspace.FetchBlob("fc")
+        self.assertEqual(fc.shape, expected.shape)
+        np.testing.assert_allclose(
+            fc, expected, atol=0.1 * np.abs(expected).max())
+        self.assertEqual(workspace.FetchBlob("softmax").shape, fc.shape)
+
+
+if __name__ == "__main__":
+    unittest.main()
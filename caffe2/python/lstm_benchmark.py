@@ -323,7 +323,8 @@ def GetArgumentParser():
         "--rnn_executor_max_cuda_streams",
         type=int,
         default=None,
-        help="Maximum number of CUDA streams used by RNN executor on GPU"
+        help="Maximum number of CUDA streams used by RNN executor on GPU. "
+        "Defaults to the number of timesteps that can run at once"
     )
     return parser
 
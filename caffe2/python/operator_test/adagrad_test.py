@@ -185,9 +185,7 @@ class TestAdagrad(hu.HypothesisTestCase):
                 )
             return (param_out, momentum_out)
 
-        ref_using_fp16_values = [False]
-        if dc == hu.gpu_do:
-            ref_using_fp16_values.append(True)
+        ref_using_fp16_values = [False, True]
 
         for ref_using_fp16 in ref_using_fp16_values:
             if(ref_using_fp16):
@@ -234,9 +232,7 @@ class TestAdagrad(hu.HypothesisTestCase):
             momentum_out = np.copy(momentum)
             return (param_out, momentum_out)
 
-        ref_using_fp16_values = [False]
-        if dc == hu.gpu_do:
-            ref_using_fp16_values.append(True)
+        ref_using_fp16_values = [False, True]
 
         for ref_using_fp16 in ref_using_fp16_values:
             if(ref_using_fp16):
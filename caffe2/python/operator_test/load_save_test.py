@@ -455,6 +455,40 @@ class TestLoadSave(TestLoadSaveBase):
             if e.errno != errno.ENOENT:
                 raise
 
+    def testLoadWithThreads(self):
+        tmp_folder = tempfile.mkdtemp()
+        # The first one is bigger than caffe2_tensor_chunk_size, so it is
+        # saved in several chunks
+        arrays = [np.random.rand(2500000).astype(np.float32),
+                  np.arange(6).astype(np.int64), np.array([b'a', b'bc'])]
+        for i, arr in enumerate(arrays):
+            self.assertTrue(workspace.FeedBlob(str(i), arr))
+        tmp_file = os.path.join(tmp_folder, "db")
+        op = core.CreateOperator(
+            "Save",
+            [str(i) for i in range(len(arrays))], [],
+            absolute_path=1,
+            db=tmp_file, db_type=self._db_type)
+        self.assertTrue(workspace.RunOperatorOnce(op))
+
+        for load_all in [0, 1]:
+            workspace.ResetWorkspace()
+            op = core.CreateOperator(
+                "Load",
+                [], [] if load_all else [str(i) for i in range(len(arrays))],
+                absolute_path=1,
+                db=tmp_file, db_type=self._db_type,
+                load_all=load_all,
+                num_threads=4)
+            self.assertTrue(workspace.RunOperatorOnce(op))
+            for i, arr in enumerate(arrays):
+                np.testing.assert_array_equal(workspace.FetchBlob(str(i)), arr)
+        try:
+            shutil.rmtree(tmp_folder)
+        except OSError as e:
+            if e.errno != errno.ENOENT:
+                raise
+
 
 if __name__ == '__main__':
     unittest.main()
@@ -151,7 +151,7 @@ class TestTensorPackOps(hu.HypothesisTestCase):
         exponentiated = workspace.FetchBlob('r')
         assert(exponentiated[0, -1, 0] == 0.0)
 
-    @given(**hu.gcs_cpu_only)
+    @given(**hu.gcs)
     def test_presence_mask(self, gc, dc):
         lengths = np.array([1, 2, 3], dtype=np.int32)
         data = np.array(
@@ -192,6 +192,52 @@ class TestTensorPackOps(hu.HypothesisTestCase):
         self.assertEqual(presence_mask.shape, expected_presence_mask.shape)
         np.testing.assert_array_equal(presence_mask, expected_presence_mask)
 
+    @given(max_length=st.integers(0, 5), **hu.gcs)
+    def test_max_length(self, max_length, gc, dc):
+        lengths = np.array([1, 0, 2, 3], dtype=np.int32)
+        data = np.array(
+            [[1.0, 1.0], [2.0, 2.0], [2.1, 2.1], [3.0, 3.0], [3.1, 3.1],
+             [3.2, 3.2]],
+            dtype=np.float32
+        )
+
+        def pack_ref(lengths, data):
+            packed = np.zeros((len(lengths), max_length, 2), dtype=np.float32)
+            presence = np.zeros((len(lengths), max_length), dtype=np.bool)
+            start = 0
+            for i, length in enumerate(lengths):
+                kept = min(length, max_length)
+                packed[i, :kept] = data[start:start + kept]
+                presence[i, :kept] = True
+                start += length
+            return [packed, presence]
+
+        self.assertReferenceChecks(
+            device_option=gc,
+            op=core.CreateOperator(
+                'PackSegments', ['l', 'd'], ['t', 'p'],
+                max_length=max_length, return_presence_mask=True),
+            inputs=[lengths, data],
+            reference=pack_ref,
+        )
+
+        # The rows that were truncated unpack to zeros
+        def unpack_ref(lengths, packed):
+            data = np.zeros((np.sum(lengths), 2), dtype=np.float32)
+            start = 0
+            for i, length in enumerate(lengths):
+                kept = min(length, max_length)
+                data[start:start + kept] = packed[i, :kept]
+                start += length
+            return [data]
+
+        self.assertReferenceChecks(
+            device_option=gc,
+            op=core.CreateOperator('UnpackSegments', ['l', 't'], ['d']),
+            inputs=[lengths, pack_ref(lengths, data)[0]],
+            reference=unpack_ref,
+        )
+
     def test_presence_mask_empty(self):
         lengths = np.array([], dtype=np.int32)
         data = np.array([], dtype=np.float32)
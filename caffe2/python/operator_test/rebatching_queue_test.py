@@ -77,6 +77,47 @@ class TestReBatchingQueue(TestCase):
             workspace.FetchBlob(results[1]), workspace.FetchBlob("tensors")[5:]
         )
 
+    def test_rebatching_queue_max_tokens(self):
+        net = core.Net('net')
+        workspace.FeedBlob("lengths", np.array([1, 2, 3, 4, 5], np.int32))
+        workspace.FeedBlob(
+            "values", np.arange(10, dtype=np.float32).reshape(5, 2)
+        )
+
+        queue = net.CreateRebatchingQueue([], 1, capacity=10, num_blobs=2)
+
+        net.EnqueueRebatchingQueue(
+            [queue, "lengths", "values"], [], enqueue_batch=True
+        )
+        net.CloseRebatchingQueue([queue], 0)
+
+        results = [
+            net.DequeueRebatchingQueue(
+                [queue], 2, num_elements=5, max_tokens=6, token_blob=0
+            ),
+            net.DequeueRebatchingQueue(
+                [queue], 2, num_elements=5, max_tokens=6, token_blob=0
+            ),
+            net.DequeueRebatchingQueue(
+                [queue], 2, num_elements=5, max_tokens=6, token_blob=0
+            ),
+        ]
+
+        workspace.RunNetOnce(net)
+
+        lengths = workspace.FetchBlob("lengths")
+        values = workspace.FetchBlob("values")
+        # 1 + 2 + 3 tokens, then 4 (4 + 5 > 6), then 5
+        for (lengths_out, values_out), (begin, end) in zip(
+            results, [(0, 3), (3, 4), (4, 5)]
+        ):
+            npt.assert_array_equal(
+                workspace.FetchBlob(lengths_out), lengths[begin:end]
+            )
+            npt.assert_array_equal(
+                workspace.FetchBlob(values_out), values[begin:end]
+            )
+
     def test_rebatching_queue_closes_properly(self):
         net = core.Net('net')
         workspace.FeedBlob(
@@ -525,6 +525,35 @@ class TestSegmentOps(hu.HypothesisTestCase):
         )
         self.assertDeviceChecks(dc, op, [X, Y, Z], [0])
 
+    @given(
+        inputs=hu.sparse_lengths_tensor(
+            dtype=np.float32,
+            min_value=1,
+            max_value=5,
+            allow_empty=True
+        ),
+        **hu.gcs
+    )
+    def test_sparse_lengths_sum_dedup_gradient(self, inputs, gc, dc):
+        X, Y, Z = inputs
+        G = np.random.rand(*((Z.size, ) + X.shape[1:])).astype(np.float32)
+        op = core.CreateOperator(
+            "SparseLengthsSumDedupGradient", ["G", "Z", "Y"], ["U", "out"]
+        )
+
+        def ref(G, L, I):
+            U = np.unique(I)
+            R = np.zeros(shape=(U.size, ) + G.shape[1:], dtype=G.dtype)
+            line = 0
+            for g in range(L.size):
+                for _ in range(L[g]):
+                    R[np.searchsorted(U, I[line])] += G[g]
+                    line += 1
+            return [U, R]
+
+        self.assertReferenceChecks(gc, op, [G, Z, Y], ref, threshold=1e-4)
+        self.assertDeviceChecks(dc, op, [G, Z, Y], [0, 1])
+
     @given(**hu.gcs_cpu_only)
     def test_legacy_sparse_and_lengths_sum_gradient(self, gc, dc):
         X = np.random.rand(3, 64).astype(np.float32)
@@ -191,6 +191,23 @@ class TestTopK(hu.HypothesisTestCase):
         self.assertReferenceChecks(gc, op, [X], bind_ref)
         self.assertDeviceChecks(dc, op, [X], [0])
 
+    @given(bs=st.integers(64, 128), n=st.integers(256, 1024),
+           k=st.sampled_from([1, 2, 10]), flatten_indices=st.booleans(),
+           **hu.gcs_cpu_only)
+    def test_top_k_many_rows(self, bs, n, k, flatten_indices, gc, dc):
+        # Large enough to run rows in parallel, with ties broken by index
+        X = np.random.randint(0, 50, size=(bs, n)).astype(np.float32)
+        output_list = ["Values", "Indices"]
+        if flatten_indices:
+            output_list.append("FlattenIndices")
+        op = core.CreateOperator("TopK", ["X"], output_list,
+                                 k=k, device_option=gc)
+
+        def bind_ref(X_loc):
+            return self.top_k_ref(X_loc, k, flatten_indices)
+
+        self.assertReferenceChecks(gc, op, [X], bind_ref)
+
     @given(X=hu.tensor(dtype=np.float32), k=st.integers(1, 5),
            axis=st.integers(-1, 5), flatten_indices=st.booleans(),
            **hu.gcs)
@@ -15,7 +15,7 @@ import shutil
 import tempfile
 
 from caffe2.proto import caffe2_pb2
-from caffe2.python import workspace, model_helper
+from caffe2.python import core, workspace, model_helper
 import numpy as np
 
 
@@ -555,6 +555,59 @@ class VideoInputOpTest(unittest.TestCase):
         os.remove(temp_list)
         shutil.rmtree(video_db_dir)
 
+    # test optical flow computed on the GPU, with all channels added to it
+    def test_optical_flow_on_gpu(self):
+        if not workspace.has_gpu_support or workspace.NumCudaDevices() < 1:
+            raise unittest.SkipTest('No GPU')
+        if not workspace.C.get_build_options().get('USE_OPENCV_CUDA'):
+            raise unittest.SkipTest('Built without the CUDA modules of OpenCV')
+        batch_size = 4
+        crop_height, crop_width = 112, 144
+        random_label = np.random.randint(0, 100)
+        VIDEO = "/mnt/vol/gfsdataswarm-oregon/users/trandu/sample.avi"
+        if not os.path.exists(VIDEO):
+            raise unittest.SkipTest('Missing data')
+        temp_list = tempfile.NamedTemporaryFile(delete=False).name
+        line_str = '{} 0 {}\n'.format(VIDEO, random_label)
+        self.create_a_list(temp_list, line_str, batch_size)
+        video_db_dir = tempfile.mkdtemp()
+
+        self.create_video_db(temp_list, video_db_dir)
+        model = model_helper.ModelHelper(name="Video Loader from LMDB")
+        reader = model.CreateDB("sample", db=video_db_dir, db_type="lmdb")
+        with core.DeviceScope(core.DeviceOption(caffe2_pb2.CUDA, 0)):
+            model.net.VideoInput(
+                reader,
+                ["data", "label"],
+                name="data",
+                batch_size=batch_size,
+                clip_per_video=1,
+                scale_h=128,
+                scale_w=166,
+                crop_height=crop_height,
+                crop_width=crop_width,
+                length_of=8,
+                sampling_rate_of=1,
+                frame_gap_of=2,
+                decode_type=0,
+                video_res_type=0,
+                flow_data_type=3,
+                get_rgb=False,
+                get_optical_flow=True,
+                use_gpu_optical_flow=True)
+
+        workspace.RunNetOnce(model.param_init_net)
+        workspace.RunNetOnce(model.net)
+        data = workspace.FetchBlob("data")
+        label = workspace.FetchBlob("label")
+
+        np.testing.assert_equal(label, random_label)
+        np.testing.assert_equal(
+            data.shape, [batch_size, 5, 8, crop_height, crop_width])
+        self.assertTrue(np.all(np.isfinite(data)))
+        os.remove(temp_list)
+        shutil.rmtree(video_db_dir)
+
 
 if __name__ == "__main__":
     unittest.main()
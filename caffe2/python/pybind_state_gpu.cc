@@ -62,10 +62,26 @@ void addCUDAGlobalMethods(py::module& m) {
          int max_batch_size,
          int max_workspace_size,
          int verbosity,
-         bool debug_builder) -> py::bytes {
+         bool debug_builder,
+         bool fp16_mode,
+         bool int8_mode,
+         const std::string& int8_calibration_db,
+         const std::string& int8_calibration_db_type,
+         const std::string& engine_cache_dir) -> py::bytes {
 #ifdef CAFFE2_USE_TRT
+        tensorrt::TrtBuildOptions build_options;
+        build_options.fp16_mode = fp16_mode;
+        build_options.int8_mode = int8_mode;
+        build_options.int8_calibration_db = int8_calibration_db;
+        build_options.int8_calibration_db_type = int8_calibration_db_type;
+        build_options.engine_cache_dir = engine_cache_dir;
         TensorRTTransformer t(
-            max_batch_size, max_workspace_size, verbosity, debug_builder);
+            max_batch_size,
+            max_workspace_size,
+            verbosity,
+            debug_builder,
+            true,
+            build_options);
         auto op_def =
             t.BuildTrtOp(onnx_model_str.cast<std::string>(), output_size_hints);
         std::string out;
@@ -83,7 +99,12 @@ void addCUDAGlobalMethods(py::module& m) {
          int max_workspace_size,
          int verbosity,
          bool debug_builder,
-         bool build_serializable_op) -> py::bytes {
+         bool build_serializable_op,
+         bool fp16_mode,
+         bool int8_mode,
+         const std::string& int8_calibration_db,
+         const std::string& int8_calibration_db_type,
+         const std::string& engine_cache_dir) -> py::bytes {
 #ifdef CAFFE2_USE_TRT
         caffe2::NetDef pred_net;
         if (!ParseProtoFromLargeString(
@@ -95,12 +116,19 @@ void addCUDAGlobalMethods(py::module& m) {
           tensor_shapes.emplace(
               it.first, CreateTensorShape(it.second, TensorProto::FLOAT));
         }
+        tensorrt::TrtBuildOptions build_options;
+        build_options.fp16_mode = fp16_mode;
+        build_options.int8_mode = int8_mode;
+        build_options.int8_calibration_db = int8_calibration_db;
+        build_options.int8_calibration_db_type = int8_calibration_db_type;
+        build_options.engine_cache_dir = engine_cache_dir;
         TensorRTTransformer ts(
             max_batch_size,
             max_workspace_size,
             verbosity,
             debug_builder,
-            build_serializable_op);
+            build_serializable_op,
+            build_options);
         ts.Transform(GetCurrentWorkspace(), &pred_net, tensor_shapes);
         std::string pred_net_str2;
         pred_net.SerializeToString(&pred_net_str2);
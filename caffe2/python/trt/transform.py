@@ -38,9 +38,19 @@ def convert_onnx_model_to_trt_op(onnx_model,
         max_batch_size=50,
         max_workspace_size=2*1024*1024,
         verbosity=1,
-        debug_builder=False):
+        debug_builder=False,
+        fp16_mode=False,
+        int8_mode=False,
+        int8_calibration_db="",
+        int8_calibration_db_type="minidb",
+        engine_cache_dir=""):
     """
     Convert the whole ONNX model to a TensorRT C2 op
+
+    Set engine_cache_dir to reuse the engine built by an earlier call with the
+    same model, options and GPU. In int8_mode the engine is calibrated with
+    the batches of int8_calibration_db, a db of TensorProtos with one tensor
+    per input.
     """
     check_gpu_()
     trt_str = C.onnx_to_trt_op(onnx_model.SerializeToString(),
@@ -48,7 +58,12 @@ def convert_onnx_model_to_trt_op(onnx_model,
                                max_batch_size,
                                max_workspace_size,
                                verbosity,
-                               debug_builder)
+                               debug_builder,
+                               fp16_mode,
+                               int8_mode,
+                               int8_calibration_db,
+                               int8_calibration_db_type,
+                               engine_cache_dir)
     op = caffe2_pb2.OperatorDef()
     op.ParseFromString(trt_str)
     return op
@@ -78,9 +93,18 @@ def transform_caffe2_net(
         max_workspace_size=2*1024*1024,
         verbosity=1,
         debug_builder=False,
-        build_serializable_op=True):
+        build_serializable_op=True,
+        fp16_mode=False,
+        int8_mode=False,
+        int8_calibration_db="",
+        int8_calibration_db_type="minidb",
+        engine_cache_dir=""):
     """
     Transfrom the caffe2_net by collapsing TRT-runnable nodes into trt c2 ops
+
+    Ops TensorRT cannot run stay in Caffe2 between the trt ops. With
+    build_serializable_op=False the engines are built when the trt ops are
+    created, and engine_cache_dir lets later processes load them instead.
     """
     check_gpu_()
 
@@ -101,7 +125,12 @@ def transform_caffe2_net(
                                    max_workspace_size,
                                    verbosity,
                                    debug_builder,
-                                   build_serializable_op)
+                                   build_serializable_op,
+                                   fp16_mode,
+                                   int8_mode,
+                                   int8_calibration_db,
+                                   int8_calibration_db_type,
+                                   engine_cache_dir)
     pred_net_cut = caffe2_pb2.NetDef()
     pred_net_cut.ParseFromString(pred_net_str)
     return pred_net_cut
@@ -28,8 +28,12 @@ BlobsQueue::BlobsQueue(
     size_t capacity,
     size_t numBlobs,
     bool enforceUniqueName,
-    const std::vector<std::string>& fieldNames)
-    : numBlobs_(numBlobs), name_(queueName), stats_(queueName) {
+    const std::vector<std::string>& fieldNames,
+    bool lockFree)
+    : numBlobs_(numBlobs),
+      name_(queueName),
+      lockFree_(lockFree),
+      stats_(queueName) {
   if (!fieldNames.empty()) {
     CAFFE_ENFORCE_EQ(
         fieldNames.size(), numBlobs, "Wrong number of fieldNames provided.");
@@ -52,11 +56,21 @@ BlobsQueue::BlobsQueue(
     queue_.push_back(blobs);
   }
   DCHECK_EQ(queue_.size(), capacity);
+  if (lockFree_) {
+    CAFFE_ENFORCE_GT(capacity, 0, "Lock-free queues need a capacity");
+    sequence_.reset(new std::atomic<int64_t>[capacity]);
+    for (auto i = 0; i < capacity; ++i) {
+      sequence_[i] = i;
+    }
+  }
 }
 
 bool BlobsQueue::blockingRead(
     const std::vector<Blob*>& inputs,
     float timeout_secs) {
+  if (lockFree_) {
+    return lockFreeRead(inputs, timeout_secs);
+  }
   Timer readTimer;
   auto keeper = this->shared_from_this();
   const auto& name = name_.c_str();
@@ -103,6 +117,9 @@ bool BlobsQueue::blockingRead(
 }
 
 bool BlobsQueue::tryWrite(const std::vector<Blob*>& inputs) {
+  if (lockFree_) {
+    return lockFreeWrite(inputs, false);
+  }
   Timer writeTimer;
   auto keeper = this->shared_from_this();
   const auto& name = name_.c_str();
@@ -122,6 +139,9 @@ bool BlobsQueue::tryWrite(const std::vector<Blob*>& inputs) {
 }
 
 bool BlobsQueue::blockingWrite(const std::vector<Blob*>& inputs) {
+  if (lockFree_) {
+    return lockFreeWrite(inputs, true);
+  }
   Timer writeTimer;
   auto keeper = this->shared_from_this();
   const auto& name = name_.c_str();
@@ -170,4 +190,144 @@ void BlobsQueue::doWrite(const std::vector<Blob*>& inputs) {
   cv_.notify_all();
 }
 
+bool BlobsQueue::lockFreeRead(
+    const std::vector<Blob*>& inputs,
+    float timeout_secs) {
+  Timer readTimer;
+  auto keeper = this->shared_from_this();
+  const auto& name = name_.c_str();
+  CAFFE_SDT(queue_read_start, name, (void*)this, SDT_BLOCKING_OP);
+  // Decrease queue balance before reading to indicate queue read pressure
+  // is being increased (-ve queue balance indicates more reads than writes)
+  CAFFE_EVENT(stats_, queue_balance, -1);
+  const auto deadline = std::chrono::steady_clock::now() +
+      std::chrono::milliseconds(int(timeout_secs * 1000));
+  int64_t pos;
+  while (!tryClaim(readPos_, 1, &pos)) {
+    const bool ready = wait(
+        [this]() { return closing_ || canClaim(readPos_, 1); },
+        timeout_secs > 0 ? &deadline : nullptr);
+    if (!ready) {
+      LOG(ERROR) << "DequeueBlobs timed out in " << timeout_secs << " secs";
+      CAFFE_SDT(queue_read_end, name, (void*)this, SDT_TIMEOUT);
+      return false;
+    }
+    if (closing_ && !canClaim(readPos_, 1)) {
+      CAFFE_SDT(queue_read_end, name, (void*)this, SDT_CANCEL);
+      return false;
+    }
+  }
+  auto& result = queue_[pos % queue_.size()];
+  CAFFE_ENFORCE(inputs.size() >= result.size());
+  for (auto i = 0; i < result.size(); ++i) {
+    auto bytes = BlobStat::sizeBytes(*result[i]);
+    CAFFE_EVENT(stats_, queue_dequeued_bytes, bytes, i);
+    using std::swap;
+    swap(*(inputs[i]), *(result[i]));
+  }
+  CAFFE_SDT(queue_read_end, name, (void*)this, writePos_ - readPos_);
+  CAFFE_EVENT(stats_, queue_dequeued_records);
+  // the slot can be written again one lap later
+  sequence_[pos % queue_.size()] = pos + queue_.size();
+  notifyWaiters();
+  CAFFE_EVENT(stats_, read_time_ns, readTimer.NanoSeconds());
+  return true;
+}
+
+bool BlobsQueue::lockFreeWrite(const std::vector<Blob*>& inputs, bool blocking) {
+  Timer writeTimer;
+  auto keeper = this->shared_from_this();
+  const auto& name = name_.c_str();
+  CAFFE_SDT(
+      queue_write_start,
+      name,
+      (void*)this,
+      blocking ? SDT_BLOCKING_OP : SDT_NONBLOCKING_OP);
+  if (blocking) {
+    // Increase queue balance before writing to indicate queue write pressure
+    // is being increased (+ve queue balance indicates more writes than reads)
+    CAFFE_EVENT(stats_, queue_balance, 1);
+  }
+  int64_t pos;
+  while (!tryClaim(writePos_, 0, &pos)) {
+    if (!blocking || closing_) {
+      CAFFE_SDT(queue_write_end, name, (void*)this, SDT_ABORT);
+      return false;
+    }
+    wait([this]() { return closing_ || canClaim(writePos_, 0); }, nullptr);
+  }
+  if (!blocking) {
+    CAFFE_EVENT(stats_, queue_balance, 1);
+  }
+  auto& result = queue_[pos % queue_.size()];
+  CAFFE_ENFORCE(inputs.size() >= result.size());
+  for (auto i = 0; i < result.size(); ++i) {
+    using std::swap;
+    swap(*(inputs[i]), *(result[i]));
+  }
+  CAFFE_SDT(
+      queue_write_end,
+      name,
+      (void*)this,
+      readPos_ + queue_.size() - writePos_);
+  // the slot can be read now
+  sequence_[pos % queue_.size()] = pos + 1;
+  notifyWaiters();
+  CAFFE_EVENT(stats_, write_time_ns, writeTimer.NanoSeconds());
+  return true;
+}
+
+bool BlobsQueue::tryClaim(
+    std::atomic<int64_t>& position,
+    int64_t offset,
+    int64_t* pos) {
+  auto current = position.load();
+  while (true) {
+    const auto diff = sequence_[current % queue_.size()] - (current + offset);
+    if (diff == 0) {
+      if (position.compare_exchange_weak(current, current + 1)) {
+        *pos = current;
+        return true;
+      }
+    } else if (diff < 0) {
+      // the slot hasn't been read (written) since the last lap
+      return false;
+    } else {
+      // another thread claimed the slot
+      current = position.load();
+    }
+  }
+}
+
+bool BlobsQueue::canClaim(
+    const std::atomic<int64_t>& position,
+    int64_t offset) const {
+  const auto current = position.load();
+  return sequence_[current % queue_.size()] - (current + offset) >= 0;
+}
+
+bool BlobsQueue::wait(
+    const std::function<bool()>& ready,
+    const std::chrono::steady_clock::time_point* deadline) {
+  std::unique_lock<std::mutex> g(mutex_);
+  // Counted before checking ready(), so that a thread making the queue ready
+  // afterwards sees the waiter and notifies it under the mutex
+  ++waiters_;
+  bool result = true;
+  if (deadline) {
+    result = cv_.wait_until(g, *deadline, ready);
+  } else {
+    cv_.wait(g, ready);
+  }
+  --waiters_;
+  return result;
+}
+
+void BlobsQueue::notifyWaiters() {
+  if (waiters_ > 0) {
+    std::lock_guard<std::mutex> g(mutex_);
+    cv_.notify_all();
+  }
+}
+
 } // namespace caffe2
@@ -1,7 +1,9 @@
 #pragma once
 
 #include <atomic>
+#include <chrono>
 #include <condition_variable>
+#include <functional>
 #include <memory>
 #include <mutex>
 #include <queue>
@@ -20,6 +22,10 @@ namespace caffe2 {
 // Containing blobs are owned by the workspace.
 // On read, we swap out the underlying data for the blob passed in for blobs
 
+// With lockFree, readers and writers claim slots of the circular buffer with
+// atomic operations and swap blobs without holding the mutex, which is then
+// only used to sleep while the queue is empty (or full) and to wake up.
+
 class BlobsQueue : public std::enable_shared_from_this<BlobsQueue> {
  public:
   BlobsQueue(
@@ -28,7 +34,8 @@ class BlobsQueue : public std::enable_shared_from_this<BlobsQueue> {
       size_t capacity,
       size_t numBlobs,
       bool enforceUniqueName,
-      const std::vector<std::string>& fieldNames = {});
+      const std::vector<std::string>& fieldNames = {},
+      bool lockFree = false);
 
   ~BlobsQueue() {
     close();
@@ -48,6 +55,19 @@ class BlobsQueue : public std::enable_shared_from_this<BlobsQueue> {
   bool canWrite();
   void doWrite(const std::vector<Blob*>& inputs);
 
+  // lockFree_ versions of the above
+  bool lockFreeRead(const std::vector<Blob*>& inputs, float timeout_secs);
+  bool lockFreeWrite(const std::vector<Blob*>& inputs, bool blocking);
+  // Claims the next slot to read (offset 1) or write (offset 0), false if
+  // there is none.
+  bool tryClaim(std::atomic<int64_t>& position, int64_t offset, int64_t* pos);
+  bool canClaim(const std::atomic<int64_t>& position, int64_t offset) const;
+  // Sleeps until ready() or the deadline (if any); false on timeout
+  bool wait(
+      const std::function<bool()>& ready,
+      const std::chrono::steady_clock::time_point* deadline);
+  void notifyWaiters();
+
   std::atomic<bool> closing_{false};
 
   size_t numBlobs_;
@@ -58,6 +78,15 @@ class BlobsQueue : public std::enable_shared_from_this<BlobsQueue> {
   std::vector<std::vector<Blob*>> queue_;
   const std::string name_;
 
+  // Only used with lockFree_: the next read and write positions and, per
+  // slot, the position it can next be written at (if equal to the slot's
+  // write position) or read at (if one past it).
+  const bool lockFree_;
+  std::atomic<int64_t> readPos_{0};
+  std::atomic<int64_t> writePos_{0};
+  std::unique_ptr<std::atomic<int64_t>[]> sequence_;
+  std::atomic<int> waiters_{0};
+
   struct QueueStats {
     CAFFE_STAT_CTOR(QueueStats);
     CAFFE_EXPORTED_STAT(queue_balance);
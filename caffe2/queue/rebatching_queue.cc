@@ -1,98 +1,135 @@
 #include "rebatching_queue.h"
-#include "caffe2/utils/smart_tensor_printer.h"
 
 namespace caffe2 {
 
 namespace {
 
-// This concat function will always create a new first dimension to concat
+using Element = RebatchingQueue::Element;
+
+std::vector<TIndex> rowDims(const Element& element, int i) {
+  auto dims = element.tensors->at(i).dims();
+  if (element.row >= 0) {
+    dims.erase(dims.begin());
+  }
+  return dims;
+}
+
+const char* rowData(const Element& element, int i) {
+  const auto& tensor = element.tensors->at(i);
+  if (element.row < 0) {
+    return static_cast<const char*>(tensor.raw_data());
+  }
+  return static_cast<const char*>(tensor.raw_data()) +
+      element.row * tensor.size_from_dim(1) * tensor.itemsize();
+}
+
+int64_t numTokens(const Element& element, int tokenBlob) {
+  const auto& tensor = element.tensors->at(tokenBlob);
+  CAFFE_ENFORCE_EQ(
+      element.row < 0 ? tensor.size() : tensor.size_from_dim(1),
+      1,
+      "Token count tensor must hold a single value per element");
+  if (tensor.IsType<int>()) {
+    return *reinterpret_cast<const int*>(rowData(element, tokenBlob));
+  }
+  CAFFE_ENFORCE(
+      tensor.IsType<int64_t>(),
+      "Token count tensor must be int or int64, got ",
+      tensor.meta().name());
+  return *reinterpret_cast<const int64_t*>(rowData(element, tokenBlob));
+}
+
+// This concat function will always create a new first dimension to concat.
+// Rows that are consecutive in the batch they were enqueued with are copied
+// with a single copy.
 void concat(
     CPUContext& context,
-    const std::vector<std::vector<TensorCPU>>& inputs,
+    const std::vector<Element>& inputs,
     const std::vector<TensorCPU*>& outputs) {
   CAFFE_ENFORCE(!inputs.empty());
 
   const auto& inputZero = inputs[0];
-  const auto numTensors = inputZero.size();
+  const auto numTensors = inputZero.tensors->size();
   const auto numRows = inputs.size();
+  CAFFE_ENFORCE_EQ(outputs.size(), numTensors);
 
-  // Precompute the output sizes to avoid resizing
-  std::vector<std::vector<TIndex>> outputDims(numTensors);
-
-  for (int i = 0; i < numTensors; ++i) {
-    SmartTensorPrinter::PrintTensor(inputZero.at(i));
-    outputDims[i] = inputZero.at(i).dims();
-    outputDims[i].insert(outputDims[i].begin(), numRows);
-  }
-
-  // Resize to the final output size
-  std::vector<void*> destinations(numTensors);
-  for (int i = 0; i < numTensors; ++i) {
-    outputs[i]->Resize(outputDims[i]);
-    destinations[i] = outputs[i]->raw_mutable_data(inputZero[i].meta());
+  for (int i = 0; i < numRows; ++i) {
+    CAFFE_ENFORCE_EQ(inputs[i].tensors->size(), numTensors);
   }
 
-  for (int i = 0; i < numRows; ++i) {
-    CAFFE_ENFORCE_EQ(inputs[i].size(), numTensors);
+  for (int j = 0; j < numTensors; ++j) {
+    const auto& meta = inputZero.tensors->at(j).meta();
+    const auto dims = rowDims(inputZero, j);
+    for (int i = 1; i < numRows; ++i) {
+      CAFFE_ENFORCE(inputs[i].tensors->at(j).meta() == meta);
+      CAFFE_ENFORCE(rowDims(inputs[i], j) == dims);
+    }
 
-    for (int j = 0; j < numTensors; ++j) {
-      const auto& input = inputs[i][j];
+    // Resize to the final output size
+    auto outputDims = dims;
+    outputDims.insert(outputDims.begin(), numRows);
+    outputs[j]->Resize(outputDims);
+    auto* destination = static_cast<char*>(outputs[j]->raw_mutable_data(meta));
+    const auto rowSize = outputs[j]->size_from_dim(1);
 
-      CAFFE_ENFORCE(inputZero[j].meta() == input.meta());
-      CAFFE_ENFORCE_EQ(inputZero[j].itemsize(), input.itemsize());
-      CAFFE_ENFORCE_EQ(inputZero[j].ndim(), input.ndim());
-      for (int k = 0; k < input.ndim(); ++k) {
-        CAFFE_ENFORCE_EQ(input.dims()[k], inputZero[j].dims()[k]);
-      }
+    // Skip empty tensors
+    if (rowSize == 0) {
+      continue;
+    }
 
-      // Skip empty tensors
-      if (input.size() == 0) {
-        continue;
+    for (int i = 0; i < numRows;) {
+      int runEnd = i + 1;
+      while (runEnd < numRows && inputs[runEnd].row >= 0 &&
+             inputs[runEnd].tensors == inputs[i].tensors &&
+             inputs[runEnd].row == inputs[runEnd - 1].row + 1) {
+        ++runEnd;
       }
-
+      const auto runSize = (runEnd - i) * rowSize;
       context.CopyItems<CPUContext, CPUContext>(
-          input.meta(),
-          input.size(),
-          input.raw_data() /* src */,
-          destinations[j] /* dst */
-          );
-
-      destinations[j] =
-          (char*)destinations[j] + input.size() * input.itemsize();
+          meta, runSize, rowData(inputs[i], j) /* src */, destination /* dst */);
+      destination += runSize * meta.itemsize();
+      i = runEnd;
     }
   }
 }
 
-std::vector<std::vector<TensorCPU>> split(
+// Turns a batch into queue elements, one per row, that share one copy of the
+// batch
+std::vector<Element> split(
     CPUContext& context,
     const std::vector<const TensorCPU*>& inputs) {
   CAFFE_ENFORCE(!inputs.empty());
+  CAFFE_ENFORCE(inputs[0]);
+  CAFFE_ENFORCE(!inputs[0]->dims().empty());
 
   const auto outputSize = inputs[0]->dims().at(0);
-  std::vector<std::vector<TensorCPU>> outputs(outputSize);
+  auto batch = std::make_shared<std::vector<TensorCPU>>();
+  batch->reserve(inputs.size());
 
   for (const auto* inputPtr : inputs) {
     CAFFE_ENFORCE(inputPtr);
 
     const auto& input = *inputPtr;
-    const auto innerSize = input.size_from_dim(1);
-    const auto itemSize = input.meta().itemsize();
-
-    auto outputDims = input.dims();
-    CAFFE_ENFORCE(!outputDims.empty());
-    outputDims.erase(outputDims.begin());
+    CAFFE_ENFORCE(!input.dims().empty());
     CAFFE_ENFORCE_EQ(input.dims().at(0), outputSize);
 
-    for (int i = 0; i < outputSize; ++i) {
-      outputs[i].push_back(TensorCPU(outputDims));
+    batch->emplace_back(input.dims());
+    if (input.size() > 0) {
       context.CopyItems<CPUContext, CPUContext>(
           input.meta(),
-          innerSize,
-          (char*)input.raw_data() + i * innerSize * itemSize /* src */,
-          outputs[i].back().raw_mutable_data(input.meta()) /* dst */);
+          input.size(),
+          input.raw_data() /* src */,
+          batch->back().raw_mutable_data(input.meta()) /* dst */);
+    } else {
+      batch->back().raw_mutable_data(input.meta());
     }
   }
 
+  std::vector<Element> outputs(outputSize);
+  for (int i = 0; i < outputSize; ++i) {
+    outputs[i].tensors = batch;
+    outputs[i].row = i;
+  }
   return outputs;
 }
 } // anonymous namespace
@@ -111,12 +148,17 @@ bool RebatchingQueue::canRead() const {
 bool RebatchingQueue::dequeue(
     CPUContext& context,
     size_t numElements,
-    const std::vector<TensorCPU*>& outputs) {
-  std::vector<std::vector<TensorCPU>> results;
+    const std::vector<TensorCPU*>& outputs,
+    int64_t maxTokens,
+    int tokenBlob) {
+  CAFFE_ENFORCE(tokenBlob >= 0 && tokenBlob < numBlobs_);
+  std::vector<Element> results;
   results.reserve(numElements);
+  int64_t tokens = 0;
+  bool tokensFull = false;
 
   for (;;) {
-    if (results.size() == numElements) {
+    if (results.size() == numElements || tokensFull) {
       break;
     }
 
@@ -131,7 +173,17 @@ bool RebatchingQueue::dequeue(
       }
 
       do {
-        results.push_back(std::move(queue_[tail_++ % capacity()]));
+        auto& element = queue_[tail_ % capacity()];
+        if (maxTokens > 0) {
+          const auto elementTokens = numTokens(element, tokenBlob);
+          if (!results.empty() && tokens + elementTokens > maxTokens) {
+            tokensFull = true;
+            break;
+          }
+          tokens += elementTokens;
+        }
+        results.push_back(std::move(element));
+        ++tail_;
       } while (canRead() && results.size() < numElements);
     }
 
@@ -158,15 +210,15 @@ bool RebatchingQueue::canWrite() const {
 bool RebatchingQueue::enqueueOne(
     CPUContext& /*context*/,
     const std::vector<const TensorCPU*>& inputs) {
-  std::vector<std::vector<TensorCPU>> splittedInputs;
-  splittedInputs.emplace_back();
-  auto& tensorVector = splittedInputs.back();
-  tensorVector.reserve(inputs.size());
+  auto tensors = std::make_shared<std::vector<TensorCPU>>();
+  tensors->reserve(inputs.size());
   for (const auto* tensorPtr : inputs) {
-    tensorVector.push_back(*tensorPtr);
+    tensors->push_back(*tensorPtr);
   }
 
-  return enqueue(std::move(splittedInputs));
+  std::vector<Element> elements(1);
+  elements[0].tensors = std::move(tensors);
+  return enqueue(std::move(elements));
 }
 
 bool RebatchingQueue::enqueueMany(
@@ -174,13 +226,10 @@ bool RebatchingQueue::enqueueMany(
     const std::vector<const TensorCPU*>& inputs) {
   CAFFE_ENFORCE_EQ(numBlobs_, inputs.size());
 
-  std::vector<std::vector<TensorCPU>> splittedInputs;
-  splittedInputs = split(context, inputs);
-  return enqueue(std::move(splittedInputs));
+  return enqueue(split(context, inputs));
 }
 
-bool RebatchingQueue::enqueue(
-    std::vector<std::vector<TensorCPU>> splittedInputs) {
+bool RebatchingQueue::enqueue(std::vector<Element> splittedInputs) {
   int idx = 0;
   for (;;) {
     if (idx >= splittedInputs.size()) {
@@ -19,6 +19,15 @@ namespace caffe2 {
 
 class RebatchingQueue {
  public:
+  // A queue element is a row of a batch shared with the other elements
+  // enqueued together, so that enqueueMany does not copy the rows apart and
+  // dequeue can copy runs of consecutive rows at once. A row of -1 means that
+  // the tensors are the element itself (enqueueOne).
+  struct Element {
+    std::shared_ptr<const std::vector<TensorCPU>> tensors;
+    TIndex row{-1};
+  };
+
   RebatchingQueue(size_t capacity, size_t numBlobs);
 
   ~RebatchingQueue();
@@ -31,10 +40,17 @@ class RebatchingQueue {
       CPUContext& context,
       const std::vector<const TensorCPU*>& inputs);
 
+  // Dequeues up to numElements elements. If maxTokens is positive, also
+  // stops before the total number of tokens would exceed maxTokens, where the
+  // number of tokens of an element is the integer value of its tokenBlob-th
+  // tensor (e.g. the length of a sequence). At least one element is always
+  // returned.
   bool dequeue(
       CPUContext& context,
       size_t numElements,
-      const std::vector<TensorCPU*>& outputs);
+      const std::vector<TensorCPU*>& outputs,
+      int64_t maxTokens = 0,
+      int tokenBlob = 0);
 
   size_t capacity() const;
 
@@ -45,7 +61,7 @@ class RebatchingQueue {
   void close();
 
  private:
-  bool enqueue(std::vector<std::vector<TensorCPU>> splittedInputs);
+  bool enqueue(std::vector<Element> elements);
 
   bool canWrite() const;
   bool canRead() const;
@@ -63,6 +79,6 @@ class RebatchingQueue {
   std::condition_variable cvEmpty_;
   std::condition_variable cvOverflow_;
 
-  std::vector<std::vector<TensorCPU>> queue_;
+  std::vector<Element> queue_;
 };
 } // caffe2
@@ -67,6 +67,16 @@ tensor per component.
     .Input(1, "tensor", "First tensor to enqueue")
     .Arg(
         "num_elements",
-        "Number of elements to dequeue. By default we dequeue one element.");
+        "Number of elements to dequeue. By default we dequeue one element.")
+    .Arg(
+        "max_tokens",
+        "If positive, also stop dequeuing before the total number of tokens "
+        "of the dequeued elements exceeds max_tokens. At least one element "
+        "is dequeued.")
+    .Arg(
+        "token_blob",
+        "Index of the component holding the number of tokens of an element, "
+        "as a single int or int64 value (e.g. a sequence length). Defaults "
+        "to 0.");
 }
 }
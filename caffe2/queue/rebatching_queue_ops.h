@@ -48,7 +48,9 @@ class DequeueRebatchingQueueOp : public Operator<CPUContext> {
  public:
   DequeueRebatchingQueueOp(const OperatorDef& operator_def, Workspace* ws)
       : Operator(operator_def, ws),
-        numElements_(OperatorBase::GetSingleArgument<int>("num_elements", 1)) {}
+        numElements_(OperatorBase::GetSingleArgument<int>("num_elements", 1)),
+        maxTokens_(OperatorBase::GetSingleArgument<int64_t>("max_tokens", 0)),
+        tokenBlob_(OperatorBase::GetSingleArgument<int>("token_blob", 0)) {}
 
   bool RunOnDevice() override {
     auto& queue = Inputs()[0]->template Get<RebatchingQueuePtr>();
@@ -60,11 +62,14 @@ class DequeueRebatchingQueueOp : public Operator<CPUContext> {
       outputTensors.push_back(Output(i));
     }
 
-    return queue->dequeue(context_, numElements_, outputTensors);
+    return queue->dequeue(
+        context_, numElements_, outputTensors, maxTokens_, tokenBlob_);
   }
 
  private:
   int numElements_;
+  int64_t maxTokens_;
+  int tokenBlob_;
 };
 
 class CloseRebatchingQueueOp : public Operator<CPUContext> {
@@ -48,6 +48,8 @@ Given inputs (param, moment, indices, grad, lr), runs the dense AdaGrad
 update on (param, grad, moment[indices], lr), and returns (new_param,
 new_moment) as in the dense case.
 
+param and moment can both be float16; the update is computed in float.
+
 )DOC")
     .Input(0, "param", "Parameters to be updated")
     .Input(1, "moment", "Moment history")
@@ -75,6 +77,8 @@ applied to an entire row of param, and the new moment is calculated by adding
 the average squared sum of gradients across each row. Note that indices must
 also be a 1D tensor indexing into the rows of param.
 
+param can be float16, in which case moment is still float.
+
 )DOC")
     .Input(0, "param", "Parameters to be updated")
     .Input(1, "moment", "Moment history")
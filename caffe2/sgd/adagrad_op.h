@@ -1,6 +1,7 @@
 #pragma once
 
 #include "caffe2/core/operator.h"
+#include "caffe2/perfkernels/adagrad.h"
 
 namespace caffe2 {
 
@@ -163,63 +164,44 @@ class SparseAdagradOp final : public Operator<Context> {
 
   template <typename SIndex>
   bool DoRunWithType() {
-    const auto* lr = Input(LR).template data<T>();
-    const auto* indices = Input(INDICES).template data<SIndex>();
-    const auto* gradIn = Input(GRAD).template data<T>();
-    const auto* paramIn = Input(PARAM).template data<T>();
-    const auto* momentIn = Input(MOMENT_1).template data<T>();
-    auto* paramOut = Output(OUTPUT_PARAM)->template mutable_data<T>();
-    auto* momentOut = Output(OUTPUT_MOMENT_1)->template mutable_data<T>();
+    return DispatchHelper<TensorTypes2<float, float16>, SIndex>::call(
+        this, Input(PARAM));
+  }
 
+  template <typename SIndex, typename TParam>
+  bool DoRunWithType2() {
     auto n = Input(INDICES).size();
     if (n == 0) {
       return true;
     }
+    CAFFE_ENFORCE(
+        Input(MOMENT_1).template IsType<TParam>(),
+        "The moment must be of the type of the parameters");
 
-    auto block_size = Input(GRAD).size() / n;
-    for (auto i = 0; i < n; ++i) {
-      auto idx = indices[i];
-      if (block_size == 1) {
-        float gi = gradIn[i];
-        float hi = momentOut[idx] = momentIn[idx] + gi * gi;
-        paramOut[idx] = paramIn[idx] + lr[0] * gi / (std::sqrt(hi) + epsilon_);
-      } else {
-        auto offsetI = i * block_size;
-        auto offsetIdx = idx * block_size;
+    const auto* lr = Input(LR).template data<T>();
+    const auto* indices = Input(INDICES).template data<SIndex>();
+    const auto* gradIn = Input(GRAD).template data<T>();
+    // updated in place, see EnforceOneToOneInplace
+    auto* param = Output(OUTPUT_PARAM)->template mutable_data<TParam>();
+    auto* moment = Output(OUTPUT_MOMENT_1)->template mutable_data<TParam>();
 
+    auto block_size = Input(GRAD).size() / n;
 #ifndef NDEBUG
-        CAFFE_ENFORCE_GE(
-            Input(PARAM).size(),
-            block_size + offsetIdx,
-            this->debug_def().input(PARAM),
-            ", out of bound,  idx:",
-            idx,
-            " for input i:",
-            i,
-            " and block size:",
-            block_size);
-        CAFFE_ENFORCE_GE(
-            Input(GRAD).size(),
-            block_size + offsetI,
-            this->debug_def().input(GRAD),
-            ", out of bound idx, idx:",
-            idx,
-            " for input i:",
-            i);
-#endif
-        adagrad_update(
-            block_size,
-            paramIn + offsetIdx,
-            gradIn + offsetI,
-            momentIn + offsetIdx,
-            paramOut + offsetIdx,
-            momentOut + offsetIdx,
-            epsilon_,
-            1.0f,
-            lr,
-            &context_);
-      }
+    for (auto i = 0; i < n; ++i) {
+      CAFFE_ENFORCE_GE(
+          Input(PARAM).size(),
+          block_size + indices[i] * block_size,
+          this->debug_def().input(PARAM),
+          ", out of bound,  idx:",
+          indices[i],
+          " for input i:",
+          i,
+          " and block size:",
+          block_size);
     }
+#endif
+    SparseAdagrad<SIndex, TParam>(
+        block_size, n, indices, gradIn, param, moment, epsilon_, lr[0]);
     return true;
   }
 
@@ -251,69 +233,41 @@ class RowWiseSparseAdagradOp final : public Operator<Context> {
 
   template <typename SIndex>
   bool DoRunWithType() {
-    const auto* lr = Input(LR).template data<T>();
-    const auto* indices = Input(INDICES).template data<SIndex>();
-    const auto* gradIn = Input(GRAD).template data<T>();
-    const auto* paramIn = Input(PARAM).template data<T>();
-    const auto* momentIn = Input(MOMENT_1).template data<T>();
-    auto* paramOut = Output(OUTPUT_PARAM)->template mutable_data<T>();
-    auto* momentOut = Output(OUTPUT_MOMENT_1)->template mutable_data<T>();
+    return DispatchHelper<TensorTypes2<float, float16>, SIndex>::call(
+        this, Input(PARAM));
+  }
 
+  template <typename SIndex, typename TParam>
+  bool DoRunWithType2() {
     auto n = Input(INDICES).size();
     if (n == 0) {
       return true;
     }
 
-    auto block_size = Input(GRAD).size() / n;
-
-    for (auto i = 0; i < n; ++i) {
-      auto idx = indices[i];
-      if (block_size == 1) {
-        float gi = gradIn[i];
-        float hi = momentOut[idx] = momentIn[idx] + gi * gi;
-        paramOut[idx] = paramIn[idx] + lr[0] * gi / (std::sqrt(hi) + epsilon_);
-      } else {
-        auto offsetI = i * block_size;
-        auto offsetIdx = idx * block_size;
+    const auto* lr = Input(LR).template data<T>();
+    const auto* indices = Input(INDICES).template data<SIndex>();
+    const auto* gradIn = Input(GRAD).template data<T>();
+    // updated in place, see EnforceOneToOneInplace
+    auto* param = Output(OUTPUT_PARAM)->template mutable_data<TParam>();
+    auto* moment = Output(OUTPUT_MOMENT_1)->template mutable_data<T>();
 
+    auto block_size = Input(GRAD).size() / n;
 #ifndef NDEBUG
-        CAFFE_ENFORCE_GE(
-            Input(PARAM).size(),
-            block_size + offsetIdx,
-            this->debug_def().input(PARAM),
-            ", out of bound,  idx:",
-            idx,
-            " for input i:",
-            i,
-            " and block size:",
-            block_size);
-        CAFFE_ENFORCE_GE(
-            Input(GRAD).size(),
-            block_size + offsetI,
-            this->debug_def().input(GRAD),
-            ", out of bound idx, idx:",
-            idx,
-            " for input i:",
-            i);
-#endif
-
-        const float* w = paramIn + offsetIdx;
-        const float* g = gradIn + offsetI;
-        const float* h = momentIn + idx;
-        float* nw = paramOut + offsetIdx;
-        float* nh = momentOut + idx;
-        float hs = 0.;
-        for (auto j = 0; j < block_size; ++j) {
-          float gj = g[j];
-          hs += gj * gj;
-        }
-        float hi = nh[0] = h[0] + hs / block_size;
-        float step = lr[0] / (std::sqrt(hi) + epsilon_);
-        for (auto j = 0; j < block_size; ++j) {
-          nw[j] = w[j] + g[j] * step;
-        }
-      }
+    for (auto i = 0; i < n; ++i) {
+      CAFFE_ENFORCE_GE(
+          Input(PARAM).size(),
+          block_size + indices[i] * block_size,
+          this->debug_def().input(PARAM),
+          ", out of bound,  idx:",
+          indices[i],
+          " for input i:",
+          i,
+          " and block size:",
+          block_size);
     }
+#endif
+    RowWiseSparseAdagrad<SIndex, TParam>(
+        block_size, n, indices, gradIn, param, moment, epsilon_, lr[0]);
     return true;
   }
 
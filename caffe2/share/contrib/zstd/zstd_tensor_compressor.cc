@@ -0,0 +1,60 @@
+#include <stdint.h>
+#include <cstring>
+#include <zstd.h>
+
+#include "caffe2/core/blob_serialization.h"
+#include "caffe2/core/flags.h"
+#include "caffe2/core/logging.h"
+
+CAFFE2_DEFINE_int(
+    caffe2_zstd_compression_level,
+    3,
+    "The zstd level to compress serialized tensors with");
+
+namespace caffe2 {
+
+namespace {
+
+// The compressed data is the size of the data, as a uint64_t, followed by a
+// zstd frame
+class ZstdTensorCompressor : public TensorCompressor {
+ public:
+  string Compress(const string& data) override {
+    uint64_t size = data.size();
+    string compressed(sizeof(size) + ZSTD_compressBound(size), '\0');
+    std::memcpy(&compressed[0], &size, sizeof(size));
+    size_t compressed_size = ZSTD_compress(
+        &compressed[sizeof(size)],
+        compressed.size() - sizeof(size),
+        data.data(),
+        size,
+        FLAGS_caffe2_zstd_compression_level);
+    CAFFE_ENFORCE(
+        !ZSTD_isError(compressed_size), ZSTD_getErrorName(compressed_size));
+    compressed.resize(sizeof(size) + compressed_size);
+    return compressed;
+  }
+
+  string Decompress(const string& compressed) override {
+    uint64_t size;
+    CAFFE_ENFORCE_GE(compressed.size(), sizeof(size), "Truncated zstd data");
+    std::memcpy(&size, compressed.data(), sizeof(size));
+    string data(size, '\0');
+    size_t decompressed_size = ZSTD_decompress(
+        &data[0],
+        size,
+        compressed.data() + sizeof(size),
+        compressed.size() - sizeof(size));
+    CAFFE_ENFORCE(
+        !ZSTD_isError(decompressed_size),
+        ZSTD_getErrorName(decompressed_size));
+    CAFFE_ENFORCE_EQ(decompressed_size, size, "Truncated zstd data");
+    return data;
+  }
+};
+
+} // namespace
+
+REGISTER_TENSOR_COMPRESSOR(zstd, ZstdTensorCompressor);
+
+} // namespace caffe2
@@ -130,6 +130,26 @@ bool PatternNetTransform::PatternRule(
   return true;
 }
 
+std::vector<int> PatternNetTransform::PatternAnchors(
+    const transform::Graph& g) {
+  if (ordered_ops_.empty()) {
+    return {};
+  }
+  const string& type = p_.node(ordered_ops_[0]).op.type();
+  if (type == "*") {
+    return Transform::PatternAnchors(g);
+  }
+  const auto choices = split('|', type);
+  const std::unordered_set<string> types(choices.begin(), choices.end());
+  std::vector<int> anchors;
+  for (int idx = 0; idx < g.size(); ++idx) {
+    if (types.count(g.node(idx).op.type())) {
+      anchors.push_back(idx);
+    }
+  }
+  return anchors;
+}
+
 bool PatternNetTransform::ValidatorRule(
     const transform::Graph& /*g*/,
     const std::vector<int>& subgraph) {
@@ -59,6 +59,12 @@ class PatternNetTransform : public Transform {
       const transform::Graph& g,
       const std::vector<int>& subgraph,
       int idx) override;
+  /**
+   * PatternAnchors for PatternNetTransform returns the nodes whose type can
+   * match the first operator of ordered_ops, so that matching is only
+   * attempted where the pattern can start.
+   */
+  std::vector<int> PatternAnchors(const transform::Graph& g) override;
   /**
    * ValidatorRule for PatternNetTransform does the following:
    *
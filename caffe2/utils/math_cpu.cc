@@ -27,6 +27,7 @@
 
 #include "caffe2/utils/cpu_neon.h"
 #include "caffe2/core/context.h"
+#include "caffe2/perfkernels/transpose.h"
 
 #include "Eigen/Core"
 #include "Eigen/Dense"
@@ -844,21 +845,57 @@ void BroadcastImpl(
     const T* X,
     T* Y) {
   CAFFE_ENFORCE_LE(X_ndim, Y_ndim);
-  std::vector<int> X_dims_ex(Y_ndim);
+  // Merge the adjacent dims of Y that are either all broadcasted from X or all
+  // taken from X, so that the innermost one is a contiguous run of Y that is
+  // either filled with one value of X or copied from X.
+  std::vector<int> dims;
+  std::vector<bool> broadcasted;
   const int d = Y_ndim - X_ndim;
-  std::fill(X_dims_ex.begin(), X_dims_ex.begin() + d, 1);
-  for (int i = d; i < Y_ndim; ++i) {
-    CAFFE_ENFORCE(X_dims[i - d] == 1 || X_dims[i - d] == Y_dims[i]);
-    X_dims_ex[i] = X_dims[i - d];
+  for (int i = 0; i < Y_ndim; ++i) {
+    const int X_dim = i < d ? 1 : X_dims[i - d];
+    CAFFE_ENFORCE(X_dim == 1 || X_dim == Y_dims[i]);
+    if (Y_dims[i] == 1) {
+      continue;
+    }
+    const bool is_broadcasted = X_dim == 1;
+    if (!dims.empty() && broadcasted.back() == is_broadcasted) {
+      dims.back() *= Y_dims[i];
+    } else {
+      dims.push_back(Y_dims[i]);
+      broadcasted.push_back(is_broadcasted);
+    }
   }
   const int Y_size =
       std::accumulate(Y_dims, Y_dims + Y_ndim, 1, std::multiplies<int>());
-  std::vector<int> index(Y_ndim, 0);
-  for (int Y_index = 0; Y_index < Y_size; ++Y_index) {
-    const int X_index =
-        internal::GetIndexFromDims(Y_ndim, X_dims_ex.data(), index.data());
-    Y[Y_index] = X[X_index];
-    internal::IncreaseIndexInDims(Y_ndim, Y_dims, index.data());
+  if (Y_size == 0) {
+    return;
+  }
+  if (dims.empty()) {
+    Y[0] = X[0];
+    return;
+  }
+  const int ndim = dims.size();
+  std::vector<int> X_strides(ndim, 0);
+  for (int i = ndim - 1, stride = 1; i >= 0; --i) {
+    if (!broadcasted[i]) {
+      X_strides[i] = stride;
+      stride *= dims[i];
+    }
+  }
+  const int inner_size = dims.back();
+  const int outer_size = Y_size / inner_size;
+  std::vector<int> index(ndim - 1, 0);
+  for (int Y_index = 0; Y_index < outer_size; ++Y_index) {
+    const T* X_ptr = X +
+        std::inner_product(
+                     X_strides.cbegin(), X_strides.cend() - 1, index.cbegin(), 0);
+    T* Y_ptr = Y + Y_index * inner_size;
+    if (broadcasted.back()) {
+      std::fill(Y_ptr, Y_ptr + inner_size, *X_ptr);
+    } else {
+      std::copy(X_ptr, X_ptr + inner_size, Y_ptr);
+    }
+    internal::IncreaseIndexInDims(ndim - 1, dims.data(), index.data());
   }
 }
 
@@ -1837,6 +1874,54 @@ ComputeXStrides(const int ndim, const int* dims, const int* axes) {
   return x_strides;
 }
 
+// Drops the dims of size 1 and merges the runs of axes that stay adjacent in
+// Y, e.g. the NCHW to NHWC transpose of X with dims (N, C, H, W) and axes
+// (0, 2, 3, 1) becomes the transpose of X with dims (N, C, H * W) and axes
+// (0, 2, 1).
+void CollapseTransposeDims(
+    const int ndim,
+    const int* dims,
+    const int* axes,
+    std::vector<int>* new_dims,
+    std::vector<int>* new_axes) {
+  std::vector<int> kept(ndim, -1);
+  int num_kept = 0;
+  for (int i = 0; i < ndim; ++i) {
+    if (dims[i] != 1) {
+      kept[i] = num_kept++;
+    }
+  }
+  // The axes of the merged dims of Y, given by their first axis of X
+  std::vector<int> group_starts;
+  std::vector<int> group_dims;
+  int prev = -2;
+  for (int i = 0; i < ndim; ++i) {
+    const int axis = kept[axes[i]];
+    if (axis < 0) {
+      continue;
+    }
+    if (axis == prev + 1) {
+      group_dims.back() *= dims[axes[i]];
+    } else {
+      group_starts.push_back(axis);
+      group_dims.push_back(dims[axes[i]]);
+    }
+    prev = axis;
+  }
+  const int num_groups = group_starts.size();
+  std::vector<int> order(num_groups);
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(), [&group_starts](int a, int b) {
+    return group_starts[a] < group_starts[b];
+  });
+  new_dims->resize(num_groups);
+  new_axes->resize(num_groups);
+  for (int i = 0; i < num_groups; ++i) {
+    (*new_dims)[i] = group_dims[order[i]];
+    (*new_axes)[order[i]] = i;
+  }
+}
+
 template <typename T>
 void TransposeCPUImpl(
     const int ndim,
@@ -1844,25 +1929,41 @@ void TransposeCPUImpl(
     const int* axes,
     const T* X,
     T* Y) {
-  std::vector<int> Y_dims(ndim);
-  for (int i = 0; i < ndim; ++i) {
-    Y_dims[i] = dims[axes[i]];
+  std::vector<int> X_dims;
+  std::vector<int> Y_axes;
+  CollapseTransposeDims(ndim, dims, axes, &X_dims, &Y_axes);
+  const int X_size =
+      std::accumulate(dims, dims + ndim, 1, std::multiplies<int>());
+  const int merged_ndim = X_dims.size();
+  if (merged_ndim < 2) {
+    std::memcpy(Y, X, X_size * sizeof(T));
+    return;
+  }
+  // Transposes of matrices, such as between NCHW and NHWC, go by tiles
+  if (merged_ndim == 2) {
+    BatchedTranspose2D<T>(1, X_dims[0], X_dims[1], X, Y);
+    return;
+  }
+  if (merged_ndim == 3 && Y_axes[0] == 0) {
+    BatchedTranspose2D<T>(X_dims[0], X_dims[1], X_dims[2], X, Y);
+    return;
+  }
+  std::vector<int> Y_dims(merged_ndim);
+  for (int i = 0; i < merged_ndim; ++i) {
+    Y_dims[i] = X_dims[Y_axes[i]];
   }
   // Measure amount of contiguous data we can copy at once
   int block_size = 1;
   int num_shared_idx = 0;
-  for (int i = ndim - 1; i >= 0 && axes[i] == i; --i) {
+  for (int i = merged_ndim - 1; i >= 0 && Y_axes[i] == i; --i) {
     block_size *= Y_dims[i];
     ++num_shared_idx;
   }
-  const int itr_axes = ndim - num_shared_idx;
+  const int itr_axes = merged_ndim - num_shared_idx;
   const int num_blocks = std::accumulate(
       Y_dims.cbegin(), Y_dims.cbegin() + itr_axes, 1, std::multiplies<int>());
-  if (ndim < 2 || itr_axes == 0) {
-    std::memcpy(Y, X, num_blocks * block_size * sizeof(T));
-    return;
-  }
-  const std::vector<int> X_strides = ComputeXStrides(itr_axes, dims, axes);
+  const std::vector<int> X_strides =
+      ComputeXStrides(itr_axes, X_dims.data(), Y_axes.data());
   std::vector<int> index(itr_axes, 0);
   for (int Y_index = 0; Y_index < num_blocks; ++Y_index) {
     const int X_index = std::inner_product(
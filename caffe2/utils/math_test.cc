@@ -1,4 +1,6 @@
+#include <functional>
 #include <memory>
+#include <numeric>
 #include <vector>
 
 #include <gtest/gtest.h>
@@ -687,6 +689,22 @@ TEST_F(BroadcastTest, BroadcastFloatTest) {
       {2, 2, 2},
       {1.0f, 2.0f},
       {1.0f, 1.0f, 2.0f, 2.0f, 1.0f, 1.0f, 2.0f, 2.0f});
+  RunBroadcastTest(
+      {1, 2, 1},
+      {2, 2, 2},
+      {1.0f, 2.0f},
+      {1.0f, 1.0f, 2.0f, 2.0f, 1.0f, 1.0f, 2.0f, 2.0f});
+  RunBroadcastTest(
+      {2, 1, 2},
+      {2, 2, 2},
+      {1.0f, 2.0f, 3.0f, 4.0f},
+      {1.0f, 2.0f, 1.0f, 2.0f, 3.0f, 4.0f, 3.0f, 4.0f});
+  RunBroadcastTest(
+      {1, 1},
+      {1, 2, 1},
+      {1.0f},
+      {1.0f, 1.0f});
+  RunBroadcastTest({1, 1}, {1, 1}, {1.0f}, {1.0f});
 }
 
 class MomentsTest : public testing::Test {
@@ -849,6 +867,51 @@ TEST_F(TransposeTest, TransposeFloatTest) {
       {1.0f, 2.0f, 5.0f, 6.0f, 3.0f, 4.0f, 7.0f, 8.0f});
 }
 
+TEST_F(TransposeTest, TransposeLargeFloatTest) {
+  // Sizes that are not multiples of the tiles, with unit dims and runs of
+  // axes that merge, such as NCHW to NHWC and back
+  const std::vector<std::pair<std::vector<int>, std::vector<int>>> cases = {
+      {{37, 45}, {1, 0}},
+      {{64, 128}, {1, 0}},
+      {{3, 17, 33}, {0, 2, 1}},
+      {{2, 19, 5, 7}, {0, 2, 3, 1}},
+      {{2, 5, 7, 19}, {0, 3, 1, 2}},
+      {{1, 9, 1, 11}, {3, 1, 2, 0}},
+      {{4, 3, 5, 6}, {2, 0, 3, 1}},
+      {{4, 3, 5, 6}, {1, 0, 2, 3}},
+  };
+  for (const auto& c : cases) {
+    const std::vector<int>& X_dims = c.first;
+    const std::vector<int>& axes = c.second;
+    const int ndim = X_dims.size();
+    const int size = std::accumulate(
+        X_dims.cbegin(), X_dims.cend(), 1, std::multiplies<int>());
+    std::vector<float> X_data(size);
+    std::iota(X_data.begin(), X_data.end(), 0.0f);
+    std::vector<int> Y_dims(ndim);
+    for (int i = 0; i < ndim; ++i) {
+      Y_dims[i] = X_dims[axes[i]];
+    }
+    std::vector<float> Y_data(size);
+    std::vector<int> index(ndim, 0);
+    for (int Y_index = 0; Y_index < size; ++Y_index) {
+      int X_index = 0;
+      for (int i = 0; i < ndim; ++i) {
+        int stride = 1;
+        for (int j = axes[i] + 1; j < ndim; ++j) {
+          stride *= X_dims[j];
+        }
+        X_index += index[i] * stride;
+      }
+      Y_data[Y_index] = X_data[X_index];
+      for (int i = ndim - 1; i >= 0 && ++index[i] == Y_dims[i]; --i) {
+        index[i] = 0;
+      }
+    }
+    RunTransposeTest(X_dims, axes, X_data, Y_data);
+  }
+}
+
 } // namespace
 
 } // namespace caffe2
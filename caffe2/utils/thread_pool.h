@@ -1,17 +1,33 @@
 #ifndef CAFFE2_UTILS_THREAD_POOL_H_
 #define CAFFE2_UTILS_THREAD_POOL_H_
 
+#include <atomic>
 #include <condition_variable>
+#include <deque>
 #include <functional>
+#include <memory>
 #include <mutex>
 #include <queue>
 #include <thread>
 #include <utility>
 
 #include "caffe2/core/numa.h"
+#include "caffe2/core/thread_budget.h"
 
 namespace caffe2 {
 
+/**
+ * A fixed size pool of threads running tasks.
+ *
+ * By default all tasks go through a single queue. With `work_stealing` every
+ * thread has its own deque instead: a task submitted from one of the pool's
+ * threads goes to that thread's deque, which the thread serves last in, first
+ * out, so that a task scheduled by another one (e.g. the successor of an
+ * operator chain) tends to run next on the same core. Other tasks are spread
+ * over the deques round-robin. Idle threads steal from the front of the other
+ * deques before going to sleep, and the pool-wide mutex is only taken to put
+ * threads to sleep and to wake them up.
+ */
 class TaskThreadPool {
  private:
   struct task_element_t {
@@ -25,25 +41,59 @@ class TaskThreadPool {
         : run_with_id(true), no_id(nullptr), with_id(f) {}
   };
 
+  struct worker_queue_t {
+    std::mutex mutex;
+    std::deque<task_element_t> tasks;
+  };
+
+  struct worker_id_t {
+    const TaskThreadPool* pool;
+    std::size_t index;
+  };
+
   std::queue<task_element_t> tasks_;
   std::vector<std::thread> threads_;
   std::mutex mutex_;
   std::condition_variable condition_;
   std::condition_variable completed_;
-  bool running_;
+  std::atomic<bool> running_;
   bool complete_;
-  std::size_t available_;
+  std::atomic<std::size_t> available_;
   std::size_t total_;
   int numa_node_id_;
 
+  // Only used with work stealing: one deque per thread, the number of tasks
+  // in the deques and the number of threads waiting on condition_.
+  std::vector<std::unique_ptr<worker_queue_t>> worker_queues_;
+  std::atomic<std::size_t> pending_;
+  std::atomic<std::size_t> sleeping_;
+  std::atomic<std::size_t> next_queue_;
+
+  // The pool and index of the calling thread, if it is a pool thread.
+  static worker_id_t& current_worker() {
+    static thread_local worker_id_t id{nullptr, 0};
+    return id;
+  }
+
  public:
-  explicit TaskThreadPool(std::size_t pool_size, int numa_node_id = -1)
+  explicit TaskThreadPool(
+      std::size_t pool_size,
+      int numa_node_id = -1,
+      bool work_stealing = false)
       : threads_(pool_size),
         running_(true),
         complete_(true),
         available_(pool_size),
         total_(pool_size),
-        numa_node_id_(numa_node_id) {
+        numa_node_id_(numa_node_id),
+        pending_(0),
+        sleeping_(0),
+        next_queue_(0) {
+    if (work_stealing) {
+      for (std::size_t i = 0; i < pool_size; ++i) {
+        worker_queues_.emplace_back(new worker_queue_t());
+      }
+    }
     for (std::size_t i = 0; i < pool_size; ++i) {
       threads_[i] = std::thread(std::bind(&TaskThreadPool::main_loop, this, i));
     }
@@ -76,16 +126,14 @@ class TaskThreadPool {
     return available_;
   }
 
+  bool work_stealing() const {
+    return !worker_queues_.empty();
+  }
+
   /// @brief Add task to the thread pool if a thread is currently available.
   template <typename Task>
   void runTask(Task task) {
-    std::unique_lock<std::mutex> lock(mutex_);
-
-    // Set task and signal condition variable so that a worker thread will
-    // wake up and use the task.
-    tasks_.push(task_element_t(static_cast<std::function<void()>>(task)));
-    complete_ = false;
-    condition_.notify_one();
+    push(task_element_t(static_cast<std::function<void()>>(task)));
   }
 
   void run(const std::function<void()>& func) {
@@ -94,28 +142,123 @@ class TaskThreadPool {
 
   template <typename Task>
   void runTaskWithID(Task task) {
-    std::unique_lock<std::mutex> lock(mutex_);
-
-    // Set task and signal condition variable so that a worker thread will
-    // wake up and use the task.
-    tasks_.push(
-        task_element_t(static_cast<std::function<void(std::size_t)>>(task)));
-    complete_ = false;
-    condition_.notify_one();
+    push(task_element_t(static_cast<std::function<void(std::size_t)>>(task)));
   }
 
   /// @brief Wait for queue to be empty
   void waitWorkComplete() {
     std::unique_lock<std::mutex> lock(mutex_);
+    if (work_stealing()) {
+      completed_.wait(
+          lock, [this] { return pending_ == 0 && available_ == total_; });
+      return;
+    }
     while (!complete_) {
       completed_.wait(lock);
     }
   }
 
  private:
+  void push(task_element_t task) {
+    if (!work_stealing()) {
+      std::unique_lock<std::mutex> lock(mutex_);
+
+      // Set task and signal condition variable so that a worker thread will
+      // wake up and use the task.
+      tasks_.push(std::move(task));
+      complete_ = false;
+      condition_.notify_one();
+      return;
+    }
+
+    const auto& worker = current_worker();
+    auto index = worker.pool == this
+        ? worker.index
+        : next_queue_++ % worker_queues_.size();
+    {
+      auto& queue = *worker_queues_[index];
+      std::lock_guard<std::mutex> lock(queue.mutex);
+      queue.tasks.push_back(std::move(task));
+    }
+    // A thread going to sleep increments sleeping_ before checking pending_,
+    // so either it sees this task or the wake up below.
+    ++pending_;
+    if (sleeping_ > 0) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      condition_.notify_one();
+    }
+  }
+
+  /// @brief Pops a task from the thread's own deque, or steals one.
+  bool take(std::size_t index, std::unique_ptr<task_element_t>* task) {
+    const auto size = worker_queues_.size();
+    for (std::size_t i = 0; i < size; ++i) {
+      auto& queue = *worker_queues_[(index + i) % size];
+      std::lock_guard<std::mutex> lock(queue.mutex);
+      if (queue.tasks.empty()) {
+        continue;
+      }
+      if (i == 0) {
+        task->reset(new task_element_t(std::move(queue.tasks.back())));
+        queue.tasks.pop_back();
+      } else {
+        task->reset(new task_element_t(std::move(queue.tasks.front())));
+        queue.tasks.pop_front();
+      }
+      --pending_;
+      return true;
+    }
+    return false;
+  }
+
+  static void run_task(const task_element_t& task, std::size_t index) {
+    try {
+      if (task.run_with_id) {
+        task.with_id(index);
+      } else {
+        task.no_id();
+      }
+    } catch (const std::exception&) {
+    }
+  }
+
+  /// @brief Entry point for pool threads with work stealing.
+  void work_stealing_loop(std::size_t index) {
+    current_worker() = worker_id_t{this, index};
+
+    while (running_) {
+      std::unique_ptr<task_element_t> task;
+      if (take(index, &task)) {
+        --available_;
+        run_task(*task, index);
+        task.reset();
+        if (++available_ == total_ && pending_ == 0) {
+          std::lock_guard<std::mutex> lock(mutex_);
+          completed_.notify_all();
+        }
+        continue;
+      }
+
+      std::unique_lock<std::mutex> lock(mutex_);
+      ++sleeping_;
+      while (pending_ == 0 && running_) {
+        condition_.wait(lock);
+      }
+      --sleeping_;
+    }
+  }
+
   /// @brief Entry point for pool threads.
   void main_loop(std::size_t index) {
     NUMABind(numa_node_id_);
+    if (IsThreadBudgetEnabled()) {
+      SetIntraOpThreads(GetThreadBudget(numa_node_id_).intra_op_threads);
+    }
+
+    if (work_stealing()) {
+      work_stealing_loop(index);
+      return;
+    }
 
     while (running_) {
       // Wait on condition variable while the task is empty and
@@ -143,14 +286,7 @@ class TaskThreadPool {
         lock.unlock();
 
         // Run the task.
-        try {
-          if (tasks.run_with_id) {
-            tasks.with_id(index);
-          } else {
-            tasks.no_id();
-          }
-        } catch (const std::exception&) {
-        }
+        run_task(tasks, index);
 
         // Update status of empty, maybe
         // Need to recover the lock first
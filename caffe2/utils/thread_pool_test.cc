@@ -0,0 +1,65 @@
+#include <atomic>
+
+#include <gtest/gtest.h>
+#include "caffe2/utils/thread_pool.h"
+
+namespace caffe2 {
+
+namespace {
+
+void testRunTasks(bool work_stealing) {
+  TaskThreadPool pool(4, -1, work_stealing);
+  EXPECT_EQ(pool.work_stealing(), work_stealing);
+  std::atomic<int> count(0);
+  std::atomic<int> bad_ids(0);
+  for (int i = 0; i < 1000; ++i) {
+    pool.run([&count] { ++count; });
+    pool.runTaskWithID([&bad_ids](std::size_t id) {
+      if (id >= 4) {
+        ++bad_ids;
+      }
+    });
+  }
+  pool.waitWorkComplete();
+  EXPECT_EQ(count.load(), 1000);
+  EXPECT_EQ(bad_ids.load(), 0);
+  EXPECT_EQ(pool.num_available(), 4);
+}
+
+// Every task schedules two more until the given depth, like operator chains
+// scheduling their children from pool threads.
+void spawn(TaskThreadPool* pool, std::atomic<int>* count, int depth) {
+  ++*count;
+  if (depth > 0) {
+    for (int i = 0; i < 2; ++i) {
+      pool->run([pool, count, depth] { spawn(pool, count, depth - 1); });
+    }
+  }
+}
+
+void testNestedTasks(bool work_stealing) {
+  TaskThreadPool pool(4, -1, work_stealing);
+  std::atomic<int> count(0);
+  pool.run([&pool, &count] { spawn(&pool, &count, 10); });
+  pool.waitWorkComplete();
+  EXPECT_EQ(count.load(), (1 << 11) - 1);
+}
+} // namespace
+
+TEST(ThreadPoolTest, RunTasks) {
+  testRunTasks(false);
+}
+
+TEST(ThreadPoolTest, RunTasksWorkStealing) {
+  testRunTasks(true);
+}
+
+TEST(ThreadPoolTest, NestedTasks) {
+  testNestedTasks(false);
+}
+
+TEST(ThreadPoolTest, NestedTasksWorkStealing) {
+  testNestedTasks(true);
+}
+
+} // namespace caffe2
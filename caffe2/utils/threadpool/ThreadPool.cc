@@ -1,6 +1,9 @@
 #include "caffe2/utils/threadpool/ThreadPool.h"
 #include "WorkersPool.h"
 #include "caffe2/core/logging.h"
+#include "caffe2/core/thread_budget.h"
+
+#include <algorithm>
 
 #include <cpuinfo.h>
 
@@ -76,6 +79,11 @@ std::unique_ptr<ThreadPool> ThreadPool::defaultThreadPool() {
         break;
     }
   }
+  if (caffe2::IsThreadBudgetEnabled()) {
+    // The pool runs the intra-op work of the workspace's operators
+    numThreads = std::min(
+        numThreads, caffe2::GetThreadBudget().intra_op_threads);
+  }
   LOG(INFO) << "Constructing thread pool with " << numThreads << " threads";
   return caffe2::make_unique<ThreadPool>(numThreads);
 }
@@ -0,0 +1,160 @@
+#include <caffe2/core/common_gpu.h>
+#include <caffe2/core/context_gpu.h>
+#include <caffe2/video/optical_flow_gpu.h>
+
+namespace caffe2 {
+
+namespace {
+
+// At most two flow channels and three RGB channels
+constexpr int kMaxFlowChannels = 5;
+
+struct FlowNormalization {
+  float mean[kMaxFlowChannels];
+  float inv_std[kMaxFlowChannels];
+};
+
+// Same fixed point weights and rounding as cv::COLOR_RGB2GRAY on bytes
+__device__ inline int RGBToGray(const unsigned char* rgb) {
+  return (rgb[0] * 4899 + rgb[1] * 9617 + rgb[2] * 1868 + (1 << 13)) >> 14;
+}
+
+template <typename T>
+__global__ void RGBToGrayKernel(
+    const int N,
+    const float scale,
+    const unsigned char* rgb,
+    T* gray) {
+  CUDA_1D_KERNEL_LOOP(i, N) {
+    gray[i] = static_cast<T>(RGBToGray(rgb + 3 * i) * scale);
+  }
+}
+
+// One thread per pixel of every flow, N = num_clips * length_of * height *
+// width. flows holds the num_frames - 1 flows of each flow clip, frames its
+// num_frames RGB frames.
+__global__ void TransformOpticalFlowKernel(
+    const int N,
+    const int length_of,
+    const int num_frames,
+    const int height,
+    const int width,
+    const bool magnitude,
+    const int image_channels,
+    const FlowNormalization norm,
+    const float2* flows,
+    const unsigned char* frames,
+    float* clip_of) {
+  const int frame_size = height * width;
+  const int channel_size = length_of * frame_size;
+  const int channels_of = (magnitude ? 3 : 2) + image_channels;
+  CUDA_1D_KERNEL_LOOP(i, N) {
+    const int p = i % frame_size;
+    const int clip = i / frame_size;
+    const int x = p % width;
+    const int y = p / width;
+
+    // Follow the pixel through the flows, as MergeOpticalFlow does
+    const float2* flow = flows + clip * (num_frames - 1) * frame_size;
+    float2 u = flow[p];
+    for (int j = 1; j < num_frames - 1; ++j) {
+      const int x_new = min(width - 1, max(0, __float2int_rn(u.x + x)));
+      const int y_new = min(height - 1, max(0, __float2int_rn(u.y + y)));
+      const float2 u_new = flow[j * frame_size + y_new * width + x_new];
+      u.x += u_new.x;
+      u.y += u_new.y;
+    }
+
+    float* out = clip_of + (clip / length_of) * channels_of * channel_size +
+        (clip % length_of) * frame_size + p;
+    const float flow_x = (u.x - norm.mean[0]) * norm.inv_std[0];
+    const float flow_y = (u.y - norm.mean[1]) * norm.inv_std[1];
+    out[0] = flow_x;
+    out[channel_size] = flow_y;
+    if (magnitude) {
+      // of the normalized flow, like on the CPU
+      out[2 * channel_size] =
+          (fabsf(flow_x) + fabsf(flow_y) - norm.mean[2]) * norm.inv_std[2];
+    }
+
+    // the first frame of the clip
+    const unsigned char* rgb = frames + (clip * num_frames * frame_size + p) * 3;
+    if (image_channels == 1) {
+      out[2 * channel_size] =
+          (RGBToGray(rgb) - norm.mean[2]) * norm.inv_std[2];
+    } else {
+      for (int c = 0; c < image_channels; ++c) {
+        out[(2 + c) * channel_size] =
+            (rgb[c] - norm.mean[2 + c]) * norm.inv_std[2 + c];
+      }
+    }
+  }
+}
+
+} // namespace
+
+void RGBToGrayGPU(
+    const int num_pixels,
+    const unsigned char* rgb,
+    unsigned char* gray,
+    CUDAContext* context) {
+  RGBToGrayKernel<unsigned char>
+      <<<CAFFE_GET_BLOCKS(num_pixels),
+         CAFFE_CUDA_NUM_THREADS,
+         0,
+         context->cuda_stream()>>>(num_pixels, 1.f, rgb, gray);
+}
+
+void RGBToGrayGPU(
+    const int num_pixels,
+    const unsigned char* rgb,
+    float* gray,
+    CUDAContext* context) {
+  RGBToGrayKernel<float>
+      <<<CAFFE_GET_BLOCKS(num_pixels),
+         CAFFE_CUDA_NUM_THREADS,
+         0,
+         context->cuda_stream()>>>(num_pixels, 1.f / 255, rgb, gray);
+}
+
+void TransformOpticalFlowGPU(
+    const int num_clips,
+    const int length_of,
+    const int num_frames,
+    const int height,
+    const int width,
+    const bool magnitude,
+    const int image_channels,
+    const std::vector<float>& mean_of,
+    const std::vector<float>& inv_std_of,
+    const float* flows,
+    const unsigned char* frames,
+    float* clip_of,
+    CUDAContext* context) {
+  CAFFE_ENFORCE_LE(mean_of.size(), kMaxFlowChannels);
+  CAFFE_ENFORCE_EQ(mean_of.size(), inv_std_of.size());
+  FlowNormalization norm;
+  for (int c = 0; c < mean_of.size(); ++c) {
+    norm.mean[c] = mean_of[c];
+    norm.inv_std[c] = inv_std_of[c];
+  }
+  const int N = num_clips * length_of * height * width;
+  TransformOpticalFlowKernel<<<
+      CAFFE_GET_BLOCKS(N),
+      CAFFE_CUDA_NUM_THREADS,
+      0,
+      context->cuda_stream()>>>(
+      N,
+      length_of,
+      num_frames,
+      height,
+      width,
+      magnitude,
+      image_channels,
+      norm,
+      reinterpret_cast<const float2*>(flows),
+      frames,
+      clip_of);
+}
+
+} // namespace caffe2
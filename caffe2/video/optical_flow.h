@@ -32,6 +32,15 @@ enum FlowDataType {
   FlowWithRGB = 3,
 };
 
+// Number of frames one optical flow of a clip is computed from: the
+// frame_gap_of + 1 consecutive frames if the flow is aggregated, else only the
+// first and the last of them
+inline int NumOpticalFlowFrames(
+    const int frame_gap_of,
+    const bool do_flow_aggregation) {
+  return do_flow_aggregation ? frame_gap_of + 1 : 2;
+}
+
 void OpticalFlowExtractor(
     const cv::Mat& prev_gray,
     const cv::Mat& curr_gray,
@@ -0,0 +1,142 @@
+#include <caffe2/video/optical_flow_gpu.h>
+
+#include <cmath>
+
+#include <opencv2/core/cuda_stream_accessor.hpp>
+
+#include <caffe2/video/optical_flow.h>
+
+namespace caffe2 {
+
+GPUOpticalFlowExtractor::GPUOpticalFlowExtractor(
+    const int flow_alg_type,
+    const int flow_data_type,
+    const int length_of,
+    const int frame_gap_of,
+    const bool do_flow_aggregation,
+    const int crop_height,
+    const int crop_width,
+    const std::vector<float>& mean_of,
+    const std::vector<float>& inv_std_of)
+    : float_frames_(false),
+      length_of_(length_of),
+      num_frames_(NumOpticalFlowFrames(frame_gap_of, do_flow_aggregation)),
+      crop_height_(crop_height),
+      crop_width_(crop_width),
+      magnitude_(false),
+      image_channels_(0),
+      mean_of_(mean_of),
+      inv_std_of_(inv_std_of) {
+  switch (flow_alg_type) {
+    case FLowAlgType::FarnebackOpticalFlow:
+      // same parameters as on the CPU
+      algorithm_ = cv::cuda::FarnebackOpticalFlow::create(
+          5,
+          std::sqrt(2) / 2.0,
+          false,
+          10,
+          2,
+          7,
+          1.5,
+          cv::OPTFLOW_FARNEBACK_GAUSSIAN);
+      break;
+    case FLowAlgType::DensePyrLKOpticalFlow:
+      algorithm_ = cv::cuda::DensePyrLKOpticalFlow::create();
+      break;
+    case FLowAlgType::BroxOpticalFlow:
+      algorithm_ = cv::cuda::BroxOpticalFlow::create();
+      float_frames_ = true;
+      break;
+    case FLowAlgType::OpticalFlowDual_TVL1:
+      algorithm_ = cv::cuda::OpticalFlowDual_TVL1::create();
+      break;
+    default:
+      CAFFE_THROW("Unsupported optical flow type ", flow_alg_type);
+  }
+
+  switch (flow_data_type) {
+    case FlowDataType::Flow2C:
+      break;
+    case FlowDataType::Flow3C:
+      magnitude_ = true;
+      break;
+    case FlowDataType::FlowWithGray:
+      image_channels_ = 1;
+      break;
+    case FlowDataType::FlowWithRGB:
+      image_channels_ = 3;
+      break;
+    default:
+      CAFFE_THROW("Unsupported optical flow data type ", flow_data_type);
+  }
+  CAFFE_ENFORCE_EQ(mean_of_.size(), (magnitude_ ? 3 : 2) + image_channels_);
+  CAFFE_ENFORCE_EQ(inv_std_of_.size(), mean_of_.size());
+}
+
+void GPUOpticalFlowExtractor::Run(
+    const unsigned char* frames,
+    const int num_clips,
+    float* clip_of,
+    CUDAContext* context) {
+  const int frame_size = crop_height_ * crop_width_;
+  const int num_flow_clips = num_clips * length_of_;
+  const int num_flows = num_frames_ - 1;
+
+  // the algorithms take gray frames
+  grays_.Resize(num_flow_clips * num_frames_, crop_height_, crop_width_);
+  int gray_type;
+  if (float_frames_) {
+    RGBToGrayGPU(
+        grays_.size(), frames, grays_.mutable_data<float>(), context);
+    gray_type = CV_32FC1;
+  } else {
+    RGBToGrayGPU(
+        grays_.size(),
+        frames,
+        grays_.mutable_data<unsigned char>(),
+        context);
+    gray_type = CV_8UC1;
+  }
+  char* grays = static_cast<char*>(grays_.raw_mutable_data());
+  const size_t gray_nbytes = frame_size * grays_.itemsize();
+
+  // Compute the flow of every pair of consecutive frames into flows_, on the
+  // stream of the context so that the host does not wait for any of them
+  flows_.Resize(num_flow_clips * num_flows, crop_height_, crop_width_, 2);
+  float* flows = flows_.mutable_data<float>();
+  cv::cuda::Stream stream =
+      cv::cuda::StreamAccessor::wrapStream(context->cuda_stream());
+  for (int i = 0; i < num_flow_clips; ++i) {
+    for (int j = 0; j < num_flows; ++j) {
+      char* prev = grays + (i * num_frames_ + j) * gray_nbytes;
+      float* flow_data = flows + (i * num_flows + j) * 2 * frame_size;
+      cv::cuda::GpuMat flow(crop_height_, crop_width_, CV_32FC2, flow_data);
+      algorithm_->calc(
+          cv::cuda::GpuMat(crop_height_, crop_width_, gray_type, prev),
+          cv::cuda::GpuMat(
+              crop_height_, crop_width_, gray_type, prev + gray_nbytes),
+          flow,
+          stream);
+      CAFFE_ENFORCE(
+          flow.data == reinterpret_cast<unsigned char*>(flow_data),
+          "Optical flow was not computed in place");
+    }
+  }
+
+  TransformOpticalFlowGPU(
+      num_clips,
+      length_of_,
+      num_frames_,
+      crop_height_,
+      crop_width_,
+      magnitude_,
+      image_channels_,
+      mean_of_,
+      inv_std_of_,
+      flows,
+      frames,
+      clip_of,
+      context);
+}
+
+} // namespace caffe2
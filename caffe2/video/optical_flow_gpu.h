@@ -0,0 +1,94 @@
+#ifndef CAFFE2_VIDEO_OPTICAL_FLOW_GPU_H_
+#define CAFFE2_VIDEO_OPTICAL_FLOW_GPU_H_
+
+#include <vector>
+
+#include <opencv2/core/cuda.hpp>
+#include <opencv2/cudaoptflow.hpp>
+
+#include <caffe2/core/context_gpu.h>
+
+namespace caffe2 {
+
+// Computes the optical flow of clips on the GPU with the CUDA modules of
+// OpenCV, the way ClipTransformOpticalFlow does on the CPU. All clips of a
+// batch are converted, aggregated and normalized together, and the flow of
+// every pair of frames is computed on the stream of the context, so that a
+// batch costs a single copy of its frames to the device and no other
+// synchronization. Unlike on the CPU, all four FLowAlgType are supported.
+class GPUOpticalFlowExtractor {
+ public:
+  GPUOpticalFlowExtractor(
+      const int flow_alg_type,
+      const int flow_data_type,
+      const int length_of,
+      const int frame_gap_of,
+      const bool do_flow_aggregation,
+      const int crop_height,
+      const int crop_width,
+      const std::vector<float>& mean_of,
+      const std::vector<float>& inv_std_of);
+
+  // Computes the optical flow of num_clips clips from frames, the frames
+  // written by ClipCropOpticalFlowFrames for each of the clips one after the
+  // other, on the device. Writes num_clips x channels_of x length_of x
+  // crop_height x crop_width floats to clip_of, like ClipTransformOpticalFlow.
+  void Run(
+      const unsigned char* frames,
+      const int num_clips,
+      float* clip_of,
+      CUDAContext* context);
+
+ private:
+  cv::Ptr<cv::cuda::DenseOpticalFlow> algorithm_;
+  // BroxOpticalFlow only takes float frames in [0, 1]
+  bool float_frames_;
+  int length_of_;
+  int num_frames_;
+  int crop_height_;
+  int crop_width_;
+  bool magnitude_;
+  int image_channels_;
+  std::vector<float> mean_of_;
+  std::vector<float> inv_std_of_;
+  Tensor<CUDAContext> grays_;
+  Tensor<CUDAContext> flows_;
+};
+
+// Converts num_pixels RGB pixels to gray as cv::COLOR_RGB2GRAY does
+void RGBToGrayGPU(
+    const int num_pixels,
+    const unsigned char* rgb,
+    unsigned char* gray,
+    CUDAContext* context);
+
+// Same, scaled to [0, 1]
+void RGBToGrayGPU(
+    const int num_pixels,
+    const unsigned char* rgb,
+    float* gray,
+    CUDAContext* context);
+
+// Aggregates the num_frames - 1 flows of each of the num_clips x length_of
+// flow clips in flows, as MergeOpticalFlow does, and writes them normalized
+// to clip_of. The third channel is the magnitude of the flow if magnitude,
+// else the first of num_frames RGB frames in frames is added as
+// image_channels gray (1) or RGB (3) channels.
+void TransformOpticalFlowGPU(
+    const int num_clips,
+    const int length_of,
+    const int num_frames,
+    const int height,
+    const int width,
+    const bool magnitude,
+    const int image_channels,
+    const std::vector<float>& mean_of,
+    const std::vector<float>& inv_std_of,
+    const float* flows,
+    const unsigned char* frames,
+    float* clip_of,
+    CUDAContext* context);
+
+} // namespace caffe2
+
+#endif // CAFFE2_VIDEO_OPTICAL_FLOW_GPU_H_
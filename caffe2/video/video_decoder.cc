@@ -9,6 +9,7 @@ extern "C" {
 #include <libavcodec/avcodec.h>
 #include <libavformat/avformat.h>
 #include <libavutil/log.h>
+#include <libavutil/pixdesc.h>
 #include <libswresample/swresample.h>
 #include <libswscale/swscale.h>
 }
@@ -122,10 +123,25 @@ void VideoDecoder::decodeLoop(
     AVDictionary* opts = nullptr;
     videoCodecContext_ = videoStream_->codec;
     try {
-      ret = avcodec_open2(
-          videoCodecContext_,
-          avcodec_find_decoder(videoCodecContext_->codec_id),
-          &opts);
+      ret = -1;
+      if (params.hardwareDecoder_) {
+        string name =
+            string(avcodec_get_name(videoCodecContext_->codec_id)) + "_cuvid";
+        AVCodec* codec = avcodec_find_decoder_by_name(name.c_str());
+        if (codec) {
+          ret = avcodec_open2(videoCodecContext_, codec, &opts);
+        }
+        if (ret < 0) {
+          VLOG(1) << "Cannot open " << name << ", decoding " << videoName
+                  << " in software";
+        }
+      }
+      if (ret < 0) {
+        ret = avcodec_open2(
+            videoCodecContext_,
+            avcodec_find_decoder(videoCodecContext_->codec_id),
+            &opts);
+      }
     } catch (const std::exception&) {
       LOG(ERROR) << "Exception during open video codec";
       return;
@@ -178,18 +194,8 @@ void VideoDecoder::decodeLoop(
     // Make sure that we have a valid format
     CAFFE_ENFORCE_NE(videoCodecContext_->pix_fmt, AV_PIX_FMT_NONE);
 
-    // Create a scale context
-    scaleContext_ = sws_getContext(
-        videoCodecContext_->width,
-        videoCodecContext_->height,
-        videoCodecContext_->pix_fmt,
-        outWidth,
-        outHeight,
-        pixFormat,
-        SWS_FAST_BILINEAR,
-        nullptr,
-        nullptr,
-        nullptr);
+    // The scale context is created for the format of the first frame
+    // sampled, which differs from that of the stream with NVDEC (NV12)
 
     // Getting video meta data
     VideoMeta videoMeta;
@@ -345,6 +351,15 @@ void VideoDecoder::decodeLoop(
           }
         }
 
+        // the frames before start_ts are only needed as references of the
+        // ones after it, so the decoder drops those no frame refers to
+        if (!mustDecodeAll) {
+          videoCodecContext_->skip_frame =
+              (packet.pts != AV_NOPTS_VALUE && packet.pts < start_ts)
+              ? AVDISCARD_NONREF
+              : AVDISCARD_DEFAULT;
+        }
+
         ret = avcodec_decode_video2(
             videoCodecContext_, videoStreamFrame_, &gotPicture, &packet);
         if (ret < 0) {
@@ -450,12 +465,33 @@ void VideoDecoder::decodeLoop(
                   outWidth,
                   outHeight);
 
+              scaleContext_ = sws_getCachedContext(
+                  scaleContext_,
+                  videoStreamFrame_->width,
+                  videoStreamFrame_->height,
+                  static_cast<AVPixelFormat>(videoStreamFrame_->format),
+                  outWidth,
+                  outHeight,
+                  pixFormat,
+                  SWS_FAST_BILINEAR,
+                  nullptr,
+                  nullptr,
+                  nullptr);
+              if (!scaleContext_) {
+                LOG(ERROR) << "Cannot convert the frames from "
+                           << av_get_pix_fmt_name(static_cast<AVPixelFormat>(
+                                  videoStreamFrame_->format));
+                av_frame_free(&rgbFrame);
+                av_free_packet(&packet);
+                break;
+              }
+
               sws_scale(
                   scaleContext_,
                   videoStreamFrame_->data,
                   videoStreamFrame_->linesize,
                   0,
-                  videoCodecContext_->height,
+                  videoStreamFrame_->height,
                   rgbFrame->data,
                   rgbFrame->linesize);
 
@@ -71,6 +71,8 @@ class Params {
  public:
   // return all key-frames regardless of specified fps
   bool keyFrames_ = false;
+  // decode with the NVDEC decoder of FFmpeg for the codec, if it has one
+  bool hardwareDecoder_ = false;
 
   // Output image pixel format
   AVPixelFormat pixelFormat_ = AVPixelFormat::AV_PIX_FMT_RGB24;
@@ -152,6 +154,16 @@ class Params {
     return *this;
   }
 
+  /**
+   * Decode with the NVDEC (cuvid) decoder of FFmpeg for the codec of the
+   * video, e.g. h264_cuvid, falling back to the software decoder if FFmpeg
+   * was built without it or it cannot open the video
+   */
+  Params& hardwareDecoder(bool hardwareDecoder) {
+    hardwareDecoder_ = hardwareDecoder;
+    return *this;
+  }
+
   /**
    * Index of video stream to process, defaults to the first video stream
    */
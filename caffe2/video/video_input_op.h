@@ -15,6 +15,8 @@
 
 namespace caffe2 {
 
+class GPUOpticalFlowExtractor;
+
 template <class Context>
 class VideoInputOp final : public PrefetchOperator<Context> {
  public:
@@ -47,9 +49,16 @@ class VideoInputOp final : public PrefetchOperator<Context> {
       float* clip_of_data,
       int* label_data,
       int* video_id_data,
+      unsigned char* clip_of_frames_data,
       std::mt19937* randgen,
       std::bernoulli_distribution* mirror_this_clip);
 
+  // Computing the optical flow on the device, see use_gpu_optical_flow_.
+  // Only VideoInputOp<CUDAContext> implements these, when Caffe2 is built
+  // with the CUDA modules of OpenCV.
+  bool InitOpticalFlowOnDevice();
+  void ComputeOpticalFlowOnDevice();
+
   const db::DBReader* reader_;
   CPUContext cpu_context_;
   TensorCPU prefetched_clip_rgb_;
@@ -60,6 +69,10 @@ class VideoInputOp final : public PrefetchOperator<Context> {
   Tensor<Context> prefetched_clip_of_on_device_;
   Tensor<Context> prefetched_label_on_device_;
   Tensor<Context> prefetched_video_id_on_device_;
+  // The cropped frames the optical flow is computed from on the device
+  TensorCPU prefetched_of_frames_;
+  Tensor<Context> prefetched_of_frames_on_device_;
+  std::shared_ptr<GPUOpticalFlowExtractor> of_extractor_;
   int batch_size_;
   int clip_per_video_;
   std::vector<float> mean_rgb_;
@@ -103,6 +116,10 @@ class VideoInputOp final : public PrefetchOperator<Context> {
   bool get_optical_flow_;
   bool get_video_id_;
   bool do_multi_label_;
+  bool use_hardware_decoder_;
+  // Whether the decoding threads only crop the frames, and the optical flow
+  // is computed on the device, for all clips of a batch at once
+  bool use_gpu_optical_flow_;
 
   // thread pool for parse + decode
   int num_decode_threads_;
@@ -186,6 +203,12 @@ void VideoInputOp<Context>::CheckParamsAndPrint() {
   // print out the parameter settings
   LOG(INFO) << "Creating a clip input op with the following setting: ";
   LOG(INFO) << "    Using " << num_decode_threads_ << " CPU threads;";
+  if (use_hardware_decoder_) {
+    LOG(INFO) << "    Decoding with NVDEC when FFmpeg supports the codec;";
+  }
+  if (use_gpu_optical_flow_) {
+    LOG(INFO) << "    Computing optical flow on the GPU;";
+  }
   LOG(INFO) << "    Outputting in batches of " << batch_size_ << " videos;";
   LOG(INFO) << "    Each video has " << clip_per_video_ << " clips;";
   LOG(INFO) << "    Scaling image to " << scale_h_ << "x" << scale_w_;
@@ -343,6 +366,14 @@ VideoInputOp<Context>::VideoInputOp(
       do_multi_label_(OperatorBase::template GetSingleArgument<bool>(
           "do_multi_label",
           false)),
+      use_hardware_decoder_(OperatorBase::template GetSingleArgument<bool>(
+          "use_hardware_decoder",
+          false)),
+      use_gpu_optical_flow_(
+          get_optical_flow_ &&
+          OperatorBase::template GetSingleArgument<bool>(
+              "use_gpu_optical_flow",
+              false)),
       num_decode_threads_(OperatorBase::template GetSingleArgument<int>(
           "num_decode_threads",
           4)),
@@ -478,6 +509,20 @@ VideoInputOp<Context>::VideoInputOp(
   data_shape[2] = length_of_;
   prefetched_clip_of_.Resize(data_shape);
 
+  if (use_gpu_optical_flow_) {
+    CAFFE_ENFORCE(
+        InitOpticalFlowOnDevice(),
+        "Computing optical flow on the device needs a CUDA VideoInput op "
+        "and Caffe2 built with the CUDA modules of OpenCV");
+    prefetched_of_frames_.Resize(
+        data_shape[0],
+        length_of_,
+        NumOpticalFlowFrames(frame_gap_of_, do_flow_aggregation_),
+        crop_height_,
+        crop_width_,
+        channels_rgb_);
+  }
+
   // If do_multi_label is used, output label is a binary vector
   // of length num_of_class indicating which labels present
   if (do_multi_label_) {
@@ -573,6 +618,7 @@ bool VideoInputOp<Context>::GetClipsAndLabelsFromDBValue(
   params.scale_h_ = scale_h_;
   params.decode_type_ = decode_type_;
   params.num_of_required_frame_ = num_of_required_frame_;
+  params.hardwareDecoder_ = use_hardware_decoder_;
 
   char* video_buffer = nullptr; // for decoding from buffer
   std::string video_filename; // for decoding from file
@@ -619,6 +665,7 @@ void VideoInputOp<Context>::DecodeAndTransform(
     float* clip_of_data,
     int* label_data,
     int* video_id_data,
+    unsigned char* clip_of_frames_data,
     std::mt19937* randgen,
     std::bernoulli_distribution* mirror_this_clip) {
   std::vector<unsigned char*> buffer_rgb;
@@ -634,6 +681,10 @@ void VideoInputOp<Context>::DecodeAndTransform(
   int clip_crop_offset_of =
       channels_of_ * length_of_ * crop_height_ * crop_width_;
   int clip_offset_of = multi_crop_count_ * clip_crop_offset_of;
+  int clip_crop_offset_of_frames = length_of_ *
+      NumOpticalFlowFrames(frame_gap_of_, do_flow_aggregation_) *
+      crop_height_ * crop_width_ * channels_rgb_;
+  int clip_offset_of_frames = multi_crop_count_ * clip_crop_offset_of_frames;
   for (int i = 0; i < std::min(clip_per_video_, int(buffer_rgb.size())); i++) {
     // get the rectangle for cropping
     int h_off = 0;
@@ -699,7 +750,7 @@ void VideoInputOp<Context>::DecodeAndTransform(
           randgen,
           clip_rgb_data + (i * clip_offset_rgb));
     }
-    if (get_optical_flow_ && clip_of_data) {
+    if (get_optical_flow_ && (clip_of_data || clip_of_frames_data)) {
       cv::Rect rect;
       for (int j = 0; j < multi_crop_count_; ++j) {
         if (multi_crop_count_ == 1) {
@@ -713,6 +764,25 @@ void VideoInputOp<Context>::DecodeAndTransform(
               crop_width_,
               crop_height_);
         }
+        if (clip_of_frames_data) {
+          // the flow is computed on the device
+          ClipCropOpticalFlowFrames(
+              buffer_rgb[i],
+              crop_height_,
+              crop_width_,
+              length_of_,
+              sampling_rate_of_,
+              height,
+              width,
+              rect,
+              channels_rgb_,
+              mirror_me,
+              frame_gap_of_,
+              do_flow_aggregation_,
+              clip_of_frames_data + (i * clip_offset_of_frames) +
+                  j * clip_crop_offset_of_frames);
+          continue;
+        }
         ClipTransformOpticalFlow(
             buffer_rgb[i],
             crop_height_,
@@ -753,7 +823,11 @@ bool VideoInputOp<Context>::Prefetch() {
 
   // Call mutable_data() once to allocate the underlying memory.
   prefetched_clip_rgb_.mutable_data<float>();
-  prefetched_clip_of_.mutable_data<float>();
+  if (use_gpu_optical_flow_) {
+    prefetched_of_frames_.mutable_data<unsigned char>();
+  } else {
+    prefetched_clip_of_.mutable_data<float>();
+  }
   prefetched_label_.mutable_data<int>();
   prefetched_video_id_.mutable_data<int>();
 
@@ -774,10 +848,20 @@ bool VideoInputOp<Context>::Prefetch() {
         frame_size * length_rgb_ * channels_rgb_ * item_id * clip_per_video_ *
             multi_crop_count_;
 
-    // get the optical flow data for the current clip
-    float* clip_of_data = prefetched_clip_of_.mutable_data<float>() +
-        frame_size * length_of_ * channels_of_ * item_id * clip_per_video_ *
-            multi_crop_count_;
+    // get the optical flow data for the current clip, or the frames to
+    // compute it from on the device
+    float* clip_of_data = nullptr;
+    unsigned char* clip_of_frames_data = nullptr;
+    if (use_gpu_optical_flow_) {
+      clip_of_frames_data =
+          prefetched_of_frames_.mutable_data<unsigned char>() +
+          prefetched_of_frames_.size_from_dim(1) * item_id * clip_per_video_ *
+              multi_crop_count_;
+    } else {
+      clip_of_data = prefetched_clip_of_.mutable_data<float>() +
+          frame_size * length_of_ * channels_of_ * item_id * clip_per_video_ *
+              multi_crop_count_;
+    }
 
     // get the label data pointer for the item_id -th example
     int* label_data = prefetched_label_.mutable_data<int>() +
@@ -800,6 +884,7 @@ bool VideoInputOp<Context>::Prefetch() {
         clip_of_data,
         label_data,
         video_id_data,
+        clip_of_frames_data,
         randgen,
         &mirror_this_clip));
   } // for over the batch
@@ -812,7 +897,11 @@ bool VideoInputOp<Context>::Prefetch() {
       prefetched_clip_rgb_on_device_.CopyFrom(prefetched_clip_rgb_, &context_);
     }
     if (get_optical_flow_) {
-      prefetched_clip_of_on_device_.CopyFrom(prefetched_clip_of_, &context_);
+      if (use_gpu_optical_flow_) {
+        ComputeOpticalFlowOnDevice();
+      } else {
+        prefetched_clip_of_on_device_.CopyFrom(prefetched_clip_of_, &context_);
+      }
     }
     prefetched_label_on_device_.CopyFrom(prefetched_label_, &context_);
     if (get_video_id_) {
@@ -858,6 +947,16 @@ bool VideoInputOp<Context>::CopyPrefetched() {
   return true;
 }
 
+template <class Context>
+bool VideoInputOp<Context>::InitOpticalFlowOnDevice() {
+  return false;
+}
+
+template <class Context>
+void VideoInputOp<Context>::ComputeOpticalFlowOnDevice() {
+  CAFFE_THROW("Optical flow can only be computed on a CUDA device");
+}
+
 } // namespace caffe2
 
 #endif // CAFFE2_VIDEO_VIDEO_INPUT_OP_H_
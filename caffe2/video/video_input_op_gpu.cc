@@ -1,9 +1,45 @@
 #include <caffe2/core/common_gpu.h>
 #include <caffe2/core/context_gpu.h>
+#include <caffe2/core/macros.h>
 #include <caffe2/video/video_input_op.h>
 
+#ifdef CAFFE2_USE_OPENCV_CUDA
+#include <caffe2/video/optical_flow_gpu.h>
+#endif
+
 namespace caffe2 {
 
+#ifdef CAFFE2_USE_OPENCV_CUDA
+
+template <>
+bool VideoInputOp<CUDAContext>::InitOpticalFlowOnDevice() {
+  CAFFE_ENFORCE_EQ(channels_rgb_, 3, "Optical flow needs RGB frames");
+  of_extractor_ = std::make_shared<GPUOpticalFlowExtractor>(
+      flow_alg_type_,
+      flow_data_type_,
+      length_of_,
+      frame_gap_of_,
+      do_flow_aggregation_,
+      crop_height_,
+      crop_width_,
+      mean_of_,
+      inv_std_of_);
+  return true;
+}
+
+template <>
+void VideoInputOp<CUDAContext>::ComputeOpticalFlowOnDevice() {
+  prefetched_of_frames_on_device_.CopyFrom(prefetched_of_frames_, &context_);
+  prefetched_clip_of_on_device_.Resize(prefetched_clip_of_.dims());
+  of_extractor_->Run(
+      prefetched_of_frames_on_device_.data<unsigned char>(),
+      prefetched_of_frames_.dim32(0),
+      prefetched_clip_of_on_device_.mutable_data<float>(),
+      &context_);
+}
+
+#endif // CAFFE2_USE_OPENCV_CUDA
+
 REGISTER_CUDA_OPERATOR(VideoInput, VideoInputOp<CUDAContext>);
 
 } // namespace caffe2
@@ -486,6 +486,46 @@ void ClipTransformOpticalFlow(
   }
 }
 
+void ClipCropOpticalFlowFrames(
+    const unsigned char* buffer_rgb,
+    const int crop_height,
+    const int crop_width,
+    const int length_of,
+    const int sampling_rate_of,
+    const int height,
+    const int width,
+    const cv::Rect& rect,
+    const int channels_rgb,
+    const bool mirror_me,
+    const int frame_gap_of,
+    const bool do_flow_aggregation,
+    unsigned char* frames) {
+  const int row_size = crop_width * channels_rgb;
+  const int step_size = do_flow_aggregation ? 1 : frame_gap_of;
+  for (int l = 0; l < length_of; l++) {
+    // same frames as in ClipTransformOpticalFlow
+    for (int j = 0; j <= frame_gap_of; j += step_size) {
+      const unsigned char* curr_frame = buffer_rgb +
+          (l * sampling_rate_of + j) * height * width * channels_rgb;
+      for (int y = 0; y < crop_height; y++) {
+        const unsigned char* src = curr_frame +
+            ((rect.y + y) * width + rect.x) * channels_rgb;
+        if (mirror_me) {
+          for (int x = 0; x < crop_width; x++) {
+            memcpy(
+                frames + (crop_width - 1 - x) * channels_rgb,
+                src + x * channels_rgb,
+                channels_rgb);
+          }
+        } else {
+          memcpy(frames, src, row_size);
+        }
+        frames += row_size;
+      }
+    }
+  }
+}
+
 void FreeDecodedData(
     std::vector<std::unique_ptr<DecodedFrame>>& sampledFrames) {
   // free the sampledFrames
@@ -61,6 +61,26 @@ void ClipTransformOpticalFlow(
     const std::vector<float>& inv_std_of,
     float* transformed_clip);
 
+// Copies the frames ClipTransformOpticalFlow would compute the flow of to
+// frames, cropped to rect and mirrored if mirror_me, so that the flow can be
+// computed on the device instead. These are NumOpticalFlowFrames frames of
+// crop_height x crop_width x channels_rgb bytes for each of the length_of
+// flows.
+void ClipCropOpticalFlowFrames(
+    const unsigned char* buffer_rgb,
+    const int crop_height,
+    const int crop_width,
+    const int length_of,
+    const int sampling_rate_of,
+    const int height,
+    const int width,
+    const cv::Rect& rect,
+    const int channels_rgb,
+    const bool mirror_me,
+    const int frame_gap_of,
+    const bool do_flow_aggregation,
+    unsigned char* frames);
+
 void FreeDecodedData(std::vector<std::unique_ptr<DecodedFrame>>& sampledFrames);
 
 bool DecodeMultipleClipsFromVideo(
@@ -397,6 +397,14 @@ if(USE_CUDA)
   endif()
 endif()
 
+# ---[ OpenCV CUDA modules, used to compute optical flow on the GPU
+if(USE_OPENCV AND USE_CUDA)
+  if(";${OpenCV_LIB_COMPONENTS};" MATCHES ";opencv_cudaoptflow;")
+    list(APPEND Caffe2_CUDA_DEPENDENCY_LIBS opencv_cudaoptflow)
+    set(CAFFE2_USE_OPENCV_CUDA 1)
+  endif()
+endif()
+
 # ---[ NCCL
 if(USE_NCCL)
   if(NOT USE_CUDA)
@@ -582,6 +590,16 @@ if (BUILD_ATEN)
   list(APPEND Caffe2_DEPENDENCY_LIBS ATen_cpu)
   if (USE_CUDA)
     list(APPEND Caffe2_CUDA_DEPENDENCY_LIBS ATen_cuda)
+    if (BUILD_CAFFE2)
+      # Caffe2 allocates its CUDA memory from the caching allocator of THC,
+      # so that the cache is shared with ATen
+      set(CAFFE2_USE_ATEN 1)
+      include_directories(
+          ${PROJECT_SOURCE_DIR}/aten/src/TH
+          ${PROJECT_SOURCE_DIR}/aten/src/THC
+          ${PROJECT_BINARY_DIR}/caffe2/contrib/aten/aten/src/TH
+          ${PROJECT_BINARY_DIR}/caffe2/contrib/aten/aten/src/THC)
+    endif()
   endif()
   include_directories(${PROJECT_SOURCE_DIR}/aten/src)
 endif()
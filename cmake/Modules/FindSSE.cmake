@@ -1,5 +1,6 @@
 INCLUDE(CheckCSourceRuns)
 INCLUDE(CheckCXXSourceRuns)
+INCLUDE(CheckCXXSourceCompiles)
 
 SET(SSE1_CODE "
   #include <xmmintrin.h>
@@ -79,6 +80,28 @@ SET(AVX2_CODE "
   }
 ")
 
+SET(AVX512_CODE "
+  #include <immintrin.h>
+
+  int main()
+  {
+    __m512 a = _mm512_set1_ps(0);
+    a = _mm512_roundscale_ps(a, _MM_FROUND_TO_NEG_INF);
+    return 0;
+  }
+")
+
+SET(NEON_CODE "
+  #include <arm_neon.h>
+
+  int main()
+  {
+    float32x4_t a = vdupq_n_f32(0);
+    a = vaddq_f32(a, a);
+    return 0;
+  }
+")
+
 MACRO(CHECK_SSE lang type flags)
   SET(__FLAG_I 1)
   SET(CMAKE_REQUIRED_FLAGS_SAVE ${CMAKE_REQUIRED_FLAGS})
@@ -123,3 +146,34 @@ CHECK_SSE(CXX "SSE4_1" " ;-msse4.1;-msse4;/arch:SSE4")
 CHECK_SSE(CXX "SSE4_2" " ;-msse4.2;-msse4;/arch:SSE4")
 CHECK_SSE(CXX "AVX" " ;-mavx;/arch:AVX")
 CHECK_SSE(CXX "AVX2" " ;-mavx2 -mfma;/arch:AVX2")
+
+# The ATen kernels built for AVX-512 and NEON are only called when the CPU
+# supports them (see aten/src/ATen/native/cpu/CapabilityDispatch.h), so unlike
+# CHECK_SSE this only checks that the compiler accepts them: the build machine
+# does not need to be able to run them.
+MACRO(CHECK_SIMD_COMPILES type flags)
+  SET(CMAKE_REQUIRED_FLAGS_SAVE ${CMAKE_REQUIRED_FLAGS})
+  SET(__FLAG_I 1)
+  FOREACH(__FLAG ${flags})
+    IF(NOT CXX_${type}_FOUND)
+      SET(CMAKE_REQUIRED_FLAGS ${__FLAG})
+      CHECK_CXX_SOURCE_COMPILES("${${type}_CODE}" CXX_HAS_${type}_${__FLAG_I})
+      IF(CXX_HAS_${type}_${__FLAG_I})
+        SET(CXX_${type}_FOUND TRUE CACHE BOOL "CXX ${type} support")
+        SET(CXX_${type}_FLAGS "${__FLAG}" CACHE STRING "CXX ${type} flags")
+      ENDIF()
+      MATH(EXPR __FLAG_I "${__FLAG_I}+1")
+    ENDIF()
+  ENDFOREACH()
+  SET(CMAKE_REQUIRED_FLAGS ${CMAKE_REQUIRED_FLAGS_SAVE})
+
+  IF(NOT CXX_${type}_FOUND)
+    SET(CXX_${type}_FOUND FALSE CACHE BOOL "CXX ${type} support")
+    SET(CXX_${type}_FLAGS "" CACHE STRING "CXX ${type} flags")
+  ENDIF()
+
+  MARK_AS_ADVANCED(CXX_${type}_FOUND CXX_${type}_FLAGS)
+ENDMACRO()
+
+CHECK_SIMD_COMPILES("AVX512" "-mavx512f -mavx2 -mfma -mf16c;/arch:AVX512")
+CHECK_SIMD_COMPILES("NEON" " ;-mfpu=neon")
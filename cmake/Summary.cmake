@@ -107,6 +107,7 @@ function (caffe2_print_configuration_summary)
   message(STATUS "  USE_OPENCV            : ${USE_OPENCV}")
   if(${USE_OPENCV})
     message(STATUS "    OpenCV version      : ${OpenCV_VERSION}")
+    message(STATUS "    OpenCV CUDA         : ${CAFFE2_USE_OPENCV_CUDA}")
   endif()
   message(STATUS "  USE_OPENMP            : ${USE_OPENMP}")
   message(STATUS "  USE_PROF              : ${USE_PROF}")
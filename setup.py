@@ -613,6 +613,7 @@ main_sources = [
     "torch/csrc/utils/device.cpp",
     "torch/csrc/utils/invalid_arguments.cpp",
     "torch/csrc/utils/object_ptr.cpp",
+    "torch/csrc/utils/overhead_benchmark.cpp",
     "torch/csrc/utils/python_arg_parser.cpp",
     "torch/csrc/utils/tensor_list.cpp",
     "torch/csrc/utils/tensor_new.cpp",
@@ -622,6 +623,7 @@ main_sources = [
     "torch/csrc/utils/tensor_types.cpp",
     "torch/csrc/utils/tuple_parser.cpp",
     "torch/csrc/utils/tensor_apply.cpp",
+    "torch/csrc/utils/tensor_collate.cpp",
     "torch/csrc/utils/tensor_conversion_dispatch.cpp",
     "torch/csrc/utils/tensor_flatten.cpp",
     "torch/csrc/utils/variadic.cpp",
@@ -632,6 +634,9 @@ main_sources = [
     "torch/csrc/jit/ir.cpp",
     "torch/csrc/jit/fusion_compiler.cpp",
     "torch/csrc/jit/graph_executor.cpp",
+    "torch/csrc/jit/captured_launches.cpp",
+    "torch/csrc/jit/inter_op_pool.cpp",
+    "torch/csrc/jit/shape_profile.cpp",
     "torch/csrc/jit/python_ir.cpp",
     "torch/csrc/jit/test_jit.cpp",
     "torch/csrc/jit/tracer.cpp",
@@ -658,8 +663,17 @@ main_sources = [
     "torch/csrc/jit/passes/inplace_check.cpp",
     "torch/csrc/jit/passes/canonicalize.cpp",
     "torch/csrc/jit/passes/batch_mm.cpp",
+    "torch/csrc/jit/passes/plan_memory.cpp",
+    "torch/csrc/jit/passes/prepack_linear.cpp",
+    "torch/csrc/jit/passes/quantize_weights.cpp",
+    "torch/csrc/jit/passes/constant_propagation.cpp",
+    "torch/csrc/jit/passes/fold_batch_norm.cpp",
+    "torch/csrc/jit/passes/fuse_conv_relu.cpp",
+    "torch/csrc/jit/passes/loop_invariant_code_motion.cpp",
+    "torch/csrc/jit/passes/loop_unrolling.cpp",
     "torch/csrc/jit/passes/onnx/peephole.cpp",
     "torch/csrc/jit/passes/onnx/fixup_onnx_loop.cpp",
+    "torch/csrc/jit/passes/onnx/native_symbolic.cpp",
     "torch/csrc/jit/generated/aten_dispatch.cpp",
     "torch/csrc/jit/script/lexer.cpp",
     "torch/csrc/jit/script/compiler.cpp",
@@ -669,10 +683,12 @@ main_sources = [
     "torch/csrc/autograd/init.cpp",
     "torch/csrc/autograd/aten_variable_hooks.cpp",
     "torch/csrc/autograd/grad_mode.cpp",
+    "torch/csrc/autograd/autocast_mode.cpp",
     "torch/csrc/autograd/engine.cpp",
     "torch/csrc/autograd/function.cpp",
     "torch/csrc/autograd/variable.cpp",
     "torch/csrc/autograd/saved_variable.cpp",
+    "torch/csrc/autograd/saved_tensor_hooks.cpp",
     "torch/csrc/autograd/input_buffer.cpp",
     "torch/csrc/autograd/profiler.cpp",
     "torch/csrc/autograd/python_function.cpp",
@@ -691,6 +707,7 @@ main_sources = [
     "torch/csrc/autograd/functions/basic_ops.cpp",
     "torch/csrc/autograd/functions/tensor.cpp",
     "torch/csrc/autograd/functions/accumulate_grad.cpp",
+    "torch/csrc/autograd/functions/checkpoint.cpp",
     "torch/csrc/autograd/functions/special.cpp",
     "torch/csrc/autograd/functions/utils.cpp",
     "torch/csrc/autograd/functions/init.cpp",
@@ -761,7 +778,11 @@ if WITH_CUDA:
         "torch/csrc/cuda/Stream.cpp",
         "torch/csrc/cuda/utils.cpp",
         "torch/csrc/cuda/comm.cpp",
+        "torch/csrc/cuda/prefetcher.cpp",
         "torch/csrc/cuda/python_comm.cpp",
+        "torch/csrc/cuda/python_prefetcher.cpp",
+        "torch/csrc/cuda/replica_cache.cpp",
+        "torch/csrc/cuda/python_replica_cache.cpp",
         "torch/csrc/cuda/serialization.cpp",
         "torch/csrc/nn/THCUNN.cpp",
     ]
@@ -898,6 +919,7 @@ if __name__ == '__main__':
                 'lib/include/ATen/cuda/*.cuh',
                 'lib/include/ATen/cuda/detail/*.h',
                 'lib/include/ATen/cudnn/*.h',
+                'lib/include/ATen/mkl/*.h',
                 'lib/include/ATen/cuda/detail/*.cuh',
                 'lib/include/pybind11/*.h',
                 'lib/include/pybind11/detail/*.h',
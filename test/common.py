@@ -21,6 +21,8 @@ import torch.cuda
 from torch._six import string_classes
 import torch.backends.cudnn
 import torch.backends.mkl
+import torch.backends.mkldnn
+import torch.backends.nnpack
 
 
 torch.set_default_tensor_type('torch.DoubleTensor')
@@ -59,6 +61,8 @@ except ImportError:
     TEST_SCIPY = False
 
 TEST_MKL = torch.backends.mkl.is_available()
+TEST_MKLDNN = torch.backends.mkldnn.is_available()
+TEST_NNPACK = torch.backends.nnpack.is_available()
 
 
 def skipIfNoLapack(fn):
@@ -0,0 +1,105 @@
+#include <catch.hpp>
+
+#include <torch/torch.h>
+
+#include <set>
+#include <stdexcept>
+
+using namespace torch;
+
+namespace {
+
+class ThrowingDataset : public data::Dataset {
+ public:
+  data::Example get(size_t index) override {
+    if (index == 5) {
+      throw std::runtime_error("bad example");
+    }
+    return {at::CPU(at::kFloat).scalarTensor(static_cast<int64_t>(index)).view({1}), Tensor()};
+  }
+  size_t size() const override {
+    return 8;
+  }
+};
+
+// Returns the values in the first column of the batch data
+std::vector<int64_t> collect(data::DataLoader& loader) {
+  std::vector<int64_t> values;
+  loader.reset();
+  data::Example batch;
+  while (loader.next(batch)) {
+    REQUIRE(batch.data.size(0) == batch.target.size(0));
+    for (int64_t i = 0; i < batch.data.size(0); i++) {
+      values.push_back(batch.data[i][0].toCLong());
+    }
+  }
+  return values;
+}
+
+} // namespace
+
+TEST_CASE("data") {
+  auto data = at::CPU(at::kLong).arange(20).view({10, 2});
+  auto target = at::CPU(at::kLong).arange(10);
+  auto dataset = std::make_shared<data::TensorDataset>(data, target);
+
+  SECTION("sequential") {
+    for (size_t workers : {0, 1, 4}) {
+      data::DataLoader loader(dataset, 3);
+      loader.workers(workers);
+      auto values = collect(loader);
+      REQUIRE(values == std::vector<int64_t>({0, 2, 4, 6, 8, 10, 12, 14, 16, 18}));
+      // a second epoch sees everything again
+      REQUIRE(collect(loader) == values);
+    }
+  }
+
+  SECTION("batch contents") {
+    data::DataLoader loader(dataset, 4);
+    loader.workers(2);
+    loader.reset();
+    data::Example batch;
+    REQUIRE(loader.next(batch));
+    REQUIRE(batch.data.sizes().equals({4, 2}));
+    REQUIRE(batch.target.sizes().equals({4}));
+    REQUIRE(batch.data.equal(data.narrow(0, 0, 4)));
+    REQUIRE(batch.target.equal(target.narrow(0, 0, 4)));
+  }
+
+  SECTION("drop_last") {
+    data::DataLoader loader(dataset, 3);
+    loader.workers(2).drop_last();
+    REQUIRE(collect(loader).size() == 9);
+  }
+
+  SECTION("random") {
+    data::DataLoader loader(dataset, 2);
+    loader.workers(3).sampler(std::make_shared<data::RandomSampler>(0));
+    auto values = collect(loader);
+    std::set<int64_t> seen(values.begin(), values.end());
+    REQUIRE(values.size() == 10);
+    REQUIRE(seen.size() == 10);
+  }
+
+  SECTION("unordered") {
+    data::DataLoader loader(dataset, 1);
+    loader.workers(4).max_prefetch(4).enforce_ordering(false);
+    auto values = collect(loader);
+    std::set<int64_t> seen(values.begin(), values.end());
+    REQUIRE(seen.size() == 10);
+  }
+
+  SECTION("exceptions") {
+    for (size_t workers : {0, 2}) {
+      data::DataLoader loader(std::make_shared<ThrowingDataset>(), 2);
+      loader.workers(workers);
+      loader.reset();
+      data::Example batch;
+      REQUIRE(loader.next(batch));
+      REQUIRE(loader.next(batch));
+      REQUIRE_THROWS_WITH(loader.next(batch), "bad example");
+      REQUIRE(loader.next(batch));
+      REQUIRE(!loader.next(batch));
+    }
+  }
+}
@@ -2,6 +2,13 @@
 
 #include <torch/torch.h>
 
+#include <torch/csrc/autograd/engine.h>
+#include <torch/csrc/autograd/functions/checkpoint.h>
+
+#include <algorithm>
+#include <mutex>
+#include <vector>
+
 using namespace torch;
 using namespace torch::nn;
 
@@ -17,6 +24,55 @@ TEST_CASE("misc") {
     REQUIRE(!model->parameters()["weight"].grad().defined());
   }
 
+  SECTION("grad accumulated hook") {
+    auto model = make(Linear(5, 2));
+    auto x = Var(at::CPU(at::kFloat).randn({10, 5}), true);
+    auto& engine = autograd::Engine::getDefaultEngine();
+
+    std::mutex mutex;
+    std::vector<at::TensorImpl*> ready;
+    auto handle = engine.add_grad_accumulated_hook([&](const Variable& var) {
+      // the gradient is already accumulated when the hook runs
+      REQUIRE(var.grad().defined());
+      std::lock_guard<std::mutex> lock(mutex);
+      ready.push_back(var.get());
+    });
+    backward(model->forward({x})[0].sum());
+    engine.remove_grad_accumulated_hook(handle);
+
+    // weight, bias and x
+    REQUIRE(ready.size() == 3);
+    auto count = [&](const Variable& var) {
+      return std::count(ready.begin(), ready.end(), var.get());
+    };
+    REQUIRE(count(model->parameters()["weight"]) == 1);
+    REQUIRE(count(model->parameters()["bias"]) == 1);
+    REQUIRE(count(x) == 1);
+
+    backward(model->forward({x})[0].sum());
+    REQUIRE(ready.size() == 3);
+  }
+
+  SECTION("checkpoint") {
+    auto model = make(Linear(5, 2));
+    auto x = Var(at::CPU(at::kFloat).randn({10, 5}), true);
+    backward(model->forward({x})[0].sum());
+    auto weight_grad = model->parameters()["weight"].grad().clone();
+
+    int calls = 0;
+    auto forward = [&](const autograd::variable_list& inputs) {
+      calls++;
+      return model->forward(inputs);
+    };
+    auto y = Var(x.data().clone(), true);
+    auto out = autograd::Checkpoint::run(forward, {y})[0];
+    REQUIRE(calls == 1);
+    backward(out.sum());
+    REQUIRE(calls == 2);
+    REQUIRE(y.grad().allclose(x.grad()));
+    REQUIRE(model->parameters()["weight"].grad().allclose(weight_grad * 2));
+  }
+
   SECTION("CPU random seed") {
     int size = 100;
     setSeed(7);
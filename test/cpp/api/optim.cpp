@@ -80,3 +80,55 @@ TEST_CASE("optim") {
     REQUIRE(test_optimizer_xor(optim, model));
   }
 }
+
+TEST_CASE("optim_sparse") {
+  auto sparse_model = make(Embedding(10, 3).sparse());
+  auto dense_model = make(Embedding(10, 3));
+  dense_model->weight.data().copy_(sparse_model->weight.data());
+  auto initial = sparse_model->weight.data().clone();
+
+  auto run = [&](std::vector<int64_t> rows, Optimizer sparse_optim, Optimizer dense_optim) {
+    auto input = at::CPU(at::kLong).tensor({static_cast<int64_t>(rows.size())});
+    for (size_t i = 0; i < rows.size(); i++) {
+      input[i] = rows[i];
+    }
+    for (auto& pair : {std::make_pair(sparse_model, sparse_optim),
+                       std::make_pair(dense_model, dense_optim)}) {
+      pair.second->zero_grad();
+      auto output = pair.first->forward({Var(input, false)})[0];
+      backward(output.pow(2).sum());
+      pair.second->step();
+    }
+    REQUIRE(sparse_model->weight.grad().type().is_sparse());
+  };
+
+  SECTION("adagrad") {
+    auto sparse_optim = Adagrad(sparse_model, 0.1).lr_decay(1e-3).make();
+    auto dense_optim = Adagrad(dense_model, 0.1).lr_decay(1e-3).make();
+    // rows without gradient don't change in either, so both agree everywhere
+    run({1, 3, 3}, sparse_optim, dense_optim);
+    run({3, 7}, sparse_optim, dense_optim);
+    REQUIRE(sparse_model->weight.data().allclose(dense_model->weight.data()));
+    REQUIRE(sparse_model->weight.data()[0].equal(initial[0]));
+  }
+
+  SECTION("adam") {
+    auto sparse_optim = Adam(sparse_model, 0.1).make();
+    auto dense_optim = Adam(dense_model, 0.1).make();
+    run({1, 3, 3}, sparse_optim, dense_optim);
+    REQUIRE(sparse_model->weight.data().allclose(dense_model->weight.data()));
+    // the dense moments of row 1 keep moving it, the lazy update doesn't
+    auto row1 = sparse_model->weight.data()[1].clone();
+    run({3}, sparse_optim, dense_optim);
+    REQUIRE(sparse_model->weight.data()[1].equal(row1));
+    REQUIRE(!dense_model->weight.data()[1].equal(row1));
+    REQUIRE(sparse_model->weight.data()[3].allclose(dense_model->weight.data()[3]));
+  }
+
+  SECTION("unsupported") {
+    auto optim = Adam(sparse_model, 0.1).amsgrad().make();
+    auto output = sparse_model->forward({Var(at::CPU(at::kLong).ones({1}), false)})[0];
+    backward(output.sum());
+    REQUIRE_THROWS(optim->step());
+  }
+}
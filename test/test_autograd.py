@@ -1,5 +1,6 @@
 import contextlib
 import gc
+import os
 import sys
 import math
 import torch
@@ -192,6 +193,35 @@ class TestAutograd(TestCase):
         x_grad, x_grad_clone = compute_grad(create_graph=True)
         self.assertEqual(x_grad, x_grad_clone)
 
+    def test_accumulate_grad_reuses_buffers(self):
+        x = torch.randn(5, 5, requires_grad=True)
+        grad_output = torch.ones(5, 5)
+        # The gradients of x flowing through the branches are summed in place
+        # unless they are visible elsewhere, like grad_output for x + 1
+        y = (x * 2) + (x * 3) + (x + 1) + x.t().t()
+        y.backward(grad_output)
+        self.assertEqual(x.grad, torch.full((5, 5), 7))
+        self.assertEqual(grad_output, torch.ones(5, 5))
+
+        # A gradient seen by nobody else becomes x.grad and is then
+        # accumulated into; grad_output must not alias it
+        x.grad = None
+        (x * 2).backward(grad_output)
+        x_grad = x.grad
+        (x + 1).backward(grad_output)
+        self.assertIs(x.grad, x_grad)
+        self.assertEqual(x.grad, torch.full((5, 5), 3))
+        self.assertEqual(grad_output, torch.ones(5, 5))
+
+        # A hook that keeps the gradient around sees it unchanged
+        seen = []
+        x.grad = None
+        x.register_hook(lambda grad: seen.append(grad))
+        (x * 2).backward(grad_output)
+        (x * 2).backward(grad_output)
+        self.assertEqual(seen[0], torch.full((5, 5), 2))
+        self.assertEqual(x.grad, torch.full((5, 5), 4))
+
     def test_hessian_vector(self):
         x = torch.randn(2, 2, requires_grad=True)
         y = torch.randn(2, 2, requires_grad=True)
@@ -1809,6 +1839,81 @@ class TestAutograd(TestCase):
         out.sum().backward()
         self.assertEqual(x.grad.data, y_data)
 
+    def test_multiple_cpu_workers(self):
+        # The number of CPU workers is read when the engine starts its
+        # threads, so this has to run in a fresh process.
+        import subprocess
+        script = """if True:
+            import threading
+            import torch
+            from torch.utils.checkpoint import checkpoint
+
+            w = torch.randn(10, 10, requires_grad=True)
+            x = torch.randn(10, 10)
+
+            def step():
+                # checkpoint makes the backward pass reentrant
+                branches = [checkpoint(lambda x: (x * w).tanh(), x) for _ in range(8)]
+                sum(b.sum() for b in branches).backward()
+
+            step()
+            expected = w.grad.clone() * 80
+            w.grad.zero_()
+
+            def run():
+                for _ in range(20):
+                    step()
+
+            threads = [threading.Thread(target=run) for _ in range(4)]
+            for t in threads:
+                t.start()
+            for t in threads:
+                t.join()
+            # concurrent AccumulateGrad calls must not lose updates
+            assert (w.grad - expected).abs().max() < 1e-3
+            print('OK')
+        """
+        env = dict(os.environ, TORCH_AUTOGRAD_CPU_WORKERS='4')
+        output = subprocess.check_output([sys.executable, '-c', script], env=env)
+        self.assertEqual(output.decode('ascii').strip(), 'OK')
+
+    def test_set_num_cpu_workers(self):
+        import subprocess
+        script = """if True:
+            import torch
+
+            assert torch.autograd.get_num_cpu_workers() == 1
+            torch.autograd.set_num_cpu_workers(4)
+            assert torch.autograd.get_num_cpu_workers() == 4
+
+            # independent branches, run by different workers
+            w = torch.randn(10, 10, requires_grad=True)
+            xs = [torch.randn(10, 10) for _ in range(8)]
+            sum(x.mm(w).tanh().sum() for x in xs).backward()
+            expected = sum(x.t().mm(1 - x.mm(w.detach()).tanh().pow(2)) for x in xs)
+            assert (w.grad - expected).abs().max() < 1e-4
+
+            torch.autograd.set_num_cpu_workers(4)
+            try:
+                torch.autograd.set_num_cpu_workers(2)
+            except RuntimeError:
+                print('OK')
+        """
+        env = dict(os.environ)
+        env.pop('TORCH_AUTOGRAD_CPU_WORKERS', None)
+        output = subprocess.check_output([sys.executable, '-c', script], env=env)
+        self.assertEqual(output.decode('ascii').strip(), 'OK')
+
+    def test_last_backward_peak_memory(self):
+        x = torch.randn(1000, requires_grad=True)
+        # a chain holds a single gradient at a time
+        (x * 2 * 3 * 4).sum().backward()
+        self.assertEqual(torch.autograd.last_backward_peak_memory(), 4000)
+        # the gradients of both branches are counted until they are summed
+        y = x * 2
+        (y * 3 + y * 4).sum().backward()
+        self.assertEqual(torch.autograd.last_backward_peak_memory(), 8000)
+
     def test_cat(self):
         f_args_variable = (torch.randn(1, S, S, requires_grad=True),
                            torch.randn(2, S, S, requires_grad=True),
@@ -2014,6 +2119,82 @@ class TestAutograd(TestCase):
             self.assertEqual(info.name, expected_name)
             last_end = info.cpu_interval.end
 
+    def test_profiler_shapes_and_memory(self):
+        x = torch.randn(10, 10)
+        z = torch.randn(20, 5)
+
+        with profile(record_shapes=True, profile_memory=True) as p:
+            y = x * 2 + 4
+            w = z * 2
+
+        events = p.function_events
+        self.assertEqual([evt.name for evt in events], ['mul', 'add', 'mul'])
+        self.assertEqual([evt.input_shapes for evt in events], [[[10, 10]], [[10, 10]], [[20, 5]]])
+        for evt in events:
+            # each op allocates its result
+            self.assertGreaterEqual(evt.cpu_memory_usage, 100 * 4)
+            self.assertEqual(evt.cuda_memory_usage, 0)
+
+        averages = {evt.key: evt for evt in p.key_averages()}
+        self.assertEqual(averages['mul'].count, 2)
+        self.assertIsNone(averages['mul'].input_shapes)
+        self.assertEqual(averages['mul'].cpu_memory_usage,
+                         events[0].cpu_memory_usage + events[2].cpu_memory_usage)
+        by_shape = p.key_averages(group_by_input_shape=True)
+        self.assertEqual(sorted(evt.input_shapes for evt in by_shape if evt.key == 'mul'),
+                         [[[10, 10]], [[20, 5]]])
+        table = p.key_averages().table()
+        self.assertIn('CPU Mem', table)
+
+        # nothing is recorded by default
+        with profile() as p:
+            y = x * 2
+        self.assertIsNone(p.function_events[0].input_shapes)
+        self.assertEqual(p.function_events[0].cpu_memory_usage, 0)
+        self.assertNotIn('CPU Mem', p.key_averages().table())
+
+    def test_profiler_chrome_trace(self):
+        import json
+        import tempfile
+        x = torch.randn(10, 10)
+
+        with profile() as p:
+            y = x * 2 + 4
+            with torch.autograd.profiler.range('my_range'):
+                y = y * 3
+
+        fd, path = tempfile.mkstemp(suffix='.json')
+        os.close(fd)
+        try:
+            p.export_chrome_trace(path)
+            with open(path) as f:
+                trace = json.load(f)
+        finally:
+            os.remove(path)
+        names = [evt['name'] for evt in trace]
+        self.assertEqual(sorted(names), sorted(evt.name for evt in p.function_events))
+        self.assertIn('my_range', names)
+        for evt in trace:
+            self.assertEqual(evt['ph'], 'X')
+            self.assertEqual(evt['pid'], 'CPU functions')
+            self.assertGreaterEqual(evt['dur'], 0)
+
+    def test_sampled_profiler(self):
+        x = torch.randn(10, 10)
+        traces = []
+
+        with torch.autograd.profiler.sampled_profile(3, on_trace=traces.append) as sampler:
+            for i in range(7):
+                y = x * 2
+                sampler.step()
+
+        # iterations 0, 3 and 6 are sampled
+        self.assertEqual(len(traces), 3)
+        for prof in traces:
+            self.assertEqual([evt.name for evt in prof.function_events], ['mul'])
+        self.assertIs(sampler.last_trace, traces[-1])
+        self.assertRaises(ValueError, lambda: torch.autograd.profiler.sampled_profile(0))
+
     def test_dir(self):
         x = torch.randn(10, 10)
         keys = dir(x)
@@ -2196,6 +2377,37 @@ class TestAutograd(TestCase):
         test()
         self.assertEqual(dealloc[0], 1)
 
+    def test_compress_saved_tensors(self):
+        x = torch.randn(32, 32, requires_grad=True)
+        y = torch.randn(32, 32)
+        mask = y > 0
+        with torch.autograd.compress_saved_tensors(min_bytes=0):
+            z = (x * y).masked_fill(mask, 0).tanh()
+        z.sum().backward()
+        expected = (1 - z.detach() ** 2) * y.masked_fill(mask, 0)
+        # the masked elements must get exactly zero, the others lose precision
+        self.assertEqual(x.grad[mask].abs().sum(), 0)
+        self.assertEqual(x.grad, expected, prec=1e-2)
+
+        # small tensors are saved as they are
+        x.grad.data.zero_()
+        with torch.autograd.compress_saved_tensors(min_bytes=1 << 20):
+            z = (x * y).masked_fill(mask, 0).tanh()
+        z.sum().backward()
+        self.assertEqual(x.grad, (1 - z.detach() ** 2) * y.masked_fill(mask, 0))
+
+    @unittest.skipIf(not torch.cuda.is_available(), "CUDA unavailable")
+    def test_offload_saved_tensors(self):
+        x = torch.randn(64, 64, device='cuda', requires_grad=True)
+        (x.tanh() * x.exp()).tanh().sum().backward()
+        expected = x.grad.clone()
+
+        x.grad.data.zero_()
+        with torch.autograd.offload_saved_tensors(min_bytes=0, prefetch=1):
+            y = (x.tanh() * x.exp()).tanh().sum()
+        y.backward()
+        self.assertEqual(x.grad, expected)
+
     def test_mul_out(self):
         a = torch.randn(2, 2, requires_grad=True)
         b = torch.randn(2, 2, requires_grad=True)
@@ -7,6 +7,7 @@ from itertools import repeat
 import torch
 import torch.cuda
 import torch.cuda.comm as comm
+import torch.nn.functional as F
 
 from test_torch import TestTorch
 from common import TestCase, get_gpu_type, to_gpu, freeze_rng_state, run_tests
@@ -695,6 +696,55 @@ class TestCuda(TestCase):
         for _ in self._test_memory_stats_generator(self):
             pass
 
+    def test_memory_snapshot(self):
+        torch.cuda.empty_cache()
+        stats = torch.cuda.memory_stats()
+        self.assertEqual(stats['allocated_bytes'], torch.cuda.memory_allocated())
+        self.assertEqual(stats['cached_bytes'], torch.cuda.memory_cached())
+
+        x = torch.cuda.FloatTensor(1024)
+        y = torch.cuda.FloatTensor(1024)
+        ptr = y.data_ptr()
+        del y
+
+        segments = torch.cuda.memory_snapshot()
+        self.assertEqual(torch.cuda.memory_stats()['num_segments'], len(segments))
+        self.assertEqual(sum(s['total_size'] for s in segments), torch.cuda.memory_cached())
+        self.assertEqual(sum(s['allocated_size'] for s in segments), torch.cuda.memory_allocated())
+
+        def block_state(address):
+            for segment in segments:
+                self.assertEqual(sum(b['size'] for b in segment['blocks']), segment['total_size'])
+                block_address = segment['address']
+                for block in segment['blocks']:
+                    if block_address == address:
+                        return segment['segment_type'], block['state']
+                    block_address += block['size']
+            return None
+
+        self.assertEqual(block_state(x.data_ptr()), ('small', 'active_allocated'))
+        self.assertEqual(block_state(ptr), ('small', 'inactive'))
+        self.assertGreater(torch.cuda.memory_stats()['inactive_split_bytes'], 0)
+        del x
+
+    def test_memory_trace(self):
+        torch.cuda.empty_cache()
+        torch.cuda._record_memory_history(True, max_entries=2)
+        try:
+            x = torch.cuda.FloatTensor(1024)
+            ptr = x.data_ptr()
+            del x
+            entries, stacks = torch.cuda._memory_trace()
+        finally:
+            torch.cuda._record_memory_history(False)
+
+        # the ring buffer keeps only the last 2 events, dropping the
+        # segment_alloc if the block was not cached
+        self.assertEqual([e['action'] for e in entries], ['alloc', 'free'])
+        self.assertEqual(entries[0]['address'], ptr)
+        self.assertEqual(entries[0]['size'], 4096)
+        self.assertIn('test_memory_trace', stacks[entries[0]['stack_id']])
+
     @unittest.skipIf(torch.cuda.device_count() < 2, "only one GPU detected")
     def test_memory_stats_multigpu(self):
         # advance a generator with a end flag
@@ -946,6 +996,14 @@ class TestCuda(TestCase):
         ]
         self._test_reduce_add_coalesced(self, tensors, num_bytes * 5 // 2)
 
+    @unittest.skipIf(torch.cuda.device_count() < 2, "only one GPU detected")
+    def test_reduce_add_coalesced_many_buckets(self):
+        # many small tensors, spread over buckets that are reduced while the
+        # next ones are flattened
+        tensors = [torch.randn(i % 7 + 1, 3).cuda() for i in range(200)]
+        tensors += [torch.randn(5).double().cuda(), torch.randn(4, 4).cuda()]
+        self._test_reduce_add_coalesced(self, tensors, 256)
+
     @unittest.skipIf(torch.cuda.device_count() < 2, "only one GPU detected")
     def test_reduce_add_coalesced_dense_only(self):
         numel = 5
@@ -1024,6 +1082,15 @@ class TestCuda(TestCase):
     def test_gather_dim(self):
         self._test_gather(1)
 
+    def test_gather_cpu(self):
+        if torch.cuda.device_count() < 2:
+            raise unittest.SkipTest("only one GPU detected")
+        x = torch.randn(2, 5).cuda(0)
+        y = torch.randn(3, 5).cuda(1)
+        result = comm.gather((x, y), -2, destination=-1)
+        self.assertFalse(result.is_cuda)
+        self.assertEqual(result, torch.cat((x.cpu(), y.cpu()), 0))
+
     def test_from_sequence(self):
         seq = [list(range(i * 4, i * 4 + 4)) for i in range(5)]
         reference = torch.arange(0, 20).resize_(5, 4)
@@ -1265,6 +1332,76 @@ class TestCuda(TestCase):
             tmp3 = torch.cuda.FloatTensor(t.size())
             self.assertEqual(tmp3.data_ptr(), ptr[0], 'allocation not re-used')
 
+    def test_record_stream_independent_streams(self):
+        cycles_per_ms = get_cycles_per_ms()
+
+        slow = torch.cuda.Stream()
+        fast = torch.cuda.Stream()
+
+        # a is used on a stream that stays busy for a long time
+        a = torch.cuda.FloatTensor(1024)
+        with torch.cuda.stream(slow):
+            torch.cuda._sleep(int(100 * cycles_per_ms))
+        a.record_stream(slow)
+        del a
+
+        # b is used on a stream that finishes right away
+        b = torch.cuda.FloatTensor(256)
+        b.record_stream(fast)
+        ptr = b.data_ptr()
+        del b
+        fast.synchronize()
+
+        # b's block must not wait for the event on the slow stream
+        c = torch.cuda.FloatTensor(256)
+        self.assertEqual(c.data_ptr(), ptr, 'allocation not re-used')
+        self.assertFalse(slow.query())
+        slow.synchronize()
+
+    def test_prefetcher(self):
+        batches = [(torch.randn(4, 3), torch.arange(0, n)) for n in (5, 3, 8, 1)]
+        prefetcher = torch.cuda.Prefetcher(num_buffers=2)
+        results = list(prefetcher.iterate(batches))
+        self.assertEqual(len(results), len(batches))
+        for (x, y), (x_cuda, y_cuda) in zip(batches, results):
+            self.assertTrue(x_cuda.is_cuda)
+            self.assertFalse(x_cuda.requires_grad)
+            self.assertEqual(x_cuda.cpu(), x)
+            self.assertEqual(y_cuda.cpu(), y)
+        self.assertEqual(prefetcher.pending(), 0)
+        self.assertRaises(RuntimeError, lambda: prefetcher.get())
+        self.assertRaises(RuntimeError, lambda: prefetcher.put([torch.randn(2).cuda()]))
+
+    def test_prefetcher_side_stream(self):
+        cycles_per_ms = get_cycles_per_ms()
+        prefetcher = torch.cuda.Prefetcher()
+        x = torch.randn(1024)
+        prefetcher.put([x])
+        y, = prefetcher.get()
+        # y must wait for the copy, and its block for the work of the current stream
+        torch.cuda._sleep(int(50 * cycles_per_ms))
+        result = y.mul(2)
+        ptr = y.data_ptr()
+        del y
+        prefetcher.put([torch.randn(1024)])
+        self.assertNotEqual(prefetcher.get()[0].data_ptr(), ptr)
+        self.assertEqual(result.cpu(), x * 2)
+
+    def test_caching_pinned_memory_size_classes(self):
+        # slightly different sizes share a size class
+        t = torch.FloatTensor(1000).pin_memory()
+        ptr = t.data_ptr()
+        del t
+        t = torch.FloatTensor(900).pin_memory()
+        self.assertEqual(t.data_ptr(), ptr, 'allocation not reused')
+
+    def test_reserve_pinned_memory(self):
+        torch.cuda.reserve_pinned_memory(3 << 20, count=2)
+        a = torch.ByteTensor(3 << 20).pin_memory()
+        b = torch.ByteTensor(2 << 20).pin_memory()
+        self.assertNotEqual(a.data_ptr(), b.data_ptr())
+        self.assertTrue(a.is_pinned() and b.is_pinned())
+
     def test_noncontiguous_pinned_memory(self):
         # See issue #3266
         x = torch.arange(0, 10).view((2, 5))
@@ -1330,6 +1467,10 @@ class TestCuda(TestCase):
     def test_gesv_batched_dims(self):
         TestTorch._test_gesv_batched_dims(self, lambda t: t.cuda())
 
+    @unittest.skipIf(not HAS_MAGMA, "no MAGMA library detected")
+    def test_batched_small_matrices(self):
+        TestTorch._test_batched_small_matrices(self, lambda t: t.cuda())
+
     def test_view(self):
         TestTorch._test_view(self, lambda t: t.cuda())
 
@@ -1338,6 +1479,14 @@ class TestCuda(TestCase):
             return torch.cuda.DoubleTensor(*sizes).normal_()
         TestTorch._test_fft_ifft_rfft_irfft(self, build_fn=cuda_randn_double)
 
+    def test_fft_plan_cache(self):
+        x = torch.randn(5, 8, 2, dtype=torch.double, device='cuda')
+        TestTorch._test_fft_plan_cache(self, x,
+                                       torch.cuda.cufft_plan_cache_max_size,
+                                       torch.cuda.set_cufft_plan_cache_max_size,
+                                       torch.cuda.cufft_plan_cache_size,
+                                       torch.cuda.clear_cufft_plan_cache)
+
     def test_stft(self):
         def cuda_randn_double(*sizes):
             return torch.cuda.DoubleTensor(*sizes).normal_()
@@ -1385,6 +1534,45 @@ class TestCuda(TestCase):
     def test_advancedindex(self):
         TestTorch._test_advancedindex(self, lambda t: t.cuda())
 
+    def test_index_rows(self):
+        # Index ops along dim 0 of contiguous tensors with wide rows move
+        # whole rows, in vectors when the row size allows. The results are
+        # checked against double precision ones on the CPU.
+        for dtype in [torch.float, torch.double, torch.half, torch.long]:
+            prec = 1 if dtype == torch.half else 1e-5
+            for width in [512, 67]:
+                src = torch.randn(50, width).mul(10).to(dtype).cuda()
+                ref = src.double().cpu()
+                # Sorted, with repeats, as in the backward of embeddings
+                idx = torch.randint(0, 50, (300,), dtype=torch.long).sort()[0]
+                perm = torch.randperm(50)
+
+                def zeros(rows):
+                    return torch.zeros(rows, width, dtype=dtype, device='cuda')
+
+                self.assertEqual(src.index_select(0, idx.cuda()).double().cpu(),
+                                 ref.index_select(0, idx))
+                # A strided index
+                self.assertEqual(src.index_select(0, idx.cuda()[::3]).double().cpu(),
+                                 ref.index_select(0, idx[::3]))
+                self.assertEqual(zeros(50).index_copy_(0, perm.cuda(), src).double().cpu(),
+                                 torch.zeros_like(ref).index_copy_(0, perm, ref))
+
+                rows = ref.index_select(0, idx)
+                summed = torch.zeros_like(ref).index_add_(0, idx, rows)
+                result = zeros(50).index_add_(0, idx.cuda(), rows.to(dtype).cuda())
+                self.assertEqual(result.double().cpu(), summed, prec=prec)
+
+                # Gather and scatter with an index expanded along the rows
+                row_idx = idx.unsqueeze(1).expand(300, width)
+                perm_idx = perm.unsqueeze(1).expand(50, width)
+                self.assertEqual(src.gather(0, row_idx.cuda()).double().cpu(),
+                                 ref.gather(0, row_idx))
+                self.assertEqual(zeros(50).scatter_(0, perm_idx.cuda(), src).double().cpu(),
+                                 torch.zeros_like(ref).scatter_(0, perm_idx, ref))
+                result = zeros(50).scatter_add_(0, row_idx.cuda(), rows.to(dtype).cuda())
+                self.assertEqual(result.double().cpu(), summed, prec=prec)
+
     def test_advancedindex_mixed_cpu_cuda(self):
         def test(x, ia, ib):
             # test getitem
@@ -1457,6 +1645,42 @@ class TestCuda(TestCase):
     def test_tensor_scatterFill(self):
         TestTorch._test_scatter_base(self, lambda t: t.cuda(), 'scatter_', True, test_bounds=False)
 
+    def test_sort_large_slices(self):
+        # Slices above the in-place bitonic sort limit take the segmented
+        # sort path, possibly along a non-innermost dim
+        for t in [torch.float, torch.double, torch.long]:
+            for dim in [0, 1]:
+                for descending in [False, True]:
+                    x = torch.stack([torch.randperm(5000) for _ in range(6)], dim)
+                    x = x.to(t)
+                    res, idx = x.cuda().sort(dim, descending)
+                    expected, expected_idx = x.sort(dim, descending)
+                    self.assertEqual(res.cpu(), expected)
+                    self.assertEqual(idx.cpu(), expected_idx)
+
+        # Non-contiguous input, and ties, which are kept in order
+        x = torch.randint(0, 10, (4, 5000)).cuda().t()
+        res, idx = x.sort(0)
+        self.assertEqual(res, x.gather(0, idx))
+        self.assertTrue((res[1:] >= res[:-1]).all())
+        ties = res[1:] == res[:-1]
+        self.assertTrue((idx[1:] > idx[:-1])[ties].all())
+
+    def test_topk_large_slices(self):
+        # A few huge slices take the multi-block selection and many slices
+        # with a small k the warp heaps, possibly along a non-innermost dim
+        for t in [torch.float, torch.double, torch.long, torch.uint8]:
+            for shape, k in [((2, 1 << 18), 1000), ((1 << 18,), 7), ((600, 300), 5), ((600, 300), 63)]:
+                for largest in [False, True]:
+                    x = torch.randint(0, 100, shape).to(t)
+                    x = x.t() if x.dim() == 2 else x
+                    res, idx = x.cuda().topk(k, 0, largest, True)
+                    expected, _ = x.sort(0, largest)
+                    self.assertEqual(res.cpu(), expected.narrow(0, 0, k), 0)
+                    self.assertEqual(x.gather(0, idx.cpu()), res.cpu(), 0)
+                    sorted_idx, _ = idx.sort(0)
+                    self.assertTrue((sorted_idx[1:] != sorted_idx[:-1]).all())
+
     def test_min_max_inits(self):
         # Testing if THC_reduceAll received the correct index initialization.
         # This affects the result of THC_reduceAll operations at extreme values
@@ -1512,6 +1736,156 @@ class TestCuda(TestCase):
 
         self.assertEqual(tensor_cpu.var(2), tensor_cuda.var(2).cpu())
 
+    def test_pointwise_layouts(self):
+        # contiguous and aligned, misaligned, transposed and strided operands
+        x = torch.rand(67, 129) + 0.5
+        inputs = [x, x[:, 1:], x.t(), x[::2, ::3]]
+        for input in inputs:
+            for t in (torch.float, torch.double):
+                cpu = input.to(t)
+                cuda = cpu.cuda()
+                for op in ('exp', 'log', 'sqrt', 'tanh', 'floor', 'abs'):
+                    self.assertEqual(getattr(cuda, op)().cpu(), getattr(cpu, op)())
+                    self.assertEqual(getattr(cuda.clone(), op + '_')().cpu(), getattr(cpu.clone(), op + '_')())
+            half = input.cuda().half()
+            self.assertEqual(half.exp().float(), half.float().exp(), 1e-2)
+
+        a, b, c = torch.rand(3, 1, 33) + 0.5, torch.rand(33, 1) + 0.5, torch.rand(33, 33) + 0.5
+        for cpu in ((a, b, c), (c.t(), c, c[:, 1:].narrow(0, 0, 1))):
+            cuda = tuple(t.cuda() for t in cpu)
+            self.assertEqual(torch.addcmul(*cuda, value=2).cpu(), torch.addcmul(*cpu, value=2))
+            self.assertEqual(torch.addcdiv(*cuda, value=0.5).cpu(), torch.addcdiv(*cpu, value=0.5))
+        self.assertEqual(torch.lerp(c.cuda().t(), b.cuda(), 0.3).cpu(), torch.lerp(c.t(), b, 0.3))
+
+        # integral tensors are still handled by THC
+        i = torch.cuda.LongTensor([-3, 0, 2])
+        self.assertEqual(i.abs().cpu(), torch.LongTensor([3, 0, 2]))
+
+    def test_var_long_rows(self):
+        # few long rows are split over several blocks; the offset row start
+        # isn't aligned for vectorized loads
+        tensor_cpu = torch.randn(3, 100003).double()
+        tensor_cuda = tensor_cpu.cuda()
+        for unbiased in (True, False):
+            self.assertEqual(tensor_cpu.var(1, unbiased), tensor_cuda.var(1, unbiased).cpu())
+            self.assertEqual(tensor_cpu.std(-1, unbiased, keepdim=True),
+                             tensor_cuda.std(-1, unbiased, keepdim=True).cpu())
+        self.assertEqual(tensor_cpu[:, 1:].var(1), tensor_cuda[:, 1:].var(1).cpu())
+        self.assertEqual(tensor_cpu.view(-1)[1:].var(0), tensor_cuda.view(-1)[1:].var(0).cpu())
+
+    def test_batch_norm_stats(self):
+        for size in ((4, 3, 5, 5), (2, 2, 40000), (7, 5)):
+            x = torch.randn(*size)
+            mean, var = torch._batch_norm_stats(x.cuda())
+            expected_mean, expected_var = torch._batch_norm_stats(x)
+            self.assertEqual(mean.cpu(), expected_mean)
+            self.assertEqual(var.cpu(), expected_var)
+            self.assertEqual(mean.cpu(), x.transpose(0, 1).contiguous().view(x.size(1), -1).mean(1))
+
+    def test_softmax_long_rows(self):
+        x = torch.randn(2, 30001).cuda()
+        for input in (x, x[:, 1:]):
+            self.assertEqual(F.softmax(input, 1).cpu(), F.softmax(input.cpu(), 1))
+            self.assertEqual(F.log_softmax(input, 1).cpu(), F.log_softmax(input.cpu(), 1))
+        # the one pass max and sum rescale by exp(old_max - new_max)
+        x = torch.arange(0, 2000).cuda() * 0.1
+        self.assertEqual(F.softmax(x, 0).cpu(), F.softmax(x.cpu(), 0))
+
+    def test_scan_and_compaction_long_rows(self):
+        # long rows take the single segmented scan
+        x_cpu = torch.randn(3, 5000).double()
+        x = x_cpu.cuda()
+        self.assertEqual(x.cumsum(1).cpu(), x_cpu.cumsum(1))
+        self.assertEqual(x.cumprod(1).cpu(), x_cpu.cumprod(1))
+        self.assertEqual(x.t().cumsum(0).cpu(), x_cpu.t().cumsum(0))
+        self.assertEqual(x.view(-1).cumsum(0).cpu(), x_cpu.view(-1).cumsum(0))
+        mask = x > 0.5
+        self.assertEqual(x.masked_select(mask).cpu(), x_cpu.masked_select(mask.cpu()))
+        self.assertEqual(x.t().masked_select(mask.t()).cpu(), x_cpu.t().masked_select(mask.cpu().t()))
+        self.assertEqual(mask.nonzero().cpu(), mask.cpu().nonzero())
+        self.assertEqual(x.new(0).masked_select(mask.new(0)).numel(), 0)
+        self.assertEqual(mask.new(0).nonzero().numel(), 0)
+
+    def test_half_mm_unaligned(self):
+        # sizes that aren't multiples of 8 are padded for the tensor cores
+        # when the product is large enough
+        for m, n, k in ((257, 255, 259), (5, 3, 7)):
+            a = torch.randn(m, k).cuda()
+            b = torch.randn(k, n).cuda()
+            c = torch.randn(m, n).cuda()
+            expected = torch.addmm(c, a.half().float(), b.half().float())
+            result = torch.addmm(c.half(), a.half(), b.half()).float()
+            self.assertEqual(result, expected, prec=0.5)
+            result = torch.mm(a.t().contiguous().half().t(), b.half()).float()
+            self.assertEqual(result, torch.mm(a.half().float(), b.half().float()), prec=0.5)
+
+    def test_autocast(self):
+        a = torch.randn(8, 8, device='cuda', requires_grad=True)
+        b = torch.randn(8, 8, device='cuda')
+        with torch.cuda.amp.autocast():
+            self.assertTrue(torch._C.is_autocast_enabled())
+            out = torch.mm(a, b)
+            self.assertEqual(out.dtype, torch.float16)
+            self.assertEqual(torch.softmax(out, 1).dtype, torch.float32)
+            self.assertEqual((out + out).dtype, torch.float16)
+            self.assertEqual(torch.mm(a.cpu(), b.cpu()).dtype, torch.float32)
+            with torch.cuda.amp.autocast(enabled=False):
+                self.assertEqual(torch.mm(a, b).dtype, torch.float32)
+        self.assertFalse(torch._C.is_autocast_enabled())
+        out.float().sum().backward()
+        self.assertEqual(a.grad.dtype, torch.float32)
+        self.assertEqual(a.grad, torch.ones(8, 8, device='cuda').mm(b.t()), prec=0.05)
+
+    def test_amp_unscale_and_update_scale(self):
+        for device in ('cpu', 'cuda'):
+            grads = [torch.full((5,), 4., device=device), torch.full((1000,), 8., device=device)]
+            found_inf = torch.zeros(1, device=device)
+            inv_scale = torch.full((1,), 0.25, device=device)
+            torch._amp_unscale(grads, found_inf, inv_scale)
+            self.assertEqual(found_inf.item(), 0)
+            self.assertEqual(grads[0], torch.ones(5, device=device))
+            self.assertEqual(grads[1], torch.full((1000,), 2., device=device))
+            grads[1][500] = float('inf')
+            torch._amp_unscale(grads, found_inf, inv_scale)
+            self.assertEqual(found_inf.item(), 1)
+
+            growth_tracker = torch.zeros(1, dtype=torch.int32, device=device)
+            scale = torch.full((1,), 4., device=device)
+            no_inf = torch.zeros(1, device=device)
+            scale = torch._amp_update_scale(growth_tracker, scale, no_inf, 2., 0.5, 2)
+            self.assertEqual(scale.item(), 4)
+            self.assertEqual(growth_tracker.item(), 1)
+            scale = torch._amp_update_scale(growth_tracker, scale, no_inf, 2., 0.5, 2)
+            self.assertEqual(scale.item(), 8)
+            self.assertEqual(growth_tracker.item(), 0)
+            scale = torch._amp_update_scale(growth_tracker, scale, found_inf, 2., 0.5, 2)
+            self.assertEqual(scale.item(), 4)
+
+    def test_grad_scaler(self):
+        model = torch.nn.Linear(4, 4).cuda()
+        optimizer = torch.optim.SGD(model.parameters(), lr=0.1)
+        scaler = torch.cuda.amp.GradScaler(init_scale=4., growth_interval=1)
+        weight = model.weight.data.clone()
+        with torch.cuda.amp.autocast():
+            loss = model(torch.randn(2, 4, device='cuda')).float().sum()
+        scaler.scale(loss).backward()
+        scaler.unscale_(optimizer)
+        grad = model.weight.grad.clone()
+        scaler.step(optimizer)
+        scaler.update()
+        self.assertEqual(model.weight.data, weight - 0.1 * grad)
+        self.assertEqual(scaler.get_scale(), 8.)
+
+        # an overflow skips the step and backs the scale off
+        weight = model.weight.data.clone()
+        optimizer.zero_grad()
+        scaler.scale(model(torch.randn(2, 4, device='cuda')).sum()).backward()
+        model.weight.grad.data[0, 0] = float('inf')
+        self.assertIsNone(scaler.step(optimizer))
+        scaler.update()
+        self.assertEqual(model.weight.data, weight)
+        self.assertEqual(scaler.get_scale(), 4.)
+
     def test_var_stability(self):
         tensor = torch.FloatTensor([2281.5, 2281.25]).cuda()
 
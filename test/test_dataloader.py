@@ -604,6 +604,30 @@ but they are all safe to ignore'''
             batch = next(iter(loader))
             self.assertIsInstance(batch, tt)
 
+    def test_default_collate_tensors(self):
+        samples = [torch.randn(3, 4) for _ in range(5)]
+        samples[2] = samples[2].t().contiguous().t()
+        self.assertEqual(default_collate(samples), torch.stack(samples))
+        # large enough to be copied by several threads
+        samples = [torch.randn(512, 512) for _ in range(8)]
+        self.assertEqual(default_collate(samples), torch.stack(samples))
+        out = torch.Tensor()
+        self.assertIs(torch._C._collate_tensors(samples, out), out)
+        self.assertEqual(out, torch.stack(samples))
+        self.assertRaises(RuntimeError, lambda: default_collate([torch.randn(3), torch.randn(4)]))
+        self.assertRaises(RuntimeError, lambda: default_collate([torch.randn(3), torch.randn(3).long()]))
+        # samples that require grad are stacked with their history
+        x = torch.randn(3, requires_grad=True)
+        default_collate([x, x]).sum().backward()
+        self.assertEqual(x.grad, torch.full_like(x, 2))
+
+    @unittest.skipIf(not TEST_CUDA, "CUDA unavailable")
+    def test_collate_tensors_pin_memory(self):
+        samples = [torch.randn(3, 4) for _ in range(5)]
+        batch = torch._C._collate_tensors(samples, None, True)
+        self.assertTrue(batch.is_pinned())
+        self.assertEqual(batch, torch.stack(samples))
+
     @unittest.skipIf(not TEST_NUMPY, "numpy unavailable")
     def test_default_colate_bad_numpy_types(self):
         import numpy as np
@@ -301,6 +301,39 @@ class _DistTestBase(object):
 
         self._barrier()
 
+    # ISEND/IRECV of several tensors, as between pipeline stages
+    @unittest.skipIf(BACKEND == 'gloo', "Gloo does not support isend")
+    @unittest.skipIf(BACKEND == 'nccl', "Nccl does not support isend")
+    def test_isend_irecv_multiple(self):
+        rank = dist.get_rank()
+        world_size = dist.get_world_size()
+        next_rank = (rank + 1) % world_size
+        prev_rank = (rank - 1) % world_size
+        micro_batches = 4
+
+        # All transfers of all micro batches are in flight at the same time
+        recv_tensors = []
+        requests = []
+        for i in range(micro_batches):
+            tensors = [_build_tensor(i + 1, -1), _build_tensor(i + 2, -1)]
+            recv_tensors.append(tensors)
+            if i % 2 == 0:
+                requests.append(dist.irecv(tensors, prev_rank))
+            else:
+                requests += [dist.irecv(tensor, prev_rank) for tensor in tensors]
+        for i in range(micro_batches):
+            tensors = [_build_tensor(i + 1, rank), _build_tensor(i + 2, rank)]
+            requests.append(dist.isend(tensors, next_rank))
+
+        for request in requests:
+            request.wait()
+            self.assertTrue(request.is_completed())
+        for i, tensors in enumerate(recv_tensors):
+            self.assertEqual(tensors[0], _build_tensor(i + 1, prev_rank))
+            self.assertEqual(tensors[1], _build_tensor(i + 2, prev_rank))
+
+        self._barrier()
+
     # BROADCAST
     def _test_broadcast_helper(self, group, group_id, rank, cuda=False, rank_to_GPU=None):
         for ttype, value, requires_cuda in [
@@ -350,6 +383,16 @@ class _DistTestBase(object):
         group, group_id, rank = self._init_group_test()
         self._test_broadcast_helper(group, group_id, rank)
 
+    @unittest.skipIf(BACKEND == 'nccl', "Nccl does not support CPU tensors")
+    def test_broadcast_async(self):
+        group, group_id, rank = self._init_global_test()
+        for src in group:
+            tensor = _build_tensor(src + 1, src if rank == src else -1)
+            dist.broadcast(tensor, src, group_id, async_op=True).wait()
+            self.assertEqual(tensor, _build_tensor(src + 1, src))
+
+        self._barrier()
+
     # REDUCE
     def _test_reduce_helper(self, group, group_id, rank, op, master_value,
                             worker_value, expected_value, cuda=False, rank_to_GPU=None):
@@ -475,6 +518,19 @@ class _DistTestBase(object):
             group, group_id, rank, dist.reduce_op.SUM, 2, 10, 2 + (10 * (len(group) - 1))
         )
 
+    @unittest.skipIf(BACKEND == 'nccl', "Nccl does not support CPU tensors")
+    def test_all_reduce_sum_async(self):
+        group, group_id, rank = self._init_global_test()
+        tensors = [_build_tensor(src + 1, rank) for src in group]
+        requests = [dist.all_reduce(tensor, dist.reduce_op.SUM, group_id, async_op=True)
+                    for tensor in tensors]
+        for request in requests:
+            request.wait()
+        for src, tensor in zip(group, tensors):
+            self.assertEqual(tensor, _build_tensor(src + 1, sum(group)))
+
+        self._barrier()
+
     @unittest.skipIf(BACKEND != 'gloo' and BACKEND != 'nccl',
                      "Only Gloo & Nccl backend support CUDA allReduce")
     @skip_if_no_cuda_distributed
@@ -508,6 +564,45 @@ class _DistTestBase(object):
             group, group_id, rank, dist.reduce_op.MAX, -1, 10, 10
         )
 
+    @unittest.skipIf(BACKEND == 'nccl', "Nccl does not support CPU tensors")
+    def test_all_reduce_sum_large(self):
+        # large enough for the TCP backend to use ring allreduce; the size
+        # does not divide evenly between processes
+        group, group_id, rank = self._init_global_test()
+        tensor = torch.FloatTensor(1000003).fill_(rank + 1)
+        dist.all_reduce(tensor, dist.reduce_op.SUM, group_id)
+        expected = len(group) * (len(group) + 1) / 2
+        self.assertEqual(tensor, torch.FloatTensor(1000003).fill_(expected))
+        self._barrier()
+
+    @unittest.skipIf(BACKEND == 'nccl', "Nccl does not support CPU tensors")
+    def test_collectives_large_repeated(self):
+        # the Gloo backend runs collectives on memory that comes back in place,
+        # after staging them the first time
+        group, group_id, rank = self._init_global_test()
+        tensor = torch.FloatTensor(1 << 20)
+        for i in range(3):
+            tensor.fill_(rank + i)
+            dist.all_reduce(tensor, dist.reduce_op.SUM, group_id)
+            expected = sum(r + i for r in group)
+            self.assertEqual(tensor, torch.FloatTensor(1 << 20).fill_(expected))
+
+            tensor.fill_(rank + i)
+            dist.broadcast(tensor, group[-1], group_id)
+            self.assertEqual(tensor, torch.FloatTensor(1 << 20).fill_(group[-1] + i))
+        self._barrier()
+
+    @unittest.skipIf(BACKEND != 'tcp',
+                     "Only TCP backend supports CPU allreduce multigpu")
+    def test_all_reduce_multigpu_cpu(self):
+        group, group_id, rank = self._init_global_test()
+        tensors = [_build_tensor(10, rank + i) for i in range(3)]
+        dist.all_reduce_multigpu(tensors, dist.reduce_op.SUM, group_id)
+        expected = sum(r + i for r in group for i in range(3))
+        for tensor in tensors:
+            self.assertEqual(tensor, _build_tensor(10, expected))
+        self._barrier()
+
     @unittest.skipIf(BACKEND == 'nccl', "Nccl does not support newGroup")
     @skip_if_small_worldsize
     def test_all_reduce_group_sum(self):
@@ -626,6 +721,76 @@ class _DistTestBase(object):
         group, group_id, rank = self._init_group_test()
         self._test_all_gather_helper(group, group_id, rank)
 
+    # ALL REDUCE SPARSE
+    def _test_all_reduce_sparse_helper(self, group, group_id, rank):
+        if group:
+            # every rank but the first contributes rows rank and rank + 1
+            size = torch.Size([max(group) + 2, 3])
+            if rank == group[0]:
+                tensor = torch.sparse.FloatTensor(size)
+            else:
+                indices = torch.LongTensor([[rank, rank + 1]])
+                tensor = torch.sparse.FloatTensor(indices, torch.FloatTensor(2, 3).fill_(rank), size)
+            result = dist.all_reduce_sparse(tensor, group_id)
+
+            expected = torch.zeros(size, dtype=torch.float)
+            for r in group[1:]:
+                expected[r] += r
+                expected[r + 1] += r
+            self.assertTrue(result.is_coalesced())
+            self.assertEqual(result.to_dense(), expected)
+
+        self._barrier()
+
+    @unittest.skipIf(BACKEND == 'nccl', "Nccl does not support CPU tensors")
+    def test_all_reduce_sparse(self):
+        group, group_id, rank = self._init_global_test()
+        self._test_all_reduce_sparse_helper(group, group_id, rank)
+
+    @unittest.skipIf(BACKEND == 'nccl', "Nccl does not support newGroup")
+    @skip_if_small_worldsize
+    def test_all_reduce_sparse_group(self):
+        group, group_id, rank = self._init_group_test()
+        self._test_all_reduce_sparse_helper(group, group_id, rank)
+
+    # COMPRESSED ALL REDUCE
+    def _test_compressed_all_reduce_helper(self, group, group_id, rank):
+        from torch.distributed.compression import FP16Compressor, \
+            TopKCompressor, PowerSGDCompressor
+
+        if group:
+            # the sums of these tensors are compressed without loss: small
+            # integers fit in fp16, ratio 1 keeps all entries, and the
+            # tensors are of rank 1
+            total = sum(group) + len(group)
+            for compressor in [FP16Compressor(), TopKCompressor(1), PowerSGDCompressor(1)]:
+                for _ in range(2):
+                    tensor = torch.FloatTensor(4, 4).fill_(rank + 1)
+                    compressor.all_reduce(tensor, group_id, key=0)
+                    self.assertEqual(tensor, torch.FloatTensor(4, 4).fill_(total), prec=1e-3)
+
+            # the entries that are left out are sent by the next call
+            compressor = TopKCompressor(0.5)
+            tensor = torch.FloatTensor([1, 2]) * (rank + 1)
+            compressor.all_reduce(tensor, group_id)
+            self.assertEqual(tensor, torch.FloatTensor([0, 2]) * total)
+            tensor.zero_()
+            compressor.all_reduce(tensor, group_id)
+            self.assertEqual(tensor, torch.FloatTensor([1, 0]) * total)
+
+        self._barrier()
+
+    @unittest.skipIf(BACKEND == 'nccl', "Nccl does not support CPU tensors")
+    def test_compressed_all_reduce(self):
+        group, group_id, rank = self._init_global_test()
+        self._test_compressed_all_reduce_helper(group, group_id, rank)
+
+    @unittest.skipIf(BACKEND == 'nccl', "Nccl does not support newGroup")
+    @skip_if_small_worldsize
+    def test_compressed_all_reduce_group(self):
+        group, group_id, rank = self._init_group_test()
+        self._test_compressed_all_reduce_helper(group, group_id, rank)
+
     # BARRIER
     def _test_barrier_helper(self, group, group_id, rank):
         WAIT_TIME = 0.3  # seconds
@@ -698,8 +863,8 @@ class _DistTestBase(object):
 
         self._barrier()
 
-    @unittest.skipIf(BACKEND != 'nccl',
-                     "Only Nccl backend supports allreduce multigpu")
+    @unittest.skipIf(BACKEND != 'nccl' and BACKEND != 'gloo',
+                     "Only Nccl & Gloo backend support allreduce multigpu")
     @skip_if_no_gpu
     def test_all_reduce_multigpu(self):
         group, group_id, rank = self._init_global_test()
@@ -892,6 +1057,15 @@ class _DistTestBase(object):
                              local_bs,
                              rank,
                              global_bs)
+
+        # gradients are reduced in place of the persistent flat buffers
+        self._test_DDP_helper(model_DDP,
+                              input_cpu[rank * local_bs: (rank + 1) * local_bs],
+                              target[rank * local_bs: (rank + 1) * local_bs],
+                              loss)
+        for bucket, flat, views in model_DDP._grad_buffers:
+            for param, view in zip(bucket, views):
+                self.assertEqual(param.grad.data_ptr(), view.data_ptr())
         self._barrier()
 
 
@@ -233,6 +233,30 @@ class TestIndexing(TestCase):
         i, j = indices
         self.assertEqual(x[i:j], x[0:1])
 
+    def test_basic_tuple_indexing(self):
+        x = torch.arange(0, 60).view(3, 4, 5)
+        self.assertEqual(x[1, 1:3], x.select(0, 1).narrow(0, 1, 2))
+        self.assertEqual(x[:, ::2, -1], x.select(2, 4).index_select(1, torch.LongTensor([0, 2])))
+        self.assertEqual(x[None, ..., 2].size(), torch.Size([1, 3, 4]))
+        self.assertEqual(x[0, None, :, None].size(), torch.Size([1, 4, 1, 5]))
+        self.assertEqual(x[1:, ..., None].size(), torch.Size([2, 4, 5, 1]))
+        self.assertEqual(x[2, 3, 4].dim(), 0)
+        self.assertEqual(x[2, 3, 4].item(), 59)
+        self.assertEqual(x[-1, -1, -1].item(), 59)
+
+        y = x.transpose(0, 2)[1:, 2]
+        self.assertEqual(y, x.transpose(0, 2).narrow(0, 1, 4).select(1, 2))
+        self.assertEqual(y.stride(), (1, 20))
+        self.assertEqual(y.data_ptr(), x.data_ptr() + 11 * x.element_size())
+
+        x[1, :, 1:3] = -1
+        self.assertEqual(x[1, :, 1:3], torch.full((4, 2), -1))
+        self.assertEqual(x[0, :, 1:3], torch.arange(0, 20).view(4, 5)[:, 1:3])
+
+        self.assertRaisesRegex(IndexError, 'too many indices', lambda: x[0, 0, 0, 0])
+        self.assertRaisesRegex(IndexError, 'out of bounds', lambda: x[0, 4])
+        self.assertRaisesRegex(ValueError, 'step cannot be zero', lambda: x[0, ::0])
+
     def test_ellipsis_tensor(self):
         x = torch.arange(0, 9).view(3, 3)
         idx = torch.tensor([0, 2])
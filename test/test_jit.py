@@ -20,6 +20,7 @@ import tempfile
 import shutil
 
 from torch.jit.frontend import NotSupportedError
+from torch.jit import fork, wait
 
 try:
     import torchvision
@@ -99,6 +100,22 @@ class TestJit(TestCase):
 
         self.assertEqual(out1, out2)
 
+    def test_export_import_file(self):
+        def f(x, w):
+            return torch.tanh(x.mm(w))
+
+        x = torch.randn(3, 4)
+        w = torch.randn(4, 5)
+        trace, _ = torch.jit.get_trace_graph(f, (x, w), nderivs=0)
+        with tempfile.TemporaryDirectory() as tmp_dir:
+            filename = os.path.join(tmp_dir, 'graph.pt')
+            trace.graph().export_file([w], filename)
+            graph, initializers = torch._C._jit_import_graph_file(filename)
+            self.assertEqual(initializers[0], w)
+            ge = torch._C.GraphExecutor(graph, False)
+            self.assertEqual(ge(x, *initializers), f(x, w))
+            del ge, graph, initializers
+
     def test_simple(self):
         x = Variable(torch.Tensor([0.4]), requires_grad=True)
         y = Variable(torch.Tensor([0.7]), requires_grad=True)
@@ -329,6 +346,42 @@ class TestJit(TestCase):
         torch._C._jit_pass_fuse(trace.graph())
         self.assertExpectedTrace(trace)
 
+    def run_layer_norm_fusion(self, use_cuda):
+        def layer_norm_softmax(x, weight):
+            centered = x - x.mean(-1, keepdim=True)
+            var = (centered * centered).mean(-1, keepdim=True)
+            return F.softmax(centered * (var + 1e-5).rsqrt() * weight, dim=-1)
+
+        device = 'cuda' if use_cuda else 'cpu'
+        x = torch.randn(6, 50, device=device)
+        weight = torch.rand(50, device=device)
+
+        trace, _ = torch.jit.get_trace_graph(layer_norm_softmax, (x, weight))
+        torch._C._jit_pass_lint(trace.graph())
+        torch._C._jit_pass_fuse(trace.graph())
+        torch._C._jit_pass_lint(trace.graph())
+        # the reductions and the broadcast of weight all end up in one group
+        outer = str(trace.graph()).split('with prim::FusionGroup')[0]
+        self.assertEqual(outer.count('prim::FusionGroup'), 1)
+        for kind in ['aten::mean', 'aten::softmax', 'aten::mul', 'aten::sub']:
+            self.assertNotIn(kind, outer)
+
+        compiled = torch.jit.compile(nderivs=0)(layer_norm_softmax)
+        z = compiled(x, weight)
+        with self.assertCompiled(compiled):
+            z2 = compiled(x, weight)
+        self.assertEqual(z, layer_norm_softmax(x, weight))
+        self.assertEqual(z, z2)
+
+    @unittest.skipIf(IS_WINDOWS, "NYI: fuser support for Windows")
+    def test_layer_norm_fusion_cpu(self):
+        self.run_layer_norm_fusion(False)
+
+    @unittest.skipIf(IS_WINDOWS, "NYI: fuser support for Windows")
+    @unittest.skipIf(not RUN_CUDA, "fuser requires CUDA")
+    def test_layer_norm_fusion_cuda(self):
+        self.run_layer_norm_fusion(True)
+
     def test_arg_configurations(self):
         """Different arg configurations should trigger different traces"""
         x = Variable(torch.FloatTensor(4, 4).uniform_())
@@ -372,6 +425,42 @@ class TestJit(TestCase):
                 self.assertFalse(fn.has_trace_for(*unk_config))
         self.assertEqual(fn.hits, 0)
 
+    def test_specialize_sizes(self):
+        @torch.jit.compile(nderivs=0, specialize_sizes=False)
+        def fn(x, y):
+            return (x * y + x).view(x.size(0), -1).sum(1)
+
+        x, y = Variable(torch.randn(4, 3)), Variable(torch.randn(4, 3))
+        fn(x, y)
+        with self.assertCompiled(fn):
+            fn(x, y)
+
+        # the trace is specialized to the new sizes, without running fn again
+        x, y = Variable(torch.randn(6, 5)), Variable(torch.randn(6, 5))
+        self.assertFalse(fn.has_trace_for(x, y))
+        with self.assertCompiled(fn):
+            z = fn(x, y)
+        self.assertEqual(z, (x * y + x).sum(1))
+        self.assertEqual(fn.specializations, 1)
+        self.assertTrue(fn.has_trace_for(x, y))
+
+        # other number of dimensions are traced anew
+        x, y = Variable(torch.randn(2, 3, 4)), Variable(torch.randn(2, 3, 4))
+        misses = fn.misses
+        fn(x, y)
+        self.assertEqual(fn.misses, misses + 1)
+        self.assertEqual(fn.specializations, 1)
+
+        @torch.jit.compile(nderivs=0)
+        def fn_specialized(x):
+            return x * 2
+
+        fn_specialized(Variable(torch.randn(4, 3)))
+        fn_specialized(Variable(torch.randn(4, 3)))
+        fn_specialized(Variable(torch.randn(6, 5)))
+        self.assertEqual(fn_specialized.misses, 2)
+        self.assertEqual(fn_specialized.specializations, 0)
+
     def test_cse(self):
         x = Variable(torch.Tensor([0.4, 0.3]), requires_grad=True)
         y = Variable(torch.Tensor([0.7, 0.5]), requires_grad=True)
@@ -1349,6 +1438,91 @@ class TestJit(TestCase):
     def test_ge_cuda(self):
         self.run_ge_tests(True, True)
 
+    def test_ge_plan_cache_limits(self):
+        old_limits = torch._C._jit_get_plan_cache_limits()
+        try:
+            torch._C._jit_set_plan_cache_limits(2, 3)
+            ge = torch._C.GraphExecutor(lambda a, b: a * b + b, (torch.rand(1), torch.rand(1)))
+            for n in range(1, 6):
+                a, b = torch.rand(n, 3), torch.rand(n, 3)
+                self.assertEqual(ge(a, b), a * b + b)
+                self.assertLessEqual(ge.num_specialized_plans, 2)
+                # after three shape-specialized plans, new sizes share one plan
+                self.assertEqual(ge.has_dynamic_plan, n > 3)
+            # sizes that already have a plan keep using it
+            a, b = torch.rand(3, 3), torch.rand(3, 3)
+            self.assertEqual(ge(a, b), a * b + b)
+
+            # graphs that depend on sizes are always specialized
+            ge = torch._C.GraphExecutor(lambda a: a.view(-1, 2) * 2, (torch.rand(2, 2),))
+            for n in range(1, 6):
+                a = torch.rand(2, 2 * n)
+                self.assertEqual(ge(a), a.view(-1, 2) * 2)
+            self.assertFalse(ge.has_dynamic_plan)
+        finally:
+            torch._C._jit_set_plan_cache_limits(*old_limits)
+
+    def test_ge_precompile(self):
+        def f(a, b):
+            return a * b + b
+
+        ge = torch._C.GraphExecutor(f, (torch.rand(1), torch.rand(1)))
+        shapes = [(2, 3), (4, 5), (1, 7)]
+        with torch.no_grad():
+            for shape in shapes:
+                ge(torch.rand(*shape), torch.rand(*shape))
+        profile = ge.shape_profile()
+        self.assertEqual(len(profile.splitlines()), len(shapes))
+        self.assertIn('Float -1 0 2 3 / 3 1', profile)
+
+        # a fresh executor compiles the plans of the profile ahead of its runs
+        ge = torch._C.GraphExecutor(f, (torch.rand(1), torch.rand(1)))
+        future = ge.precompile(profile, num_threads=2)
+        future.wait()
+        self.assertTrue(future.done())
+        self.assertEqual(ge.num_specialized_plans, len(shapes))
+        self.assertEqual(sorted(ge.shape_profile().splitlines()), sorted(profile.splitlines()))
+        with torch.no_grad():
+            for shape in shapes:
+                a, b = torch.rand(*shape), torch.rand(*shape)
+                self.assertEqual(ge(a, b), f(a, b))
+        self.assertEqual(ge.num_specialized_plans, len(shapes))
+        # plans that are cached already are not compiled again
+        ge.precompile(profile).wait()
+        self.assertEqual(ge.num_specialized_plans, len(shapes))
+
+        with self.assertRaisesRegex(RuntimeError, 'expected a spec of 2 inputs'):
+            ge.precompile('Float -1 0 2 / 1').wait()
+        with self.assertRaisesRegex(RuntimeError, 'unknown scalar type'):
+            ge.precompile('Floaty -1 0 2 / 1;undefined').wait()
+
+    @unittest.skipIf(IS_WINDOWS, "NYI: fuser support for Windows")
+    @unittest.skipIf(not RUN_CUDA, "requires CUDA")
+    def test_ge_capture_launches(self):
+        def f(x, w, b):
+            return torch.tanh(x.mm(w) + b) * 2
+
+        old_enabled = torch._C._jit_get_capture_launches()
+        try:
+            torch._C._jit_set_capture_launches(True)
+            x, w, b = torch.rand(4, 8).cuda(), torch.rand(8, 8).cuda(), torch.rand(4, 8).cuda()
+            ge = torch._C.GraphExecutor(f, (x, w, b))
+            outputs = []
+            for i in range(4):
+                x = torch.rand(4, 8).cuda()
+                if i == 2:
+                    # an input modified in place is copied again
+                    w.add_(1)
+                out = ge(x, w, b)
+                self.assertEqual(out, f(x, w, b))
+                outputs.append((out, f(x, w, b)))
+            # the outputs of earlier runs are not overwritten by later ones
+            for out, expected in outputs:
+                self.assertEqual(out, expected)
+            self.assertEqual(ge.num_specialized_plans, 1)
+        finally:
+            torch._C._jit_set_capture_launches(old_enabled)
+
     # more manual test of graph executor that can be used as a scratchpad
     def test_ge(self):
         def foo(a, b):
@@ -1519,6 +1693,53 @@ class TestJit(TestCase):
         f = io.BytesIO()
         torch.onnx.export(MyDrop(), (eg,), f, verbose=False)
 
+    def test_freeze_parameters_conv_bn(self):
+        model = nn.Sequential(nn.Conv2d(3, 4, 3), nn.BatchNorm2d(4), nn.ReLU())
+        model[1].running_mean.uniform_(-1, 1)
+        model[1].running_var.uniform_(0.5, 2)
+        model.eval()
+        x = torch.randn(2, 3, 8, 8)
+        traced = torch.jit.trace(x)(model)
+        traced.freeze_parameters()
+
+        graph = str(traced._get_method('forward').graph)
+        self.assertNotIn('aten::batch_norm', graph)
+        self.assertIn('aten::_convolution', graph)
+        self.assertEqual(len(list(traced._get_method('forward').graph.inputs())), 1)
+        self.assertEqual(traced(x), model(x))
+
+        # the frozen method no longer sees the parameters
+        model[0].weight.data.zero_()
+        self.assertNotEqual(traced(x), model(x))
+
+        with self.assertRaisesRegex(RuntimeError, 'already been run'):
+            traced.freeze_parameters()
+
+    def test_fuse_conv_relu(self):
+        model = nn.Sequential(nn.Conv2d(3, 4, 3, padding=1), nn.ReLU(), nn.Conv2d(4, 2, 1), nn.ReLU())
+        x = torch.randn(2, 3, 8, 8)
+        traced = torch.jit.trace(x)(model)
+        graph = traced._get_method('forward').graph
+        torch._C._jit_pass_fuse_conv_relu(graph)
+        self.assertEqual(str(graph).count('aten::_convolution_relu'), 2)
+        self.assertNotIn('aten::relu', str(graph))
+        with torch.no_grad():
+            self.assertEqual(traced(x), model(x))
+
+    def test_constant_propagation(self):
+        w = torch.randn(5, 3)
+
+        @torch.jit.trace(torch.randn(2, 3))
+        def fn(x):
+            return x.mm((w * 2).t()) + w.sum(1)
+
+        torch._C._jit_pass_constant_propagation(fn.graph)
+        graph = str(fn.graph)
+        self.assertNotIn('aten::t', graph)
+        self.assertNotIn('aten::sum', graph)
+        x = torch.randn(2, 3)
+        self.assertEqual(fn(x), x.mm((w * 2).t()) + w.sum(1))
+
     def test_python_function(self):
         class MyFn(Function):
             @staticmethod
@@ -1935,6 +2156,46 @@ class TestScript(TestCase):
 
         self.assertEqual(test_script_for_in_range_ast(*inputs), 161700)
 
+    def test_hoist_loop_invariants(self):
+        @torch.jit.script
+        def fn(x, w, n):
+            y = x
+            for i in range(n):
+                y = y + torch.mm(x, w).tanh()
+            return y
+
+        x, w = torch.randn(3, 3), torch.randn(3, 3)
+        n = torch.tensor(4)
+        graph = fn.graph
+        torch._C._jit_pass_hoist_loop_invariants(graph)
+        torch._C._jit_pass_lint(graph)
+        # the body only keeps the addition
+        graph_str = str(graph)
+        loop_start = graph_str.index('prim::Loop')
+        self.assertLess(graph_str.index('aten::mm'), loop_start)
+        self.assertLess(graph_str.index('aten::tanh'), loop_start)
+        self.assertGreater(graph_str.index('aten::add'), loop_start)
+        self.assertEqual(fn(x, w, n), x + 4 * torch.mm(x, w).tanh())
+
+    def test_unroll_loops(self):
+        @torch.jit.script
+        def fn(x):
+            y = x
+            for i in range(4):
+                y = y * 2 + x
+            return y
+
+        x = torch.randn(3)
+        expected = x
+        for i in range(4):
+            expected = expected * 2 + x
+        graph = fn.graph
+        torch._C._jit_pass_unroll_loops(graph)
+        torch._C._jit_pass_lint(graph)
+        self.assertNotIn('prim::Loop', str(graph))
+        self.assertEqual(str(graph).count('aten::mul'), 4)
+        self.assertEqual(fn(x), expected)
+
     def test_script_bool_constant(self):
         script = '''
         def test_script_bool_constant():
@@ -2181,6 +2442,49 @@ class TestScript(TestCase):
         m2.sub2.a.data.zero_()
         self.assertEqual(torch.zeros(2, 2), m2.forward(torch.randn(3, 2)))
 
+    def test_script_fork_wait(self):
+        @torch.jit.script
+        def tower(x, y):
+            return torch.mm(x, y).tanh(), x + y
+
+        @torch.jit.script
+        def towers(x, y):
+            fut_a = fork(tower, x, y)
+            fut_b = fork(tower, y, x)
+            a, s = wait(fut_a)
+            b, _ = wait(fut_b)
+            return a + b + s
+
+        def reference(x, y):
+            a, s = tower(x, y)
+            b, _ = tower(y, x)
+            return a + b + s
+
+        x = torch.randn(16, 16, requires_grad=True)
+        y = torch.randn(16, 16, requires_grad=True)
+        self.assertIn("prim::Fork", str(towers.graph))
+        num_threads = torch._C._jit_get_inter_op_threads()
+        try:
+            for threads in [0, 2]:
+                torch._C._jit_set_inter_op_threads(threads)
+                out = towers(x, y)
+                expected = reference(x, y)
+                self.assertEqual(out, expected)
+                grads = torch.autograd.grad(out.sum(), (x, y))
+                self.assertEqual(grads, torch.autograd.grad(expected.sum(), (x, y)))
+                with torch.no_grad():
+                    self.assertEqual(towers(x, y), expected)
+        finally:
+            torch._C._jit_set_inter_op_threads(num_threads)
+
+        # the eager versions call the function right away
+        self.assertEqual(wait(fork(reference, x, y)), reference(x, y))
+
+        with self.assertRaisesRegex(RuntimeError, "expects the result of a fork"):
+            @torch.jit.script
+            def bad_wait(x):
+                return wait(x)
+
     def test_script_module_call_noscript(self):
         class M(torch.jit.ScriptModule):
             def __init__(self):
@@ -3210,6 +3514,18 @@ class TestPytorchExportModes(unittest.TestCase):
                            export_type=torch.onnx.ExportTypes.DIRECTORY)
         shutil.rmtree(d)
 
+    def test_external_data(self):
+        torch_model = nn.Linear(4, 3)
+        fake_input = Variable(torch.randn(2, 4), requires_grad=True)
+        d = tempfile.mkdtemp()
+        f = os.path.join(d, 'model.onnx')
+        torch.onnx._export(torch_model, (fake_input), f, verbose=False,
+                           export_type=torch.onnx.ExportTypes.EXTERNAL_DATA)
+        self.assertTrue(os.path.exists(f))
+        # the weight and the bias, as float, back to back
+        self.assertEqual(os.path.getsize(f + '.data'), (4 * 3 + 3) * 4)
+        shutil.rmtree(d)
+
 
 if __name__ == '__main__':
     run_tests()
@@ -52,6 +52,15 @@ def send_tensor(queue, event, tp):
     event.wait()
 
 
+def send_from_arena(queue, done, arena_size, repeat):
+    torch._C._init_shm_arena(arena_size)
+    for i in range(repeat):
+        t = torch.FloatTensor(torch.FloatStorage._new_shared(25)).view(5, 5).fill_(i)
+        queue.put(t)
+        del t
+        done.get()  # the receiver has freed the tensor
+
+
 def call_backward():
     x = torch.autograd.Variable(torch.randn(3, 3), requires_grad=True)
     x.sum().backward()
@@ -293,6 +302,29 @@ class TestMultiprocessing(TestCase):
             for _ in range(TEST_REPEATS):
                 queue_put()
 
+    @unittest.skipIf(IS_WINDOWS, "shared memory arenas are not supported on Windows")
+    def test_shm_arena(self):
+        # 5 blocks of 25 floats (with their headers) fit in the arena
+        arena_size = 1024
+        q = mp.Queue()
+        done = mp.Queue()
+        p = mp.Process(target=send_from_arena, args=(q, done, arena_size, TEST_REPEATS))
+        p.daemon = True
+        p.start()
+        offsets = set()
+        for i in range(TEST_REPEATS):
+            t = q.get(timeout=5)
+            self.assertTrue(t.eq(i).all())
+            metadata = t.storage()._share_arena_()
+            self.assertIsNotNone(metadata)
+            offsets.add(metadata[3])
+            del t, metadata
+            done.put(None)
+        p.join(5)
+        self.assertFalse(p.is_alive())
+        # freed blocks are reused instead of growing the arena
+        self.assertLessEqual(len(offsets), 5)
+
     def test_inherit_tensor(self):
         t = torch.zeros(5, 5)
         p = SubProcess(t.share_memory_())
@@ -6,6 +6,7 @@ import itertools
 import contextlib
 import warnings
 import pickle
+import tempfile
 from copy import deepcopy
 from itertools import repeat, product
 from functools import wraps, reduce
@@ -31,7 +32,7 @@ from common_nn import NNTestCase, ModuleTest, CriterionTest, TestBase, \
     TEST_CUDNN_VERSION, loss_reference_fns, get_size_average, get_weight, \
     smoothl1loss_reference, kldivloss_reference
 from common import freeze_rng_state, run_tests, TestCase, skipIfNoLapack, \
-    TEST_SCIPY, download_file, PY3, PY34, to_gpu, get_function_arglist
+    TEST_SCIPY, TEST_MKLDNN, TEST_NNPACK, download_file, PY3, PY34, to_gpu, get_function_arglist
 
 if TEST_SCIPY:
     from scipy import stats
@@ -1442,6 +1443,46 @@ class TestNN(NNTestCase):
         self.assertEqual(output[1], output[2])
         self.assertTrue(output.data.norm(p=2, dim=1).le(1).all())
 
+    @unittest.skipIf(not TEST_CUDA, "CUDA unavailable")
+    def test_embedding_backward_cuda_skewed(self):
+        # most lookups hit the same row; the gradient must match the CPU and
+        # be the same from run to run
+        indices = torch.randint(0, 50, (4000,), dtype=torch.long)
+        indices[torch.rand(4000) < 0.8] = 3
+        grad = torch.randn(4000, 17)
+        for padding_idx, scale_grad_by_freq in ((-1, False), (3, False), (7, True)):
+            expected = torch.embedding_dense_backward(grad, indices, 50, padding_idx, scale_grad_by_freq)
+            result = torch.embedding_dense_backward(grad.cuda(), indices.cuda(), 50, padding_idx,
+                                                    scale_grad_by_freq)
+            self.assertEqual(result.cpu(), expected, prec=1e-4)
+            other = torch.embedding_dense_backward(grad.cuda(), indices.cuda(), 50, padding_idx,
+                                                   scale_grad_by_freq)
+            self.assertTrue(torch.equal(result, other))
+
+            if not scale_grad_by_freq:
+                sparse = torch.embedding_sparse_backward(grad.cuda(), indices.cuda(), 50, padding_idx, False)
+                # one row per distinct index, which isn't padding_idx
+                self.assertEqual(sparse._indices().size(1), len(set(indices.tolist()) - {padding_idx}))
+                self.assertEqual(sparse.to_dense().cpu(), expected, prec=1e-4)
+
+        # embedding_bag: the max mode gradient goes to a different row for every feature
+        weight = torch.randn(10, 6)
+        input = torch.randint(0, 10, (200,), dtype=torch.long)
+        input[:150] = 4
+        offsets = torch.arange(0, 200, 5, dtype=torch.long)
+        for mode in ('sum', 'mean', 'max'):
+            for sparse in ((False, True) if mode != 'max' else (False,)):
+                bag_cpu = nn.EmbeddingBag(10, 6, mode=mode, sparse=sparse)
+                bag_cpu.weight.data.copy_(weight)
+                bag_cuda = nn.EmbeddingBag(10, 6, mode=mode, sparse=sparse).cuda()
+                bag_cuda.weight.data.copy_(weight)
+                bag_cpu(input, offsets).sum().backward()
+                bag_cuda(input.cuda(), offsets.cuda()).sum().backward()
+                grad_cpu, grad_cuda = bag_cpu.weight.grad.data, bag_cuda.weight.grad.data
+                if sparse:
+                    grad_cpu, grad_cuda = grad_cpu.to_dense(), grad_cuda.to_dense()
+                self.assertEqual(grad_cuda.cpu(), grad_cpu, prec=1e-4)
+
     def test_embedding_from_pretrained(self):
         a = torch.Tensor([[1, 2, 3], [4, 5, 6]])
         embedding = nn.Embedding.from_pretrained(a)
@@ -1639,6 +1680,8 @@ class TestNN(NNTestCase):
         _test_vs_Embedding(N, D, B, L)
         for p in itertools.product([1, 2], repeat=4):
             _test_vs_Embedding(*p)
+        # enough bags to be split across threads, with a vector tail
+        _test_vs_Embedding(1000, 67, 300, 40)
 
         # check that giving illegal input combos raises error
         es = nn.EmbeddingBag(10, 20, mode=mode, sparse=sparse)
@@ -1698,6 +1741,38 @@ class TestNN(NNTestCase):
         F.conv_transpose2d(x, torch.randn(16, 1, 1, 1, device="cuda"))
         F.conv2d(x, torch.randn(1, 16, 1, 1, device="cuda"))
 
+    def test_roi_pooling_2d(self):
+        # positive features, so that every non-empty tile has an argmax
+        input = torch.rand(2, 3, 8, 10, requires_grad=True)
+        rois = torch.tensor([[0, 0, 0, 9, 7], [1, 2, 1, 5, 6],
+                             [0, 1, 1, 4, 4], [1, 3, 2, 3, 2]], dtype=torch.float)
+        output, argmaxes = torch.RoiPooling2d_forward(input, rois, 3, 2, 1.0)
+        self.assertEqual(output.size(), (4, 3, 3, 2))
+
+        expected = torch.zeros(4, 3, 3, 2)
+        for i, (n, x1, y1, x2, y2) in enumerate(rois.long().tolist()):
+            for ph in range(3):
+                h0 = y1 + math.floor(ph * (y2 - y1) / 3.)
+                h1 = y1 + math.ceil((ph + 1) * (y2 - y1) / 3.)
+                for pw in range(2):
+                    w0 = x1 + math.floor(pw * (x2 - x1) / 2.)
+                    w1 = x1 + math.ceil((pw + 1) * (x2 - x1) / 2.)
+                    if h0 < h1 and w0 < w1:
+                        tile = input.data[n, :, h0:h1, w0:w1]
+                        expected[i, :, ph, pw] = tile.contiguous().view(3, -1).max(1)[0]
+        self.assertEqual(output.data, expected)
+
+        # the gradient of every output goes to its argmax, summed over the RoIs
+        grad = torch.randn(4, 3, 3, 2)
+        output.backward(grad)
+        expected_grad = torch.zeros(2, 3, 8 * 10)
+        for i, n in enumerate(rois[:, 0].long().tolist()):
+            for c in range(3):
+                for index, g in zip(argmaxes[i, c].view(-1).tolist(), grad[i, c].view(-1).tolist()):
+                    if index != -1:
+                        expected_grad[n, c, index] += g
+        self.assertEqual(input.grad.data, expected_grad.view(2, 3, 8, 10))
+
     def test_embedding_bag(self):
         self._test_EmbeddingBag(False, 'sum', False)
         self._test_EmbeddingBag(False, 'mean', False)
@@ -1706,6 +1781,90 @@ class TestNN(NNTestCase):
         self._test_EmbeddingBag(False, 'sum', True)
         self._test_EmbeddingBag(False, 'mean', True)
 
+    def test_embedding_bag_rowwise_quantized(self):
+        for bits in [8, 4]:
+            weight = torch.randn(50, 14, dtype=torch.float)
+            weight[3].fill_(2)  # constant rows get a scale of 0
+            q = torch.embedding_rowwise_quantize(weight, bits)
+            self.assertEqual(q.dtype, torch.uint8)
+            self.assertEqual(q.size(), (50, (14 if bits == 8 else 7) + 8))
+
+            dq = torch.embedding_rowwise_dequantize(q, bits)
+            row_range = weight.max(1)[0] - weight.min(1)[0]
+            error = (dq - weight).abs().max(1)[0]
+            self.assertTrue((error <= row_range / (2 ** bits - 1) / 2 + 1e-5).all())
+            self.assertEqual(dq[3], weight[3])
+
+            input = torch.randint(50, (40,), dtype=torch.long)
+            offsets = torch.tensor([0, 0, 3, 20, 39], dtype=torch.long)
+            for mode, mode_id in [('sum', 0), ('mean', 1)]:
+                output = torch.embedding_bag_rowwise_quantized(q, input, offsets, bits, mode_id)
+                expected = F.embedding_bag(dq, input, offsets, mode=mode)
+                self.assertEqual(output, expected, 1e-4)
+
+        self.assertRaises(RuntimeError, lambda: torch.embedding_rowwise_quantize(torch.randn(2, 3).float(), 4))
+        self.assertRaises(RuntimeError, lambda: torch.embedding_bag_rowwise_quantized(
+            q, torch.tensor([50]), torch.tensor([0]), 4, 0))
+
+    def test_embedding_bag_half(self):
+        # 300 columns go through more than one float chunk per row
+        weight = torch.randn(50, 300).half()
+        input = torch.randint(50, (40,), dtype=torch.long)
+        offsets = torch.tensor([0, 0, 3, 20, 39], dtype=torch.long)
+        for mode in ['sum', 'mean']:
+            output = F.embedding_bag(weight, input, offsets, mode=mode)
+            self.assertEqual(output.dtype, torch.float16)
+            expected = F.embedding_bag(weight.float(), input, offsets, mode=mode)
+            self.assertEqual(output.float(), expected, 1e-2)
+        self.assertRaises(RuntimeError, lambda: F.embedding_bag(weight, input, offsets, mode='max'))
+
+    def test_linear_packed_half(self):
+        input = torch.randn(7, 300)
+        weight = torch.randn(20, 300).half()
+        bias = torch.randn(20)
+        packed = torch._linear_prepack(weight, 7)
+        self.assertEqual(packed.dtype, torch.float16)
+        expected = F.linear(input, weight.float(), bias)
+        self.assertEqual(torch._linear_packed(input, packed, bias), expected, 1e-4)
+        self.assertEqual(torch._linear_packed(input, packed), expected - bias, 1e-4)
+
+    def test_quantized_linear_conv2d(self):
+        x = torch.randn(20, 30)
+        q = torch.quantize_linear(x, 0.02, 128)
+        self.assertEqual(q.dtype, torch.uint8)
+        expected = (x / 0.02).round().add(128).clamp(0, 255)
+        self.assertEqual(q.float(), expected)
+        self.assertEqual(torch.dequantize_linear(q, 0.02, 128), (expected - 128) * 0.02, 1e-6)
+
+        weight = torch.randn(6, 3, 3, 3)
+        weight[2].zero_()
+        qweight, scales = torch.quantize_per_channel(weight)
+        self.assertEqual(qweight.dtype, torch.int8)
+        expected_scales = weight.view(6, -1).abs().max(1)[0] / 127
+        expected_scales[2] = 1  # all-zero channels get a scale of 1
+        self.assertEqual(scales, expected_scales)
+        self.assertEqual(qweight.float() * scales.view(6, 1, 1, 1), weight, scales.max() / 2)
+
+        def check(output, expected):
+            self.assertEqual(output.size(), expected.size())
+            self.assertLessEqual((output - expected).abs().max(), 0.05 * expected.abs().max())
+
+        # 37 input features exercise the tails of the vectorized dot products
+        for bias in [torch.randn(11), None]:
+            x = torch.randn(4, 5, 37)
+            weight = torch.randn(11, 37)
+            qweight, scales = torch.quantize_per_channel(weight)
+            check(torch.quantized_linear(x, qweight, scales, bias), F.linear(x, weight, bias))
+
+        for bias, stride, padding, groups in product([torch.randn(6), None], [1, 2], [0, 1], [1, 3]):
+            x = torch.randn(2, 6, 9, 8)
+            weight = torch.randn(6, 6 // groups, 3, 3)
+            qweight, scales = torch.quantize_per_channel(weight)
+            check(torch.quantized_conv2d(x, qweight, scales, bias, stride, padding, 1, groups),
+                  F.conv2d(x, weight, bias, stride, padding, 1, groups))
+
+        self.assertRaises(RuntimeError, lambda: torch.quantized_linear(x, weight, scales))
+
     @unittest.skipIf(not TEST_CUDA, "CUDA unavailable")
     @repeat_test_for_types(ALL_TENSORTYPES)
     def test_embedding_bag_cuda(self, dtype=torch.float):
@@ -1739,6 +1898,35 @@ class TestNN(NNTestCase):
         input = torch.Tensor(1000)
         self._test_dropout(nn.Dropout, input)
 
+    def _test_fused_dropout(self, device, dtype=torch.double):
+        p = 0.3
+        prec = 1e-2 if dtype == torch.half else 1e-3
+        x = torch.randn(3, 1001, dtype=dtype, device=device).add_(5).requires_grad_()
+        output, mask = torch._fused_dropout(x, p)
+        self.assertEqual(mask.dtype, torch.uint8)
+        self.assertEqual(mask.numel(), (x.numel() + 7) // 8)
+        kept = output.data != 0
+        self.assertEqual(output.data[kept], x.data[kept] / (1 - p), prec=prec)
+        self.assertLess(abs(kept.float().mean().item() - (1 - p)), 0.05)
+
+        grad = torch.randn_like(x)
+        output.backward(grad)
+        self.assertEqual(x.grad.data, torch.where(kept, grad * (1 / (1 - p)), torch.zeros_like(grad)), prec=prec)
+
+        self.assertEqual(torch._fused_dropout(x, 0)[0], x)
+        self.assertEqual(torch._fused_dropout(x, 1)[0].abs().sum().item(), 0)
+        if dtype == torch.double:
+            gradgradcheck(lambda y: torch._fused_dropout_backward(y, mask, p), [grad.requires_grad_()])
+
+    def test_fused_dropout(self):
+        self._test_fused_dropout('cpu')
+        self._test_fused_dropout('cpu', torch.float)
+
+    @unittest.skipIf(not TEST_CUDA, "CUDA unavailable")
+    def test_fused_dropout_cuda(self):
+        self._test_fused_dropout('cuda')
+        self._test_fused_dropout('cuda', torch.half)
+
     def test_Dropout2d(self):
         b = random.randint(1, 5)
         w = random.randint(1, 5)
@@ -2027,6 +2215,49 @@ class TestNN(NNTestCase):
         self._test_GroupNorm_general("cuda", torch.float)
         self._test_GroupNorm_cuda_half()
 
+    def _test_LayerNorm_GroupNorm_reference(self, device="cpu"):
+        def reference(x, rows, weight, bias, weight_shape, eps):
+            x_rows = x.contiguous().view(rows, -1)
+            mean = x_rows.mean(1, keepdim=True)
+            var = x_rows.var(1, unbiased=False, keepdim=True)
+            out = ((x_rows - mean) / (var + eps).sqrt()).view_as(x)
+            return out * weight.view(weight_shape) + bias.view(weight_shape)
+
+        eps = 1e-5
+        for input_size, normalized_shape in [((4, 7), [7]), ((3, 2, 37), [2, 37]), ((6, 1), [1])]:
+            x = torch.randn(*input_size, device=device, dtype=torch.double)
+            weight = torch.randn(*normalized_shape, device=device, dtype=torch.double)
+            bias = torch.randn(*normalized_shape, device=device, dtype=torch.double)
+            inputs = [t.requires_grad_() for t in (x, weight, bias)]
+            rows = x.numel() // weight.numel()
+            grad = torch.randn(*input_size, device=device, dtype=torch.double)
+            out = F.layer_norm(x, normalized_shape, weight, bias, eps)
+            expected = reference(x, rows, weight, bias, normalized_shape, eps)
+            self.assertEqual(out, expected)
+            self.assertEqual(torch.autograd.grad(out, inputs, grad),
+                             torch.autograd.grad(expected, inputs, grad))
+
+        for input_size, g in [((2, 6, 5), 3), ((3, 4, 2, 3), 2), ((2, 8, 1), 8)]:
+            c = input_size[1]
+            x = torch.randn(*input_size, device=device, dtype=torch.double)
+            weight = torch.randn(c, device=device, dtype=torch.double)
+            bias = torch.randn(c, device=device, dtype=torch.double)
+            inputs = [t.requires_grad_() for t in (x, weight, bias)]
+            grad = torch.randn(*input_size, device=device, dtype=torch.double)
+            weight_shape = [c] + [1] * (x.dim() - 2)
+            out = F.group_norm(x, g, weight, bias, eps)
+            expected = reference(x, input_size[0] * g, weight, bias, weight_shape, eps)
+            self.assertEqual(out, expected)
+            self.assertEqual(torch.autograd.grad(out, inputs, grad),
+                             torch.autograd.grad(expected, inputs, grad))
+
+    def test_LayerNorm_GroupNorm_reference(self):
+        self._test_LayerNorm_GroupNorm_reference()
+
+    @unittest.skipIf(not TEST_CUDA, "CUDA unavailable")
+    def test_LayerNorm_GroupNorm_reference_cuda(self):
+        self._test_LayerNorm_GroupNorm_reference("cuda")
+
     def test_pad(self):
         inputs = torch.randn(1, 3, 4, 4, requires_grad=True)
         _assertGradAndGradgradChecks(self, lambda x: F.pad(x, (1, 1, 1, 1)), (inputs,))
@@ -2125,6 +2356,25 @@ class TestNN(NNTestCase):
     def test_batchnorm_eval_cuda(self, dtype=torch.float):
         self._test_batchnorm_eval("cuda", dtype)
 
+    @unittest.skipIf(not TEST_MKLDNN, "MKL-DNN unavailable")
+    def test_batchnorm_eval_mkldnn(self):
+        # evaluation mode 4-d float batch norm runs mkldnn_batch_norm
+        bn = nn.BatchNorm2d(3).eval()
+        bn.running_mean.normal_()
+        bn.running_var.uniform_(0.5, 2)
+        bn.weight.data.normal_()
+        bn.bias.data.normal_()
+        x = torch.randn(2, 3, 5, 7, requires_grad=True)
+        out = bn(x)
+        bn_double = deepcopy(bn).double()
+        x_double = x.detach().double().requires_grad_()
+        expected = bn_double(x_double)
+        self.assertEqual(out, expected)
+        grad = torch.randn_like(out)
+        self.assertEqual(torch.autograd.grad(out, (x, bn.weight, bn.bias), grad),
+                         torch.autograd.grad(expected, (x_double, bn_double.weight, bn_double.bias),
+                                             grad.double()))
+
     def test_batchnorm_simple_average(self):
         self._test_batchnorm_simple_average()
 
@@ -2148,6 +2398,219 @@ class TestNN(NNTestCase):
     def test_MaxPool2d_indices_cuda(self, dtype=torch.float):
         self._test_maxpool_indices(2, device="cuda", dtype=dtype)
 
+    @unittest.skipIf(not TEST_MKLDNN, "MKL-DNN unavailable")
+    def test_pool2d_mkldnn(self):
+        # without requires_grad, F.max_pool2d and F.avg_pool2d run the MKL-DNN primitives
+        x = torch.randn(2, 3, 10, 11)
+        x_double = x.double()
+        for kernel, stride, padding, ceil_mode in product([2, 3], [1, 2], [0, 1], [False, True]):
+            self.assertEqual(F.max_pool2d(x, kernel, stride, padding, ceil_mode=ceil_mode),
+                             F.max_pool2d(x_double, kernel, stride, padding, ceil_mode=ceil_mode))
+            for count_include_pad in [False, True]:
+                self.assertEqual(F.avg_pool2d(x, kernel, stride, padding, ceil_mode, count_include_pad),
+                                 F.avg_pool2d(x_double, kernel, stride, padding, ceil_mode, count_include_pad))
+
+    @unittest.skipIf(not TEST_MKLDNN, "MKL-DNN unavailable")
+    def test_conv_relu_mkldnn(self):
+        x = torch.randn(2, 3, 9, 11, requires_grad=True)
+        w = torch.randn(5, 3, 3, 2, requires_grad=True)
+        b = torch.randn(5, requires_grad=True)
+        padding, stride, dilation = (1, 0), (2, 1), (1, 1)
+        out = torch.mkldnn_convolution_relu(x, w, b, padding, stride, dilation)
+        inputs_double = [t.detach().double().requires_grad_() for t in (x, w, b)]
+        expected = F.relu(F.conv2d(*inputs_double, stride=stride, padding=padding))
+        self.assertEqual(out, expected, 1e-4)
+        grad = torch.randn_like(out)
+        self.assertEqual(torch.autograd.grad(out, (x, w, b), grad),
+                         torch.autograd.grad(expected, inputs_double, grad.double()), 1e-4)
+
+        # inference with the weight reordered beforehand
+        for relu in [False, True]:
+            reordered = torch.mkldnn_reorder_conv_weight(w.detach(), x.size(), padding, stride, dilation, True, relu)
+            out = torch.mkldnn_convolution_inference(x.detach(), reordered, w.size(), b.detach(),
+                                                     padding, stride, dilation, relu)
+            expected = F.conv2d(*inputs_double, stride=stride, padding=padding)
+            self.assertEqual(out, F.relu(expected) if relu else expected, 1e-4)
+
+    def _test_convolution_relu(self, device):
+        x = torch.randn(2, 4, 7, 6, device=device)
+        b = torch.randn(6, device=device)
+        for groups in [1, 2]:
+            w = torch.randn(6, 4 // groups, 3, 3, device=device)
+            for bias in [None, b]:
+                out = torch._convolution_relu(x, w, bias, (2, 1), (1, 0), (1, 1), False, (0, 0), groups,
+                                              False, False, True)
+                expected = F.relu(F.conv2d(x, w, bias, stride=(2, 1), padding=(1, 0), groups=groups))
+                self.assertEqual(out, expected, 1e-4)
+
+    def test_convolution_relu(self):
+        self._test_convolution_relu('cpu')
+
+    @unittest.skipIf(not TEST_CUDA, "CUDA unavailable")
+    def test_convolution_relu_cuda(self):
+        self._test_convolution_relu('cuda')
+
+    @unittest.skipIf(not TEST_NNPACK, "NNPACK unavailable")
+    def test_conv_nnpack(self):
+        for batch_size, kernel_size, padding in [(1, 3, 1), (4, 3, 0), (4, 5, 2)]:
+            x = torch.randn(batch_size, 3, 10, 9, requires_grad=True)
+            w = torch.randn(6, 3, kernel_size, kernel_size, requires_grad=True)
+            b = torch.randn(6, requires_grad=True)
+            out = torch._nnpack_spatial_convolution(x, w, b, padding)
+            inputs_double = [t.detach().double().requires_grad_() for t in (x, w, b)]
+            expected = F.conv2d(*inputs_double, padding=padding)
+            self.assertEqual(out, expected, 1e-3)
+            grad = torch.randn_like(out)
+            self.assertEqual(torch.autograd.grad(out, (x, w, b), grad),
+                             torch.autograd.grad(expected, inputs_double, grad.double()), 1e-3)
+
+    def test_mkldnn_blocked_layout(self):
+        x = torch.randn(2, 16, 3, 5)
+        for block in [8, 16]:
+            blocked = torch.mkldnn_to_blocked(x, block)
+            self.assertEqual(blocked.size(), (2, 16 // block, 3, 5, block))
+            self.assertEqual(blocked[1, 1 // block, 2, 4, 1 % block], x[1, 1, 2, 4])
+            self.assertEqual(torch.mkldnn_from_blocked(blocked), x)
+        self.assertRaises(RuntimeError, lambda: torch.mkldnn_to_blocked(x[:, :12], 8))
+
+    @unittest.skipIf(not TEST_MKLDNN, "MKL-DNN unavailable")
+    def test_mkldnn_blocked_chain(self):
+        # conv, relu and pooling stay in the blocked layout
+        x = torch.randn(2, 16, 9, 9)
+        w = torch.randn(32, 16, 3, 3)
+        reordered = torch.mkldnn_reorder_conv_weight(w, x.size(), (1, 1), (1, 1), (1, 1), False, False)
+        expected = F.max_pool2d(F.relu(F.conv2d(x, w, padding=1)), 2)
+        for block in [8, 16]:
+            out = torch.mkldnn_convolution_inference(torch.mkldnn_to_blocked(x, block), reordered, w.size(), None,
+                                                     (1, 1), (1, 1), (1, 1), False)
+            out = torch.mkldnn_max_pool2d(torch.relu(out), 2)
+            self.assertEqual(out.size(), (2, 32 // block, 4, 4, block))
+            self.assertEqual(torch.mkldnn_from_blocked(out), expected, 1e-4)
+
+    def test_channels_last_layout(self):
+        x = torch.randn(2, 3, 4, 5)
+        self.assertFalse(x.is_channels_last())
+        y = x.channels_last_contiguous()
+        self.assertTrue(y.is_channels_last())
+        self.assertEqual(y.stride(), (60, 1, 15, 3))
+        self.assertEqual(y, x)
+        self.assertIs(y.channels_last_contiguous(), y)
+        self.assertFalse(torch.randn(2, 1, 4, 5).channels_last_contiguous().is_channels_last())
+
+    def test_pool2d_channels_last(self):
+        x = torch.randn(2, 5, 9, 7, dtype=torch.double)
+        y = x.channels_last_contiguous().requires_grad_()
+        for kwargs in [dict(kernel_size=3), dict(kernel_size=(3, 2), stride=(2, 1), padding=1),
+                       dict(kernel_size=3, stride=2, ceil_mode=True)]:
+            out, indices = F.max_pool2d(y, return_indices=True, **kwargs)
+            expected, expected_indices = F.max_pool2d(x, return_indices=True, **kwargs)
+            self.assertTrue(out.is_channels_last())
+            self.assertEqual(out, expected)
+            self.assertEqual(indices, expected_indices)
+            for count_include_pad in [True, False]:
+                out = F.avg_pool2d(y, count_include_pad=count_include_pad, **kwargs)
+                self.assertTrue(out.is_channels_last())
+                self.assertEqual(out, F.avg_pool2d(x, count_include_pad=count_include_pad, **kwargs))
+        self.assertEqual(F.max_pool2d(y, 3, dilation=2), F.max_pool2d(x, 3, dilation=2))
+        gradcheck(lambda t: F.max_pool2d(t.channels_last_contiguous(), 3, 2, 1), (y,))
+        gradcheck(lambda t: F.avg_pool2d(t.channels_last_contiguous(), 3, 2, 1, False, False), (y,))
+
+    def test_pool2d_contiguous(self):
+        # the native kernels of contiguous CPU tensors against THNN
+        for x in [torch.randn(2, 5, 11, 9, dtype=torch.double), torch.randn(3, 8, 13)]:
+            for kwargs in [dict(kernel_size=3), dict(kernel_size=(3, 2), stride=(2, 1), padding=1),
+                           dict(kernel_size=3, stride=2, ceil_mode=True),
+                           dict(kernel_size=(2, 4), stride=(1, 3), padding=(1, 2), ceil_mode=True)]:
+                stride = kwargs.get('stride', kwargs['kernel_size'])
+                args = (kwargs['kernel_size'], stride, kwargs.get('padding', 0))
+                ceil_mode = kwargs.get('ceil_mode', False)
+                for dilation in [1, 2]:
+                    if dilation == 2 and ceil_mode:
+                        continue
+                    out, indices = torch._max_pool2d_contiguous(x, *(args + (dilation, ceil_mode)))
+                    expected, expected_indices = torch._C._nn.max_pool2d(x, *(args + (dilation, ceil_mode)))
+                    self.assertEqual(out, expected)
+                    self.assertEqual(indices, expected_indices)
+                for count_include_pad in [True, False]:
+                    self.assertEqual(torch._avg_pool2d_contiguous(x, *(args + (ceil_mode, count_include_pad))),
+                                     torch._C._nn.avg_pool2d(x, *(args + (ceil_mode, count_include_pad))))
+            for output_size in [(1, 1), (4, 3), (5, 7), (11, 2)]:
+                self.assertEqual(torch._adaptive_avg_pool2d_contiguous(x, output_size),
+                                 torch._C._nn.adaptive_avg_pool2d(x, output_size))
+                out, indices = torch._adaptive_max_pool2d_contiguous(x, output_size)
+                expected, expected_indices = torch._C._nn.adaptive_max_pool2d(x, output_size)
+                self.assertEqual(out, expected)
+                self.assertEqual(indices, expected_indices)
+
+        # ties pick the first element of the window, like THNN
+        x = torch.zeros(1, 2, 6, 6)
+        self.assertEqual(torch._max_pool2d_contiguous(x, 3, 1, 1, 1, False)[1],
+                         torch._C._nn.max_pool2d(x, 3, 1, 1, 1, False)[1])
+        self.assertEqual(torch._adaptive_max_pool2d_contiguous(x, (4, 4))[1],
+                         torch._C._nn.adaptive_max_pool2d(x, (4, 4))[1])
+
+        y = torch.randn(2, 3, 7, 6, dtype=torch.double, requires_grad=True)
+        gradcheck(lambda t: F.max_pool2d(t, 3, 2, 1), (y,))
+        gradcheck(lambda t: F.avg_pool2d(t, 3, 2, 1, True, False), (y,))
+        gradcheck(lambda t: F.adaptive_avg_pool2d(t, (3, 4)), (y,))
+        gradcheck(lambda t: F.adaptive_max_pool2d(t, (3, 4)), (y,))
+
+    def test_batchnorm_channels_last(self):
+        x = torch.randn(4, 5, 3, 6, dtype=torch.double)
+        y = x.channels_last_contiguous()
+        for affine in [True, False]:
+            bn = nn.BatchNorm2d(5, affine=affine).double()
+            bn_channels_last = deepcopy(bn)
+            out = bn_channels_last(y)
+            self.assertTrue(out.is_channels_last())
+            self.assertEqual(out, bn(x))
+            self.assertEqual(bn_channels_last.running_mean, bn.running_mean)
+            self.assertEqual(bn_channels_last.running_var, bn.running_var)
+            bn.eval()
+            bn_channels_last.eval()
+            self.assertEqual(bn_channels_last(y), bn(x))
+        weight = torch.rand(5, dtype=torch.double, requires_grad=True)
+        bias = torch.randn(5, dtype=torch.double, requires_grad=True)
+        running_mean = torch.randn(5, dtype=torch.double)
+        running_var = torch.rand(5, dtype=torch.double) + 0.5
+        for training in [True, False]:
+            gradcheck(lambda t, w, b: F.batch_norm(t.channels_last_contiguous(), running_mean.clone(),
+                                                   running_var.clone(), w, b, training),
+                      (y.requires_grad_(), weight, bias))
+
+    def _test_inplace_abn(self, device="cpu"):
+        x = torch.randn(4, 5, 3, 6, dtype=torch.double, device=device)
+        weight = (torch.rand(5, dtype=torch.double, device=device) + 0.5).requires_grad_()
+        bias = torch.randn(5, dtype=torch.double, device=device, requires_grad=True)
+        running_mean = torch.randn(5, dtype=torch.double, device=device)
+        running_var = torch.rand(5, dtype=torch.double, device=device) + 0.5
+        for training in [True, False]:
+            input = x.clone().requires_grad_()
+            mean, var = running_mean.clone(), running_var.clone()
+            expected = F.leaky_relu(F.batch_norm(input, mean, var, weight, bias, training), 0.1)
+            abn_input = x.clone().requires_grad_()
+            abn_mean, abn_var = running_mean.clone(), running_var.clone()
+            out = torch.inplace_abn_(abn_input.clone(), weight, bias, abn_mean, abn_var,
+                                     training, 0.1, 1e-5, 0.1)
+            self.assertEqual(out, expected)
+            self.assertEqual(abn_mean, mean)
+            self.assertEqual(abn_var, var)
+            grad = torch.randn_like(out)
+            self.assertEqual(torch.autograd.grad(out, (abn_input, weight, bias), grad),
+                             torch.autograd.grad(expected, (input, weight, bias), grad))
+            gradcheck(lambda t, w, b: torch.inplace_abn_(t.clone(), w, b, running_mean.clone(),
+                                                         running_var.clone(), training, 0.1, 1e-5, 0.1),
+                      (x.clone().requires_grad_(), weight, bias))
+        self.assertRaises(RuntimeError, lambda: torch.inplace_abn_(
+            x.clone(), weight, bias, None, None, True, 0.1, 1e-5, 0))
+
+    def test_inplace_abn(self):
+        self._test_inplace_abn()
+
+    @unittest.skipIf(not TEST_CUDA, "CUDA unavailable")
+    def test_inplace_abn_cuda(self):
+        self._test_inplace_abn("cuda")
+
     def test_MaxPool3d_indices(self):
         self._test_maxpool_indices(3)
 
@@ -2299,6 +2762,51 @@ class TestNN(NNTestCase):
             self.assertEqual(replica.bn.running_var.get_device(), i, 'buffer on wrong device')
             self.assertEqual(replica.bn.num_batches_tracked.get_device(), i, 'buffer on wrong device')
 
+    @unittest.skipIf(not TEST_MULTIGPU, "multi-GPU not supported")
+    def test_replica_cache(self):
+        net = nn.Sequential(nn.Linear(10, 5), nn.BatchNorm1d(5)).cuda().eval()
+        cache = dp.ReplicaCache((0, 1))
+        input = torch.randn(4, 10).cuda()
+        with torch.no_grad():
+            replicas = cache(net)
+            self.assertIs(cache(net)[1], replicas[1])
+            weight = replicas[1][0].weight
+            self.assertEqual(weight.get_device(), 1)
+            self.assertEqual(replicas[1](input.cuda(1)), net(input))
+
+            # in-place changes are broadcast into the same copies
+            net[0].weight.add_(1)
+            self.assertIs(cache(net)[1], replicas[1])
+            self.assertIs(replicas[1][0].weight, weight)
+            self.assertEqual(replicas[1](input.cuda(1)), net(input))
+
+            # changes through .data need an invalidation
+            net[0].bias.data.fill_(2)
+            cache.invalidate()
+            self.assertEqual(cache(net)[1](input.cuda(1)), net(input))
+
+            # new parameters and a new mode rebuild the replicas
+            net[0].weight = nn.Parameter(torch.randn(5, 10).cuda())
+            self.assertEqual(cache(net)[1](input.cuda(1)), net(input))
+            net.train()
+            self.assertTrue(cache(net)[1].training)
+
+    @unittest.skipIf(not TEST_MULTIGPU, "multi-GPU not supported")
+    def test_data_parallel_cache_replicas(self):
+        l = nn.Linear(10, 5).float().cuda()
+        net = dp.DataParallel(l, device_ids=(0, 1), cache_replicas=True)
+        i = torch.randn(20, 10).float().cuda()
+        with torch.no_grad():
+            self.assertEqual(net(i), l(i))
+            l.weight.mul_(2)
+            self.assertEqual(net(i), l(i))
+        self.assertIsNotNone(net._replica_cache)
+        out = net(i)
+        out.sum().backward()
+        self.assertIsNotNone(l.weight.grad)
+        copied = pickle.loads(pickle.dumps(net))
+        self.assertIsNone(copied._replica_cache)
+
     @unittest.skipIf(not TEST_MULTIGPU, "multi-GPU not supported")
     def test_parallel_apply(self):
         l1 = nn.Linear(10, 5).to("cuda:0", torch.float)
@@ -2880,6 +3388,22 @@ class TestNN(NNTestCase):
             self.assertEqual(conv1.bias.grad.data, conv2.bias.grad.data, prec=0.0)
             self.assertEqual(conv1.weight.grad.data, conv2.weight.grad.data, prec=0.0)
 
+    @unittest.skipIf(not TEST_CUDNN, 'CUDNN not available')
+    def test_Conv2d_benchmark_cache_cudnn(self):
+        inputs = torch.randn(2, 3, 7, 7, device="cuda", requires_grad=True)
+        conv = torch.nn.Conv2d(3, 4, 3).to("cuda")
+        with cudnn.flags(enabled=True, benchmark=True):
+            conv(inputs).sum().backward()
+        with tempfile.NamedTemporaryFile() as f:
+            cudnn.save_benchmark_cache(f.name)
+            # All the entries of this process are already in the cache
+            self.assertEqual(cudnn.load_benchmark_cache(f.name), 0)
+            f.seek(0)
+            lines = f.read().decode().splitlines()
+            self.assertTrue(lines[0].startswith('cudnn_benchmark_cache '))
+            kinds = set(line.split()[0] for line in lines[1:])
+            self.assertEqual(kinds, {'fwd', 'bwd_data', 'bwd_filter'})
+
     def test_Conv2d_missing_argument(self):
         c = nn.Conv2d(3, 3, 3)
         self.assertRaises(TypeError, lambda: c(None))
@@ -2965,6 +3489,22 @@ class TestNN(NNTestCase):
                 else:
                     self.assertRaises(ValueError, lambda: m(i, (h, w)))
 
+    def test_ConvTranspose2d_cpu_col2im(self):
+        # the batched, parallel col2im and the direct path of kernel == stride
+        # against the gradient of the adjoint convolution
+        for kernel, stride, padding, output_padding in [(2, 2, 0, 0), (2, 2, 0, 1), ((2, 3), (2, 3), 0, 0),
+                                                        (3, 2, 1, 1), (4, 2, 1, 0), (3, 1, 1, 0)]:
+            kernel_size = kernel if isinstance(kernel, tuple) else (kernel, kernel)
+            x = torch.randn(3, 4, 5, 6, dtype=torch.double)
+            weight = torch.randn(4, 5, *kernel_size, dtype=torch.double)
+            bias = torch.randn(5, dtype=torch.double)
+            out = F.conv_transpose2d(x, weight, bias, stride, padding, output_padding)
+            inp = torch.zeros(3, 5, *out.shape[2:], dtype=torch.double, requires_grad=True)
+            expected, = torch.autograd.grad(F.conv2d(inp, weight, None, stride, padding), inp, x)
+            self.assertEqual(out, expected + bias.view(1, 5, 1, 1))
+            # a single sample parallelizes over the output planes instead
+            self.assertEqual(F.conv_transpose2d(x[:1], weight, bias, stride, padding, output_padding), out[:1])
+
     def _test_Conv2d_naive_groups(self, device="cpu", dtype=torch.float):
         # Check that grouped convolutions matches two half convolutions
         m = nn.Conv2d(4, 4, kernel_size=3, groups=2).to(device, dtype)
@@ -3073,6 +3613,36 @@ class TestNN(NNTestCase):
                                         m2.weight.grad.data], 0),
                              prec=dtype2prec[dtype])
 
+    def test_Conv2d_depthwise_naive_groups(self):
+        for depth_multiplier, kernel_size, stride, padding in product([1, 3], [3, 5], [1, 2], [0, 2]):
+            x = torch.randn(2, 3, 11, 9, dtype=torch.double)
+            w = torch.randn(3 * depth_multiplier, 1, kernel_size, kernel_size, dtype=torch.double)
+            b = torch.randn(3 * depth_multiplier, dtype=torch.double)
+            output = F.conv2d(x, w, b, stride, padding, groups=3)
+            expected = torch.cat([F.conv2d(x[:, c:c + 1], w[c * depth_multiplier:(c + 1) * depth_multiplier],
+                                           b[c * depth_multiplier:(c + 1) * depth_multiplier], stride, padding)
+                                  for c in range(3)], 1)
+            self.assertEqual(output, expected)
+        x = torch.randn(1, 2, 7, 8, dtype=torch.double, requires_grad=True)
+        w = torch.randn(4, 1, 5, 5, dtype=torch.double, requires_grad=True)
+        b = torch.randn(4, dtype=torch.double, requires_grad=True)
+        self.assertTrue(gradcheck(lambda x, w, b: torch._depthwise_conv2d(x, w, b, (2, 1), (2, 1), (1, 2)),
+                                  (x, w, b)))
+
+    def test_grouped_conv2d(self):
+        x = torch.randn(2, 6, 7, 8, dtype=torch.double, requires_grad=True)
+        w = torch.randn(9, 2, 3, 2, dtype=torch.double, requires_grad=True)
+        b = torch.randn(9, dtype=torch.double, requires_grad=True)
+        stride, padding, dilation = (2, 1), (1, 0), (1, 2)
+        output = torch._grouped_conv2d(x, w, b, stride, padding, dilation, 3)
+        expected = torch.cat([F.conv2d(x[:, 2 * g:2 * g + 2], w[3 * g:3 * g + 3], b[3 * g:3 * g + 3],
+                                       stride, padding, dilation) for g in range(3)], 1)
+        self.assertEqual(output, expected)
+        self.assertTrue(gradcheck(lambda x, w, b: torch._grouped_conv2d(x, w, b, stride, padding, dilation, 3),
+                                  (x, w, b)))
+        self.assertTrue(gradcheck(lambda x, w: torch._grouped_conv2d(x, w, None, (1, 1), (0, 0), (1, 1), 3),
+                                  (x, w)))
+
     def test_MaxUnpool2d_output_size(self):
         m = nn.MaxPool2d(3, stride=2, return_indices=True)
         mu = nn.MaxUnpool2d(3, stride=2)
@@ -3147,6 +3717,79 @@ class TestNN(NNTestCase):
     def test_loss_equal_input_target_shape(self):
         self._test_loss_equal_input_target_shape(lambda x: x)
 
+    @staticmethod
+    def _cross_entropy_reference(x, target, w, size_average, reduce, label_smoothing, ignore_index=-100):
+        log_probs = F.log_softmax(x, 1)
+        nll = F.nll_loss(log_probs, target, w, size_average=False, ignore_index=ignore_index, reduce=False)
+        kept = (target != ignore_index).type_as(x)
+        row_weights = kept if w is None else w[target.clamp(min=0)] * kept
+        losses = (1 - label_smoothing) * nll - label_smoothing * log_probs.mean(1) * row_weights
+        if not reduce:
+            return losses
+        return losses.sum() / row_weights.sum() if size_average else losses.sum()
+
+    def _test_cross_entropy_fused(self, device):
+        # 2-D cross_entropy runs log_softmax and nll_loss in one pass
+        x = torch.randn(20, 37, dtype=torch.double, device=device, requires_grad=True)
+        target = torch.randint(37, (20,), dtype=torch.long, device=device)
+        target[3] = -100
+        weight = torch.rand(37, dtype=torch.double, device=device)
+        for w, size_average, reduce in product([None, weight], [True, False], [True, False]):
+            out = F.cross_entropy(x, target, w, size_average=size_average, reduce=reduce)
+            expected = F.nll_loss(F.log_softmax(x, 1), target, w, size_average=size_average, reduce=reduce)
+            self.assertEqual(out, expected)
+            grad = torch.randn_like(out)
+            self.assertEqual(torch.autograd.grad(out, x, grad), torch.autograd.grad(expected, x, grad))
+            gradcheck(lambda x: F.cross_entropy(x, target, w, size_average=size_average, reduce=reduce), (x,))
+            gradgradcheck(lambda x: F.cross_entropy(x, target, w, size_average=size_average, reduce=reduce), (x,))
+
+            out = F.cross_entropy(x, target, w, size_average=size_average, reduce=reduce, label_smoothing=0.1)
+            expected = self._cross_entropy_reference(x, target, w, size_average, reduce, 0.1)
+            self.assertEqual(out, expected)
+            self.assertEqual(torch.autograd.grad(out, x, grad), torch.autograd.grad(expected, x, grad))
+            gradcheck(lambda x: F.cross_entropy(x, target, w, size_average=size_average, reduce=reduce,
+                                                label_smoothing=0.1), (x,))
+            gradgradcheck(lambda x: F.cross_entropy(x, target, w, size_average=size_average, reduce=reduce,
+                                                    label_smoothing=0.1), (x,))
+
+        # rows of several chunks, with the max of the row in the last one
+        x = torch.randn(4, 5000, device=device)
+        x[:, 4999] = 30
+        target = torch.randint(5000, (4,), dtype=torch.long, device=device)
+        for label_smoothing in [0, 0.2]:
+            out = nn.CrossEntropyLoss(reduce=False, label_smoothing=label_smoothing)(x, target)
+            expected = self._cross_entropy_reference(x, target, None, True, False, label_smoothing)
+            self.assertEqual(out, expected, prec=1e-3)
+
+        # K-dimensional inputs are flattened to 2-D rows when smoothing
+        x = torch.randn(3, 5, 4, 2, dtype=torch.double, device=device, requires_grad=True)
+        target = torch.randint(5, (3, 4, 2), dtype=torch.long, device=device)
+        weight = torch.rand(5, dtype=torch.double, device=device)
+        for reduce in [True, False]:
+            out = F.cross_entropy(x, target, weight, reduce=reduce, label_smoothing=0.3)
+            rows = x.permute(0, 2, 3, 1).contiguous().view(-1, 5)
+            expected = F.cross_entropy(rows, target.view(-1), weight, reduce=reduce, label_smoothing=0.3)
+            self.assertEqual(out, expected if reduce else expected.view(3, 4, 2))
+        self.assertEqual(F.cross_entropy(x, target, label_smoothing=0), F.cross_entropy(x, target))
+
+    def test_cross_entropy_fused(self):
+        self._test_cross_entropy_fused('cpu')
+        x = torch.randn(20, 37)
+        self.assertRaises(RuntimeError, lambda: F.cross_entropy(x, torch.full((20,), 37, dtype=torch.long)))
+        self.assertRaises(RuntimeError, lambda: F.cross_entropy(x, torch.zeros(20, dtype=torch.long),
+                                                                label_smoothing=1.5))
+
+    @unittest.skipIf(not TEST_CUDA, "CUDA unavailable")
+    def test_cross_entropy_fused_cuda(self):
+        self._test_cross_entropy_fused('cuda')
+        x = torch.randn(20, 37, device='cuda', dtype=torch.half, requires_grad=True)
+        target = torch.randint(37, (20,), dtype=torch.long, device='cuda')
+        out = F.cross_entropy(x, target, label_smoothing=0.1)
+        expected = self._cross_entropy_reference(x.float(), target, None, True, True, 0.1)
+        self.assertEqual(out.float(), expected, prec=1e-2)
+        out.backward()
+        self.assertEqual(x.grad.dtype, torch.half)
+
     def test_NLLLoss_mismatched_batch(self):
         x = torch.randn((10, 3), requires_grad=True)
         # t should have size (10,)
@@ -3604,6 +4247,32 @@ class TestNN(NNTestCase):
             self.assertEqual(output1, output2)
             self.assertEqual(hidden1, hidden2)
 
+    def test_rnn_cpu_inference(self):
+        # without autograd, CPU RNNs run on torch._cpu_rnn, which must match
+        # the autograd cells
+        for mode, bias, bidirectional, batch_first in product(
+                ['RNN_TANH', 'RNN_RELU', 'LSTM', 'GRU'], [True, False], [False, True], [False, True]):
+            if mode.startswith('RNN_'):
+                rnn = nn.RNN(7, 13, 2, nonlinearity=mode[4:].lower(), bias=bias,
+                             batch_first=batch_first, bidirectional=bidirectional)
+            else:
+                rnn = getattr(nn, mode)(7, 13, 2, bias=bias, batch_first=batch_first,
+                                        bidirectional=bidirectional)
+            rnn = rnn.double()
+            input = torch.randn(6, 5, 7, dtype=torch.double)
+            num_directions = 2 if bidirectional else 1
+            hx = torch.randn(2 * num_directions, 5, 13, dtype=torch.double)
+            if batch_first:
+                input = input.transpose(0, 1).contiguous()
+            if mode == 'LSTM':
+                hx = (hx, torch.randn_like(hx))
+
+            output, hy = rnn(input, hx)
+            with torch.no_grad():
+                output_cpu, hy_cpu = rnn(input, hx)
+            self.assertEqual(output_cpu, output)
+            self.assertEqual(hy_cpu, hy)
+
     def _test_rnn_retain_variables(self, device="cpu", dtype=torch.double):
         rnns = [nn.LSTM(10, 20, num_layers=2).to(device, dtype),
                 nn.GRU(10, 20, num_layers=2).to(device, dtype),
@@ -6447,6 +7116,11 @@ new_module_tests = [
         constructor=lambda: nn.Conv2d(4, 4, (3, 3), padding=(1, 1), groups=4),
         input_size=(2, 4, 6, 6),
     ),
+    dict(
+        fullname='Conv2d_depthwise_5x5_strided',
+        constructor=lambda: nn.Conv2d(4, 4, (5, 5), stride=(2, 2), padding=(2, 2), groups=4),
+        input_size=(2, 4, 7, 7),
+    ),
     dict(
         fullname='Conv2d_depthwise_dilated',
         constructor=lambda: nn.Conv2d(4, 4, (2, 2), dilation=(2, 2), groups=4),
@@ -475,6 +475,59 @@ class TestOptim(TestCase):
             ignore_multidevice=True
         )
 
+    def test_fused_steps(self):
+        # Enough tensors, and ones large enough, to take several batches of
+        # chunks on CUDA
+        sizes = [3, 70000, 0, 5] + [7] * 150
+        devices = ['cpu'] + (['cuda'] if torch.cuda.is_available() else [])
+        for device in devices:
+            def lists(n):
+                return [[torch.randn(s, dtype=torch.double, device=device) for s in sizes]
+                        for _ in range(n)]
+
+            params, grads, bufs = lists(3)
+            expected = []
+            for p, g, b in zip(params, grads, bufs):
+                d_p = g + 0.1 * p
+                b_new = 0.9 * b + 0.8 * d_p
+                expected.append((p - 0.5 * (d_p + 0.9 * b_new), b_new))
+            torch._fused_sgd(params, grads, bufs, 0.5, 0.9, 0.2, 0.1, True, False)
+            for p, b, (p_new, b_new) in zip(params, bufs, expected):
+                self.assertEqual(p, p_new)
+                self.assertEqual(b, b_new)
+
+            params, grads, exp_avgs, exp_avg_sqs, max_exp_avg_sqs = lists(5)
+            exp_avg_sqs = [t.abs() for t in exp_avg_sqs]
+            max_exp_avg_sqs = [t.abs() for t in max_exp_avg_sqs]
+            expected = []
+            for p, g, m, v, v_max in zip(params, grads, exp_avgs, exp_avg_sqs, max_exp_avg_sqs):
+                g = g + 0.1 * p
+                m_new = 0.9 * m + 0.1 * g
+                v_new = 0.99 * v + 0.01 * g * g
+                v_max_new = torch.max(v_max, v_new)
+                expected.append((p - 0.01 * m_new / (v_max_new.sqrt() + 1e-8), m_new, v_new, v_max_new))
+            torch._fused_adam(params, grads, exp_avgs, exp_avg_sqs, max_exp_avg_sqs,
+                              0.01, 0.9, 0.99, 1e-8, 0.1)
+            for i, (p_new, m_new, v_new, v_max_new) in enumerate(expected):
+                self.assertEqual(params[i], p_new)
+                self.assertEqual(exp_avgs[i], m_new)
+                self.assertEqual(exp_avg_sqs[i], v_new)
+                self.assertEqual(max_exp_avg_sqs[i], v_max_new)
+
+            params, grads, sums = lists(3)
+            sums = [t.abs() for t in sums]
+            expected = []
+            for p, g, s in zip(params, grads, sums):
+                s_new = s + g * g
+                expected.append((p - 0.1 * g / (s_new.sqrt() + 1e-10), s_new))
+            torch._fused_adagrad(params, grads, sums, 0.1, 0)
+            for p, s, (p_new, s_new) in zip(params, sums, expected):
+                self.assertEqual(p, p_new)
+                self.assertEqual(s, s_new)
+
+        with self.assertRaisesRegex(RuntimeError, "elements of its parameter"):
+            torch._fused_sgd([torch.randn(3)], [torch.randn(4)], [], 0.1)
+
     def test_invalid_param_type(self):
         with self.assertRaises(TypeError):
             optim.SGD(Variable(torch.randn(5, 5)), lr=3)
@@ -127,6 +127,32 @@ class TestSparse(TestCase):
         self.assertEqual(x._indices().numel(), 0)
         self.assertEqual(x._values().numel(), 0)
 
+    @cpu_only
+    def test_coalesce_sorted(self):
+        # sorted unique indices are only marked as coalesced
+        i = self.IndexTensor([[0, 0, 1, 3], [1, 2, 0, 0]])
+        v = self.ValueTensor([1, 2, 3, 4])
+        x = self.SparseTensor(i, v, torch.Size([4, 3]))
+        self.assertFalse(x.is_coalesced())
+        y = x.coalesce()
+        self.assertTrue(y.is_coalesced())
+        self.assertTrue(x.is_coalesced())
+        self.assertEqual(i, y._indices())
+        self.assertEqual(v, y._values())
+
+    @cpu_only
+    def test_coalesce_large(self):
+        # enough entries for the parallel sort, with keys of several digits
+        n = 200000
+        i = (torch.rand(2, n) * 1000).type(torch.LongTensor)
+        v = torch.randn(n).type(self.ValueTensor)
+        x = self.SparseTensor(i, v, torch.Size([1000, 1000]))
+        y = x.coalesce()
+        self.assertTrue(y.is_coalesced())
+        keys = y._indices()[0] * 1000 + y._indices()[1]
+        self.assertTrue((keys[1:] > keys[:-1]).all())
+        self.assertEqual(x.to_dense(), y.to_dense())
+
     def test_ctor_size_checks(self):
         indices = self.IndexTensor([
             [0, 0, 0],
@@ -463,6 +489,49 @@ class TestSparse(TestCase):
         test_shape(1000, 100, 100)
         test_shape(3000, 64, 300)
 
+    @cpu_only
+    def test_csr(self):
+        def test_shape(di, dj, dk):
+            x = self._gen_sparse(2, 20, [di, dj])[0]
+            dense = self.safeToDense(x)
+            a = sparse.CSRTensor.from_coo(x)
+            self.assertEqual(a.size(), torch.Size([di, dj]))
+            self.assertEqual(a.to_dense(), dense)
+            self.assertEqual(a.to_coo().to_dense(), dense)
+            self.assertEqual(sparse.CSRTensor.from_dense(dense).to_dense(), dense)
+            self.assertEqual(a.t().to_dense(), dense.t())
+
+            y = torch.randn(dj, dk)
+            t = torch.randn(di, dk)
+            alpha = random.random()
+            beta = random.random()
+            self.assertEqual(a.mm(y), torch.mm(dense, y))
+            self.assertEqual(a.addmm(t, y, beta=beta, alpha=alpha),
+                             torch.addmm(beta, t, alpha, dense, y))
+            self.assertEqual(a.addmm(t[0], y), torch.addmm(t[0], dense, y))
+
+            rows = torch.LongTensor([di - 1, 0, di - 1])
+            cols = torch.LongTensor([0, dj - 1])
+            self.assertEqual(a.index_select(0, rows).to_dense(), dense.index_select(0, rows))
+            self.assertEqual(a.index_select(1, cols).to_dense(), dense.index_select(1, cols))
+
+        test_shape(7, 5, 3)
+        test_shape(1000, 100, 100)
+        test_shape(3000, 64, 300)
+
+    @cpu_only
+    def test_csr_mm_backward(self):
+        x = self._gen_sparse(2, 20, [10, 5])[0].coalesce()
+        crow = torch._csr_pointers(x._indices()[0], 10)
+        col = x._indices()[1].contiguous()
+
+        def fn(values, dense):
+            return sparse.CSRTensor(crow, col, values, (10, 5)).mm(dense)
+
+        values = x._values().clone().requires_grad_()
+        dense = torch.randn(5, 3, requires_grad=True)
+        self.assertTrue(torch.autograd.gradcheck(fn, (values, dense)))
+
     def _test_spadd_shape(self, shape_i, shape_v=None):
         shape = shape_i + (shape_v or [])
         x, _, _ = self._gen_sparse(len(shape_i), 10, shape)
@@ -628,6 +628,34 @@ class TestTorch(TestCase):
     def test_norm_cuda(self):
         self._test_norm(self, device='cuda')
 
+    @staticmethod
+    def _test_cdist(self, device):
+        for n, m, d in [(1, 1, 1), (5, 7, 3), (100, 80, 20)]:
+            x1 = torch.randn(n, d, dtype=torch.double, device=device)
+            x2 = torch.randn(m, d, dtype=torch.double, device=device)
+            diff = x1.unsqueeze(1) - x2.unsqueeze(0)
+            for p in [0, 1, 2, 3, 1.5, float('inf')]:
+                expected = diff.norm(p, 2)
+                self.assertEqual(torch.cdist(x1, x2, p), expected, 1e-8,
+                                 "cdist failed for {}-norm".format(p))
+        # close points, where the GEMM formula suffers from cancellation
+        x1 = torch.randn(10, 5, dtype=torch.double, device=device) + 1000
+        x2 = x1 + 1e-3
+        self.assertEqual(torch.cdist(x1, x2).diag(),
+                         torch.full((10,), 1e-3 * math.sqrt(5), dtype=torch.double, device=device), 1e-8)
+        # backward
+        x1 = torch.randn(4, 3, dtype=torch.double, device=device, requires_grad=True)
+        x2 = torch.randn(5, 3, dtype=torch.double, device=device, requires_grad=True)
+        for p in [1, 2, 3]:
+            self.assertTrue(torch.autograd.gradcheck(lambda a, b: torch.cdist(a, b, p), (x1, x2)))
+
+    def test_cdist(self):
+        self._test_cdist(self, device='cpu')
+
+    @unittest.skipIf(not torch.cuda.is_available(), 'no CUDA')
+    def test_cdist_cuda(self):
+        self._test_cdist(self, device='cuda')
+
     def test_dim_reduction_uint8_overflow(self):
         example = [[-1, 2, 1], [5, 3, 6]]
         x = torch.tensor(example, dtype=torch.uint8)
@@ -823,6 +851,32 @@ class TestTorch(TestCase):
         expected.map2_(a, b, lambda _, a, b: TH_lerp(a, b, w))
         self.assertEqual(result, expected)
 
+    def test_pointwise_ops_broadcast_noncontig(self):
+        # the vectorized CPU kernels take different paths for contiguous,
+        # broadcast (zero-stride) and arbitrarily strided operands
+        for dtype in [torch.float, torch.double]:
+            a = torch.randn(37, 65, dtype=dtype)
+            b = torch.randn(65, 37, dtype=dtype).t()
+            c = torch.randn(65, dtype=dtype).abs() + 1
+            d = torch.randn(37, 1, dtype=dtype)
+            for t1, t2 in [(b, c), (c, d), (d, b), (b, b)]:
+                self.assertEqual(torch.addcmul(a, 0.5, t1, t2), a + 0.5 * t1 * t2)
+                self.assertEqual(torch.addcdiv(a, 0.5, t1, t2.abs() + 1), a + 0.5 * t1 / (t2.abs() + 1))
+                x = a.clone()
+                x.addcmul_(2, t1, t2)
+                self.assertEqual(x, a + 2 * t1 * t2)
+            for end in [b, c, d]:
+                self.assertEqual(torch.lerp(a, end, 0.3), a + 0.3 * (end - a))
+                x = a.clone()
+                x.lerp_(end, 0.3)
+                self.assertEqual(x, a + 0.3 * (end - a))
+            out = torch.empty(0, dtype=dtype)
+            torch.addcmul(a, 1, b, c, out=out)
+            self.assertEqual(out, a + b * c)
+        # integral types are still handled by TH
+        i = torch.arange(10, dtype=torch.long)
+        self.assertEqual(torch.addcmul(i, 2, i, i), i + 2 * i * i)
+
     def test_all_any(self):
         def test(size):
             x = torch.ones(*size).byte()
@@ -1203,6 +1257,27 @@ class TestTorch(TestCase):
             r = torch.mm(b1[i], b2[i])
             self.assertEqual(r, res[i])
 
+    def test_bmm_layouts(self):
+        num_batches = 40
+        M, N, O = 7, 5, 3
+        for dtype in [torch.float, torch.double, torch.long]:
+            b1 = torch.randn(num_batches, M, N).mul(10).to(dtype)
+            b2 = torch.randn(num_batches, N, O).mul(10).to(dtype)
+            expected = torch.stack([torch.mm(b1[i], b2[i]) for i in range(num_batches)])
+            # transposed, expanded and non-contiguous operands
+            b1_t = b1.transpose(1, 2).contiguous().transpose(1, 2)
+            b2_t = b2.transpose(1, 2).contiguous().transpose(1, 2)
+            self.assertEqual(torch.bmm(b1_t, b2_t), expected)
+            self.assertEqual(torch.bmm(b1[:1].expand_as(b1), b2),
+                             torch.stack([torch.mm(b1[0], b2[i]) for i in range(num_batches)]))
+            b1_strided = torch.zeros(num_batches, M, 2 * N, dtype=dtype)[:, :, ::2]
+            b1_strided.copy_(b1)
+            self.assertEqual(torch.bmm(b1_strided, b2), expected)
+            # into a non-contiguous result
+            out = torch.zeros(num_batches, O, M, dtype=dtype).transpose(1, 2)
+            torch.bmm(b1, b2, out=out)
+            self.assertEqual(out, expected)
+
     def test_addbmm(self):
         # num_batches = 10
         # M, N, O = 12, 8, 5
@@ -1545,6 +1620,24 @@ class TestTorch(TestCase):
             check_sum_dim(make_contiguous_slice(500, dtype), 0)
             check_sum_dim(make_contiguous_slice(100000, dtype), 0)
 
+    @unittest.skipIf(not TEST_NUMPY, 'Numpy not found')
+    def test_moments_dim_non_contiguous(self):
+        for dtype in [torch.float, torch.double]:
+            x = torch.randn(4, 3, 20, 2, dtype=dtype).transpose(1, 2)[..., 0]
+            self.assertFalse(x.is_contiguous())
+            x_np = x.numpy()
+            for dim in range(x.dim()):
+                for keepdim in [False, True]:
+                    self.assertEqual(x.mean(dim, keepdim),
+                                     torch.from_numpy(x_np.mean(dim, keepdims=keepdim)))
+                    self.assertEqual(x.var(dim, keepdim=keepdim),
+                                     torch.from_numpy(x_np.var(dim, ddof=1, keepdims=keepdim)))
+                    self.assertEqual(x.std(dim, unbiased=False, keepdim=keepdim),
+                                     torch.from_numpy(x_np.std(dim, keepdims=keepdim)))
+            self.assertEqual(x.sum((0, 2)), torch.from_numpy(x_np.sum((0, 2))))
+            self.assertEqual(x.sum((0, 1, 2), keepdim=True),
+                             torch.from_numpy(x_np.sum((0, 1, 2), keepdims=True)))
+
     def test_sum_out(self):
         x = torch.rand(100, 100)
         res1 = torch.sum(x, 1)
@@ -1645,6 +1738,16 @@ class TestTorch(TestCase):
         torch.zeros(100, 100, out=res2)
         self.assertEqual(res1, res2)
 
+    def test_zeros_large(self):
+        # large CPU tensors are created from calloc'ed memory
+        for dtype in [torch.uint8, torch.float, torch.double]:
+            res = torch.zeros(1 << 21, dtype=dtype)
+            self.assertEqual(res.sum().item(), 0)
+            res.fill_(1)
+            res.resize_(1 << 22)
+            self.assertEqual(res[:1 << 21].sum().item(), 1 << 21)
+            self.assertEqual(torch.zeros_like(res).sum().item(), 0)
+
     def test_zeros_like(self):
         expected = torch.zeros(100, 100)
 
@@ -2322,6 +2425,48 @@ class TestTorch(TestCase):
     def test_multinomial(self):
         self._test_multinomial(self, torch.FloatTensor)
 
+    def test_multinomial_alias(self):
+        probs = torch.tensor([0.1, 0, 3, 0.5, 1.4, 0.02, 5], dtype=torch.double)
+        q, J = torch._multinomial_alias_setup(probs)
+        self.assertEqual(q.dtype, torch.double)
+        self.assertEqual(J.dtype, torch.long)
+        samples = torch._multinomial_alias_draw(q, J, 200000)
+        self.assertEqual(samples.size(), (200000,))
+        self.assertTrue(samples.min() >= 0 and samples.max() < probs.numel())
+        self.assertEqual((samples == 1).sum(), 0)
+        freqs = torch.tensor([(samples == k).sum().item() for k in range(probs.numel())],
+                             dtype=torch.double) / samples.numel()
+        self.assertEqual(freqs, probs / probs.sum(), 0.01)
+        self.assertEqual(torch._multinomial_alias_draw(q, J, 0).numel(), 0)
+        self.assertRaises(RuntimeError, lambda: torch._multinomial_alias_setup(torch.tensor([1., -1.])))
+        self.assertRaises(RuntimeError, lambda: torch._multinomial_alias_setup(torch.rand(2, 3)))
+
+    def test_samplers_num_threads(self):
+        # gamma, poisson and multinomial sample in parallel from counter-based
+        # streams, so the samples must not depend on the number of threads
+        num_threads = torch.get_num_threads()
+        try:
+            results = []
+            for threads in [1, 4]:
+                torch.set_num_threads(threads)
+                torch.manual_seed(123)
+                rates = torch.rand(50000, dtype=torch.double) * 20
+                probs = torch.rand(40, 300)
+                q, J = torch._multinomial_alias_setup(probs[0])
+                results.append([torch._standard_gamma(rates), torch.poisson(rates),
+                                torch.multinomial(probs, 1000, True), torch.multinomial(probs, 100, False),
+                                torch._multinomial_alias_draw(q, J, 100000)])
+            for x, y in zip(*results):
+                self.assertEqual(x, y, 0)
+        finally:
+            torch.set_num_threads(num_threads)
+
+        torch.manual_seed(123)
+        rates = torch.full((100000,), 7, dtype=torch.double)
+        self.assertEqual(torch.poisson(rates).mean(), 7, 0.05)
+        self.assertEqual(torch._standard_gamma(rates).mean(), 7, 0.05)
+        self.assertEqual(torch._standard_gamma(rates).var(), 7, 0.2)
+
     @suppress_warnings
     def test_range(self):
         res1 = torch.range(0, 1)
@@ -2786,6 +2931,42 @@ class TestTorch(TestCase):
         torch.zeros(5, 6).copy_(torch.zeros(6))
         self.assertRaises(RuntimeError, lambda: torch.zeros(5, 6).copy_(torch.zeros(30)))
 
+    def test_arg_parser_cached_signatures(self):
+        # every call site caches the signature matched by its last call with
+        # only positional arguments; calls with other argument types, or
+        # where a 0-dim tensor is accepted as a number, must not reuse it
+        x = torch.ones(2, 3)
+        for _ in range(2):
+            self.assertEqual(x.add(2), torch.full((2, 3), 3))
+            self.assertEqual(x.add(2.5), torch.full((2, 3), 3.5))
+            self.assertEqual(x.add(torch.tensor(2.)), torch.full((2, 3), 3))
+            self.assertEqual(x.add(torch.full((2, 3), 2)), torch.full((2, 3), 3))
+            self.assertEqual(x.add(2, alpha=3), torch.full((2, 3), 7))
+            self.assertEqual(x.view(3, 2).size(), (3, 2))
+            self.assertEqual(x.view((6,)).size(), (6,))
+            self.assertRaises(TypeError, lambda: x.add('2'))
+
+    def test_copy_dtypes(self):
+        types = [torch.uint8, torch.int32, torch.int64, torch.float32, torch.float64]
+        src = torch.arange(0, 60 * 70).view(60, 70)
+        for src_dtype in types + [torch.float16]:
+            for dst_dtype in types:
+                if src_dtype == dst_dtype:
+                    continue
+                x = src.remainder(200).to(src_dtype)
+                expected = [[int(v) for v in row] for row in x.double().tolist()]
+                # contiguous, transposed, strided and broadcast sources and
+                # a transposed destination
+                self.assertEqual(x.to(dst_dtype).tolist(), expected)
+                self.assertEqual(x.t().to(dst_dtype).t().tolist(), expected)
+                y = torch.zeros(70, 60, dtype=dst_dtype).t()
+                y.copy_(x)
+                self.assertEqual(y.tolist(), expected)
+                self.assertEqual(x[::2, 1::3].to(dst_dtype).tolist(),
+                                 [row[1::3] for row in expected[::2]])
+                self.assertEqual(torch.zeros(3, 70, dtype=dst_dtype).copy_(x[5]).tolist(),
+                                 [expected[5]] * 3)
+
     def test_randperm(self):
         _RNGState = torch.get_rng_state()
         res1 = torch.randperm(100)
@@ -2954,6 +3135,17 @@ class TestTorch(TestCase):
                         k = random.randint(1, testTensor.size(dim))
                         compare(testTensor, k, dim, dir)
 
+    def test_topk_many_slices(self):
+        # big enough for the slices to be split across threads
+        t = torch.rand(300, 20, 50)
+        for dim in range(3):
+            for dir in (True, False):
+                for testTensor in (t, t.transpose(0, 2)):
+                    topKVal, topKInd = testTensor.topk(5, dim, dir, True)
+                    sortVal, _ = testTensor.sort(dim, dir)
+                    self.assertEqual(topKVal, sortVal.narrow(dim, 0, 5), 0)
+                    self.assertEqual(topKVal, testTensor.gather(dim, topKInd), 0)
+
     def test_topk_arguments(self):
         q = torch.randn(10, 2, 10)
         # Make sure True isn't mistakenly taken as the 2nd dimension (interpreted as 1)
@@ -3155,6 +3347,31 @@ class TestTorch(TestCase):
     def test_cat_empty(self):
         self._test_cat_empty(self)
 
+    def test_cat_out(self):
+        empty = torch.randn(0)
+        for dtype in [torch.float, torch.double, torch.uint8, torch.int64]:
+            x = torch.randn(4, 5, 6).mul(10).to(dtype)
+            y = torch.randn(4, 3, 6).mul(10).to(dtype)
+            expected = x.new(4, 8, 6)
+            expected[:, :5] = x
+            expected[:, 5:] = y
+            res = x.new(4, 8, 6)
+            res_dp = res.data_ptr()
+            torch.cat([x, empty.to(dtype), y], 1, out=res)
+            self.assertEqual(res, expected, 0)
+            self.assertEqual(res.data_ptr(), res_dp)
+            # a result of the wrong size is resized, a non-contiguous one
+            # written in place
+            res = x.new()
+            torch.cat([x, y], 1, out=res)
+            self.assertEqual(res, expected, 0)
+            res = x.new(6, 8, 4).transpose(0, 2)
+            torch.cat([x, y], 1, out=res)
+            self.assertEqual(res, expected, 0)
+            # mixed contiguous and non-contiguous inputs
+            z = torch.randn(4, 6, 7).mul(10).to(dtype).transpose(1, 2)
+            self.assertEqual(torch.cat([x, z, y], 1).narrow(1, 5, 7), z, 0)
+
     def test_stack(self):
         x = torch.rand(2, 3, 4)
         y = torch.rand(2, 3, 4)
@@ -3435,6 +3652,41 @@ class TestTorch(TestCase):
     def test_gesv_batched_dims(self):
         self._test_gesv_batched_dims(self, lambda t: t)
 
+    @staticmethod
+    def _test_batched_small_matrices(self, cast):
+        # matrices of up to 8 rows use the register-resident kernels, larger
+        # ones the LAPACK / MAGMA path; both must match the unbatched functions
+        for n in [1, 3, 6, 8, 12]:
+            A = cast(torch.randn(2, 3, n, n).double())
+            b = cast(torch.randn(2, 3, n, 4).double())
+            x, LU = torch.gesv(b, A)
+            inv = torch.inverse(A)
+            M = torch.matmul(A, A.transpose(-2, -1)) + cast(torch.eye(n).double())
+            U = torch.potrf(M)
+            L = torch.potrf(M, False)
+            for i in range(2):
+                for j in range(3):
+                    x_exp, LU_exp = torch.gesv(b[i, j], A[i, j])
+                    self.assertEqual(x[i, j], x_exp)
+                    self.assertEqual(LU[i, j], LU_exp)
+                    self.assertEqual(inv[i, j], torch.inverse(A[i, j]))
+                    self.assertEqual(U[i, j], torch.potrf(M[i, j]))
+                    self.assertEqual(L[i, j], torch.potrf(M[i, j], False))
+            self.assertEqual(torch.matmul(A, inv), cast(torch.eye(n).double()).expand_as(A))
+
+        # errors are reported for the failing matrix of the batch
+        A = cast(torch.randn(4, 3, 3).double())
+        A = torch.matmul(A, A.transpose(-2, -1)) + cast(torch.eye(3).double())
+        A[2].zero_()
+        self.assertRaisesRegex(RuntimeError, 'For batch 2', lambda: torch.inverse(A))
+        self.assertRaisesRegex(RuntimeError, 'For batch 2', lambda: torch.potrf(A))
+        self.assertRaisesRegex(RuntimeError, 'For batch 2',
+                               lambda: torch.gesv(cast(torch.randn(4, 3, 1).double()), A))
+
+    @skipIfNoLapack
+    def test_batched_small_matrices(self):
+        self._test_batched_small_matrices(self, lambda t: t)
+
     @skipIfNoLapack
     def test_qr(self):
 
@@ -4127,6 +4379,42 @@ class TestTorch(TestCase):
             return torch.DoubleTensor(*sizes).normal_()
         self._test_fft_ifft_rfft_irfft(self, build_fn=randn_double)
 
+    @staticmethod
+    def _test_fft_plan_cache(self, x, get_max_size, set_max_size, get_size, clear):
+        orig_max_size = get_max_size()
+        try:
+            clear()
+            set_max_size(2)
+            expected = x.fft(1)
+            self.assertEqual(get_size(), 1)
+            # a cached plan gives the same result
+            self.assertEqual(x.fft(1), expected, 0)
+            self.assertEqual(get_size(), 1)
+            # inverse and real transforms of other sizes evict the least
+            # recently used plans
+            x.ifft(1)
+            x.narrow(0, 0, 3).fft(1)
+            x.select(2, 0).rfft(1)
+            self.assertLessEqual(get_size(), 2)
+            self.assertEqual(x.fft(1), expected, 0)
+            set_max_size(0)
+            self.assertEqual(get_size(), 0)
+            self.assertEqual(x.fft(1), expected, 0)
+            self.assertEqual(get_size(), 0)
+            self.assertRaises(RuntimeError, lambda: set_max_size(-1))
+        finally:
+            set_max_size(orig_max_size)
+            clear()
+
+    @unittest.skipIf(not TEST_MKL, "PyTorch is built without MKL support")
+    def test_fft_plan_cache(self):
+        x = torch.randn(5, 8, 2, dtype=torch.double)
+        self._test_fft_plan_cache(self, x,
+                                  torch.backends.mkl.fft_plan_cache_max_size,
+                                  torch.backends.mkl.set_fft_plan_cache_max_size,
+                                  torch.backends.mkl.fft_plan_cache_size,
+                                  torch.backends.mkl.clear_fft_plan_cache)
+
     @staticmethod
     def _test_stft(self, build_fn):
         # the conv_fn to convert tensors can be slow in cuda tests, so we use
@@ -5285,6 +5573,49 @@ class TestTorch(TestCase):
             dest2[idx[i]] = dest2[idx[i]] + src[i]
         self.assertEqual(dest, dest2)
 
+    def test_index_add_duplicates(self):
+        # narrow rows are grouped by target, wide ones split in column blocks;
+        # both must add repeated indices in order
+        for row_size in [1, 7, 2000]:
+            for dtype in [torch.float, torch.double, torch.int64]:
+                dest = torch.randn(5, row_size).mul(10).to(dtype)
+                src = torch.randn(12, row_size).mul(10).to(dtype)
+                idx = torch.LongTensor([4, 0, 4, 2, 4, 0, 1, 3, 3, 4, 0, 2])
+                expected = dest.clone()
+                for i in range(idx.size(0)):
+                    expected[idx[i]] += src[i]
+                dest.index_add_(0, idx, src)
+                self.assertEqual(dest, expected, 0)
+        self.assertRaises(RuntimeError, lambda: torch.zeros(3, 2).index_add_(
+            0, torch.LongTensor([0, 3]), torch.ones(2, 2)))
+
+    def test_index_put_accumulate(self):
+        dest = torch.zeros(4, 3)
+        idx = torch.LongTensor([0, 3, -1, 0])
+        dest.index_put_((idx,), torch.ones(4, 3), accumulate=True)
+        self.assertEqual(dest, torch.Tensor([[2, 2, 2], [0, 0, 0], [0, 0, 0], [2, 2, 2]]))
+
+        # broadcast value, multi-dimensional index
+        dest = torch.zeros(4, 3)
+        dest.index_put_((torch.LongTensor([[1, 1], [2, 1]]),), torch.Tensor([1, 2, 3]), True)
+        self.assertEqual(dest, torch.Tensor([[0, 0, 0], [3, 6, 9], [1, 2, 3], [0, 0, 0]]))
+
+        # element indices
+        dest = torch.zeros(3, 4)
+        rows = torch.LongTensor([0, 2, 0, 0])
+        cols = torch.LongTensor([1, 3, 1, 2])
+        dest.index_put_((rows, cols), torch.Tensor([1, 2, 3, 4]), accumulate=True)
+        expected = torch.zeros(3, 4)
+        expected[0, 1] = 4
+        expected[2, 3] = 2
+        expected[0, 2] = 4
+        self.assertEqual(dest, expected)
+
+        # without accumulate the last value of repeated indices is put
+        dest = torch.zeros(3)
+        dest.index_put_((torch.LongTensor([1, 1]),), torch.Tensor([5, 6]))
+        self.assertEqual(dest, torch.Tensor([0, 6, 0]))
+
     def test_index_select(self):
         src = torch.randn(3, 4, 5)
         # Index can be duplicated.
@@ -6078,6 +6409,38 @@ class TestTorch(TestCase):
         self.assertEqual(r[:, :50].std(), 4, 0.3)
         self.assertEqual(r[:, 50:].std(), 1, 0.2)
 
+    def test_random_fill_num_threads(self):
+        # contiguous fills are computed in parallel chunks from a counter-based
+        # stream, so they must not depend on the number of threads
+        num_threads = torch.get_num_threads()
+        size = 300001
+        try:
+            results = []
+            for threads in [1, 4]:
+                torch.set_num_threads(threads)
+                results.append([])
+                for dtype in [torch.float, torch.double]:
+                    torch.manual_seed(123)
+                    results[-1].append(torch.empty(size, dtype=dtype).uniform_(-1, 2))
+                    results[-1].append(torch.empty(size, dtype=dtype).normal_(3, 2))
+                    results[-1].append(torch.empty(size, dtype=dtype).bernoulli_(0.3))
+            for x, y in zip(*results):
+                self.assertEqual(x, y, 0)
+        finally:
+            torch.set_num_threads(num_threads)
+
+        torch.manual_seed(123)
+        u = torch.empty(size).uniform_(-1, 2)
+        self.assertTrue(u.min() >= -1 and u.max() < 2)
+        self.assertEqual(u.mean(), 0.5, 0.01)
+        n = torch.empty(size).normal_(3, 2)
+        self.assertEqual(n.mean(), 3, 0.02)
+        self.assertEqual(n.std(), 2, 0.02)
+        b = torch.empty(size).bernoulli_(0.3)
+        self.assertEqual(b.mean(), 0.3, 0.01)
+        self.assertEqual(torch.empty(100).bernoulli_(0).sum(), 0)
+        self.assertEqual(torch.empty(100).bernoulli_(1).sum(), 100)
+
     def test_parsing_int64(self):
         # accepts integer arguments
         x = torch.cumsum(torch.ones(5, 5), 0)
@@ -6200,6 +6563,65 @@ class TestTorch(TestCase):
     def test_serialization_offset_filelike(self):
         self._test_serialization_offset(BytesIOContext)
 
+    def _test_serialization_async(self, make_tensor):
+        a = [make_tensor(100 * (i + 1)) for i in range(5)]
+        b = [a, a[0][10:20], make_tensor(0)]
+        expected = copy.deepcopy(b)
+        with tempfile.NamedTemporaryFile() as f:
+            checkpoint = torch.save_async(b, f.name, num_threads=2)
+            # the storages were copied, so they can be changed right away
+            for t in a:
+                t.fill_(-1)
+            checkpoint.wait()
+            self.assertTrue(checkpoint.done())
+            c = torch.load(f.name)
+        self.assertEqual(expected, c, 0)
+        self.assertEqual(c[0][0].storage().data_ptr(), c[1].storage().data_ptr())
+
+    @unittest.skipIf(IS_WINDOWS, "the file is opened twice, which isn't supported on Windows")
+    def test_serialization_async(self):
+        self._test_serialization_async(lambda n: torch.randn(n))
+        self.assertRaises(TypeError, lambda: torch.save_async(torch.randn(5), io.BytesIO()))
+
+    @unittest.skipIf(IS_WINDOWS, "the file is opened twice, which isn't supported on Windows")
+    @unittest.skipIf(not torch.cuda.is_available(), 'no CUDA')
+    def test_serialization_async_cuda(self):
+        self._test_serialization_async(lambda n: torch.randn(n).cuda())
+
+    @unittest.skipIf(IS_WINDOWS, "the file is opened twice, which isn't supported on Windows")
+    def test_serialization_mmap(self):
+        a = torch.randn(5, 5)
+        b = torch.arange(0, 10).int()
+        obj = [a, a[1], b, a.storage()[2:5]]
+        with tempfile.NamedTemporaryFile() as f:
+            torch.save(obj, f)
+            f.flush()
+            c = torch.load(f.name, mmap=True)
+            self.assertEqual(obj, c, 0)
+            self.assertEqual(c[0].storage().data_ptr(), c[1].storage().data_ptr())
+            self.assertEqual(c[3].data_ptr(), c[0].storage().data_ptr() + 2 * a.element_size())
+            self.assertEqual(c[0].data_ptr() % 64, 0)
+            self.assertEqual(c[2].data_ptr() % 64, 0)
+
+            # the mapping is private
+            c[0].fill_(1)
+            self.assertEqual(torch.load(f.name, mmap=True)[0], a, 0)
+
+            # mapped storages are saved on their own
+            buf = io.BytesIO()
+            torch.save(c[2], buf)
+            self.assertLess(len(buf.getvalue()), 1024)
+            buf.seek(0)
+            self.assertEqual(torch.load(buf), b, 0)
+
+        # checkpoints at an unaligned offset are read as usual
+        with tempfile.NamedTemporaryFile() as f:
+            f.write(b'x')
+            torch.save(a, f)
+            f.flush()
+            f.seek(1)
+            self.assertEqual(torch.load(f, mmap=True), a, 0)
+
     def test_half_tensor(self):
         x = torch.randn(5, 5).float()
         y = torch.randn(5, 5).float()
@@ -6636,6 +7058,7 @@ class TestTorch(TestCase):
     def test_toNumpy(self):
         types = [
             'torch.ByteTensor',
+            'torch.CharTensor',
             'torch.IntTensor',
             'torch.HalfTensor',
             'torch.FloatTensor',
@@ -6721,12 +7144,34 @@ class TestTorch(TestCase):
         z = from_dlpack(to_dlpack(x))
         self.assertEqual(z, x)
 
+    def test_dlpack_noncontiguous(self):
+        x = torch.randn(4, 6, 5)[:, 1::2].transpose(0, 2)
+        z = from_dlpack(to_dlpack(x))
+        self.assertEqual(z, x)
+        self.assertEqual(z.stride(), x.stride())
+        z.fill_(1)
+        self.assertEqual(x, torch.ones(x.size()))
+        # a capsule that is never consumed is freed with its tensor
+        to_dlpack(x)
+
     @unittest.skipIf(not torch.cuda.is_available(), "No CUDA")
     def test_dlpack_cuda(self):
         x = torch.randn(1, 2, 3, 4).cuda()
         z = from_dlpack(to_dlpack(x))
         self.assertEqual(z, x)
 
+    @unittest.skipIf(not torch.cuda.is_available(), "No CUDA")
+    def test_dlpack_cuda_stream(self):
+        stream = torch.cuda.Stream()
+        x = torch.randn(100, 100, device='cuda').t()
+        y = x.mm(x)
+        capsule = to_dlpack(y, stream.cuda_stream)
+        with torch.cuda.stream(stream):
+            z = from_dlpack(capsule)
+            w = z * 2
+        v = from_dlpack(to_dlpack(w), stream.cuda_stream)
+        self.assertEqual(v, y * 2)
+
     @unittest.skipIf(not TEST_NUMPY, "Numpy not found")
     def test_from_numpy(self):
         dtypes = [
@@ -6736,6 +7181,7 @@ class TestTorch(TestCase):
             np.int64,
             np.int32,
             np.int16,
+            np.int8,
             np.uint8,
             np.longlong,
         ]
@@ -6776,6 +7222,12 @@ class TestTorch(TestCase):
         x.strides = (3,)
         self.assertRaises(ValueError, lambda: torch.from_numpy(x))
 
+        # check negative strides and non-native byte orders raise exception
+        x = np.array([3., 5., 8.])
+        self.assertRaises(ValueError, lambda: torch.from_numpy(x[::-1]))
+        x = np.array([3., 5., 8.], dtype=np.dtype(np.float64).newbyteorder())
+        self.assertRaises(ValueError, lambda: torch.from_numpy(x))
+
     @unittest.skipIf(not TEST_NUMPY, "Numpy not found")
     def test_ctor_with_numpy_array(self):
         dtypes = [
@@ -7141,6 +7593,38 @@ class TestTorch(TestCase):
         self.assertEqual(torch.ByteTensor([7, 42, 128, 133]), byte_unique)
         self.assertEqual(torch.LongTensor([3, 0, 0, 0, 1, 2]), byte_inverse)
 
+        x_unique, x_counts = x.unique(sorted=True, return_counts=True)
+        self.assertEqual(expected_unique, x_unique)
+        self.assertEqual(torch.LongTensor([1, 3, 2, 1, 1]), x_counts)
+
+        x_unique, x_inverse, x_counts = torch.unique(
+            x, sorted=True, return_inverse=True, return_counts=True)
+        self.assertEqual(expected_unique, x_unique)
+        self.assertEqual(expected_inverse, x_inverse)
+        self.assertEqual(torch.LongTensor([1, 3, 2, 1, 1]), x_counts)
+
+    def test_unique_large(self):
+        # large inputs are radix sorted instead of hashed
+        for t in [torch.LongTensor, torch.IntTensor, torch.CharTensor, torch.DoubleTensor, torch.FloatTensor]:
+            x = t(20000).random_(-100, 100)
+            if x.is_floating_point():
+                x /= 7
+            expected = sorted(set(x.tolist()))
+            x_unique, x_inverse, x_counts = x.unique(return_inverse=True, return_counts=True)
+            self.assertEqual(expected, x_unique.tolist())
+            self.assertEqual(x, x_unique[x_inverse])
+            self.assertEqual([x.tolist().count(v) for v in expected], x_counts.tolist())
+
+        x = torch.DoubleTensor([0.0, -0.0, -1.5, 2.0] * 2000)
+        x_unique, x_counts = x.unique(sorted=True, return_counts=True)
+        self.assertEqual(torch.DoubleTensor([-1.5, 0.0, 2.0]), x_unique)
+        self.assertEqual(torch.LongTensor([2000, 4000, 2000]), x_counts)
+
+        x = torch.LongTensor([-2 ** 62, 2 ** 62, 0] * 2000).view(2, 3, 1000)
+        x_unique, x_inverse = x.unique(return_inverse=True)
+        self.assertEqual(torch.LongTensor([-2 ** 62, 0, 2 ** 62]), x_unique)
+        self.assertEqual(x, x_unique[x_inverse])
+
     @unittest.skipIf(not torch.cuda.is_available(), 'no CUDA')
     def test_unique_cuda(self):
         # unique currently does not support CUDA.
@@ -228,6 +228,38 @@ class TestCheckpoint(TestCase):
             self.assertEqual(grad_checkpointed[name], grad_not_checkpointed[name])
 
 
+    def test_checkpoint_rng_state(self):
+        model = nn.Sequential(
+            nn.Linear(20, 20),
+            nn.Dropout(0.5),
+            nn.Linear(20, 5)
+        )
+        x = torch.randn(4, 20, requires_grad=True)
+
+        torch.manual_seed(0)
+        model(x).sum().backward()
+        input_grad = x.grad.data.clone()
+        weight_grad = model[0].weight.grad.data.clone()
+
+        model.zero_grad()
+        x.grad.data.zero_()
+        torch.manual_seed(0)
+        out = checkpoint(model, x)
+        rng_state = torch.get_rng_state()
+        out.sum().backward()
+        # dropout drops the same elements in the recomputation, which leaves
+        # the generator as it was
+        self.assertEqual(x.grad, input_grad)
+        self.assertEqual(model[0].weight.grad, weight_grad)
+        self.assertEqual(torch.get_rng_state(), rng_state)
+
+    def test_checkpoint_tuple_outputs(self):
+        x = torch.randn(3, 4, requires_grad=True)
+        a, b = checkpoint(lambda x: (x * 2, x.exp()), x)
+        (a + b).sum().backward()
+        self.assertEqual(x.grad, 2 + x.exp())
+
+
 class TestDataLoader(TestCase):
     def setUp(self):
         self.dataset = torch.randn(5, 3, 3, 2)
@@ -21,6 +21,8 @@ SKIP_PYTHON_BINDINGS = [
     'sparse_coo_tensor', '_arange.*', '_range.*', '_linspace.*', '_logspace.*',
     '_indexCopy_', 'max_values', 'min_values', 'argmax', 'argmin',
     '_cumsum.*', '_cumprod.*', '_sum.*', '_prod.*', '_th_sum.*', '_th_prod.*',
+    '_th_lerp.*', '_th_addcmul.*', '_th_addcdiv.*', '_th_mean.*', '_th_var.*', '_th_std.*',
+    '_th_bmm.*',
     'arange.*', 'range.*', '_gesv.*',
 ]
 
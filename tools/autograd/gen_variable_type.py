@@ -67,6 +67,26 @@ DONT_REQUIRE_DERIVATIVE = {
     # These are only implemented on integral types
     '__and__', '__iand__', '__ilshift__', '__ior__', '__irshift__', '__ixor__',
     '__lshift__', '__or__', '__rshift__', '__xor__',
+    # The batch statistics of inplace_abn_ are constants of its backward
+    '_inplace_abn_stats',
+    # The tables and the samples of the alias method are not differentiable
+    '_multinomial_alias_setup', '_multinomial_alias_draw',
+}
+
+# Ops run in fp16 under autocast (see autocast_mode.h): they are fast on the
+# tensor cores and safe in half precision.
+AUTOCAST_FP16 = {
+    'mm', 'addmm', 'bmm', 'baddbmm', 'addbmm', 'mv', 'addmv', 'addr', 'matmul',
+    '_convolution',
+}
+
+# Ops run in fp32 under autocast: reductions, softmax and losses, which need
+# the range or precision of fp32, and functions whose results overflow half.
+AUTOCAST_FP32 = {
+    'sum', 'prod', 'mean', 'norm', 'var', 'std', 'cumsum', 'dist',
+    'softmax', 'log_softmax', 'layer_norm', 'group_norm',
+    'mse_loss', 'l1_loss', 'smooth_l1_loss', 'binary_cross_entropy', 'kl_div',
+    'nll_loss', 'exp', 'log', 'pow', 'softplus',
 }
 
 METHOD_DECLARATION = CodeTemplate("""\
@@ -93,7 +113,7 @@ if (compute_requires_grad( ${args_with_derivatives} )) {
 """)
 
 ASSIGN_GRAD_FN = CodeTemplate("""\
-grad_fn = std::shared_ptr<${op}>(new ${op}(${op_ctor}), deleteFunction);
+grad_fn = make_function<${op}>(${op_ctor});
 grad_fn->set_next_edges(collect_next_edges( ${args_with_derivatives} ));
 """)
 
@@ -113,8 +133,18 @@ if (${cond}) {
 }
 """)
 
+AUTOCAST = CodeTemplate("""\
+if (AutocastMode::is_enabled() && autocast::any_castable(ScalarType::${scalar_type}, ${tensor_args})) {
+  ${casts}
+  return ${dispatch_arg}.type().${method_prefix_derived}${api_name}(${cast_args});
+}
+""")
+
+AUTOCAST_ARG = CodeTemplate("""\
+auto ${arg_name}_cast = autocast::cast(ScalarType::${scalar_type}, ${arg_name});""")
+
 RECORD_FUNCTION = CodeTemplate("""\
-profiler::RecordFunction profiler("${name}");""")
+profiler::RecordFunction profiler("${name}"${profiler_inputs});""")
 
 PRE_RECORD_TRACE = CodeTemplate("""\
 jit::tracer::PreTraceInfo trace_info;
@@ -190,6 +220,30 @@ def gen_variable_type(out, aten_declarations):
     write(out, 'VariableType.cpp', VARIABLE_TYPE_CPP, env)
 
 
+def emit_autocast(declaration):
+    """Casts the arguments of ops in AUTOCAST_FP16 and AUTOCAST_FP32 and
+    dispatches again on the type of the first one; the casted arguments
+    are not castable anymore, so the second dispatch runs the op itself"""
+    name = declaration['name']
+    if declaration['inplace'] or name.endswith('_out'):
+        return []
+    if name in AUTOCAST_FP16:
+        scalar_type = 'Half'
+    elif name in AUTOCAST_FP32:
+        scalar_type = 'Float'
+    else:
+        return []
+    arguments = [arg for arg in declaration['arguments'] if not arg.get('is_type_dispatched')]
+    tensor_args = [arg['name'] for arg in arguments if arg['simple_type'] == 'Tensor']
+    if len(tensor_args) == 0 or any(arg['simple_type'] in {'TensorList', 'SparseTensor'} for arg in arguments):
+        return []
+    casts = [AUTOCAST_ARG.substitute(arg_name=arg, scalar_type=scalar_type) for arg in tensor_args]
+    cast_args = [arg['name'] + '_cast' if arg['name'] in tensor_args else arg['name'] for arg in arguments]
+    return [AUTOCAST.substitute(declaration, scalar_type=scalar_type, tensor_args=tensor_args,
+                                casts=casts, dispatch_arg=tensor_args[0] + '_cast',
+                                cast_args=cast_args)]
+
+
 def emit_method_definition(declaration):
     body = emit_body(declaration)
     return METHOD_DEFINITION.substitute(declaration, type_definition_body=body)
@@ -465,9 +519,11 @@ def emit_body(declaration):
     def emit_history():
         fn = 'rebase' if modifies_arguments and not is_view else 'set'
         output_names = [r['name'] for r in differentiable_outputs]
-        # TODO: flatten allocates a std::vector, which could be expensive
+        # flatten allocates a std::vector, and without a grad_fn (no input
+        # requires grad, or grad mode is disabled) there is no history to set
         outs = CodeTemplate("flatten( ${outs} )").substitute(outs=output_names)
-        return SET_HISTORY.substitute(fn=fn, differentiable_outputs=outs)
+        return CONDITIONAL.substitute(cond='grad_fn', statements=[
+            SET_HISTORY.substitute(fn=fn, differentiable_outputs=outs)])
 
     def emit_save_outputs():
         if is_out_fn:
@@ -495,7 +551,11 @@ def emit_body(declaration):
     combined = nested_dict(env, declaration)
 
     body = []
+    body.extend(emit_autocast(declaration))
     if base_name not in DONT_PROFILE:
+        # input shapes are recorded when profiling with record_shapes=True
+        profiler_inputs = [arg['name'] for arg in arguments if arg['simple_type'] in {'Tensor', 'TensorList'}]
+        env['profiler_inputs'] = ''.join(', ' + name for name in profiler_inputs)
         body.append(RECORD_FUNCTION.substitute(combined))
     if strategy != 'use_type':
         body.extend(unpack_args(env, declaration))
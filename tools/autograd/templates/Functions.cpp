@@ -1,6 +1,7 @@
 #include "Functions.h"
 #include <ATen/WrapDimUtils.h>
 #include <ATen/WrapDimUtilsMulti.h>
+#include "torch/csrc/autograd/grad_mode.h"
 
 // define constants like M_PI and C keywords for MSVC
 #ifdef _MSC_VER
@@ -427,6 +428,20 @@ Tensor mm_mat2_backward(const Tensor & grad, const Tensor & mat1, IntList sizes,
   }
 }
 
+// values[p] is the entry at (row(p), col_indices[p]), so its gradient is the
+// dot product of the matching rows of grad and dense
+Tensor csr_addmm_values_backward(const Tensor & grad, const Tensor & crow_indices, const Tensor & col_indices, const Tensor & dense, const Scalar & alpha) {
+  auto rows = at::_csr_row_indices(crow_indices);
+  auto dots = (grad.index_select(0, rows) * dense.index_select(0, col_indices)).sum(1);
+  return maybe_multiply(dots, alpha);
+}
+
+Tensor csr_addmm_dense_backward(const Tensor & grad, const Tensor & crow_indices, const Tensor & col_indices, const Tensor & values, int64_t dense_rows, const Scalar & alpha) {
+  Tensor crow_t, col_t, positions;
+  std::tie(crow_t, col_t, positions) = at::_csr_transpose(crow_indices, col_indices, dense_rows);
+  return maybe_multiply(at::_csr_mm(crow_t, col_t, values.index_select(0, positions), grad), alpha);
+}
+
 Tensor renorm_backward(const Tensor & grad, const Tensor & self, Scalar p, int64_t dim, Scalar maxnorm) {
   auto transposed_sizes = std::vector<int64_t>(self.transpose(dim, 0).sizes());
   auto flatten = [&](const Tensor & t) {
@@ -684,6 +699,24 @@ Tensor log_softmax_double_backward(const Tensor & grad, const Tensor & grad_outp
   return z * grad_output.sum(dim, true) * ((grad * z).sum(dim, true) - grad);
 }
 
+// The fused backward is not differentiable, so when the graph of the backward
+// is recorded (create_graph=True) it is computed as the backward of
+// nll_loss(log_softmax(self, 1)) instead
+Tensor log_softmax_nll_loss_backward(const Tensor & grad, const Tensor & self, const Tensor & target, const Tensor & weight, bool size_average, int64_t ignore_index, bool reduce, double label_smoothing, const Tensor & logsumexp, const Tensor & total_weight) {
+  if (!GradMode::is_enabled()) {
+    return at::_log_softmax_nll_loss_backward(grad, self, target, weight, size_average, ignore_index, reduce, label_smoothing, logsumexp, total_weight);
+  }
+  auto output = at::log_softmax(self, 1);
+  auto grad_output = at::nll_loss_backward(grad, output, target, weight, size_average, ignore_index, reduce, total_weight);
+  if (label_smoothing != 0) {
+    // Each row of the nll_loss gradient only holds -grad * weight[target] at
+    // the target, which the smoothing spreads by eps / C over all the classes
+    grad_output = grad_output * (1 - label_smoothing) +
+                  grad_output.sum(1, true) * (label_smoothing / self.size(1));
+  }
+  return at::log_softmax_backward_data(grad_output, output, 1, self);
+}
+
 Tensor l1_loss_double_backward_grad_output(const Tensor & grad, const Tensor & input, const Tensor & target, bool size_average, bool reduce) {
   auto output = l1_loss_backward(grad, input, target, size_average, false);
   if (reduce and size_average) {
@@ -1307,6 +1340,130 @@ std::tuple<Tensor, Tensor, Tensor> batchnorm_double_backward(
 
 }
 
+// The output of inplace_abn_ overwrites its input, so the normalized input is
+// reconstructed from it: leaky_relu with the inverse slope undoes the
+// activation (the slope keeps the sign), and the affine transform is undone
+// with weight and bias.
+std::tuple<Tensor, Tensor, Tensor> inplace_abn_backward(
+    const Tensor & grad,
+    const Tensor & output,
+    const Tensor & weight,
+    const Tensor & bias,
+    const Tensor & invstd,
+    bool training,
+    double negative_slope,
+    std::array<bool,3> output_mask) {
+  if (!grad.defined()) {
+    return std::tuple<Tensor, Tensor, Tensor>();
+  }
+  auto y = at::leaky_relu(output, 1. / negative_slope);
+  if (bias.defined()) {
+    y = y - unsqueeze_dim1(bias, output);
+  }
+  auto x_hat = weight.defined() ? y / unsqueeze_dim1(weight, output) : y;
+  auto gY = leaky_relu_backward(grad, output, negative_slope);
+
+  Tensor gI, gW, gB;
+  if (output_mask[0]) {
+    auto g = (weight.defined() ? gY * unsqueeze_dim1(weight, output) : gY) *
+             unsqueeze_dim1(invstd, output);
+    if (training) {
+      auto M = output.numel() / output.size(1);
+      gI = g - sum_exclude_dim1(g).div_(M) - x_hat * sum_exclude_dim1(g * x_hat).div_(M);
+    } else {
+      gI = g;
+    }
+  }
+  if (output_mask[1] && weight.defined()) {
+    gW = sum_exclude_dim1(gY * x_hat, false);
+  }
+  if (output_mask[2] && bias.defined()) {
+    gB = sum_exclude_dim1(gY, false);
+  }
+  return std::tuple<Tensor, Tensor, Tensor>{gI, gW, gB};
+}
+
+// Helper for layer_norm_backward and group_norm_backward: x is normalized
+// over its rows; given g, the gradient of the normalized x, returns the
+// normalized x and the gradient of x, computed with differentiable ops
+std::tuple<Tensor, Tensor> normalize_rows_double_backward(
+    const Tensor& g, const Tensor& x, double eps) {
+  auto x_mu = x - x.mean(1, true);
+  auto rstd = (x_mu.pow(2).mean(1, true) + eps).rsqrt();
+  auto x_hat = x_mu * rstd;
+  auto gI = rstd * (g - g.mean(1, true) - x_hat * (g * x_hat).mean(1, true));
+  return std::tuple<Tensor, Tensor>{x_hat, gI};
+}
+
+// The fused kernels only compute the gradients, so when the graph of the
+// backward is recorded (create_graph=True) the gradients are recomputed with
+// differentiable ops instead
+std::tuple<Tensor, Tensor, Tensor> layer_norm_backward(
+    const Tensor& grad, const Tensor& input, IntList normalized_shape,
+    const Tensor& mean, const Tensor& rstd, const Tensor& weight, double eps,
+    std::array<bool, 3> output_mask) {
+  if (!grad.defined()) {
+    return std::tuple<Tensor, Tensor, Tensor>();
+  }
+  if (!GradMode::is_enabled()) {
+    return at::_layer_norm_backward(grad, input, normalized_shape, mean, rstd,
+                                    weight, output_mask);
+  }
+  int64_t N = 1;
+  for (auto size : normalized_shape) {
+    N *= size;
+  }
+  int64_t M = N == 0 ? 0 : input.numel() / N;
+  auto x = input.contiguous().view({M, N});
+  auto gO = grad.contiguous().view({M, N});
+  auto g = weight.defined() ? gO * weight.contiguous().view({1, N}) : gO;
+  Tensor x_hat, gI, gG, gB;
+  std::tie(x_hat, gI) = normalize_rows_double_backward(g, x, eps);
+  if (output_mask[0]) {
+    gI = gI.view(input.sizes());
+  } else {
+    gI = Tensor();
+  }
+  if (output_mask[1]) {
+    gG = (gO * x_hat).sum(0).view(normalized_shape);
+  }
+  if (output_mask[2]) {
+    gB = gO.sum(0).view(normalized_shape);
+  }
+  return std::tuple<Tensor, Tensor, Tensor>{gI, gG, gB};
+}
+
+std::tuple<Tensor, Tensor, Tensor> group_norm_backward(
+    const Tensor& grad, const Tensor& input, const Tensor& mean,
+    const Tensor& rstd, const Tensor& weight, int64_t N, int64_t C,
+    int64_t HxW, int64_t group, double eps, std::array<bool, 3> output_mask) {
+  if (!grad.defined()) {
+    return std::tuple<Tensor, Tensor, Tensor>();
+  }
+  if (!GradMode::is_enabled()) {
+    return at::_group_norm_backward(grad, input, mean, rstd, weight, N, C, HxW,
+                                    group, output_mask);
+  }
+  int64_t D = C / group * HxW;
+  auto x = input.contiguous().view({N * group, D});
+  auto gO = grad.contiguous().view({N, C, HxW});
+  auto g = weight.defined() ? gO * weight.contiguous().view({1, C, 1}) : gO;
+  Tensor x_hat, gI, gG, gB;
+  std::tie(x_hat, gI) = normalize_rows_double_backward(g.view({N * group, D}), x, eps);
+  if (output_mask[0]) {
+    gI = gI.view(input.sizes());
+  } else {
+    gI = Tensor();
+  }
+  if (output_mask[1]) {
+    gG = (gO * x_hat.view({N, C, HxW})).sum(2).sum(0);
+  }
+  if (output_mask[2]) {
+    gB = gO.sum(2).sum(0);
+  }
+  return std::tuple<Tensor, Tensor, Tensor>{gI, gG, gB};
+}
+
 std::tuple<Tensor, Tensor, Tensor> _trilinear_backward(const Tensor& grad_out, const Tensor& i1, const Tensor& i2, const Tensor& i3,
 						       IntList expand1, IntList expand2, IntList expand3,
 						       IntList sumdim, int64_t unroll_dim, std::array<bool, 3> grad_mask) {
@@ -3,6 +3,7 @@
 // ${generated_comment}
 
 #include "torch/csrc/autograd/variable.h"
+#include "torch/csrc/autograd/autocast_mode.h"
 #include "torch/csrc/autograd/function.h"
 #include "torch/csrc/autograd/edge.h"
 #include "torch/csrc/autograd/grad_mode.h"
@@ -288,7 +289,7 @@ std::tuple<Tensors...> as_variable_impl(
   // constructions. This turns into (boolean omitted):
   // Variable(std::get<0>(tensors)), Variable(std::get<1>(tensors)), ...
   return std::tuple<Tensors...>(
-      as_variable(std::get<Is>(tensors))...);
+      as_variable(std::move(std::get<Is>(tensors)))...);
 }
 
 // NB: Because this was not forward declared, recursive std::tuple won't work.
@@ -300,7 +301,8 @@ std::tuple<Tensors...> as_variable(std::tuple<Tensors...> tensors) {
   // expand into an Indices object containing the numbers 0 to
   // sizeof...(Tensors) - 1.
   return as_variable_impl(
-      tensors, typename MakeIndices<sizeof...(Tensors)>::indices());
+      std::move(tensors),
+      typename MakeIndices<sizeof...(Tensors)>::indices());
 }
 
 static Tensor as_view(const Tensor & base, Tensor tensor) {
@@ -341,6 +343,12 @@ static void check_no_requires_grad(const Tensor& tensor, const char* name) {
   }
 }
 
+static void check_no_requires_grad(TensorList tensors, const char* name) {
+  for (auto& tensor : tensors) {
+    check_no_requires_grad(tensor, name);
+  }
+}
+
 static void check_inplace(const Tensor& tensor) {
   auto& var = static_cast<const Variable&>(tensor);
   if (var.requires_grad() && var.is_leaf() && GradMode::is_enabled()) {
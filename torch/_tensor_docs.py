@@ -983,16 +983,21 @@ Example::
 
 add_docstr_all('index_put_',
                r"""
-index_put_(indices, value) -> Tensor
+index_put_(indices, value, accumulate=False) -> Tensor
 
 Puts values from the tensor :attr:`value` into the tensor :attr:`self` using
 the indices specified in :attr:`indices` (which is a tuple of Tensors). The
 expression ``tensor.index_put_(indices, value)`` is equivalent to
 ``tensor[indices] = value``. Returns :attr:`self`.
 
+If :attr:`accumulate` is ``True``, the elements in :attr:`value` are added to
+:attr:`self` instead, and values for repeated indices all add up, like
+``tensor[indices] += value`` would if the indices were unique.
+
 Args:
     indices (tuple of LongTensor): tensors used to index into `self`.
     value (Tensor): tensor of same dtype as `self`.
+    accumulate (bool): whether to accumulate into `self`
 """)
 
 add_docstr_all('index_select',
@@ -1016,6 +1021,15 @@ is_contiguous() -> bool
 Returns True if :attr:`self` tensor is contiguous in memory in C order.
 """)
 
+add_docstr_all('is_channels_last',
+               r"""
+is_channels_last() -> bool
+
+Returns True if the 4-d :attr:`self` tensor is laid out in memory as a
+contiguous (N, H, W, C) tensor, but not as a contiguous (N, C, H, W) one. See
+:meth:`~Tensor.channels_last_contiguous`.
+""")
+
 add_docstr_all('is_set_to',
                r"""
 is_set_to(tensor) -> bool
@@ -2398,6 +2412,19 @@ matmul(tensor2) -> Tensor
 See :func:`torch.matmul`
 """)
 
+add_docstr_all('channels_last_contiguous',
+               r"""
+channels_last_contiguous() -> Tensor
+
+Returns a tensor with the same data and size as the 4-d :attr:`self` tensor,
+laid out in memory as a contiguous (N, H, W, C) tensor. If :attr:`self` is
+already in this channels-last format, this function returns :attr:`self`.
+
+On the CPU, batch normalization, 2D max pooling and 2D average pooling of
+channels-last tensors run on this layout directly, and return channels-last
+tensors.
+""")
+
 add_docstr_all('chunk',
                r"""
 chunk(chunks, dim=0) -> List of Tensors
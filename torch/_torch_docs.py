@@ -692,6 +692,36 @@ Example::
              -0.5790,  0.1497]])
 """)
 
+add_docstr(torch.cdist,
+           r"""
+cdist(x1, x2, p=2) -> Tensor
+
+Computes the p-norm distance between each pair of rows of :attr:`x1` and
+:attr:`x2`. If :attr:`x1` has shape :math:`N \times D` and :attr:`x2` has
+shape :math:`M \times D`, the result has shape :math:`N \times M`.
+
+For :math:`p = 2` the distances are computed with a matrix multiplication,
+as :math:`\sqrt{\|x\|^2 + \|y\|^2 - 2 x y^T}`. Other norms are computed
+directly, for chunks of rows of :attr:`x1`, so that the
+:math:`N \times M \times D` differences are never held in memory at once.
+
+Args:
+    x1 (Tensor): input tensor of shape :math:`N \times D`
+    x2 (Tensor): input tensor of shape :math:`M \times D`
+    p (float, optional): the norm to be computed, between 0 and :math:`\infty`
+
+Example::
+
+    >>> a = torch.tensor([[0., 0.], [3., 4.]])
+    >>> b = torch.tensor([[0., 0.], [1., 0.], [0., 4.]])
+    >>> torch.cdist(a, b)
+    tensor([[ 0.0000,  1.0000,  4.0000],
+            [ 5.0000,  4.4721,  3.0000]])
+    >>> torch.cdist(a, b, 1)
+    tensor([[ 0.,  1.,  4.],
+            [ 7.,  6.,  3.]])
+""")
+
 add_docstr(torch.ceil,
            r"""
 ceil(input, out=None) -> Tensor
@@ -1888,15 +1918,23 @@ add_docstr(torch.inverse,
            r"""
 inverse(input, out=None) -> Tensor
 
-Takes the inverse of the square matrix :attr:`input`.
+Takes the inverse of the square matrix :attr:`input`. :attr:`input` can also
+be a batch of square matrices, in which case the inverse of each matrix of the
+batch is returned.
 
 .. note::
 
     Irrespective of the original strides, the returned matrix will be
-    transposed, i.e. with strides `(1, m)` instead of `(m, 1)`
+    transposed, i.e. with strides `(1, m)` instead of `(m, 1)`. This doesn't
+    apply to batches, whose results are contiguous.
+
+.. note::
+
+    `out` is only supported for 2-D inputs.
 
 Args:
-    input (Tensor): the input 2-D square tensor
+    input (Tensor): the input 2-D square tensor or batch of square matrices
+        of size `(*, m, m)`
     out (Tensor, optional): the optional output tensor
 
 Example::
@@ -3062,8 +3100,13 @@ the decomposition has the form:
 
     A = LL^T
 
+:attr:`a` can also be a batch of such matrices of size `(*, n, n)`, in which
+case the decomposition of each matrix of the batch is returned; `out` is only
+supported for 2-D inputs.
+
 Args:
-    a (Tensor): the input 2-D tensor, a symmetric positive-definite matrix
+    a (Tensor): the input 2-D tensor, a symmetric positive-definite matrix,
+        or a batch of them
     upper (bool, optional): flag that indicates whether to return the
                             upper or lower triangular matrix
     out (Tensor, optional): the output matrix
@@ -183,6 +183,52 @@ def _unflatten_dense_tensors(flat, tensors):
     return tuple(outputs)
 
 
+def _flat_dense_buffer(tensors):
+    """Allocate a zero-filled contiguous 1D buffer large enough to hold dense
+    tensors, together with views into it shaped like each of them. Assume that
+    tensors are of same dense type.
+
+    Unlike the result of _flatten_dense_tensors, the buffer never aliases the
+    inputs and is meant to be kept around: writes to the views are visible in
+    the buffer and vice versa, so no flatten or unflatten copy is needed.
+
+    Arguments:
+        tensors (Iterable[Tensor]): dense tensors whose sizes will be used to
+          lay out the buffer.
+
+    Returns:
+        A tuple of the buffer and of its views with sizes same as tensors.
+    """
+    flat = tensors[0].new(sum(t.numel() for t in tensors)).zero_()
+    return flat, _unflatten_dense_tensors(flat, tensors)
+
+
+def _bind_grads_to_views(params, views):
+    """Make the ``.grad`` of each parameter the corresponding view (as returned
+    by _flat_dense_buffer), keeping any gradient it already has. Gradients
+    accumulated by autograd then land in the buffer directly.
+
+    Arguments:
+        params (Iterable[Tensor]): parameters whose gradients to bind.
+        views (Iterable[Tensor]): views of the same sizes as params.
+
+    Returns:
+        True if all gradients were already bound.
+    """
+    bound = True
+    for param, view in zip(params, views):
+        grad = param.grad
+        if grad is not None and grad.data_ptr() == view.data_ptr():
+            continue
+        if grad is not None:
+            view.copy_(grad.data)
+        else:
+            view.zero_()
+        param.grad = view
+        bound = False
+    return bound
+
+
 def _unflatten_sparse_tensors(flat, tensors):
     """View flat buffer (containing indices and values) using the sizes of
     tensors. Assume that tensors are of same sparse type, and that flat is given
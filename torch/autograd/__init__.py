@@ -11,6 +11,7 @@ from .variable import Variable
 from .function import Function, NestedIOFunction
 from .gradcheck import gradcheck
 from .grad_mode import no_grad, enable_grad, set_grad_enabled
+from .saved_tensors import offload_saved_tensors, compress_saved_tensors
 from . import profiler
 
 __all__ = ['Variable', 'Function', 'backward', 'grad_mode']
@@ -162,6 +163,38 @@ def _is_checkpoint_valid():
     return Variable._execution_engine.is_checkpoint_valid()
 
 
+def set_num_cpu_workers(num_workers):
+    r"""Sets the number of threads that run the CPU part of backward passes.
+
+    With more than one worker, functions of the graph that do not depend on
+    each other (e.g. the branches of a multi-tower model) are run in parallel.
+    The workers are started by the first backward pass, so this has to be
+    called before it. The default is the value of the
+    ``TORCH_AUTOGRAD_CPU_WORKERS`` environment variable, or 1.
+
+    Arguments:
+        num_workers (int): the number of CPU worker threads
+    """
+    Variable._execution_engine.set_num_cpu_workers(num_workers)
+
+
+def get_num_cpu_workers():
+    r"""Returns the number of threads that run the CPU part of backward passes.
+    See :func:`set_num_cpu_workers`."""
+    return Variable._execution_engine.get_num_cpu_workers()
+
+
+def last_backward_peak_memory():
+    r"""Returns the largest number of bytes of gradients held at once by the
+    last backward pass started from the current thread.
+
+    This counts the gradients waiting to be passed to a function of the graph,
+    and those of the functions being run. It does not include ``.grad`` of
+    leaf tensors nor the tensors saved for backward.
+    """
+    return Variable._execution_engine.last_peak_grad_bytes()
+
+
 def variable(*args, **kwargs):
     warnings.warn("torch.autograd.variable(...) is deprecated, use torch.tensor(...) instead")
     return torch.tensor(*args, **kwargs)
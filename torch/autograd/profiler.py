@@ -106,15 +106,21 @@ class EventList(list):
 
             json.dump(chrome_events, f)
 
-    def key_averages(self):
+    def key_averages(self, group_by_input_shape=False):
         """Averages all function events over their keys.
 
+        Arguments:
+            group_by_input_shape (bool, optional): Averages calls with different
+                input shapes separately. Requires profiling with
+                ``record_shapes=True``. Default: ``False``
+
         Returns:
             An EventList containing FunctionEventAvg objects.
         """
         stats = defaultdict(FunctionEventAvg)
         for evt in self:
-            stats[evt.key] += evt
+            key = (evt.key, str(evt.input_shapes)) if group_by_input_shape else evt.key
+            stats[key] += evt
         return EventList(stats.values())
 
     def total_average(self):
@@ -142,6 +148,16 @@ class profile(object):
             Adds approximately 4us of overhead to each tensor operation.
             Default: ``False``
 
+        record_shapes (bool, optional): Records the shapes of the tensor inputs
+            of every operator, see ``FunctionEvent.input_shapes`` and
+            :meth:`key_averages`. Default: ``False``
+
+        profile_memory (bool, optional): Records the memory allocated (minus
+            the memory freed) by the CPU allocator and the CUDA caching
+            allocator in every operator, see ``FunctionEvent.cpu_memory_usage``
+            and ``FunctionEvent.cuda_memory_usage``. Memory is attributed to
+            the innermost operator only. Default: ``False``
+
     .. warning:
         This context managers should not be called recursively, i.e. at most one
         instance should be enabled at any given time.
@@ -166,9 +182,11 @@ class profile(object):
         N5torch8autograd5CloneE                        4.088us          0.000us
     """
 
-    def __init__(self, enabled=True, use_cuda=False):
+    def __init__(self, enabled=True, use_cuda=False, record_shapes=False, profile_memory=False):
         self.enabled = enabled
         self.use_cuda = use_cuda
+        self.record_shapes = record_shapes
+        self.profile_memory = profile_memory
         self.function_events = None
         if not self.enabled:
             return
@@ -182,14 +200,14 @@ class profile(object):
         self.entered = True
         profiler_kind = torch.autograd.ProfilerState.CUDA if self.use_cuda \
             else torch.autograd.ProfilerState.CPU
-        torch.autograd._enable_profiler(profiler_kind)
+        torch.autograd._enable_profiler(profiler_kind, self.record_shapes, self.profile_memory)
         return self
 
     def __exit__(self, exc_type, exc_val, exc_tb):
         if not self.enabled:
             return
-        records = torch.autograd._disable_profiler()
-        self.function_events = EventList(parse_cpu_trace(records))
+        self._records = torch.autograd._disable_profiler()
+        self.function_events = EventList(parse_cpu_trace(self._records))
         return False
 
     def __repr__(self):
@@ -213,12 +231,14 @@ class profile(object):
 
     def export_chrome_trace(self, path):
         self._check_finish()
-        return self.function_events.export_chrome_trace(path)
+        # The native writer doesn't go through FunctionEvents, which is much
+        # faster for long traces.
+        torch.autograd._export_chrome_trace(self._records, path)
     export_chrome_trace.__doc__ = EventList.export_chrome_trace.__doc__
 
-    def key_averages(self):
+    def key_averages(self, group_by_input_shape=False):
         self._check_finish()
-        return self.function_events.key_averages()
+        return self.function_events.key_averages(group_by_input_shape)
     key_averages.__doc__ = EventList.key_averages.__doc__
 
     def total_average(self):
@@ -227,6 +247,68 @@ class profile(object):
     total_average.__doc__ = EventList.total_average.__doc__
 
 
+class sampled_profile(object):
+    """Profiles one iteration out of every ``period``, so that it can be left on.
+
+    Call :meth:`step` at the end of every iteration. The profiler is only
+    enabled during sampled iterations; in all others, operations merely check
+    that it is disabled, so the overhead is negligible for large periods.
+
+    Arguments:
+        period (int): Number of iterations between two sampled iterations.
+        use_cuda (bool, optional): Same as for :class:`profile`.
+            Default: ``False``
+        on_trace (callable, optional): Called with the finished
+            :class:`profile` of every sampled iteration, e.g. to export it
+            with :meth:`profile.export_chrome_trace`. Default: ``None``
+
+    Example:
+        >>> with torch.autograd.profiler.sampled_profile(
+        ...         100, on_trace=lambda prof: print(prof.total_average())) as sampler:
+        ...     for input in data:
+        ...         model(input).sum().backward()
+        ...         sampler.step()
+    """
+
+    def __init__(self, period, use_cuda=False, on_trace=None):
+        if period < 1:
+            raise ValueError("period must be at least 1, but got {}".format(period))
+        self.period = period
+        self.use_cuda = use_cuda
+        self.on_trace = on_trace
+        self.iteration = 0
+        self.last_trace = None
+        self._current = None
+
+    def __enter__(self):
+        self._start()
+        return self
+
+    def __exit__(self, exc_type, exc_val, exc_tb):
+        self._stop()
+        return False
+
+    def step(self):
+        """Marks the end of an iteration."""
+        self._stop()
+        self.iteration += 1
+        self._start()
+
+    def _start(self):
+        if self.iteration % self.period == 0:
+            self._current = profile(use_cuda=self.use_cuda)
+            self._current.__enter__()
+
+    def _stop(self):
+        if self._current is None:
+            return
+        prof, self._current = self._current, None
+        prof.__exit__(None, None, None)
+        self.last_trace = prof
+        if self.on_trace is not None:
+            self.on_trace(prof)
+
+
 class emit_nvtx(object):
     """Context manager that makes every autograd operation emit an NVTX range.
 
@@ -298,6 +380,21 @@ def attr_formatter(name):
     return property(lambda self: format_time(getattr(self, name)))
 
 
+def format_memory(nbytes):
+    """Returns a formatted memory size string"""
+    KB = 1024.
+    MB = 1024. * KB
+    GB = 1024. * MB
+    if abs(nbytes) >= GB:
+        return '{:.2f} Gb'.format(nbytes / GB)
+    elif abs(nbytes) >= MB:
+        return '{:.2f} Mb'.format(nbytes / MB)
+    elif abs(nbytes) >= KB:
+        return '{:.2f} Kb'.format(nbytes / KB)
+    else:
+        return '{} b'.format(nbytes)
+
+
 class FormattedTimesMixin(object):
     """Helpers for FunctionEvent and FunctionEventAvg.
 
@@ -335,14 +432,24 @@ class Kernel(object):
 
 # TODO: record TID too
 class FunctionEvent(FormattedTimesMixin):
-    """Profiling information about a single function."""
-    def __init__(self, id, name, thread, cpu_start, cpu_end):
+    """Profiling information about a single function.
+
+    ``input_shapes`` is only filled in with ``record_shapes=True``, and
+    ``cpu_memory_usage`` and ``cuda_memory_usage`` (bytes allocated minus bytes
+    freed while this function was the innermost one running) with
+    ``profile_memory=True``.
+    """
+    def __init__(self, id, name, thread, cpu_start, cpu_end, input_shapes=None,
+                 cpu_memory_usage=0, cuda_memory_usage=0):
         self.id = id
         self.name = name
         self.cpu_interval = Interval(cpu_start, cpu_end)
         self.thread = thread
         self.kernels = []
         self.count = 1
+        self.input_shapes = input_shapes
+        self.cpu_memory_usage = cpu_memory_usage
+        self.cuda_memory_usage = cuda_memory_usage
 
     def append_kernel(self, name, device, start, end):
         self.kernels.append(Kernel(name, device, Interval(start, end)))
@@ -365,18 +472,30 @@ class FunctionEvent(FormattedTimesMixin):
 
 
 class FunctionEventAvg(FormattedTimesMixin):
-    """Used to average stats over multiple FunctionEvent objects."""
+    """Used to average stats over multiple FunctionEvent objects.
+
+    Memory usage is summed, not averaged. ``input_shapes`` is only set if all
+    averaged events had the same input shapes.
+    """
     def __init__(self):
         self.key = None
         self.count = self.cpu_time_total = self.cuda_time_total = 0
+        self.cpu_memory_usage = self.cuda_memory_usage = 0
+        self.input_shapes = None
 
     def __iadd__(self, other):
         if self.key is None:
             self.key = other.key
         assert isinstance(other, FunctionEvent)
         assert other.key == self.key
+        if self.count == 0:
+            self.input_shapes = other.input_shapes
+        elif self.input_shapes != other.input_shapes:
+            self.input_shapes = None
         self.cpu_time_total += other.cpu_time
         self.cuda_time_total += other.cuda_time
+        self.cpu_memory_usage += other.cpu_memory_usage
+        self.cuda_memory_usage += other.cuda_memory_usage
         self.count += 1
         return self
 
@@ -440,17 +559,25 @@ def parse_cpu_trace(thread_records):
     for record in itertools.chain(*thread_records):
         if record.kind() == 'mark':
             continue
+        elif record.kind() == 'memory':
+            # attributed to the innermost range; [cpu, cuda] bytes
+            if record_stack:
+                memory_usage = record_stack[-1][2]
+                memory_usage[0 if record.device() == -1 else 1] += record.memory_usage()
         elif record.kind() == 'push':
-            record_stack.append((next_id, record))
+            record_stack.append((next_id, record, [0, 0]))
             next_id += 1
         elif record.kind() == 'pop':
-            function_id, start = record_stack.pop()
+            function_id, start, memory_usage = record_stack.pop()
             fe = FunctionEvent(
                 id=function_id,
                 name=string_table[start.name()],
                 thread=start.thread_id(),
                 cpu_start=start_record.cpu_elapsed_us(start),
-                cpu_end=start_record.cpu_elapsed_us(record))
+                cpu_end=start_record.cpu_elapsed_us(record),
+                input_shapes=start.shapes() or None,
+                cpu_memory_usage=memory_usage[0],
+                cuda_memory_usage=memory_usage[1])
             if start.has_cuda():
                 cuda_start = adjusted_time(start)
                 cuda_end = adjusted_time(record)
@@ -548,12 +675,20 @@ def build_table(events, sort_by=None, header=None):
     if sort_by is not None:
         events = sorted(events, key=lambda evt: getattr(evt, sort_by))
 
+    # memory and shape columns are only shown if they were recorded
+    has_memory = any(evt.cpu_memory_usage or evt.cuda_memory_usage for evt in events)
+    has_shapes = any(evt.input_shapes for evt in events)
+    headers = ['Name', 'CPU time', 'CUDA time', 'Calls', 'CPU total', 'CUDA total']
+    if has_memory:
+        headers += ['CPU Mem', 'CUDA Mem']
+    num_columns = len(headers) - 1
+
     max_name_length = max(len(evt.key) for evt in events)
     max_name_length += 4  # Add some nice padding
     col_width = 15
     col_format = '  {: >' + str(col_width) + '}'
-    row_format = '{: <' + str(max_name_length) + '}' + col_format * 5
-    header_sep = '-' * max_name_length + ('  ' + '-' * col_width) * 5
+    row_format = '{: <' + str(max_name_length) + '}' + col_format * num_columns
+    header_sep = '-' * max_name_length + ('  ' + '-' * col_width) * num_columns
 
     # Have to use a list because nonlocal is Py3 only...
     result = ['']
@@ -564,14 +699,20 @@ def build_table(events, sort_by=None, header=None):
 
     # Actual printing
     if header is not None:
-        line_length = max_name_length + (col_width + 2) * 5
+        line_length = max_name_length + (col_width + 2) * num_columns
         append('=' * line_length)
         append(header)
     append(header_sep)
-    append(row_format.format('Name', 'CPU time', 'CUDA time', 'Calls', 'CPU total', 'CUDA total'))
+    append(row_format.format(*headers) + ('  Input Shapes' if has_shapes else ''))
     append(header_sep)
     for evt in events:
-        append(row_format.format(evt.key, evt.cpu_time_str, evt.cuda_time_str,
-                                 evt.count, evt.cpu_time_total_str, evt.cuda_time_total_str))
+        row = [evt.key, evt.cpu_time_str, evt.cuda_time_str,
+               evt.count, evt.cpu_time_total_str, evt.cuda_time_total_str]
+        if has_memory:
+            row += [format_memory(evt.cpu_memory_usage), format_memory(evt.cuda_memory_usage)]
+        line = row_format.format(*row)
+        if has_shapes and evt.input_shapes is not None:
+            line += '  ' + str(evt.input_shapes)
+        append(line)
 
     return result[0]
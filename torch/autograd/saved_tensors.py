@@ -0,0 +1,61 @@
+import torch
+
+
+class _saved_tensor_hooks(object):
+
+    def __init__(self, hooks):
+        self.hooks = hooks
+
+    def __enter__(self):
+        self.prev = torch.autograd._get_saved_tensor_hooks()
+        torch.autograd._set_saved_tensor_hooks(self.hooks)
+
+    def __exit__(self, *args):
+        torch.autograd._set_saved_tensor_hooks(self.prev)
+        return False
+
+
+class offload_saved_tensors(_saved_tensor_hooks):
+    r"""Context-manager that moves the tensors saved for backward to host memory.
+
+    The CUDA tensors of at least :attr:`min_bytes` saved by the operations
+    run inside it are copied to pinned host memory on a side stream, so they
+    don't hold device memory between the forward and the backward pass.
+    Backward copies them back as it needs them; when it needs one, the
+    :attr:`prefetch` tensors saved just before it are copied back ahead of
+    time. The saved tensors of an operation are saved on the thread running
+    it, so this only applies to the current thread.
+
+    Arguments:
+        min_bytes (int): size under which saved tensors stay on the device
+        prefetch (int): number of tensors copied back ahead of time
+
+    Example::
+
+        >>> with torch.autograd.offload_saved_tensors():
+        ...     loss = model(input).sum()
+        >>> loss.backward()
+    """
+
+    def __init__(self, min_bytes=1 << 20, prefetch=2):
+        super(offload_saved_tensors, self).__init__(
+            torch.autograd._OffloadHooks(min_bytes, prefetch))
+
+
+class compress_saved_tensors(_saved_tensor_hooks):
+    r"""Context-manager that compresses the tensors saved for backward.
+
+    The float and double tensors of at least :attr:`min_bytes` saved by the
+    operations run inside it are kept as half until backward, and the byte
+    tensors of at least :attr:`min_bytes` that only hold zeros and ones (masks)
+    as bits. Half loses precision, so the gradients are only approximately the
+    same as without it. Like :class:`offload_saved_tensors`, this only applies
+    to the current thread.
+
+    Arguments:
+        min_bytes (int): size under which saved tensors are kept as they are
+    """
+
+    def __init__(self, min_bytes=1 << 10):
+        super(compress_saved_tensors, self).__init__(
+            torch.autograd._CompressionHooks(min_bytes))
@@ -166,6 +166,29 @@ def flags(enabled=False, benchmark=False, deterministic=False, verbose=False):
             set_flags(orig_flags[0], orig_flags[1], orig_flags[2], orig_flags[3])
 
 
+def save_benchmark_cache(path):
+    r"""Writes the convolution algorithms found so far with ``benchmark=True``
+    to the file at ``path``.
+
+    The file can be loaded with :func:`load_benchmark_cache` by later runs,
+    or by other machines with the same GPUs and cuDNN version, to skip the
+    benchmarking. Setting the ``TORCH_CUDNN_BENCHMARK_CACHE`` environment
+    variable to the path of such a file loads it before the first
+    convolution.
+    """
+    torch._C._cudnn_save_benchmark_cache(path)
+
+
+def load_benchmark_cache(path):
+    r"""Adds the convolution algorithms of a file written by
+    :func:`save_benchmark_cache` to the cache, and returns how many were added.
+
+    Entries already in the cache are kept. A file written with another
+    version of cuDNN is ignored.
+    """
+    return torch._C._cudnn_load_benchmark_cache(path)
+
+
 class CuDNNHandle:
     def __init__(self):
         ptr = ctypes.c_void_p()
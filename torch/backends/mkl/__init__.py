@@ -4,3 +4,32 @@ import torch
 def is_available():
     r"""Returns whether PyTorch is built with MKL support."""
     return torch._C.has_mkl
+
+
+def fft_plan_cache_max_size():
+    r"""Returns the maximum number of MKL FFT descriptors kept by the plan
+    cache.
+
+    The FFT functions on CPU (e.g. :func:`torch.fft` and :func:`torch.stft`)
+    reuse the descriptor made for the same signal sizes, strides, batch size,
+    type, direction and normalization. The least recently used descriptors
+    are dropped first.
+    """
+    return torch._C._mkl_fft_get_plan_cache_max_size()
+
+
+def set_fft_plan_cache_max_size(max_size):
+    r"""Sets the maximum number of MKL FFT descriptors kept by the plan cache.
+    ``0`` disables the cache.
+    """
+    torch._C._mkl_fft_set_plan_cache_max_size(max_size)
+
+
+def fft_plan_cache_size():
+    r"""Returns the number of MKL FFT descriptors currently cached."""
+    return torch._C._mkl_fft_get_plan_cache_size()
+
+
+def clear_fft_plan_cache():
+    r"""Drops the cached MKL FFT descriptors."""
+    torch._C._mkl_fft_clear_plan_cache()
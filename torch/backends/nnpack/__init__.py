@@ -0,0 +1,7 @@
+import torch
+
+
+def is_available():
+    r"""Returns whether PyTorch is built with NNPACK support and NNPACK
+    supports this CPU."""
+    return torch._C.has_nnpack
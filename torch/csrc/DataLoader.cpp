@@ -1,5 +1,17 @@
 #include "DataLoader.h"
 
+#include "torch/csrc/Exceptions.h"
+#include "torch/csrc/THP.h"
+#include "torch/csrc/autograd/python_variable.h"
+#include "torch/csrc/autograd/variable.h"
+#include "torch/csrc/utils/auto_gil.h"
+#include "torch/csrc/utils/object_ptr.h"
+#include "torch/csrc/utils/tensor_collate.h"
+
+#include <ATen/ATen.h>
+
+#include <vector>
+
 // In cases like DataLoader, if a worker process die due to bus error/segfault
 // or just hang, the main process, if implemented with
 // multiprocessing.queue.SimpleQueue, will hang waiting for data. This is
@@ -207,10 +219,70 @@ static PyObject *THPModule_errorIfAnyWorkerFails(PyObject *module, PyObject *_ig
 
 #endif
 
+// torch._C._collate_tensors(tensors, out=None, pin_memory=False), see
+// torch::utils::collate_tensors. Tensors that require grad are stacked with
+// their history instead.
+static PyObject *THPModule_collateTensors(PyObject *module, PyObject *args) {
+  HANDLE_TH_ERRORS
+  PyObject *sequence = nullptr;
+  PyObject *out_obj = Py_None;
+  int pin_memory = 0;
+  if (!PyArg_ParseTuple(args, "O|Oi", &sequence, &out_obj, &pin_memory)) {
+    return nullptr;
+  }
+  THPObjectPtr items(PySequence_Fast(sequence, "expected a sequence of tensors"));
+  if (!items) throw python_error();
+  Py_ssize_t num_items = PySequence_Fast_GET_SIZE(items.get());
+  std::vector<torch::autograd::Variable> variables;
+  variables.reserve(num_items);
+  bool requires_grad = false;
+  for (Py_ssize_t i = 0; i < num_items; i++) {
+    PyObject *item = PySequence_Fast_GET_ITEM(items.get(), i);
+    THPUtils_assert(THPVariable_Check(item), "expected a sequence of tensors, but "
+        "element %d is %s", (int)i, THPUtils_typename(item));
+    variables.push_back(((THPVariable*)item)->cdata);
+    requires_grad |= variables.back().requires_grad();
+  }
+  THPUtils_assert(out_obj == Py_None || THPVariable_Check(out_obj), "out must be a "
+      "Tensor, but got %s", THPUtils_typename(out_obj));
+  at::Tensor out;
+  if (out_obj != Py_None) {
+    out = ((THPVariable*)out_obj)->cdata;
+  }
+
+  at::Tensor result;
+  if (requires_grad) {
+    std::vector<at::Tensor> tensors(variables.begin(), variables.end());
+    {
+      AutoNoGIL no_gil;
+      result = out.defined() ? at::stack_out(out, tensors, 0) : at::stack(tensors, 0);
+    }
+    return THPVariable_Wrap(result);
+  }
+
+  std::vector<at::Tensor> tensors;
+  tensors.reserve(num_items);
+  for (auto& variable : variables) {
+    tensors.push_back(variable.data());
+  }
+  {
+    AutoNoGIL no_gil;
+    result = torch::utils::collate_tensors(
+        tensors, out.defined() ? torch::autograd::Variable(out).data() : out, pin_memory);
+  }
+  if (out.defined()) {
+    Py_INCREF(out_obj);
+    return out_obj;
+  }
+  return THPVariable_Wrap(torch::autograd::make_variable(result, false));
+  END_HANDLE_TH_ERRORS
+}
+
 PyMethodDef DataLoaderMethods[] = {
   {"_set_worker_signal_handlers",  (PyCFunction)THPModule_setWorkerSignalHandlers,  METH_NOARGS,   NULL},
   {"_update_worker_pids",          (PyCFunction)THPModule_updateWorkerPIDs,         METH_VARARGS,  NULL},
   {"_remove_worker_pids",          (PyCFunction)THPModule_removeWorkerPIDs,         METH_O,        NULL},
   {"_error_if_any_worker_fails",   (PyCFunction)THPModule_errorIfAnyWorkerFails,    METH_NOARGS,   NULL},
+  {"_collate_tensors",             (PyCFunction)THPModule_collateTensors,           METH_VARARGS,  NULL},
   {NULL, NULL, 0, NULL}
 };
@@ -13,6 +13,7 @@
 #include <ATen/ExpandUtils.h>
 #include <ATen/dlpack.h>
 #include <ATen/DLConvertor.h>
+#include <ATen/mkl/FFTPlanCache.h>
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
 
@@ -28,6 +29,7 @@
 #include "torch/csrc/autograd/python_variable.h"
 #include "torch/csrc/tensor/python_tensor.h"
 #include "torch/csrc/utils/tensor_dtypes.h"
+#include "torch/csrc/utils/auto_gil.h"
 #include "torch/csrc/utils/python_strings.h"
 #include "torch/csrc/utils/tensor_layouts.h"
 #include "torch/csrc/utils/tensor_numpy.h"
@@ -36,8 +38,14 @@
 #include "torch/csrc/jit/python_ir.h"
 #include "torch/csrc/onnx/init.h"
 
+#ifdef WITH_CUDA
+#include <THC/THC.h>
+#include "torch/csrc/utils/auto_gpu.h"
+#endif
+
 #ifdef WITH_CUDNN
 #include "cudnn.h"
+#include <ATen/cudnn/BenchmarkCache.h>
 #endif
 
 #define WITH_NUMPY_IMPORT_ARRAY
@@ -116,11 +124,42 @@ static PyObject * THPModule_setNumThreads(PyObject *module, PyObject *arg)
 {
   THPUtils_assert(THPUtils_checkLong(arg), "set_num_threads expects an int, "
           "but got %s", THPUtils_typename(arg));
-  THSetNumThreads((int)THPUtils_unpackLong(arg));
   at::set_num_threads((int)THPUtils_unpackLong(arg));
   Py_RETURN_NONE;
 }
 
+static PyObject * THPModule_getMklFFTPlanCacheMaxSize(PyObject *module)
+{
+  HANDLE_TH_ERRORS
+  return PyLong_FromLongLong(at::native::mkl_fft_get_plan_cache_max_size());
+  END_HANDLE_TH_ERRORS
+}
+
+static PyObject * THPModule_setMklFFTPlanCacheMaxSize(PyObject *module, PyObject *arg)
+{
+  HANDLE_TH_ERRORS
+  THPUtils_assert(THPUtils_checkLong(arg), "_mkl_fft_set_plan_cache_max_size expects an int, "
+          "but got %s", THPUtils_typename(arg));
+  at::native::mkl_fft_set_plan_cache_max_size(THPUtils_unpackLong(arg));
+  Py_RETURN_NONE;
+  END_HANDLE_TH_ERRORS
+}
+
+static PyObject * THPModule_getMklFFTPlanCacheSize(PyObject *module)
+{
+  HANDLE_TH_ERRORS
+  return PyLong_FromLongLong(at::native::mkl_fft_get_plan_cache_size());
+  END_HANDLE_TH_ERRORS
+}
+
+static PyObject * THPModule_clearMklFFTPlanCache(PyObject *module)
+{
+  HANDLE_TH_ERRORS
+  at::native::mkl_fft_clear_plan_cache();
+  Py_RETURN_NONE;
+  END_HANDLE_TH_ERRORS
+}
+
 PyObject * THPModule_setDefaultTensorType(PyObject *_unused, PyObject *type)
 {
   HANDLE_TH_ERRORS
@@ -249,19 +288,88 @@ PyObject *THPModule_hasDistributed(PyObject *_unused)
 #endif
 }
 
-PyObject *THPModule_toDLPack(PyObject *_unused, PyObject *data)
+// Deletes the DLManagedTensor of a capsule that was never consumed
+static void THPModule_deleteDLPackCapsule(PyObject *capsule)
+{
+  if (PyCapsule_IsValid(capsule, "dltensor")) {
+    auto dlMTensor = (DLManagedTensor *)PyCapsule_GetPointer(capsule, "dltensor");
+    dlMTensor->deleter(dlMTensor);
+  }
+}
+
+#ifdef WITH_CUDA
+// Makes the work queued so far on stream from happen before any work queued
+// later on stream to, without blocking the host. A null stream is the legacy
+// default stream.
+static void THPModule_waitDLPackStream(int device, cudaStream_t from, cudaStream_t to)
+{
+  if (from == to) {
+    return;
+  }
+  AutoGPU guard(device);
+  cudaEvent_t event;
+  THCudaCheck(cudaEventCreateWithFlags(&event, cudaEventDisableTiming));
+  THCudaCheck(cudaEventRecord(event, from));
+  THCudaCheck(cudaStreamWaitEvent(to, event, 0));
+  THCudaCheck(cudaEventDestroy(event));
+}
+#endif
+
+// stream is an optional cudaStream_t, passed as an int, which the consumer
+// (for to_dlpack) or the producer (for from_dlpack) of a CUDA tensor uses.
+static void THPModule_syncDLPackStream(const at::Tensor& tensor, PyObject *stream, bool to_stream)
+{
+  if (!stream || stream == Py_None) {
+    return;
+  }
+  THPUtils_assert(THPUtils_checkLong(stream), "stream must be an int (a cudaStream_t), "
+      "but got %s", THPUtils_typename(stream));
+  if (!tensor.is_cuda()) {
+    return;
+  }
+#ifdef WITH_CUDA
+  auto other = (cudaStream_t)PyLong_AsVoidPtr(stream);
+  if (PyErr_Occurred()) throw python_error();
+  AutoGPU guard(tensor);
+  auto current = THCState_getCurrentStream(at::globalContext().getTHCState());
+  if (to_stream) {
+    THPModule_waitDLPackStream(tensor.get_device(), current, other);
+  } else {
+    THPModule_waitDLPackStream(tensor.get_device(), other, current);
+  }
+#endif
+}
+
+// The capsule views the memory of the tensor, whatever its strides. If
+// stream is given, the consumer can use the tensor on it right away: it waits
+// for the work already queued on the current stream.
+PyObject *THPModule_toDLPack(PyObject *_unused, PyObject *args)
 {
   HANDLE_TH_ERRORS
+  PyObject *data = nullptr;
+  PyObject *stream = nullptr;
+  if (!PyArg_ParseTuple(args, "O|O", &data, &stream)) {
+    return nullptr;
+  }
   THPUtils_assert(THPVariable_Check(data), "data must be a Tensor");
-  DLManagedTensor* dlMTensor = at::toDLPack(THPVariable_UnpackData(data));
-  return PyCapsule_New(dlMTensor, "dltensor", NULL);
+  auto tensor = THPVariable_UnpackData(data);
+  THPModule_syncDLPackStream(tensor, stream, /*to_stream=*/true);
+  DLManagedTensor* dlMTensor = at::toDLPack(tensor);
+  return PyCapsule_New(dlMTensor, "dltensor", THPModule_deleteDLPackCapsule);
   END_HANDLE_TH_ERRORS
 }
 
-PyObject *THPModule_fromDLPack(PyObject *_unused, PyObject *data)
+// If stream is given, the current stream waits for the work the producer
+// queued on it, so the tensor can be used right away.
+PyObject *THPModule_fromDLPack(PyObject *_unused, PyObject *args)
 {
   using namespace torch::autograd;
   HANDLE_TH_ERRORS
+  PyObject *data = nullptr;
+  PyObject *stream = nullptr;
+  if (!PyArg_ParseTuple(args, "O|O", &data, &stream)) {
+    return nullptr;
+  }
   DLManagedTensor * dlMTensor = (DLManagedTensor *)PyCapsule_GetPointer(data, "dltensor");
   THPUtils_assert(dlMTensor, "from_dlpack received an invalid capsule. "
     "Note that DLTensor capsules can be consumed only once, "
@@ -270,6 +378,8 @@ PyObject *THPModule_fromDLPack(PyObject *_unused, PyObject *data)
   // destructor function that will be called when the underlying storage goes
   // out of scope. When the destructor is called, the dlMTensor is destructed too.
   auto atensor = make_variable(at::fromDLPack(dlMTensor), false);
+  // Make sure this capsule will never be used (or deleted) again.
+  PyCapsule_SetName(data, "used_dltensor");
 
   // It is possible that the call to at::fromDLPack is the very first
   // call to create a Tensor in PyTorch. If so, then _lazy_init has
@@ -280,8 +390,7 @@ PyObject *THPModule_fromDLPack(PyObject *_unused, PyObject *data)
   if(atensor.is_cuda()) {
     py::module::import("torch.cuda").attr("init")();
   }
-  // Make sure this capsule will never be used again.
-  PyCapsule_SetName(data, "used_dltensor");
+  THPModule_syncDLPackStream(atensor, stream, /*to_stream=*/false);
   return THPVariable_Wrap(std::move(atensor));
   END_HANDLE_TH_ERRORS
 }
@@ -355,6 +464,20 @@ PyObject *THPModule_isDefaultTypeCuda(PyObject *_unused, PyObject *arg) {
   END_HANDLE_TH_ERRORS
 }
 
+PyObject *THPModule_initShmArena(PyObject *_unused, PyObject *arg) {
+  HANDLE_TH_ERRORS
+  THPUtils_assert(THPUtils_checkLong(arg), "_init_shm_arena expects an int, "
+          "but got %s", THPUtils_typename(arg));
+  if (libshm_arena_init(THPUtils_unpackLong(arg))) {
+    Py_RETURN_TRUE;
+  }
+  Py_RETURN_FALSE;
+  END_HANDLE_TH_ERRORS
+}
+
+// See torch/csrc/utils/overhead_benchmark.h
+PyObject *THPModule_runOverheadBenchmarks(PyObject *_unused, PyObject *iters);
+
 static PyMethodDef TorchMethods[] = {
   {"_initExtension",  (PyCFunction)THPModule_initExtension,   METH_O,       NULL},
   {"_autograd_init",  (PyCFunction)THPAutograd_initExtension, METH_NOARGS,  NULL},
@@ -362,23 +485,29 @@ static PyMethodDef TorchMethods[] = {
   {"_init_names",     (PyCFunction)THPModule_initNames,       METH_O,       NULL},
   {"_has_distributed",(PyCFunction)THPModule_hasDistributed,  METH_NOARGS,  NULL},
   {"_safe_call",      (PyCFunction)THPModule_safeCall,          METH_VARARGS | METH_KEYWORDS, NULL},
+  {"_run_overhead_benchmarks", (PyCFunction)THPModule_runOverheadBenchmarks, METH_O, NULL},
   {"_set_default_tensor_type", (PyCFunction)THPModule_setDefaultTensorType, METH_O, NULL},
   {"_set_default_dtype", (PyCFunction)THPModule_setDefaultDtype, METH_O, NULL},
   {"_infer_size",     (PyCFunction)THPModule_inferSize,         METH_VARARGS, NULL},
+  {"_init_shm_arena", (PyCFunction)THPModule_initShmArena,     METH_O,       NULL},
   {"_set_backcompat_broadcast_warn", (PyCFunction)THPModule_setBackcompatBroadcastWarn, METH_O, NULL},
   {"_get_backcompat_broadcast_warn", (PyCFunction)THPModule_getBackcompatBroadcastWarn, METH_NOARGS, NULL},
   {"_set_backcompat_keepdim_warn", (PyCFunction)THPModule_setBackcompatKeepdimWarn, METH_O, NULL},
   {"_get_backcompat_keepdim_warn", (PyCFunction)THPModule_getBackcompatKeepdimWarn, METH_NOARGS, NULL},
   {"get_num_threads", (PyCFunction)THPModule_getNumThreads,     METH_NOARGS,  NULL},
   {"set_num_threads", (PyCFunction)THPModule_setNumThreads,     METH_O,       NULL},
+  {"_mkl_fft_get_plan_cache_max_size", (PyCFunction)THPModule_getMklFFTPlanCacheMaxSize, METH_NOARGS, NULL},
+  {"_mkl_fft_set_plan_cache_max_size", (PyCFunction)THPModule_setMklFFTPlanCacheMaxSize, METH_O, NULL},
+  {"_mkl_fft_get_plan_cache_size", (PyCFunction)THPModule_getMklFFTPlanCacheSize, METH_NOARGS, NULL},
+  {"_mkl_fft_clear_plan_cache", (PyCFunction)THPModule_clearMklFFTPlanCache, METH_NOARGS, NULL},
   {"_get_cudnn_enabled", (PyCFunction)THPModule_userEnabledCuDNN, METH_NOARGS,     NULL},
   {"_set_cudnn_enabled", (PyCFunction)THPModule_setUserEnabledCuDNN, METH_O,  NULL},
   {"_get_cudnn_benchmark", (PyCFunction)THPModule_benchmarkCuDNN, METH_NOARGS,     NULL},
   {"_set_cudnn_benchmark", (PyCFunction)THPModule_setBenchmarkCuDNN, METH_O,  NULL},
   {"_get_cudnn_deterministic", (PyCFunction)THPModule_deterministicCuDNN, METH_NOARGS,     NULL},
   {"_set_cudnn_deterministic", (PyCFunction)THPModule_setDeterministicCuDNN, METH_O,  NULL},
-  {"_to_dlpack",      (PyCFunction)THPModule_toDLPack,          METH_O,       NULL},
-  {"_from_dlpack",    (PyCFunction)THPModule_fromDLPack,        METH_O,       NULL},
+  {"_to_dlpack",      (PyCFunction)THPModule_toDLPack,          METH_VARARGS, NULL},
+  {"_from_dlpack",    (PyCFunction)THPModule_fromDLPack,        METH_VARARGS, NULL},
   {"set_flush_denormal", (PyCFunction)THPModule_setFlushDenormal, METH_O,     NULL},
   {"get_default_dtype", (PyCFunction)THPModule_getDefaultDtype, METH_NOARGS,  NULL},
   {"_is_default_type_cuda", (PyCFunction)THPModule_isDefaultTypeCuda, METH_NOARGS,  NULL},
@@ -436,8 +565,39 @@ static PyObject * THCUDNN_cudnn_version(PyObject *self, PyObject *args)
   return PyLong_FromLong(CUDNN_VERSION);
 }
 
+static PyObject * THCUDNN_save_benchmark_cache(PyObject *self, PyObject *arg)
+{
+  HANDLE_TH_ERRORS
+  THPUtils_assert(THPUtils_checkString(arg), "_cudnn_save_benchmark_cache expects a "
+          "path, but got %s", THPUtils_typename(arg));
+  auto path = THPUtils_unpackString(arg);
+  {
+    AutoNoGIL no_gil;
+    at::native::cudnn_save_benchmark_cache(path);
+  }
+  Py_RETURN_NONE;
+  END_HANDLE_TH_ERRORS
+}
+
+static PyObject * THCUDNN_load_benchmark_cache(PyObject *self, PyObject *arg)
+{
+  HANDLE_TH_ERRORS
+  THPUtils_assert(THPUtils_checkString(arg), "_cudnn_load_benchmark_cache expects a "
+          "path, but got %s", THPUtils_typename(arg));
+  auto path = THPUtils_unpackString(arg);
+  int64_t loaded;
+  {
+    AutoNoGIL no_gil;
+    loaded = at::native::cudnn_load_benchmark_cache(path);
+  }
+  return PyLong_FromLongLong(loaded);
+  END_HANDLE_TH_ERRORS
+}
+
 static PyMethodDef _THCUDNN_methods[] = {
   {"_cudnn_version", (PyCFunction)THCUDNN_cudnn_version, METH_VARARGS, NULL},
+  {"_cudnn_save_benchmark_cache", (PyCFunction)THCUDNN_save_benchmark_cache, METH_O, NULL},
+  {"_cudnn_load_benchmark_cache", (PyCFunction)THCUDNN_load_benchmark_cache, METH_O, NULL},
   {NULL}
 };
 
@@ -546,6 +706,8 @@ static PyObject* initModule() {
   at::init();
 
   ASSERT_TRUE(PyModule_AddObject(module, "has_mkl", at::hasMKL() ? Py_True : Py_False) == 0);
+  ASSERT_TRUE(PyModule_AddObject(module, "has_mkldnn", at::hasMKLDNN() ? Py_True : Py_False) == 0);
+  ASSERT_TRUE(PyModule_AddObject(module, "has_nnpack", at::hasNNPACK() ? Py_True : Py_False) == 0);
 
   auto& defaultGenerator = at::globalContext().defaultGenerator(at::kCPU);
   THPDefaultGenerator = (THPGenerator*)THPGenerator_NewWithGenerator(
@@ -18,6 +18,7 @@
 #include "allocators.h"
 #include "copy_utils.h"
 #include "DynamicTypes.h"
+#include "torch/csrc/utils/auto_gil.h"
 
 #include "generic/Storage.cpp"
 #include <TH/THGenerateAllTypes.h>
@@ -59,6 +59,27 @@ THAllocator THStorageWeakRefAllocator = {
   free_wrapper<StorageWeakRefAllocator>,
 };
 
+static void * byte_storage_slice_malloc(void *ctx, ptrdiff_t size) {
+  THError("THByteStorageSliceAllocator: malloc not supported");
+  return nullptr;
+}
+
+static void * byte_storage_slice_realloc(void *ctx, void *ptr, ptrdiff_t size) {
+  THError("THByteStorageSliceAllocator: can't resize a storage that points "
+      "into another storage");
+  return nullptr;
+}
+
+static void byte_storage_slice_free(void *ctx, void *ptr) {
+  THByteStorage_free((THByteStorage*)ctx);
+}
+
+THAllocator THByteStorageSliceAllocator = {
+  byte_storage_slice_malloc,
+  byte_storage_slice_realloc,
+  byte_storage_slice_free,
+};
+
 #ifdef WITH_CUDA
 cudaError_t CudaStorageWeakRefAllocator::malloc(void** ptr, size_t size, cudaStream_t stream) {
   THError("CudaStorageWeakRefAllocator: malloc not supported");
@@ -63,6 +63,9 @@ public:
 
 extern THAllocator THObjectPtrAllocator;
 extern THAllocator THStorageWeakRefAllocator;
+// For storages that point into the memory of a THByteStorage, which is their
+// context. Frees the reference to it; they can't be resized.
+extern THAllocator THByteStorageSliceAllocator;
 #ifdef WITH_CUDA
 extern THCDeviceAllocator THCStorageWeakRefAllocator;
 #endif
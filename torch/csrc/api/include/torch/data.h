@@ -0,0 +1,152 @@
+#pragma once
+
+#include "torch/detail.h"
+
+#include <ATen/ATen.h>
+
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace torch {
+namespace data {
+
+// An input and its target. Batches are Examples too, whose tensors have an
+// extra leading dimension.
+struct Example {
+  Tensor data;
+  Tensor target;
+};
+
+// A map-style dataset. get() is called concurrently from the worker threads
+// of a DataLoader, so it must be thread safe. Examples should hold ATen
+// tensors, not Variables; wrap batches with Var() before using them in a
+// model.
+class Dataset {
+ public:
+  virtual ~Dataset() = default;
+  virtual Example get(size_t index) = 0;
+  virtual size_t size() const = 0;
+};
+
+// Indexes the first dimension of a data and a target tensor.
+class TensorDataset : public Dataset {
+ public:
+  TensorDataset(Tensor data, Tensor target);
+  Example get(size_t index) override;
+  size_t size() const override;
+
+ private:
+  Tensor data_;
+  Tensor target_;
+};
+
+// Produces the order in which the indices of a dataset are visited. Only
+// used by one thread at a time.
+class Sampler {
+ public:
+  virtual ~Sampler() = default;
+  // Starts a new epoch over the indices [0, size)
+  virtual void reset(size_t size) = 0;
+  // Returns false once the epoch is over
+  virtual bool next(size_t& index) = 0;
+};
+
+class SequentialSampler : public Sampler {
+ public:
+  void reset(size_t size) override;
+  bool next(size_t& index) override;
+
+ private:
+  size_t size_ = 0;
+  size_t next_ = 0;
+};
+
+// Visits a new random permutation of the indices in every epoch.
+class RandomSampler : public Sampler {
+ public:
+  explicit RandomSampler(uint64_t seed = std::random_device()());
+  void reset(size_t size) override;
+  bool next(size_t& index) override;
+
+ private:
+  std::mt19937_64 generator_;
+  std::vector<size_t> indices_;
+  size_t next_ = 0;
+};
+
+// Loads batches of a Dataset in a pool of worker threads. Every worker
+// fetches all examples of a batch and stacks them into the batch tensors
+// itself; at most max_prefetch batches are being loaded or waiting to be
+// returned by next() at any time. With enforce_ordering, batches are returned in the order of the
+// sampler, otherwise as soon as they are ready. With no workers, batches are
+// loaded by next() on the calling thread. With pin_memory, batches are
+// allocated in page-locked memory (from the caching host allocator, so the
+// buffers of freed batches are reused), which requires CUDA.
+//
+//   data::DataLoader loader(dataset, 32);
+//   loader.workers(4).sampler(std::make_shared<data::RandomSampler>());
+//   for (int epoch = 0; epoch < 10; epoch++) {
+//     loader.reset();
+//     data::Example batch;
+//     while (loader.next(batch)) { ... }
+//   }
+//
+// Options must not be changed during an epoch.
+class DataLoader {
+ public:
+  DataLoader(std::shared_ptr<Dataset> dataset, size_t batch_size);
+  ~DataLoader();
+
+  TORCH_AUTOGRAD_KWARG(DataLoader, size_t, workers, 0, 0);
+  TORCH_AUTOGRAD_KWARG(DataLoader, size_t, max_prefetch, 2, 2);
+  TORCH_AUTOGRAD_KWARG(DataLoader, bool, drop_last, false, true);
+  TORCH_AUTOGRAD_KWARG(DataLoader, bool, enforce_ordering, true, true);
+  TORCH_AUTOGRAD_KWARG(DataLoader, bool, pin_memory, false, true);
+  // Defaults to a SequentialSampler
+  TORCH_AUTOGRAD_KWARG(DataLoader, std::shared_ptr<Sampler>, sampler, nullptr, nullptr);
+
+  // Starts a new epoch, dropping any batches of the current one that
+  // haven't been returned yet.
+  void reset();
+  // Stores the next batch in batch, or returns false once the epoch is over.
+  // Rethrows exceptions thrown while loading the batch.
+  bool next(Example& batch);
+
+ private:
+  struct Result {
+    Example batch;
+    std::exception_ptr error;
+  };
+
+  // Draws the indices of the next batch from the sampler. Returns false at
+  // the end of the epoch. Must be called with mutex_ held.
+  bool claim(std::vector<size_t>& indices);
+  Example load(const std::vector<size_t>& indices);
+  void work();
+  void stop();
+
+  std::shared_ptr<Dataset> dataset_;
+  size_t batch_size_;
+
+  std::mutex mutex_;
+  std::condition_variable work_available_;
+  std::condition_variable result_available_;
+  std::vector<std::thread> threads_;
+  bool started_ = false;
+  bool stopping_ = false;
+  bool sampler_exhausted_ = false;
+  size_t claimed_ = 0; // batches handed to workers in this epoch
+  size_t returned_ = 0; // batches returned by next() in this epoch
+  size_t in_flight_ = 0; // claimed batches whose result isn't stored yet
+  std::map<size_t, Result> results_; // by position in the epoch
+};
+
+} // namespace data
+} // namespace torch
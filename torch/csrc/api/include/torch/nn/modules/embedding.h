@@ -11,6 +11,9 @@ class Embedding : public torch::nn::CloneableModule<Embedding> {
  public:
   Embedding(uint32_t num_embeddings, uint32_t embedding_dim);
 
+  // Produce sparse gradients for weight, which only hold the looked up rows
+  TORCH_AUTOGRAD_KWARG(Embedding, bool, sparse, false, true)
+
   variable_list forward(variable_list) override;
   void reset_parameters() override;
   void initialize_parameters() override;
@@ -3,5 +3,6 @@
 #include <torch/nn/module.h>
 #include <torch/nn/modules/modules.h>
 
+#include "torch/data.h"
 #include "torch/optimizers.h"
 #include "torch/serialization.h"
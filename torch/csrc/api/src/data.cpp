@@ -0,0 +1,227 @@
+#include "torch/data.h"
+
+#include <algorithm>
+#include <numeric>
+
+namespace torch {
+namespace data {
+namespace {
+
+// Stacks one field of the examples along a new first dimension.
+Tensor collate(
+    const std::vector<Example>& examples,
+    Tensor Example::*field,
+    bool pin_memory) {
+  const auto& first = examples.front().*field;
+  if (!first.defined()) {
+    return Tensor();
+  }
+  auto sizes = first.sizes().vec();
+  sizes.insert(sizes.begin(), examples.size());
+  auto& type = first.type();
+  Tensor batch;
+  if (pin_memory) {
+    AT_CHECK(!type.is_cuda(), "DataLoader: can't pin CUDA tensors");
+    batch = type.tensorWithAllocator(
+        sizes, at::detail::getCUDAHooks().newPinnedMemoryAllocator());
+  } else {
+    batch = type.tensor(sizes);
+  }
+  for (size_t i = 0; i < examples.size(); i++) {
+    const auto& t = examples[i].*field;
+    AT_CHECK(
+        t.defined() && t.sizes().equals(first.sizes()),
+        "DataLoader: all examples of a batch must have the same sizes");
+    batch[i].copy_(t);
+  }
+  return batch;
+}
+
+} // namespace
+
+TensorDataset::TensorDataset(Tensor data, Tensor target)
+    : data_(std::move(data)), target_(std::move(target)) {
+  AT_CHECK(data_.dim() > 0, "TensorDataset: data must have a first dimension");
+  AT_CHECK(
+      !target_.defined() || (target_.dim() > 0 && target_.size(0) == data_.size(0)),
+      "TensorDataset: data and target must have the same first dimension");
+}
+
+Example TensorDataset::get(size_t index) {
+  auto i = static_cast<int64_t>(index);
+  return {data_[i], target_.defined() ? target_[i] : Tensor()};
+}
+
+size_t TensorDataset::size() const {
+  return data_.size(0);
+}
+
+void SequentialSampler::reset(size_t size) {
+  size_ = size;
+  next_ = 0;
+}
+
+bool SequentialSampler::next(size_t& index) {
+  if (next_ == size_) {
+    return false;
+  }
+  index = next_++;
+  return true;
+}
+
+RandomSampler::RandomSampler(uint64_t seed) : generator_(seed) {}
+
+void RandomSampler::reset(size_t size) {
+  indices_.resize(size);
+  std::iota(indices_.begin(), indices_.end(), 0);
+  std::shuffle(indices_.begin(), indices_.end(), generator_);
+  next_ = 0;
+}
+
+bool RandomSampler::next(size_t& index) {
+  if (next_ == indices_.size()) {
+    return false;
+  }
+  index = indices_[next_++];
+  return true;
+}
+
+DataLoader::DataLoader(std::shared_ptr<Dataset> dataset, size_t batch_size)
+    : dataset_(std::move(dataset)), batch_size_(batch_size) {
+  AT_CHECK(dataset_, "DataLoader: dataset must not be null");
+  AT_CHECK(batch_size_ > 0, "DataLoader: batch_size must be positive");
+}
+
+DataLoader::~DataLoader() {
+  stop();
+}
+
+void DataLoader::reset() {
+  AT_CHECK(max_prefetch_ > 0, "DataLoader: max_prefetch must be positive");
+  stop();
+  if (!sampler_) {
+    sampler_ = std::make_shared<SequentialSampler>();
+  }
+  sampler_->reset(dataset_->size());
+  sampler_exhausted_ = false;
+  claimed_ = 0;
+  returned_ = 0;
+  in_flight_ = 0;
+  results_.clear();
+  stopping_ = false;
+  started_ = true;
+  for (size_t i = 0; i < workers_; i++) {
+    threads_.emplace_back([this] { work(); });
+  }
+}
+
+bool DataLoader::next(Example& batch) {
+  if (!started_) {
+    reset();
+  }
+  if (threads_.empty()) {
+    std::vector<size_t> indices;
+    if (!claim(indices)) {
+      return false;
+    }
+    claimed_++;
+    returned_++;
+    batch = load(indices);
+    return true;
+  }
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    auto it = enforce_ordering_ ? results_.find(returned_) : results_.begin();
+    if (it != results_.end()) {
+      Result result = std::move(it->second);
+      results_.erase(it);
+      returned_++;
+      lock.unlock();
+      work_available_.notify_all();
+      if (result.error) {
+        std::rethrow_exception(result.error);
+      }
+      batch = std::move(result.batch);
+      return true;
+    }
+    if (sampler_exhausted_ && in_flight_ == 0) {
+      return false;
+    }
+    result_available_.wait(lock);
+  }
+}
+
+bool DataLoader::claim(std::vector<size_t>& indices) {
+  if (sampler_exhausted_) {
+    return false;
+  }
+  indices.clear();
+  size_t index;
+  while (indices.size() < batch_size_ && sampler_->next(index)) {
+    indices.push_back(index);
+  }
+  if (indices.size() < batch_size_) {
+    sampler_exhausted_ = true;
+  }
+  return !indices.empty() && !(drop_last_ && indices.size() < batch_size_);
+}
+
+Example DataLoader::load(const std::vector<size_t>& indices) {
+  std::vector<Example> examples;
+  examples.reserve(indices.size());
+  for (auto index : indices) {
+    examples.push_back(dataset_->get(index));
+  }
+  return {collate(examples, &Example::data, pin_memory_),
+          collate(examples, &Example::target, pin_memory_)};
+}
+
+void DataLoader::work() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    work_available_.wait(lock, [this] {
+      return stopping_ ||
+          (!sampler_exhausted_ && claimed_ - returned_ < max_prefetch_);
+    });
+    if (stopping_) {
+      return;
+    }
+    std::vector<size_t> indices;
+    if (!claim(indices)) {
+      // wake up next() in case this was the end of the epoch
+      result_available_.notify_all();
+      continue;
+    }
+    size_t position = claimed_++;
+    in_flight_++;
+    lock.unlock();
+
+    Result result;
+    try {
+      result.batch = load(indices);
+    } catch (...) {
+      result.error = std::current_exception();
+    }
+
+    lock.lock();
+    in_flight_--;
+    results_[position] = std::move(result);
+    result_available_.notify_all();
+  }
+}
+
+void DataLoader::stop() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  work_available_.notify_all();
+  for (auto& thread : threads_) {
+    thread.join();
+  }
+  threads_.clear();
+}
+
+} // namespace data
+} // namespace torch
@@ -7,7 +7,7 @@ Embedding::Embedding(uint32_t num_embeddings, uint32_t embedding_dim)
 
 variable_list Embedding::forward(variable_list input) {
   auto x = input[0];
-  return variable_list({at::embedding(weight, x, -1, false, false)});
+  return variable_list({at::embedding(weight, x, -1, false, sparse_)});
 }
 
 void Embedding::reset_parameters() {
@@ -2,7 +2,49 @@
 
 #include <torch/nn/module.h>
 
+#include "torch/csrc/utils/auto_gpu.h"
+
+#include <map>
+#include <tuple>
+#include <vector>
+
 namespace torch {
+namespace {
+
+// Sparse gradients (e.g. of an Embedding with sparse()) are updated lazily:
+// only the rows present in the gradient are touched, like Caffe2's
+// SparseAdagrad. Returns the coalesced gradient.
+at::Tensor check_sparse_grad(const at::Tensor& grad, const char* optimizer) {
+  AT_CHECK(
+      grad._dimI() == 1,
+      optimizer, ": sparse gradients must have one sparse dimension, but got ",
+      grad._dimI());
+  return grad.coalesce();
+}
+
+// Whether the step of p can go through one of the fused optimizer kernels,
+// which update many CUDA parameters in a single launch
+bool fusable(const at::Tensor& p, const at::Tensor& grad) {
+  return p.is_cuda() && !grad.type().is_sparse() && grad.type() == p.type() &&
+      p.is_contiguous() && grad.is_contiguous();
+}
+
+// The lists of tensors ({params, grads, state...}) that a fused kernel steps
+// together: of one type, on one device and with the same key
+using FusedBuckets = std::map<
+    std::tuple<const at::Type*, int64_t, int64_t>,
+    std::vector<std::vector<at::Tensor>>>;
+
+void add_fused(FusedBuckets& buckets, int64_t key, std::vector<at::Tensor> tensors) {
+  auto& lists = buckets[std::make_tuple(
+      &tensors[0].type(), tensors[0].get_device(), key)];
+  lists.resize(tensors.size());
+  for (size_t i = 0; i < tensors.size(); i++) {
+    lists[i].push_back(std::move(tensors[i]));
+  }
+}
+
+} // namespace
 
 void OptimizerImpl::zero_grad() {
   for (auto p : model_->parameters()) {
@@ -19,6 +61,8 @@ void OptimizerImpl::set_model(std::shared_ptr<nn::Module> model) {
 }
 
 void SGD::step() {
+  // keyed by whether the momentum buffers are new
+  FusedBuckets fused;
   for (auto& pair : model_->parameters()) {
     auto& name = pair.first;
     auto& grad = pair.second.grad();
@@ -27,6 +71,20 @@ void SGD::step() {
       continue;
 
     auto d_p = torch::autograd::as_variable_ref(grad).data();
+    if (fusable(p, d_p)) {
+      std::vector<at::Tensor> tensors = {p, d_p};
+      bool init_momentum = false;
+      if (momentum_ != 0) {
+        init_momentum = momentum_buffers_.find(name) == momentum_buffers_.end();
+        if (init_momentum) {
+          momentum_buffers_[name] = at::zeros_like(p);
+        }
+        tensors.push_back(momentum_buffers_[name]);
+      }
+      add_fused(fused, init_momentum, std::move(tensors));
+      continue;
+    }
+
     if (weight_decay_ > 0) {
       d_p.add_(p, weight_decay_);
     };
@@ -50,6 +108,14 @@ void SGD::step() {
 
     p.add_(d_p, -lr_);
   }
+
+  for (auto& bucket : fused) {
+    auto& lists = bucket.second;
+    AutoGPU guard(lists[0][0]);
+    at::_fused_sgd(
+        lists[0], lists[1], momentum_ != 0 ? at::TensorList(lists[2]) : at::TensorList(),
+        lr_, momentum_, dampening_, weight_decay_, nesterov_, std::get<2>(bucket.first));
+  }
 }
 
 void SGD::init_state() {
@@ -59,6 +125,8 @@ void SGD::init_state() {
 /// Adapted from
 /// https://github.com/pytorch/pytorch/blob/master/torch/optim/adagrad.py
 void Adagrad::step() {
+  // keyed by the step
+  FusedBuckets fused;
   for (auto& pair : model_->parameters()) {
     auto& name = pair.first;
     auto& grad = pair.second.grad();
@@ -67,9 +135,6 @@ void Adagrad::step() {
       continue;
 
     auto d_p = torch::autograd::as_variable_ref(grad).data();
-    if (weight_decay_ > 0) {
-      d_p.add_(p, weight_decay_);
-    };
     auto& step = step_[name];
     step += 1.0;
     auto clr = lr_ / (1.0 + (step - 1.0) * lr_decay_);
@@ -80,10 +145,40 @@ void Adagrad::step() {
       buf = sum_[name];
     }
 
+    if (fusable(p, d_p)) {
+      add_fused(fused, static_cast<int64_t>(step), {p, d_p, buf});
+      continue;
+    }
+
+    if (d_p.type().is_sparse()) {
+      AT_CHECK(
+          weight_decay_ == 0,
+          "Adagrad: weight_decay is not supported with sparse gradients");
+      d_p = check_sparse_grad(d_p, "Adagrad");
+      auto rows = d_p._indices()[0];
+      auto values = d_p._values();
+      buf.index_add_(0, rows, values * values);
+      auto std = buf.index_select(0, rows).sqrt_().add_(1e-10);
+      p.index_add_(0, rows, values.div(std).mul_(-clr));
+      continue;
+    }
+
+    if (weight_decay_ > 0) {
+      d_p.add_(p, weight_decay_);
+    };
     buf.addcmul_(d_p, d_p, 1.0);
     at::Tensor std = buf.sqrt().add_(1e-10);
     p.addcdiv_(d_p, std, -clr);
   }
+
+  for (auto& bucket : fused) {
+    auto& lists = bucket.second;
+    double step = std::get<2>(bucket.first);
+    AutoGPU guard(lists[0][0]);
+    at::_fused_adagrad(
+        lists[0], lists[1], lists[2], lr_ / (1.0 + (step - 1.0) * lr_decay_),
+        weight_decay_);
+  }
 }
 
 void Adagrad::init_state() {
@@ -145,6 +240,8 @@ void RMSprop::init_state() {
 }
 
 void Adam::step() {
+  // keyed by the step
+  FusedBuckets fused;
   for (auto& pair : model_->parameters()) {
     auto& name = pair.first;
     auto& grad = pair.second.grad();
@@ -166,8 +263,42 @@ void Adam::step() {
     auto& exp_avg_sq = exp_avg_sq_buffer_[name];
 
     step += 1;
+    auto bias_correction1 = 1 - std::pow(beta1_, step);
+    auto bias_correction2 = 1 - std::pow(beta2_, step);
+    auto step_size = lr_ * std::sqrt(bias_correction2) / bias_correction1;
 
     auto d_p = torch::autograd::as_variable_ref(grad).data();
+    if (fusable(p, d_p)) {
+      std::vector<at::Tensor> tensors = {p, d_p, exp_avg, exp_avg_sq};
+      if (amsgrad_) {
+        tensors.push_back(max_exp_avg_sq_buffer_[name]);
+      }
+      add_fused(fused, step, std::move(tensors));
+      continue;
+    }
+
+    if (d_p.type().is_sparse()) {
+      AT_CHECK(
+          weight_decay_ == 0 && !amsgrad_,
+          "Adam: weight_decay and amsgrad are not supported with sparse gradients");
+      d_p = check_sparse_grad(d_p, "Adam");
+      auto rows = d_p._indices()[0];
+      auto values = d_p._values();
+      // exp_avg[rows] = beta1 * exp_avg[rows] + (1 - beta1) * values, written
+      // as an index_add_ of the difference
+      auto exp_avg_rows = exp_avg.index_select(0, rows);
+      auto exp_avg_update = values.sub(exp_avg_rows).mul_(1 - beta1_);
+      exp_avg.index_add_(0, rows, exp_avg_update);
+      exp_avg_rows.add_(exp_avg_update);
+      auto exp_avg_sq_rows = exp_avg_sq.index_select(0, rows);
+      auto exp_avg_sq_update = (values * values).sub_(exp_avg_sq_rows).mul_(1 - beta2_);
+      exp_avg_sq.index_add_(0, rows, exp_avg_sq_update);
+      exp_avg_sq_rows.add_(exp_avg_sq_update);
+      auto denom = exp_avg_sq_rows.sqrt_().add_(eps_);
+      p.index_add_(0, rows, exp_avg_rows.div_(denom).mul_(-step_size));
+      continue;
+    }
+
     if (weight_decay_ > 0) {
       d_p.add_(p, weight_decay_);
     }
@@ -184,11 +315,20 @@ void Adam::step() {
       denom = exp_avg_sq.sqrt().add_(eps_);
     };
 
+    p.addcdiv_(exp_avg, denom, -step_size);
+  }
+
+  for (auto& bucket : fused) {
+    auto& lists = bucket.second;
+    auto step = std::get<2>(bucket.first);
     auto bias_correction1 = 1 - std::pow(beta1_, step);
     auto bias_correction2 = 1 - std::pow(beta2_, step);
     auto step_size = lr_ * std::sqrt(bias_correction2) / bias_correction1;
-
-    p.addcdiv_(exp_avg, denom, -step_size);
+    AutoGPU guard(lists[0][0]);
+    at::_fused_adam(
+        lists[0], lists[1], lists[2], lists[3],
+        amsgrad_ ? at::TensorList(lists[4]) : at::TensorList(),
+        step_size, beta1_, beta2_, eps_, weight_decay_);
   }
 }
 
@@ -0,0 +1,29 @@
+#include "autocast_mode.h"
+
+namespace torch { namespace autograd {
+
+thread_local bool AutocastMode::_enabled = false;
+
+namespace autocast {
+
+bool is_castable(at::ScalarType scalar_type, const at::Tensor& tensor) {
+  if (!tensor.defined() || !tensor.type().is_cuda() || tensor.type().is_sparse()) {
+    return false;
+  }
+  auto from = tensor.type().scalarType();
+  if (scalar_type == at::kHalf) {
+    return from == at::kFloat;
+  }
+  return scalar_type == at::kFloat && from == at::kHalf;
+}
+
+at::Tensor cast(at::ScalarType scalar_type, const at::Tensor& tensor) {
+  if (!is_castable(scalar_type, tensor)) {
+    return tensor;
+  }
+  return tensor.toType(tensor.type().toScalarType(scalar_type));
+}
+
+} // namespace autocast
+
+}} // namespace torch::autograd
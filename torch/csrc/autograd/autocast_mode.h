@@ -0,0 +1,44 @@
+#pragma once
+
+#include <ATen/ATen.h>
+
+namespace torch { namespace autograd {
+
+// Automatic mixed precision. While enabled, the VariableType methods of the
+// ops that are fast and safe in fp16 (GEMMs and convolutions) cast their
+// float CUDA arguments to half, and those that need the range or precision
+// of fp32 (reductions, softmax, losses, exp, log, pow) cast their half CUDA
+// arguments to float. The casts are differentiable, so the gradients flow
+// back in the type of the original arguments. Like GradMode, the mode is
+// thread local, and backward passes don't run under it.
+struct AutocastMode {
+  static bool is_enabled() {
+    return _enabled;
+  }
+  static void set_enabled(bool enabled) {
+    _enabled = enabled;
+  }
+private:
+  static thread_local bool _enabled;
+};
+
+namespace autocast {
+
+// True if tensor is converted when an op casts its arguments to scalar_type
+bool is_castable(at::ScalarType scalar_type, const at::Tensor& tensor);
+
+inline bool any_castable(at::ScalarType /*scalar_type*/) {
+  return false;
+}
+
+template <typename... Args>
+bool any_castable(at::ScalarType scalar_type, const at::Tensor& tensor, const Args&... args) {
+  return is_castable(scalar_type, tensor) || any_castable(scalar_type, args...);
+}
+
+// tensor converted to scalar_type if it is castable, else tensor itself
+at::Tensor cast(at::ScalarType scalar_type, const at::Tensor& tensor);
+
+} // namespace autocast
+
+}} // namespace torch::autograd
@@ -1,14 +1,17 @@
 #include "torch/csrc/autograd/engine.h"
 
 #include "torch/csrc/autograd/function.h"
+#include "torch/csrc/autograd/functions/accumulate_grad.h"
 #include "torch/csrc/autograd/functions/basic_ops.h"
 #include "torch/csrc/autograd/grad_mode.h"
 #include "torch/csrc/autograd/variable.h"
 #include "torch/csrc/utils/auto_gpu.h"
 
+#include <array>
 #include <atomic>
 #include <condition_variable>
 #include <cstdint>
+#include <cstdlib>
 #include <functional>
 #include <iostream>
 #include <memory>
@@ -21,6 +24,7 @@
 #include <sstream>
 #include <queue>
 #include <TH/TH.h>
+#include <TH/THStaticTracepoint.h>
 
 #ifdef WITH_CUDA
 #include <cuda.h>
@@ -38,17 +42,31 @@ static constexpr int NO_DEVICE = -2;
 // handling reentrant backwards calls; see Note [Reentrant backwards]
 static thread_local int worker_device = NO_DEVICE;
 
+// Index in Engine::ready_queues of the queue this worker thread drains, or
+// NO_QUEUE for threads that are not engine workers. Unlike worker_device,
+// this tells apart the CPU workers, which all have worker_device == -1.
+static constexpr int NO_QUEUE = -1;
+static thread_local int worker_queue = NO_QUEUE;
+
 // This variable is true if ALL invocations in the stack of re-entrant engine
 // invocations are imperative backwards. This special variable is needed for the
 // gradient checkpointing feature only.
 static thread_local bool checkpoint_valid = true;
 
+// Peak number of bytes of gradients held by the engine during the last
+// backward pass started from this thread, see Note [Early release].
+static thread_local int64_t last_graph_task_peak_bytes = 0;
+
 // XXX: Changes to the way multithreading works in execute should be done with
 // great care. Right now the implementation guarantees that a single function's
 // apply will never be entered concurrently (even if multiple graphs are
 // executed at the same time). Adding multiple threads per-device or removing
 // engine thread affinity to the device can break this invariant, and we depend
 // on it in a few places (e.g. AccumulateGrad function).
+//
+// The one exception is CPU work, which can be spread over several workers
+// (see Note [CPU workers]). There, the invariant is upheld explicitly by
+// locking the function before running it.
 
 struct FunctionTask {
   GraphTask* base;
@@ -57,26 +75,80 @@ struct FunctionTask {
   // gradients flowing here.  Once all the dependencies are finished, we
   // use the contents of this buffer to run the function.
   InputBuffer inputs;
+  // Whether fn recomputes part of the forward pass, see
+  // Function::recomputes_forward()
+  bool recompute;
 
   FunctionTask(GraphTask* base, std::shared_ptr<Function> fn, InputBuffer inputs)
     : base(base)
     , fn(fn)
-    , inputs(std::move(inputs)) {}
+    , inputs(std::move(inputs))
+    , recompute(fn && fn->recomputes_forward()) {}
 };
 
+// Tasks without a function (sent to wake up the owner of a finished graph
+// task, see Note [Reentrant backwards]) come first, and recomputations last,
+// just in time: running everything else that is ready first releases as many
+// saved variables as possible before activations are recreated. Otherwise
+// tasks are ordered by decreasing sequence number, i.e. the most recently
+// created function first.
 struct CompareFunctionTaskTime {
   bool operator()(FunctionTask const & t1, FunctionTask const & t2) {
+    if (!t1.fn) return false;
+    if (!t2.fn) return true;
+    if (t1.recompute != t2.recompute) return t1.recompute;
     return t1.fn->sequence_nr() < t2.fn->sequence_nr();
   }
 };
 
+struct CPUReadyQueues;
+
 struct ReadyQueue {
   std::priority_queue<FunctionTask, std::vector<FunctionTask>, CompareFunctionTaskTime> heap;
   std::condition_variable not_empty;
   std::mutex mutex;
+  // Set if this queue is one of the shards of the CPU queue.
+  CPUReadyQueues* cpu_queues = nullptr;
+  // Number of tasks in heap. Also read without holding mutex, by idle CPU
+  // workers deciding whether to go to sleep.
+  std::atomic<size_t> size;
+
+  ReadyQueue() : size(0) {}
 
   void push(FunctionTask item);
   FunctionTask pop();
+  // Pops the first task without blocking. When stealing, tasks without a
+  // function are left alone, since they are meant for this queue's worker.
+  bool try_pop(FunctionTask& task, bool steal);
+};
+
+// Note [CPU workers]
+// ~~~~~~~~~~~~~~~~~~
+// Backward passes with many small functions, or with independent branches
+// (e.g. the towers of a multi-tower model), are limited by the single CPU
+// worker. Engine::set_num_cpu_workers or TORCH_AUTOGRAD_CPU_WORKERS (default
+// 1) sets the number of CPU worker threads. Each of them has its own shard of the CPU queue: tasks
+// created by a CPU worker go to its own shard, tasks from other threads are
+// dealt out round-robin, and a worker whose shard is empty steals from the
+// others before going to sleep. Device queues keep their single worker, so
+// CUDA work still runs on the thread bound to its device.
+//
+// A graph task owned by a CPU worker (see Note [Reentrant backwards]) signals
+// its completion with a task without a function on the owner's shard; those
+// are never stolen, so that the owner itself wakes up.
+struct CPUReadyQueues {
+  std::vector<ReadyQueue*> shards;
+  // Number of tasks with a function in all shards.
+  std::atomic<int64_t> num_stealable;
+  std::atomic<int> num_idle;
+  std::atomic<size_t> next_shard;
+  std::mutex idle_mutex;
+  std::condition_variable idle_cv;
+
+  CPUReadyQueues() : num_stealable(0), num_idle(0), next_shard(0) {}
+
+  void notify(bool stealable);
+  FunctionTask pop(int shard);
 };
 
 // Note [Reentrant backwards]
@@ -116,6 +188,23 @@ struct ReadyQueue {
 //    evaluate_function() completes.
 
 
+// Note [Early release]
+// ~~~~~~~~~~~~~~~~~~~~
+// Memory held by a backward pass is let go as soon as it isn't needed
+// anymore, rather than when the whole GraphTask is done:
+//
+//  - Unless the graph is kept, a function's saved variables are released
+//    right after its apply(), before its post hooks run.
+//  - The gradients a function received are dropped right after its apply(),
+//    unless a post hook needs them.
+//  - Outputs that go to functions which won't be executed are dropped
+//    right away, and the buffers of functions that are still waiting for
+//    inputs are freed as soon as an error stops the pass.
+//
+// GraphTask::grad_bytes counts the bytes of gradients that sit in input
+// buffers or are being consumed by a running function, and peak_grad_bytes
+// records its maximum, which Engine::last_peak_grad_bytes() reports.
+
 // GraphTask holds metadata needed for a single execution of backward()
 struct GraphTask {
   std::exception_ptr exception;
@@ -133,6 +222,18 @@ struct GraphTask {
   std::unordered_map<Function*, InputBuffer> not_ready;
   std::unordered_map<Function*, int> dependencies;
 
+  // See Note [Early release]. grad_bytes only grows while mutex is held,
+  // which also protects peak_grad_bytes.
+  std::atomic<int64_t> grad_bytes;
+  int64_t peak_grad_bytes;
+
+  void add_grad_bytes(int64_t nbytes) {
+    int64_t current = grad_bytes += nbytes;
+    if (current > peak_grad_bytes) {
+      peak_grad_bytes = current;
+    }
+  }
+
   struct ExecInfo {
     struct Capture {
       Capture(int input_idx, int output_idx) : input_idx(input_idx), output_idx(output_idx) {}
@@ -157,7 +258,7 @@ struct GraphTask {
 
   void init_to_execute(Function& graph_root, const edge_list& captures);
 
-  // The value of worker_device in the thread that created this task.
+  // The value of worker_queue in the thread that created this task.
   // See Note [Reentrant backwards]
   int owner;
 
@@ -175,26 +276,114 @@ struct GraphTask {
     , not_done()
     , not_ready()
     , dependencies()
-    , owner(NO_DEVICE) {}
+    , grad_bytes(0)
+    , peak_grad_bytes(0)
+    , owner(NO_QUEUE) {}
 };
 
 auto ReadyQueue::push(FunctionTask item) -> void {
+  bool stealable = bool(item.fn);
   {
     std::lock_guard<std::mutex> lock(mutex);
     ++item.base->outstanding_tasks;
     heap.push(std::move(item));
+    ++size;
+    if (cpu_queues && stealable) {
+      ++cpu_queues->num_stealable;
+    }
+  }
+  if (cpu_queues) {
+    cpu_queues->notify(stealable);
+  } else {
+    not_empty.notify_one();
   }
-  not_empty.notify_one();
 }
 
 auto ReadyQueue::pop() -> FunctionTask {
   std::unique_lock<std::mutex> lock(mutex);
   not_empty.wait(lock, [this]{ return !heap.empty(); });
   auto task = std::move(const_cast<FunctionTask&>(heap.top())); heap.pop();
+  --size;
   return task;
 }
 
-Engine::Engine() : ready_queues() {
+auto ReadyQueue::try_pop(FunctionTask& task, bool steal) -> bool {
+  std::lock_guard<std::mutex> lock(mutex);
+  if (heap.empty() || (steal && !heap.top().fn)) {
+    return false;
+  }
+  task = std::move(const_cast<FunctionTask&>(heap.top())); heap.pop();
+  --size;
+  if (cpu_queues && task.fn) {
+    --cpu_queues->num_stealable;
+  }
+  return true;
+}
+
+auto CPUReadyQueues::notify(bool stealable) -> void {
+  // Pairs with the increment of num_idle in pop(): either the sleeper sees
+  // the new task in its wait predicate, or we see the sleeper here.
+  if (num_idle.load() == 0) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(idle_mutex);
+  if (stealable) {
+    idle_cv.notify_one();
+  } else {
+    // Only the owner of the shard can take it, so wake everyone.
+    idle_cv.notify_all();
+  }
+}
+
+auto CPUReadyQueues::pop(int shard) -> FunctionTask {
+  ReadyQueue& own = *shards[shard];
+  FunctionTask task(nullptr, nullptr, InputBuffer(0));
+  while (true) {
+    if (own.try_pop(task, false)) {
+      return task;
+    }
+    for (size_t i = 1; i < shards.size(); ++i) {
+      if (shards[(shard + i) % shards.size()]->try_pop(task, true)) {
+        return task;
+      }
+    }
+    std::unique_lock<std::mutex> lock(idle_mutex);
+    ++num_idle;
+    idle_cv.wait(lock, [&]{ return own.size.load() > 0 || num_stealable.load() > 0; });
+    --num_idle;
+  }
+}
+
+static int num_cpu_workers_from_env() {
+  const char* env = std::getenv("TORCH_AUTOGRAD_CPU_WORKERS");
+  if (!env) {
+    return 1;
+  }
+  int num_workers = std::atoi(env);
+  if (num_workers < 1) {
+    throw std::runtime_error(
+        std::string("TORCH_AUTOGRAD_CPU_WORKERS must be a positive integer, got ") + env);
+  }
+  return num_workers;
+}
+
+// Functions run by CPU workers are locked during their execution when there
+// is more than one CPU worker, see the XXX note above. Lock striping keeps
+// this out of Function itself. The mutexes are recursive because a function
+// may start a reentrant backward pass that reaches another function on the
+// same stripe.
+static std::array<std::recursive_mutex, 64> function_locks;
+
+static std::recursive_mutex& function_lock(Function* fn) {
+  return function_locks[(reinterpret_cast<uintptr_t>(fn) >> 4) % function_locks.size()];
+}
+
+Engine::Engine()
+  : threads_started(false)
+  , ready_queues()
+  , num_cpu_workers(0)
+  , grad_accumulated_hooks(std::make_shared<grad_accumulated_hooks_type>())
+  , next_grad_accumulated_hook(0) {
 }
 
 // This Engine's ReadyQueues and their corresponding threads are leaked here
@@ -222,17 +411,34 @@ auto Engine::thread_init(int device) -> void {
 // It's all ok and is handled right now, but it should be accounted for
 // in case this code is to be changed.
 auto Engine::thread_main(GraphTask *graph_task) -> void {
-  auto queue = ready_queues[worker_device + 1];
+  auto queue = ready_queues[worker_queue];
+  bool is_cpu_worker = worker_device == -1;
+  bool lock_functions = is_cpu_worker && num_cpu_workers > 1;
   // Why the test on graph_task->outstanding_tasks?  See
   // Note [Reentrant backwards]
   while (!graph_task || graph_task->outstanding_tasks > 0) {
-    FunctionTask task = queue->pop();
+    FunctionTask task = is_cpu_worker ? cpu_queues->pop(worker_queue) : queue->pop();
     if (task.fn && !task.base->has_error.load()) {
-      GradMode::set_enabled(task.base->grad_mode);
-      try {
-        evaluate_function(task);
-      } catch (std::exception& e) {
-        thread_on_exception(task, e);
+      std::unique_lock<std::recursive_mutex> fn_lock;
+      if (lock_functions) {
+        fn_lock = std::unique_lock<std::recursive_mutex>(
+            function_lock(task.fn.get()), std::try_to_lock);
+      }
+      if (lock_functions && !fn_lock.owns_lock()) {
+        // Another CPU worker is running a function on the same stripe (most
+        // likely the same function for another graph task). Don't block this
+        // worker on it; put the task back and pick up something else. The
+        // push counts as a new outstanding task, which the bookkeeping below
+        // balances.
+        queue->push(FunctionTask(task.base, std::move(task.fn), std::move(task.inputs)));
+        std::this_thread::yield();
+      } else {
+        GradMode::set_enabled(task.base->grad_mode);
+        try {
+          evaluate_function(task);
+        } catch (std::exception& e) {
+          thread_on_exception(task, e);
+        }
       }
     }
     // Notify downstream about the completion of tasks depending
@@ -240,7 +446,7 @@ auto Engine::thread_main(GraphTask *graph_task) -> void {
     // graph (in case of reentrant execution.)  See Note [Reentrant backwards].
     auto base_owner = task.base->owner;
     // Task from a non-worker thread. Easy case.
-    if (base_owner == NO_DEVICE) {
+    if (base_owner == NO_QUEUE) {
       if (--task.base->outstanding_tasks == 0) {
         std::lock_guard<std::mutex> lock(task.base->mutex);
         task.base->not_done.notify_all();
@@ -248,17 +454,17 @@ auto Engine::thread_main(GraphTask *graph_task) -> void {
     } else {
       // If it's a task initiated from this thread, decrease the counter, but
       // don't do anything - loop condition will do all checks for us next.
-      if (base_owner == worker_device) {
+      if (base_owner == worker_queue) {
         --task.base->outstanding_tasks;
       // Otherwise send a dummy function task to the owning thread just to
       // ensure that it's not sleeping. If it has work, it might see that
       // graph_task->outstanding_tasks == 0 before it gets to the task, but
       // it's a no-op anyway.
-      } else if (base_owner != worker_device) {
+      } else if (base_owner != worker_queue) {
         if (--task.base->outstanding_tasks == 0) {
           // Synchronize outstanding_tasks with queue mutex
           std::atomic_thread_fence(std::memory_order_release);
-          ready_queue(base_owner).push(FunctionTask(task.base, nullptr, InputBuffer(0)));
+          ready_queues[base_owner]->push(FunctionTask(task.base, nullptr, InputBuffer(0)));
         }
       }
     }
@@ -270,6 +476,8 @@ auto Engine::thread_on_exception(FunctionTask& task, std::exception& e) -> void
   if (!task.base->has_error.load()) {
     task.base->exception = std::current_exception();
     task.base->has_error = true;
+    // Nothing will consume these anymore
+    task.base->not_ready.clear();
   }
 }
 
@@ -291,6 +499,11 @@ static variable_list call_function(FunctionTask& task) {
   bool prev_checkpoint_valid_state = checkpoint_valid;
   checkpoint_valid = task.base->can_checkpoint() && prev_checkpoint_valid_state;
   auto& fn = *task.fn;
+  // fn.name() demangles, the probes get the cheap mangled type name
+  const char* type_name = typeid(fn).name();
+  uint64_t sequence_nr = fn.sequence_nr();
+  TH_SDT(autograd_task_start, type_name, (void*)&fn, sequence_nr);
+  int64_t input_bytes = task.inputs.nbytes();
   auto inputs = call_pre_hooks(fn, InputBuffer::variables(std::move(task.inputs)));
 
   if(!task.base->keep_graph) {
@@ -298,7 +511,18 @@ static variable_list call_function(FunctionTask& task) {
   }
   auto outputs = fn(inputs);
   checkpoint_valid = prev_checkpoint_valid_state;
-  return call_post_hooks(fn, std::move(outputs), std::move(inputs));
+
+  // See Note [Early release]
+  if (!task.base->keep_graph) {
+    fn.release_variables();
+  }
+  if (fn.post_hooks().empty()) {
+    inputs.clear();
+  }
+  task.base->grad_bytes -= input_bytes;
+  auto result = call_post_hooks(fn, std::move(outputs), std::move(inputs));
+  TH_SDT(autograd_task_end, type_name, (void*)&fn, sequence_nr);
+  return result;
 }
 
 auto Engine::evaluate_function(FunctionTask& task) -> void {
@@ -312,15 +536,16 @@ auto Engine::evaluate_function(FunctionTask& task) -> void {
         task.base->captured_vars[capture.output_idx] = task.inputs[capture.input_idx];
       }
     }
-    if (!fn_info.needed) return;
+    if (!fn_info.needed) {
+      task.base->grad_bytes -= task.inputs.nbytes();
+      task.inputs = InputBuffer(0);
+      return;
+    }
   }
 
   auto outputs = call_function(task);
 
   auto& fn = *task.fn;
-  if (!task.base->keep_graph) {
-    fn.release_variables();
-  }
 
   if (outputs.size() != fn.num_outputs()) {
     std::stringstream ss;
@@ -329,6 +554,15 @@ auto Engine::evaluate_function(FunctionTask& task) -> void {
     throw std::runtime_error(ss.str());
   }
 
+  auto hooks = std::atomic_load(&grad_accumulated_hooks);
+  if (!hooks->empty()) {
+    if (auto* accumulate = dynamic_cast<AccumulateGrad*>(&fn)) {
+      for (const auto& hook : *hooks) {
+        hook.second(accumulate->variable);
+      }
+    }
+  }
+
   int num_outputs = outputs.size();
   if (num_outputs == 0) return; // Don't even acquire the mutex
   std::lock_guard<std::mutex> lock(task.base->mutex);
@@ -357,12 +591,14 @@ auto Engine::evaluate_function(FunctionTask& task) -> void {
       if (!exec_info.empty()) {
         auto it = exec_info.find(next.function.get());
         if (it == exec_info.end() || !it->second.should_execute()) {
+          output = Variable();
           continue;
         }
       }
       // No buffers have been allocated for the function
       InputBuffer input_buffer(next.function->num_inputs());
       input_buffer.add(next.input_nr, std::move(output));
+      task.base->add_grad_bytes(input_buffer.nbytes());
       if (is_ready) {
         auto& queue = ready_queue(input_buffer.device());
         queue.push(FunctionTask(task.base, next.function, std::move(input_buffer)));
@@ -372,7 +608,9 @@ auto Engine::evaluate_function(FunctionTask& task) -> void {
     } else {
       // The function already has a buffer
       auto &input_buffer = not_ready_it->second;
+      int64_t old_bytes = input_buffer.nbytes();
       input_buffer.add(next.input_nr, std::move(output));
+      task.base->add_grad_bytes(input_buffer.nbytes() - old_bytes);
       if (is_ready) {
         auto& queue = ready_queue(input_buffer.device());
         queue.push(FunctionTask(task.base, next.function, std::move(input_buffer)));
@@ -449,11 +687,13 @@ auto Engine::execute(const edge_list& input_roots,
     // Get back to work while we wait for our new graph_task to
     // complete!
     // See Note [Reentrant backwards]
-    graph_task.owner = worker_device;
+    graph_task.owner = worker_queue;
     lock.unlock();
     thread_main(&graph_task);
   }
 
+  last_graph_task_peak_bytes = graph_task.peak_grad_bytes;
+
   // Check for an exception while running backwards
   if (graph_task.has_error.load()) {
     std::rethrow_exception(graph_task.exception);
@@ -488,12 +728,66 @@ void Engine::queue_callback(std::function<void()> callback) {
   final_callbacks.emplace_back(std::move(callback));
 }
 
+uint64_t Engine::add_grad_accumulated_hook(grad_accumulated_hook_type hook) {
+  std::lock_guard<std::mutex> lock(grad_accumulated_hooks_lock);
+  auto hooks = std::make_shared<grad_accumulated_hooks_type>(*grad_accumulated_hooks);
+  uint64_t handle = next_grad_accumulated_hook++;
+  hooks->emplace_back(handle, std::move(hook));
+  std::atomic_store(&grad_accumulated_hooks,
+                    std::shared_ptr<const grad_accumulated_hooks_type>(std::move(hooks)));
+  return handle;
+}
+
+void Engine::remove_grad_accumulated_hook(uint64_t handle) {
+  std::lock_guard<std::mutex> lock(grad_accumulated_hooks_lock);
+  auto hooks = std::make_shared<grad_accumulated_hooks_type>();
+  for (const auto& hook : *grad_accumulated_hooks) {
+    if (hook.first != handle) {
+      hooks->push_back(hook);
+    }
+  }
+  std::atomic_store(&grad_accumulated_hooks,
+                    std::shared_ptr<const grad_accumulated_hooks_type>(std::move(hooks)));
+}
+
+void Engine::set_num_cpu_workers(int num_workers) {
+  if (num_workers < 1) {
+    throw std::runtime_error(
+        "the number of autograd CPU workers must be positive, got " + std::to_string(num_workers));
+  }
+  std::lock_guard<std::mutex> lock(start_threads_mutex);
+  if (threads_started) {
+    if (num_workers == num_cpu_workers) {
+      return;
+    }
+    throw std::runtime_error(
+        "the number of autograd CPU workers can only be changed before the first backward pass");
+  }
+  num_cpu_workers = num_workers;
+}
+
+int Engine::get_num_cpu_workers() {
+  std::lock_guard<std::mutex> lock(start_threads_mutex);
+  return num_cpu_workers > 0 ? num_cpu_workers : num_cpu_workers_from_env();
+}
+
 bool Engine::is_checkpoint_valid() {
   return checkpoint_valid;
 }
 
+int64_t Engine::last_peak_grad_bytes() {
+  return last_graph_task_peak_bytes;
+}
+
 auto Engine::ready_queue(int device) -> ReadyQueue& {
-  return *ready_queues.at(device + 1);
+  if (device == -1) {
+    // CPU workers keep the work they create; see Note [CPU workers]
+    if (worker_device == -1) {
+      return *ready_queues[worker_queue];
+    }
+    return *cpu_queues->shards[cpu_queues->next_shard++ % num_cpu_workers];
+  }
+  return *ready_queues.at(num_cpu_workers + device);
 }
 
 auto Engine::start_threads() -> void {
@@ -505,13 +799,31 @@ auto Engine::start_threads() -> void {
     num_devices = 0;
   }
 #endif
-  // One for CPU, plus one for every GPU device
-  int num_threads = num_devices + 1;
+  // The CPU workers, plus one for every GPU device. ready_queues holds the
+  // shards of the CPU queue first, followed by the device queues.
+  {
+    std::lock_guard<std::mutex> lock(start_threads_mutex);
+    if (num_cpu_workers == 0) {
+      num_cpu_workers = num_cpu_workers_from_env();
+    }
+    threads_started = true;
+  }
+  int num_threads = num_cpu_workers + num_devices;
+  cpu_queues = std::make_shared<CPUReadyQueues>();
   ready_queues = std::vector<std::shared_ptr<ReadyQueue>>(num_threads);
-  for (auto& queue : ready_queues)
-    queue.reset(new ReadyQueue());
   for (int i = 0; i < num_threads; ++i) {
-    std::thread t(&Engine::thread_init, this, i - 1);
+    ready_queues[i].reset(new ReadyQueue());
+    if (i < num_cpu_workers) {
+      ready_queues[i]->cpu_queues = cpu_queues.get();
+      cpu_queues->shards.push_back(ready_queues[i].get());
+    }
+  }
+  for (int i = 0; i < num_threads; ++i) {
+    int device = i < num_cpu_workers ? -1 : i - num_cpu_workers;
+    std::thread t([this, i, device] {
+      worker_queue = i;
+      thread_init(device);
+    });
     t.detach();
   }
 }
@@ -16,6 +16,7 @@
 namespace torch { namespace autograd {
 
 struct ReadyQueue;
+struct CPUReadyQueues;
 struct FunctionTask;
 struct GraphTask;
 
@@ -39,10 +40,31 @@ struct Engine {
 
   void queue_callback(std::function<void()> callback);
 
+  // Hooks called every time a gradient has been accumulated into the .grad of
+  // a leaf variable, with that variable, while the rest of the backward pass
+  // is still running. This lets the data parallel code start reducing
+  // gradients as soon as they are ready. Hooks run on the engine thread that
+  // accumulated the gradient, without the GIL, and may be called
+  // concurrently from several threads.
+  using grad_accumulated_hook_type = std::function<void(const Variable&)>;
+  uint64_t add_grad_accumulated_hook(grad_accumulated_hook_type hook);
+  void remove_grad_accumulated_hook(uint64_t handle);
+
   static Engine& getDefaultEngine();
 
+  // The number of CPU worker threads, see Note [CPU workers] in engine.cpp.
+  // It can only be changed before the first backward pass starts the
+  // threads; until then it defaults to TORCH_AUTOGRAD_CPU_WORKERS (or 1).
+  void set_num_cpu_workers(int num_workers);
+  int get_num_cpu_workers();
+
   bool is_checkpoint_valid();
 
+  // The largest number of bytes of gradients held at once by the last
+  // backward pass started from the calling thread, see Note [Early release]
+  // in engine.cpp.
+  int64_t last_peak_grad_bytes();
+
 protected:
   void compute_dependencies(Function* root, GraphTask& task);
   void evaluate_function(FunctionTask& task);
@@ -53,9 +75,23 @@ protected:
   virtual void thread_on_exception(FunctionTask& task, std::exception& e);
 
   std::once_flag start_threads_flag;
+  std::mutex start_threads_mutex;
+  bool threads_started;
+  // The shards of the CPU queue (one per CPU worker), then one queue per
+  // device. See Note [CPU workers] in engine.cpp.
   std::vector<std::shared_ptr<ReadyQueue>> ready_queues;
+  std::shared_ptr<CPUReadyQueues> cpu_queues;
+  int num_cpu_workers;
   std::vector<std::function<void()>> final_callbacks;
   std::mutex post_callbacks_lock;
+
+  // Replaced (never modified) under grad_accumulated_hooks_lock, so that the
+  // engine threads can iterate over a snapshot without locking.
+  using grad_accumulated_hooks_type =
+      std::vector<std::pair<uint64_t, grad_accumulated_hook_type>>;
+  std::shared_ptr<const grad_accumulated_hooks_type> grad_accumulated_hooks;
+  std::mutex grad_accumulated_hooks_lock;
+  uint64_t next_grad_accumulated_hook;
 };
 
 }} // namespace torch::autograd
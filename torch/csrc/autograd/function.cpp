@@ -7,8 +7,10 @@
 #include <ATen/ATen.h>
 
 #include <algorithm>
+#include <array>
 #include <cstdint>
 #include <memory>
+#include <new>
 #include <stdexcept>
 #include <string>
 #include <utility>
@@ -19,6 +21,104 @@ namespace torch { namespace autograd {
 
 thread_local uint64_t Function::next_sequence_nr_ = 0;
 
+/*
+ * Every differentiable operation of the forward pass allocates a Function
+ * and the control block of its shared_ptr, which are freed again by the
+ * backward pass, and there are only a handful of distinct sizes. Freed
+ * blocks are kept on per-thread free lists, one per multiple of
+ * kFunctionPoolGranularity bytes, and reused by the next allocation of that
+ * size class on the same thread. A block may be freed on another thread than
+ * the one that allocated it (e.g. by the engine's device threads), it then
+ * goes to the lists of the freeing thread. Larger blocks, and blocks in excess
+ * of kFunctionPoolMaxBlocks per size class, go back to operator delete.
+ */
+namespace {
+
+constexpr size_t kFunctionPoolGranularity = 16;
+constexpr size_t kFunctionPoolMaxSize = 1024;
+constexpr size_t kFunctionPoolMaxBlocks = 4096;
+
+struct FunctionPool {
+  struct FreeBlock {
+    FreeBlock* next;
+  };
+  struct FreeList {
+    FreeBlock* head = nullptr;
+    size_t size = 0;
+  };
+
+  static size_t size_class(size_t size) {
+    return (size + kFunctionPoolGranularity - 1) / kFunctionPoolGranularity;
+  }
+
+  ~FunctionPool();
+
+  std::array<FreeList, kFunctionPoolMaxSize / kFunctionPoolGranularity + 1> lists;
+};
+
+// Functions can still be freed during thread exit after the pool has been
+// destroyed, the flag is trivially destructible so it remains valid.
+thread_local bool function_pool_destroyed = false;
+
+FunctionPool::~FunctionPool() {
+  for (auto& list : lists) {
+    while (list.head) {
+      auto next = list.head->next;
+      ::operator delete(list.head);
+      list.head = next;
+    }
+  }
+  function_pool_destroyed = true;
+}
+
+FunctionPool* function_pool() {
+  static thread_local FunctionPool pool;
+  return function_pool_destroyed ? nullptr : &pool;
+}
+
+} // anonymous namespace
+
+namespace detail {
+
+void* allocateFunctionMemory(size_t size) {
+  auto cls = FunctionPool::size_class(size);
+  if (size > kFunctionPoolMaxSize) {
+    return ::operator new(size);
+  }
+  if (auto pool = function_pool()) {
+    auto& list = pool->lists[cls];
+    if (list.head) {
+      auto block = list.head;
+      list.head = block->next;
+      list.size--;
+      return block;
+    }
+  }
+  return ::operator new(cls * kFunctionPoolGranularity);
+}
+
+void freeFunctionMemory(void* ptr, size_t size) noexcept {
+  if (!ptr) {
+    return;
+  }
+  auto cls = FunctionPool::size_class(size);
+  if (size <= kFunctionPoolMaxSize) {
+    if (auto pool = function_pool()) {
+      auto& list = pool->lists[cls];
+      if (list.size < kFunctionPoolMaxBlocks) {
+        auto block = static_cast<FunctionPool::FreeBlock*>(ptr);
+        block->next = list.head;
+        list.head = block;
+        list.size++;
+        return;
+      }
+    }
+  }
+  ::operator delete(ptr);
+}
+
+} // namespace detail
+
 auto Function::name() -> std::string {
   return std::string(typeid(*this).name());
 }
@@ -12,8 +12,10 @@
 #include "torch/csrc/utils/variadic.h"
 
 #include <ATen/ATen.h>
+#include <ATen/SmallVector.h>
 
 #include <algorithm>
+#include <cstddef>
 #include <cstdint>
 #include <initializer_list>
 #include <memory>
@@ -29,13 +31,21 @@ struct FunctionPreHook;
 
 using tensor_list = std::vector<at::Tensor>;
 using variable_list = std::vector<Variable>;
-using edge_list = std::vector<Edge>;
+// Most functions have one or two inputs, whose edges are stored inline.
+using edge_list = at::SmallVector<Edge, 2>;
 using saved_variable_list = std::vector<SavedVariable>;
 using IndexRange = std::pair<size_t, size_t>;
 
 // Custom deleter to prevent stack overflows.
 void deleteFunction(Function* function);
 
+namespace detail {
+// Allocates from and frees to the per-thread pool of `Function` memory (see
+// `function.cpp`). `size` must be the same for both calls.
+void* allocateFunctionMemory(std::size_t size);
+void freeFunctionMemory(void* ptr, std::size_t size) noexcept;
+} // namespace detail
+
 ///~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 ///                               Function
 ///~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
@@ -95,6 +105,20 @@ struct Function : std::enable_shared_from_this<Function> {
         num_inputs_(num_inputs),
         next_edges_(std::move(next_edges)) {}
 
+  /// `Function`s are allocated from a per-thread pool, because the forward
+  /// pass creates and the backward pass frees one (or more) per operation.
+  static void* operator new(std::size_t size) {
+    return detail::allocateFunctionMemory(size);
+  }
+  static void operator delete(void* ptr, std::size_t size) noexcept {
+    detail::freeFunctionMemory(ptr, size);
+  }
+  /// `PyFunction`s are constructed in place in their Python object.
+  static void* operator new(std::size_t /*size*/, void* ptr) noexcept {
+    return ptr;
+  }
+  static void operator delete(void* /*ptr*/, void* /*place*/) noexcept {}
+
   /// Functions are neither copyable nor moveable.
   Function(const Function& other) = delete;
   Function(Function&& other) = delete;
@@ -259,6 +283,14 @@ struct Function : std::enable_shared_from_this<Function> {
   /// release variables as they run.
   virtual void will_release_variables() {}
 
+  /// Returns true if this function runs part of the forward pass again in its
+  /// `apply()`, like `Checkpoint`. The engine runs such functions only when no
+  /// other function is ready, so that the activations they recreate are alive
+  /// for as short as possible.
+  virtual bool recomputes_forward() {
+    return false;
+  }
+
   /// Returns true if this function is traceable. An op is traceable if all
   /// operations happening within `apply()` are performed on autograd
   /// `Variables` (i.e. apply mostly instantiates and applies other functions).
@@ -374,4 +406,42 @@ edge_list collect_next_edges(Variables&&... variables) {
   make.apply(std::forward<Variables>(variables)...);
   return std::move(make.next_edges);
 }
+
+/// A standard allocator on the pool that backs `Function`s, used for the
+/// control blocks of their `shared_ptr`s.
+template <typename T>
+struct FunctionPoolAllocator {
+  using value_type = T;
+
+  FunctionPoolAllocator() = default;
+  template <typename U>
+  FunctionPoolAllocator(const FunctionPoolAllocator<U>&) noexcept {}
+
+  T* allocate(std::size_t n) {
+    return static_cast<T*>(detail::allocateFunctionMemory(n * sizeof(T)));
+  }
+  void deallocate(T* ptr, std::size_t n) noexcept {
+    detail::freeFunctionMemory(ptr, n * sizeof(T));
+  }
+};
+
+template <typename T, typename U>
+bool operator==(const FunctionPoolAllocator<T>&, const FunctionPoolAllocator<U>&) {
+  return true;
+}
+
+template <typename T, typename U>
+bool operator!=(const FunctionPoolAllocator<T>&, const FunctionPoolAllocator<U>&) {
+  return false;
+}
+
+/// Creates a `Function` of type `T` that is deleted with `deleteFunction`,
+/// with both the function and its reference count allocated from the pool.
+template <typename T, typename... Args>
+std::shared_ptr<T> make_function(Args&&... args) {
+  return std::shared_ptr<T>(
+      new T(std::forward<Args>(args)...),
+      deleteFunction,
+      FunctionPoolAllocator<T>());
+}
 }} // namespace torch::autograd
@@ -29,10 +29,21 @@ auto AccumulateGrad::apply(const variable_list& grads) -> variable_list {
   for (auto& hook : variable.hooks()) {
     new_grad = (*hook)({new_grad})[0];
   }
+  // new_grad and, unless a hook replaced it, grads[0]
+  bool replaced = static_cast<const Tensor&>(new_grad).get() !=
+      static_cast<const Tensor&>(grads[0]).get();
+  int expected_refs = replaced ? 1 : 2;
 
   at::Tensor& grad = variable.grad();
   if (!grad.defined()) {
-    variable.grad() = new_grad.clone();
+    // A gradient nobody else can see becomes .grad without a copy. Later
+    // calls accumulate into it in place, so .grad keeps its storage across
+    // iterations when it is zeroed rather than reset.
+    if (!GradMode::is_enabled() && can_accumulate_inplace(new_grad, expected_refs)) {
+      variable.grad() = new_grad.detach();
+    } else {
+      variable.grad() = new_grad.clone();
+    }
   } else if (!GradMode::is_enabled()) {
     Variable& grad_variable = as_variable_ref(grad);
     // This case is not strictly necessary, but it makes the first-order only case
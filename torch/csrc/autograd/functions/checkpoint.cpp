@@ -0,0 +1,187 @@
+#include "torch/csrc/autograd/functions/checkpoint.h"
+
+#include "torch/csrc/autograd/engine.h"
+#include "torch/csrc/autograd/function.h"
+#include "torch/csrc/autograd/functions/utils.h"
+#include "torch/csrc/autograd/grad_mode.h"
+#include "torch/csrc/autograd/variable.h"
+#include "torch/csrc/utils/auto_gpu.h"
+
+#include <ATen/ATen.h>
+
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#ifdef WITH_CUDA
+#include <THC/THC.h>
+#endif
+
+namespace torch { namespace autograd {
+
+namespace {
+
+// Receives the gradients of the inputs of a recomputed segment
+struct InputGrads : public Function {
+  explicit InputGrads(uint32_t num_inputs)
+    : Function(num_inputs) {}
+
+  virtual variable_list apply(const variable_list& inputs) override {
+    grads = inputs;
+    return {};
+  }
+
+  variable_list grads;
+};
+
+// Swaps in the generator states of a checkpointed segment for the duration
+// of its recomputation
+struct RNGStateGuard {
+  explicit RNGStateGuard(const RNGState& state)
+    : prev_state(state.devices) {
+    state.restore();
+  }
+
+  ~RNGStateGuard() {
+    prev_state.restore();
+  }
+
+  RNGState prev_state;
+};
+
+std::vector<int> cuda_devices(const variable_list& inputs) {
+  std::vector<int> devices;
+  for (auto& input : inputs) {
+    if (input.defined() && input.is_cuda()) {
+      int device = input.get_device();
+      if (std::find(devices.begin(), devices.end(), device) == devices.end()) {
+        devices.push_back(device);
+      }
+    }
+  }
+  return devices;
+}
+
+} // anonymous namespace
+
+RNGState::RNGState(std::vector<int> devices)
+  : devices(std::move(devices))
+  , cpu_state(at::CPU(at::kFloat).generator()) {
+  cpu_state->copy(at::globalContext().defaultGenerator(at::kCPU));
+#ifdef WITH_CUDA
+  for (auto device : this->devices) {
+    AutoGPU guard(device);
+    auto state = at::CPU(at::kByte).tensor();
+    THCRandom_getRNGState(at::globalContext().getTHCState(),
+                          (THByteTensor*)state.unsafeGetTH(false));
+    cuda_states.push_back(std::move(state));
+  }
+#endif
+}
+
+void RNGState::restore() const {
+  at::globalContext().defaultGenerator(at::kCPU).copy(*cpu_state);
+#ifdef WITH_CUDA
+  for (size_t i = 0; i < devices.size(); i++) {
+    AutoGPU guard(devices[i]);
+    THCRandom_setRNGState(at::globalContext().getTHCState(),
+                          (THByteTensor*)cuda_states[i].unsafeGetTH(false));
+  }
+#endif
+}
+
+Checkpoint::Checkpoint(forward_fn forward, const variable_list& inputs, RNGState rng_state,
+                       edge_list&& next_edges)
+  : Function(/*num_inputs=*/0, std::move(next_edges))
+  , forward(std::move(forward))
+  , rng_state(std::move(rng_state)) {
+  this->inputs.reserve(inputs.size());
+  for (auto& input : inputs) {
+    this->inputs.emplace_back(input, /*is_output=*/false);
+  }
+}
+
+auto Checkpoint::run(forward_fn forward, const variable_list& inputs) -> variable_list {
+  if (!GradMode::is_enabled()) {
+    return forward(inputs);
+  }
+  RNGState rng_state(cuda_devices(inputs));
+  variable_list outputs;
+  {
+    AutoGradMode grad_mode(false);
+    outputs = forward(inputs);
+  }
+  tensor_list output_data;
+  output_data.reserve(outputs.size());
+  for (auto& output : outputs) {
+    output_data.push_back(output.defined() ? output.data() : at::Tensor());
+  }
+  return wrap_outputs(inputs, std::move(output_data), [&](edge_list&& next_edges) {
+    return std::make_shared<Checkpoint>(
+        std::move(forward), inputs, std::move(rng_state), std::move(next_edges));
+  });
+}
+
+auto Checkpoint::apply(const variable_list& grads) -> variable_list {
+  auto& engine = Engine::getDefaultEngine();
+  if (!engine.is_checkpoint_valid()) {
+    throw std::runtime_error(
+        "Checkpointing is not compatible with .grad(), please use .backward() if possible");
+  }
+  bool create_graph = GradMode::is_enabled();
+
+  // The recomputed inputs send their gradients to input_grads rather than to
+  // the graph of the forward pass, which the engine is running
+  auto input_grads = std::make_shared<InputGrads>(inputs.size());
+  variable_list recompute_inputs;
+  recompute_inputs.reserve(inputs.size());
+  for (size_t i = 0; i < inputs.size(); i++) {
+    auto input = inputs[i].unpack();
+    if (!input.defined()) {
+      recompute_inputs.emplace_back();
+    } else if (input.requires_grad()) {
+      recompute_inputs.push_back(make_variable(input.data(), Edge(input_grads, i)));
+    } else {
+      recompute_inputs.push_back(make_variable(input.data(), /*requires_grad=*/false));
+    }
+  }
+
+  variable_list outputs;
+  {
+    RNGStateGuard rng_guard(rng_state);
+    AutoGradMode grad_mode(true);
+    outputs = forward(recompute_inputs);
+  }
+  if (outputs.size() != num_inputs()) {
+    throw std::runtime_error(
+        "a checkpointed function returned " + std::to_string(outputs.size()) +
+        " outputs in backward, but " + std::to_string(num_inputs()) + " in forward");
+  }
+
+  edge_list roots;
+  variable_list root_grads;
+  for (size_t i = 0; i < outputs.size(); i++) {
+    if (outputs[i].defined() && outputs[i].requires_grad() && grads[i].defined()) {
+      roots.push_back(outputs[i].gradient_edge());
+      root_grads.push_back(grads[i]);
+    }
+  }
+  if (!roots.empty()) {
+    engine.execute(roots, root_grads, /*keep_graph=*/false, create_graph);
+  }
+
+  variable_list result(inputs.size());
+  std::copy(input_grads->grads.begin(), input_grads->grads.end(), result.begin());
+  return result;
+}
+
+auto Checkpoint::release_variables() -> void {
+  for (auto& input : inputs) {
+    input.reset_data();
+  }
+  forward = nullptr;
+}
+
+}} // namespace torch::autograd
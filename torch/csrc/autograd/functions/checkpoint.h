@@ -0,0 +1,58 @@
+#pragma once
+
+#include "torch/csrc/autograd/function.h"
+#include "torch/csrc/autograd/saved_variable.h"
+#include "torch/csrc/autograd/variable.h"
+
+#include <ATen/ATen.h>
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace torch { namespace autograd {
+
+// The states of the random number generators a checkpointed segment can draw
+// from: the CPU generator and the generators of the given CUDA devices.
+struct RNGState {
+  explicit RNGState(std::vector<int> devices);
+
+  // Sets the generators back to this state
+  void restore() const;
+
+  std::vector<int> devices;
+  std::unique_ptr<at::Generator> cpu_state;
+  std::vector<at::Tensor> cuda_states;
+};
+
+// Backward of a checkpointed segment of the forward pass (see
+// torch.utils.checkpoint). Instead of the activations of the segment, it saves
+// its inputs and the states of the random number generators before it ran.
+// apply() runs the segment again from them with grad mode on, so that dropout
+// and the like draw the same numbers, and backpropagates the gradients
+// through the graph this builds with a reentrant backward pass. That graph is
+// freed before the gradients move on, and the engine runs these functions
+// only when no other function is ready (see recomputes_forward()), so the
+// activations of a single segment per worker are alive at any point.
+struct Checkpoint : public Function {
+  using forward_fn = std::function<variable_list(const variable_list&)>;
+
+  Checkpoint(forward_fn forward, const variable_list& inputs, RNGState rng_state,
+             edge_list&& next_edges);
+
+  // Runs forward on inputs without recording a graph. If grad mode is on and
+  // an input requires grad, the outputs get a Checkpoint as their grad_fn.
+  static variable_list run(forward_fn forward, const variable_list& inputs);
+
+  virtual variable_list apply(const variable_list& grads) override;
+  virtual void release_variables() override;
+  virtual bool recomputes_forward() override {
+    return true;
+  }
+
+  forward_fn forward;
+  std::vector<SavedVariable> inputs;
+  RNGState rng_state;
+};
+
+}} // namespace torch::autograd
@@ -290,9 +290,11 @@ variable_list Eval::apply(const variable_list& inputs) {
   } else {
     auto& engine = Engine::getDefaultEngine();
     auto exec_data = filterRoots(inputs);
-    auto next_edges = fmap(
-        placeholders,
-        [](const std::shared_ptr<EvalOutput>& o) { return Edge(o, 0); });
+    edge_list next_edges;
+    next_edges.reserve(placeholders.size());
+    for (auto& placeholder : placeholders) {
+      next_edges.emplace_back(placeholder, 0);
+    }
     outputs = engine.execute(exec_data.first, exec_data.second, true, true, next_edges);
   }
 
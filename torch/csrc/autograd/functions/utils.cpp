@@ -55,4 +55,18 @@ void check_input_variables(const char* name, const variable_list& inputs, int ar
     }
   }
 }
+
+bool can_accumulate_inplace(const Variable& variable, int expected_refs) {
+  if (!variable.defined() || variable.is_view() ||
+      static_cast<const at::Tensor&>(variable).get()->use_count() > expected_refs) {
+    return false;
+  }
+  auto& data = variable.data();
+  if (data.type().is_sparse() || !data.is_contiguous() ||
+      data.get()->use_count() != 1) {
+    return false;
+  }
+  // The storage() wrapper holds a reference of its own
+  return data.storage()->use_count() == 2;
+}
 }} // namespace torch::autograd
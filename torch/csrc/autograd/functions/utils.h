@@ -23,4 +23,11 @@ variable_list wrap_outputs(const variable_list& inputs, tensor_list&& outputs,
  * items are not nullptr. If not specified, `required_args` defaults to `args`.
  */
 void check_input_variables(const char* name, const variable_list& inputs, int args, int required_args=-1);
+
+/**
+ * Returns true if nothing but the `expected_refs` references to `variable` can
+ * observe its data, so that gradients can be accumulated into it in place.
+ * Only dense, contiguous variables that are not views qualify.
+ */
+bool can_accumulate_inplace(const Variable& variable, int expected_refs=1);
 }}
@@ -2,9 +2,13 @@
 
 #include "torch/csrc/Exceptions.h"
 #include "torch/csrc/utils/pybind.h"
+#include "torch/csrc/autograd/autocast_mode.h"
 #include "torch/csrc/autograd/grad_mode.h"
 #include "torch/csrc/autograd/profiler.h"
 #include "torch/csrc/autograd/python_function.h"
+#include "torch/csrc/autograd/saved_tensor_hooks.h"
+
+#include <fstream>
 
 PyObject * THPAutograd_initExtension(PyObject *_unused)
 {
@@ -31,17 +35,31 @@ PyObject * THPAutograd_initExtension(PyObject *_unused)
   .def("device",&torch::autograd::profiler::Event::device)
   .def("cpu_elapsed_us",&torch::autograd::profiler::Event::cpu_elapsed_us)
   .def("cuda_elapsed_us",&torch::autograd::profiler::Event::cuda_elapsed_us)
-  .def("has_cuda",&torch::autograd::profiler::Event::has_cuda);
+  .def("has_cuda",&torch::autograd::profiler::Event::has_cuda)
+  .def("memory_usage",&torch::autograd::profiler::Event::memory_usage)
+  .def("shapes",&torch::autograd::profiler::Event::shapes)
+  .def("dtypes",&torch::autograd::profiler::Event::dtypes);
   py::enum_<torch::autograd::profiler::ProfilerState>(m,"ProfilerState")
   .value("Disabled", torch::autograd::profiler::ProfilerState::Disabled)
   .value("CPU", torch::autograd::profiler::ProfilerState::CPU)
   .value("CUDA", torch::autograd::profiler::ProfilerState::CUDA)
   .value("NVTX", torch::autograd::profiler::ProfilerState::NVTX);
 
-  m.def("_enable_profiler", torch::autograd::profiler::enableProfiler);
+  m.def("_enable_profiler", torch::autograd::profiler::enableProfiler,
+        py::arg("state"), py::arg("record_shapes") = false, py::arg("profile_memory") = false);
   m.def("_disable_profiler", torch::autograd::profiler::disableProfiler);
 
-  m.def("_push_range", [](const char *name) {
+  m.def("_export_chrome_trace", [](const torch::autograd::profiler::thread_event_lists& records,
+                                   const std::string& path) {
+    std::ofstream out(path);
+    if (!out) {
+      throw std::runtime_error("could not open " + path + " for writing");
+    }
+    torch::autograd::profiler::writeChromeTrace(records, out);
+  });
+
+  // name is interned by pushRange, the Python string may go away
+  m.def("_push_range", [](const std::string& name) {
     using namespace torch::autograd::profiler;
     if (state  == ProfilerState::Disabled) return;
     pushRange(name);
@@ -52,6 +70,19 @@ PyObject * THPAutograd_initExtension(PyObject *_unused)
     popRange();
   });
 
+  using torch::autograd::SavedTensorHooks;
+  py::class_<SavedTensorHooks, std::shared_ptr<SavedTensorHooks>>(m, "_SavedTensorHooks");
+  py::class_<torch::autograd::OffloadHooks, SavedTensorHooks,
+             std::shared_ptr<torch::autograd::OffloadHooks>>(m, "_OffloadHooks")
+  .def(py::init<int64_t, int64_t>());
+  py::class_<torch::autograd::CompressionHooks, SavedTensorHooks,
+             std::shared_ptr<torch::autograd::CompressionHooks>>(m, "_CompressionHooks")
+  .def(py::init<int64_t>());
+  m.def("_get_saved_tensor_hooks", &SavedTensorHooks::get);
+  m.def("_set_saved_tensor_hooks", [](py::object hooks) {
+    SavedTensorHooks::set(hooks.is_none() ? nullptr : hooks.cast<std::shared_ptr<SavedTensorHooks>>());
+  });
+
   Py_RETURN_TRUE;
 }
 
@@ -77,10 +108,32 @@ static PyObject * is_grad_enabled(PyObject* _unused, PyObject *arg) {
   END_HANDLE_TH_ERRORS
 }
 
+static PyObject * set_autocast_enabled(PyObject* _unused, PyObject *arg) {
+  HANDLE_TH_ERRORS
+  if (!PyBool_Check(arg)) {
+    throw TypeError("enabled must be a bool (got %s)", Py_TYPE(arg)->tp_name);
+  }
+  AutocastMode::set_enabled(arg == Py_True);
+  Py_RETURN_NONE;
+  END_HANDLE_TH_ERRORS
+}
+
+static PyObject * is_autocast_enabled(PyObject* _unused, PyObject *arg) {
+  HANDLE_TH_ERRORS
+  if (AutocastMode::is_enabled()) {
+    Py_RETURN_TRUE;
+  } else {
+    Py_RETURN_FALSE;
+  }
+  END_HANDLE_TH_ERRORS
+}
+
 // autograd methods on torch._C
 static PyMethodDef methods[] = {
   {"set_grad_enabled", (PyCFunction)set_grad_enabled, METH_O, nullptr},
   {"is_grad_enabled", (PyCFunction)is_grad_enabled, METH_NOARGS, nullptr},
+  {"set_autocast_enabled", (PyCFunction)set_autocast_enabled, METH_O, nullptr},
+  {"is_autocast_enabled", (PyCFunction)is_autocast_enabled, METH_NOARGS, nullptr},
   {nullptr, nullptr, 0, nullptr}
 };
 
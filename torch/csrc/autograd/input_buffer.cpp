@@ -2,6 +2,8 @@
 
 #include "torch/csrc/assertions.h"
 #include "torch/csrc/autograd/functions/basic_ops.h"
+#include "torch/csrc/autograd/functions/utils.h"
+#include "torch/csrc/autograd/grad_mode.h"
 #include "torch/csrc/utils/auto_gpu.h"
 
 namespace torch { namespace autograd {
@@ -17,8 +19,17 @@ void InputBuffer::add(size_t pos, Variable var) {
     buffer[pos] = std::move(var);
   } else {
     AutoGPU auto_gpu(var);
-    // ATen doesn't route sparse additions correctly...
-    if (old_var.type().is_sparse()) {
+    // Unless the backward pass is differentiated, gradients are summed into
+    // whichever of the two can't be observed by anyone else
+    bool may_reuse = !GradMode::is_enabled() &&
+        old_var.type() == var.type() && old_var.sizes().equals(var.sizes());
+    if (may_reuse && can_accumulate_inplace(old_var)) {
+      old_var.data().add_(var.data());
+    } else if (may_reuse && can_accumulate_inplace(var)) {
+      var.data().add_(old_var.data());
+      buffer[pos] = std::move(var);
+    } else if (old_var.type().is_sparse()) {
+      // ATen doesn't route sparse additions correctly...
       buffer[pos] = var + old_var;
     } else {
       buffer[pos] = old_var + var;
@@ -35,6 +46,22 @@ auto InputBuffer::device() const -> int {
   return -1;
 }
 
+auto InputBuffer::nbytes() const -> int64_t {
+  int64_t result = 0;
+  for (auto& var : buffer) {
+    if (!var.defined()) continue;
+    if (var.type().is_sparse()) {
+      auto values = var.data()._values();
+      auto indices = var.data()._indices();
+      result += values.numel() * values.type().elementSizeInBytes();
+      result += indices.numel() * indices.type().elementSizeInBytes();
+    } else {
+      result += var.numel() * var.type().elementSizeInBytes();
+    }
+  }
+  return result;
+}
+
 auto InputBuffer::variables(InputBuffer&& g) -> std::vector<Variable> {
   std::vector<Variable> result = std::move(g.buffer);
   return result;
@@ -26,6 +26,9 @@ struct InputBuffer {
 
   int device() const;
 
+  // The number of bytes taken by the gradients in the buffer.
+  int64_t nbytes() const;
+
   Variable operator[](std::size_t pos) { return buffer[pos]; }
 
   // Returns the inputs as a list of variables. Destroys given InputBuffer.
@@ -1,9 +1,21 @@
 #include "torch/csrc/autograd/profiler.h"
 #include "torch/csrc/autograd/function.h"
 
+#include <TH/THAllocator.h>
+#ifdef WITH_CUDA
+#include <THC/THCCachingAllocator.h>
+#endif
+
+#include <cstring>
+#include <iomanip>
+#include <unordered_map>
+#include <unordered_set>
+
 namespace torch { namespace autograd { namespace profiler {
 
 ProfilerState state = ProfilerState::Disabled;
+bool record_input_shapes = false;
+bool profile_memory = false;
 uint32_t next_thread_id = 0;
 std::mutex all_event_lists_mutex;
 std::list<std::shared_ptr<RangeEventList>> all_event_lists;
@@ -14,6 +26,87 @@ void RecordFunction::pushFunctionRange(Function* fn) {
   pushRange(fn->name());
 }
 
+const char* internName(const std::string& name) {
+  // Each thread remembers the names it has seen, so that only new names take
+  // the global lock. The global set is leaked on purpose: interned names have
+  // to outlive any thread_local cache.
+  thread_local std::unordered_map<std::string, const char*> cache;
+  auto it = cache.find(name);
+  if (it != cache.end()) {
+    return it->second;
+  }
+  static std::mutex names_mutex;
+  static auto names = new std::unordered_set<std::string>();
+  const char* interned;
+  {
+    std::lock_guard<std::mutex> guard(names_mutex);
+    interned = names->insert(name).first->c_str();
+  }
+  cache.emplace(name, interned);
+  return interned;
+}
+
+#ifdef WITH_CUDA
+static std::mutex cuda_events_mutex;
+static std::vector<std::vector<cudaEvent_t>> cuda_events;
+
+cudaEvent_t getCUDAEvent(int device) {
+  {
+    std::lock_guard<std::mutex> guard(cuda_events_mutex);
+    if ((size_t)device < cuda_events.size() && !cuda_events[device].empty()) {
+      cudaEvent_t event = cuda_events[device].back();
+      cuda_events[device].pop_back();
+      return event;
+    }
+  }
+  cudaEvent_t event;
+  TORCH_CUDA_CHECK(cudaEventCreate(&event));
+  return event;
+}
+
+void releaseCUDAEvent(int device, cudaEvent_t event) {
+  std::lock_guard<std::mutex> guard(cuda_events_mutex);
+  if ((size_t)device >= cuda_events.size()) {
+    cuda_events.resize(device + 1);
+  }
+  cuda_events[device].push_back(event);
+}
+
+// Resolves all CUDA events against the "__cuda_start_event" mark of their
+// device, see Event::resolveCUDA.
+static void resolveCUDAEvents(thread_event_lists& lists) {
+  std::unordered_map<int, std::pair<Event*, cudaEvent_t>> start_events;
+  for (auto& list : lists) {
+    for (auto& e : list) {
+      if (e.has_cuda() && std::strcmp(e.name(), "__cuda_start_event") == 0) {
+        start_events[e.device()] = std::make_pair(&e, e.cuda_event());
+      }
+    }
+  }
+  for (auto& list : lists) {
+    for (auto& e : list) {
+      if (!e.has_cuda() || !e.cuda_event()) {
+        continue;
+      }
+      auto it = start_events.find(e.device());
+      if (it == start_events.end()) {
+        // no start event was recorded on this device
+        releaseCUDAEvent(e.device(), e.cuda_event());
+        continue;
+      }
+      if (&e != it->second.first) {
+        e.resolveCUDA(*it->second.first, it->second.second);
+      }
+    }
+  }
+  for (auto& entry : start_events) {
+    Event& start = *entry.second.first;
+    start.resolveCUDA(start, entry.second.second);
+    releaseCUDAEvent(entry.first, entry.second.second);
+  }
+}
+#endif
+
 #ifdef WITH_CUDA
 static void onEachDevice(std::function<void(int)> op) {
   AutoGPU gpu_guard;
@@ -26,7 +119,31 @@ static void onEachDevice(std::function<void(int)> op) {
 }
 #endif
 
-void enableProfiler(ProfilerState new_state) {
+void reportMemoryUsage(int64_t memory_usage, int device) {
+  if (!profile_memory || state == ProfilerState::Disabled || state == ProfilerState::NVTX) {
+    return;
+  }
+  getEventList().record(EventKind::MemoryAlloc, "[memory]", thread_id, memory_usage, device);
+}
+
+static void reportCPUMemoryUsage(void* ptr, ptrdiff_t size) {
+  reportMemoryUsage(size, -1);
+}
+
+#ifdef WITH_CUDA
+static void reportCUDAMemoryUsage(void* ptr, int64_t size, int device) {
+  reportMemoryUsage(size, device);
+}
+#endif
+
+static void setMemoryReportHandlers(bool enabled) {
+  THDefaultAllocator_setReportHandler(enabled ? &reportCPUMemoryUsage : nullptr);
+#ifdef WITH_CUDA
+  THCCachingAllocator_setReportHandler(enabled ? &reportCUDAMemoryUsage : nullptr);
+#endif
+}
+
+void enableProfiler(ProfilerState new_state, bool record_shapes, bool profile_memory_) {
   TORCH_ASSERT(new_state != ProfilerState::Disabled);
 #ifndef WITH_CUDA
   if (new_state == ProfilerState::NVTX)
@@ -36,6 +153,11 @@ void enableProfiler(ProfilerState new_state) {
       throw std::runtime_error("can't change kind of profiling (e.g. NVTX to CPU) while profiler is running");
   }
   state = new_state;
+  record_input_shapes = record_shapes;
+  profile_memory = profile_memory_;
+  if (profile_memory) {
+    setMemoryReportHandlers(true);
+  }
 
 #ifdef WITH_CUDA
   if(state == ProfilerState::CUDA) {
@@ -66,25 +188,114 @@ thread_event_lists disableProfiler() {
   ProfilerState old_state = state;
   mark("__stop_profile");
   state = ProfilerState::Disabled;
+  if (profile_memory) {
+    setMemoryReportHandlers(false);
+  }
+  record_input_shapes = false;
+  profile_memory = false;
   if (old_state == ProfilerState::NVTX) {
     return thread_event_lists();
   } else {
     thread_event_lists result;
-    std::lock_guard<std::mutex> guard(all_event_lists_mutex);
-    for (auto it = all_event_lists.begin(); it != all_event_lists.end();) {
-      auto & list = *it;
-      result.emplace_back(list->consolidate());
-      // GC lists that are not held by any threads
-      if (list.use_count() == 1) {
-        auto current_it = it;
-        ++it;
-        all_event_lists.erase(current_it);
-      } else {
-        ++it;
+    {
+      std::lock_guard<std::mutex> guard(all_event_lists_mutex);
+      for (auto it = all_event_lists.begin(); it != all_event_lists.end();) {
+        auto & list = *it;
+        result.emplace_back(list->consolidate());
+        // GC lists that are not held by any threads
+        if (list.use_count() == 1) {
+          auto current_it = it;
+          ++it;
+          all_event_lists.erase(current_it);
+        } else {
+          ++it;
+        }
       }
     }
+#ifdef WITH_CUDA
+    if (old_state == ProfilerState::CUDA) {
+      resolveCUDAEvents(result);
+    }
+#endif
     return result;
   }
 }
 
+static void writeJSONString(std::ostream& out, const char* str) {
+  out << '"';
+  for (const char* c = str; *c; c++) {
+    switch (*c) {
+      case '"': out << "\\\""; break;
+      case '\\': out << "\\\\"; break;
+      case '\n': out << "\\n"; break;
+      default:
+        if ((unsigned char)*c < 0x20) {
+          out << "\\u" << std::hex << std::setw(4) << std::setfill('0') << (int)*c
+              << std::dec << std::setfill(' ');
+        } else {
+          out << *c;
+        }
+    }
+  }
+  out << '"';
+}
+
+void writeChromeTrace(const thread_event_lists& lists, std::ostream& out) {
+  // Profiling may start on any thread, so find the start mark first.
+  const Event* start = nullptr;
+  std::unordered_map<int, const Event*> cuda_starts;
+  for (auto& list : lists) {
+    for (auto& e : list) {
+      if (std::strcmp(e.name(), "__start_profile") == 0) {
+        start = &e;
+      } else if (e.has_cuda() && std::strcmp(e.name(), "__cuda_start_event") == 0) {
+        cuda_starts[e.device()] = &e;
+      }
+    }
+  }
+  if (!start) {
+    throw std::runtime_error("writeChromeTrace: no __start_profile event found");
+  }
+
+  // As in torch/autograd/profiler.py, CUDA times are shifted by the CPU time
+  // between the start of profiling and the start event of their device.
+  auto cuda_time = [&](const Event& e) {
+    const Event& cuda_start = *cuda_starts.at(e.device());
+    return cuda_start.cuda_elapsed_us(e) +
+           start->cpu_elapsed_us(cuda_start);
+  };
+  auto write_event = [&](bool& first, const char* name, double ts, double dur,
+                         const char* pid, int64_t tid) {
+    out << (first ? "\n" : ",\n") << "{\"name\": ";
+    writeJSONString(out, name);
+    out << ", \"ph\": \"X\", \"ts\": " << ts << ", \"dur\": " << dur
+        << ", \"pid\": \"" << pid << "\", \"tid\": " << tid << ", \"args\": {}}";
+    first = false;
+  };
+
+  bool first = true;
+  out << std::fixed << std::setprecision(3) << "[";
+  std::vector<const Event*> stack;
+  for (auto& list : lists) {
+    stack.clear();
+    for (auto& e : list) {
+      if (e.kind() == "push") {
+        stack.push_back(&e);
+      } else if (e.kind() == "pop" && !stack.empty()) {
+        const Event& push = *stack.back();
+        stack.pop_back();
+        double ts = start->cpu_elapsed_us(push);
+        write_event(first, push.name(), ts, push.cpu_elapsed_us(e),
+                    "CPU functions", push.thread_id());
+        if (push.has_cuda() && cuda_starts.count(push.device())) {
+          double cuda_ts = cuda_time(push);
+          write_event(first, push.name(), cuda_ts, cuda_time(e) - cuda_ts,
+                      "CUDA functions", push.device());
+        }
+      }
+    }
+  }
+  out << "\n]\n";
+}
+
 }}}
@@ -15,6 +15,7 @@
 #include <forward_list>
 #include <tuple>
 #include "ATen/ATen.h"
+#include "TH/THStaticTracepoint.h"
 #include "torch/csrc/cuda/cuda_check.h"
 #ifdef WITH_CUDA
 #include <cuda_runtime.h>
@@ -39,18 +40,33 @@ inline uint64_t getTime() {
 enum class EventKind {
   Mark,
   PushRange,
-  PopRange
+  PopRange,
+  MemoryAlloc
 };
 
+// Returns a pointer to a copy of name that lives until the end of the
+// process, the same pointer for equal names. Events store names as such
+// pointers (or as string literals) so that recording one doesn't allocate.
+const char* internName(const std::string& name);
+
+#ifdef WITH_CUDA
+// CUDA events are recycled across profiling sessions; creating one for every
+// recorded event would dominate the cost of profiling.
+cudaEvent_t getCUDAEvent(int device);
+void releaseCUDAEvent(int device, cudaEvent_t event);
+#endif
+
 struct Event {
-  Event(EventKind kind, std::string name, uint32_t thread_id, bool record_cuda)
+  // name must be a string literal or come from internName().
+  Event(EventKind kind, const char* name, uint32_t thread_id, bool record_cuda)
   : kind_(kind)
-  , name_(std::move(name))
+  , name_(name)
   , thread_id_(thread_id) {
 #ifdef WITH_CUDA
     if(record_cuda) {
       TORCH_CUDA_CHECK(cudaGetDevice(&device_));
-      TORCH_CUDA_CHECK(cudaEventCreate(&event));
+      event = getCUDAEvent(device_);
+      has_cuda_ = true;
       auto stream = at::globalContext().getCurrentCUDAStream();
       cpu_ns_ = getTime();
       TORCH_CUDA_CHECK(cudaEventRecord(event, stream));
@@ -61,24 +77,34 @@ struct Event {
     cpu_ns_ = getTime();
 #endif
   }
+  // An allocation (positive memory_usage) or free (negative memory_usage) in
+  // bytes, by the CPU allocator (device -1) or the CUDA caching allocator.
+  Event(EventKind kind, const char* name, uint32_t thread_id, int64_t memory_usage, int device)
+  : kind_(kind)
+  , name_(name)
+  , thread_id_(thread_id)
+  , cpu_ns_(getTime())
+  , memory_usage_(memory_usage)
+  , device_(device) {}
   std::string kind() const {
     switch(kind_) {
       case EventKind::Mark: return "mark";
       case EventKind::PushRange: return "push";
       case EventKind::PopRange: return "pop";
+      case EventKind::MemoryAlloc: return "memory";
     }
     throw std::runtime_error("unknown EventKind");
   }
-  const std::string & name() const {
+  const char* name() const {
     return name_;
   }
   uint32_t thread_id() const {
     return thread_id_;
   }
-  double cpu_elapsed_us(const Event & e) {
+  double cpu_elapsed_us(const Event & e) const {
     return (e.cpu_ns_ - cpu_ns_)/(1000.0);
   }
-  double cuda_elapsed_us(const Event & e) {
+  double cuda_elapsed_us(const Event & e) const {
 #ifdef WITH_CUDA
     if(!e.has_cuda() || !has_cuda()) {
       throw std::logic_error("Events were not recorded for CUDA");
@@ -86,6 +112,10 @@ struct Event {
     if(e.device() != device()) {
       throw std::logic_error("Events are not on the same device");
     }
+    if (!event && !e.event) {
+      // both were resolved by disableProfiler()
+      return e.cuda_us_ - cuda_us_;
+    }
     TORCH_CUDA_CHECK(cudaEventSynchronize(event));
     TORCH_CUDA_CHECK(cudaEventSynchronize(e.event));
     float ms;
@@ -96,24 +126,63 @@ struct Event {
 #endif
   }
   bool has_cuda() const {
-#ifdef WITH_CUDA
-    return event != nullptr;
-#else
-    return false;
-#endif
+    return has_cuda_;
   }
   int device() const {
     return device_;
   }
+  int64_t memory_usage() const {
+    return memory_usage_;
+  }
+  // Shapes and scalar types of the tensor inputs of a range, recorded only if
+  // the profiler was enabled with record_shapes. An undefined tensor has an
+  // empty shape and type "Undefined".
+  const std::vector<std::vector<int64_t>>& shapes() const {
+    return shapes_;
+  }
+  const std::vector<const char*>& dtypes() const {
+    return dtypes_;
+  }
+  void addInput(const at::Tensor& tensor) {
+    if (tensor.defined()) {
+      shapes_.push_back(tensor.sizes().vec());
+      dtypes_.push_back(at::toString(tensor.type().scalarType()));
+    } else {
+      shapes_.emplace_back();
+      dtypes_.push_back("Undefined");
+    }
+  }
+#ifdef WITH_CUDA
+  // Replaces the CUDA event by its time relative to 'start' (an event on the
+  // same device) and gives the event back to the pool. Waits for the event.
+  void resolveCUDA(const Event& start, cudaEvent_t start_event) {
+    float ms;
+    TORCH_CUDA_CHECK(cudaEventSynchronize(event));
+    TORCH_CUDA_CHECK(cudaEventElapsedTime(&ms, start_event, event));
+    cuda_us_ = ms * 1000.0;
+    if (event != start_event) {
+      releaseCUDAEvent(device_, event);
+    }
+    event = nullptr;
+  }
+  cudaEvent_t cuda_event() const {
+    return event;
+  }
+#endif
 private:
   EventKind kind_;
-  std::string name_;
+  const char* name_;
   uint32_t thread_id_;
   int64_t cpu_ns_; // signed to allow for negative intervals
 #ifdef WITH_CUDA
   cudaEvent_t event = nullptr;
 #endif
+  double cuda_us_ = 0; // set by resolveCUDA
+  bool has_cuda_ = false;
+  int64_t memory_usage_ = 0;
   int device_ = -1;
+  std::vector<std::vector<int64_t>> shapes_;
+  std::vector<const char*> dtypes_;
 };
 
 // a linked-list of fixed sized vectors, to avoid
@@ -141,6 +210,11 @@ struct RangeEventList {
     blocks.front().emplace_back(std::forward<Args>(args)...);
   }
 
+  // The last recorded event.
+  Event& back() {
+    return blocks.front().back();
+  }
+
   std::vector<Event> consolidate() {
     std::vector<Event> result;
     for (auto & block : blocks) {
@@ -163,6 +237,9 @@ enum class ProfilerState {
 };
 
 extern ProfilerState state;
+// options of the running profiler, see enableProfiler()
+extern bool record_input_shapes;
+extern bool profile_memory;
 extern uint32_t next_thread_id;
 extern std::mutex all_event_lists_mutex;
 extern std::list<std::shared_ptr<RangeEventList>> all_event_lists;
@@ -180,30 +257,41 @@ inline RangeEventList& getEventList() {
   return *event_list;
 }
 
-inline void mark(std::string name, bool include_cuda = true) {
+// The const char* overloads of mark() and pushRange() keep the pointer, so
+// name must be a string literal (or otherwise live until the end of the
+// process). The std::string overloads intern the name first.
+inline void mark(const char* name, bool include_cuda = true) {
   if (state == ProfilerState::NVTX) {
 #ifdef WITH_CUDA
-    nvtxMarkA(name.c_str());
+    nvtxMarkA(name);
 #else
     throw std::logic_error("mark called with NVTX tracing, but compiled without CUDA");
 #endif
   } else {
-    getEventList().record(EventKind::Mark, std::move(name), thread_id, include_cuda && state == ProfilerState::CUDA);
+    getEventList().record(EventKind::Mark, name, thread_id, include_cuda && state == ProfilerState::CUDA);
   }
 }
 
-inline void pushRange(std::string name) {
+inline void mark(const std::string& name, bool include_cuda = true) {
+  mark(state == ProfilerState::NVTX ? name.c_str() : internName(name), include_cuda);
+}
+
+inline void pushRange(const char* name) {
   if (state == ProfilerState::NVTX) {
 #ifdef WITH_CUDA
-    nvtxRangePushA(name.c_str());
+    nvtxRangePushA(name);
 #else
     throw std::logic_error("pushRange called with NVTX tracing, but compiled without CUDA");
 #endif
   } else {
-    getEventList().record(EventKind::PushRange, std::move(name), thread_id, state == ProfilerState::CUDA);
+    getEventList().record(EventKind::PushRange, name, thread_id, state == ProfilerState::CUDA);
   }
 }
 
+inline void pushRange(const std::string& name) {
+  pushRange(state == ProfilerState::NVTX ? name.c_str() : internName(name));
+}
+
 inline void popRange() {
   if (state == ProfilerState::NVTX) {
 #ifdef WITH_CUDA
@@ -212,40 +300,116 @@ inline void popRange() {
     throw std::logic_error("popRange called with NVTX tracing, but compiled without CUDA");
 #endif
   } else {
-    getEventList().record(EventKind::PopRange, std::string(), thread_id, state == ProfilerState::CUDA);
+    getEventList().record(EventKind::PopRange, "", thread_id, state == ProfilerState::CUDA);
+  }
+}
+
+inline void recordInputs(Event& e) {}
+template <typename... Inputs>
+void recordInputs(Event& e, const at::Tensor& input, const Inputs&... inputs);
+template <typename... Inputs>
+void recordInputs(Event& e, at::TensorList input, const Inputs&... inputs);
+
+template <typename... Inputs>
+void recordInputs(Event& e, const at::Tensor& input, const Inputs&... inputs) {
+  e.addInput(input);
+  recordInputs(e, inputs...);
+}
+
+template <typename... Inputs>
+void recordInputs(Event& e, at::TensorList input, const Inputs&... inputs) {
+  for (auto& tensor : input) {
+    e.addInput(tensor);
+  }
+  recordInputs(e, inputs...);
+}
+
+// Fire the op_start probe (see TH/THStaticTracepoint.h) with the sizes of
+// the first tensor input
+inline void sdtOpStart(const char *name, const at::Tensor& input) {
+  if (input.defined()) {
+    TH_SDT(op_start, name, input.sizes().data(), input.dim());
+  } else {
+    TH_SDT(op_start, name, (const int64_t*)nullptr, (int64_t)0);
+  }
+}
+
+inline void sdtOpStart(const char *name, at::TensorList input) {
+  if (!input.empty()) {
+    sdtOpStart(name, input[0]);
+  } else {
+    TH_SDT(op_start, name, (const int64_t*)nullptr, (int64_t)0);
   }
 }
 
+// Records a memory event in the current range, see Event. Does nothing unless
+// the profiler is enabled with profile_memory.
+void reportMemoryUsage(int64_t memory_usage, int device);
+
 struct RecordFunction {
   explicit RecordFunction(Function *fn) {
     if (state == ProfilerState::Disabled) return;
     pushFunctionRange(fn);
   }
 
-  explicit RecordFunction(std::string name) {
+  explicit RecordFunction(const std::string& name) {
     if (state == ProfilerState::Disabled) return;
-    pushRange(std::move(name));
+    pushRange(name);
   }
 
-  explicit RecordFunction(const char *name) {
+  // name must be a string literal, see pushRange()
+  explicit RecordFunction(const char *name) : sdt_name(name) {
+    TH_SDT(op_start, name, (const int64_t*)nullptr, (int64_t)0);
     if (state == ProfilerState::Disabled) return;
     pushRange(name);
   }
 
+  // Also records the shapes of the tensor (and tensor list) inputs if the
+  // profiler was enabled with record_shapes.
+  template <typename Input, typename... Inputs>
+  RecordFunction(const char *name, const Input& input, const Inputs&... inputs)
+      : sdt_name(name) {
+    sdtOpStart(name, input);
+    if (state == ProfilerState::Disabled) return;
+    pushRange(name);
+    if (record_input_shapes && state != ProfilerState::NVTX) {
+      recordInputs(getEventList().back(), input, inputs...);
+    }
+  }
+
   ~RecordFunction() {
+    if (sdt_name) {
+      TH_SDT(op_end, sdt_name);
+    }
     if (state == ProfilerState::Disabled) return;
     popRange();
   }
 
   // Needed only because we don't have Function defined yet.
   void pushFunctionRange(Function *fn);
+
+private:
+  // The operator name for the op_start/op_end probes, only the string
+  // literal constructors (used by VariableType) fire them
+  const char *sdt_name = nullptr;
 };
 
 using thread_event_lists = std::vector<std::vector<Event>>;
 // NOTE: changing profiler modes is **NOT THREAD SAFE**. You should ensure that
 // there no autograd functions are being executed when these function are used.
-void enableProfiler(ProfilerState state);
+// record_shapes makes RecordFunction record the shapes of the inputs of
+// operators, and profile_memory records every allocation and free of the
+// CPU allocator and the CUDA caching allocator as a memory event, which can
+// be attributed to the innermost enclosing range.
+void enableProfiler(ProfilerState state, bool record_shapes = false, bool profile_memory = false);
+// In CUDA mode, waits for the recorded CUDA events and resolves their times,
+// so that the events can be recycled and cuda_elapsed_us() doesn't have to
+// synchronize.
 thread_event_lists disableProfiler();
 
+// Writes the ranges in lists in the Chrome trace event format (see
+// chrome://tracing), with times relative to the start of profiling.
+void writeChromeTrace(const thread_event_lists& lists, std::ostream& out);
+
 } // namespace profiler
 }} // namespace torch::autograd
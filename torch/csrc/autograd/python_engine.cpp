@@ -6,6 +6,7 @@
 #include "torch/csrc/autograd/engine.h"
 #include "torch/csrc/autograd/function.h"
 #include "torch/csrc/autograd/edge.h"
+#include "torch/csrc/autograd/functions/checkpoint.h"
 #include "torch/csrc/autograd/python_function.h"
 #include "torch/csrc/utils/auto_gil.h"
 
@@ -208,6 +209,93 @@ PyObject* THPEngine_is_checkpoint_valid(PyObject *self) {
   END_HANDLE_TH_ERRORS
 }
 
+PyObject* THPEngine_set_num_cpu_workers(PyObject *self, PyObject *arg) {
+  HANDLE_TH_ERRORS
+  THPUtils_assert(THPUtils_checkLong(arg), "set_num_cpu_workers expects an int, "
+          "but got %s", THPUtils_typename(arg));
+  engine.set_num_cpu_workers(THPUtils_unpackLong(arg));
+  Py_RETURN_NONE;
+  END_HANDLE_TH_ERRORS
+}
+
+PyObject* THPEngine_get_num_cpu_workers(PyObject *self) {
+  HANDLE_TH_ERRORS
+  return PyLong_FromLong(engine.get_num_cpu_workers());
+  END_HANDLE_TH_ERRORS
+}
+
+PyObject* THPEngine_last_peak_grad_bytes(PyObject *self) {
+  HANDLE_TH_ERRORS
+  return PyLong_FromLongLong(engine.last_peak_grad_bytes());
+  END_HANDLE_TH_ERRORS
+}
+
+// Implementation of torch._C._EngineBase.checkpoint, which runs function on
+// the tuple of tensors inputs and returns its outputs with a Checkpoint as
+// their grad_fn. function must return a tuple of tensors.
+PyObject *THPEngine_checkpoint(THPEngine *self, PyObject *args)
+{
+  HANDLE_TH_ERRORS
+  _maybe_reinitialize_engine_after_fork();
+  PyObject *function = nullptr;
+  PyObject *inputs = nullptr;
+  if (!PyArg_ParseTuple(args, "OO", &function, &inputs))
+    return nullptr;
+  THPUtils_assert(PyCallable_Check(function), "function argument is expected "
+      "to be callable, but got %s", THPUtils_typename(function));
+  THPUtils_assert(PyTuple_Check(inputs), "inputs argument is expected to "
+      "be a tuple, but got %s", THPUtils_typename(inputs));
+
+  Py_ssize_t num_inputs = PyTuple_GET_SIZE(inputs);
+  variable_list input_vars;
+  input_vars.reserve(num_inputs);
+  for (int i = 0; i < num_inputs; i++) {
+    PyObject *input = PyTuple_GET_ITEM(inputs, i);
+    THPUtils_assert(THPVariable_Check(input), "element %d of inputs "
+        "tuple is not a Tensor", i);
+    input_vars.push_back(((THPVariable*)input)->cdata);
+  }
+
+  // The function is called again, and released, by the engine threads
+  Py_INCREF(function);
+  std::shared_ptr<PyObject> fn(function, [](PyObject *obj) { AutoGIL gil; Py_DECREF(obj); });
+  auto forward = [fn](const variable_list& inputs) {
+    AutoGIL gil;
+    THPObjectPtr py_inputs(PyTuple_New(inputs.size()));
+    if (!py_inputs) throw python_error();
+    for (size_t i = 0; i < inputs.size(); i++) {
+      PyTuple_SET_ITEM(py_inputs.get(), i, THPVariable_Wrap(inputs[i]));
+    }
+    THPObjectPtr py_outputs(PyObject_CallObject(fn.get(), py_inputs));
+    if (!py_outputs) throw python_error();
+    if (!PyTuple_Check(py_outputs.get())) {
+      throw TypeError("checkpointed function must return a tuple of Tensors, but got %s",
+          THPUtils_typename(py_outputs.get()));
+    }
+    Py_ssize_t num_outputs = PyTuple_GET_SIZE(py_outputs.get());
+    variable_list outputs;
+    outputs.reserve(num_outputs);
+    for (int i = 0; i < num_outputs; i++) {
+      PyObject *output = PyTuple_GET_ITEM(py_outputs.get(), i);
+      if (!THPVariable_Check(output)) {
+        throw TypeError("element %d of the outputs of a checkpointed function is not "
+            "a Tensor, but %s", i, THPUtils_typename(output));
+      }
+      outputs.push_back(((THPVariable*)output)->cdata);
+    }
+    return outputs;
+  };
+  auto outputs = Checkpoint::run(std::move(forward), input_vars);
+
+  THPObjectPtr py_outputs(PyTuple_New(outputs.size()));
+  if (!py_outputs) return nullptr;
+  for (size_t i = 0; i < outputs.size(); i++) {
+    PyTuple_SET_ITEM(py_outputs.get(), i, THPVariable_Wrap(outputs[i]));
+  }
+  return py_outputs.release();
+  END_HANDLE_TH_ERRORS
+}
+
 PyObject *THPEngine_new(PyTypeObject *type, PyObject *args, PyObject *kwargs)
 {
   return type->tp_alloc(type, 0);
@@ -217,6 +305,10 @@ static struct PyMethodDef THPEngine_methods[] = {
   {(char*)"run_backward", (PyCFunction)THPEngine_run_backward, METH_VARARGS | METH_KEYWORDS, nullptr},
   {(char*)"queue_callback", (PyCFunction)THPEngine_queue_callback, METH_O, nullptr},
   {(char*)"is_checkpoint_valid", (PyCFunction)THPEngine_is_checkpoint_valid, METH_NOARGS, nullptr},
+  {(char*)"checkpoint", (PyCFunction)THPEngine_checkpoint, METH_VARARGS, nullptr},
+  {(char*)"set_num_cpu_workers", (PyCFunction)THPEngine_set_num_cpu_workers, METH_O, nullptr},
+  {(char*)"get_num_cpu_workers", (PyCFunction)THPEngine_get_num_cpu_workers, METH_NOARGS, nullptr},
+  {(char*)"last_peak_grad_bytes", (PyCFunction)THPEngine_last_peak_grad_bytes, METH_NOARGS, nullptr},
   {nullptr}
 };
 
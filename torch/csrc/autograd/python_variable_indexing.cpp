@@ -4,9 +4,11 @@
 #include "torch/csrc/Exceptions.h"
 #include "torch/csrc/THP_export.h"
 #include "torch/csrc/autograd/function.h"
+#include "torch/csrc/autograd/grad_mode.h"
 #include "torch/csrc/autograd/python_variable.h"
 #include "torch/csrc/autograd/utils/wrap_outputs.h"
 #include "torch/csrc/autograd/variable.h"
+#include "torch/csrc/jit/tracer.h"
 #include "torch/csrc/utils/python_compat.h"
 #include "torch/csrc/utils/python_numbers.h"
 #include "torch/csrc/utils/tensor_new.h"
@@ -169,6 +171,83 @@ static Variable applySlicing(const Variable& self, PyObject* index, variable_lis
   return result;
 }
 
+// Basic indexing of a tuple of integers, slices, None and at most one
+// ellipsis, in a single step: computes the sizes, strides and offset of the
+// result and returns one as_strided view, where applySlicing makes a select,
+// slice or unsqueeze view per index. Tensors that need a history or are
+// traced take applySlicing's path, which records the precise views (their
+// backward is cheaper than as_strided's). Returns an undefined Variable if the
+// index isn't basic.
+static Variable applyBasicIndexing(const Variable& self, PyObject* index) {
+  if (!PyTuple_Check(index) || self.dim() == 0 || self.type().is_sparse() ||
+      (GradMode::is_enabled() && self.requires_grad()) || jit::tracer::isTracing(self)) {
+    return Variable();
+  }
+  auto size = PyTuple_GET_SIZE(index);
+  int64_t specified_dims = 0;
+  bool has_ellipsis = false;
+  for (Py_ssize_t i = 0; i < size; i++) {
+    PyObject* obj = PyTuple_GET_ITEM(index, i);
+    if (THPUtils_checkLong(obj) || PySlice_Check(obj)) {
+      specified_dims++;
+    } else if (obj == Py_Ellipsis && !has_ellipsis) {
+      has_ellipsis = true;
+    } else if (obj != Py_None) {
+      return Variable();
+    }
+  }
+  if (specified_dims > self.dim()) {
+    throw IndexError("too many indices for tensor of dimension %d", (int)self.dim());
+  }
+
+  std::vector<int64_t> sizes;
+  std::vector<int64_t> strides;
+  int64_t offset = self.storage_offset();
+  int64_t dim = 0;
+  for (Py_ssize_t i = 0; i < size; i++) {
+    PyObject* obj = PyTuple_GET_ITEM(index, i);
+    if (THPUtils_checkLong(obj)) {
+      int64_t idx = THPUtils_unpackLong(obj);
+      int64_t dim_size = self.size(dim);
+      if (idx < -dim_size || idx >= dim_size) {
+        throw IndexError("index %lld is out of bounds for dimension %lld with size %lld",
+          idx, dim, dim_size);
+      }
+      offset += (idx < 0 ? idx + dim_size : idx) * self.stride(dim);
+      dim++;
+    } else if (PySlice_Check(obj)) {
+      Py_ssize_t start, stop, step, slicelength;
+      if (!THPUtils_parseSlice(obj, self.size(dim), &start, &stop, &step, &slicelength)) {
+        throw python_error();
+      }
+      if (step == 0) {
+        throw ValueError("step cannot be zero");
+      }
+      if (step < 0) {
+        throw ValueError("negative step not yet supported");
+      }
+      sizes.push_back(slicelength);
+      strides.push_back(step * self.stride(dim));
+      offset += start * self.stride(dim);
+      dim++;
+    } else if (obj == Py_Ellipsis) {
+      for (int64_t end = dim + self.dim() - specified_dims; dim < end; dim++) {
+        sizes.push_back(self.size(dim));
+        strides.push_back(self.stride(dim));
+      }
+    } else {
+      // the stride unsqueeze gives a new dimension
+      sizes.push_back(1);
+      strides.push_back(dim < self.dim() ? self.size(dim) * self.stride(dim) : 1);
+    }
+  }
+  for (; dim < self.dim(); dim++) {
+    sizes.push_back(self.size(dim));
+    strides.push_back(self.stride(dim));
+  }
+  return self.as_strided(sizes, strides, offset);
+}
+
 static std::vector<Tensor> typeConvertIndices(const Variable& self, const variable_list& indices) {
   std::vector<Tensor> converted_inds(indices.size());
   int64_t device = self.is_cuda() ? self.get_device() : -1;
@@ -279,6 +358,11 @@ PyObject* THPVariable_getitem(PyObject* self, PyObject* index) {
     return wrap(applySlice(self_, 0, index, true));
   }
 
+  Variable basic = applyBasicIndexing(self_, index);
+  if (basic.defined()) {
+    return wrap(basic);
+  }
+
   // wrap index in a tuple if it's not already one
   THPObjectPtr holder = wrapTuple(index);
 
@@ -345,6 +429,15 @@ int THPVariable_setitem(PyObject* self, PyObject* index, PyObject* py_value) {
     return 0;
   }
 
+  // a value that requires grad needs the precise views of applySlicing too
+  if (!(GradMode::is_enabled() && value.requires_grad())) {
+    Variable basic = applyBasicIndexing(self_, index);
+    if (basic.defined()) {
+      copy_to(basic, value);
+      return 0;
+    }
+  }
+
   // wrap index in a tuple if it's not already one
   THPObjectPtr holder = wrapTuple(index);
 
@@ -0,0 +1,275 @@
+#include "torch/csrc/autograd/saved_tensor_hooks.h"
+
+#include "torch/csrc/utils/auto_gpu.h"
+
+#include <ATen/ATen.h>
+#include <ATen/detail/CUDAHooksInterface.h>
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#ifdef WITH_CUDA
+#include <THC/THC.h>
+#endif
+
+namespace torch { namespace autograd {
+
+#ifdef WITH_CUDA
+
+namespace {
+
+// The stream each device copies saved tensors on
+THCStream* side_stream(int device) {
+  static std::mutex mutex;
+  static std::vector<THCStream*> streams;
+  std::lock_guard<std::mutex> lock(mutex);
+  if (streams.size() <= static_cast<size_t>(device)) {
+    streams.resize(device + 1, nullptr);
+  }
+  if (!streams[device]) {
+    AutoGPU guard(device);
+    streams[device] = THCStream_new(cudaStreamNonBlocking);
+  }
+  return streams[device];
+}
+
+// Makes stream the current stream of its device for the guard's lifetime
+struct AutoStream {
+  explicit AutoStream(THCStream* stream)
+    : state(at::globalContext().getTHCState())
+    , prev_stream(THCState_getStream(state)) {
+    THCStream_retain(prev_stream);
+    THCState_setStream(state, stream);
+  }
+
+  ~AutoStream() {
+    THCState_setStream(state, prev_stream);
+    THCStream_free(prev_stream);
+  }
+
+  THCState* state;
+  THCStream* prev_stream;
+};
+
+// An event recorded on the current stream of the current device
+cudaEvent_t record_event() {
+  cudaEvent_t event;
+  THCudaCheck(cudaEventCreateWithFlags(&event, cudaEventDisableTiming));
+  THCudaCheck(cudaEventRecord(event, THCState_getCurrentStream(at::globalContext().getTHCState())));
+  return event;
+}
+
+void wait_event(cudaEvent_t event) {
+  THCudaCheck(cudaStreamWaitEvent(
+      THCState_getCurrentStream(at::globalContext().getTHCState()), event, 0));
+}
+
+} // anonymous namespace
+
+#endif
+
+// A saved CUDA tensor moved to pinned host memory, and possibly copied back
+// to the device already. Events order the side stream copies with the
+// streams the tensor is produced and used on.
+struct OffloadedTensor : public PackedTensor {
+  OffloadedTensor(std::shared_ptr<OffloadHooks> hooks, uint64_t index, const at::Tensor& data);
+  virtual ~OffloadedTensor();
+
+  virtual at::Tensor unpack() override;
+
+  // Starts copying the tensor back to the device
+  void prefetch();
+
+  std::weak_ptr<OffloadHooks> hooks;
+  uint64_t index;
+  at::Type& device_type;
+  int device;
+  at::Tensor host;
+
+  std::mutex mutex;
+  at::Tensor prefetched;
+#ifdef WITH_CUDA
+  cudaEvent_t prefetch_done;
+#endif
+};
+
+OffloadedTensor::OffloadedTensor(std::shared_ptr<OffloadHooks> hooks, uint64_t index,
+                                 const at::Tensor& data)
+  : hooks(hooks)
+  , index(index)
+  , device_type(data.type())
+  , device(data.get_device()) {
+#ifdef WITH_CUDA
+  AutoGPU guard(device);
+  auto stream = side_stream(device);
+  host = data.type().toBackend(at::kCPU).tensorWithAllocator(
+      data.sizes(), at::detail::getCUDAHooks().newPinnedMemoryAllocator());
+  auto produced = record_event();
+  {
+    AutoStream stream_guard(stream);
+    wait_event(produced);
+    host.copy_(data, /*non_blocking=*/true);
+  }
+  THCudaCheck(cudaEventDestroy(produced));
+  // data may be freed once the copy is done, and host once its last use is
+  THCCachingAllocator_recordStream(data.data_ptr(), stream);
+  THCudaCheck(THCCachingHostAllocator_recordEvent(host.data_ptr(), stream));
+#endif
+}
+
+OffloadedTensor::~OffloadedTensor() {
+  if (auto hooks = this->hooks.lock()) {
+    hooks->forget(index);
+  }
+#ifdef WITH_CUDA
+  if (prefetched.defined()) {
+    cudaEventDestroy(prefetch_done);
+  }
+#endif
+}
+
+void OffloadedTensor::prefetch() {
+#ifdef WITH_CUDA
+  std::lock_guard<std::mutex> lock(mutex);
+  if (prefetched.defined()) {
+    return;
+  }
+  AutoGPU guard(device);
+  auto stream = side_stream(device);
+  // allocated for the current stream, which frees it after its use in backward
+  prefetched = device_type.tensor(host.sizes());
+  {
+    AutoStream stream_guard(stream);
+    // after the copy to host, which ran on the same stream
+    prefetched.copy_(host, /*non_blocking=*/true);
+    prefetch_done = record_event();
+  }
+  THCCachingAllocator_recordStream(prefetched.data_ptr(), stream);
+#endif
+}
+
+at::Tensor OffloadedTensor::unpack() {
+  if (auto hooks = this->hooks.lock()) {
+    hooks->prefetch_before(index);
+  }
+  prefetch();
+#ifdef WITH_CUDA
+  std::lock_guard<std::mutex> lock(mutex);
+  AutoGPU guard(device);
+  wait_event(prefetch_done);
+#endif
+  return prefetched;
+}
+
+auto OffloadHooks::pack(const at::Tensor& data) -> std::shared_ptr<PackedTensor> {
+  if (!data.is_cuda() || data.numel() * data.type().elementSizeInBytes() < min_bytes) {
+    return nullptr;
+  }
+  uint64_t index;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    index = next_index++;
+  }
+  auto packed = std::make_shared<OffloadedTensor>(shared_from_this(), index, data);
+  std::lock_guard<std::mutex> lock(mutex);
+  offloaded.emplace(index, packed);
+  return packed;
+}
+
+void OffloadHooks::prefetch_before(uint64_t index) {
+  std::vector<std::shared_ptr<OffloadedTensor>> tensors;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = offloaded.find(index);
+    if (it == offloaded.end()) {
+      return;
+    }
+    while (it != offloaded.begin() && static_cast<int64_t>(tensors.size()) < prefetch) {
+      --it;
+      if (auto tensor = it->second.lock()) {
+        tensors.push_back(std::move(tensor));
+      }
+    }
+  }
+  for (auto& tensor : tensors) {
+    tensor->prefetch();
+  }
+}
+
+void OffloadHooks::forget(uint64_t index) {
+  std::lock_guard<std::mutex> lock(mutex);
+  offloaded.erase(index);
+}
+
+namespace {
+
+struct HalfTensor : public PackedTensor {
+  explicit HalfTensor(const at::Tensor& data)
+    : type(data.type())
+    , half(data.toType(at::kHalf)) {}
+
+  virtual at::Tensor unpack() override {
+    return half.toType(type);
+  }
+
+  at::Type& type;
+  at::Tensor half;
+};
+
+// Bit i of byte j of bits is element 8 * j + i of the mask. Telling masks
+// apart takes a max over the data, which syncs with the device.
+struct BitTensor : public PackedTensor {
+  explicit BitTensor(const at::Tensor& data)
+    : sizes(data.sizes().vec()) {
+    AutoGPU guard(data);
+    weights = bit_weights(data.type());
+    auto flat = data.contiguous().view(-1);
+    int64_t numel = flat.numel();
+    auto padded = data.type().zeros({(numel + 7) / 8 * 8});
+    padded.narrow(0, 0, numel).copy_(flat);
+    bits = padded.view({-1, 8}).mul(weights).sum(1).toType(at::kByte);
+  }
+
+  virtual at::Tensor unpack() override {
+    int64_t numel = 1;
+    for (auto size : sizes) {
+      numel *= size;
+    }
+    AutoGPU guard(bits);
+    auto mask = bits.view({-1, 1}).div(weights).remainder(2);
+    return mask.view(-1).narrow(0, 0, numel).contiguous().view(sizes);
+  }
+
+  static at::Tensor bit_weights(at::Type& type) {
+    auto weights = at::CPU(at::kByte).tensor({8});
+    auto data = weights.data<uint8_t>();
+    for (int i = 0; i < 8; i++) {
+      data[i] = 1 << i;
+    }
+    return weights.toType(type);
+  }
+
+  std::vector<int64_t> sizes;
+  at::Tensor weights;
+  at::Tensor bits;
+};
+
+} // anonymous namespace
+
+auto CompressionHooks::pack(const at::Tensor& data) -> std::shared_ptr<PackedTensor> {
+  if (data.type().is_sparse() ||
+      data.numel() * data.type().elementSizeInBytes() < min_bytes) {
+    return nullptr;
+  }
+  auto scalar_type = data.type().scalarType();
+  if (scalar_type == at::kFloat || scalar_type == at::kDouble) {
+    return std::make_shared<HalfTensor>(data);
+  }
+  if (scalar_type == at::kByte && data.max().toCLong() <= 1) {
+    return std::make_shared<BitTensor>(data);
+  }
+  return nullptr;
+}
+
+}} // namespace torch::autograd
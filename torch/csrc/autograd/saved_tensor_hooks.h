@@ -0,0 +1,59 @@
+#pragma once
+
+// Stock SavedTensorHooks (see saved_variable.h), which trade time in forward
+// and backward for less device memory held by the saved variables.
+
+#include "torch/csrc/autograd/saved_variable.h"
+
+#include <ATen/ATen.h>
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+
+namespace torch { namespace autograd {
+
+struct OffloadedTensor;
+
+// Moves the saved CUDA tensors of at least min_bytes to pinned host memory.
+// The copies run on a side stream of each device, so they overlap with the
+// rest of the forward pass. Backward unpacks saved tensors roughly in the
+// reverse order of forward; whenever one is unpacked, the (at most prefetch)
+// tensors saved just before it are copied back to the device ahead of time on
+// the side stream.
+struct OffloadHooks : public SavedTensorHooks,
+                      public std::enable_shared_from_this<OffloadHooks> {
+  OffloadHooks(int64_t min_bytes, int64_t prefetch)
+    : min_bytes(min_bytes)
+    , prefetch(prefetch)
+    , next_index(0) {}
+
+  virtual std::shared_ptr<PackedTensor> pack(const at::Tensor& data) override;
+
+  // Starts copying back the tensors offloaded before the one at index
+  void prefetch_before(uint64_t index);
+  void forget(uint64_t index);
+
+  int64_t min_bytes;
+  int64_t prefetch;
+
+  std::mutex mutex;
+  uint64_t next_index;
+  // The tensors still offloaded, in the order they were saved
+  std::map<uint64_t, std::weak_ptr<OffloadedTensor>> offloaded;
+};
+
+// Saves float and double tensors of at least min_bytes as half, and byte
+// tensors of at least min_bytes holding only zeros and ones (masks) as bits.
+// Half loses precision, so the gradients are approximate.
+struct CompressionHooks : public SavedTensorHooks {
+  explicit CompressionHooks(int64_t min_bytes)
+    : min_bytes(min_bytes) {}
+
+  virtual std::shared_ptr<PackedTensor> pack(const at::Tensor& data) override;
+
+  int64_t min_bytes;
+};
+
+}} // namespace torch::autograd
@@ -16,6 +16,48 @@ struct Function;
 
 extern const char* ERR_BACKWARD_TWICE;
 
+/// The data of a saved variable in the form `SavedTensorHooks::pack` gave it.
+struct PackedTensor {
+  virtual ~PackedTensor() = default;
+
+  /// Returns the saved data, called by `SavedVariable::unpack` in backward.
+  virtual at::Tensor unpack() = 0;
+};
+
+/// Hooks that choose how the variables saved for backward keep their data,
+/// e.g. to move it off the device or to compress it between forward and
+/// backward. They apply to the variables saved on the thread that set them
+/// (see `AutoSavedTensorHooks`); see saved_tensor_hooks.h for the stock ones.
+struct SavedTensorHooks {
+  virtual ~SavedTensorHooks() = default;
+
+  /// Called with the data of every variable being saved. Returns nullptr to
+  /// keep the data as it is.
+  virtual std::shared_ptr<PackedTensor> pack(const at::Tensor& data) = 0;
+
+  static const std::shared_ptr<SavedTensorHooks>& get() {
+    return current_;
+  }
+  static void set(std::shared_ptr<SavedTensorHooks> hooks) {
+    current_ = std::move(hooks);
+  }
+
+ private:
+  static thread_local std::shared_ptr<SavedTensorHooks> current_;
+};
+
+/// Sets the saved tensor hooks of this thread for its lifetime.
+struct AutoSavedTensorHooks {
+  explicit AutoSavedTensorHooks(std::shared_ptr<SavedTensorHooks> hooks)
+      : prev_hooks(SavedTensorHooks::get()) {
+    SavedTensorHooks::set(std::move(hooks));
+  }
+  ~AutoSavedTensorHooks() {
+    SavedTensorHooks::set(std::move(prev_hooks));
+  }
+  std::shared_ptr<SavedTensorHooks> prev_hooks;
+};
+
 /// A snapshot of a variable at a certain version. A `SavedVariable` stores
 /// enough information to reconstruct a variable from a certain point in time.
 class SavedVariable {
@@ -31,11 +73,14 @@ class SavedVariable {
   Variable unpack(std::shared_ptr<Function> saved_for = nullptr) const;
 
   void reset_data() {
+    packed_.reset();
     return data_.reset();
   }
 
  private:
   at::Tensor data_;
+  // Set instead of data_ if the saved tensor hooks packed the data
+  std::shared_ptr<PackedTensor> packed_;
 
   // The gradient function associated with this node. If has_grad_fn
   // is false, then this is a leaf node. Note that the grad_fn is not saved if
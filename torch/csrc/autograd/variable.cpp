@@ -45,15 +45,15 @@ const char* Variable::Impl::toString() const {
   return type().toString();
 }
 
-IntList Variable::Impl::sizes() const {
+IntList Variable::Impl::sizes_custom() const {
   return data_.sizes();
 }
 
-IntList Variable::Impl::strides() const {
+IntList Variable::Impl::strides_custom() const {
   return data_.strides();
 }
 
-int64_t Variable::Impl::dim() const {
+int64_t Variable::Impl::dim_custom() const {
   return data_.dim();
 }
 
@@ -292,9 +292,9 @@ struct Variable::Impl : public at::TensorImpl {
   virtual ~Impl();
 
   const char* toString() const override;
-  at::IntList sizes() const override;
-  at::IntList strides() const override;
-  int64_t dim() const override;
+  at::IntList sizes_custom() const override;
+  at::IntList strides_custom() const override;
+  int64_t dim_custom() const override;
   at::Scalar localScalar() override;
   void* unsafeGetTH(bool retain) override;
   std::unique_ptr<at::Storage> storage() override;
@@ -429,7 +429,7 @@ inline Variable make_variable_view(
 
 inline Variable make_variable(at::Tensor data, bool requires_grad = false) {
   if (data.defined()) {
-    auto impl = new Variable::Impl(data, requires_grad);
+    auto impl = new Variable::Impl(std::move(data), requires_grad);
     return Variable(impl, /*retain=*/false);
   }
   return Variable();
@@ -437,7 +437,7 @@ inline Variable make_variable(at::Tensor data, bool requires_grad = false) {
 
 inline Variable make_variable(at::Tensor data, Edge gradient_edge) {
   if (data.defined()) {
-    auto impl = new Variable::Impl(data, false, std::move(gradient_edge));
+    auto impl = new Variable::Impl(std::move(data), false, std::move(gradient_edge));
     return Variable(impl, /*retain=*/false);
   }
   return Variable();
@@ -8,6 +8,7 @@
 #include <TH/TH.h>
 #include <ATen/ATen.h>
 #include <THC/THCCachingAllocator.h>
+#include <ATen/cuda/CuFFTPlanCache.h>
 #ifdef WITH_NCCL
 #include <nccl.h>
 #endif
@@ -18,6 +19,10 @@
 #include "torch/csrc/autograd/generated/VariableType.h"
 #include "torch/csrc/utils/python_strings.h"
 #include "torch/csrc/cuda/python_comm.h"
+#include "torch/csrc/cuda/python_prefetcher.h"
+#include "torch/csrc/cuda/python_replica_cache.h"
+
+#include <frameobject.h>
 
 using namespace torch;
 
@@ -287,6 +292,45 @@ PyObject * THCPModule_maxMemoryCached(PyObject *_unused, PyObject *arg)
   END_HANDLE_TH_ERRORS
 }
 
+// Python stacks seen by the allocator trace, by the id stored in the trace.
+// Only accessed with the GIL held.
+static std::unordered_map<uint64_t, std::string> memory_trace_stacks;
+
+// Context function for the allocator trace: returns an id for the Python
+// stack of the calling thread, or 0 if the thread does not hold the GIL (e.g.
+// the autograd engine's worker threads). Must not try to acquire the GIL,
+// since it is called with the allocator lock held.
+static uint64_t THCPModule_memoryTraceContext()
+{
+#if PY_MAJOR_VERSION == 2
+  PyThreadState *tstate = PyGILState_GetThisThreadState();
+  if (tstate == NULL || tstate != _PyThreadState_Current) {
+    return 0;
+  }
+#else
+  if (!PyGILState_Check()) {
+    return 0;
+  }
+  PyThreadState *tstate = PyThreadState_GET();
+#endif
+  std::stringstream stack_trace;
+  int depth = 0;
+  for (PyFrameObject *frame = tstate->frame; frame && depth < 32; frame = frame->f_back, depth++) {
+    int line = PyCode_Addr2Line(frame->f_code, frame->f_lasti);
+    std::string filename = THPUtils_unpackString(frame->f_code->co_filename);
+    std::string funcname = THPUtils_unpackString(frame->f_code->co_name);
+    stack_trace << filename << "(" << line << "): " << funcname << "\n";
+  }
+  std::string stack = stack_trace.str();
+  if (stack.empty()) {
+    return 0;
+  }
+  // 0 means "no context"
+  uint64_t id = std::hash<std::string>()(stack) | 1;
+  memory_trace_stacks.emplace(id, std::move(stack));
+  return id;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // Cuda module initialization
 ////////////////////////////////////////////////////////////////////////////////
@@ -314,6 +358,97 @@ static void bindCudaDeviceProperties(PyObject* module) {
   }, py::return_value_policy::reference);
 }
 
+static void bindCachingAllocator(PyObject* module) {
+  auto m = py::handle(module).cast<py::module>();
+  m.def("_cuda_memoryStats", [](int device) {
+    py::dict stats;
+    stats["allocated_bytes"] = THCCachingAllocator_currentMemoryAllocated(device);
+    stats["max_allocated_bytes"] = THCCachingAllocator_maxMemoryAllocated(device);
+    stats["cached_bytes"] = THCCachingAllocator_currentMemoryCached(device);
+    stats["max_cached_bytes"] = THCCachingAllocator_maxMemoryCached(device);
+    stats["inactive_split_bytes"] = THCCachingAllocator_currentMemoryInactiveSplit(device);
+    stats["num_segments"] = THCCachingAllocator_numSegments(device);
+    stats["num_alloc_retries"] = THCCachingAllocator_numAllocRetries(device);
+    stats["num_ooms"] = THCCachingAllocator_numOOMs(device);
+    return stats;
+  });
+  m.def("_cuda_memorySnapshot", []() {
+    std::vector<THCCachingAllocatorSegmentInfo> snapshot;
+    {
+      py::gil_scoped_release no_gil;
+      snapshot = THCCachingAllocator_snapshot();
+    }
+    py::list segments;
+    for (auto& segment_info : snapshot) {
+      py::dict segment;
+      segment["device"] = segment_info.device;
+      segment["address"] = segment_info.address;
+      segment["stream"] = (uintptr_t)segment_info.stream;
+      segment["total_size"] = segment_info.total_size;
+      segment["allocated_size"] = segment_info.allocated_size;
+      segment["segment_type"] = segment_info.is_large ? "large" : "small";
+      py::list blocks;
+      for (auto& block_info : segment_info.blocks) {
+        py::dict block;
+        block["size"] = block_info.size;
+        block["state"] = block_info.allocated ? "active_allocated" :
+            (block_info.pending_events ? "active_pending_free" : "inactive");
+        blocks.append(block);
+      }
+      segment["blocks"] = blocks;
+      segments.append(segment);
+    }
+    return segments;
+  });
+  m.def("_cuda_recordMemoryHistory", [](bool enabled, size_t max_entries) {
+    if (enabled) {
+      memory_trace_stacks.clear();
+    }
+    THCCachingAllocator_recordHistory(enabled, max_entries, &THCPModule_memoryTraceContext);
+  });
+  m.def("_cuda_memoryTrace", []() {
+    static const char* action_names[] = {"alloc", "free", "segment_alloc", "segment_free"};
+    std::vector<THCCachingAllocatorTraceEntry> trace;
+    {
+      py::gil_scoped_release no_gil;
+      trace = THCCachingAllocator_trace();
+    }
+    py::list entries;
+    py::dict stacks;
+    for (auto& trace_entry : trace) {
+      py::dict entry;
+      entry["action"] = action_names[trace_entry.action];
+      entry["device"] = trace_entry.device;
+      entry["address"] = trace_entry.address;
+      entry["size"] = trace_entry.size;
+      entry["stream"] = (uintptr_t)trace_entry.stream;
+      entry["stack_id"] = trace_entry.context;
+      auto it = memory_trace_stacks.find(trace_entry.context);
+      if (it != memory_trace_stacks.end()) {
+        stacks[py::int_(it->first)] = it->second;
+      }
+      entries.append(entry);
+    }
+    return py::make_tuple(entries, stacks);
+  });
+  m.def("_cuda_hostReserve", [](size_t size, size_t count) {
+    py::gil_scoped_release no_gil;
+    THCudaCheck(THCCachingHostAllocator_reserve(size, count));
+  });
+  m.def("_cuda_setHostTrimInterval", [](double seconds) {
+    py::gil_scoped_release no_gil;
+    THCCachingHostAllocator_setTrimInterval(seconds);
+  });
+}
+
+static void bindCuFFTPlanCache(PyObject* module) {
+  auto m = py::handle(module).cast<py::module>();
+  m.def("_cufft_get_plan_cache_max_size", &at::native::cufft_get_plan_cache_max_size);
+  m.def("_cufft_set_plan_cache_max_size", &at::native::cufft_set_plan_cache_max_size);
+  m.def("_cufft_get_plan_cache_size", &at::native::cufft_get_plan_cache_size);
+  m.def("_cufft_clear_plan_cache", &at::native::cufft_clear_plan_cache);
+}
+
 // Callback for python part. Used for additional initialization of python classes
 static PyObject * THCPModule_initExtension(PyObject *self)
 {
@@ -361,6 +496,13 @@ static PyObject * THCPModule_initExtension(PyObject *self)
 
   bindCudaDeviceProperties(m);
 
+  // The allocator functions go to torch._C, next to _cuda_memoryAllocated and
+  // friends, so that torch.cuda can wrap them under their public names.
+  auto c_module = THPObjectPtr(PyImport_ImportModule("torch._C"));
+  if (!c_module) throw python_error();
+  bindCachingAllocator(c_module);
+  bindCuFFTPlanCache(c_module);
+
   Py_RETURN_NONE;
   END_HANDLE_TH_ERRORS
 }
@@ -433,6 +575,8 @@ namespace torch { namespace cuda {
 
 void initModule(PyObject *module) {
   python::initCommMethods(module);
+  python::initPrefetcherBindings(module);
+  python::initReplicaCacheBindings(module);
 }
 
 }}
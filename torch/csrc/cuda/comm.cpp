@@ -3,11 +3,18 @@
 #include "torch/csrc/utils/tensor_flatten.h"
 #include "torch/csrc/utils/auto_gpu.h"
 #include "torch/csrc/cuda/device_set.h"
+#include "torch/csrc/utils/functional.h"
 #ifdef WITH_NCCL
 #include "torch/csrc/cuda/nccl.h"
 #endif
 
 #include <ATen/ATen.h>
+#include <ATen/WrapDimUtils.h>
+#include <THC/THC.h>
+
+#include <mutex>
+
+extern THCState* state;
 
 namespace torch { namespace cuda {
 
@@ -105,4 +112,207 @@ tensor_list2d broadcast_coalesced(TensorList tensors, IntList devices, std::size
   return outputs;
 }
 
+Tensor reduce_add(TensorList inputs, int64_t destination) {
+  AT_CHECK(!inputs.empty(), "reduce_add expects at least one input");
+  int64_t root = -1;
+  for (size_t i = 0; i < inputs.size(); i++) {
+    AT_CHECK(inputs[i].type().is_cuda(), "reduce_add expects all inputs to be on GPUs");
+    AT_CHECK(inputs[i].sizes().equals(inputs[0].sizes()),
+             "reduce_add: input ", i, " has invalid size: got ", inputs[i].sizes(),
+             ", but expected ", inputs[0].sizes());
+    if (inputs[i].get_device() == destination)
+      root = i;
+  }
+  AT_CHECK(root >= 0, "reduce_add expects destination to be on the same GPU with one of the tensors");
+
+  AutoGPU gpu_guard(destination);
+#ifdef WITH_NCCL
+  if (nccl::is_available(inputs)) {
+    auto result = inputs[root].type().tensor(inputs[root].sizes());
+    // ncclReduce only writes to the root's output
+    std::vector<Tensor> outputs = inputs.vec();
+    outputs[root] = result;
+    nccl::reduce(inputs, outputs, root);
+    return result;
+  }
+#endif
+  auto result = inputs[root].clone();
+  for (size_t i = 0; i < inputs.size(); i++) {
+    if (static_cast<int64_t>(i) != root)
+      result.add_(result.type().copy(inputs[i], /*non_blocking=*/true));
+  }
+  return result;
+}
+
+#ifdef WITH_NCCL
+namespace {
+
+// Side streams on which reduce_add_coalesced runs NCCL, one per device. They
+// are created on first use and live as long as the process.
+THCStream* comm_stream(int64_t device) {
+  static std::mutex mutex;
+  static std::vector<THCStream*> streams;
+  std::lock_guard<std::mutex> lock(mutex);
+  if (streams.empty())
+    streams.resize(THCState_getNumDevices(state), nullptr);
+  auto & stream = streams.at(device);
+  if (!stream) {
+    AutoGPU gpu_guard(device);
+    stream = THCStream_new(cudaStreamNonBlocking);
+  }
+  return stream;
+}
+
+// Keeps the caching allocator from reusing the memory of tensor before the
+// work queued on stream is done. Flattened buckets of one tensor are views of
+// it, so this records the whole storage.
+void record_stream(const Tensor& tensor, THCStream* stream) {
+  if (tensor.numel() > 0)
+    THCCachingAllocator_recordStream(tensor.storage()->data(), stream);
+}
+
+} // namespace
+#endif
+
+std::vector<Tensor> reduce_add_coalesced(const tensor_list2d& inputs, int64_t destination,
+                                         std::size_t buffer_size) {
+  AT_CHECK(!inputs.empty(), "reduce_add_coalesced expects at least one device");
+  const std::size_t num_devices = inputs.size();
+  const std::size_t num_tensors = inputs[0].size();
+  if (num_tensors == 0)
+    return {};
+
+  std::vector<int64_t> devices(num_devices);
+  int64_t root = -1;
+  for (std::size_t i = 0; i < num_devices; i++) {
+    AT_CHECK(inputs[i].size() == num_tensors,
+             "reduce_add_coalesced expects the same number of tensors on every device, but got ",
+             inputs[i].size(), " tensors for device ", i, " and ", num_tensors, " for device 0");
+    devices[i] = inputs[i][0].get_device();
+    for (std::size_t j = 0; j < num_tensors; j++) {
+      auto & t = inputs[i][j];
+      AT_CHECK(t.type().is_cuda() && !t.type().is_sparse(),
+               "reduce_add_coalesced expects dense CUDA tensors");
+      AT_CHECK(t.get_device() == devices[i],
+               "reduce_add_coalesced expects the tensors of each list to be on one device");
+      AT_CHECK(t.type() == inputs[0][j].type() && t.sizes().equals(inputs[0][j].sizes()),
+               "reduce_add_coalesced: tensor ", j, " of device ", i,
+               " doesn't match the type and size of tensor ", j, " of device 0");
+    }
+    if (devices[i] == destination)
+      root = i;
+  }
+  AT_CHECK(root >= 0, "reduce_add_coalesced expects destination to be the device of one of the inputs");
+
+  // The tensors have the same types and sizes on every device, so they are
+  // split into the same buckets
+  auto buckets = fmap(inputs, [&](const std::vector<Tensor>& tensors) {
+    return utils::take_tensors(tensors, buffer_size);
+  });
+  const std::size_t num_buckets = buckets[0].size();
+
+  std::vector<Tensor> outputs;
+  outputs.reserve(num_tensors);
+  unique_type_checker type_checker;
+  AutoGPU gpu_guard;
+#ifdef WITH_NCCL
+  // Every device flattens its buckets on its current stream, which only
+  // waits for the side stream at the end, so the NCCL reduction of a bucket
+  // overlaps with the flattening of the next one.
+  nccl::stream_list streams(num_devices);
+  std::vector<cudaEvent_t> events(num_devices);
+  for (std::size_t i = 0; i < num_devices; i++) {
+    gpu_guard.setDevice(devices[i]);
+    streams[i] = comm_stream(devices[i]);
+    THCudaCheck(cudaEventCreateWithFlags(&events[i], cudaEventDisableTiming));
+  }
+  bool used_streams = false;
+#endif
+  for (std::size_t b = 0; b < num_buckets; b++) {
+    auto & root_bucket = buckets[root][b];
+    type_checker.show(root_bucket.type());
+    std::vector<Tensor> flats(num_devices);
+    for (std::size_t i = 0; i < num_devices; i++) {
+      gpu_guard.setDevice(devices[i]);
+      flats[i] = utils::flatten_dense_tensors(buckets[i][b].tensors);
+    }
+
+    Tensor result;
+#ifdef WITH_NCCL
+    if (nccl::is_available(flats)) {
+      gpu_guard.setDevice(destination);
+      result = flats[root].type().tensor(flats[root].sizes());
+      std::vector<Tensor> reduce_outputs = flats;
+      reduce_outputs[root] = result;
+      for (std::size_t i = 0; i < num_devices; i++) {
+        gpu_guard.setDevice(devices[i]);
+        THCudaCheck(cudaEventRecord(events[i], THCStream_stream(THCState_getStream(state))));
+        THCudaCheck(cudaStreamWaitEvent(THCStream_stream(streams[i]), events[i], 0));
+        record_stream(flats[i], streams[i]);
+      }
+      record_stream(result, streams[root]);
+      nccl::reduce(flats, reduce_outputs, root, ncclSum, streams);
+      used_streams = true;
+    } else {
+#else
+    {
+#endif
+      result = reduce_add(flats, destination);
+    }
+    gpu_guard.setDevice(destination);
+    for (auto & t : utils::unflatten_dense_tensors(result, root_bucket.tensors))
+      outputs.push_back(std::move(t));
+  }
+
+#ifdef WITH_NCCL
+  if (used_streams) {
+    gpu_guard.setDevice(destination);
+    THCudaCheck(cudaEventRecord(events[root], THCStream_stream(streams[root])));
+    THCudaCheck(cudaStreamWaitEvent(THCStream_stream(THCState_getStream(state)), events[root], 0));
+  }
+  for (std::size_t i = 0; i < num_devices; i++) {
+    gpu_guard.setDevice(devices[i]);
+    THCudaCheck(cudaEventDestroy(events[i]));
+  }
+#endif
+
+  // If we only saw a single tensor type, then we can skip expensive reordering
+  if (!type_checker.unique)
+    utils::reorder_tensors_like(outputs, inputs[root]);
+  return outputs;
+}
+
+Tensor gather(TensorList tensors, int64_t dim, int64_t destination) {
+  AT_CHECK(!tensors.empty(), "gather expects at least one tensor");
+  auto & first = tensors[0];
+  dim = maybe_wrap_dim(dim, first.dim());
+  std::vector<int64_t> expected_size = first.sizes().vec();
+  int64_t total_size = 0;
+  for (auto & tensor : tensors) {
+    AT_CHECK(tensor.type().is_cuda(), "gather expects all inputs to be on GPUs");
+    expected_size[dim] = tensor.size(dim);
+    AT_CHECK(tensor.sizes().equals(expected_size),
+             "gather got an input of invalid size: got ", tensor.sizes(),
+             ", but expected ", IntList(expected_size));
+    total_size += tensor.size(dim);
+  }
+  expected_size[dim] = total_size;
+
+  Tensor result;
+  if (destination == -1) {
+    result = first.type().toBackend(kCPU).tensor(expected_size);
+  } else {
+    AutoGPU gpu_guard(destination);
+    result = first.type().tensor(expected_size);
+  }
+  int64_t chunk_start = 0;
+  // TODO: if copying to CPU, allocate a pinned buffer, do async copies to it,
+  // and copy it to regular memory
+  for (auto & tensor : tensors) {
+    result.narrow(dim, chunk_start, tensor.size(dim)).copy_(tensor, /*non_blocking=*/true);
+    chunk_start += tensor.size(dim);
+  }
+  return result;
+}
+
 }}
@@ -11,4 +11,16 @@ std::vector<at::Tensor> broadcast(const at::Tensor& tensor, at::IntList devices)
 tensor_list2d broadcast_coalesced(at::TensorList tensors, at::IntList devices,
                                   std::size_t buffer_size);
 
+// Sums inputs, which are on different devices, into a tensor on destination,
+// which has to be the device of one of them.
+at::Tensor reduce_add(at::TensorList inputs, int64_t destination);
+// Sums inputs[i][j] over i for each j, inputs[i] being dense tensors on one
+// device per i. The tensors are coalesced into buckets of buffer_size bytes
+// and, with NCCL, each bucket is reduced on a side stream while the next one
+// is flattened. The results are ordered like inputs[0].
+std::vector<at::Tensor> reduce_add_coalesced(const tensor_list2d& inputs, int64_t destination,
+                                             std::size_t buffer_size);
+// Concatenates tensors along dim on destination (-1 for the CPU)
+at::Tensor gather(at::TensorList tensors, int64_t dim, int64_t destination);
+
 }}
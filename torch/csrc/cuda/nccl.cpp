@@ -193,4 +193,30 @@ void broadcast(TensorList tensors, const stream_list& streams, const comm_list&
 #endif
 }
 
+void reduce(TensorList inputs, TensorList outputs, int32_t root, int32_t op,
+            const stream_list& streams, const comm_list& user_comms) {
+#ifdef WITH_NCCL
+  using namespace torch::cuda::nccl::detail;
+  if (root < 0 || static_cast<size_t>(root) >= inputs.size()) {
+    throw std::runtime_error("invalid root");
+  }
+  _check_inputs(inputs, outputs, 1, 1);
+  ncclDataType_t data_type = _get_data_type(inputs[0].type());
+  int64_t count = inputs[0].numel();
+
+  std::lock_guard<std::mutex> free_mutex(*(THCCachingAllocator_getCudaFreeMutex()));
+  const auto comms = user_comms.empty() ? _get_communicators(inputs) : ArrayRef<ncclComm_t>(user_comms);
+  AutoGPU gpu_guard;
+  AutoNcclGroup nccl_group_guard;
+  for (size_t i = 0, num_inputs = inputs.size(); i < num_inputs; i++) {
+    gpu_guard.setDevice(inputs[i].get_device());
+    const auto stream = (streams.empty() || !streams[i]) ? NULL : streams[i]->stream;
+    CHECK(ncclReduce(inputs[i].data_ptr(), outputs[i].data_ptr(),
+                     count, data_type, (ncclRedOp_t) op, root, comms[i], stream));
+  }
+#else
+  throw std::runtime_error("PyTorch built without NCCL support");
+#endif
+}
+
 }}}
@@ -46,5 +46,13 @@ bool is_available(at::TensorList tensors);
 void broadcast(at::TensorList tensors,
                const stream_list& streams = {},
                const comm_list& user_comms = {});
+// Reduces inputs into outputs[root] with op (a ncclRedOp_t). The outputs of
+// the other devices are only checked for their size and may alias inputs.
+void reduce(at::TensorList inputs,
+            at::TensorList outputs,
+            int32_t root = 0,
+            int32_t op = ncclSum,
+            const stream_list& streams = {},
+            const comm_list& user_comms = {});
 
 }}}
@@ -0,0 +1,104 @@
+#include "torch/csrc/cuda/prefetcher.h"
+
+#include "torch/csrc/utils/auto_gpu.h"
+#include "torch/csrc/utils/auto_stream.h"
+
+#include <ATen/ATen.h>
+#include <ATen/detail/CUDAHooksInterface.h>
+
+#include <stdexcept>
+
+namespace torch { namespace cuda {
+
+using namespace at;
+
+Prefetcher::Prefetcher(int device, std::size_t num_buffers)
+  : device(device)
+  , buffers(num_buffers)
+  , next_buffer(0) {
+  if (num_buffers == 0) {
+    throw std::runtime_error("Prefetcher: num_buffers must be positive");
+  }
+  AutoGPU guard(device);
+  stream = THCStream_new(cudaStreamNonBlocking);
+  for (auto& buffer : buffers) {
+    THCudaCheck(cudaEventCreateWithFlags(&buffer.copied, cudaEventDisableTiming));
+    buffer.used = false;
+  }
+}
+
+Prefetcher::~Prefetcher() {
+  AutoGPU guard(device);
+  // The batches that were never returned are freed on the side stream
+  for (auto& batch : batches) {
+    cudaEventDestroy(batch.ready);
+  }
+  for (auto& buffer : buffers) {
+    cudaEventDestroy(buffer.copied);
+  }
+  THCStream_free(stream);
+}
+
+void Prefetcher::put(TensorList tensors) {
+  AutoGPU guard(device);
+  auto& buffer = buffers[next_buffer];
+  next_buffer = (next_buffer + 1) % buffers.size();
+  if (buffer.used) {
+    THCudaCheck(cudaEventSynchronize(buffer.copied));
+  }
+
+  std::vector<Tensor> host_tensors;
+  host_tensors.reserve(tensors.size());
+  buffer.staging.resize(tensors.size());
+  for (size_t i = 0; i < tensors.size(); i++) {
+    auto& src = tensors[i];
+    AT_CHECK(src.type().backend() == kCPU, "Prefetcher: expected CPU tensors, but tensor ", i,
+             " is of type ", src.type().toString());
+    auto& staging = buffer.staging[i];
+    // Staging buffers only grow, so that batches of varying sizes reuse them
+    if (!staging.defined() || &staging.type() != &src.type() || staging.numel() < src.numel()) {
+      staging = src.type().tensorWithAllocator(
+          {src.numel()}, detail::getCUDAHooks().newPinnedMemoryAllocator());
+    }
+    host_tensors.push_back(staging.narrow(0, 0, src.numel()).view(src.sizes()));
+    host_tensors.back().copy_(src);
+  }
+
+  Batch batch;
+  batch.tensors.reserve(tensors.size());
+  {
+    // Allocated for the side stream; get() records them on the stream that
+    // uses them
+    AutoStream stream_guard(stream);
+    for (auto& host : host_tensors) {
+      auto dst = host.type().toBackend(kCUDA).tensor(host.sizes());
+      dst.copy_(host, /*non_blocking=*/true);
+      batch.tensors.push_back(std::move(dst));
+    }
+  }
+  THCudaCheck(cudaEventRecord(buffer.copied, THCStream_stream(stream)));
+  buffer.used = true;
+  THCudaCheck(cudaEventCreateWithFlags(&batch.ready, cudaEventDisableTiming));
+  THCudaCheck(cudaEventRecord(batch.ready, THCStream_stream(stream)));
+  batches.push_back(std::move(batch));
+}
+
+std::vector<Tensor> Prefetcher::get() {
+  if (batches.empty()) {
+    throw std::runtime_error("Prefetcher: get() called without a pending batch, call put() first");
+  }
+  AutoGPU guard(device);
+  auto batch = std::move(batches.front());
+  batches.pop_front();
+  auto current = THCState_getStream(state);
+  THCudaCheck(cudaStreamWaitEvent(THCStream_stream(current), batch.ready, 0));
+  THCudaCheck(cudaEventDestroy(batch.ready));
+  for (auto& tensor : batch.tensors) {
+    if (tensor.numel() > 0) {
+      THCCachingAllocator_recordStream(tensor.data_ptr(), current);
+    }
+  }
+  return std::move(batch.tensors);
+}
+
+}} // namespace torch::cuda
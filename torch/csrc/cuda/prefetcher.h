@@ -0,0 +1,65 @@
+#pragma once
+
+#include <ATen/ATen.h>
+#include <THC/THC.h>
+
+#include <cstddef>
+#include <deque>
+#include <vector>
+
+namespace torch { namespace cuda {
+
+// Copies batches of CPU tensors to a CUDA device ahead of their use. put()
+// copies a batch into one of num_buffers pinned staging buffers, which are
+// reused from batch to batch, and from there to the device on a side stream
+// owned by the prefetcher, so that the copy of the next batch overlaps with
+// the work on the current one:
+//
+//   prefetcher.put(first_batch);
+//   for (...) {
+//     prefetcher.put(next_batch);
+//     auto batch = prefetcher.get();
+//     ...
+//   }
+//
+// get() makes the current stream wait for the copy of the oldest batch (the
+// host doesn't wait) and records its tensors on the current stream for the
+// caching allocator, so they can be used and freed there like any other
+// tensor. put() only waits for the host when the staging buffer it reuses is
+// still being copied from. Not thread safe.
+struct Prefetcher {
+  Prefetcher(int device, std::size_t num_buffers);
+  ~Prefetcher();
+
+  Prefetcher(const Prefetcher&) = delete;
+  Prefetcher& operator=(const Prefetcher&) = delete;
+
+  void put(at::TensorList tensors);
+  std::vector<at::Tensor> get();
+
+  // The number of batches put but not returned by get() yet
+  std::size_t pending() const {
+    return batches.size();
+  }
+
+ private:
+  struct Buffer {
+    std::vector<at::Tensor> staging;
+    // Recorded on the side stream after the copies out of staging
+    cudaEvent_t copied;
+    bool used;
+  };
+
+  struct Batch {
+    std::vector<at::Tensor> tensors;
+    cudaEvent_t ready;
+  };
+
+  int device;
+  THCStream* stream;
+  std::vector<Buffer> buffers;
+  std::size_t next_buffer;
+  std::deque<Batch> batches;
+};
+
+}} // namespace torch::cuda
@@ -13,7 +13,19 @@ void initCommMethods(PyObject *module) {
       py::call_guard<py::gil_scoped_release>())
    .def("_broadcast", [](at::Tensor& tensor, std::vector<int64_t> devices) {
      return broadcast(tensor, devices);
-   }, py::call_guard<py::gil_scoped_release>());
+   }, py::call_guard<py::gil_scoped_release>())
+   .def("_reduce_add", [](std::vector<at::Tensor>& inputs, int64_t destination) {
+     return reduce_add(inputs, destination);
+   }, py::arg("inputs"), py::arg("destination"),
+      py::call_guard<py::gil_scoped_release>())
+   .def("_reduce_add_coalesced", [](tensor_list2d& inputs, int64_t destination, std::size_t buffer_size) {
+     return reduce_add_coalesced(inputs, destination, buffer_size);
+   }, py::arg("inputs"), py::arg("destination"), py::arg("buffer_size"),
+      py::call_guard<py::gil_scoped_release>())
+   .def("_gather", [](std::vector<at::Tensor>& tensors, int64_t dim, int64_t destination) {
+     return gather(tensors, dim, destination);
+   }, py::arg("tensors"), py::arg("dim"), py::arg("destination"),
+      py::call_guard<py::gil_scoped_release>());
 }
 
 }}}
@@ -0,0 +1,33 @@
+#include "torch/csrc/utils/pybind.h"
+#include "torch/csrc/cuda/prefetcher.h"
+#include "torch/csrc/autograd/variable.h"
+
+namespace torch { namespace cuda { namespace python {
+
+using torch::autograd::make_variable;
+
+void initPrefetcherBindings(PyObject *module) {
+  auto m = py::cast<py::module>(module);
+  py::class_<Prefetcher>(m, "_CudaPrefetcher")
+   .def(py::init<int, std::size_t>(), py::arg("device"), py::arg("num_buffers"))
+   .def("put", [](Prefetcher& self, std::vector<at::Tensor> tensors) {
+     std::vector<at::Tensor> data;
+     data.reserve(tensors.size());
+     for (auto& tensor : tensors) {
+       data.push_back(torch::autograd::as_variable_ref(tensor).data());
+     }
+     self.put(data);
+   }, py::call_guard<py::gil_scoped_release>())
+   .def("get", [](Prefetcher& self) {
+     auto tensors = self.get();
+     std::vector<at::Tensor> variables;
+     variables.reserve(tensors.size());
+     for (auto& tensor : tensors) {
+       variables.push_back(make_variable(std::move(tensor), /*requires_grad=*/false));
+     }
+     return variables;
+   }, py::call_guard<py::gil_scoped_release>())
+   .def("pending", &Prefetcher::pending);
+}
+
+}}}
@@ -0,0 +1,7 @@
+#pragma once
+
+namespace torch { namespace cuda { namespace python {
+
+void initPrefetcherBindings(PyObject *module);
+
+}}}
@@ -0,0 +1,16 @@
+#include "torch/csrc/utils/pybind.h"
+#include "torch/csrc/cuda/replica_cache.h"
+
+namespace torch { namespace cuda { namespace python {
+
+void initReplicaCacheBindings(PyObject *module) {
+  auto m = py::cast<py::module>(module);
+  py::class_<ReplicaCache>(m, "_CudaReplicaCache")
+   .def(py::init<std::vector<int64_t>, std::size_t>(), py::arg("devices"), py::arg("buffer_size"))
+   .def("sync", &ReplicaCache::sync, py::arg("sources"), py::call_guard<py::gil_scoped_release>())
+   .def("invalidate", &ReplicaCache::invalidate)
+   .def("copies", &ReplicaCache::copies)
+   .def("devices", &ReplicaCache::devices);
+}
+
+}}}
@@ -0,0 +1,98 @@
+#include "torch/csrc/cuda/replica_cache.h"
+
+#include "torch/csrc/cuda/comm.h"
+#include "torch/csrc/utils/auto_gpu.h"
+
+#include <ATen/ATen.h>
+
+#include <stdexcept>
+
+namespace torch { namespace cuda {
+
+using namespace at;
+using torch::autograd::Variable;
+using torch::autograd::make_variable;
+
+ReplicaCache::ReplicaCache(std::vector<int64_t> devices, std::size_t buffer_size)
+  : device_ids(std::move(devices))
+  , buffer_size(buffer_size)
+  , replicas(device_ids.size())
+  , valid(false) {
+  if (device_ids.empty()) {
+    throw std::runtime_error("ReplicaCache: expected at least one device");
+  }
+}
+
+void ReplicaCache::invalidate() {
+  valid = false;
+}
+
+bool ReplicaCache::sync(const std::vector<Variable>& sources) {
+  for (size_t i = 0; i < sources.size(); i++) {
+    auto& source = sources[i];
+    AT_CHECK(source.defined() && source.type().is_cuda() && !source.type().is_sparse()
+             && source.get_device() == device_ids[0],
+             "ReplicaCache: expected dense CUDA tensors on device ", device_ids[0],
+             ", but source ", i, " isn't");
+  }
+
+  const size_t num_devices = device_ids.size();
+  const size_t num_cached = synced.size();
+  bool changed = sources.size() != num_cached;
+
+  // Sources that need a broadcast, and whether their copies are new
+  std::vector<size_t> stale;
+  std::vector<bool> fresh;
+  for (size_t i = 0; i < sources.size(); i++) {
+    auto& source = sources[i];
+    if (i >= num_cached || !(&source.type() == &replicas[0][i].type()
+                             && source.sizes().equals(replicas[0][i].sizes()))) {
+      stale.push_back(i);
+      fresh.push_back(true);
+      changed = true;
+      continue;
+    }
+    if (!source.is_same(replicas[0][i])) {
+      changed = true;
+    }
+    if (!valid || source.data().data_ptr() != synced[i].data
+        || source.current_version() != synced[i].version) {
+      stale.push_back(i);
+      fresh.push_back(false);
+    }
+  }
+
+  replicas[0] = sources;
+  for (size_t d = 1; d < num_devices; d++) {
+    replicas[d].resize(sources.size());
+  }
+  synced.resize(sources.size());
+
+  if (!stale.empty() && num_devices > 1) {
+    std::vector<Tensor> data;
+    data.reserve(stale.size());
+    for (auto i : stale) {
+      data.push_back(sources[i].data());
+    }
+    auto results = broadcast_coalesced(data, device_ids, buffer_size);
+    AutoGPU gpu_guard;
+    for (size_t d = 1; d < num_devices; d++) {
+      gpu_guard.setDevice(device_ids[d]);
+      for (size_t k = 0; k < stale.size(); k++) {
+        auto& copy = replicas[d][stale[k]];
+        if (fresh[k]) {
+          copy = make_variable(std::move(results[d][k]), /*requires_grad=*/false);
+        } else {
+          copy.data().copy_(results[d][k]);
+        }
+      }
+    }
+  }
+  for (auto i : stale) {
+    synced[i] = {sources[i].data().data_ptr(), sources[i].current_version()};
+  }
+  valid = true;
+  return changed;
+}
+
+}} // namespace torch::cuda
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "torch/csrc/autograd/variable.h"
+
+#include <ATen/ATen.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace torch { namespace cuda {
+
+// Keeps copies of a list of CUDA tensors, like the parameters and buffers of
+// a module, resident on a list of devices, so that replicas used for
+// inference don't re-broadcast them on every call. sync() broadcasts (with
+// broadcast_coalesced) only the sources whose version counter or data pointer
+// changed since the previous sync, and copies them into the existing copies:
+//
+//   ReplicaCache cache(devices, buffer_size);
+//   for (...) {
+//     if (cache.sync(sources)) {
+//       // cache.copies() holds new Variables, rebuild the replicas
+//     }
+//     ...
+//   }
+//
+// sync() returns true when copies() changed: on the first call, and when a
+// source is replaced by another Variable, or changes type or shape. The
+// sources are the copies of devices[0].
+//
+// Writes through .data, as done by the optimizers and load_state_dict, don't
+// bump the version counter of a Variable, so they have to be followed by
+// invalidate(). The copies don't require grad. Not thread safe.
+struct ReplicaCache {
+  ReplicaCache(std::vector<int64_t> devices, std::size_t buffer_size);
+
+  bool sync(const std::vector<autograd::Variable>& sources);
+  // Makes the next sync() broadcast all sources
+  void invalidate();
+
+  // copies()[d][i] is the copy of source i on devices[d]
+  const std::vector<std::vector<autograd::Variable>>& copies() const {
+    return replicas;
+  }
+
+  const std::vector<int64_t>& devices() const {
+    return device_ids;
+  }
+
+ private:
+  struct Synced {
+    const void* data;
+    uint32_t version;
+  };
+
+  std::vector<int64_t> device_ids;
+  std::size_t buffer_size;
+  std::vector<std::vector<autograd::Variable>> replicas;
+  // What each source was at the last sync, when valid
+  std::vector<Synced> synced;
+  bool valid;
+};
+
+}} // namespace torch::cuda
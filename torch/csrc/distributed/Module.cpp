@@ -285,6 +285,98 @@ PyObject* THDPModule_irecv(PyObject *_unused, PyObject *args)
   END_HANDLE_TH_ERRORS
 }
 
+PyObject* THDPModule_isendMultiple(PyObject *_unused, PyObject *args)
+{
+  HANDLE_TH_ERRORS
+  std::vector<at::Tensor> descriptors;
+  std::size_t length;
+  int dst_rank;
+  THPObjectPtr sequence;
+  THDRequest* req;
+
+  if (PyTuple_GET_SIZE(args) != 2 || !PySequence_Check(PyTuple_GET_ITEM(args, 0)) ||
+        !THPUtils_checkLong(PyTuple_GET_ITEM(args, 1))) {
+    goto invalid_arguments;
+  }
+
+  sequence = THPObjectPtr(PySequence_Fast(PyTuple_GET_ITEM(args, 0),
+                                          "expected a sequence"));
+  if (!sequence.get()) {
+    goto invalid_arguments;
+  }
+
+  length = static_cast<std::size_t>(PySequence_Fast_GET_SIZE(sequence.get()));
+  descriptors.reserve(length);
+  for (std::size_t i = 0; i < length; ++i) {
+    if (!THPVariable_Check(PySequence_Fast_GET_ITEM(sequence.get(), i))) {
+      goto invalid_arguments;
+    }
+
+    descriptors.push_back(
+      THDPModule_makeDescriptor(PySequence_Fast_GET_ITEM(sequence.get(), i))
+    );
+  }
+
+  dst_rank = THPUtils_unpackLong(PyTuple_GET_ITEM(args, 1));
+  {
+    AutoNoGIL guard;
+    req = THDIsendMultiple(descriptors.data(), length, dst_rank);
+  }
+  return THPWrapper_New(req, (void(*)(void*))THDRequest_free);
+
+invalid_arguments:
+  THPUtils_invalidArguments(args, NULL, "isend", 1,
+                            "(list[tensor] input, int dst_rank)");
+  return NULL;
+  END_HANDLE_TH_ERRORS
+}
+
+PyObject* THDPModule_irecvMultiple(PyObject *_unused, PyObject *args)
+{
+  HANDLE_TH_ERRORS
+  std::vector<at::Tensor> descriptors;
+  std::size_t length;
+  int src_rank;
+  THPObjectPtr sequence;
+  THDRequest* req;
+
+  if (PyTuple_GET_SIZE(args) != 2 || !PySequence_Check(PyTuple_GET_ITEM(args, 0)) ||
+        !THPUtils_checkLong(PyTuple_GET_ITEM(args, 1))) {
+    goto invalid_arguments;
+  }
+
+  sequence = THPObjectPtr(PySequence_Fast(PyTuple_GET_ITEM(args, 0),
+                                          "expected a sequence"));
+  if (!sequence.get()) {
+    goto invalid_arguments;
+  }
+
+  length = static_cast<std::size_t>(PySequence_Fast_GET_SIZE(sequence.get()));
+  descriptors.reserve(length);
+  for (std::size_t i = 0; i < length; ++i) {
+    if (!THPVariable_Check(PySequence_Fast_GET_ITEM(sequence.get(), i))) {
+      goto invalid_arguments;
+    }
+
+    descriptors.push_back(
+      THDPModule_makeDescriptor(PySequence_Fast_GET_ITEM(sequence.get(), i))
+    );
+  }
+
+  src_rank = THPUtils_unpackLong(PyTuple_GET_ITEM(args, 1));
+  {
+    AutoNoGIL guard;
+    req = THDIrecvMultiple(descriptors.data(), length, src_rank);
+  }
+  return THPWrapper_New(req, (void(*)(void*))THDRequest_free);
+
+invalid_arguments:
+  THPUtils_invalidArguments(args, NULL, "irecv", 1,
+                            "(list[tensor] output, int src_rank)");
+  return NULL;
+  END_HANDLE_TH_ERRORS
+}
+
 PyObject* THDPModule_send(PyObject *_unused, PyObject *args)
 {
   HANDLE_TH_ERRORS
@@ -612,6 +704,26 @@ PyObject* THDPModule_allReduce(PyObject *_unused, PyObject *args)
   END_HANDLE_TH_ERRORS
 }
 
+PyObject* THDPModule_iallReduce(PyObject *_unused, PyObject *args)
+{
+  HANDLE_TH_ERRORS
+  if (PyTuple_GET_SIZE(args) != 3 || !THPVariable_Check(PyTuple_GET_ITEM(args, 0))) {
+    THPUtils_invalidArguments(args, NULL, "iall_reduce", 1, "(tensor in_out, reduce_op op, group gr)");
+    return NULL;
+  }
+
+  THDGroup group = _getGroup(PyTuple_GET_ITEM(args, 2));
+  THDReduceOp op = _getReduceOp(PyTuple_GET_ITEM(args, 1));
+  auto desc = THDPModule_makeDescriptor(PyTuple_GET_ITEM(args, 0));
+  THDRequest* req;
+  {
+    AutoNoGIL guard;
+    req = THDIallReduce(desc, op, group);
+  }
+  return THPWrapper_New(req, (void(*)(void*))THDRequest_free);
+  END_HANDLE_TH_ERRORS
+}
+
 PyObject* THDPModule_reduce(PyObject *_unused, PyObject *args)
 {
   HANDLE_TH_ERRORS
@@ -655,6 +767,28 @@ PyObject* THDPModule_broadcast(PyObject *_unused, PyObject *args)
   END_HANDLE_TH_ERRORS
 }
 
+PyObject* THDPModule_ibroadcast(PyObject *_unused, PyObject *args)
+{
+  HANDLE_TH_ERRORS
+  if (PyTuple_GET_SIZE(args) != 3 || !THPVariable_Check(PyTuple_GET_ITEM(args, 0)) ||
+        !THPUtils_checkLong(PyTuple_GET_ITEM(args, 1))) {
+    THPUtils_invalidArguments(args, NULL, "ibroadcast", 1,
+        "(tensor src_dst, int src_rank, group gr)");
+    return NULL;
+  }
+
+  THDGroup group = _getGroup(PyTuple_GET_ITEM(args, 2));
+  auto desc = THDPModule_makeDescriptor(PyTuple_GET_ITEM(args, 0));
+  int src_rank = THPUtils_unpackLong(PyTuple_GET_ITEM(args, 1));
+  THDRequest* req;
+  {
+    AutoNoGIL guard;
+    req = THDIbroadcast(desc, src_rank, group);
+  }
+  return THPWrapper_New(req, (void(*)(void*))THDRequest_free);
+  END_HANDLE_TH_ERRORS
+}
+
 PyObject* THDPModule_allGather(PyObject *_unused, PyObject *args)
 {
   HANDLE_TH_ERRORS
@@ -992,14 +1126,18 @@ static struct PyMethodDef _THDPModule_methods[] = {
   {"_dist_get_num_processes", (PyCFunction)THDPModule_getNumProcesses, METH_NOARGS, NULL},
   {"_dist_isend", (PyCFunction)THDPModule_isend, METH_VARARGS, NULL},
   {"_dist_irecv", (PyCFunction)THDPModule_irecv, METH_VARARGS, NULL},
+  {"_dist_isend_multiple", (PyCFunction)THDPModule_isendMultiple, METH_VARARGS, NULL},
+  {"_dist_irecv_multiple", (PyCFunction)THDPModule_irecvMultiple, METH_VARARGS, NULL},
   {"_dist_send", (PyCFunction)THDPModule_send, METH_VARARGS, NULL},
   {"_dist_recv_any_source", (PyCFunction)THDPModule_recvAnySource, METH_O, NULL},
   {"_dist_recv", (PyCFunction)THDPModule_recv, METH_VARARGS, NULL},
   {"_dist_all_reduce", (PyCFunction)THDPModule_allReduce, METH_VARARGS, NULL},
+  {"_dist_iall_reduce", (PyCFunction)THDPModule_iallReduce, METH_VARARGS, NULL},
   {"_dist_all_reduce_multigpu", (PyCFunction)THDPModule_allReduceMultiGPU, METH_VARARGS, NULL},
   {"_dist_reduce", (PyCFunction)THDPModule_reduce, METH_VARARGS, NULL},
   {"_dist_reduce_multigpu", (PyCFunction)THDPModule_reduceMultiGPU, METH_VARARGS, NULL},
   {"_dist_broadcast", (PyCFunction)THDPModule_broadcast, METH_VARARGS, NULL},
+  {"_dist_ibroadcast", (PyCFunction)THDPModule_ibroadcast, METH_VARARGS, NULL},
   {"_dist_broadcast_multigpu", (PyCFunction)THDPModule_broadcastMultiGPU, METH_VARARGS, NULL},
   {"_dist_all_gather", (PyCFunction)THDPModule_allGather, METH_VARARGS, NULL},
   {"_dist_all_gather_multigpu", (PyCFunction)THDPModule_allGatherMultiGPU, METH_VARARGS, NULL},
@@ -179,6 +179,39 @@ static PyObject * THPStorage_(fromBuffer)(PyObject *_unused, PyObject *args, PyO
 }
 #endif
 
+#if !defined(THC_GENERIC_FILE) && !defined(THD_GENERIC_FILE)
+// Returns a storage of size elements that points into the memory of a
+// ByteStorage, starting at a byte offset, and keeps the ByteStorage alive.
+// Unlike a slice it is not a view, so it is serialized on its own.
+static PyObject * THPStorage_(newFromBytes)(PyObject *_unused, PyObject *args)
+{
+  HANDLE_TH_ERRORS
+  PyObject *bytes_obj;
+  Py_ssize_t offset, size;
+  if (!PyArg_ParseTuple(args, "Onn", &bytes_obj, &offset, &size)) {
+    return NULL;
+  }
+  THPUtils_assert(THPByteStorage_Check(bytes_obj), "_new_from_bytes expected "
+      "a torch.ByteStorage, but got %s", THPUtils_typename(bytes_obj));
+  THByteStorage *bytes = ((THPByteStorage*)bytes_obj)->cdata;
+  THPUtils_assert(offset >= 0 && size >= 0 && offset % sizeof(real) == 0,
+      "_new_from_bytes: invalid offset %" PRId64 " or size %" PRId64,
+      (int64_t)offset, (int64_t)size);
+  THPUtils_assert(offset + size * (Py_ssize_t)sizeof(real) <= THByteStorage_size(bytes),
+      "_new_from_bytes: %" PRId64 " elements at offset %" PRId64 " are out of "
+      "bounds of a storage of %" PRId64 " bytes", (int64_t)size, (int64_t)offset,
+      (int64_t)THByteStorage_size(bytes));
+  THStoragePtr storage(THStorage_(newWithDataAndAllocator)(
+      (real*)(THByteStorage_data(bytes) + offset), size,
+      &THByteStorageSliceAllocator, bytes));
+  THByteStorage_retain(bytes);
+  PyObject *result = THPStorage_(New)(storage);
+  storage.release();
+  return result;
+  END_HANDLE_TH_ERRORS
+}
+#endif
+
 static PyObject * THPStorage_(fromFile)(PyObject *_unused, PyObject *args, PyObject *keywds)
 {
   HANDLE_TH_ERRORS
@@ -212,7 +245,11 @@ PyObject * THPStorage_(writeFile)(THPStorage *self, PyObject *args)
   int fd = PyObject_AsFileDescriptor(file);
   THPUtils_assert(fd != -1, "_write_file couldn't retrieve a file descriptor "
       "from given object");
-  THPStorage_(writeFileRaw)(self->cdata, fd);
+  {
+    // lets torch.save_async write several storages at once
+    AutoNoGIL no_gil;
+    THPStorage_(writeFileRaw)(self->cdata, fd);
+  }
   Py_RETURN_NONE;
   END_HANDLE_TH_ERRORS
 }
@@ -328,6 +365,7 @@ static PyMethodDef THPStorage_(methods)[] = {
 #endif // !defined(THD_GENERIC_FILE)
 #if !defined(THC_GENERIC_FILE) && !defined(THD_GENERIC_FILE)
   {"from_buffer", (PyCFunction)THPStorage_(fromBuffer), METH_VARARGS | METH_KEYWORDS | METH_STATIC, NULL},
+  {"_new_from_bytes", (PyCFunction)THPStorage_(newFromBytes), METH_VARARGS | METH_STATIC, NULL},
 #endif
   {"from_file", (PyCFunction)THPStorage_(fromFile), METH_VARARGS | METH_KEYWORDS | METH_STATIC, NULL},
 #ifdef THC_GENERIC_FILE
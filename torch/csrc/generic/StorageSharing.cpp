@@ -4,6 +4,20 @@
 #endif
 
 
+#ifndef THC_GENERIC_FILE
+static libshm_arena_context * THPStorage_(arenaContext)(THStorage *storage)
+{
+  if (storage->allocator == &THArenaSharedAllocator) {
+    return (libshm_arena_context*)storage->allocatorContext;
+  } else if (storage->allocator == &THStorageWeakRefAllocator) {
+    auto allocator_obj = ((StorageWeakRefAllocator*)storage->allocatorContext);
+    if (allocator_obj->allocator == &THArenaSharedAllocator)
+      return (libshm_arena_context*)allocator_obj->allocatorContext;
+  }
+  return NULL;
+}
+#endif
+
 static PyObject * THPStorage_(sharedDecref)(THPStorage *self)
 {
   HANDLE_TH_ERRORS
@@ -19,6 +33,8 @@ static PyObject * THPStorage_(sharedDecref)(THPStorage *self)
   }
   if (ctx)
     THRefcountedMapAllocator_decref(ctx->th_context, storage->data);
+  if (auto arena_ctx = THPStorage_(arenaContext)(storage))
+    libshm_arena_decref(arena_ctx);
 #endif
   Py_INCREF(self);
   return (PyObject *)self;
@@ -40,6 +56,8 @@ static PyObject * THPStorage_(sharedIncref)(THPStorage *self)
   }
   if (ctx)
     THRefcountedMapAllocator_incref(ctx->th_context, storage->data);
+  if (auto arena_ctx = THPStorage_(arenaContext)(storage))
+    libshm_arena_incref(arena_ctx);
 #endif
   Py_RETURN_NONE;
   END_HANDLE_TH_ERRORS
@@ -148,6 +166,90 @@ static PyObject * THPStorage_(newSharedFilename)(PyObject *_unused, PyObject *ar
   END_HANDLE_TH_ERRORS
 }
 
+// Returns NULL if this process has no arena, or if it's full
+static THStorage* THPStorage_(newArenaStorage)(ptrdiff_t size)
+{
+  libshm_arena *arena = libshm_arena_get();
+  if (!arena || size == 0)
+    return NULL;
+  auto ctx = libshm_arena_context_new(arena, size * sizeof(real));
+  if (!ctx)
+    return NULL;
+  return THStorage_(newWithAllocator)(size, &THArenaSharedAllocator, (void*)ctx);
+}
+
+static PyObject * THPStorage_(pyNewArenaStorage)(PyObject *_unused, PyObject *args)
+{
+  HANDLE_TH_ERRORS
+  long long size;
+  if (!PyArg_ParseTuple(args, "L", &size)) {
+    return NULL;
+  }
+  THStorage *storage = THPStorage_(newArenaStorage)(size);
+  if (!storage)
+    Py_RETURN_NONE;
+  return THPStorage_(New)(storage);
+  END_HANDLE_TH_ERRORS
+}
+
+// Storages are never moved into an arena; this returns None for storages
+// that weren't allocated from one.
+static PyObject * THPStorage_(shareArena)(THPStorage *self)
+{
+  HANDLE_TH_ERRORS
+  THStorage *storage = self->cdata;
+  libshm_arena_context *ctx = THPStorage_(arenaContext)(storage);
+  if (!ctx)
+    Py_RETURN_NONE;
+
+  THPObjectPtr manager_handle(PyBytes_FromString(libshm_arena_manager_handle(ctx->arena)));
+  if (!manager_handle) return NULL;
+  THPObjectPtr arena_handle(PyBytes_FromString(libshm_arena_filename(ctx->arena)));
+  if (!arena_handle) return NULL;
+  THPObjectPtr arena_size(PyLong_FromSize_t(libshm_arena_size(ctx->arena)));
+  if (!arena_size) return NULL;
+  THPObjectPtr offset(PyLong_FromUnsignedLongLong(ctx->offset));
+  if (!offset) return NULL;
+  THPObjectPtr size(PyLong_FromLong(storage->size));
+  if (!size) return NULL;
+
+  THPObjectPtr tuple(PyTuple_New(5));
+  if (!tuple) return NULL;
+  PyTuple_SET_ITEM(tuple.get(), 0, manager_handle.release());
+  PyTuple_SET_ITEM(tuple.get(), 1, arena_handle.release());
+  PyTuple_SET_ITEM(tuple.get(), 2, arena_size.release());
+  PyTuple_SET_ITEM(tuple.get(), 3, offset.release());
+  PyTuple_SET_ITEM(tuple.get(), 4, size.release());
+  return tuple.release();
+  END_HANDLE_TH_ERRORS
+}
+
+static PyObject * THPStorage_(newSharedArena)(PyObject *_unused, PyObject *args)
+{
+  HANDLE_TH_ERRORS
+  THPUtils_assert(PyTuple_GET_SIZE(args) == 5, "tuple of 5 items expected");
+  PyObject *_manager_handle = PyTuple_GET_ITEM(args, 0);
+  PyObject *_arena_handle = PyTuple_GET_ITEM(args, 1);
+  PyObject *_arena_size = PyTuple_GET_ITEM(args, 2);
+  PyObject *_offset = PyTuple_GET_ITEM(args, 3);
+  PyObject *_size = PyTuple_GET_ITEM(args, 4);
+  if (!PyBytes_Check(_manager_handle) || !PyBytes_Check(_arena_handle) ||
+      !THPUtils_checkLong(_arena_size) || !THPUtils_checkLong(_offset) ||
+      !THPUtils_checkLong(_size)) {
+    THPUtils_invalidArguments(args, NULL, "_new_shared in arena mode", 1,
+        "a manager handle, an arena handle (string/bytes), the arena size, "
+        "an offset and the storage size (int)");
+    return NULL;
+  }
+  libshm_arena *arena = libshm_arena_open(
+      PyBytes_AS_STRING(_manager_handle), PyBytes_AS_STRING(_arena_handle),
+      THPUtils_unpackLong(_arena_size));
+  auto ctx = libshm_arena_context_at(arena, THPUtils_unpackLong(_offset));
+  return THPStorage_(New)(THStorage_(newWithAllocator)(THPUtils_unpackLong(_size),
+      &THArenaSharedAllocator, (void*)ctx));
+  END_HANDLE_TH_ERRORS
+}
+
 static THStorage* THPStorage_(newFdStorage)(ptrdiff_t size)
 {
   int flags = TH_ALLOCATOR_MAPPED_SHAREDMEM |
@@ -417,7 +519,8 @@ PyObject * THPStorage_(isShared)(THPStorage *self)
   void *allocator = self->cdata->allocator;
   if (allocator == &THMapAllocator ||
       allocator == &THStorageWeakRefAllocator ||
-      allocator == &THManagedSharedAllocator) {
+      allocator == &THManagedSharedAllocator ||
+      allocator == &THArenaSharedAllocator) {
     Py_RETURN_TRUE;
   } else {
     Py_RETURN_FALSE;
@@ -437,6 +540,9 @@ static PyMethodDef THPStorage_(sharingMethods)[] = {
   {"_share_filename_", (PyCFunction)THPStorage_(shareFilename), METH_NOARGS, NULL},
   {"_new_shared_filename", (PyCFunction)THPStorage_(newSharedFilename), METH_VARARGS | METH_STATIC, NULL},
   {"_new_using_filename", (PyCFunction)THPStorage_(pyNewFilenameStorage), METH_VARARGS | METH_STATIC, NULL},
+  {"_share_arena_", (PyCFunction)THPStorage_(shareArena), METH_NOARGS, NULL},
+  {"_new_shared_arena", (PyCFunction)THPStorage_(newSharedArena), METH_VARARGS | METH_STATIC, NULL},
+  {"_new_using_arena", (PyCFunction)THPStorage_(pyNewArenaStorage), METH_VARARGS | METH_STATIC, NULL},
 #endif
   {"_weak_ref", (PyCFunction)THPStorage_(weakRef), METH_O, NULL},
   {"_new_view", (PyCFunction)THPStorage_(newView), METH_VARARGS, NULL},
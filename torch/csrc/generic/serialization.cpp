@@ -4,21 +4,10 @@
 
 #define SYSCHECK(call) { ssize_t __result = call; if (__result < 0) throw std::system_error((int) __result, std::system_category()); }
 
+// Writes size elements in little endian byte order.
 template <class io>
-void THPStorage_(writeFileRaw)(THStorage *self, io fd)
+static void THPStorage_(writeElements)(io fd, real *data, int64_t size)
 {
-  real *data;
-  int64_t size = THStorage_(size)(LIBRARY_STATE self);
-#ifndef THC_GENERIC_FILE
-  data = THStorage_(data)(LIBRARY_STATE self);
-#else
-  std::unique_ptr<char[]> cpu_data(new char[size * sizeof(real)]);
-  data = (real*)cpu_data.get();
-  THCudaCheck(cudaMemcpy(data, THStorage_(data)(LIBRARY_STATE self), size * sizeof(real), cudaMemcpyDeviceToHost));
-#endif
-  ssize_t result = doWrite(fd, &size, sizeof(int64_t));
-  if (result != sizeof(int64_t))
-    throw std::system_error(result, std::system_category());
   // fast track for bytes and little endian
   if (sizeof(real) == 1 || THP_nativeByteOrder() == THPByteOrder::THP_LITTLE_ENDIAN) {
     char *bytes = (char *) data;
@@ -31,8 +20,6 @@ void THPStorage_(writeFileRaw)(THStorage *self, io fd)
       bytes += result;
       remaining -= result;
     }
-    if (remaining != 0)
-      throw std::system_error(result, std::system_category());
   } else {
     int64_t buffer_size = std::min(size, (int64_t)5000);
     std::unique_ptr<uint8_t[]> le_buffer(new uint8_t[buffer_size * sizeof(real)]);
@@ -59,40 +46,14 @@ void THPStorage_(writeFileRaw)(THStorage *self, io fd)
   }
 }
 
-template void THPStorage_(writeFileRaw<int>)(THStorage *self, int fd);
-template void THPStorage_(writeFileRaw<PyObject*>)(THStorage *self, PyObject* fd);
-
+// Reads size elements stored in little endian byte order.
 template <class io>
-THStorage * THPStorage_(readFileRaw)(io file, THStorage *_storage)
+static void THPStorage_(readElements)(io file, real *data, int64_t size)
 {
-  real *data;
-  int64_t size;
-  ssize_t result = doRead(file, &size, sizeof(int64_t));
-  if (result == 0)
-    throw std::runtime_error("unexpected EOF. The file might be corrupted.");
-  if (result != sizeof(int64_t))
-    throw std::system_error(result, std::system_category());
-  THStoragePtr storage;
-  if (_storage == nullptr) {
-    storage = THStorage_(newWithSize)(LIBRARY_STATE size);
-  } else {
-    THPUtils_assert(THStorage_(size)(LIBRARY_STATE _storage) == size,
-        "storage has wrong size: expected %ld got %ld",
-        size, THStorage_(size)(LIBRARY_STATE _storage));
-    storage = _storage;
-  }
-
-#ifndef THC_GENERIC_FILE
-  data = THStorage_(data)(LIBRARY_STATE storage);
-#else
-  std::unique_ptr<char[]> cpu_data(new char[size * sizeof(real)]);
-  data = (real*)cpu_data.get();
-#endif
-
   // fast track for bytes and little endian
   if (sizeof(real) == 1 || THP_nativeByteOrder() == THPByteOrder::THP_LITTLE_ENDIAN) {
     char *bytes = (char *) data;
-    int64_t remaining = sizeof(real) * THStorage_(size)(LIBRARY_STATE storage);
+    int64_t remaining = sizeof(real) * size;
     while (remaining > 0) {
       // we write and read in 1GB blocks to avoid bugs on some OSes
       ssize_t result = doRead(file, bytes, THMin(remaining, 1073741824));
@@ -103,13 +64,10 @@ THStorage * THPStorage_(readFileRaw)(io file, THStorage *_storage)
       bytes += result;
       remaining -= result;
     }
-    if (remaining != 0)
-      throw std::system_error(result, std::system_category());
   } else {
     int64_t buffer_size = std::min(size, (int64_t)5000);
     std::unique_ptr<uint8_t[]> le_buffer(new uint8_t[buffer_size * sizeof(real)]);
 
-
     for (int64_t i = 0; i < size; i += buffer_size) {
       size_t to_convert = std::min(size - i, buffer_size);
       SYSCHECK(doRead(file, le_buffer.get(), sizeof(real) * to_convert));
@@ -132,9 +90,68 @@ THStorage * THPStorage_(readFileRaw)(io file, THStorage *_storage)
       }
     }
   }
+}
 
 #ifdef THC_GENERIC_FILE
-  THCudaCheck(cudaMemcpy(THStorage_(data)(LIBRARY_STATE storage), data, size * sizeof(real), cudaMemcpyHostToDevice));
+// CUDA storages are staged through a host buffer of at most this many bytes,
+// so that saving or loading one doesn't need a full copy of it in host memory
+static const int64_t THPStorage_(stagingBytes) = 64 * 1024 * 1024;
+#endif
+
+template <class io>
+void THPStorage_(writeFileRaw)(THStorage *self, io fd)
+{
+  int64_t size = THStorage_(size)(LIBRARY_STATE self);
+  ssize_t result = doWrite(fd, &size, sizeof(int64_t));
+  if (result != sizeof(int64_t))
+    throw std::system_error(result, std::system_category());
+#ifndef THC_GENERIC_FILE
+  THPStorage_(writeElements)(fd, THStorage_(data)(LIBRARY_STATE self), size);
+#else
+  int64_t chunk = std::max<int64_t>(1, std::min<int64_t>(size, THPStorage_(stagingBytes) / sizeof(real)));
+  std::unique_ptr<char[]> cpu_data(new char[chunk * sizeof(real)]);
+  real *data = (real*)cpu_data.get();
+  for (int64_t i = 0; i < size; i += chunk) {
+    int64_t n = std::min(size - i, chunk);
+    THCudaCheck(cudaMemcpy(data, THStorage_(data)(LIBRARY_STATE self) + i, n * sizeof(real), cudaMemcpyDeviceToHost));
+    THPStorage_(writeElements)(fd, data, n);
+  }
+#endif
+}
+
+template void THPStorage_(writeFileRaw<int>)(THStorage *self, int fd);
+template void THPStorage_(writeFileRaw<PyObject*>)(THStorage *self, PyObject* fd);
+
+template <class io>
+THStorage * THPStorage_(readFileRaw)(io file, THStorage *_storage)
+{
+  int64_t size;
+  ssize_t result = doRead(file, &size, sizeof(int64_t));
+  if (result == 0)
+    throw std::runtime_error("unexpected EOF. The file might be corrupted.");
+  if (result != sizeof(int64_t))
+    throw std::system_error(result, std::system_category());
+  THStoragePtr storage;
+  if (_storage == nullptr) {
+    storage = THStorage_(newWithSize)(LIBRARY_STATE size);
+  } else {
+    THPUtils_assert(THStorage_(size)(LIBRARY_STATE _storage) == size,
+        "storage has wrong size: expected %ld got %ld",
+        size, THStorage_(size)(LIBRARY_STATE _storage));
+    storage = _storage;
+  }
+
+#ifndef THC_GENERIC_FILE
+  THPStorage_(readElements)(file, THStorage_(data)(LIBRARY_STATE storage), size);
+#else
+  int64_t chunk = std::max<int64_t>(1, std::min<int64_t>(size, THPStorage_(stagingBytes) / sizeof(real)));
+  std::unique_ptr<char[]> cpu_data(new char[chunk * sizeof(real)]);
+  real *data = (real*)cpu_data.get();
+  for (int64_t i = 0; i < size; i += chunk) {
+    int64_t n = std::min(size - i, chunk);
+    THPStorage_(readElements)(file, data, n);
+    THCudaCheck(cudaMemcpy(THStorage_(data)(LIBRARY_STATE storage) + i, data, n * sizeof(real), cudaMemcpyHostToDevice));
+  }
 #endif
   return storage.release();
 }
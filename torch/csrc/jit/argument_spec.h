@@ -1,7 +1,9 @@
 #pragma once
 
+#include <algorithm>
 #include <iostream>
 #include <vector>
+#include "torch/csrc/assertions.h"
 #include "torch/csrc/autograd/variable.h"
 #include "torch/csrc/utils/hash.h"
 #include "torch/csrc/jit/variable_tensor_list.h"
@@ -37,12 +39,26 @@ static_assert(sizeof(TensorInfoPOD) == sizeof(int64_t),
 
 struct TensorInfo;
 
+// What ArgumentSpec records of one input, to build specs without tensors
+// (e.g. when reading them back from a shape profile, see shape_profile.h)
+struct TensorDescription {
+  bool defined = false;
+  at::ScalarType type = at::ScalarType::Undefined;
+  int device = -1;
+  bool requires_grad = false;
+  std::vector<int64_t> sizes;
+  std::vector<int64_t> strides;
+};
+
 struct ArgumentSpec {
   // note: tensors must always be variables
-  ArgumentSpec(bool with_grad, const variable_tensor_list & tensors)
+  // with_sizes=false leaves out sizes and strides (every tensor then reports
+  // 0 dimensions), so the spec only tells apart inputs that differ in type,
+  // device, definedness or requires_grad.
+  ArgumentSpec(bool with_grad, const variable_tensor_list & tensors, bool with_sizes = true)
   :  hash_code(0), ntensors(tensors.size()) {
     int all_dims = 0;
-    for(size_t i = 0; i < ntensors; i++) {
+    for(size_t i = 0; i < ntensors && with_sizes; i++) {
       all_dims += tensors[i].defined() ? tensors[i].ndimension() : 0;
     }
     // allocate enough room for all TensorPODs and dimensions
@@ -60,6 +76,8 @@ struct ArgumentSpec {
         pod.type = static_cast<unsigned int>(t.type().scalarType());
         pod.device = (!t.type().is_cuda()) ? -1 : t.get_device();
         pod.requires_grad = with_grad && static_cast<const autograd::Variable&>(t).requires_grad();
+      }
+      if(t.defined() && with_sizes) {
         total_dims += t.ndimension();
         auto sizes = t.sizes();
         std::copy(sizes.begin(),sizes.end(), next_dim);
@@ -71,12 +89,38 @@ struct ArgumentSpec {
       // each POD has a running tally of all dimensions including its own
       pod.total_dims = total_dims;
     }
-    // we precompute the hash_code to minimize the time inside of hash
-    // table operations where we may need to hold a compiler cache lock.
-    hash_code = hash_combine(0, ntensors);
-    for(auto d : data) {
-      hash_code = hash_combine(hash_code, d);
+    computeHashCode();
+  }
+
+  // the spec of inputs matching tensors, equal to the spec built from such
+  // inputs
+  explicit ArgumentSpec(const std::vector<TensorDescription> & tensors)
+  :  hash_code(0), ntensors(tensors.size()) {
+    size_t all_dims = 0;
+    for(const auto & t : tensors) {
+      JIT_ASSERT(t.sizes.size() == t.strides.size());
+      all_dims += t.defined ? t.sizes.size() : 0;
+    }
+    data.resize(ntensors + all_dims*2);
+
+    TensorInfoPOD * pods = reinterpret_cast<TensorInfoPOD*>(data.data());
+    int64_t * next_dim = sizes_strides();
+    int total_dims = 0;
+    for(size_t i = 0; i < ntensors; i++) {
+      const auto & t = tensors[i];
+      auto & pod = pods[i];
+      pod.defined = t.defined;
+      if(t.defined) {
+        pod.type = static_cast<unsigned int>(t.type);
+        pod.device = t.device;
+        pod.requires_grad = t.requires_grad;
+        total_dims += t.sizes.size();
+        next_dim = std::copy(t.sizes.begin(), t.sizes.end(), next_dim);
+        next_dim = std::copy(t.strides.begin(), t.strides.end(), next_dim);
+      }
+      pod.total_dims = total_dims;
     }
+    computeHashCode();
   }
 
   // equality is fast: check ntensors, and then check the raw array data,
@@ -97,6 +141,14 @@ struct ArgumentSpec {
   }
 
 private:
+  // we precompute the hash_code to minimize the time inside of hash
+  // table operations where we may need to hold a compiler cache lock.
+  void computeHashCode() {
+    hash_code = hash_combine(0, ntensors);
+    for(auto d : data) {
+      hash_code = hash_combine(hash_code, d);
+    }
+  }
   ArrayRef<TensorInfoPOD> tensor_info() const {
     return ArrayRef<TensorInfoPOD>(reinterpret_cast<const TensorInfoPOD*>(data.data()), ntensors);
   }
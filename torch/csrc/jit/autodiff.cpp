@@ -17,7 +17,8 @@ bool isDifferentiable(Node * n) {
   static std::unordered_set<Symbol> differentiable_kinds = {
     aten::add, aten::sub, aten::mul, prim::Constant, prim::ReplaceIfUndef,
     aten::sigmoid, aten::tanh, aten::mm, aten::chunk, aten::split, aten::t, aten::neg,
-    aten::unsqueeze, aten::expand,
+    aten::unsqueeze, aten::expand, aten::div, aten::exp, aten::log, aten::reciprocal,
+    aten::sqrt,
   };
   return differentiable_kinds.count(n->kind()) > 0;
 }
@@ -59,6 +60,20 @@ static std::vector<Value*> gradientForNode(Node* node, ArrayRef<Value*> grad_val
         return {grads.at(0) * outputs.at(0) * (1 - outputs.at(0))};
       case aten::tanh:
         return {grads.at(0) * (1 - outputs.at(0) * outputs.at(0))};
+      case aten::div:
+        // o = a / other
+        if(inputs.size() == 1)
+          return {grads.at(0) * at::Scalar(1. / at::Scalar(node->t(attr::other)).toDouble())};
+        // o = a / b
+        return {grads.at(0) / inputs.at(1), -grads.at(0) * outputs.at(0) / inputs.at(1)};
+      case aten::exp:
+        return {grads.at(0) * outputs.at(0)};
+      case aten::log:
+        return {grads.at(0) / inputs.at(0)};
+      case aten::reciprocal:
+        return {-grads.at(0) * outputs.at(0) * outputs.at(0)};
+      case aten::sqrt:
+        return {grads.at(0) / outputs.at(0) * at::Scalar(0.5)};
       case aten::chunk:
       case aten::split:
         return {SymbolicVariable::cat(grads, node->i(attr::dim))};
@@ -338,6 +353,73 @@ static void passthroughUndefs(std::shared_ptr<Graph> graph) {
 
 }
 
+// Pointwise ops cheap enough to run again in df rather than save their
+// outputs. Only ops without broadcasting qualify, so that recomputing never
+// needs saving values larger than the one it replaces.
+static bool isRecomputable(Node * node) {
+  static std::unordered_set<Symbol> recomputable_kinds = {
+    aten::add, aten::sub, aten::mul, aten::div, aten::neg, aten::sigmoid, aten::tanh,
+    aten::exp, aten::log, aten::reciprocal, aten::sqrt,
+  };
+  if (recomputable_kinds.count(node->kind()) == 0 || node->outputs().size() != 1)
+    return false;
+  auto type = node->output()->type()->cast<TensorType>();
+  if (!type)
+    return false;
+  return std::all_of(node->inputs().begin(), node->inputs().end(), [&](Value * v) {
+    auto input_type = v->type()->cast<TensorType>();
+    return input_type && input_type->sizes() == type->sizes();
+  });
+}
+
+// Recomputes intermediates of f that the reverse block uses at the start of
+// the reverse block, when they are cheap pointwise functions of values it has
+// to capture anyway (inputs of f, captured values, or recomputed ones). They
+// then need no temporary output of f, and they are freed after f runs rather
+// than after df does. df is fused like any other graph, so they are usually
+// recomputed inside the fused kernels of the backward pass.
+static void recomputeIntermediates(Graph & graph, Block * reverse_block) {
+  auto primal_block = graph.block();
+  const auto reverse_uses = [&](Value * v) {
+    use_list uses;
+    for (auto & use : v->uses()) {
+      if (use.user->owningBlock() != primal_block)
+        uses.push_back(use);
+    }
+    return uses;
+  };
+
+  // primal values the reverse block can use -> their values in the reverse block
+  value_map available;
+  for (Value * input : graph.inputs())
+    available[input] = input;
+  for (Node * node : graph.nodes()) {
+    for (Value * output : node->outputs()) {
+      if (!reverse_uses(output).empty())
+        available[output] = output;
+    }
+  }
+  value_set primal_outputs(graph.outputs().begin(), graph.outputs().end());
+
+  WithInsertPoint guard(*reverse_block->nodes().begin());
+  for (Node * node : graph.nodes()) {
+    if (!isRecomputable(node) || primal_outputs.count(node->output()) > 0)
+      continue;
+    auto uses = reverse_uses(node->output());
+    if (uses.empty())
+      continue;
+    if (!std::all_of(node->inputs().begin(), node->inputs().end(),
+                     [&](Value * v) { return available.count(v) > 0; }))
+      continue;
+    Node * recomputed = graph.insertNode(graph.createClone(node, [&](Value * v) {
+      return available.at(v);
+    }));
+    for (auto & use : uses)
+      use.user->replaceInput(use.offset, recomputed->output());
+    available[node->output()] = recomputed->output();
+  }
+}
+
 // Takes a grad_desc.f returned from `addReverseInline` and splits off the
 // reverse_block into its own graph, storing it in df.
 // All intermediates needed in the second stage are added to
@@ -350,6 +432,8 @@ static void lambdaLiftReverse(Gradient& grad_desc, ReverseDetails& rev_info) {
   auto primal_block = graph.block();
   auto reverse_block = rev_info.reverse_block;
 
+  recomputeIntermediates(graph, reverse_block);
+
   // --------------------------------------------------------------------------
   // 1. Find values of f that need to be captured.
   // --------------------------------------------------------------------------
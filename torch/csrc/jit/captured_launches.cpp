@@ -0,0 +1,293 @@
+#include "torch/csrc/jit/captured_launches.h"
+
+#include "torch/csrc/autograd/variable.h"
+#include "torch/csrc/jit/passes/plan_memory.h"
+#include "torch/csrc/utils/auto_gpu.h"
+
+#include <ATen/ATen.h>
+
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#ifdef WITH_CUDA
+#include <THC/THC.h>
+#include <cuda.h>
+#include <cuda_runtime.h>
+#endif
+
+namespace torch { namespace jit {
+
+#if defined(WITH_CUDA) && CUDA_VERSION >= 10000
+
+namespace {
+
+// Makes stream the current stream of its device for the guard's lifetime
+struct AutoStream {
+  explicit AutoStream(THCStream* stream)
+    : state(at::globalContext().getTHCState())
+    , prev_stream(THCState_getStream(state)) {
+    THCStream_retain(prev_stream);
+    THCState_setStream(state, stream);
+  }
+
+  ~AutoStream() {
+    THCState_setStream(state, prev_stream);
+    THCStream_free(prev_stream);
+  }
+
+  THCState* state;
+  THCStream* prev_stream;
+};
+
+cudaStream_t currentStream() {
+  return THCState_getCurrentStream(at::globalContext().getTHCState());
+}
+
+// A fresh tensor with the sizes and strides of type
+at::Tensor emptyLike(TensorType* type) {
+  auto & tensor_type = at::globalContext().getType(at::Backend::CUDA, type->scalarType());
+  int64_t storage_size = 1;
+  for(size_t i = 0; i < type->sizes().size(); ++i) {
+    if(type->sizes()[i] == 0) {
+      storage_size = 0;
+      break;
+    }
+    storage_size += (type->sizes()[i] - 1) * type->strides()[i];
+  }
+  return tensor_type.tensor({storage_size}).as_strided(type->sizes(), type->strides());
+}
+
+// a planned node or a node with an out= variant, and the fixed buffers of
+// its inputs and outputs
+struct Step {
+  OutOperation op;
+  std::vector<at::Tensor> inputs;
+  std::vector<at::Tensor> outputs;
+};
+
+// (data, version) of the tensor an input buffer was last copied from
+struct CopiedInput {
+  void* data;
+  uint32_t version;
+};
+
+struct CUDACapturedLaunches : public CapturedLaunches {
+  CUDACapturedLaunches(Graph & graph, int device)
+  : device(device), copied(graph.inputs().size(), CopiedInput {nullptr, 0}) {
+    AutoGPU guard(device);
+    std::unordered_map<Value*, at::Tensor> buffers;
+    for(auto input : graph.inputs()) {
+      auto buffer = emptyLike(input->type()->expect<TensorType>());
+      inputs.push_back(buffer);
+      buffers[input] = buffer;
+    }
+    // the arenas are kept alive by the slices of them in the steps
+    for(auto n : graph.nodes()) {
+      if(n->kind() == prim::Constant) {
+        buffers[n->output()] = n->t(attr::value);
+        continue;
+      }
+      if(n->kind() == prim::MemoryArena) {
+        buffers[n->output()] = emptyLike(n->output()->type()->expect<TensorType>());
+        continue;
+      }
+      Step step;
+      step.op = tryGetOutOperation(n);
+      auto node_inputs = n->inputs();
+      bool planned = n->hasAttribute(attr::arena_offsets);
+      if(planned)
+        node_inputs = node_inputs.slice(0, node_inputs.size() - 1);
+      for(auto input : node_inputs)
+        step.inputs.push_back(buffers.at(input));
+      for(size_t i = 0; i < n->outputs().size(); ++i) {
+        auto output = n->outputs()[i];
+        auto type = output->type()->expect<TensorType>();
+        at::Tensor buffer;
+        if(planned) {
+          auto & arena = buffers.at(n->inputs().back());
+          buffer = arena.as_strided(type->sizes(), type->strides(), n->is(attr::arena_offsets)[i]);
+        } else {
+          buffer = emptyLike(type);
+        }
+        step.outputs.push_back(buffer);
+        buffers[output] = buffer;
+      }
+      steps.push_back(std::move(step));
+    }
+    for(auto output : graph.outputs())
+      outputs.push_back(buffers.at(output));
+    THCudaCheck(cudaEventCreateWithFlags(&done, cudaEventDisableTiming));
+  }
+
+  virtual ~CUDACapturedLaunches() {
+    AutoGPU guard(device);
+    if(exec)
+      cudaGraphExecDestroy(exec);
+    if(stream)
+      THCStream_free(stream);
+    cudaEventDestroy(done);
+  }
+
+  virtual bool run(variable_tensor_list & stack) override {
+    std::lock_guard<std::mutex> lock(mutex);
+    if(failed)
+      return false;
+    AutoGPU guard(device);
+    // the buffers may still be in use by a run on another stream
+    THCudaCheck(cudaStreamWaitEvent(currentStream(), done, 0));
+    copyInputs(stack);
+    if(exec) {
+      THCudaCheck(cudaGraphLaunch(exec, currentStream()));
+    } else {
+      // the first run also initializes the libraries and compiles the
+      // fusion groups, none of which may happen during the capture
+      runSteps();
+      capture();
+    }
+    stack.clear();
+    for(auto & output : outputs)
+      stack.push_back(autograd::make_variable(output.clone(), /*requires_grad=*/false));
+    THCudaCheck(cudaEventRecord(done, currentStream()));
+    return true;
+  }
+
+private:
+  void copyInputs(const variable_tensor_list & stack) {
+    for(size_t i = 0; i < inputs.size(); ++i) {
+      auto & input = autograd::as_variable_ref(stack[i]);
+      CopiedInput current {input.data().data_ptr(), input.current_version()};
+      if(current.data == copied[i].data && current.version == copied[i].version)
+        continue;
+      inputs[i].copy_(input.data());
+      copied[i] = current;
+    }
+  }
+
+  void runSteps() {
+    for(auto & step : steps)
+      step.op(step.inputs, step.outputs);
+  }
+
+  // Records the steps on a side stream, which first waits for the work
+  // queued so far on the current stream. On failure the graph is never
+  // captured again, and the runs fall back to the interpreter.
+  void capture() {
+    cudaStream_t current = currentStream();
+    stream = THCStream_new(cudaStreamNonBlocking);
+    cudaStream_t side = THCStream_stream(stream);
+    THCudaCheck(cudaEventRecord(done, current));
+    THCudaCheck(cudaStreamWaitEvent(side, done, 0));
+    cudaGraph_t graph = nullptr;
+    {
+      AutoStream stream_guard(stream);
+#if CUDA_VERSION >= 10010
+      THCudaCheck(cudaStreamBeginCapture(side, cudaStreamCaptureModeThreadLocal));
+#else
+      THCudaCheck(cudaStreamBeginCapture(side));
+#endif
+      try {
+        runSteps();
+      } catch(std::exception &) {
+        failed = true;
+      }
+      if(cudaStreamEndCapture(side, &graph) != cudaSuccess)
+        failed = true;
+    }
+    if(!failed && cudaGraphInstantiate(&exec, graph, nullptr, nullptr, 0) != cudaSuccess) {
+      exec = nullptr;
+      failed = true;
+    }
+    if(graph)
+      cudaGraphDestroy(graph);
+    // clear the error of a failed capture, it doesn't affect later work
+    cudaGetLastError();
+  }
+
+  int device;
+  std::vector<at::Tensor> inputs;
+  std::vector<CopiedInput> copied;
+  std::vector<Step> steps;
+  std::vector<at::Tensor> outputs;
+  // recorded on the current stream at the end of every run
+  cudaEvent_t done;
+  THCStream* stream = nullptr;
+  cudaGraphExec_t exec = nullptr;
+  bool failed = false;
+  std::mutex mutex;
+};
+
+// The out= variants copy operands with other layouts to contiguous
+// temporaries, which may not be allocated during the capture
+bool isContiguous(const TensorType & type) {
+  return type.strides() == type.contiguous()->expect<TensorType>()->strides();
+}
+
+// a transposed operand of mm is handled by cuBLAS without a copy
+bool isTransposedMatrix(const TensorType & type) {
+  return type.sizes().size() == 2 && type.strides()[0] == 1 &&
+         type.strides()[1] == type.sizes()[0];
+}
+
+// hosts a CUDA tensor of device, or sets device if it is -1
+bool onDevice(const TypePtr & type, int & device) {
+  auto tensor_type = type->cast<TensorType>();
+  if(!tensor_type || tensor_type->device() == -1)
+    return false;
+  if(device == -1)
+    device = tensor_type->device();
+  return tensor_type->device() == device;
+}
+
+} // anonymous namespace
+
+std::shared_ptr<CapturedLaunches> CapturedLaunches::create(std::shared_ptr<Graph> graph) {
+  if(graph->stage() != 0)
+    return nullptr;
+  int device = -1;
+  for(auto input : graph->inputs()) {
+    if(!onDevice(input->type(), device))
+      return nullptr;
+  }
+  for(auto n : graph->nodes()) {
+    if(!n->blocks().empty())
+      return nullptr;
+    for(auto output : n->outputs()) {
+      if(!onDevice(output->type(), device))
+        return nullptr;
+    }
+    if(n->kind() == prim::Constant || n->kind() == prim::MemoryArena)
+      continue;
+    // cat copies the pointers of its inputs to the device from the host
+    if(n->kind() == aten::cat || !tryGetOutOperation(n))
+      return nullptr;
+    bool is_mm = n->kind() == aten::mm || n->kind() == aten::addmm;
+    for(auto input : n->inputs()) {
+      auto type = input->type()->expect<TensorType>();
+      if(!isContiguous(*type) && !(is_mm && isTransposedMatrix(*type)))
+        return nullptr;
+    }
+    for(auto output : n->outputs()) {
+      if(!isContiguous(*output->type()->expect<TensorType>()))
+        return nullptr;
+    }
+  }
+  // outputs are copied out of the buffers of the nodes that compute them
+  for(auto output : graph->outputs()) {
+    if(output->node()->kind() == prim::Param || output->node()->kind() == prim::Constant)
+      return nullptr;
+  }
+  if(device == -1)
+    return nullptr;
+  return std::make_shared<CUDACapturedLaunches>(*graph, device);
+}
+
+#else
+
+std::shared_ptr<CapturedLaunches> CapturedLaunches::create(std::shared_ptr<Graph> graph) {
+  return nullptr;
+}
+
+#endif
+
+}}
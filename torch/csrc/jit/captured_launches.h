@@ -0,0 +1,39 @@
+#pragma once
+
+#include "torch/csrc/jit/ir.h"
+#include "torch/csrc/jit/variable_tensor_list.h"
+
+#include <memory>
+
+namespace torch { namespace jit {
+
+// Replays the kernels of a shape-specialized CUDA inference graph with a
+// single launch, to save the per-op launch latency that dominates small
+// batches.
+//
+// Every value of the graph is given a buffer at a fixed address: the inputs
+// and outputs get their own, and the intermediates planned by PlanMemory stay
+// in their arenas. The first run executes the nodes through their out=
+// variants (see plan_memory.h) and then records the same sequence of kernels
+// with CUDA stream capture. Each later run copies the inputs into their
+// buffers, launches the recorded graph on the current stream and returns
+// copies of the outputs. An input that is the same tensor, at the same
+// version, as the one copied by the previous run is not copied again, so
+// that parameters passed as inputs cost nothing.
+//
+// Only graphs in which every node is a constant, an arena or has an out=
+// variant that neither allocates nor synchronizes with the host can be
+// captured, and all of their tensors must be on one device. Needs CUDA 10.
+struct CapturedLaunches {
+  // Returns nullptr if graph can't be captured
+  static std::shared_ptr<CapturedLaunches> create(std::shared_ptr<Graph> graph);
+  virtual ~CapturedLaunches() {}
+
+  // Runs the graph on inputs, which have the sizes and strides it was
+  // specialized to. Returns false and leaves inputs untouched if the capture
+  // failed, in which case the caller has to run the graph itself; it then
+  // fails for every later run as well.
+  virtual bool run(variable_tensor_list & stack) = 0;
+};
+
+}}
@@ -11,6 +11,7 @@
 #include <ATen/ATen.h>
 #include <ATen/optional.h>
 
+#include <cstdint>
 #include <cstring>
 #include <fstream>
 #include <memory>
@@ -27,9 +28,37 @@ std::string value_name(Value* n) {
   return n->uniqueName();
 }
 
+// Appends the raw data of initializers to a sidecar file as they are
+// encoded, so that they are never all held in memory at once.
+struct ExternalDataWriter {
+  explicit ExternalDataWriter(const std::string& filename)
+    : location(filename.substr(filename.find_last_of('/') + 1))
+    , out(filename, std::ios::binary | std::ios::trunc) {
+    if (!out) {
+      throw std::runtime_error("Could not open " + filename + " for writing");
+    }
+  }
+
+  // Writes the data of t and returns where it went, in the form the tensor's
+  // doc_string records it
+  std::string write(const at::Tensor& t) {
+    uint64_t length = t.numel() * t.type().elementSizeInBytes();
+    out.write(static_cast<const char*>(t.data_ptr()), length);
+    std::string where = "location=" + location + " offset=" + std::to_string(offset) +
+                        " length=" + std::to_string(length);
+    offset += length;
+    return where;
+  }
+
+  std::string location;
+  std::ofstream out;
+  uint64_t offset = 0;
+};
+
 struct ExportContext {
   size_t num_blocks = 0;
   bool export_raw_ir = false;
+  ExternalDataWriter* external_data = nullptr;
 };
 
 void encodeGraph(onnx::GraphProto * p_g, const std::shared_ptr<Graph> & g,
@@ -42,7 +71,8 @@ void encodeBlock(onnx::GraphProto * p_g, Block *b,
 
 void encodeTensor(onnx::TensorProto * p, const at::Tensor & tensor,
                   at::optional<std::string> external_ref={},
-                  RawDataExportMap* raw_data_export_map = nullptr) {
+                  RawDataExportMap* raw_data_export_map = nullptr,
+                  ExternalDataWriter* external_data = nullptr) {
   for(auto d : tensor.sizes()) {
     p->add_dims(d);
   }
@@ -84,8 +114,12 @@ void encodeTensor(onnx::TensorProto * p, const at::Tensor & tensor,
   auto t = tensor.contiguous().toBackend(at::kCPU).toType(cast_type);
   // Add a buffer to the raw_data_export_map for the caller to dump into an
   // external data store. If external_ref is not specified, we instead dump
-  // the contiguous data into the protobuf itself
-  if (external_ref) {
+  // the contiguous data into the protobuf itself. With external_data, the
+  // data goes straight to its file and the protobuf only records where.
+  if (external_data) {
+    p->set_external_data_present();
+    p->set_doc_string(external_data->write(t));
+  } else if (external_ref) {
     // For now, we use the name of the tensor as the external lookup name to
     // avoid ONNX protobuf changes.
     JIT_ASSERT(external_ref.value() == p->get_name());
@@ -305,7 +339,9 @@ void encodeBlock(onnx::GraphProto * p_g, Block *b,
     std::string name = p_g->get_input_name(inputs_count++);
     auto p = p_g->add_initializer();
     p->set_name(name);
-    if (raw_data_export_map) {
+    if (ctx->external_data) {
+      encodeTensor(p, tensor, {}, nullptr, ctx->external_data);
+    } else if (raw_data_export_map) {
       encodeTensor(p, tensor, name, raw_data_export_map);
     } else {
       encodeTensor(p, tensor, {});
@@ -316,10 +352,12 @@ void encodeBlock(onnx::GraphProto * p_g, Block *b,
 void encodeModel(onnx::ModelProto* p_m, const std::shared_ptr<Graph>& g,
                  const std::vector<at::Tensor>& initializers,
                  RawDataExportMap* raw_data_export_map = nullptr,
-                 bool export_raw_ir = false) {
+                 bool export_raw_ir = false,
+                 ExternalDataWriter* external_data = nullptr) {
   onnx::GraphProto* p_g = p_m->mutable_graph();
   ExportContext ctx;
   ctx.export_raw_ir = export_raw_ir;
+  ctx.external_data = external_data;
   encodeGraph(p_g, g, initializers, &ctx, raw_data_export_map);
 }
 
@@ -382,7 +420,8 @@ RawDataExportMap ToModelProto(
     int64_t onnx_opset_version,
     bool defer_weight_export,
     bool export_raw_ir,
-    onnx::ModelProto *model_proto) {
+    onnx::ModelProto *model_proto,
+    ExternalDataWriter* external_data = nullptr) {
   if (!export_raw_ir) {
     validateGraph(graph);
   }
@@ -401,7 +440,7 @@ RawDataExportMap ToModelProto(
   if (defer_weight_export) {
     encodeModel(model_proto, graph, initializers, &raw_data_export_map, export_raw_ir);
   } else {
-    encodeModel(model_proto, graph, initializers, nullptr, export_raw_ir);
+    encodeModel(model_proto, graph, initializers, nullptr, export_raw_ir, external_data);
   }
 
   return raw_data_export_map;
@@ -450,4 +489,102 @@ std::tuple<std::string, RawDataExportMap> ExportGraph(
   return std::make_tuple(out, raw_data_export_map);
 }
 
+void ExportGraphWithExternalData(
+                        const std::shared_ptr<Graph>& graph,
+                        const std::vector<at::Tensor> & initializers,
+                        int64_t onnx_opset_version,
+                        bool export_raw_ir,
+                        const std::string& model_filename,
+                        const std::string& data_filename) {
+  ::torch::onnx::ModelProto model_proto;
+  ExternalDataWriter external_data(data_filename);
+  ToModelProto(graph, initializers, onnx_opset_version, /*defer_weight_export=*/false,
+               export_raw_ir, &model_proto, &external_data);
+  external_data.out.flush();
+  if (!external_data.out) {
+    throw std::runtime_error("Failed to write " + data_filename);
+  }
+
+  std::ofstream out(model_filename, std::ios::binary | std::ios::trunc);
+  if (!out) {
+    throw std::runtime_error("Could not open " + model_filename + " for writing");
+  }
+  // Encode in a single pass straight into the file, without sizing the
+  // protobuf first or holding it in memory
+  auto write = [](pb_ostream_t* stream, const pb_byte_t* buf, size_t count) {
+    auto file = static_cast<std::ofstream*>(stream->state);
+    file->write(reinterpret_cast<const char*>(buf), count);
+    return static_cast<bool>(*file);
+  };
+  pb_ostream_t ostream = {write, &out, SIZE_MAX, 0};
+  if (!pb_encode(&ostream, onnx_ModelProto_fields, &model_proto.proto) || !out.flush()) {
+    throw std::runtime_error("Failed to write " + model_filename);
+  }
+}
+
+void ExportIRGraphFile(
+                        const std::shared_ptr<Graph>& graph,
+                        const std::vector<at::Tensor> & initializers,
+                        const std::string& filename) {
+  // The weights are written by us below, in their own scalar type, so the
+  // copies kept in the export map are not needed.
+  std::string graph_proto = std::get<0>(ExportGraph(
+    graph, initializers, /*onnx_opset_version=*/0, /*defer_weight_export=*/true, /*export_raw_ir=*/true));
+
+  auto align = [](uint64_t offset) {
+    return (offset + kIRFileAlignment - 1) / kIRFileAlignment * kIRFileAlignment;
+  };
+  auto tensors = fmap(initializers, [](const at::Tensor& t) {
+    return t.toBackend(at::kCPU).contiguous();
+  });
+
+  std::vector<uint64_t> header;
+  uint64_t header_words = 5;
+  for (auto & t : tensors) {
+    header_words += 3 + t.dim();
+  }
+  uint64_t graph_offset = sizeof(uint64_t) + header_words * sizeof(uint64_t);
+  header.push_back(kIRFileVersion);
+  header.push_back(graph_offset);
+  header.push_back(graph_proto.size());
+  header.push_back(tensors.size());
+  uint64_t offset = align(graph_offset + graph_proto.size());
+  std::vector<uint64_t> offsets;
+  for (auto & t : tensors) {
+    header.push_back(static_cast<uint64_t>(t.type().scalarType()));
+    header.push_back(offset);
+    header.push_back(t.dim());
+    for (auto d : t.sizes()) {
+      header.push_back(d);
+    }
+    offsets.push_back(offset);
+    offset = align(offset + t.numel() * t.type().elementSizeInBytes());
+  }
+  // the total size, so that a truncated file is detected on import
+  header.push_back(offset);
+  JIT_ASSERT(header.size() == header_words);
+
+  std::ofstream out(filename, std::ios::binary | std::ios::trunc);
+  if (!out) {
+    throw std::runtime_error("Could not open " + filename + " for writing");
+  }
+  static_assert(sizeof(kIRFileMagic) - 1 == sizeof(uint64_t), "the magic must be one word long");
+  out.write(kIRFileMagic, sizeof(uint64_t));
+  out.write(reinterpret_cast<const char*>(header.data()), header.size() * sizeof(uint64_t));
+  out.write(graph_proto.data(), graph_proto.size());
+  for (size_t i = 0; i < tensors.size(); ++i) {
+    while (static_cast<uint64_t>(out.tellp()) < offsets[i]) {
+      out.put('\0');
+    }
+    out.write(static_cast<const char*>(tensors[i].data_ptr()),
+              tensors[i].numel() * tensors[i].type().elementSizeInBytes());
+  }
+  while (static_cast<uint64_t>(out.tellp()) < offset) {
+    out.put('\0');
+  }
+  if (!out) {
+    throw std::runtime_error("Failed to write " + filename);
+  }
+}
+
 }}
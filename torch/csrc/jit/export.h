@@ -21,6 +21,43 @@ std::tuple<std::string, RawDataExportMap> ExportGraph(
     bool defer_weight_export = false,
     bool export_raw_ir = false);
 
+// Writes graph to model_filename and the raw data of its initializers to
+// data_filename, one after the other in order, as each is encoded. Every
+// initializer in the model has raw_data "__EXTERNAL" and a doc_string of the
+// form "location=<data file name> offset=<bytes> length=<bytes>". Neither the
+// weights nor the protobuf are ever all held in memory.
+void ExportGraphWithExternalData(
+    const std::shared_ptr<Graph>& graph,
+    const std::vector<at::Tensor>& initializers,
+    int64_t onnx_opset_version,
+    bool export_raw_ir,
+    const std::string& model_filename,
+    const std::string& data_filename);
+
+// Writes graph (with export_raw_ir) and its initializers to filename in a
+// native container that ImportIRGraphFile can load without copying weights.
+// The file starts with a header (all integers are uint64_t in host byte
+// order):
+//
+//   magic                           kIRFileMagic
+//   version                         kIRFileVersion
+//   graph offset, graph size        the ModelProto, with external weights
+//   number of tensors               one entry per initializer, in order:
+//     scalar type, data offset, number of dims, dims...
+//   file size
+//
+// The raw contiguous data of every tensor follows the graph, each blob
+// starting at a multiple of kIRFileAlignment so that it can be used directly
+// from a memory mapping of the file.
+constexpr char kIRFileMagic[] = "PTIRFILE";
+constexpr uint64_t kIRFileVersion = 1;
+constexpr uint64_t kIRFileAlignment = 4096;
+
+void ExportIRGraphFile(
+    const std::shared_ptr<Graph>& graph,
+    const std::vector<at::Tensor>& initializers,
+    const std::string& filename);
+
 // For testing purposes
 std::string PrettyPrintExportedGraph(
     const std::shared_ptr<Graph>& graph,
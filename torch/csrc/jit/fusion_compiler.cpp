@@ -7,6 +7,7 @@
 #include "torch/csrc/variable_tensor_functions.h"
 
 #include "ATen/ATen.h"
+#include "ATen/ExpandUtils.h"
 #ifdef WITH_CUDA
 #include "torch/csrc/cuda/cuda_check.h"
 #include <nvrtc.h>
@@ -16,11 +17,18 @@
 #include <string>
 #include <algorithm>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 #include <sstream>
 #include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <cerrno>
+#include <cstdlib>
 #include <dlfcn.h>
 #include <unistd.h>
+#include <sys/stat.h>
+#include <thread>
 
 namespace torch { namespace jit {
 
@@ -54,6 +62,104 @@ std::ostream& operator<<(std::ostream & out, const TensorDesc & d) {
   return out;
 }
 
+// The values written by a fusion group, with concatenated outputs replaced by
+// their subtensors (which is what the kernels compute).
+std::vector<Value*> flatOutputs(Graph & subgraph) {
+  std::vector<Value*> result;
+  for(auto o : subgraph.outputs()) {
+    if(o->node()->kind() == aten::cat) {
+      for(auto c : o->node()->inputs())
+        result.push_back(c);
+    } else {
+      result.push_back(o);
+    }
+  }
+  return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Reductions
+//
+// Every input of a fusion group is broadcast to the size of its outputs (the
+// map), and each node is evaluated at every element of the map. Groups may
+// also reduce over the innermost dimension of the map: sum and mean (with
+// keepdim, so their result broadcasts against the rest of the group), softmax
+// and log_softmax (see graph_fuser.cpp for the exact conditions).
+//
+// Such a group runs one row of the map at a time. A separate pass over the row
+// computes each reduction in topological order, and a final pass computes the
+// outputs. Every pass evaluates again the pointwise nodes it needs instead of
+// keeping them in memory, and sees the results of the earlier reductions as
+// per-row scalars. softmax and log_softmax take two passes: one for the
+// maximum of the row and one for the sum of exponentials.
+
+bool isReduction(Node * n) {
+  return n->kind() == aten::sum || n->kind() == aten::mean;
+}
+
+bool isSoftmax(Node * n) {
+  return n->kind() == aten::softmax || n->kind() == aten::log_softmax;
+}
+
+enum class ReduceKind { Sum, Max, SumExp };
+
+struct ReducePass {
+  Node * node; // the sum, mean, softmax or log_softmax
+  ReduceKind kind;
+  std::vector<Node*> nodes; // evaluated in this pass, in topological order
+};
+
+struct ReductionPlan {
+  std::vector<ReducePass> passes;
+  std::vector<Node*> output_nodes; // evaluated in the final pass
+  bool empty() const {
+    return passes.empty();
+  }
+};
+
+// Nodes needed to compute values at one element of the map. Reductions are
+// not included because their result is already known by then.
+std::vector<Node*> nodesNeededFor(Graph & subgraph, at::ArrayRef<Value*> values) {
+  std::unordered_set<Node*> needed;
+  std::vector<Value*> stack(values.begin(), values.end());
+  while(!stack.empty()) {
+    Node * n = stack.back()->node();
+    stack.pop_back();
+    if(n->kind() == prim::Param || isReduction(n) || !needed.insert(n).second)
+      continue;
+    for(auto input : n->inputs())
+      stack.push_back(input);
+  }
+  std::vector<Node*> result;
+  for(auto n : subgraph.nodes()) {
+    if(needed.count(n) > 0)
+      result.push_back(n);
+  }
+  return result;
+}
+
+ReductionPlan planReductions(Graph & subgraph) {
+  ReductionPlan plan;
+  for(auto n : subgraph.nodes()) {
+    if(!isReduction(n) && !isSoftmax(n))
+      continue;
+    auto nodes = nodesNeededFor(subgraph, n->inputs());
+    if(isReduction(n)) {
+      plan.passes.push_back({n, ReduceKind::Sum, nodes});
+    } else {
+      plan.passes.push_back({n, ReduceKind::Max, nodes});
+      plan.passes.push_back({n, ReduceKind::SumExp, nodes});
+    }
+  }
+  auto outputs = flatOutputs(subgraph);
+  for(auto o : outputs) {
+    if(isReduction(o->node()))
+      throw std::runtime_error("fusion groups can't output the result of a reduction");
+  }
+  plan.output_nodes = nodesNeededFor(subgraph, outputs);
+  return plan;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // Code generation
 
@@ -73,7 +179,7 @@ auto cuda_compilation_unit_template = CodeTemplate(R"(
 ${type_declarations}
 
 extern "C" __global__
-void ${kernelName}(IndexType totalElements, ${formals}) {
+void ${kernelName}(IndexType totalElements, IndexType rowSize, ${formals}) {
   for (IndexType linearIndex = blockIdx.x * blockDim.x + threadIdx.x;
         linearIndex < totalElements;
         linearIndex += gridDim.x * blockDim.x) {
@@ -85,6 +191,37 @@ void ${kernelName}(IndexType totalElements, ${formals}) {
 }
 )");
 
+// One block per row; launched with blockDim.x * sizeof(float) bytes of
+// shared memory, and blockDim.x must be a power of two.
+auto cuda_reduction_compilation_unit_template = CodeTemplate(R"(
+${type_declarations}
+
+// sum (or maximum, if is_max) of value over the threads of the block
+__device__ float blockReduce(float * buffer, float value, bool is_max) {
+  buffer[threadIdx.x] = value;
+  __syncthreads();
+  for (unsigned int s = blockDim.x / 2; s > 0; s >>= 1) {
+    if (threadIdx.x < s) {
+      float other = buffer[threadIdx.x + s];
+      buffer[threadIdx.x] = is_max ? fmaxf(buffer[threadIdx.x], other) : buffer[threadIdx.x] + other;
+    }
+    __syncthreads();
+  }
+  float result = buffer[0];
+  __syncthreads();
+  return result;
+}
+
+extern "C" __global__
+void ${kernelName}(IndexType totalElements, IndexType rowSize, ${formals}) {
+  extern __shared__ float reduceBuffer[];
+  IndexType rows = rowSize == 0 ? 0 : totalElements / rowSize;
+  for (IndexType row = blockIdx.x; row < rows; row += gridDim.x) {
+    ${rowBody}
+  }
+}
+)");
+
 auto cpu_compilation_unit_template = CodeTemplate(R"(
 #include <cstddef>
 #include <math.h>
@@ -92,7 +229,7 @@ auto cpu_compilation_unit_template = CodeTemplate(R"(
 ${type_declarations}
 
 #define OMP_THRESHOLD 100000
-static void ${kernelName}_kernel(IndexType totalElements, ${formals}) {
+static void ${kernelName}_kernel(IndexType totalElements, IndexType rowSize, ${formals}) {
   #pragma omp parallel for if(totalElements > OMP_THRESHOLD)
   for (IndexType linearIndex = 0;
         linearIndex < totalElements;
@@ -106,7 +243,37 @@ static void ${kernelName}_kernel(IndexType totalElements, ${formals}) {
 
 extern "C"
 void ${kernelName}(IndexType totalElements, void ** args) {
-  ${kernelName}_kernel(totalElements ${,argument_loads});
+  ${kernelName}_kernel(totalElements, *static_cast<IndexType*>(args[1]) ${,argument_loads});
+}
+)");
+
+auto cpu_reduction_compilation_unit_template = CodeTemplate(R"(
+#include <cstddef>
+#include <math.h>
+#include <iostream>
+${type_declarations}
+
+#define OMP_THRESHOLD 100000
+static void ${kernelName}_kernel(IndexType totalElements, IndexType rowSize, ${formals}) {
+  IndexType rows = rowSize == 0 ? 0 : totalElements / rowSize;
+  #pragma omp parallel for if(totalElements > OMP_THRESHOLD)
+  for (IndexType row = 0; row < rows; row++) {
+    ${rowBody}
+  }
+}
+
+extern "C"
+void ${kernelName}(IndexType totalElements, void ** args) {
+  ${kernelName}_kernel(totalElements, *static_cast<IndexType*>(args[1]) ${,argument_loads});
+}
+)");
+
+// One pass over the current row of a reduction kernel.
+auto reduction_pass_template = CodeTemplate(R"(
+for (IndexType col = ${firstCol}; col < rowSize; col += ${colStep}) {
+  IndexType linearIndex = row * rowSize + col;
+  ${tensorOffsets}
+  ${passBody}
 }
 )");
 
@@ -225,6 +392,13 @@ std::string encodeRHS(Node * n) {
     // simple derivatives
     {aten::_sigmoid_backward, "${0} * ${1} * (1.f - ${1})"},
     {aten::_tanh_backward,    "${0} * (1.f - ${1} * ${1})"},
+
+    // broadcasts are implicit, every value is computed for each element of the map
+    {aten::expand, "${0}"},
+
+    // the maximum and the sum have been computed by earlier passes, see ReductionPlan
+    {aten::softmax, "expf(${0} - ${max}) / ${sum}"},
+    {aten::log_softmax, "${0} - ${max} - logf(${sum})"},
   };
 
 
@@ -249,6 +423,10 @@ std::string encodeRHS(Node * n) {
       }
     }
   }
+  if(isSoftmax(n)) {
+    env.s("max", valueName(n->output()) + "_max");
+    env.s("sum", valueName(n->output()) + "_sum");
+  }
   const auto & str = simple_map_ops.at(n->kind());
   return format(str, env);
 }
@@ -272,7 +450,7 @@ std::vector<ConcatDesc> emitCompilationUnit(std::ostream & out,
     size_t nDim = desc.nDim();
     emitIndexingFor(tensorOffsets, tensor, nDim,  desc.lastIsContiguous());
     env.s("tensor",tensor);
-    env.d("formal_index", formals.size() + 1); // + 1 because the first argument is the linearIndex
+    env.d("formal_index", formals.size() + 2); // + 2 because the first arguments are totalElements and rowSize
     env.d("nDim",nDim);
     env.s("scalar_type",scalarTypeName(desc.scalar_type));
     formals.push_back(format("TensorInfo<${scalar_type},${nDim}> ${tensor}",env));
@@ -304,36 +482,105 @@ std::vector<ConcatDesc> emitCompilationUnit(std::ostream & out,
       }
     }
   }
-  size_t formal_count = 0;
-  for(auto p : subgraph.inputs()) {
-    env.s("node",valueName(p));
-    env.d("formal",formal_count++);
-    env.s("access",format("t${formal}.data[t${formal}_offset]",env));
-    //TODO: actual type propagation rather than relying on auto..
-    body << format("auto ${node} = ${access};\n",env);
-  }
-  for(auto n : subgraph.nodes()) {
-    if(n->kind() == aten::cat)
-      continue; // Concat nodes by narrowing the output Tensors before the kernel runs
-    env.s("node",valueName(n->output()));
-    env.s("rhs", encodeRHS(n));
-    body << format("auto ${node} = ${rhs};\n",env);
-  }
-  for(auto o : flat_output_nodes) {
-    env.d("formal",formal_count++);
-    env.s("access",format("t${formal}.data[t${formal}_offset]",env));
-    env.s("node",valueName(o));
-    body << format("${access} = ${node};\n",env);
+  // loads the inputs used by nodes (or listed in values) and computes nodes,
+  // for the element at linearIndex
+  auto emitNodes = [&](std::ostream & out, const std::vector<Node*> & nodes, at::ArrayRef<Value*> values) {
+    std::unordered_set<Value*> used(values.begin(), values.end());
+    for(auto n : nodes) {
+      for(auto i : n->inputs())
+        used.insert(i);
+    }
+    size_t formal_count = 0;
+    for(auto p : subgraph.inputs()) {
+      env.d("formal",formal_count++);
+      if(used.count(p) == 0)
+        continue;
+      env.s("node",valueName(p));
+      env.s("access",format("t${formal}.data[t${formal}_offset]",env));
+      //TODO: actual type propagation rather than relying on auto..
+      out << format("auto ${node} = ${access};\n",env);
+    }
+    for(auto n : nodes) {
+      if(n->kind() == aten::cat)
+        continue; // Concat nodes by narrowing the output Tensors before the kernel runs
+      env.s("node",valueName(n->output()));
+      env.s("rhs", encodeRHS(n));
+      out << format("auto ${node} = ${rhs};\n",env);
+    }
+  };
+  auto emitStores = [&](std::ostream & out) {
+    size_t formal_count = subgraph.inputs().size();
+    for(auto o : flat_output_nodes) {
+      env.d("formal",formal_count++);
+      env.s("access",format("t${formal}.data[t${formal}_offset]",env));
+      env.s("node",valueName(o));
+      out << format("${access} = ${node};\n",env);
+    }
+  };
+
+  ReductionPlan plan = planReductions(subgraph);
+  if(plan.empty()) {
+    emitNodes(body, std::vector<Node*>(subgraph.nodes().begin(), subgraph.nodes().end()), flat_output_nodes);
+    emitStores(body);
+  } else {
+    // consecutive threads of a block (on CUDA) take consecutive columns
+    TemplateEnv pass_env;
+    pass_env.s("firstCol", use_cuda ? "threadIdx.x" : "0");
+    pass_env.s("colStep", use_cuda ? "blockDim.x" : "1");
+    pass_env.s("tensorOffsets", tensorOffsets.str());
+    for(auto & pass : plan.passes) {
+      std::string result = valueName(pass.node->output());
+      std::string operand = valueName(pass.node->inputs()[0]);
+      std::string acc, init, update;
+      switch(pass.kind) {
+        case ReduceKind::Sum:
+          acc = result + "_acc";
+          init = "0.f";
+          update = acc + " += " + operand + ";\n";
+          break;
+        case ReduceKind::Max:
+          acc = result + "_max";
+          // nvrtc compiles without any headers, so there is no INFINITY there
+          init = use_cuda ? "-__int_as_float(0x7f800000)" : "-INFINITY";
+          update = acc + " = fmaxf(" + acc + ", " + operand + ");\n";
+          break;
+        case ReduceKind::SumExp:
+          acc = result + "_sum";
+          init = "0.f";
+          update = acc + " += expf(" + operand + " - " + result + "_max);\n";
+          break;
+      }
+      body << "float " << acc << " = " << init << ";\n";
+      std::stringstream pass_body;
+      emitNodes(pass_body, pass.nodes, pass.node->inputs());
+      pass_body << update;
+      pass_env.s("passBody", pass_body.str());
+      body << reduction_pass_template.format(pass_env);
+      if(use_cuda) {
+        body << acc << " = blockReduce(reduceBuffer, " << acc << ", "
+             << (pass.kind == ReduceKind::Max ? "true" : "false") << ");\n";
+      }
+      if(pass.kind == ReduceKind::Sum) {
+        body << "float " << result << " = " << acc
+             << (pass.node->kind() == aten::mean ? " / rowSize" : "") << ";\n";
+      }
+    }
+    std::stringstream pass_body;
+    emitNodes(pass_body, plan.output_nodes, flat_output_nodes);
+    emitStores(pass_body);
+    pass_env.s("passBody", pass_body.str());
+    body << reduction_pass_template.format(pass_env);
   }
   env.s("tensorOffsets",tensorOffsets.str());
   env.s("kernelBody",body.str());
+  env.s("rowBody",body.str());
   env.v("formals",formals);
   env.v("argument_loads",argument_loads);
   env.s("type_declarations", type_declarations_template.format(env));
   if(use_cuda) {
-    out << cuda_compilation_unit_template.format(env);
+    out << (plan.empty() ? cuda_compilation_unit_template : cuda_reduction_compilation_unit_template).format(env);
   } else {
-    out << cpu_compilation_unit_template.format(env);
+    out << (plan.empty() ? cpu_compilation_unit_template : cpu_reduction_compilation_unit_template).format(env);
   }
   return concat_desc;
 }
@@ -343,6 +590,30 @@ std::vector<ConcatDesc> emitCompilationUnit(std::ostream & out,
 } // codegen namespace
 } // anonymous namespace
 
+namespace {
+
+std::vector<std::vector<int64_t>> expandSizes(Graph & subgraph) {
+  std::vector<std::vector<int64_t>> result;
+  for(auto n : subgraph.nodes()) {
+    if(n->kind() == aten::expand)
+      result.push_back(n->is(attr::size));
+  }
+  return result;
+}
+
+// The size of the map of a fusion group: its inputs broadcast against each
+// other and against the sizes of its expands.
+std::vector<int64_t> mapSize(const std::vector<std::vector<int64_t>> & expand_sizes, at::ArrayRef<at::Tensor> inputs) {
+  std::vector<int64_t> result = inputs.at(0).sizes().vec();
+  for(auto & i : inputs)
+    result = at::infer_size(result, i.sizes());
+  for(auto & sizes : expand_sizes)
+    result = at::infer_size(result, sizes);
+  return result;
+}
+
+} // anonymous namespace
+
 // Host-side view of TensorInfo (that visivle for the kernel is defined above).
 // Note dims[0] - we need to dynamically allocate the dims.
 struct TensorInfo {
@@ -358,7 +629,13 @@ struct TensorInfo {
 CompiledFusionFunction::CompiledFusionFunction(const std::string & name, AnnotatedGraph & agraph)
   : name(name)
   , input_desc(agraph.input_desc)
-  , output_desc(agraph.output_desc) {}
+  , output_desc(agraph.output_desc) {
+  for(auto n : agraph.graph->nodes()) {
+    if(isReduction(n) || isSoftmax(n))
+      has_reductions = true;
+  }
+  expand_sizes = expandSizes(*agraph.graph);
+}
 
 namespace {
 
@@ -417,20 +694,25 @@ void CompiledFusionFunction::launch_with_tensors(at::ArrayRef<at::Tensor> inputs
   size_t flat_outputs_size = 0;
   for(auto & c : concat_desc)
     flat_outputs_size += c.nSubtensors;
+  // Inputs are broadcast to the size of the map, which the outputs get.
   // XXX: this code assumes that inputs are 32-bit addressable
-  // XXX: this code assumes that all inputs are of the same size
-  JIT_ASSERT(inputs[0].numel() <= std::numeric_limits<uint32_t>::max());
-  uint32_t numel = inputs[0].numel();
-  at::IntList map_size = inputs[0].sizes();
+  std::vector<int64_t> map_size = mapSize(expand_sizes, inputs);
+  int64_t map_numel = 1;
+  for(auto size : map_size)
+    map_numel *= size;
+  JIT_ASSERT(map_numel <= std::numeric_limits<uint32_t>::max());
+  uint32_t numel = map_numel;
+  // reductions are over the innermost dimension
+  uint32_t row_size = map_size.empty() ? 1 : map_size.back();
   // Compute the storage needed to store TensorInfo structs for inputs and outputs.
   size_t uncompressedDim = input_desc.at(0).contiguity.size();
   size_t maxPossibleTensorInfoSize = sizeof(TensorInfo) + 2 * sizeof(uint32_t) * uncompressedDim;
   size_t maxPossibleBufferSize = maxPossibleTensorInfoSize * (inputs.size() + flat_outputs_size);
   std::vector<char> buffer(maxPossibleBufferSize);
   char * buffer_next = buffer.data();
-  // A vector of arguments to the kernel. It's (numel, *input_descs, *output_descs)
+  // A vector of arguments to the kernel. It's (numel, row_size, *input_descs, *output_descs)
   std::vector<void*> arguments;
-  arguments.reserve(1 + inputs.size() + flat_outputs_size);
+  arguments.reserve(2 + inputs.size() + flat_outputs_size);
   // Asserts that t's dims can be compressed in the same way as in desc
   // (that's what the kernel assumes), and appends it to the arguments vector.
   auto addTensorInfo = [&](TensorDesc & desc, const at::Tensor & t) {
@@ -443,8 +725,9 @@ void CompiledFusionFunction::launch_with_tensors(at::ArrayRef<at::Tensor> inputs
     arguments.push_back(ti);
   };
   arguments.push_back(&numel);
+  arguments.push_back(&row_size);
   for (std::size_t i = 0; i < input_desc.size(); ++i)
-    addTensorInfo(input_desc[i], inputs[i]);
+    addTensorInfo(input_desc[i], inputs[i].expand(map_size));
   for (std::size_t i = 0; i < output_desc.size(); ++i) {
     auto & c = concat_desc[i];
     at::Tensor o = outputs[i];
@@ -480,6 +763,111 @@ void CompiledFusionFunction::launch(at::ArrayRef<at::Tensor> inputs, std::vector
   launch_with_tensors(inputs, outputs);
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// Disk cache
+//
+// Compiled kernels (PTX for CUDA, shared objects for CPU) are stored in
+// FusionCompilerConfig::cache_dir so that restarted processes don't have to
+// compile them again. Entries are named after a hash of their key, which
+// contains the generated source and everything else the binary depends on
+// (device architecture, toolkit and compiler versions, flags). The full key
+// is stored in the entry as well and compared when loading, so a hash
+// collision is a cache miss rather than a wrong kernel.
+
+static const std::string cache_magic = "pytorch-fusion-cache 1\n";
+
+// 64-bit FNV-1a, in hex; stable across processes and builds, unlike std::hash
+static std::string hashString(const std::string & str) {
+  uint64_t hash = 14695981039346656037ULL;
+  for (unsigned char c : str) {
+    hash ^= c;
+    hash *= 1099511628211ULL;
+  }
+  std::stringstream result;
+  result << std::hex << std::setw(16) << std::setfill('0') << hash;
+  return result.str();
+}
+
+struct DiskCache {
+  explicit DiskCache(const std::string & dir)
+  : dir(dir) {}
+
+  bool enabled() const {
+    return !dir.empty();
+  }
+
+  bool load(const std::string & key, std::string & payload) const {
+    if (!enabled())
+      return false;
+    std::ifstream in(path(key), std::ios::binary);
+    if (!in)
+      return false;
+    std::stringstream contents;
+    contents << in.rdbuf();
+    const std::string data = contents.str();
+    // magic, key size, '\n', key, payload
+    if (data.compare(0, cache_magic.size(), cache_magic) != 0)
+      return false;
+    size_t pos = cache_magic.size();
+    size_t newline = data.find('\n', pos);
+    if (newline == std::string::npos)
+      return false;
+    size_t key_size = std::strtoull(data.c_str() + pos, nullptr, 10);
+    pos = newline + 1;
+    if (data.size() < pos + key_size || data.compare(pos, key_size, key) != 0)
+      return false;
+    payload = data.substr(pos + key_size);
+    return true;
+  }
+
+  // Failures are ignored, the cache is only an optimization.
+  void store(const std::string & key, const std::string & payload) const {
+    if (!enabled() || !makeDirectories(dir))
+      return;
+    // write to a temporary file and rename it, so that concurrent processes
+    // and threads never see a partial entry
+    std::string final_path = path(key);
+    std::string tmp_path = final_path + ".tmp" + std::to_string(getpid()) + "." +
+        std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id()));
+    {
+      std::ofstream out(tmp_path, std::ios::binary);
+      if (!out)
+        return;
+      out << cache_magic << key.size() << "\n" << key << payload;
+      if (!out) {
+        unlink(tmp_path.c_str());
+        return;
+      }
+    }
+    if (rename(tmp_path.c_str(), final_path.c_str()) != 0)
+      unlink(tmp_path.c_str());
+  }
+
+private:
+  std::string path(const std::string & key) const {
+    return dir + "/" + hashString(key);
+  }
+
+  static bool makeDirectories(const std::string & dir) {
+    for (size_t pos = dir.find('/', 1); ; pos = dir.find('/', pos + 1)) {
+      std::string prefix = dir.substr(0, pos);
+      if (mkdir(prefix.c_str(), 0755) != 0 && errno != EEXIST)
+        return false;
+      if (pos == std::string::npos)
+        return true;
+    }
+  }
+
+  std::string dir;
+};
+
+static std::string readFile(const std::string & path) {
+  std::ifstream in(path, std::ios::binary);
+  std::stringstream contents;
+  contents << in.rdbuf();
+  return contents.str();
+}
+
 #ifdef WITH_CUDA
 
 void checkCUDAVersion(const cudaDeviceProp & prop) {
@@ -494,7 +882,7 @@ void checkCUDAVersion(const cudaDeviceProp & prop) {
 }
 
 struct CUDAFusionFunction : public CompiledFusionFunction {
-  CUDAFusionFunction(const std::string & name, AnnotatedGraph & agraph)
+  CUDAFusionFunction(const std::string & name, AnnotatedGraph & agraph, const FusionCompilerConfig & config)
   : CompiledFusionFunction(name, agraph) {
     AutoGPU gpu_guard(agraph.device);
 
@@ -504,10 +892,34 @@ struct CUDAFusionFunction : public CompiledFusionFunction {
     std::stringstream cu;
     concat_desc = codegen::emitCompilationUnit(cu, name, agraph, true);
     compilation_unit = cu.str();
+
+    std::string compute = "--gpu-architecture=compute_" + std::to_string(prop.major) + std::to_string(prop.minor);
+    int nvrtc_major, nvrtc_minor;
+    TORCH_NVRTC_CHECK(nvrtcVersion(&nvrtc_major, &nvrtc_minor));
+    std::stringstream key;
+    key << "cuda " << compute << " cuda " << CUDA_VERSION
+        << " nvrtc " << nvrtc_major << "." << nvrtc_minor << "\n" << compilation_unit;
+    DiskCache disk_cache(config.cache_dir);
+    std::string cached_ptx;
+    if (disk_cache.load(key.str(), cached_ptx)) {
+      ptx.assign(cached_ptx.begin(), cached_ptx.end());
+    } else {
+      compile(compute);
+      disk_cache.store(key.str(), std::string(ptx.begin(), ptx.end()));
+    }
+
+    TORCH_CU_CHECK(cuModuleLoadData(&module, ptx.data()));
+    TORCH_CU_CHECK(cuModuleGetFunction(&function, module, name.c_str()));
+
+    TORCH_CU_CHECK(cuOccupancyMaxActiveBlocksPerMultiprocessor(
+      &maxBlocks, function, 128, 0));
+    maxBlocks *= prop.multiProcessorCount;
+  }
+  // Compiles compilation_unit to ptx
+  void compile(const std::string & compute) {
     nvrtcProgram program;
     TORCH_NVRTC_CHECK(nvrtcCreateProgram(&program, compilation_unit.c_str(), NULL, 0, nullptr, nullptr));
 
-    std::string compute = "--gpu-architecture=compute_" + std::to_string(prop.major) + std::to_string(prop.minor);
     std::vector<const char *> args = {"--std=c++11", compute.c_str()};
     nvrtcResult result = nvrtcCompileProgram(program, args.size(), args.data());
     if (result == NVRTC_ERROR_COMPILATION) {
@@ -515,8 +927,7 @@ struct CUDAFusionFunction : public CompiledFusionFunction {
       nvrtcGetProgramLogSize(program, &logsize);
       std::vector<char> log(logsize);
       nvrtcGetProgramLog(program, log.data());
-      cu << log.data();
-      throw std::runtime_error(cu.str());
+      throw std::runtime_error(compilation_unit + log.data());
     }
     ResourceGuard holdProgram([&] {
       TORCH_NVRTC_CHECK(nvrtcDestroyProgram(&program));
@@ -527,13 +938,6 @@ struct CUDAFusionFunction : public CompiledFusionFunction {
     TORCH_NVRTC_CHECK(nvrtcGetPTXSize(program, &ptx_size));
     ptx.resize(ptx_size);
     TORCH_NVRTC_CHECK(nvrtcGetPTX(program, ptx.data()));
-
-    TORCH_CU_CHECK(cuModuleLoadData(&module, ptx.data()));
-    TORCH_CU_CHECK(cuModuleGetFunction(&function, module, name.c_str()));
-
-    TORCH_CU_CHECK(cuOccupancyMaxActiveBlocksPerMultiprocessor(
-      &maxBlocks, function, 128, 0));
-    maxBlocks *= prop.multiProcessorCount;
   }
   virtual ~CUDAFusionFunction() override {
     TORCH_CU_CHECK(cuModuleUnload(module));
@@ -546,6 +950,15 @@ protected:
      int numBlocks = std::min(maxBlocks, ceilDiv(numel, blockSize));
      //std::cout << "maxBlocks = " << maxBlocks << " needed blocks: " << ceilDiv(numel,blockSize)
      //          << " numblocks =  " << numBlocks;
+     unsigned int sharedMem = 0;
+     if (has_reductions) {
+       // one block per row, see cuda_reduction_compilation_unit_template
+       uint32_t rowSize = *static_cast<uint32_t*>(arguments[1]);
+       numBlocks = std::min<int64_t>(maxBlocks, rowSize == 0 ? 0 : numel / rowSize);
+       sharedMem = blockSize * sizeof(float);
+     }
+     if (numBlocks == 0)
+       return;
 
      // it is possible that this is the first cuda call on this thread
      // so make sure we initialize the Driver API's context
@@ -556,7 +969,7 @@ protected:
        function,
        numBlocks, 1, 1,
        blockSize, 1, 1,
-       0, nullptr,
+       sharedMem, nullptr,
        arguments,
        nullptr));
   }
@@ -656,13 +1069,17 @@ static const std::string compile_string =
 #endif
   "-std=c++11 -fPIC ${fopenmp} -shared \"${cpp_file}\" -o \"${so_file}\"";
 
-static void runCompiler(FusionCompilerConfig & config, const std::string & cpp_file, const std::string & so_file) {
+static std::string compileCommand(const FusionCompilerConfig & config, const std::string & cpp_file, const std::string & so_file) {
   TemplateEnv env;
   env.s("cxx", config.cxx);
   env.s("fopenmp", config.openmp ? "-fopenmp" : "");
   env.s("cpp_file",cpp_file);
   env.s("so_file",so_file);
-  std::string result = format(compile_string,env);
+  return format(compile_string,env);
+}
+
+static void runCompiler(FusionCompilerConfig & config, const std::string & cpp_file, const std::string & so_file) {
+  std::string result = compileCommand(config, cpp_file, so_file);
   int r = system(result.c_str());
   if(config.openmp && r != 0) {
     std::cerr << "warning: pytorch jit fuser failed to compile with openmp, trying without it...\n";
@@ -673,6 +1090,22 @@ static void runCompiler(FusionCompilerConfig & config, const std::string & cpp_f
 }
 
 
+// Identifies the host CPU for the disk cache, since kernels are compiled
+// with -march=native.
+static std::string cpuModel() {
+  std::string model;
+  std::ifstream cpuinfo("/proc/cpuinfo");
+  std::string line;
+  while (std::getline(cpuinfo, line)) {
+    if (line.compare(0, 10, "model name") == 0 || line.compare(0, 5, "flags") == 0) {
+      model += line + "\n";
+    }
+    if (line.empty())
+      break; // only look at the first processor
+  }
+  return model;
+}
+
 static const std::string disas_string =
   "objdump -M  intel -d \"${so_file}\"";
 static void disas(const std::string & so_file) {
@@ -692,9 +1125,22 @@ struct CPUFusionFunction : public CompiledFusionFunction {
     std::stringstream cu;
     concat_desc = codegen::emitCompilationUnit(cu, name, agraph, false);
     compilation_unit = cu.str();
-    cpp_file.write(compilation_unit);
-    cpp_file.sync();
-    runCompiler(config, cpp_file.name(), so_file.name());
+
+    // -march=native makes the binary specific to this CPU, and the compiler
+    // (and its version) is part of the compile command
+    std::string key = cpuModel() + config.cxx_version + "\n"
+        + compileCommand(config, "", "") + "\n" + compilation_unit;
+    DiskCache disk_cache(config.cache_dir);
+    std::string cached_so;
+    if (disk_cache.load(key, cached_so)) {
+      so_file.write(cached_so);
+      so_file.sync();
+    } else {
+      cpp_file.write(compilation_unit);
+      cpp_file.sync();
+      runCompiler(config, cpp_file.name(), so_file.name());
+      disk_cache.store(key, readFile(so_file.name()));
+    }
     if(config.debug) {
       std::cout << compilation_unit << "\n";
       disas(so_file.name());
@@ -715,6 +1161,449 @@ protected:
   void (*kernel)(uint32_t, void**) = nullptr;
 };
 
+////////////////////////////////////////////////////////////////////////////////
+// CPU interpreter
+//
+// Runs CPU fusion groups without generating any code, so that they work on
+// hosts without a C++ compiler and don't pay hundreds of milliseconds of
+// compilation per group. The subgraph is translated once into a list of
+// instructions over registers that each hold a block of kBlockSize elements.
+// launch_raw then evaluates the whole program on one block at a time: the
+// per-instruction loops are simple enough for the compiler to vectorize and
+// the registers of a block stay in cache.
+
+namespace interp {
+
+enum class OpCode {
+  Abs, Sigmoid, Log, Log10, Log1p, Log2, Lgamma, Exp, Expm1, Cos, Acos, Cosh,
+  Sin, Asin, Sinh, Tan, Atan, Tanh, Sqrt, Rsqrt, Ceil, Floor, Round, Trunc,
+  Frac, Reciprocal, Neg,
+  Atan2, Min, Max, And, Or, Div, Eq, Fmod, Ge, Gt, Le, Lt, Mul, Ne, Remainder,
+  Pow, Add, Sub, Lerp, Clamp, SigmoidBackward, TanhBackward,
+};
+
+// dst = op(a, b); scalar operands are loaded into constant registers.
+struct Instruction {
+  OpCode op;
+  int dst;
+  int a;
+  int b;
+  float alpha; // add, sub: multiplier of b; lerp: weight
+  float lo, hi; // clamp bounds
+};
+
+static const std::unordered_map<NodeKind, OpCode> & opcodes() {
+  static std::unordered_map<NodeKind, OpCode> map = {
+    {aten::abs, OpCode::Abs},
+    {aten::sigmoid, OpCode::Sigmoid},
+    {aten::log, OpCode::Log},
+    {aten::log10, OpCode::Log10},
+    {aten::log1p, OpCode::Log1p},
+    {aten::log2, OpCode::Log2},
+    {aten::lgamma, OpCode::Lgamma},
+    {aten::exp, OpCode::Exp},
+    {aten::expm1, OpCode::Expm1},
+    {aten::cos, OpCode::Cos},
+    {aten::acos, OpCode::Acos},
+    {aten::cosh, OpCode::Cosh},
+    {aten::sin, OpCode::Sin},
+    {aten::asin, OpCode::Asin},
+    {aten::sinh, OpCode::Sinh},
+    {aten::tan, OpCode::Tan},
+    {aten::atan, OpCode::Atan},
+    {aten::tanh, OpCode::Tanh},
+    {aten::sqrt, OpCode::Sqrt},
+    {aten::rsqrt, OpCode::Rsqrt},
+    {aten::ceil, OpCode::Ceil},
+    {aten::floor, OpCode::Floor},
+    {aten::round, OpCode::Round},
+    {aten::trunc, OpCode::Trunc},
+    {aten::frac, OpCode::Frac},
+    {aten::reciprocal, OpCode::Reciprocal},
+    {aten::neg, OpCode::Neg},
+    {aten::atan2, OpCode::Atan2},
+    {aten::min, OpCode::Min},
+    {aten::max, OpCode::Max},
+    {aten::__and__, OpCode::And},
+    {aten::__or__, OpCode::Or},
+    {aten::div, OpCode::Div},
+    {aten::eq, OpCode::Eq},
+    {aten::fmod, OpCode::Fmod},
+    {aten::ge, OpCode::Ge},
+    {aten::gt, OpCode::Gt},
+    {aten::le, OpCode::Le},
+    {aten::lt, OpCode::Lt},
+    {aten::mul, OpCode::Mul},
+    {aten::ne, OpCode::Ne},
+    {aten::remainder, OpCode::Remainder},
+    {aten::pow, OpCode::Pow},
+    {aten::add, OpCode::Add},
+    {aten::sub, OpCode::Sub},
+    {aten::lerp, OpCode::Lerp},
+    {aten::clamp, OpCode::Clamp},
+    {aten::_sigmoid_backward, OpCode::SigmoidBackward},
+    {aten::_tanh_backward, OpCode::TanhBackward},
+  };
+  return map;
+}
+
+static float scalarAttr(Node * n, Symbol name, float def) {
+  return n->hasAttribute(name) ? at::Scalar(n->t(name)).toFloat() : def;
+}
+
+#define UNARY_LOOP(expr)                    \
+  for (int64_t i = 0; i < n; i++) {         \
+    float x = a[i];                         \
+    out[i] = (expr);                        \
+  }                                         \
+  break;
+#define BINARY_LOOP(expr)                   \
+  for (int64_t i = 0; i < n; i++) {         \
+    float x = a[i], y = b[i];               \
+    out[i] = (expr);                        \
+  }                                         \
+  break;
+
+static void run(const Instruction & inst, float * regs, int64_t n, int64_t block_size) {
+  float * out = regs + inst.dst * block_size;
+  const float * a = regs + inst.a * block_size;
+  const float * b = regs + (inst.b >= 0 ? inst.b : inst.a) * block_size;
+  const float alpha = inst.alpha, lo = inst.lo, hi = inst.hi;
+  switch (inst.op) {
+    case OpCode::Abs: UNARY_LOOP(std::abs(x))
+    case OpCode::Sigmoid: UNARY_LOOP(1.f / (1.f + std::exp(-x)))
+    case OpCode::Log: UNARY_LOOP(std::log(x))
+    case OpCode::Log10: UNARY_LOOP(std::log10(x))
+    case OpCode::Log1p: UNARY_LOOP(std::log1p(x))
+    case OpCode::Log2: UNARY_LOOP(std::log2(x))
+    case OpCode::Lgamma: UNARY_LOOP(std::lgamma(x))
+    case OpCode::Exp: UNARY_LOOP(std::exp(x))
+    case OpCode::Expm1: UNARY_LOOP(std::expm1(x))
+    case OpCode::Cos: UNARY_LOOP(std::cos(x))
+    case OpCode::Acos: UNARY_LOOP(std::acos(x))
+    case OpCode::Cosh: UNARY_LOOP(std::cosh(x))
+    case OpCode::Sin: UNARY_LOOP(std::sin(x))
+    case OpCode::Asin: UNARY_LOOP(std::asin(x))
+    case OpCode::Sinh: UNARY_LOOP(std::sinh(x))
+    case OpCode::Tan: UNARY_LOOP(std::tan(x))
+    case OpCode::Atan: UNARY_LOOP(std::atan(x))
+    case OpCode::Tanh: UNARY_LOOP(std::tanh(x))
+    case OpCode::Sqrt: UNARY_LOOP(std::sqrt(x))
+    case OpCode::Rsqrt: UNARY_LOOP(1.f / std::sqrt(x))
+    case OpCode::Ceil: UNARY_LOOP(std::ceil(x))
+    case OpCode::Floor: UNARY_LOOP(std::floor(x))
+    case OpCode::Round: UNARY_LOOP(std::round(x))
+    case OpCode::Trunc: UNARY_LOOP(std::trunc(x))
+    case OpCode::Frac: UNARY_LOOP(x - std::trunc(x))
+    case OpCode::Reciprocal: UNARY_LOOP(1.f / x)
+    case OpCode::Neg: UNARY_LOOP(-x)
+    case OpCode::Clamp: UNARY_LOOP(std::min(std::max(x, lo), hi))
+    case OpCode::Atan2: BINARY_LOOP(std::atan2(x, y))
+    case OpCode::Min: BINARY_LOOP(std::fmin(x, y))
+    case OpCode::Max: BINARY_LOOP(std::fmax(x, y))
+    case OpCode::And: BINARY_LOOP(x && y)
+    case OpCode::Or: BINARY_LOOP(x || y)
+    case OpCode::Div: BINARY_LOOP(x / y)
+    case OpCode::Eq: BINARY_LOOP(x == y)
+    case OpCode::Fmod: BINARY_LOOP(std::fmod(x, y))
+    case OpCode::Ge: BINARY_LOOP(x >= y)
+    case OpCode::Gt: BINARY_LOOP(x > y)
+    case OpCode::Le: BINARY_LOOP(x <= y)
+    case OpCode::Lt: BINARY_LOOP(x < y)
+    case OpCode::Mul: BINARY_LOOP(x * y)
+    case OpCode::Ne: BINARY_LOOP(x != y)
+    case OpCode::Remainder: BINARY_LOOP(x - y * std::floor(x / y))
+    case OpCode::Pow: BINARY_LOOP(std::pow(x, y))
+    case OpCode::Add: BINARY_LOOP(x + alpha * y)
+    case OpCode::Sub: BINARY_LOOP(x - alpha * y)
+    case OpCode::Lerp: BINARY_LOOP(x + alpha * (y - x))
+    case OpCode::SigmoidBackward: BINARY_LOOP(x * y * (1.f - y))
+    case OpCode::TanhBackward: BINARY_LOOP(x * (1.f - y * y))
+  }
+}
+
+#undef UNARY_LOOP
+#undef BINARY_LOOP
+
+// Offset of element linear_index in a tensor with compressed sizes and
+// strides, as computed by emitIndexingFor for the generated kernels.
+static inline uint32_t elementOffset(uint32_t linear_index, const uint32_t * sizes,
+                                     const uint32_t * strides, size_t nDim) {
+  uint32_t offset = 0;
+  for (size_t d = nDim; d-- > 0;) {
+    offset += (linear_index % sizes[d]) * strides[d];
+    linear_index /= sizes[d];
+  }
+  return offset;
+}
+
+} // namespace interp
+
+struct CPUInterpretedFusionFunction : public CompiledFusionFunction {
+  CPUInterpretedFusionFunction(const std::string & name, AnnotatedGraph & agraph, bool debug)
+  : CompiledFusionFunction(name, agraph) {
+    Graph & subgraph = *agraph.graph;
+    std::unordered_map<Value*, int> registers;
+    auto reg = [&](Value * v) {
+      auto it = registers.find(v);
+      JIT_ASSERT(it != registers.end());
+      return it->second;
+    };
+    auto newConstant = [&](float value) {
+      constants.emplace_back(num_registers, value);
+      return num_registers++;
+    };
+    auto newInstruction = [&](interp::OpCode op, int a, int b) {
+      interp::Instruction inst;
+      inst.op = op;
+      inst.a = a;
+      inst.b = b;
+      inst.alpha = 1;
+      inst.lo = -std::numeric_limits<float>::infinity();
+      inst.hi = std::numeric_limits<float>::infinity();
+      inst.dst = num_registers++;
+      return inst;
+    };
+
+    // the same argument order as emitCompilationUnit: inputs, then outputs
+    // with concatenated outputs expanded into their subtensors
+    for (size_t i = 0; i < subgraph.inputs().size(); i++) {
+      registers[subgraph.inputs()[i]] = num_registers++;
+      args.push_back({true, registers.at(subgraph.inputs()[i]), agraph.input_desc[i].nDim()});
+    }
+
+    // Registers are assigned in a single sweep over the graph, so that nodes
+    // evaluated by several passes (see ReductionPlan) use the same ones.
+    // Results of reductions get a register of their own, filled with the
+    // value for the current row before the passes that read it.
+    std::unordered_map<Node*, std::vector<interp::Instruction>> node_instructions;
+    std::unordered_map<Node*, std::pair<int, int>> row_registers; // (maximum, sum)
+    std::stringstream program;
+    for (auto n : subgraph.nodes()) {
+      if (n->kind() == aten::cat)
+        continue; // outputs are narrowed before launch, see launch_with_tensors
+      if (n->kind() == aten::expand) {
+        registers[n->output()] = reg(n->input()); // broadcasts are implicit
+        continue;
+      }
+      if (isReduction(n)) {
+        registers[n->output()] = num_registers++;
+        program << "r" << reg(n->output()) << " = " << n->kind().toQualString()
+                << "(r" << reg(n->input()) << ")\n";
+        continue;
+      }
+      auto & insts = node_instructions[n];
+      if (isSoftmax(n)) {
+        // softmax(x) = exp(x - max) / sum, log_softmax(x) = x - max - log(sum)
+        int max_reg = num_registers++;
+        int sum_reg = num_registers++;
+        row_registers[n] = {max_reg, sum_reg};
+        insts.push_back(newInstruction(interp::OpCode::Sub, reg(n->input()), max_reg));
+        if (n->kind() == aten::softmax) {
+          insts.push_back(newInstruction(interp::OpCode::Exp, insts.back().dst, -1));
+          insts.push_back(newInstruction(interp::OpCode::Div, insts.back().dst, sum_reg));
+        } else {
+          insts.push_back(newInstruction(interp::OpCode::Sub, insts.back().dst, sum_reg));
+        }
+        registers[n->output()] = insts.back().dst;
+        program << "r" << insts.back().dst << " = " << n->kind().toQualString()
+                << "(r" << reg(n->input()) << ")\n";
+        continue;
+      }
+      auto it = interp::opcodes().find(n->kind());
+      if (it == interp::opcodes().end()) {
+        throw std::runtime_error(std::string("CPU fusion interpreter: unsupported operator ") +
+                                 n->kind().toQualString());
+      }
+      interp::Instruction inst;
+      inst.op = it->second;
+      inst.a = reg(n->inputs().at(0));
+      // binary ops with a constant operand keep it in attr::other (or
+      // attr::exponent for pow), like in encodeRHS
+      if (n->inputs().size() > 1) {
+        inst.b = reg(n->inputs()[1]);
+      } else if (n->hasAttribute(attr::other)) {
+        inst.b = newConstant(interp::scalarAttr(n, attr::other, 0));
+      } else if (n->hasAttribute(attr::exponent)) {
+        inst.b = newConstant(interp::scalarAttr(n, attr::exponent, 0));
+      } else {
+        inst.b = -1;
+      }
+      inst.alpha = interp::scalarAttr(n, inst.op == interp::OpCode::Lerp ? attr::weight : attr::alpha, 1);
+      inst.lo = interp::scalarAttr(n, attr::min, -std::numeric_limits<float>::infinity());
+      inst.hi = interp::scalarAttr(n, attr::max, std::numeric_limits<float>::infinity());
+      inst.dst = registers[n->output()] = num_registers++;
+      program << "r" << inst.dst << " = " << n->kind().toQualString() << "(r" << inst.a;
+      if (inst.b >= 0)
+        program << ", r" << inst.b;
+      program << ")\n";
+      insts.push_back(inst);
+    }
+    for (size_t i = 0; i < subgraph.outputs().size(); i++) {
+      auto o = subgraph.outputs()[i];
+      auto & desc = agraph.output_desc[i];
+      if (o->node()->kind() != aten::cat) {
+        concat_desc.emplace_back();
+        args.push_back({false, reg(o), desc.nDim()});
+      } else {
+        auto cat = o->node();
+        concat_desc.emplace_back(desc, cat->inputs().size(), cat->i(attr::dim));
+        for (auto c : cat->inputs()) {
+          args.push_back({false, reg(c), concat_desc.back().subtensorDesc->nDim()});
+        }
+      }
+    }
+
+    // inputs read by nodes (or listed in values), and the instructions of nodes
+    auto makePass = [&](const std::vector<Node*> & nodes, at::ArrayRef<Value*> values) {
+      Pass pass;
+      std::unordered_set<int> used;
+      for (auto v : values)
+        used.insert(reg(v));
+      for (auto n : nodes) {
+        for (auto & inst : node_instructions[n]) {
+          used.insert(inst.a);
+          used.insert(inst.b);
+          pass.instructions.push_back(inst);
+        }
+      }
+      for (size_t i = 0; i < subgraph.inputs().size(); i++) {
+        if (used.count(args[i].reg) > 0)
+          pass.inputs.push_back(i);
+      }
+      return pass;
+    };
+    ReductionPlan plan = planReductions(subgraph);
+    for (auto & reduce : plan.passes) {
+      Node * n = reduce.node;
+      Pass pass = makePass(reduce.nodes, n->inputs());
+      pass.operand = reg(n->input());
+      pass.is_max = reduce.kind == ReduceKind::Max;
+      pass.finish = Pass::Finish::None;
+      switch (reduce.kind) {
+        case ReduceKind::Sum:
+          pass.result = reg(n->output());
+          if (n->kind() == aten::mean)
+            pass.finish = Pass::Finish::Mean;
+          break;
+        case ReduceKind::Max:
+          pass.result = row_registers.at(n).first;
+          break;
+        case ReduceKind::SumExp:
+          pass.instructions.push_back(newInstruction(interp::OpCode::Sub, pass.operand, row_registers.at(n).first));
+          pass.instructions.push_back(newInstruction(interp::OpCode::Exp, pass.instructions.back().dst, -1));
+          pass.operand = pass.instructions.back().dst;
+          pass.result = row_registers.at(n).second;
+          if (n->kind() == aten::log_softmax)
+            pass.finish = Pass::Finish::Log;
+          break;
+      }
+      passes.push_back(std::move(pass));
+    }
+    auto outputs = flatOutputs(subgraph);
+    passes.push_back(makePass(plan.output_nodes, outputs));
+
+    compilation_unit = program.str();
+    if (debug) {
+      std::cout << name << ":\n" << compilation_unit << "\n";
+    }
+  }
+protected:
+  virtual at::Backend backend() const override {
+    return at::kCPU;
+  }
+  virtual void launch_raw(uint32_t numel, void ** arguments) override {
+    std::vector<float> regs(num_registers * kBlockSize);
+    for (auto & c : constants) {
+      std::fill_n(regs.begin() + c.first * kBlockSize, kBlockSize, c.second);
+    }
+    // without reductions the whole map is a single row
+    int64_t row_size = has_reductions ? *static_cast<uint32_t*>(arguments[1]) : numel;
+    if (row_size == 0)
+      return;
+    for (int64_t row = 0; row < numel; row += row_size) {
+      for (auto & pass : passes) {
+        float acc = pass.is_max ? -std::numeric_limits<float>::infinity() : 0.f;
+        for (int64_t begin = row; begin < row + row_size; begin += kBlockSize) {
+          int64_t n = std::min<int64_t>(kBlockSize, row + row_size - begin);
+          for (auto i : pass.inputs) {
+            transfer(args[i], static_cast<TensorInfo*>(arguments[i + 2]), regs.data(), begin, n);
+          }
+          for (auto & inst : pass.instructions) {
+            interp::run(inst, regs.data(), n, kBlockSize);
+          }
+          if (pass.operand >= 0) {
+            const float * r = regs.data() + pass.operand * kBlockSize;
+            for (int64_t i = 0; i < n; i++)
+              acc = pass.is_max ? std::max(acc, r[i]) : acc + r[i];
+            continue;
+          }
+          for (size_t i = 0; i < args.size(); i++) {
+            if (!args[i].is_input) {
+              transfer(args[i], static_cast<TensorInfo*>(arguments[i + 2]), regs.data(), begin, n);
+            }
+          }
+        }
+        if (pass.operand >= 0) {
+          if (pass.finish == Pass::Finish::Mean)
+            acc /= row_size;
+          else if (pass.finish == Pass::Finish::Log)
+            acc = std::log(acc);
+          std::fill_n(regs.begin() + pass.result * kBlockSize, std::min<int64_t>(kBlockSize, row_size), acc);
+        }
+      }
+    }
+  }
+private:
+  struct Arg {
+    bool is_input;
+    int reg;
+    size_t nDim; // compressed, see TensorDesc
+  };
+  // One pass over a row of the map, see ReductionPlan. Passes that compute a
+  // reduction fold register operand into a scalar and fill register result
+  // with it; the final pass writes the outputs instead.
+  struct Pass {
+    enum class Finish { None, Mean, Log };
+    std::vector<size_t> inputs; // into args
+    std::vector<interp::Instruction> instructions;
+    int operand = -1;
+    bool is_max = false;
+    int result = -1;
+    Finish finish = Finish::None;
+  };
+  // Copies elements [begin, begin + n) of a tensor into its register (for
+  // inputs) or back (for outputs).
+  static void transfer(const Arg & arg, TensorInfo * ti, float * regs, int64_t begin, int64_t n) {
+    float * data = static_cast<float*>(ti->data);
+    float * r = regs + arg.reg * kBlockSize;
+    const uint32_t * sizes = ti->sizes(arg.nDim);
+    const uint32_t * strides = ti->strides(arg.nDim);
+    if (arg.nDim == 1 && strides[0] == 1) {
+      if (arg.is_input)
+        std::copy(data + begin, data + begin + n, r);
+      else
+        std::copy(r, r + n, data + begin);
+      return;
+    }
+    for (int64_t i = 0; i < n; i++) {
+      float & elem = data[interp::elementOffset(begin + i, sizes, strides, arg.nDim)];
+      if (arg.is_input)
+        r[i] = elem;
+      else
+        elem = r[i];
+    }
+  }
+
+  static constexpr int64_t kBlockSize = 256;
+  std::vector<Arg> args;
+  std::vector<Pass> passes;
+  std::vector<std::pair<int, float>> constants; // (register, value)
+  int num_registers = 0;
+};
+
+constexpr int64_t CPUInterpretedFusionFunction::kBlockSize;
+
 std::shared_ptr<CompiledFusionFunction> FusionCompiler::getOrCompile(AnnotatedGraph & agraph) {
   std::stringstream key;
   key << *agraph.graph << "\n";
@@ -725,31 +1614,55 @@ std::shared_ptr<CompiledFusionFunction> FusionCompiler::getOrCompile(AnnotatedGr
     key << i << "\n";
   std::string key_ = key.str();
 
-  auto it = cache.find(key_);
-  if (it == cache.end()) {
-    std::string name = "kernel_" + std::to_string(cache.size());
-    CompiledFusionFunction * raw_func;
-    if(agraph.device != kCPUDevice) {
+  {
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    auto it = cache.find(key_);
+    if (it != cache.end())
+      return it->second;
+  }
+  // compiled without the lock, so that executors compiling plans on other
+  // threads (see precompileInBackground) compile their kernels in parallel
+  std::string name = "kernel_" + std::to_string(next_kernel_id++);
+  CompiledFusionFunction * raw_func;
+  if(agraph.device != kCPUDevice) {
 #ifdef WITH_CUDA
-      raw_func = new CUDAFusionFunction(name, agraph);
+    raw_func = new CUDAFusionFunction(name, agraph, config_);
 #else
-      throw std::runtime_error("cannot compile a CUDA fusion group, CUDA is not enabled.");
+    throw std::runtime_error("cannot compile a CUDA fusion group, CUDA is not enabled.");
 #endif
-    } else {
-      JIT_ASSERT(canCompileOnCPU());
-      raw_func = new CPUFusionFunction(name, agraph, config_);
-    }
-    it = cache.emplace(key_, std::shared_ptr<CompiledFusionFunction>(raw_func)).first;
+  } else if (config_.cpu_interpreter) {
+    raw_func = new CPUInterpretedFusionFunction(name, agraph, config_.debug);
+  } else {
+    raw_func = new CPUFusionFunction(name, agraph, config_);
   }
-  return it->second;
+  std::shared_ptr<CompiledFusionFunction> func(raw_func);
+  std::lock_guard<std::mutex> lock(cache_mutex);
+  // if another thread compiled the same kernel meanwhile, its function is kept
+  return cache.emplace(key_, std::move(func)).first->second;
+}
+
+// Describes a tensor of type t once it's expanded to map_size.
+static TensorDesc expandedDesc(TensorType * t, at::IntList map_size) {
+  auto & sizes = t->sizes();
+  auto & strides = t->strides();
+  JIT_ASSERT(sizes.size() <= map_size.size());
+  size_t offset = map_size.size() - sizes.size();
+  std::vector<int64_t> expanded_strides(map_size.size(), 0);
+  for(size_t i = 0; i < sizes.size(); ++i) {
+    if(sizes[i] == map_size[i + offset])
+      expanded_strides[i + offset] = strides[i];
+  }
+  return TensorDesc(t->scalarType(), map_size, expanded_strides);
 }
 
 std::shared_ptr<CompiledFusionFunction> FusionCompiler::getOrCompile(Node* fusion_group) {
   auto & graph = *fusion_group->g(attr::Subgraph);
   AnnotatedGraph agraph(graph, fusion_group->i(attr::device));
+  // the kernel sees the inputs broadcast to the map, see launch_with_tensors
+  auto map_size = flatOutputs(graph).at(0)->type()->expect<TensorType>()->sizes();
   for(auto & input : graph.inputs()) {
     auto t = input->type()->expect<TensorType>();
-    agraph.input_desc.emplace_back(t);
+    agraph.input_desc.push_back(expandedDesc(t, map_size));
   }
   for(auto & output : graph.outputs()) {
     auto t = output->type()->expect<TensorType>();
@@ -764,8 +1677,9 @@ std::shared_ptr<CompiledFusionFunction> FusionCompiler::getOrCompile(Graph & gra
                                                      at::ArrayRef<at::Tensor> inputs,
                                                      at::ArrayRef<at::Tensor> outputs) {
   AnnotatedGraph agraph(graph, device);
+  auto map_size = mapSize(expandSizes(graph), inputs);
   for(auto & i : inputs) {
-   agraph.input_desc.emplace_back(i);
+   agraph.input_desc.emplace_back(i.expand(map_size));
   }
   for(auto & i : outputs) {
    agraph.output_desc.emplace_back(i);
@@ -788,19 +1702,59 @@ static bool programExists(const std::string & program) {
   return 0 == system(cmd.c_str());
 }
 
-FusionCompiler::FusionCompiler() {
-  const char * cxx_env = getenv("CXX");
-  if(cxx_env != nullptr) {
-    config_.cxx = cxx_env;
+// first line of `cxx --version`, for the disk cache
+static std::string compilerVersion(const std::string & cxx) {
+  std::string cmd = "\"" + cxx + "\" --version 2>/dev/null";
+  FILE * pipe = popen(cmd.c_str(), "r");
+  if (!pipe)
+    return "";
+  char line[256] = {0};
+  if (!fgets(line, sizeof(line), pipe))
+    line[0] = '\0';
+  pclose(pipe);
+  return line;
+}
+
+static std::string defaultCacheDir() {
+  if (const char * xdg = getenv("XDG_CACHE_HOME")) {
+    if (xdg[0])
+      return std::string(xdg) + "/torch/fusion";
+  }
+  if (const char * home = getenv("HOME")) {
+    if (home[0])
+      return std::string(home) + "/.cache/torch/fusion";
   }
-  if(!programExists(config_.cxx)) {
-    config_.cxx = "";
+  return "";
+}
+
+FusionCompiler::FusionCompiler() {
+  // PYTORCH_FUSION_CPU_BACKEND=cxx compiles CPU fusion groups with $CXX (or
+  // g++) instead of interpreting them, falling back to the interpreter if
+  // there is no compiler.
+  const char * backend_env = getenv("PYTORCH_FUSION_CPU_BACKEND");
+  if(backend_env && std::string(backend_env) == "cxx") {
+    config_.cpu_interpreter = false;
+    const char * cxx_env = getenv("CXX");
+    if(cxx_env != nullptr) {
+      config_.cxx = cxx_env;
+    }
+    if(!programExists(config_.cxx)) {
+      std::cerr << "warning: pytorch jit fuser could not find " << config_.cxx
+                << ", using the CPU interpreter instead\n";
+      config_.cxx = "";
+      config_.cpu_interpreter = true;
+    } else {
+      config_.cxx_version = compilerVersion(config_.cxx);
+    }
   }
+  // PYTORCH_FUSION_CACHE_DIR overrides where compiled kernels are kept
+  // across processes; setting it to an empty string disables the cache.
+  const char * cache_env = getenv("PYTORCH_FUSION_CACHE_DIR");
+  config_.cache_dir = cache_env ? cache_env : defaultCacheDir();
   const char * debug_env = getenv("PYTORCH_FUSION_DEBUG");
   config_.debug = debug_env && atoi(debug_env) != 0;
 }
 
-//TODO: thread safety
 FusionCompiler & sharedFusionCompiler() {
   static FusionCompiler compiler;
   return compiler;
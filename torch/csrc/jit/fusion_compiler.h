@@ -4,6 +4,8 @@
 #include "ATen/ATen.h"
 #include <string>
 #include <algorithm>
+#include <atomic>
+#include <mutex>
 #include <unordered_map>
 #include <vector>
 
@@ -100,8 +102,10 @@ protected:
   // The format of arguments is suitable for directly passing to a call to
   // cuLaunchKernel as the kernel arguments.
   // Currently the first argument is a pointer to numel (for passing to
-  // CUDA code), and the remainder are pointers to the TensorInfo<T> structs
-  // that compiled code uses to load Tensor data.
+  // CUDA code), the second one a pointer to the size of the innermost
+  // dimension (over which reductions happen), and the remainder are pointers
+  // to the TensorInfo<T> structs that compiled code uses to load Tensor data.
+  // Inputs are expanded to the size of the outputs before that.
   // launch_with_tensors handles packing at::Tensors into this arguments array.
   // CPU code uses the same convension so that launch_with_tensors can be shared.
   virtual void launch_raw(uint32_t numel, void ** arguments) = 0;
@@ -115,12 +119,26 @@ protected:
   // an output is actually a concatenation of
   // many subtensors that the fusion group produces
   std::vector<ConcatDesc> concat_desc;
+
+  // the group reduces over the innermost dimension, so the kernels
+  // work one row at a time
+  bool has_reductions = false;
+  // sizes of the aten::expand nodes in the group, which determine the size of
+  // the outputs along with those of the inputs
+  std::vector<std::vector<int64_t>> expand_sizes;
 };
 
 struct FusionCompilerConfig {
   std::string cxx = "g++"; // compiler location
   bool debug = false; // emit debugging information about fusions
   bool openmp = true;
+  // run CPU fusion groups with a built-in interpreter instead of compiling
+  // them with cxx, see PYTORCH_FUSION_CPU_BACKEND
+  bool cpu_interpreter = true;
+  std::string cxx_version; // output of `cxx --version`, if cxx is used
+  // directory in which compiled kernels are kept across processes, or empty
+  // to disable the disk cache, see PYTORCH_FUSION_CACHE_DIR
+  std::string cache_dir;
 };
 
 // caching compiler
@@ -144,11 +162,14 @@ struct FusionCompiler {
   // the graph each time
   void debugLaunchGraph(Graph & graph, int device, at::ArrayRef<at::Tensor> inputs, at::ArrayRef<at::Tensor> outputs);
   bool canCompileOnCPU() const {
-    return config_.cxx.size() > 0;
+    return config_.cpu_interpreter || config_.cxx.size() > 0;
   }
 private:
   FusionCompilerConfig config_;
+  // guards cache, but not the compilation of the kernels missing from it
+  std::mutex cache_mutex;
   std::unordered_map<std::string, std::shared_ptr<CompiledFusionFunction>> cache;
+  std::atomic<size_t> next_kernel_id {0};
 };
 
 FusionCompiler & sharedFusionCompiler();
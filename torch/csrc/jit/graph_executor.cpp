@@ -3,15 +3,23 @@
 #include "torch/csrc/autograd/grad_mode.h"
 #include "torch/csrc/jit/argument_spec.h"
 #include "torch/csrc/jit/autodiff.h"
+#include "torch/csrc/jit/captured_launches.h"
 #include "torch/csrc/jit/interpreter.h"
 #include "torch/csrc/jit/ir.h"
 #include "torch/csrc/jit/passes/batch_mm.h"
 #include "torch/csrc/jit/passes/common_subexpression_elimination.h"
+#include "torch/csrc/jit/passes/constant_propagation.h"
 #include "torch/csrc/jit/passes/create_autodiff_subgraphs.h"
+#include "torch/csrc/jit/passes/fold_batch_norm.h"
+#include "torch/csrc/jit/passes/fuse_conv_relu.h"
 #include "torch/csrc/jit/passes/dead_code_elimination.h"
 #include "torch/csrc/jit/passes/graph_fuser.h"
 #include "torch/csrc/jit/passes/inplace_check.h"
+#include "torch/csrc/jit/passes/loop_invariant_code_motion.h"
+#include "torch/csrc/jit/passes/loop_unrolling.h"
 #include "torch/csrc/jit/passes/peephole.h"
+#include "torch/csrc/jit/passes/plan_memory.h"
+#include "torch/csrc/jit/passes/prepack_linear.h"
 #include "torch/csrc/jit/passes/shape_analysis.h"
 #include "torch/csrc/jit/passes/remove_expands.h"
 
@@ -19,9 +27,16 @@
 #include "torch/csrc/autograd/function.h"
 #include "torch/csrc/jit/script/compiler.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <list>
 #include <memory>
 #include <mutex>
+#include <sstream>
+#include <thread>
 #include <unordered_map>
 #include <utility>
 #include <vector>
@@ -34,6 +49,28 @@ using tensor_list = std::vector<at::Tensor>;
 using Variable = autograd::Variable;
 using autograd::variable_list;
 
+size_t envOr(const char * name, size_t default_value) {
+  const char * value = getenv(name);
+  if(!value || !value[0])
+    return default_value;
+  return std::strtoull(value, nullptr, 10);
+}
+
+std::mutex plan_cache_limits_mutex;
+
+PlanCacheLimits & planCacheLimits() {
+  static PlanCacheLimits limits {
+    envOr("PYTORCH_JIT_PLAN_CACHE_SIZE", 64),
+    envOr("PYTORCH_JIT_MAX_SPECIALIZATIONS", 8)
+  };
+  return limits;
+}
+
+std::atomic<bool> & captureLaunches() {
+  static std::atomic<bool> enabled(envOr("PYTORCH_JIT_CAPTURE_LAUNCHES", 0) != 0);
+  return enabled;
+}
+
 // this type is in ExecutionPlan to run its Gradient if it is
 // specified. It has a list of inputs captured by ExecutionPlan that
 // it concats with inputs to form the full set of inputs to graph.
@@ -73,6 +110,9 @@ private:
 struct ExecutionPlan {
   ExecutionPlan(std::shared_ptr<Graph>& graph)
       : f(graph) {}
+  ExecutionPlan(std::shared_ptr<Graph>& graph, std::shared_ptr<CapturedLaunches> launches)
+      : f(graph),
+        launches(std::move(launches)) {}
   ExecutionPlan(std::shared_ptr<Graph>& graph, Gradient grad)
       : f(graph),
         grad(std::move(grad)),
@@ -82,6 +122,9 @@ struct ExecutionPlan {
     if(grad) {
       return runWithGrad(std::move(stack));
     }
+    if(launches && launches->run(stack)) {
+      return stack;
+    }
     InterpreterState(f).runOneStage(stack);
     return stack;
   }
@@ -149,6 +192,8 @@ private:
     return outputs;
   }
   Code f;
+  // replays the kernels of f when it can be captured, see captured_launches.h
+  std::shared_ptr<CapturedLaunches> launches;
   // description of gradient as a graph
   Gradient grad; // if(grad) is false when this is unused
   // executor for df, including code caches
@@ -157,6 +202,24 @@ private:
 
 } // anonymous namespace
 
+PlanCacheLimits getPlanCacheLimits() {
+  std::lock_guard<std::mutex> lock(plan_cache_limits_mutex);
+  return planCacheLimits();
+}
+
+void setPlanCacheLimits(PlanCacheLimits limits) {
+  std::lock_guard<std::mutex> lock(plan_cache_limits_mutex);
+  planCacheLimits() = limits;
+}
+
+bool getCaptureLaunches() {
+  return captureLaunches();
+}
+
+void setCaptureLaunches(bool enabled) {
+  captureLaunches() = enabled;
+}
+
 // a Graph can be created via tracing, or via a language-based frontend
 // GraphExecutor runs it. It can run the same graph on many different sizes
 // and different requires_grad states, and handles specializations for each situation.
@@ -169,7 +232,8 @@ struct GraphExecutorImpl {
   , optimize(optimize)
   , num_inputs(this->graph->inputs().size())
   , symbolically_differentiable(symbolically_differentiable)
-  , may_introduce_gradient(calcMayIntroduceGradient(this->graph->block())) {}
+  , may_introduce_gradient(calcMayIntroduceGradient(this->graph->block()))
+  , reads_sizes(calcReadsSizes(this->graph->block())) {}
   GraphExecutorImpl(std::shared_ptr<Graph> graph, bool optimize)
   : GraphExecutorImpl(graph, optimize, isDifferentiable(*graph)) {}
 
@@ -197,8 +261,8 @@ struct GraphExecutorImpl {
     // either we can symbolically differentiate, or we do not need a gradient.
     // go down the route where we treat the inputs as tensors
     // and fully optimize
-    auto & implementation = getOrCompile(inputs);
-    return implementation.run(std::move(inputs));
+    auto implementation = getOrCompile(inputs);
+    return implementation->run(std::move(inputs));
   }
 
 private:
@@ -271,6 +335,19 @@ private:
     }
     return false;
   }
+  // nodes that bake sizes into the graph (view, expand, ...) make the graph
+  // worth specializing no matter how many shapes it sees
+  static bool calcReadsSizes(Block* b) {
+    for(Node* n : b->nodes()) {
+      if(n->hasAttribute(attr::size) || n->hasAttribute(attr::sizes))
+        return true;
+      for(Block* bb : n->blocks()) {
+        if(calcReadsSizes(bb))
+          return true;
+      }
+    }
+    return false;
+  }
   bool needsGradient(const variable_tensor_list & inputs) {
     if (!autograd::GradMode::is_enabled()) {
       return false;
@@ -288,8 +365,12 @@ private:
     // these optimizations must run in the presence of variables
     // and when shape information is not statically known.
 
+    // the loops go first, so that the passes below see their unrolled bodies
+    HoistLoopInvariants(graph);
+    UnrollLoops(graph);
     EliminateDeadCode(graph);
     CheckInplace(graph);
+    ConstantPropagation(graph);
     EliminateCommonSubexpression(graph);
 
     if (!graphMustSupportVariables) {
@@ -332,18 +413,68 @@ private:
     autograd_fallback = Code(graph_);
     return autograd_fallback;
   }
-  const ExecutionPlan & getOrCompile(const variable_tensor_list & inputs) {
+  // plans are handed out as shared_ptrs because another thread may evict
+  // them from the cache while they run
+  std::shared_ptr<ExecutionPlan> getOrCompile(const variable_tensor_list & inputs) {
     // outside lock guard, to minimize the time holding the lock on the fast path
     // ArgumentSpec even computes its hashCode here.
-    ArgumentSpec spec(autograd::GradMode::is_enabled(), inputs);
+    bool with_grad = autograd::GradMode::is_enabled();
+    ArgumentSpec spec(with_grad, inputs);
     {
       std::lock_guard<std::mutex> lock(compile_mutex);
       auto it = plan_cache.find(spec);
-      if(it != plan_cache.end())
-        return it->second;
-      auto plan = compileSpec(spec);
-      auto r = plan_cache.emplace(std::move(spec), std::move(plan));
-      return r.first->second;
+      if(it != plan_cache.end()) {
+        plan_lru.splice(plan_lru.begin(), plan_lru, it->second);
+        return it->second->second;
+      }
+      auto limits = getPlanCacheLimits();
+      // the gradient is derived from a shape-specialized graph, so only
+      // plans that need no gradient can be shared across sizes
+      if(limits.max_specializations != 0 && !reads_sizes && !argumentSpecRequiresGradient(spec)) {
+        auto & dynamic = dynamic_plans[ArgumentSpec(with_grad, inputs, /*with_sizes=*/false)];
+        if(!dynamic.plan && dynamic.num_specializations >= limits.max_specializations)
+          dynamic.plan = compileDynamic(spec);
+        if(dynamic.plan)
+          return dynamic.plan;
+        dynamic.num_specializations++;
+      }
+      auto plan = std::make_shared<ExecutionPlan>(compileSpec(spec));
+      cachePlan(std::move(spec), plan, limits);
+      return plan;
+    }
+  }
+
+  void precompile(const ArgumentSpec & spec) {
+    if(spec.size() != num_inputs) {
+      std::stringstream ss;
+      ss << "expected a spec of " << num_inputs << " inputs but got " << spec.size() << " inputs";
+      throw std::runtime_error(ss.str());
+    }
+    if(!optimize || (!symbolically_differentiable && argumentSpecRequiresGradient(spec))) {
+      return;
+    }
+    {
+      std::lock_guard<std::mutex> lock(compile_mutex);
+      if(plan_cache.count(spec))
+        return;
+    }
+    // compiled without the lock, see GraphExecutor::precompile
+    auto plan = std::make_shared<ExecutionPlan>(compileSpec(spec));
+    std::lock_guard<std::mutex> lock(compile_mutex);
+    // a run may have compiled it meanwhile
+    if(plan_cache.count(spec))
+      return;
+    cachePlan(spec, std::move(plan), getPlanCacheLimits());
+  }
+
+  // adds plan as the most recently used one, evicting the least recently
+  // used plans beyond limits.max_plans. Must hold compile_mutex.
+  void cachePlan(ArgumentSpec spec, std::shared_ptr<ExecutionPlan> plan, const PlanCacheLimits & limits) {
+    plan_lru.emplace_front(spec, std::move(plan));
+    plan_cache.emplace(std::move(spec), plan_lru.begin());
+    while(limits.max_plans != 0 && plan_lru.size() > limits.max_plans) {
+      plan_cache.erase(plan_lru.back().first);
+      plan_lru.pop_back();
     }
   }
 
@@ -414,7 +545,19 @@ private:
 
     specializeToSpec(graph_, spec);
     if(!argumentSpecRequiresGradient(spec)) {
+      // nothing can update the constant weights of an inference plan, so
+      // they can be packed once for its input sizes
+      PrepackLinear(graph_);
+      // batch norms in inference mode and relus are folded into the
+      // convolutions before them, ahead of the fuser taking the relus
+      FoldConvBatchNorm(graph_);
+      FuseConvRelu(graph_);
       runOptimization(graph_, /*graphMustSupportVariables=*/false);
+      // without a gradient no intermediate outlives the run, so they can all
+      // be placed in preallocated arenas
+      PlanMemory(graph_);
+      if(getCaptureLaunches())
+        return ExecutionPlan(graph_, CapturedLaunches::create(graph_));
       return ExecutionPlan(graph_);
     }
     JIT_ASSERT(symbolically_differentiable);
@@ -429,6 +572,16 @@ private:
     runOptimization(graph_, /*graphMustSupportVariables=*/false);
     return ExecutionPlan(graph_, std::move(gradient));
   }
+  // a plan for any input sizes: the graph is specialized on undefined inputs
+  // only, and just the optimizations that need no shape information are run
+  std::shared_ptr<ExecutionPlan> compileDynamic(const ArgumentSpec & spec) {
+    auto graph_ = graph->copy();
+    runRequiredPasses(graph_);
+    specializeUndef(*graph_, spec);
+    propagateZeros(*graph_);
+    runOptimization(graph_, /*graphMustSupportVariables=*/true);
+    return std::make_shared<ExecutionPlan>(graph_);
+  }
   // the unoptimized starting graph
   // this is never mutated
   std::shared_ptr<Graph> graph;
@@ -449,6 +602,10 @@ private:
   // regardles of input state.
   bool may_introduce_gradient;
 
+  // true if some node depends on concrete input sizes, in which case no
+  // size-independent plan is created
+  bool reads_sizes;
+
   // when this graph has some parts that are not symbolically_differentable,
   // but some input does require a derivative, we create and use autograd_fallback,
   // which wraps up the fully differentiable subgraphs, and then runs the outer
@@ -459,7 +616,19 @@ private:
 
   // optimizable code paths, used when we can differentiate or when no derivative is needed
   // Spec describes input conditions, Plan describes how to execute them.
-  std::unordered_map<ArgumentSpec, ExecutionPlan> plan_cache;
+  // plan_lru is ordered from most to least recently used; see PlanCacheLimits.
+  using PlanList = std::list<std::pair<ArgumentSpec, std::shared_ptr<ExecutionPlan>>>;
+  PlanList plan_lru;
+  std::unordered_map<ArgumentSpec, PlanList::iterator> plan_cache;
+
+  // size-independent plans, keyed by specs without sizes. Until one is
+  // compiled, num_specializations counts the shape-specialized plans that
+  // were compiled for the key.
+  struct DynamicPlan {
+    size_t num_specializations = 0;
+    std::shared_ptr<ExecutionPlan> plan;
+  };
+  std::unordered_map<ArgumentSpec, DynamicPlan> dynamic_plans;
 
   // GraphExecutor can be accessed from  multiple thread so
   // anytime we are checking or updating the autograd_fallback or
@@ -483,4 +652,65 @@ std::shared_ptr<Graph> GraphExecutor::graph() const {
   return pImpl->graph;
 }
 
+size_t GraphExecutor::numSpecializedPlans() const {
+  std::lock_guard<std::mutex> lock(pImpl->compile_mutex);
+  return pImpl->plan_lru.size();
+}
+
+bool GraphExecutor::hasDynamicPlan() const {
+  std::lock_guard<std::mutex> lock(pImpl->compile_mutex);
+  for(auto & entry : pImpl->dynamic_plans) {
+    if(entry.second.plan)
+      return true;
+  }
+  return false;
+}
+
+std::vector<ArgumentSpec> GraphExecutor::specializedPlanSpecs() const {
+  std::lock_guard<std::mutex> lock(pImpl->compile_mutex);
+  std::vector<ArgumentSpec> specs;
+  specs.reserve(pImpl->plan_lru.size());
+  for(auto & entry : pImpl->plan_lru) {
+    specs.push_back(entry.first);
+  }
+  return specs;
+}
+
+void GraphExecutor::precompile(const ArgumentSpec & spec) {
+  pImpl->precompile(spec);
+}
+
+std::shared_future<void> precompileInBackground(
+    GraphExecutor executor, std::vector<ArgumentSpec> specs, size_t num_threads) {
+  num_threads = std::max<size_t>(1, std::min(num_threads, specs.size()));
+  return std::async(std::launch::async, [executor, specs, num_threads]() mutable {
+    // the threads take the specs in order, so that the first ones of the
+    // profile (the most recently used when it was saved) are ready first
+    std::atomic<size_t> next(0);
+    std::mutex error_mutex;
+    std::exception_ptr error;
+    auto work = [&] {
+      for(size_t i = next++; i < specs.size(); i = next++) {
+        try {
+          executor.precompile(specs[i]);
+        } catch(...) {
+          std::lock_guard<std::mutex> lock(error_mutex);
+          if(!error)
+            error = std::current_exception();
+        }
+      }
+    };
+    std::vector<std::thread> threads;
+    for(size_t i = 1; i < num_threads; i++) {
+      threads.emplace_back(work);
+    }
+    work();
+    for(auto & thread : threads) {
+      thread.join();
+    }
+    if(error)
+      std::rethrow_exception(error);
+  }).share();
+}
+
 }}
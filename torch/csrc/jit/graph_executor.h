@@ -1,11 +1,38 @@
 #pragma once
 
+#include <future>
 #include <memory>
+#include <vector>
+#include "torch/csrc/jit/argument_spec.h"
 #include "torch/csrc/jit/ir.h"
 #include "torch/csrc/jit/variable_tensor_list.h"
 
 namespace torch { namespace jit {
 
+// Bounds on the execution plans that each GraphExecutor keeps.
+struct PlanCacheLimits {
+  // Maximum number of shape-specialized plans; when a new one is compiled the
+  // least recently used plan is dropped. 0 means unbounded.
+  size_t max_plans;
+  // Number of shape-specialized plans compiled for inputs that only differ in
+  // sizes and strides before the executor stops specializing and runs them
+  // with a single plan that works for any size. Graphs that read input sizes
+  // keep being specialized. 0 means always specialize.
+  size_t max_specializations;
+};
+
+// Defaults come from PYTORCH_JIT_PLAN_CACHE_SIZE (64) and
+// PYTORCH_JIT_MAX_SPECIALIZATIONS (8). Changes apply to all executors the
+// next time they compile a plan.
+PlanCacheLimits getPlanCacheLimits();
+void setPlanCacheLimits(PlanCacheLimits limits);
+
+// Whether shape-specialized inference plans on CUDA record their kernels once
+// and replay them with a single launch, see captured_launches.h. Defaults to
+// PYTORCH_JIT_CAPTURE_LAUNCHES (0). Changes apply to plans compiled later.
+bool getCaptureLaunches();
+void setCaptureLaunches(bool enabled);
+
 struct GraphExecutorImpl;
 struct GraphExecutor {
   GraphExecutor() {}
@@ -17,8 +44,30 @@ struct GraphExecutor {
     return pImpl != nullptr;
   }
   std::shared_ptr<Graph> graph() const;
+  // number of shape-specialized plans currently cached, and whether any
+  // size-independent plan has been compiled
+  size_t numSpecializedPlans() const;
+  bool hasDynamicPlan() const;
+  // the argument specs of the cached shape-specialized plans, most recently
+  // used first, e.g. to save as a shape profile (see shape_profile.h)
+  std::vector<ArgumentSpec> specializedPlanSpecs() const;
+  // Compiles and caches the shape-specialized plan of inputs matching spec,
+  // unless it is cached already, so that they run without compiling first.
+  // Does nothing for specs that don't run such plans: in unoptimized
+  // executors, or requiring gradients of graphs that are not differentiable.
+  // Runs of plans that are cached already don't wait for it.
+  void precompile(const ArgumentSpec & spec);
 private:
   std::shared_ptr<GraphExecutorImpl> pImpl;
 };
 
+// Precompiles the plans of executor for specs (see GraphExecutor::precompile)
+// on num_threads background threads, e.g. from the shape profile a model
+// ships with when it is loaded. The returned future is ready once all are
+// compiled, and rethrows the first error of a compilation. The executor can
+// run meanwhile; inputs whose plan isn't compiled yet compile it themselves.
+// Beyond the max_plans of PlanCacheLimits, plans evict each other as usual.
+std::shared_future<void> precompileInBackground(
+    GraphExecutor executor, std::vector<ArgumentSpec> specs, size_t num_threads);
+
 }}
@@ -1,10 +1,14 @@
 #include "torch/csrc/jit/import.h"
 #include "torch/csrc/onnx/onnx.pb.h"
+#include "torch/csrc/jit/export.h"
 #include "torch/csrc/jit/ir.h"
 #include "torch/csrc/utils/functional.h"
 
 #include <ATen/ATen.h>
+#include <TH/TH.h>
 
+#include <cstring>
+#include <fstream>
 #include <unordered_map>
 #include <vector>
 #include <string>
@@ -526,4 +530,79 @@ std::shared_ptr<Graph> ImportIRGraph(const std::string& serialized_graph,
   return graph;
 }
 
+std::shared_ptr<Graph> ImportIRGraphFile(const std::string& filename,
+                                         std::vector<at::Tensor>& initializers) {
+  uint64_t file_size;
+  {
+    std::ifstream in(filename, std::ios::binary | std::ios::ate);
+    if (!in) {
+      throw std::runtime_error("Could not open " + filename);
+    }
+    file_size = in.tellg();
+  }
+  if (file_size < sizeof(uint64_t) * 6) {
+    throw std::runtime_error(filename + " is not a serialized IR graph");
+  }
+
+  // Map the whole file once; every initializer is a view into the mapping
+  // that keeps it alive.
+  auto ctx = THMapAllocatorContext_new(filename.c_str(), 0);
+  auto th_storage = THByteStorage_newWithAllocator(file_size, &THMapAllocator, ctx);
+  std::shared_ptr<at::Storage> file(
+      at::CPU(at::kByte).unsafeStorageFromTH(th_storage, /*retain=*/false).release());
+  char* base = static_cast<char*>(file->data());
+
+  if (std::memcmp(base, kIRFileMagic, sizeof(uint64_t)) != 0) {
+    throw std::runtime_error(filename + " is not a serialized IR graph");
+  }
+  const uint64_t* header = reinterpret_cast<const uint64_t*>(base) + 1;
+  const uint64_t* header_end = reinterpret_cast<const uint64_t*>(base) + file_size / sizeof(uint64_t);
+  auto next = [&]() {
+    if (header == header_end) {
+      throw std::runtime_error("Decoding failed");
+    }
+    return *header++;
+  };
+  uint64_t version = next();
+  if (version != kIRFileVersion) {
+    throw std::runtime_error("Unsupported IR file version " + std::to_string(version));
+  }
+  uint64_t graph_offset = next();
+  uint64_t graph_size = next();
+  uint64_t num_tensors = next();
+
+  initializers.reserve(initializers.size() + num_tensors);
+  for (uint64_t i = 0; i < num_tensors; ++i) {
+    auto scalar_type = static_cast<at::ScalarType>(next());
+    uint64_t offset = next();
+    std::vector<int64_t> dims(next());
+    for (auto & d : dims) {
+      d = next();
+    }
+    if (scalar_type >= at::ScalarType::Undefined) {
+      throw std::runtime_error("Unsupported data type");
+    }
+    auto & type = at::CPU(scalar_type);
+    int64_t numel = 1;
+    for (auto d : dims) {
+      numel *= d;
+    }
+    if (offset % type.elementSizeInBytes() != 0 ||
+        offset + numel * type.elementSizeInBytes() > file_size) {
+      throw std::runtime_error("Decoding failed");
+    }
+    auto storage = type.storageFromBlob(base + offset, numel, [file](void*) {});
+    initializers.push_back(type.tensor(*storage, 0, dims));
+  }
+  if (next() > file_size || graph_offset + graph_size > file_size) {
+    throw std::runtime_error(filename + " is truncated");
+  }
+
+  // The initializers in the proto only refer to external data, so we build
+  // the graph alone.
+  pb_istream_t istream = pb_istream_from_buffer(reinterpret_cast<const pb_byte_t *>(base + graph_offset), graph_size);
+  auto model = Reader<Model_>::read(&istream);
+  return buildGraph(model.graph);
+}
+
 }}
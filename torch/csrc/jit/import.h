@@ -6,4 +6,9 @@ namespace torch { namespace jit {
 
 std::shared_ptr<Graph> ImportIRGraph(const std::string& serialized_graph, std::vector<at::Tensor> & initializers);
 
+// Loads a file written by ExportIRGraphFile. The initializers are CPU tensors
+// backed by a private (copy-on-write) memory mapping of the file, which stays
+// mapped until the last of them is freed.
+std::shared_ptr<Graph> ImportIRGraphFile(const std::string& filename, std::vector<at::Tensor> & initializers);
+
 }}
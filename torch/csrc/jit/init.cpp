@@ -12,14 +12,26 @@
 #include "torch/csrc/jit/passes/dead_code_elimination.h"
 #include "torch/csrc/jit/passes/common_subexpression_elimination.h"
 #include "torch/csrc/jit/passes/peephole.h"
+#include "torch/csrc/jit/passes/prepack_linear.h"
+#include "torch/csrc/jit/passes/quantize_weights.h"
+#include "torch/csrc/jit/passes/constant_propagation.h"
+#include "torch/csrc/jit/passes/fold_batch_norm.h"
+#include "torch/csrc/jit/passes/fuse_conv_relu.h"
+#include "torch/csrc/jit/passes/loop_invariant_code_motion.h"
+#include "torch/csrc/jit/passes/loop_unrolling.h"
 #include "torch/csrc/jit/passes/canonicalize.h"
 #include "torch/csrc/jit/passes/onnx/peephole.h"
 #include "torch/csrc/jit/passes/onnx/fixup_onnx_loop.h"
 #include "torch/csrc/jit/passes/shape_analysis.h"
 #include "torch/csrc/jit/graph_executor.h"
+#include "torch/csrc/jit/inter_op_pool.h"
+#include "torch/csrc/jit/shape_profile.h"
 #include "torch/csrc/jit/script/init.h"
 #include "torch/csrc/jit/script/python_tree_views.h"
 
+#include <chrono>
+#include <future>
+
 
 namespace torch  { namespace jit {
 
@@ -71,6 +83,13 @@ void initJITBindings(PyObject *module) {
      return Canonicalize(g);
    })
    .def("_jit_pass_lint", LintGraph)
+   .def("_jit_pass_prepack_linear", PrepackLinear)
+   .def("_jit_pass_quantize_weights", QuantizeWeights)
+   .def("_jit_pass_constant_propagation", ConstantPropagation)
+   .def("_jit_pass_fold_conv_batch_norm", FoldConvBatchNorm)
+   .def("_jit_pass_fuse_conv_relu", FuseConvRelu)
+   .def("_jit_pass_hoist_loop_invariants", HoistLoopInvariants)
+   .def("_jit_pass_unroll_loops", UnrollLoops)
    .def("_jit_pass_shape_analysis", [](Graph& graph, py::tuple inputs, bool with_grad) {
      auto tensor_inputs = createVariableTensorList(inputs);
      PropagateInputShapes(graph, ArgumentSpec(with_grad, tensor_inputs));
@@ -84,7 +103,18 @@ void initJITBindings(PyObject *module) {
      return py::reinterpret_steal<py::object>(python::unflatten(vars, desc));
    })
    .def("_jit_pass_onnx_block", BlockToONNX)
-   .def("_jit_pass_fixup_onnx_loops", FixupONNXLoops);
+   .def("_jit_pass_fixup_onnx_loops", FixupONNXLoops)
+   .def("_jit_get_plan_cache_limits", []() {
+     auto limits = getPlanCacheLimits();
+     return std::make_pair(limits.max_plans, limits.max_specializations);
+   })
+   .def("_jit_set_plan_cache_limits", [](size_t max_plans, size_t max_specializations) {
+     setPlanCacheLimits({max_plans, max_specializations});
+   })
+   .def("_jit_get_capture_launches", getCaptureLaunches)
+   .def("_jit_set_capture_launches", setCaptureLaunches)
+   .def("_jit_get_inter_op_threads", getInterOpThreads)
+   .def("_jit_set_inter_op_threads", setInterOpThreads);
 
   py::class_<GraphExecutor>(m, "GraphExecutor")
       .def(
@@ -107,6 +137,18 @@ void initJITBindings(PyObject *module) {
       .def_property_readonly("graph", [](GraphExecutor& ge) {
         return ge.graph();
       })
+      .def_property_readonly("num_specialized_plans", [](GraphExecutor& ge) {
+        return ge.numSpecializedPlans();
+      })
+      .def_property_readonly("has_dynamic_plan", [](GraphExecutor& ge) {
+        return ge.hasDynamicPlan();
+      })
+      .def("shape_profile", [](GraphExecutor& ge) {
+        return serializeShapeProfile(ge.specializedPlanSpecs());
+      })
+      .def("precompile", [](GraphExecutor& ge, const std::string& profile, size_t num_threads) {
+        return precompileInBackground(ge, parseShapeProfile(profile), num_threads);
+      }, py::arg("profile"), py::arg("num_threads") = 1)
       .def("__call__", [](GraphExecutor& ge, py::args args) -> py::object {
         auto inputs = createVariableTensorList(args);
         auto outputs = ge.run(std::move(inputs));
@@ -125,6 +167,15 @@ void initJITBindings(PyObject *module) {
           return tuple;
         }
       });
+  py::class_<std::shared_future<void>>(m, "PrecompileFuture")
+      .def("wait", [](std::shared_future<void>& f) {
+        py::gil_scoped_release no_gil;
+        f.get();
+      })
+      .def("done", [](std::shared_future<void>& f) {
+        return f.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+      });
+
   initPythonIRBindings(module);
   initPythonTracerBindings(module);
   python::initCompilerMixin(module);
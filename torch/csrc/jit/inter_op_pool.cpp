@@ -0,0 +1,120 @@
+#include "torch/csrc/jit/inter_op_pool.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <deque>
+#include <thread>
+
+namespace torch { namespace jit {
+
+namespace {
+
+size_t defaultInterOpThreads() {
+  const char * value = getenv("PYTORCH_JIT_INTER_OP_THREADS");
+  if(value && value[0])
+    return std::strtoull(value, nullptr, 10);
+  return std::max<size_t>(1, std::thread::hardware_concurrency());
+}
+
+struct InterOpPool {
+  void launch(std::shared_ptr<InterOpTask> task) {
+    std::unique_lock<std::mutex> lock(mutex);
+    if(max_threads == 0) {
+      lock.unlock();
+      task->tryRun();
+      return;
+    }
+    queue.push_back(std::move(task));
+    if(queue.size() > idle_threads && num_threads < max_threads) {
+      num_threads++;
+      // the pool is never destroyed, so its threads can be detached
+      std::thread(&InterOpPool::work, this).detach();
+    }
+    lock.unlock();
+    available.notify_one();
+  }
+
+  size_t getMaxThreads() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return max_threads;
+  }
+
+  void setMaxThreads(size_t n) {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      max_threads = n;
+    }
+    available.notify_all();
+  }
+
+private:
+  void work() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while(true) {
+      idle_threads++;
+      available.wait(lock, [&] {
+        return !queue.empty() || num_threads > max_threads;
+      });
+      idle_threads--;
+      if(queue.empty()) {
+        num_threads--;
+        return;
+      }
+      auto task = std::move(queue.front());
+      queue.pop_front();
+      lock.unlock();
+      // tasks that a waiting thread got to first are skipped
+      task->tryRun();
+      lock.lock();
+    }
+  }
+
+  std::mutex mutex;
+  std::condition_variable available;
+  std::deque<std::shared_ptr<InterOpTask>> queue;
+  size_t max_threads = defaultInterOpThreads();
+  size_t num_threads = 0;
+  size_t idle_threads = 0;
+};
+
+InterOpPool & pool() {
+  static InterOpPool * pool = new InterOpPool();
+  return *pool;
+}
+
+} // anonymous namespace
+
+bool InterOpTask::tryRun() {
+  if(started.exchange(true))
+    return false;
+  fn();
+  // release what fn captured as soon as it is done
+  fn = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    done = true;
+  }
+  finished.notify_all();
+  return true;
+}
+
+void InterOpTask::wait() {
+  if(tryRun())
+    return;
+  std::unique_lock<std::mutex> lock(mutex);
+  finished.wait(lock, [&] { return done; });
+}
+
+void launchInterOp(std::shared_ptr<InterOpTask> task) {
+  pool().launch(std::move(task));
+}
+
+size_t getInterOpThreads() {
+  return pool().getMaxThreads();
+}
+
+void setInterOpThreads(size_t num_threads) {
+  pool().setMaxThreads(num_threads);
+}
+
+}}
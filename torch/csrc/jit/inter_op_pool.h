@@ -0,0 +1,45 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+namespace torch { namespace jit {
+
+// A piece of work forked by prim::Fork. It runs exactly once: on a thread of
+// the inter-op pool, or on the thread that waits for it if no thread of the
+// pool has picked it up yet. The latter keeps forks nested inside forked
+// subgraphs from deadlocking when every thread of the pool is waiting.
+struct InterOpTask {
+  // fn must not throw
+  explicit InterOpTask(std::function<void()> fn)
+  : fn(std::move(fn)) {}
+
+  // Runs the task on this thread unless it was already started, returns
+  // whether it did
+  bool tryRun();
+  // Returns once the task has run, running it on this thread if needed
+  void wait();
+
+private:
+  std::function<void()> fn;
+  std::atomic<bool> started {false};
+  std::mutex mutex;
+  std::condition_variable finished;
+  bool done = false;
+};
+
+// Queues task on the inter-op pool, or runs it right away when the pool has
+// no threads
+void launchInterOp(std::shared_ptr<InterOpTask> task);
+
+// Number of threads of the inter-op pool. Defaults to
+// PYTORCH_JIT_INTER_OP_THREADS, or the number of cores if it is not set.
+// Threads are started on demand, and idle threads beyond the number are
+// stopped. 0 runs forked subgraphs on the forking thread.
+size_t getInterOpThreads();
+void setInterOpThreads(size_t num_threads);
+
+}}
@@ -37,6 +37,7 @@ _(prim, CppOp) \
 _(prim, Drop) \
 _(prim, Eval) \
 _(prim, Expand) /* onnx */ \
+_(prim, Fork) \
 _(prim, FusionGroup) \
 _(prim, GraphExecutor) \
 _(prim, If) \
@@ -45,6 +46,7 @@ _(prim, JumpNZ) /* debug */ \
 _(prim, JumpZ) /* debug */ \
 _(prim, Load) \
 _(prim, Loop) \
+_(prim, MemoryArena) \
 _(prim, Param) \
 _(prim, PackPadded) /* onnx */ \
 _(prim, PadPacked) /* onnx */ \
@@ -58,7 +60,8 @@ _(prim, Store) \
 _(prim, Undefined) \
 _(prim, Starred) \
 _(prim, TupleConstruct) \
-_(prim, TupleUnpack)
+_(prim, TupleUnpack) \
+_(prim, Wait)
 /* end */
 
 // Workaround for some not-yet-defined ATen symbols, see
@@ -84,23 +87,31 @@ FORALL_ATEN_EXTRA_SYMBOLS(_)
 // optimization on ONNX operations.
 
 #define FORALL_ONNX_SYMBOLS(_) \
+_(onnx, Abs) \
 _(onnx, Add) \
 _(onnx, Concat) \
 _(onnx, Constant) \
 _(onnx, ConstantFill) \
 _(onnx, Div) \
+_(onnx, Exp) \
 _(onnx, GRU) \
 _(onnx, Gather) \
 _(onnx, Gemm) \
 _(onnx, LSTM) \
+_(onnx, MatMul) \
 _(onnx, Mul) \
+_(onnx, Neg) \
 _(onnx, Pow) \
 _(onnx, RNN) \
+_(onnx, Relu) \
 _(onnx, Shape) \
+_(onnx, Sigmoid) \
 _(onnx, Size) \
 _(onnx, Slice) \
+_(onnx, Sqrt) \
 _(onnx, Squeeze) \
 _(onnx, Sub) \
+_(onnx, Tanh) \
 _(onnx, Transpose) \
 _(onnx, Unsqueeze) \
 _(onnx, Loop) \
@@ -115,6 +126,7 @@ _(onnx, Reshape)
 
 #define FORALL_ATTR_EXTRA_SYMBOLS(_) \
 _(attr, Subgraph) \
+_(attr, arena_offsets) \
 _(attr, axes) \
 _(attr, axis) \
 _(attr, broadcast) \
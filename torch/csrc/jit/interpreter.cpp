@@ -5,14 +5,18 @@
 
 #include "torch/csrc/autograd/edge.h"
 #include "torch/csrc/autograd/function.h"
+#include "torch/csrc/autograd/grad_mode.h"
 #include "torch/csrc/autograd/functions/special.h"
 #include "torch/csrc/autograd/profiler.h"
 #include "torch/csrc/autograd/variable.h"
 #include "torch/csrc/jit/fusion_compiler.h"
 #include "torch/csrc/jit/generated/aten_dispatch.h"
 #include "torch/csrc/jit/graph_executor.h"
+#include "torch/csrc/jit/inter_op_pool.h"
 #include "torch/csrc/jit/ir.h"
+#include "torch/csrc/jit/passes/plan_memory.h"
 #include "torch/csrc/jit/tensor_conversions.h"
+#include "torch/csrc/utils/auto_gpu.h"
 #include "torch/csrc/variable_tensor_functions.h"
 
 #include <typeinfo>
@@ -345,13 +349,13 @@ public:
   virtual const char * toString() const override {
     throw std::runtime_error("toString() on ContainerTensor");
   }
-  virtual at::IntList sizes() const override {
+  virtual at::IntList sizes_custom() const override {
     throw std::runtime_error("sizes() on ContainerTensor");
   }
-  virtual at::IntList strides() const override {
+  virtual at::IntList strides_custom() const override {
     throw std::runtime_error("strides() on ContainerTensor");
   }
-  virtual int64_t dim() const override {
+  virtual int64_t dim_custom() const override {
     throw std::runtime_error("dim() on ContainerTensor");
   }
   virtual at::Scalar localScalar() override {
@@ -394,6 +398,45 @@ struct AutogradHandle : public ContainerTensor {
   autograd::edge_list forward_outputs;
 };
 
+// The result of a prim::Fork. The forked subgraph runs as an InterOpTask,
+// which leaves its outputs, or the error it raised, in the future's state.
+// The state is shared with the task so that a future dropped before its
+// task ran stays valid.
+struct Future : public ContainerTensor {
+  struct State {
+    variable_tensor_list outputs;
+    std::exception_ptr error;
+  };
+
+  // blocks until the task ran, and returns its outputs
+  variable_tensor_list get() {
+    task->wait();
+    if(state->error)
+      std::rethrow_exception(state->error);
+    return state->outputs;
+  }
+
+  std::shared_ptr<State> state;
+  std::shared_ptr<InterOpTask> task;
+};
+
+// Python functions would serialize the threads of the pool on the GIL, and
+// the thread waiting for them may be holding it, so subgraphs that call
+// into Python are run when they are forked
+static bool callsPython(Block * b) {
+  for(auto n : b->nodes()) {
+    if(n->kind() == prim::PythonOp)
+      return true;
+    if(n->kind() == prim::Fork && callsPython(n->g(attr::Subgraph)->block()))
+      return true;
+    for(auto nb : n->blocks()) {
+      if(callsPython(nb))
+        return true;
+    }
+  }
+  return false;
+}
+
 // HandleBuilder is used to construct the correct Autograd Handle objects
 // for use in a future stage.
 // It is used even when the future stage does not require a handle since
@@ -617,9 +660,40 @@ Operation createEvalOperation(CppOp * op) {
   };
 }
 
+// Nodes rewritten by PlanMemory write their outputs into slices of the arena
+// that is passed as their last input.
+Operation createPlannedOperation(jit::Node* node) {
+  auto out_op = getOutOperation(node);
+  auto offsets = node->is(attr::arena_offsets);
+  std::vector<std::vector<int64_t>> sizes, strides;
+  for(auto output : node->outputs()) {
+    auto type = output->type()->expect<TensorType>();
+    sizes.push_back(type->sizes());
+    strides.push_back(type->strides());
+  }
+  auto num_inputs = node->inputs().size() - 1;
+  const char * name = node->kind().toUnqualString();
+  return [=](Stack & stack) {
+    autograd::profiler::RecordFunction record(name);
+    auto arena = pop(stack);
+    AutoGPU device_guard(arena);
+    std::vector<at::Tensor> outputs;
+    outputs.reserve(offsets.size());
+    for(size_t i = 0; i < offsets.size(); ++i) {
+      outputs.push_back(arena.as_strided(sizes[i], strides[i], offsets[i]));
+    }
+    out_op(last(stack, num_inputs), outputs);
+    drop(stack, num_inputs);
+    stack.insert(stack.end(), outputs.begin(), outputs.end());
+    return 0;
+  };
+}
+
 // Returns a function implementing functionality of a given node,
 // or nullptr if it's a no-op for autograd.
 Operation getOperation(jit::Node* node) {
+  if(node->hasAttribute(attr::arena_offsets))
+    return createPlannedOperation(node);
   IR_IFM(node, PythonOp)
     return createPythonOperation(value);
   IR_ELSEIFM(CppOp)
@@ -651,6 +725,17 @@ Operation getOperation(jit::Node* node) {
       stack.push_back(at::Tensor());
       return 0;
     };
+  IR_ELSEIF(MemoryArena)
+    auto type = value->output()->type()->expect<TensorType>();
+    auto backend = type->device() == -1 ? at::kCPU : at::kCUDA;
+    auto & arena_type = torch::getType(backend, type->scalarType());
+    auto size = type->sizes().at(0);
+    int device = type->device();
+    return [&arena_type, size, device](Stack & stack) {
+      AutoGPU device_guard(device);
+      stack.push_back(arena_type.tensor({size}));
+      return 0;
+    };
   IR_ELSEIF(ReplaceIfUndef)
     return [](Stack & stack) {
       auto alternate = pop(stack);
@@ -722,6 +807,50 @@ Operation getOperation(jit::Node* node) {
     };
   IR_ELSE()
     switch (node->kind()) {
+      case prim::Fork: {
+        auto subgraph = node->g(attr::Subgraph);
+        GraphExecutor executor(subgraph);
+        auto num_inputs = node->inputs().size();
+        bool run_now = callsPython(subgraph->block());
+        return [=](Stack& stack) {
+          autograd::profiler::RecordFunction record("Fork");
+          auto inputs = last(stack, num_inputs);
+          auto state = std::make_shared<Future::State>();
+          state->outputs.assign(inputs.begin(), inputs.end());
+          drop(stack, num_inputs);
+          // the fork runs in the grad mode of the thread that forked it
+          bool grad_mode = autograd::GradMode::is_enabled();
+          auto future = new Future();
+          future->state = state;
+          future->task = std::make_shared<InterOpTask>([executor, state, grad_mode]() mutable {
+            autograd::AutoGradMode guard(grad_mode);
+            try {
+              state->outputs = executor.run(std::move(state->outputs));
+            } catch(...) {
+              state->outputs.clear();
+              state->error = std::current_exception();
+            }
+          });
+          if(run_now) {
+            future->task->tryRun();
+          } else {
+            launchInterOp(future->task);
+          }
+          stack.push_back(at::Tensor(future, /*retain=*/false));
+          return 0;
+        };
+      } break;
+      case prim::Wait: {
+        return [](Stack& stack) {
+          autograd::profiler::RecordFunction record("Wait");
+          auto future_t = pop(stack);
+          auto future = dynamic_cast<Future*>(future_t.get());
+          JIT_ASSERT(future);
+          auto outputs = future->get();
+          stack.insert(stack.end(), outputs.begin(), outputs.end());
+          return 0;
+        };
+      } break;
       case onnx::Reshape: {
         return [=](Stack& stack) {
           auto shape = pop(stack).contiguous();
@@ -756,24 +885,26 @@ Operation getOperation(jit::Node* node) {
 // contiguous we allocate a single vector and use offsets into the vector
 // which are stored in the ListHandle struct
 // start is an offset into int_data of Code for ListHandle<int>
-// and bool_data of Code for ListHandle<bool>
+// and use_data of Code for ListHandle<RegisterUse>
 template<typename T>
 struct ListHandle {
   int start;
   int size;
 };
 
-struct UseList {
-  // values to be used
-  ListHandle<int> values;
-  // boolean flags indicating whether to free the Tensor after this use
-  ListHandle<bool> free_flags;
+// a register read by an instruction. Registers read for the last time are
+// moved onto the stack, which frees the tensor as soon as the op drops it.
+struct RegisterUse {
+  int reg;
+  bool move;
 };
 
 // one instruction plus meta-data
 struct Instruction {
+  // empty for instructions that only move values between registers and the
+  // stack (Load, Store, Assign); the run loop skips the call for them
   Operation callback;
-  UseList inputs;
+  ListHandle<RegisterUse> inputs;
   ListHandle<int> outputs;
   Symbol debug_name; // used in dump to understand the generated code
   std::shared_ptr<SourceLocation> debug_location; // for error reporting
@@ -913,7 +1044,10 @@ struct CodeImpl {
 
   size_t insertInstruction(Node * n) {
     auto inst = insertInstruction(n->kind(), n->getSourceLocation(), n->inputs(), moveFlags(n) , n->outputs());
-    instructions[inst].callback = getOperation(n);
+    if(n->kind() != prim::Load && n->kind() != prim::Store)
+      instructions[inst].callback = getOperation(n);
+    if(n->kind() == prim::Load)
+      load_size += n->inputs().size();
     return inst;
   }
   size_t insertInstruction(Symbol sym,
@@ -925,18 +1059,16 @@ struct CodeImpl {
     auto & inst = instructions.back();
     inst.debug_name = sym;
     inst.debug_location = std::move(debug_location);
-    listBegin(inst.inputs.values);
-    for(auto input : inputs) {
-      listInsert(inst.inputs.values, getOrAllocateRegister(input, true));
-    }
-    listBegin(inst.inputs.free_flags);
-    for(auto flag : move_flags) {
-      listInsert(inst.inputs.free_flags, flag);
+    JIT_ASSERT(inputs.size() == move_flags.size());
+    listBegin(inst.inputs);
+    for(size_t i = 0; i < inputs.size(); ++i) {
+      listInsert(inst.inputs, RegisterUse {getOrAllocateRegister(inputs[i], true), move_flags[i] != 0});
     }
     listBegin(inst.outputs);
     for(auto output : outputs) {
       listInsert(inst.outputs, getOrAllocateRegister(output));
     }
+    max_io = std::max(max_io, std::max(inputs.size(), outputs.size()));
     return instructions.size() - 1;
   }
   ArrayRef<uint8_t> moveFlags(Node * n) {
@@ -950,8 +1082,8 @@ struct CodeImpl {
     auto inst = insertInstruction(prim::Assign, std::move(debug_location),inputs, move_flags, outputs);
     // This node effectively forwards its inputs into different places in a register list.
     // We don't need to manipulate the stack in any way, because all inputs are also outputs,
-    // and the interpreter will take care of putting them in correct places.
-    instructions[inst].callback = [](Stack& stack) { return 0; };
+    // and the interpreter will take care of putting them in correct places,
+    // so it has no callback.
     return inst;
   }
 
@@ -959,8 +1091,8 @@ struct CodeImpl {
   int get(const ListHandle<int> & list, int i)  const {
     return int_data[list.start + i];
   }
-  bool get(const ListHandle<bool> & list, int i) const {
-    return bool_data[list.start + i];
+  const RegisterUse & get(const ListHandle<RegisterUse> & list, int i) const {
+    return use_data[list.start + i];
   }
   void listBegin(ListHandle<int> & list) {
     list.start = int_data.size();
@@ -971,13 +1103,13 @@ struct CodeImpl {
     int_data.push_back(value);
     list.size++;
   }
-  void listBegin(ListHandle<bool> & list) {
-    list.start = bool_data.size();
+  void listBegin(ListHandle<RegisterUse> & list) {
+    list.start = use_data.size();
     list.size = 0;
   }
-  void listInsert(ListHandle<bool> & list, int value) {
-    JIT_ASSERTM(list.start + list.size == (int)bool_data.size(), "another list already started");
-    bool_data.push_back(value);
+  void listInsert(ListHandle<RegisterUse> & list, RegisterUse value) {
+    JIT_ASSERTM(list.start + list.size == (int)use_data.size(), "another list already started");
+    use_data.push_back(value);
     list.size++;
   }
   // must be called before any new_allocations are used, otherwise they will
@@ -1009,14 +1141,15 @@ struct CodeImpl {
         out << get(list, i);
       }
     };
-    auto writeUseList = [&](const UseList & list) {
-      for(int i = 0; i < list.values.size; i++) {
+    auto writeUseList = [&](const ListHandle<RegisterUse> & list) {
+      for(int i = 0; i < list.size; i++) {
         if(i > 0)
           out << ", ";
-        if(get(list.free_flags, i))
-          out << "move(" << get(list.values, i) << ")";
+        auto & use = get(list, i);
+        if(use.move)
+          out << "move(" << use.reg << ")";
         else
-          out << get(list.values, i);
+          out << use.reg;
       }
     };
     auto & inst = instructions.at(pc);
@@ -1047,11 +1180,16 @@ struct CodeImpl {
   std::vector<Instruction> instructions;
   std::vector<size_t> stage_end; // each stage runs while(pc < stage_end[stage])
   int register_size = 0;
+  // the most values any instruction reads or writes, plus everything the
+  // Loads leave on the stack: runOneStage reserves this much stack space so
+  // that pushes never reallocate
+  size_t max_io = 0;
+  size_t load_size = 0;
 
   // all memory ArrayRef<int> are slices of this, to make sure
   // the interpreter is mostly linearly scanning through memory
   std::vector<int> int_data;
-  std::vector<bool> bool_data;
+  std::vector<RegisterUse> use_data;
 };
 
 // InterpreterState state that is held across stages and used to compute a Code
@@ -1059,7 +1197,7 @@ struct InterpreterStateImpl {
   InterpreterStateImpl(const Code & function_)
   : function(function_.pImpl),
     int_data(function->int_data.data()),
-    bool_data(function->bool_data),
+    use_data(function->use_data.data()),
     registers(function->register_size) {
   }
   void runOneStage(Stack & stack) {
@@ -1069,6 +1207,7 @@ struct InterpreterStateImpl {
     size_t pc = current_pc;
     size_t last = function->stage_end[current_stage];
     auto & instructions = function->instructions;
+    stack.reserve(stack.size() + function->max_io + function->load_size);
     while(pc < last) {
         // std::cout << "executing " << pc << ": ";
         // function->dumpInstruction(std::cout, pc);
@@ -1076,11 +1215,15 @@ struct InterpreterStateImpl {
         try {
           auto & inst = instructions[pc];
           loadTensorsFromRegisters(inst.inputs, stack);
-          size_t new_pc = pc + 1 + inst.callback(stack);
-          for(int i = inst.outputs.size - 1; i >= 0; i--) {
-            int reg = get(inst.outputs,i);
-            registers[reg] = pop(stack);
-            // std::cout << "pop reg[" << reg << "];\n" << registers[reg].pImpl << "\n";
+          size_t new_pc = pc + 1;
+          if(inst.callback)
+            new_pc += inst.callback(stack);
+          if(inst.outputs.size > 0) {
+            auto outputs = stack.end() - inst.outputs.size;
+            for(int i = 0; i < inst.outputs.size; i++) {
+              registers[get(inst.outputs, i)] = std::move(outputs[i]);
+            }
+            drop(stack, inst.outputs.size);
           }
           pc = new_pc;
         } catch(std::exception & e) {
@@ -1099,19 +1242,15 @@ struct InterpreterStateImpl {
   int get(const ListHandle<int> & list, int i) {
     return int_data[list.start + i];
   };
-  bool get(const ListHandle<bool> & list, int i) {
-    return bool_data[list.start + i];
-  }
-  void loadTensorsFromRegisters(const UseList & uses, Stack & stack) {
-    for(int i = 0; i < uses.values.size; i++) {
-      int reg = get(uses.values,i);
-      // std::cout << "push reg[" << reg << "];\n" << registers[reg] << "\n\n";
-      if(get(uses.free_flags,i)) {
-        stack.push_back(std::move(registers[reg]));
+  void loadTensorsFromRegisters(const ListHandle<RegisterUse> & uses, Stack & stack) {
+    const RegisterUse * use = use_data + uses.start;
+    for(int i = 0; i < uses.size; i++, use++) {
+      // std::cout << "push reg[" << use->reg << "];\n" << registers[use->reg] << "\n\n";
+      if(use->move) {
+        stack.push_back(std::move(registers[use->reg]));
       } else {
-        stack.push_back(registers[reg]);
+        stack.push_back(registers[use->reg]);
       }
-
     }
   }
   size_t current_stage = 0;
@@ -1119,7 +1258,7 @@ struct InterpreterStateImpl {
   std::shared_ptr<CodeImpl> function; // keep function alive
   // these are just copies of function to prevent indirections in interpreter
   int * int_data;
-  const std::vector<bool> & bool_data;
+  const RegisterUse * use_data;
 
 
   // this holds all the tensors for this interpreter run
@@ -180,6 +180,22 @@ InterpreterFunctionFactory::InterpreterFunctionFactory(TracingState *state) {
   }
 }
 
+InterpreterFunctionFactory::InterpreterFunctionFactory(std::shared_ptr<Graph> graph,
+                                                       const InterpreterFunctionFactory& like)
+  : stage_details_(like.stage_details_) {
+  JIT_ASSERT(graph->stage() + 1 == stage_details_.size());
+  code_ = jit::Code(graph);
+  auto graph_inputs = graph->inputs();
+  auto inputs_it = graph_inputs.begin();
+  for (std::size_t stage = 0; stage < graph->stage() + 1; ++stage) {
+    auto & used_inputs = stage_details_[stage].used_inputs;
+    used_inputs.clear();
+    for (; inputs_it != graph_inputs.end() && (*inputs_it)->stage() == stage; ++inputs_it) {
+      used_inputs.push_back((*inputs_it)->uses().size() > 0);
+    }
+  }
+}
+
 std::shared_ptr<InterpreterAutogradFunction> InterpreterFunctionFactory::construct() {
   return std::make_shared<InterpreterAutogradFunction>(code_, stage_details_);
 }
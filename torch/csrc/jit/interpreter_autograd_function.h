@@ -62,6 +62,10 @@ private:
 
 struct InterpreterFunctionFactory {
   explicit InterpreterFunctionFactory(tracer::TracingState *state);
+  // Like like, but runs graph, a copy of the graph of like specialized to
+  // inputs of other sizes.
+  InterpreterFunctionFactory(std::shared_ptr<Graph> graph,
+                             const InterpreterFunctionFactory& like);
   // Return `InterpreterAutogradFunction` because it has its apply() public.
   std::shared_ptr<InterpreterAutogradFunction> construct();
   // For when we need to pass a function with this signature.
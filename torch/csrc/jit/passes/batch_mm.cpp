@@ -6,6 +6,9 @@
 
 #include <ATen/ATen.h>
 #include <algorithm>
+#include <functional>
+#include <limits>
+#include <sstream>
 #include <unordered_map>
 
 namespace torch { namespace jit {
@@ -205,8 +208,445 @@ void BatchMMBlock(Block* block) {
   EliminateDeadCode(block);
 }
 
+// Horizontal batching
+//
+// The second half of this pass looks for independent ops of the same kind,
+// applied to operands of the same sizes, e.g. the projections of the heads of
+// a multi-head attention layer, or the convolutions on sibling branches of an
+// inception block. Each group is replaced with a single op on concatenated
+// operands, whose result is chunked back into the original outputs:
+//
+//   %1 = mm(%x, %w1)        %w = cat[dim=1](%w1, %w2)
+//   %2 = mm(%x, %w2)   =>   %y = mm(%x, %w)
+//                           %1, %2 = chunk[chunks=2, dim=1](%y)
+//
+// The patterns we handle are:
+//   - mm (and addmm, which is what linear turns into) with a shared lhs: cat
+//     the rhs (and biases) along dim 1,
+//   - mm with a shared rhs: cat the lhs along dim 0,
+//   - any other group of mms: stack both operands and use a single bmm,
+//   - _convolution with a shared input: cat the weights (and biases) along
+//     dim 0,
+//   - any other group of _convolutions: cat the inputs along the channel
+//     dimension and run a single grouped convolution,
+//   - unary pointwise ops: cat the inputs along dim 0.
+// Only the cats and stacks copy memory; chunk and select return views.
+//
+// Groups are formed in a single pass over the block in topological order. A
+// node can only join a group if none of the outputs of the nodes already in it
+// has been used yet, which guarantees that no member depends on another one,
+// and that all of their uses come after the last member, which is where the
+// batched op is inserted.
+
+// Tunable parameter. The number of elements that can be copied in the time
+// it takes to launch one op. A group of k ops is only batched if the cats it
+// needs copy fewer than (k - 1) times this many elements.
+static constexpr int64_t launch_cost_in_elements = 1 << 16;
+
+namespace {
+
+struct HorizontalPattern {
+  // Returns the key of the group that n can be batched with, or an empty
+  // string if this pattern doesn't apply to n.
+  std::function<std::string(Node*)> key;
+  // Number of elements of the inputs of n that the batched version copies.
+  std::function<int64_t(Node*)> copied;
+  // Inserts the batched version of nodes before nodes.back(), and replaces
+  // all uses of their outputs.
+  std::function<void(const std::vector<Node*>&)> rewrite;
+};
+
+TensorType* completeType(Value* v) {
+  return v->type()->cast<TensorType>();
+}
+
+int64_t numel(Value* v) {
+  auto type = completeType(v);
+  if (!type)
+    return 0;
+  int64_t n = 1;
+  for (auto s : type->sizes())
+    n *= s;
+  return n;
+}
+
+// Appends the type of v to the key, or returns false if it isn't a tensor
+// of known size.
+bool appendType(std::ostream& out, Value* v) {
+  auto type = completeType(v);
+  if (!type)
+    return false;
+  out << static_cast<int>(type->scalarType()) << ":" << type->device() << ":";
+  for (auto s : type->sizes())
+    out << s << ",";
+  out << ";";
+  return true;
+}
+
+// Appends the attributes of n to the key, or returns false if one of them
+// is of a kind we don't compare.
+bool appendAttributes(std::ostream& out, Node* n) {
+  auto names = n->attributeNames();
+  std::sort(names.begin(), names.end());
+  for (auto name : names) {
+    out << name.toUnqualString() << "=";
+    switch (n->kindOf(name)) {
+      case AttributeKind::i:
+        out << n->i(name);
+        break;
+      case AttributeKind::is:
+        for (auto i : n->is(name))
+          out << i << ",";
+        break;
+      default:
+        return false;
+    }
+    out << ";";
+  }
+  return true;
+}
+
+bool isUndefined(Value* v) {
+  return v->node()->kind() == prim::Undefined;
+}
+
+bool isOne(Node* n, Symbol name) {
+  return n->hasAttribute(name) && n->kindOf(name) == AttributeKind::t &&
+         at::Scalar(n->t(name)).toDouble() == 1;
+}
+
+Value* insertCat(Node* before, const std::vector<Value*>& inputs, int64_t dim) {
+  auto type = inputs[0]->type()->expect<TensorType>();
+  auto sizes = type->sizes();
+  sizes[dim] = 0;
+  for (auto input : inputs)
+    sizes[dim] += input->type()->expect<TensorType>()->sizes()[dim];
+  Node *cat = before->owningGraph()->create(aten::cat, inputs)
+                                   ->i_(attr::dim, dim);
+  cat->insertBefore(before);
+  cat->output()->setType(type->withSizes(sizes));
+  return cat->output();
+}
+
+Value* insertStack(Node* before, const std::vector<Value*>& inputs) {
+  auto type = inputs[0]->type()->expect<TensorType>();
+  auto sizes = type->sizes();
+  sizes.insert(sizes.begin(), inputs.size());
+  Node *stack = before->owningGraph()->create(aten::stack, inputs)
+                                     ->i_(attr::dim, 0);
+  stack->insertBefore(before);
+  stack->output()->setType(type->withSizes(sizes));
+  return stack->output();
+}
+
+// Inserts a node of kind with the attributes of like, whose single output
+// is contiguous tensor of sizes.
+Value* insertBatched(Node* before, Node* like, NodeKind kind, at::ArrayRef<Value*> inputs,
+                     at::IntList sizes) {
+  Node *batched = before->owningGraph()->create(kind, inputs);
+  batched->copyAttributes(*like);
+  batched->insertBefore(before);
+  batched->output()->setType(like->output()->type()->expect<TensorType>()->withSizes(sizes));
+  return batched->output();
+}
+
+std::vector<int64_t> outputSizes(const std::vector<Node*>& nodes, int64_t dim) {
+  auto sizes = nodes[0]->output()->type()->expect<TensorType>()->sizes();
+  sizes[dim] *= nodes.size();
+  return sizes;
+}
+
+// Replaces the outputs of nodes with consecutive chunks of batched along dim.
+void replaceWithChunks(Node* before, Value* batched, const std::vector<Node*>& nodes, int64_t dim) {
+  auto strides = batched->type()->expect<TensorType>()->strides();
+  Node *chunk = before->owningGraph()->create(aten::chunk, batched, nodes.size())
+                                     ->i_(attr::chunks, nodes.size())
+                                     ->i_(attr::dim, dim);
+  chunk->insertBefore(before);
+  for (size_t i = 0; i < nodes.size(); ++i) {
+    auto type = nodes[i]->output()->type()->expect<TensorType>();
+    chunk->outputs()[i]->setType(type->withSizesStrides(type->sizes(), strides));
+    nodes[i]->output()->replaceAllUsesWith(chunk->outputs()[i]);
+  }
+}
+
+std::vector<Value*> inputsAt(const std::vector<Node*>& nodes, size_t i) {
+  return fmap(nodes, [=](Node *n) { return n->inputs()[i]; });
+}
+
+// mm(%a, %b) or addmm[beta=1, alpha=1](%bias, %a, %b); see lhsOffset
+bool isMatMul(Node* n) {
+  if (n->outputs().size() != 1 || !completeType(n->output()))
+    return false;
+  if (n->kind() == aten::mm)
+    return n->inputs().size() == 2 && n->attributeNames().empty();
+  if (n->kind() == aten::addmm)
+    return n->inputs().size() == 3 && n->attributeNames().size() == 2 &&
+           isOne(n, attr::beta) && isOne(n, attr::alpha);
+  return false;
+}
+
+size_t lhsOffset(Node* n) {
+  return n->kind() == aten::addmm ? 1 : 0;
+}
+
+std::vector<HorizontalPattern> horizontalPatterns() {
+  std::vector<HorizontalPattern> patterns;
+
+  // mm/addmm with a shared lhs
+  patterns.push_back({
+    [](Node* n) -> std::string {
+      if (!isMatMul(n))
+        return "";
+      size_t off = lhsOffset(n);
+      std::stringstream key;
+      key << n->kind().toQualString() << ";lhs=" << n->inputs()[off]->unique() << ";";
+      if (!appendType(key, n->inputs()[off]) || !appendType(key, n->inputs()[off + 1]))
+        return "";
+      if (off == 1) {
+        // the bias has to be concatenated as well, so it can only be
+        // broadcast along the rows
+        auto bias = completeType(n->inputs()[0]);
+        auto out = completeType(n->output());
+        if (!bias || bias->sizes().size() < 1 || bias->sizes().back() != out->sizes()[1])
+          return "";
+        appendType(key, n->inputs()[0]);
+      }
+      return key.str();
+    },
+    [](Node* n) {
+      size_t off = lhsOffset(n);
+      return numel(n->inputs()[off + 1]) + (off == 1 ? numel(n->inputs()[0]) : 0);
+    },
+    [](const std::vector<Node*>& nodes) {
+      Node *last = nodes.back();
+      size_t off = lhsOffset(last);
+      std::vector<Value*> inputs;
+      if (off == 1) {
+        auto bias_dim = last->inputs()[0]->type()->expect<TensorType>()->sizes().size() - 1;
+        inputs.push_back(insertCat(last, inputsAt(nodes, 0), bias_dim));
+      }
+      inputs.push_back(last->inputs()[off]);
+      inputs.push_back(insertCat(last, inputsAt(nodes, off + 1), 1));
+      auto batched = insertBatched(last, last, last->kind(), inputs, outputSizes(nodes, 1));
+      replaceWithChunks(last, batched, nodes, 1);
+    }
+  });
+
+  // mm with a shared rhs
+  patterns.push_back({
+    [](Node* n) -> std::string {
+      if (!isMatMul(n) || n->kind() != aten::mm)
+        return "";
+      std::stringstream key;
+      key << "mm;rhs=" << n->inputs()[1]->unique() << ";";
+      if (!appendType(key, n->inputs()[0]) || !appendType(key, n->inputs()[1]))
+        return "";
+      return key.str();
+    },
+    [](Node* n) { return numel(n->inputs()[0]); },
+    [](const std::vector<Node*>& nodes) {
+      Node *last = nodes.back();
+      auto lhs = insertCat(last, inputsAt(nodes, 0), 0);
+      auto batched = insertBatched(last, last, aten::mm, {lhs, last->inputs()[1]}, outputSizes(nodes, 0));
+      replaceWithChunks(last, batched, nodes, 0);
+    }
+  });
+
+  // any other mms
+  patterns.push_back({
+    [](Node* n) -> std::string {
+      if (!isMatMul(n) || n->kind() != aten::mm)
+        return "";
+      std::stringstream key;
+      key << "mm;";
+      if (!appendType(key, n->inputs()[0]) || !appendType(key, n->inputs()[1]))
+        return "";
+      return key.str();
+    },
+    [](Node* n) { return numel(n->inputs()[0]) + numel(n->inputs()[1]); },
+    [](const std::vector<Node*>& nodes) {
+      Node *last = nodes.back();
+      auto graph = last->owningGraph();
+      auto lhs = insertStack(last, inputsAt(nodes, 0));
+      auto rhs = insertStack(last, inputsAt(nodes, 1));
+      auto sizes = last->output()->type()->expect<TensorType>()->sizes();
+      sizes.insert(sizes.begin(), nodes.size());
+      auto batched = insertBatched(last, last, aten::bmm, {lhs, rhs}, sizes);
+      for (size_t i = 0; i < nodes.size(); ++i) {
+        Node *select = graph->create(aten::select, batched)
+                            ->i_(attr::dim, 0)
+                            ->i_(attr::index, i);
+        select->insertBefore(last);
+        select->output()->setType(nodes[i]->output()->type()->expect<TensorType>()->contiguous());
+        nodes[i]->output()->replaceAllUsesWith(select->output());
+      }
+    }
+  });
+
+  // Grouping the output channels of a convolution that already has groups
+  // would interleave them with the groups of the other members, so only plain
+  // convolutions are batched.
+  auto convKey = [](Node* n, bool shared_input) -> std::string {
+    if (n->kind() != aten::_convolution || n->inputs().size() != 3 ||
+        n->outputs().size() != 1 || !completeType(n->output()) ||
+        !n->hasAttribute(attr::transposed) || n->i(attr::transposed) != 0 ||
+        !n->hasAttribute(attr::groups) || n->i(attr::groups) != 1)
+      return "";
+    std::stringstream key;
+    key << "conv;";
+    if (shared_input)
+      key << "input=" << n->inputs()[0]->unique() << ";";
+    if (!appendType(key, n->inputs()[0]) || !appendType(key, n->inputs()[1]))
+      return "";
+    if (isUndefined(n->inputs()[2]))
+      key << "no bias;";
+    else if (!appendType(key, n->inputs()[2]))
+      return "";
+    if (!appendAttributes(key, n))
+      return "";
+    return key.str();
+  };
+  auto convBias = [](const std::vector<Node*>& nodes) {
+    Node *last = nodes.back();
+    if (isUndefined(last->inputs()[2]))
+      return last->inputs()[2];
+    return insertCat(last, inputsAt(nodes, 2), 0);
+  };
+
+  // _convolution with a shared input
+  patterns.push_back({
+    [=](Node* n) { return convKey(n, true); },
+    [](Node* n) { return numel(n->inputs()[1]) + numel(n->inputs()[2]); },
+    [=](const std::vector<Node*>& nodes) {
+      Node *last = nodes.back();
+      auto weight = insertCat(last, inputsAt(nodes, 1), 0);
+      auto bias = convBias(nodes);
+      auto batched = insertBatched(last, last, aten::_convolution,
+                                   {last->inputs()[0], weight, bias}, outputSizes(nodes, 1));
+      replaceWithChunks(last, batched, nodes, 1);
+    }
+  });
+
+  // any other _convolutions
+  patterns.push_back({
+    [=](Node* n) { return convKey(n, false); },
+    [](Node* n) { return numel(n->inputs()[0]) + numel(n->inputs()[1]) + numel(n->inputs()[2]); },
+    [=](const std::vector<Node*>& nodes) {
+      Node *last = nodes.back();
+      auto input = insertCat(last, inputsAt(nodes, 0), 1);
+      auto weight = insertCat(last, inputsAt(nodes, 1), 0);
+      auto bias = convBias(nodes);
+      auto batched = insertBatched(last, last, aten::_convolution,
+                                   {input, weight, bias}, outputSizes(nodes, 1));
+      batched->node()->i_(attr::groups, nodes.size());
+      replaceWithChunks(last, batched, nodes, 1);
+    }
+  });
+
+  // unary pointwise ops
+  patterns.push_back({
+    [](Node* n) -> std::string {
+      switch (n->kind()) {
+        case aten::sigmoid:
+        case aten::tanh:
+        case aten::exp:
+        case aten::log:
+        case aten::neg:
+        case aten::sqrt:
+        case aten::rsqrt:
+        case aten::reciprocal:
+          break;
+        default:
+          return "";
+      }
+      if (n->inputs().size() != 1 || n->outputs().size() != 1 ||
+          !n->attributeNames().empty() || !completeType(n->output()))
+        return "";
+      auto type = completeType(n->inputs()[0]);
+      if (!type || type->sizes().empty())
+        return "";
+      std::stringstream key;
+      key << n->kind().toQualString() << ";";
+      appendType(key, n->inputs()[0]);
+      return key.str();
+    },
+    [](Node* n) { return numel(n->inputs()[0]); },
+    [](const std::vector<Node*>& nodes) {
+      Node *last = nodes.back();
+      auto input = insertCat(last, inputsAt(nodes, 0), 0);
+      auto batched = insertBatched(last, last, last->kind(), {input}, outputSizes(nodes, 0));
+      replaceWithChunks(last, batched, nodes, 0);
+    }
+  });
+
+  return patterns;
+}
+
+// Position of n in block, or of the node of block that n is nested in.
+// The return node is considered to come after all nodes.
+size_t positionIn(Block* block, const std::unordered_map<Node*, size_t>& position, Node* n) {
+  while (n->owningBlock() != block)
+    n = n->owningBlock()->owningNode();
+  auto it = position.find(n);
+  return it == position.end() ? std::numeric_limits<size_t>::max() : it->second;
+}
+
+struct HorizontalGroup {
+  std::vector<Node*> nodes;
+  size_t first_use = std::numeric_limits<size_t>::max();
+  int64_t copied = 0;
+};
+
+void BatchHorizontalBlock(Block* block, const HorizontalPattern& pattern) {
+  std::unordered_map<Node*, size_t> position;
+  for (auto node : block->nodes()) {
+    size_t i = position.size();
+    position[node] = i;
+  }
+
+  std::unordered_map<std::string, HorizontalGroup> open;
+  std::vector<HorizontalGroup> closed;
+  for (auto node : block->nodes()) {
+    for (auto b : node->blocks())
+      BatchHorizontalBlock(b, pattern);
+    auto key = pattern.key(node);
+    if (key.empty())
+      continue;
+    auto it = open.find(key);
+    if (it != open.end() && it->second.first_use < position.at(node)) {
+      closed.push_back(std::move(it->second));
+      open.erase(it);
+      it = open.end();
+    }
+    if (it == open.end())
+      it = open.emplace(key, HorizontalGroup()).first;
+    auto & group = it->second;
+    group.nodes.push_back(node);
+    group.copied += pattern.copied(node);
+    for (auto & use : node->output()->uses())
+      group.first_use = std::min(group.first_use, positionIn(block, position, use.user));
+  }
+  for (auto & item : open)
+    closed.push_back(std::move(item.second));
+
+  for (auto & group : closed) {
+    auto k = static_cast<int64_t>(group.nodes.size());
+    if (group.nodes.size() < min_fusion_size ||
+        group.copied >= (k - 1) * launch_cost_in_elements)
+      continue;
+    pattern.rewrite(group.nodes);
+  }
+  // Later patterns must not see the nodes we've replaced.
+  EliminateDeadCode(block);
+}
+
+} // anonymous namespace
+
 void BatchMM(std::shared_ptr<Graph>& graph) {
   BatchMMBlock(graph->block());
+  for (auto & pattern : horizontalPatterns())
+    BatchHorizontalBlock(graph->block(), pattern);
 }
 
 }}
@@ -0,0 +1,118 @@
+#include "torch/csrc/jit/passes/constant_propagation.h"
+
+#include "torch/csrc/autograd/variable.h"
+#include "torch/csrc/jit/generated/aten_dispatch.h"
+#include "torch/csrc/jit/interned_strings.h"
+#include "torch/csrc/jit/passes/dead_code_elimination.h"
+
+#include <ATen/ATen.h>
+
+#include <algorithm>
+#include <cstring>
+#include <unordered_set>
+
+namespace torch { namespace jit {
+
+namespace {
+
+// Folding one of these would freeze a single draw of its random numbers
+bool isNondeterministic(Node* n) {
+  static const std::unordered_set<std::string> ops = {
+    "alpha_dropout", "bernoulli", "dropout", "feature_alpha_dropout",
+    "feature_dropout", "multinomial", "normal", "poisson", "rand_like",
+    "randint_like", "randn_like", "rrelu", "rrelu_with_noise",
+  };
+  return ops.count(n->kind().toUnqualString()) > 0;
+}
+
+// Constants are kept as long as the graph, so results can't be much larger
+// than what they're computed from
+constexpr int64_t kMaxFoldedGrowth = 1024;
+
+bool isFoldable(Node* n) {
+  if (!n->kind().is_aten() || !n->blocks().empty() || n->outputs().empty() ||
+      isNondeterministic(n))
+    return false;
+  bool has_constant = false;
+  for (auto input : n->inputs()) {
+    auto kind = input->node()->kind();
+    if (kind == prim::Constant) {
+      has_constant = true;
+    } else if (kind != prim::Undefined) {
+      return false;
+    }
+  }
+  for (auto output : n->outputs()) {
+    if (!output->isTensor())
+      return false;
+  }
+  return has_constant;
+}
+
+// The results of running n on its constant inputs, or nullopt if n has no
+// kernel or fails on them, in which case it is left to fail at run time
+at::optional<std::vector<at::Tensor>> evaluate(Node* n) {
+  auto op = findTensorOp(n);
+  if (!op || op->num_outputs != n->outputs().size())
+    return at::nullopt;
+  Stack stack;
+  int64_t input_numel = 0;
+  for (auto input : n->inputs()) {
+    if (input->node()->kind() == prim::Constant) {
+      auto& value = input->node()->t(attr::value);
+      input_numel += value.numel();
+      // the interpreter runs ops on variables too
+      stack.push_back(autograd::make_variable(value, /*requires_grad=*/false));
+    } else {
+      stack.push_back(at::Tensor());
+    }
+  }
+  try {
+    op->op(stack);
+  } catch (std::exception&) {
+    return at::nullopt;
+  }
+  std::vector<at::Tensor> outputs;
+  for (auto& output : stack) {
+    if (!output.defined()) {
+      outputs.emplace_back();
+      continue;
+    }
+    if (output.numel() > std::max(input_numel, kMaxFoldedGrowth))
+      return at::nullopt;
+    outputs.push_back(autograd::as_variable_ref(output).data());
+  }
+  return outputs;
+}
+
+void ConstantPropagation(Block* block) {
+  for (auto it = block->nodes().begin(), end = block->nodes().end(); it != end; ++it) {
+    auto n = *it;
+    for (auto b : n->blocks())
+      ConstantPropagation(b);
+    if (!isFoldable(n))
+      continue;
+    auto outputs = evaluate(n);
+    if (!outputs)
+      continue;
+    auto graph = n->owningGraph();
+    for (size_t i = 0; i < outputs->size(); i++) {
+      auto& output = (*outputs)[i];
+      Node* constant = output.defined() ? graph->createConstant(output) : graph->createUndefined();
+      constant->insertBefore(n);
+      constant->setStage(n->stage());
+      n->outputs()[i]->replaceAllUsesWith(constant->output());
+    }
+    it.destroyCurrent();
+  }
+}
+
+} // anonymous namespace
+
+void ConstantPropagation(std::shared_ptr<Graph>& graph) {
+  ConstantPropagation(graph->block());
+  // the constants that were only used by folded nodes
+  EliminateDeadCode(graph);
+}
+
+}}
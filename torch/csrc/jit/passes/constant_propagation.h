@@ -0,0 +1,15 @@
+#pragma once
+
+#include "torch/csrc/jit/ir.h"
+
+namespace torch { namespace jit {
+
+// Evaluates the deterministic ATen nodes whose inputs are all prim::Constant
+// (or prim::Undefined) once, and replaces their outputs by constants holding
+// the results, e.g. the transposes of constant weights or the arithmetic on
+// the statistics of a batch norm. Results much larger than the inputs they
+// are computed from (an expand of a constant to the batch size) are left to
+// be computed at run time.
+void ConstantPropagation(std::shared_ptr<Graph>& graph);
+
+}}
@@ -0,0 +1,83 @@
+#include "torch/csrc/jit/passes/fold_batch_norm.h"
+
+#include "torch/csrc/jit/interned_strings.h"
+#include "torch/csrc/jit/passes/dead_code_elimination.h"
+#include "torch/csrc/utils/auto_gpu.h"
+
+#include <ATen/ATen.h>
+
+namespace torch { namespace jit {
+
+namespace {
+
+// The value of a prim::Constant, an undefined tensor for a prim::Undefined,
+// and nullopt otherwise
+at::optional<at::Tensor> constantValue(Value* v, bool allow_undefined) {
+  auto n = v->node();
+  if (n->kind() == prim::Constant)
+    return n->t(attr::value);
+  if (allow_undefined && n->kind() == prim::Undefined)
+    return at::Tensor();
+  return at::nullopt;
+}
+
+bool foldIntoConvolution(Node* bn) {
+  if (bn->kind() != aten::batch_norm || bn->inputs().size() != 5 ||
+      !bn->hasAttribute(attr::training) || bn->i(attr::training) != 0)
+    return false;
+  Node* conv = bn->inputs()[0]->node();
+  if (conv->kind() != aten::_convolution || conv->inputs().size() != 3 ||
+      conv->owningBlock() != bn->owningBlock() || conv->output()->uses().size() != 1 ||
+      conv->i(attr::transposed) != 0)
+    return false;
+  auto weight = constantValue(conv->inputs()[1], false);
+  auto bias = constantValue(conv->inputs()[2], true);
+  auto gamma = constantValue(bn->inputs()[1], true);
+  auto beta = constantValue(bn->inputs()[2], true);
+  auto mean = constantValue(bn->inputs()[3], false);
+  auto var = constantValue(bn->inputs()[4], false);
+  if (!weight || !bias || !gamma || !beta || !mean || !var)
+    return false;
+  int64_t channels = weight->size(0);
+  if (mean->numel() != channels || var->numel() != channels)
+    return false;
+
+  AutoGPU guard(*weight);
+  auto scale = (*var + bn->f(attr::eps)).rsqrt();
+  if (gamma->defined())
+    scale = scale * *gamma;
+  std::vector<int64_t> scale_sizes(weight->dim(), 1);
+  scale_sizes[0] = channels;
+  auto new_weight = *weight * scale.view(scale_sizes);
+  auto new_bias = bias->defined() ? (*bias - *mean) * scale : -*mean * scale;
+  if (beta->defined())
+    new_bias = new_bias + *beta;
+
+  auto graph = bn->owningGraph();
+  Node* weight_node = graph->createConstant(new_weight)->insertBefore(conv);
+  Node* bias_node = graph->createConstant(new_bias)->insertBefore(conv);
+  conv->replaceInput(1, weight_node->output());
+  conv->replaceInput(2, bias_node->output());
+  conv->output()->setType(bn->output()->type());
+  bn->output()->replaceAllUsesWith(conv->output());
+  return true;
+}
+
+void FoldConvBatchNorm(Block* block) {
+  for (auto it = block->nodes().begin(), end = block->nodes().end(); it != end; ++it) {
+    for (auto b : it->blocks())
+      FoldConvBatchNorm(b);
+    if (foldIntoConvolution(*it))
+      it.destroyCurrent();
+  }
+}
+
+} // anonymous namespace
+
+void FoldConvBatchNorm(std::shared_ptr<Graph>& graph) {
+  FoldConvBatchNorm(graph->block());
+  // the original weights and statistics
+  EliminateDeadCode(graph);
+}
+
+}}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include "torch/csrc/jit/ir.h"
+
+namespace torch { namespace jit {
+
+// Folds the inference mode batch norms that follow convolutions into them:
+// batch_norm[training=0](_convolution[transposed=0](%x, %w, %b), %gamma,
+// %beta, %mean, %var) with the only use of the convolution in the batch norm
+// and all of %w, %b, %gamma, %beta, %mean and %var prim::Constant (or, for
+// %b, %gamma and %beta, prim::Undefined) becomes _convolution(%x, %w', %b')
+// with the constants
+//   %w' = %w * %gamma / sqrt(%var + eps)   (scaled per output channel)
+//   %b' = (%b - %mean) * %gamma / sqrt(%var + eps) + %beta
+// See Method::freeze_parameters() for turning weights into constants.
+void FoldConvBatchNorm(std::shared_ptr<Graph>& graph);
+
+}}
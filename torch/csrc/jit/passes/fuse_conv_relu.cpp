@@ -0,0 +1,43 @@
+#include "torch/csrc/jit/passes/fuse_conv_relu.h"
+
+#include "torch/csrc/jit/interned_strings.h"
+
+namespace torch { namespace jit {
+
+namespace {
+
+bool fuseIntoConvolution(Node* relu) {
+  if (relu->kind() != aten::relu || relu->inputs().size() != 1)
+    return false;
+  Node* conv = relu->input()->node();
+  if (conv->kind() != aten::_convolution || conv->inputs().size() != 3 ||
+      conv->owningBlock() != relu->owningBlock() || conv->output()->uses().size() != 1)
+    return false;
+  auto graph = relu->owningGraph();
+  Node* fused = graph->create(aten::_convolution_relu, conv->inputs());
+  fused->copyAttributes(*conv);
+  fused->insertBefore(relu);
+  fused->output()->setType(relu->output()->type());
+  relu->output()->replaceAllUsesWith(fused->output());
+  return true;
+}
+
+void FuseConvRelu(Block* block) {
+  for (auto it = block->nodes().begin(), end = block->nodes().end(); it != end; ++it) {
+    for (auto b : it->blocks())
+      FuseConvRelu(b);
+    if (!fuseIntoConvolution(*it))
+      continue;
+    Node* conv = it->input()->node();
+    it.destroyCurrent();
+    conv->destroy();
+  }
+}
+
+} // anonymous namespace
+
+void FuseConvRelu(std::shared_ptr<Graph>& graph) {
+  FuseConvRelu(graph->block());
+}
+
+}}
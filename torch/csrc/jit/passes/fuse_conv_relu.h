@@ -0,0 +1,13 @@
+#pragma once
+
+#include "torch/csrc/jit/ir.h"
+
+namespace torch { namespace jit {
+
+// Replaces relu(_convolution(...)), where the convolution has no other use,
+// by _convolution_relu(...), with the same inputs and attributes, which cuDNN
+// and MKL-DNN run as a single kernel. _convolution_relu has no derivative of
+// its own, so this is only for graphs that don't need gradients.
+void FuseConvRelu(std::shared_ptr<Graph>& graph);
+
+}}
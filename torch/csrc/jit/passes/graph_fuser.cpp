@@ -7,7 +7,8 @@ namespace torch { namespace jit {
 namespace {
 
 // What is a simple mappable operator?  It is:
-//    - Has an output with the same types and sizes of its input
+//    - Has an output with the same types of its input, and inputs that
+//      broadcast to the size of the output
 //    - Single output
 //    - Can handle non-contiguous input
 //    - Produces contiguous output
@@ -70,34 +71,102 @@ std::unordered_set<NodeKind> simple_mappable = {
   aten::_tanh_backward,
 };
 
+// Can a tensor of size from be broadcast to size to?
+bool broadcastsTo(at::IntList from, at::IntList to) {
+  if (from.size() > to.size())
+    return false;
+  size_t offset = to.size() - from.size();
+  for (size_t i = 0; i < from.size(); ++i) {
+    if (from[i] != to[i + offset] && from[i] != 1)
+      return false;
+  }
+  return true;
+}
+
 bool isSimpleMap(Node *node) {
   if(simple_mappable.count(node->kind()) == 0)
     return false;
   if((node->kind() == aten::min || node->kind() == aten::max) && node->inputs().size() == 1)
     return false;
-  // Make sure that the node doesn't broadcast.
+  // Inputs may be broadcast, since fusion groups compute every value for
+  // each element of their output anyway, but the output must not.
   JIT_ASSERT(node->inputs().size() > 0);
-  TensorType* expected_type = node->inputs()[0]->type()->cast<TensorType>();
+  TensorType* expected_type = node->outputs()[0]->type()->cast<TensorType>();
   if (!expected_type)
     return false;
-  static const auto equal_modulo_strides = [](TensorType* expected, const TypePtr& _actual) {
-    TensorType* actual = _actual->cast<TensorType>();
+  static const auto same_kind = [](TensorType* expected, TensorType* actual) {
     return actual &&
            expected->scalarType() == actual->scalarType() &&
-           expected->device() == actual->device() &&
-           expected->sizes() == actual->sizes();
+           expected->device() == actual->device();
   };
   for (Value * val : node->inputs()) {
-    if (!equal_modulo_strides(expected_type, val->type()))
+    TensorType* actual = val->type()->cast<TensorType>();
+    if (!same_kind(expected_type, actual) || !broadcastsTo(actual->sizes(), expected_type->sizes()))
       return false;
   }
   for (Value * val : node->outputs()) {
-    if (!equal_modulo_strides(expected_type, val->type()))
+    TensorType* actual = val->type()->cast<TensorType>();
+    if (!same_kind(expected_type, actual) || actual->sizes() != expected_type->sizes())
       return false;
   }
   return true;
 }
 
+// Explicit broadcasts (which shape analysis inserts for pointwise ops) are
+// free inside a fusion group.
+bool isBroadcast(Node *node) {
+  if (node->kind() != aten::expand || node->inputs().size() != 1 ||
+      !node->hasAttribute(attr::size) || node->kindOf(attr::size) != AttributeKind::is)
+    return false;
+  auto input_type = node->input()->type()->cast<TensorType>();
+  auto output_type = node->output()->type()->cast<TensorType>();
+  // the fusion compiler takes the size of the outputs from the attribute
+  auto & sizes = node->is(attr::size);
+  return input_type && output_type &&
+         std::none_of(sizes.begin(), sizes.end(), [](int64_t s) { return s < 0; }) &&
+         output_type->sizes() == sizes &&
+         broadcastsTo(input_type->sizes(), sizes);
+}
+
+bool isSoftmax(Node *node) {
+  return node->kind() == aten::softmax || node->kind() == aten::log_softmax;
+}
+
+// Reductions over the innermost dimension, which fusion groups compute one
+// row at a time (see the comment on reductions in fusion_compiler.cpp). sum
+// and mean must keep the reduced dimension, so that their result broadcasts
+// against the rest of the group. softmax and log_softmax count as well,
+// since they reduce along the dimension before mapping over it.
+bool isInnermostReduction(Node *node) {
+  bool is_sum = node->kind() == aten::sum || node->kind() == aten::mean;
+  bool is_softmax = isSoftmax(node);
+  if ((!is_sum && !is_softmax) || node->inputs().size() != 1 || node->outputs().size() != 1)
+    return false;
+  auto input_type = node->input()->type()->cast<TensorType>();
+  if (!input_type || input_type->sizes().empty())
+    return false;
+  int64_t ndim = input_type->sizes().size();
+  int64_t dim;
+  if (!node->hasAttribute(attr::dim))
+    return false;
+  if (node->kindOf(attr::dim) == AttributeKind::i) {
+    dim = node->i(attr::dim);
+  } else if (node->kindOf(attr::dim) == AttributeKind::is && node->is(attr::dim).size() == 1) {
+    dim = node->is(attr::dim)[0];
+  } else {
+    return false;
+  }
+  if (dim != -1 && dim != ndim - 1)
+    return false;
+  if (is_sum) {
+    // nothing but dim and keepdim, e.g. no dtype
+    auto names = node->attributeNames();
+    return names.size() == 2 && node->hasAttribute(attr::keepdim) &&
+           node->kindOf(attr::keepdim) == AttributeKind::i && node->i(attr::keepdim);
+  }
+  return node->attributeNames().size() == 1;
+}
+
 struct GraphFuser {
   Block * block;
 
@@ -142,7 +211,32 @@ struct GraphFuser {
   bool isFusable(Node * node) {
     if (node->owningBlock() != block) return false;
     if (node->kind() == prim::FusionGroup) return true;
-    return isSimpleMap(node) && allFloatIO(node);
+    return (isSimpleMap(node) || (isSoftmax(node) && isInnermostReduction(node))) &&
+      allFloatIO(node);
+  }
+  // Nodes that can be put into an existing fusion group, but never start one
+  // or become one of its outputs: broadcasts, which would be materialized,
+  // and sums, which don't have the size of the map.
+  bool isFusableIntoGroup(Node * node) {
+    if (node->owningBlock() != block) return false;
+    return (isBroadcast(node) || (!isSoftmax(node) && isInnermostReduction(node))) &&
+      allFloatIO(node);
+  }
+  bool hasReductions(Node * group) {
+    for (auto n : getSubgraph(group).nodes()) {
+      if (n->kind() == aten::sum || n->kind() == aten::mean || isSoftmax(n))
+        return true;
+    }
+    return false;
+  }
+  // The size of all outputs of a fusion group (or of the fusion group that node
+  // would become), except concatenated ones, which are made of tensors of
+  // this size.
+  std::vector<int64_t> mapSize(Node * node) {
+    Value * v = node->kind() == prim::FusionGroup ? getSubgraph(node).outputs()[0] : node->output();
+    if (v->node()->kind() == aten::cat)
+      v = v->node()->inputs()[0];
+    return v->type()->expect<TensorType>()->sizes();
   }
 
   bool allOutputsHaveSameSize(Node * node) {
@@ -209,10 +303,27 @@ struct GraphFuser {
     // we can move the consumer up into the producer.
     // but this requires better handling of merging fusion groups so it is not done now
     int consumer_device = getDevice(consumer);
-    return isFusable(producer->node()) &&
-      allUsersAreThisConsumerOrOccurAfterIt(consumer, producer) &&
-      consumer_device == getDevice(producer->node()) &&
-      (consumer_device != kCPUDevice || sharedFusionCompiler().canCompileOnCPU());
+    Node * producer_node = producer->node();
+    bool into_group_only = isFusableIntoGroup(producer_node);
+    if (!(isFusable(producer_node) || into_group_only) ||
+        consumer_device != getDevice(producer_node) ||
+        (consumer_device == kCPUDevice && !sharedFusionCompiler().canCompileOnCPU()))
+      return false;
+    // All outputs of a fusion group have the size of its map, and reductions
+    // happen along its innermost dimension.
+    auto map_size = mapSize(consumer);
+    if (isInnermostReduction(producer_node) &&
+        producer_node->input()->type()->expect<TensorType>()->sizes() != map_size)
+      return false;
+    bool same_map = producer_node->kind() == prim::FusionGroup ?
+      mapSize(producer_node) == map_size :
+      producer->type()->expect<TensorType>()->sizes() == map_size;
+    if (producer_node->kind() == prim::FusionGroup && hasReductions(producer_node) && !same_map)
+      return false;
+    // Only values that can become outputs of the group may have uses after it.
+    if (into_group_only || !same_map)
+      return allUsersAreThisConsumer(consumer, producer);
+    return allUsersAreThisConsumerOrOccurAfterIt(consumer, producer);
   }
 
   // insert a producer node into a consuming fusion group.
@@ -410,6 +521,15 @@ struct GraphFuser {
     // multiple return operators
     Node * producer_for_chunk_node = producer_for_chunk->node();
     JIT_ASSERT(producer_for_chunk_node->outputs().size() == 1);
+    // softmax depends on the whole row, which chunking may split
+    if (isSoftmax(producer_for_chunk_node))
+      return false;
+    // the operands get chunked like the result, which is wrong for broadcast ones
+    for (auto input : producer_for_chunk_node->inputs()) {
+      if (input->type()->expect<TensorType>()->sizes() !=
+          producer_for_chunk->type()->expect<TensorType>()->sizes())
+        return false;
+    }
     // Make sure we lay out the nodes in the correct topological order.
     // TODO: There should be some more enshrined way to do this
     Node * insertion_point = chunk;
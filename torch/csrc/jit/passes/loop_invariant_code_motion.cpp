@@ -0,0 +1,55 @@
+#include "torch/csrc/jit/passes/loop_invariant_code_motion.h"
+
+#include "torch/csrc/jit/interned_strings.h"
+
+#include <unordered_set>
+
+namespace torch { namespace jit {
+
+namespace {
+
+// Hoisting one of these would reuse a single draw of its random numbers
+bool isNondeterministic(Node* n) {
+  static const std::unordered_set<std::string> ops = {
+    "alpha_dropout", "bernoulli", "dropout", "feature_alpha_dropout",
+    "feature_dropout", "multinomial", "normal", "poisson", "rand_like",
+    "randint_like", "randn_like", "rrelu", "rrelu_with_noise",
+  };
+  return ops.count(n->kind().toUnqualString()) > 0;
+}
+
+bool isInvariant(Node* n, Block* body) {
+  if (n->kind() != prim::Constant &&
+      (!n->kind().is_aten() || !n->blocks().empty() || isNondeterministic(n)))
+    return false;
+  for (auto input : n->inputs()) {
+    // the body inputs count as defined in the body
+    if (input->node()->owningBlock() == body)
+      return false;
+  }
+  return true;
+}
+
+void HoistLoopInvariants(Block* block) {
+  for (auto it = block->nodes().begin(), end = block->nodes().end(); it != end;) {
+    Node* n = *it++;
+    for (auto b : n->blocks())
+      HoistLoopInvariants(b);
+    if (n->kind() != prim::Loop)
+      continue;
+    Block* body = n->blocks()[0];
+    for (auto body_it = body->nodes().begin(), body_end = body->nodes().end(); body_it != body_end;) {
+      Node* candidate = *body_it++;
+      if (isInvariant(candidate, body))
+        candidate->moveBefore(n);
+    }
+  }
+}
+
+} // anonymous namespace
+
+void HoistLoopInvariants(std::shared_ptr<Graph>& graph) {
+  HoistLoopInvariants(graph->block());
+}
+
+}}
@@ -0,0 +1,15 @@
+#pragma once
+
+#include "torch/csrc/jit/ir.h"
+
+namespace torch { namespace jit {
+
+// Moves the nodes of a prim::Loop body that compute the same value on every
+// iteration (deterministic ATen ops and constants whose inputs are all
+// defined outside of the loop) in front of the loop, innermost loops first,
+// so that e.g. a projection of the encoder output in a decoding loop is
+// computed once. Nodes in the blocks of a prim::If stay where they are. A
+// hoisted node runs even if the loop runs zero times.
+void HoistLoopInvariants(std::shared_ptr<Graph>& graph);
+
+}}
@@ -0,0 +1,96 @@
+#include "torch/csrc/jit/passes/loop_unrolling.h"
+
+#include "torch/csrc/jit/interned_strings.h"
+
+#include <ATen/ATen.h>
+
+#include <unordered_map>
+
+namespace torch { namespace jit {
+
+namespace {
+
+// The value of a 1-element prim::Constant, or nullopt
+at::optional<int64_t> constantInt(Value* v) {
+  Node* n = v->node();
+  if (n->kind() != prim::Constant || n->t(attr::value).numel() != 1)
+    return at::nullopt;
+  return n->t(attr::value).toCLong();
+}
+
+size_t countNodes(Block* block) {
+  size_t count = 0;
+  for (auto n : block->nodes()) {
+    count++;
+    for (auto b : n->blocks())
+      count += countNodes(b);
+  }
+  return count;
+}
+
+// The number of iterations of a loop that runs a fixed number of times, or
+// nullopt
+at::optional<int64_t> constantTripCount(Node* loop) {
+  Block* body = loop->blocks()[0];
+  auto max_trip_count = constantInt(loop->inputs()[0]);
+  auto start_condition = constantInt(loop->inputs()[1]);
+  auto continue_condition = constantInt(body->outputs()[0]);
+  if (!max_trip_count || !start_condition || !continue_condition || *continue_condition == 0)
+    return at::nullopt;
+  if (*start_condition == 0)
+    return 0;
+  return std::max<int64_t>(*max_trip_count, 0);
+}
+
+void unroll(Node* loop, int64_t trip_count) {
+  auto graph = loop->owningGraph();
+  Block* body = loop->blocks()[0];
+  // loop inputs: max trip count, start condition, loop-carried values
+  std::vector<Value*> carried(loop->inputs().begin() + 2, loop->inputs().end());
+  WithInsertPoint guard(loop);
+  for (int64_t i = 0; i < trip_count; i++) {
+    // body inputs: loop counter, loop-carried values
+    std::unordered_map<Value*, Value*> value_map;
+    auto counter = at::CPU(at::kLong).tensor({1}).fill_(i);
+    value_map[body->inputs()[0]] = graph->insertNode(graph->createConstant(counter))->output();
+    for (size_t j = 0; j < carried.size(); j++)
+      value_map[body->inputs()[j + 1]] = carried[j];
+    auto value_map_func = [&](Value* v) {
+      auto it = value_map.find(v);
+      return it == value_map.end() ? v : it->second;
+    };
+    for (auto n : body->nodes()) {
+      Node* copy = graph->insertNode(graph->createClone(n, value_map_func));
+      for (size_t j = 0; j < n->outputs().size(); j++)
+        value_map[n->outputs()[j]] = copy->outputs()[j];
+    }
+    // body outputs: continue condition, loop-carried values
+    for (size_t j = 0; j < carried.size(); j++)
+      carried[j] = value_map_func(body->outputs()[j + 1]);
+  }
+  for (size_t j = 0; j < carried.size(); j++)
+    loop->outputs()[j]->replaceAllUsesWith(carried[j]);
+}
+
+void UnrollLoops(Block* block) {
+  for (auto it = block->nodes().begin(), end = block->nodes().end(); it != end; ++it) {
+    for (auto b : it->blocks())
+      UnrollLoops(b);
+    if (it->kind() != prim::Loop)
+      continue;
+    auto trip_count = constantTripCount(*it);
+    if (!trip_count ||
+        static_cast<size_t>(*trip_count) * countNodes(it->blocks()[0]) > kMaxUnrolledNodes)
+      continue;
+    unroll(*it, *trip_count);
+    it.destroyCurrent();
+  }
+}
+
+} // anonymous namespace
+
+void UnrollLoops(std::shared_ptr<Graph>& graph) {
+  UnrollLoops(graph->block());
+}
+
+}}
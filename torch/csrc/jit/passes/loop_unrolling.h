@@ -0,0 +1,17 @@
+#pragma once
+
+#include "torch/csrc/jit/ir.h"
+
+namespace torch { namespace jit {
+
+// Replaces the prim::Loops with a constant trip count and constant true
+// conditions (for i in range(<constant>)) by that many copies of their body,
+// with the loop counter a constant in each, when the copies take at most
+// kMaxUnrolledNodes nodes. This gives the fuser and the other passes longer
+// straight-line regions to work on. Run HoistLoopInvariants first, so that
+// the invariant nodes are not copied.
+constexpr size_t kMaxUnrolledNodes = 256;
+
+void UnrollLoops(std::shared_ptr<Graph>& graph);
+
+}}
@@ -1,5 +1,6 @@
 #include "torch/csrc/utils/pybind.h"
 #include "torch/csrc/jit/passes/onnx.h"
+#include "torch/csrc/jit/passes/onnx/native_symbolic.h"
 #include "torch/csrc/autograd/function.h"
 #include "torch/csrc/autograd/symbolic.h"
 #include "torch/csrc/utils/functional.h"
@@ -151,6 +152,26 @@ void BlockToONNX(Block* old_block, Block* new_block, bool aten, std::unordered_m
     processSymbolicOutput(n->kind().toUnqualString(), n, raw_output);
   };
 
+  // Returns false if the node has to go through Python after all
+  auto callNativeSymbolic = [&](Node* n) {
+    if (aten) {
+      return false;
+    }
+    if (n->kind().is_onnx()) {
+      cloneNode(n);
+      return true;
+    }
+    auto inputs = fmap(n->inputs(), envFn);
+    value_list outputs;
+    WithInsertPoint insert_point_guard(ctx.block);
+    WithCurrentScope scope_guard(*ctx.block->owningGraph(), n->scope());
+    if (!runNativeSymbolic(*ctx.block->owningGraph(), n, inputs, outputs)) {
+      return false;
+    }
+    setOutputs(n->kind().toUnqualString(), n, outputs);
+    return true;
+  };
+
   auto callPySymbolicMethod = [&](PythonOp* op) {
 
     // Test if there is a symbolic function; bail if there is not
@@ -213,7 +234,9 @@ void BlockToONNX(Block* old_block, Block* new_block, bool aten, std::unordered_m
     IR_ELSEIFM(PythonOp)
       callPySymbolicMethod(value);
     IR_ELSE()
-      callPySymbolicFunction(node);
+      if (!callNativeSymbolic(node)) {
+        callPySymbolicFunction(node);
+      }
     IR_END()
   }
   for (auto output : old_block->outputs()) {
@@ -0,0 +1,98 @@
+#include "torch/csrc/jit/passes/onnx/native_symbolic.h"
+
+#include <ATen/ATen.h>
+
+#include <algorithm>
+#include <unordered_map>
+
+namespace torch { namespace jit {
+
+namespace {
+
+bool isScalar(Node* n, Symbol name, double value) {
+  return n->hasAttribute(name) && n->kindOf(name) == AttributeKind::t &&
+         at::Scalar(n->t(name)).toDouble() == value;
+}
+
+bool hasOnlyAttributes(Node* n, std::initializer_list<Symbol> names) {
+  for (auto name : n->attributeNames()) {
+    if (std::find(names.begin(), names.end(), name) == names.end()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// ATen ops of one or two tensors that map to a single ONNX op
+const std::unordered_map<Symbol, Symbol>& simpleSymbolics() {
+  static std::unordered_map<Symbol, Symbol> symbolics {
+    {aten::add, onnx::Add},
+    {aten::sub, onnx::Sub},
+    {aten::mul, onnx::Mul},
+    {aten::div, onnx::Div},
+    {aten::matmul, onnx::MatMul},
+    {aten::bmm, onnx::MatMul},
+    {aten::relu, onnx::Relu},
+    {aten::sigmoid, onnx::Sigmoid},
+    {aten::tanh, onnx::Tanh},
+    {aten::neg, onnx::Neg},
+    {aten::sqrt, onnx::Sqrt},
+    {aten::exp, onnx::Exp},
+    {aten::abs, onnx::Abs},
+  };
+  return symbolics;
+}
+
+size_t numTensorInputs(Symbol onnx_kind) {
+  if (onnx_kind == onnx::Add || onnx_kind == onnx::Sub || onnx_kind == onnx::Mul ||
+      onnx_kind == onnx::Div || onnx_kind == onnx::MatMul) {
+    return 2;
+  }
+  return 1;
+}
+
+} // anonymous namespace
+
+bool runNativeSymbolic(Graph& graph, Node* n, ArrayRef<Value*> inputs, value_list& outputs) {
+  if (n->outputs().size() != 1) {
+    return false;
+  }
+  auto kind = n->kind();
+  Node* node = nullptr;
+  if (kind == prim::Constant) {
+    node = graph.create(onnx::Constant);
+    node->t_(attr::value, n->t(attr::value));
+  } else if (kind == aten::t) {
+    if (inputs.size() != 1 || n->hasAttributes()) {
+      return false;
+    }
+    node = graph.create(onnx::Transpose, inputs);
+    node->is_(attr::perm, {1, 0});
+  } else if (kind == aten::threshold) {
+    // Only the form that is a relu
+    if (inputs.size() != 1 || !hasOnlyAttributes(n, {attr::threshold, attr::value}) ||
+        !isScalar(n, attr::threshold, 0) || !isScalar(n, attr::value, 0)) {
+      return false;
+    }
+    node = graph.create(onnx::Relu, inputs);
+  } else {
+    auto it = simpleSymbolics().find(kind);
+    if (it == simpleSymbolics().end() || inputs.size() != numTensorInputs(it->second)) {
+      return false;
+    }
+    // add and sub take an alpha, which ONNX has no counterpart for
+    if (kind == aten::add || kind == aten::sub) {
+      if (!hasOnlyAttributes(n, {attr::alpha}) || !isScalar(n, attr::alpha, 1)) {
+        return false;
+      }
+    } else if (n->hasAttributes()) {
+      return false;
+    }
+    node = graph.create(it->second, inputs);
+  }
+  graph.insertNode(node);
+  outputs = {node->output()};
+  return true;
+}
+
+}}
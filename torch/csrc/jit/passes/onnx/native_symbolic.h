@@ -0,0 +1,13 @@
+#include "torch/csrc/jit/ir.h"
+
+namespace torch { namespace jit {
+
+// Symbolics for common ATen and prim nodes, written in C++ so that exporting
+// them does not call into torch.onnx.symbolic. Appends the ONNX nodes n maps
+// to at the insertion point of graph, with inputs the values n's inputs map
+// to, and sets outputs to their outputs. Returns false, without touching the
+// graph, for nodes or forms it does not cover (e.g. pointwise ops with a
+// scalar argument), which are then left to Python.
+bool runNativeSymbolic(Graph& graph, Node* n, ArrayRef<Value*> inputs, value_list& outputs);
+
+}}
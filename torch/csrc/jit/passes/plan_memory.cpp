@@ -0,0 +1,330 @@
+#include "torch/csrc/jit/passes/plan_memory.h"
+
+#include "torch/csrc/jit/fusion_compiler.h"
+
+#include <ATen/ATen.h>
+#include <algorithm>
+#include <limits>
+#include <map>
+#include <unordered_map>
+
+namespace torch { namespace jit {
+
+// This pass is a static version of what Caffe2's memonger does for nets.
+// After shape analysis the size of every intermediate is known, so we can
+// compute when each one is alive and give tensors whose lifetimes don't overlap
+// the same memory:
+//
+//   %1 = mm(%x, %w)       arena: [ %1 ][ %2 ]
+//   %2 = tanh(%1)                 [ %3 ]
+//   %3 = mm(%2, %v)         (%1 is dead once %2 is computed, so %3 reuses it)
+//
+// Only outputs of nodes with an out= variant are planned. Every other node may
+// return a view of one of its inputs, so its outputs are treated as aliases of
+// all of its inputs; a planned tensor stays alive until the last use of any of
+// its aliases, and is not planned at all if an alias is a graph output.
+
+namespace {
+
+// the attributes of n other than the ones added by PlanMemory are exactly names
+bool hasAttributes(Node* n, std::vector<Symbol> names) {
+  std::vector<Symbol> actual;
+  for(auto name : n->attributeNames()) {
+    if(name != attr::arena_offsets)
+      actual.push_back(name);
+  }
+  std::sort(actual.begin(), actual.end());
+  std::sort(names.begin(), names.end());
+  return actual == names;
+}
+
+OutOperation findOutOperation(Node* n, size_t num_inputs) {
+  auto unary = [&](at::Tensor& (*fn)(at::Tensor&, const at::Tensor&)) -> OutOperation {
+    if(num_inputs != 1 || !hasAttributes(n, {}))
+      return nullptr;
+    return [fn](at::ArrayRef<at::Tensor> inputs, std::vector<at::Tensor>& outputs) {
+      fn(outputs[0], inputs[0]);
+    };
+  };
+  switch(n->kind()) {
+    case aten::add:
+    case aten::sub: {
+      bool is_add = n->kind() == aten::add;
+      if(num_inputs == 2 && hasAttributes(n, {attr::alpha})) {
+        at::Scalar alpha(n->t(attr::alpha));
+        return [is_add, alpha](at::ArrayRef<at::Tensor> inputs, std::vector<at::Tensor>& outputs) {
+          if(is_add)
+            at::add_out(outputs[0], inputs[0], inputs[1], alpha);
+          else
+            at::sub_out(outputs[0], inputs[0], inputs[1], alpha);
+        };
+      }
+      if(num_inputs == 1 && hasAttributes(n, {attr::other, attr::alpha})) {
+        at::Scalar other(n->t(attr::other)), alpha(n->t(attr::alpha));
+        return [is_add, other, alpha](at::ArrayRef<at::Tensor> inputs, std::vector<at::Tensor>& outputs) {
+          if(is_add)
+            at::add_out(outputs[0], inputs[0], other, alpha);
+          else
+            at::sub_out(outputs[0], inputs[0], other, alpha);
+        };
+      }
+      return nullptr;
+    }
+    case aten::mul:
+    case aten::div: {
+      bool is_mul = n->kind() == aten::mul;
+      if(num_inputs == 2 && hasAttributes(n, {})) {
+        return [is_mul](at::ArrayRef<at::Tensor> inputs, std::vector<at::Tensor>& outputs) {
+          if(is_mul)
+            at::mul_out(outputs[0], inputs[0], inputs[1]);
+          else
+            at::div_out(outputs[0], inputs[0], inputs[1]);
+        };
+      }
+      if(num_inputs == 1 && hasAttributes(n, {attr::other})) {
+        at::Scalar other(n->t(attr::other));
+        return [is_mul, other](at::ArrayRef<at::Tensor> inputs, std::vector<at::Tensor>& outputs) {
+          if(is_mul)
+            at::mul_out(outputs[0], inputs[0], other);
+          else
+            at::div_out(outputs[0], inputs[0], other);
+        };
+      }
+      return nullptr;
+    }
+    case aten::mm:
+      if(num_inputs != 2 || !hasAttributes(n, {}))
+        return nullptr;
+      return [](at::ArrayRef<at::Tensor> inputs, std::vector<at::Tensor>& outputs) {
+        at::mm_out(outputs[0], inputs[0], inputs[1]);
+      };
+    case aten::addmm: {
+      if(num_inputs != 3 || !hasAttributes(n, {attr::beta, attr::alpha}))
+        return nullptr;
+      at::Scalar beta(n->t(attr::beta)), alpha(n->t(attr::alpha));
+      return [beta, alpha](at::ArrayRef<at::Tensor> inputs, std::vector<at::Tensor>& outputs) {
+        at::addmm_out(outputs[0], inputs[0], inputs[1], inputs[2], beta, alpha);
+      };
+    }
+    case aten::threshold: {
+      if(num_inputs != 1 || !hasAttributes(n, {attr::threshold, attr::value}))
+        return nullptr;
+      at::Scalar threshold(n->t(attr::threshold)), value(n->t(attr::value));
+      return [threshold, value](at::ArrayRef<at::Tensor> inputs, std::vector<at::Tensor>& outputs) {
+        at::threshold_out(outputs[0], inputs[0], threshold, value);
+      };
+    }
+    case aten::cat: {
+      if(num_inputs == 0 || !hasAttributes(n, {attr::dim}))
+        return nullptr;
+      int64_t dim = n->i(attr::dim);
+      return [dim](at::ArrayRef<at::Tensor> inputs, std::vector<at::Tensor>& outputs) {
+        at::cat_out(outputs[0], inputs, dim);
+      };
+    }
+    case aten::sigmoid: return unary(at::sigmoid_out);
+    case aten::tanh: return unary(at::tanh_out);
+    case aten::exp: return unary(at::exp_out);
+    case aten::log: return unary(at::log_out);
+    case aten::neg: return unary(at::neg_out);
+    case prim::FusionGroup: {
+      auto fusion_fn = sharedFusionCompiler().getOrCompile(n);
+      return [fusion_fn](at::ArrayRef<at::Tensor> inputs, std::vector<at::Tensor>& outputs) {
+        fusion_fn->launch_with_tensors(inputs, outputs);
+      };
+    }
+    default:
+      return nullptr;
+  }
+}
+
+// An output can live in an arena if its size is known and its strides are
+// the contiguous ones that a fresh slice of the arena has.
+TensorType* plannableType(Value* v) {
+  auto type = v->type()->cast<TensorType>();
+  if(!type)
+    return nullptr;
+  auto contiguous = type->contiguous()->expect<TensorType>();
+  if(type->strides() != contiguous->strides())
+    return nullptr;
+  if(std::find(type->sizes().begin(), type->sizes().end(), 0) != type->sizes().end())
+    return nullptr;
+  return type;
+}
+
+int64_t numel(TensorType* type) {
+  int64_t n = 1;
+  for(auto s : type->sizes())
+    n *= s;
+  return n;
+}
+
+struct Slot {
+  Value* value;
+  size_t begin; // index of the defining node
+  size_t end; // index of the last use of any alias
+  int64_t size;
+  int64_t offset;
+};
+
+// Greedy offset assignment: place the largest slots first, each at the lowest
+// offset that doesn't collide with an already placed slot alive at the same
+// time. Returns the size of the arena.
+int64_t assignOffsets(std::vector<Slot>& slots, int64_t alignment) {
+  std::sort(slots.begin(), slots.end(), [](const Slot& a, const Slot& b) {
+    return a.size > b.size || (a.size == b.size && a.begin < b.begin);
+  });
+  int64_t total = 0;
+  for(size_t i = 0; i < slots.size(); ++i) {
+    std::vector<const Slot*> live;
+    for(size_t j = 0; j < i; ++j) {
+      if(slots[j].begin <= slots[i].end && slots[i].begin <= slots[j].end)
+        live.push_back(&slots[j]);
+    }
+    std::sort(live.begin(), live.end(), [](const Slot* a, const Slot* b) {
+      return a->offset < b->offset;
+    });
+    int64_t offset = 0;
+    for(auto other : live) {
+      if(offset + slots[i].size <= other->offset)
+        break;
+      offset = std::max(offset, other->offset + other->size);
+      offset = (offset + alignment - 1) / alignment * alignment;
+    }
+    slots[i].offset = offset;
+    total = std::max(total, offset + slots[i].size);
+  }
+  return total;
+}
+
+} // anonymous namespace
+
+void PlanMemory(std::shared_ptr<Graph>& graph) {
+  if(graph->stage() != 0)
+    return;
+  for(auto n : graph->nodes()) {
+    if(!n->blocks().empty())
+      return;
+  }
+
+  // union-find over values; see the comment at the top of the file
+  std::unordered_map<Value*, Value*> alias_parent;
+  std::function<Value*(Value*)> findAlias = [&](Value* v) -> Value* {
+    auto it = alias_parent.find(v);
+    if(it == alias_parent.end() || it->second == v)
+      return v;
+    return it->second = findAlias(it->second);
+  };
+  auto unionAlias = [&](Value* a, Value* b) {
+    a = findAlias(a);
+    b = findAlias(b);
+    if(a != b)
+      alias_parent[a] = b;
+  };
+
+  std::unordered_map<Node*, size_t> index;
+  std::vector<Node*> planned;
+  for(auto n : graph->nodes()) {
+    size_t i = index.size();
+    index[n] = i;
+    bool plannable = n->outputs().size() > 0 && findOutOperation(n, n->inputs().size()) != nullptr;
+    TensorType* first = nullptr;
+    for(auto output : n->outputs()) {
+      auto type = plannableType(output);
+      plannable &= type != nullptr;
+      if(!type)
+        break;
+      if(!first)
+        first = type;
+      plannable &= type->scalarType() == first->scalarType() && type->device() == first->device();
+    }
+    if(plannable) {
+      planned.push_back(n);
+    } else {
+      for(auto output : n->outputs()) {
+        for(auto input : n->inputs())
+          unionAlias(output, input);
+      }
+    }
+  }
+  if(planned.empty())
+    return;
+
+  // lifetime of every alias class
+  std::unordered_map<Value*, size_t> alias_end;
+  auto noteUses = [&](Value* v) {
+    auto root = findAlias(v);
+    auto & end = alias_end[root];
+    for(auto & use : v->uses()) {
+      if(use.user == graph->return_node())
+        end = std::numeric_limits<size_t>::max();
+      else
+        end = std::max(end, index.at(use.user));
+    }
+  };
+  for(auto n : graph->nodes()) {
+    for(auto output : n->outputs())
+      noteUses(output);
+  }
+  for(auto input : graph->inputs())
+    noteUses(input);
+
+  // one arena per scalar type and device
+  std::map<std::pair<int, int>, std::vector<Slot>> arenas;
+  std::vector<Node*> rewritten;
+  for(auto n : planned) {
+    bool escapes = false;
+    for(auto output : n->outputs())
+      escapes |= alias_end[findAlias(output)] == std::numeric_limits<size_t>::max();
+    if(escapes)
+      continue;
+    auto type = n->outputs()[0]->type()->expect<TensorType>();
+    auto & slots = arenas[std::make_pair(static_cast<int>(type->scalarType()), type->device())];
+    for(auto output : n->outputs()) {
+      size_t begin = index.at(n);
+      size_t end = std::max(begin, alias_end[findAlias(output)]);
+      slots.push_back(Slot {output, begin, end, numel(output->type()->expect<TensorType>()), 0});
+    }
+    rewritten.push_back(n);
+  }
+
+  std::unordered_map<Value*, Value*> arena_for;
+  std::unordered_map<Value*, int64_t> offset_for;
+  for(auto & entry : arenas) {
+    auto scalar_type = static_cast<at::ScalarType>(entry.first.first);
+    int device = entry.first.second;
+    auto & slots = entry.second;
+    // keep slices 64-byte aligned for vectorized kernels
+    int64_t element_size = at::globalContext().getType(at::Backend::CPU, scalar_type).elementSizeInBytes();
+    int64_t alignment = std::max<int64_t>(1, 64 / element_size);
+    int64_t size = assignOffsets(slots, alignment);
+    auto arena = graph->prependNode(graph->create(prim::MemoryArena, 1));
+    arena->output()->setType(std::make_shared<TensorType>(scalar_type, device, at::IntList(size)));
+    for(auto & slot : slots) {
+      arena_for[slot.value] = arena->output();
+      offset_for[slot.value] = slot.offset;
+    }
+  }
+  for(auto n : rewritten) {
+    std::vector<int64_t> offsets;
+    for(auto output : n->outputs())
+      offsets.push_back(offset_for.at(output));
+    n->addInput(arena_for.at(n->outputs()[0]));
+    n->is_(attr::arena_offsets, std::move(offsets));
+  }
+}
+
+OutOperation getOutOperation(Node* planned) {
+  JIT_ASSERT(planned->hasAttribute(attr::arena_offsets));
+  auto op = findOutOperation(planned, planned->inputs().size() - 1);
+  JIT_ASSERT(op);
+  return op;
+}
+
+OutOperation tryGetOutOperation(Node* n) {
+  if(n->hasAttribute(attr::arena_offsets))
+    return getOutOperation(n);
+  return findOutOperation(n, n->inputs().size());
+}
+
+}}
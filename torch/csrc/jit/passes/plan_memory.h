@@ -0,0 +1,30 @@
+#pragma once
+
+#include "torch/csrc/jit/ir.h"
+
+#include <functional>
+
+namespace torch { namespace jit {
+
+// Assigns the intermediate tensors of a shape-specialized graph to slices of
+// one arena per scalar type and device, so that a run allocates each arena
+// once instead of allocating every intermediate separately.
+//
+// The arenas become prim::MemoryArena nodes at the start of the graph. A
+// planned node gets its arena as an extra last input and the element offsets
+// of its outputs as attr::arena_offsets, and the interpreter runs it through
+// its out= variant (see getOutOperation) writing into those slices.
+// Graphs with blocks or several stages are left alone.
+void PlanMemory(std::shared_ptr<Graph>& graph);
+
+// Writes the results of a node into preallocated outputs.
+using OutOperation = std::function<void(at::ArrayRef<at::Tensor> inputs, std::vector<at::Tensor>& outputs)>;
+
+// The out= variant of a node rewritten by PlanMemory; inputs exclude the arena.
+OutOperation getOutOperation(Node* planned);
+
+// The out= variant of any node, as getOutOperation for planned nodes, or
+// nullptr if the node has none.
+OutOperation tryGetOutOperation(Node* n);
+
+}}
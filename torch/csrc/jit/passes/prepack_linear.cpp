@@ -0,0 +1,67 @@
+#include "torch/csrc/jit/passes/prepack_linear.h"
+
+#include "torch/csrc/jit/passes/dead_code_elimination.h"
+#include "torch/csrc/jit/interned_strings.h"
+
+#include <ATen/ATen.h>
+
+namespace torch { namespace jit {
+
+namespace {
+
+bool isOne(Node* n, Symbol name) {
+  return n->hasAttribute(name) && n->kindOf(name) == AttributeKind::t &&
+         at::Scalar(n->t(name)).toDouble() == 1;
+}
+
+// The constant weight w of addmm(%bias, %x, t(%w)), or nullptr
+Node* linearWeight(Node* n) {
+  if (n->kind() != aten::addmm || n->inputs().size() != 3 || n->outputs().size() != 1 ||
+      n->attributeNames().size() != 2 || !isOne(n, attr::beta) || !isOne(n, attr::alpha))
+    return nullptr;
+  Node* t = n->inputs()[2]->node();
+  if (t->kind() != aten::t || t->inputs().size() != 1)
+    return nullptr;
+  Node* w = t->input()->node();
+  if (w->kind() != prim::Constant || !w->hasAttribute(attr::value))
+    return nullptr;
+  auto x_type = n->inputs()[1]->type()->cast<TensorType>();
+  const auto& weight = w->t(attr::value);
+  if (!x_type || x_type->device() != -1 || x_type->sizes().size() != 2 ||
+      weight.type().is_cuda() || weight.dim() != 2 ||
+      x_type->scalarType() != weight.type().scalarType() ||
+      x_type->sizes()[0] == 0 || x_type->sizes()[1] != weight.size(1))
+    return nullptr;
+  return w;
+}
+
+void PrepackLinear(Block* block) {
+  for (auto it = block->nodes().begin(), end = block->nodes().end(); it != end; ++it) {
+    auto n = *it;
+    for (auto b : n->blocks())
+      PrepackLinear(b);
+    Node* w = linearWeight(n);
+    if (!w)
+      continue;
+    auto graph = n->owningGraph();
+    int64_t batch_size = n->inputs()[1]->type()->expect<TensorType>()->sizes()[0];
+    Node* packed = graph->createConstant(at::_linear_prepack(w->t(attr::value), batch_size));
+    packed->insertBefore(n);
+    Node* linear = graph->create(aten::_linear_packed,
+                                 {n->inputs()[1], packed->output(), n->inputs()[0]});
+    linear->insertBefore(n);
+    linear->output()->setType(n->output()->type());
+    n->output()->replaceAllUsesWith(linear->output());
+    it.destroyCurrent();
+  }
+}
+
+} // anonymous namespace
+
+void PrepackLinear(std::shared_ptr<Graph>& graph) {
+  PrepackLinear(graph->block());
+  // the transposes and the unpacked weights are usually dead now
+  EliminateDeadCode(graph);
+}
+
+}}
@@ -0,0 +1,14 @@
+#pragma once
+
+#include "torch/csrc/jit/ir.h"
+
+namespace torch { namespace jit {
+
+// Freezes the constant weights of linear layers of a shape-specialized graph:
+// addmm[beta=1, alpha=1](%bias, %x, t(%w)) with a prim::Constant %w and a 2-d
+// CPU %x of known size becomes _linear_packed(%x, %packed, %bias), with
+// %packed a new constant holding _linear_prepack(%w, batch size of %x), so
+// the weight is prepared for the BLAS once instead of on every run.
+void PrepackLinear(std::shared_ptr<Graph>& graph);
+
+}}
@@ -0,0 +1,93 @@
+#include "torch/csrc/jit/passes/quantize_weights.h"
+
+#include "torch/csrc/jit/passes/dead_code_elimination.h"
+#include "torch/csrc/jit/interned_strings.h"
+
+#include <ATen/ATen.h>
+
+namespace torch { namespace jit {
+
+namespace {
+
+bool isOne(Node* n, Symbol name) {
+  return n->hasAttribute(name) && n->kindOf(name) == AttributeKind::t &&
+         at::Scalar(n->t(name)).toDouble() == 1;
+}
+
+// The value of a prim::Constant float CPU weight with dim dimensions, or an
+// undefined tensor
+at::Tensor constantWeight(Value* v, int64_t dim) {
+  Node* n = v->node();
+  if (n->kind() != prim::Constant || !n->hasAttribute(attr::value))
+    return at::Tensor();
+  const auto& weight = n->t(attr::value);
+  if (weight.type().is_cuda() || weight.type().scalarType() != at::kFloat || weight.dim() != dim)
+    return at::Tensor();
+  return weight;
+}
+
+// Replaces the output of n by a new kind node with inputs x, the quantized
+// weight, its scales and bias
+Node* replaceWithQuantized(Node* n, NodeKind kind, Value* x, const at::Tensor& weight, Value* bias) {
+  auto graph = n->owningGraph();
+  auto quantized = at::quantize_per_channel(weight);
+  Node* qweight = graph->createConstant(std::get<0>(quantized));
+  Node* scales = graph->createConstant(std::get<1>(quantized));
+  qweight->insertBefore(n);
+  scales->insertBefore(n);
+  Node* q = graph->create(kind, {x, qweight->output(), scales->output(), bias});
+  q->insertBefore(n);
+  q->output()->setType(n->output()->type());
+  n->output()->replaceAllUsesWith(q->output());
+  return q;
+}
+
+bool quantizeLinear(Node* n) {
+  if (n->kind() != aten::addmm || n->inputs().size() != 3 || n->outputs().size() != 1 ||
+      n->attributeNames().size() != 2 || !isOne(n, attr::beta) || !isOne(n, attr::alpha))
+    return false;
+  Node* t = n->inputs()[2]->node();
+  if (t->kind() != aten::t || t->inputs().size() != 1)
+    return false;
+  auto weight = constantWeight(t->input(), 2);
+  if (!weight.defined())
+    return false;
+  replaceWithQuantized(n, aten::quantized_linear, n->inputs()[1], weight, n->inputs()[0]);
+  return true;
+}
+
+bool quantizeConv2d(Node* n) {
+  if (n->kind() != aten::_convolution || n->inputs().size() != 3 || n->outputs().size() != 1 ||
+      !n->hasAttribute(attr::transposed) || n->i(attr::transposed) ||
+      !n->hasAttribute(attr::stride) || n->is(attr::stride).size() != 2)
+    return false;
+  auto weight = constantWeight(n->inputs()[1], 4);
+  if (!weight.defined())
+    return false;
+  Node* q = replaceWithQuantized(n, aten::quantized_conv2d, n->inputs()[0], weight, n->inputs()[2]);
+  q->is_(attr::stride, n->is(attr::stride));
+  q->is_(attr::padding, n->is(attr::padding));
+  q->is_(attr::dilation, n->is(attr::dilation));
+  q->i_(attr::groups, n->i(attr::groups));
+  return true;
+}
+
+void QuantizeWeights(Block* block) {
+  for (auto it = block->nodes().begin(), end = block->nodes().end(); it != end; ++it) {
+    auto n = *it;
+    for (auto b : n->blocks())
+      QuantizeWeights(b);
+    if (quantizeLinear(n) || quantizeConv2d(n))
+      it.destroyCurrent();
+  }
+}
+
+} // anonymous namespace
+
+void QuantizeWeights(std::shared_ptr<Graph>& graph) {
+  QuantizeWeights(graph->block());
+  // the float weights are usually dead now
+  EliminateDeadCode(graph);
+}
+
+}}
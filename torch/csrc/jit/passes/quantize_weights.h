@@ -0,0 +1,16 @@
+#pragma once
+
+#include "torch/csrc/jit/ir.h"
+
+namespace torch { namespace jit {
+
+// Runs the linear layers and 2D convolutions with constant float CPU weights
+// in int8: addmm[beta=1, alpha=1](%bias, %x, t(%w)) becomes
+// quantized_linear(%x, %qw, %scales, %bias) and a non-transposed 2D
+// _convolution(%x, %w, %bias) becomes quantized_conv2d with the same stride,
+// padding, dilation and groups, where %qw, %scales = quantize_per_channel(%w)
+// are new constants. Unlike the other passes this changes the results, so it
+// is not run by the graph executor and has to be applied explicitly.
+void QuantizeWeights(std::shared_ptr<Graph>& graph);
+
+}}
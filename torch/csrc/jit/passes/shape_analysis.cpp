@@ -144,6 +144,15 @@ void PropagateShapeOnNode(Node * node, bool insert_expands) {
       }
       return;
     }
+    case prim::Fork: {
+      // the subgraph is specialized by its own executor when it runs, and the
+      // output keeps its Future type
+      return;
+    }
+    case prim::Wait: {
+      setDynamicType(node);
+      return;
+    }
     default: ; // fall-through
   }
 
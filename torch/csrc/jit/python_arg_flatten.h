@@ -5,6 +5,7 @@
 #include "torch/csrc/utils/hash.h"
 
 #include <ATen/ATen.h>
+#include <algorithm>
 #include <tuple>
 #include <vector>
 #include <functional>
@@ -43,6 +44,16 @@ struct IODescriptor {
     return get_hash(o.structure, o.metadata, o.grad_enabled);
   }
 
+  // A copy of this descriptor that only keeps the number of dimensions of
+  // each Variable, so it matches the descriptors of inputs that differ from
+  // these in sizes alone.
+  IODescriptor withoutSizes() const {
+    IODescriptor desc = *this;
+    for (auto & meta : desc.metadata)
+      std::fill(meta.sizes.begin(), meta.sizes.end(), -1);
+    return desc;
+  }
+
   void extend(const autograd::variable_list& list) {
     metadata.reserve(metadata.size() + list.size());
     for (auto & var : list)
@@ -13,6 +13,8 @@
 #include "torch/csrc/jit/passes/graph_fuser.h"
 #include "torch/csrc/jit/passes/inplace_check.h"
 #include "torch/csrc/jit/passes/batch_mm.h"
+#include "torch/csrc/jit/passes/shape_analysis.h"
+#include "torch/csrc/jit/argument_spec.h"
 #include "torch/csrc/jit/python_arg_flatten.h"
 #include "torch/csrc/jit/interpreter.h"
 #include "torch/csrc/jit/interpreter_autograd_function.h"
@@ -51,12 +53,20 @@ py::object steal(py::handle x) {
 //   as the compiled trace.
 // - When we encounter an input configuration whose trace is compiled,
 //   we just directly run the compiled trace.
+// - Unless specialize_sizes is set, a compiled single stage trace also
+//   serves input configurations which only differ from its own in sizes. It
+//   is specialized to their sizes by shape propagation, without running the
+//   underlying function again.
 struct CompiledFunction {
 
   struct TraceForKey {
-    TraceForKey(CompiledFunction& fn, bool grad_enabled)
+    TraceForKey(CompiledFunction& fn, const IODescriptor& desc)
       : fn_(fn)
-      , grad_enabled_(grad_enabled) {}
+      , grad_enabled_(desc.grad_enabled) {
+      if (!fn.specialize_sizes_) {
+        sizeless_desc_ = desc.withoutSizes();
+      }
+    }
 
     bool ready() {
       if (is_ready_) return true;
@@ -84,18 +94,48 @@ struct CompiledFunction {
       // Now, we have a complete trace. Compile it.
       EliminateDeadCode(complete_trace->graph);
       CheckInplace(complete_trace->graph);
-      if (fn_.optimize_) {
-        PeepholeOptimize(complete_trace->graph);
-        BatchMM(complete_trace->graph);
-        FuseGraph(complete_trace->graph);
-        EliminateCommonSubexpression(complete_trace->graph);
+      // The backward stages record the sizes of the forward as attributes,
+      // so only single stage traces are fit for other sizes
+      if (!fn_.specialize_sizes_ && complete_trace->graph->stage() == 0) {
+        template_ = complete_trace->graph->copy();
       }
+      optimize(complete_trace->graph);
       factory_ = std::make_shared<InterpreterFunctionFactory>(complete_trace.get());
       graph_ = complete_trace->graph;
       is_ready_ = true;
+      if (template_) {
+        fn_.templates_.emplace(sizeless_desc_, this);
+      }
+      return true;
+    }
+
+    // Compiles the trace of other for the sizes of inputs. Returns false if
+    // they don't fit it, e.g. when it views them with sizes of other inputs.
+    bool specialize(const TraceForKey& other, const variable_list& inputs) {
+      JIT_ASSERT(!is_ready_ && other.template_);
+      auto graph = other.template_->copy();
+      try {
+        PropagateInputShapes(*graph, ArgumentSpec(grad_enabled_, variable_tensor_list(inputs.begin(), inputs.end())));
+      } catch (std::exception&) {
+        return false;
+      }
+      optimize(graph);
+      factory_ = std::make_shared<InterpreterFunctionFactory>(graph, *other.factory_);
+      graph_ = std::move(graph);
+      out_desc_ = other.out_desc_;
+      is_ready_ = true;
       return true;
     }
 
+    void optimize(std::shared_ptr<Graph>& graph) {
+      if (fn_.optimize_) {
+        PeepholeOptimize(graph);
+        BatchMM(graph);
+        FuseGraph(graph);
+        EliminateCommonSubexpression(graph);
+      }
+    }
+
     variable_list run(variable_list inputs) {
       JIT_ASSERT(is_ready_);
       AutoNoGIL _gil_guard;
@@ -146,6 +186,7 @@ struct CompiledFunction {
     }
 
     CompiledFunction& fn_;
+    IODescriptor sizeless_desc_;
     IODescriptor out_desc_;
     std::vector<std::shared_ptr<TracingState>> traces_;
     bool grad_enabled_ = false;
@@ -153,14 +194,23 @@ struct CompiledFunction {
 
     std::shared_ptr<InterpreterFunctionFactory> factory_;
     std::shared_ptr<jit::Graph> graph_;
+    // The optimizable trace, kept to be specialized to other sizes
+    std::shared_ptr<jit::Graph> template_;
   };
 
   TraceForKey& getTrace(ParsedArgs& args) {
     auto it = ktraces_.find(args.desc);
     if (it == ktraces_.end()) {
-      bool grad_enabled = args.desc.grad_enabled;
       std::tie(it, std::ignore) = ktraces_.emplace(args.desc,
-                                                   TraceForKey(*this, grad_enabled));
+                                                   TraceForKey(*this, args.desc));
+      auto & ktrace = it->second;
+      if (!specialize_sizes_) {
+        auto template_it = templates_.find(ktrace.sizeless_desc_);
+        if (template_it != templates_.end() &&
+            ktrace.specialize(*template_it->second, args.vars)) {
+          specializations_++;
+        }
+      }
     }
     return it->second;
   }
@@ -203,16 +253,19 @@ struct CompiledFunction {
   }
 
   void clearCache() {
+    templates_.clear();
     ktraces_.clear();
   }
 
-  CompiledFunction(int nderivs, bool optimize, bool enabled, py::object function,
-                   std::string name)
+  CompiledFunction(int nderivs, bool optimize, bool enabled, bool specialize_sizes,
+                   py::object function, std::string name)
     : nderivs_(nderivs)
     , optimize_(optimize)
     , enabled_(enabled)
+    , specialize_sizes_(specialize_sizes)
     , hits_(0)
     , misses_(0)
+    , specializations_(0)
     , function_(function.release().ptr())
     , name_(std::move(name))
     , captured_vars_()
@@ -221,12 +274,16 @@ struct CompiledFunction {
   int nderivs_;
   bool optimize_;
   bool enabled_;
+  bool specialize_sizes_;
   std::atomic<uint64_t> hits_;
   std::atomic<uint64_t> misses_;
+  std::atomic<uint64_t> specializations_;
   THPObjectPtr function_;
   std::string name_;
   variable_list captured_vars_;
   std::unordered_map<IODescriptor, TraceForKey, torch::hash<IODescriptor>> ktraces_;
+  // Compiled traces by the descriptors of their inputs without the sizes
+  std::unordered_map<IODescriptor, TraceForKey*, torch::hash<IODescriptor>> templates_;
 };
 
 
@@ -243,6 +300,7 @@ std::ostream& operator<<(std::ostream& out, const CompiledFunction & cf) {
   out << "CompiledFunction: " << cf.name_ << "(nderivs=" << cf.nderivs_ << ", optimized=" << cf.optimize_ << ", enabled=" << cf.enabled_ << "):\n";
   out << "trace cache hits: " << cf.hits_ << "\n";
   out << "trace cache misses: " << cf.misses_ << "\n";
+  out << "trace specializations: " << cf.specializations_ << "\n";
   std::vector<std::string> trace_info;
   for(auto & v : cf.ktraces_) {
     std::stringstream ss;
@@ -277,7 +335,7 @@ CompiledFunction::TraceForKey* getTraceFor(CompiledFunction& fn,
 void initCompilerMixin(PyObject *module) {
   auto m = py::handle(module).cast<py::module>();
   py::class_<CompiledFunction>(m, "CompiledFunction", py::dynamic_attr())
-    .def(py::init<int, bool, bool, py::object, std::string>())
+    .def(py::init<int, bool, bool, bool, py::object, std::string>())
     .def("__call__", [](py::args args_) -> py::object {
       auto fn = py::cast<CompiledFunction*>(args_[0]);
       auto args = tuple_tail(args_);
@@ -311,6 +369,9 @@ void initCompilerMixin(PyObject *module) {
     .def_property_readonly("misses", [](CompiledFunction& fn) {
       return fn.misses_.load();
     })
+    .def_property_readonly("specializations", [](CompiledFunction& fn) {
+      return fn.specializations_.load();
+    })
     .def_readwrite("enabled", &CompiledFunction::enabled_);
 }
 
@@ -49,6 +49,20 @@ void initPythonIRBindings(PyObject * module_) {
        py::arg("onnx_opset_version")=0,
        py::arg("defer_weight_export")=false,
        py::arg("export_raw_ir")=false )
+    .def("export_external_data", [](const std::shared_ptr<Graph> g, const std::vector<at::Tensor>& initializers,
+                                    int64_t onnx_opset_version, bool export_raw_ir,
+                                    const std::string& model_filename, const std::string& data_filename) {
+      ExportGraphWithExternalData(
+        g, initializers, onnx_opset_version, export_raw_ir, model_filename, data_filename);
+    }, py::arg("initializers"),
+       py::arg("onnx_opset_version"),
+       py::arg("export_raw_ir"),
+       py::arg("model_filename"),
+       py::arg("data_filename"))
+    .def("export_file", [](const std::shared_ptr<Graph> g, const std::vector<at::Tensor>& initializers,
+                           const std::string& filename) {
+      ExportIRGraphFile(g, initializers, filename);
+    }, py::arg("initializers"), py::arg("filename"))
     .def("prettyPrintExport", [](const std::shared_ptr<Graph> g, const std::vector<at::Tensor>& initializers,
                       int64_t onnx_opset_version, bool defer_weight_export, bool export_raw_ir) {
       return PrettyPrintExportedGraph(
@@ -306,6 +320,8 @@ void initPythonIRBindings(PyObject * module_) {
           return "TensorType";
         case TypeKind::TupleType:
           return "TupleType";
+        case TypeKind::FutureType:
+          return "FutureType";
         default:
           torch::barf("unknown type kind");
           return "";
@@ -348,6 +364,17 @@ void initPythonIRBindings(PyObject * module_) {
     }
     return std::make_tuple(graph, variables);
   });
+  m.def("_jit_import_graph_file", [](const std::string& filename) {
+    std::vector<at::Tensor> initializers;
+    auto graph = ImportIRGraphFile(filename, initializers);
+    std::vector<torch::autograd::Variable> variables;
+    variables.reserve(initializers.size());
+    for (auto& tensor : initializers) {
+      variables.push_back(torch::autograd::make_variable(
+          std::move(tensor), /*requires_grad=*/false));
+    }
+    return std::make_tuple(graph, variables);
+  });
   m.def("_jit_is_tracing", [](const autograd::Variable& var) {
     return tracer::isTracing(var);
   });
@@ -380,6 +380,33 @@ std::shared_ptr<SugaredValue> BuiltinFunction::call(
   return emitBuiltinCall(loc, m, name, inputs, attributes, true);
 }
 
+// Moves the block of each prim::Fork into its Subgraph attribute. The values
+// of the enclosing scopes that the block refers to become the inputs of the
+// fork and of the subgraph.
+static void liftForkBlocks(Block* block) {
+  for(auto n : block->nodes()) {
+    for(auto b : n->blocks()) {
+      liftForkBlocks(b);
+    }
+    if(n->kind() != prim::Fork || n->blocks().empty())
+      continue;
+    auto subgraph = std::make_shared<Graph>();
+    std::unordered_map<Value*, Value*> captured;
+    auto capture = [&](Value* v) {
+      auto it = captured.find(v);
+      if(it != captured.end())
+        return it->second;
+      n->addInput(v);
+      auto input = subgraph->addInput()->copyMetadata(v);
+      captured[v] = input;
+      return input;
+    };
+    subgraph->block()->cloneFrom(n->blocks()[0], capture);
+    n->g_(attr::Subgraph, subgraph);
+    n->eraseBlock(0);
+  }
+}
+
 struct to_ir {
   to_ir(
       Def def,
@@ -429,6 +456,7 @@ struct to_ir {
 
     // remove any uses of tuples that we inserted
     LowerTuples(graph);
+    liftForkBlocks(graph->block());
   }
 
 private:
@@ -912,6 +940,8 @@ private:
     auto it = function_table.find(ident.name());
     if (it != function_table.end()) {
       return packOutputs(*graph, method.emit_call_to(ident.range(), it->second, inputs));
+    } else if (ident.name() == "wait") {
+      return emitWait(ident.range(), inputs, attributes);
     } else if (ident.name() == "print") {
       if (!attributes.empty())
         throw ErrorReport(ident) << "print doesn't accept any keyword arguments";
@@ -926,6 +956,57 @@ private:
     return emitApplyExpr(Var::create(ident.range(), ident), inputs, attributes, n_binders);
   }
 
+  // fut = fork(fn, *args) emits the call fn(*args) into the block of a
+  // prim::Fork node, whose output is the future. The block may refer to values
+  // of the enclosing scopes; liftForkBlocks turns it into the subgraph that the
+  // interpreter runs once the method is complete.
+  std::shared_ptr<SugaredValue> emitFork(Apply apply) {
+    const auto& range = apply.range();
+    if(apply.inputs().size() == 0)
+      throw ErrorReport(apply) << "fork expects a function to call";
+    if(!apply.attributes().empty())
+      throw ErrorReport(apply) << "fork doesn't accept any keyword arguments";
+    auto callee = emitSugaredExpr(apply.inputs()[0], 1);
+    std::vector<Value*> args;
+    for(size_t i = 1; i < apply.inputs().size(); ++i) {
+      auto arg = apply.inputs()[i];
+      if(arg.kind() == TK_STARRED) {
+        auto starred = Starred(arg);
+        for(auto entry : emitSugaredExpr(starred.expr(), 1)->asTuple(starred.range(), method))
+          args.push_back(ensureTensor(starred.range(), entry->asValue(starred.range(), method)));
+      } else {
+        args.push_back(emitExpr(arg));
+      }
+    }
+    auto fork = emitNode(prim::Fork, range, {}, 1);
+    fork->output()->setType(FutureType::get());
+    auto body = fork->addBlock();
+    {
+      WithInsertPoint guard(body);
+      auto result = callee->call(range, method, args, {}, 1)->asValue(range, method);
+      std::vector<Value*> outputs = {result};
+      if(result->type()->kind() == TypeKind::TupleType)
+        outputs = graph->insertNode(graph->createTupleUnpack(result))->outputs().vec();
+      for(auto output : outputs)
+        body->registerOutput(ensureTensor(range, output));
+    }
+    return std::make_shared<SimpleValue>(fork->output());
+  }
+
+  // outputs = wait(fut) blocks until the fork that returned fut is done
+  std::shared_ptr<SugaredValue> emitWait(const SourceRange& loc, at::ArrayRef<Value*> inputs, at::ArrayRef<NamedValue> attributes) {
+    if(!attributes.empty())
+      throw ErrorReport(loc) << "wait doesn't accept any keyword arguments";
+    if(inputs.size() != 1 || inputs[0]->type()->kind() != TypeKind::FutureType)
+      throw ErrorReport(loc) << "wait expects the result of a fork";
+    auto future = inputs[0];
+    if(future->node()->kind() != prim::Fork)
+      throw ErrorReport(loc) << "wait expects the result of a fork, but the future "
+                             << "was passed through control flow";
+    auto num_outputs = future->node()->blocks().at(0)->outputs().size();
+    return packOutputs(*graph, emitNode(prim::Wait, loc, {future}, num_outputs)->outputs());
+  }
+
   std::shared_ptr<SugaredValue> emitApplyExpr(Expr callee, const std::vector<Value*>& inputs, at::ArrayRef<NamedValue> attributes, size_t n_binders) {
     // otherwise we evaluate the callee and then desugar it
     auto sv = emitSugaredExpr(callee, 1);
@@ -949,6 +1030,11 @@ private:
       }
       case TK_APPLY: {
         auto apply = Apply(tree);
+        // the callee of fork is not a value, so fork is handled before its
+        // arguments are emitted
+        if(apply.callee().kind() == TK_VAR && Var(apply.callee()).name().name() == "fork") {
+          return emitFork(apply);
+        }
         auto inputs = getValues(apply.inputs(), true, identity);
         auto attributes = fmap(apply.attributes(), [&](const Attribute& attr) {
           return NamedValue(attr.range(), attr.name().name(), emitExpr(attr.value(), identity));
@@ -1,5 +1,6 @@
 #include "torch/csrc/jit/script/init.h"
 #include "torch/csrc/jit/script/compiler.h"
+#include "torch/csrc/jit/shape_profile.h"
 
 namespace torch {
 namespace jit {
@@ -350,6 +351,7 @@ void initJitScriptBindings(PyObject* module) {
       .def("_register_module", &Module::register_module)
       .def("_set_parameter", &Module::set_parameter)
       .def("_get_parameter", &Module::get_parameter)
+      .def("_freeze_parameters", &Module::freeze_parameters)
       .def("_get_module", &Module::get_module)
       .def("_get_modules", [](Module& self) -> py::tuple {
         auto & modules = self.get_modules();
@@ -428,7 +430,13 @@ void initJitScriptBindings(PyObject* module) {
     })
     .def("propagate_shapes", &Method::propagate_shapes)
     .def("propagate_and_assign_input_and_output_shapes", &Method::propagate_and_assign_input_and_output_shapes)
-    .def("params", &Method::params);
+    .def("params", &Method::params)
+    .def("shape_profile", [](Method& m) {
+      return serializeShapeProfile(m.get_executor().specializedPlanSpecs());
+    })
+    .def("precompile", [](Method& m, const std::string& profile, size_t num_threads) {
+      return precompileInBackground(m.get_executor(), parseShapeProfile(profile), num_threads);
+    }, py::arg("profile"), py::arg("num_threads") = 1);
 
   m.def("_jit_script_compile", [](Def def, ResolutionCallback rcb) {
     return compileFunction(def, pythonResolver(rcb));
@@ -1,6 +1,8 @@
 #include "torch/csrc/jit/script/module.h"
 #include "torch/csrc/jit/script/compiler.h"
 #include "torch/csrc/jit/script/error_report.h"
+#include "torch/csrc/jit/passes/constant_propagation.h"
+#include "torch/csrc/jit/passes/fold_batch_norm.h"
 
 namespace torch { namespace jit { namespace script {
 
@@ -39,4 +41,27 @@ void Method::ensure_defined() {
   }
 }
 
+void Method::freeze_parameters() {
+  if(executor) {
+    throw std::runtime_error("cannot freeze the parameters of method '" + name_ +
+                             "', which has already been run");
+  }
+  ensure_defined();
+  auto & g = *graph_;
+  size_t first = g.inputs().size() - member_inputs.size();
+  for(size_t i = 0; i < member_inputs.size(); i++) {
+    // constants hold tensors, not variables
+    auto value = autograd::as_variable_ref(*member_inputs[i]).data();
+    Node * constant = g.prependNode(g.createConstant(value));
+    g.inputs()[first + i]->replaceAllUsesWith(constant->output());
+  }
+  while(g.inputs().size() > first) {
+    g.eraseInput(g.inputs().size() - 1);
+  }
+  member_inputs.clear();
+  member_input_index.clear();
+  ConstantPropagation(graph_);
+  FoldConvBatchNorm(graph_);
+}
+
 }}}
@@ -42,13 +42,18 @@ struct Method {
   }
 
   variable_tensor_list run(variable_tensor_list && inputs) {
-    std::call_once(executor_init, [&]{
-      executor = GraphExecutor(graph(), optimize);
-    });
     for(auto tp : member_inputs) {
       inputs.push_back(*tp);
     }
-    return executor.run(std::move(inputs));
+    return get_executor().run(std::move(inputs));
+  }
+  // the executor of the graph, whose inputs end with the members of the
+  // method
+  GraphExecutor& get_executor() {
+    std::call_once(executor_init, [&]{
+      executor = GraphExecutor(graph(), optimize);
+    });
+    return executor;
   }
   std::shared_ptr<Graph> graph() const {
     return graph_;
@@ -121,6 +126,13 @@ struct Method {
     return member_inputs;
   }
 
+  // Replaces the parameters of the method by constants holding copies of
+  // their current values, so later changes to them are not seen and no
+  // gradient flows to them, and folds what can be computed from them ahead of
+  // time (see ConstantPropagation and FoldConvBatchNorm). Only valid before
+  // the method is first run.
+  void freeze_parameters();
+
 private:
   std::string name_;
   std::shared_ptr<Graph> graph_; // for debugging and for inlining
@@ -318,6 +330,14 @@ struct Module : public std::enable_shared_from_this<Module> {
     return at::nullopt;
   }
 
+  // freezes the parameters of the methods of this module and its submodules
+  void freeze_parameters() {
+    for(auto& method : methods.values())
+      method->freeze_parameters();
+    for(auto& submodule : modules.values())
+      submodule.module->freeze_parameters();
+  }
+
 
 private:
 
@@ -0,0 +1,118 @@
+#include "torch/csrc/jit/shape_profile.h"
+
+#include <cstdlib>
+#include <sstream>
+#include <stdexcept>
+
+namespace torch { namespace jit {
+
+namespace {
+
+[[noreturn]] void badProfile(size_t line_number, const std::string& line, const char* what) {
+  std::stringstream ss;
+  ss << "invalid shape profile line " << line_number << " (" << what << "): " << line;
+  throw std::runtime_error(ss.str());
+}
+
+at::ScalarType parseScalarType(const std::string& name) {
+#define DEFINE_CASE(_1, n, _2)         \
+  if (name == at::toString(at::ScalarType::n)) \
+    return at::ScalarType::n;
+  AT_FORALL_SCALAR_TYPES(DEFINE_CASE)
+#undef DEFINE_CASE
+  return at::ScalarType::Undefined;
+}
+
+TensorDescription parseTensor(const std::string& text, size_t line_number, const std::string& line) {
+  TensorDescription t;
+  std::istringstream in(text);
+  std::string type;
+  if (!(in >> type)) {
+    badProfile(line_number, line, "empty input");
+  }
+  if (type == "undefined") {
+    return t;
+  }
+  t.defined = true;
+  t.type = parseScalarType(type);
+  if (t.type == at::ScalarType::Undefined) {
+    badProfile(line_number, line, "unknown scalar type");
+  }
+  int requires_grad;
+  if (!(in >> t.device >> requires_grad)) {
+    badProfile(line_number, line, "expected a device and requires_grad");
+  }
+  t.requires_grad = requires_grad != 0;
+  std::string token;
+  auto* dims = &t.sizes;
+  while (in >> token) {
+    if (token == "/") {
+      if (dims == &t.strides) {
+        badProfile(line_number, line, "more than one '/'");
+      }
+      dims = &t.strides;
+      continue;
+    }
+    char* end;
+    int64_t value = std::strtoll(token.c_str(), &end, 10);
+    if (*end != '\0') {
+      badProfile(line_number, line, "expected an integer");
+    }
+    dims->push_back(value);
+  }
+  if (dims != &t.strides || t.sizes.size() != t.strides.size()) {
+    badProfile(line_number, line, "sizes and strides differ in length");
+  }
+  return t;
+}
+
+} // namespace
+
+std::string serializeShapeProfile(const std::vector<ArgumentSpec>& specs) {
+  std::stringstream out;
+  for (const auto& spec : specs) {
+    for (size_t i = 0; i < spec.size(); i++) {
+      if (i > 0) {
+        out << ";";
+      }
+      auto info = spec.tensorInfo(i);
+      if (!info.defined()) {
+        out << "undefined";
+        continue;
+      }
+      out << at::toString(info.type()) << " " << info.device() << " " << info.requires_grad();
+      for (auto size : info.sizes()) {
+        out << " " << size;
+      }
+      out << " /";
+      for (auto stride : info.strides()) {
+        out << " " << stride;
+      }
+    }
+    out << "\n";
+  }
+  return out.str();
+}
+
+std::vector<ArgumentSpec> parseShapeProfile(const std::string& profile) {
+  std::vector<ArgumentSpec> specs;
+  std::istringstream in(profile);
+  std::string line;
+  size_t line_number = 0;
+  while (std::getline(in, line)) {
+    line_number++;
+    if (line.empty() || line[0] == '#') {
+      continue;
+    }
+    std::vector<TensorDescription> tensors;
+    std::istringstream inputs(line);
+    std::string input;
+    while (std::getline(inputs, input, ';')) {
+      tensors.push_back(parseTensor(input, line_number, line));
+    }
+    specs.emplace_back(tensors);
+  }
+  return specs;
+}
+
+}}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "torch/csrc/jit/argument_spec.h"
+
+namespace torch { namespace jit {
+
+// A shape profile lists the argument specs that a GraphExecutor compiled
+// shape-specialized plans for (see GraphExecutor::specializedPlanSpecs), e.g.
+// while serving production traffic. A model can ship with its profile and
+// compile those plans when it is loaded (see precompileInBackground) rather
+// than on the first run of every shape.
+//
+// The text format has one spec per line, and the inputs of a spec separated
+// by ';'. An input is either "undefined" or
+//   <scalar type> <device> <requires_grad> <sizes...> / <strides...>
+// where device is -1 on the CPU, e.g. "Float -1 0 2 3 / 3 1;undefined".
+// Empty lines and lines starting with '#' are skipped.
+std::string serializeShapeProfile(const std::vector<ArgumentSpec>& specs);
+std::vector<ArgumentSpec> parseShapeProfile(const std::string& profile);
+
+}}
@@ -24,6 +24,11 @@
 #include "torch/csrc/jit/argument_spec.h"
 #include "torch/csrc/jit/passes/shape_analysis.h"
 #include "torch/csrc/jit/passes/dead_code_elimination.h"
+#include "torch/csrc/jit/passes/plan_memory.h"
+#include "torch/csrc/jit/passes/prepack_linear.h"
+#include "torch/csrc/jit/passes/quantize_weights.h"
+#include "torch/csrc/jit/passes/constant_propagation.h"
+#include "torch/csrc/jit/passes/batch_mm.h"
 #include "torch/csrc/variable_tensor_functions.h"
 
 #include "torch/csrc/assertions.h"
@@ -239,6 +244,71 @@ static void fusionTests() {
   testConcat(2);
 }
 
+static void cpuFusionTests() {
+  // runs with the CPU interpreter unless PYTORCH_FUSION_CPU_BACKEND=cxx
+  FusionCompiler comp;
+
+  auto testOne = [&](int ti, int tj, int dim) {
+    Graph graph;
+    Var i0 = Var::asNewInput(graph);
+    Var i1 = Var::asNewInput(graph);
+    auto o0 = (i0 * i1).sigmoid() + i1 * 2;
+    o0.addAsOutput();
+    Var::cat({i0, o0.tanh()}, dim).addAsOutput();
+
+    std::vector<int64_t> dims = {3, 300, 5};
+    auto a = at::rand(at::CPU(at::kFloat), dims);
+    std::swap(dims[ti], dims[tj]);
+    auto b = at::rand(at::CPU(at::kFloat), dims).transpose(ti, tj);
+
+    auto o_r = (a * b).sigmoid() + b * 2;
+    auto o2_r = at::cat({a, o_r.tanh()}, dim);
+    auto o = at::zeros(at::CPU(at::kFloat), a.sizes());
+    auto o2 = at::zeros(at::CPU(at::kFloat), o2_r.sizes());
+    comp.debugLaunchGraph(graph, kCPUDevice, {a, b}, {o, o2});
+
+    REQUIRE((o_r - o).abs().max().toCDouble() < 1e-6);
+    REQUIRE((o2_r - o2).abs().max().toCDouble() < 1e-6);
+  };
+  testOne(0, 0, 0);
+  testOne(0, 1, 1);
+  testOne(1, 2, 2);
+
+  // layer norm followed by softmax, with a broadcast weight
+  auto testReductions = [&](int64_t rows, int64_t cols) {
+    Graph graph;
+    Var x = Var::asNewInput(graph);
+    Var w = Var::asNewInput(graph);
+    Node * n;
+    auto mean = Var::create(aten::mean, {x}, 1, &n)[0];
+    n->i_(attr::dim, 1)->i_(attr::keepdim, 1);
+    auto centered = Var::create(aten::sub, {x, mean}, 1, &n)[0];
+    n->t_(attr::alpha, at::Scalar(1).toTensor());
+    auto var = Var::create(aten::mean, {centered * centered}, 1, &n)[0];
+    n->i_(attr::dim, 1)->i_(attr::keepdim, 1);
+    auto rstd = Var::create(aten::rsqrt, {var + 1e-5})[0];
+    auto y = centered * rstd * w;
+    auto s = Var::create(aten::softmax, {y}, 1, &n)[0];
+    n->i_(attr::dim, 1);
+    s.addAsOutput();
+    centered.addAsOutput();
+
+    auto a = at::randn(at::CPU(at::kFloat), {rows, cols});
+    auto b = at::rand(at::CPU(at::kFloat), {cols});
+    auto centered_r = a - a.mean(1, true);
+    auto y_r = centered_r * (centered_r * centered_r).mean(1, true).add(1e-5).rsqrt() * b;
+    auto s_r = at::softmax(y_r, 1);
+    auto o = at::zeros(at::CPU(at::kFloat), {rows, cols});
+    auto o2 = at::zeros(at::CPU(at::kFloat), {rows, cols});
+    comp.debugLaunchGraph(graph, kCPUDevice, {a, b}, {o, o2});
+
+    REQUIRE((s_r - o).abs().max().toCDouble() < 1e-6);
+    REQUIRE((centered_r - o2).abs().max().toCDouble() < 1e-5);
+  };
+  testReductions(3, 5);
+  testReductions(7, 1000);
+}
+
 struct Attr : public Attributes<Attr> {
 };
 void attributesTest() {
@@ -532,7 +602,9 @@ std::shared_ptr<Graph> trace(const ADTestSpec& test, const variable_list& vars_i
 variable_list grad(const variable_list& outputs, const variable_list& inputs, const variable_list& grad_outputs) {
   static const auto get_edge = [](const Variable& v) { return v.gradient_edge(); };
   auto & engine = torch::autograd::Engine::getDefaultEngine();
-  return engine.execute(fmap(outputs, get_edge), grad_outputs, true, false, fmap(inputs, get_edge));
+  autograd::edge_list output_edges(fmap(outputs, get_edge));
+  autograd::edge_list input_edges(fmap(inputs, get_edge));
+  return engine.execute(output_edges, grad_outputs, true, false, input_edges);
 }
 
 void assertAllClose(const tensor_list& a, const tensor_list& b) {
@@ -578,6 +650,12 @@ void testADFormulas() {
     {"mul",     binary_pointwise, [](const VL& v) -> VL { return {v[0] * v[1]}; }},
     {"sigmoid", unary_pointwise,  [](const VL& v) -> VL { return {v[0].sigmoid()}; }},
     {"tanh",    unary_pointwise,  [](const VL& v) -> VL { return {v[0].tanh()}; }},
+    {"div",     binary_pointwise, [](const VL& v) -> VL { return {v[0] / v[1]}; }},
+    {"exp",     unary_pointwise,  [](const VL& v) -> VL { return {v[0].exp()}; }},
+    {"log",     unary_pointwise,  [](const VL& v) -> VL { return {(v[0] * v[0]).log()}; }},
+    {"reciprocal", unary_pointwise, [](const VL& v) -> VL { return {v[0].reciprocal()}; }},
+    {"sqrt",    unary_pointwise,  [](const VL& v) -> VL { return {(v[0] * v[0]).sqrt()}; }},
+    {"recompute", binary_pointwise, [](const VL& v) -> VL { return {(v[0] - v[1]) * (v[0] + v[1])}; }},
     {"t",       unary_pointwise,  [](const VL& v) -> VL { return {v[0].t()}; }},
     {"mm",      {{10, 12}, {12, 15}}, [](const VL& v) -> VL { return {v[0].mm(v[1])}; }},
     {"chunk",   {{10, 12, 15}}, [](const VL& v) -> VL { return fmap<Variable>(v[0].chunk(4, 1)); }},
@@ -634,9 +712,10 @@ void testDifferentiate(std::ostream & out) {
   graph->registerOutput(c.value());
 
   auto grad_spec = differentiate(graph, {true, true});
+  // a * b is recomputed in df from the captured inputs, not saved
   std::vector<std::size_t> expected_captured_inputs = {0, 1};
-  std::vector<std::size_t> expected_captured_outputs = {1};
-  std::vector<std::size_t> expected_input_vjps = {0, 1};
+  std::vector<std::size_t> expected_captured_outputs = {};
+  std::vector<std::size_t> expected_input_vjps = {0};
   std::vector<std::size_t> expected_output_vjps = {0, 1};
   REQUIRE(grad_spec.f_real_outputs == 1);
   REQUIRE(grad_spec.df_input_captured_inputs == expected_captured_inputs);
@@ -759,6 +838,16 @@ void argumentSpecTest() {
   REQUIRE(!(c == a));
   REQUIRE(spec.count(c) == 0);
 
+  // without sizes, only type, device, definedness and requires_grad count
+  auto list3 = createVarList({ var(CF, {7}, true), var(CD, {3, 3}, false) , var(GF, {2}, true), var(GD, {1}, false), undef()});
+  ArgumentSpec no_sizes(true, list, /*with_sizes=*/false);
+  REQUIRE(no_sizes == ArgumentSpec(true, list3, /*with_sizes=*/false));
+  REQUIRE(no_sizes.hashCode() == ArgumentSpec(true, list3, /*with_sizes=*/false).hashCode());
+  REQUIRE(no_sizes != ArgumentSpec(false, list3, /*with_sizes=*/false));
+  for(size_t i = 0; i < list.size(); ++i) {
+    REQUIRE(no_sizes.tensorInfo(i).ndimension() == 0);
+  }
+
 }
 
 void shapeAnalysisTest() {
@@ -885,6 +974,157 @@ void testControlFlow() {
   REQUIRE(256 == run_binary("while_test",2,0));
 }
 
+void memoryPlanningTest() {
+  auto graph = std::make_shared<Graph>();
+  Var x = Var::asNewInput(*graph);
+  Var w = Var::asNewInput(*graph);
+  Var a = x.mm(w);
+  Var b = a.tanh();
+  Var c = b.mm(w);
+  Var d = c.sigmoid();
+  d.mm(w).addAsOutput();
+
+  auto v = [](at::Tensor t) { return autograd::make_variable(t, false); };
+  auto x_t = at::randn(at::CPU(at::kFloat), {4, 8});
+  auto w_t = at::randn(at::CPU(at::kFloat), {8, 8});
+  PropagateInputShapes(*graph, ArgumentSpec(false, createVarList({v(x_t), v(w_t)})));
+  PlanMemory(graph);
+
+  // a and c are never alive at the same time, so they share a slice; the
+  // output is allocated separately
+  Node* arena = *graph->nodes().begin();
+  REQUIRE(arena->kind() == prim::MemoryArena);
+  REQUIRE(arena->output()->type()->expect<TensorType>()->sizes() == std::vector<int64_t>{64});
+  REQUIRE(a.value()->node()->is(attr::arena_offsets) == c.value()->node()->is(attr::arena_offsets));
+  REQUIRE(a.value()->node()->is(attr::arena_offsets) != b.value()->node()->is(attr::arena_offsets));
+  REQUIRE(!graph->outputs()[0]->node()->hasAttribute(attr::arena_offsets));
+
+  Code code(graph);
+  InterpreterState interp(code);
+  std::vector<at::Tensor> stack = {v(x_t), v(w_t)};
+  interp.runOneStage(stack);
+  auto expected = x_t.mm(w_t).tanh().mm(w_t).sigmoid().mm(w_t);
+  REQUIRE(almostEqual(Variable(stack[0]).data(), expected));
+}
+
+void batchHorizontalTest() {
+  auto graph = std::make_shared<Graph>();
+  Var x = Var::asNewInput(*graph);
+  Var w1 = Var::asNewInput(*graph);
+  Var w2 = Var::asNewInput(*graph);
+  x.mm(w1).tanh().addAsOutput();
+  x.mm(w2).tanh().addAsOutput();
+
+  auto v = [](at::Tensor t) { return autograd::make_variable(t, false); };
+  auto x_t = at::randn(at::CPU(at::kFloat), {4, 8});
+  auto w1_t = at::randn(at::CPU(at::kFloat), {8, 6});
+  auto w2_t = at::randn(at::CPU(at::kFloat), {8, 6});
+  PropagateInputShapes(*graph, ArgumentSpec(false, createVarList({v(x_t), v(w1_t), v(w2_t)})));
+  BatchMM(graph);
+
+  // both mms share x, and the tanhs of their results can be concatenated
+  auto count = [&](Symbol kind) {
+    return std::count_if(graph->nodes().begin(), graph->nodes().end(),
+                         [&](Node* n) { return n->kind() == kind; });
+  };
+  REQUIRE(count(aten::mm) == 1);
+  REQUIRE(count(aten::tanh) == 1);
+
+  Code code(graph);
+  InterpreterState interp(code);
+  std::vector<at::Tensor> stack = {v(x_t), v(w1_t), v(w2_t)};
+  interp.runOneStage(stack);
+  REQUIRE(almostEqual(Variable(stack[0]).data(), x_t.mm(w1_t).tanh()));
+  REQUIRE(almostEqual(Variable(stack[1]).data(), x_t.mm(w2_t).tanh()));
+}
+
+void prepackLinearTest() {
+  auto graph = std::make_shared<Graph>();
+  Var x = Var::asNewInput(*graph);
+  Var b = Var::asNewInput(*graph);
+  auto w_t = at::randn(at::CPU(at::kFloat), {5, 8});
+  Var w(graph->appendNode(graph->createConstant(w_t))->output());
+  Node* n;
+  auto y = Var::create(aten::addmm, {b, x, Var::create(aten::t, {w})[0]}, 1, &n)[0];
+  n->t_(attr::beta, at::Scalar(1).toTensor());
+  n->t_(attr::alpha, at::Scalar(1).toTensor());
+  y.addAsOutput();
+
+  auto v = [](at::Tensor t) { return autograd::make_variable(t, false); };
+  auto x_t = at::randn(at::CPU(at::kFloat), {4, 8});
+  auto b_t = at::randn(at::CPU(at::kFloat), {5});
+  PropagateInputShapes(*graph, ArgumentSpec(false, createVarList({v(x_t), v(b_t)})));
+  PrepackLinear(graph);
+
+  // the weight and its transpose are replaced by the packed weight
+  std::vector<Symbol> kinds;
+  for (auto node : graph->nodes())
+    kinds.push_back(node->kind());
+  REQUIRE(kinds == (std::vector<Symbol>{prim::Constant, aten::_linear_packed}));
+
+  Code code(graph);
+  InterpreterState interp(code);
+  std::vector<at::Tensor> stack = {v(x_t), v(b_t)};
+  interp.runOneStage(stack);
+  REQUIRE(almostEqual(Variable(stack[0]).data(), at::addmm(b_t, x_t, w_t.t())));
+}
+
+void quantizeWeightsTest() {
+  auto graph = std::make_shared<Graph>();
+  Var x = Var::asNewInput(*graph);
+  Var b = Var::asNewInput(*graph);
+  auto w_t = at::randn(at::CPU(at::kFloat), {5, 8});
+  Var w(graph->appendNode(graph->createConstant(w_t))->output());
+  Node* n;
+  auto y = Var::create(aten::addmm, {b, x, Var::create(aten::t, {w})[0]}, 1, &n)[0];
+  n->t_(attr::beta, at::Scalar(1).toTensor());
+  n->t_(attr::alpha, at::Scalar(1).toTensor());
+  y.addAsOutput();
+  QuantizeWeights(graph);
+
+  std::vector<Symbol> kinds;
+  for (auto node : graph->nodes())
+    kinds.push_back(node->kind());
+  REQUIRE(kinds == (std::vector<Symbol>{prim::Constant, prim::Constant, aten::quantized_linear}));
+
+  auto v = [](at::Tensor t) { return autograd::make_variable(t, false); };
+  auto x_t = at::randn(at::CPU(at::kFloat), {4, 8});
+  auto b_t = at::randn(at::CPU(at::kFloat), {5});
+  Code code(graph);
+  InterpreterState interp(code);
+  std::vector<at::Tensor> stack = {v(x_t), v(b_t)};
+  interp.runOneStage(stack);
+  auto expected = at::addmm(b_t, x_t, w_t.t());
+  auto error = (Variable(stack[0]).data() - expected).abs().max().toCFloat();
+  REQUIRE(error < 0.05 * expected.abs().max().toCFloat());
+}
+
+void constantPropagationTest() {
+  auto graph = std::make_shared<Graph>();
+  Var x = Var::asNewInput(*graph);
+  auto w_t = at::randn(at::CPU(at::kFloat), {8, 5});
+  auto b_t = at::randn(at::CPU(at::kFloat), {8});
+  Var w(graph->appendNode(graph->createConstant(w_t))->output());
+  Var b(graph->appendNode(graph->createConstant(b_t))->output());
+  auto y = x.mm((w * 2).t()) + b.sigmoid();
+  y.addAsOutput();
+  ConstantPropagation(graph);
+
+  // only the nodes that depend on x are left
+  std::vector<Symbol> kinds;
+  for (auto node : graph->nodes())
+    kinds.push_back(node->kind());
+  REQUIRE(kinds == (std::vector<Symbol>{prim::Constant, aten::mm, prim::Constant, aten::add}));
+
+  auto v = [](at::Tensor t) { return autograd::make_variable(t, false); };
+  auto x_t = at::randn(at::CPU(at::kFloat), {4, 5});
+  Code code(graph);
+  InterpreterState interp(code);
+  std::vector<at::Tensor> stack = {v(x_t)};
+  interp.runOneStage(stack);
+  REQUIRE(almostEqual(Variable(stack[0]).data(), x_t.mm((w_t * 2).t()) + b_t.sigmoid()));
+}
+
 #ifdef NO_PYTHON
 
 TEST_CASE( "jit test CPU", "[cpu]" ) {
@@ -908,6 +1148,18 @@ TEST_CASE( "jit test CPU", "[cpu]" ) {
     attributesTest();
   SECTION( "interned strings" )
     internedStringsTests();
+  SECTION( "cpu fusion" )
+    cpuFusionTests();
+  SECTION( "memory planning" )
+    memoryPlanningTest();
+  SECTION( "prepack linear" )
+    prepackLinearTest();
+  SECTION( "quantize weights" )
+    quantizeWeightsTest();
+  SECTION( "constant propagation" )
+    constantPropagationTest();
+  SECTION( "horizontal batching" )
+    batchHorizontalTest();
 }
 
 TEST_CASE( "jit test CUDA", "[cuda]" ) {
@@ -941,6 +1193,12 @@ std::string runJITCPPTests() {
   interpStageTest();
   codeTemplateTest();
   fusionTests();
+  cpuFusionTests();
+  memoryPlanningTest();
+  prepackLinearTest();
+  quantizeWeightsTest();
+  constantPropagationTest();
+  batchHorizontalTest();
   attributesTest();
   internedStringsTests();
   fromQualStringTests();
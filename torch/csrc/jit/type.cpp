@@ -29,6 +29,8 @@ std::ostream& operator<<(std::ostream & out, const Type & t) {
     out << "Dynamic";
   } else if(t.kind() == TypeKind::TupleType) {
     out << "Tuple";
+  } else if(t.kind() == TypeKind::FutureType) {
+    out << "Future";
   } else {
     barf("unknown type kind");
   }
@@ -39,6 +41,10 @@ TypePtr HandleType::get() {
   static auto value = std::make_shared<HandleType>();
   return value;
 }
+TypePtr FutureType::get() {
+  static auto value = std::make_shared<FutureType>();
+  return value;
+}
 TypePtr DynamicType::get() {
   static auto value = std::make_shared<DynamicType>();
   return value;
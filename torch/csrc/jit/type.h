@@ -15,7 +15,8 @@ namespace torch { namespace jit {
 _(DynamicType) \
 _(TensorType) \
 _(HandleType) \
-_(TupleType)
+_(TupleType) \
+_(FutureType)
 
 enum class TypeKind {
 #define DEFINE_TYPE(T) T,
@@ -206,6 +207,24 @@ struct HandleType : public Type {
   static TypePtr get();
 };
 
+// The result of a prim::Fork, which the prim::Wait for the fork turns into
+// the outputs of the forked subgraph. Futures only live between the two, they
+// can't be passed to other operators or returned.
+struct FutureType : public Type {
+  friend struct Type;
+  FutureType()
+    : Type(TypeKind::FutureType) {}
+  virtual bool operator==(const Type& rhs) const override {
+    return rhs.kind() == kind();
+  }
+  virtual std::string name() const override {
+    return "Future";
+  }
+  static const TypeKind Kind = TypeKind::FutureType;
+  // global singleton
+  static TypePtr get();
+};
+
 struct TupleType : public Type {
   friend struct Type;
   TupleType(std::vector<TypePtr> elements_)
@@ -203,6 +203,7 @@ private:
   unique_vector<int64_t> dims;
   at::Tensor raw_data;
   std::string dump_;
+  std::string doc_string;
 public:
   TensorProto() : MicroProto(onnx_TensorProto_init_default) {
     proto.dims       = list<int64_t>(&dims);
@@ -213,6 +214,7 @@ public:
   void set_raw_data(const at::Tensor& t) { proto.raw_data = string_from_tensor(&raw_data, t); }
   void set_external_data_present() { proto.raw_data = string(&dump_, "__EXTERNAL"); }
   void set_data_type(onnx_TensorProto_DataType t) { proto.has_data_type = true; proto.data_type = t; }
+  void set_doc_string(const std::string& s) { proto.doc_string = string(&doc_string, s); }
   std::string get_name() const { return name; }
   void dump(std::ostream& stream, size_t indent = 0);
 };
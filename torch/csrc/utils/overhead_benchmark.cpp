@@ -0,0 +1,186 @@
+#ifndef NO_PYTHON
+#include "torch/csrc/python_headers.h"
+#endif
+
+#include "torch/csrc/utils/overhead_benchmark.h"
+
+#include "torch/csrc/autograd/engine.h"
+#include "torch/csrc/autograd/function.h"
+#include "torch/csrc/autograd/grad_mode.h"
+#include "torch/csrc/autograd/variable.h"
+#include "torch/csrc/jit/interpreter.h"
+#include "torch/csrc/jit/ir.h"
+#include "torch/csrc/jit/symbolic_variable.h"
+
+#ifndef NO_PYTHON
+#include "torch/csrc/Exceptions.h"
+#include "torch/csrc/autograd/python_variable.h"
+#include "torch/csrc/utils/object_ptr.h"
+#include "torch/csrc/utils/python_arg_parser.h"
+#include "torch/csrc/utils/python_numbers.h"
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+
+namespace torch { namespace utils {
+
+namespace {
+
+using autograd::Edge;
+using autograd::edge_list;
+using autograd::Function;
+using autograd::Variable;
+using autograd::variable_list;
+
+template <typename F>
+double nsPerCall(int64_t iters, F&& f) {
+  for (int64_t i = 0; i < std::min<int64_t>(iters / 10 + 1, 1000); i++) {
+    f();
+  }
+  auto start = std::chrono::steady_clock::now();
+  for (int64_t i = 0; i < iters; i++) {
+    f();
+  }
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::nano>(end - start).count() / iters;
+}
+
+// Passes its gradient on to the next function of the chain
+struct Identity : public Function {
+  Identity() : Function(/*num_inputs=*/1) {}
+  variable_list apply(const variable_list& inputs) override {
+    return num_outputs() > 0 ? inputs : variable_list();
+  }
+};
+
+// A chain of length Identity functions, from the root
+std::vector<std::shared_ptr<Function>> makeChain(int length) {
+  std::vector<std::shared_ptr<Function>> chain;
+  for (int i = 0; i < length; i++) {
+    chain.push_back(std::make_shared<Identity>());
+  }
+  for (int i = 0; i + 1 < length; i++) {
+    chain[i]->add_next_edge(Edge(chain[i + 1], 0));
+  }
+  return chain;
+}
+
+} // namespace
+
+std::vector<std::pair<std::string, double>> runOverheadBenchmarks(int64_t iters) {
+  std::vector<std::pair<std::string, double>> results;
+  auto tensor = at::CPU(at::kFloat).ones({1, 1});
+
+  // t() is a view, so these measure dispatch rather than a kernel
+  results.emplace_back("aten_t", nsPerCall(iters, [&] { tensor.t(); }));
+  auto variable = autograd::make_variable(tensor, /*requires_grad=*/false);
+  results.emplace_back("variable_t", nsPerCall(iters, [&] { variable.t(); }));
+  auto leaf = autograd::make_variable(tensor.clone(), /*requires_grad=*/true);
+  results.emplace_back("variable_t_requires_grad", nsPerCall(iters, [&] { leaf.t(); }));
+  {
+    autograd::AutoGradMode no_grad(false);
+    results.emplace_back("variable_t_no_grad", nsPerCall(iters, [&] { leaf.t(); }));
+  }
+
+  // The engine over chains of functions that return their input, per
+  // execute() call
+  auto& engine = autograd::Engine::getDefaultEngine();
+  variable_list grads = {autograd::make_variable(at::CPU(at::kFloat).ones({1}))};
+  for (int length : {1, 10, 100}) {
+    auto chain = makeChain(length);
+    edge_list roots = {Edge(chain[0], 0)};
+    results.emplace_back(
+        "engine_execute_chain_" + std::to_string(length),
+        nsPerCall(std::max<int64_t>(iters / length, 1), [&] {
+          engine.execute(roots, grads, /*keep_graph=*/true, /*create_graph=*/false);
+        }));
+  }
+
+  // Interpreter dispatch, per instruction of a straight line of t()
+  constexpr int kInstructions = 100;
+  auto graph = std::make_shared<jit::Graph>();
+  auto x = jit::SymbolicVariable::asNewInput(*graph);
+  auto y = x;
+  for (int i = 0; i < kInstructions; i++) {
+    y = y.t();
+  }
+  y.addAsOutput();
+  jit::Code code(graph);
+  results.emplace_back(
+      "interpreter_t_per_instruction",
+      nsPerCall(std::max<int64_t>(iters / kInstructions, 1), [&] {
+        jit::InterpreterState interp(code);
+        std::vector<at::Tensor> stack = {variable};
+        interp.runOneStage(stack);
+      }) / kInstructions);
+
+#ifndef NO_PYTHON
+  // PythonArgParser::parse with one and several signatures, as in
+  // Tensor.t() and Tensor.add()
+  static PythonArgParser unary_parser({
+    "t()",
+  });
+  static PythonArgParser add_parser({
+    "add(Scalar alpha, Tensor other)|deprecated",
+    "add(Tensor other, *, Scalar alpha=1)",
+  });
+  THPObjectPtr py_variable(THPVariable_Wrap(variable));
+  THPObjectPtr no_args(PyTuple_New(0));
+  THPObjectPtr tensor_args(PyTuple_Pack(1, py_variable.get()));
+  THPObjectPtr kwargs(PyDict_New());
+  THPObjectPtr alpha(PyLong_FromLong(2));
+  PyDict_SetItemString(kwargs.get(), "alpha", alpha.get());
+  if (!py_variable || !no_args || !tensor_args || !kwargs || !alpha) {
+    throw python_error();
+  }
+  results.emplace_back("python_arg_parser_no_args", nsPerCall(iters, [&] {
+    ParsedArgs<1> parsed_args;
+    unary_parser.parse(no_args.get(), nullptr, parsed_args);
+  }));
+  results.emplace_back("python_arg_parser_tensor", nsPerCall(iters, [&] {
+    ParsedArgs<2> parsed_args;
+    add_parser.parse(tensor_args.get(), nullptr, parsed_args);
+  }));
+  results.emplace_back("python_arg_parser_tensor_kwarg", nsPerCall(iters, [&] {
+    ParsedArgs<2> parsed_args;
+    add_parser.parse(tensor_args.get(), kwargs.get(), parsed_args);
+  }));
+#endif
+
+  return results;
+}
+
+}} // namespace torch::utils
+
+#ifndef NO_PYTHON
+
+PyObject* THPModule_runOverheadBenchmarks(PyObject* _unused, PyObject* arg) {
+  HANDLE_TH_ERRORS
+  THPUtils_assert(THPUtils_checkLong(arg), "iters must be an int");
+  auto results = torch::utils::runOverheadBenchmarks(THPUtils_unpackLong(arg));
+  THPObjectPtr list(PyList_New(results.size()));
+  if (!list) throw python_error();
+  for (size_t i = 0; i < results.size(); i++) {
+    PyObject* item = Py_BuildValue("(sd)", results[i].first.c_str(), results[i].second);
+    if (!item) throw python_error();
+    PyList_SET_ITEM(list.get(), i, item);
+  }
+  return list.release();
+  END_HANDLE_TH_ERRORS
+}
+
+#else
+
+int main(int argc, char** argv) {
+  int64_t iters = argc > 1 ? std::atoll(argv[1]) : 100000;
+  for (const auto& result : torch::utils::runOverheadBenchmarks(iters)) {
+    std::cout << result.first << ": " << result.second << " ns" << std::endl;
+  }
+  return 0;
+}
+
+#endif
@@ -0,0 +1,23 @@
+#pragma once
+
+// Measures the fixed cost that each layer of PyTorch adds to an operator,
+// on operators that do next to no work: ATen dispatch, VariableType dispatch
+// (with and without recording the graph), Engine::execute over chains of
+// trivial functions, interpreter instruction dispatch and, in the Python
+// build, PythonArgParser::parse.
+//
+// Run it with the overhead_benchmark binary of the libtorch build, or with
+// torch._C._run_overhead_benchmarks(iters) from Python.
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace torch { namespace utils {
+
+// (benchmark name, nanoseconds per call), each benchmark calls its operation
+// iters times
+std::vector<std::pair<std::string, double>> runOverheadBenchmarks(int64_t iters);
+
+}} // namespace torch::utils
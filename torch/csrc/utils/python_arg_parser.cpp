@@ -1,5 +1,6 @@
 #include "torch/csrc/utils/python_arg_parser.h"
 
+#include <algorithm>
 #include <stdexcept>
 #include <sstream>
 #include <unordered_map>
@@ -332,7 +333,15 @@ static void missing_args(const FunctionSignature& signature, int idx) {
 }
 
 static ssize_t find_param(FunctionSignature& signature, PyObject* name) {
+  // the names are interned, and so usually are keyword arguments
   ssize_t i = 0;
+  for (auto& param : signature.params) {
+    if (name == param.python_name) {
+      return i;
+    }
+    i++;
+  }
+  i = 0;
   for (auto& param : signature.params) {
     int cmp = PyObject_RichCompareBool(name, param.python_name, Py_EQ);
     if (cmp < 0) {
@@ -392,6 +401,11 @@ bool FunctionSignature::parse(PyObject* args, PyObject* kwargs, PyObject* dst[],
     return false;
   }
 
+  // too few arguments to give all the required parameters
+  if (!raise_exception && nargs + remaining_kwargs < min_args) {
+    return false;
+  }
+
   int i = 0;
   for (auto& param : params) {
     PyObject* obj = nullptr;
@@ -457,6 +471,17 @@ bool FunctionSignature::parse(PyObject* args, PyObject* kwargs, PyObject* dst[],
   return true;
 }
 
+// Binds the positional arguments of a call without keyword arguments that
+// this signature is known to match
+void FunctionSignature::bind_positional(PyObject* args, PyObject* dst[]) const {
+  auto nargs = PyTuple_GET_SIZE(args);
+  ssize_t i = 0;
+  for (auto& param : params) {
+    PyObject* obj = i < nargs ? PyTuple_GET_ITEM(args, i) : nullptr;
+    dst[i++] = obj == Py_None && param.allow_none ? nullptr : obj;
+  }
+}
+
 PythonArgParser::PythonArgParser(std::vector<std::string> fmts, bool traceable)
  : max_args(0)
  , traceable(traceable)
@@ -474,16 +499,87 @@ PythonArgParser::PythonArgParser(std::vector<std::string> fmts, bool traceable)
   }
 }
 
+bool PythonArgParser::cache_matches(PyObject* args) const {
+  auto nargs = PyTuple_GET_SIZE(args);
+  if (nargs != cached_nargs) {
+    return false;
+  }
+  for (ssize_t i = 0; i < nargs; i++) {
+    if (Py_TYPE(PyTuple_GET_ITEM(args, i)) != cached_types[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Records that a call with the positional arguments args and no keyword
+// arguments matched signature idx, if any other call with no keyword
+// arguments and positional arguments of the same types must match it too.
+// Whether a signature matches such a call depends only on the types of the
+// arguments, except for the Tensors given for Scalar, int64_t or double
+// parameters (which must be 0-dim, and integral for int64_t), and for the
+// var-args IntLists, whose elements are checked; calls where one of the
+// signatures up to idx has either aren't cached.
+void PythonArgParser::cache_signature(PyObject* args, int idx) {
+  auto nargs = PyTuple_GET_SIZE(args);
+  if (nargs > kMaxCachedArgs) {
+    return;
+  }
+  for (int j = 0; j <= idx; j++) {
+    auto& signature = signatures_[j];
+    if (signature.max_pos_args == 1 && signature.params[0].type_ == ParameterType::INT_LIST) {
+      return;
+    }
+    auto checked = std::min<ssize_t>(nargs, signature.params.size());
+    for (ssize_t i = 0; i < checked; i++) {
+      auto type = signature.params[i].type_;
+      if ((type == ParameterType::SCALAR || type == ParameterType::INT64 ||
+           type == ParameterType::DOUBLE) && THPVariable_Check(PyTuple_GET_ITEM(args, i))) {
+        return;
+      }
+    }
+  }
+  // the types are kept alive, so that no other type can take their address
+  for (ssize_t i = 0; i < nargs; i++) {
+    Py_INCREF(Py_TYPE(PyTuple_GET_ITEM(args, i)));
+  }
+  for (ssize_t i = 0; i < cached_nargs; i++) {
+    Py_DECREF(cached_types[i]);
+  }
+  for (ssize_t i = 0; i < nargs; i++) {
+    cached_types[i] = Py_TYPE(PyTuple_GET_ITEM(args, i));
+  }
+  cached_nargs = nargs;
+  cached_idx = idx;
+}
+
 PythonArgs PythonArgParser::raw_parse(PyObject* args, PyObject* kwargs, PyObject* parsed_args[]) {
+  if (kwargs && PyDict_Size(kwargs) == 0) {
+    kwargs = nullptr;
+  }
+  // calls with only positional arguments of the types of the last one skip
+  // type checking and overload resolution
+  if (!kwargs && cache_matches(args)) {
+    auto& signature = signatures_[cached_idx];
+    signature.bind_positional(args, parsed_args);
+    return PythonArgs(cached_idx, traceable, signature, parsed_args);
+  }
+
   if (signatures_.size() == 1) {
     auto& signature = signatures_[0];
     signature.parse(args, kwargs, parsed_args, true);
+    if (!kwargs) {
+      cache_signature(args, 0);
+    }
     return PythonArgs(0, traceable, signature, parsed_args);
   }
 
   int i = 0;
   for (auto& signature : signatures_) {
     if (signature.parse(args, kwargs, parsed_args, false)) {
+      if (!kwargs) {
+        cache_signature(args, i);
+      }
       return PythonArgs(i, traceable, signature, parsed_args);
     }
     i++;
@@ -68,11 +68,22 @@ private:
   [[noreturn]]
   void print_error(PyObject* args, PyObject* kwargs, PyObject* dst[]);
   PythonArgs raw_parse(PyObject* args, PyObject* kwargs, PyObject* dst[]);
+  bool cache_matches(PyObject* args) const;
+  void cache_signature(PyObject* args, int idx);
 
   std::vector<FunctionSignature> signatures_;
   std::string function_name;
   ssize_t max_args;
   bool traceable;
+
+  // The signature matched by the last call with only positional arguments,
+  // and their types; see cache_signature for when this is recorded. Every
+  // parser is a static of the function it parses for, so this is a per call
+  // site cache, and it is only accessed with the GIL held.
+  static constexpr int kMaxCachedArgs = 8;
+  ssize_t cached_nargs = -1;
+  PyTypeObject* cached_types[kMaxCachedArgs];
+  int cached_idx = 0;
 };
 
 struct PythonArgs {
@@ -121,6 +132,7 @@ struct FunctionSignature {
   explicit FunctionSignature(const std::string& fmt);
 
   bool parse(PyObject* args, PyObject* kwargs, PyObject* dst[], bool raise_exception);
+  void bind_positional(PyObject* args, PyObject* dst[]) const;
   std::string toString() const;
 
   std::string name;
@@ -0,0 +1,99 @@
+#include "torch/csrc/utils/tensor_collate.h"
+
+#include <ATen/ATen.h>
+#include <ATen/detail/CUDAHooksInterface.h>
+
+#include <algorithm>
+#include <cstring>
+#include <exception>
+#include <thread>
+#include <vector>
+
+namespace torch { namespace utils {
+
+using namespace at;
+
+// Batches smaller than this per thread are not worth starting a thread for
+static constexpr size_t COLLATE_MIN_BYTES_PER_THREAD = 1 << 20;
+
+Tensor collate_tensors(TensorList tensors, Tensor out, bool pin_memory) {
+  AT_CHECK(!tensors.empty(), "collate_tensors: expected a non-empty list of tensors");
+  auto& type = tensors[0].type();
+  auto sizes = tensors[0].sizes();
+  for (size_t i = 1; i < tensors.size(); i++) {
+    AT_CHECK(tensors[i].type() == type, "collate_tensors: expected all tensors to be of type ",
+             type.toString(), ", but tensor ", i, " is of type ", tensors[i].type().toString());
+    AT_CHECK(tensors[i].sizes().equals(sizes), "collate_tensors: expected all tensors to be of "
+             "the same size, but tensor 0 has size ", sizes, " and tensor ", i, " has size ",
+             tensors[i].sizes());
+  }
+  std::vector<int64_t> out_sizes;
+  out_sizes.reserve(sizes.size() + 1);
+  out_sizes.push_back(tensors.size());
+  out_sizes.insert(out_sizes.end(), sizes.begin(), sizes.end());
+
+  if (out.defined()) {
+    AT_CHECK(out.type() == type, "collate_tensors: expected out to be of type ",
+             type.toString(), ", but it is of type ", out.type().toString());
+    out.resize_(out_sizes);
+  } else if (pin_memory && type.backend() == kCPU) {
+    out = type.tensorWithAllocator(out_sizes, detail::getCUDAHooks().newPinnedMemoryAllocator());
+  } else {
+    out = type.tensor(out_sizes);
+  }
+  if (type.backend() != kCPU || !out.is_contiguous()) {
+    return at::stack_out(out, tensors, 0);
+  }
+
+  size_t num_tensors = tensors.size();
+  size_t tensor_bytes = tensors[0].numel() * type.elementSizeInBytes();
+  auto data = static_cast<char*>(out.data_ptr());
+  auto copy = [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++) {
+      if (tensors[i].is_contiguous()) {
+        std::memcpy(data + i * tensor_bytes, tensors[i].data_ptr(), tensor_bytes);
+      } else {
+        out.select(0, i).copy_(tensors[i]);
+      }
+    }
+  };
+
+  size_t num_threads = std::min({
+      static_cast<size_t>(std::max(at::get_num_threads(), 1)),
+      num_tensors,
+      num_tensors * tensor_bytes / COLLATE_MIN_BYTES_PER_THREAD});
+  if (num_threads <= 1) {
+    copy(0, num_tensors);
+    return out;
+  }
+
+  // The calling thread copies the first chunk
+  size_t chunk = (num_tensors + num_threads - 1) / num_threads;
+  std::vector<std::thread> threads;
+  std::vector<std::exception_ptr> errors(num_threads);
+  for (size_t t = 1; t < num_threads; t++) {
+    threads.emplace_back([&, t] {
+      try {
+        copy(t * chunk, std::min(num_tensors, (t + 1) * chunk));
+      } catch (...) {
+        errors[t] = std::current_exception();
+      }
+    });
+  }
+  try {
+    copy(0, std::min(num_tensors, chunk));
+  } catch (...) {
+    errors[0] = std::current_exception();
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  for (auto& error : errors) {
+    if (error) {
+      std::rethrow_exception(error);
+    }
+  }
+  return out;
+}
+
+}} // namespace torch::utils
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <ATen/ATen.h>
+
+namespace torch { namespace utils {
+
+// Stacks tensors, which must all have the same type and sizes, along a new
+// first dimension, like at::stack. The result is written to out (resized if
+// needed) or, if out is undefined, to a new tensor, allocated in pinned
+// memory if pin_memory is set. CPU tensors are copied with memcpy, split over
+// up to at::get_num_threads() threads for large batches. Doesn't need the
+// GIL.
+at::Tensor collate_tensors(at::TensorList tensors, at::Tensor out, bool pin_memory);
+
+}} // namespace torch::utils
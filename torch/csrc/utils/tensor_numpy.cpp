@@ -90,6 +90,11 @@ at::Tensor tensor_from_numpy(PyObject* obj) {
   }
 
   auto array = (PyArrayObject*)obj;
+  if (!PyArray_ISNOTSWAPPED(array)) {
+    throw ValueError(
+        "given numpy array has a byte order different from the native byte "
+        "order. Conversion between byte orders is currently not supported.");
+  }
   int ndim = PyArray_NDIM(array);
   auto sizes = to_aten_shape(ndim, PyArray_DIMS(array));
   auto strides = to_aten_shape(ndim, PyArray_STRIDES(array));
@@ -108,8 +113,9 @@ at::Tensor tensor_from_numpy(PyObject* obj) {
   for (int i = 0; i < ndim; i++) {
     if (strides[i] < 0) {
       throw ValueError(
-          "some of the strides of a given numpy array are negative. This is "
-          "currently not supported, but will be added in future releases.");
+          "some of the strides of a given numpy array are negative, which "
+          "tensors cannot represent. Copy the numpy array (e.g. with "
+          "np.ascontiguousarray) first.");
     }
     // XXX: this won't work for negative strides
     storage_size += (sizes[i] - 1) * strides[i];
@@ -143,6 +149,7 @@ static int aten_to_dtype(const at::Type& type) {
       case kLong: return NPY_INT64;
       case kInt: return NPY_INT32;
       case kShort: return NPY_INT16;
+      case kChar: return NPY_INT8;
       case kByte: return NPY_UINT8;
       default: break;
     }
@@ -157,6 +164,7 @@ ScalarType numpy_dtype_to_aten(int dtype) {
     case NPY_HALF: return kHalf;
     case NPY_INT32: return kInt;
     case NPY_INT16: return kShort;
+    case NPY_INT8: return kChar;
     case NPY_UINT8: return kByte;
     default:
       // Workaround: MSVC does not support two switch cases that have the same value
@@ -170,7 +178,7 @@ ScalarType numpy_dtype_to_aten(int dtype) {
   if (!pytype) throw python_error();
   throw TypeError(
       "can't convert np.ndarray of type %s. The only supported types are: "
-      "double, float, float16, int64, int32, and uint8.",
+      "double, float, float16, int64, int32, int16, int8, and uint8.",
       ((PyTypeObject*)pytype.get())->tp_name);
 }
 
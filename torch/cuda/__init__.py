@@ -443,6 +443,159 @@ def max_memory_cached(device=None):
     return torch._C._cuda_maxMemoryCached(device)
 
 
+def memory_stats(device=None):
+    r"""Returns a dictionary of caching allocator statistics for a given
+    device.
+
+    Besides the values returned by :meth:`~torch.cuda.memory_allocated`,
+    :meth:`~torch.cuda.max_memory_allocated`, :meth:`~torch.cuda.memory_cached`
+    and :meth:`~torch.cuda.max_memory_cached` (as ``allocated_bytes``,
+    ``max_allocated_bytes``, ``cached_bytes`` and ``max_cached_bytes``), the
+    dictionary contains:
+
+    - ``inactive_split_bytes``: cached memory that can not be released because
+      other parts of the same segment are in use
+    - ``num_segments``: number of segments obtained from ``cudaMalloc``
+    - ``num_alloc_retries``: number of times ``cudaMalloc`` failed and the
+      cache was flushed
+    - ``num_ooms``: number of allocations that failed even after flushing
+      the cache
+
+    Arguments:
+        device (int, optional): selected device. Returns statistics for the
+                                current device, given by
+                                :meth:`~torch.cuda.current_device`, if
+                                :attr:`device` is ``None`` (default).
+
+    .. note::
+        See :ref:`cuda-memory-management` for more details about GPU memory
+        management.
+    """
+    _lazy_init()
+    if device is None:
+        device = current_device()
+    return torch._C._cuda_memoryStats(device)
+
+
+def memory_snapshot():
+    r"""Returns a snapshot of all segments held by the caching allocator, on
+    all devices.
+
+    Each segment is a dictionary with the keys ``device``, ``address``,
+    ``stream``, ``total_size``, ``allocated_size``, ``segment_type``
+    (``'small'`` or ``'large'``) and ``blocks``, the list of blocks the
+    segment is split into, in address order. Each block has a ``size`` and a
+    ``state``: ``'active_allocated'`` (in use by a tensor),
+    ``'active_pending_free'`` (freed, but still in use by a stream passed to
+    :meth:`~torch.Tensor.record_stream`) or ``'inactive'`` (cached).
+
+    .. note::
+        See :ref:`cuda-memory-management` for more details about GPU memory
+        management.
+    """
+    _lazy_init()
+    return torch._C._cuda_memorySnapshot()
+
+
+def _record_memory_history(enabled, max_entries=10000):
+    r"""Starts or stops recording the last :attr:`max_entries` allocations,
+    frees and ``cudaMalloc``/``cudaFree`` calls of the caching allocator,
+    together with the Python stack that caused them. Starting clears the
+    previous record. See :meth:`~torch.cuda._memory_trace`.
+    """
+    _lazy_init()
+    torch._C._cuda_recordMemoryHistory(enabled, max_entries)
+
+
+def _memory_trace():
+    r"""Returns ``(entries, stacks)``: the events recorded since
+    :meth:`~torch.cuda._record_memory_history` was enabled, oldest first, and
+    a dictionary that maps the ``stack_id`` of an entry to its Python stack
+    trace. Entries whose ``stack_id`` is 0 were caused from a thread that did
+    not hold the GIL, e.g. during the backward pass.
+    """
+    _lazy_init()
+    return torch._C._cuda_memoryTrace()
+
+
+def reserve_pinned_memory(size, count=1):
+    r"""Page-locks :attr:`count` blocks of host memory that can each hold
+    :attr:`size` bytes and adds them to the pinned memory cache.
+
+    Allocating pinned memory is slow and blocks the calling thread, e.g. the
+    pin-memory thread of a :class:`~torch.utils.data.DataLoader`. Reserving the
+    memory needed for a few batches at startup avoids paying that cost during
+    training. Requests are rounded up to a power of two, so a reserved block is
+    also used for smaller tensors.
+
+    Arguments:
+        size (int): size of each block in bytes
+        count (int, optional): number of blocks (default: 1)
+    """
+    _lazy_init()
+    torch._C._cuda_hostReserve(size, count)
+
+
+def set_pinned_memory_trim_interval(seconds):
+    r"""Releases cached pinned memory blocks that have not been used for
+    :attr:`seconds` seconds, from a background thread. A non-positive value
+    (the default) keeps cached blocks until the process exits.
+    """
+    _lazy_init()
+    torch._C._cuda_setHostTrimInterval(seconds)
+
+
+def cufft_plan_cache_max_size():
+    r"""Returns the maximum number of cuFFT plans kept by the plan cache of
+    each device.
+
+    The FFT functions (e.g. :func:`torch.fft` and :func:`torch.stft`) reuse
+    the plan made for the same signal sizes, strides, batch size and type,
+    which saves most of the time of small transforms. The least recently used
+    plans are dropped first.
+    """
+    _lazy_init()
+    return torch._C._cufft_get_plan_cache_max_size()
+
+
+def set_cufft_plan_cache_max_size(max_size):
+    r"""Sets the maximum number of cuFFT plans kept by the plan cache of each
+    device. ``0`` disables the caches.
+    """
+    _lazy_init()
+    torch._C._cufft_set_plan_cache_max_size(max_size)
+
+
+def cufft_plan_cache_size(device=None):
+    r"""Returns the number of cuFFT plans cached for a given device.
+
+    Arguments:
+        device (int, optional): selected device. Returns the number for the
+                                current device, given by
+                                :meth:`~torch.cuda.current_device`, if
+                                :attr:`device` is ``None`` (default).
+    """
+    _lazy_init()
+    if device is None:
+        device = current_device()
+    return torch._C._cufft_get_plan_cache_size(device)
+
+
+def clear_cufft_plan_cache(device=None):
+    r"""Drops the cuFFT plans cached for a given device.
+
+    Arguments:
+        device (int, optional): selected device. Clears the cache of the
+                                current device, given by
+                                :meth:`~torch.cuda.current_device`, if
+                                :attr:`device` is ``None`` (default).
+    """
+    _lazy_init()
+    if device is None:
+        device = current_device()
+    torch._C._cufft_clear_plan_cache(device)
+
+
 def _host_allocator():
     _lazy_init()
     return torch._C._cuda_cudaHostAllocator()
@@ -550,4 +703,6 @@ torch._storage_classes.add(HalfStorage)
 from . import sparse
 from . import profiler
 from . import nvtx
+from . import amp
 from .streams import Stream, Event
+from .prefetcher import Prefetcher
@@ -0,0 +1,216 @@
+import functools
+from collections import defaultdict
+
+import torch
+
+
+class autocast(object):
+    r"""Context-manager that runs CUDA ops in mixed precision.
+
+    Inside the region, the matrix multiplications and convolutions cast their
+    float CUDA arguments to half, to run on the tensor cores, while the
+    reductions, softmaxes, norms, losses and ops like ``exp``, ``log`` and
+    ``pow``, which need the range of float, cast their half arguments to
+    float. Every other op runs in the type of its arguments. The casts are
+    recorded by autograd, so the gradients of float parameters stay float,
+    and the backward pass should be run outside of the region.
+
+    ``autocast`` can also be used as a decorator. It is thread local, like
+    :class:`torch.no_grad`.
+
+    Example::
+
+        >>> model = Net().cuda()
+        >>> with torch.cuda.amp.autocast():
+        ...     loss = criterion(model(input), target)
+        >>> loss.backward()
+
+    Arguments:
+        enabled (bool, optional): whether to enable mixed precision in the
+            region. Default: ``True``.
+    """
+
+    def __init__(self, enabled=True):
+        self.enabled = enabled
+
+    def __enter__(self):
+        self.prev = torch._C.is_autocast_enabled()
+        torch._C.set_autocast_enabled(self.enabled)
+
+    def __exit__(self, *args):
+        torch._C.set_autocast_enabled(self.prev)
+        return False
+
+    def __call__(self, func):
+        @functools.wraps(func)
+        def decorate_autocast(*args, **kwargs):
+            with self:
+                return func(*args, **kwargs)
+        return decorate_autocast
+
+
+class GradScaler(object):
+    r"""Scales the loss of mixed precision training to keep the half
+    gradients from underflowing, and adjusts the scale dynamically.
+
+    :meth:`scale` multiplies the loss by the current scale before the
+    backward. :meth:`step` divides the gradients of an optimizer by it, and
+    then calls ``optimizer.step()`` unless one of them is an inf or a NaN,
+    i.e. the scale was too large. :meth:`update` then multiplies the scale by
+    :attr:`backoff_factor` if any optimizer skipped its step, or by
+    :attr:`growth_factor` after :attr:`growth_interval` iterations without
+    infs. The checks and the update of the scale stay on the device; the
+    only synchronization per iteration is the one :meth:`step` needs to
+    decide whether to skip.
+
+    Gradients can be inspected or clipped between the backward and
+    :meth:`step` after calling :meth:`unscale_`.
+
+    Example::
+
+        >>> scaler = torch.cuda.amp.GradScaler()
+        >>> for input, target in data:
+        ...     optimizer.zero_grad()
+        ...     with torch.cuda.amp.autocast():
+        ...         loss = criterion(model(input), target)
+        ...     scaler.scale(loss).backward()
+        ...     scaler.step(optimizer)
+        ...     scaler.update()
+
+    Arguments:
+        init_scale (float, optional): the initial scale. Default: ``2.**16``.
+        growth_factor (float, optional): the factor the scale grows by.
+            Default: 2.
+        backoff_factor (float, optional): the factor the scale shrinks by after
+            an overflow. Default: 0.5.
+        growth_interval (int, optional): the number of iterations without
+            infs after which the scale grows. Default: 2000.
+        enabled (bool, optional): if ``False``, every method is a no-op apart
+            from ``step``, which just calls ``optimizer.step()``. Default: ``True``.
+    """
+
+    def __init__(self, init_scale=2.**16, growth_factor=2.0, backoff_factor=0.5,
+                 growth_interval=2000, enabled=True):
+        if growth_factor <= 1.0:
+            raise ValueError("growth_factor should be > 1, but got {}".format(growth_factor))
+        if not 0.0 < backoff_factor < 1.0:
+            raise ValueError("backoff_factor should be in (0, 1), but got {}".format(backoff_factor))
+        if growth_interval <= 0:
+            raise ValueError("growth_interval should be > 0, but got {}".format(growth_interval))
+        self.init_scale = init_scale
+        self.growth_factor = growth_factor
+        self.backoff_factor = backoff_factor
+        self.growth_interval = growth_interval
+        self.enabled = enabled
+        self._init_growth_tracker = 0
+        self._scale = None
+        self._growth_tracker = None
+        # found_inf of every optimizer unscaled since the last update, by id
+        self._found_inf = {}
+
+    def _lazy_init_scale(self, device):
+        self._scale = torch.full((1,), self.init_scale, dtype=torch.float32, device=device)
+        self._growth_tracker = torch.full((1,), self._init_growth_tracker, dtype=torch.int32, device=device)
+
+    def scale(self, outputs):
+        r"""Returns outputs, a tensor or a sequence of tensors, multiplied by
+        the scale."""
+        if not self.enabled:
+            return outputs
+        if torch.is_tensor(outputs):
+            if self._scale is None:
+                self._lazy_init_scale(outputs.device)
+            return outputs * self._scale.to(outputs.device)
+        return type(outputs)(self.scale(output) for output in outputs)
+
+    def get_scale(self):
+        r"""Returns the current scale as a Python float. Synchronizes."""
+        if not self.enabled:
+            return 1.0
+        return self.init_scale if self._scale is None else self._scale.item()
+
+    def unscale_(self, optimizer):
+        r"""Divides the gradients of the parameters of optimizer by the scale,
+        in place. Called by :meth:`step` if it wasn't called since the last
+        :meth:`update`."""
+        if not self.enabled:
+            return
+        if id(optimizer) in self._found_inf:
+            raise RuntimeError("unscale_() was already called on this optimizer since the last update()")
+        if self._scale is None:
+            raise RuntimeError("unscale_() called before scale()")
+
+        # keyed by device index and type name, as devices aren't hashable
+        per_device_and_type = defaultdict(list)
+        for group in optimizer.param_groups:
+            for p in group['params']:
+                if p.grad is None:
+                    continue
+                if p.grad.is_sparse:
+                    raise RuntimeError("GradScaler doesn't support sparse gradients")
+                if not p.grad.is_contiguous():
+                    p.grad.data = p.grad.data.contiguous()
+                grad = p.grad.data
+                index = grad.get_device() if grad.is_cuda else -1
+                per_device_and_type[(index, grad.type())].append(grad)
+
+        inv_scale = self._scale.double().reciprocal().float()
+        found_infs = {}
+        for (index, _), grads in per_device_and_type.items():
+            device = grads[0].device
+            if index not in found_infs:
+                found_infs[index] = torch.zeros(1, dtype=torch.float32, device=device)
+            torch._amp_unscale(grads, found_infs[index], inv_scale.to(device))
+
+        found_inf = torch.zeros(1, dtype=torch.float32, device=self._scale.device)
+        for device_found_inf in found_infs.values():
+            found_inf += device_found_inf.to(found_inf.device)
+        self._found_inf[id(optimizer)] = found_inf
+
+    def step(self, optimizer, *args, **kwargs):
+        r"""Unscales the gradients of optimizer if needed, and calls
+        ``optimizer.step(*args, **kwargs)`` unless one of them is an inf or a
+        NaN. Returns the result of ``optimizer.step``, or ``None`` if the step
+        was skipped."""
+        if not self.enabled:
+            return optimizer.step(*args, **kwargs)
+        if id(optimizer) not in self._found_inf:
+            self.unscale_(optimizer)
+        if self._found_inf[id(optimizer)].item() == 0:
+            return optimizer.step(*args, **kwargs)
+        return None
+
+    def update(self):
+        r"""Updates the scale from the optimizers unscaled since the last
+        update. Call it once per iteration, after every :meth:`step`."""
+        if not self.enabled or self._scale is None:
+            return
+        if len(self._found_inf) == 0:
+            raise RuntimeError("update() called without any unscale_() or step() since the last update()")
+        found_inf = sum(self._found_inf.values())
+        self._scale = torch._amp_update_scale(self._growth_tracker, self._scale, found_inf,
+                                              self.growth_factor, self.backoff_factor,
+                                              self.growth_interval)
+        self._found_inf = {}
+
+    def state_dict(self):
+        r"""Returns the state of the scaler as a :class:`dict`."""
+        return {
+            'scale': self.get_scale(),
+            'growth_factor': self.growth_factor,
+            'backoff_factor': self.backoff_factor,
+            'growth_interval': self.growth_interval,
+            'growth_tracker': (self._init_growth_tracker if self._growth_tracker is None
+                               else self._growth_tracker.item()),
+        }
+
+    def load_state_dict(self, state_dict):
+        r"""Loads the state returned by :meth:`state_dict`."""
+        self.init_scale = state_dict['scale']
+        self.growth_factor = state_dict['growth_factor']
+        self.backoff_factor = state_dict['backoff_factor']
+        self.growth_interval = state_dict['growth_interval']
+        self._init_growth_tracker = state_dict['growth_tracker']
+        if self._scale is not None:
+            self._scale.fill_(state_dict['scale'])
+            self._growth_tracker.fill_(state_dict['growth_tracker'])
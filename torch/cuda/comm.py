@@ -1,8 +1,6 @@
 import torch
 from . import nccl
-from torch._utils import _accumulate, _take_tensors, _flatten_dense_tensors, \
-    _flatten_sparse_tensors, _unflatten_dense_tensors, \
-    _unflatten_sparse_tensors, _reorder_tensors_as
+from torch._utils import _accumulate, _reorder_tensors_as
 
 
 def broadcast(tensor, devices):
@@ -71,16 +69,7 @@ def reduce_add(inputs, destination=None):
                              "{}".format(i, got, expected))
     if nccl_root is None:
         raise RuntimeError("reduce_add expects destination to be on the same GPU with one of the tensors")
-    result = inp.new(device=destination).resize_as_(inp).zero_()
-
-    if nccl.is_available(inputs) and inputs[0].get_device() == destination:
-        outputs = [result] + [t.new(t.size()) for t in inputs[1:]]
-        nccl.reduce(inputs, outputs, root=nccl_root)
-        return result
-    for inp in inputs:
-        input_correct_gpu = inp.cuda(result.get_device())
-        result.add_(input_correct_gpu)
-    return result
+    return torch._C._reduce_add(inputs, destination)
 
 
 def reduce_add_coalesced(inputs, destination=None, buffer_size=10485760):
@@ -113,12 +102,11 @@ def reduce_add_coalesced(inputs, destination=None, buffer_size=10485760):
             for coll, t in zip(dense_tensors, tensor_at_gpus):
                 coll.append(t.to_dense() if t.is_sparse else t)
             ref_order.append(dense_tensors[0][-1])
-    itrs = [_take_tensors(tensors, buffer_size) for tensors in dense_tensors]
-    # now the dense ones, which have consistent sizes
-    for chunks in zip(*itrs):
-        flat_tensors = [_flatten_dense_tensors(chunk) for chunk in chunks]
-        flat_result = reduce_add(flat_tensors, destination)
-        output.extend(_unflatten_dense_tensors(flat_result, chunks[0]))
+    # now the dense ones, which have consistent sizes; they are coalesced and
+    # reduced in C++
+    if destination is None:
+        destination = torch.cuda.current_device()
+    output.extend(torch._C._reduce_add_coalesced(dense_tensors, destination, buffer_size))
     return tuple(_reorder_tensors_as(output, ref_order))
 
 
@@ -174,7 +162,6 @@ def gather(tensors, dim=0, destination=None):
         A tensor located on ``destination`` device, that is a result of
         concatenating ``tensors`` along ``dim``.
     """
-    total_size = 0
     expected_size = list(tensors[0].size())
     for tensor in tensors:
         assert tensor.is_cuda, "gather expects all inputs to be on GPUs"
@@ -184,20 +171,6 @@ def gather(tensors, dim=0, destination=None):
             expected = 'x'.join(str(x) for x in expected_size)
             raise ValueError("gather got an input of invalid size: got {}, "
                              "but expected {}".format(got, expected))
-        total_size += tensor.size(dim)
-    expected_size[dim] = total_size
-    expected_size = torch.Size(expected_size)
     if destination is None:
         destination = torch.cuda.current_device()
-    if destination == -1:
-        result = tensors[0].new().cpu().resize_(expected_size)
-    else:
-        result = tensors[0].new(expected_size, device=destination)
-
-    chunk_start = 0
-    # TODO: if copying to CPU, allocate a pinned buffer, do async copies to it,
-    # and copy it to regular memory
-    for tensor in tensors:
-        result.narrow(dim, chunk_start, tensor.size(dim)).copy_(tensor, True)
-        chunk_start += tensor.size(dim)
-    return result
+    return torch._C._gather(tensors, dim, destination)
@@ -0,0 +1,61 @@
+import torch
+from . import _lazy_init, current_device
+
+
+class Prefetcher(object):
+    r"""Copies batches of CPU tensors to a CUDA device ahead of their use.
+
+    :meth:`put` copies a batch into one of :attr:`num_buffers` pinned staging
+    buffers, which are reused from batch to batch, and from there to the
+    device on a side stream, so that the copy of the next batch overlaps with
+    the work on the current one. :meth:`get` returns the oldest batch put,
+    makes the current stream wait for its copy without blocking the host, and
+    records its tensors on the current stream, so they can be used and freed
+    like any other tensor.
+
+    Example::
+
+        >>> prefetcher = torch.cuda.Prefetcher()
+        >>> for inputs, targets in prefetcher.iterate(loader):
+        >>>     loss = criterion(model(inputs), targets)
+
+    Arguments:
+        device (int, optional): the device to copy to. Default: the current
+            device.
+        num_buffers (int, optional): the number of staging buffers, i.e. how
+            many batches can be in flight. :meth:`put` blocks when the copy of
+            the batch that last used its buffer is not done yet. Default: 2.
+    """
+
+    def __init__(self, device=None, num_buffers=2):
+        _lazy_init()
+        if device is None:
+            device = current_device()
+        self.device = device
+        self._prefetcher = torch._C._CudaPrefetcher(device, num_buffers)
+
+    def put(self, tensors):
+        r"""Starts copying a sequence of CPU tensors to the device."""
+        self._prefetcher.put(list(tensors))
+
+    def get(self):
+        r"""Returns the device tensors of the oldest batch put, as a list."""
+        return self._prefetcher.get()
+
+    def pending(self):
+        r"""Returns the number of batches put but not returned by :meth:`get`."""
+        return self._prefetcher.pending()
+
+    def iterate(self, batches):
+        r"""Yields the batches (sequences of CPU tensors) of an iterable as
+        device tensors, copying the next batch while the current one is used.
+        """
+        it = iter(batches)
+        for batch in it:
+            self.put(batch)
+            break
+        for batch in it:
+            self.put(batch)
+            yield self.get()
+        while self.pending() > 0:
+            yield self.get()
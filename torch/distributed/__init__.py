@@ -3,11 +3,18 @@ torch.distributed provides an MPI-like interface for exchanging tensor
 data across multi-machine networks. It supports a few different backends
 and initialization methods.
 """
+import sys
+import threading
 import torch
 import atexit
 import warnings
 from torch._utils import _flatten_dense_tensors, _unflatten_dense_tensors
 
+if sys.version_info[0] == 3:
+    import queue
+else:
+    import Queue as queue
+
 
 class dist_backend:
     UNDEFINED = -1
@@ -173,8 +180,15 @@ def get_world_size():
 def isend(tensor, dst):
     """Sends a tensor asynchronously.
 
+    The transfer progresses in the background (with the ``tcp`` backend, to
+    and from all peers at the same time), so that it can be overlapped with
+    computation, e.g. between the stages of a pipeline. The tensor must not
+    be modified until the request completes.
+
     Arguments:
-        tensor (Tensor): Tensor to send.
+        tensor (Tensor or list[Tensor]): Tensor to send. A list of tensors
+            is sent in order, with a single request for all of them, and can
+            be received with one :func:`irecv` per tensor or one for all.
         dst (int): Destination rank.
 
     Returns:
@@ -182,6 +196,8 @@ def isend(tensor, dst):
     """
     assert torch.distributed._initialized == _INITIALIZED_PG, \
         "collective only supported in process-group mode"
+    if isinstance(tensor, (list, tuple)):
+        return _DistributedRequest(torch._C._dist_isend_multiple(tensor, dst))
     return _DistributedRequest(torch._C._dist_isend(tensor, dst))
 
 
@@ -189,7 +205,9 @@ def irecv(tensor, src):
     """Receives a tensor asynchronously.
 
     Arguments:
-        tensor (Tensor): Tensor to fill with received data.
+        tensor (Tensor or list[Tensor]): Tensor to fill with received data.
+            A list of tensors is received in order, with a single request for
+            all of them.
         src (int): Source rank.
 
     Returns:
@@ -197,6 +215,8 @@ def irecv(tensor, src):
     """
     assert torch.distributed._initialized == _INITIALIZED_PG, \
         "collective only supported in process-group mode"
+    if isinstance(tensor, (list, tuple)):
+        return _DistributedRequest(torch._C._dist_irecv_multiple(tensor, src))
     return _DistributedRequest(torch._C._dist_irecv(tensor, src))
 
 
@@ -259,7 +279,7 @@ def broadcast_multigpu(tensor_list, src, group=group.WORLD):
     return torch._C._dist_broadcast_multigpu(tensor_list, src, group)
 
 
-def broadcast(tensor, src, group=group.WORLD):
+def broadcast(tensor, src, group=group.WORLD, async_op=False):
     """Broadcasts the tensor to the whole group.
 
     ``tensor`` must have the same number of elements in all processes
@@ -270,9 +290,19 @@ def broadcast(tensor, src, group=group.WORLD):
             process, and tensor to be used to save received data otherwise.
         src (int): Source rank.
         group (optional): Group of the collective.
+        async_op (bool, optional): Whether to return a request instead of
+            waiting for the collective. ``tensor`` must not be used until the
+            request completes. Only the ``mpi`` backend overlaps the
+            collective with other work, the others complete it before
+            returning.
+
+    Returns:
+        A distributed request object if ``async_op`` is set, None otherwise.
     """
     assert torch.distributed._initialized == _INITIALIZED_PG, \
         "collective only supported in process-group mode"
+    if async_op:
+        return _DistributedRequest(torch._C._dist_ibroadcast(tensor, src, group))
     return torch._C._dist_broadcast(tensor, src, group)
 
 
@@ -286,9 +316,15 @@ def all_reduce_multigpu(tensor_list, op=reduce_op.SUM, group=group.WORLD):
     After the call, all ``tensor`` in ``tensor_list`` is going to be bitwise
     identical in all processes.
 
-    Only nccl backend is currently supported
+    The nccl and gloo backends are currently supported
     tensors should only be GPU tensors
 
+    With the gloo backend, the reduction is hierarchical: the tensors are
+    reduced to the first GPU with NCCL, all-reduced across processes from
+    there with Gloo, and broadcast back to the other GPUs with NCCL. The
+    tensors are processed in chunks, so that the phases of consecutive chunks
+    overlap.
+
     Arguments:
         tensor list (List[Tensor]): List of input and output tensors of
             the collective. The function operates in-place and requires that
@@ -303,10 +339,76 @@ def all_reduce_multigpu(tensor_list, op=reduce_op.SUM, group=group.WORLD):
     assert torch.distributed._initialized == _INITIALIZED_PG, \
         "collective only supported in process-group mode"
 
+    if _backend == dist_backend.GLOO:
+        return _all_reduce_hierarchical(tensor_list, op, group)
     return torch._C._dist_all_reduce_multigpu(tensor_list, op, group)
 
 
-def all_reduce(tensor, op=reduce_op.SUM, group=group.WORLD):
+# Size of the chunks pipelined by _all_reduce_hierarchical
+_HIERARCHICAL_CHUNK_BYTES = 4 * 1024 * 1024
+
+
+def _all_reduce_hierarchical(tensor_list, op, group):
+    from torch.cuda import nccl
+
+    assert all(t.is_cuda and t.is_contiguous() for t in tensor_list), \
+        "hierarchical all_reduce_multigpu expects contiguous GPU tensors"
+    if len(tensor_list) == 1:
+        return all_reduce(tensor_list[0], op, group)
+
+    # ncclRedOp_t
+    nccl_op = {reduce_op.SUM: 0, reduce_op.PRODUCT: 1,
+               reduce_op.MAX: 2, reduce_op.MIN: 3}[op]
+    flat = [t.view(-1) for t in tensor_list]
+    numel = flat[0].numel()
+    chunk_numel = max(1, _HIERARCHICAL_CHUNK_BYTES // flat[0].element_size())
+    chunks = [[t.narrow(0, offset, min(chunk_numel, numel - offset)) for t in flat]
+              for offset in range(0, numel, chunk_numel)]
+
+    # The inter-process all-reduces run on their own thread (which releases
+    # the GIL), while the NCCL kernels of the next and previous chunks are
+    # queued and run on the GPUs
+    reduced = queue.Queue()
+    all_reduced = queue.Queue()
+
+    def all_reduce_chunks():
+        while True:
+            item = reduced.get()
+            if item is None:
+                return
+            chunk, event = item
+            try:
+                event.synchronize()
+                all_reduce(chunk, op, group)
+                all_reduced.put(None)
+            except Exception as e:
+                all_reduced.put(e)
+                return
+
+    thread = threading.Thread(target=all_reduce_chunks)
+    thread.daemon = True
+    thread.start()
+    try:
+        for chunk in chunks:
+            nccl.reduce(chunk, root=0, op=nccl_op)
+            with torch.cuda.device(chunk[0].get_device()):
+                event = torch.cuda.Event()
+                event.record()
+            reduced.put((chunk[0], event))
+    finally:
+        reduced.put(None)
+
+    try:
+        for chunk in chunks:
+            error = all_reduced.get()
+            if error is not None:
+                raise error
+            nccl.broadcast(chunk, root=0)
+    finally:
+        thread.join()
+
+
+def all_reduce(tensor, op=reduce_op.SUM, group=group.WORLD, async_op=False):
     """Reduces the tensor data across all machines in such a way that all get
     the final result.
 
@@ -318,9 +420,19 @@ def all_reduce(tensor, op=reduce_op.SUM, group=group.WORLD):
         op (optional): One of the values from ``torch.distributed.reduce_op``
             enum.  Specifies an operation used for element-wise reductions.
         group (optional): Group of the collective.
+        async_op (bool, optional): Whether to return a request instead of
+            waiting for the collective. ``tensor`` must not be used until the
+            request completes. Only the ``mpi`` backend overlaps the
+            collective with other work, the others complete it before
+            returning.
+
+    Returns:
+        A distributed request object if ``async_op`` is set, None otherwise.
     """
     assert torch.distributed._initialized == _INITIALIZED_PG, \
         "collective only supported in process-group mode"
+    if async_op:
+        return _DistributedRequest(torch._C._dist_iall_reduce(tensor, op, group))
     return torch._C._dist_all_reduce(tensor, op, group)
 
 
@@ -439,6 +551,63 @@ def all_gather(tensor_list, tensor, group=group.WORLD):
         return all_gather_multigpu([tensor_list], [tensor], group)
 
 
+def all_reduce_sparse(tensor, group=group.WORLD):
+    """Sums a sparse tensor across all machines and returns the coalesced
+    result, e.g. the gradient of an ``nn.Embedding(..., sparse=True)``.
+
+    Unlike :func:`all_reduce`, the tensor isn't densified: every process
+    gathers the indices and values of all others and sums the duplicate
+    entries, so the traffic is proportional to the number of nonzeros instead
+    of the size of the tensor. All tensors must have the same size and number
+    of sparse dimensions.
+
+    Arguments:
+        tensor (Tensor): Sparse input of the collective. It is not modified.
+        group (optional): Group of the collective.
+
+    Returns:
+        A coalesced sparse tensor, identical in all processes.
+    """
+    assert torch.distributed._initialized == _INITIALIZED_PG, \
+        "collective only supported in process-group mode"
+    assert tensor.is_sparse, "all_reduce_sparse expects a sparse tensor"
+    tensor = tensor.coalesce()
+    indices, values = tensor._indices(), tensor._values()
+    nnz = tensor._nnz()
+
+    if group is torch.distributed.group.WORLD:
+        group_size = get_world_size()
+    else:
+        group_size = torch.ones(1, dtype=torch.long)
+        all_reduce(group_size, group=group)
+        group_size = int(group_size[0])
+
+    # all_gather needs tensors of the same size everywhere, so the entries are
+    # padded to the largest number of nonzeros
+    counts = [torch.zeros(1, dtype=torch.long) for _ in range(group_size)]
+    all_gather(counts, torch.tensor([nnz], dtype=torch.long), group)
+    counts = [int(c[0]) for c in counts]
+    max_nnz = max(counts)
+    if max_nnz == 0:
+        return tensor
+
+    dim_i = tensor._dimI()
+    value_size = (max_nnz,) + tuple(tensor.size()[dim_i:])
+    padded_indices = torch.zeros(dim_i, max_nnz, dtype=torch.long, device=tensor.device)
+    padded_values = torch.zeros(value_size, dtype=tensor.dtype, device=tensor.device)
+    if nnz > 0:
+        padded_indices[:, :nnz].copy_(indices)
+        padded_values[:nnz].copy_(values)
+    all_indices = [torch.empty_like(padded_indices) for _ in range(group_size)]
+    all_values = [torch.empty_like(padded_values) for _ in range(group_size)]
+    all_gather(all_indices, padded_indices, group)
+    all_gather(all_values, padded_values, group)
+
+    all_indices = torch.cat([i[:, :c] for i, c in zip(all_indices, counts) if c > 0], 1)
+    all_values = torch.cat([v[:c] for v, c in zip(all_values, counts) if c > 0], 0)
+    return tensor.new(all_indices, all_values, tensor.size()).coalesce()
+
+
 def gather(tensor, **kwargs):
     """Gathers a list of tensors in a single process.
 
@@ -0,0 +1,179 @@
+"""
+Compressed all-reduces for bandwidth bound training.
+
+Each compressor has an ``all_reduce(tensor, group)`` method that can be used
+in place of :func:`torch.distributed.all_reduce` with the ``SUM`` op: only the
+compressed form of the tensor goes through the network, and the result is
+decompressed and accumulated in the type of the tensor (e.g. fp32).
+
+The compression error of every call is kept and added back to the tensor
+passed to the next call on the same buffer (error feedback), so the updates
+that are dropped are only delayed. The state is kept per buffer, identified
+by the ``key`` given to ``all_reduce`` or else by the address of the tensor,
+which suits persistent buffers such as the flat gradient buckets of
+:class:`~torch.nn.parallel.DistributedDataParallel`.
+"""
+import math
+
+import torch
+import torch.distributed as dist
+
+
+def _group_size(group):
+    if group is dist.group.WORLD:
+        return dist.get_world_size()
+    group_size = torch.ones(1, dtype=torch.long)
+    dist.all_reduce(group_size, group=group)
+    return int(group_size[0])
+
+
+class _Compressor(object):
+
+    def __init__(self):
+        self._state = {}
+
+    def _get_state(self, tensor, key, make):
+        if key is None:
+            key = tensor.data_ptr()
+        key = (key, tensor.numel(), tensor.type())
+        state = self._state.get(key)
+        if state is None:
+            state = self._state[key] = make()
+        return state
+
+    def all_reduce(self, tensor, group=dist.group.WORLD, key=None):
+        """Sums tensor across all machines in place, through its compressed
+        form.
+
+        Arguments:
+            tensor (Tensor): Dense input and output of the collective.
+            group (optional): Group of the collective.
+            key (optional): Identifies the buffer across calls, for the error
+                feedback (default: the address of tensor).
+        """
+        raise NotImplementedError
+
+
+class FP16Compressor(_Compressor):
+    """Sends the tensor in half precision.
+
+    Arguments:
+        error_feedback (bool, optional): whether to add the rounding error back
+            to the next tensor (default: ``True``).
+    """
+
+    def __init__(self, error_feedback=True):
+        super(FP16Compressor, self).__init__()
+        self.error_feedback = error_feedback
+
+    def all_reduce(self, tensor, group=dist.group.WORLD, key=None):
+        if self.error_feedback:
+            residual = self._get_state(tensor, key, lambda: torch.zeros_like(tensor))
+            tensor.add_(residual)
+        compressed = tensor.half()
+        if self.error_feedback:
+            residual.copy_(tensor).sub_(compressed.type_as(tensor))
+
+        # Gathered rather than reduced, so that the sum is done in full
+        # precision
+        gathered = [torch.empty_like(compressed) for _ in range(_group_size(group))]
+        dist.all_gather(gathered, compressed, group)
+        tensor.zero_()
+        for other in gathered:
+            tensor.add_(other.type_as(tensor))
+
+
+class TopKCompressor(_Compressor):
+    """Sends only the largest entries (in absolute value) of the tensor,
+    together with their indices.
+
+    Arguments:
+        ratio (float): fraction of the entries to send.
+    """
+
+    def __init__(self, ratio):
+        super(TopKCompressor, self).__init__()
+        if not 0 < ratio <= 1:
+            raise ValueError("ratio must be in (0, 1], got {}".format(ratio))
+        self.ratio = ratio
+
+    def all_reduce(self, tensor, group=dist.group.WORLD, key=None):
+        flat = tensor.view(-1)
+        residual = self._get_state(tensor, key, lambda: torch.zeros_like(flat))
+        flat.add_(residual)
+
+        k = max(1, int(flat.numel() * self.ratio))
+        _, indices = flat.abs().topk(k, sorted=False)
+        values = flat.index_select(0, indices)
+        residual.copy_(flat).index_fill_(0, indices, 0)
+
+        group_size = _group_size(group)
+        all_indices = [torch.empty_like(indices) for _ in range(group_size)]
+        all_values = [torch.empty_like(values) for _ in range(group_size)]
+        dist.all_gather(all_indices, indices, group)
+        dist.all_gather(all_values, values, group)
+        flat.zero_()
+        for other_indices, other_values in zip(all_indices, all_values):
+            flat.index_add_(0, other_indices, other_values)
+
+
+def _orthogonalize(matrix):
+    # Gram-Schmidt on the (few) columns
+    for i in range(matrix.size(1)):
+        col = matrix[:, i]
+        col.div_(col.norm() + 1e-8)
+        if i + 1 < matrix.size(1):
+            rest = matrix[:, i + 1:]
+            rest.sub_(col.unsqueeze(1) * col.matmul(rest).unsqueeze(0))
+
+
+class PowerSGDCompressor(_Compressor):
+    """Sends a low-rank approximation of the tensor, computed with one step of
+    power iteration (PowerSGD).
+
+    The tensor is viewed as a nearly square matrix ``M`` of ``n x m`` entries
+    (padded with zeros), and only ``(n + m) * rank`` entries are all-reduced.
+    The right factor is reused by the next call on the same buffer, which
+    makes the approximation better over time.
+
+    Arguments:
+        rank (int, optional): rank of the approximation (default: 1).
+        seed (int, optional): seed of the initial right factors, which must
+            be the same in all processes (default: 0).
+    """
+
+    def __init__(self, rank=1, seed=0):
+        super(PowerSGDCompressor, self).__init__()
+        if rank < 1:
+            raise ValueError("rank must be positive, got {}".format(rank))
+        self.rank = rank
+        self.seed = seed
+
+    def all_reduce(self, tensor, group=dist.group.WORLD, key=None):
+        numel = tensor.numel()
+        cols = int(math.ceil(math.sqrt(numel)))
+        rows = int(math.ceil(float(numel) / cols))
+        rank = min(self.rank, rows, cols)
+
+        def make_state():
+            # All processes must start from the same factor
+            generator = torch.Generator()
+            generator.manual_seed(self.seed)
+            q = torch.randn(cols, rank, generator=generator).type_as(tensor)
+            return tensor.new(rows * cols).zero_(), q
+
+        residual, q = self._get_state(tensor, key, make_state)
+        # The padding of the residual stays zero
+        residual[:numel].add_(tensor.view(-1))
+        matrix = residual.view(rows, cols)
+
+        p = matrix.matmul(q)
+        dist.all_reduce(p, group=group)
+        _orthogonalize(p)
+        q.copy_(matrix.t().matmul(p))
+
+        # Keep what this process' approximation misses, before summing the
+        # right factors
+        residual[:numel].sub_(p.matmul(q.t()).view(-1)[:numel])
+        dist.all_reduce(q, group=group)
+        tensor.view(-1).copy_(p.matmul(q.t()).view(-1)[:numel])
@@ -78,8 +78,20 @@ class Categorical(Distribution):
     def variance(self):
         return self.probs.new_tensor(float('nan')).expand(self._extended_shape())
 
+    @lazy_property
+    def _alias_tables(self):
+        return torch._multinomial_alias_setup(self.probs)
+
     def sample(self, sample_shape=torch.Size()):
         sample_shape = self._extended_shape(sample_shape)
+        if self.probs.dim() == 1:
+            # A single distribution: the tables of the alias method are built
+            # once, then every sample is drawn in O(1)
+            num_samples = 1
+            for size in sample_shape:
+                num_samples *= size
+            q, J = self._alias_tables
+            return torch._multinomial_alias_draw(q, J, num_samples).view(sample_shape)
         param_shape = sample_shape + torch.Size((self._num_events,))
         probs = self.probs.expand(param_shape)
         if self.probs.dim() == 1 or self.probs.size(0) == 1:
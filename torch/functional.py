@@ -311,7 +311,7 @@ def isnan(tensor):
     return tensor != tensor
 
 
-def unique(input, sorted=False, return_inverse=False):
+def unique(input, sorted=False, return_inverse=False, return_counts=False):
     r"""Returns the unique scalar elements of the input tensor as a 1-D tensor.
 
     Arguments:
@@ -320,9 +320,11 @@ def unique(input, sorted=False, return_inverse=False):
             before returning as output.
         return_inverse (bool): Whether to also return the indices for where
             elements in the original input ended up in the returned unique list.
+        return_counts (bool): Whether to also return the number of times each
+            unique element occurs in the input.
 
     Returns:
-        (Tensor, Tensor (optional)): A tensor or a tuple of tensors containing
+        (Tensor, Tensor (optional), Tensor (optional)): A tensor or a tuple of tensors containing
 
             - **output** (*Tensor*): the output list of unique scalar elements.
             - **inverse_indices** (*Tensor*): (optional) if
@@ -330,6 +332,10 @@ def unique(input, sorted=False, return_inverse=False):
               2nd returned tensor (same shape as input) representing the indices
               for where elements in the original input map to in the output;
               otherwise, this function will only return a single tensor.
+            - **counts** (*Tensor*): (optional) if :attr:`return_counts` is
+              True, there will be an additional returned tensor (same shape as
+              output) representing the number of occurrences of each unique
+              element.
 
     Example::
 
@@ -352,16 +358,28 @@ def unique(input, sorted=False, return_inverse=False):
         tensor([[ 0,  2],
                 [ 1,  2]])
 
+        >>> output, counts = torch.unique(
+                torch.tensor([1, 3, 2, 3], dtype=torch.long), sorted=True, return_counts=True)
+        >>> output
+        tensor([ 1,  2,  3])
+        >>> counts
+        tensor([ 1,  1,  2])
+
     """
-    output, inverse_indices = torch._unique(
+    output, inverse_indices, counts = torch._unique(
         input,
         sorted=sorted,
         return_inverse=return_inverse,
+        return_counts=return_counts,
     )
+    result = (output,)
     if return_inverse:
-        return output, inverse_indices
-    else:
+        result += (inverse_indices,)
+    if return_counts:
+        result += (counts,)
+    if len(result) == 1:
         return output
+    return result
 
 
 def argmax(input, dim=None, keepdim=False):
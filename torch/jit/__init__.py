@@ -47,7 +47,7 @@ def scope(scope_name, *vars):
             tracing_state.pop_scope()
 
 
-def compile(arg=None, nderivs=1, optimize=True, enabled=True):
+def compile(arg=None, nderivs=1, optimize=True, enabled=True, specialize_sizes=True):
     """
     Decorator which marks a function or module class as eligible for
     just-in-time compilation.  The next time the function/module is executed, it
@@ -86,6 +86,13 @@ def compile(arg=None, nderivs=1, optimize=True, enabled=True):
             Default: 1 (i.e., we will compile forwards and backwards, but not
             double-backwards).
         optimize (bool, optional): whether or not to apply optimizations.  Default: ``True``.
+        specialize_sizes (bool, optional): if ``False``, the compiled trace of a
+            function/module which is only used without derivatives (``nderivs=0``
+            or with grad disabled) is reused for inputs that only differ from
+            its own in sizes.  It is specialized to the new sizes without running
+            the Python code again.  Only use this when the function/module does
+            nothing different for other sizes, e.g., does not turn sizes into
+            Python numbers or pass them to tensor constructors.  Default: ``True``.
 
     Debug arguments:
         time (bool, optional): if ``True``, whenever we execute the model in question, we
@@ -170,6 +177,7 @@ def compile(arg=None, nderivs=1, optimize=True, enabled=True):
             def __init__(self, *args, **kwargs):
                 torch._C.CompiledFunction.__init__(self,
                                                    nderivs, optimize, enabled,
+                                                   specialize_sizes,
                                                    self.forward,
                                                    arg.__name__)
                 try:
@@ -204,6 +212,7 @@ def compile(arg=None, nderivs=1, optimize=True, enabled=True):
                             "Use @torch.jit.compile on a class instead.")
         elif callable(arg):
             compiled_fn = torch._C.CompiledFunction(nderivs, optimize, enabled,
+                                                    specialize_sizes,
                                                     arg, arg.__name__)
             return compiled_fn
         else:
@@ -547,6 +556,35 @@ def script_method(fn):
     return ScriptMethodStub(createResolutionCallback(frames_up=1), get_jit_ast(fn))
 
 
+class _Future(object):
+    def __init__(self, value):
+        self.value = value
+
+
+def fork(fn, *args):
+    """
+    Calls fn(*args) asynchronously and returns a future of its result, which
+    ``wait`` returns. In script, the call runs on the JIT's pool of inter-op
+    threads (see ``torch._C._jit_set_inter_op_threads``), so that independent
+    parts of a model run at the same time. Outside of script, fn is called
+    right away. For example::
+
+        @torch.jit.script
+        def towers(x):
+            fut = fork(tower_a, x)
+            b = tower_b(x)
+            return wait(fut) + b
+    """
+    return _Future(fn(*args))
+
+
+def wait(future):
+    """
+    Returns the result of the call started by ``fork``.
+    """
+    return future.value
+
+
 # These OrderedDictWrapper classes replace the actual OrderedDicts in
 # module with versions that get/set properties inside of script::Module.
 # This allows us to reuse most of nn.Module while still storing the
@@ -767,6 +805,36 @@ class ScriptModule(with_metaclass(ScriptMeta, Module, torch._C.ScriptModule)):
         rcb = createResolutionCallback(frames_up=1)
         self._define(lang, rcb, True)
 
+    def freeze_parameters(self):
+        r"""Turns the parameters and buffers of the methods of this module and
+        its submodules into constants holding copies of their current values,
+        and computes what depends on them alone (e.g. transposed weights)
+        ahead of time. The batch norms in inference mode that follow
+        convolutions are folded into their weights.
+
+        The methods then see no later changes to the parameters and the
+        gradients don't flow to them, so this is meant for inference. It must
+        be called before the methods are first run.
+        """
+        self._freeze_parameters()
+
+    def shape_profile(self, method='forward'):
+        r"""Returns the shape profile of a method: the input types, sizes and
+        strides that it has compiled shape-specialized plans for, as text to
+        save along with the model (e.g. after serving production traffic).
+        """
+        return self._get_method(method).shape_profile()
+
+    def precompile(self, profile, num_threads=1, method='forward'):
+        r"""Compiles the plans of a method for the inputs of a shape profile
+        (see :meth:`shape_profile`) on ``num_threads`` background threads, so
+        that the first runs of those shapes don't wait for their compilation.
+
+        Returns a future whose ``wait()`` blocks until all are compiled. The
+        method can run meanwhile.
+        """
+        return self._get_method(method).precompile(profile, num_threads)
+
 
 def _get_methods(cls):
     import inspect
@@ -16,6 +16,29 @@
 
 namespace thd {
 
+namespace {
+
+struct CompletedRequest : DataChannel::Request {
+  bool isCompleted() override { return true; }
+  void wait() override {}
+};
+
+} // namespace
+
+DataChannel::Request* DataChannel::iallReduce(at::Tensor& data,
+                                              THDReduceOp operation,
+                                              THDGroup group_id) {
+  allReduce(data, operation, group_id);
+  return new CompletedRequest();
+}
+
+DataChannel::Request* DataChannel::ibroadcast(at::Tensor& data,
+                                              rank_type src_rank,
+                                              THDGroup group_id) {
+  broadcast(data, src_rank, group_id);
+  return new CompletedRequest();
+}
+
 #define GET_CONFIG getInitConfig(init_method, world_size, group_name, rank)
 DataChannel* DataChannel::newChannel(THDChannelType type, std::string init_method,
                                      int world_size, std::string group_name,
@@ -135,6 +135,15 @@ struct DataChannel {
   virtual void broadcast(at::Tensor& data,
                          rank_type src_rank,
                          THDGroup group_id = THDGroupWORLD) = 0;
+  /**
+   * Non-blocking allReduce and broadcast: `data` must not be used until the
+   * returned request completes. Channels without asynchronous collectives
+   * run the blocking ones and return a completed request.
+   */
+  virtual Request* iallReduce(at::Tensor& data, THDReduceOp operation,
+                              THDGroup group_id = THDGroupWORLD);
+  virtual Request* ibroadcast(at::Tensor& data, rank_type src_rank,
+                              THDGroup group_id = THDGroupWORLD);
   virtual void send(Scalar& value, rank_type src_rank) = 0;
   virtual void send(at::Tensor& data, rank_type dst_rank) = 0;
   virtual void receive(Scalar& value, rank_type src_rank) = 0;
@@ -142,6 +151,13 @@ struct DataChannel {
   virtual void receive(at::Tensor& data, rank_type src_rank) = 0;
   virtual Request* isend(at::Tensor& data, rank_type dst_rank) = 0;
   virtual Request* ireceive(at::Tensor& data, rank_type src_rank) = 0;
+  /**
+   * Same as one isend/ireceive per tensor, in order, with a single request
+   * for all of them
+   */
+  virtual Request* isend(std::vector<at::Tensor>& data, rank_type dst_rank) = 0;
+  virtual Request* ireceive(std::vector<at::Tensor>& data,
+                            rank_type src_rank) = 0;
 
   virtual void barrier(THDGroup group_id = THDGroupWORLD) = 0;
 
@@ -219,14 +219,22 @@ template<typename T>
 void DataChannelGloo::allReduceT(at::Tensor& t, THDReduceOp operation,
                                  THDGroup group_id) {
   std::uint64_t tensor_bytes = t.type().elementSizeInBytes() * t.numel();
+  auto device = getDeviceType(t);
   auto ret = _cache->getAlgorithm<CollectiveType::ALL_REDUCE, T>(
-    group_id, _groups.at(group_id), getDeviceType(t), tensor_bytes, t.numel(), operation);
+    group_id, _groups.at(group_id), device, tensor_bytes, t.numel(), operation);
 
   {
     std::lock_guard<std::mutex> lock(*GlooCache::mutex(ret));
-    GlooCache::memcpy_input(ret, t);
-    GlooCache::algorithm(ret)->run();
-    GlooCache::memcpy_output(ret, t);
+    auto in_place = _cache->getInPlaceAlgorithm<CollectiveType::ALL_REDUCE, T>(
+      group_id, _groups.at(group_id), t.data_ptr(), device, tensor_bytes,
+      t.numel(), operation);
+    if (in_place) {
+      in_place->run();
+    } else {
+      GlooCache::memcpy_input(ret, t);
+      GlooCache::algorithm(ret)->run();
+      GlooCache::memcpy_output(ret, t);
+    }
   }
 }
 
@@ -248,12 +256,22 @@ template<typename T>
 void DataChannelGloo::broadcastT(at::Tensor& data, rank_type src_rank,
                                  THDGroup group_id) {
   std::uint64_t tensor_bytes = data.type().elementSizeInBytes() * data.numel();
+  auto device = getDeviceType(data);
+  auto group_src_rank = _groups.at(group_id).mustGetGroupRank(src_rank);
   auto ret = _cache->getAlgorithm<CollectiveType::BROADCAST, T>(
-    group_id, _groups.at(group_id), getDeviceType(data), tensor_bytes, data.numel(),
-    _groups.at(group_id).mustGetGroupRank(src_rank));
+    group_id, _groups.at(group_id), device, tensor_bytes, data.numel(),
+    group_src_rank);
 
   {
     std::lock_guard<std::mutex> lock(*GlooCache::mutex(ret));
+    auto in_place = _cache->getInPlaceAlgorithm<CollectiveType::BROADCAST, T>(
+      group_id, _groups.at(group_id), data.data_ptr(), device, tensor_bytes,
+      data.numel(), group_src_rank);
+    if (in_place) {
+      in_place->run();
+      return;
+    }
+
     if (_rank == src_rank) {
       GlooCache::memcpy_input(ret, data);
     }
@@ -310,6 +328,18 @@ auto DataChannelGloo::ireceive(at::Tensor& data, rank_type src_rank) -> RequestG
 }
 
 
+auto DataChannelGloo::isend(std::vector<at::Tensor>& data,
+                            rank_type dst_rank) -> RequestGloo* {
+  throw std::runtime_error("DataChannelGloo does not support isend");
+}
+
+
+auto DataChannelGloo::ireceive(std::vector<at::Tensor>& data,
+                               rank_type src_rank) -> RequestGloo* {
+  throw std::runtime_error("DataChannelGloo does not support ireceive");
+}
+
+
 void DataChannelGloo::allReduce(std::vector<at::Tensor>& data,
                                 THDReduceOp operation,
                                 THDGroup groupId) {
@@ -78,6 +78,9 @@ struct DataChannelGloo : DataChannel {
   void receive(at::Tensor& data, rank_type src_id) override;
   RequestGloo* isend(at::Tensor& data, rank_type dst_rank) override;
   RequestGloo* ireceive(at::Tensor& data, rank_type src_rank) override;
+  RequestGloo* isend(std::vector<at::Tensor>& data, rank_type dst_rank) override;
+  RequestGloo* ireceive(std::vector<at::Tensor>& data,
+                        rank_type src_rank) override;
 
   void barrier(THDGroup group_id = THDGroupWORLD) override;
 
@@ -12,6 +12,7 @@
 
 #ifdef WITH_CUDA
 #include <cuda_runtime.h>
+#include "../Cuda.hpp"
 #endif
 
 
@@ -154,6 +155,24 @@ struct AutoGPU {
   int device_ = -1;
 };
 
+/*
+ * MPI knows nothing about CUDA streams, so a CUDA-aware MPI may only touch
+ * `data` once the kernels that produce it have run. Rather than synchronizing
+ * the whole device, wait for an event recorded on the current stream of the
+ * tensor's device, which is where its producers were queued.
+ */
+static void waitForProducer(const at::Tensor& data) {
+#ifdef WITH_CUDA
+  if (!data.is_cuda()) return;
+  AutoGPU gpu_guard { static_cast<int>(data.get_device()) };
+  cudaEvent_t event;
+  THCudaCheck(cudaEventCreateWithFlags(&event, cudaEventDisableTiming));
+  THCudaCheck(cudaEventRecord(event, THCState_getCurrentStream(THDGetCudaState())));
+  THCudaCheck(cudaEventSynchronize(event));
+  THCudaCheck(cudaEventDestroy(event));
+#endif
+}
+
 at::Tensor DataChannelMPI::_newLikeFlat(std::vector<at::Tensor>& tensors) const {
   // TODO: check if all outputs are contiguous in memory and skip this step is yes
   if (tensors.size() == 0)
@@ -280,11 +299,34 @@ void DataChannelMPI::allReduce(at::Tensor& data, THDReduceOp operation,
   if (!data.is_contiguous())
     throw std::runtime_error("all_reduce input has to be contiguous");
 
+  waitForProducer(data);
   MPI_Allreduce(MPI_IN_PLACE, data.data_ptr(), data.numel(),
                 mpi_datatype.at(data.type().scalarType()), mpi_op.at(operation), comm);
 }
 
 
+DataChannelMPI::RequestMPI* DataChannelMPI::iallReduce(at::Tensor& data,
+                                                       THDReduceOp operation,
+                                                       THDGroup group_id) {
+  std::unique_ptr<RequestMPI> request { new RequestMPI() };
+  const auto& comm = _groups.at(group_id).first;
+  if (comm == MPI_COMM_NULL)
+    return request.release();
+
+  if (!data.is_contiguous())
+    throw std::runtime_error("all_reduce input has to be contiguous");
+
+  waitForProducer(data);
+  request->save_tensor_buffer(data);
+  auto& mpi_request = request->new_request();
+  MPI_Iallreduce(MPI_IN_PLACE, data.data_ptr(), data.numel(),
+                 mpi_datatype.at(data.type().scalarType()), mpi_op.at(operation),
+                 comm, &mpi_request);
+
+  return request.release();
+}
+
+
 void DataChannelMPI::reduce(at::Tensor& data, THDReduceOp operation,
                             rank_type dst_rank, THDGroup group_id) {
   const auto& group_pair = _groups.at(group_id);
@@ -314,11 +356,35 @@ void DataChannelMPI::broadcast(at::Tensor& data, rank_type src_rank,
     throw std::runtime_error("broadcast input has to be contiguous");
 
   rank_type group_src_rank = group_pair.second.mustGetGroupRank(src_rank);
+  waitForProducer(data);
   MPI_Bcast(data.data_ptr(), data.numel(), mpi_datatype.at(data.type().scalarType()),
             group_src_rank, comm);
 }
 
 
+DataChannelMPI::RequestMPI* DataChannelMPI::ibroadcast(at::Tensor& data,
+                                                       rank_type src_rank,
+                                                       THDGroup group_id) {
+  std::unique_ptr<RequestMPI> request { new RequestMPI() };
+  const auto& group_pair = _groups.at(group_id);
+  const auto& comm = group_pair.first;
+  if (comm == MPI_COMM_NULL)
+    return request.release();
+
+  if (!data.is_contiguous())
+    throw std::runtime_error("broadcast input has to be contiguous");
+
+  rank_type group_src_rank = group_pair.second.mustGetGroupRank(src_rank);
+  waitForProducer(data);
+  request->save_tensor_buffer(data);
+  auto& mpi_request = request->new_request();
+  MPI_Ibcast(data.data_ptr(), data.numel(), mpi_datatype.at(data.type().scalarType()),
+             group_src_rank, comm, &mpi_request);
+
+  return request.release();
+}
+
+
 void DataChannelMPI::send(Scalar& data, rank_type dst_rank) {
   MPI_Send(data.data(), data.elementSize(), MPI_UINT8_T,
            dst_rank, 0, MPI_COMM_WORLD);
@@ -397,6 +463,42 @@ DataChannelMPI::RequestMPI* DataChannelMPI::ireceive(at::Tensor& data,
   return request.release();
 }
 
+
+DataChannelMPI::RequestMPI* DataChannelMPI::isend(std::vector<at::Tensor>& data,
+                                                  rank_type dst_rank) {
+  std::unique_ptr<RequestMPI> request { new RequestMPI() };
+  for (auto& tensor : data) {
+    if (!tensor.is_contiguous())
+      throw std::logic_error("tensor to send is not contiguous");
+
+    request->save_tensor_buffer(tensor);
+    auto& mpi_request = request->new_request();
+    MPI_Isend(tensor.data_ptr(), tensor.numel(),
+              mpi_datatype.at(tensor.type().scalarType()),
+              dst_rank, 0, MPI_COMM_WORLD, &mpi_request);
+  }
+
+  return request.release();
+}
+
+
+DataChannelMPI::RequestMPI* DataChannelMPI::ireceive(std::vector<at::Tensor>& data,
+                                                     rank_type src_rank) {
+  std::unique_ptr<RequestMPI> request { new RequestMPI() };
+  for (auto& tensor : data) {
+    if (!tensor.is_contiguous())
+      throw std::logic_error("tensor to receive is not contiguous");
+
+    request->save_tensor_buffer(tensor);
+    auto& mpi_request = request->new_request();
+    MPI_Irecv(tensor.data_ptr(), tensor.numel(),
+              mpi_datatype.at(tensor.type().scalarType()),
+              src_rank, 0, MPI_COMM_WORLD, &mpi_request);
+  }
+
+  return request.release();
+}
+
 THDGroup DataChannelMPI::newGroup(const std::vector<rank_type>& ranks) {
   MPI_Group world_group;
   MPI_Comm_group(MPI_COMM_WORLD, &world_group);
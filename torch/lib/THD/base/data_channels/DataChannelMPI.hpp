@@ -65,6 +65,10 @@ struct DataChannelMPI : DataChannel {
                  THDGroup group_id = THDGroupWORLD) override;
   void broadcast(at::Tensor& data, rank_type src_rank,
                  THDGroup group_id = THDGroupWORLD) override;
+  RequestMPI* iallReduce(at::Tensor& data, THDReduceOp operation,
+                         THDGroup group_id = THDGroupWORLD) override;
+  RequestMPI* ibroadcast(at::Tensor& data, rank_type src_rank,
+                         THDGroup group_id = THDGroupWORLD) override;
   void send(Scalar& data, rank_type dst_rank) override;
   void send(at::Tensor& data, rank_type dst_rank) override;
   void receive(Scalar& data, rank_type src_rank) override;
@@ -72,6 +76,9 @@ struct DataChannelMPI : DataChannel {
   void receive(at::Tensor& data, rank_type src_rank) override;
   RequestMPI* isend(at::Tensor& data, rank_type dst_rank) override;
   RequestMPI* ireceive(at::Tensor& data, rank_type src_rank) override;
+  RequestMPI* isend(std::vector<at::Tensor>& data, rank_type dst_rank) override;
+  RequestMPI* ireceive(std::vector<at::Tensor>& data,
+                       rank_type src_rank) override;
 
   void barrier(THDGroup group_id = THDGroupWORLD) override;
   THDGroup newGroup(const std::vector<rank_type>& ranks) override;
@@ -718,4 +718,20 @@ DataChannelNccl::RequestNccl* DataChannelNccl::ireceive(at::Tensor& data,
 }
 
 
+DataChannelNccl::RequestNccl* DataChannelNccl::isend(
+    std::vector<at::Tensor>& data,
+    rank_type dstRank) {
+
+  throw std::runtime_error("DataChannelNccl does not support isend");
+}
+
+
+DataChannelNccl::RequestNccl* DataChannelNccl::ireceive(
+    std::vector<at::Tensor>& data,
+    rank_type srcRank) {
+
+  throw std::runtime_error("DataChannelNccl does not support ireceive");
+}
+
+
 } // namespace thd
@@ -147,6 +147,12 @@ struct DataChannelNccl : DataChannel {
 
   RequestNccl* ireceive(at::Tensor& data, rank_type srcRank) override;
 
+  RequestNccl* isend(std::vector<at::Tensor>& data,
+                     rank_type dstRank) override;
+
+  RequestNccl* ireceive(std::vector<at::Tensor>& data,
+                        rank_type srcRank) override;
+
 private:
 
   // Current process' rank
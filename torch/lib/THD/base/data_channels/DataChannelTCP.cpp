@@ -1,6 +1,5 @@
 #include "DataChannelTCP.hpp"
 
-#include <sys/poll.h>
 #include <unistd.h>
 #include <algorithm>
 #include <cstdint>
@@ -37,10 +36,17 @@ inline std::uint64_t pow2(T value) {
   return pof2;
 }
 
+// Tensors of at least this size are allreduced with the ring algorithm,
+// smaller ones with recursive doubling which needs fewer round trips.
+constexpr std::uint64_t RING_ALLREDUCE_MIN_BYTES = 1 << 18;
+// Ring allreduce receives segments in chunks of this size, so that reducing
+// one chunk overlaps with receiving the next one.
+constexpr std::uint64_t RING_ALLREDUCE_CHUNK_BYTES = 1 << 18;
+
 } // namespace
 
 
-DataChannelTCP::RequestTCP::RequestTCP(QueueWorker::Request&& request)
+DataChannelTCP::RequestTCP::RequestTCP(ProgressEngineTCP::Request&& request)
   : _request(std::move(request)) {
 }
 
@@ -68,7 +74,6 @@ DataChannelTCP::DataChannelTCP(InitMethod::Config config, int timeout)
   , _port(0)
   , _timeout(timeout)
   , _processes(config.world_size)
-  , _poll_events(nullptr)
 {
   _rank = config.rank;
 
@@ -95,6 +100,8 @@ DataChannelTCP::DataChannelTCP(InitMethod::Config config, int timeout)
 
 
 DataChannelTCP::~DataChannelTCP() {
+  // stop using the sockets before closing them
+  _engine.reset();
 
   if (_socket != -1)
     ::close(_socket);
@@ -230,6 +237,11 @@ bool DataChannelTCP::init() {
       THDGroupWORLD,
       DataChannel::Group(ranks, _processes.size() - 1)
     });
+
+    std::vector<int> sockets;
+    for (const auto& process : _processes)
+      sockets.push_back(process.rank == _rank ? -1 : process.socket);
+    _engine.reset(new ProgressEngineTCP(sockets));
   }
 
   return ok;
@@ -361,20 +373,6 @@ void DataChannelTCP::scatter(std::vector<at::Tensor>& input,
 
 void DataChannelTCP::allReduce(at::Tensor& data, THDReduceOp operation,
                                THDGroup group_id) {
-  /*
-   * Allreduce implementation is recursive doubling algorithm. It is good
-   * algorithm for small sizes of message but other (theoratically better)
-   * implementations could not be addapted because of non-commutative
-   * operations on tensors (operation cannot be commutative because this could
-   * introduce different numerical errors on different workers).
-   *
-   * More about efficiency can be found here:
-   *   > http://www.mcs.anl.gov/~thakur/papers/ijhpca-coll.pdf (section 4.5)
-   *
-   * Implementation is based on:
-   *   > https://github.com/pmodels/mpich/blob/master/src/mpi/coll/allreduce.c
-   */
-
   std::lock_guard<std::mutex> lock(_mutex);
 
   const auto& group = _groups.at(group_id);
@@ -385,6 +383,35 @@ void DataChannelTCP::allReduce(at::Tensor& data, THDReduceOp operation,
   if (!exists)
     return;
 
+  std::uint64_t tensor_bytes = data.type().elementSizeInBytes() * data.numel();
+  if (group.size() > 1 && data.is_contiguous() &&
+      tensor_bytes >= RING_ALLREDUCE_MIN_BYTES &&
+      static_cast<std::uint64_t>(data.numel()) >= group.size()) {
+    _allReduceRing(data, operation, group, group_rank);
+  } else {
+    _allReduceRecursiveDoubling(data, operation, group, group_rank);
+  }
+}
+
+
+void DataChannelTCP::_allReduceRecursiveDoubling(at::Tensor& data,
+                                                 THDReduceOp operation,
+                                                 const DataChannel::Group& group,
+                                                 rank_type group_rank) {
+  /*
+   * Allreduce implementation is recursive doubling algorithm. It is good
+   * algorithm for small sizes of message, large ones use `_allReduceRing`.
+   * Results of both are the same on all workers (reductions are done in the
+   * same order everywhere, otherwise they could introduce different
+   * numerical errors on different workers).
+   *
+   * More about efficiency can be found here:
+   *   > http://www.mcs.anl.gov/~thakur/papers/ijhpca-coll.pdf (section 4.5)
+   *
+   * Implementation is based on:
+   *   > https://github.com/pmodels/mpich/blob/master/src/mpi/coll/allreduce.c
+   */
+
   std::uint64_t tensor_bytes = data.type().elementSizeInBytes() * data.numel();
   auto tmp_tensor = data.clone();
 
@@ -437,6 +464,95 @@ void DataChannelTCP::allReduce(at::Tensor& data, THDReduceOp operation,
 }
 
 
+void DataChannelTCP::_allReduceRing(at::Tensor& data, THDReduceOp operation,
+                                    const DataChannel::Group& group,
+                                    rank_type group_rank) {
+  /*
+   * Ring allreduce: reduce-scatter followed by allgather. Tensor is split into
+   * `p` segments; in each of the first `p - 1` steps every process sends one
+   * segment to its right neighbour and reduces the one received from its left
+   * neighbour, so that process `i` ends up with the result for segment
+   * `i + 1`. Then the reduced segments are passed around the ring, for
+   * `2 * (p - 1) / p * N` bytes sent per process instead of `log(p) * N`.
+   *
+   * Each segment is reduced in the same order on its way around the ring and
+   * then copied to all other processes, so all workers get the same result.
+   *
+   * More about efficiency can be found here:
+   *   > http://www.mcs.anl.gov/~thakur/papers/ijhpca-coll.pdf (section 4.5)
+   */
+
+  const std::int64_t size = group.size();
+  const std::int64_t numel = data.numel();
+  auto flat = data.view({numel});
+  auto segment = [&](std::int64_t idx) {
+    idx = (idx % size + size) % size;
+    std::int64_t base = numel / size, rem = numel % size;
+    return flat.narrow(0, idx * base + std::min(idx, rem),
+                       base + (idx < rem ? 1 : 0));
+  };
+
+  auto left = group.mustGetGlobalRank((group_rank + size - 1) % size);
+  auto right = group.mustGetGlobalRank((group_rank + 1) % size);
+  const std::int64_t chunk_numel = std::max<std::int64_t>(
+    1, RING_ALLREDUCE_CHUNK_BYTES / data.type().elementSizeInBytes());
+
+  // a chunk is reduced from one buffer while the next one is received into
+  // the other
+  at::Tensor buffers[2] = {
+    flat.type().tensor({chunk_numel}),
+    flat.type().tensor({chunk_numel})
+  };
+
+  for (std::int64_t step = 0; step < size - 1; ++step) {
+    auto send_segment = segment(group_rank - step);
+    auto recv_segment = segment(group_rank - step - 1);
+
+    std::vector<req_ptr> send_requests;
+    for (std::int64_t offset = 0; offset < send_segment.numel(); offset += chunk_numel) {
+      auto chunk = send_segment.narrow(
+        0, offset, std::min(chunk_numel, send_segment.numel() - offset));
+      send_requests.emplace_back(isend(chunk, right));
+    }
+
+    const std::int64_t recv_numel = recv_segment.numel();
+    auto recv_chunk = [&](std::int64_t offset) {
+      return buffers[(offset / chunk_numel) % 2].narrow(
+        0, 0, std::min(chunk_numel, recv_numel - offset));
+    };
+
+    req_ptr recv_request;
+    if (recv_numel > 0) {
+      auto chunk = recv_chunk(0);
+      recv_request.reset(ireceive(chunk, left));
+    }
+    for (std::int64_t offset = 0; offset < recv_numel; offset += chunk_numel) {
+      auto received = recv_chunk(offset);
+      recv_request->wait();
+      if (offset + chunk_numel < recv_numel) {
+        auto next = recv_chunk(offset + chunk_numel);
+        recv_request.reset(ireceive(next, left));
+      }
+
+      auto result = recv_segment.narrow(0, offset, received.numel());
+      _reduce(result, received, operation);
+    }
+
+    for (auto& send_request : send_requests)
+      send_request->wait();
+  }
+
+  for (std::int64_t step = 0; step < size - 1; ++step) {
+    auto send_segment = segment(group_rank + 1 - step);
+    auto recv_segment = segment(group_rank - step);
+
+    req_ptr send_request {isend(send_segment, right)};
+    receive(recv_segment, left);
+    send_request->wait();
+  }
+}
+
+
 void DataChannelTCP::reduce(at::Tensor& data, THDReduceOp operation,
                             rank_type dst_rank, THDGroup group_id) {
   /*
@@ -527,90 +643,66 @@ void DataChannelTCP::broadcast(at::Tensor& data, rank_type src_rank,
 
 
 void DataChannelTCP::send(Scalar& data, rank_type dst_rank) {
-  auto request = _send_worker.push([this, &data, dst_rank]{
-    this->_send(data, dst_rank);
-  });
-  request.wait();
+  _send(data, dst_rank).wait();
 }
 
 
 void DataChannelTCP::send(at::Tensor& data, rank_type dst_rank) {
-  auto request = _send_worker.push([this, &data, dst_rank]{
-    this->_send(data, dst_rank);
-  });
-  request.wait();
+  _send(std::vector<at::Tensor>{data}, dst_rank).wait();
 }
 
 
 void DataChannelTCP::receive(Scalar& data, rank_type src_rank) {
-  auto request = _receive_worker.push([this, &data, src_rank]{
-    this->_receive(data, src_rank);
-  });
-  request.wait();
+  _receive(data, src_rank).wait();
 }
 
 
 rank_type DataChannelTCP::receive(at::Tensor& data) {
-  rank_type sender;
-  auto request = _receive_worker.push([this, &data, &sender]{
-    if (!this->_poll_events) {
-      // cache poll events array, it will be reused in another `receive` calls
-      this->_poll_events.reset(new struct pollfd[this->_processes.size()]);
-      for (std::size_t rank = 0; rank < this->_processes.size(); ++rank) {
-        this->_poll_events[rank] = {
-          .fd = this->_processes[rank].socket,
-          .events = POLLIN
-        };
-      }
-    }
-
-    // cleanup
-    for (std::size_t rank = 0; rank < this->_processes.size(); ++rank) {
-      this->_poll_events[rank].revents = 0;
-    }
-
-    SYSCHECK(::poll(this->_poll_events.get(), this->_processes.size(), -1)) // infinite timeout
-    for (std::size_t rank = 0; rank < this->_processes.size(); ++rank) {
-      if (this->_poll_events[rank].revents == 0)
-        continue;
-
-      if (this->_poll_events[rank].revents ^ POLLIN)
-        throw std::system_error(ECONNABORTED, std::system_category());
-
-      this->_receive(data, rank);
-      sender = rank;
-      break;
-    }
-  });
+  if (!data.is_contiguous())
+    throw std::logic_error("tensor to receive is not contiguous");
 
+  rank_type sender;
+  auto request = _engine->receiveAny(
+    &sender,
+    {{reinterpret_cast<std::uint8_t*>(data.data_ptr()),
+      data.type().elementSizeInBytes() * data.numel()}},
+    true, {}, "tensor sizes do not match"
+  );
   request.wait();
   return sender;
 }
 
 
 void DataChannelTCP::receive(at::Tensor& data, rank_type src_rank) {
-  auto request = _receive_worker.push([this, &data, src_rank]{
-    this->_receive(data, src_rank);
-  });
-  request.wait();
+  _receive(std::vector<at::Tensor>{data}, src_rank).wait();
 }
 
 
 DataChannelTCP::RequestTCP* DataChannelTCP::isend(at::Tensor& data,
                                                   rank_type dst_rank) {
-  auto request = _send_worker.push([this, data, dst_rank]{
-    this->_send(data, dst_rank);
-  });
-  return new DataChannelTCP::RequestTCP(std::move(request));
+  return new DataChannelTCP::RequestTCP(
+    _send(std::vector<at::Tensor>{data}, dst_rank)
+  );
 }
 
 
 DataChannelTCP::RequestTCP* DataChannelTCP::ireceive(at::Tensor& data,
                                                      rank_type src_rank) {
-  auto request = _receive_worker.push([this, data, src_rank]{
-    this->_receive(data, src_rank);
-  });
-  return new DataChannelTCP::RequestTCP(std::move(request));
+  return new DataChannelTCP::RequestTCP(
+    _receive(std::vector<at::Tensor>{data}, src_rank)
+  );
+}
+
+
+DataChannelTCP::RequestTCP* DataChannelTCP::isend(std::vector<at::Tensor>& data,
+                                                  rank_type dst_rank) {
+  return new DataChannelTCP::RequestTCP(_send(data, dst_rank));
+}
+
+
+DataChannelTCP::RequestTCP* DataChannelTCP::ireceive(std::vector<at::Tensor>& data,
+                                                     rank_type src_rank) {
+  return new DataChannelTCP::RequestTCP(_receive(data, src_rank));
 }
 
 
@@ -618,8 +710,8 @@ void DataChannelTCP::barrier(THDGroup group_id) {
   /*
    * Barrier is implementation of Bruck algorithm. All processes send to
    * other processes with rank (i + 2^k) and recv from process with rank (i - 2^k)
-   * with wrap-around. Since we cannot do recv and send at the same time
-   * we do recv asynchronously (thread), send byte and then wait for recv to complete.
+   * with wrap-around. The byte is received and sent at the same time, then
+   * we wait for both transfers to complete.
    */
 
   std::lock_guard<std::mutex> lock(_mutex);
@@ -632,19 +724,17 @@ void DataChannelTCP::barrier(THDGroup group_id) {
   if (!exists)
     return;
 
-  std::uint8_t byte = 1;
+  std::uint8_t send_byte = 1, recv_byte;
   for (rank_type distance = 1; distance < group.size(); distance <<= 1) {
     rank_type recv_partner = (group_rank + group.size() - distance) % group.size();
-    const auto& recv_process = _processes.at(group.mustGetGlobalRank(recv_partner));
-    auto recv_request = _receive_worker.push([&recv_process, &byte]{
-      recv_bytes<std::uint8_t>(recv_process.socket, &byte, 1);
-    });
+    auto recv_request = _engine->receive(
+      group.mustGetGlobalRank(recv_partner), {{&recv_byte, 1}}, false
+    );
 
     rank_type send_partner = (group_rank + distance) % group.size();
-    const auto& send_process = _processes.at(group.mustGetGlobalRank(send_partner));
-    auto send_request = _send_worker.push([&send_process, &byte]{
-      send_bytes<std::uint8_t>(send_process.socket, &byte, 1);
-    });
+    auto send_request = _engine->send(
+      group.mustGetGlobalRank(send_partner), {{&send_byte, 1}}, false
+    );
 
     send_request.wait();
     recv_request.wait();
@@ -661,7 +751,8 @@ THDGroup DataChannelTCP::newGroup(const std::vector<rank_type>& ranks) {
 }
 
 
-void DataChannelTCP::_send(const Scalar& data, rank_type dst_rank) {
+ProgressEngineTCP::Request DataChannelTCP::_send(const Scalar& data,
+                                                 rank_type dst_rank) {
   /*
    * We have to check if dst_rank is positive to properly use `.at` function in vector.
    * Not checking that can result in int overflow and strange errors.
@@ -671,20 +762,16 @@ void DataChannelTCP::_send(const Scalar& data, rank_type dst_rank) {
   if (process_dst.rank == _rank)
     throw std::logic_error("cannot send scalar to process with same rank");
 
-  // send size of scalar in bytes
-  std::uint64_t scalar_bytes = data.elementSize();
-  send_bytes<std::uint64_t>(process_dst.socket, &scalar_bytes, 1, true);
-
-  // send data (bytes)
-  send_bytes<std::uint8_t>(
-    process_dst.socket,
-    reinterpret_cast<const std::uint8_t*>(data.data()),
-    scalar_bytes
-  );
+  // size of scalar in bytes goes first
+  return _engine->send(dst_rank, {{
+    reinterpret_cast<std::uint8_t*>(const_cast<void*>(data.data())),
+    data.elementSize()
+  }}, true);
 }
 
 
-void DataChannelTCP::_send(const at::Tensor& data, rank_type dst_rank) {
+ProgressEngineTCP::Request DataChannelTCP::_send(const std::vector<at::Tensor>& data,
+                                                 rank_type dst_rank) {
   /*
    * We have to check if dst_rank is positive to properly use `.at` function in vector.
    * Not checking that can result in int overflow and strange errors.
@@ -694,23 +781,24 @@ void DataChannelTCP::_send(const at::Tensor& data, rank_type dst_rank) {
   if (process_dst.rank == _rank)
     throw std::logic_error("cannot send tensor to process with same rank");
 
-  if (!data.is_contiguous())
-    throw std::logic_error("tensor to send is not contiguous");
+  // every tensor is sent as the size of its data in bytes, then the data
+  std::vector<ProgressEngineTCP::Buffer> buffers;
+  for (const auto& tensor : data) {
+    if (!tensor.is_contiguous())
+      throw std::logic_error("tensor to send is not contiguous");
 
-  // send size of tensor data in bytes
-  std::uint64_t tensor_bytes = data.type().elementSizeInBytes() * data.numel();
-  send_bytes<std::uint64_t>(process_dst.socket, &tensor_bytes, 1, true);
+    buffers.push_back({
+      reinterpret_cast<std::uint8_t*>(tensor.data_ptr()),
+      tensor.type().elementSizeInBytes() * tensor.numel()
+    });
+  }
 
-  // send data (bytes)
-  send_bytes<std::uint8_t>(
-    process_dst.socket,
-    reinterpret_cast<const std::uint8_t*>(data.data_ptr()),
-    tensor_bytes
-  );
+  return _engine->send(dst_rank, std::move(buffers), true, data);
 }
 
 
-void DataChannelTCP::_receive(Scalar& data, rank_type src_rank) {
+ProgressEngineTCP::Request DataChannelTCP::_receive(Scalar& data,
+                                                    rank_type src_rank) {
   /*
    * We have to check if src_rank is positive to properly use `.at` function in vector.
    * Not checking that can result in int overflow and strange errors.
@@ -720,27 +808,15 @@ void DataChannelTCP::_receive(Scalar& data, rank_type src_rank) {
   if (process_src.rank == _rank)
     throw std::logic_error("cannot receive scalar from process with same rank");
 
-  // get size of scalar in bytes
-  std::uint64_t scalar_bytes;
-  recv_bytes<std::uint64_t>(process_src.socket, &scalar_bytes, 1);
-
-  std::uint64_t actual_scalar_bytes = data.elementSize();
-  if (actual_scalar_bytes == scalar_bytes) {
-    recv_bytes<std::uint8_t>(
-      process_src.socket,
-      reinterpret_cast<std::uint8_t*>(data.data()),
-      scalar_bytes
-    );
-  } else {
-    // remove invalid data from recv buffer
-    std::unique_ptr<std::uint8_t[]> bytes(new std::uint8_t[scalar_bytes]);
-    recv_bytes<std::uint8_t>(process_src.socket, bytes.get(), scalar_bytes);
-    throw std::logic_error("scalar sizes do not match");
-  }
+  return _engine->receive(src_rank, {{
+    reinterpret_cast<std::uint8_t*>(data.data()),
+    data.elementSize()
+  }}, true, {}, "scalar sizes do not match");
 }
 
 
-void DataChannelTCP::_receive(const at::Tensor& data, rank_type src_rank) {
+ProgressEngineTCP::Request DataChannelTCP::_receive(const std::vector<at::Tensor>& data,
+                                                    rank_type src_rank) {
   /*
    * We have to check if src_rank is positive to properly use `.at` function in vector.
    * Not checking that can result in int overflow and strange errors.
@@ -750,26 +826,19 @@ void DataChannelTCP::_receive(const at::Tensor& data, rank_type src_rank) {
   if (process_src.rank == _rank)
     throw std::logic_error("cannot receive tensor from process with same rank");
 
-  if (!data.is_contiguous())
-    throw std::logic_error("tensor to receive is not contiguous");
-
-  // get size of tensor data in bytes
-  std::uint64_t tensor_bytes;
-  recv_bytes<std::uint64_t>(process_src.socket, &tensor_bytes, 1);
+  std::vector<ProgressEngineTCP::Buffer> buffers;
+  for (const auto& tensor : data) {
+    if (!tensor.is_contiguous())
+      throw std::logic_error("tensor to receive is not contiguous");
 
-  std::uint64_t actual_tensor_bytes = data.type().elementSizeInBytes() * data.numel();
-  if (actual_tensor_bytes == tensor_bytes) {
-    recv_bytes<std::uint8_t>(
-      process_src.socket,
-      reinterpret_cast<std::uint8_t*>(data.data_ptr()),
-      tensor_bytes
-    );
-  } else {
-    // remove invalid data from recv buffer
-    std::unique_ptr<std::uint8_t[]> bytes(new std::uint8_t[tensor_bytes]);
-    recv_bytes<std::uint8_t>(process_src.socket, bytes.get(), tensor_bytes);
-    throw std::logic_error("tensor sizes do not match");
+    buffers.push_back({
+      reinterpret_cast<std::uint8_t*>(tensor.data_ptr()),
+      tensor.type().elementSizeInBytes() * tensor.numel()
+    });
   }
+
+  return _engine->receive(src_rank, std::move(buffers), true, data,
+                          "tensor sizes do not match");
 }
 
 void DataChannelTCP::_reduce(at::Tensor& result, at::Tensor& data,
@@ -791,10 +860,30 @@ void DataChannelTCP::_reduce(at::Tensor& result, at::Tensor& data,
 
 void DataChannelTCP::allReduce(std::vector<at::Tensor>& data,
                                THDReduceOp operation,
-                               THDGroup groupId) {
+                               THDGroup group_id) {
+  /*
+   * Tensors are reduced locally into the first one, which is then allreduced
+   * across processes and copied back to the other tensors.
+   */
 
-  throw std::runtime_error("DataChannelTCP does not support mult-GPU cross "
-                           "node allreduce");
+  if (data.size() == 0)
+    throw std::logic_error("allReduce: received an empty list");
+
+  bool exists;
+  std::tie(std::ignore, exists) = _groups.at(group_id).getGroupRank(_rank);
+  if (!exists)
+    return;
+
+  for (auto& tensor : data)
+    assertSameSizeAndType(tensor, data[0], "allReduce");
+
+  for (std::size_t i = 1; i < data.size(); ++i)
+    _reduce(data[0], data[i], operation);
+
+  allReduce(data[0], operation, group_id);
+
+  for (std::size_t i = 1; i < data.size(); ++i)
+    data[i].copy_(data[0]);
 }
 
 
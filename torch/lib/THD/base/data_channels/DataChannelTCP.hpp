@@ -2,8 +2,8 @@
 
 #include "../DataChannel.hpp"
 #include "DataChannelUtils.hpp"
+#include "ProgressEngineTCP.hpp"
 
-#include <sys/poll.h>
 #include <cstdint>
 #include <map>
 #include <memory>
@@ -16,14 +16,14 @@ namespace thd {
 struct DataChannelTCP : DataChannel {
 
   struct RequestTCP : DataChannel::Request {
-    RequestTCP(QueueWorker::Request&& request);
+    RequestTCP(ProgressEngineTCP::Request&& request);
     virtual ~RequestTCP();
 
     virtual bool isCompleted() override;
     virtual void wait() override;
 
   private:
-    QueueWorker::Request _request;
+    ProgressEngineTCP::Request _request;
   };
 
   DataChannelTCP(InitMethod::Config config);
@@ -68,6 +68,9 @@ struct DataChannelTCP : DataChannel {
   void receive(at::Tensor& data, rank_type src_id) override;
   RequestTCP* isend(at::Tensor& data, rank_type dst_rank) override;
   RequestTCP* ireceive(at::Tensor& data, rank_type src_rank) override;
+  RequestTCP* isend(std::vector<at::Tensor>& data, rank_type dst_rank) override;
+  RequestTCP* ireceive(std::vector<at::Tensor>& data,
+                       rank_type src_rank) override;
 
   void barrier(THDGroup group_id = THDGroupWORLD) override;
 
@@ -87,12 +90,19 @@ private:
   bool initMaster();
   bool initWorker();
 
-  void _send(const Scalar& data, rank_type dst_id);
-  void _send(const at::Tensor& data, rank_type dst_id);
-  void _receive(Scalar& data, rank_type src_id);
-  void _receive(const at::Tensor& data, rank_type src_id);
+  ProgressEngineTCP::Request _send(const Scalar& data, rank_type dst_id);
+  ProgressEngineTCP::Request _send(const std::vector<at::Tensor>& data,
+                                   rank_type dst_id);
+  ProgressEngineTCP::Request _receive(Scalar& data, rank_type src_id);
+  ProgressEngineTCP::Request _receive(const std::vector<at::Tensor>& data,
+                                      rank_type src_id);
   void _reduce(at::Tensor& result, at::Tensor& data,
                THDReduceOp operation) const;
+  void _allReduceRecursiveDoubling(at::Tensor& data, THDReduceOp operation,
+                                   const DataChannel::Group& group,
+                                   rank_type group_rank);
+  void _allReduceRing(at::Tensor& data, THDReduceOp operation,
+                      const DataChannel::Group& group, rank_type group_rank);
 
 
   rank_type _rank; // Rank of current process, range: [0.._processes.size()-1]
@@ -101,7 +111,6 @@ private:
   int _timeout; // Accept waiting timeout in milliseconds (it is optional, default = infinity)
 
   std::vector<Process> _processes; // Other processes in network
-  std::unique_ptr<struct pollfd[]> _poll_events; // Events array for `poll`
 
   // General mutex for methods - to protect access to the TCP data channel.
   std::mutex _mutex;
@@ -109,8 +118,8 @@ private:
   // Existing groups of processes and corresponding group ids
   std::unordered_map<THDGroup, DataChannel::Group> _groups;
 
-  // Workers
-  QueueWorker _send_worker, _receive_worker;
+  // Moves the data of all point-to-point transfers, set up by `init`
+  std::unique_ptr<ProgressEngineTCP> _engine;
 
 };
 
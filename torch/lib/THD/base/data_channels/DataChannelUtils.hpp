@@ -58,7 +58,7 @@ private:
 
     void wait() {
       std::unique_lock<std::mutex> ulock(_mutex);
-      if (!_completed)
+      while (!_completed)
         _cond.wait(ulock);
 
       _validate();
@@ -93,7 +93,10 @@ public:
   }
 
   ~QueueWorker() {
-    _exiting = true;
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _exiting = true;
+    }
     _cond.notify_one();
     _main_thread.join();
   }
@@ -109,7 +112,7 @@ public:
 private:
   std::shared_ptr<Task> _pop() {
     std::unique_lock<std::mutex> ulock(_mutex);
-    if (_queue.empty())
+    while (_queue.empty() && !_exiting)
       _cond.wait(ulock);
 
     if (_exiting) // check if we were woken up by destructor
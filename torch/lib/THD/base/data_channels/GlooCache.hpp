@@ -49,6 +49,13 @@ const int UNUSED_STREAM = -1;
 const rank_type UNUSED_RANK = -1;
 const std::size_t UNUSED_BYTES = 0;
 
+// Collectives on tensors of at least this size run in place on the tensors
+// memory, instead of being staged through the cached buffers, once the same
+// memory is seen twice in a row (see GlooCache::getInPlaceAlgorithm)
+const std::size_t IN_PLACE_MIN_BYTES = 1 << 20;
+// Number of in-place instances kept per algorithm key
+const std::size_t IN_PLACE_INSTANCES = 2;
+
 // Forward declaration
 template<CollectiveType D, typename T>
 struct algorithm_spec;
@@ -108,6 +115,25 @@ struct GlooCache {
     return std::get<3>(t);
   }
 
+  // Instances of an algorithm bound to the memory of the tensors they were
+  // created for. They are never used for a tensor elsewhere in memory, and for
+  // a tensor at the same place only while it is there.
+  struct InPlaceEntries {
+    struct Instance {
+      void* data;
+      std::shared_ptr<algorithm_type> algorithm;
+      std::uint64_t last_used;
+    };
+
+    std::vector<Instance> instances;
+    // Number of collectives that could have run in place, for the LRU
+    std::uint64_t calls = 0;
+    // Number of instances created so far, to name their contexts
+    std::uint64_t created = 0;
+    // Memory of the last staged collective
+    void* candidate = nullptr;
+  };
+
 
   // NOTE: this function needs to be thread safe
   std::shared_ptr<context_type> createContext(
@@ -177,6 +203,81 @@ struct GlooCache {
     return it->second;
   }
 
+  /**
+   * Returns an instance of the algorithm that runs in place on `data`, or
+   * nullptr if the collective has to be staged through the buffers returned
+   * by getAlgorithm, whose mutex must be held.
+   *
+   * Gloo algorithms are bound to their buffers when they are created, and
+   * their creation is itself collective, so all processes of the group have
+   * to agree on which instance to run (or to create), while the memory of
+   * their tensors differs. For large collectives, that agreement costs one
+   * small CPU all-reduce, which is far cheaper than the copies in and out of
+   * the staging buffers. An instance is only created for memory that was
+   * used twice in a row in all processes, like persistent gradient buckets,
+   * so that tensors that come and go keep using the staging buffers.
+   */
+  template<CollectiveType D, typename T, typename Extra>
+  std::shared_ptr<algorithm_type> getInPlaceAlgorithm(
+    THDGroup group_id, const DataChannelGloo::Group& group, void* data,
+    DeviceType device, std::size_t bytes, std::size_t count, Extra extra
+  ) {
+    if (bytes < gloo_cache::IN_PLACE_MIN_BYTES)
+      return nullptr;
+
+    auto key = gloo_cache::algorithm_spec<D, T>::key(group_id, device, bytes, count, extra);
+    std::unique_lock<std::mutex> lock(_mutex);
+    // NOTE: references to the map elements survive rehashing
+    auto& entries = _in_place[key];
+    lock.unlock();
+
+    // 1-based index of the (most recent) instance bound to `data`, 0 if
+    // `data` is the candidate for a new instance, -1 otherwise
+    std::int64_t state = data == entries.candidate ? 0 : -1;
+    for (std::size_t i = 0; i < entries.instances.size(); ++i) {
+      if (entries.instances[i].data == data &&
+          (state <= 0 || entries.instances[i].last_used >
+                           entries.instances[state - 1].last_used)) {
+        state = i + 1;
+      }
+    }
+
+    std::int64_t min_state, max_state;
+    std::tie(min_state, max_state) = agree(group_id, group, state);
+    entries.calls++;
+
+    if (min_state == max_state && max_state > 0) {
+      auto& instance = entries.instances[max_state - 1];
+      instance.last_used = entries.calls;
+      return instance.algorithm;
+    }
+
+    if (min_state < 0) {
+      entries.candidate = data;
+      return nullptr;
+    }
+
+    // Everybody has seen its memory before, bind a new instance to it in
+    // place of the least recently used one
+    std::size_t slot = entries.instances.size();
+    if (slot == gloo_cache::IN_PLACE_INSTANCES) {
+      slot = 0;
+      for (std::size_t i = 1; i < entries.instances.size(); ++i) {
+        if (entries.instances[i].last_used < entries.instances[slot].last_used)
+          slot = i;
+      }
+    } else {
+      entries.instances.emplace_back();
+    }
+
+    auto prefix = print_key(key) + "-inplace-" + std::to_string(entries.created++);
+    auto algorithm = gloo_cache::algorithm_spec<D, T>::create_in_place(
+      *this, group, prefix, reinterpret_cast<T*>(data), device, count, extra);
+    entries.instances[slot] = {data, algorithm, entries.calls};
+    entries.candidate = nullptr;
+    return algorithm;
+  }
+
   static void memcpy_input(value_type& info, at::Tensor& t) {
     std::uint64_t tensor_bytes = t.type().elementSizeInBytes() * t.numel();
     auto t_dev = getDeviceType(t);
@@ -214,6 +315,22 @@ struct GlooCache {
   }
 
 private:
+  // Returns the minimum and the maximum of `value` over the group
+  std::pair<std::int64_t, std::int64_t> agree(
+    THDGroup group_id, const DataChannelGloo::Group& group, std::int64_t value
+  ) {
+    auto ret = getAlgorithm<CollectiveType::ALL_REDUCE, std::int64_t>(
+      group_id, group, DeviceType::CPU, 2 * sizeof(std::int64_t),
+      std::size_t(2), THDReduceMAX);
+
+    std::lock_guard<std::mutex> lock(*GlooCache::mutex(ret));
+    auto buffer = reinterpret_cast<std::int64_t*>(GlooCache::input_buffer(ret).get());
+    buffer[0] = value;
+    buffer[1] = -value;
+    GlooCache::algorithm(ret)->run();
+    return std::make_pair(-buffer[1], buffer[0]);
+  }
+
   std::string print_key(const key_type& k) {
     return std::to_string(static_cast<uint8_t>(std::get<0>(k))) + "-"
       + std::to_string(std::get<1>(k)) + "-"
@@ -232,6 +349,7 @@ private:
   std::mutex _mutex;
 
   std::unordered_map<key_type, value_type> _algorithms;
+  std::unordered_map<key_type, InPlaceEntries> _in_place;
 };
 
 namespace gloo_cache {
@@ -308,14 +426,29 @@ struct algorithm_spec<CollectiveType::ALL_REDUCE, T> {
     const DataChannelGloo::Group& group, const std::string& store_prefix,
     DeviceType device, std::size_t input_bytes, std::size_t count, THDReduceOp op
   ) {
-    auto context = cache.createContext(group, store_prefix);
     auto input_buffer = cache.createBuffer(input_bytes, device);
+    auto algo = create_in_place(cache, group, store_prefix,
+      reinterpret_cast<T*>(input_buffer.get()), device, count, op);
+
+    return std::make_tuple(
+      algo,
+      input_buffer,
+      input_buffer, // we get the result in same buffer
+      std::make_shared<std::mutex>()
+    );
+  }
+
+  static std::shared_ptr<GlooCache::algorithm_type> create_in_place(GlooCache& cache,
+    const DataChannelGloo::Group& group, const std::string& store_prefix,
+    T* data, DeviceType device, std::size_t count, THDReduceOp op
+  ) {
+    auto context = cache.createContext(group, store_prefix);
 
     std::shared_ptr<GlooCache::algorithm_type> algo;
     if (device == DeviceType::CPU) {
       algo = std::make_shared<::gloo::AllreduceRing<T>>(
         context,
-        std::initializer_list<T*>{reinterpret_cast<T*>(input_buffer.get())},
+        std::initializer_list<T*>{data},
         count,
         THDToGlooReduceOp<T>(op));
 #ifdef WITH_CUDA
@@ -331,7 +464,7 @@ struct algorithm_spec<CollectiveType::ALL_REDUCE, T> {
         algo = std::make_shared<::gloo::CudaAllreduceHalvingDoublingPipelined<T,
                                 ::gloo::CudaDeviceWorkspace<T>>>(
           context,
-          std::initializer_list<T*>{reinterpret_cast<T*>(input_buffer.get())},
+          std::initializer_list<T*>{data},
           count,
           std::vector<cudaStream_t>{stream});
       } else
@@ -340,7 +473,7 @@ struct algorithm_spec<CollectiveType::ALL_REDUCE, T> {
         algo = std::make_shared<::gloo::CudaAllreduceHalvingDoublingPipelined<T,
                                 ::gloo::CudaHostWorkspace<T>>>(
           context,
-          std::initializer_list<T*>{reinterpret_cast<T*>(input_buffer.get())},
+          std::initializer_list<T*>{data},
           count,
           std::vector<cudaStream_t>{stream});
       }
@@ -350,12 +483,7 @@ struct algorithm_spec<CollectiveType::ALL_REDUCE, T> {
       throw std::runtime_error("unsupported tensor device in Gloo allReduce");
     }
 
-    return std::make_tuple(
-      algo,
-      input_buffer,
-      input_buffer, // we get the result in same buffer
-      std::make_shared<std::mutex>()
-    );
+    return algo;
   }
 };
 
@@ -378,14 +506,29 @@ struct algorithm_spec<CollectiveType::BROADCAST, T> {
     const DataChannelGloo::Group& group, const std::string& store_prefix,
     DeviceType device, std::size_t input_bytes, std::size_t count, rank_type src_rank
   ) {
-    auto context = cache.createContext(group, store_prefix);
     auto input_buffer = cache.createBuffer(input_bytes, device);
+    auto algo = create_in_place(cache, group, store_prefix,
+      reinterpret_cast<T*>(input_buffer.get()), device, count, src_rank);
+
+    return std::make_tuple(
+      algo,
+      input_buffer,
+      input_buffer, // we get the result in same buffer
+      std::make_shared<std::mutex>()
+    );
+  }
+
+  static std::shared_ptr<GlooCache::algorithm_type> create_in_place(GlooCache& cache,
+    const DataChannelGloo::Group& group, const std::string& store_prefix,
+    T* data, DeviceType device, std::size_t count, rank_type src_rank
+  ) {
+    auto context = cache.createContext(group, store_prefix);
 
     std::shared_ptr<GlooCache::algorithm_type> algo;
     if (device == DeviceType::CPU) {
       algo = std::make_shared<::gloo::BroadcastOneToAll<T>>(
         context,
-        std::initializer_list<T*>{reinterpret_cast<T*>(input_buffer.get())},
+        std::initializer_list<T*>{data},
         count,
         src_rank);
 #ifdef WITH_CUDA
@@ -398,7 +541,7 @@ struct algorithm_spec<CollectiveType::BROADCAST, T> {
         algo = std::make_shared<::gloo::CudaBroadcastOneToAll<T,
                                 ::gloo::CudaDeviceWorkspace<T>>>(
           context,
-          std::initializer_list<T*>{reinterpret_cast<T*>(input_buffer.get())},
+          std::initializer_list<T*>{data},
           count,
           src_rank,
           0,
@@ -409,7 +552,7 @@ struct algorithm_spec<CollectiveType::BROADCAST, T> {
         algo = std::make_shared<::gloo::CudaBroadcastOneToAll<T,
                                 ::gloo::CudaHostWorkspace<T>>>(
           context,
-          std::initializer_list<T*>{reinterpret_cast<T*>(input_buffer.get())},
+          std::initializer_list<T*>{data},
           count,
           src_rank,
           0,
@@ -421,12 +564,7 @@ struct algorithm_spec<CollectiveType::BROADCAST, T> {
       throw std::runtime_error("unsupported tensor device in Gloo broadcast");
     }
 
-    return std::make_tuple(
-      algo,
-      input_buffer,
-      input_buffer, // we get the result in same buffer
-      std::make_shared<std::mutex>()
-    );
+    return algo;
   }
 };
 
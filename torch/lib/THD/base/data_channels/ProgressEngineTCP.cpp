@@ -0,0 +1,434 @@
+#include "ProgressEngineTCP.hpp"
+
+#include <fcntl.h>
+#include <sys/poll.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+
+
+namespace thd {
+namespace {
+
+// Most buffers passed to a single `sendmsg` call
+constexpr std::size_t MAX_IOVECS = 64;
+// Size of the chunks in which the data of bad sizes is dropped
+constexpr std::size_t DISCARD_BYTES = 1 << 16;
+
+} // namespace
+
+
+struct ProgressEngineTCP::Transfer {
+  Transfer(rank_type rank, std::vector<Buffer>&& buffers, bool framed,
+           bool receiving, std::vector<at::Tensor>&& tensors)
+    : rank(rank)
+    , framed(framed)
+    , receiving(receiving)
+    , tensors(std::move(tensors))
+    , headers(framed ? buffers.size() : 0)
+    , bad_size(false)
+    , sender(nullptr)
+    , piece(0)
+    , offset(0)
+    , completed(false)
+  {
+    pieces.reserve(framed ? 2 * buffers.size() : buffers.size());
+    for (std::size_t i = 0; i < buffers.size(); ++i) {
+      if (framed) {
+        headers[i] = buffers[i].bytes;
+        pieces.push_back({
+          reinterpret_cast<std::uint8_t*>(&headers[i]),
+          sizeof(std::uint64_t)
+        });
+      }
+      pieces.push_back(buffers[i]);
+    }
+  }
+
+  bool done() {
+    // skip the buffers left empty
+    while (piece < pieces.size() && offset == pieces[piece].bytes)
+      next();
+    return piece == pieces.size();
+  }
+
+  void consume(std::uint64_t bytes) {
+    while (bytes > 0) {
+      auto n = std::min(bytes, pieces[piece].bytes - offset);
+      offset += n;
+      bytes -= n;
+      if (offset == pieces[piece].bytes)
+        next();
+    }
+  }
+
+  void next() {
+    if (receiving && framed && piece % 2 == 0) {
+      // the size of the next buffer has just been received
+      auto& buffer = pieces[piece + 1];
+      std::uint64_t bytes = headers[piece / 2];
+      if (bytes != buffer.bytes) {
+        bad_size = true;
+        buffer = {nullptr, bytes};
+      }
+    }
+    piece++;
+    offset = 0;
+  }
+
+  void complete(std::exception_ptr exception = nullptr) {
+    std::unique_lock<std::mutex> ulock(mutex);
+    tensors.clear();
+    this->exception = exception;
+    completed = true;
+    ulock.unlock();
+    cond.notify_all();
+  }
+
+  rank_type rank;
+  bool framed;
+  bool receiving;
+  std::vector<at::Tensor> tensors; // Kept alive until completion
+  std::string size_error;
+
+  // The headers (when framed) and buffers, in the order of the stream
+  std::vector<Buffer> pieces;
+  std::vector<std::uint64_t> headers;
+  bool bad_size;
+  rank_type* sender; // Set for receives from any source
+
+  // Position in the stream
+  std::size_t piece;
+  std::uint64_t offset;
+
+  std::mutex mutex;
+  std::condition_variable cond;
+  bool completed;
+  std::exception_ptr exception;
+};
+
+
+ProgressEngineTCP::Request::Request(std::shared_ptr<Transfer> transfer)
+  : _transfer(std::move(transfer)) {
+}
+
+
+void ProgressEngineTCP::Request::wait() {
+  std::unique_lock<std::mutex> ulock(_transfer->mutex);
+  while (!_transfer->completed)
+    _transfer->cond.wait(ulock);
+
+  if (_transfer->exception)
+    std::rethrow_exception(_transfer->exception);
+}
+
+
+bool ProgressEngineTCP::Request::isCompleted() {
+  std::unique_lock<std::mutex> ulock(_transfer->mutex);
+  if (_transfer->exception)
+    std::rethrow_exception(_transfer->exception);
+
+  return _transfer->completed;
+}
+
+
+ProgressEngineTCP::ProgressEngineTCP(std::vector<int> sockets)
+  : _peers(sockets.size())
+  , _discarded(DISCARD_BYTES)
+  , _exiting(false)
+{
+  for (std::size_t rank = 0; rank < sockets.size(); ++rank)
+    _peers[rank].socket = sockets[rank];
+
+  SYSCHECK(::pipe(_wakeup));
+  for (auto fd : _wakeup)
+    SYSCHECK(::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK));
+
+  _thread = std::thread(&ProgressEngineTCP::_run, this);
+}
+
+
+ProgressEngineTCP::~ProgressEngineTCP() {
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _exiting = true;
+  }
+  char byte = 0;
+  while (::write(_wakeup[1], &byte, 1) < 0 && errno == EINTR) {}
+  _thread.join();
+
+  for (auto fd : _wakeup)
+    ::close(fd);
+}
+
+
+auto ProgressEngineTCP::send(rank_type dst_rank, std::vector<Buffer> buffers,
+                             bool framed, std::vector<at::Tensor> tensors)
+    -> Request {
+  return _post(std::make_shared<Transfer>(
+    dst_rank, std::move(buffers), framed, false, std::move(tensors)
+  ));
+}
+
+
+auto ProgressEngineTCP::receive(rank_type src_rank, std::vector<Buffer> buffers,
+                                bool framed, std::vector<at::Tensor> tensors,
+                                std::string size_error) -> Request {
+  auto transfer = std::make_shared<Transfer>(
+    src_rank, std::move(buffers), framed, true, std::move(tensors)
+  );
+  transfer->size_error = std::move(size_error);
+  return _post(transfer);
+}
+
+
+auto ProgressEngineTCP::receiveAny(rank_type* src_rank,
+                                   std::vector<Buffer> buffers, bool framed,
+                                   std::vector<at::Tensor> tensors,
+                                   std::string size_error) -> Request {
+  auto transfer = std::make_shared<Transfer>(
+    0, std::move(buffers), framed, true, std::move(tensors)
+  );
+  transfer->size_error = std::move(size_error);
+  transfer->sender = src_rank;
+  return _post(transfer);
+}
+
+
+auto ProgressEngineTCP::_post(std::shared_ptr<Transfer> transfer) -> Request {
+  if (!transfer->sender && (transfer->rank >= _peers.size() ||
+                            _peers[transfer->rank].socket == -1)) {
+    throw std::logic_error(
+      "no connection to process " + std::to_string(transfer->rank)
+    );
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _posted.push_back(transfer);
+  }
+
+  // A full pipe already wakes the progress thread up
+  char byte = 0;
+  while (::write(_wakeup[1], &byte, 1) < 0 && errno == EINTR) {}
+  return Request(transfer);
+}
+
+
+void ProgressEngineTCP::_run() {
+  std::vector<struct pollfd> poll_events;
+  std::vector<rank_type> poll_ranks;
+  std::vector<std::shared_ptr<Transfer>> posted;
+
+  while (true) {
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      if (_exiting)
+        break;
+      posted.swap(_posted);
+    }
+
+    for (auto& transfer : posted) {
+      if (transfer->sender) {
+        _any_receives.push_back(std::move(transfer));
+      } else if (transfer->receiving) {
+        _peers[transfer->rank].receives.push_back(std::move(transfer));
+      } else {
+        _peers[transfer->rank].sends.push_back(std::move(transfer));
+      }
+    }
+    posted.clear();
+
+    poll_events.clear();
+    poll_ranks.clear();
+    poll_events.push_back({_wakeup[0], POLLIN, 0});
+    for (rank_type rank = 0; rank < _peers.size(); ++rank) {
+      const auto& peer = _peers[rank];
+      if (peer.socket == -1)
+        continue;
+
+      short events = 0;
+      if (!peer.sends.empty())
+        events |= POLLOUT;
+      if (!peer.receives.empty() || !_any_receives.empty())
+        events |= POLLIN;
+      if (events) {
+        poll_events.push_back({peer.socket, events, 0});
+        poll_ranks.push_back(rank);
+      }
+    }
+
+    int ready;
+    do {
+      ready = ::poll(poll_events.data(), poll_events.size(), -1);
+    } while (ready < 0 && errno == EINTR);
+
+    if (ready < 0) {
+      auto exception = std::make_exception_ptr(
+        std::system_error(errno, std::system_category())
+      );
+      for (rank_type rank = 0; rank < _peers.size(); ++rank)
+        _fail(rank, exception);
+      continue;
+    }
+
+    if (poll_events[0].revents) {
+      char bytes[64];
+      while (::read(_wakeup[0], bytes, sizeof(bytes)) > 0) {}
+    }
+
+    for (std::size_t i = 1; i < poll_events.size(); ++i) {
+      if (poll_events[i].revents == 0)
+        continue;
+
+      try {
+        _progress(poll_ranks[i - 1], poll_events[i].revents);
+      } catch (...) {
+        _fail(poll_ranks[i - 1], std::current_exception());
+      }
+    }
+  }
+
+  // fail what is left, nobody is going to progress it anymore
+  auto exception = std::make_exception_ptr(
+    std::runtime_error("TCP data channel was destroyed")
+  );
+  for (auto& transfer : posted)
+    transfer->complete(exception);
+  for (auto& transfer : _posted)
+    transfer->complete(exception);
+  for (auto& transfer : _any_receives)
+    transfer->complete(exception);
+  for (rank_type rank = 0; rank < _peers.size(); ++rank)
+    _fail(rank, exception);
+}
+
+
+void ProgressEngineTCP::_progress(rank_type rank, short revents) {
+  auto& peer = _peers[rank];
+  if (revents & POLLNVAL)
+    throw std::system_error(EBADF, std::system_category());
+
+  // errors and hang ups are reported by the calls below
+  if (revents & (POLLOUT | POLLERR | POLLHUP)) {
+    while (!peer.sends.empty() && _progressSend(peer.socket, *peer.sends.front())) {
+      peer.sends.front()->complete();
+      peer.sends.pop_front();
+    }
+  }
+
+  if (revents & (POLLIN | POLLERR | POLLHUP)) {
+    /*
+     * Data from a peer with nothing to receive goes to the oldest receive
+     * from any source. This is decided only when the peer is known to have
+     * sent something, not to wait on a peer that might never send.
+     */
+    if (peer.receives.empty() && !_any_receives.empty()) {
+      auto transfer = std::move(_any_receives.front());
+      _any_receives.pop_front();
+      *transfer->sender = rank;
+      transfer->rank = rank;
+      peer.receives.push_back(std::move(transfer));
+    }
+
+    while (!peer.receives.empty()) {
+      auto& transfer = *peer.receives.front();
+      if (!_progressReceive(peer.socket, transfer))
+        break;
+
+      if (transfer.bad_size) {
+        transfer.complete(std::make_exception_ptr(
+          std::logic_error(transfer.size_error)
+        ));
+      } else {
+        transfer.complete();
+      }
+      peer.receives.pop_front();
+    }
+  }
+}
+
+
+// Returns true when the transfer is done, false when the socket is full
+bool ProgressEngineTCP::_progressSend(int socket, Transfer& transfer) {
+  struct iovec iovecs[MAX_IOVECS];
+
+  while (!transfer.done()) {
+    std::size_t count = 0;
+    for (std::size_t piece = transfer.piece;
+         piece < transfer.pieces.size() && count < MAX_IOVECS; ++piece) {
+      std::uint64_t offset = (piece == transfer.piece) ? transfer.offset : 0;
+      iovecs[count].iov_base = transfer.pieces[piece].data + offset;
+      iovecs[count].iov_len = transfer.pieces[piece].bytes - offset;
+      ++count;
+    }
+
+    struct msghdr message = {};
+    message.msg_iov = iovecs;
+    message.msg_iovlen = count;
+    ssize_t bytes_sent = ::sendmsg(socket, &message, MSG_DONTWAIT);
+    if (bytes_sent < 0) {
+      if (errno == EINTR)
+        continue;
+      if (errno == EAGAIN || errno == EWOULDBLOCK)
+        return false;
+      throw std::system_error(errno, std::system_category());
+    }
+
+    transfer.consume(bytes_sent);
+  }
+
+  return true;
+}
+
+
+// Returns true when the transfer is done, false when there is nothing to read
+bool ProgressEngineTCP::_progressReceive(int socket, Transfer& transfer) {
+  while (!transfer.done()) {
+    const auto& piece = transfer.pieces[transfer.piece];
+    std::uint64_t bytes_left = piece.bytes - transfer.offset;
+    std::uint8_t* destination = _discarded.data();
+    if (piece.data) {
+      destination = piece.data + transfer.offset;
+    } else {
+      bytes_left = std::min<std::uint64_t>(bytes_left, _discarded.size());
+    }
+
+    ssize_t bytes_received = ::recv(socket, destination, bytes_left, MSG_DONTWAIT);
+    if (bytes_received < 0) {
+      if (errno == EINTR)
+        continue;
+      if (errno == EAGAIN || errno == EWOULDBLOCK)
+        return false;
+      throw std::system_error(errno, std::system_category());
+    }
+    if (bytes_received == 0)
+      throw std::system_error(ECONNRESET, std::system_category());
+
+    transfer.consume(bytes_received);
+  }
+
+  return true;
+}
+
+
+void ProgressEngineTCP::_fail(rank_type rank, std::exception_ptr exception) {
+  /*
+   * The stream of the peer cannot be framed anymore, fail all of its
+   * transfers.
+   */
+  auto& peer = _peers[rank];
+  for (auto& transfer : peer.sends)
+    transfer->complete(exception);
+  for (auto& transfer : peer.receives)
+    transfer->complete(exception);
+  peer.sends.clear();
+  peer.receives.clear();
+}
+
+} // namespace thd
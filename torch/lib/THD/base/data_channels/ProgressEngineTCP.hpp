@@ -0,0 +1,107 @@
+#pragma once
+
+#include "../DataChannel.hpp"
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace thd {
+
+/*
+ * Moves the bytes of the point-to-point transfers of the TCP data channel.
+ *
+ * A single thread polls the sockets of all peers and progresses the pending
+ * transfers with non-blocking calls, so that transfers to and from different
+ * peers proceed at the same time (and with the computation of the threads
+ * that posted them). Transfers to, or from, the same peer are done in the
+ * order in which they were posted, which keeps the byte streams framed.
+ */
+struct ProgressEngineTCP {
+  // Contiguous memory to send, or to receive into
+  struct Buffer {
+    std::uint8_t* data;
+    std::uint64_t bytes;
+  };
+
+private:
+  struct Transfer;
+
+public:
+  struct Request {
+    Request(std::shared_ptr<Transfer> transfer);
+
+    void wait();
+    bool isCompleted();
+
+  private:
+    std::shared_ptr<Transfer> _transfer;
+  };
+
+  // `sockets[rank]` is connected to the process with rank `rank` (-1 for
+  // the current process)
+  ProgressEngineTCP(std::vector<int> sockets);
+  ~ProgressEngineTCP();
+
+  ProgressEngineTCP(const ProgressEngineTCP&) = delete;
+  ProgressEngineTCP& operator=(const ProgressEngineTCP&) = delete;
+
+  /*
+   * Sends `buffers` back to back to `dst_rank`. When `framed` is set every
+   * buffer is preceded by its size in bytes (as std::uint64_t). `tensors`
+   * are kept alive until the transfer completes.
+   */
+  Request send(rank_type dst_rank, std::vector<Buffer> buffers, bool framed,
+               std::vector<at::Tensor> tensors = {});
+  /*
+   * Receives into `buffers` from `src_rank`. When `framed` is set, a buffer
+   * whose size differs from the one sent before it is left untouched, its
+   * data is dropped and the request fails with `size_error`.
+   */
+  Request receive(rank_type src_rank, std::vector<Buffer> buffers, bool framed,
+                  std::vector<at::Tensor> tensors = {},
+                  std::string size_error = "sizes do not match");
+  /*
+   * Like `receive`, from the first peer with data to read (and nothing else
+   * to receive from). `*src_rank` is set before the request completes.
+   */
+  Request receiveAny(rank_type* src_rank, std::vector<Buffer> buffers,
+                     bool framed, std::vector<at::Tensor> tensors = {},
+                     std::string size_error = "sizes do not match");
+
+private:
+  struct Peer {
+    int socket;
+    std::deque<std::shared_ptr<Transfer>> sends;
+    std::deque<std::shared_ptr<Transfer>> receives;
+  };
+
+  Request _post(std::shared_ptr<Transfer> transfer);
+  void _run();
+  void _progress(rank_type rank, short revents);
+  bool _progressSend(int socket, Transfer& transfer);
+  bool _progressReceive(int socket, Transfer& transfer);
+  void _fail(rank_type rank, std::exception_ptr exception);
+
+  // Owned by the progress thread
+  std::vector<Peer> _peers;
+  std::deque<std::shared_ptr<Transfer>> _any_receives;
+  std::vector<std::uint8_t> _discarded; // Sink of the data of bad sizes
+
+  // Transfers posted since the progress thread last looked, protected by
+  // `_mutex`
+  std::vector<std::shared_ptr<Transfer>> _posted;
+  bool _exiting;
+  std::mutex _mutex;
+
+  int _wakeup[2]; // Pipe waking up the progress thread from `poll`
+  std::thread _thread;
+};
+
+} // namespace thd
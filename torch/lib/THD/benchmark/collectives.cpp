@@ -0,0 +1,337 @@
+/**
+ * Benchmark of the collectives of the THD data channels.
+ *
+ * Every process of the job runs this binary; the processes find each other
+ * through the env:// init method (MASTER_ADDR, MASTER_PORT, WORLD_SIZE,
+ * RANK). For every collective, data type, group size (powers of two up to
+ * the world size, and the world size) and tensor size, rank 0 prints:
+ *
+ *  - algbw: bytes of the tensor divided by the time of the collective,
+ *  - busbw: algbw scaled by the fraction of the data every link has to carry
+ *    in an optimal implementation, comparable to the bandwidth of the links
+ *    whatever the group size (as reported by nccl-tests),
+ *  - latency percentiles over the iterations, where the time of an iteration
+ *    is the one of the slowest process.
+ *
+ * Example:
+ *   MASTER_ADDR=host0 MASTER_PORT=29500 WORLD_SIZE=8 RANK=$i \
+ *     ./thd_benchmark_collectives --backend=gloo --collectives=all_reduce
+ */
+
+#include "../base/DataChannel.hpp"
+
+#ifdef WITH_CUDA
+#include <cuda_runtime.h>
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace thd;
+
+namespace {
+
+struct Options {
+  std::string backend = "tcp";
+  std::vector<std::string> collectives = {
+    "broadcast", "all_reduce", "reduce", "all_gather", "gather", "scatter",
+    "barrier"};
+  std::vector<std::string> types = {"float"};
+  int min_bytes = 2; // log2
+  int max_bytes = 26; // log2
+  int iters = 20;
+  int warmup_iters = 5;
+  bool cuda = false;
+};
+
+std::vector<std::string> split(const std::string& s) {
+  std::vector<std::string> parts;
+  std::stringstream ss(s);
+  std::string part;
+  while (std::getline(ss, part, ',')) {
+    if (!part.empty()) {
+      parts.push_back(part);
+    }
+  }
+  return parts;
+}
+
+void usage(const char* argv0) {
+  std::cerr
+    << "Usage: " << argv0 << " [OPTIONS]\n\n"
+    << "  --backend=tcp|gloo|mpi|nccl  data channel to benchmark (tcp)\n"
+    << "  --collectives=a,b,...        among broadcast, all_reduce, reduce,\n"
+    << "                               all_gather, gather, scatter, barrier\n"
+    << "                               (all)\n"
+    << "  --types=a,b,...              among float, double, half, int, long,\n"
+    << "                               byte (float)\n"
+    << "  --min-bytes=N                smallest tensor is 2**N bytes (2)\n"
+    << "  --max-bytes=N                largest tensor is 2**N bytes (26)\n"
+    << "  --iters=N                    timed iterations per size (20)\n"
+    << "  --warmup-iters=N             untimed iterations per size (5)\n"
+    << "  --cuda                       use CUDA tensors\n";
+}
+
+Options parseOptions(int argc, char** argv) {
+  Options options;
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    auto eq = arg.find('=');
+    auto name = arg.substr(0, eq);
+    auto value = eq == std::string::npos ? "" : arg.substr(eq + 1);
+    if (name == "--backend") {
+      options.backend = value;
+    } else if (name == "--collectives") {
+      options.collectives = split(value);
+    } else if (name == "--types") {
+      options.types = split(value);
+    } else if (name == "--min-bytes") {
+      options.min_bytes = std::stoi(value);
+    } else if (name == "--max-bytes") {
+      options.max_bytes = std::stoi(value);
+    } else if (name == "--iters") {
+      options.iters = std::stoi(value);
+    } else if (name == "--warmup-iters") {
+      options.warmup_iters = std::stoi(value);
+    } else if (name == "--cuda") {
+      options.cuda = true;
+    } else {
+      usage(argv[0]);
+      std::exit(name == "--help" ? 0 : 1);
+    }
+  }
+  if (options.iters < 1 || options.min_bytes > options.max_bytes) {
+    usage(argv[0]);
+    std::exit(1);
+  }
+  return options;
+}
+
+THDChannelType channelType(const std::string& backend) {
+  if (backend == "tcp") return THDChannelTCP;
+  if (backend == "mpi") return THDChannelMPI;
+  if (backend == "gloo") return THDChannelGloo;
+  if (backend == "nccl") return THDChannelNccl;
+  throw std::invalid_argument("unknown backend: " + backend);
+}
+
+at::ScalarType scalarType(const std::string& type) {
+  if (type == "float") return at::kFloat;
+  if (type == "double") return at::kDouble;
+  if (type == "half") return at::kHalf;
+  if (type == "int") return at::kInt;
+  if (type == "long") return at::kLong;
+  if (type == "byte") return at::kByte;
+  throw std::invalid_argument("unknown type: " + type);
+}
+
+// Fraction of the tensor that every link carries in an optimal
+// implementation of the collective, used to compute the bus bandwidth
+double busFactor(const std::string& collective, int group_size) {
+  double n = group_size;
+  if (collective == "all_reduce") return 2 * (n - 1) / n;
+  if (collective == "all_gather" || collective == "gather" ||
+      collective == "scatter") {
+    return (n - 1) / n;
+  }
+  return 1;
+}
+
+void synchronize(const Options& options) {
+#ifdef WITH_CUDA
+  if (options.cuda) {
+    cudaDeviceSynchronize();
+  }
+#endif
+}
+
+// Allocates the tensors of one collective call and returns the call
+std::function<void()> makeCollective(
+    DataChannel& channel, const std::string& collective, at::Type& type,
+    int64_t numel, THDGroup group, rank_type group_size) {
+  // The buffers are shared with the returned function
+  auto tensor = std::make_shared<at::Tensor>(type.ones({numel}));
+  auto tensors = std::make_shared<std::vector<at::Tensor>>();
+  for (rank_type i = 0; i < group_size; i++) {
+    tensors->push_back(type.zeros({numel}));
+  }
+  auto rank = channel.getRank();
+
+  if (collective == "broadcast") {
+    return [&channel, tensor, group] { channel.broadcast(*tensor, 0, group); };
+  } else if (collective == "all_reduce") {
+    return [&channel, tensor, group] {
+      channel.allReduce(*tensor, THDReduceSUM, group);
+    };
+  } else if (collective == "reduce") {
+    return [&channel, tensor, group] {
+      channel.reduce(*tensor, THDReduceSUM, 0, group);
+    };
+  } else if (collective == "all_gather") {
+    return [&channel, tensor, tensors, group] {
+      channel.allGather(*tensors, *tensor, group);
+    };
+  } else if (collective == "gather") {
+    if (rank != 0) {
+      tensors->clear();
+    }
+    return [&channel, tensor, tensors, group] {
+      channel.gather(*tensors, *tensor, 0, group);
+    };
+  } else if (collective == "scatter") {
+    if (rank != 0) {
+      tensors->clear();
+    }
+    return [&channel, tensor, tensors, group] {
+      channel.scatter(*tensors, *tensor, 0, group);
+    };
+  } else if (collective == "barrier") {
+    return [&channel, group] { channel.barrier(group); };
+  }
+  throw std::invalid_argument("unknown collective: " + collective);
+}
+
+// Returns the time of every iteration in seconds, the maximum over the group
+std::vector<double> timeCollective(
+    DataChannel& channel, const Options& options,
+    const std::function<void()>& run, THDGroup group) {
+  for (int i = 0; i < options.warmup_iters; i++) {
+    run();
+  }
+  synchronize(options);
+
+  auto times = at::CPU(at::kDouble).zeros({options.iters});
+  auto times_data = times.data<double>();
+  for (int i = 0; i < options.iters; i++) {
+    channel.barrier(group);
+    auto start = std::chrono::steady_clock::now();
+    run();
+    synchronize(options);
+    auto end = std::chrono::steady_clock::now();
+    times_data[i] = std::chrono::duration<double>(end - start).count();
+  }
+
+  // NCCL only reduces CUDA tensors, the local times are close enough there
+  if (options.backend != "nccl") {
+    channel.allReduce(times, THDReduceMAX, group);
+  }
+  return std::vector<double>(times_data, times_data + options.iters);
+}
+
+double percentile(const std::vector<double>& sorted, double p) {
+  auto index = static_cast<std::size_t>(p * (sorted.size() - 1) + 0.5);
+  return sorted[index];
+}
+
+void printHeader() {
+  std::printf("%-12s %-7s %6s %12s %6s %12s %12s %12s %12s %12s\n",
+              "collective", "type", "ranks", "bytes", "iters", "algbw(GB/s)",
+              "busbw(GB/s)", "p50(us)", "p90(us)", "p99(us)");
+}
+
+void printStats(const std::string& collective, const std::string& type,
+                rank_type group_size, std::size_t bytes,
+                std::vector<double> times) {
+  std::sort(times.begin(), times.end());
+  auto median = percentile(times, 0.5);
+  auto algbw = collective == "barrier" ? 0 : bytes / median / 1e9;
+  std::printf("%-12s %-7s %6u %12zu %6zu %12.3f %12.3f %12.1f %12.1f %12.1f\n",
+              collective.c_str(), type.c_str(), group_size, bytes,
+              times.size(), algbw, algbw * busFactor(collective, group_size),
+              median * 1e6, percentile(times, 0.9) * 1e6,
+              percentile(times, 0.99) * 1e6);
+  std::fflush(stdout);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  auto options = parseOptions(argc, argv);
+
+  std::unique_ptr<DataChannel> channel(DataChannel::newChannel(
+    channelType(options.backend), "env://", -1, "", -1));
+  if (!channel->init()) {
+    std::cerr << "failed to initialize the " << options.backend
+              << " data channel" << std::endl;
+    return 1;
+  }
+  auto rank = channel->getRank();
+  auto world_size = channel->getNumProcesses();
+
+  // Groups of the first ranks, created by all processes in the same order
+  std::vector<std::pair<rank_type, THDGroup>> groups;
+  for (rank_type size = 2; size <= world_size; size *= 2) {
+    groups.emplace_back(size, THDGroupWORLD);
+  }
+  if (groups.empty() || groups.back().first != world_size) {
+    groups.emplace_back(world_size, THDGroupWORLD);
+  }
+  for (auto& group : groups) {
+    if (group.first == world_size) {
+      continue;
+    }
+    std::vector<rank_type> ranks;
+    for (rank_type r = 0; r < group.first; r++) {
+      ranks.push_back(r);
+    }
+    group.second = channel->newGroup(ranks);
+  }
+
+  if (rank == 0) {
+    printHeader();
+  }
+
+  for (const auto& collective : options.collectives) {
+    for (const auto& type_name : options.types) {
+      auto scalar_type = scalarType(type_name);
+      auto& type = options.cuda ? at::CUDA(scalar_type) : at::CPU(scalar_type);
+      for (const auto& group : groups) {
+        auto group_size = group.first;
+        auto group_id = group.second;
+        if (rank >= group_size) {
+          continue;
+        }
+
+        int max_bytes = collective == "barrier" ? options.min_bytes : options.max_bytes;
+        for (int log2 = options.min_bytes; log2 <= max_bytes; log2++) {
+          std::size_t bytes = std::size_t(1) << log2;
+          auto numel = std::max<int64_t>(1, bytes / type.elementSizeInBytes());
+          bytes = numel * type.elementSizeInBytes();
+
+          // The first failure of a collective is the same in all processes
+          // (e.g. an unsupported collective or type), skip the rest of it
+          try {
+            auto run = makeCollective(*channel, collective, type, numel,
+                                      group_id, group_size);
+            auto times = timeCollective(*channel, options, run, group_id);
+            if (rank == 0) {
+              printStats(collective, type_name, group_size,
+                         collective == "barrier" ? 0 : bytes, times);
+            }
+          } catch (const std::exception& e) {
+            if (rank == 0) {
+              std::printf("%-12s %-7s %6u skipped: %s\n", collective.c_str(),
+                          type_name.c_str(), group_size, e.what());
+            }
+            break;
+          }
+        }
+      }
+    }
+  }
+
+  // Wait for everybody before tearing the channel down
+  channel->barrier();
+  channel->destroy();
+  return 0;
+}
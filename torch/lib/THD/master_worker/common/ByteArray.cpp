@@ -24,6 +24,10 @@ ByteArray::ByteArray(const char* arr, std::size_t size)
   : _data(arr, arr + size)
 {}
 
+ByteArray::ByteArray(std::string&& str)
+  : _data(std::move(str))
+{}
+
 ByteArray::ByteArray(ByteArray&& arr)
 {
   std::swap(_data, arr._data);
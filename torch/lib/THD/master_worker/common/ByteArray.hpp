@@ -11,6 +11,7 @@ struct ByteArray {
   ByteArray();
   ByteArray(std::size_t size);
   ByteArray(const char* arr, std::size_t size);
+  ByteArray(std::string&& str);
   ByteArray(ByteArray&& arr);
   ByteArray(const ByteArray& arr);
   ~ByteArray();
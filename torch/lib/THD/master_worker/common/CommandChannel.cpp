@@ -2,7 +2,9 @@
 #include "Functions.hpp"
 #include "../../base/ChannelUtils.hpp"
 
+#include <sys/uio.h>
 #include <unistd.h>
+#include <algorithm>
 #include <climits>
 #include <cstdlib>
 #include <cstring>
@@ -16,28 +18,59 @@
 namespace thd {
 namespace {
 
-void sendMessage(int socket, std::unique_ptr<rpc::RPCMessage> msg) {
-  auto& bytes = msg.get()->bytes();
-  std::uint64_t msg_length = static_cast<std::uint64_t>(bytes.length());
-
-  send_bytes<std::uint64_t>(socket, &msg_length, 1, true);
-  send_bytes<std::uint8_t>(
-    socket,
-    reinterpret_cast<const std::uint8_t*>(bytes.data()),
-    msg_length
-  );
+constexpr char BATCH_SIZE_ENV[] = "THD_COMMAND_BATCH_SIZE";
+constexpr std::size_t DEFAULT_BATCH_SIZE = 64;
+// Every command takes two iovecs, which `writev` limits to IOV_MAX (1024 on
+// Linux)
+constexpr std::size_t MAX_BATCH_SIZE = 512;
+constexpr std::size_t MAX_BATCH_BYTES = 1 << 16;
+constexpr std::size_t RECV_BUFFER_SIZE = 1 << 16;
+
+std::size_t loadBatchSize() {
+  const char* value = std::getenv(BATCH_SIZE_ENV);
+  if (value == nullptr)
+    return DEFAULT_BATCH_SIZE;
+  long batch_size = std::stol(value);
+  if (batch_size < 1)
+    throw std::domain_error(std::string(BATCH_SIZE_ENV) + " has to be positive");
+  return std::min(static_cast<std::size_t>(batch_size), MAX_BATCH_SIZE);
 }
 
-std::unique_ptr<rpc::RPCMessage> receiveMessage(int socket) {
-  std::uint64_t msg_length;
-  recv_bytes<std::uint64_t>(socket, &msg_length, 1);
-
-  std::unique_ptr<std::uint8_t[]> bytes(new std::uint8_t[msg_length]);
-  recv_bytes<std::uint8_t>(socket, bytes.get(), msg_length);
+/*
+ * Sends every message as its length followed by its bytes, straight from the
+ * messages' buffers.
+ */
+void sendMessages(int socket, const std::vector<std::unique_ptr<rpc::RPCMessage>>& msgs) {
+  std::vector<std::uint64_t> lengths(msgs.size());
+  std::vector<struct iovec> iovecs(2 * msgs.size());
+  for (std::size_t i = 0; i < msgs.size(); ++i) {
+    auto& bytes = msgs[i]->bytes();
+    lengths[i] = static_cast<std::uint64_t>(bytes.length());
+    iovecs[2 * i].iov_base = &lengths[i];
+    iovecs[2 * i].iov_len = sizeof(std::uint64_t);
+    iovecs[2 * i + 1].iov_base = const_cast<char*>(bytes.data());
+    iovecs[2 * i + 1].iov_len = bytes.length();
+  }
 
-  return std::unique_ptr<rpc::RPCMessage>(
-    new rpc::RPCMessage(reinterpret_cast<char*>(bytes.get()), msg_length)
-  );
+  struct iovec* current = iovecs.data();
+  std::size_t count = iovecs.size();
+  while (count > 0) {
+    ssize_t bytes_sent;
+    SYSCHECK(bytes_sent = ::writev(socket, current, count))
+    if (bytes_sent == 0)
+      throw std::system_error(ECONNRESET, std::system_category());
+
+    std::size_t sent = static_cast<std::size_t>(bytes_sent);
+    while (count > 0 && sent >= current->iov_len) {
+      sent -= current->iov_len;
+      ++current;
+      --count;
+    }
+    if (count > 0) {
+      current->iov_base = static_cast<char*>(current->iov_base) + sent;
+      current->iov_len -= sent;
+    }
+  }
 }
 
 } // anonymous namespace
@@ -49,6 +82,9 @@ MasterCommandChannel::MasterCommandChannel(InitMethod::Config config)
   , _error_pipe(-1)
   , _error(nullptr)
   , _mutexes(config.world_size)
+  , _pending(config.world_size)
+  , _pending_bytes(config.world_size, 0)
+  , _batch_size(loadBatchSize())
 {
   _sockets[0] = config.master.listen_socket;
 }
@@ -69,6 +105,7 @@ MasterCommandChannel::~MasterCommandChannel() {
     if (socket == -1) continue;
     try {
       sendMessage(rpc::packMessage(Functions::exit), i);
+      flush(i);
     } catch(...) {}
     ::close(socket);
   }
@@ -127,7 +164,40 @@ void MasterCommandChannel::sendMessage(std::unique_ptr<rpc::RPCMessage> msg, int
   }
 
   std::lock_guard<std::mutex> guard(_mutexes[rank]);
-  ::thd::sendMessage(_sockets[rank], std::move(msg));
+  _pending_bytes[rank] += sizeof(std::uint64_t) + msg->bytes().length();
+  _pending[rank].push_back(std::move(msg));
+  if (_pending[rank].size() >= _batch_size ||
+      _pending_bytes[rank] >= MAX_BATCH_BYTES) {
+    flushLocked(rank);
+  }
+}
+
+void MasterCommandChannel::flush(int rank) {
+  if (_error) {
+    throw std::runtime_error(*_error);
+  }
+
+  if ((rank <= 0) || (rank >= _sockets.size())) {
+    throw std::domain_error("flush received invalid rank as parameter");
+  }
+
+  std::lock_guard<std::mutex> guard(_mutexes[rank]);
+  flushLocked(rank);
+}
+
+void MasterCommandChannel::flushAll() {
+  for (std::size_t rank = 1; rank < _sockets.size(); ++rank) {
+    flush(rank);
+  }
+}
+
+void MasterCommandChannel::flushLocked(int rank) {
+  if (_pending[rank].empty()) return;
+
+  std::vector<std::unique_ptr<rpc::RPCMessage>> msgs;
+  std::swap(msgs, _pending[rank]);
+  _pending_bytes[rank] = 0;
+  sendMessages(_sockets[rank], msgs);
 }
 
 std::tuple<rank_type, std::string> MasterCommandChannel::recvError() {
@@ -183,6 +253,9 @@ WorkerCommandChannel::WorkerCommandChannel(InitMethod::Config config)
   , _socket(-1)
   , _master_addr(config.worker.master_addr)
   , _master_port(config.worker.master_port)
+  , _recv_buffer(new char[RECV_BUFFER_SIZE])
+  , _recv_begin(0)
+  , _recv_end(0)
 {}
 
 WorkerCommandChannel::~WorkerCommandChannel() {
@@ -200,7 +273,41 @@ bool WorkerCommandChannel::init() {
 }
 
 std::unique_ptr<rpc::RPCMessage> WorkerCommandChannel::recvMessage() {
-  return ::thd::receiveMessage(_socket);
+  std::uint64_t msg_length;
+  recvBuffered(reinterpret_cast<char*>(&msg_length), sizeof(msg_length));
+
+  // received in place, the message takes the string over
+  std::string bytes(msg_length, '\0');
+  recvBuffered(&bytes[0], msg_length);
+
+  return std::unique_ptr<rpc::RPCMessage>(
+    new rpc::RPCMessage(rpc::ByteArray(std::move(bytes)))
+  );
+}
+
+void WorkerCommandChannel::recvBuffered(char* data, std::size_t size) {
+  while (size > 0) {
+    if (_recv_begin == _recv_end) {
+      if (size >= RECV_BUFFER_SIZE) {
+        // large messages go straight to their destination
+        recv_bytes<char>(_socket, data, size);
+        return;
+      }
+
+      ssize_t bytes_received;
+      SYSCHECK(bytes_received = ::recv(_socket, _recv_buffer.get(), RECV_BUFFER_SIZE, 0))
+      if (bytes_received == 0)
+        throw std::system_error(ECONNRESET, std::system_category());
+      _recv_begin = 0;
+      _recv_end = static_cast<std::size_t>(bytes_received);
+    }
+
+    std::size_t chunk = std::min(size, _recv_end - _recv_begin);
+    std::memcpy(data, _recv_buffer.get() + _recv_begin, chunk);
+    _recv_begin += chunk;
+    data += chunk;
+    size -= chunk;
+  }
 }
 
 void WorkerCommandChannel::sendError(const std::string& error) {
@@ -4,6 +4,7 @@
 
 #include <sys/poll.h>
 #include <atomic>
+#include <cstdint>
 #include <memory>
 #include <mutex>
 #include <string>
@@ -13,6 +14,15 @@
 
 namespace thd {
 
+/*
+ * Commands to a worker are queued and sent in batches, with a single
+ * `writev`, when THD_COMMAND_BATCH_SIZE (64 by default, 1 sends every
+ * command right away) of them or 64KB are waiting. Workers report errors
+ * asynchronously, so the master never waits for a command to be
+ * acknowledged; before it waits for a worker in any other way (a value or a
+ * tensor over the data channel) it has to `flushAll`, so that the worker
+ * has received everything it must run before.
+ */
 struct MasterCommandChannel {
   MasterCommandChannel(InitMethod::Config config);
   ~MasterCommandChannel();
@@ -20,10 +30,13 @@ struct MasterCommandChannel {
   bool init();
 
   void sendMessage(std::unique_ptr<rpc::RPCMessage> msg, int rank);
+  void flush(int rank);
+  void flushAll();
 
 private:
   std::tuple<rank_type, std::string> recvError();
   void errorHandler();
+  void flushLocked(int rank);
 
   rank_type _rank;
   std::vector<int> _sockets;
@@ -33,6 +46,11 @@ private:
   std::unique_ptr<std::string> _error;
   std::thread _error_thread;
   std::vector<std::mutex> _mutexes;
+
+  // Commands not sent yet, and the size of their frames, per rank
+  std::vector<std::vector<std::unique_ptr<rpc::RPCMessage>>> _pending;
+  std::vector<std::size_t> _pending_bytes;
+  std::size_t _batch_size;
 };
 
 struct WorkerCommandChannel {
@@ -45,9 +63,17 @@ struct WorkerCommandChannel {
   void sendError(const std::string& error);
 
 private:
+  void recvBuffered(char* data, std::size_t size);
+
   rank_type _rank;
   int _socket;
 
+  // Commands arrive in batches, which are read with as few `recv`s as
+  // possible and split here
+  std::unique_ptr<char[]> _recv_buffer;
+  std::size_t _recv_begin;
+  std::size_t _recv_end;
+
   std::string _master_addr;
   port_type _master_port;
 };
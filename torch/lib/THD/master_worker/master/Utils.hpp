@@ -1,9 +1,12 @@
 #pragma once
 
 #include "process_group/General.hpp"
+#include "Master.hpp"
 
 template<typename T>
 T receiveValueFromWorker(int worker_id) {
+  // the worker sends the value once it runs the queued command
+  thd::master::masterCommandChannel->flushAll();
   thd::RPCType type = thd::type_traits<T>::type;
   if (thd::isInteger(type)) {
     thd::IntScalar wrapped_value;
@@ -53,6 +53,16 @@ void THDBroadcast(THDTensorDescriptor& desc, int src_rank, THDGroup group) {
   dataChannel->broadcast(desc, convertToRank(src_rank), group);
 }
 
+THDRequest* THDIallReduce(THDTensorDescriptor& desc, THDReduceOp operation,
+                          THDGroup group) {
+  return dataChannel->iallReduce(desc, operation, group);
+}
+
+THDRequest* THDIbroadcast(THDTensorDescriptor& desc, int src_rank,
+                          THDGroup group) {
+  return dataChannel->ibroadcast(desc, convertToRank(src_rank), group);
+}
+
 THDRequest* THDIsend(THDTensorDescriptor& desc, int dst_rank) {
   return dataChannel->isend(desc, convertToRank(dst_rank));
 }
@@ -61,6 +71,18 @@ THDRequest* THDIrecv(THDTensorDescriptor& desc, int src_rank) {
   return dataChannel->ireceive(desc, convertToRank(src_rank));
 }
 
+THDRequest* THDIsendMultiple(THDTensorDescriptor* desc, size_t len,
+                             int dst_rank) {
+  std::vector<at::Tensor> dataVec(desc, desc + len);
+  return dataChannel->isend(dataVec, convertToRank(dst_rank));
+}
+
+THDRequest* THDIrecvMultiple(THDTensorDescriptor* desc, size_t len,
+                             int src_rank) {
+  std::vector<at::Tensor> dataVec(desc, desc + len);
+  return dataChannel->ireceive(dataVec, convertToRank(src_rank));
+}
+
 void THDSend(THDTensorDescriptor& desc, int dst_rank) {
   dataChannel->send(desc, convertToRank(dst_rank));
 }
@@ -23,8 +23,16 @@ THD_API void THDBroadcastMultiGPU(THDTensorDescriptor* desc,
                                   int src_rank,
                                   THDGroup group);
 THD_API void THDBroadcast(THDTensorDescriptor& desc, int src_rank, THDGroup group);
+THD_API THDRequest* THDIallReduce(THDTensorDescriptor& desc, THDReduceOp operation,
+                                  THDGroup group);
+THD_API THDRequest* THDIbroadcast(THDTensorDescriptor& desc, int src_rank,
+                                  THDGroup group);
 THD_API THDRequest* THDIsend(THDTensorDescriptor& desc, int dst_rank);
 THD_API THDRequest* THDIrecv(THDTensorDescriptor& desc, int src_rank);
+THD_API THDRequest* THDIsendMultiple(THDTensorDescriptor* desc, size_t len,
+                                     int dst_rank);
+THD_API THDRequest* THDIrecvMultiple(THDTensorDescriptor* desc, size_t len,
+                                     int src_rank);
 THD_API void THDSend(THDTensorDescriptor& desc, int dst_rank);
 THD_API int THDRecvAnySource(THDTensorDescriptor& desc);
 THD_API void THDRecv(THDTensorDescriptor& desc, int src_rank);
@@ -32,6 +32,15 @@ void init_worker(const int& rank, const std::string& master_addr) {
       (int)msg.get()->bytes().length(), msg.get()->bytes().data());
   assert(expected.compare(msg.get()->bytes().to_string()) == 0);
 
+  // batched messages arrive in order, including ones that do not fit in a
+  // single batch
+  for (int i = 0; i < 1000; ++i) {
+    msg = channel->recvMessage();
+    assert(msg->bytes().to_string() == std::string(i % 100, 'a' + i % 26));
+  }
+  msg = channel->recvMessage();
+  assert(msg->bytes().length() == (1 << 20));
+
   /*
    * We need to wait until master will do all receiving and sending. This
    * is because when worker is destroyed it closes all sockets what results in
@@ -59,7 +68,18 @@ void init_master(int world_size, const std::string& master_port) {
     fprintf(stderr, "master: about to send a message to worker %d\n", worker_rank);
     auto rpc_msg = std::unique_ptr<rpc::RPCMessage>(new rpc::RPCMessage(arr));
     channel->sendMessage(std::move(rpc_msg), worker_rank);
+
+    for (int i = 0; i < 1000; ++i) {
+      std::string payload(i % 100, 'a' + i % 26);
+      channel->sendMessage(std::unique_ptr<rpc::RPCMessage>(
+          new rpc::RPCMessage(rpc::ByteArray(payload.data(), payload.size()))),
+        worker_rank);
+    }
+    channel->sendMessage(std::unique_ptr<rpc::RPCMessage>(
+        new rpc::RPCMessage(rpc::ByteArray(std::string(1 << 20, 'x')))),
+      worker_rank);
   }
+  channel->flushAll();
 
   g_barrier->wait();
 
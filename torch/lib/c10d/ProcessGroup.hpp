@@ -0,0 +1,76 @@
+#pragma once
+
+#include <exception>
+#include <memory>
+#include <vector>
+
+#include <ATen/ATen.h>
+
+#include "Types.hpp"
+
+namespace c10d {
+
+// ProcessGroup is a base class that captures collective and point to
+// point communication in a fixed set of processes.
+//
+// All collective functions return immediately with a Work handle. The
+// collective runs asynchronously (e.g. on a worker thread or a device
+// stream) and the handle can be polled with `isCompleted` or waited on
+// with `wait`, so that multiple collectives can be in flight and
+// communication can overlap with computation.
+//
+// Collectives must be called in the same order on all processes in the
+// group. The input tensors must not be modified until the collective
+// has completed.
+//
+class ProcessGroup {
+ public:
+  class Work {
+   public:
+    virtual ~Work();
+
+    // Checks if request has completed. Non-blocking operation.
+    virtual bool isCompleted() = 0;
+
+    // Returns if the work completed successfully.
+    // If false, the exception function can be called to get details.
+    virtual bool isSuccess() = 0;
+
+    // Ensures that operations on the output tensors that are invoked
+    // after this function returns are correctly sequenced after the
+    // asynchronous completion of this work (e.g. for CUDA streams).
+    virtual void synchronize() = 0;
+
+    // Waits until request completes. Blocking operation.
+    // Returns false if the work completed with an exception.
+    virtual bool wait() = 0;
+
+    // Returns exception if wait() returned false.
+    virtual const std::exception& exception() const = 0;
+  };
+
+  explicit ProcessGroup(int rank, int size);
+  virtual ~ProcessGroup();
+
+  int getRank() const {
+    return rank_;
+  }
+
+  int getSize() const {
+    return size_;
+  }
+
+  virtual std::shared_ptr<Work> broadcast(
+      std::vector<at::Tensor>& data,
+      const BroadcastOptions& opts = BroadcastOptions()) = 0;
+
+  virtual std::shared_ptr<Work> allreduce(
+      std::vector<at::Tensor>& data,
+      const AllreduceOptions& opts = AllreduceOptions()) = 0;
+
+ protected:
+  const int rank_;
+  const int size_;
+};
+
+} // namespace c10d
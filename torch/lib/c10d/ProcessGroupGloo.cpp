@@ -0,0 +1,420 @@
+#include "ProcessGroupGloo.hpp"
+
+#include <gloo/allreduce_ring.h>
+#include <gloo/broadcast_one_to_all.h>
+#include <gloo/rendezvous/context.h>
+#include <gloo/rendezvous/prefix_store.h>
+
+#define GENERATE_ALL_TYPES(type, func, args...)        \
+  switch (type) {                                      \
+    case ::at::ScalarType::Float:                      \
+      func<float>(args);                               \
+      break;                                           \
+    case ::at::ScalarType::Double:                     \
+      func<double>(args);                              \
+      break;                                           \
+    case ::at::ScalarType::Half:                       \
+      func<gloo::float16>(args);                       \
+      break;                                           \
+    case ::at::ScalarType::Char:                       \
+      func<int8_t>(args);                              \
+      break;                                           \
+    case ::at::ScalarType::Byte:                       \
+      func<uint8_t>(args);                             \
+      break;                                           \
+    case ::at::ScalarType::Int:                        \
+      func<int32_t>(args);                             \
+      break;                                           \
+    case ::at::ScalarType::Long:                       \
+      func<int64_t>(args);                             \
+      break;                                           \
+    default:                                           \
+      throw std::runtime_error("Invalid scalar type"); \
+  }
+
+namespace c10d {
+
+namespace {
+
+// Wrap c10d store as Gloo store
+class GlooStore : public ::gloo::rendezvous::Store {
+ public:
+  GlooStore(const std::shared_ptr<::c10d::Store>& store) : store_(store) {}
+
+  void set(const std::string& key, const std::vector<char>& value) override {
+    std::vector<uint8_t> tmp(value.begin(), value.end());
+    store_->set(key, tmp);
+  }
+
+  std::vector<char> get(const std::string& key) override {
+    auto value = store_->get(key);
+    return std::vector<char>(value.begin(), value.end());
+  }
+
+  void wait(const std::vector<std::string>& keys) override {
+    store_->wait(keys, ::c10d::Store::kNoTimeout);
+  }
+
+ protected:
+  std::shared_ptr<::c10d::Store> store_;
+};
+
+template <typename T>
+const ::gloo::ReductionFunction<T>* reductionFunction(const ReduceOp& r) {
+  switch (r) {
+    case ReduceOp::SUM:
+      return ::gloo::ReductionFunction<T>::sum;
+    case ReduceOp::PRODUCT:
+      return ::gloo::ReductionFunction<T>::product;
+    case ReduceOp::MIN:
+      return ::gloo::ReductionFunction<T>::min;
+    case ReduceOp::MAX:
+      return ::gloo::ReductionFunction<T>::max;
+  }
+
+  throw std::runtime_error("Unhandled ReduceOp");
+}
+
+std::vector<std::vector<int64_t>> getSizes(
+    const std::vector<at::Tensor>& tensors) {
+  std::vector<std::vector<int64_t>> sizes(tensors.size());
+  for (size_t i = 0; i < tensors.size(); i++) {
+    sizes[i] = tensors[i].sizes().vec();
+  }
+  return sizes;
+}
+
+void assertSameTypeAndSizes(const std::vector<at::Tensor>& tensors) {
+  if (tensors.empty()) {
+    throw std::invalid_argument("Requires at least one tensor");
+  }
+
+  const auto& type = tensors[0].type();
+  const auto sizes = tensors[0].sizes().vec();
+  for (const auto& tensor : tensors) {
+    if (tensor.type() != type) {
+      throw std::invalid_argument("Tensors must have identical type");
+    }
+    if (tensor.sizes().vec() != sizes) {
+      throw std::invalid_argument("Tensors must have identical size");
+    }
+  }
+
+  if (type.is_cuda()) {
+    throw std::invalid_argument("ProcessGroupGloo only supports CPU tensors");
+  }
+}
+
+} // namespace
+
+size_t AlgorithmKey::Hash::operator()(const AlgorithmKey& key) const {
+  size_t hash = std::hash<int>()(static_cast<int>(key.collectiveType));
+  auto combine = [&hash](size_t value) {
+    hash ^= value + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+  };
+  combine(std::hash<at::Type*>()(key.type));
+  for (const auto& shape : key.shapes) {
+    for (auto size : shape) {
+      combine(std::hash<int64_t>()(size));
+    }
+  }
+  combine(std::hash<int>()(key.rootRank));
+  combine(std::hash<int>()(key.rootTensor));
+  combine(std::hash<int>()(static_cast<int>(key.reduceOp)));
+  return hash;
+}
+
+ProcessGroupGloo::WorkGloo::WorkGloo() {}
+
+ProcessGroupGloo::WorkGloo::~WorkGloo() {}
+
+bool ProcessGroupGloo::WorkGloo::isCompleted() {
+  std::unique_lock<std::mutex> lock(m_);
+  return completed_;
+}
+
+bool ProcessGroupGloo::WorkGloo::isSuccess() {
+  std::unique_lock<std::mutex> lock(m_);
+  return !ex_;
+}
+
+void ProcessGroupGloo::WorkGloo::synchronize() {
+  // Nothing to synchronize; outputs are CPU tensors written by the
+  // worker thread before the work is marked as completed.
+}
+
+bool ProcessGroupGloo::WorkGloo::wait() {
+  std::unique_lock<std::mutex> lock(m_);
+  cv_.wait(lock, [&] { return completed_; });
+  return !ex_;
+}
+
+const std::exception& ProcessGroupGloo::WorkGloo::exception() const {
+  return *ex_;
+}
+
+void ProcessGroupGloo::WorkGloo::finish() {
+  {
+    std::unique_lock<std::mutex> lock(m_);
+    completed_ = true;
+  }
+  cv_.notify_all();
+}
+
+void ProcessGroupGloo::WorkGloo::finishWithException(const std::exception& ex) {
+  {
+    std::unique_lock<std::mutex> lock(m_);
+    completed_ = true;
+    ex_.reset(new std::runtime_error(ex.what()));
+  }
+  cv_.notify_all();
+}
+
+ProcessGroupGloo::Options::Options()
+    : timeout(Store::kDefaultTimeout),
+      threads(2),
+      cacheNumAlgorithmEntries(1) {}
+
+ProcessGroupGloo::ProcessGroupGloo(
+    const std::shared_ptr<Store>& store,
+    int rank,
+    int size,
+    Options options)
+    : ProcessGroup(rank, size),
+      store_(new GlooStore(store)),
+      stop_(false),
+      cacheNumAlgorithmEntries_(options.cacheNumAlgorithmEntries) {
+  if (options.devices.empty()) {
+    throw std::invalid_argument("No device(s) specified");
+  }
+  if (options.threads < 1) {
+    throw std::invalid_argument("Requires at least one worker thread");
+  }
+  if (options.cacheNumAlgorithmEntries < 1) {
+    throw std::invalid_argument(
+        "Requires at least one algorithm entry per key");
+  }
+
+  for (size_t i = 0; i < options.devices.size(); i++) {
+    auto context = std::make_shared<::gloo::rendezvous::Context>(rank_, size_);
+    ::gloo::rendezvous::PrefixStore prefixStore(std::to_string(i), *store_);
+    context->setTimeout(options.timeout);
+    context->connectFullMesh(prefixStore, options.devices[i]);
+    contexts_.push_back(std::move(context));
+  }
+
+  threads_.resize(options.threads);
+  for (size_t i = 0; i < threads_.size(); i++) {
+    threads_[i] = std::thread(&ProcessGroupGloo::runLoop, this);
+  }
+}
+
+ProcessGroupGloo::~ProcessGroupGloo() {
+  {
+    std::unique_lock<std::mutex> lock(m_);
+    stop_ = true;
+  }
+
+  // Queued work is still run before the worker threads exit
+  queueConsumeCV_.notify_all();
+  for (auto& thread : threads_) {
+    thread.join();
+  }
+}
+
+void ProcessGroupGloo::runLoop() {
+  std::unique_lock<std::mutex> lock(m_);
+
+  for (;;) {
+    queueConsumeCV_.wait(lock, [&] { return stop_ || !queue_.empty(); });
+    if (queue_.empty()) {
+      break;
+    }
+
+    auto work = std::move(queue_.front());
+    queue_.pop_front();
+
+    lock.unlock();
+    runSingle(std::move(work));
+    lock.lock();
+  }
+}
+
+void ProcessGroupGloo::runSingle(WorkType tuple) {
+  auto entry = std::get<0>(tuple);
+  auto& work = std::get<1>(tuple);
+
+  try {
+    entry->run();
+    work->finish();
+  } catch (const std::exception& ex) {
+    work->finishWithException(ex);
+  }
+
+  // The entry can now be used by the next collective with the same key
+  {
+    std::unique_lock<std::mutex> lock(m_);
+    entry->run = nullptr;
+    entry->busy = false;
+  }
+  cacheCV_.notify_all();
+}
+
+template <typename T>
+void ProcessGroupGloo::createBroadcast(AlgorithmEntry& entry) {
+  const auto& key = entry.key;
+  auto count = entry.src[0].numel();
+  std::vector<T*> ptrs(entry.src.size());
+  for (size_t i = 0; i < entry.src.size(); i++) {
+    ptrs[i] = static_cast<T*>(entry.src[i].data_ptr());
+  }
+
+  entry.algorithm = std::unique_ptr<::gloo::Algorithm>(
+      new ::gloo::BroadcastOneToAll<T>(
+          entry.context, ptrs, count, key.rootRank, key.rootTensor));
+}
+
+template <typename T>
+void ProcessGroupGloo::createAllreduce(AlgorithmEntry& entry) {
+  const auto& key = entry.key;
+  auto count = entry.src[0].numel();
+  std::vector<T*> ptrs(entry.src.size());
+  for (size_t i = 0; i < entry.src.size(); i++) {
+    ptrs[i] = static_cast<T*>(entry.src[i].data_ptr());
+  }
+
+  entry.algorithm =
+      std::unique_ptr<::gloo::Algorithm>(new ::gloo::AllreduceRing<T>(
+          entry.context, ptrs, count, reductionFunction<T>(key.reduceOp)));
+}
+
+void ProcessGroupGloo::createAlgorithm(AlgorithmEntry& entry) {
+  const auto& key = entry.key;
+
+  // Allocate the buffers the algorithm runs on
+  entry.src.resize(key.shapes.size());
+  for (size_t i = 0; i < key.shapes.size(); i++) {
+    entry.src[i] = key.type->tensor(key.shapes[i]);
+  }
+
+  switch (key.collectiveType) {
+    case CollectiveType::BROADCAST:
+      GENERATE_ALL_TYPES(key.type->scalarType(), createBroadcast, entry);
+      return;
+    case CollectiveType::ALLREDUCE:
+      GENERATE_ALL_TYPES(key.type->scalarType(), createAllreduce, entry);
+      return;
+  }
+
+  throw std::runtime_error("Unhandled collective type");
+}
+
+AlgorithmEntry* ProcessGroupGloo::checkout(const AlgorithmKey& key) {
+  std::unique_lock<std::mutex> lock(m_);
+
+  // The number of calls with this key only depends on the order of the
+  // calls, so all processes use the same entry for the same call.
+  auto& cached = cache_[key];
+  const auto index = cached.calls++ % cacheNumAlgorithmEntries_;
+
+  if (index == cached.entries.size()) {
+    cached.entries.emplace_back(new AlgorithmEntry);
+    auto entry = cached.entries.back().get();
+    entry->key = key;
+    entry->busy = true;
+
+    // Algorithms are created in call order as well, spreading them over
+    // the contexts (one per device)
+    entry->context = contexts_[nextContext_++ % contexts_.size()];
+
+    lock.unlock();
+    try {
+      createAlgorithm(*entry);
+    } catch (...) {
+      lock.lock();
+      cached.entries.pop_back();
+      cached.calls--;
+      throw;
+    }
+    return entry;
+  }
+
+  auto entry = cached.entries[index].get();
+  cacheCV_.wait(lock, [&] { return !entry->busy; });
+  entry->busy = true;
+  return entry;
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupGloo::enqueue(
+    AlgorithmEntry* entry) {
+  auto work = std::make_shared<WorkGloo>();
+  {
+    std::unique_lock<std::mutex> lock(m_);
+    queue_.push_back(std::make_tuple(entry, work));
+  }
+  queueConsumeCV_.notify_one();
+  return work;
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupGloo::broadcast(
+    std::vector<at::Tensor>& tensors,
+    const BroadcastOptions& opts) {
+  if (opts.rootRank < 0 || opts.rootRank >= size_) {
+    throw std::invalid_argument("Invalid rootRank");
+  }
+  if (opts.rootTensor < 0 || opts.rootTensor >= tensors.size()) {
+    throw std::invalid_argument("Invalid rootTensor");
+  }
+  assertSameTypeAndSizes(tensors);
+
+  AlgorithmKey key;
+  key.collectiveType = CollectiveType::BROADCAST;
+  key.type = &tensors[0].type();
+  key.shapes = getSizes(tensors);
+  key.rootRank = opts.rootRank;
+  key.rootTensor = opts.rootTensor;
+
+  auto entry = checkout(key);
+
+  // Only the root tensor of the root process is read
+  if (rank_ == opts.rootRank) {
+    entry->src[opts.rootTensor].copy_(tensors[opts.rootTensor]);
+  }
+
+  entry->run = [=]() mutable {
+    entry->algorithm->run();
+    for (size_t i = 0; i < tensors.size(); i++) {
+      tensors[i].copy_(entry->src[i]);
+    }
+  };
+
+  return enqueue(entry);
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupGloo::allreduce(
+    std::vector<at::Tensor>& tensors,
+    const AllreduceOptions& opts) {
+  assertSameTypeAndSizes(tensors);
+
+  AlgorithmKey key;
+  key.collectiveType = CollectiveType::ALLREDUCE;
+  key.type = &tensors[0].type();
+  key.shapes = getSizes(tensors);
+  key.reduceOp = opts.reduceOp;
+
+  auto entry = checkout(key);
+  for (size_t i = 0; i < tensors.size(); i++) {
+    entry->src[i].copy_(tensors[i]);
+  }
+
+  entry->run = [=]() mutable {
+    entry->algorithm->run();
+    for (size_t i = 0; i < tensors.size(); i++) {
+      tensors[i].copy_(entry->src[i]);
+    }
+  };
+
+  return enqueue(entry);
+}
+
+} // namespace c10d
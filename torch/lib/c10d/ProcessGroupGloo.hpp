@@ -0,0 +1,178 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+
+#include <gloo/algorithm.h>
+#include <gloo/context.h>
+#include <gloo/rendezvous/store.h>
+#include <gloo/transport/device.h>
+
+#include "ProcessGroup.hpp"
+#include "Store.hpp"
+
+namespace c10d {
+
+enum class CollectiveType : std::uint8_t {
+  BROADCAST,
+  ALLREDUCE,
+};
+
+// Identifies the Gloo algorithm instances that can run a collective:
+// a cached instance has its own buffers of fixed type and shape.
+struct AlgorithmKey {
+  CollectiveType collectiveType;
+  at::Type* type = nullptr;
+  std::vector<std::vector<int64_t>> shapes;
+
+  // Broadcast
+  int rootRank = -1;
+  int rootTensor = -1;
+
+  // Allreduce
+  ReduceOp reduceOp = ReduceOp::SUM;
+
+  bool operator==(const AlgorithmKey& other) const {
+    return collectiveType == other.collectiveType && type == other.type &&
+        shapes == other.shapes && rootRank == other.rootRank &&
+        rootTensor == other.rootTensor && reduceOp == other.reduceOp;
+  }
+
+  struct Hash {
+    size_t operator()(const AlgorithmKey& key) const;
+  };
+};
+
+struct AlgorithmEntry {
+  AlgorithmKey key;
+  std::shared_ptr<::gloo::Context> context;
+  std::unique_ptr<::gloo::Algorithm> algorithm;
+  std::vector<at::Tensor> src;
+  std::function<void()> run;
+
+  // Set while a collective using this entry is queued or running
+  bool busy = false;
+};
+
+// ProcessGroupGloo implements Gloo bindings for c10d.
+//
+// All functions on this class are expected to be called in the same
+// order across processes in the group. This is the only way that we
+// can guarantee to match up the same calls across processes.
+//
+// Algorithm instances are created on the calling thread, in call order,
+// and cached by type and shape of the input tensors. The collectives
+// themselves run on a pool of worker threads. Up to
+// `cacheNumAlgorithmEntries` collectives with the same key can be in
+// flight at the same time; they use the cached instances round robin, so
+// that all processes pick the same instance for the same call.
+//
+// Input tensors are copied into the algorithm buffers before a
+// collective function returns, so they can be reused right away. Output
+// tensors are written on the worker thread and must not be used before
+// the returned work has completed.
+//
+class ProcessGroupGloo : public ProcessGroup {
+ public:
+  class WorkGloo : public ProcessGroup::Work {
+   public:
+    explicit WorkGloo();
+    virtual ~WorkGloo();
+
+    bool isCompleted() override;
+    bool isSuccess() override;
+    void synchronize() override;
+    bool wait() override;
+    const std::exception& exception() const override;
+
+   protected:
+    void finish();
+    void finishWithException(const std::exception& ex);
+
+    std::mutex m_;
+    std::condition_variable cv_;
+    bool completed_ = false;
+    std::unique_ptr<std::runtime_error> ex_;
+
+    friend class ProcessGroupGloo;
+  };
+
+  struct Options {
+    explicit Options();
+
+    std::vector<std::shared_ptr<::gloo::transport::Device>> devices;
+    std::chrono::milliseconds timeout;
+    int threads;
+    int cacheNumAlgorithmEntries;
+  };
+
+  explicit ProcessGroupGloo(
+      const std::shared_ptr<Store>& store,
+      int rank,
+      int size,
+      Options options = Options());
+
+  virtual ~ProcessGroupGloo();
+
+  std::shared_ptr<Work> broadcast(
+      std::vector<at::Tensor>& data,
+      const BroadcastOptions& opts = BroadcastOptions()) override;
+
+  std::shared_ptr<Work> allreduce(
+      std::vector<at::Tensor>& data,
+      const AllreduceOptions& opts = AllreduceOptions()) override;
+
+ protected:
+  using WorkType =
+      std::tuple<AlgorithmEntry*, std::shared_ptr<ProcessGroupGloo::WorkGloo>>;
+
+  std::unique_ptr<::gloo::rendezvous::Store> store_;
+  std::vector<std::shared_ptr<::gloo::Context>> contexts_;
+  std::vector<std::thread> threads_;
+  bool stop_;
+
+  void runLoop();
+
+  void runSingle(WorkType work);
+
+  template <typename T>
+  void createBroadcast(AlgorithmEntry& entry);
+
+  template <typename T>
+  void createAllreduce(AlgorithmEntry& entry);
+
+  void createAlgorithm(AlgorithmEntry& entry);
+
+  // Returns the cached algorithm entry to use for (the next collective
+  // with) the given key, creating it if necessary. Blocks until the
+  // collective that used the entry before has completed.
+  AlgorithmEntry* checkout(const AlgorithmKey& key);
+
+  // Queues the entry's run function for the worker threads.
+  std::shared_ptr<Work> enqueue(AlgorithmEntry* entry);
+
+  const int cacheNumAlgorithmEntries_;
+
+  // Context for the next algorithm to be created
+  size_t nextContext_ = 0;
+
+  struct CacheEntries {
+    std::vector<std::unique_ptr<AlgorithmEntry>> entries;
+    // Number of collectives issued with this key so far
+    size_t calls = 0;
+  };
+
+  std::unordered_map<AlgorithmKey, CacheEntries, AlgorithmKey::Hash> cache_;
+
+  std::mutex m_;
+  std::condition_variable cacheCV_;
+  std::deque<WorkType> queue_;
+  std::condition_variable queueConsumeCV_;
+};
+
+} // namespace c10d
@@ -0,0 +1,359 @@
+#include "TCPStore.hpp"
+
+#include <poll.h>
+#include <sys/epoll.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+namespace c10d {
+
+namespace {
+
+enum class QueryType : uint8_t { SET, GET, ADD, CHECK, WAIT };
+
+enum class CheckResponseType : uint8_t { READY, NOT_READY };
+
+enum class WaitResponseType : uint8_t { STOP_WAITING };
+
+constexpr int kMaxEvents = 64;
+
+} // namespace
+
+// TCPStoreDaemon class methods
+TCPStoreDaemon::TCPStoreDaemon(int storeListenSocket)
+    : storeListenSocket_(storeListenSocket) {
+  epollFd_ = ::epoll_create1(EPOLL_CLOEXEC);
+  SYSCHECK(epollFd_);
+
+  // Used to wake the daemon up when it has to stop
+  SYSCHECK(::pipe(controlPipeFd_));
+
+  for (auto fd : {storeListenSocket_, controlPipeFd_[0]}) {
+    struct ::epoll_event event;
+    event.events = EPOLLIN;
+    event.data.fd = fd;
+    SYSCHECK(::epoll_ctl(epollFd_, EPOLL_CTL_ADD, fd, &event));
+  }
+
+  daemonThread_ = std::thread(&TCPStoreDaemon::run, this);
+}
+
+TCPStoreDaemon::~TCPStoreDaemon() {
+  // Stop the run
+  stop();
+
+  // Join the thread
+  join();
+
+  // Close unclosed sockets
+  for (auto socket : sockets_) {
+    ::close(socket);
+  }
+
+  // Now close the control pipe and the epoll instance
+  for (auto fd : controlPipeFd_) {
+    ::close(fd);
+  }
+  ::close(epollFd_);
+}
+
+void TCPStoreDaemon::join() {
+  if (daemonThread_.joinable()) {
+    daemonThread_.join();
+  }
+}
+
+void TCPStoreDaemon::stop() {
+  char byte = 0;
+  while (::write(controlPipeFd_[1], &byte, 1) < 0 && errno == EINTR) {
+  }
+}
+
+void TCPStoreDaemon::run() {
+  std::vector<struct ::epoll_event> events(kMaxEvents);
+
+  for (;;) {
+    int numEvents;
+    do {
+      numEvents = ::epoll_wait(epollFd_, events.data(), events.size(), -1);
+    } while (numEvents < 0 && errno == EINTR);
+    SYSCHECK(numEvents);
+
+    for (int i = 0; i < numEvents; i++) {
+      const auto fd = events[i].data.fd;
+
+      // The control pipe only becomes readable when we are stopping
+      if (fd == controlPipeFd_[0]) {
+        return;
+      }
+
+      if (fd == storeListenSocket_) {
+        try {
+          auto socket = tcputil::accept(storeListenSocket_);
+          struct ::epoll_event event;
+          event.events = EPOLLIN;
+          event.data.fd = socket;
+          sockets_.push_back(socket);
+          SYSCHECK(::epoll_ctl(epollFd_, EPOLL_CTL_ADD, socket, &event));
+        } catch (const std::exception&) {
+          // The client will fail to connect or be dropped below
+        }
+        continue;
+      }
+
+      // A query from a client, or the client going away
+      try {
+        query(fd);
+      } catch (const std::exception&) {
+        closeSocket(fd);
+      }
+    }
+  }
+}
+
+void TCPStoreDaemon::closeSocket(int socket) {
+  ::epoll_ctl(epollFd_, EPOLL_CTL_DEL, socket, nullptr);
+  ::close(socket);
+  sockets_.erase(
+      std::remove(sockets_.begin(), sockets_.end(), socket), sockets_.end());
+
+  // Forget about any keys the client was waiting for
+  if (keysAwaited_.erase(socket) > 0) {
+    for (auto& waiting : waitingSockets_) {
+      auto& sockets = waiting.second;
+      sockets.erase(
+          std::remove(sockets.begin(), sockets.end(), socket), sockets.end());
+    }
+  }
+}
+
+// query communicates with the worker. The format
+// of the query is as follows:
+// type of query | size of arg1 | arg1 | size of arg2 | arg2 | ...
+// or, in the case of wait
+// type of query | number of args | size of arg1 | arg1 | ...
+void TCPStoreDaemon::query(int socket) {
+  auto qt = tcputil::recvValue<QueryType>(socket);
+  switch (qt) {
+    case QueryType::SET:
+      setHandler(socket);
+      break;
+    case QueryType::ADD:
+      addHandler(socket);
+      break;
+    case QueryType::GET:
+      getHandler(socket);
+      break;
+    case QueryType::CHECK:
+      checkHandler(socket);
+      break;
+    case QueryType::WAIT:
+      waitHandler(socket);
+      break;
+    default:
+      throw std::runtime_error("Unexpected query type");
+  }
+}
+
+void TCPStoreDaemon::wakeupWaitingClients(const std::string& key) {
+  auto it = waitingSockets_.find(key);
+  if (it == waitingSockets_.end()) {
+    return;
+  }
+
+  for (auto socket : it->second) {
+    if (--keysAwaited_[socket] == 0) {
+      keysAwaited_.erase(socket);
+      try {
+        tcputil::sendValue<WaitResponseType>(
+            socket, WaitResponseType::STOP_WAITING);
+      } catch (const std::exception&) {
+        // The client is gone; its socket is closed on the next event
+      }
+    }
+  }
+  waitingSockets_.erase(it);
+}
+
+void TCPStoreDaemon::setHandler(int socket) {
+  auto key = tcputil::recvString(socket);
+  tcpStore_[key] = tcputil::recvVector<uint8_t>(socket);
+  // On "set", wake up all clients that have been waiting
+  wakeupWaitingClients(key);
+}
+
+void TCPStoreDaemon::addHandler(int socket) {
+  auto key = tcputil::recvString(socket);
+  auto addVal = tcputil::recvValue<int64_t>(socket);
+
+  auto it = tcpStore_.find(key);
+  if (it != tcpStore_.end()) {
+    auto buf = reinterpret_cast<const char*>(it->second.data());
+    auto len = it->second.size();
+    addVal += std::stoll(std::string(buf, len));
+  }
+
+  // Values are stored as decimal strings, like in FileStore
+  auto addValStr = std::to_string(addVal);
+  tcpStore_[key] = std::vector<uint8_t>(addValStr.begin(), addValStr.end());
+
+  tcputil::sendValue<int64_t>(socket, addVal);
+  // On "add", wake up all clients that have been waiting
+  wakeupWaitingClients(key);
+}
+
+void TCPStoreDaemon::getHandler(int socket) const {
+  auto key = tcputil::recvString(socket);
+  // Clients wait for the key before getting it
+  tcputil::sendVector<uint8_t>(socket, tcpStore_.at(key));
+}
+
+void TCPStoreDaemon::checkHandler(int socket) const {
+  auto nargs = tcputil::recvValue<uint64_t>(socket);
+  std::vector<std::string> keys(nargs);
+  for (size_t i = 0; i < nargs; i++) {
+    keys[i] = tcputil::recvString(socket);
+  }
+
+  tcputil::sendValue<CheckResponseType>(
+      socket,
+      checkKeys(keys) ? CheckResponseType::READY
+                      : CheckResponseType::NOT_READY);
+}
+
+void TCPStoreDaemon::waitHandler(int socket) {
+  auto nargs = tcputil::recvValue<uint64_t>(socket);
+  std::vector<std::string> keys(nargs);
+  for (size_t i = 0; i < nargs; i++) {
+    keys[i] = tcputil::recvString(socket);
+  }
+
+  if (checkKeys(keys)) {
+    tcputil::sendValue<WaitResponseType>(
+        socket, WaitResponseType::STOP_WAITING);
+    return;
+  }
+
+  // Answered by wakeupWaitingClients once all the keys are set
+  size_t numKeysToAwait = 0;
+  for (const auto& key : keys) {
+    if (tcpStore_.count(key) == 0) {
+      waitingSockets_[key].push_back(socket);
+      numKeysToAwait++;
+    }
+  }
+  keysAwaited_[socket] = numKeysToAwait;
+}
+
+bool TCPStoreDaemon::checkKeys(const std::vector<std::string>& keys) const {
+  return std::all_of(keys.begin(), keys.end(), [this](const std::string& s) {
+    return tcpStore_.count(s) > 0;
+  });
+}
+
+// TCPStore class methods
+TCPStore::TCPStore(
+    const std::string& masterAddr,
+    tcputil::PortType masterPort,
+    bool isServer)
+    : isServer_(isServer),
+      tcpStoreAddr_(masterAddr),
+      tcpStorePort_(masterPort) {
+  if (isServer_) {
+    // Opening up the listening socket
+    std::tie(masterListenSocket_, tcpStorePort_) = tcputil::listen(masterPort);
+    // Now start the daemon
+    tcpStoreDaemon_ = std::unique_ptr<TCPStoreDaemon>(
+        new TCPStoreDaemon(masterListenSocket_));
+  }
+
+  // Connect to the daemon, which may not be listening yet
+  storeSocket_ = tcputil::connect(
+      tcpStoreAddr_, tcpStorePort_, /* wait= */ true, kDefaultTimeout);
+}
+
+TCPStore::~TCPStore() {
+  ::close(storeSocket_);
+  if (isServer_) {
+    // Stops and joins the daemon thread
+    tcpStoreDaemon_.reset(nullptr);
+    ::close(masterListenSocket_);
+  }
+}
+
+void TCPStore::set(const std::string& key, const std::vector<uint8_t>& data) {
+  tcputil::sendValue<QueryType>(storeSocket_, QueryType::SET, true);
+  tcputil::sendString(storeSocket_, key, true);
+  tcputil::sendVector<uint8_t>(storeSocket_, data);
+}
+
+std::vector<uint8_t> TCPStore::get(const std::string& key) {
+  wait({key});
+  tcputil::sendValue<QueryType>(storeSocket_, QueryType::GET, true);
+  tcputil::sendString(storeSocket_, key);
+  return tcputil::recvVector<uint8_t>(storeSocket_);
+}
+
+int64_t TCPStore::add(const std::string& key, int64_t value) {
+  tcputil::sendValue<QueryType>(storeSocket_, QueryType::ADD, true);
+  tcputil::sendString(storeSocket_, key, true);
+  tcputil::sendValue<int64_t>(storeSocket_, value);
+  return tcputil::recvValue<int64_t>(storeSocket_);
+}
+
+bool TCPStore::check(const std::vector<std::string>& keys) {
+  tcputil::sendValue<QueryType>(storeSocket_, QueryType::CHECK, true);
+  uint64_t nkeys = keys.size();
+  tcputil::sendValue<uint64_t>(storeSocket_, nkeys, nkeys > 0);
+  for (size_t i = 0; i < nkeys; i++) {
+    tcputil::sendString(storeSocket_, keys[i], i + 1 < nkeys);
+  }
+
+  auto response = tcputil::recvValue<CheckResponseType>(storeSocket_);
+  if (response == CheckResponseType::READY) {
+    return true;
+  } else if (response == CheckResponseType::NOT_READY) {
+    return false;
+  } else {
+    throw std::runtime_error("ready or not_ready response expected");
+  }
+}
+
+void TCPStore::wait(
+    const std::vector<std::string>& keys,
+    const std::chrono::milliseconds& timeout) {
+  tcputil::sendValue<QueryType>(storeSocket_, QueryType::WAIT, true);
+  uint64_t nkeys = keys.size();
+  tcputil::sendValue<uint64_t>(storeSocket_, nkeys, nkeys > 0);
+  for (size_t i = 0; i < nkeys; i++) {
+    tcputil::sendString(storeSocket_, keys[i], i + 1 < nkeys);
+  }
+
+  // The daemon answers once all keys are set
+  if (timeout != kNoTimeout) {
+    struct ::pollfd pfd;
+    pfd.fd = storeSocket_;
+    pfd.events = POLLIN;
+    int rv;
+    do {
+      rv = ::poll(&pfd, 1, timeout.count());
+    } while (rv < 0 && errno == EINTR);
+    SYSCHECK(rv);
+    if (rv == 0) {
+      // The answer may still come later; reconnect so that it doesn't get
+      // mixed up with the answers to the next queries
+      ::close(storeSocket_);
+      storeSocket_ = tcputil::connect(
+          tcpStoreAddr_, tcpStorePort_, /* wait= */ true, kDefaultTimeout);
+      throw std::runtime_error("Wait timeout");
+    }
+  }
+
+  auto response = tcputil::recvValue<WaitResponseType>(storeSocket_);
+  if (response != WaitResponseType::STOP_WAITING) {
+    throw std::runtime_error("Stop_waiting response is expected");
+  }
+}
+
+} // namespace c10d
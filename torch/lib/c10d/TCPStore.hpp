@@ -0,0 +1,95 @@
+#pragma once
+
+#include <memory>
+#include <thread>
+#include <unordered_map>
+
+#include "Store.hpp"
+#include "Utils.hpp"
+
+namespace c10d {
+
+// Server side of TCPStore: a single thread serving all clients with
+// epoll. Clients waiting for keys are answered when the keys are set,
+// so that they don't have to poll.
+class TCPStoreDaemon {
+ public:
+  explicit TCPStoreDaemon(int storeListenSocket);
+  ~TCPStoreDaemon();
+
+  void join();
+
+ protected:
+  void run();
+  void stop();
+
+  void query(int socket);
+  void closeSocket(int socket);
+
+  void setHandler(int socket);
+  void addHandler(int socket);
+  void getHandler(int socket) const;
+  void checkHandler(int socket) const;
+  void waitHandler(int socket);
+
+  bool checkKeys(const std::vector<std::string>& keys) const;
+  void wakeupWaitingClients(const std::string& key);
+
+  std::thread daemonThread_;
+  std::unordered_map<std::string, std::vector<uint8_t>> tcpStore_;
+  // From key -> the sockets waiting on it
+  std::unordered_map<std::string, std::vector<int>> waitingSockets_;
+  // From socket -> number of keys awaited
+  std::unordered_map<int, size_t> keysAwaited_;
+
+  std::vector<int> sockets_;
+  int storeListenSocket_;
+  int epollFd_;
+  int controlPipeFd_[2];
+};
+
+// Store backed by a TCP server. One process (e.g. rank 0) creates it with
+// isServer set, which starts the server; all processes, including that
+// one, connect to it as clients.
+class TCPStore : public Store {
+ public:
+  explicit TCPStore(
+      const std::string& masterAddr,
+      tcputil::PortType masterPort,
+      bool isServer = false);
+
+  virtual ~TCPStore();
+
+  void set(
+      const std::string& key,
+      const std::vector<uint8_t>& value) override;
+
+  std::vector<uint8_t> get(const std::string& key) override;
+
+  int64_t add(const std::string& key, int64_t value) override;
+
+  bool check(const std::vector<std::string>& keys) override;
+
+  void wait(
+      const std::vector<std::string>& keys,
+      const std::chrono::milliseconds& timeout = kDefaultTimeout) override;
+
+  // Port of the server; the one picked by the system if the store was
+  // created as server with port 0
+  tcputil::PortType getPort() const {
+    return tcpStorePort_;
+  }
+
+ protected:
+  bool isServer_;
+  int storeSocket_ = -1;
+  int masterListenSocket_ = -1;
+
+  std::string tcpStoreAddr_;
+  tcputil::PortType tcpStorePort_;
+
+  // Only created if this store is the server
+  std::unique_ptr<TCPStoreDaemon> tcpStoreDaemon_;
+};
+
+} // namespace c10d
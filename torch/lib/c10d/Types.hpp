@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstdint>
+
+namespace c10d {
+
+enum class ReduceOp : std::uint8_t {
+  SUM = 0,
+  PRODUCT,
+  MIN,
+  MAX,
+};
+
+struct BroadcastOptions {
+  int rootRank = 0;
+  int rootTensor = 0;
+};
+
+struct AllreduceOptions {
+  ReduceOp reduceOp = ReduceOp::SUM;
+};
+
+} // namespace c10d
@@ -0,0 +1,143 @@
+#include "Utils.hpp"
+
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <unistd.h>
+
+#include <memory>
+#include <thread>
+
+namespace c10d {
+namespace tcputil {
+
+namespace {
+
+struct AddrinfoDeleter {
+  void operator()(struct ::addrinfo* addresses) const {
+    ::freeaddrinfo(addresses);
+  }
+};
+
+using AddrinfoPtr = std::unique_ptr<struct ::addrinfo, AddrinfoDeleter>;
+
+AddrinfoPtr getAddresses(const char* address, PortType port, int flags) {
+  struct ::addrinfo hints;
+  std::memset(&hints, 0, sizeof(hints));
+  hints.ai_flags = flags;
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+
+  struct ::addrinfo* addresses = nullptr;
+  auto rv = ::getaddrinfo(
+      address, std::to_string(port).c_str(), &hints, &addresses);
+  if (rv != 0) {
+    throw std::runtime_error(
+        std::string("getaddrinfo: ") + ::gai_strerror(rv));
+  }
+  return AddrinfoPtr(addresses);
+}
+
+PortType getSocketPort(int socket) {
+  struct ::sockaddr_storage addr;
+  socklen_t addrLen = sizeof(addr);
+  SYSCHECK(::getsockname(
+      socket, reinterpret_cast<struct ::sockaddr*>(&addr), &addrLen));
+
+  if (addr.ss_family == AF_INET) {
+    return ntohs(reinterpret_cast<struct ::sockaddr_in*>(&addr)->sin_port);
+  }
+  return ntohs(reinterpret_cast<struct ::sockaddr_in6*>(&addr)->sin6_port);
+}
+
+} // namespace
+
+std::pair<int, PortType> listen(PortType port) {
+  auto addresses = getAddresses(nullptr, port, AI_PASSIVE | AI_ADDRCONFIG);
+
+  // Prefer an IPv6 address, which also accepts IPv4 connections
+  std::vector<struct ::addrinfo*> candidates;
+  for (auto address = addresses.get(); address; address = address->ai_next) {
+    if (address->ai_family == AF_INET6) {
+      candidates.insert(candidates.begin(), address);
+    } else {
+      candidates.push_back(address);
+    }
+  }
+
+  for (auto address : candidates) {
+    int socket = ::socket(
+        address->ai_family, address->ai_socktype, address->ai_protocol);
+    if (socket < 0) {
+      continue;
+    }
+
+    int optval = 1;
+    SYSCHECK(::setsockopt(
+        socket, SOL_SOCKET, SO_REUSEADDR, &optval, sizeof(optval)));
+
+    if (::bind(socket, address->ai_addr, address->ai_addrlen) < 0 ||
+        ::listen(socket, SOMAXCONN) < 0) {
+      ::close(socket);
+      continue;
+    }
+
+    return std::make_pair(socket, getSocketPort(socket));
+  }
+
+  throw std::system_error(errno, std::system_category(), "listen");
+}
+
+int connect(
+    const std::string& address,
+    PortType port,
+    bool wait,
+    const std::chrono::milliseconds& timeout) {
+  auto addresses = getAddresses(address.c_str(), port, AI_ADDRCONFIG);
+  const auto start = std::chrono::steady_clock::now();
+
+  for (;;) {
+    int error = 0;
+    for (auto addr = addresses.get(); addr; addr = addr->ai_next) {
+      int socket =
+          ::socket(addr->ai_family, addr->ai_socktype, addr->ai_protocol);
+      SYSCHECK(socket);
+
+      if (::connect(socket, addr->ai_addr, addr->ai_addrlen) == 0) {
+        int optval = 1;
+        SYSCHECK(::setsockopt(
+            socket, IPPROTO_TCP, TCP_NODELAY, &optval, sizeof(optval)));
+        return socket;
+      }
+
+      error = errno;
+      ::close(socket);
+    }
+
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    if (!wait || (error != ECONNREFUSED && error != ENOENT) ||
+        (timeout != kNoTimeout && elapsed > timeout)) {
+      throw std::system_error(error, std::system_category(), "connect");
+    }
+
+    /* sleep override */
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+}
+
+int accept(int listenSocket) {
+  int socket;
+  do {
+    socket = ::accept(listenSocket, nullptr, nullptr);
+  } while (socket < 0 && errno == EINTR);
+  SYSCHECK(socket);
+
+  int optval = 1;
+  SYSCHECK(::setsockopt(
+      socket, IPPROTO_TCP, TCP_NODELAY, &optval, sizeof(optval)));
+  return socket;
+}
+
+} // namespace tcputil
+} // namespace c10d
@@ -0,0 +1,150 @@
+#pragma once
+
+#include <sys/socket.h>
+#include <sys/types.h>
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <tuple>
+#include <vector>
+
+namespace c10d {
+
+#define SYSCHECK(expr)                                             \
+  {                                                                \
+    if ((expr) < 0) {                                              \
+      throw std::system_error(errno, std::system_category(), #expr); \
+    }                                                              \
+  }
+
+// Helpers for the TCP based store; all of them throw on failure
+namespace tcputil {
+
+using PortType = uint16_t;
+
+constexpr std::chrono::milliseconds kNoTimeout =
+    std::chrono::milliseconds::zero();
+
+// Listens on all interfaces. Returns the socket and the port it listens
+// on, which is picked by the system if `port` is 0.
+std::pair<int, PortType> listen(PortType port);
+
+// Connects to the given address. If `wait` is set, connection refusals
+// (e.g. the server not listening yet) are retried until `timeout`.
+int connect(
+    const std::string& address,
+    PortType port,
+    bool wait = true,
+    const std::chrono::milliseconds& timeout = kNoTimeout);
+
+int accept(int listenSocket);
+
+template <typename T>
+void sendBytes(
+    int socket,
+    const T* buffer,
+    size_t length,
+    bool moreData = false) {
+  size_t bytesToSend = sizeof(T) * length;
+  if (bytesToSend == 0) {
+    return;
+  }
+
+  auto bytes = reinterpret_cast<const uint8_t*>(buffer);
+  int flags = 0;
+#ifdef MSG_MORE
+  if (moreData) { // there is more data to send
+    flags |= MSG_MORE;
+  }
+#endif
+#ifdef MSG_NOSIGNAL
+  flags |= MSG_NOSIGNAL;
+#endif
+
+  while (bytesToSend > 0) {
+    ssize_t bytesSent;
+    do {
+      bytesSent = ::send(socket, bytes, bytesToSend, flags);
+    } while (bytesSent < 0 && errno == EINTR);
+    SYSCHECK(bytesSent);
+    if (bytesSent == 0) {
+      throw std::system_error(ECONNRESET, std::system_category());
+    }
+
+    bytesToSend -= bytesSent;
+    bytes += bytesSent;
+  }
+}
+
+template <typename T>
+void recvBytes(int socket, T* buffer, size_t length) {
+  size_t bytesToReceive = sizeof(T) * length;
+  if (bytesToReceive == 0) {
+    return;
+  }
+
+  auto bytes = reinterpret_cast<uint8_t*>(buffer);
+  while (bytesToReceive > 0) {
+    ssize_t bytesReceived;
+    do {
+      bytesReceived = ::recv(socket, bytes, bytesToReceive, 0);
+    } while (bytesReceived < 0 && errno == EINTR);
+    SYSCHECK(bytesReceived);
+    if (bytesReceived == 0) {
+      throw std::system_error(ECONNRESET, std::system_category());
+    }
+
+    bytesToReceive -= bytesReceived;
+    bytes += bytesReceived;
+  }
+}
+
+template <typename T>
+void sendValue(int socket, const T& value, bool moreData = false) {
+  sendBytes<T>(socket, &value, 1, moreData);
+}
+
+template <typename T>
+T recvValue(int socket) {
+  T value;
+  recvBytes<T>(socket, &value, 1);
+  return value;
+}
+
+template <typename T>
+void sendVector(int socket, const std::vector<T>& vec, bool moreData = false) {
+  uint64_t size = vec.size();
+  sendValue<uint64_t>(socket, size, true);
+  sendBytes<T>(socket, vec.data(), size, moreData);
+}
+
+template <typename T>
+std::vector<T> recvVector(int socket) {
+  auto size = recvValue<uint64_t>(socket);
+  std::vector<T> vec(size);
+  recvBytes<T>(socket, vec.data(), size);
+  return vec;
+}
+
+inline void sendString(
+    int socket,
+    const std::string& str,
+    bool moreData = false) {
+  uint64_t size = str.size();
+  sendValue<uint64_t>(socket, size, true);
+  sendBytes<char>(socket, str.data(), size, moreData);
+}
+
+inline std::string recvString(int socket) {
+  auto size = recvValue<uint64_t>(socket);
+  std::string str(size, '\0');
+  recvBytes<char>(socket, &str[0], size);
+  return str;
+}
+
+} // namespace tcputil
+} // namespace c10d
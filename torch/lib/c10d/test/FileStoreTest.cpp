@@ -1,36 +1,14 @@
 #include <unistd.h>
 
-#include <condition_variable>
 #include <iostream>
-#include <mutex>
 #include <sstream>
 #include <thread>
 
 #include "FileStore.hpp"
+#include "TestUtils.hpp"
 
 using namespace c10d;
-
-class Semaphore {
- public:
-  void post(int n = 1) {
-    std::unique_lock<std::mutex> lock(m_);
-    n_ += n;
-    cv_.notify_all();
-  }
-
-  void wait(int n = 1) {
-    std::unique_lock<std::mutex> lock(m_);
-    while (n_ < n) {
-      cv_.wait(lock);
-    }
-    n_ -= n;
-  }
-
- protected:
-  int n_ = 0;
-  std::mutex m_;
-  std::condition_variable cv_;
-};
+using namespace c10d::test;
 
 void set(Store& store, const std::string& key, const std::string& value) {
   std::vector<uint8_t> data(value.begin(), value.end());
@@ -45,26 +23,6 @@ void check(Store& store, const std::string& key, const std::string& expected) {
   }
 }
 
-std::string tmppath() {
-  const char* tmpdir = getenv("TMPDIR");
-  if (tmpdir == nullptr) {
-    tmpdir = "/tmp";
-  }
-
-  // Create template
-  std::vector<char> tmp(256);
-  auto len = snprintf(tmp.data(), tmp.size(), "%s/testXXXXXX", tmpdir);
-  tmp.resize(len);
-
-  // Create temporary file
-  auto fd = mkstemp(&tmp[0]);
-  if (fd == -1) {
-    throw std::system_error(errno, std::system_category());
-  }
-  close(fd);
-  return std::string(tmp.data(), tmp.size());
-}
-
 int main(int argc, char** argv) {
   auto path = tmppath();
   std::cout << "Using temporary file: " << path << std::endl;
@@ -0,0 +1,134 @@
+#include <unistd.h>
+
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+#include <gloo/transport/tcp/device.h>
+
+#include "FileStore.hpp"
+#include "ProcessGroupGloo.hpp"
+#include "TestUtils.hpp"
+
+using namespace c10d;
+using namespace c10d::test;
+
+std::shared_ptr<ProcessGroupGloo> makeProcessGroup(
+    const std::string& path,
+    int rank,
+    int size) {
+  auto store = std::make_shared<FileStore>(path);
+  ProcessGroupGloo::Options options;
+  ::gloo::transport::tcp::attr attr("127.0.0.1");
+  options.devices.push_back(::gloo::transport::tcp::CreateDevice(attr));
+  options.cacheNumAlgorithmEntries = 2;
+  return std::make_shared<ProcessGroupGloo>(store, rank, size, options);
+}
+
+// Runs fn(rank, processGroup) on `size` threads, each with its own
+// process group
+template <typename F>
+void runTest(const std::string& path, int size, F fn) {
+  std::vector<std::thread> threads;
+  std::vector<std::exception_ptr> errors(size);
+  for (auto rank = 0; rank < size; rank++) {
+    threads.push_back(std::thread([&, rank] {
+      try {
+        auto pg = makeProcessGroup(path, rank, size);
+        fn(rank, *pg);
+      } catch (...) {
+        errors[rank] = std::current_exception();
+      }
+    }));
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  for (auto& error : errors) {
+    if (error) {
+      std::rethrow_exception(error);
+    }
+  }
+}
+
+void testAllreduce(const std::string& path) {
+  const auto size = 4;
+  const auto numCollectives = 8;
+  runTest(path, size, [&](int rank, ProcessGroup& pg) {
+    // Several collectives in flight, sharing the cached algorithms
+    std::vector<std::vector<at::Tensor>> inputs(numCollectives);
+    std::vector<std::shared_ptr<ProcessGroup::Work>> work(numCollectives);
+    for (auto i = 0; i < numCollectives; i++) {
+      inputs[i] = {at::CPU(at::kFloat).ones({16, 16}) * (rank + i)};
+      work[i] = pg.allreduce(inputs[i]);
+    }
+
+    for (auto i = 0; i < numCollectives; i++) {
+      if (!work[i]->wait()) {
+        throw std::runtime_error(work[i]->exception().what());
+      }
+
+      const auto expected = size * i + size * (size - 1) / 2;
+      auto data = inputs[i][0].data<float>();
+      for (auto j = 0; j < inputs[i][0].numel(); j++) {
+        if (data[j] != expected) {
+          std::ostringstream ss;
+          ss << "Allreduce: expected " << expected << ", got " << data[j];
+          throw std::runtime_error(ss.str());
+        }
+      }
+    }
+  });
+}
+
+void testBroadcast(const std::string& path) {
+  const auto size = 2;
+  runTest(path, size, [&](int rank, ProcessGroup& pg) {
+    for (auto rootRank = 0; rootRank < size; rootRank++) {
+      // Two tensors per process, broadcast from one of them
+      for (auto rootTensor = 0; rootTensor < 2; rootTensor++) {
+        std::vector<at::Tensor> tensors = {
+            at::CPU(at::kLong).zeros({16}) + rank * 2,
+            at::CPU(at::kLong).zeros({16}) + rank * 2 + 1,
+        };
+
+        BroadcastOptions options;
+        options.rootRank = rootRank;
+        options.rootTensor = rootTensor;
+        auto work = pg.broadcast(tensors, options);
+        if (!work->wait()) {
+          throw std::runtime_error(work->exception().what());
+        }
+
+        const auto expected = rootRank * 2 + rootTensor;
+        for (const auto& tensor : tensors) {
+          auto data = tensor.data<int64_t>();
+          for (auto j = 0; j < tensor.numel(); j++) {
+            if (data[j] != expected) {
+              std::ostringstream ss;
+              ss << "Broadcast: expected " << expected << ", got " << data[j];
+              throw std::runtime_error(ss.str());
+            }
+          }
+        }
+      }
+    }
+  });
+}
+
+int main(int argc, char** argv) {
+  {
+    auto path = tmppath();
+    testAllreduce(path);
+    unlink(path.c_str());
+  }
+
+  {
+    auto path = tmppath();
+    testBroadcast(path);
+    unlink(path.c_str());
+  }
+
+  std::cout << "Test successful" << std::endl;
+  return 0;
+}
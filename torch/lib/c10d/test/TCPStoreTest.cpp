@@ -0,0 +1,111 @@
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+#include "TCPStore.hpp"
+#include "TestUtils.hpp"
+
+using namespace c10d;
+using namespace c10d::test;
+
+void set(Store& store, const std::string& key, const std::string& value) {
+  std::vector<uint8_t> data(value.begin(), value.end());
+  store.set(key, data);
+}
+
+void check(Store& store, const std::string& key, const std::string& expected) {
+  auto tmp = store.get(key);
+  auto actual = std::string((const char*) tmp.data(), tmp.size());
+  if (actual != expected) {
+    throw std::runtime_error("Expected " + expected + ", got " + actual);
+  }
+}
+
+int main(int argc, char** argv) {
+  // Server on a port picked by the system
+  TCPStore serverStore("127.0.0.1", 0, true);
+  const auto port = serverStore.getPort();
+
+  // Basic set/get on the server store
+  {
+    set(serverStore, "key0", "value0");
+    set(serverStore, "key1", "value1");
+    set(serverStore, "key2", "value2");
+    check(serverStore, "key0", "value0");
+    check(serverStore, "key1", "value1");
+    check(serverStore, "key2", "value2");
+  }
+
+  // Perform get on a client
+  {
+    TCPStore store("127.0.0.1", port);
+    check(store, "key0", "value0");
+    if (!store.check({"key0", "key1"}) || store.check({"key0", "key3"})) {
+      throw std::runtime_error("Unexpected check result");
+    }
+  }
+
+  // Wait is answered once the keys are set by another client
+  {
+    Semaphore sem;
+    std::thread waiter([&] {
+      TCPStore store("127.0.0.1", port);
+      sem.post();
+      store.wait({"wait0", "wait1"});
+      check(store, "wait1", "value1");
+    });
+    sem.wait();
+    TCPStore store("127.0.0.1", port);
+    set(store, "wait0", "value0");
+    set(store, "wait1", "value1");
+    waiter.join();
+  }
+
+  // Wait times out, and the store can still be used afterwards
+  {
+    TCPStore store("127.0.0.1", port);
+    bool timedOut = false;
+    try {
+      store.wait({"missing"}, std::chrono::milliseconds(100));
+    } catch (const std::runtime_error&) {
+      timedOut = true;
+    }
+    if (!timedOut) {
+      throw std::runtime_error("Expected wait to time out");
+    }
+    set(store, "missing", "found");
+    check(store, "missing", "found");
+  }
+
+  // Hammer on TCPStore#add
+  std::vector<std::thread> threads;
+  const auto numThreads = 16;
+  const auto numIterations = 100;
+  Semaphore sem1, sem2;
+  for (auto i = 0; i < numThreads; i++) {
+    threads.push_back(std::move(std::thread([&] {
+            TCPStore store("127.0.0.1", port);
+            sem1.post();
+            sem2.wait();
+            for (auto j = 0; j < numIterations; j++) {
+              store.add("counter", 1);
+            }
+          })));
+  }
+  sem1.wait(numThreads);
+  sem2.post(numThreads);
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  // Check that the counter has the expected value
+  {
+    TCPStore store("127.0.0.1", port);
+    std::stringstream ss;
+    ss << (numThreads * numIterations);
+    check(store, "counter", ss.str());
+  }
+
+  std::cout << "Test successful" << std::endl;
+  return 0;
+}
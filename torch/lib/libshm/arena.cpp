@@ -0,0 +1,179 @@
+#include <atomic>
+#include <cstring>
+#include <mutex>
+#include <random>
+#include <string>
+#include <unordered_map>
+
+#include <unistd.h>
+
+#include <TH/TH.h>
+#include "libshm.h"
+
+// Every block starts with a header, which is followed by the data. Blocks
+// are allocated at increasing positions of the ring and reclaimed in the same
+// order: the owner remembers the positions of the oldest live block (tail)
+// and of the end of the newest one (head), both of which only grow, and when
+// allocating, moves the tail past all blocks whose reference count has dropped
+// to zero. A block that doesn't fit before the end of the segment is preceded
+// by a free padding block that covers the rest of it.
+struct ArenaBlock {
+  std::atomic<int32_t> refcount;
+  uint64_t size; // including the header
+};
+
+static constexpr uint64_t kBlockAlignment = 64;
+static constexpr uint64_t kHeaderSize = kBlockAlignment;
+static_assert(sizeof(ArenaBlock) <= kHeaderSize, "ArenaBlock doesn't fit in its header");
+
+static uint64_t round_up(uint64_t size) {
+  return (size + kBlockAlignment - 1) / kBlockAlignment * kBlockAlignment;
+}
+
+struct libshm_arena {
+  THByteStorage *storage;
+  libshm_context *shm_context; // owned by storage
+  char *base;
+  uint64_t size;
+  pid_t owner;
+
+  std::mutex mutex;
+  uint64_t head = 0;
+  uint64_t tail = 0;
+
+  ArenaBlock * block_at(uint64_t position) {
+    return reinterpret_cast<ArenaBlock*>(base + position % size);
+  }
+};
+
+static libshm_arena *process_arena = nullptr;
+static std::mutex arenas_mutex;
+static std::unordered_map<std::string, libshm_arena*> opened_arenas;
+
+static libshm_arena * arena_new(libshm_context *ctx, uint64_t size) {
+  libshm_arena *arena = new libshm_arena();
+  arena->shm_context = ctx;
+  arena->storage = THByteStorage_newWithAllocator(size, &THManagedSharedAllocator, ctx);
+  arena->base = reinterpret_cast<char*>(THByteStorage_data(arena->storage));
+  arena->size = size;
+  return arena;
+}
+
+int libshm_arena_init(size_t size) {
+  std::lock_guard<std::mutex> lock(arenas_mutex);
+  // A forked child inherits the arena of its parent, but must not allocate
+  // from it.
+  if (process_arena && process_arena->owner == getpid())
+    return 0;
+  std::string handle = "/torch_arena_";
+  handle += std::to_string(getpid());
+  handle += "_";
+  handle += std::to_string(std::random_device()());
+  int flags = TH_ALLOCATOR_MAPPED_SHAREDMEM | TH_ALLOCATOR_MAPPED_EXCLUSIVE;
+  libshm_arena *arena = arena_new(libshm_context_new(NULL, handle.c_str(), flags), round_up(size));
+  arena->owner = getpid();
+  process_arena = arena;
+  return 1;
+}
+
+libshm_arena * libshm_arena_get(void) {
+  std::lock_guard<std::mutex> lock(arenas_mutex);
+  if (process_arena && process_arena->owner == getpid())
+    return process_arena;
+  return NULL;
+}
+
+libshm_arena * libshm_arena_open(const char *manager_handle, const char *filename, size_t size) {
+  std::lock_guard<std::mutex> lock(arenas_mutex);
+  auto it = opened_arenas.find(filename);
+  if (it != opened_arenas.end())
+    return it->second;
+  int flags = TH_ALLOCATOR_MAPPED_SHAREDMEM | TH_ALLOCATOR_MAPPED_NOCREATE;
+  libshm_arena *arena = arena_new(libshm_context_new(manager_handle, filename, flags), size);
+  arena->owner = 0;
+  opened_arenas.emplace(filename, arena);
+  return arena;
+}
+
+const char * libshm_arena_manager_handle(libshm_arena *arena) {
+  return arena->shm_context->manager_handle;
+}
+
+const char * libshm_arena_filename(libshm_arena *arena) {
+  return THMapAllocatorContext_filename(arena->shm_context->th_context);
+}
+
+size_t libshm_arena_size(libshm_arena *arena) {
+  return arena->size;
+}
+
+libshm_arena_context * libshm_arena_context_new(libshm_arena *arena, size_t size) {
+  uint64_t needed = kHeaderSize + round_up(size);
+  std::lock_guard<std::mutex> lock(arena->mutex);
+  while (arena->tail < arena->head &&
+         arena->block_at(arena->tail)->refcount.load(std::memory_order_acquire) == 0) {
+    arena->tail += arena->block_at(arena->tail)->size;
+  }
+  uint64_t position = arena->head % arena->size;
+  uint64_t padding = position + needed > arena->size ? arena->size - position : 0;
+  if (arena->head + padding + needed - arena->tail > arena->size)
+    return NULL;
+  if (padding > 0) {
+    ArenaBlock *pad = arena->block_at(arena->head);
+    pad->size = padding;
+    pad->refcount.store(0, std::memory_order_release);
+    arena->head += padding;
+  }
+  ArenaBlock *block = arena->block_at(arena->head);
+  block->size = needed;
+  block->refcount.store(1, std::memory_order_release);
+  libshm_arena_context *ctx = new libshm_arena_context();
+  ctx->arena = arena;
+  ctx->offset = arena->head % arena->size + kHeaderSize;
+  arena->head += needed;
+  return ctx;
+}
+
+static ArenaBlock * block_of(libshm_arena_context *ctx) {
+  return reinterpret_cast<ArenaBlock*>(ctx->arena->base + ctx->offset - kHeaderSize);
+}
+
+libshm_arena_context * libshm_arena_context_at(libshm_arena *arena, uint64_t offset) {
+  libshm_arena_context *ctx = new libshm_arena_context();
+  ctx->arena = arena;
+  ctx->offset = offset;
+  block_of(ctx)->refcount.fetch_add(1, std::memory_order_relaxed);
+  return ctx;
+}
+
+void libshm_arena_incref(libshm_arena_context *ctx) {
+  block_of(ctx)->refcount.fetch_add(1, std::memory_order_relaxed);
+  THRefcountedMapAllocator_incref(ctx->arena->shm_context->th_context, ctx->arena->base);
+}
+
+void libshm_arena_decref(libshm_arena_context *ctx) {
+  block_of(ctx)->refcount.fetch_sub(1, std::memory_order_acq_rel);
+  THRefcountedMapAllocator_decref(ctx->arena->shm_context->th_context, ctx->arena->base);
+}
+
+static void * arena_alloc(void *_ctx, ptrdiff_t size) {
+  auto *ctx = (libshm_arena_context*)_ctx;
+  return ctx->arena->base + ctx->offset;
+}
+
+static void * arena_realloc(void *_ctx, void *data, ptrdiff_t size) {
+  THError("cannot realloc shared memory");
+  return NULL;
+}
+
+static void arena_free(void *_ctx, void *data) {
+  auto *ctx = (libshm_arena_context*)_ctx;
+  block_of(ctx)->refcount.fetch_sub(1, std::memory_order_acq_rel);
+  delete ctx;
+}
+
+THAllocator THArenaSharedAllocator = {
+  arena_alloc,
+  arena_realloc,
+  arena_free,
+};
@@ -20,4 +20,46 @@ EXPORT_API void libshm_context_free(libshm_context *context);
 
 extern THAllocator THManagedSharedAllocator;
 
+/* Shared memory arenas
+ *
+ * A process can own one arena: a single managed shared memory segment that is
+ * mapped once and that storages are carved out of, so that sending a batch
+ * to another process costs neither a new segment nor a new mapping. Blocks
+ * are allocated from the arena like from a ring buffer, and are reference
+ * counted across processes; a block is reused once every storage that uses it
+ * has been freed, in any process. Only the owning process allocates blocks,
+ * other processes open the arena by name and refer to blocks by offset.
+ */
+typedef struct libshm_arena libshm_arena;
+
+typedef struct {
+  libshm_arena *arena;
+  uint64_t offset; /* of the data of the block */
+} libshm_arena_context;
+
+/* Creates the arena of the calling process, of at least size bytes.
+ * Returns 0 if the process already has one. */
+EXPORT_API int libshm_arena_init(size_t size);
+/* The arena owned by the calling process, or NULL */
+EXPORT_API libshm_arena * libshm_arena_get(void);
+/* Maps an arena owned by another process; arenas are cached by filename */
+EXPORT_API libshm_arena * libshm_arena_open(const char *manager_handle, const char *filename, size_t size);
+EXPORT_API const char * libshm_arena_manager_handle(libshm_arena *arena);
+EXPORT_API const char * libshm_arena_filename(libshm_arena *arena);
+EXPORT_API size_t libshm_arena_size(libshm_arena *arena);
+/* Reserves a block of size bytes in an arena owned by the calling process.
+ * Returns NULL if the arena is full. */
+EXPORT_API libshm_arena_context * libshm_arena_context_new(libshm_arena *arena, size_t size);
+/* Takes a new reference to the block whose data starts at offset */
+EXPORT_API libshm_arena_context * libshm_arena_context_at(libshm_arena *arena, uint64_t offset);
+/* Reference held on behalf of another process. Like the reference counts of
+ * THRefcountedMapAllocator these also keep the segment alive, so that the
+ * receiver can still map it if the owner exits in the meantime. */
+EXPORT_API void libshm_arena_incref(libshm_arena_context *ctx);
+EXPORT_API void libshm_arena_decref(libshm_arena_context *ctx);
+
+/* Allocator for storages in an arena; its context is a
+ * libshm_arena_context, which is freed together with the storage. */
+extern THAllocator THArenaSharedAllocator;
+
 #endif
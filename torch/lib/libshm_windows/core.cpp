@@ -41,3 +41,49 @@ THAllocator THManagedSharedAllocator = {
   libshm_realloc,
   libshm_free,
 };
+
+int libshm_arena_init(size_t size) {
+  return 0;
+}
+
+libshm_arena * libshm_arena_get(void) {
+  return NULL;
+}
+
+libshm_arena * libshm_arena_open(const char *manager_handle, const char *filename, size_t size) {
+  THError("shared memory arenas are not supported on Windows");
+  return NULL;
+}
+
+const char * libshm_arena_manager_handle(libshm_arena *arena) {
+  return "no_manager";
+}
+
+const char * libshm_arena_filename(libshm_arena *arena) {
+  return "";
+}
+
+size_t libshm_arena_size(libshm_arena *arena) {
+  return 0;
+}
+
+libshm_arena_context * libshm_arena_context_new(libshm_arena *arena, size_t size) {
+  return NULL;
+}
+
+libshm_arena_context * libshm_arena_context_at(libshm_arena *arena, uint64_t offset) {
+  THError("shared memory arenas are not supported on Windows");
+  return NULL;
+}
+
+void libshm_arena_incref(libshm_arena_context *ctx) {
+}
+
+void libshm_arena_decref(libshm_arena_context *ctx) {
+}
+
+THAllocator THArenaSharedAllocator = {
+  libshm_alloc,
+  libshm_realloc,
+  libshm_free,
+};
@@ -26,4 +26,26 @@ SHM_API void libshm_context_free(libshm_context *context);
 
 SHM_API THAllocator THManagedSharedAllocator;
 
+// Shared memory arenas are not supported on Windows: libshm_arena_init always
+// fails, and so storages are never allocated from an arena.
+typedef struct libshm_arena libshm_arena;
+
+typedef struct {
+  libshm_arena *arena;
+  uint64_t offset;
+} libshm_arena_context;
+
+SHM_API int libshm_arena_init(size_t size);
+SHM_API libshm_arena * libshm_arena_get(void);
+SHM_API libshm_arena * libshm_arena_open(const char *manager_handle, const char *filename, size_t size);
+SHM_API const char * libshm_arena_manager_handle(libshm_arena *arena);
+SHM_API const char * libshm_arena_filename(libshm_arena *arena);
+SHM_API size_t libshm_arena_size(libshm_arena *arena);
+SHM_API libshm_arena_context * libshm_arena_context_new(libshm_arena *arena, size_t size);
+SHM_API libshm_arena_context * libshm_arena_context_at(libshm_arena *arena, uint64_t offset);
+SHM_API void libshm_arena_incref(libshm_arena_context *ctx);
+SHM_API void libshm_arena_decref(libshm_arena_context *ctx);
+
+SHM_API THAllocator THArenaSharedAllocator;
+
 #endif
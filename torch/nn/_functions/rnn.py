@@ -1,4 +1,5 @@
 import warnings
+import torch
 from torch.autograd import NestedIOFunction
 import torch.backends.cudnn as cudnn
 from .. import functional as F
@@ -294,11 +295,58 @@ def CudnnRNN(mode, input_size, hidden_size, num_layers=1,
     return forward
 
 
+# Modes of torch._cpu_rnn, the same as those of cuDNN
+_cpu_rnn_modes = {'RNN_RELU': 0, 'RNN_TANH': 1, 'LSTM': 2, 'GRU': 3}
+
+
+def CpuRNN(mode, input_size, hidden_size, num_layers=1, batch_first=False,
+           dropout=0, train=True, bidirectional=False, variable_length=False,
+           dropout_state=None, flat_weight=None):
+    cpu_mode = _cpu_rnn_modes[mode]
+
+    def forward(input, weight, hx, batch_sizes):
+        if mode == 'LSTM':
+            hx, cx = hx
+        else:
+            cx = None
+        if batch_first:
+            input = input.transpose(0, 1)
+
+        weight_arr = list(itertools.chain.from_iterable(weight))
+        output, hy, cy = torch._cpu_rnn(input, weight_arr, len(weight[0]), hx, cx,
+                                        cpu_mode, hidden_size, num_layers, bool(bidirectional))
+
+        if batch_first:
+            output = output.transpose(0, 1)
+        if cx is not None:
+            return (output, (hy, cy))
+        else:
+            return (output, hy)
+
+    return forward
+
+
+def _cpu_rnn_is_acceptable(input, weight, hx, variable_length=False, dropout=0, train=True, **kwargs):
+    # torch._cpu_rnn has no backward, and neither packed sequences nor dropout
+    if input.is_cuda or variable_length or (dropout != 0 and train):
+        return False
+    if input.dtype not in (torch.float, torch.double) or torch._C._jit_is_tracing(input):
+        return False
+    if torch.is_grad_enabled():
+        hidden = list(hx) if isinstance(hx, tuple) else [hx]
+        tensors = [input] + hidden + list(itertools.chain.from_iterable(weight))
+        if any(t.requires_grad for t in tensors):
+            return False
+    return True
+
+
 def RNN(*args, **kwargs):
 
     def forward(input, *fargs, **fkwargs):
         if cudnn.is_acceptable(input.data):
             func = CudnnRNN(*args, **kwargs)
+        elif _cpu_rnn_is_acceptable(input, fargs[0], fargs[1], **kwargs):
+            func = CpuRNN(*args, **kwargs)
         else:
             func = AutogradRNN(*args, **kwargs)
 
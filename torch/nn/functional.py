@@ -246,28 +246,53 @@ def avg_pool1d(input, kernel_size, stride=None, padding=0,
                       ceil_mode, count_include_pad).squeeze(3)
 
 
-avg_pool2d = _add_docstr(torch._C._nn.avg_pool2d, r"""
-avg_pool2d(input, kernel_size, stride=None, padding=0, ceil_mode=False, count_include_pad=True) -> Tensor
+def _use_channels_last_pooling(input):
+    return not input.is_cuda and input.dtype in (torch.float32, torch.float64) and input.is_channels_last()
 
-Applies 2D average-pooling operation in :math:`kH \times kW` regions by step size
-:math:`sH \times sW` steps. The number of output features is equal to the number of
-input planes.
 
-See :class:`~torch.nn.AvgPool2d` for details and output shape.
+def _use_contiguous_pooling(input):
+    # The native pooling kernels of contiguous CPU tensors, which THNN's
+    # backwards differentiate
+    return (not input.is_cuda and input.dtype in (torch.float32, torch.float64) and
+            input.dim() in (3, 4) and input.is_contiguous())
+
+
+def _use_mkldnn_pooling(input):
+    # The MKL-DNN pooling primitives only compute the output
+    return (torch._C.has_mkldnn and not input.requires_grad and not input.is_cuda and
+            input.dtype == torch.float32 and input.dim() == 4)
+
+
+def avg_pool2d(input, kernel_size, stride=None, padding=0, ceil_mode=False, count_include_pad=True):
+    r"""Applies 2D average-pooling operation in :math:`kH \times kW` regions by step size
+    :math:`sH \times sW` steps. The number of output features is equal to the number of
+    input planes.
+
+    See :class:`~torch.nn.AvgPool2d` for details and output shape.
+
+    Args:
+        input: input tensor (:math:`minibatch \times in\_channels \times iH \times iW`)
+        kernel_size: size of the pooling region. Can be a single number or a
+          tuple (:math:`kH \times kW`)
+        stride: stride of the pooling operation. Can be a single number or a
+          tuple `(sH, sW)`. Default: :attr:`kernel_size`
+        padding: implicit zero paddings on both sides of the input. Can be a
+          single number or a tuple `(padH, padW)`. Default: 0
+        ceil_mode: when True, will use `ceil` instead of `floor` in the formula
+            to compute the output shape. Default: ``False``
+        count_include_pad: when True, will include the zero-padding in the
+            averaging calculation. Default: ``True``
+    """
+    if stride is None:
+        stride = kernel_size
+    if _use_channels_last_pooling(input):
+        return torch._avg_pool2d_channels_last(input, kernel_size, stride, padding, ceil_mode, count_include_pad)
+    if _use_mkldnn_pooling(input) and not (ceil_mode and count_include_pad):
+        return torch.mkldnn_avg_pool2d(input, kernel_size, stride, padding, ceil_mode, count_include_pad)
+    if _use_contiguous_pooling(input):
+        return torch._avg_pool2d_contiguous(input, kernel_size, stride, padding, ceil_mode, count_include_pad)
+    return torch._C._nn.avg_pool2d(input, kernel_size, stride, padding, ceil_mode, count_include_pad)
 
-Args:
-    input: input tensor (:math:`minibatch \times in\_channels \times iH \times iW`)
-    kernel_size: size of the pooling region. Can be a single number or a
-      tuple (:math:`kH \times kW`)
-    stride: stride of the pooling operation. Can be a single number or a
-      tuple `(sH, sW)`. Default: :attr:`kernel_size`
-    padding: implicit zero paddings on both sides of the input. Can be a
-      single number or a tuple `(padH, padW)`. Default: 0
-    ceil_mode: when True, will use `ceil` instead of `floor` in the formula
-        to compute the output shape. Default: ``False``
-    count_include_pad: when True, will include the zero-padding in the
-        averaging calculation. Default: ``True``
-""")
 
 avg_pool3d = _add_docstr(torch._C._nn.avg_pool3d, r"""
 avg_pool3d(input, kernel_size, stride=None, padding=0, ceil_mode=False, count_include_pad=True) -> Tensor
@@ -357,6 +382,20 @@ def max_pool2d(input, kernel_size, stride=None, padding=0, dilation=1,
 
     See :class:`~torch.nn.MaxPool2d` for details.
     """
+    if _use_channels_last_pooling(input):
+        if stride is None:
+            stride = kernel_size
+        ret = torch._max_pool2d_channels_last(input, kernel_size, stride, padding, dilation, ceil_mode)
+        return ret if return_indices else ret[0]
+    if not return_indices and _pair(dilation) == (1, 1) and _use_mkldnn_pooling(input):
+        if stride is None:
+            stride = kernel_size
+        return torch.mkldnn_max_pool2d(input, kernel_size, stride, padding, ceil_mode)
+    if _use_contiguous_pooling(input):
+        if stride is None:
+            stride = kernel_size
+        ret = torch._max_pool2d_contiguous(input, kernel_size, stride, padding, dilation, ceil_mode)
+        return ret if return_indices else ret[0]
     ret = torch._C._nn.max_pool2d(input, kernel_size, stride, padding, dilation, ceil_mode)
     return ret if return_indices else ret[0]
 
@@ -490,7 +529,11 @@ def adaptive_max_pool2d(input, output_size, return_indices=False):
             double-integer tuple)
         return_indices: whether to return pooling indices. Default: ``False``
     """
-    ret = torch._C._nn.adaptive_max_pool2d(input, output_size)
+    output_size = _pair(output_size)
+    if _use_contiguous_pooling(input) and None not in output_size:
+        ret = torch._adaptive_max_pool2d_contiguous(input, output_size)
+    else:
+        ret = torch._C._nn.adaptive_max_pool2d(input, output_size)
     return ret if return_indices else ret[0]
 
 
@@ -521,18 +564,21 @@ Args:
     output_size: the target output size (single integer)
 """)
 
-adaptive_avg_pool2d = _add_docstr(torch._C._nn.adaptive_avg_pool2d, r"""
-adaptive_avg_pool2d(input, output_size) -> Tensor
+def adaptive_avg_pool2d(input, output_size):
+    r"""Applies a 2D adaptive average pooling over an input signal composed of
+    several input planes.
 
-Applies a 2D adaptive average pooling over an input signal composed of
-several input planes.
+    See :class:`~torch.nn.AdaptiveAvgPool2d` for details and output shape.
 
-See :class:`~torch.nn.AdaptiveAvgPool2d` for details and output shape.
+    Args:
+        output_size: the target output size (single integer or
+            double-integer tuple)
+    """
+    output_size = _pair(output_size)
+    if _use_contiguous_pooling(input) and None not in output_size:
+        return torch._adaptive_avg_pool2d_contiguous(input, output_size)
+    return torch._C._nn.adaptive_avg_pool2d(input, output_size)
 
-Args:
-    output_size: the target output size (single integer or
-        double-integer tuple)
-""")
 
 adaptive_avg_pool3d = _add_docstr(torch._C._nn.adaptive_avg_pool3d, r"""
 adaptive_avg_pool3d(input, output_size) -> Tensor
@@ -550,7 +596,17 @@ Args:
 
 # Activation functions
 
+def _use_fused_dropout(input, p, training, inplace):
+    # _fused_dropout saves a bit-packed mask for backward instead of a mask
+    # of the size of input
+    if not training or inplace or not 0 < p < 1:
+        return False
+    return input.dtype in (torch.float, torch.double) or (input.is_cuda and input.dtype == torch.half)
+
+
 def dropout(input, p=0.5, training=False, inplace=False):
+    if _use_fused_dropout(input, p, training, inplace):
+        return torch._fused_dropout(input, p)[0]
     return _functions.dropout.Dropout.apply(input, p, training, inplace)
 
 
@@ -1417,7 +1473,8 @@ Args:
 """)
 
 
-def cross_entropy(input, target, weight=None, size_average=True, ignore_index=-100, reduce=True):
+def cross_entropy(input, target, weight=None, size_average=True, ignore_index=-100, reduce=True,
+                  label_smoothing=0):
     r"""This criterion combines `log_softmax` and `nll_loss` in a single
     function.
 
@@ -1443,6 +1500,9 @@ def cross_entropy(input, target, weight=None, size_average=True, ignore_index=-1
                 observations for each minibatch depending on :attr:`size_average`. When :attr:`reduce`
                 is ``False``, returns a loss per batch instead and ignores
                 :attr:`size_average`. Default: ``True``
+        label_smoothing (float, optional): A value :math:`\epsilon` in [0, 1]. The
+                target distribution becomes :math:`(1 - \epsilon)` on the target
+                class plus :math:`\epsilon / C` on every class. Default: 0
 
     Examples::
 
@@ -1451,6 +1511,22 @@ def cross_entropy(input, target, weight=None, size_average=True, ignore_index=-1
         >>> loss = F.cross_entropy(input, target)
         >>> loss.backward()
     """
+    if input.dim() == 2 and target.dim() == 1 and input.size(0) == target.size(0):
+        # computed in one pass, without materializing log_softmax(input)
+        return torch._log_softmax_nll_loss(input, target, weight, size_average, ignore_index, reduce,
+                                           label_smoothing)[0]
+    if label_smoothing != 0 and input.dim() > 2:
+        # the classes of every (n, d_1, ..., d_K) become a row
+        if target.size() != input.size()[:1] + input.size()[2:]:
+            raise ValueError('Expected target size {}, got {}'.format(
+                input.size()[:1] + input.size()[2:], target.size()))
+        dims = [0] + list(range(2, input.dim())) + [1]
+        scores = input.permute(*dims).contiguous().view(-1, input.size(1))
+        out = torch._log_softmax_nll_loss(scores, target.contiguous().view(-1), weight,
+                                          size_average, ignore_index, reduce, label_smoothing)[0]
+        return out if reduce else out.view(target.size())
+    if label_smoothing != 0:
+        raise ValueError('label_smoothing requires a 2-D or higher input, got {}-D'.format(input.dim()))
     return nll_loss(log_softmax(input, 1), target, weight, size_average, ignore_index, reduce)
 
 
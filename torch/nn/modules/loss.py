@@ -745,6 +745,12 @@ class CrossEntropyLoss(_WeightedLoss):
             observations for each minibatch depending on `size_average`. When reduce
             is ``False``, returns a loss per batch instead and ignores
             size_average. Default: ``True``
+        label_smoothing (float, optional): A value :math:`\epsilon` in [0, 1].
+            The target distribution becomes :math:`1 - \epsilon` on the target
+            class plus :math:`\epsilon / C` on every class, so that
+            :math:`\text{loss}(x, class) = weight[class] \left(-(1 - \epsilon) x[class]
+            - \frac{\epsilon}{C} \sum_j x[j] + \log\left(\sum_j \exp(x[j])\right)\right)`.
+            Default: 0
 
     Shape:
         - Input: :math:`(N, C)` where `C = number of classes`, or
@@ -767,14 +773,16 @@ class CrossEntropyLoss(_WeightedLoss):
         >>> output.backward()
     """
 
-    def __init__(self, weight=None, size_average=True, ignore_index=-100, reduce=True):
+    def __init__(self, weight=None, size_average=True, ignore_index=-100, reduce=True,
+                 label_smoothing=0):
         super(CrossEntropyLoss, self).__init__(weight, size_average, reduce)
         self.ignore_index = ignore_index
+        self.label_smoothing = label_smoothing
 
     def forward(self, input, target):
         _assert_no_grad(target)
         return F.cross_entropy(input, target, self.weight, self.size_average,
-                               self.ignore_index, self.reduce)
+                               self.ignore_index, self.reduce, self.label_smoothing)
 
 
 class MultiLabelSoftMarginLoss(_WeightedLoss):
@@ -1,9 +1,9 @@
 from .parallel_apply import parallel_apply
-from .replicate import replicate
+from .replicate import replicate, ReplicaCache
 from .data_parallel import DataParallel, data_parallel
 from .scatter_gather import scatter, gather
 from .distributed import DistributedDataParallel
 from .distributed_cpu import DistributedDataParallelCPU
 
-__all__ = ['replicate', 'scatter', 'parallel_apply', 'gather', 'data_parallel',
+__all__ = ['replicate', 'ReplicaCache', 'scatter', 'parallel_apply', 'gather', 'data_parallel',
            'DataParallel', 'DistributedDataParallel', 'DistributedDataParallelCPU']
@@ -3,7 +3,7 @@ import torch
 import warnings
 from ..modules import Module
 from .scatter_gather import scatter_kwargs, gather
-from .replicate import replicate
+from .replicate import replicate, ReplicaCache
 from .parallel_apply import parallel_apply
 
 
@@ -73,6 +73,12 @@ class DataParallel(Module):
         module: module to be parallelized
         device_ids: CUDA devices (default: all devices)
         output_device: device location of output (default: device_ids[0])
+        cache_replicas: keep the replicas and the copies of the parameters and
+            buffers on the devices between forward passes run with gradients
+            disabled, re-broadcasting only what was modified in-place (see
+            :class:`~torch.nn.parallel.replicate.ReplicaCache`). Call
+            :meth:`invalidate_replicas` after writing to the parameters
+            through ``.data`` or loading a state dict (default: False)
 
     Attributes:
         module (Module): the module to be parallelized
@@ -85,8 +91,10 @@ class DataParallel(Module):
 
     # TODO: update notes/cuda.rst when this class handles 8+ GPUs well
 
-    def __init__(self, module, device_ids=None, output_device=None, dim=0):
+    def __init__(self, module, device_ids=None, output_device=None, dim=0, cache_replicas=False):
         super(DataParallel, self).__init__()
+        self.cache_replicas = cache_replicas
+        self._replica_cache = None
 
         if not torch.cuda.is_available():
             self.module = module
@@ -113,10 +121,30 @@ class DataParallel(Module):
         inputs, kwargs = self.scatter(inputs, kwargs, self.device_ids)
         if len(self.device_ids) == 1:
             return self.module(*inputs[0], **kwargs[0])
-        replicas = self.replicate(self.module, self.device_ids[:len(inputs)])
+        if self.cache_replicas and not torch.is_grad_enabled():
+            if self._replica_cache is None:
+                self._replica_cache = ReplicaCache(self.device_ids)
+            replicas = self._replica_cache(self.module)[:len(inputs)]
+        else:
+            replicas = self.replicate(self.module, self.device_ids[:len(inputs)])
         outputs = self.parallel_apply(replicas, inputs, kwargs)
         return self.gather(outputs, self.output_device)
 
+    def invalidate_replicas(self):
+        r"""Drops the replicas kept with ``cache_replicas``, so that the next
+        forward pass broadcasts all parameters and buffers again."""
+        self._replica_cache = None
+
+    def __getstate__(self):
+        state = self.__dict__.copy()
+        state['_replica_cache'] = None
+        return state
+
+    def __setstate__(self, state):
+        super(DataParallel, self).__setstate__(state)
+        self.__dict__.setdefault('cache_replicas', False)
+        self.__dict__.setdefault('_replica_cache', None)
+
     def replicate(self, module, device_ids):
         return replicate(module, device_ids)
 
@@ -6,7 +6,7 @@ import copy
 import torch
 from torch.autograd import Variable
 from torch._utils import _flatten_dense_tensors, _unflatten_dense_tensors, \
-    _take_tensors
+    _take_tensors, _flat_dense_buffer, _bind_grads_to_views
 
 from torch.cuda.comm import broadcast_coalesced
 from torch.cuda import nccl
@@ -92,6 +92,9 @@ class DistributedDataParallel(Module):
         broadcast_buffers: flag that enables syncing (broadcasting) buffers of
                            the module at beginning of the forward function.
                            (default: True)
+        compression: compressor of the gradient all-reduces, e.g. one from
+                     :mod:`torch.distributed.compression`. Not supported by
+                     the NCCL backend. (default: None)
 
     Attributes:
         module (Module): the module to be parallelized
@@ -103,7 +106,7 @@ class DistributedDataParallel(Module):
     """
 
     def __init__(self, module, device_ids=None, output_device=None, dim=0,
-                 broadcast_buffers=True):
+                 broadcast_buffers=True, compression=None):
         super(DistributedDataParallel, self).__init__()
         if device_ids is None:
             device_ids = list(range(torch.cuda.device_count()))
@@ -114,6 +117,7 @@ class DistributedDataParallel(Module):
         self.device_ids = device_ids
         self.output_device = output_device
         self.broadcast_buffers = broadcast_buffers
+        self.compression = compression
 
         # Flag used by the NCCL backend to make sure we only reduce gradients
         # one time in the execution engine
@@ -144,11 +148,16 @@ class DistributedDataParallel(Module):
         else:
             self._module_copies = [self.module]
 
+        self._grad_buffers = []
+
         # For NCCL backend, since every single NCCL call is asynchoronous, we
         # therefore directly enqueue all the NCCL reduction calls to the
         # default CUDA stream without spawning up other reduction threads.
         # This achieves the best performance.
         if dist._backend == dist.dist_backend.NCCL:
+            if compression is not None:
+                raise ValueError("DistributedDataParallel doesn't support "
+                                 "gradient compression with the NCCL backend")
             self._register_nccl_grad_hook()
             return
 
@@ -189,6 +198,7 @@ class DistributedDataParallel(Module):
         self.bucket_events = [[None] * len(self.device_ids) for _ in range(len(self.bucket_sizes))]
         self.reduced = [False] * len(self.bucket_sizes)
 
+        self._make_grad_buffers()
         self._register_grad_hooks()
 
         self.dispatch_lock = threading.Lock()
@@ -199,7 +209,8 @@ class DistributedDataParallel(Module):
         if dist._backend != dist.dist_backend.NCCL:
             del attrs['_grad_accs'], attrs['_reduction_queues'], \
                 attrs['_reduction_streams'], attrs['_reduction_threads'], \
-                attrs['_nccl_streams'], attrs['_default_streams']
+                attrs['_nccl_streams'], attrs['_default_streams'], \
+                attrs['_grad_buffers']
         return attrs
 
     def __setstate__(self, state):
@@ -207,11 +218,14 @@ class DistributedDataParallel(Module):
         if dist._backend == dist.dist_backend.NCCL:
             self._register_nccl_grad_hook()
         else:
+            self._make_grad_buffers()
             self._register_grad_hooks()
             self._start_reduction_threads()
 
     def forward(self, *inputs, **kwargs):
         self.need_reduction = True
+        for params, _, views in self._grad_buffers:
+            _bind_grads_to_views(params, views)
         inputs, kwargs = self.scatter(inputs, kwargs, self.device_ids)
         self._sync_params()
         if len(self.device_ids) == 1:
@@ -273,6 +287,23 @@ class DistributedDataParallel(Module):
                         for tensor, buf in zip(tensors, module._all_buffers()):
                             buf.set_(tensor)
 
+    def _make_grad_buffers(self):
+        # The gradients of the first device's parameters are views of one
+        # persistent flat buffer per bucket, so that they don't have to be
+        # flattened before the reduction and copied back after it
+        bucket_params = [[] for _ in range(len(self.bucket_sizes))]
+        for p in self.module.parameters():
+            if p in self.bucket_map:
+                bucket_params[self.bucket_map[p]].append(p)
+
+        self._grad_buffers = []
+        for params in bucket_params:
+            if len(params) == 0:
+                self._grad_buffers.append((params, None, ()))
+                continue
+            flat, views = _flat_dense_buffer([p.data for p in params])
+            self._grad_buffers.append((params, flat, views))
+
     def _register_grad_hooks(self):
         self._grad_accs = []  # need to keep them in scope
         for device_idx, module in enumerate(self._module_copies):
@@ -396,9 +427,17 @@ class DistributedDataParallel(Module):
         if any(evt is None for evt in dev_events):
             return
 
+        # The gradients can be reduced in place of the buffer, unless some of
+        # them were replaced since the forward pass
+        _, flat, views = self._grad_buffers[bucket_idx]
+        grad_ptrs = set(grad.data_ptr() for grad in dev_buckets[0])
+        if len(grad_ptrs) != len(views) or \
+                any(view.data_ptr() not in grad_ptrs for view in views):
+            flat = None
+
         # Queue the reduction and make sure backward waits for it
         event = threading.Event()
-        self._reduction_queues[bucket_idx].put((dev_buckets, dev_events, event))
+        self._reduction_queues[bucket_idx].put((dev_buckets, dev_events, flat, event))
         Variable._execution_engine.queue_callback(lambda: event.wait())
 
         # Reset bucket state
@@ -430,7 +469,8 @@ class DistributedDataParallel(Module):
                 # TODO: don't assume we're on a default stream
                 self._default_streams.append(torch.cuda.current_stream())
                 self._nccl_streams.append(torch.cuda.Stream())
-        for reduction_queue, reduction_streams in zip(self._reduction_queues, self._reduction_streams):
+        for bucket_idx, (reduction_queue, reduction_streams) in \
+                enumerate(zip(self._reduction_queues, self._reduction_streams)):
             for dev_id in self.device_ids:
                 with torch.cuda.device(dev_id):
                     reduction_streams.append(torch.cuda.Stream())
@@ -441,21 +481,27 @@ class DistributedDataParallel(Module):
 
             self._reduction_threads.append(threading.Thread(
                 target=self._reduction_thread_fn,
-                args=(reduction_queue, group_id, self.device_ids, reduction_streams, self._nccl_streams)))
+                args=(reduction_queue, group_id, self.device_ids, reduction_streams, self._nccl_streams,
+                      self.compression, bucket_idx)))
             self._reduction_threads[-1].daemon = True
             self._reduction_threads[-1].start()
 
     @staticmethod
-    def _reduction_thread_fn(queue, group_id, device_ids, reduction_streams, nccl_streams):
+    def _reduction_thread_fn(queue, group_id, device_ids, reduction_streams, nccl_streams,
+                             compression, bucket_idx):
 
         def _process_batch():
-            dev_grad_batch, dev_events, job_event = queue.get()
+            dev_grad_batch, dev_events, grad_buffer, job_event = queue.get()
             dev_coalesced = []
             # Coalesce the tensors on all devices and start a local reduction
             for dev_id, grad_batch, event, stream in zip(device_ids, dev_grad_batch, dev_events, reduction_streams):
                 with torch.cuda.device(dev_id), torch.cuda.stream(stream):
                     stream.wait_event(event)
-                    coalesced = _flatten_dense_tensors(grad_batch)
+                    if grad_buffer is not None and not dev_coalesced:
+                        # The first device's gradients are already coalesced
+                        coalesced = grad_buffer
+                    else:
+                        coalesced = _flatten_dense_tensors(grad_batch)
                     dev_coalesced.append(coalesced)
             # Wait for all copies to complete before starting the NCCL kernel
             for stream in reduction_streams:
@@ -469,9 +515,13 @@ class DistributedDataParallel(Module):
             with torch.cuda.stream(reduce_stream):
                 reduce_stream.wait_stream(nccl_streams[0])
                 coalesced /= dist.get_world_size()
-                dist.all_reduce(coalesced, group=group_id)
-                for grad, reduced in zip(grad_batch, _unflatten_dense_tensors(coalesced, grad_batch)):
-                    grad.copy_(reduced)
+                if compression is not None:
+                    compression.all_reduce(coalesced, group=group_id, key=bucket_idx)
+                else:
+                    dist.all_reduce(coalesced, group=group_id)
+                if grad_buffer is None:
+                    for grad, reduced in zip(grad_batch, _unflatten_dense_tensors(coalesced, grad_batch)):
+                        grad.copy_(reduced)
             job_event.set()
 
         with torch.cuda.device(device_ids[0]):
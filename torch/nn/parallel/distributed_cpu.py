@@ -1,5 +1,5 @@
 import torch
-from torch._utils import _flatten_dense_tensors, _unflatten_dense_tensors
+from torch._utils import _flat_dense_buffer, _bind_grads_to_views
 import torch.distributed as dist
 from torch.nn.modules import Module
 from collections import defaultdict
@@ -60,6 +60,8 @@ class DistributedDataParallelCPU(Module):
 
     Args:
         module: module to be parallelized
+        compression: compressor of the gradient all-reduces, e.g. one from
+                     :mod:`torch.distributed.compression` (default: None)
 
     Example::
 
@@ -67,27 +69,25 @@ class DistributedDataParallelCPU(Module):
         >>> net = torch.nn.DistributedDataParallelCPU(model)
     """
 
-    def __init__(self, module):
+    def __init__(self, module, compression=None):
         super(DistributedDataParallelCPU, self).__init__()
         self.module = module
+        self.compression = compression
         self.sync_parameters()
 
+        self._make_grad_buffers()
+
         def allreduce_params():
             if self.needs_reduction:
                 self.needs_reduction = False
-                buckets = defaultdict(list)
-                for param in self.module.parameters():
-                    if param.requires_grad and param.grad is not None:
-                        tp = type(param.data)
-                        buckets[tp].append(param)
-
-                for bucket in buckets.values():
-                    grads = [param.grad.data for param in bucket]
-                    coalesced = _flatten_dense_tensors(grads)
-                    dist.all_reduce(coalesced)
-                    coalesced /= dist.get_world_size()
-                    for buf, synced in zip(grads, _unflatten_dense_tensors(coalesced, grads)):
-                        buf.copy_(synced)
+                for bucket_idx, (bucket, flat, views) in enumerate(self._grad_buffers):
+                    # Gradients replaced during backward are copied back in
+                    _bind_grads_to_views(bucket, views)
+                    if self.compression is not None:
+                        self.compression.all_reduce(flat, key=bucket_idx)
+                    else:
+                        dist.all_reduce(flat)
+                    flat /= dist.get_world_size()
 
         for param in list(self.module.parameters()):
             def allreduce_hook(*unused):
@@ -100,6 +100,21 @@ class DistributedDataParallelCPU(Module):
         for param in self.module.parameters():
             dist.broadcast(param.data, 0)
 
+    def _make_grad_buffers(self):
+        # One persistent flat buffer per parameter type, which the gradients
+        # are views of, so that they are all-reduced without any copy
+        buckets = defaultdict(list)
+        for param in self.module.parameters():
+            if param.requires_grad:
+                buckets[param.type()].append(param)
+
+        self._grad_buffers = []
+        for bucket in buckets.values():
+            flat, views = _flat_dense_buffer([param.data for param in bucket])
+            self._grad_buffers.append((bucket, flat, views))
+
     def forward(self, *inputs, **kwargs):
         self.needs_reduction = True
+        for bucket, _, views in self._grad_buffers:
+            _bind_grads_to_views(bucket, views)
         return self.module(*inputs, **kwargs)
@@ -1,3 +1,4 @@
+import torch
 import torch.cuda.comm as comm
 
 
@@ -8,18 +9,25 @@ def replicate(network, devices, detach=False):
     num_replicas = len(devices)
 
     params = list(network.parameters())
-    param_indices = {param: idx for idx, param in enumerate(params)}
     param_copies = Broadcast.apply(devices, *params)
     if len(params) > 0:
         param_copies = [param_copies[i:i + len(params)]
                         for i in range(0, len(param_copies), len(params))]
 
     buffers = list(network._all_buffers())
-    buffer_indices = {buf: idx for idx, buf in enumerate(buffers)}
     buffer_copies = comm.broadcast_coalesced(buffers, devices)
 
+    return _build_replicas(network, num_replicas, params, param_copies,
+                           buffers, buffer_copies, detach)
+
+
+def _build_replicas(network, num_replicas, params, param_copies, buffers,
+                    buffer_copies, detach=False):
+    param_indices = {param: idx for idx, param in enumerate(params)}
+    buffer_indices = {buf: idx for idx, buf in enumerate(buffers)}
+
     modules = list(network.modules())
-    module_copies = [[] for device in devices]
+    module_copies = [[] for _ in range(num_replicas)]
     module_indices = {}
 
     for i, module in enumerate(modules):
@@ -66,3 +74,50 @@ def replicate(network, devices, detach=False):
                     replica._buffers[key] = buffer_copies[j][buffer_idx]
 
     return [module_copies[j][0] for j in range(num_replicas)]
+
+
+class ReplicaCache(object):
+    r"""Replicates a network onto devices for inference, keeping the copies
+    of its parameters and buffers on the devices from call to call.
+
+    Each call only broadcasts the parameters and buffers that were modified
+    in-place since the previous one, as told by their version counters, and
+    returns the same replicas unless the network changed: its modules, their
+    training mode, or the parameters and buffers themselves. The broadcasts
+    are not recorded by autograd, so the replicas are meant to be run with
+    gradients disabled (see :class:`torch.no_grad`).
+
+    Writes through ``.data``, such as optimizer steps and
+    :meth:`~torch.nn.Module.load_state_dict`, and changes to other attributes
+    of the modules are not detected; call :meth:`invalidate` after them.
+
+    Arguments:
+        devices (Iterable[int]): devices of the replicas. The network has to
+            be on the first one.
+        buffer_size (int): maximum size of the buffers used for coalescing
+    """
+
+    def __init__(self, devices, buffer_size=10485760):
+        self.devices = tuple(devices)
+        self._cache = torch._C._CudaReplicaCache(self.devices, buffer_size)
+        self._replicas = None
+        self._key = None
+
+    def __call__(self, network):
+        params = list(network.parameters())
+        buffers = list(network._all_buffers())
+        changed = self._cache.sync(params + buffers)
+        key = [(id(module), module.training) for module in network.modules()]
+        if changed or self._replicas is None or key != self._key:
+            copies = self._cache.copies()
+            param_copies = [c[:len(params)] for c in copies]
+            buffer_copies = [c[len(params):] for c in copies]
+            self._replicas = _build_replicas(network, len(self.devices), params,
+                                             param_copies, buffers, buffer_copies)
+            self._key = key
+        return self._replicas
+
+    def invalidate(self):
+        r"""Makes the next call broadcast everything and rebuild the replicas."""
+        self._cache.invalidate()
+        self._replicas = None
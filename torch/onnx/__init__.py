@@ -13,6 +13,9 @@ class ExportTypes:
     ZIP_ARCHIVE = 2
     COMPRESSED_ZIP_ARCHIVE = 3
     DIRECTORY = 4
+    # The model is written to f, and the raw data of the parameters to
+    # f + ".data"; each initializer records its offset there in its doc_string
+    EXTERNAL_DATA = 5
 
 
 def _export(*args, **kwargs):
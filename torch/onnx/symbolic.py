@@ -477,6 +477,11 @@ avg_pool1d = _avg_pool('avg_pool1d', _single)
 avg_pool2d = _avg_pool('avg_pool2d', _pair)
 avg_pool3d = _avg_pool('avg_pool3d', _triple)
 
+# The CPU kernels of contiguous tensors that F.max_pool2d and F.avg_pool2d
+# call instead of THNN
+_max_pool2d_contiguous = max_pool2d
+_avg_pool2d_contiguous = avg_pool2d
+
 
 def reflection_pad(g, input, padding):
     from torch.autograd._functions.utils import prepare_onnx_paddings
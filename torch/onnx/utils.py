@@ -200,8 +200,15 @@ def _export(model, args, f, export_params=True, verbose=False, training=False,
                                                output_names, aten, export_raw_ir,
                                                example_outputs, propagate)
 
-    # TODO: Don't allocate a in-memory string for the protobuf
     from torch.onnx.symbolic import _onnx_opset_version
+    if export_type == ExportTypes.EXTERNAL_DATA:
+        if not isinstance(f, string_classes):
+            raise ValueError("exporting with external data requires f to be a file name")
+        graph.export_external_data(params if export_params else [], _onnx_opset_version,
+                                   export_raw_ir, f, f + ".data")
+        return torch_out
+
+    # TODO: Don't allocate a in-memory string for the protobuf
     defer_weight_export = export_type is not ExportTypes.PROTOBUF_FILE
     if export_params:
         proto, export_map = graph.export(params, _onnx_opset_version, defer_weight_export, export_raw_ir)
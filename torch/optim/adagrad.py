@@ -1,5 +1,5 @@
 import torch
-from .optimizer import Optimizer
+from .optimizer import Optimizer, _fusable, _fused_buckets
 
 
 class Adagrad(Optimizer):
@@ -57,9 +57,13 @@ class Adagrad(Optimizer):
             loss = closure()
 
         for group in self.param_groups:
+            fused = []
             for p in group['params']:
                 if p.grad is None:
                     continue
+                if _fusable(p):
+                    fused.append(p)
+                    continue
 
                 grad = p.grad.data
                 state = self.state[p]
@@ -93,4 +97,18 @@ class Adagrad(Optimizer):
                     std = state['sum'].sqrt().add_(1e-10)
                     p.data.addcdiv_(-clr, grad, std)
 
+            for params in _fused_buckets(fused, lambda p: self.state[p]['step']):
+                self._fused_step(group, params)
+
         return loss
+
+    def _fused_step(self, group, params):
+        # Steps CUDA parameters, which are at the same step, in one kernel
+        # launch per few hundred chunks
+        states = [self.state[p] for p in params]
+        step = states[0]['step'] + 1
+        for state in states:
+            state['step'] = step
+        clr = group['lr'] / (1 + (step - 1) * group['lr_decay'])
+        torch._fused_adagrad([p.data for p in params], [p.grad.data for p in params],
+                             [state['sum'] for state in states], clr, group['weight_decay'])
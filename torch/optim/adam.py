@@ -1,6 +1,6 @@
 import math
 import torch
-from .optimizer import Optimizer
+from .optimizer import Optimizer, _fusable, _fused_buckets
 
 
 class Adam(Optimizer):
@@ -57,6 +57,7 @@ class Adam(Optimizer):
             loss = closure()
 
         for group in self.param_groups:
+            fused = []
             for p in group['params']:
                 if p.grad is None:
                     continue
@@ -78,6 +79,10 @@ class Adam(Optimizer):
                         # Maintains max of all exp. moving avg. of sq. grad. values
                         state['max_exp_avg_sq'] = torch.zeros_like(p.data)
 
+                if _fusable(p):
+                    fused.append(p)
+                    continue
+
                 exp_avg, exp_avg_sq = state['exp_avg'], state['exp_avg_sq']
                 if amsgrad:
                     max_exp_avg_sq = state['max_exp_avg_sq']
@@ -105,4 +110,25 @@ class Adam(Optimizer):
 
                 p.data.addcdiv_(-step_size, exp_avg, denom)
 
+            for params in _fused_buckets(fused, lambda p: self.state[p]['step']):
+                self._fused_step(group, params)
+
         return loss
+
+    def _fused_step(self, group, params):
+        # Steps CUDA parameters, which are at the same step, in one kernel
+        # launch per few hundred chunks
+        states = [self.state[p] for p in params]
+        beta1, beta2 = group['betas']
+        step = states[0]['step'] + 1
+        for state in states:
+            state['step'] = step
+        bias_correction1 = 1 - beta1 ** step
+        bias_correction2 = 1 - beta2 ** step
+        step_size = group['lr'] * math.sqrt(bias_correction2) / bias_correction1
+        max_exp_avg_sqs = [state['max_exp_avg_sq'] for state in states] if group['amsgrad'] else []
+        torch._fused_adam([p.data for p in params], [p.grad.data for p in params],
+                          [state['exp_avg'] for state in states],
+                          [state['exp_avg_sq'] for state in states],
+                          max_exp_avg_sqs, step_size, beta1, beta2, group['eps'],
+                          group['weight_decay'])
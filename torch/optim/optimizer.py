@@ -207,3 +207,20 @@ class Optimizer(object):
             raise ValueError("some parameters appear in more than one parameter group")
 
         self.param_groups.append(param_group)
+
+
+def _fusable(p):
+    r"""Whether the update of parameter ``p`` can go through one of the fused
+    optimizer kernels, which step many CUDA parameters in a single launch."""
+    grad = p.grad.data
+    return (p.is_cuda and not grad.is_sparse and grad.type() == p.type() and
+            p.is_contiguous() and grad.is_contiguous())
+
+
+def _fused_buckets(params, key=None):
+    r"""Splits ``params`` into the lists that a fused optimizer kernel can step
+    together: of one type, on one device, and with the same ``key(p)``."""
+    buckets = defaultdict(list)
+    for p in params:
+        buckets[(p.type(), p.get_device(), key(p) if key is not None else None)].append(p)
+    return buckets.values()
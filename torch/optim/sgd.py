@@ -1,5 +1,5 @@
 import torch
-from .optimizer import Optimizer, required
+from .optimizer import Optimizer, required, _fusable, _fused_buckets
 
 
 class SGD(Optimizer):
@@ -85,9 +85,13 @@ class SGD(Optimizer):
             dampening = group['dampening']
             nesterov = group['nesterov']
 
+            fused = []
             for p in group['params']:
                 if p.grad is None:
                     continue
+                if _fusable(p):
+                    fused.append(p)
+                    continue
                 d_p = p.grad.data
                 if weight_decay != 0:
                     d_p.add_(weight_decay, p.data)
@@ -106,4 +110,24 @@ class SGD(Optimizer):
 
                 p.data.add_(-group['lr'], d_p)
 
+            for params in _fused_buckets(fused, lambda p: 'momentum_buffer' in self.state[p]):
+                self._fused_step(group, params)
+
         return loss
+
+    def _fused_step(self, group, params):
+        # Steps CUDA parameters in one kernel launch per few hundred chunks.
+        # Unlike the step above, the weight decay is not added to p.grad.
+        momentum = group['momentum']
+        buffers = []
+        init_momentum = False
+        if momentum != 0:
+            init_momentum = 'momentum_buffer' not in self.state[params[0]]
+            for p in params:
+                param_state = self.state[p]
+                if init_momentum:
+                    param_state['momentum_buffer'] = torch.zeros_like(p.data)
+                buffers.append(param_state['momentum_buffer'])
+        torch._fused_sgd([p.data for p in params], [p.grad.data for p in params], buffers,
+                         group['lr'], momentum, group['dampening'], group['weight_decay'],
+                         group['nesterov'], init_momentum)
@@ -8,6 +8,7 @@ import sys
 import torch
 import tarfile
 import tempfile
+import threading
 import warnings
 from contextlib import closing, contextmanager
 from ._utils import _import_dotted_name
@@ -25,7 +26,12 @@ INT_SIZE = struct.Struct('=i').size
 SHORT_SIZE = struct.Struct('=h').size
 
 MAGIC_NUMBER = 0x1950a86a20f9469cfc6c
-PROTOCOL_VERSION = 1001
+PROTOCOL_VERSION = 1002
+# the last version that stored storages right after each other
+UNALIGNED_PROTOCOL_VERSION = 1001
+# the data of every storage starts at a multiple of this many bytes from where
+# the checkpoint starts, so that it can be mapped from the file
+STORAGE_ALIGNMENT = 64
 STORAGE_KEY_SEPARATOR = ','
 
 
@@ -173,6 +179,23 @@ def _save(obj, f, pickle_module, pickle_protocol):
                    'Please use something like io.BytesIO for torch.save instead.')
             raise RuntimeError(msg)
 
+    header, data, storage_table, serialized_storages = _serialize(obj, pickle_module, pickle_protocol)
+    f.write(header)
+    f.write(data)
+
+    f_is_real_file = _is_real_file(f)
+    offset = len(header) + len(data)
+    for key, nbytes in storage_table:
+        padding = _storage_padding(offset)
+        f.write(b'\0' * padding)
+        f.flush()
+        serialized_storages[key]._write_file(f, f_is_real_file)
+        offset += padding + 8 + nbytes
+
+
+def _serialize(obj, pickle_module, pickle_protocol):
+    """Pickles obj without its storages. Returns the header and pickle of a
+    checkpoint, its storage table, and the storages by key."""
     import torch.nn as nn
     serialized_container_types = {}
     serialized_storages = {}
@@ -227,21 +250,163 @@ def _save(obj, f, pickle_module, pickle_protocol):
         ),
     )
 
-    pickle_module.dump(MAGIC_NUMBER, f, protocol=pickle_protocol)
-    pickle_module.dump(PROTOCOL_VERSION, f, protocol=pickle_protocol)
-    pickle_module.dump(sys_info, f, protocol=pickle_protocol)
-    pickler = pickle_module.Pickler(f, protocol=pickle_protocol)
+    # The object is pickled first to find its storages. Only the storages are
+    # large, and they are written one by one straight from their memory.
+    data = io.BytesIO()
+    pickler = pickle_module.Pickler(data, protocol=pickle_protocol)
     pickler.persistent_id = persistent_id
     pickler.dump(obj)
+    data = data.getvalue()
+
+    storage_table = [(key, serialized_storages[key].size() * serialized_storages[key].element_size())
+                     for key in sorted(serialized_storages.keys())]
+    header = io.BytesIO()
+    pickle_module.dump(MAGIC_NUMBER, header, protocol=pickle_protocol)
+    pickle_module.dump(PROTOCOL_VERSION, header, protocol=pickle_protocol)
+    pickle_module.dump(sys_info, header, protocol=pickle_protocol)
+    pickle_module.dump(storage_table, header, protocol=pickle_protocol)
+    header.write(struct.pack('<q', len(data)))
+    return header.getvalue(), data, storage_table, serialized_storages
+
+
+def _storage_padding(offset):
+    # storages are stored as an 8 byte element count followed by the data
+    return -(offset + 8) % STORAGE_ALIGNMENT
+
+
+def _storage_offsets(offset, storage_table):
+    """Returns the offsets of the storages that follow the pickle, which ends
+    at offset, and the size of the checkpoint."""
+    storage_offsets = {}
+    for key, nbytes in storage_table:
+        offset += _storage_padding(offset)
+        storage_offsets[key] = offset
+        offset += 8 + nbytes
+    return storage_offsets, offset
+
+
+def save_async(obj, f, pickle_module=pickle, pickle_protocol=DEFAULT_PROTOCOL, num_threads=4):
+    """Saves an object to a disk file in the background.
+
+    The storages of obj are snapshotted before this function returns, so they
+    can be modified right away: CPU storages are copied, and CUDA storages are
+    copied to pinned memory with non-blocking copies on the current stream of
+    their device, which later kernels on that stream wait for. The file is
+    then written by up to ``num_threads`` threads, each writing a share of the
+    storages through its own file descriptor. It can be loaded with
+    :func:`torch.load` once it is complete.
 
-    serialized_storage_keys = sorted(serialized_storages.keys())
-    pickle_module.dump(serialized_storage_keys, f, protocol=pickle_protocol)
-    f.flush()
-    for key in serialized_storage_keys:
-        serialized_storages[key]._write_file(f, _is_real_file(f))
+    Args:
+        obj: saved object
+        f: a string containing a file name
+        pickle_module: module used for pickling metadata and objects
+        pickle_protocol: can be specified to override the default protocol
+        num_threads: number of threads writing the storages
 
+    Returns:
+        An :class:`AsyncSave` that can be waited on
 
-def load(f, map_location=None, pickle_module=pickle):
+    Example:
+        >>> checkpoint = torch.save_async(model.state_dict(), 'model.pt')
+        >>> optimizer.step()  # runs while the checkpoint is written
+        >>> checkpoint.wait()
+    """
+    if not isinstance(f, _string_classes) and not \
+            (sys.version_info[0] == 3 and isinstance(f, pathlib.Path)):
+        raise TypeError("save_async expects a file name, but got {}".format(type(f).__name__))
+    if num_threads < 1:
+        raise ValueError("save_async expects a positive num_threads, but got {}".format(num_threads))
+    header, data, storage_table, storages = _serialize(obj, pickle_module, pickle_protocol)
+
+    snapshots = {}
+    devices = set()
+    for key, storage in storages.items():
+        if storage.is_cuda:
+            device = storage.get_device()
+            cpu_type = getattr(torch, type(storage).__name__)
+            with torch.cuda.device(device):
+                snapshot = cpu_type(storage.size(), allocator=torch.cuda._host_allocator())
+                snapshot.copy_(storage, non_blocking=True)
+            devices.add(device)
+        else:
+            snapshot = storage.clone()
+        snapshots[key] = snapshot
+    copies_done = []
+    for device in devices:
+        with torch.cuda.device(device):
+            event = torch.cuda.Event()
+            event.record()
+            copies_done.append(event)
+
+    return AsyncSave(str(f), header, data, storage_table, snapshots, copies_done, num_threads)
+
+
+class AsyncSave(object):
+    """A checkpoint that is being written by :func:`save_async`."""
+
+    def __init__(self, filename, header, data, storage_table, storages, copies_done, num_threads):
+        self.filename = filename
+        self._error = None
+        self._thread = threading.Thread(
+            target=self._write,
+            args=(header, data, storage_table, storages, copies_done, num_threads))
+        self._thread.start()
+
+    def done(self):
+        """Returns ``True`` if the checkpoint has been written or writing it
+        failed."""
+        return not self._thread.is_alive()
+
+    def wait(self):
+        """Waits until the checkpoint has been written, and raises the error
+        that writing it failed with, if any."""
+        self._thread.join()
+        if self._error is not None:
+            raise self._error
+
+    def _write(self, header, data, storage_table, storages, copies_done, num_threads):
+        try:
+            storage_offsets, size = _storage_offsets(len(header) + len(data), storage_table)
+            with open(self.filename, 'wb') as f:
+                f.write(header)
+                f.write(data)
+                # the padding between storages stays zero
+                f.truncate(size)
+
+            # give every thread about the same number of bytes, largest first
+            shards = [[] for _ in range(min(num_threads, len(storage_table)))]
+            shard_bytes = [0] * len(shards)
+            for key, nbytes in sorted(storage_table, key=lambda entry: -entry[1]):
+                i = shard_bytes.index(min(shard_bytes))
+                shards[i].append(key)
+                shard_bytes[i] += nbytes
+
+            for event in copies_done:
+                event.synchronize()
+
+            errors = []
+
+            def write_shard(keys):
+                try:
+                    with open(self.filename, 'r+b') as f:
+                        for key in keys:
+                            f.seek(storage_offsets[key])
+                            storages[key]._write_file(f, True)
+                except Exception as e:
+                    errors.append(e)
+
+            threads = [threading.Thread(target=write_shard, args=(keys,)) for keys in shards]
+            for thread in threads:
+                thread.start()
+            for thread in threads:
+                thread.join()
+            if errors:
+                raise errors[0]
+        except Exception as e:
+            self._error = e
+
+
+def load(f, map_location=None, pickle_module=pickle, mmap=False):
     """Loads an object saved with :func:`torch.save` from a file.
 
     :meth:`torch.load` uses Python's unpickling facilities but treats storages,
@@ -280,6 +445,12 @@ def load(f, map_location=None, pickle_module=pickle):
             locations
         pickle_module: module used for unpickling metadata and objects (has to
             match the pickle_module used to serialize file)
+        mmap: if ``True``, CPU storages are mapped from the file instead of
+            being read, so that only the pages that are accessed are loaded.
+            Modifying them doesn't change the file. Requires f to be a file
+            name or a file object with a ``name``. Checkpoints saved by older
+            versions, or that don't start at an offset aligned to 64 bytes
+            within the file, are read as usual.
 
     Example:
         >>> torch.load('tensors.pt')
@@ -303,13 +474,13 @@ def load(f, map_location=None, pickle_module=pickle):
         new_fd = True
         f = open(f, 'rb')
     try:
-        return _load(f, map_location, pickle_module)
+        return _load(f, map_location, pickle_module, mmap)
     finally:
         if new_fd:
             f.close()
 
 
-def _load(f, map_location, pickle_module):
+def _load(f, map_location, pickle_module, mmap):
     deserialized_objects = {}
 
     if map_location is None:
@@ -440,7 +611,7 @@ def _load(f, map_location, pickle_module):
             data_type, root_key, location, size, view_metadata = data
             if root_key not in deserialized_objects:
                 deserialized_objects[root_key] = restore_location(
-                    data_type(size), location)
+                    new_storage(data_type, root_key, size), location)
             storage = deserialized_objects[root_key]
             if view_metadata is not None:
                 view_key, offset, view_size = view_metadata
@@ -452,6 +623,9 @@ def _load(f, map_location, pickle_module):
         else:
             raise RuntimeError("Unknown saved id type: %s" % saved_id[0])
 
+    def new_storage(data_type, root_key, size):
+        return data_type(size)
+
     f_is_real_file = _is_real_file(f)
     if f_is_real_file and f.tell() == 0:
         # legacy_load requires that f has fileno()
@@ -462,24 +636,59 @@ def _load(f, map_location, pickle_module):
             # if not a tarfile, reset file offset and proceed
             f.seek(0)
 
+    start = f.tell()
     magic_number = pickle_module.load(f)
     if magic_number != MAGIC_NUMBER:
         raise RuntimeError("Invalid magic number; corrupt file?")
     protocol_version = pickle_module.load(f)
-    if protocol_version != PROTOCOL_VERSION:
+    if protocol_version not in (PROTOCOL_VERSION, UNALIGNED_PROTOCOL_VERSION):
         raise RuntimeError("Invalid protocol version: %s" % protocol_version)
 
     _sys_info = pickle_module.load(f)
+
+    if protocol_version == UNALIGNED_PROTOCOL_VERSION:
+        unpickler = pickle_module.Unpickler(f)
+        unpickler.persistent_load = persistent_load
+        result = unpickler.load()
+
+        deserialized_storage_keys = pickle_module.load(f)
+
+        offset = f.tell() if f_is_real_file else None
+        for key in deserialized_storage_keys:
+            assert key in deserialized_objects
+            deserialized_objects[key]._set_from_file(f, offset, f_is_real_file)
+            offset = None
+        return result
+
+    # offsets of the storages relative to start
+    storage_table = pickle_module.load(f)
+    data_size, = struct.unpack('<q', f.read(8))
+    storage_offsets, checkpoint_size = _storage_offsets(f.tell() - start + data_size, storage_table)
+
+    mapped = None
+    if mmap and storage_table and start % STORAGE_ALIGNMENT == 0:
+        filename = getattr(f, 'name', None)
+        if not f_is_real_file or not isinstance(filename, _string_classes):
+            raise ValueError("torch.load with mmap=True requires a file name or "
+                             "a file object with a name, but got {}".format(f))
+        mapped = torch.ByteStorage.from_file(filename, False, start + checkpoint_size)
+
+        def new_storage(data_type, root_key, size):
+            # always on the CPU; restore_location moves it where it belongs
+            cpu_type = getattr(torch, data_type.__name__)
+            return cpu_type._new_from_bytes(mapped, start + storage_offsets[root_key] + 8, size)
+
     unpickler = pickle_module.Unpickler(f)
     unpickler.persistent_load = persistent_load
     result = unpickler.load()
 
-    deserialized_storage_keys = pickle_module.load(f)
-
-    offset = f.tell() if f_is_real_file else None
-    for key in deserialized_storage_keys:
-        assert key in deserialized_objects
-        deserialized_objects[key]._set_from_file(f, offset, f_is_real_file)
-        offset = None
+    if mapped is None:
+        for key, _ in storage_table:
+            assert key in deserialized_objects
+            if f_is_real_file:
+                deserialized_objects[key]._set_from_file(f, start + storage_offsets[key], True)
+            else:
+                f.seek(start + storage_offsets[key])
+                deserialized_objects[key]._set_from_file(f, None, False)
 
     return result
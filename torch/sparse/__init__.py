@@ -1 +1,137 @@
 # The Tensor classes are added to this module by python_tensor.cpp
+import torch
+
+__all__ = ['CSRTensor']
+
+
+class CSRTensor(object):
+    r"""A 2-D sparse matrix in compressed sparse row (CSR) format.
+
+    The entries of row ``i`` are ``values[crow_indices[i]:crow_indices[i + 1]]``
+    and sit at the columns ``col_indices[crow_indices[i]:crow_indices[i + 1]]``,
+    which are sorted. Compared to a coalesced COO matrix, the row indices take
+    ``rows + 1`` instead of ``nnz`` elements, and :meth:`mm` reads the
+    entries of every row of the result contiguously.
+
+    Gradients flow to :attr:`values` (and to the dense arguments of
+    :meth:`mm` and :meth:`addmm`). Only CPU tensors are supported.
+
+    Arguments:
+        crow_indices (LongTensor): row pointers, of size ``rows + 1``
+        col_indices (LongTensor): column of each entry, of size ``nnz``
+        values (Tensor): value of each entry, of size ``nnz``
+        size (torch.Size or tuple): ``(rows, cols)``
+
+    Example::
+
+        >>> i = torch.LongTensor([[0, 1, 1], [2, 0, 2]])
+        >>> v = torch.FloatTensor([3, 4, 5])
+        >>> a = torch.sparse.CSRTensor.from_coo(torch.sparse.FloatTensor(i, v, torch.Size([2, 3])))
+        >>> a.crow_indices
+        tensor([ 0,  1,  3])
+        >>> a.mm(torch.ones(3, 2))
+        tensor([[ 3.,  3.],
+                [ 9.,  9.]])
+    """
+
+    def __init__(self, crow_indices, col_indices, values, size):
+        size = torch.Size(size)
+        if len(size) != 2:
+            raise ValueError("CSRTensor: size must have two dimensions, but got {}".format(size))
+        if crow_indices.dim() != 1 or crow_indices.numel() != size[0] + 1:
+            raise ValueError("CSRTensor: crow_indices must have size rows + 1 ({})".format(size[0] + 1))
+        if values.dim() > 1 or col_indices.dim() > 1 or values.numel() != col_indices.numel():
+            raise ValueError("CSRTensor: col_indices and values must be 1-D and of the same size")
+        self.crow_indices = crow_indices.contiguous()
+        self.col_indices = col_indices.contiguous()
+        self.values = values
+        self._size = size
+
+    @classmethod
+    def from_coo(cls, tensor):
+        r"""Converts a 2-D sparse COO tensor with scalar values."""
+        if not tensor.is_sparse or tensor.dim() != 2 or tensor._values().dim() != 1:
+            raise ValueError("CSRTensor.from_coo: expected a 2-D sparse tensor with scalar values")
+        tensor = tensor.coalesce()
+        if tensor._nnz() == 0:
+            rows = cols = tensor._indices().new()
+        else:
+            rows, cols = tensor._indices()
+        crow_indices = torch._csr_pointers(rows, tensor.size(0))
+        return cls(crow_indices, cols, tensor._values(), tensor.size())
+
+    @classmethod
+    def from_dense(cls, tensor):
+        r"""Converts a 2-D dense tensor, keeping its nonzero entries."""
+        if tensor.dim() != 2:
+            raise ValueError("CSRTensor.from_dense: expected a 2-D tensor")
+        indices = tensor.nonzero()
+        if indices.numel() == 0:
+            rows = cols = indices.new()
+        else:
+            # nonzero() returns the indices in row-major order
+            rows, cols = indices[:, 0].contiguous(), indices[:, 1].contiguous()
+        values = tensor.view(-1).index_select(0, rows * tensor.size(1) + cols)
+        return cls(torch._csr_pointers(rows, tensor.size(0)), cols, values, tensor.size())
+
+    def to_coo(self):
+        rows = torch._csr_row_indices(self.crow_indices)
+        indices = torch.stack([rows, self.col_indices])
+        return torch.sparse_coo_tensor(indices, self.values, self._size)
+
+    def to_dense(self):
+        rows = torch._csr_row_indices(self.crow_indices)
+        result = self.values.new_zeros(self._size[0] * self._size[1])
+        result = result.index_add(0, rows * self._size[1] + self.col_indices, self.values)
+        return result.view(self._size)
+
+    def size(self, dim=None):
+        if dim is None:
+            return self._size
+        return self._size[dim]
+
+    @property
+    def shape(self):
+        return self._size
+
+    @property
+    def dtype(self):
+        return self.values.dtype
+
+    def dim(self):
+        return 2
+
+    def _nnz(self):
+        return self.col_indices.numel()
+
+    def mm(self, dense):
+        r"""Returns the dense product of this matrix and ``dense``."""
+        return torch._csr_mm(self.crow_indices, self.col_indices, self.values, dense)
+
+    def addmm(self, input, dense, beta=1, alpha=1):
+        r"""Returns ``beta * input + alpha * (self @ dense)``; ``input`` is
+        broadcast to the size of the product."""
+        return torch._csr_addmm(input, self.crow_indices, self.col_indices, self.values, dense,
+                                beta=beta, alpha=alpha)
+
+    def t(self):
+        crow_indices, col_indices, positions = torch._csr_transpose(
+            self.crow_indices, self.col_indices, self._size[1])
+        return CSRTensor(crow_indices, col_indices, self.values.index_select(0, positions),
+                         (self._size[1], self._size[0]))
+
+    def index_select(self, dim, index):
+        r"""Returns the rows (``dim=0``) or columns (``dim=1``) at ``index``
+        as a new CSRTensor. Selecting columns transposes the matrix twice."""
+        if dim == 1 or dim == -1:
+            return self.t().index_select(0, index).t()
+        if dim != 0 and dim != -2:
+            raise IndexError("CSRTensor.index_select: dim must be 0 or 1, but got {}".format(dim))
+        crow_indices, col_indices, positions = torch._csr_index_select(
+            self.crow_indices, self.col_indices, index)
+        return CSRTensor(crow_indices, col_indices, self.values.index_select(0, positions),
+                         (index.numel(), self._size[1]))
+
+    def __repr__(self):
+        return 'CSRTensor(crow_indices={}, col_indices={}, values={}, size={})'.format(
+            self.crow_indices, self.col_indices, self.values, tuple(self._size))
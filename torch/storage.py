@@ -106,11 +106,18 @@ class _StorageBase(object):
 
     @classmethod
     def _new_shared(cls, size):
-        """Creates a new storage in shared memory with the same data type"""
+        """Creates a new storage in shared memory with the same data type
+
+        CPU storages are taken from the shared memory arena of this process if
+        there is one (see ``torch._C._init_shm_arena``) and it has room.
+        """
         from torch.multiprocessing import get_sharing_strategy
         if cls.is_cuda:
             return cls(size)
-        elif get_sharing_strategy() == 'file_system':
+        storage = cls._new_using_arena(size)
+        if storage is not None:
+            return storage
+        if get_sharing_strategy() == 'file_system':
             return cls._new_using_filename(size)
         else:
             return cls._new_using_fd(size)
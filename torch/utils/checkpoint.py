@@ -2,50 +2,11 @@ import torch
 import warnings
 
 
-def detach_variable(inputs):
-    if isinstance(inputs, tuple):
-        out = []
-        for inp in inputs:
-            x = inp.detach()
-            x.requires_grad = inp.requires_grad
-            out.append(x)
-        return tuple(out)
-    else:
-        raise RuntimeError(
-            "Only tuple of tensors is supported. Got Unsupported input type: ", type(inputs).__name__)
-
-
 def check_backward_validity(inputs):
     if not any(inp.requires_grad for inp in inputs):
         warnings.warn("None of the inputs have requires_grad=True. Gradients will be None")
 
 
-class CheckpointFunction(torch.autograd.Function):
-
-    @staticmethod
-    def forward(ctx, run_function, *args):
-        check_backward_validity(args)
-        ctx.run_function = run_function
-        ctx.save_for_backward(*args)
-        with torch.no_grad():
-            outputs = run_function(*args)
-        return outputs
-
-    @staticmethod
-    def backward(ctx, *args):
-        if not torch.autograd._is_checkpoint_valid():
-            raise RuntimeError("Checkpointing is not compatible with .grad(), please use .backward() if possible")
-        inputs = ctx.saved_tensors
-        detached_inputs = detach_variable(inputs)
-        with torch.enable_grad():
-            outputs = ctx.run_function(*detached_inputs)
-
-        if isinstance(outputs, torch.Tensor):
-            outputs = (outputs,)
-        torch.autograd.backward(outputs, args)
-        return (None,) + tuple(inp.grad for inp in detached_inputs)
-
-
 def checkpoint(function, *args):
     r"""Checkpoint a model or part of the model
 
@@ -57,11 +18,14 @@ def checkpoint(function, *args):
 
     Specifically, in the forward pass, :attr:`function` will run in
     :func:`torch.no_grad` manner, i.e., not storing the intermediate
-    activations. Instead, the forward pass saves the inputs tuple and the
-    :attr:`function` parameter. In the backwards pass, the saved inputs and
-    :attr:`function` is retreived, and the forward pass is computed on
-    :attr:`function` again, now tracking the intermediate activations, and then
-    the gradients are calculated using these activation values.
+    activations. Instead, the forward pass saves the inputs tuple, the
+    :attr:`function` parameter and the state of the random number generators.
+    In the backwards pass, the saved inputs and :attr:`function` is retreived,
+    and the forward pass is computed on :attr:`function` again from the same
+    random state, now tracking the intermediate activations, and then the
+    gradients are calculated using these activation values. The autograd
+    engine runs each recomputation only once nothing else in the backward pass
+    is ready to run, and frees its activations before moving on.
 
     .. warning::
         Checkpointing doesn't work with :func:`torch.autograd.grad`, but only
@@ -89,7 +53,18 @@ def checkpoint(function, *args):
     Returns:
         Output of running :attr:`function` on *:attr:`args`
     """
-    return CheckpointFunction.apply(function, *args)
+    check_backward_validity(args)
+    returns_tensor = [False]
+
+    def run_function(*inputs):
+        outputs = function(*inputs)
+        if isinstance(outputs, torch.Tensor):
+            returns_tensor[0] = True
+            return (outputs,)
+        return tuple(outputs)
+
+    outputs = torch.autograd.Variable._execution_engine.checkpoint(run_function, args)
+    return outputs[0] if returns_tensor[0] else outputs
 
 
 def checkpoint_sequential(functions, segments, *inputs):
@@ -2,7 +2,7 @@ import random
 import torch
 import torch.multiprocessing as multiprocessing
 from torch._C import _set_worker_signal_handlers, _update_worker_pids, \
-    _remove_worker_pids, _error_if_any_worker_fails
+    _remove_worker_pids, _error_if_any_worker_fails, _collate_tensors
 from . import SequentialSampler, RandomSampler, BatchSampler
 import signal
 import functools
@@ -39,6 +39,11 @@ r"""Whether to use shared memory in default_collate"""
 
 MANAGER_STATUS_CHECK_INTERVAL = 5.0
 
+SHM_ARENA_SIZE = int(os.environ.get('PYTORCH_DATALOADER_SHM_ARENA_SIZE', 64 * 1024 * 1024))
+r"""Size in bytes of the shared memory arena every worker allocates batches
+from, so that sending a batch doesn't create a new shared memory segment.
+Batches that don't fit fall back to a segment of their own. 0 disables it."""
+
 if IS_WINDOWS:
     # On Windows, the parent ID of the worker process remains unchanged when the manager process
     # is gone, and the only way to check it through OS is to let the worker have a process handle
@@ -83,6 +88,8 @@ def _worker_loop(dataset, index_queue, data_queue, collate_fn, seed, init_fn, wo
     _set_worker_signal_handlers()
 
     torch.set_num_threads(1)
+    if SHM_ARENA_SIZE > 0:
+        torch._C._init_shm_arena(SHM_ARENA_SIZE)
     random.seed(seed)
     torch.manual_seed(seed)
 
@@ -161,7 +168,7 @@ def default_collate(batch):
             numel = sum([x.numel() for x in batch])
             storage = batch[0].storage()._new_shared(numel)
             out = batch[0].new(storage)
-        return torch.stack(batch, 0, out=out)
+        return _collate_tensors(batch, out)
     elif elem_type.__module__ == 'numpy' and elem_type.__name__ != 'str_' \
             and elem_type.__name__ != 'string_':
         elem = batch[0]
@@ -170,7 +177,7 @@ def default_collate(batch):
             if re.search('[SaUO]', elem.dtype.str) is not None:
                 raise TypeError(error_msg.format(elem.dtype))
 
-            return torch.stack([torch.from_numpy(b) for b in batch], 0)
+            return _collate_tensors([torch.from_numpy(b) for b in batch])
         if elem.shape == ():  # scalars
             py_type = float if elem.dtype.name.startswith('float') else int
             return numpy_type_map[elem.dtype.name](list(map(py_type, batch)))
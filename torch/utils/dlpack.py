@@ -2,3 +2,27 @@ import torch
 
 from torch._C import _from_dlpack as from_dlpack
 from torch._C import _to_dlpack as to_dlpack
+
+torch._C._add_docstr(to_dlpack, r"""to_dlpack(tensor, stream=None) -> PyCapsule
+
+Returns a DLPack capsule viewing the memory of :attr:`tensor`, with its
+strides, without a copy. The capsule can be consumed only once.
+
+Arguments:
+    tensor: a CPU or CUDA tensor
+    stream (int, optional): for a CUDA tensor, the ``cudaStream_t`` the
+        consumer will use the tensor on. It is made to wait for the work
+        already queued on the current stream, without blocking the host.
+""")
+
+torch._C._add_docstr(from_dlpack, r"""from_dlpack(capsule, stream=None) -> Tensor
+
+Returns a tensor viewing the memory of a DLPack capsule, without a copy. The
+capsule can be consumed only once.
+
+Arguments:
+    capsule: a DLPack capsule, e.g. from :func:`to_dlpack`
+    stream (int, optional): for a CUDA tensor, the ``cudaStream_t`` its
+        producer used. The current stream is made to wait for the work queued
+        on it, without blocking the host.
+""")